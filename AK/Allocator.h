@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+#include <AK/kmalloc.h>
+
+namespace AK {
+
+// Containers that take an Allocator get their memory through it instead of calling kmalloc() directly.
+// An allocator needs to provide:
+//   - void* allocate(size_t size, size_t alignment), returning nullptr on failure,
+//   - void deallocate(void* ptr, size_t size), for memory it gave out before,
+//   - size_t good_size(size_t size), the amount of memory that a request for `size` bytes would really use.
+// Allocators are stored inside the containers, so stateless ones like this one don't take up any space.
+struct DefaultAllocator {
+    void* allocate(size_t size, size_t) const { return kmalloc(size); }
+    void deallocate(void* ptr, size_t size) const { kfree_sized(ptr, size); }
+    size_t good_size(size_t size) const { return kmalloc_good_size(size); }
+
+    bool operator==(DefaultAllocator const&) const = default;
+};
+
+}
+
+#if USING_AK_GLOBALLY
+using AK::DefaultAllocator;
+#endif
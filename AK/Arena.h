@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/BumpAllocator.h>
+#include <AK/Noncopyable.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+#include <AK/kmalloc.h>
+
+namespace AK {
+
+// An Arena hands out memory for short-lived data and gives all of it back at once, either when it is reset or
+// destroyed. Individual allocations are never freed on their own, which makes allocating and "freeing" almost free.
+// Containers can be put into an arena by giving them an ArenaAllocator:
+//
+//     Arena arena;
+//     Vector<Token, 0, ArenaAllocator> tokens { ArenaAllocator { arena } };
+//
+// Note: Objects that live in an arena must not outlive it, and it is up to the user to make sure that nothing
+//       needs its destructor to run when the arena is reset.
+class Arena {
+    AK_MAKE_NONCOPYABLE(Arena);
+    AK_MAKE_NONMOVABLE(Arena);
+
+public:
+    static constexpr size_t chunk_size = 64 * KiB;
+
+    Arena() = default;
+    ~Arena() { reset(); }
+
+    void* allocate(size_t size, size_t alignment)
+    {
+        m_allocated_bytes += size;
+
+        // Note: Anything that would take up a good part of a chunk gets its own allocation, so we don't end up
+        //       wasting most of a chunk whenever a big buffer grows.
+        if (size > chunk_size / 4)
+            return allocate_large(size, alignment);
+        return m_chunks.allocate(size, alignment);
+    }
+
+    // Gives back all memory allocated through this arena.
+    void reset()
+    {
+        m_chunks.deallocate_all();
+        m_chunks = {};
+
+        while (m_large_allocations) {
+            auto* allocation = exchange(m_large_allocations, m_large_allocations->next);
+            kfree_sized(allocation->base, allocation->size);
+        }
+        m_allocated_bytes = 0;
+    }
+
+    // The number of bytes that have been requested since the arena was last reset.
+    size_t allocated_bytes() const { return m_allocated_bytes; }
+
+private:
+    struct LargeAllocation {
+        LargeAllocation* next { nullptr };
+        void* base { nullptr };
+        size_t size { 0 };
+    };
+
+    void* allocate_large(size_t size, size_t alignment)
+    {
+        // Note: kmalloc() only guarantees a small alignment, so leave enough room to align the data ourselves.
+        //       The header always sits right in front of the data.
+        alignment = max(alignment, alignof(LargeAllocation));
+        auto allocation_size = sizeof(LargeAllocation) + alignment - 1 + size;
+        auto* base = static_cast<u8*>(kmalloc(allocation_size));
+        if (!base)
+            return nullptr;
+        auto* data = reinterpret_cast<u8*>(align_up_to(reinterpret_cast<FlatPtr>(base) + sizeof(LargeAllocation), alignment));
+        auto* allocation = reinterpret_cast<LargeAllocation*>(data - sizeof(LargeAllocation));
+        allocation->next = m_large_allocations;
+        allocation->base = base;
+        allocation->size = allocation_size;
+        m_large_allocations = allocation;
+        return data;
+    }
+
+    BumpAllocator<false, chunk_size> m_chunks;
+    LargeAllocation* m_large_allocations { nullptr };
+    size_t m_allocated_bytes { 0 };
+};
+
+// An allocator for containers that puts their memory into an Arena.
+// Note: Memory is only given back when the arena is reset, so containers that keep growing leave their old buffers
+//       behind until then.
+class ArenaAllocator {
+public:
+    ArenaAllocator(Arena& arena)
+        : m_arena(&arena)
+    {
+    }
+
+    void* allocate(size_t size, size_t alignment) const { return m_arena->allocate(size, alignment); }
+    void deallocate(void*, size_t) const { }
+    size_t good_size(size_t size) const { return size; }
+
+    Arena& arena() const { return *m_arena; }
+
+    bool operator==(ArenaAllocator const&) const = default;
+
+private:
+    Arena* m_arena { nullptr };
+};
+
+}
+
+#if USING_AK_GLOBALLY
+using AK::Arena;
+using AK::ArenaAllocator;
+#endif
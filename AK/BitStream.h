@@ -139,16 +139,24 @@ public:
     // ^Stream
     virtual ErrorOr<Bytes> read(Bytes bytes) override
     {
-        if (m_current_byte.has_value() && is_aligned_to_byte_boundary()) {
-            bytes[0] = m_current_byte.release_value();
-            return m_stream->read(bytes.slice(1));
-        }
         align_to_byte_boundary();
-        return m_stream->read(bytes);
+
+        // Note: Whole bytes may already have been pulled into the bit buffer, those have to be handed out first.
+        size_t buffered_bytes = 0;
+        while (m_bit_count > 0 && buffered_bytes < bytes.size()) {
+            bytes[buffered_bytes++] = static_cast<u8>(m_bit_buffer);
+            m_bit_buffer >>= 8;
+            m_bit_count -= 8;
+        }
+        if (buffered_bytes == bytes.size())
+            return bytes;
+
+        auto read_bytes = TRY(m_stream->read(bytes.slice(buffered_bytes)));
+        return bytes.trim(buffered_bytes + read_bytes.size());
     }
     virtual ErrorOr<size_t> write(ReadonlyBytes bytes) override { return m_stream->write(bytes); }
     virtual ErrorOr<void> write_entire_buffer(ReadonlyBytes bytes) override { return m_stream->write_entire_buffer(bytes); }
-    virtual bool is_eof() const override { return m_stream->is_eof() && !m_current_byte.has_value(); }
+    virtual bool is_eof() const override { return m_stream->is_eof() && m_bit_count == 0; }
     virtual bool is_open() const override { return m_stream->is_open(); }
     virtual void close() override
     {
@@ -169,65 +177,83 @@ public:
         if constexpr (IsSame<bool, T>) {
             VERIFY(count == 1);
         }
-        T result = 0;
 
-        size_t nread = 0;
-        while (nread < count) {
-            if (m_current_byte.has_value()) {
-                if constexpr (!IsSame<bool, T> && !IsSame<u8, T>) {
-                    // read as many bytes as possible directly
-                    if (((count - nread) >= 8) && is_aligned_to_byte_boundary()) {
-                        // shift existing data over
-                        result |= (m_current_byte.value() << nread);
-                        nread += 8;
-                        m_current_byte.clear();
-                    } else {
-                        auto const bit = (m_current_byte.value() >> m_bit_offset) & 1;
-                        result |= (bit << nread);
-                        ++nread;
-                        if (m_bit_offset++ == 7)
-                            m_current_byte.clear();
-                    }
-                } else {
-                    // Always take this branch for booleans or u8: there's no purpose in reading more than a single bit
-                    auto const bit = (m_current_byte.value() >> m_bit_offset) & 1;
-                    if constexpr (IsSame<bool, T>)
-                        result = bit;
-                    else
-                        result |= (bit << nread);
-                    ++nread;
-                    if (m_bit_offset++ == 7)
-                        m_current_byte.clear();
-                }
-            } else {
-                auto temp_buffer = TRY(ByteBuffer::create_uninitialized(1));
-                auto read_bytes = TRY(m_stream->read(temp_buffer.bytes()));
-                if (read_bytes.is_empty())
-                    return Error::from_string_literal("eof");
-                m_current_byte = temp_buffer[0];
-                m_bit_offset = 0;
-            }
+        if (count > max_peek_bit_count) {
+            // Note: The buffer can't always hold this many bits at once, so they are read in two halves.
+            auto low_count = count / 2;
+            auto low_bits = TRY(read_bits<u64>(low_count));
+            auto high_bits = TRY(read_bits<u64>(count - low_count));
+            return static_cast<T>(low_bits | (high_bits << low_count));
         }
 
-        return result;
+        auto bits = TRY(peek_bits<T>(count));
+        TRY(discard_previously_peeked_bits(count));
+        return bits;
+    }
+
+    /// Returns the next `count` bits without consuming them. Bits past the end of the underlying stream read as zero,
+    /// so that prefix codes can be looked up in a table without knowing their length beforehand.
+    template<Unsigned T = u64>
+    ErrorOr<T> peek_bits(size_t count)
+    {
+        VERIFY(count <= max_peek_bit_count);
+        if (count > m_bit_count)
+            TRY(refill_buffer_from_stream());
+
+        if constexpr (IsSame<bool, T>)
+            return (m_bit_buffer & 1) != 0;
+        else
+            return static_cast<T>(m_bit_buffer & ((1ull << count) - 1));
+    }
+
+    /// Consumes bits that have previously been looked at through peek_bits().
+    ErrorOr<void> discard_previously_peeked_bits(size_t count)
+    {
+        if (count > m_bit_count)
+            return Error::from_string_literal("eof");
+        m_bit_buffer >>= count;
+        m_bit_count -= count;
+        return {};
     }
 
     /// Discards any sub-byte stream positioning the input stream may be keeping track of.
     /// Non-bitwise reads will implicitly call this.
     u8 align_to_byte_boundary()
     {
-        u8 remaining_bits = m_current_byte.value_or(0) >> m_bit_offset;
-        m_current_byte.clear();
-        m_bit_offset = 0;
+        auto remaining_bit_count = m_bit_count % 8;
+        u8 remaining_bits = m_bit_buffer & ((1u << remaining_bit_count) - 1);
+        m_bit_buffer >>= remaining_bit_count;
+        m_bit_count -= remaining_bit_count;
         return remaining_bits;
     }
 
     /// Whether we are (accidentally or intentionally) at a byte boundary right now.
-    ALWAYS_INLINE bool is_aligned_to_byte_boundary() const { return m_bit_offset == 0; }
+    ALWAYS_INLINE bool is_aligned_to_byte_boundary() const { return m_bit_count % 8 == 0; }
 
 private:
-    Optional<u8> m_current_byte;
-    size_t m_bit_offset { 0 };
+    // Note: The buffer is only ever topped up with whole bytes, so at least this many bits can always be peeked at.
+    static constexpr size_t max_peek_bit_count = 64 - 7;
+
+    ErrorOr<void> refill_buffer_from_stream()
+    {
+        // Note: This pulls in as many bytes as fit into the buffer with a single read, which means that the underlying
+        //       stream may be read further than the bits that end up being consumed. Anything that is read afterwards
+        //       should go through this stream instead.
+        size_t byte_count = (64 - m_bit_count) / 8;
+        if (byte_count == 0)
+            return {};
+
+        u8 bytes[8] {};
+        auto read_bytes = TRY(m_stream->read({ bytes, byte_count }));
+        for (size_t i = 0; i < read_bytes.size(); ++i) {
+            m_bit_buffer |= static_cast<u64>(bytes[i]) << m_bit_count;
+            m_bit_count += 8;
+        }
+        return {};
+    }
+
+    u64 m_bit_buffer { 0 };
+    size_t m_bit_count { 0 };
     MaybeOwned<Stream> m_stream;
 };
 
@@ -339,6 +365,23 @@ public:
     {
         VERIFY(m_bit_offset <= 7);
 
+        if (sizeof(T) <= sizeof(u32) && bit_count <= 32) {
+            // Note: The bits are put next to the ones that are still pending, and all the bytes that that completes are
+            //       handed to the underlying stream in one go.
+            u64 bits = m_current_byte | ((static_cast<u64>(value) & ((1ull << bit_count) - 1)) << m_bit_offset);
+            size_t total_bit_count = m_bit_offset + bit_count;
+            size_t byte_count = total_bit_count / 8;
+            if (byte_count > 0) {
+                u8 bytes[sizeof(u64)];
+                for (size_t i = 0; i < byte_count; ++i)
+                    bytes[i] = static_cast<u8>(bits >> (i * 8));
+                TRY(m_stream->write_entire_buffer({ bytes, byte_count }));
+            }
+            m_current_byte = static_cast<u8>(bits >> (byte_count * 8));
+            m_bit_offset = total_bit_count % 8;
+            return {};
+        }
+
         size_t input_offset = 0;
         while (input_offset < bit_count) {
             u8 next_bit = (value >> input_offset) & 1;
@@ -174,6 +174,26 @@ ErrorOr<Bytes> CircularBuffer::read_with_seekback(Bytes bytes, size_t distance)
     return bytes.trim(bytes.size() - remaining);
 }
 
+ErrorOr<size_t> CircularBuffer::copy_from_seekback(size_t distance, size_t length)
+{
+    if (distance == 0 || distance > m_seekback_limit)
+        return Error::from_string_literal("Tried a seekback copy beyond the seekback limit");
+
+    auto remaining = length;
+
+    while (remaining > 0) {
+        // Note: At most `distance` bytes are copied at once, so that the bytes being read have all been written already.
+        auto const next_span = next_read_span_with_seekback(distance).trim(min(distance, remaining));
+        auto const written_bytes = write(next_span);
+        if (written_bytes == 0)
+            break;
+
+        remaining -= written_bytes;
+    }
+
+    return length - remaining;
+}
+
 ErrorOr<void> CircularBuffer::discard(size_t discarding_size)
 {
     if (m_used_space < discarding_size)
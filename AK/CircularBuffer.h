@@ -32,6 +32,11 @@ public:
     /// before the current write pointer and allows for reading already-read data.
     ErrorOr<Bytes> read_with_seekback(Bytes bytes, size_t distance);
 
+    /// Appends `length` bytes that are copied from `distance` bytes before the current write pointer, like an LZ77
+    /// back reference does. The copy may overlap with the bytes that it writes.
+    /// Returns the number of bytes that were copied, which is less than `length` if the buffer runs out of space.
+    ErrorOr<size_t> copy_from_seekback(size_t distance, size_t length);
+
     [[nodiscard]] size_t empty_space() const;
     [[nodiscard]] size_t used_space() const;
     [[nodiscard]] size_t capacity() const;
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+#include <coroutine>
+
+namespace AK {
+
+template<typename T>
+class Coroutine;
+
+namespace Detail {
+
+struct CoroutinePromiseBase {
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        // Note: Resuming whoever is waiting for the result from here (rather than from return_value()) means that the
+        //       frame is already suspended when they get to run, so they're free to destroy it.
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            if (auto awaiter = handle.promise().awaiter)
+                return awaiter;
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept { }
+    };
+
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() const { VERIFY_NOT_REACHED(); }
+
+    std::coroutine_handle<> awaiter;
+};
+
+template<typename T>
+struct CoroutinePromise : public CoroutinePromiseBase {
+    void return_value(T value) { result = move(value); }
+
+    Optional<T> result;
+};
+
+template<>
+struct CoroutinePromise<void> : public CoroutinePromiseBase {
+    void return_void() { }
+};
+
+}
+
+// The result of a function that uses co_await or co_return.
+// Like a regular function call, calling a coroutine runs it right away, but it may suspend on the way (by co_await-ing
+// something that isn't ready yet), in which case the caller gets control back before it has finished. Other coroutines
+// can then co_await the Coroutine to be resumed once it has finished, and everyone else can check is_ready().
+// The coroutine's frame lives as long as the Coroutine does, and destroying a Coroutine that hasn't finished cancels it.
+template<typename T>
+class [[nodiscard]] Coroutine {
+    AK_MAKE_NONCOPYABLE(Coroutine);
+
+public:
+    struct promise_type : public Detail::CoroutinePromise<T> {
+        Coroutine get_return_object() { return Coroutine { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+    };
+
+    Coroutine(Coroutine&& other)
+        : m_handle(exchange(other.m_handle, {}))
+    {
+    }
+
+    Coroutine& operator=(Coroutine&& other)
+    {
+        if (this != &other) {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle = exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+
+    ~Coroutine()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    bool is_ready() const { return m_handle.done(); }
+
+    // Only callable once the coroutine has finished, and only once.
+    T take_result()
+    {
+        VERIFY(is_ready());
+        if constexpr (!IsVoid<T>)
+            return m_handle.promise().result.release_value();
+    }
+
+    bool await_ready() const { return is_ready(); }
+    void await_suspend(std::coroutine_handle<> awaiter)
+    {
+        VERIFY(!m_handle.promise().awaiter);
+        m_handle.promise().awaiter = awaiter;
+    }
+    T await_resume() { return take_result(); }
+
+private:
+    explicit Coroutine(std::coroutine_handle<promise_type> handle)
+        : m_handle(handle)
+    {
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+}
+
+#if USING_AK_GLOBALLY
+using AK::Coroutine;
+#endif
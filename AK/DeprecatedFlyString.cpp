@@ -59,11 +59,24 @@ DeprecatedFlyString::DeprecatedFlyString(StringView string)
 {
     if (string.is_null())
         return;
-    auto it = fly_impls().find(string.hash(), [&](auto& candidate) {
+    intern(string, string.hash());
+}
+
+DeprecatedFlyString::DeprecatedFlyString(Badge<FlyString>, StringView string, unsigned hash)
+{
+    VERIFY(!string.is_null());
+    intern(string, hash);
+}
+
+void DeprecatedFlyString::intern(StringView string, unsigned hash)
+{
+    auto it = fly_impls().find(hash, [&](auto& candidate) {
         return string == candidate;
     });
     if (it == fly_impls().end()) {
         auto new_string = string.to_deprecated_string();
+        // Note: We already know the hash, so don't make the table compute it a second time.
+        new_string.impl()->set_precomputed_hash({}, hash);
         fly_impls().set(new_string.impl());
         new_string.impl()->set_fly({}, true);
         m_impl = new_string.impl();
@@ -24,11 +24,16 @@ public:
     }
     DeprecatedFlyString(DeprecatedString const&);
     DeprecatedFlyString(StringView);
+    // Note: This looks the string up without making a DeprecatedString first, so interning a literal that has
+    //       been interned before doesn't allocate.
     DeprecatedFlyString(char const* string)
-        : DeprecatedFlyString(static_cast<DeprecatedString>(string))
+        : DeprecatedFlyString(StringView { string, string ? __builtin_strlen(string) : 0 })
     {
     }
 
+    // For strings whose hash is already known, like the ones of a FlyString.
+    DeprecatedFlyString(Badge<FlyString>, StringView, unsigned hash);
+
     static DeprecatedFlyString from_fly_impl(NonnullRefPtr<StringImpl> impl)
     {
         VERIFY(impl->is_fly());
@@ -91,12 +96,15 @@ public:
     }
 
 private:
+    void intern(StringView, unsigned hash);
+
     RefPtr<StringImpl> m_impl;
 };
 
 template<>
 struct Traits<DeprecatedFlyString> : public GenericTraits<DeprecatedFlyString> {
     static unsigned hash(DeprecatedFlyString const& s) { return s.hash(); }
+    static constexpr bool is_trivially_relocatable() { return true; }
 };
 
 }
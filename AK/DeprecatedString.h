@@ -329,6 +329,7 @@ private:
 template<>
 struct Traits<DeprecatedString> : public GenericTraits<DeprecatedString> {
     static unsigned hash(DeprecatedString const& s) { return s.impl() ? s.impl()->hash() : 0; }
+    static constexpr bool is_trivially_relocatable() { return true; }
 };
 
 struct CaseInsensitiveStringTraits : public Traits<DeprecatedString> {
@@ -0,0 +1,579 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/BuiltinWrappers.h>
+#include <AK/HashTable.h>
+#include <AK/Optional.h>
+#include <AK/SIMD.h>
+
+namespace AK {
+
+// FlatHashTable is a drop-in replacement for an unordered HashTable, in the style of Abseil's "Swiss tables".
+// The state of each slot lives in a separate array of control bytes, which also hold 7 bits of the slot's hash.
+// Lookups compare a whole group of control bytes against the hash at once, and only ever touch the slots
+// of entries whose hash bits match. Unlike HashTable, the slots of large values don't have to be skipped
+// over while probing, and the table can be filled up to 7/8 of its capacity.
+namespace Detail {
+
+// Control bytes of full slots hold the lower 7 bits of the hash, so their highest bit is clear.
+enum class FlatHashTableControl : i8 {
+    Empty = -128,
+    Deleted = -2,
+    Sentinel = -1,
+};
+
+constexpr bool is_full_control_byte(i8 control)
+{
+    return control >= 0;
+}
+
+// The positions of matching control bytes in a group, in the order they appear in.
+template<typename T, size_t Shift>
+class FlatHashTableBitMask {
+public:
+    explicit FlatHashTableBitMask(T mask)
+        : m_mask(mask)
+    {
+    }
+
+    explicit operator bool() const { return m_mask != 0; }
+    size_t lowest_set_bit() const { return count_trailing_zeroes(m_mask) >> Shift; }
+    void remove_lowest_set_bit() { m_mask &= m_mask - 1; }
+
+private:
+    T m_mask;
+};
+
+#if defined(__SSE2__)
+struct FlatHashTableGroup {
+    static constexpr size_t width = 16;
+    using BitMask = FlatHashTableBitMask<u32, 0>;
+
+    explicit FlatHashTableGroup(i8 const* controls)
+    {
+        __builtin_memcpy(&m_controls, controls, sizeof(m_controls));
+    }
+
+    BitMask match(u8 hash) const { return to_bit_mask(m_controls == splat(static_cast<i8>(hash))); }
+    BitMask match_empty() const { return to_bit_mask(m_controls == splat(to_underlying(FlatHashTableControl::Empty))); }
+    // Note: Empty and deleted are the only control bytes smaller than the sentinel.
+    BitMask match_empty_or_deleted() const { return to_bit_mask(m_controls < splat(to_underlying(FlatHashTableControl::Sentinel))); }
+
+private:
+    static SIMD::i8x16 splat(i8 value)
+    {
+        return SIMD::i8x16 { value, value, value, value, value, value, value, value, value, value, value, value, value, value, value, value };
+    }
+
+    static BitMask to_bit_mask(SIMD::i8x16 comparison)
+    {
+        return BitMask(static_cast<u32>(__builtin_ia32_pmovmskb128(reinterpret_cast<SIMD::c8x16>(comparison))));
+    }
+
+    SIMD::i8x16 m_controls;
+};
+#else
+// Without SSE2 (for example in the kernel), we look at 8 control bytes at a time in a general purpose register.
+struct FlatHashTableGroup {
+    static constexpr size_t width = 8;
+    using BitMask = FlatHashTableBitMask<u64, 3>;
+
+    explicit FlatHashTableGroup(i8 const* controls)
+    {
+        __builtin_memcpy(&m_controls, controls, sizeof(m_controls));
+    }
+
+    // Note: This may report false positives right next to a true match, which are fine as we compare the values anyways.
+    BitMask match(u8 hash) const
+    {
+        auto x = m_controls ^ (lsbs * hash);
+        return BitMask((x - lsbs) & ~x & msbs);
+    }
+
+    // Empty is 0b10000000, deleted is 0b11111110 and the sentinel is 0b11111111.
+    BitMask match_empty() const { return BitMask(m_controls & (~m_controls << 6) & msbs); }
+    BitMask match_empty_or_deleted() const { return BitMask(m_controls & (~m_controls << 7) & msbs); }
+
+private:
+    static constexpr u64 lsbs = 0x0101010101010101;
+    static constexpr u64 msbs = 0x8080808080808080;
+
+    u64 m_controls;
+};
+#endif
+
+}
+
+template<typename HashTableType, typename T>
+class FlatHashTableIterator {
+    friend HashTableType;
+
+public:
+    bool operator==(FlatHashTableIterator const& other) const { return m_control == other.m_control; }
+    bool operator!=(FlatHashTableIterator const& other) const { return m_control != other.m_control; }
+    T& operator*() { return *m_slot; }
+    T* operator->() { return m_slot; }
+    void operator++()
+    {
+        ++m_control;
+        ++m_slot;
+        skip_to_full_slot();
+    }
+
+private:
+    FlatHashTableIterator(i8 const* control, T* slot)
+        : m_control(control)
+        , m_slot(slot)
+    {
+    }
+
+    void skip_to_full_slot()
+    {
+        while (!Detail::is_full_control_byte(*m_control)) {
+            if (*m_control == to_underlying(Detail::FlatHashTableControl::Sentinel)) {
+                m_control = nullptr;
+                m_slot = nullptr;
+                return;
+            }
+            ++m_control;
+            ++m_slot;
+        }
+    }
+
+    i8 const* m_control { nullptr };
+    T* m_slot { nullptr };
+};
+
+template<typename T, typename TraitsForT>
+class FlatHashTable {
+    using Group = Detail::FlatHashTableGroup;
+    using Control = Detail::FlatHashTableControl;
+
+    // The capacity is always one less than a power of two, so it can be used as a mask for the probe position.
+    static constexpr size_t minimum_capacity = Group::width - 1;
+
+    // The control bytes are followed by a sentinel that ends iteration, and a copy of the first group (minus one byte),
+    // so that loading a group never has to wrap around the end of the table.
+    static constexpr size_t cloned_control_byte_count = Group::width - 1;
+
+public:
+    FlatHashTable() = default;
+    explicit FlatHashTable(size_t capacity) { rehash(capacity_for_size(capacity)); }
+
+    ~FlatHashTable()
+    {
+        if (!m_controls)
+            return;
+
+        if constexpr (!IsTriviallyDestructible<T>) {
+            for (size_t i = 0; i < m_capacity; ++i) {
+                if (Detail::is_full_control_byte(m_controls[i]))
+                    m_slots[i].~T();
+            }
+        }
+
+        kfree_sized(m_controls, size_in_bytes(m_capacity));
+    }
+
+    FlatHashTable(FlatHashTable const& other)
+    {
+        if (!other.is_empty())
+            rehash(capacity_for_size(other.size()));
+        for (auto& it : other)
+            set(it);
+    }
+
+    FlatHashTable& operator=(FlatHashTable const& other)
+    {
+        FlatHashTable temporary(other);
+        swap(*this, temporary);
+        return *this;
+    }
+
+    FlatHashTable(FlatHashTable&& other) noexcept
+        : m_controls(exchange(other.m_controls, nullptr))
+        , m_slots(exchange(other.m_slots, nullptr))
+        , m_size(exchange(other.m_size, 0))
+        , m_capacity(exchange(other.m_capacity, 0))
+        , m_deleted_count(exchange(other.m_deleted_count, 0))
+    {
+    }
+
+    FlatHashTable& operator=(FlatHashTable&& other) noexcept
+    {
+        FlatHashTable temporary { move(other) };
+        swap(*this, temporary);
+        return *this;
+    }
+
+    friend void swap(FlatHashTable& a, FlatHashTable& b) noexcept
+    {
+        swap(a.m_controls, b.m_controls);
+        swap(a.m_slots, b.m_slots);
+        swap(a.m_size, b.m_size);
+        swap(a.m_capacity, b.m_capacity);
+        swap(a.m_deleted_count, b.m_deleted_count);
+    }
+
+    [[nodiscard]] bool is_empty() const { return m_size == 0; }
+    [[nodiscard]] size_t size() const { return m_size; }
+    [[nodiscard]] size_t capacity() const { return m_capacity; }
+
+    template<typename U, size_t N>
+    ErrorOr<void> try_set_from(U (&from_array)[N])
+    {
+        for (size_t i = 0; i < N; ++i)
+            TRY(try_set(from_array[i]));
+        return {};
+    }
+    template<typename U, size_t N>
+    void set_from(U (&from_array)[N])
+    {
+        MUST(try_set_from(from_array));
+    }
+
+    void ensure_capacity(size_t capacity)
+    {
+        MUST(try_ensure_capacity(capacity));
+    }
+
+    ErrorOr<void> try_ensure_capacity(size_t capacity)
+    {
+        VERIFY(capacity >= size());
+        if (capacity <= max_load(m_capacity) - m_deleted_count)
+            return {};
+        return try_rehash(capacity_for_size(capacity));
+    }
+
+    [[nodiscard]] bool contains(T const& value) const
+    {
+        return find(value) != end();
+    }
+
+    template<Concepts::HashCompatible<T> K>
+    requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] bool contains(K const& value) const
+    {
+        return find(value) != end();
+    }
+
+    using Iterator = FlatHashTableIterator<FlatHashTable, T>;
+    using ConstIterator = FlatHashTableIterator<const FlatHashTable, const T>;
+
+    [[nodiscard]] Iterator begin() { return begin_impl<Iterator>(); }
+    [[nodiscard]] Iterator end() { return Iterator(nullptr, nullptr); }
+    [[nodiscard]] ConstIterator begin() const { return begin_impl<ConstIterator>(); }
+    [[nodiscard]] ConstIterator end() const { return ConstIterator(nullptr, nullptr); }
+
+    void clear()
+    {
+        *this = FlatHashTable();
+    }
+    void clear_with_capacity()
+    {
+        if (m_capacity == 0)
+            return;
+        if constexpr (!IsTriviallyDestructible<T>) {
+            for (auto& value : *this)
+                value.~T();
+        }
+        initialize_controls();
+        m_size = 0;
+        m_deleted_count = 0;
+    }
+
+    template<typename U = T>
+    ErrorOr<HashSetResult> try_set(U&& value, HashSetExistingEntryBehavior existing_entry_behavior = HashSetExistingEntryBehavior::Replace)
+    {
+        auto hash = TraitsForT::hash(value);
+        if (auto* existing_value = lookup_with_hash(hash, [&](auto& other) { return TraitsForT::equals(other, value); })) {
+            if (existing_entry_behavior == HashSetExistingEntryBehavior::Keep)
+                return HashSetResult::KeptExistingEntry;
+            *existing_value = forward<U>(value);
+            return HashSetResult::ReplacedExistingEntry;
+        }
+
+        if (m_size + m_deleted_count >= max_load(m_capacity)) {
+            // If many of the used slots are tombstones, getting rid of those is enough to make space.
+            auto new_capacity = m_capacity && m_deleted_count >= m_size ? m_capacity : capacity_for_size(m_size + 1);
+            TRY(try_rehash(new_capacity));
+        }
+
+        auto index = find_first_non_full_slot(hash);
+        if (m_controls[index] == to_underlying(Control::Deleted))
+            --m_deleted_count;
+        new (&m_slots[index]) T(forward<U>(value));
+        set_control(index, hash_bits_for_control(hash));
+        ++m_size;
+        return HashSetResult::InsertedNewEntry;
+    }
+    template<typename U = T>
+    HashSetResult set(U&& value, HashSetExistingEntryBehavior existing_entry_behaviour = HashSetExistingEntryBehavior::Replace)
+    {
+        return MUST(try_set(forward<U>(value), existing_entry_behaviour));
+    }
+
+    template<typename TUnaryPredicate>
+    [[nodiscard]] Iterator find(unsigned hash, TUnaryPredicate predicate)
+    {
+        return iterator_for(lookup_with_hash(hash, move(predicate)));
+    }
+
+    [[nodiscard]] Iterator find(T const& value)
+    {
+        return find(TraitsForT::hash(value), [&](auto& other) { return TraitsForT::equals(value, other); });
+    }
+
+    template<typename TUnaryPredicate>
+    [[nodiscard]] ConstIterator find(unsigned hash, TUnaryPredicate predicate) const
+    {
+        return iterator_for(lookup_with_hash(hash, move(predicate)));
+    }
+
+    [[nodiscard]] ConstIterator find(T const& value) const
+    {
+        return find(TraitsForT::hash(value), [&](auto& other) { return TraitsForT::equals(value, other); });
+    }
+
+    template<Concepts::HashCompatible<T> K>
+    requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] Iterator find(K const& value)
+    {
+        return find(Traits<K>::hash(value), [&](auto& other) { return Traits<T>::equals(other, value); });
+    }
+
+    template<Concepts::HashCompatible<T> K, typename TUnaryPredicate>
+    requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] Iterator find(K const& value, TUnaryPredicate predicate)
+    {
+        return find(Traits<K>::hash(value), move(predicate));
+    }
+
+    template<Concepts::HashCompatible<T> K>
+    requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] ConstIterator find(K const& value) const
+    {
+        return find(Traits<K>::hash(value), [&](auto& other) { return Traits<T>::equals(other, value); });
+    }
+
+    template<Concepts::HashCompatible<T> K, typename TUnaryPredicate>
+    requires(IsSame<TraitsForT, Traits<T>>) [[nodiscard]] ConstIterator find(K const& value, TUnaryPredicate predicate) const
+    {
+        return find(Traits<K>::hash(value), move(predicate));
+    }
+
+    bool remove(T const& value)
+    {
+        auto it = find(value);
+        if (it != end()) {
+            remove(it);
+            return true;
+        }
+        return false;
+    }
+
+    template<Concepts::HashCompatible<T> K>
+    requires(IsSame<TraitsForT, Traits<T>>) bool remove(K const& value)
+    {
+        auto it = find(value);
+        if (it != end()) {
+            remove(it);
+            return true;
+        }
+        return false;
+    }
+
+    // Note: Removing an entry never moves any others, so iterators to them stay valid.
+    void remove(Iterator iterator)
+    {
+        VERIFY(iterator.m_slot);
+        delete_slot(iterator.m_slot - m_slots);
+    }
+
+    template<typename TUnaryPredicate>
+    bool remove_all_matching(TUnaryPredicate const& predicate)
+    {
+        size_t removed_count = 0;
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (Detail::is_full_control_byte(m_controls[i]) && predicate(m_slots[i])) {
+                delete_slot(i);
+                ++removed_count;
+            }
+        }
+        return removed_count;
+    }
+
+    T pop()
+    {
+        VERIFY(!is_empty());
+        auto it = begin();
+        T element = move(*it);
+        remove(it);
+        return element;
+    }
+
+private:
+    static constexpr size_t max_load(size_t capacity)
+    {
+        // Note: A table with a single group couldn't tell where a probe should end if it filled up completely.
+        if (Group::width == 8 && capacity == 7)
+            return 6;
+        return capacity - capacity / 8;
+    }
+
+    static constexpr size_t capacity_for_size(size_t size)
+    {
+        size_t capacity = minimum_capacity;
+        while (max_load(capacity) < size)
+            capacity = capacity * 2 + 1;
+        return capacity;
+    }
+
+    static constexpr size_t controls_size_in_bytes(size_t capacity)
+    {
+        return align_up_to(capacity + 1 + cloned_control_byte_count, alignof(T));
+    }
+
+    static constexpr size_t size_in_bytes(size_t capacity)
+    {
+        return controls_size_in_bytes(capacity) + capacity * sizeof(T);
+    }
+
+    static u8 hash_bits_for_control(unsigned hash) { return hash & 0x7f; }
+    size_t probe_start(unsigned hash) const { return (hash >> 7) & m_capacity; }
+
+    template<typename IteratorType>
+    IteratorType begin_impl() const
+    {
+        if (is_empty())
+            return IteratorType(nullptr, nullptr);
+        IteratorType it(m_controls, m_slots);
+        it.skip_to_full_slot();
+        return it;
+    }
+
+    Iterator iterator_for(T* slot) { return slot ? Iterator(m_controls + (slot - m_slots), slot) : end(); }
+    ConstIterator iterator_for(T const* slot) const { return slot ? ConstIterator(m_controls + (slot - m_slots), slot) : end(); }
+
+    void initialize_controls()
+    {
+        __builtin_memset(m_controls, to_underlying(Control::Empty), m_capacity + 1 + cloned_control_byte_count);
+        m_controls[m_capacity] = to_underlying(Control::Sentinel);
+    }
+
+    // Also updates the clone of this control byte after the sentinel, if it has one.
+    void set_control(size_t index, i8 control)
+    {
+        m_controls[index] = control;
+        m_controls[((index - cloned_control_byte_count) & m_capacity) + (cloned_control_byte_count & m_capacity)] = control;
+    }
+
+    ErrorOr<void> try_rehash(size_t new_capacity)
+    {
+        VERIFY(new_capacity >= minimum_capacity);
+        VERIFY(max_load(new_capacity) > m_size);
+
+        auto* new_storage = static_cast<u8*>(kmalloc(size_in_bytes(new_capacity)));
+        if (!new_storage)
+            return Error::from_errno(ENOMEM);
+
+        auto* old_controls = m_controls;
+        auto* old_slots = m_slots;
+        auto old_capacity = m_capacity;
+
+        m_controls = reinterpret_cast<i8*>(new_storage);
+        m_slots = reinterpret_cast<T*>(new_storage + controls_size_in_bytes(new_capacity));
+        m_capacity = new_capacity;
+        m_deleted_count = 0;
+        initialize_controls();
+
+        if (!old_controls)
+            return {};
+
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (!Detail::is_full_control_byte(old_controls[i]))
+                continue;
+            auto hash = TraitsForT::hash(old_slots[i]);
+            auto index = find_first_non_full_slot(hash);
+            new (&m_slots[index]) T(move(old_slots[i]));
+            set_control(index, hash_bits_for_control(hash));
+            old_slots[i].~T();
+        }
+
+        kfree_sized(old_controls, size_in_bytes(old_capacity));
+        return {};
+    }
+    void rehash(size_t new_capacity)
+    {
+        MUST(try_rehash(new_capacity));
+    }
+
+    // We probe groups in a triangular sequence, which visits every group of a power-of-two sized table.
+    template<typename Callback>
+    size_t probe(unsigned hash, Callback callback) const
+    {
+        size_t position = probe_start(hash);
+        size_t stride = 0;
+        for (;;) {
+            Group group(m_controls + position);
+            if (auto result = callback(group, position); result.has_value())
+                return result.value();
+            stride += Group::width;
+            position = (position + stride) & m_capacity;
+        }
+    }
+
+    template<typename TUnaryPredicate>
+    [[nodiscard]] T* lookup_with_hash(unsigned hash, TUnaryPredicate predicate) const
+    {
+        if (is_empty())
+            return nullptr;
+
+        auto control = hash_bits_for_control(hash);
+        T* found_slot = nullptr;
+        probe(hash, [&](Group const& group, size_t position) -> Optional<size_t> {
+            for (auto matches = group.match(control); matches; matches.remove_lowest_set_bit()) {
+                auto index = (position + matches.lowest_set_bit()) & m_capacity;
+                if (predicate(m_slots[index])) {
+                    found_slot = &m_slots[index];
+                    return index;
+                }
+            }
+            // An empty slot would have been taken by the value we're looking for, so it isn't in the table.
+            if (group.match_empty())
+                return position;
+            return {};
+        });
+        return found_slot;
+    }
+
+    size_t find_first_non_full_slot(unsigned hash) const
+    {
+        return probe(hash, [&](Group const& group, size_t position) -> Optional<size_t> {
+            if (auto candidates = group.match_empty_or_deleted())
+                return (position + candidates.lowest_set_bit()) & m_capacity;
+            return {};
+        });
+    }
+
+    void delete_slot(size_t index)
+    {
+        m_slots[index].~T();
+        set_control(index, to_underlying(Control::Deleted));
+        --m_size;
+        ++m_deleted_count;
+    }
+
+    i8* m_controls { nullptr };
+    T* m_slots { nullptr };
+    size_t m_size { 0 };
+    size_t m_capacity { 0 };
+    size_t m_deleted_count { 0 };
+};
+
+}
+
+#if USING_AK_GLOBALLY
+using AK::FlatHashTable;
+#endif
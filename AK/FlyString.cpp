@@ -4,17 +4,34 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/DeprecatedFlyString.h>
 #include <AK/FlyString.h>
-#include <AK/HashMap.h>
+#include <AK/HashTable.h>
 #include <AK/Singleton.h>
 #include <AK/StringView.h>
 #include <AK/Utf8View.h>
 
 namespace AK {
 
+namespace {
+
+// Note: Short strings are never interned, so all entries point at a Detail::StringData.
+//       Keeping the hash next to it means that neither lookups nor rehashing need to touch the string itself.
+struct FlyStringTableEntry {
+    uintptr_t data { 0 };
+    unsigned hash { 0 };
+};
+
+struct FlyStringTableEntryTraits : public GenericTraits<FlyStringTableEntry> {
+    static unsigned hash(FlyStringTableEntry const& entry) { return entry.hash; }
+    static bool equals(FlyStringTableEntry const& a, FlyStringTableEntry const& b) { return a.data == b.data; }
+};
+
+}
+
 static auto& all_fly_strings()
 {
-    static Singleton<HashMap<StringView, uintptr_t>> table;
+    static Singleton<HashTable<FlyStringTableEntry, FlyStringTableEntryTraits>> table;
     return *table;
 }
 
@@ -28,11 +45,43 @@ FlyString::~FlyString()
     String::unref_fly_string_data({}, m_data);
 }
 
+Optional<FlyString> FlyString::find_interned(StringView string, unsigned hash)
+{
+    if (string.length() <= String::MAX_SHORT_STRING_BYTE_COUNT)
+        return {};
+
+    auto it = all_fly_strings().find(hash, [&](auto const& entry) {
+        return String::fly_string_data_to_string_view({}, entry.data) == string;
+    });
+    if (it == all_fly_strings().end())
+        return {};
+
+    FlyString fly_string;
+    fly_string.m_data = it->data;
+    String::ref_fly_string_data({}, fly_string.m_data);
+    return fly_string;
+}
+
 ErrorOr<FlyString> FlyString::from_utf8(StringView string)
 {
+    // Note: Anything we find has already been validated as UTF-8.
+    if (auto fly_string = find_interned(string, string.hash()); fly_string.has_value())
+        return fly_string.release_value();
     return FlyString { TRY(String::from_utf8(string)) };
 }
 
+ErrorOr<FlyString> FlyString::from_deprecated_fly_string(DeprecatedFlyString const& string)
+{
+    if (auto fly_string = find_interned(string.view(), string.hash()); fly_string.has_value())
+        return fly_string.release_value();
+    return FlyString { TRY(String::from_utf8(string.view())) };
+}
+
+DeprecatedFlyString FlyString::to_deprecated_fly_string() const
+{
+    return DeprecatedFlyString({}, bytes_as_string_view(), hash());
+}
+
 FlyString::FlyString(String const& string)
 {
     if (string.is_short_string()) {
@@ -40,14 +89,18 @@ FlyString::FlyString(String const& string)
         return;
     }
 
-    auto it = all_fly_strings().find(string.bytes_as_string_view());
+    auto data = string.to_fly_string_data({});
+    auto hash = string.hash();
+    auto it = all_fly_strings().find(hash, [&](auto const& entry) {
+        return entry.data == data || String::fly_string_data_to_string_view({}, entry.data) == string.bytes_as_string_view();
+    });
     if (it == all_fly_strings().end()) {
-        m_data = string.to_fly_string_data({});
+        m_data = data;
 
-        all_fly_strings().set(string.bytes_as_string_view(), m_data);
+        all_fly_strings().set({ m_data, hash });
         string.did_create_fly_string({});
     } else {
-        m_data = it->value;
+        m_data = it->data;
     }
 
     String::ref_fly_string_data({}, m_data);
@@ -90,7 +143,7 @@ bool FlyString::is_empty() const
 
 unsigned FlyString::hash() const
 {
-    return bytes_as_string_view().hash();
+    return String::fly_string_data_to_hash({}, m_data);
 }
 
 FlyString::operator String() const
@@ -141,9 +194,9 @@ bool FlyString::operator==(char const* string) const
     return bytes_as_string_view() == string;
 }
 
-void FlyString::did_destroy_fly_string_data(Badge<Detail::StringData>, StringView string_data)
+void FlyString::did_destroy_fly_string_data(Badge<Detail::StringData>, uintptr_t data, unsigned hash)
 {
-    all_fly_strings().remove(string_data);
+    all_fly_strings().remove({ data, hash });
 }
 
 uintptr_t FlyString::data(Badge<String>) const
@@ -158,7 +211,7 @@ size_t FlyString::number_of_fly_strings()
 
 unsigned Traits<FlyString>::hash(FlyString const& fly_string)
 {
-    return fly_string.bytes_as_string_view().hash();
+    return fly_string.hash();
 }
 
 ErrorOr<void> Formatter<FlyString>::format(FormatBuilder& builder, FlyString const& fly_string)
@@ -23,6 +23,11 @@ public:
     static ErrorOr<FlyString> from_utf8(StringView);
     explicit FlyString(String const&);
 
+    // Note: These reuse the hash that was computed when the string was interned, and only allocate if the
+    //       string hasn't been interned as the other kind of fly string yet.
+    static ErrorOr<FlyString> from_deprecated_fly_string(DeprecatedFlyString const&);
+    [[nodiscard]] DeprecatedFlyString to_deprecated_fly_string() const;
+
     FlyString(FlyString const&);
     FlyString& operator=(FlyString const&);
 
@@ -44,13 +49,15 @@ public:
     [[nodiscard]] bool operator==(StringView) const;
     [[nodiscard]] bool operator==(char const*) const;
 
-    static void did_destroy_fly_string_data(Badge<Detail::StringData>, StringView);
+    static void did_destroy_fly_string_data(Badge<Detail::StringData>, uintptr_t, unsigned hash);
     [[nodiscard]] uintptr_t data(Badge<String>) const;
 
     // This is primarily interesting to unit tests.
     [[nodiscard]] static size_t number_of_fly_strings();
 
 private:
+    static Optional<FlyString> find_interned(StringView, unsigned hash);
+
     // This will hold either the pointer to the Detail::StringData it represents or the raw bytes of
     // an inlined short string.
     uintptr_t m_data { 0 };
@@ -59,6 +66,7 @@ private:
 template<>
 struct Traits<FlyString> : public GenericTraits<FlyString> {
     static unsigned hash(FlyString const&);
+    static constexpr bool is_trivially_relocatable() { return true; }
 };
 
 template<>
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BuiltinWrappers.h>
 #include <AK/CharacterTypes.h>
 #include <AK/Format.h>
 #include <AK/GenericLexer.h>
@@ -19,6 +20,7 @@
 #    include <Kernel/Process.h>
 #    include <Kernel/Thread.h>
 #else
+#    include <AK/StringFloatingPointConversions.h>
 #    include <math.h>
 #    include <stdio.h>
 #    include <string.h>
@@ -45,6 +47,9 @@ namespace {
 
 static constexpr size_t use_next_index = NumericLimits<size_t>::max();
 
+// Every number from 00 to 99, so that decimal numbers can be converted two digits at a time.
+static constexpr char const* decimal_digit_pairs = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
 // The worst case is that we have the largest 64-bit value formatted as binary number, this would take
 // 65 bytes. Choosing a larger power of two won't hurt and is a bit of mitigation against out-of-bounds accesses.
 static constexpr size_t convert_unsigned_to_string(u64 value, Array<u8, 128>& buffer, u8 base, bool upper_case)
@@ -53,24 +58,40 @@ static constexpr size_t convert_unsigned_to_string(u64 value, Array<u8, 128>& bu
 
     constexpr char const* lowercase_lookup = "0123456789abcdef";
     constexpr char const* uppercase_lookup = "0123456789ABCDEF";
-
-    if (value == 0) {
-        buffer[0] = '0';
-        return 1;
-    }
-
-    size_t used = 0;
-    while (value > 0) {
-        if (upper_case)
-            buffer[used++] = uppercase_lookup[value % base];
-        else
-            buffer[used++] = lowercase_lookup[value % base];
-
-        value /= base;
+    auto const* lookup = upper_case ? uppercase_lookup : lowercase_lookup;
+
+    // Note: The digits are written back to front from the end of the buffer, and moved to the front afterwards.
+    size_t position = buffer.size();
+    if (base == 10) {
+        while (value >= 100) {
+            auto pair = (value % 100) * 2;
+            value /= 100;
+            buffer[--position] = decimal_digit_pairs[pair + 1];
+            buffer[--position] = decimal_digit_pairs[pair];
+        }
+        if (value >= 10) {
+            buffer[--position] = decimal_digit_pairs[value * 2 + 1];
+            buffer[--position] = decimal_digit_pairs[value * 2];
+        } else {
+            buffer[--position] = '0' + value;
+        }
+    } else if ((base & (base - 1)) == 0) {
+        auto const shift = count_trailing_zeroes(base);
+        auto const mask = base - 1u;
+        do {
+            buffer[--position] = lookup[value & mask];
+            value >>= shift;
+        } while (value > 0);
+    } else {
+        do {
+            buffer[--position] = lookup[value % base];
+            value /= base;
+        } while (value > 0);
     }
 
-    for (size_t i = 0; i < used / 2; ++i)
-        swap(buffer[i], buffer[used - i - 1]);
+    auto const used = buffer.size() - position;
+    for (size_t i = 0; i < used; ++i)
+        buffer[i] = buffer[position + i];
 
     return used;
 }
@@ -191,9 +212,7 @@ bool FormatParser::consume_replacement_field(size_t& index)
 
 ErrorOr<void> FormatBuilder::put_padding(char fill, size_t amount)
 {
-    for (size_t i = 0; i < amount; ++i)
-        TRY(m_builder.try_append(fill));
-    return {};
+    return m_builder.try_append_repeated(fill, amount);
 }
 ErrorOr<void> FormatBuilder::put_literal(StringView value)
 {
@@ -303,9 +322,7 @@ ErrorOr<void> FormatBuilder::put_u64(
     };
 
     auto const put_digits = [&]() -> ErrorOr<void> {
-        for (size_t i = 0; i < used_by_digits; ++i)
-            TRY(m_builder.try_append(buffer[i]));
-        return {};
+        return m_builder.try_append(StringView { buffer.data(), used_by_digits });
     };
 
     if (align == Align::Left) {
@@ -467,6 +484,47 @@ ErrorOr<void> FormatBuilder::put_f64(
     if (is_negative)
         value = -value;
 
+    if (base == 10) {
+        // Note: Most numbers that get formatted have a short decimal representation. If the shortest one that round-trips
+        //       fits into the requested precision, we can print its digits as they are, without any further arithmetic.
+        auto const [sign, fraction, exponent] = convert_floating_point_to_decimal_exponential_form(value);
+        size_t const fractional_digits = exponent < 0 ? static_cast<size_t>(-exponent) : 0;
+        if (fractional_digits <= precision) {
+            Array<u8, 128> buffer;
+            auto const digit_count = convert_unsigned_to_string(fraction, buffer, 10, false);
+            StringView const digits { buffer.data(), digit_count };
+
+            if (is_negative)
+                TRY(string_builder.try_append('-'));
+            else if (sign_mode == SignMode::Always)
+                TRY(string_builder.try_append('+'));
+            else if (sign_mode == SignMode::Reserved)
+                TRY(string_builder.try_append(' '));
+
+            if (exponent >= 0) {
+                TRY(string_builder.try_append(digits));
+                TRY(string_builder.try_append_repeated('0', exponent));
+            } else if (digit_count > fractional_digits) {
+                TRY(string_builder.try_append(digits.substring_view(0, digit_count - fractional_digits)));
+            } else {
+                TRY(string_builder.try_append('0'));
+            }
+
+            bool const pad_with_zeroes = zero_pad || display_mode == RealNumberDisplayMode::FixedPoint;
+            if (fractional_digits > 0 || (pad_with_zeroes && precision > 0)) {
+                TRY(string_builder.try_append('.'));
+                if (fractional_digits > digit_count)
+                    TRY(string_builder.try_append_repeated('0', fractional_digits - digit_count));
+                TRY(string_builder.try_append(digits.substring_view(digit_count - min(digit_count, fractional_digits))));
+                if (pad_with_zeroes)
+                    TRY(string_builder.try_append_repeated('0', precision - fractional_digits));
+            }
+
+            TRY(put_string(string_builder.string_view(), align, min_width, NumericLimits<size_t>::max(), fill));
+            return {};
+        }
+    }
+
     TRY(format_builder.put_u64(static_cast<u64>(value), base, false, upper_case, false, Align::Right, 0, ' ', sign_mode, is_negative));
 
     if (precision > 0) {
@@ -79,18 +79,26 @@ class CircularQueue;
 template<typename T>
 struct Traits;
 
-template<typename T, typename TraitsForT = Traits<T>, bool IsOrdered = false>
+struct DefaultAllocator;
+
+template<typename T, typename TraitsForT = Traits<T>, bool IsOrdered = false, typename Allocator = DefaultAllocator>
 class HashTable;
 
 template<typename T, typename TraitsForT = Traits<T>>
 using OrderedHashTable = HashTable<T, TraitsForT, true>;
 
-template<typename K, typename V, typename KeyTraits = Traits<K>, typename ValueTraits = Traits<V>, bool IsOrdered = false>
+template<typename T, typename TraitsForT = Traits<T>>
+class FlatHashTable;
+
+template<typename K, typename V, typename KeyTraits = Traits<K>, typename ValueTraits = Traits<V>, bool IsOrdered = false, bool IsFlat = false, typename Allocator = DefaultAllocator>
 class HashMap;
 
 template<typename K, typename V, typename KeyTraits = Traits<K>, typename ValueTraits = Traits<V>>
 using OrderedHashMap = HashMap<K, V, KeyTraits, ValueTraits, true>;
 
+template<typename K, typename V, typename KeyTraits = Traits<K>, typename ValueTraits = Traits<V>>
+using FlatHashMap = HashMap<K, V, KeyTraits, ValueTraits, false, true>;
+
 template<typename T>
 class Badge;
 
@@ -144,7 +152,7 @@ class OwnPtr;
 template<typename T>
 class WeakPtr;
 
-template<typename T, size_t inline_capacity = 0>
+template<typename T, size_t inline_capacity = 0, typename Allocator = DefaultAllocator>
 requires(!IsRvalueReference<T>) class Vector;
 
 template<typename T, typename ErrorType = Error>
@@ -177,6 +185,8 @@ using AK::FixedArray;
 using AK::FixedPoint;
 using AK::Function;
 using AK::GenericLexer;
+using AK::FlatHashMap;
+using AK::FlatHashTable;
 using AK::HashMap;
 using AK::HashTable;
 using AK::IPv4Address;
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/FlatHashTable.h>
 #include <AK/HashTable.h>
 #include <AK/Optional.h>
 #include <AK/Vector.h>
@@ -13,8 +14,11 @@
 
 namespace AK {
 
-template<typename K, typename V, typename KeyTraits, typename ValueTraits, bool IsOrdered>
+template<typename K, typename V, typename KeyTraits, typename ValueTraits, bool IsOrdered, bool IsFlat, typename Allocator>
 class HashMap {
+    static_assert(!IsOrdered || !IsFlat, "FlatHashTable doesn't keep track of insertion order");
+    static_assert(!IsFlat || IsSame<Allocator, DefaultAllocator>, "FlatHashTable doesn't support custom allocators");
+
 private:
     struct Entry {
         K key;
@@ -32,6 +36,11 @@ public:
 
     HashMap() = default;
 
+    explicit HashMap(Allocator allocator)
+        : m_table(move(allocator))
+    {
+    }
+
     HashMap(std::initializer_list<Entry> list)
     {
         MUST(try_ensure_capacity(list.size()));
@@ -84,7 +93,7 @@ public:
         });
     }
 
-    using HashTableType = HashTable<Entry, EntryTraits, IsOrdered>;
+    using HashTableType = Conditional<IsFlat, FlatHashTable<Entry, EntryTraits>, HashTable<Entry, EntryTraits, IsOrdered, Allocator>>;
     using IteratorType = typename HashTableType::Iterator;
     using ConstIteratorType = typename HashTableType::ConstIterator;
 
@@ -287,6 +296,7 @@ private:
 }
 
 #if USING_AK_GLOBALLY
+using AK::FlatHashMap;
 using AK::HashMap;
 using AK::OrderedHashMap;
 #endif
@@ -6,12 +6,14 @@
 
 #pragma once
 
+#include <AK/Allocator.h>
 #include <AK/Concepts.h>
 #include <AK/Error.h>
 #include <AK/Forward.h>
 #include <AK/HashFunctions.h>
 #include <AK/StdLibExtras.h>
 #include <AK/Traits.h>
+#include <AK/TypedTransfer.h>
 #include <AK/Types.h>
 #include <AK/kmalloc.h>
 
@@ -106,7 +108,7 @@ private:
     BucketType* m_bucket { nullptr };
 };
 
-template<typename T, typename TraitsForT, bool IsOrdered>
+template<typename T, typename TraitsForT, bool IsOrdered, typename Allocator>
 class HashTable {
     static constexpr size_t load_factor_in_percent = 60;
 
@@ -143,6 +145,11 @@ public:
     HashTable() = default;
     explicit HashTable(size_t capacity) { rehash(capacity); }
 
+    explicit HashTable(Allocator allocator)
+        : m_allocator(move(allocator))
+    {
+    }
+
     ~HashTable()
     {
         if (!m_buckets)
@@ -153,10 +160,11 @@ public:
                 m_buckets[i].slot()->~T();
         }
 
-        kfree_sized(m_buckets, size_in_bytes(m_capacity));
+        m_allocator.deallocate(m_buckets, size_in_bytes(m_capacity));
     }
 
     HashTable(HashTable const& other)
+        : m_allocator(other.m_allocator)
     {
         rehash(other.capacity());
         for (auto& it : other)
@@ -176,6 +184,7 @@ public:
         , m_size(other.m_size)
         , m_capacity(other.m_capacity)
         , m_deleted_count(other.m_deleted_count)
+        , m_allocator(other.m_allocator)
     {
         other.m_size = 0;
         other.m_capacity = 0;
@@ -198,6 +207,7 @@ public:
         swap(a.m_size, b.m_size);
         swap(a.m_capacity, b.m_capacity);
         swap(a.m_deleted_count, b.m_deleted_count);
+        swap(a.m_allocator, b.m_allocator);
 
         if constexpr (IsOrdered)
             swap(a.m_collection_data, b.m_collection_data);
@@ -206,6 +216,7 @@ public:
     [[nodiscard]] bool is_empty() const { return m_size == 0; }
     [[nodiscard]] size_t size() const { return m_size; }
     [[nodiscard]] size_t capacity() const { return m_capacity; }
+    [[nodiscard]] Allocator const& allocator() const { return m_allocator; }
 
     template<typename U, size_t N>
     ErrorOr<void> try_set_from(U (&from_array)[N])
@@ -287,7 +298,7 @@ public:
 
     void clear()
     {
-        *this = HashTable();
+        *this = HashTable(m_allocator);
     }
     void clear_with_capacity()
     {
@@ -461,10 +472,11 @@ public:
     }
 
 private:
-    void insert_during_rehash(T&& value)
+    // Moves the value into its new bucket and destroys the original.
+    void relocate_during_rehash(T& value)
     {
         auto& bucket = lookup_for_writing(value);
-        new (bucket.slot()) T(move(value));
+        TypedTransfer<T>::relocate(bucket.slot(), &value, 1);
         bucket.state = BucketState::Used;
 
         if constexpr (IsOrdered) {
@@ -495,15 +507,16 @@ private:
         }
 
         new_capacity = max(new_capacity, static_cast<size_t>(4));
-        new_capacity = kmalloc_good_size(new_capacity * sizeof(BucketType)) / sizeof(BucketType);
+        new_capacity = m_allocator.good_size(new_capacity * sizeof(BucketType)) / sizeof(BucketType);
 
         auto* old_buckets = m_buckets;
         auto old_capacity = m_capacity;
         Iterator old_iter = begin();
 
-        auto* new_buckets = kcalloc(1, size_in_bytes(new_capacity));
+        auto* new_buckets = m_allocator.allocate(size_in_bytes(new_capacity), alignof(BucketType));
         if (!new_buckets)
             return Error::from_errno(ENOMEM);
+        __builtin_memset(new_buckets, 0, size_in_bytes(new_capacity));
 
         m_buckets = (BucketType*)new_buckets;
 
@@ -518,12 +531,10 @@ private:
         if (!old_buckets)
             return {};
 
-        for (auto it = move(old_iter); it != end(); ++it) {
-            insert_during_rehash(move(*it));
-            it->~T();
-        }
+        for (auto it = move(old_iter); it != end(); ++it)
+            relocate_during_rehash(*it);
 
-        kfree_sized(old_buckets, size_in_bytes(old_capacity));
+        m_allocator.deallocate(old_buckets, size_in_bytes(old_capacity));
         return {};
     }
     void rehash(size_t new_capacity)
@@ -575,7 +586,7 @@ private:
 
                 if (is_free_bucket(target_bucket->state)) {
                     // We can just overwrite the target bucket and bail out.
-                    new (target_bucket->slot()) T(move(*bucket_to_move->slot()));
+                    TypedTransfer<T>::relocate(target_bucket->slot(), bucket_to_move->slot(), 1);
                     target_bucket->state = BucketState::Rehashed;
                     bucket_to_move->state = BucketState::Free;
 
@@ -739,6 +750,7 @@ private:
     size_t m_size { 0 };
     size_t m_capacity { 0 };
     size_t m_deleted_count { 0 };
+    [[no_unique_address]] Allocator m_allocator;
 };
 }
 
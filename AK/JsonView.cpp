@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BuiltinWrappers.h>
+#include <AK/CharacterTypes.h>
+#include <AK/FloatingPointStringConversions.h>
+#include <AK/JsonParser.h>
+#include <AK/JsonView.h>
+#include <AK/NumericLimits.h>
+#include <AK/SIMD.h>
+
+namespace AK {
+
+namespace {
+
+constexpr size_t block_size = 64;
+constexpr u64 odd_bits = 0xAAAAAAAAAAAAAAAA;
+
+// One bit per byte of a block, for each kind of character we care about.
+struct BlockMasks {
+    u64 quote { 0 };
+    u64 backslash { 0 };
+    u64 operators { 0 };
+    u64 whitespace { 0 };
+};
+
+#if defined(__SSE2__)
+ALWAYS_INLINE u64 to_bit_mask(SIMD::i8x16 comparison)
+{
+    return static_cast<u32>(__builtin_ia32_pmovmskb128(reinterpret_cast<SIMD::c8x16>(comparison)));
+}
+
+ALWAYS_INLINE SIMD::u8x16 splat(u8 value)
+{
+    return SIMD::u8x16 { value, value, value, value, value, value, value, value, value, value, value, value, value, value, value, value };
+}
+
+BlockMasks classify_block(u8 const* block)
+{
+    BlockMasks masks;
+    for (size_t i = 0; i < block_size / 16; ++i) {
+        SIMD::u8x16 chunk;
+        __builtin_memcpy(&chunk, block + i * 16, sizeof(chunk));
+        auto shift = i * 16;
+        masks.quote |= to_bit_mask(chunk == splat('"')) << shift;
+        masks.backslash |= to_bit_mask(chunk == splat('\\')) << shift;
+        masks.operators |= to_bit_mask((chunk == splat('{')) | (chunk == splat('}')) | (chunk == splat('[')) | (chunk == splat(']')) | (chunk == splat(':')) | (chunk == splat(','))) << shift;
+        masks.whitespace |= to_bit_mask((chunk == splat(' ')) | (chunk == splat('\n')) | (chunk == splat('\r')) | (chunk == splat('\t'))) << shift;
+    }
+    return masks;
+}
+#else
+BlockMasks classify_block(u8 const* block)
+{
+    BlockMasks masks;
+    for (size_t i = 0; i < block_size; ++i) {
+        u64 bit = 1ull << i;
+        switch (block[i]) {
+        case '"':
+            masks.quote |= bit;
+            break;
+        case '\\':
+            masks.backslash |= bit;
+            break;
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ':':
+        case ',':
+            masks.operators |= bit;
+            break;
+        case ' ':
+        case '\n':
+        case '\r':
+        case '\t':
+            masks.whitespace |= bit;
+            break;
+        }
+    }
+    return masks;
+}
+#endif
+
+// Every bit is set to the XOR of itself and all bits below it, which turns the positions of quotes into string regions.
+u64 prefix_xor(u64 bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+}
+
+ErrorOr<JsonDocument> JsonDocument::parse(StringView input)
+{
+    if (input.length() >= NumericLimits<u32>::max())
+        return Error::from_string_literal("JsonDocument: Input is too large");
+
+    JsonDocument document(input);
+    TRY(document.find_structural_positions());
+    TRY(document.match_brackets());
+    return document;
+}
+
+// This is the first stage of the approach taken by simdjson (https://arxiv.org/abs/1902.08318), without the fancy
+// carry-less multiplication. We look at blocks of 64 bytes at once, and keep track of what carries over between them.
+ErrorOr<void> JsonDocument::find_structural_positions()
+{
+    TRY(m_positions.try_ensure_capacity(m_input.length() / 8));
+
+    auto const* input = reinterpret_cast<u8 const*>(m_input.characters_without_null_termination());
+    u64 previous_is_escaped = 0;
+    u64 previous_in_string = 0;
+    u64 previous_is_scalar = 0;
+
+    for (size_t offset = 0; offset < m_input.length(); offset += block_size) {
+        BlockMasks masks;
+        if (m_input.length() - offset >= block_size) {
+            masks = classify_block(input + offset);
+        } else {
+            u8 last_block[block_size];
+            __builtin_memset(last_block, ' ', block_size);
+            __builtin_memcpy(last_block, input + offset, m_input.length() - offset);
+            masks = classify_block(last_block);
+        }
+
+        // Find the characters following an odd number of backslashes. Subtracting the starts of runs of backslashes
+        // from the odd bits carries into the character after each run, while flipping the bits of every second one.
+        u64 escaped = previous_is_escaped;
+        if (masks.backslash) {
+            u64 potential_escape = masks.backslash & ~previous_is_escaped;
+            u64 maybe_escaped = potential_escape << 1;
+            u64 escape_and_terminal_code = ((maybe_escaped | odd_bits) - potential_escape) ^ odd_bits;
+            escaped = escape_and_terminal_code ^ (masks.backslash | previous_is_escaped);
+            previous_is_escaped = (escape_and_terminal_code & masks.backslash) >> 63;
+        } else {
+            previous_is_escaped = 0;
+        }
+
+        // The mask of string regions includes opening quotes, but not closing ones.
+        u64 quotes = masks.quote & ~escaped;
+        u64 in_string = prefix_xor(quotes) ^ previous_in_string;
+        previous_in_string = static_cast<u64>(static_cast<i64>(in_string) >> 63);
+
+        // Anything else outside of strings is part of a number, true, false, or null, and we only want their first characters.
+        u64 scalars = ~(masks.operators | masks.whitespace | quotes) & ~in_string;
+        u64 scalar_starts = scalars & ~((scalars << 1) | previous_is_scalar);
+        previous_is_scalar = scalars >> 63;
+
+        u64 structurals = (masks.operators & ~in_string) | (quotes & in_string) | scalar_starts;
+        // Note: Ignore the spaces we padded the last block with.
+        if (m_input.length() - offset < block_size)
+            structurals &= (1ull << (m_input.length() - offset)) - 1;
+
+        while (structurals) {
+            TRY(m_positions.try_append(offset + count_trailing_zeroes(structurals)));
+            structurals &= structurals - 1;
+        }
+    }
+
+    if (previous_in_string)
+        return Error::from_string_literal("JsonDocument: Unterminated string");
+    if (m_positions.is_empty())
+        return Error::from_string_literal("JsonDocument: No value");
+    return {};
+}
+
+// The second stage checks that the structural characters are in a valid order, and remembers where arrays and objects end.
+ErrorOr<void> JsonDocument::match_brackets()
+{
+    enum class Expecting {
+        Value,
+        ValueOrEndOfArray,
+        Key,
+        KeyOrEndOfObject,
+        Colon,
+        CommaOrEnd,
+    };
+
+    TRY(m_matching_bracket.try_resize(m_positions.size()));
+
+    Vector<u32, 32> open_brackets;
+    auto expecting = Expecting::Value;
+
+    for (size_t i = 0; i < m_positions.size(); ++i) {
+        auto character = character_at(i);
+        auto is_closing_bracket = character == ']' || character == '}';
+
+        if (is_closing_bracket && (expecting == Expecting::ValueOrEndOfArray || expecting == Expecting::KeyOrEndOfObject || expecting == Expecting::CommaOrEnd)) {
+            if (open_brackets.is_empty() || (character == ']') != (character_at(open_brackets.last()) == '['))
+                return Error::from_string_literal("JsonDocument: Mismatched bracket");
+            if ((expecting == Expecting::ValueOrEndOfArray && character != ']') || (expecting == Expecting::KeyOrEndOfObject && character != '}'))
+                return Error::from_string_literal("JsonDocument: Mismatched bracket");
+            m_matching_bracket[open_brackets.take_last()] = i;
+            expecting = Expecting::CommaOrEnd;
+            continue;
+        }
+
+        switch (expecting) {
+        case Expecting::Value:
+        case Expecting::ValueOrEndOfArray:
+            if (character == '[' || character == '{') {
+                TRY(open_brackets.try_append(i));
+                expecting = character == '[' ? Expecting::ValueOrEndOfArray : Expecting::KeyOrEndOfObject;
+            } else if (character == ':' || character == ',' || is_closing_bracket) {
+                return Error::from_string_literal("JsonDocument: Expected value");
+            } else {
+                expecting = Expecting::CommaOrEnd;
+            }
+            break;
+        case Expecting::Key:
+        case Expecting::KeyOrEndOfObject:
+            if (character != '"')
+                return Error::from_string_literal("JsonDocument: Expected key");
+            expecting = Expecting::Colon;
+            break;
+        case Expecting::Colon:
+            if (character != ':')
+                return Error::from_string_literal("JsonDocument: Expected ':'");
+            expecting = Expecting::Value;
+            break;
+        case Expecting::CommaOrEnd:
+            if (character != ',' || open_brackets.is_empty())
+                return Error::from_string_literal("JsonDocument: Unexpected character after value");
+            expecting = character_at(open_brackets.last()) == '[' ? Expecting::Value : Expecting::Key;
+            break;
+        }
+    }
+
+    if (!open_brackets.is_empty() || expecting != Expecting::CommaOrEnd)
+        return Error::from_string_literal("JsonDocument: Unexpected end of input");
+    return {};
+}
+
+size_t JsonView::next_index(size_t index) const
+{
+    auto character = m_document->character_at(index);
+    if (character == '[' || character == '{')
+        index = m_document->m_matching_bracket[index];
+    ++index;
+    if (m_document->character_at(index) == ',')
+        ++index;
+    return index;
+}
+
+StringView JsonView::raw_value() const
+{
+    auto start = m_document->m_positions[m_index];
+    if (is_array() || is_object())
+        return m_document->m_input.substring_view(start, m_document->m_positions[m_document->m_matching_bracket[m_index]] - start + 1);
+
+    // Strings and other values end before whatever comes next, minus any whitespace.
+    size_t end = m_index + 1 < m_document->m_positions.size() ? m_document->m_positions[m_index + 1] : m_document->m_input.length();
+    while (end > start && is_ascii_space(m_document->m_input[end - 1]))
+        --end;
+    return m_document->m_input.substring_view(start, end - start);
+}
+
+Optional<bool> JsonView::as_bool() const
+{
+    auto value = raw_value();
+    if (value == "true"sv)
+        return true;
+    if (value == "false"sv)
+        return false;
+    return {};
+}
+
+Optional<double> JsonView::as_double() const
+{
+    if (!is_number())
+        return {};
+    auto value = raw_value();
+    auto const* end = value.characters_without_null_termination() + value.length();
+    auto result = parse_first_floating_point<double>(value.characters_without_null_termination(), end);
+    if (!result.parsed_value() || result.end_ptr != end)
+        return {};
+    return result.value;
+}
+
+Optional<StringView> JsonView::as_raw_string() const
+{
+    if (!is_string())
+        return {};
+    auto value = raw_value();
+    if (value.length() < 2 || value[value.length() - 1] != '"')
+        return {};
+    return value.substring_view(1, value.length() - 2);
+}
+
+Optional<DeprecatedString> JsonView::as_deprecated_string() const
+{
+    auto string = as_raw_string();
+    if (!string.has_value())
+        return {};
+    if (!string->contains('\\'))
+        return DeprecatedString(*string);
+
+    // Strings with escape sequences are rare enough to not bother decoding them ourselves.
+    auto parsed = JsonParser(raw_value()).parse();
+    if (parsed.is_error() || !parsed.value().is_string())
+        return {};
+    return parsed.value().as_string();
+}
+
+size_t JsonView::size() const
+{
+    size_t size = 0;
+    if (is_array())
+        for_each([&](auto) { ++size; return IterationDecision::Continue; });
+    else if (is_object())
+        for_each_member([&](auto, auto) { ++size; return IterationDecision::Continue; });
+    return size;
+}
+
+Optional<JsonView> JsonView::get(StringView key) const
+{
+    Optional<JsonView> result;
+    for_each_member([&](StringView member_key, JsonView value) {
+        if (member_key == key || (member_key.contains('\\') && JsonView(*m_document, value.m_index - 2).as_deprecated_string() == key)) {
+            result = value;
+            return IterationDecision::Break;
+        }
+        return IterationDecision::Continue;
+    });
+    return result;
+}
+
+Optional<JsonView> JsonView::get_matching(StringView key, bool (JsonView::*predicate)() const) const
+{
+    auto value = get(key);
+    if (!value.has_value() || !(value.value().*predicate)())
+        return {};
+    return value;
+}
+
+Optional<bool> JsonView::get_bool(StringView key) const
+{
+    if (auto value = get(key); value.has_value())
+        return value->as_bool();
+    return {};
+}
+
+Optional<double> JsonView::get_double(StringView key) const
+{
+    if (auto value = get(key); value.has_value())
+        return value->as_double();
+    return {};
+}
+
+Optional<DeprecatedString> JsonView::get_deprecated_string(StringView key) const
+{
+    if (auto value = get(key); value.has_value())
+        return value->as_deprecated_string();
+    return {};
+}
+
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/DeprecatedString.h>
+#include <AK/Error.h>
+#include <AK/IterationDecision.h>
+#include <AK/Optional.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+
+namespace AK {
+
+class JsonView;
+
+// JsonDocument reads JSON on demand, without building a tree of JsonValues first.
+// Parsing only finds the positions of the structural characters ({}[]:,), strings and other values in the input,
+// a block of 64 bytes at a time. Values are then decoded when (and if) they are looked at through a JsonView.
+// Note: The document doesn't copy the input, so the input needs to outlive it and all of its views.
+class JsonDocument {
+public:
+    static ErrorOr<JsonDocument> parse(StringView input);
+
+    JsonView root() const;
+
+private:
+    friend class JsonView;
+
+    JsonDocument(StringView input)
+        : m_input(input)
+    {
+    }
+
+    ErrorOr<void> find_structural_positions();
+    ErrorOr<void> match_brackets();
+
+    char character_at(size_t index) const { return m_input[m_positions[index]]; }
+
+    StringView m_input;
+
+    // The positions of all structural characters, opening quotes, and first characters of other values.
+    Vector<u32> m_positions;
+
+    // For each opening bracket in m_positions, the index of the matching closing bracket.
+    Vector<u32> m_matching_bracket;
+};
+
+class JsonView {
+public:
+    bool is_null() const { return character() == 'n'; }
+    bool is_bool() const { return character() == 't' || character() == 'f'; }
+    bool is_string() const { return character() == '"'; }
+    bool is_number() const { return character() == '-' || (character() >= '0' && character() <= '9'); }
+    bool is_array() const { return character() == '['; }
+    bool is_object() const { return character() == '{'; }
+
+    Optional<bool> as_bool() const;
+    Optional<double> as_double() const;
+
+    template<Integral T>
+    Optional<T> as_integer() const
+    {
+        if (!is_number())
+            return {};
+        if constexpr (IsSigned<T>)
+            return raw_value().to_int<T>();
+        else
+            return raw_value().to_uint<T>();
+    }
+
+    // The text of a string without the quotes, with escape sequences left as-is.
+    Optional<StringView> as_raw_string() const;
+    Optional<DeprecatedString> as_deprecated_string() const;
+
+    // The text making up this value in the input, including any quotes and brackets.
+    StringView raw_value() const;
+
+    // The number of items of an array, or members of an object.
+    size_t size() const;
+
+    template<typename Callback>
+    void for_each(Callback callback) const
+    {
+        if (!is_array())
+            return;
+        for (auto index = m_index + 1; m_document->character_at(index) != ']';) {
+            if (callback(JsonView(*m_document, index)) == IterationDecision::Break)
+                return;
+            index = next_index(index);
+        }
+    }
+
+    // The callback gets passed the raw text of each key, like as_raw_string() would return it.
+    template<typename Callback>
+    void for_each_member(Callback callback) const
+    {
+        if (!is_object())
+            return;
+        for (auto index = m_index + 1; m_document->character_at(index) != '}';) {
+            auto value_index = index + 2;
+            if (callback(JsonView(*m_document, index).as_raw_string().value(), JsonView(*m_document, value_index)) == IterationDecision::Break)
+                return;
+            index = next_index(value_index);
+        }
+    }
+
+    Optional<JsonView> get(StringView key) const;
+
+    Optional<JsonView> get_array(StringView key) const { return get_matching(key, &JsonView::is_array); }
+    Optional<JsonView> get_object(StringView key) const { return get_matching(key, &JsonView::is_object); }
+    Optional<bool> get_bool(StringView key) const;
+    Optional<double> get_double(StringView key) const;
+    Optional<DeprecatedString> get_deprecated_string(StringView key) const;
+
+    template<Integral T>
+    Optional<T> get_integer(StringView key) const
+    {
+        if (auto value = get(key); value.has_value())
+            return value->as_integer<T>();
+        return {};
+    }
+    Optional<i32> get_i32(StringView key) const { return get_integer<i32>(key); }
+    Optional<u32> get_u32(StringView key) const { return get_integer<u32>(key); }
+    Optional<i64> get_i64(StringView key) const { return get_integer<i64>(key); }
+    Optional<u64> get_u64(StringView key) const { return get_integer<u64>(key); }
+
+private:
+    friend class JsonDocument;
+
+    JsonView(JsonDocument const& document, size_t index)
+        : m_document(&document)
+        , m_index(index)
+    {
+    }
+
+    char character() const { return m_document->character_at(m_index); }
+
+    // Returns the index of whatever follows the value at the given index, skipping over a trailing comma.
+    size_t next_index(size_t index) const;
+
+    Optional<JsonView> get_matching(StringView key, bool (JsonView::*predicate)() const) const;
+
+    JsonDocument const* m_document { nullptr };
+    size_t m_index { 0 };
+};
+
+inline JsonView JsonDocument::root() const
+{
+    return JsonView(*this, 0);
+}
+
+}
+
+#if USING_AK_GLOBALLY
+using AK::JsonDocument;
+using AK::JsonView;
+#endif
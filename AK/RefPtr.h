@@ -299,6 +299,7 @@ struct Traits<RefPtr<T>> : public GenericTraits<RefPtr<T>> {
     using ConstPeekType = T const*;
     static unsigned hash(RefPtr<T> const& p) { return ptr_hash(p.ptr()); }
     static bool equals(RefPtr<T> const& a, RefPtr<T> const& b) { return a.ptr() == b.ptr(); }
+    static constexpr bool is_trivially_relocatable() { return true; }
 };
 
 template<typename T, typename U>
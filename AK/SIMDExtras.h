@@ -98,6 +98,33 @@ ALWAYS_INLINE static int maskcount(i32x4 mask)
     return count_lut[maskbits(mask)];
 }
 
+ALWAYS_INLINE static i32 maskbits(i8x16 mask)
+{
+#if defined(__SSE2__)
+    return __builtin_ia32_pmovmskb128((c8x16)mask);
+#else
+    i32 bits = 0;
+    for (int i = 0; i < 16; ++i)
+        bits |= ((mask[i] & 0x80) >> 7) << i;
+    return bits;
+#endif
+}
+
+ALWAYS_INLINE static bool all(i8x16 mask)
+{
+    return maskbits(mask) == 0xFFFF;
+}
+
+ALWAYS_INLINE static bool any(i8x16 mask)
+{
+    return maskbits(mask) != 0;
+}
+
+ALWAYS_INLINE static bool none(i8x16 mask)
+{
+    return maskbits(mask) == 0;
+}
+
 // Load / Store
 
 ALWAYS_INLINE static f32x4 load4(float const* a, float const* b, float const* c, float const* d)
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Noncopyable.h>
+#include <AK/Stream.h>
+#include <AK/StringBuilder.h>
+
+namespace AK {
+
+// A builder that writes everything appended to it into a stream, so that large outputs (for example of
+// JsonObjectSerializer and JsonArraySerializer) never have to be held in memory in full.
+// Note: Anything still buffered when the builder is destroyed is written out, but errors can only be seen
+//       by calling flush() first.
+class StreamBuilder {
+    AK_MAKE_NONCOPYABLE(StreamBuilder);
+    AK_MAKE_NONMOVABLE(StreamBuilder);
+
+public:
+    static constexpr size_t flush_threshold = 4 * KiB;
+
+    explicit StreamBuilder(Stream& stream)
+        : m_stream(stream)
+    {
+    }
+
+    ~StreamBuilder()
+    {
+        (void)flush();
+    }
+
+    ErrorOr<void> append(char character)
+    {
+        TRY(m_buffer.try_append(character));
+        return flush_if_needed();
+    }
+
+    ErrorOr<void> append(StringView string)
+    {
+        if (string.length() >= flush_threshold) {
+            TRY(flush());
+            return m_stream.write_entire_buffer(string.bytes());
+        }
+        TRY(m_buffer.try_append(string));
+        return flush_if_needed();
+    }
+
+    ErrorOr<void> append_escaped_for_json(StringView string)
+    {
+        TRY(m_buffer.try_append_escaped_for_json(string));
+        return flush_if_needed();
+    }
+
+    template<typename... Parameters>
+    ErrorOr<void> appendff(CheckedFormatString<Parameters...>&& fmtstr, Parameters const&... parameters)
+    {
+        AK::VariadicFormatParams<AK::AllowDebugOnlyFormatters::No, Parameters...> variadic_format_params { parameters... };
+        TRY(vformat(m_buffer, fmtstr.view(), variadic_format_params));
+        return flush_if_needed();
+    }
+
+    ErrorOr<void> flush()
+    {
+        if (m_buffer.is_empty())
+            return {};
+        auto result = m_stream.write_entire_buffer(m_buffer.string_view().bytes());
+        // Note: Unlike clear(), this keeps the buffer's capacity around for the next round.
+        m_buffer.trim(m_buffer.length());
+        return result;
+    }
+
+private:
+    ErrorOr<void> flush_if_needed()
+    {
+        if (m_buffer.length() < flush_threshold)
+            return {};
+        return flush();
+    }
+
+    Stream& m_stream;
+    StringBuilder m_buffer { flush_threshold };
+};
+
+}
+
+#if USING_AK_GLOBALLY
+using AK::StreamBuilder;
+#endif
@@ -202,6 +202,7 @@ public:
 
     [[nodiscard]] static String fly_string_data_to_string(Badge<FlyString>, uintptr_t const&);
     [[nodiscard]] static StringView fly_string_data_to_string_view(Badge<FlyString>, uintptr_t const&);
+    [[nodiscard]] static u32 fly_string_data_to_hash(Badge<FlyString>, uintptr_t const&);
     [[nodiscard]] uintptr_t to_fly_string_data(Badge<FlyString>) const;
 
     static void ref_fly_string_data(Badge<FlyString>, uintptr_t);
@@ -248,6 +249,7 @@ private:
 template<>
 struct Traits<String> : public GenericTraits<String> {
     static unsigned hash(String const&);
+    static constexpr bool is_trivially_relocatable() { return true; }
 };
 
 template<>
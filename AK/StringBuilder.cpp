@@ -66,8 +66,9 @@ ErrorOr<void> StringBuilder::try_append(char ch)
 ErrorOr<void> StringBuilder::try_append_repeated(char ch, size_t n)
 {
     TRY(will_append(n));
-    for (size_t i = 0; i < n; ++i)
-        TRY(try_append(ch));
+    auto const old_size = m_buffer.size();
+    TRY(m_buffer.try_resize(old_size + n));
+    __builtin_memset(m_buffer.data() + old_size, ch, n);
     return {};
 }
 
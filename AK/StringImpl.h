@@ -80,6 +80,12 @@ public:
     bool is_fly() const { return m_fly; }
     void set_fly(Badge<DeprecatedFlyString>, bool fly) const { m_fly = fly; }
 
+    void set_precomputed_hash(Badge<DeprecatedFlyString>, unsigned hash) const
+    {
+        m_hash = hash;
+        m_has_hash = true;
+    }
+
 private:
     enum ConstructTheEmptyStringImplTag {
         ConstructTheEmptyStringImpl
@@ -20,6 +20,7 @@ struct GenericTraits {
     using ConstPeekType = T const&;
     static constexpr bool is_trivial() { return false; }
     static constexpr bool is_trivially_serializable() { return false; }
+    static constexpr bool is_trivially_relocatable() { return IsTriviallyCopyable<T>; }
     static constexpr bool equals(T const& a, T const& b) { return a == b; }
     template<Concepts::HashCompatible<T> U>
     static bool equals(U const& a, T const& b) { return a == b; }
@@ -77,9 +78,18 @@ requires(Detail::IsPointerOfType<char, T>) struct Traits<T> : public GenericTrai
     static constexpr bool is_trivial() { return true; }
 };
 
+// An object can be relocated trivially if moving it to a new address and then destroying the original is the same as
+// just copying its bytes over and forgetting about the original. That is true for most types that own things through
+// pointers, like RefPtr or String, which lets containers move them around with memcpy() instead of going through
+// their move constructors and destructors (and the refcount churn that comes with them).
+// Note: This is never true for types that point into themselves, like a Vector with inline capacity.
+template<typename T>
+inline constexpr bool IsTriviallyRelocatable = Traits<T>::is_trivially_relocatable();
+
 }
 
 #if USING_AK_GLOBALLY
 using AK::GenericTraits;
+using AK::IsTriviallyRelocatable;
 using AK::Traits;
 #endif
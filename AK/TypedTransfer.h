@@ -31,6 +31,24 @@ public:
         }
     }
 
+    // Moves the objects over to the destination and destroys the originals. The ranges may overlap.
+    static void relocate(T* destination, T* source, size_t count)
+    {
+        if (count == 0)
+            return;
+
+        if constexpr (IsTriviallyRelocatable<T>) {
+            __builtin_memmove(static_cast<void*>(destination), static_cast<void const*>(source), count * sizeof(T));
+            return;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            auto index = destination <= source ? i : count - i - 1;
+            new (&destination[index]) T(AK::move(source[index]));
+            source[index].~T();
+        }
+    }
+
     static size_t copy(T* destination, T const* source, size_t count)
     {
         if (count == 0)
@@ -35,12 +35,55 @@ static ErrorOr<Utf16Data> to_utf16_impl(UtfViewType const& view)
 
 ErrorOr<Utf16Data> utf8_to_utf16(StringView utf8_view)
 {
-    return to_utf16_impl(Utf8View { utf8_view });
+    return utf8_to_utf16(Utf8View { utf8_view });
 }
 
 ErrorOr<Utf16Data> utf8_to_utf16(Utf8View const& utf8_view)
 {
-    return to_utf16_impl(utf8_view);
+    Utf16Data utf16_data;
+    // Note: No UTF-8 sequence turns into more code units than it has bytes, so this is always enough.
+    TRY(utf16_data.try_ensure_capacity(utf8_view.byte_length()));
+
+    ReadonlyBytes bytes { utf8_view.bytes(), utf8_view.byte_length() };
+    size_t offset = 0;
+    while (offset < bytes.size()) {
+        if (bytes[offset] < 0x80) {
+            auto ascii_bytes = Utf8View::count_leading_ascii_bytes(bytes.slice(offset));
+            for (auto byte : bytes.slice(offset, ascii_bytes))
+                utf16_data.unchecked_append(byte);
+            offset += ascii_bytes;
+            continue;
+        }
+
+        auto iterator = utf8_view.iterator_at_byte_offset_without_validation(offset);
+        TRY(code_point_to_utf16(utf16_data, *iterator));
+        offset += iterator.underlying_code_point_length_in_bytes();
+    }
+
+    return utf16_data;
+}
+
+size_t utf16_code_unit_length_from_utf8(StringView utf8_string)
+{
+    Utf8View utf8_view { utf8_string };
+    ReadonlyBytes bytes { utf8_view.bytes(), utf8_view.byte_length() };
+
+    size_t length = 0;
+    size_t offset = 0;
+    while (offset < bytes.size()) {
+        if (bytes[offset] < 0x80) {
+            auto ascii_bytes = Utf8View::count_leading_ascii_bytes(bytes.slice(offset));
+            length += ascii_bytes;
+            offset += ascii_bytes;
+            continue;
+        }
+
+        auto iterator = utf8_view.iterator_at_byte_offset_without_validation(offset);
+        length += *iterator < first_supplementary_plane_code_point ? 1 : 2;
+        offset += iterator.underlying_code_point_length_in_bytes();
+    }
+
+    return length;
 }
 
 ErrorOr<Utf16Data> utf32_to_utf16(Utf32View const& utf32_view)
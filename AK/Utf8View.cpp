@@ -107,6 +107,13 @@ bool Utf8View::validate(size_t& valid_bytes) const
 {
     valid_bytes = 0;
     for (auto ptr = begin_ptr(); ptr < end_ptr(); ptr++) {
+        if (*ptr < 0x80) {
+            auto ascii_bytes = count_leading_ascii_bytes({ ptr, static_cast<size_t>(end_ptr() - ptr) });
+            valid_bytes += ascii_bytes;
+            ptr += ascii_bytes - 1;
+            continue;
+        }
+
         size_t code_point_length_in_bytes = 0;
         u32 code_point = 0;
         bool first_byte_makes_sense = decode_first_byte(*ptr, code_point_length_in_bytes, code_point);
@@ -136,7 +143,15 @@ bool Utf8View::validate(size_t& valid_bytes) const
 size_t Utf8View::calculate_length() const
 {
     size_t length = 0;
-    for ([[maybe_unused]] auto code_point : *this) {
+    for (auto iterator = begin(); !iterator.done(); ++iterator) {
+        if (*iterator.m_ptr < 0x80) {
+            // Note: Every ASCII byte is a code point of its own, so there's no need to decode them.
+            auto ascii_bytes = count_leading_ascii_bytes({ iterator.m_ptr, iterator.m_length });
+            length += ascii_bytes;
+            iterator = { iterator.m_ptr + ascii_bytes, iterator.m_length - ascii_bytes };
+            if (iterator.done())
+                break;
+        }
         ++length;
     }
     return length;
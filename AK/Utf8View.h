@@ -111,6 +111,24 @@ public:
         return validate(valid_bytes);
     }
 
+    // Returns how many of the leading bytes are ASCII. This looks at whole words at a time, so that decoders can copy
+    // runs of ASCII, which is what most text consists of, without decoding every code point on its own.
+    static size_t count_leading_ascii_bytes(ReadonlyBytes bytes)
+    {
+        constexpr u64 non_ascii_bits = 0x8080808080808080ull;
+
+        size_t offset = 0;
+        for (; offset + 2 * sizeof(u64) <= bytes.size(); offset += 2 * sizeof(u64)) {
+            u64 words[2];
+            __builtin_memcpy(words, bytes.offset_pointer(offset), sizeof(words));
+            if ((words[0] | words[1]) & non_ascii_bits)
+                break;
+        }
+        while (offset < bytes.size() && bytes[offset] < 0x80)
+            ++offset;
+        return offset;
+    }
+
     size_t length() const
     {
         if (!m_have_length) {
@@ -9,6 +9,7 @@
 #include <AK/Array.h>
 #include <AK/BitCast.h>
 #include <AK/StdLibExtras.h>
+#include <AK/Traits.h>
 #include <AK/TypeList.h>
 
 namespace AK::Detail {
@@ -521,6 +522,12 @@ private:
 template<typename... Ts>
 struct TypeList<Variant<Ts...>> : TypeList<Ts...> { };
 
+template<typename... Ts>
+struct Traits<Variant<Ts...>> : public GenericTraits<Variant<Ts...>> {
+    // Note: A Variant only ever holds one of its types in place, next to a plain index.
+    static constexpr bool is_trivially_relocatable() { return (IsTriviallyRelocatable<Ts> && ...); }
+};
+
 }
 
 #if USING_AK_GLOBALLY
@@ -7,7 +7,9 @@
 
 #pragma once
 
+#include <AK/Allocator.h>
 #include <AK/Assertions.h>
+#include <AK/Checked.h>
 #include <AK/Error.h>
 #include <AK/Find.h>
 #include <AK/Forward.h>
@@ -41,7 +43,7 @@ struct CanBePlacedInsideVectorHelper<StorageType, false> {
 };
 }
 
-template<typename T, size_t inline_capacity>
+template<typename T, size_t inline_capacity, typename Allocator>
 requires(!IsRvalueReference<T>) class Vector {
 private:
     static constexpr bool contains_reference = IsLvalueReference<T>;
@@ -59,6 +61,12 @@ public:
     {
     }
 
+    explicit Vector(Allocator allocator)
+        : m_capacity(inline_capacity)
+        , m_allocator(move(allocator))
+    {
+    }
+
     Vector(std::initializer_list<T> list)
     requires(!IsLvalueReference<T>)
     {
@@ -71,12 +79,11 @@ public:
         : m_size(other.m_size)
         , m_capacity(other.m_capacity)
         , m_outline_buffer(other.m_outline_buffer)
+        , m_allocator(other.m_allocator)
     {
         if constexpr (inline_capacity > 0) {
-            if (!m_outline_buffer) {
-                TypedTransfer<T>::move(inline_buffer(), other.inline_buffer(), m_size);
-                TypedTransfer<T>::delete_(other.inline_buffer(), m_size);
-            }
+            if (!m_outline_buffer)
+                TypedTransfer<StorageType>::relocate(inline_buffer(), other.inline_buffer(), m_size);
         }
         other.m_outline_buffer = nullptr;
         other.m_size = 0;
@@ -84,6 +91,7 @@ public:
     }
 
     Vector(Vector const& other)
+        : m_allocator(other.m_allocator)
     {
         ensure_capacity(other.size());
         TypedTransfer<StorageType>::copy(data(), other.data(), other.size());
@@ -98,8 +106,8 @@ public:
         m_size = other.size();
     }
 
-    template<size_t other_inline_capacity>
-    Vector(Vector<T, other_inline_capacity> const& other)
+    template<size_t other_inline_capacity, typename OtherAllocator>
+    Vector(Vector<T, other_inline_capacity, OtherAllocator> const& other)
     {
         ensure_capacity(other.size());
         TypedTransfer<StorageType>::copy(data(), other.data(), other.size());
@@ -120,6 +128,7 @@ public:
     bool is_empty() const { return size() == 0; }
     ALWAYS_INLINE size_t size() const { return m_size; }
     size_t capacity() const { return m_capacity; }
+    Allocator const& allocator() const { return m_allocator; }
 
     ALWAYS_INLINE StorageType* data()
     {
@@ -332,13 +341,10 @@ public:
             m_size = other.m_size;
             m_capacity = other.m_capacity;
             m_outline_buffer = other.m_outline_buffer;
+            m_allocator = other.m_allocator;
             if constexpr (inline_capacity > 0) {
-                if (!m_outline_buffer) {
-                    for (size_t i = 0; i < m_size; ++i) {
-                        new (&inline_buffer()[i]) StorageType(move(other.inline_buffer()[i]));
-                        other.inline_buffer()[i].~StorageType();
-                    }
-                }
+                if (!m_outline_buffer)
+                    TypedTransfer<StorageType>::relocate(inline_buffer(), other.inline_buffer(), m_size);
             }
             other.m_outline_buffer = nullptr;
             other.m_size = 0;
@@ -358,8 +364,8 @@ public:
         return *this;
     }
 
-    template<size_t other_inline_capacity>
-    Vector& operator=(Vector<T, other_inline_capacity> const& other)
+    template<size_t other_inline_capacity, typename OtherAllocator>
+    Vector& operator=(Vector<T, other_inline_capacity, OtherAllocator> const& other)
     {
         clear();
         ensure_capacity(other.size());
@@ -372,7 +378,7 @@ public:
     {
         clear_with_capacity();
         if (m_outline_buffer) {
-            kfree_sized(m_outline_buffer, m_capacity * sizeof(StorageType));
+            m_allocator.deallocate(m_outline_buffer, m_capacity * sizeof(StorageType));
             m_outline_buffer = nullptr;
         }
         reset_capacity();
@@ -393,10 +399,7 @@ public:
             TypedTransfer<StorageType>::copy(slot(index), slot(index + 1), m_size - index - 1);
         } else {
             at(index).~StorageType();
-            for (size_t i = index + 1; i < m_size; ++i) {
-                new (slot(i - 1)) StorageType(move(at(i)));
-                at(i).~StorageType();
-            }
+            TypedTransfer<StorageType>::relocate(slot(index), slot(index + 1), m_size - index - 1);
         }
 
         --m_size;
@@ -414,10 +417,7 @@ public:
         } else {
             for (size_t i = index; i < index + count; i++)
                 at(i).~StorageType();
-            for (size_t i = index + count; i < m_size; ++i) {
-                new (slot(i - count)) StorageType(move(at(i)));
-                at(i).~StorageType();
-            }
+            TypedTransfer<StorageType>::relocate(slot(index), slot(index + count), m_size - index - count);
         }
 
         m_size -= count;
@@ -504,10 +504,7 @@ public:
         if constexpr (Traits<StorageType>::is_trivial()) {
             TypedTransfer<StorageType>::move(slot(index + 1), slot(index), m_size - index - 1);
         } else {
-            for (size_t i = size() - 1; i > index; --i) {
-                new (slot(i)) StorageType(move(at(i - 1)));
-                at(i - 1).~StorageType();
-            }
+            TypedTransfer<StorageType>::relocate(slot(index + 1), slot(index), m_size - index - 1);
         }
         if constexpr (contains_reference)
             new (slot(index)) StorageType(&value);
@@ -613,10 +610,7 @@ public:
         auto other_size = other.size();
         TRY(try_grow_capacity(size() + other_size));
 
-        for (size_t i = size() + other_size - 1; i >= other.size(); --i) {
-            new (slot(i)) StorageType(move(at(i - other_size)));
-            at(i - other_size).~StorageType();
-        }
+        TypedTransfer<StorageType>::relocate(slot(other_size), slot(0), size());
 
         Vector tmp = move(other);
         TypedTransfer<StorageType>::move(slot(0), tmp.data(), tmp.size());
@@ -646,21 +640,20 @@ public:
     {
         if (m_capacity >= needed_capacity)
             return {};
-        size_t new_capacity = kmalloc_good_size(needed_capacity * sizeof(StorageType)) / sizeof(StorageType);
-        auto* new_buffer = static_cast<StorageType*>(kmalloc_array(new_capacity, sizeof(StorageType)));
+        size_t new_capacity = m_allocator.good_size(needed_capacity * sizeof(StorageType)) / sizeof(StorageType);
+        if (Checked<size_t>::multiplication_would_overflow(new_capacity, sizeof(StorageType)))
+            return Error::from_errno(ENOMEM);
+        auto* new_buffer = static_cast<StorageType*>(m_allocator.allocate(new_capacity * sizeof(StorageType), alignof(StorageType)));
         if (new_buffer == nullptr)
             return Error::from_errno(ENOMEM);
 
         if constexpr (Traits<StorageType>::is_trivial()) {
             TypedTransfer<StorageType>::copy(new_buffer, data(), m_size);
         } else {
-            for (size_t i = 0; i < m_size; ++i) {
-                new (&new_buffer[i]) StorageType(move(at(i)));
-                at(i).~StorageType();
-            }
+            TypedTransfer<StorageType>::relocate(new_buffer, data(), m_size);
         }
         if (m_outline_buffer)
-            kfree_sized(m_outline_buffer, m_capacity * sizeof(StorageType));
+            m_allocator.deallocate(m_outline_buffer, m_capacity * sizeof(StorageType));
         m_outline_buffer = new_buffer;
         m_capacity = new_capacity;
         return {};
@@ -853,6 +846,7 @@ private:
 
     alignas(storage_alignment()) unsigned char m_inline_buffer_storage[storage_size()];
     StorageType* m_outline_buffer { nullptr };
+    [[no_unique_address]] Allocator m_allocator;
 };
 
 template<class... Args>
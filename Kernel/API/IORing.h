@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+// The layout of an IO ring, which is shared between the kernel and userspace.
+//
+// Userspace fills in submissions at submission_tail and then calls io_ring_enter(),
+// which consumes them from submission_head and posts a completion for each of them.
+// Userspace consumes completions from completion_head up to completion_tail.
+// All indices are free-running, and taken modulo the respective entry count (which is a power of two).
+
+#define IO_RING_MAX_ENTRIES 4096
+
+enum class IORingOpcode : u8 {
+    Nop = 0,
+    // address: buffer, length: buffer size, offset: file offset, or -1 to use (and advance) the current offset
+    Read,
+    // address: buffer, length: buffer size, offset: file offset, or -1 to use (and advance) the current offset
+    Write,
+    // address: struct sockaddr* (may be null), offset: socklen_t*, flags: SOCK_NONBLOCK | SOCK_CLOEXEC
+    Accept,
+    // address: struct msghdr const*, flags: MSG_* flags
+    SendMessage,
+    // address: struct msghdr*, flags: MSG_* flags
+    ReceiveMessage,
+};
+
+struct IORingSubmission {
+    IORingOpcode opcode;
+    u8 reserved[3];
+    i32 fd;
+    i64 offset;
+    u64 address;
+    u32 length;
+    u32 flags;
+    // Passed back unchanged in the completion.
+    u64 user_data;
+};
+
+struct IORingCompletion {
+    u64 user_data;
+    // The return value of the operation, or a negated errno.
+    i64 result;
+};
+
+struct IORingHeader {
+    u32 submission_head;
+    u32 submission_tail;
+    u32 completion_head;
+    u32 completion_tail;
+    u32 submission_entries;
+    u32 completion_entries;
+    // Byte offsets of the entry arrays from the start of the mapping.
+    u32 submissions_offset;
+    u32 completions_offset;
+};
+
+struct IORingLayout {
+    u32 submission_entries;
+    u32 completion_entries;
+    u32 submissions_offset;
+    u32 completions_offset;
+    // Size of the whole mapping, as it should be passed to mmap().
+    u32 mapping_size;
+};
+
+// NOTE: The completion queue is twice as large as the submission queue, so a full batch can complete
+//       while userspace still hasn't consumed the completions of the previous one.
+constexpr IORingLayout io_ring_layout(u32 entries)
+{
+    constexpr u32 page_size = 4096;
+    IORingLayout layout {};
+    layout.submission_entries = entries;
+    layout.completion_entries = entries * 2;
+    layout.submissions_offset = (sizeof(IORingHeader) + 63) & ~63u;
+    layout.completions_offset = layout.submissions_offset + entries * sizeof(IORingSubmission);
+    auto end = layout.completions_offset + layout.completion_entries * sizeof(IORingCompletion);
+    layout.mapping_size = (end + page_size - 1) & ~(page_size - 1);
+    return layout;
+}
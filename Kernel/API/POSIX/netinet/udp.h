@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <Kernel/API/POSIX/sys/socket.h>
+
+#define SOL_UDP IPPROTO_UDP
+
+/* Splits every datagram that is sent into datagrams of this many bytes (the last one may be shorter). */
+#define UDP_SEGMENT 1
+
+/* The most datagrams a single send can be split into with UDP_SEGMENT. */
+#define UDP_MAX_SEGMENTS 64
@@ -62,6 +62,7 @@ extern "C" {
 #define MSG_DONTWAIT 0x40
 #define MSG_NOSIGNAL 0x80
 #define MSG_EOR 0x100
+#define MSG_WAITFORONE 0x200
 
 typedef uint16_t sa_family_t;
 
@@ -81,6 +82,11 @@ struct msghdr {
     int msg_flags;
 };
 
+struct mmsghdr {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+};
+
 struct sockaddr {
     sa_family_t sa_family;
     char sa_data[14];
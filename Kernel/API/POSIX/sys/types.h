@@ -70,11 +70,14 @@ typedef struct __pthread_mutex_t {
     pthread_t owner;
     int level;
     int type;
+    int protocol;
+    int spins;
 } pthread_mutex_t;
 
 typedef void* pthread_attr_t;
 typedef struct __pthread_mutexattr_t {
     int type;
+    int protocol;
 } pthread_mutexattr_t;
 
 typedef struct __pthread_cond_t {
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/EnumBits.h>
+#include <AK/Types.h>
+
+// The binary format of /sys/kernel/process_statistics.
+//
+// Every time the file is opened or seeked back to the start, a new snapshot is taken. The first snapshot on an open
+// file has everything in it. After that, snapshots only have the statistics of the processes and threads that ran or
+// changed state since the previous snapshot that was read from the file, and the rest are marked as unchanged.
+//
+// A snapshot is a ProcessStatisticsHeader followed by process_count processes. Every process is a
+// ProcessStatisticsEntry, then its strings (see the *_length fields), then thread_count ThreadStatisticsEntry's, each
+// followed by its strings. Strings aren't null-terminated, and the strings after an entry are padded with zeroes to
+// a multiple of 8 bytes.
+
+static constexpr u32 PROCESS_STATISTICS_VERSION = 1;
+
+struct ProcessStatisticsHeader {
+    u32 version;
+    u32 process_count;
+    u64 generation;
+    // The generation of the snapshot that this one is relative to, or 0 if it has everything in it.
+    u64 previous_generation;
+    u64 total_time_scheduled;
+    u64 total_time_scheduled_kernel;
+};
+
+struct ProcessStatisticsEntry {
+    enum class Flags : u32 {
+        None = 0,
+        // Only pid and thread_count are filled in. The threads still follow, all of them unchanged.
+        Unchanged = 1 << 0,
+        Kernel = 1 << 1,
+        Dumpable = 1 << 2,
+    };
+
+    enum class Veil : u32 {
+        NotApplicable,
+        None,
+        Dropped,
+        Locked,
+    };
+
+    u64 amount_virtual;
+    u64 amount_resident;
+    u64 amount_dirty_private;
+    u64 amount_clean_inode;
+    u64 amount_shared;
+    u64 amount_purgeable_volatile;
+    u64 amount_purgeable_nonvolatile;
+    i32 pid;
+    i32 pgid;
+    i32 pgp;
+    i32 sid;
+    u32 uid;
+    u32 gid;
+    i32 ppid;
+    u32 nfds;
+    Flags flags;
+    Veil veil;
+    u32 thread_count;
+    u16 name_length;
+    u16 executable_length;
+    u16 tty_length;
+    u16 pledge_length;
+};
+
+AK_ENUM_BITWISE_OPERATORS(ProcessStatisticsEntry::Flags);
+
+struct ThreadStatisticsEntry {
+    enum class Flags : u32 {
+        None = 0,
+        // Only tid is filled in.
+        Unchanged = 1 << 0,
+    };
+
+    u64 time_user;
+    u64 time_kernel;
+    i32 tid;
+    Flags flags;
+    u32 times_scheduled;
+    u32 cpu;
+    u32 priority;
+    u32 syscall_count;
+    u32 inode_faults;
+    u32 zero_faults;
+    u32 cow_faults;
+    u32 unix_socket_read_bytes;
+    u32 unix_socket_write_bytes;
+    u32 ipv4_socket_read_bytes;
+    u32 ipv4_socket_write_bytes;
+    u32 file_read_bytes;
+    u32 file_write_bytes;
+    u16 name_length;
+    u16 state_length;
+};
+
+AK_ENUM_BITWISE_OPERATORS(ThreadStatisticsEntry::Flags);
@@ -15,6 +15,7 @@
 constexpr int syscall_vector = 0x82;
 
 extern "C" {
+struct mmsghdr;
 struct pollfd;
 struct timeval;
 struct timespec;
@@ -67,6 +68,9 @@ enum class NeedsBigProcessLock {
     S(dump_backtrace, NeedsBigProcessLock::No)              \
     S(dup2, NeedsBigProcessLock::No)                        \
     S(emuctl, NeedsBigProcessLock::No)                      \
+    S(epoll_create, NeedsBigProcessLock::No)                \
+    S(epoll_ctl, NeedsBigProcessLock::No)                   \
+    S(epoll_wait, NeedsBigProcessLock::No)                  \
     S(execve, NeedsBigProcessLock::Yes)                     \
     S(exit, NeedsBigProcessLock::Yes)                       \
     S(exit_thread, NeedsBigProcessLock::Yes)                \
@@ -82,6 +86,7 @@ enum class NeedsBigProcessLock {
     S(ftruncate, NeedsBigProcessLock::No)                   \
     S(futex, NeedsBigProcessLock::Yes)                      \
     S(get_dir_entries, NeedsBigProcessLock::Yes)            \
+    S(get_dir_entries_with_stat, NeedsBigProcessLock::Yes)  \
     S(get_process_name, NeedsBigProcessLock::No)            \
     S(get_root_session_id, NeedsBigProcessLock::No)         \
     S(get_stack_bounds, NeedsBigProcessLock::No)            \
@@ -109,6 +114,8 @@ enum class NeedsBigProcessLock {
     S(getuid, NeedsBigProcessLock::No)                      \
     S(inode_watcher_add_watch, NeedsBigProcessLock::Yes)    \
     S(inode_watcher_remove_watch, NeedsBigProcessLock::Yes) \
+    S(io_ring_create, NeedsBigProcessLock::No)              \
+    S(io_ring_enter, NeedsBigProcessLock::No)               \
     S(ioctl, NeedsBigProcessLock::Yes)                      \
     S(join_thread, NeedsBigProcessLock::Yes)                \
     S(jail_create, NeedsBigProcessLock::No)                 \
@@ -148,12 +155,15 @@ enum class NeedsBigProcessLock {
     S(readv, NeedsBigProcessLock::Yes)                      \
     S(realpath, NeedsBigProcessLock::No)                    \
     S(recvfd, NeedsBigProcessLock::No)                      \
+    S(recvmmsg, NeedsBigProcessLock::Yes)                   \
     S(recvmsg, NeedsBigProcessLock::Yes)                    \
     S(rename, NeedsBigProcessLock::No)                      \
     S(rmdir, NeedsBigProcessLock::No)                       \
     S(scheduler_get_parameters, NeedsBigProcessLock::No)    \
     S(scheduler_set_parameters, NeedsBigProcessLock::No)    \
     S(sendfd, NeedsBigProcessLock::No)                      \
+    S(sendfile, NeedsBigProcessLock::No)                    \
+    S(sendmmsg, NeedsBigProcessLock::Yes)                   \
     S(sendmsg, NeedsBigProcessLock::Yes)                    \
     S(set_coredump_metadata, NeedsBigProcessLock::No)       \
     S(set_mmap_name, NeedsBigProcessLock::Yes)              \
@@ -289,6 +299,14 @@ struct SC_getsockopt_params {
     socklen_t* value_size;
 };
 
+struct SC_recvmmsg_params {
+    int sockfd;
+    struct mmsghdr* messages;
+    unsigned message_count;
+    int flags;
+    struct timespec const* timeout;
+};
+
 struct SC_setsockopt_params {
     void const* value;
     int sockfd;
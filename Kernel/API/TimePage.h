@@ -21,9 +21,20 @@ inline bool time_page_supports(clockid_t clock_id)
     return clock_id == CLOCK_REALTIME_COARSE || clock_id == CLOCK_MONOTONIC_COARSE;
 }
 
+// These clocks are served by the time page only while it has a TSC multiplier (see TimePage::tsc_to_ns_multiplier).
+inline bool time_page_supports_precise(clockid_t clock_id)
+{
+    return clock_id == CLOCK_REALTIME || clock_id == CLOCK_MONOTONIC;
+}
+
 struct TimePage {
     volatile u32 update1;
     struct timespec clocks[CLOCK_ID_COUNT];
+    // clocks[CLOCK_REALTIME] and clocks[CLOCK_MONOTONIC] were taken when the TSC read tsc_reference. They advance by
+    // ((tsc - tsc_reference) * tsc_to_ns_multiplier) >> 32 nanoseconds from there. A multiplier of 0 means that they
+    // have to be asked for with a syscall instead.
+    u64 tsc_reference;
+    u64 tsc_to_ns_multiplier;
     volatile u32 update2;
 };
 
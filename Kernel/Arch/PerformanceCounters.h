@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+struct RegisterState;
+
+// The hardware performance monitoring counters of all processors. Every counter that was selected through one of the
+// PERF_EVENT_MASK_HARDWARE events interrupts after a fixed number of occurrences of its event, and each of those
+// interrupts becomes a profiling sample of whatever was running at that time.
+// Like the profile timer, the counters are shared by everyone who profiles, so enable() and disable() are counted,
+// and the most recent enable() decides which events are being counted.
+class PerformanceCounters {
+public:
+    static u64 supported_event_mask();
+
+    static ErrorOr<void> enable(u64 event_mask);
+    static void disable();
+
+    // Called from the counter overflow interrupt of the current processor.
+    static void handle_overflow_interrupt(RegisterState const&);
+};
+
+}
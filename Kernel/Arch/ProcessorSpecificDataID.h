@@ -10,6 +10,8 @@ namespace Kernel {
 
 enum class ProcessorSpecificDataID {
     MemoryManager,
+    Scheduler,
+    TimeManagement,
     __Count,
 };
 
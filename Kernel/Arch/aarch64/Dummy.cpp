@@ -7,7 +7,9 @@
 #include <AK/Singleton.h>
 #include <AK/Types.h>
 
+#include <Kernel/API/POSIX/serenity.h>
 #include <Kernel/Arch/Delay.h>
+#include <Kernel/Arch/PerformanceCounters.h>
 #include <Kernel/Process.h>
 #include <Kernel/Sections.h>
 #include <Kernel/kstdio.h>
@@ -28,6 +30,31 @@ void microseconds_delay(u32)
 
 }
 
+// PerformanceCounters.cpp
+namespace Kernel {
+
+u64 PerformanceCounters::supported_event_mask()
+{
+    return 0;
+}
+
+ErrorOr<void> PerformanceCounters::enable(u64 event_mask)
+{
+    if ((event_mask & PERF_EVENT_MASK_HARDWARE) != 0)
+        return ENOTSUP;
+    return {};
+}
+
+void PerformanceCounters::disable()
+{
+}
+
+void PerformanceCounters::handle_overflow_interrupt(RegisterState const&)
+{
+}
+
+}
+
 // Initializer.cpp
 namespace Kernel::PCI {
 
@@ -14,6 +14,7 @@
 #include <Kernel/Interrupts/SharedIRQHandler.h>
 #include <Kernel/Interrupts/SpuriousInterruptHandler.h>
 #include <Kernel/Interrupts/UnhandledInterruptHandler.h>
+#include <Kernel/Locking/Spinlock.h>
 #include <Kernel/Panic.h>
 #include <Kernel/PerformanceManager.h>
 #include <Kernel/Process.h>
@@ -44,6 +45,9 @@ READONLY_AFTER_INIT static DescriptorTablePointer s_idtr;
 READONLY_AFTER_INIT static IDTEntry s_idt[256];
 
 static GenericInterruptHandler* s_interrupt_handler[GENERIC_INTERRUPT_HANDLERS_COUNT];
+// Note: Devices are brought up on several CPUs at once during boot, so handlers can be (un)registered concurrently.
+//       The lock is recursive, as replacing a handler may register a shared or unhandled one in its place.
+static RecursiveSpinlock<LockRank::None> s_interrupt_handlers_lock {};
 static GenericInterruptHandler* s_disabled_interrupt_handler[2];
 
 static EntropySource s_entropy_source_interrupts { EntropySource::Static::Interrupts };
@@ -348,6 +352,7 @@ void register_disabled_interrupt_handler(u8 number, GenericInterruptHandler& han
 void register_generic_interrupt_handler(u8 interrupt_number, GenericInterruptHandler& handler)
 {
     VERIFY(interrupt_number < GENERIC_INTERRUPT_HANDLERS_COUNT);
+    SpinlockLocker locker(s_interrupt_handlers_lock);
     auto*& handler_slot = s_interrupt_handler[interrupt_number];
     if (handler_slot == nullptr) {
         handler_slot = &handler;
@@ -384,6 +389,7 @@ void register_generic_interrupt_handler(u8 interrupt_number, GenericInterruptHan
 
 void unregister_generic_interrupt_handler(u8 interrupt_number, GenericInterruptHandler& handler)
 {
+    SpinlockLocker locker(s_interrupt_handlers_lock);
     auto*& handler_slot = s_interrupt_handler[interrupt_number];
     VERIFY(handler_slot != nullptr);
     if (handler_slot->type() == HandlerType::UnhandledInterruptHandler)
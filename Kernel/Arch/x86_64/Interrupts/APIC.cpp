@@ -9,6 +9,7 @@
 #include <AK/Types.h>
 #include <Kernel/Arch/Delay.h>
 #include <Kernel/Arch/PageDirectory.h>
+#include <Kernel/Arch/PerformanceCounters.h>
 #include <Kernel/Arch/x86_64/Interrupts/APIC.h>
 #include <Kernel/Arch/x86_64/MSR.h>
 #include <Kernel/Arch/x86_64/ProcessorInfo.h>
@@ -24,6 +25,7 @@
 #include <Kernel/Sections.h>
 #include <Kernel/Thread.h>
 
+#define IRQ_APIC_PERFORMANCE_COUNTER (0xfb - IRQ_VECTOR_BASE)
 #define IRQ_APIC_TIMER (0xfc - IRQ_VECTOR_BASE)
 #define IRQ_APIC_IPI (0xfd - IRQ_VECTOR_BASE)
 #define IRQ_APIC_ERR (0xfe - IRQ_VECTOR_BASE)
@@ -120,6 +122,37 @@ public:
 private:
 };
 
+class APICPerformanceCounterInterruptHandler final : public GenericInterruptHandler {
+public:
+    explicit APICPerformanceCounterInterruptHandler(u8 interrupt_vector)
+        : GenericInterruptHandler(interrupt_vector, true)
+    {
+    }
+    virtual ~APICPerformanceCounterInterruptHandler()
+    {
+    }
+
+    static void initialize(u8 interrupt_number)
+    {
+        auto* handler = new APICPerformanceCounterInterruptHandler(interrupt_number);
+        handler->register_interrupt_handler();
+    }
+
+    virtual bool handle_interrupt(RegisterState const&) override;
+
+    virtual bool eoi() override;
+
+    virtual HandlerType type() const override { return HandlerType::IRQHandler; }
+    virtual StringView purpose() const override { return "Performance Counter Overflow Handler"sv; }
+    virtual StringView controller() const override { return {}; }
+
+    virtual size_t sharing_devices_count() const override { return 0; }
+    virtual bool is_shared_handler() const override { return false; }
+    virtual bool is_sharing_with_others() const override { return false; }
+
+private:
+};
+
 bool APIC::initialized()
 {
     return s_apic.is_initialized();
@@ -486,6 +519,8 @@ UNMAP_AFTER_INIT void APIC::enable(u32 cpu)
 
         // register IPI interrupt vector
         APICIPIInterruptHandler::initialize(IRQ_APIC_IPI);
+
+        APICPerformanceCounterInterruptHandler::initialize(IRQ_APIC_PERFORMANCE_COUNTER);
     }
 
     if (!m_is_x2) {
@@ -508,6 +543,14 @@ UNMAP_AFTER_INIT void APIC::enable(u32 cpu)
     write_register(APIC_REG_TPR, 0);
 }
 
+void APIC::set_performance_counter_interrupt_enabled(bool enabled)
+{
+    if (enabled)
+        write_register(APIC_REG_LVT_PERFORMANCE_COUNTER, APIC_LVT(IRQ_APIC_PERFORMANCE_COUNTER + IRQ_VECTOR_BASE, 0));
+    else
+        write_register(APIC_REG_LVT_PERFORMANCE_COUNTER, APIC_LVT(0, 0) | APIC_LVT_MASKED);
+}
+
 Thread* APIC::get_idle_thread(u32 cpu) const
 {
     VERIFY(cpu > 0);
@@ -621,7 +664,8 @@ void APIC::setup_local_timer(u32 ticks, TimerMode timer_mode, bool enable)
     }
     write_register(APIC_REG_TIMER_CONFIGURATION, config);
 
-    if (timer_mode == TimerMode::Periodic)
+    // Note: Writing the initial count is what starts the timer, in both periodic and one-shot mode.
+    if (timer_mode != TimerMode::TSCDeadline)
         write_register(APIC_REG_TIMER_INITIAL_COUNT, ticks / get_timer_divisor());
 }
 
@@ -660,6 +704,20 @@ bool APICErrInterruptHandler::eoi()
     return true;
 }
 
+bool APICPerformanceCounterInterruptHandler::handle_interrupt(RegisterState const& regs)
+{
+    PerformanceCounters::handle_overflow_interrupt(regs);
+    // NOTE: The local APIC masks the performance counter entry whenever it delivers an interrupt through it.
+    APIC::the().set_performance_counter_interrupt_enabled(true);
+    return true;
+}
+
+bool APICPerformanceCounterInterruptHandler::eoi()
+{
+    APIC::the().eoi();
+    return true;
+}
+
 bool HardwareTimer<GenericInterruptHandler>::eoi()
 {
     APIC::the().eoi();
@@ -33,6 +33,7 @@ public:
     void broadcast_ipi();
     void send_ipi(u32 cpu);
     static u8 spurious_interrupt_vector();
+    void set_performance_counter_interrupt_enabled(bool);
     Thread* get_idle_thread(u32 cpu) const;
     u32 enabled_processor_count() const { return m_processor_enabled_cnt; }
 
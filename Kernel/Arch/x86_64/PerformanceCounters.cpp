@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/BuiltinWrappers.h>
+#include <Kernel/API/POSIX/serenity.h>
+#include <Kernel/Arch/PerformanceCounters.h>
+#include <Kernel/Arch/Processor.h>
+#include <Kernel/Arch/RegisterState.h>
+#include <Kernel/Arch/x86_64/CPUID.h>
+#include <Kernel/Arch/x86_64/Interrupts/APIC.h>
+#include <Kernel/Arch/x86_64/MSR.h>
+#include <Kernel/Locking/Spinlock.h>
+#include <Kernel/PerformanceManager.h>
+
+#define MSR_IA32_PMC0 0xc1
+#define MSR_IA32_PERFEVTSEL0 0x186
+#define MSR_IA32_PERF_GLOBAL_STATUS 0x38e
+#define MSR_IA32_PERF_GLOBAL_CTRL 0x38f
+#define MSR_IA32_PERF_GLOBAL_OVF_CTRL 0x390
+
+#define PERFEVTSEL_USR (1 << 16)
+#define PERFEVTSEL_OS (1 << 17)
+#define PERFEVTSEL_INT (1 << 20)
+#define PERFEVTSEL_EN (1 << 22)
+
+namespace Kernel {
+
+// The pre-defined architectural events, which every processor that has them counts the same way (Intel SDM Vol. 3B, 18.2.1.2).
+struct HardwareEvent {
+    u64 perf_event_type;
+    u8 event_select;
+    u8 unit_mask;
+    // The bit of CPUID.0AH:EBX that is set if the processor does *not* have this event.
+    u8 unavailability_bit;
+    u32 sample_period;
+};
+
+static constexpr Array<HardwareEvent, 4> s_hardware_events { {
+    { PERF_EVENT_CPU_CYCLES, 0x3c, 0x00, 0, 1'000'000 },
+    { PERF_EVENT_INSTRUCTIONS, 0xc0, 0x00, 1, 1'000'000 },
+    { PERF_EVENT_CACHE_MISSES, 0x2e, 0x41, 4, 10'000 },
+    { PERF_EVENT_BRANCH_MISSES, 0xc5, 0x00, 6, 10'000 },
+} };
+
+static constexpr size_t max_counter_count = s_hardware_events.size();
+
+struct Capabilities {
+    size_t counter_count { 0 };
+    u64 supported_event_mask { 0 };
+};
+
+static Capabilities detect_capabilities()
+{
+    Capabilities capabilities;
+    // The overflow interrupts are delivered through the local APIC.
+    if (!APIC::initialized() || CPUID(0).eax() < 0xa)
+        return capabilities;
+
+    CPUID id(0xa);
+    auto version = id.eax() & 0xff;
+    // Version 2 introduced the global control and overflow status registers.
+    if (version < 2)
+        return capabilities;
+
+    capabilities.counter_count = min((id.eax() >> 8) & 0xff, max_counter_count);
+    auto event_bit_vector_length = (id.eax() >> 24) & 0xff;
+    for (auto& event : s_hardware_events) {
+        if (event.unavailability_bit < event_bit_vector_length && (id.ebx() & (1u << event.unavailability_bit)) == 0)
+            capabilities.supported_event_mask |= event.perf_event_type;
+    }
+    return capabilities;
+}
+
+static Spinlock<LockRank::None> s_lock {};
+static size_t s_user_count { 0 };
+static u64 s_programmed_event_mask { 0 };
+
+// Which event every counter in use is counting, the same on all processors.
+static Array<HardwareEvent const*, max_counter_count> s_counter_events {};
+static size_t s_counters_in_use { 0 };
+
+// A counter interrupts when it overflows, so it starts out `sample_period` short of that.
+// NOTE: Writes through IA32_PMCx only set the low 32 bits and sign-extend them, which is exactly what we want here.
+static u64 counter_reload_value(HardwareEvent const& event)
+{
+    return static_cast<u64>(-static_cast<i64>(event.sample_period));
+}
+
+static void program_current_processor()
+{
+    MSR global_control(MSR_IA32_PERF_GLOBAL_CTRL);
+    global_control.set(0);
+
+    u64 enabled_counters = 0;
+    auto counter_count = detect_capabilities().counter_count;
+    for (size_t i = 0; i < counter_count; ++i) {
+        MSR event_select(MSR_IA32_PERFEVTSEL0 + i);
+        event_select.set(0);
+        if (i >= s_counters_in_use)
+            continue;
+        auto const& event = *s_counter_events[i];
+        MSR(MSR_IA32_PMC0 + i).set(counter_reload_value(event));
+        event_select.set(event.event_select | (event.unit_mask << 8) | PERFEVTSEL_USR | PERFEVTSEL_OS | PERFEVTSEL_INT | PERFEVTSEL_EN);
+        enabled_counters |= 1ull << i;
+    }
+
+    MSR(MSR_IA32_PERF_GLOBAL_OVF_CTRL).set(MSR(MSR_IA32_PERF_GLOBAL_STATUS).get());
+    APIC::the().set_performance_counter_interrupt_enabled(enabled_counters != 0);
+    global_control.set(enabled_counters);
+}
+
+static void program_all_processors()
+{
+    VERIFY(s_lock.is_locked());
+    auto current_id = Processor::current_id();
+    for (u32 cpu = 0; cpu < Processor::count(); ++cpu) {
+        if (cpu == current_id || !Processor::is_smp_enabled())
+            continue;
+        Processor::smp_unicast(cpu, [] { program_current_processor(); }, false);
+    }
+    program_current_processor();
+}
+
+static void reprogram(u64 hardware_event_mask)
+{
+    if (hardware_event_mask == s_programmed_event_mask)
+        return;
+
+    // Stop everything first, so no overflow interrupt ever sees a counter whose event is changing.
+    s_counters_in_use = 0;
+    program_all_processors();
+
+    s_counter_events.fill(nullptr);
+    for (auto& event : s_hardware_events) {
+        if (hardware_event_mask & event.perf_event_type)
+            s_counter_events[s_counters_in_use++] = &event;
+    }
+    if (s_counters_in_use != 0)
+        program_all_processors();
+    s_programmed_event_mask = hardware_event_mask;
+}
+
+u64 PerformanceCounters::supported_event_mask()
+{
+    return detect_capabilities().supported_event_mask;
+}
+
+ErrorOr<void> PerformanceCounters::enable(u64 event_mask)
+{
+    SpinlockLocker locker(s_lock);
+    auto hardware_event_mask = event_mask & PERF_EVENT_MASK_HARDWARE;
+    if (hardware_event_mask != 0) {
+        auto capabilities = detect_capabilities();
+        if ((hardware_event_mask & ~capabilities.supported_event_mask) != 0)
+            return ENOTSUP;
+        if (static_cast<size_t>(popcount(hardware_event_mask)) > capabilities.counter_count)
+            return ENOTSUP;
+    }
+    ++s_user_count;
+    reprogram(hardware_event_mask);
+    return {};
+}
+
+void PerformanceCounters::disable()
+{
+    SpinlockLocker locker(s_lock);
+    if (s_user_count == 0)
+        return;
+    if (--s_user_count == 0)
+        reprogram(0);
+}
+
+void PerformanceCounters::handle_overflow_interrupt(RegisterState const& regs)
+{
+    MSR global_status(MSR_IA32_PERF_GLOBAL_STATUS);
+    auto overflowed_counters = global_status.get();
+
+    auto* current_thread = Thread::current();
+    bool should_sample = current_thread && current_thread != Processor::idle_thread();
+    for (size_t i = 0; i < s_counters_in_use; ++i) {
+        auto const* event = s_counter_events[i];
+        if (!event || (overflowed_counters & (1ull << i)) == 0)
+            continue;
+        MSR(MSR_IA32_PMC0 + i).set(counter_reload_value(*event));
+        if (should_sample)
+            PerformanceManager::add_hardware_counter_event(*current_thread, regs, event->perf_event_type);
+    }
+
+    MSR(MSR_IA32_PERF_GLOBAL_OVF_CTRL).set(overflowed_counters);
+}
+
+}
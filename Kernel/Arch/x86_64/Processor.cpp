@@ -614,6 +614,7 @@ UNMAP_AFTER_INIT void Processor::early_initialize(u32 cpu)
     m_in_scheduler = true;
 
     m_message_queue = nullptr;
+    m_active_cr3 = 0;
     m_idle_thread = nullptr;
     m_current_thread = nullptr;
     m_info = nullptr;
@@ -994,6 +995,14 @@ void Processor::check_invoke_scheduler()
 
 void Processor::flush_tlb_local(VirtualAddress vaddr, size_t page_count)
 {
+    // Invalidating a large user range page by page is slower than reloading CR3,
+    // which drops all non-global translations, i.e. everything in userspace.
+    static constexpr size_t full_flush_page_count_threshold = 64;
+    if (page_count > full_flush_page_count_threshold && Memory::is_user_address(vaddr)) {
+        flush_entire_tlb_local();
+        return;
+    }
+
     auto ptr = vaddr.as_ptr();
     while (page_count > 0) {
         // clang-format off
@@ -1009,12 +1018,21 @@ void Processor::flush_tlb_local(VirtualAddress vaddr, size_t page_count)
 
 void Processor::flush_tlb(Memory::PageDirectory const* page_directory, VirtualAddress vaddr, size_t page_count)
 {
-    if (s_smp_enabled && (!Memory::is_user_address(vaddr) || Process::current().thread_count() > 1))
+    if (s_smp_enabled)
         smp_broadcast_flush_tlb(page_directory, vaddr, page_count);
     else
         flush_tlb_local(vaddr, page_count);
 }
 
+void Processor::load_cr3(FlatPtr cr3)
+{
+    InterruptDisabler disabler;
+    // NOTE: We publish the new CR3 before loading it. A processor switching away from a page directory
+    //       may be skipped by shootdowns as soon as we do, which is fine since loading CR3 drops its user translations.
+    current().m_active_cr3.store(cr3, AK::MemoryOrder::memory_order_seq_cst);
+    write_cr3(cr3);
+}
+
 void Processor::smp_return_to_pool(ProcessorMessage& msg)
 {
     ProcessorMessage* next = nullptr;
@@ -1251,6 +1269,25 @@ void Processor::smp_broadcast_message(ProcessorMessage& msg)
         APIC::the().broadcast_ipi();
 }
 
+void Processor::smp_multicast_message(u64 processor_mask, ProcessorMessage& msg)
+{
+    auto& current_processor = Processor::current();
+    VERIFY(!(processor_mask & (1ull << current_processor.id())));
+
+    dbgln_if(SMP_DEBUG, "SMP[{}]: Multicast message {} to cpus: {:064b} processor: {}", current_processor.id(), VirtualAddress(&msg), processor_mask, VirtualAddress(&current_processor));
+
+    msg.refs.store(popcount(processor_mask), AK::MemoryOrder::memory_order_release);
+    VERIFY(msg.refs > 0);
+    for_each(
+        [&](Processor& proc) {
+            if (!(processor_mask & (1ull << proc.id())))
+                return;
+            // Only send an IPI if the target didn't already have messages queued, it will pick this one up as well.
+            if (proc.smp_enqueue_message(msg))
+                APIC::the().send_ipi(proc.id());
+        });
+}
+
 void Processor::smp_broadcast_wait_sync(ProcessorMessage& msg)
 {
     auto& cur_proc = Processor::current();
@@ -1311,6 +1348,35 @@ void Processor::smp_unicast(u32 cpu, Function<void()> callback, bool async)
 
 void Processor::smp_broadcast_flush_tlb(Memory::PageDirectory const* page_directory, VirtualAddress vaddr, size_t page_count)
 {
+    if (Memory::is_user_address(vaddr)) {
+        // User translations can only be cached by processors that currently have this page directory loaded.
+        // NOTE: Our page table updates have to be visible before we look at which processors are using them.
+        full_memory_barrier();
+        auto& current_processor = Processor::current();
+        auto cr3 = page_directory->cr3();
+        u64 processor_mask = 0;
+        for_each(
+            [&](Processor& proc) {
+                if (&proc != &current_processor && proc.m_active_cr3.load(AK::MemoryOrder::memory_order_relaxed) == cr3)
+                    processor_mask |= 1ull << proc.id();
+            });
+        if (processor_mask == 0) {
+            flush_tlb_local(vaddr, page_count);
+            return;
+        }
+
+        auto& msg = smp_get_from_pool();
+        msg.async = false;
+        msg.type = ProcessorMessage::FlushTlb;
+        msg.flush_tlb.page_directory = page_directory;
+        msg.flush_tlb.ptr = vaddr.as_ptr();
+        msg.flush_tlb.page_count = page_count;
+        smp_multicast_message(processor_mask, msg);
+        flush_tlb_local(vaddr, page_count);
+        smp_broadcast_wait_sync(msg);
+        return;
+    }
+
     auto& msg = smp_get_from_pool();
     msg.async = false;
     msg.type = ProcessorMessage::FlushTlb;
@@ -1547,7 +1613,7 @@ extern "C" void enter_thread_context(Thread* from_thread, Thread* to_thread)
     fs_base_msr.set(to_thread->thread_specific_data().get());
 
     if (from_regs.cr3 != to_regs.cr3)
-        write_cr3(to_regs.cr3);
+        Processor::load_cr3(to_regs.cr3);
 
     to_thread->set_cpu(processor.id());
 
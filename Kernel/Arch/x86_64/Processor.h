@@ -96,6 +96,9 @@ class Processor {
 
     Atomic<ProcessorMessageEntry*> m_message_queue;
 
+    // The CR3 currently loaded on this processor, so TLB shootdowns can skip processors that aren't using a page directory.
+    Atomic<FlatPtr> m_active_cr3;
+
     bool m_invoke_scheduler_async;
     bool m_scheduler_initialized;
     bool m_in_scheduler;
@@ -118,6 +121,7 @@ class Processor {
     bool smp_enqueue_message(ProcessorMessage&);
     static void smp_unicast_message(u32 cpu, ProcessorMessage& msg, bool async);
     static void smp_broadcast_message(ProcessorMessage& msg);
+    static void smp_multicast_message(u64 processor_mask, ProcessorMessage& msg);
     static void smp_broadcast_wait_sync(ProcessorMessage& msg);
     static void smp_broadcast_halt();
 
@@ -149,6 +153,13 @@ public:
         s_idle_cpu_mask.fetch_and(~(1u << m_cpu), AK::MemoryOrder::memory_order_relaxed);
     }
 
+    static bool is_every_other_processor_idle()
+    {
+        u32 all_mask = count() >= 32 ? NumericLimits<u32>::max() : (1u << count()) - 1;
+        u32 others_mask = all_mask & ~(1u << current_id());
+        return (s_idle_cpu_mask.load(AK::MemoryOrder::memory_order_relaxed) & others_mask) == others_mask;
+    }
+
     void wait_for_interrupt() const
     {
         asm("hlt");
@@ -190,6 +201,8 @@ public:
     static void flush_tlb_local(VirtualAddress vaddr, size_t page_count);
     static void flush_tlb(Memory::PageDirectory const*, VirtualAddress, size_t);
 
+    static void load_cr3(FlatPtr);
+
     Descriptor& get_gdt_entry(u16 selector);
     void flush_gdt();
     DescriptorTablePointer const& get_gdtr();
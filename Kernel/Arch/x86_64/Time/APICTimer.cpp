@@ -148,13 +148,29 @@ size_t APICTimer::ticks_per_second() const
 
 void APICTimer::set_periodic()
 {
-    // FIXME: Implement it...
-    VERIFY_NOT_REACHED();
+    m_timer_mode = APIC::TimerMode::Periodic;
+    enable_local_timer();
 }
+
 void APICTimer::set_non_periodic()
 {
-    // FIXME: Implement it...
-    VERIFY_NOT_REACHED();
+    // Note: The timer stays quiet until it's programmed with program_one_shot().
+    m_timer_mode = APIC::TimerMode::OneShot;
+    disable_local_timer();
+}
+
+void APICTimer::program_one_shot(u64 nanoseconds)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(m_timer_mode == APIC::TimerMode::OneShot);
+
+    // m_timer_period is the number of bus clocks per tick of the calibration source, which ticks m_frequency times a
+    // second. Clamping to a second keeps the multiplication below from overflowing.
+    nanoseconds = min(nanoseconds, (u64)1'000'000'000);
+    u64 bus_clocks = nanoseconds * m_timer_period * m_frequency / 1'000'000'000ull;
+    auto divisor = APIC::the().get_timer_divisor();
+    bus_clocks = clamp(bus_clocks, (u64)divisor, (u64)NumericLimits<u32>::max());
+    APIC::the().setup_local_timer((u32)bus_clocks, APIC::TimerMode::OneShot, true);
 }
 
 void APICTimer::reset_to_default_ticks_per_second()
@@ -35,6 +35,10 @@ public:
     void enable_local_timer();
     void disable_local_timer();
 
+    // Makes the local timer of the current processor fire once, after (roughly) the given time.
+    // Only meant for when the timer isn't periodic.
+    void program_one_shot(u64 nanoseconds);
+
 private:
     explicit APICTimer(u8, Function<void(RegisterState const&)>);
 
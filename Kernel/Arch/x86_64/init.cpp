@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/Types.h>
 #include <Kernel/Arch/InterruptManagement.h>
 #include <Kernel/Arch/Processor.h>
@@ -56,8 +57,10 @@
 #include <Kernel/TTY/PTYMultiplexer.h>
 #include <Kernel/TTY/VirtualConsole.h>
 #include <Kernel/Tasks/FinalizerTask.h>
+#include <Kernel/Tasks/ReclaimTask.h>
 #include <Kernel/Tasks/SyncTask.h>
 #include <Kernel/Time/TimeManagement.h>
+#include <Kernel/WaitQueue.h>
 #include <Kernel/WorkQueue.h>
 #include <Kernel/kstdio.h>
 
@@ -289,6 +292,77 @@ extern "C" UNMAP_AFTER_INIT void init_finished(u32 cpu)
     }
 }
 
+// Subsystems that don't depend on each other are brought up on kernel threads of their own, so that they can probe
+// their devices on all CPUs at once. wait_for_boot_tasks() is the barrier for everything that depends on them.
+struct BootTask {
+    StringView name;
+    void (*initialize)();
+};
+
+static Atomic<size_t> s_pending_boot_task_count;
+static WaitQueue* s_boot_tasks_wait_queue;
+
+UNMAP_AFTER_INIT static void run_boot_task(void* data)
+{
+    auto const& task = *static_cast<BootTask const*>(data);
+    auto start = TimeManagement::the().monotonic_time(TimePrecision::Precise);
+    task.initialize();
+    auto elapsed = TimeManagement::the().monotonic_time(TimePrecision::Precise) - start;
+    dmesgln("Boot: {} took {} ms on CPU #{}", task.name, elapsed.to_milliseconds(), Processor::current_id());
+
+    if (--s_pending_boot_task_count == 0)
+        s_boot_tasks_wait_queue->wake_all();
+}
+
+UNMAP_AFTER_INIT static void spawn_boot_tasks(Span<BootTask const> tasks)
+{
+    s_boot_tasks_wait_queue = new WaitQueue;
+    s_pending_boot_task_count = tasks.size();
+    for (auto const& task : tasks) {
+        auto* task_data = const_cast<BootTask*>(&task);
+        auto name = MUST(KString::formatted("Boot Task: {}", task.name));
+        // Note: If there's no thread for it, the task is simply run right here.
+        if (!Process::current().create_kernel_thread(run_boot_task, task_data, THREAD_PRIORITY_NORMAL, move(name), THREAD_AFFINITY_DEFAULT, false))
+            run_boot_task(task_data);
+    }
+}
+
+UNMAP_AFTER_INIT static void wait_for_boot_tasks()
+{
+    auto start = TimeManagement::the().monotonic_time(TimePrecision::Precise);
+    while (s_pending_boot_task_count > 0)
+        s_boot_tasks_wait_queue->wait_forever("BootTasks"sv);
+    auto elapsed = TimeManagement::the().monotonic_time(TimePrecision::Precise) - start;
+    dmesgln("Boot: Waited {} ms for boot tasks", elapsed.to_milliseconds());
+}
+
+UNMAP_AFTER_INIT static void initialize_storage()
+{
+    StorageManagement::the().initialize(kernel_command_line().root_device(), kernel_command_line().is_force_pio(), kernel_command_line().is_nvme_polling_enabled());
+}
+
+UNMAP_AFTER_INIT static void initialize_usb()
+{
+    if (!PCI::Access::is_disabled())
+        USB::USBManagement::initialize();
+}
+
+UNMAP_AFTER_INIT static void initialize_virtio()
+{
+    if (!PCI::Access::is_disabled())
+        VirtIO::detect();
+}
+
+UNMAP_AFTER_INIT static void initialize_networking()
+{
+    NetworkingManagement::the().initialize();
+}
+
+UNMAP_AFTER_INIT static void initialize_audio()
+{
+    AudioManagement::the().initialize();
+}
+
 void init_stage2(void*)
 {
     // This is a little bit of a hack. We can't register our process at the time we're
@@ -328,19 +402,22 @@ void init_stage2(void*)
 
     SyncTask::spawn();
     FinalizerTask::spawn();
+    ReclaimTask::spawn();
 
     auto boot_profiling = kernel_command_line().is_boot_profiling_enabled();
 
-    if (!PCI::Access::is_disabled()) {
-        USB::USBManagement::initialize();
-    }
     FirmwareSysFSDirectory::initialize();
 
-    if (!PCI::Access::is_disabled()) {
-        VirtIO::detect();
-    }
-
-    NetworkingManagement::the().initialize();
+    // Note: The tasks only probe the devices of their own subsystem. Everything they share (PCI, device registration,
+    //       interrupt handlers) is locked.
+    static constexpr BootTask boot_tasks[] = {
+        { "Storage"sv, initialize_storage },
+        { "USB"sv, initialize_usb },
+        { "VirtIO"sv, initialize_virtio },
+        { "Networking"sv, initialize_networking },
+        { "Audio"sv, initialize_audio },
+    };
+    spawn_boot_tasks({ boot_tasks, array_size(boot_tasks) });
 
 #ifdef ENABLE_KERNEL_COVERAGE_COLLECTION
     (void)KCOVDevice::must_create().leak_ref();
@@ -352,9 +429,8 @@ void init_stage2(void*)
     (void)SelfTTYDevice::must_create().leak_ref();
     PTYMultiplexer::initialize();
 
-    AudioManagement::the().initialize();
+    wait_for_boot_tasks();
 
-    StorageManagement::the().initialize(kernel_command_line().root_device(), kernel_command_line().is_force_pio(), kernel_command_line().is_nvme_polling_enabled());
     if (VirtualFileSystem::the().mount_root(StorageManagement::the().root_filesystem()).is_error()) {
         PANIC("VirtualFileSystem::mount_root failed");
     }
@@ -391,7 +467,8 @@ void init_stage2(void*)
         VERIFY(!result.is_error());
     }
 
-    NetworkTask::spawn();
+    if (auto result = NetworkTask::spawn(); result.is_error())
+        dmesgln("init_stage2: Error spawning the network task: {}", result.error());
 
     Process::current().sys$exit(0);
     VERIFY_NOT_REACHED();
@@ -327,7 +327,7 @@ bool Device::setup_queue(u16 queue_index)
 
     u16 queue_notify_offset = config_read16(*m_common_cfg, COMMON_CFG_QUEUE_NOTIFY_OFF);
 
-    auto queue_or_error = Queue::try_create(queue_size, queue_notify_offset);
+    auto queue_or_error = Queue::try_create(queue_size, queue_notify_offset, is_feature_set(m_accepted_features, VIRTIO_F_EVENT_IDX));
     if (queue_or_error.is_error())
         return false;
     auto queue = queue_or_error.release_value();
@@ -419,13 +419,16 @@ bool Device::handle_irq(RegisterState const&)
     }
     if (isr_type & QUEUE_INTERRUPT) {
         dbgln_if(VIRTIO_DEBUG, "{}: VirtIO Queue interrupt!", class_name());
+        // NOTE: There's only one interrupt for all queues, so any number of them may have news.
+        bool any_queue_updated = false;
         for (size_t i = 0; i < m_queues.size(); i++) {
             if (get_queue(i).new_data_available()) {
                 handle_queue_update(i);
-                return true;
+                any_queue_updated = true;
             }
         }
-        dbgln_if(VIRTIO_DEBUG, "{}: Got queue interrupt but all queues are up to date!", class_name());
+        if (!any_queue_updated)
+            dbgln_if(VIRTIO_DEBUG, "{}: Got queue interrupt but all queues are up to date!", class_name());
     }
     return true;
 }
@@ -436,6 +439,13 @@ void Device::supply_chain_and_notify(u16 queue_index, QueueChain& chain)
     VERIFY(&chain.queue() == &queue);
     VERIFY(queue.lock().is_locked());
     chain.submit_to_queue();
+    notify_queue_if_needed(queue_index);
+}
+
+void Device::notify_queue_if_needed(u16 queue_index)
+{
+    auto& queue = get_queue(queue_index);
+    VERIFY(queue.lock().is_locked());
     if (queue.should_notify())
         notify_queue(queue_index);
 }
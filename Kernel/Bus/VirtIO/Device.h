@@ -33,6 +33,7 @@ namespace Kernel {
 #define DEVICE_STATUS_FAILED (1 << 7)
 
 #define VIRTIO_F_INDIRECT_DESC ((u64)1 << 28)
+#define VIRTIO_F_EVENT_IDX ((u64)1 << 29)
 #define VIRTIO_F_VERSION_1 ((u64)1 << 32)
 #define VIRTIO_F_RING_PACKED ((u64)1 << 34)
 #define VIRTIO_F_IN_ORDER ((u64)1 << 35)
@@ -174,6 +175,8 @@ protected:
     }
 
     void supply_chain_and_notify(u16 queue_index, QueueChain& chain);
+    // For when several chains were submitted to the queue one after another.
+    void notify_queue_if_needed(u16 queue_index);
 
     virtual bool handle_device_config_change() = 0;
     virtual void handle_queue_update(u16 queue_index) = 0;
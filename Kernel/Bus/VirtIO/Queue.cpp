@@ -9,29 +9,41 @@
 
 namespace Kernel::VirtIO {
 
-ErrorOr<NonnullOwnPtr<Queue>> Queue::try_create(u16 queue_size, u16 notify_offset)
+size_t Queue::size_of_driver_area(u16 queue_size)
+{
+    // The flags, the index, the ring and the used event, with the device area that follows aligned to 4 bytes.
+    return align_up_to(sizeof(QueueDriver) + queue_size * sizeof(u16) + sizeof(u16), 4);
+}
+
+size_t Queue::size_of_device_area(u16 queue_size)
+{
+    // The flags, the index, the ring and the available event.
+    return sizeof(QueueDevice) + queue_size * sizeof(QueueDeviceItem) + sizeof(u16);
+}
+
+ErrorOr<NonnullOwnPtr<Queue>> Queue::try_create(u16 queue_size, u16 notify_offset, bool use_event_index)
 {
     size_t size_of_descriptors = sizeof(QueueDescriptor) * queue_size;
-    size_t size_of_driver = sizeof(QueueDriver) + queue_size * sizeof(u16);
-    size_t size_of_device = sizeof(QueueDevice) + queue_size * sizeof(QueueDeviceItem);
+    size_t size_of_driver = size_of_driver_area(queue_size);
+    size_t size_of_device = size_of_device_area(queue_size);
     auto queue_region_size = TRY(Memory::page_round_up(size_of_descriptors + size_of_driver + size_of_device));
     OwnPtr<Memory::Region> queue_region;
     if (queue_region_size <= PAGE_SIZE)
         queue_region = TRY(MM.allocate_kernel_region(queue_region_size, "VirtIO Queue"sv, Memory::Region::Access::ReadWrite));
     else
         queue_region = TRY(MM.allocate_contiguous_kernel_region(queue_region_size, "VirtIO Queue"sv, Memory::Region::Access::ReadWrite));
-    return adopt_nonnull_own_or_enomem(new (nothrow) Queue(queue_region.release_nonnull(), queue_size, notify_offset));
+    return adopt_nonnull_own_or_enomem(new (nothrow) Queue(queue_region.release_nonnull(), queue_size, notify_offset, use_event_index));
 }
 
-Queue::Queue(NonnullOwnPtr<Memory::Region> queue_region, u16 queue_size, u16 notify_offset)
+Queue::Queue(NonnullOwnPtr<Memory::Region> queue_region, u16 queue_size, u16 notify_offset, bool use_event_index)
     : m_queue_size(queue_size)
     , m_notify_offset(notify_offset)
     , m_free_buffers(queue_size)
+    , m_use_event_index(use_event_index)
     , m_queue_region(move(queue_region))
 {
     size_t size_of_descriptors = sizeof(QueueDescriptor) * queue_size;
-    size_t size_of_driver = sizeof(QueueDriver) + queue_size * sizeof(u16);
-    // TODO: ensure alignment!!!
+    size_t size_of_driver = size_of_driver_area(queue_size);
     u8* ptr = m_queue_region->vaddr().as_ptr();
     memset(ptr, 0, m_queue_region->size());
     m_descriptors = reinterpret_cast<QueueDescriptor*>(ptr);
@@ -50,12 +62,18 @@ void Queue::enable_interrupts()
 {
     SpinlockLocker lock(m_lock);
     m_driver->flags = 0;
+    // Ask to be interrupted as soon as the next buffer is used.
+    if (m_use_event_index)
+        used_event() = m_used_tail;
+    full_memory_barrier();
 }
 
 void Queue::disable_interrupts()
 {
     SpinlockLocker lock(m_lock);
-    m_driver->flags = 1;
+    // NOTE: With event indices the device ignores the flag, but it won't interrupt again until the used event is moved
+    //       by enable_interrupts(), except for a buffer that may already be on its way.
+    m_driver->flags = VIRTQ_AVAIL_F_NO_INTERRUPT;
 }
 
 bool Queue::new_data_available() const
@@ -129,9 +147,17 @@ Optional<u16> Queue::take_free_slot()
     return {};
 }
 
-bool Queue::should_notify() const
+bool Queue::should_notify()
 {
     VERIFY(m_lock.is_locked());
+    if (m_use_event_index) {
+        // Make sure that the device sees the new index before we look at the event index it wants to hear about.
+        full_memory_barrier();
+        auto new_index = m_driver_index_shadow;
+        auto old_index = exchange(m_driver_index_at_last_notify, new_index);
+        // Whether the event index lies in between the index at the last notification and the current one (vring_need_event() in the spec).
+        return static_cast<u16>(new_index - avail_event() - 1) < static_cast<u16>(new_index - old_index);
+    }
     auto device_flags = m_device->flags;
     return !(device_flags & VIRTQ_USED_F_NO_NOTIFY);
 }
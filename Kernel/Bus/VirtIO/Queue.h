@@ -28,10 +28,11 @@ enum class BufferType {
 
 class Queue {
 public:
-    static ErrorOr<NonnullOwnPtr<Queue>> try_create(u16 queue_size, u16 notify_offset);
+    static ErrorOr<NonnullOwnPtr<Queue>> try_create(u16 queue_size, u16 notify_offset, bool use_event_index = false);
 
     ~Queue();
 
+    u16 size() const { return m_queue_size; }
     u16 notify_offset() const { return m_notify_offset; }
 
     void enable_interrupts();
@@ -49,10 +50,18 @@ public:
 
     Spinlock<LockRank::None>& lock() { return m_lock; }
 
-    bool should_notify() const;
+    bool should_notify();
 
 private:
-    Queue(NonnullOwnPtr<Memory::Region> queue_region, u16 queue_size, u16 notify_offset);
+    Queue(NonnullOwnPtr<Memory::Region> queue_region, u16 queue_size, u16 notify_offset, bool use_event_index);
+
+    static size_t size_of_driver_area(u16 queue_size);
+    static size_t size_of_device_area(u16 queue_size);
+
+    // With VIRTIO_F_EVENT_IDX, each side tells the other at which index it wants to hear about new buffers, instead of
+    // just turning notifications on or off. These live right behind the rings.
+    u16 volatile& used_event() { return *reinterpret_cast<u16 volatile*>(reinterpret_cast<u8*>(m_driver) + sizeof(QueueDriver) + m_queue_size * sizeof(u16)); }
+    u16 volatile& avail_event() { return *reinterpret_cast<u16 volatile*>(reinterpret_cast<u8*>(m_device) + sizeof(QueueDevice) + m_queue_size * sizeof(QueueDeviceItem)); }
 
     void reclaim_buffer_chain(u16 chain_start_index, u16 chain_end_index, size_t length_of_chain);
 
@@ -91,6 +100,8 @@ private:
     u16 m_free_head { 0 };
     u16 m_used_tail { 0 };
     u16 m_driver_index_shadow { 0 };
+    u16 m_driver_index_at_last_notify { 0 };
+    bool const m_use_event_index { false };
 
     QueueDescriptor* m_descriptors { nullptr };
     QueueDriver* m_driver { nullptr };
@@ -182,6 +182,11 @@ UNMAP_AFTER_INIT bool CommandLine::is_legacy_time_enabled() const
     return lookup("time"sv).value_or("modern"sv) == "legacy"sv;
 }
 
+UNMAP_AFTER_INIT bool CommandLine::is_tickless_enabled() const
+{
+    return lookup("tickless"sv).value_or("on"sv) == "on"sv;
+}
+
 bool CommandLine::is_pc_speaker_enabled() const
 {
     auto value = lookup("pcspeaker"sv).value_or("off"sv);
@@ -325,4 +330,15 @@ UNMAP_AFTER_INIT size_t CommandLine::switch_to_tty() const
     }
     PANIC("Invalid default tty value: {}", default_tty);
 }
+
+UNMAP_AFTER_INIT Optional<size_t> CommandLine::network_rx_descriptor_count() const
+{
+    auto value = lookup("network_rx_descriptors"sv);
+    if (!value.has_value())
+        return {};
+    auto count = value->to_uint<size_t>();
+    if (!count.has_value() || count.value() == 0)
+        PANIC("Invalid network_rx_descriptors value: {}", *value);
+    return count.value();
+}
 }
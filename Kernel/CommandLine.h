@@ -82,6 +82,7 @@ public:
     [[nodiscard]] PCIAccessLevel pci_access_level() const;
     [[nodiscard]] bool is_pci_disabled() const;
     [[nodiscard]] bool is_legacy_time_enabled() const;
+    [[nodiscard]] bool is_tickless_enabled() const;
     [[nodiscard]] bool is_pc_speaker_enabled() const;
     [[nodiscard]] GraphicsSubsystemMode graphics_subsystem_mode() const;
     [[nodiscard]] I8042PresenceMode i8042_presence_mode() const;
@@ -101,6 +102,7 @@ public:
     [[nodiscard]] StringView root_device() const;
     [[nodiscard]] bool is_nvme_polling_enabled() const;
     [[nodiscard]] size_t switch_to_tty() const;
+    [[nodiscard]] Optional<size_t> network_rx_descriptor_count() const;
 
 private:
     CommandLine(StringView);
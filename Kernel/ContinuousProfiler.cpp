@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <AK/OwnPtr.h>
+#include <AK/Singleton.h>
+#include <Kernel/Arch/Processor.h>
+#include <Kernel/Arch/RegisterState.h>
+#include <Kernel/ContinuousProfiler.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Locking/Mutex.h>
+#include <Kernel/Thread.h>
+#include <Kernel/Time/TimeManagement.h>
+
+namespace Kernel {
+
+namespace {
+
+struct SampleRing {
+    explicit SampleRing(NonnullOwnPtr<KBuffer> storage)
+        : storage(move(storage))
+    {
+    }
+
+    ContinuousProfilerSample& at(u64 index)
+    {
+        return reinterpret_cast<ContinuousProfilerSample*>(storage->data())[index % ContinuousProfiler::samples_per_cpu];
+    }
+
+    NonnullOwnPtr<KBuffer> storage;
+
+    // Both of these count samples since the ring was created, and are only ever written by the CPU owning the ring.
+    // A slot is being overwritten whenever `started` is ahead of `completed`.
+    Atomic<u64> started { 0 };
+    Atomic<u64> completed { 0 };
+
+    // The index of the first sample that has not been drained yet, protected by s_lock.
+    u64 next_to_drain { 0 };
+};
+
+}
+
+static Atomic<bool> s_enabled { false };
+static Array<SampleRing*, MAX_CPU_COUNT> s_rings {};
+static Singleton<Mutex> s_lock;
+
+bool ContinuousProfiler::is_enabled()
+{
+    return s_enabled.load(AK::MemoryOrder::memory_order_relaxed);
+}
+
+ErrorOr<void> ContinuousProfiler::enable()
+{
+    MutexLocker locker(*s_lock);
+    if (s_enabled.load(AK::MemoryOrder::memory_order_relaxed))
+        return {};
+
+    for (u32 cpu = 0; cpu < Processor::count(); ++cpu) {
+        if (auto* ring = s_rings[cpu]) {
+            // Don't hand out samples from an earlier session.
+            ring->next_to_drain = ring->completed.load(AK::MemoryOrder::memory_order_acquire);
+            continue;
+        }
+        auto storage = TRY(KBuffer::try_create_with_size("ContinuousProfiler: Samples"sv, samples_per_cpu * sizeof(ContinuousProfilerSample)));
+        auto ring = TRY(adopt_nonnull_own_or_enomem(new (nothrow) SampleRing(move(storage))));
+        s_rings[cpu] = ring.leak_ptr();
+    }
+
+    if (!TimeManagement::the().enable_profile_timer())
+        return ENOTSUP;
+    s_enabled.store(true, AK::MemoryOrder::memory_order_release);
+    return {};
+}
+
+void ContinuousProfiler::disable()
+{
+    MutexLocker locker(*s_lock);
+    if (!s_enabled.exchange(false, AK::MemoryOrder::memory_order_relaxed))
+        return;
+    TimeManagement::the().disable_profile_timer();
+}
+
+void ContinuousProfiler::add_sample(Thread& thread, RegisterState const& regs, u32 lost_samples)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    if (!s_enabled.load(AK::MemoryOrder::memory_order_acquire))
+        return;
+    if (thread.is_profiling_suppressed())
+        return;
+    auto* ring = s_rings[Processor::current_id()];
+    if (!ring)
+        return;
+
+    auto index = ring->completed.load(AK::MemoryOrder::memory_order_relaxed);
+    ring->started.store(index + 1, AK::MemoryOrder::memory_order_relaxed);
+    // Make sure readers see that the old sample in this slot is gone before they could see any part of the new one.
+    AK::atomic_thread_fence(AK::MemoryOrder::memory_order_release);
+
+    auto& sample = ring->at(index);
+    auto backtrace = PerformanceEventBuffer::raw_backtrace(regs.bp(), regs.ip());
+    sample.timestamp_ns = TimeManagement::the().monotonic_time(TimePrecision::Coarse).to_nanoseconds();
+    sample.pid = thread.pid().value();
+    sample.tid = thread.tid().value();
+    sample.lost_samples = lost_samples;
+    sample.stack_size = backtrace.size();
+    memcpy(sample.stack, backtrace.data(), backtrace.size() * sizeof(FlatPtr));
+
+    ring->completed.store(index + 1, AK::MemoryOrder::memory_order_release);
+}
+
+ErrorOr<ContinuousProfiler::DrainStatistics> ContinuousProfiler::drain(Function<ErrorOr<void>(u32 cpu, ContinuousProfilerSample const&)> callback)
+{
+    MutexLocker locker(*s_lock);
+    DrainStatistics statistics;
+    for (u32 cpu = 0; cpu < Processor::count(); ++cpu) {
+        auto* ring = s_rings[cpu];
+        if (!ring)
+            continue;
+
+        auto completed = ring->completed.load(AK::MemoryOrder::memory_order_acquire);
+        if (completed - ring->next_to_drain > samples_per_cpu) {
+            statistics.overwritten += completed - samples_per_cpu - ring->next_to_drain;
+            ring->next_to_drain = completed - samples_per_cpu;
+        }
+
+        ContinuousProfilerSample sample;
+        for (; ring->next_to_drain < completed; ++ring->next_to_drain) {
+            auto index = ring->next_to_drain;
+            sample = ring->at(index);
+            // The copy is only good if the writer didn't start reusing the slot while we were reading it.
+            AK::atomic_thread_fence(AK::MemoryOrder::memory_order_acquire);
+            auto started = ring->started.load(AK::MemoryOrder::memory_order_relaxed);
+            if (index + samples_per_cpu < started) {
+                ++statistics.overwritten;
+                continue;
+            }
+            sample.stack_size = min(sample.stack_size, static_cast<u32>(PerformanceEvent::max_stack_frame_count));
+            TRY(callback(cpu, sample));
+        }
+    }
+    return statistics;
+}
+
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/Function.h>
+#include <AK/Types.h>
+#include <Kernel/PerformanceEventBuffer.h>
+
+namespace Kernel {
+
+class Thread;
+struct RegisterState;
+
+struct ContinuousProfilerSample {
+    u64 timestamp_ns;
+    pid_t pid;
+    pid_t tid;
+    u32 lost_samples;
+    u32 stack_size;
+    FlatPtr stack[PerformanceEvent::max_stack_frame_count];
+};
+
+// Samples whatever runs on each processor into a fixed-size ring per CPU, so it can stay enabled indefinitely.
+// Every ring has exactly one writer, the profile timer interrupt on its own CPU, which takes no locks and
+// overwrites the oldest samples when they have not been read in time. Readers drain everything recorded since
+// the previous drain without ever holding up the writers, and skip samples that were overwritten while copying.
+class ContinuousProfiler {
+public:
+    static constexpr size_t samples_per_cpu = 1024;
+
+    static bool is_enabled();
+
+    // NOTE: The rings are allocated on first use and stay around afterwards, since an interrupt on another CPU
+    //       might be writing into them at any time.
+    static ErrorOr<void> enable();
+    static void disable();
+
+    static void add_sample(Thread&, RegisterState const&, u32 lost_samples);
+
+    struct DrainStatistics {
+        u64 overwritten { 0 };
+    };
+
+    // Calls the callback for every sample recorded since the last drain, grouped by CPU and ordered by time.
+    static ErrorOr<DrainStatistics> drain(Function<ErrorOr<void>(u32 cpu, ContinuousProfilerSample const&)>);
+};
+
+}
@@ -7,6 +7,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AnyOf.h>
 #include <AK/ByteBuffer.h>
 #include <AK/JsonObjectSerializer.h>
 #include <AK/Singleton.h>
@@ -23,6 +24,12 @@
 
 #define INCLUDE_USERSPACE_HEAP_MEMORY_IN_COREDUMPS 0
 
+// Runs of untouched pages shorter than this are written out as zeroes, so that fragmented regions don't end up as
+// lots of tiny segments.
+static constexpr size_t minimum_pages_in_skipped_run = 16;
+// The number of pages that are copied out of the process at a time.
+static constexpr size_t pages_per_write = 16;
+
 static Singleton<SpinlockProtected<OwnPtr<KString>, LockRank::None>> s_coredump_directory_path;
 
 namespace Kernel {
@@ -78,18 +85,90 @@ Coredump::Coredump(NonnullLockRefPtr<Process> process, NonnullLockRefPtr<OpenFil
     , m_description(move(description))
     , m_regions(move(regions))
 {
-    m_num_program_headers = 0;
-    for (auto& region : m_regions) {
+}
+
+bool Coredump::should_include_region(FlatRegionData const& region) const
+{
 #if !INCLUDE_USERSPACE_HEAP_MEMORY_IN_COREDUMPS
-        if (region.looks_like_userspace_heap_region())
-            continue;
+    if (region.looks_like_userspace_heap_region())
+        return false;
 #endif
 
-        if (region.access() == Memory::Region::Access::None)
+    return region.access() != Memory::Region::Access::None;
+}
+
+static bool page_has_data(Memory::PhysicalPage const* page)
+{
+    return page && !page->is_shared_zero_page() && !page->is_lazy_committed_page();
+}
+
+ErrorOr<void> Coredump::create_segments()
+{
+    // Note: e_phnum and the program header indices in the notes are 16 bits wide, and PN_XNUM is reserved. Regions
+    //       are no longer split up once we get close to that, and are written out in one piece instead.
+    static constexpr size_t max_segment_count = PN_XNUM - 1;
+    size_t remaining_region_count = 0;
+    for (auto& region : m_regions) {
+        if (should_include_region(region))
+            ++remaining_region_count;
+    }
+
+    for (size_t region_index = 0; region_index < m_regions.size(); ++region_index) {
+        auto& region = m_regions[region_index];
+        VERIFY(!region.is_kernel());
+        if (!should_include_region(region))
+            continue;
+        --remaining_region_count;
+
+        Vector<Segment> region_segments;
+        TRY(m_process->address_space().with([&](auto& space) -> ErrorOr<void> {
+            auto* real_region = space->region_tree().regions().find(region.vaddr().get());
+
+            if (!real_region)
+                return Error::from_string_view("Failed to find matching region in the process"sv);
+
+            if (!region.is_consistent_with_region(*real_region))
+                return Error::from_string_view("Found region does not match stored metadata"sv);
+
+            // If we crashed in the middle of mapping in Regions, they do not have a page directory yet, and will crash on a remap() call
+            if (!real_region->is_mapped() || (real_region->vmobject().is_inode() && !region.is_writable()))
+                return region_segments.try_append({ region_index, region.vaddr(), region.page_count(), false });
+
+            real_region->set_readable(true);
+            real_region->remap();
+
+            // Find the runs of pages with and without data first...
+            Vector<Segment> runs;
+            for (size_t i = 0; i < region.page_count(); ++i) {
+                bool has_data = page_has_data(real_region->physical_page(i).ptr());
+                if (!runs.is_empty() && runs.last().has_data == has_data)
+                    ++runs.last().page_count;
+                else
+                    TRY(runs.try_append({ region_index, region.vaddr().offset(i * PAGE_SIZE), 1, has_data }));
+            }
+
+            // ...and then write short runs without data out as zeroes, along with the data around them.
+            for (auto& run : runs) {
+                if (!run.has_data && run.page_count < minimum_pages_in_skipped_run)
+                    run.has_data = true;
+                if (!region_segments.is_empty() && region_segments.last().has_data == run.has_data)
+                    region_segments.last().page_count += run.page_count;
+                else
+                    TRY(region_segments.try_append(run));
+            }
+            return {};
+        }));
+
+        if (m_segments.size() + region_segments.size() + remaining_region_count + 1 > max_segment_count) {
+            bool has_data = any_of(region_segments, [](auto& segment) { return segment.has_data; });
+            TRY(m_segments.try_append({ region_index, region.vaddr(), region.page_count(), has_data }));
             continue;
-        ++m_num_program_headers;
+        }
+        TRY(m_segments.try_extend(move(region_segments)));
     }
-    ++m_num_program_headers; // +1 for NOTE segment
+
+    m_num_program_headers = m_segments.size() + 1; // +1 for NOTE segment
+    return {};
 }
 
 ErrorOr<NonnullLockRefPtr<OpenFileDescription>> Coredump::try_create_target_file(Process const& process, StringView output_path)
@@ -162,24 +241,19 @@ ErrorOr<void> Coredump::write_elf_header()
 ErrorOr<void> Coredump::write_program_headers(size_t notes_size)
 {
     size_t offset = sizeof(ElfW(Ehdr)) + m_num_program_headers * sizeof(ElfW(Phdr));
-    for (auto& region : m_regions) {
-#if !INCLUDE_USERSPACE_HEAP_MEMORY_IN_COREDUMPS
-        if (region.looks_like_userspace_heap_region())
-            continue;
-#endif
-
-        if (region.access() == Memory::Region::Access::None)
-            continue;
+    for (auto& segment : m_segments) {
+        auto& region = m_regions[segment.region_index];
 
         ElfW(Phdr) phdr {};
 
         phdr.p_type = PT_LOAD;
         phdr.p_offset = offset;
-        phdr.p_vaddr = region.vaddr().get();
+        phdr.p_vaddr = segment.vaddr.get();
         phdr.p_paddr = 0;
 
-        phdr.p_filesz = region.page_count() * PAGE_SIZE;
-        phdr.p_memsz = region.page_count() * PAGE_SIZE;
+        // Note: Segments without data read as zeroes, just like the part of any PT_LOAD segment past its p_filesz.
+        phdr.p_filesz = segment.has_data ? segment.page_count * PAGE_SIZE : 0;
+        phdr.p_memsz = segment.page_count * PAGE_SIZE;
         phdr.p_align = 0;
 
         phdr.p_flags = region.is_readable() ? PF_R : 0;
@@ -210,52 +284,43 @@ ErrorOr<void> Coredump::write_program_headers(size_t notes_size)
 
 ErrorOr<void> Coredump::write_regions()
 {
-    u8 zero_buffer[PAGE_SIZE] = {};
-
-    for (auto& region : m_regions) {
-        VERIFY(!region.is_kernel());
-
-#if !INCLUDE_USERSPACE_HEAP_MEMORY_IN_COREDUMPS
-        if (region.looks_like_userspace_heap_region())
-            continue;
-#endif
+    // Note: The process' memory is copied out a few pages at a time, as the address space can't stay locked while
+    //       writing to the file, and a buffer as large as the biggest region may not be available.
+    auto buffer = TRY(KBuffer::try_create_with_size("Coredump Region Copy Buffer"sv, pages_per_write * PAGE_SIZE));
 
-        if (region.access() == Memory::Region::Access::None)
+    for (auto& segment : m_segments) {
+        if (!segment.has_data)
             continue;
 
-        auto buffer = TRY(KBuffer::try_create_with_size("Coredump Region Copy Buffer"sv, region.page_count() * PAGE_SIZE));
+        auto& region = m_regions[segment.region_index];
+        size_t first_page_in_region = (segment.vaddr.get() - region.vaddr().get()) / PAGE_SIZE;
+        for (size_t first_page = 0; first_page < segment.page_count; first_page += pages_per_write) {
+            auto page_count = min(pages_per_write, segment.page_count - first_page);
+            auto chunk = buffer->bytes().trim(page_count * PAGE_SIZE);
 
-        TRY(m_process->address_space().with([&](auto& space) -> ErrorOr<void> {
-            auto* real_region = space->region_tree().regions().find(region.vaddr().get());
+            TRY(m_process->address_space().with([&](auto& space) -> ErrorOr<void> {
+                auto* real_region = space->region_tree().regions().find(region.vaddr().get());
 
-            if (!real_region)
-                return Error::from_string_view("Failed to find matching region in the process"sv);
+                // Note: The access of the region has already been changed by create_segments(), so it isn't checked here.
+                if (!real_region || real_region->size() != region.size())
+                    return Error::from_string_view("Region changed while writing coredump"sv);
 
-            if (!region.is_consistent_with_region(*real_region))
-                return Error::from_string_view("Found region does not match stored metadata"sv);
-
-            // If we crashed in the middle of mapping in Regions, they do not have a page directory yet, and will crash on a remap() call
-            if (!real_region->is_mapped())
-                return {};
-
-            real_region->set_readable(true);
-            real_region->remap();
-
-            for (size_t i = 0; i < region.page_count(); i++) {
-                auto page = real_region->physical_page(i);
-                auto src_buffer = [&]() -> ErrorOr<UserOrKernelBuffer> {
-                    if (page)
-                        return UserOrKernelBuffer::for_user_buffer(reinterpret_cast<uint8_t*>((region.vaddr().as_ptr() + (i * PAGE_SIZE))), PAGE_SIZE);
+                for (size_t i = 0; i < page_count; i++) {
+                    auto page_index = first_page_in_region + first_page + i;
+                    auto destination = chunk.slice(i * PAGE_SIZE, PAGE_SIZE);
                     // If the current page is not backed by a physical page, we zero it in the coredump file.
-                    return UserOrKernelBuffer::for_kernel_buffer(zero_buffer);
-                }();
-                TRY(src_buffer.value().read(buffer->bytes().slice(i * PAGE_SIZE, PAGE_SIZE)));
-            }
-
-            return {};
-        }));
+                    if (!page_has_data(real_region->physical_page(page_index).ptr())) {
+                        destination.fill(0);
+                        continue;
+                    }
+                    auto source = TRY(UserOrKernelBuffer::for_user_buffer(region.vaddr().offset(page_index * PAGE_SIZE).as_ptr(), PAGE_SIZE));
+                    TRY(source.read(destination));
+                }
+                return {};
+            }));
 
-        TRY(m_description->write(UserOrKernelBuffer::for_kernel_buffer(buffer->data()), buffer->size()));
+            TRY(m_description->write(UserOrKernelBuffer::for_kernel_buffer(chunk.data()), chunk.size()));
+        }
     }
 
     return {};
@@ -317,14 +382,10 @@ ErrorOr<void> Coredump::create_notes_threads_data(auto& builder) const
 
 ErrorOr<void> Coredump::create_notes_regions_data(auto& builder) const
 {
-    size_t region_index = 0;
-    for (auto const& region : m_regions) {
-#if !INCLUDE_USERSPACE_HEAP_MEMORY_IN_COREDUMPS
-        if (region.looks_like_userspace_heap_region())
-            continue;
-#endif
-
-        if (region.access() == Memory::Region::Access::None)
+    size_t segment_index = 0;
+    for (size_t region_index = 0; region_index < m_regions.size(); ++region_index) {
+        auto const& region = m_regions[region_index];
+        if (!should_include_region(region))
             continue;
 
         ELF::Core::MemoryRegionInfo info {};
@@ -332,7 +393,11 @@ ErrorOr<void> Coredump::create_notes_regions_data(auto& builder) const
 
         info.region_start = region.vaddr().get();
         info.region_end = region.vaddr().offset(region.size()).get();
-        info.program_header_index = region_index++;
+        // Note: This is the first of the segments of the region, the others follow it.
+        while (segment_index < m_segments.size() && m_segments[segment_index].region_index != region_index)
+            ++segment_index;
+        VERIFY(segment_index < m_segments.size());
+        info.program_header_index = segment_index;
 
         TRY(builder.append_bytes(ReadonlyBytes { (void*)&info, sizeof(info) }));
 
@@ -383,6 +448,7 @@ ErrorOr<void> Coredump::write()
 {
     ScopedAddressSpaceSwitcher switcher(m_process);
 
+    TRY(create_segments());
     auto builder = TRY(KBufferBuilder::try_create());
     TRY(create_notes_segment_data(builder));
     TRY(write_elf_header());
@@ -65,9 +65,22 @@ private:
         VirtualAddress m_vaddr;
     };
 
+    // Every region is written as one or more PT_LOAD segments. The contents of a segment are only written if it has
+    // any data, which leaves out runs of pages that have never been touched and regions that are read-only mappings of
+    // a file (whose contents can be found in the file itself).
+    struct Segment {
+        size_t region_index { 0 };
+        VirtualAddress vaddr;
+        size_t page_count { 0 };
+        bool has_data { false };
+    };
+
     Coredump(NonnullLockRefPtr<Process>, NonnullLockRefPtr<OpenFileDescription>, Vector<FlatRegionData>);
     static ErrorOr<NonnullLockRefPtr<OpenFileDescription>> try_create_target_file(Process const&, StringView output_path);
 
+    bool should_include_region(FlatRegionData const&) const;
+    ErrorOr<void> create_segments();
+
     ErrorOr<void> write_elf_header();
     ErrorOr<void> write_program_headers(size_t notes_size);
     ErrorOr<void> write_regions();
@@ -83,6 +96,7 @@ private:
     NonnullLockRefPtr<OpenFileDescription> m_description;
     size_t m_num_program_headers { 0 };
     Vector<FlatRegionData> m_regions;
+    Vector<Segment> m_segments;
 };
 
 }
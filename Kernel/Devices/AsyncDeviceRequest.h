@@ -74,6 +74,9 @@ public:
 
     void complete(RequestResult result);
 
+    // Note: This only changes with the request queue of the device locked, see do_start().
+    bool was_started() const { return m_result != Pending; }
+
     void set_private(void* priv)
     {
         VERIFY(!m_private || !priv);
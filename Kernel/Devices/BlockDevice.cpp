@@ -6,9 +6,13 @@
 
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/DeviceIdentifiers/BlockDevicesDirectory.h>
+#include <Kernel/Time/TimeManagement.h>
 
 namespace Kernel {
 
+static constexpr Time read_request_expiry = Time::from_milliseconds(500);
+static constexpr Time write_request_expiry = Time::from_seconds(5);
+
 AsyncBlockDeviceRequest::AsyncBlockDeviceRequest(Device& block_device, RequestType request_type, u64 block_index, u32 block_count, UserOrKernelBuffer const& buffer, size_t buffer_size)
     : AsyncDeviceRequest(block_device)
     , m_block_device(static_cast<BlockDevice&>(block_device))
@@ -17,6 +21,7 @@ AsyncBlockDeviceRequest::AsyncBlockDeviceRequest(Device& block_device, RequestTy
     , m_block_count(block_count)
     , m_buffer(buffer)
     , m_buffer_size(buffer_size)
+    , m_deadline(TimeManagement::the().monotonic_time() + (request_type == Read ? read_request_expiry : write_request_expiry))
 {
 }
 
@@ -25,6 +30,33 @@ void AsyncBlockDeviceRequest::start()
     m_block_device.start_request(*this);
 }
 
+AsyncDeviceRequest& BlockDevice::choose_next_queued_request(RequestQueue& queued_requests)
+{
+    // Only AsyncBlockDeviceRequests are ever made on block devices.
+    auto& oldest_request = static_cast<AsyncBlockDeviceRequest&>(Device::choose_next_queued_request(queued_requests));
+    AsyncBlockDeviceRequest* chosen_request = nullptr;
+    if (oldest_request.deadline() <= TimeManagement::the().monotonic_time()) {
+        chosen_request = &oldest_request;
+    } else {
+        // Sweep across the disk in one direction (C-LOOK): take the nearest request at or after the position of
+        // the last one, and wrap around to the lowest block once there's nothing left ahead of it.
+        AsyncBlockDeviceRequest* nearest_ahead = nullptr;
+        AsyncBlockDeviceRequest* lowest = nullptr;
+        for (auto& queued_request : queued_requests) {
+            if (queued_request->was_started())
+                continue;
+            auto& request = static_cast<AsyncBlockDeviceRequest&>(*queued_request);
+            if (request.block_index() >= m_next_block_index_after_last_request && (!nearest_ahead || request.block_index() < nearest_ahead->block_index()))
+                nearest_ahead = &request;
+            if (!lowest || request.block_index() < lowest->block_index())
+                lowest = &request;
+        }
+        chosen_request = nearest_ahead ? nearest_ahead : lowest;
+    }
+    m_next_block_index_after_last_request = chosen_request->block_index() + chosen_request->block_count();
+    return *chosen_request;
+}
+
 BlockDevice::~BlockDevice() = default;
 
 void BlockDevice::after_inserting_add_symlink_to_device_identifier_directory()
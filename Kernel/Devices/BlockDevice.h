@@ -41,6 +41,8 @@ protected:
 protected:
     virtual bool is_block_device() const final { return true; }
 
+    virtual AsyncDeviceRequest& choose_next_queued_request(RequestQueue&) override;
+
     virtual void after_inserting_add_symlink_to_device_identifier_directory() override final;
     virtual void before_will_be_destroyed_remove_symlink_from_device_identifier_directory() override final;
 
@@ -51,6 +53,9 @@ private:
 
     size_t m_block_size { 0 };
     u8 m_block_size_log { 0 };
+
+    // The block right after the last request we chose to start, i.e. roughly where the disk head is now.
+    u64 m_next_block_index_after_last_request { 0 };
 };
 
 class AsyncBlockDeviceRequest final : public AsyncDeviceRequest {
@@ -70,6 +75,10 @@ public:
     UserOrKernelBuffer const& buffer() const { return m_buffer; }
     size_t buffer_size() const { return m_buffer_size; }
 
+    // Requests are normally served in the order of their blocks, but one that has waited past its deadline goes first.
+    // Reads get a much shorter deadline than writes, since somebody is usually waiting for them to finish.
+    Time deadline() const { return m_deadline; }
+
     virtual void start() override;
     virtual StringView name() const override
     {
@@ -90,6 +99,7 @@ private:
     const u32 m_block_count;
     UserOrKernelBuffer m_buffer;
     const size_t m_buffer_size;
+    const Time m_deadline;
 };
 
 }
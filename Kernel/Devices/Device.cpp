@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AnyOf.h>
 #include <AK/Singleton.h>
 #include <Kernel/Devices/Device.h>
 #include <Kernel/Devices/DeviceManagement.h>
@@ -69,15 +70,32 @@ ErrorOr<NonnullLockRefPtr<OpenFileDescription>> Device::open(int options)
     return File::open(options);
 }
 
+AsyncDeviceRequest& Device::choose_next_queued_request(RequestQueue& queued_requests)
+{
+    for (auto& request : queued_requests) {
+        if (!request->was_started())
+            return *request;
+    }
+    VERIFY_NOT_REACHED();
+}
+
 void Device::process_next_queued_request(Badge<AsyncDeviceRequest>, AsyncDeviceRequest const& completed_request)
 {
     SpinlockLocker lock(m_requests_lock);
     VERIFY(!m_requests.is_empty());
-    VERIFY(m_requests.first().ptr() == &completed_request);
-    m_requests.remove(m_requests.begin());
-    if (!m_requests.is_empty()) {
-        auto* next_request = m_requests.first().ptr();
-        next_request->do_start(move(lock));
+    // Requests may be started out of order and several at once, so the completed one isn't necessarily the first.
+    auto it = m_requests.begin();
+    while (it != m_requests.end() && it->ptr() != &completed_request)
+        ++it;
+    VERIFY(it != m_requests.end());
+    m_requests.remove(it);
+    VERIFY(m_started_requests_count > 0);
+    m_started_requests_count--;
+    bool has_unstarted_requests = any_of(m_requests, [](auto& request) { return !request->was_started(); });
+    if (has_unstarted_requests && m_started_requests_count < queue_depth()) {
+        auto& next_request = choose_next_queued_request(m_requests);
+        m_started_requests_count++;
+        next_request.do_start(move(lock));
     }
 
     evaluate_block_conditions();
@@ -54,15 +54,20 @@ public:
     virtual bool is_openable_by_jailed_processes() const { return false; }
     void process_next_queued_request(Badge<AsyncDeviceRequest>, AsyncDeviceRequest const&);
 
+    // How many of the queued requests may be started (and be in flight) at the same time.
+    virtual size_t queue_depth() const { return 1; }
+
     template<typename AsyncRequestType, typename... Args>
     ErrorOr<NonnullLockRefPtr<AsyncRequestType>> try_make_request(Args&&... args)
     {
         auto request = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) AsyncRequestType(*this, forward<Args>(args)...)));
         SpinlockLocker lock(m_requests_lock);
-        bool was_empty = m_requests.is_empty();
         TRY(m_requests.try_append(request));
-        if (was_empty)
-            request->do_start(move(lock));
+        if (m_started_requests_count < queue_depth()) {
+            auto& next_request = choose_next_queued_request(m_requests);
+            m_started_requests_count++;
+            next_request.do_start(move(lock));
+        }
         return request;
     }
 
@@ -72,6 +77,12 @@ protected:
     void set_gid(GroupID gid) { m_gid = gid; }
 
     void after_inserting_add_to_device_management();
+
+    using RequestQueue = DoublyLinkedList<LockRefPtr<AsyncDeviceRequest>>;
+
+    // Picks which of the queued requests that haven't been started yet to start next, whenever there is room for one.
+    // The queue is in the order the requests were made, and locked while this is called.
+    virtual AsyncDeviceRequest& choose_next_queued_request(RequestQueue&);
     void before_will_be_destroyed_remove_from_device_management();
 
     virtual void after_inserting_add_symlink_to_device_identifier_directory() = 0;
@@ -91,7 +102,8 @@ private:
     State m_state { State::Normal };
 
     Spinlock<LockRank::None> m_requests_lock {};
-    DoublyLinkedList<LockRefPtr<AsyncDeviceRequest>> m_requests;
+    RequestQueue m_requests;
+    size_t m_started_requests_count { 0 };
 
 protected:
     // FIXME: This pointer will be eventually removed after all nodes in /sys/dev/block/ and
@@ -17,17 +17,24 @@ inline void DoubleBuffer::compute_lockfree_metadata()
     m_space_for_writing = m_capacity - m_write_buffer->size;
 }
 
-ErrorOr<NonnullOwnPtr<DoubleBuffer>> DoubleBuffer::try_create(StringView name, size_t capacity)
+ErrorOr<NonnullOwnPtr<DoubleBuffer>> DoubleBuffer::try_create(StringView name, size_t capacity, size_t maximum_capacity)
 {
+    maximum_capacity = max(capacity, maximum_capacity);
+    // The name is only needed again for the storage of a grown buffer.
+    OwnPtr<KString> growable_name;
+    if (maximum_capacity > capacity)
+        growable_name = TRY(KString::try_create(name));
     auto storage = TRY(KBuffer::try_create_with_size(name, capacity * 2, Memory::Region::Access::ReadWrite));
-    return adopt_nonnull_own_or_enomem(new (nothrow) DoubleBuffer(capacity, move(storage)));
+    return adopt_nonnull_own_or_enomem(new (nothrow) DoubleBuffer(capacity, maximum_capacity, move(storage), move(growable_name)));
 }
 
-DoubleBuffer::DoubleBuffer(size_t capacity, NonnullOwnPtr<KBuffer> storage)
+DoubleBuffer::DoubleBuffer(size_t capacity, size_t maximum_capacity, NonnullOwnPtr<KBuffer> storage, OwnPtr<KString> name)
     : m_write_buffer(&m_buffer1)
     , m_read_buffer(&m_buffer2)
     , m_storage(move(storage))
+    , m_name(move(name))
     , m_capacity(capacity)
+    , m_maximum_capacity(maximum_capacity)
 {
     m_buffer1.data = m_storage->data();
     m_buffer1.size = 0;
@@ -45,11 +52,47 @@ void DoubleBuffer::flip()
     compute_lockfree_metadata();
 }
 
+ErrorOr<void> DoubleBuffer::try_grow(size_t minimum_capacity)
+{
+    auto new_capacity = m_capacity;
+    while (new_capacity < minimum_capacity && new_capacity < m_maximum_capacity)
+        new_capacity *= 2;
+    new_capacity = min(new_capacity, m_maximum_capacity);
+    if (new_capacity <= m_capacity)
+        return {};
+
+    auto new_storage = TRY(KBuffer::try_create_with_size(m_name->view(), new_capacity * 2, Memory::Region::Access::ReadWrite));
+
+    // Whatever hasn't been read yet moves to the start of the new halves.
+    auto unread_size = m_read_buffer->size - m_read_buffer_index;
+    auto written_size = m_write_buffer->size;
+    memcpy(new_storage->data(), m_read_buffer->data + m_read_buffer_index, unread_size);
+    memcpy(new_storage->data() + new_capacity, m_write_buffer->data, written_size);
+
+    m_read_buffer = &m_buffer1;
+    m_write_buffer = &m_buffer2;
+    m_buffer1 = { new_storage->data(), unread_size };
+    m_buffer2 = { new_storage->data() + new_capacity, written_size };
+    m_read_buffer_index = 0;
+    m_storage = move(new_storage);
+    m_capacity = new_capacity;
+    compute_lockfree_metadata();
+    return {};
+}
+
 ErrorOr<size_t> DoubleBuffer::write(UserOrKernelBuffer const& data, size_t size)
 {
     if (!size)
         return 0;
     MutexLocker locker(m_lock);
+    if (size > m_space_for_writing) {
+        // If the reader is done with its half, the writer can have it right away rather than waiting for the next read.
+        if (m_read_buffer_index >= m_read_buffer->size)
+            flip();
+        // Not being able to grow only means that less gets written for now.
+        if (size > m_space_for_writing && m_capacity < m_maximum_capacity)
+            (void)try_grow(m_write_buffer->size + size);
+    }
     size_t bytes_to_write = min(size, m_space_for_writing);
     u8* write_ptr = m_write_buffer->data + m_write_buffer->size;
     TRY(data.read(write_ptr, bytes_to_write));
@@ -64,14 +107,26 @@ ErrorOr<size_t> DoubleBuffer::read_impl(UserOrKernelBuffer& data, size_t size, M
 {
     if (size == 0)
         return 0;
-    if (m_read_buffer_index >= m_read_buffer->size && m_write_buffer->size != 0)
-        flip();
-    if (m_read_buffer_index >= m_read_buffer->size)
+    size_t nread = 0;
+    // A read can drain both halves, so that a large reader doesn't need a separate call for each of them.
+    while (nread < size) {
+        if (m_read_buffer_index >= m_read_buffer->size && m_write_buffer->size != 0)
+            flip();
+        if (m_read_buffer_index >= m_read_buffer->size)
+            break;
+        size_t chunk_size = min(m_read_buffer->size - m_read_buffer_index, size - nread);
+        if (auto result = data.write(m_read_buffer->data + m_read_buffer_index, nread, chunk_size); result.is_error()) {
+            if (nread == 0)
+                return result.release_error();
+            break;
+        }
+        nread += chunk_size;
+        if (!advance_buffer_index)
+            break;
+        m_read_buffer_index += chunk_size;
+    }
+    if (nread == 0)
         return 0;
-    size_t nread = min(m_read_buffer->size - m_read_buffer_index, size);
-    TRY(data.write(m_read_buffer->data + m_read_buffer_index, nread));
-    if (advance_buffer_index)
-        m_read_buffer_index += nread;
     compute_lockfree_metadata();
     if (m_unblock_callback && m_space_for_writing > 0)
         m_unblock_callback();
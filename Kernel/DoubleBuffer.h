@@ -8,6 +8,7 @@
 
 #include <AK/Types.h>
 #include <Kernel/KBuffer.h>
+#include <Kernel/KString.h>
 #include <Kernel/Locking/Mutex.h>
 #include <Kernel/Thread.h>
 #include <Kernel/UserOrKernelBuffer.h>
@@ -16,7 +17,8 @@ namespace Kernel {
 
 class DoubleBuffer {
 public:
-    static ErrorOr<NonnullOwnPtr<DoubleBuffer>> try_create(StringView name, size_t capacity = 65536);
+    // If `maximum_capacity` is larger than `capacity`, the buffer grows (up to that) whenever a write doesn't fit.
+    static ErrorOr<NonnullOwnPtr<DoubleBuffer>> try_create(StringView name, size_t capacity = 65536, size_t maximum_capacity = 0);
     ErrorOr<size_t> write(UserOrKernelBuffer const&, size_t);
     ErrorOr<size_t> write(u8 const* data, size_t size)
     {
@@ -50,8 +52,9 @@ public:
     }
 
 private:
-    explicit DoubleBuffer(size_t capacity, NonnullOwnPtr<KBuffer> storage);
+    DoubleBuffer(size_t capacity, size_t maximum_capacity, NonnullOwnPtr<KBuffer> storage, OwnPtr<KString> name);
     void flip();
+    ErrorOr<void> try_grow(size_t minimum_capacity);
     void compute_lockfree_metadata();
 
     ErrorOr<size_t> read_impl(UserOrKernelBuffer&, size_t, MutexLocker&, bool advance_buffer_index);
@@ -67,8 +70,10 @@ private:
     InnerBuffer m_buffer2;
 
     NonnullOwnPtr<KBuffer> m_storage;
+    OwnPtr<KString> m_name;
     Function<void()> m_unblock_callback;
     size_t m_capacity { 0 };
+    size_t m_maximum_capacity { 0 };
     size_t m_read_buffer_index { 0 };
     size_t m_space_for_writing { 0 };
     bool m_empty { true };
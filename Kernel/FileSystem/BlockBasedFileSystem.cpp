@@ -5,9 +5,13 @@
  */
 
 #include <AK/IntrusiveList.h>
+#include <AK/QuickSort.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Memory/MemoryManager.h>
 #include <Kernel/Process.h>
+#include <Kernel/Tasks/SyncTask.h>
 
 namespace Kernel {
 
@@ -18,70 +22,118 @@ struct CacheEntry {
     bool has_data { false };
 };
 
-class DiskCache {
-public:
-    static constexpr size_t EntryCount = 10000;
-    explicit DiskCache(BlockBasedFileSystem& fs, NonnullOwnPtr<KBuffer> cached_block_data, NonnullOwnPtr<KBuffer> entries_buffer)
-        : m_fs(fs)
-        , m_cached_block_data(move(cached_block_data))
-        , m_entries(move(entries_buffer))
-    {
-        for (size_t i = 0; i < EntryCount; ++i) {
-            entries()[i].data = m_cached_block_data->data() + i * m_fs->block_size();
-            m_clean_list.append(entries()[i]);
-        }
-    }
-
-    ~DiskCache() = default;
-
-    bool is_dirty() const { return !m_dirty_list.is_empty(); }
-    bool entry_is_dirty(CacheEntry const& entry) const { return m_dirty_list.contains(entry); }
+// Blocks are distributed over a fixed number of shards by their index, and every
+// shard has its own lock, so accesses to unrelated blocks don't contend.
+struct DiskCacheShard {
+    bool is_dirty() const { return !dirty_list.is_empty(); }
+    bool entry_is_dirty(CacheEntry const& entry) const { return dirty_list.contains(entry); }
 
     void mark_all_clean()
     {
-        while (auto* entry = m_dirty_list.first())
-            m_clean_list.prepend(*entry);
+        while (auto* entry = dirty_list.first())
+            clean_list.prepend(*entry);
+        dirty_count = 0;
     }
 
     void mark_dirty(CacheEntry& entry)
     {
-        m_dirty_list.prepend(entry);
-    }
-
-    void mark_clean(CacheEntry& entry)
-    {
-        m_clean_list.prepend(entry);
+        if (!entry_is_dirty(entry))
+            ++dirty_count;
+        dirty_list.prepend(entry);
     }
 
     CacheEntry* get(BlockBasedFileSystem::BlockIndex block_index) const
     {
-        auto it = m_hash.find(block_index);
-        if (it == m_hash.end())
+        auto it = hash.find(block_index);
+        if (it == hash.end())
             return nullptr;
         auto& entry = const_cast<CacheEntry&>(*it->value);
         VERIFY(entry.block_index == block_index);
         return &entry;
     }
 
-    ErrorOr<CacheEntry*> ensure(BlockBasedFileSystem::BlockIndex block_index) const
+    IntrusiveList<&CacheEntry::list_node> dirty_list;
+    IntrusiveList<&CacheEntry::list_node> clean_list;
+    size_t dirty_count { 0 };
+    HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> hash;
+};
+
+class DiskCache {
+public:
+    static constexpr size_t ShardCount = 16;
+    // Blocks are assigned to shards in stripes, so neighbouring blocks end up in the same shard and can be written back together.
+    static constexpr size_t ShardStripeBlockCount = 64;
+    static constexpr size_t MinimumEntryCount = 1024;
+    // The cache of every block based file system is allocated up front and never shrinks, so it is kept small: a fraction of
+    // physical memory, but never more than MaximumCacheSize.
+    static constexpr size_t PhysicalMemoryFraction = 256;
+    static constexpr size_t MaximumCacheSize = 16 * MiB;
+
+    static constexpr u32 InitialReadaheadBlockCount = 4;
+    static constexpr u32 MaximumReadaheadBlockCount = 64;
+
+    static constexpr size_t MaximumWritebackBlockCount = 64;
+    // Once this fraction of a shard is dirty, the sync task is asked to write it back instead of waiting for its next round.
+    // Otherwise we'd only find out when the shard runs out of clean entries, and then the writer has to wait for all of them.
+    static constexpr size_t WritebackDirtyFraction = 2;
+
+    static size_t entry_count_for(size_t block_size)
+    {
+        auto physical_memory_size = MM.get_system_memory_info().physical_pages * PAGE_SIZE;
+        auto entry_count = min(physical_memory_size / PhysicalMemoryFraction, MaximumCacheSize) / block_size;
+        return round_up_to_power_of_two(max(entry_count, MinimumEntryCount), ShardCount);
+    }
+
+    explicit DiskCache(BlockBasedFileSystem& fs, size_t entry_count, NonnullOwnPtr<KBuffer> cached_block_data, NonnullOwnPtr<KBuffer> entries_buffer, NonnullOwnPtr<KBuffer> writeback_buffer)
+        : m_fs(fs)
+        , m_entry_count(entry_count)
+        , m_cached_block_data(move(cached_block_data))
+        , m_entries(move(entries_buffer))
+        , m_writeback_buffer(move(writeback_buffer))
     {
-        if (auto* entry = get(block_index))
+        for (size_t i = 0; i < m_entry_count; ++i) {
+            auto* entry = new (&entries()[i]) CacheEntry;
+            entry->data = m_cached_block_data->data() + i * m_fs->block_size();
+            m_shards[i % ShardCount].with_exclusive([&](auto& shard) {
+                shard.clean_list.append(*entry);
+            });
+        }
+    }
+
+    ~DiskCache() = default;
+
+    template<typename Callback>
+    decltype(auto) with_shard_for(BlockBasedFileSystem::BlockIndex block_index, Callback callback) const
+    {
+        return m_shards[(block_index.value() / ShardStripeBlockCount) % ShardCount].with_exclusive([&](auto& shard) {
+            return callback(shard);
+        });
+    }
+
+    template<typename Callback>
+    void for_each_shard(Callback callback) const
+    {
+        for (auto& shard : m_shards)
+            shard.with_exclusive([&](auto& locked_shard) { callback(locked_shard); });
+    }
+
+    ErrorOr<CacheEntry*> ensure(DiskCacheShard& shard, BlockBasedFileSystem::BlockIndex block_index) const
+    {
+        if (auto* entry = shard.get(block_index))
             return entry;
 
-        if (m_clean_list.is_empty()) {
-            // Not a single clean entry! Flush writes and try again.
-            // NOTE: We want to make sure we only call FileBackedFileSystem flush here,
-            //       not some FileBackedFileSystem subclass flush!
-            m_fs->flush_writes_impl();
-            return ensure(block_index);
+        if (shard.clean_list.is_empty()) {
+            // Not a single clean entry! Flush this shard's writes and try again.
+            flush_shard(shard);
+            return ensure(shard, block_index);
         }
 
-        VERIFY(m_clean_list.last());
-        auto& new_entry = *m_clean_list.last();
-        m_clean_list.prepend(new_entry);
+        VERIFY(shard.clean_list.last());
+        auto& new_entry = *shard.clean_list.last();
+        shard.clean_list.prepend(new_entry);
 
-        m_hash.remove(new_entry.block_index);
-        TRY(m_hash.try_set(block_index, &new_entry));
+        shard.hash.remove(new_entry.block_index);
+        TRY(shard.hash.try_set(block_index, &new_entry));
 
         new_entry.block_index = block_index;
         new_entry.has_data = false;
@@ -89,23 +141,110 @@ public:
         return &new_entry;
     }
 
+    void flush_shard(DiskCacheShard& shard) const
+    {
+        if (!shard.is_dirty())
+            return;
+
+        Vector<CacheEntry*> dirty_entries;
+        if (dirty_entries.try_ensure_capacity(shard.dirty_count).is_error()) {
+            // We can't sort them without memory, but we can still write them one by one.
+            for (auto& entry : shard.dirty_list)
+                write_entry(entry);
+            shard.mark_all_clean();
+            return;
+        }
+
+        for (auto& entry : shard.dirty_list)
+            dirty_entries.unchecked_append(&entry);
+        quick_sort(dirty_entries, [](auto* a, auto* b) { return a->block_index < b->block_index; });
+
+        size_t run_start = 0;
+        for (size_t i = 1; i <= dirty_entries.size(); ++i) {
+            bool continues_run = i < dirty_entries.size()
+                && i - run_start < MaximumWritebackBlockCount
+                && dirty_entries[i]->block_index.value() == dirty_entries[i - 1]->block_index.value() + 1;
+            if (continues_run)
+                continue;
+            write_run(dirty_entries.span().slice(run_start, i - run_start));
+            run_start = i;
+        }
+        shard.mark_all_clean();
+    }
+
+    bool dirty_count_warrants_writeback(DiskCacheShard const& shard) const
+    {
+        return shard.dirty_count == m_entry_count / ShardCount / WritebackDirtyFraction;
+    }
+
+    // Called on every cache miss, returns how many blocks starting at `block_index` should be read in one go.
+    // Sequential misses grow the readahead window, anything else resets it.
+    u32 readahead_block_count_for_miss(BlockBasedFileSystem::BlockIndex block_index) const
+    {
+        auto expected_block_index = m_next_expected_miss.load(AK::MemoryOrder::memory_order_relaxed);
+        u32 window = 1;
+        if (block_index.value() == expected_block_index) {
+            auto previous_window = m_readahead_window.load(AK::MemoryOrder::memory_order_relaxed);
+            window = previous_window <= 1 ? InitialReadaheadBlockCount : min(previous_window * 2, MaximumReadaheadBlockCount);
+        }
+        m_readahead_window.store(window, AK::MemoryOrder::memory_order_relaxed);
+        // If we're reading ahead, the next miss of a sequential reader will be right after the window.
+        m_next_expected_miss.store(block_index.value() + (window == 1 ? 1 : window), AK::MemoryOrder::memory_order_relaxed);
+        return window;
+    }
+
+    size_t entry_count() const { return m_entry_count; }
+
+    static size_t writeback_buffer_size_for(size_t block_size) { return MaximumWritebackBlockCount * block_size; }
+
     CacheEntry const* entries() const { return (CacheEntry const*)m_entries->data(); }
     CacheEntry* entries() { return (CacheEntry*)m_entries->data(); }
 
-    template<typename Callback>
-    void for_each_dirty_entry(Callback callback)
+private:
+    void write_entry(CacheEntry& entry) const
     {
-        for (auto& entry : m_dirty_list)
-            callback(entry);
+        auto base_offset = entry.block_index.value() * m_fs->block_size();
+        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+        [[maybe_unused]] auto rc = m_fs->file_description().write(base_offset, entry_data_buffer, m_fs->block_size());
+    }
+
+    // Writes a run of entries for consecutive blocks with a single request to the device.
+    void write_run(Span<CacheEntry*> run) const
+    {
+        if (run.size() == 1) {
+            write_entry(*run[0]);
+            return;
+        }
+
+        auto block_size = m_fs->block_size();
+        MutexLocker locker(m_writeback_buffer_lock);
+        for (size_t i = 0; i < run.size(); ++i)
+            memcpy(m_writeback_buffer->data() + i * block_size, run[i]->data, block_size);
+
+        auto base_offset = run[0]->block_index.value() * block_size;
+        size_t total_size = run.size() * block_size;
+        size_t nwritten = 0;
+        while (nwritten < total_size) {
+            auto buffer = UserOrKernelBuffer::for_kernel_buffer(m_writeback_buffer->data() + nwritten);
+            auto chunk_nwritten_or_error = m_fs->file_description().write(base_offset + nwritten, buffer, total_size - nwritten);
+            if (chunk_nwritten_or_error.is_error() || chunk_nwritten_or_error.value() == 0)
+                break;
+            nwritten += chunk_nwritten_or_error.value();
+        }
+        // If the device didn't take all of it, try the remaining blocks one by one.
+        for (size_t i = nwritten / block_size; i < run.size(); ++i)
+            write_entry(*run[i]);
     }
 
-private:
     mutable NonnullRefPtr<BlockBasedFileSystem> m_fs;
-    mutable IntrusiveList<&CacheEntry::list_node> m_dirty_list;
-    mutable IntrusiveList<&CacheEntry::list_node> m_clean_list;
-    mutable HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_hash;
+    size_t m_entry_count { 0 };
+    mutable Array<MutexProtected<DiskCacheShard>, ShardCount> m_shards;
+    mutable Atomic<u64> m_next_expected_miss { 0 };
+    mutable Atomic<u32> m_readahead_window { 1 };
     NonnullOwnPtr<KBuffer> m_cached_block_data;
     NonnullOwnPtr<KBuffer> m_entries;
+    NonnullOwnPtr<KBuffer> m_writeback_buffer;
+    mutable Mutex m_writeback_buffer_lock { "DiskCacheWriteback"sv };
 };
 
 BlockBasedFileSystem::BlockBasedFileSystem(OpenFileDescription& file_description)
@@ -129,9 +268,12 @@ ErrorOr<void> BlockBasedFileSystem::initialize_while_locked()
     VERIFY(m_lock.is_locked());
     VERIFY(!is_initialized_while_locked());
     VERIFY(block_size() != 0);
-    auto cached_block_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache blocks"sv, DiskCache::EntryCount * block_size()));
-    auto entries_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache entries"sv, DiskCache::EntryCount * sizeof(CacheEntry)));
-    auto disk_cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(*this, move(cached_block_data), move(entries_data))));
+    auto entry_count = DiskCache::entry_count_for(block_size());
+    auto cached_block_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache blocks"sv, entry_count * block_size()));
+    auto entries_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache entries"sv, entry_count * sizeof(CacheEntry)));
+    auto writeback_buffer = TRY(KBuffer::try_create_with_size("BlockBasedFS: Writeback buffer"sv, DiskCache::writeback_buffer_size_for(block_size())));
+    auto disk_cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(*this, entry_count, move(cached_block_data), move(entries_data), move(writeback_buffer))));
+    dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem: Using a disk cache of {} blocks", entry_count);
 
     m_cache.with_exclusive([&](auto& cache) {
         cache = move(disk_cache);
@@ -152,25 +294,29 @@ ErrorOr<void> BlockBasedFileSystem::write_block(BlockIndex index, UserOrKernelBu
 
     TRY(data.read(buffered_data.bytes()));
 
-    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
+    return m_cache.with_shared([&](auto& cache) -> ErrorOr<void> {
         if (!allow_cache) {
-            flush_specific_block_if_needed(index);
+            const_cast<BlockBasedFileSystem*>(this)->flush_specific_block_if_needed(index);
             u64 base_offset = index.value() * block_size() + offset;
             auto nwritten = TRY(file_description().write(base_offset, data, count));
             VERIFY(nwritten == count);
             return {};
         }
 
-        auto entry = TRY(cache->ensure(index));
-        if (count < block_size()) {
-            // Fill the cache first.
-            TRY(read_block(index, nullptr, block_size()));
-        }
-        memcpy(entry->data + offset, buffered_data.data(), count);
+        return cache->with_shard_for(index, [&](auto& shard) -> ErrorOr<void> {
+            auto* entry = TRY(cache->ensure(shard, index));
+            if (count < block_size() && !entry->has_data) {
+                // Fill the cache first.
+                TRY(read_into_entry(*entry));
+            }
+            memcpy(entry->data + offset, buffered_data.data(), count);
 
-        cache->mark_dirty(*entry);
-        entry->has_data = true;
-        return {};
+            shard.mark_dirty(*entry);
+            entry->has_data = true;
+            if (cache->dirty_count_warrants_writeback(shard))
+                SyncTask::request_writeback();
+            return {};
+        });
     });
 }
 
@@ -214,19 +360,88 @@ ErrorOr<void> BlockBasedFileSystem::write_blocks(BlockIndex index, unsigned coun
 {
     VERIFY(m_logical_block_size);
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::write_blocks {}, count={}", index, count);
+    if (!allow_cache && count > 1) {
+        return m_cache.with_shared([&](auto&) -> ErrorOr<void> {
+            for (unsigned i = 0; i < count; ++i)
+                flush_specific_block_if_needed(BlockIndex { index.value() + i });
+            // Uncached writes go to the device directly, so there's no reason to split them up into single blocks.
+            size_t total_size = count * block_size();
+            size_t nwritten = 0;
+            while (nwritten < total_size) {
+                auto chunk_nwritten = TRY(file_description().write(index.value() * block_size() + nwritten, data.offset(nwritten), total_size - nwritten));
+                if (chunk_nwritten == 0)
+                    return EIO;
+                nwritten += chunk_nwritten;
+            }
+            return {};
+        });
+    }
     for (unsigned i = 0; i < count; ++i) {
         TRY(write_block(BlockIndex { index.value() + i }, data.offset(i * block_size()), block_size(), 0, allow_cache));
     }
     return {};
 }
 
+ErrorOr<void> BlockBasedFileSystem::read_into_entry(CacheEntry& entry) const
+{
+    auto base_offset = entry.block_index.value() * block_size();
+    auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+    auto nread = TRY(file_description().read(entry_data_buffer, base_offset, block_size()));
+    VERIFY(nread == block_size());
+    entry.has_data = true;
+    return {};
+}
+
+void BlockBasedFileSystem::read_ahead(DiskCache const& cache, BlockIndex index, u32 count) const
+{
+    // NOTE: Readahead is purely an optimization, so failures are silently ignored here.
+    //       The block that was actually requested will be read (and fail) on its own.
+    auto buffer_or_error = ByteBuffer::create_uninitialized(count * block_size());
+    if (buffer_or_error.is_error())
+        return;
+    auto buffer = buffer_or_error.release_value();
+
+    // The device may give us fewer blocks than we asked for if it can't transfer that much in one request.
+    size_t blocks_read = 0;
+    while (blocks_read < count) {
+        auto chunk = UserOrKernelBuffer::for_kernel_buffer(buffer.data() + blocks_read * block_size());
+        auto base_offset = (index.value() + blocks_read) * block_size();
+        auto nread_or_error = file_description().read(chunk, base_offset, (count - blocks_read) * block_size());
+        if (nread_or_error.is_error() || nread_or_error.value() < block_size())
+            break;
+        blocks_read += nread_or_error.value() / block_size();
+    }
+
+    dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_ahead {}, read {} of {} blocks", index, blocks_read, count);
+
+    for (size_t i = 0; i < blocks_read; ++i) {
+        BlockIndex block_index { index.value() + i };
+        cache.with_shard_for(block_index, [&](auto& shard) {
+            // Never clobber a block somebody else read (or dirtied) in the meantime.
+            if (auto* entry = shard.get(block_index); entry && entry->has_data)
+                return;
+            auto entry_or_error = cache.ensure(shard, block_index);
+            if (entry_or_error.is_error())
+                return;
+            auto* entry = entry_or_error.release_value();
+            memcpy(entry->data, buffer.data() + i * block_size(), block_size());
+            entry->has_data = true;
+        });
+    }
+}
+
 ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuffer* buffer, size_t count, u64 offset, bool allow_cache) const
+{
+    return read_block_with_readahead_hint(index, buffer, count, offset, allow_cache, 0);
+}
+
+ErrorOr<void> BlockBasedFileSystem::read_block_with_readahead_hint(BlockIndex index, UserOrKernelBuffer* buffer, size_t count, u64 offset, bool allow_cache, u32 blocks_wanted) const
 {
     VERIFY(m_logical_block_size);
     VERIFY(offset + count <= block_size());
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_block {}", index);
 
-    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
+    return m_cache.with_shared([&](auto& cache) -> ErrorOr<void> {
         if (!allow_cache) {
             const_cast<BlockBasedFileSystem*>(this)->flush_specific_block_if_needed(index);
             u64 base_offset = index.value() * block_size() + offset;
@@ -235,17 +450,31 @@ ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuf
             return {};
         }
 
-        auto* entry = TRY(cache->ensure(index));
-        if (!entry->has_data) {
-            auto base_offset = index.value() * block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
-            auto nread = TRY(file_description().read(entry_data_buffer, base_offset, block_size()));
-            VERIFY(nread == block_size());
-            entry->has_data = true;
-        }
-        if (buffer)
-            TRY(buffer->write(entry->data + offset, count));
-        return {};
+        auto copy_out = [&](CacheEntry& entry) -> ErrorOr<void> {
+            if (buffer)
+                TRY(buffer->write(entry.data + offset, count));
+            return {};
+        };
+
+        auto result = cache->with_shard_for(index, [&](auto& shard) -> Optional<ErrorOr<void>> {
+            auto* entry = shard.get(index);
+            if (!entry || !entry->has_data)
+                return {};
+            return copy_out(*entry);
+        });
+        if (result.has_value())
+            return result.release_value();
+
+        auto readahead_count = max(cache->readahead_block_count_for_miss(index), min(blocks_wanted, DiskCache::MaximumReadaheadBlockCount));
+        if (readahead_count > 1)
+            read_ahead(*cache, index, readahead_count);
+
+        return cache->with_shard_for(index, [&](auto& shard) -> ErrorOr<void> {
+            auto* entry = TRY(cache->ensure(shard, index));
+            if (!entry->has_data)
+                TRY(read_into_entry(*entry));
+            return copy_out(*entry);
+        });
     });
 }
 
@@ -256,9 +485,27 @@ ErrorOr<void> BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count
         return EINVAL;
     if (count == 1)
         return read_block(index, &buffer, block_size(), 0, allow_cache);
+    if (!allow_cache) {
+        return m_cache.with_shared([&](auto&) -> ErrorOr<void> {
+            for (unsigned i = 0; i < count; ++i)
+                const_cast<BlockBasedFileSystem*>(this)->flush_specific_block_if_needed(BlockIndex { index.value() + i });
+            // Uncached reads go to the device directly, so there's no reason to split them up into single blocks.
+            size_t total_size = count * block_size();
+            size_t nread = 0;
+            while (nread < total_size) {
+                auto chunk = buffer.offset(nread);
+                auto chunk_nread = TRY(file_description().read(chunk, index.value() * block_size() + nread, total_size - nread));
+                if (chunk_nread == 0)
+                    return EIO;
+                nread += chunk_nread;
+            }
+            return {};
+        });
+    }
     auto out = buffer;
     for (unsigned i = 0; i < count; ++i) {
-        TRY(read_block(BlockIndex { index.value() + i }, &out, block_size(), 0, allow_cache));
+        // Let the cache know how many more blocks we're about to read, so a miss can fetch all of them at once.
+        TRY(read_block_with_readahead_hint(BlockIndex { index.value() + i }, &out, block_size(), 0, allow_cache, count - i));
         out = out.offset(block_size());
     }
 
@@ -267,35 +514,35 @@ ErrorOr<void> BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count
 
 void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
 {
-    m_cache.with_exclusive([&](auto& cache) {
-        if (!cache->is_dirty())
-            return;
-        auto* entry = cache->get(index);
-        if (!entry)
-            return;
-        if (!cache->entry_is_dirty(*entry))
-            return;
-        size_t base_offset = entry->block_index.value() * block_size();
-        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
-        (void)file_description().write(base_offset, entry_data_buffer, block_size());
+    m_cache.with_shared([&](auto& cache) {
+        cache->with_shard_for(index, [&](auto& shard) {
+            if (!shard.is_dirty())
+                return;
+            auto* entry = shard.get(index);
+            if (!entry)
+                return;
+            if (!shard.entry_is_dirty(*entry))
+                return;
+            size_t base_offset = entry->block_index.value() * block_size();
+            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
+            (void)file_description().write(base_offset, entry_data_buffer, block_size());
+        });
     });
 }
 
 void BlockBasedFileSystem::flush_writes_impl()
 {
     size_t count = 0;
-    m_cache.with_exclusive([&](auto& cache) {
-        if (!cache->is_dirty())
-            return;
-        cache->for_each_dirty_entry([&](CacheEntry& entry) {
-            auto base_offset = entry.block_index.value() * block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-            [[maybe_unused]] auto rc = file_description().write(base_offset, entry_data_buffer, block_size());
-            ++count;
+    m_cache.with_shared([&](auto& cache) {
+        cache->for_each_shard([&](auto& shard) {
+            if (!shard.is_dirty())
+                return;
+            count += shard.dirty_count;
+            cache->flush_shard(shard);
         });
-        cache->mark_all_clean();
-        dbgln("{}: Flushed {} blocks to disk", class_name(), count);
     });
+    if (count)
+        dbgln("{}: Flushed {} blocks to disk", class_name(), count);
 }
 
 void BlockBasedFileSystem::flush_writes()
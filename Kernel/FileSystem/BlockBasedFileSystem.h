@@ -11,6 +11,8 @@
 
 namespace Kernel {
 
+struct CacheEntry;
+
 class BlockBasedFileSystem : public FileBackedFileSystem {
 public:
     AK_TYPEDEF_DISTINCT_ORDERED_ID(u64, BlockIndex);
@@ -45,6 +47,9 @@ protected:
 
 private:
     void flush_specific_block_if_needed(BlockIndex index);
+    ErrorOr<void> read_block_with_readahead_hint(BlockIndex, UserOrKernelBuffer*, size_t count, u64 offset, bool allow_cache, u32 blocks_wanted) const;
+    ErrorOr<void> read_into_entry(CacheEntry&) const;
+    void read_ahead(DiskCache const&, BlockIndex, u32 count) const;
 
     mutable MutexProtected<OwnPtr<DiskCache>> m_cache;
 };
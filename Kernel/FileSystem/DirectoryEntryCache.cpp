@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashFunctions.h>
+#include <AK/Singleton.h>
+#include <Kernel/FileSystem/DirectoryEntryCache.h>
+#include <Kernel/FileSystem/FileSystem.h>
+#include <Kernel/FileSystem/Inode.h>
+
+namespace Kernel {
+
+static Singleton<DirectoryEntryCache> s_the;
+
+DirectoryEntryCache& DirectoryEntryCache::the()
+{
+    return *s_the;
+}
+
+void DirectoryEntryCache::Entry::clear()
+{
+    is_in_use = false;
+    is_negative = false;
+    was_recently_used = false;
+    name_length = 0;
+    parent = {};
+    child = nullptr;
+}
+
+DirectoryEntryCache::Entry* DirectoryEntryCache::Bucket::find(InodeIdentifier parent, StringView name)
+{
+    for (auto& entry : entries) {
+        if (entry.is_in_use && entry.parent == parent && entry.name_view() == name)
+            return &entry;
+    }
+    return nullptr;
+}
+
+DirectoryEntryCache::Entry& DirectoryEntryCache::Bucket::find_free_or_least_recently_used()
+{
+    for (auto& entry : entries) {
+        if (!entry.is_in_use)
+            return entry;
+    }
+    while (true) {
+        auto& entry = entries[clock_hand];
+        clock_hand = (clock_hand + 1) % entries_per_bucket;
+        if (!entry.was_recently_used)
+            return entry;
+        entry.was_recently_used = false;
+    }
+}
+
+bool DirectoryEntryCache::can_cache(Inode const& parent, StringView name)
+{
+    // NOTE: "." and ".." are resolved by the VirtualFileSystem, and their targets change without notifications.
+    return parent.fs().supports_watchers() && name.length() <= max_name_length && name != "."sv && name != ".."sv;
+}
+
+DirectoryEntryCache::Bucket& DirectoryEntryCache::bucket_for(InodeIdentifier parent, StringView name)
+{
+    auto inode_hash = pair_int_hash(parent.fsid().value(), u64_hash(parent.index().value()));
+    auto hash = pair_int_hash(inode_hash, name.hash());
+    return m_buckets[hash % bucket_count];
+}
+
+ErrorOr<NonnullLockRefPtr<Inode>> DirectoryEntryCache::lookup(Inode& parent, StringView name)
+{
+    if (!can_cache(parent, name))
+        return parent.lookup(name);
+
+    auto parent_identifier = parent.identifier();
+    auto& bucket = bucket_for(parent_identifier, name);
+    u64 generation;
+    {
+        SpinlockLocker locker(bucket.lock);
+        if (auto* entry = bucket.find(parent_identifier, name)) {
+            entry->was_recently_used = true;
+            if (entry->is_negative)
+                return ENOENT;
+            if (auto child = entry->child.strong_ref())
+                return child.release_nonnull();
+            // The inode we found has been freed since, so there's no point in keeping this around.
+            entry->clear();
+        }
+        generation = bucket.generation;
+    }
+
+    auto child_or_error = parent.lookup(name);
+    if (child_or_error.is_error() && child_or_error.error().code() != ENOENT)
+        return child_or_error;
+
+    LockWeakPtr<Inode> weak_child;
+    if (!child_or_error.is_error()) {
+        auto weak_child_or_error = child_or_error.value()->try_make_weak_ptr<Inode>();
+        if (weak_child_or_error.is_error())
+            return child_or_error;
+        weak_child = weak_child_or_error.release_value();
+    }
+
+    SpinlockLocker locker(bucket.lock);
+    if (bucket.generation != generation || bucket.find(parent_identifier, name))
+        return child_or_error;
+
+    auto& entry = bucket.find_free_or_least_recently_used();
+    entry.clear();
+    entry.is_in_use = true;
+    entry.is_negative = child_or_error.is_error();
+    entry.was_recently_used = true;
+    entry.name_length = name.length();
+    memcpy(entry.name, name.characters_without_null_termination(), name.length());
+    entry.parent = parent_identifier;
+    entry.child = move(weak_child);
+    return child_or_error;
+}
+
+void DirectoryEntryCache::invalidate(Inode const& parent, StringView name)
+{
+    if (!can_cache(parent, name))
+        return;
+
+    auto parent_identifier = parent.identifier();
+    auto& bucket = bucket_for(parent_identifier, name);
+    SpinlockLocker locker(bucket.lock);
+    ++bucket.generation;
+    if (auto* entry = bucket.find(parent_identifier, name))
+        entry->clear();
+}
+
+void DirectoryEntryCache::invalidate_children_of(Inode const& parent)
+{
+    if (!parent.fs().supports_watchers())
+        return;
+
+    // The children of a directory are spread over all buckets, but this only has to happen when a directory is
+    // deleted, before its inode index can be reused by another one.
+    auto parent_identifier = parent.identifier();
+    for (auto& bucket : m_buckets) {
+        SpinlockLocker locker(bucket.lock);
+        ++bucket.generation;
+        for (auto& entry : bucket.entries) {
+            if (entry.is_in_use && entry.parent == parent_identifier)
+                entry.clear();
+        }
+    }
+}
+
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Error.h>
+#include <AK/StringView.h>
+#include <AK/Types.h>
+#include <Kernel/FileSystem/InodeIdentifier.h>
+#include <Kernel/Library/LockRefPtr.h>
+#include <Kernel/Library/LockWeakPtr.h>
+#include <Kernel/Locking/Spinlock.h>
+
+namespace Kernel {
+
+class Inode;
+
+// A global cache of directory lookups, keyed by the directory and the name looked up in it.
+// Names that don't exist are remembered too, so probing for missing files doesn't go to the file system every time.
+// Entries only hold weak references to the inodes they found, and are invalidated by the did_add_child() and
+// did_remove_child() notifications of their directory. Only file systems that send those notifications
+// (the same ones that support watchers) are cached.
+// A hit takes nothing but the spinlock of a single bucket, never an inode or file system lock.
+class DirectoryEntryCache {
+public:
+    static DirectoryEntryCache& the();
+
+    // Looks up `name` in `parent`, going to the file system only if the answer isn't cached already.
+    ErrorOr<NonnullLockRefPtr<Inode>> lookup(Inode& parent, StringView name);
+
+    void invalidate(Inode const& parent, StringView name);
+    void invalidate_children_of(Inode const& parent);
+
+    DirectoryEntryCache() = default;
+
+private:
+    static constexpr size_t bucket_count = 512;
+    static constexpr size_t entries_per_bucket = 4;
+    static constexpr size_t max_name_length = 47;
+
+    struct Entry {
+        bool is_in_use { false };
+        bool is_negative { false };
+        // Cleared whenever the clock hand of the bucket passes this entry, set again whenever it's used.
+        bool was_recently_used { false };
+        u8 name_length { 0 };
+        char name[max_name_length];
+        InodeIdentifier parent;
+        LockWeakPtr<Inode> child;
+
+        StringView name_view() const { return { name, name_length }; }
+        void clear();
+    };
+
+    struct Bucket {
+        Spinlock<LockRank::None> lock {};
+        // Bumped by every invalidation, so lookups that raced with one don't cache what they found.
+        u64 generation { 0 };
+        size_t clock_hand { 0 };
+        Array<Entry, entries_per_bucket> entries;
+
+        Entry* find(InodeIdentifier parent, StringView name);
+        Entry& find_free_or_least_recently_used();
+    };
+
+    static bool can_cache(Inode const& parent, StringView name);
+    Bucket& bucket_for(InodeIdentifier parent, StringView name);
+
+    Array<Bucket, bucket_count> m_buckets;
+};
+
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+ErrorOr<NonnullLockRefPtr<EPoll>> EPoll::try_create()
+{
+    return adopt_nonnull_lock_ref_or_enomem(new (nothrow) EPoll);
+}
+
+EPoll::~EPoll()
+{
+    // NOTE: The interests unregister themselves from their files, after which we can't be notified anymore.
+    m_interests.clear();
+}
+
+EPoll::Interest::Interest(EPoll& epoll, int fd, LockWeakPtr<OpenFileDescription> description, File& file, epoll_event const& event)
+    : epoll(epoll)
+    , fd(fd)
+    , description(move(description))
+    , file(file)
+    , blocker_set(file.blocker_set())
+    , events(event.events)
+    , data(event.data)
+{
+}
+
+EPoll::Interest::~Interest()
+{
+    blocker_set.remove_readiness_observer(*this);
+    epoll.unmark_ready(*this);
+}
+
+void EPoll::Interest::file_readiness_may_have_changed()
+{
+    epoll.mark_possibly_ready(*this);
+}
+
+void EPoll::mark_possibly_ready(Interest& interest)
+{
+    {
+        SpinlockLocker lock(m_ready_list_lock);
+        if (interest.ready_list_node.is_in_list())
+            return;
+        m_ready_list.append(interest);
+    }
+    evaluate_block_conditions();
+}
+
+void EPoll::unmark_ready(Interest& interest)
+{
+    SpinlockLocker lock(m_ready_list_lock);
+    m_ready_list.remove(interest);
+}
+
+ErrorOr<void> EPoll::add_interest(int fd, OpenFileDescription& description, epoll_event const& event)
+{
+    // NOTE: We don't support nesting, which keeps readiness notifications from ever going around in a loop.
+    if (description.is_epoll())
+        return EINVAL;
+
+    MutexLocker locker(m_lock);
+    if (auto it = m_interests.find(fd); it != m_interests.end()) {
+        // The descriptor may have been closed and its number reused since it was added.
+        if (it->value->description.strong_ref().ptr() == &description)
+            return EEXIST;
+        m_interests.remove(it);
+    }
+
+    auto weak_description = TRY(description.try_make_weak_ptr<OpenFileDescription>());
+    auto interest = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Interest(*this, fd, move(weak_description), description.file(), event)));
+    auto& interest_ref = *interest;
+    TRY(m_interests.try_set(fd, move(interest)));
+
+    interest_ref.blocker_set.add_readiness_observer(interest_ref);
+    // Whatever the descriptor's current state is, the next wait has to look at it.
+    mark_possibly_ready(interest_ref);
+    return {};
+}
+
+ErrorOr<void> EPoll::modify_interest(int fd, OpenFileDescription& description, epoll_event const& event)
+{
+    MutexLocker locker(m_lock);
+    auto it = m_interests.find(fd);
+    if (it == m_interests.end() || it->value->description.strong_ref().ptr() != &description)
+        return ENOENT;
+
+    auto& interest = *it->value;
+    interest.events = event.events;
+    interest.data = event.data;
+    mark_possibly_ready(interest);
+    return {};
+}
+
+ErrorOr<void> EPoll::remove_interest(int fd, OpenFileDescription& description)
+{
+    MutexLocker locker(m_lock);
+    auto it = m_interests.find(fd);
+    if (it == m_interests.end() || it->value->description.strong_ref().ptr() != &description)
+        return ENOENT;
+    m_interests.remove(it);
+    return {};
+}
+
+ErrorOr<void> EPoll::collect_ready_events(Vector<epoll_event>& ready_events, size_t max_events)
+{
+    MutexLocker locker(m_lock);
+
+    // NOTE: Level-triggered interests that are still ready go back to the end of the list,
+    //       so we only look at the interests that were on it when we started.
+    size_t interests_to_examine;
+    {
+        SpinlockLocker lock(m_ready_list_lock);
+        interests_to_examine = m_ready_list.size_slow();
+    }
+
+    Vector<int> stale_fds;
+    for (size_t i = 0; i < interests_to_examine && ready_events.size() < max_events; ++i) {
+        Interest* interest;
+        {
+            SpinlockLocker lock(m_ready_list_lock);
+            interest = m_ready_list.take_first();
+        }
+        if (!interest)
+            break;
+
+        auto description = interest->description.strong_ref();
+        if (!description) {
+            // The descriptor was closed, so nobody can remove this interest anymore.
+            TRY(stale_fds.try_append(interest->fd));
+            continue;
+        }
+
+        BlockFlags block_flags = BlockFlags::None;
+        if (interest->events & EPOLLIN)
+            block_flags |= BlockFlags::Read;
+        if (interest->events & EPOLLOUT)
+            block_flags |= BlockFlags::Write;
+        auto unblock_flags = description->should_unblock(block_flags);
+        if (unblock_flags == BlockFlags::None)
+            continue;
+
+        u32 events = 0;
+        if (has_flag(unblock_flags, BlockFlags::Read))
+            events |= EPOLLIN;
+        if (has_flag(unblock_flags, BlockFlags::Write))
+            events |= EPOLLOUT;
+        TRY(ready_events.try_append({ events, interest->data }));
+
+        if (interest->events & EPOLLONESHOT)
+            interest->events = 0;
+        else if (!(interest->events & EPOLLET))
+            mark_possibly_ready(*interest);
+    }
+
+    for (auto fd : stale_fds)
+        m_interests.remove(fd);
+    return {};
+}
+
+bool EPoll::can_read(OpenFileDescription const&, u64) const
+{
+    SpinlockLocker lock(m_ready_list_lock);
+    return !m_ready_list.is_empty();
+}
+
+ErrorOr<NonnullOwnPtr<KString>> EPoll::pseudo_path(OpenFileDescription const&) const
+{
+    return KString::try_create(":epoll:"sv);
+}
+
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/Vector.h>
+#include <Kernel/API/POSIX/sys/epoll.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Library/LockWeakPtr.h>
+#include <Kernel/Locking/Mutex.h>
+
+namespace Kernel {
+
+// A persistent set of file descriptors to wait on, see epoll(2).
+//
+// Every watched file notifies us when its readiness may have changed, which puts its interest on the ready list.
+// Waiting only ever has to look at the interests on that list, no matter how many descriptors are being watched.
+class EPoll final : public File {
+public:
+    static ErrorOr<NonnullLockRefPtr<EPoll>> try_create();
+    virtual ~EPoll() override;
+
+    ErrorOr<void> add_interest(int fd, OpenFileDescription&, epoll_event const&);
+    ErrorOr<void> modify_interest(int fd, OpenFileDescription&, epoll_event const&);
+    ErrorOr<void> remove_interest(int fd, OpenFileDescription&);
+
+    // Collects up to `max_events` events from the interests that are ready right now.
+    ErrorOr<void> collect_ready_events(Vector<epoll_event>&, size_t max_events);
+
+    virtual bool can_read(OpenFileDescription const&, u64) const override;
+    virtual bool can_write(OpenFileDescription const&, u64) const override { return false; }
+
+private:
+    class Interest final : public FileReadinessObserver {
+    public:
+        Interest(EPoll&, int fd, LockWeakPtr<OpenFileDescription>, File&, epoll_event const&);
+        ~Interest();
+
+        virtual void file_readiness_may_have_changed() override;
+
+        EPoll& epoll;
+        int const fd;
+        LockWeakPtr<OpenFileDescription> description;
+        NonnullLockRefPtr<File> file;
+        FileBlockerSet& blocker_set;
+        u32 events { 0 };
+        epoll_data_t data {};
+
+        IntrusiveListNode<Interest> ready_list_node;
+    };
+
+    EPoll() = default;
+
+    virtual StringView class_name() const override { return "EPoll"sv; }
+    virtual bool is_epoll() const override { return true; }
+    virtual ErrorOr<NonnullOwnPtr<KString>> pseudo_path(OpenFileDescription const&) const override;
+    virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual ErrorOr<size_t> write(OpenFileDescription&, u64, UserOrKernelBuffer const&, size_t) override { return EINVAL; }
+
+    void mark_possibly_ready(Interest&);
+    void unmark_ready(Interest&);
+
+    Mutex m_lock { "EPoll"sv };
+    HashMap<int, NonnullOwnPtr<Interest>> m_interests;
+
+    mutable Spinlock<LockRank::None> m_ready_list_lock {};
+    IntrusiveList<&Interest::ready_list_node> m_ready_list;
+};
+
+}
@@ -207,6 +207,37 @@ struct ext2_dx_countlimit {
     __u16 count;
 };
 
+/*
+ * Data structures used by the extents feature
+ *
+ * Every node of the tree, including the root in i_block, starts with a
+ * header, followed by either index entries or (at depth 0) extents.
+ */
+#define EXT4_EXT_MAGIC 0xf30a
+#define EXT4_EXT_INIT_MAX_LEN (1 << 15) /* longer extents are uninitialized */
+
+struct ext4_extent_header {
+    __u16 eh_magic;      /* probably will support different formats */
+    __u16 eh_entries;    /* number of valid entries */
+    __u16 eh_max;        /* capacity of store in entries */
+    __u16 eh_depth;      /* has tree real underlying blocks? */
+    __u32 eh_generation; /* generation of the tree */
+};
+
+struct ext4_extent_idx {
+    __u32 ei_block;   /* index covers logical blocks from 'block' */
+    __u32 ei_leaf_lo; /* pointer to the physical block of the next level */
+    __u16 ei_leaf_hi; /* high 16 bits of physical block */
+    __u16 ei_unused;
+};
+
+struct ext4_extent {
+    __u32 ee_block;    /* first logical block extent covers */
+    __u16 ee_len;      /* number of blocks covered by extent */
+    __u16 ee_start_hi; /* high 16 bits of physical block */
+    __u32 ee_start_lo; /* low 32 bits of physical block */
+};
+
 /*
  * Macro-instructions used to manage group descriptors
  */
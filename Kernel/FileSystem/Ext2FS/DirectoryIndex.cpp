@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/AnyOf.h>
+#include <AK/QuickSort.h>
+#include <AK/Vector.h>
+#include <Kernel/FileSystem/Ext2FS/Definitions.h>
+#include <Kernel/FileSystem/Ext2FS/DirectoryIndex.h>
+
+namespace Kernel {
+
+// The root block starts with the "." and ".." entries, and the root info follows the 12 bytes of ".".
+static constexpr size_t root_info_offset = 24;
+// Other index blocks start with an empty directory entry that spans the whole block.
+static constexpr size_t node_entries_offset = 8;
+static constexpr size_t dx_entry_size = sizeof(ext2_dx_entry);
+
+template<typename T>
+static T read_from(ReadonlyBytes bytes, size_t offset)
+{
+    T value;
+    VERIFY(offset + sizeof(T) <= bytes.size());
+    memcpy(&value, bytes.offset_pointer(offset), sizeof(T));
+    return value;
+}
+
+template<typename T>
+static void write_to(Bytes bytes, size_t offset, T value)
+{
+    VERIFY(offset + sizeof(T) <= bytes.size());
+    memcpy(bytes.offset_pointer(offset), &value, sizeof(T));
+}
+
+static u32 legacy_hash(StringView name, bool is_unsigned)
+{
+    u32 hash0 = 0x12a3fe2d;
+    u32 hash1 = 0x37abe8f9;
+    for (auto c : name) {
+        int value = is_unsigned ? static_cast<int>(static_cast<u8>(c)) : static_cast<int>(static_cast<i8>(c));
+        u32 hash = hash1 + (hash0 ^ (static_cast<u32>(value) * 7152373u));
+        if (hash & 0x80000000)
+            hash -= 0x7fffffff;
+        hash1 = hash0;
+        hash0 = hash;
+    }
+    return hash0 << 1;
+}
+
+// Packs (up to) the next `word_count` * 4 bytes of a name into words, padding them with its length.
+static void name_to_hash_input(StringView name, bool is_unsigned, Span<u32> words)
+{
+    u32 pad = static_cast<u32>(name.length()) | (static_cast<u32>(name.length()) << 8);
+    pad |= pad << 16;
+
+    auto length = min(name.length(), words.size() * 4);
+    size_t word_index = 0;
+    u32 value = pad;
+    for (size_t i = 0; i < length; ++i) {
+        int c = is_unsigned ? static_cast<int>(static_cast<u8>(name[i])) : static_cast<int>(static_cast<i8>(name[i]));
+        value = static_cast<u32>(c) + (value << 8);
+        if (i % 4 == 3) {
+            words[word_index++] = value;
+            value = pad;
+        }
+    }
+    if (word_index < words.size())
+        words[word_index++] = value;
+    while (word_index < words.size())
+        words[word_index++] = pad;
+}
+
+static void half_md4_transform(Array<u32, 4>& buffer, Span<u32 const> in)
+{
+    auto f = [](u32 x, u32 y, u32 z) { return z ^ (x & (y ^ z)); };
+    auto g = [](u32 x, u32 y, u32 z) { return (x & y) + ((x ^ y) & z); };
+    auto h = [](u32 x, u32 y, u32 z) { return x ^ y ^ z; };
+    auto round = [](auto function, u32& a, u32 b, u32 c, u32 d, u32 x, u32 shift) {
+        a += function(b, c, d) + x;
+        a = (a << shift) | (a >> (32 - shift));
+    };
+    constexpr u32 k2 = 013240474631u;
+    constexpr u32 k3 = 015666365641u;
+
+    u32 a = buffer[0];
+    u32 b = buffer[1];
+    u32 c = buffer[2];
+    u32 d = buffer[3];
+
+    round(f, a, b, c, d, in[0], 3);
+    round(f, d, a, b, c, in[1], 7);
+    round(f, c, d, a, b, in[2], 11);
+    round(f, b, c, d, a, in[3], 19);
+    round(f, a, b, c, d, in[4], 3);
+    round(f, d, a, b, c, in[5], 7);
+    round(f, c, d, a, b, in[6], 11);
+    round(f, b, c, d, a, in[7], 19);
+
+    round(g, a, b, c, d, in[1] + k2, 3);
+    round(g, d, a, b, c, in[3] + k2, 5);
+    round(g, c, d, a, b, in[5] + k2, 9);
+    round(g, b, c, d, a, in[7] + k2, 13);
+    round(g, a, b, c, d, in[0] + k2, 3);
+    round(g, d, a, b, c, in[2] + k2, 5);
+    round(g, c, d, a, b, in[4] + k2, 9);
+    round(g, b, c, d, a, in[6] + k2, 13);
+
+    round(h, a, b, c, d, in[3] + k3, 3);
+    round(h, d, a, b, c, in[7] + k3, 9);
+    round(h, c, d, a, b, in[2] + k3, 11);
+    round(h, b, c, d, a, in[6] + k3, 15);
+    round(h, a, b, c, d, in[1] + k3, 3);
+    round(h, d, a, b, c, in[5] + k3, 9);
+    round(h, c, d, a, b, in[0] + k3, 11);
+    round(h, b, c, d, a, in[4] + k3, 15);
+
+    buffer[0] += a;
+    buffer[1] += b;
+    buffer[2] += c;
+    buffer[3] += d;
+}
+
+static void tea_transform(Array<u32, 4>& buffer, Span<u32 const> in)
+{
+    u32 sum = 0;
+    u32 b0 = buffer[0];
+    u32 b1 = buffer[1];
+    for (int i = 0; i < 16; ++i) {
+        sum += 0x9e3779b9;
+        b0 += ((b1 << 4) + in[0]) ^ (b1 + sum) ^ ((b1 >> 5) + in[1]);
+        b1 += ((b0 << 4) + in[2]) ^ (b0 + sum) ^ ((b0 >> 5) + in[3]);
+    }
+    buffer[0] += b0;
+    buffer[1] += b1;
+}
+
+u8 Ext2FSDirectoryIndex::effective_hash_version(u8 hash_version) const
+{
+    if (hash_version <= EXT2_HASH_TEA && m_uses_unsigned_hash)
+        return hash_version + EXT2_HASH_LEGACY_UNSIGNED;
+    return hash_version;
+}
+
+size_t Ext2FSDirectoryIndex::root_limit() const
+{
+    return (m_block_size - root_info_offset - sizeof(ext2_dx_root_info)) / dx_entry_size;
+}
+
+size_t Ext2FSDirectoryIndex::node_limit() const
+{
+    return (m_block_size - node_entries_offset) / dx_entry_size;
+}
+
+u32 Ext2FSDirectoryIndex::hash(StringView name, u8 hash_version) const
+{
+    Array<u32, 4> buffer { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+    if (any_of(m_seed, [](u32 word) { return word != 0; }))
+        buffer = m_seed;
+
+    u32 hash = 0;
+    auto version = effective_hash_version(hash_version);
+    bool is_unsigned = version >= EXT2_HASH_LEGACY_UNSIGNED;
+    switch (version) {
+    case EXT2_HASH_LEGACY:
+    case EXT2_HASH_LEGACY_UNSIGNED:
+        hash = legacy_hash(name, is_unsigned);
+        break;
+    case EXT2_HASH_HALF_MD4:
+    case EXT2_HASH_HALF_MD4_UNSIGNED: {
+        Array<u32, 8> in {};
+        for (auto remaining = name; !remaining.is_empty(); remaining = remaining.substring_view(min(remaining.length(), 32))) {
+            name_to_hash_input(remaining, is_unsigned, in.span());
+            half_md4_transform(buffer, in.span());
+        }
+        hash = buffer[1];
+        break;
+    }
+    case EXT2_HASH_TEA:
+    case EXT2_HASH_TEA_UNSIGNED: {
+        Array<u32, 4> in {};
+        for (auto remaining = name; !remaining.is_empty(); remaining = remaining.substring_view(min(remaining.length(), 16))) {
+            name_to_hash_input(remaining, is_unsigned, in.span());
+            tea_transform(buffer, in.span());
+        }
+        hash = buffer[0];
+        break;
+    }
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    hash &= ~1u;
+    // This value marks the end of a directory for 32-bit readdir cookies, so it's never handed out as a hash.
+    if (hash == (0x7fffffffu << 1))
+        hash = (0x7fffffffu - 1) << 1;
+    return hash;
+}
+
+ErrorOr<Optional<InodeIndex>> Ext2FSDirectoryIndex::lookup(StringView name, Function<ErrorOr<void>(u64 logical_block, Bytes)> const& read_block) const
+{
+    struct Level {
+        ByteBuffer block;
+        size_t entries_offset { 0 };
+        size_t count { 0 };
+        size_t position { 0 };
+
+        u32 hash_at(size_t index) const { return read_from<u32>(block, entries_offset + index * dx_entry_size); }
+        u32 block_at(size_t index) const { return read_from<u32>(block, entries_offset + index * dx_entry_size + sizeof(u32)); }
+    };
+
+    auto read_level = [&](u64 logical_block, size_t entries_offset) -> ErrorOr<Level> {
+        Level level;
+        level.block = TRY(ByteBuffer::create_uninitialized(m_block_size));
+        TRY(read_block(logical_block, level.block.bytes()));
+        level.entries_offset = entries_offset;
+        auto count_limit = read_from<ext2_dx_countlimit>(level.block, entries_offset);
+        if (count_limit.count == 0 || count_limit.count > count_limit.limit || entries_offset + count_limit.count * dx_entry_size > m_block_size)
+            return ENOTSUP;
+        level.count = count_limit.count;
+        return level;
+    };
+
+    auto root = TRY(read_level(0, root_info_offset + sizeof(ext2_dx_root_info)));
+    auto root_info = read_from<ext2_dx_root_info>(root.block, root_info_offset);
+    if (root_info.reserved_zero != 0 || root_info.info_length != sizeof(ext2_dx_root_info) || root_info.indirect_levels > max_indirect_levels || root_info.hash_version > EXT2_HASH_TEA)
+        return ENOTSUP;
+
+    auto hash = this->hash(name, root_info.hash_version);
+
+    Vector<Level, max_indirect_levels + 1> path;
+    TRY(path.try_append(move(root)));
+
+    // Finds the last entry that starts at or below our hash. The first one covers everything below the second.
+    auto find_position = [&](Level& level) {
+        size_t low = 1;
+        size_t high = level.count;
+        while (low < high) {
+            auto middle = low + (high - low) / 2;
+            if (level.hash_at(middle) > hash)
+                high = middle;
+            else
+                low = middle + 1;
+        }
+        level.position = low - 1;
+    };
+
+    auto descend = [&]() -> ErrorOr<void> {
+        while (path.size() <= root_info.indirect_levels) {
+            auto& parent = path.last();
+            TRY(path.try_append(TRY(read_level(parent.block_at(parent.position), node_entries_offset))));
+            find_position(path.last());
+        }
+        return {};
+    };
+
+    find_position(path.last());
+    TRY(descend());
+
+    auto leaf = TRY(ByteBuffer::create_uninitialized(m_block_size));
+    while (true) {
+        auto& level = path.last();
+        TRY(read_block(level.block_at(level.position), leaf.bytes()));
+
+        size_t offset = 0;
+        while (offset < m_block_size) {
+            if (offset + 8 > m_block_size)
+                return EIO;
+            auto inode = read_from<u32>(leaf, offset);
+            auto record_length = read_from<u16>(leaf, offset + 4);
+            auto name_length = read_from<u8>(leaf, offset + 6);
+            if (record_length < 8 || offset + record_length > m_block_size || static_cast<size_t>(name_length) + 8 > record_length)
+                return EIO;
+            if (inode != 0 && StringView { leaf.offset_pointer(offset + 8), name_length } == name)
+                return InodeIndex { inode };
+            offset += record_length;
+        }
+
+        // Names with the same hash may continue in the next leaf, which is then marked by the lowest bit of its hash.
+        // Its index entry may well be in the next index node, so walk up until there is a next entry.
+        while (!path.is_empty() && path.last().position + 1 >= path.last().count)
+            path.take_last();
+        if (path.is_empty())
+            return Optional<InodeIndex> {};
+        auto& next_level = path.last();
+        auto next_hash = next_level.hash_at(next_level.position + 1);
+        if (!(next_hash & 1) || (next_hash & ~1u) != hash)
+            return Optional<InodeIndex> {};
+        ++next_level.position;
+        while (path.size() <= root_info.indirect_levels) {
+            auto& parent = path.last();
+            TRY(path.try_append(TRY(read_level(parent.block_at(parent.position), node_entries_offset))));
+        }
+    }
+}
+
+ErrorOr<Optional<ByteBuffer>> Ext2FSDirectoryIndex::build(Span<Ext2FSDirectoryEntry> entries) const
+{
+    if (entries.size() < 2 || entries[0].name->view() != "."sv || entries[1].name->view() != ".."sv)
+        return Optional<ByteBuffer> {};
+
+    size_t linear_size = 0;
+    for (auto& entry : entries)
+        linear_size += EXT2_DIR_REC_LEN(entry.name->length());
+    if (linear_size <= m_block_size)
+        return Optional<ByteBuffer> {};
+
+    u8 hash_version = m_default_hash_version <= EXT2_HASH_TEA ? m_default_hash_version : EXT2_HASH_HALF_MD4;
+
+    struct HashedEntry {
+        u32 hash;
+        size_t index;
+    };
+    Vector<HashedEntry> sorted_entries;
+    TRY(sorted_entries.try_ensure_capacity(entries.size() - 2));
+    for (size_t i = 2; i < entries.size(); ++i)
+        sorted_entries.unchecked_append({ hash(entries[i].name->view(), hash_version), i });
+    quick_sort(sorted_entries, [](auto& a, auto& b) {
+        return a.hash < b.hash || (a.hash == b.hash && a.index < b.index);
+    });
+
+    // Fill the leaves in hash order.
+    struct Leaf {
+        u32 hash;
+        size_t first_entry;
+        size_t entry_count;
+    };
+    Vector<Leaf> leaves;
+    size_t space_in_leaf = 0;
+    for (size_t i = 0; i < sorted_entries.size(); ++i) {
+        auto record_length = EXT2_DIR_REC_LEN(entries[sorted_entries[i].index].name->length());
+        if (leaves.is_empty() || record_length > space_in_leaf) {
+            auto leaf_hash = sorted_entries[i].hash;
+            // Mark leaves that continue a run of names with the same hash as their predecessor.
+            if (i > 0 && sorted_entries[i - 1].hash == leaf_hash)
+                leaf_hash |= 1;
+            TRY(leaves.try_append({ leaf_hash, i, 0 }));
+            space_in_leaf = m_block_size;
+        }
+        space_in_leaf -= record_length;
+        ++leaves.last().entry_count;
+    }
+
+    // We only build indexes with a single level of index nodes below the root, which is what
+    // every ext3/ext4 implementation can read. Anything larger stays an unindexed directory.
+    u8 indirect_levels = 0;
+    size_t node_count = 0;
+    if (leaves.size() > root_limit()) {
+        indirect_levels = 1;
+        node_count = ceil_div(leaves.size(), node_limit());
+        if (node_count > root_limit())
+            return Optional<ByteBuffer> {};
+    }
+
+    auto first_leaf_block = 1 + node_count;
+    auto data = TRY(ByteBuffer::create_zeroed((first_leaf_block + leaves.size()) * m_block_size));
+    auto bytes = data.bytes();
+
+    auto write_directory_entry = [&](size_t offset, Ext2FSDirectoryEntry& entry, u16 record_length) {
+        entry.record_length = record_length;
+        write_to<u32>(bytes, offset, entry.inode_index.value());
+        write_to<u16>(bytes, offset + 4, record_length);
+        write_to<u8>(bytes, offset + 6, entry.name->length());
+        write_to<u8>(bytes, offset + 7, entry.file_type);
+        memcpy(bytes.offset_pointer(offset + 8), entry.name->characters(), entry.name->length());
+    };
+
+    // The root block: ".", "..", the root info and then the top level of the index.
+    write_directory_entry(0, entries[0], 12);
+    write_directory_entry(12, entries[1], m_block_size - 12);
+    write_to(bytes, root_info_offset, ext2_dx_root_info { 0, hash_version, static_cast<u8>(sizeof(ext2_dx_root_info)), indirect_levels, 0 });
+
+    auto write_index = [&](size_t offset, size_t limit, size_t count, auto hash_for, auto block_for) {
+        write_to(bytes, offset, ext2_dx_countlimit { static_cast<u16>(limit), static_cast<u16>(count) });
+        write_to<u32>(bytes, offset + 4, block_for(0));
+        for (size_t i = 1; i < count; ++i) {
+            write_to<u32>(bytes, offset + i * dx_entry_size, hash_for(i));
+            write_to<u32>(bytes, offset + i * dx_entry_size + 4, block_for(i));
+        }
+    };
+
+    auto root_entries_offset = root_info_offset + sizeof(ext2_dx_root_info);
+    if (indirect_levels == 0) {
+        write_index(
+            root_entries_offset, root_limit(), leaves.size(),
+            [&](size_t i) { return leaves[i].hash; },
+            [&](size_t i) { return static_cast<u32>(first_leaf_block + i); });
+    } else {
+        write_index(
+            root_entries_offset, root_limit(), node_count,
+            [&](size_t i) { return leaves[i * node_limit()].hash; },
+            [&](size_t i) { return static_cast<u32>(1 + i); });
+        for (size_t node = 0; node < node_count; ++node) {
+            auto node_offset = (1 + node) * m_block_size;
+            auto first_leaf = node * node_limit();
+            auto leaf_count = min(node_limit(), leaves.size() - first_leaf);
+            // An empty directory entry covering the whole block, so the node looks like an empty directory block.
+            write_to<u16>(bytes, node_offset + 4, static_cast<u16>(m_block_size));
+            write_index(
+                node_offset + node_entries_offset, node_limit(), leaf_count,
+                [&](size_t i) { return leaves[first_leaf + i].hash; },
+                [&](size_t i) { return static_cast<u32>(first_leaf_block + first_leaf + i); });
+        }
+    }
+
+    for (size_t leaf_index = 0; leaf_index < leaves.size(); ++leaf_index) {
+        auto& leaf = leaves[leaf_index];
+        size_t offset = (first_leaf_block + leaf_index) * m_block_size;
+        auto leaf_end = offset + m_block_size;
+        for (size_t i = 0; i < leaf.entry_count; ++i) {
+            auto& entry = entries[sorted_entries[leaf.first_entry + i].index];
+            bool is_last = i + 1 == leaf.entry_count;
+            u16 record_length = is_last ? leaf_end - offset : EXT2_DIR_REC_LEN(entry.name->length());
+            write_directory_entry(offset, entry, record_length);
+            offset += record_length;
+        }
+    }
+
+    return data;
+}
+
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/ByteBuffer.h>
+#include <AK/Function.h>
+#include <AK/Optional.h>
+#include <AK/Span.h>
+#include <AK/StringView.h>
+#include <AK/Types.h>
+#include <Kernel/FileSystem/Ext2FS/DirectoryEntry.h>
+
+namespace Kernel {
+
+// Hashed B-tree ("htree") directory indexes, as used by ext3 and ext4 for large directories.
+// The index lives in blocks that look like empty directory blocks to anybody who doesn't know about it,
+// so linear traversal of an indexed directory keeps working as-is.
+class Ext2FSDirectoryIndex {
+public:
+    Ext2FSDirectoryIndex(size_t block_size, u8 default_hash_version, bool uses_unsigned_hash, Array<u32, 4> seed)
+        : m_block_size(block_size)
+        , m_default_hash_version(default_hash_version)
+        , m_uses_unsigned_hash(uses_unsigned_hash)
+        , m_seed(seed)
+    {
+    }
+
+    // Returns the major hash of a name, with the lowest bit cleared like it is stored in the index.
+    u32 hash(StringView name, u8 hash_version) const;
+
+    // Looks up a name through the index of a directory, reading its blocks with `read_block`.
+    // Fails with ENOTSUP if the index is of a kind we don't understand, in which case the directory has to be scanned.
+    ErrorOr<Optional<InodeIndex>> lookup(StringView name, Function<ErrorOr<void>(u64 logical_block, Bytes)> const& read_block) const;
+
+    // Lays out the entries of a directory as an indexed directory. The first two entries have to be "." and "..".
+    // Returns nothing if the directory fits into a single block (and won't benefit from an index), or is too large.
+    ErrorOr<Optional<ByteBuffer>> build(Span<Ext2FSDirectoryEntry>) const;
+
+private:
+    static constexpr size_t max_indirect_levels = 2;
+
+    u8 effective_hash_version(u8) const;
+    size_t root_limit() const;
+    size_t node_limit() const;
+
+    size_t m_block_size { 0 };
+    u8 m_default_hash_version { 0 };
+    bool m_uses_unsigned_hash { false };
+    Array<u32, 4> m_seed;
+};
+
+}
@@ -38,7 +38,9 @@ ext2_group_desc const& Ext2FS::group_descriptor(GroupIndex group_index) const
     // FIXME: Should this fail gracefully somehow?
     VERIFY(group_index <= m_block_group_count);
     VERIFY(group_index > 0);
-    return block_group_descriptors()[group_index.value() - 1];
+    // NOTE: With the 64bit feature, descriptors are larger than the part of them we know how to use.
+    auto const* descriptor = m_cached_group_descriptor_table->data() + (group_index.value() - 1) * group_descriptor_size();
+    return *reinterpret_cast<ext2_group_desc const*>(descriptor);
 }
 
 bool Ext2FS::is_initialized_while_locked()
@@ -91,7 +93,12 @@ ErrorOr<void> Ext2FS::initialize_while_locked()
         return EINVAL;
     }
 
-    auto blocks_to_read = ceil_div(m_block_group_count * sizeof(ext2_group_desc), block_size());
+    if (group_descriptor_size() < EXT2_MIN_DESC_SIZE || group_descriptor_size() > EXT2_MAX_DESC_SIZE || !is_power_of_two(group_descriptor_size())) {
+        dmesgln("Ext2FS: Invalid block group descriptor size: {}", group_descriptor_size());
+        return EINVAL;
+    }
+
+    auto blocks_to_read = ceil_div(m_block_group_count * group_descriptor_size(), block_size());
     BlockIndex first_block_of_bgdt = block_size() == 1024 ? 2 : 1;
     m_cached_group_descriptor_table = TRY(KBuffer::try_create_with_size("Ext2FS: Block group descriptors"sv, block_size() * blocks_to_read, Memory::Region::Access::ReadWrite));
     auto buffer = UserOrKernelBuffer::for_kernel_buffer(m_cached_group_descriptor_table->data());
@@ -194,6 +201,24 @@ Ext2FS::FeaturesReadOnly Ext2FS::get_features_readonly() const
     return Ext2FS::FeaturesReadOnly::None;
 }
 
+size_t Ext2FS::group_descriptor_size() const
+{
+    return EXT2_DESC_SIZE(&super_block());
+}
+
+bool Ext2FS::has_directory_index() const
+{
+    return m_super_block.s_rev_level > 0 && (m_super_block.s_feature_compat & EXT2_FEATURE_COMPAT_DIR_INDEX);
+}
+
+Ext2FSDirectoryIndex Ext2FS::directory_index() const
+{
+    Array<u32, 4> seed;
+    for (size_t i = 0; i < seed.size(); ++i)
+        seed[i] = m_super_block.s_hash_seed[i];
+    return Ext2FSDirectoryIndex { block_size(), m_super_block.s_def_hash_version, (m_super_block.s_flags & EXT2_FLAGS_UNSIGNED_HASH) != 0, seed };
+}
+
 u64 Ext2FS::inodes_per_block() const
 {
     return EXT2_INODES_PER_BLOCK(&super_block());
@@ -223,9 +248,36 @@ ErrorOr<void> Ext2FS::write_ext2_inode(InodeIndex inode, ext2_inode const& e2ino
     return write_block(block_index, buffer, inode_size(), offset);
 }
 
-auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) -> ErrorOr<Vector<BlockIndex>>
+auto Ext2FS::allocate_blocks_at(BlockIndex first_block, size_t max_count) -> ErrorOr<size_t>
 {
-    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {})", preferred_group_index, count);
+    MutexLocker locker(m_lock);
+    if (first_block < first_block_index() || first_block >= super_block().s_blocks_count)
+        return 0;
+
+    auto group_index = group_index_from_block_index(first_block);
+    auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index));
+    if (!bgd.bg_free_blocks_count)
+        return 0;
+
+    auto* cached_bitmap = TRY(get_bitmap_block(bgd.bg_block_bitmap));
+    int blocks_in_group = min(blocks_per_group(), super_block().s_blocks_count);
+    auto block_bitmap = cached_bitmap->bitmap(blocks_in_group);
+
+    size_t first_bit_index = (first_block.value() - first_block_index().value()) % blocks_per_group();
+    size_t count = 0;
+    while (count < max_count && first_bit_index + count < block_bitmap.size() && !block_bitmap.get(first_bit_index + count))
+        ++count;
+    if (count == 0)
+        return 0;
+
+    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks_at({}): allocating {} of {} blocks [{}]", first_block, count, max_count, group_index);
+    TRY(update_bitmap_block(bgd.bg_block_bitmap, first_bit_index, count, true, m_super_block.s_free_blocks_count, bgd.bg_free_blocks_count));
+    return count;
+}
+
+auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal) -> ErrorOr<Vector<BlockIndex>>
+{
+    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {}, goal {})", preferred_group_index, count, goal);
     if (count == 0)
         return Vector<BlockIndex> {};
 
@@ -233,6 +285,16 @@ auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) ->
     TRY(blocks.try_ensure_capacity(count));
 
     MutexLocker locker(m_lock);
+
+    // Continue right where the caller left off if we can, so files that grow a little at a time stay contiguous.
+    if (goal != 0) {
+        auto allocated_at_goal = TRY(allocate_blocks_at(goal, count));
+        for (size_t i = 0; i < allocated_at_goal; ++i)
+            blocks.unchecked_append(goal.value() + i);
+        if (allocated_at_goal)
+            preferred_group_index = group_index_from_block_index(goal);
+    }
+
     auto group_index = preferred_group_index;
 
     if (!group_descriptor(preferred_group_index).bg_free_blocks_count) {
@@ -255,7 +317,7 @@ auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) ->
         }
 
         VERIFY(found_a_group);
-        auto const& bgd = group_descriptor(group_index);
+        auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index));
 
         auto* cached_bitmap = TRY(get_bitmap_block(bgd.bg_block_bitmap));
 
@@ -267,9 +329,10 @@ auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) ->
         auto first_unset_bit_index = block_bitmap.find_longest_range_of_unset_bits(count - blocks.size(), free_region_size);
         VERIFY(first_unset_bit_index.has_value());
         dbgln_if(EXT2_DEBUG, "Ext2FS: allocating free region of size: {} [{}]", free_region_size, group_index);
+        // Claim the whole region at once, instead of going through the bitmap and the counters for every block.
+        TRY(update_bitmap_block(bgd.bg_block_bitmap, first_unset_bit_index.value(), free_region_size, true, m_super_block.s_free_blocks_count, bgd.bg_free_blocks_count));
         for (size_t i = 0; i < free_region_size; ++i) {
             BlockIndex block_index = (first_unset_bit_index.value() + i) + first_block_in_group.value();
-            TRY(set_block_allocation_state(block_index, true));
             blocks.unchecked_append(block_index);
             dbgln_if(EXT2_DEBUG, "  allocated > {}", block_index);
         }
@@ -343,7 +406,8 @@ Ext2FS::GroupIndex Ext2FS::group_index_from_block_index(BlockIndex block_index)
 {
     if (!block_index)
         return 0;
-    return (block_index.value() - 1) / blocks_per_group() + 1;
+    // NOTE: The first group starts at block 1 when blocks are 1 KiB, and at block 0 otherwise.
+    return (block_index.value() - first_block_index().value()) / blocks_per_group() + 1;
 }
 
 auto Ext2FS::group_index_from_inode(InodeIndex inode) const -> GroupIndex
@@ -367,23 +431,24 @@ ErrorOr<bool> Ext2FS::get_inode_allocation_state(InodeIndex index) const
     return cached_bitmap->bitmap(inodes_per_group()).get(bit_index);
 }
 
-ErrorOr<void> Ext2FS::update_bitmap_block(BlockIndex bitmap_block, size_t bit_index, bool new_state, u32& super_block_counter, u16& group_descriptor_counter)
+ErrorOr<void> Ext2FS::update_bitmap_block(BlockIndex bitmap_block, size_t first_bit_index, size_t bit_count, bool new_state, u32& super_block_counter, u16& group_descriptor_counter)
 {
     auto* cached_bitmap = TRY(get_bitmap_block(bitmap_block));
-    bool current_state = cached_bitmap->bitmap(blocks_per_group()).get(bit_index);
-    if (current_state == new_state) {
-        dbgln("Ext2FS: Bit {} in bitmap block {} had unexpected state {}", bit_index, bitmap_block, current_state);
+    auto bitmap = cached_bitmap->bitmap(blocks_per_group());
+    VERIFY(first_bit_index + bit_count <= bitmap.size());
+    if (auto unexpected_bits = bitmap.count_in_range(first_bit_index, bit_count, new_state); unexpected_bits != 0) {
+        dbgln("Ext2FS: {} of bits {}-{} in bitmap block {} had unexpected state {}", unexpected_bits, first_bit_index, first_bit_index + bit_count - 1, bitmap_block, new_state);
         return EIO;
     }
-    cached_bitmap->bitmap(blocks_per_group()).set(bit_index, new_state);
+    bitmap.set_range(first_bit_index, bit_count, new_state);
     cached_bitmap->dirty = true;
 
     if (new_state) {
-        --super_block_counter;
-        --group_descriptor_counter;
+        super_block_counter -= bit_count;
+        group_descriptor_counter -= bit_count;
     } else {
-        ++super_block_counter;
-        ++group_descriptor_counter;
+        super_block_counter += bit_count;
+        group_descriptor_counter += bit_count;
     }
 
     m_super_block_dirty = true;
@@ -400,7 +465,7 @@ ErrorOr<void> Ext2FS::set_inode_allocation_state(InodeIndex inode_index, bool ne
 
     dbgln_if(EXT2_DEBUG, "Ext2FS: set_inode_allocation_state: Inode {} -> {}", inode_index, new_state);
     auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index));
-    return update_bitmap_block(bgd.bg_inode_bitmap, bit_index, new_state, m_super_block.s_free_inodes_count, bgd.bg_free_inodes_count);
+    return update_bitmap_block(bgd.bg_inode_bitmap, bit_index, 1, new_state, m_super_block.s_free_inodes_count, bgd.bg_free_inodes_count);
 }
 
 Ext2FS::BlockIndex Ext2FS::first_block_index() const
@@ -425,16 +490,52 @@ ErrorOr<Ext2FS::CachedBitmap*> Ext2FS::get_bitmap_block(BlockIndex bitmap_block_
 
 ErrorOr<void> Ext2FS::set_block_allocation_state(BlockIndex block_index, bool new_state)
 {
-    VERIFY(block_index != 0);
+    return set_block_range_allocation_state(block_index, 1, new_state);
+}
+
+ErrorOr<void> Ext2FS::set_block_range_allocation_state(BlockIndex first_block, size_t count, bool new_state)
+{
+    VERIFY(first_block != 0);
     MutexLocker locker(m_lock);
 
-    auto group_index = group_index_from_block_index(block_index);
-    unsigned index_in_group = (block_index.value() - first_block_index().value()) - ((group_index.value() - 1) * blocks_per_group());
-    unsigned bit_index = index_in_group % blocks_per_group();
-    auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index));
+    // Update the bitmap of each group the range touches in one go.
+    while (count) {
+        auto group_index = group_index_from_block_index(first_block);
+        unsigned bit_index = (first_block.value() - first_block_index().value()) - ((group_index.value() - 1) * blocks_per_group());
+        size_t count_in_group = min(count, static_cast<size_t>(blocks_per_group() - bit_index));
+        auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index));
+
+        dbgln_if(EXT2_DEBUG, "Ext2FS: Blocks {}-{} state -> {} (in bitmap block {})", first_block, first_block.value() + count_in_group - 1, new_state, bgd.bg_block_bitmap);
+        TRY(update_bitmap_block(bgd.bg_block_bitmap, bit_index, count_in_group, new_state, m_super_block.s_free_blocks_count, bgd.bg_free_blocks_count));
+        first_block = first_block.value() + count_in_group;
+        count -= count_in_group;
+    }
+    return {};
+}
 
-    dbgln_if(EXT2_DEBUG, "Ext2FS: Block {} state -> {} (in bitmap block {})", block_index, new_state, bgd.bg_block_bitmap);
-    return update_bitmap_block(bgd.bg_block_bitmap, bit_index, new_state, m_super_block.s_free_blocks_count, bgd.bg_free_blocks_count);
+ErrorOr<void> Ext2FS::free_blocks(Span<BlockIndex const> blocks)
+{
+    MutexLocker locker(m_lock);
+
+    // Free runs of consecutive blocks together, since most files are mostly contiguous.
+    BlockIndex run_start { 0 };
+    size_t run_length = 0;
+    for (auto block_index : blocks) {
+        VERIFY(block_index <= super_block().s_blocks_count);
+        if (!block_index.value())
+            continue;
+        if (run_length && block_index.value() == run_start.value() + run_length) {
+            ++run_length;
+            continue;
+        }
+        if (run_length)
+            TRY(set_block_range_allocation_state(run_start, run_length, false));
+        run_start = block_index;
+        run_length = 1;
+    }
+    if (run_length)
+        TRY(set_block_range_allocation_state(run_start, run_length, false));
+    return {};
 }
 
 ErrorOr<NonnullLockRefPtr<Inode>> Ext2FS::create_directory(Ext2FSInode& parent_inode, StringView name, mode_t mode, UserID uid, GroupID gid)
@@ -540,6 +641,13 @@ ErrorOr<void> Ext2FS::prepare_to_clear_last_mount()
             return EBUSY;
     }
 
+    // Give back the blocks our inodes reserved to grow into, and make sure the bitmaps say so on disk too.
+    for (auto& it : m_inode_cache) {
+        if (it.value)
+            TRY(it.value->discard_preallocated_blocks());
+    }
+    flush_writes();
+
     BlockBasedFileSystem::remove_disk_cache_before_last_unmount();
     m_inode_cache.clear();
     m_root_inode = nullptr;
@@ -555,11 +663,7 @@ ErrorOr<void> Ext2FS::free_inode(Ext2FSInode& inode)
     // Mark all blocks used by this inode as free.
     {
         auto blocks = TRY(inode.compute_block_list_with_meta_blocks());
-        for (auto block_index : blocks) {
-            VERIFY(block_index <= super_block().s_blocks_count);
-            if (block_index.value())
-                TRY(set_block_allocation_state(block_index, false));
-        }
+        TRY(free_blocks(blocks));
     }
 
     // If the inode being freed is a directory, update block group directory counter.
@@ -584,7 +688,7 @@ ErrorOr<void> Ext2FS::free_inode(Ext2FSInode& inode)
 void Ext2FS::flush_block_group_descriptor_table()
 {
     MutexLocker locker(m_lock);
-    auto blocks_to_write = ceil_div(m_block_group_count * sizeof(ext2_group_desc), block_size());
+    auto blocks_to_write = ceil_div(m_block_group_count * group_descriptor_size(), block_size());
     auto first_block_of_bgdt = block_size() == 1024 ? 2 : 1;
     auto buffer = UserOrKernelBuffer::for_kernel_buffer((u8*)block_group_descriptors());
     if (auto result = write_blocks(first_block_of_bgdt, blocks_to_write, buffer); result.is_error())
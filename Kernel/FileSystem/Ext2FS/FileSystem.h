@@ -10,6 +10,7 @@
 #include <AK/HashMap.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
 #include <Kernel/FileSystem/Ext2FS/Definitions.h>
+#include <Kernel/FileSystem/Ext2FS/DirectoryIndex.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/UnixTypes.h>
@@ -52,9 +53,12 @@ private:
 
     ext2_super_block const& super_block() const { return m_super_block; }
     ext2_group_desc const& group_descriptor(GroupIndex) const;
+    size_t group_descriptor_size() const;
     ext2_group_desc* block_group_descriptors() { return (ext2_group_desc*)m_cached_group_descriptor_table->data(); }
     ext2_group_desc const* block_group_descriptors() const { return (ext2_group_desc const*)m_cached_group_descriptor_table->data(); }
     void flush_block_group_descriptor_table();
+    bool has_directory_index() const;
+    Ext2FSDirectoryIndex directory_index() const;
     u64 inodes_per_block() const;
     u64 inodes_per_group() const;
     u64 blocks_per_group() const;
@@ -78,13 +82,16 @@ private:
 
     BlockIndex first_block_index() const;
     ErrorOr<InodeIndex> allocate_inode(GroupIndex preferred_group = 0);
-    ErrorOr<Vector<BlockIndex>> allocate_blocks(GroupIndex preferred_group_index, size_t count);
+    ErrorOr<Vector<BlockIndex>> allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal = 0);
+    ErrorOr<size_t> allocate_blocks_at(BlockIndex first_block, size_t max_count);
     GroupIndex group_index_from_inode(InodeIndex) const;
     GroupIndex group_index_from_block_index(BlockIndex) const;
 
     ErrorOr<bool> get_inode_allocation_state(InodeIndex) const;
     ErrorOr<void> set_inode_allocation_state(InodeIndex, bool);
     ErrorOr<void> set_block_allocation_state(BlockIndex, bool);
+    ErrorOr<void> set_block_range_allocation_state(BlockIndex first_block, size_t count, bool);
+    ErrorOr<void> free_blocks(Span<BlockIndex const>);
 
     void uncache_inode(InodeIndex);
     ErrorOr<void> free_inode(Ext2FSInode&);
@@ -122,7 +129,7 @@ private:
     };
 
     ErrorOr<CachedBitmap*> get_bitmap_block(BlockIndex);
-    ErrorOr<void> update_bitmap_block(BlockIndex bitmap_block, size_t bit_index, bool new_state, u32& super_block_counter, u16& group_descriptor_counter);
+    ErrorOr<void> update_bitmap_block(BlockIndex bitmap_block, size_t first_bit_index, size_t bit_count, bool new_state, u32& super_block_counter, u16& group_descriptor_counter);
 
     Vector<OwnPtr<CachedBitmap>> m_cached_bitmaps;
     LockRefPtr<Ext2FSInode> m_root_inode;
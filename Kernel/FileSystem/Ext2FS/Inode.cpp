@@ -15,6 +15,9 @@
 namespace Kernel {
 
 static constexpr size_t max_inline_symlink_length = 60;
+static constexpr size_t preallocation_block_count = 8;
+// The deepest extent tree the ext4 driver in Linux creates.
+static constexpr u16 max_extent_tree_depth = 5;
 
 static u8 to_ext2_file_type(mode_t mode)
 {
@@ -35,6 +38,57 @@ static u8 to_ext2_file_type(mode_t mode)
     return EXT2_FT_UNKNOWN;
 }
 
+ErrorOr<Vector<Ext2FS::BlockIndex>> Ext2FSInode::allocate_blocks_for_growth(size_t count, BlockBasedFileSystem::BlockIndex last_block)
+{
+    Vector<Ext2FS::BlockIndex> blocks;
+    TRY(blocks.try_ensure_capacity(count));
+
+    // Use up what we reserved earlier first, as long as it still follows the end of the file.
+    if (m_preallocated_count && last_block != 0 && m_preallocated_start.value() == last_block.value() + 1) {
+        auto taken = min(count, m_preallocated_count);
+        for (size_t i = 0; i < taken; ++i)
+            blocks.unchecked_append(m_preallocated_start.value() + i);
+        m_preallocated_start = m_preallocated_start.value() + taken;
+        m_preallocated_count -= taken;
+        if (!m_preallocated_count)
+            m_preallocated_start = 0;
+    } else {
+        TRY(discard_preallocated_blocks());
+    }
+
+    if (blocks.size() < count) {
+        Ext2FS::BlockIndex goal = blocks.is_empty() ? last_block : blocks.last();
+        if (goal != 0)
+            goal = goal.value() + 1;
+        auto new_blocks = TRY(fs().allocate_blocks(fs().group_index_from_inode(index()), count - blocks.size(), goal));
+        TRY(blocks.try_extend(move(new_blocks)));
+    }
+
+    // Reserve a few more blocks behind the new end of the file, in case it keeps growing.
+    // This is purely an optimization, so it's fine if the blocks behind us are taken already.
+    if (!m_preallocated_count && Kernel::is_regular_file(m_raw_inode.i_mode)) {
+        Ext2FS::BlockIndex goal = blocks.last().value() + 1;
+        if (auto preallocated_count_or_error = fs().allocate_blocks_at(goal, preallocation_block_count); !preallocated_count_or_error.is_error() && preallocated_count_or_error.value()) {
+            m_preallocated_start = goal;
+            m_preallocated_count = preallocated_count_or_error.value();
+            dbgln_if(EXT2_BLOCKLIST_DEBUG, "Ext2FSInode[{}]::allocate_blocks_for_growth(): Preallocated {} blocks at {}", identifier(), m_preallocated_count, m_preallocated_start);
+        }
+    }
+
+    return blocks;
+}
+
+ErrorOr<void> Ext2FSInode::discard_preallocated_blocks()
+{
+    if (!m_preallocated_count)
+        return {};
+    auto first_block = m_preallocated_start;
+    auto count = m_preallocated_count;
+    m_preallocated_start = 0;
+    m_preallocated_count = 0;
+    return fs().set_block_range_allocation_state(first_block, count, false);
+}
+
 ErrorOr<void> Ext2FSInode::write_indirect_block(BlockBasedFileSystem::BlockIndex block, Span<BlockBasedFileSystem::BlockIndex> blocks_indices)
 {
     auto const entries_per_block = EXT2_ADDR_PER_BLOCK(&fs().super_block());
@@ -202,11 +256,11 @@ ErrorOr<void> Ext2FSInode::shrink_triply_indirect_block(BlockBasedFileSystem::Bl
     return {};
 }
 
-ErrorOr<void> Ext2FSInode::flush_block_list()
+ErrorOr<void> Ext2FSInode::flush_block_list(Vector<BlockBasedFileSystem::BlockIndex>& block_list)
 {
     MutexLocker locker(m_inode_lock);
 
-    if (m_block_list.is_empty()) {
+    if (block_list.is_empty()) {
         m_raw_inode.i_blocks = 0;
         memset(m_raw_inode.i_block, 0, sizeof(m_raw_inode.i_block));
         set_metadata_dirty(true);
@@ -217,26 +271,26 @@ ErrorOr<void> Ext2FSInode::flush_block_list()
     auto const old_block_count = ceil_div(size(), static_cast<u64>(fs().block_size()));
 
     auto old_shape = fs().compute_block_list_shape(old_block_count);
-    auto const new_shape = fs().compute_block_list_shape(m_block_list.size());
+    auto const new_shape = fs().compute_block_list_shape(block_list.size());
 
     Vector<Ext2FS::BlockIndex> new_meta_blocks;
     if (new_shape.meta_blocks > old_shape.meta_blocks) {
         new_meta_blocks = TRY(fs().allocate_blocks(fs().group_index_from_inode(index()), new_shape.meta_blocks - old_shape.meta_blocks));
     }
 
-    m_raw_inode.i_blocks = (m_block_list.size() + new_shape.meta_blocks) * (fs().block_size() / 512);
+    m_raw_inode.i_blocks = (block_list.size() + new_shape.meta_blocks) * (fs().block_size() / 512);
     dbgln_if(EXT2_BLOCKLIST_DEBUG, "Ext2FSInode[{}]::flush_block_list(): Old shape=({};{};{};{}:{}), new shape=({};{};{};{}:{})", identifier(), old_shape.direct_blocks, old_shape.indirect_blocks, old_shape.doubly_indirect_blocks, old_shape.triply_indirect_blocks, old_shape.meta_blocks, new_shape.direct_blocks, new_shape.indirect_blocks, new_shape.doubly_indirect_blocks, new_shape.triply_indirect_blocks, new_shape.meta_blocks);
 
     unsigned output_block_index = 0;
-    unsigned remaining_blocks = m_block_list.size();
+    unsigned remaining_blocks = block_list.size();
 
     // Deal with direct blocks.
     bool inode_dirty = false;
     VERIFY(new_shape.direct_blocks <= EXT2_NDIR_BLOCKS);
     for (unsigned i = 0; i < new_shape.direct_blocks; ++i) {
-        if (BlockBasedFileSystem::BlockIndex(m_raw_inode.i_block[i]) != m_block_list[output_block_index])
+        if (BlockBasedFileSystem::BlockIndex(m_raw_inode.i_block[i]) != block_list[output_block_index])
             inode_dirty = true;
-        m_raw_inode.i_block[i] = m_block_list[output_block_index].value();
+        m_raw_inode.i_block[i] = block_list[output_block_index].value();
         ++output_block_index;
         --remaining_blocks;
     }
@@ -251,9 +305,9 @@ ErrorOr<void> Ext2FSInode::flush_block_list()
     }
     if (inode_dirty) {
         if constexpr (EXT2_DEBUG) {
-            dbgln("Ext2FSInode[{}]::flush_block_list(): Writing {} direct block(s) to i_block array of inode {}", identifier(), min((size_t)EXT2_NDIR_BLOCKS, m_block_list.size()), index());
-            for (size_t i = 0; i < min((size_t)EXT2_NDIR_BLOCKS, m_block_list.size()); ++i)
-                dbgln("   + {}", m_block_list[i]);
+            dbgln("Ext2FSInode[{}]::flush_block_list(): Writing {} direct block(s) to i_block array of inode {}", identifier(), min((size_t)EXT2_NDIR_BLOCKS, block_list.size()), index());
+            for (size_t i = 0; i < min((size_t)EXT2_NDIR_BLOCKS, block_list.size()); ++i)
+                dbgln("   + {}", block_list[i]);
         }
         set_metadata_dirty(true);
     }
@@ -270,7 +324,7 @@ ErrorOr<void> Ext2FSInode::flush_block_list()
                 old_shape.meta_blocks++;
             }
 
-            TRY(write_indirect_block(m_raw_inode.i_block[EXT2_IND_BLOCK], m_block_list.span().slice(output_block_index, new_shape.indirect_blocks)));
+            TRY(write_indirect_block(m_raw_inode.i_block[EXT2_IND_BLOCK], block_list.span().slice(output_block_index, new_shape.indirect_blocks)));
         } else if ((new_shape.indirect_blocks == 0) && (old_shape.indirect_blocks != 0)) {
             dbgln_if(EXT2_BLOCKLIST_DEBUG, "Ext2FSInode[{}]::flush_block_list(): Freeing indirect block: {}", identifier(), m_raw_inode.i_block[EXT2_IND_BLOCK]);
             TRY(fs().set_block_allocation_state(m_raw_inode.i_block[EXT2_IND_BLOCK], false));
@@ -292,7 +346,7 @@ ErrorOr<void> Ext2FSInode::flush_block_list()
                 set_metadata_dirty(true);
                 old_shape.meta_blocks++;
             }
-            TRY(grow_doubly_indirect_block(m_raw_inode.i_block[EXT2_DIND_BLOCK], old_shape.doubly_indirect_blocks, m_block_list.span().slice(output_block_index, new_shape.doubly_indirect_blocks), new_meta_blocks, old_shape.meta_blocks));
+            TRY(grow_doubly_indirect_block(m_raw_inode.i_block[EXT2_DIND_BLOCK], old_shape.doubly_indirect_blocks, block_list.span().slice(output_block_index, new_shape.doubly_indirect_blocks), new_meta_blocks, old_shape.meta_blocks));
         } else {
             TRY(shrink_doubly_indirect_block(m_raw_inode.i_block[EXT2_DIND_BLOCK], old_shape.doubly_indirect_blocks, new_shape.doubly_indirect_blocks, old_shape.meta_blocks));
             if (new_shape.doubly_indirect_blocks == 0)
@@ -313,7 +367,7 @@ ErrorOr<void> Ext2FSInode::flush_block_list()
                 set_metadata_dirty(true);
                 old_shape.meta_blocks++;
             }
-            TRY(grow_triply_indirect_block(m_raw_inode.i_block[EXT2_TIND_BLOCK], old_shape.triply_indirect_blocks, m_block_list.span().slice(output_block_index, new_shape.triply_indirect_blocks), new_meta_blocks, old_shape.meta_blocks));
+            TRY(grow_triply_indirect_block(m_raw_inode.i_block[EXT2_TIND_BLOCK], old_shape.triply_indirect_blocks, block_list.span().slice(output_block_index, new_shape.triply_indirect_blocks), new_meta_blocks, old_shape.meta_blocks));
         } else {
             TRY(shrink_triply_indirect_block(m_raw_inode.i_block[EXT2_TIND_BLOCK], old_shape.triply_indirect_blocks, new_shape.triply_indirect_blocks, old_shape.meta_blocks));
             if (new_shape.triply_indirect_blocks == 0)
@@ -347,12 +401,65 @@ ErrorOr<Vector<Ext2FS::BlockIndex>> Ext2FSInode::compute_block_list_with_meta_bl
 ErrorOr<Vector<Ext2FS::BlockIndex>> Ext2FSInode::compute_block_list_impl(bool include_block_list_blocks) const
 {
     // FIXME: This is really awkwardly factored.. foo_impl_internal :|
-    auto block_list = TRY(compute_block_list_impl_internal(m_raw_inode, include_block_list_blocks));
+    auto block_list = uses_extents() ? TRY(compute_extent_tree_block_list(include_block_list_blocks)) : TRY(compute_block_list_impl_internal(m_raw_inode, include_block_list_blocks));
     while (!block_list.is_empty() && block_list.last() == 0)
         block_list.take_last();
     return block_list;
 }
 
+ErrorOr<Vector<Ext2FS::BlockIndex>> Ext2FSInode::compute_extent_tree_block_list(bool include_block_list_blocks) const
+{
+    auto const total_blocks = block_count();
+    Vector<Ext2FS::BlockIndex> list;
+    TRY(list.try_resize(total_blocks));
+    // Blocks that aren't part of the file contents (index nodes, and extents allocated past the end of the file)
+    // only matter when the whole inode is freed, so they go behind the positional list of data blocks.
+    Vector<Ext2FS::BlockIndex> other_blocks;
+
+    auto visit_node = [&](ReadonlyBytes node, Optional<u16> expected_depth, auto& visit_node) -> ErrorOr<void> {
+        auto header = TRY(read_extent_tree_header(node));
+        if ((expected_depth.has_value() && header.eh_depth != expected_depth.value()) || header.eh_depth > max_extent_tree_depth)
+            return EIO;
+
+        if (header.eh_depth > 0) {
+            auto const* indexes = reinterpret_cast<ext4_extent_idx const*>(node.offset_pointer(sizeof(ext4_extent_header)));
+            auto child = TRY(ByteBuffer::create_uninitialized(fs().block_size()));
+            for (size_t i = 0; i < header.eh_entries; ++i) {
+                u64 child_block = static_cast<u64>(indexes[i].ei_leaf_hi) << 32 | indexes[i].ei_leaf_lo;
+                if (child_block == 0 || child_block >= fs().super_block().s_blocks_count)
+                    return EIO;
+                if (include_block_list_blocks)
+                    TRY(other_blocks.try_append(child_block));
+                auto buffer = UserOrKernelBuffer::for_kernel_buffer(child.data());
+                TRY(fs().read_block(child_block, &buffer, fs().block_size()));
+                TRY(visit_node(child.bytes(), header.eh_depth - 1, visit_node));
+            }
+            return {};
+        }
+
+        auto const* extents = reinterpret_cast<ext4_extent const*>(node.offset_pointer(sizeof(ext4_extent_header)));
+        for (size_t i = 0; i < header.eh_entries; ++i) {
+            auto& extent = extents[i];
+            u64 length = extent.ee_len <= EXT4_EXT_INIT_MAX_LEN ? extent.ee_len : extent.ee_len - EXT4_EXT_INIT_MAX_LEN;
+            u64 physical_start = static_cast<u64>(extent.ee_start_hi) << 32 | extent.ee_start_lo;
+            if (physical_start == 0 || physical_start + length > fs().super_block().s_blocks_count)
+                return EIO;
+            for (u64 j = 0; j < length; ++j) {
+                u64 logical_block = static_cast<u64>(extent.ee_block) + j;
+                if (logical_block < total_blocks)
+                    list[logical_block] = physical_start + j;
+                else if (include_block_list_blocks)
+                    TRY(other_blocks.try_append(physical_start + j));
+            }
+        }
+        return {};
+    };
+    TRY(visit_node({ m_raw_inode.i_block, sizeof(m_raw_inode.i_block) }, {}, visit_node));
+
+    TRY(list.try_extend(other_blocks));
+    return list;
+}
+
 ErrorOr<Vector<Ext2FS::BlockIndex>> Ext2FSInode::compute_block_list_impl_internal(ext2_inode const& e2inode, bool include_block_list_blocks) const
 {
     unsigned entries_per_block = EXT2_ADDR_PER_BLOCK(&fs().super_block());
@@ -454,6 +561,9 @@ Ext2FSInode::Ext2FSInode(Ext2FS& fs, InodeIndex index)
 
 Ext2FSInode::~Ext2FSInode()
 {
+    // Alas, we have nowhere to propagate any errors that occur here.
+    (void)discard_preallocated_blocks();
+
     if (m_raw_inode.i_links_count == 0) {
         // Alas, we have nowhere to propagate any errors that occur here.
         (void)fs().free_inode(*this);
@@ -510,19 +620,265 @@ ErrorOr<void> Ext2FSInode::flush_metadata()
     return {};
 }
 
-ErrorOr<void> Ext2FSInode::compute_block_list_with_exclusive_locking()
+u64 Ext2FSInode::block_count() const
 {
-    // Note: We verify that the inode mutex is being held locked. Because only the read_bytes_locked()
-    // method uses this method and the mutex can be locked in shared mode when reading the Inode if
-    // it is an ext2 regular file, but also in exclusive mode, when the Inode is an ext2 directory and being
-    // traversed, we use another exclusive lock to ensure we always mutate the block list safely.
-    VERIFY(m_inode_lock.is_locked());
-    MutexLocker block_list_locker(m_block_list_lock);
-    if (m_block_list.is_empty())
-        m_block_list = TRY(compute_block_list());
+    // Short symbolic links are stored inline in the i_block array, see compute_block_list_impl_internal().
+    if (is_symlink() && m_raw_inode.i_blocks == 0)
+        return 0;
+    return ceil_div(size(), static_cast<u64>(fs().block_size()));
+}
+
+ErrorOr<Ext2FS::BlockIndex> Ext2FSInode::read_block_pointer(BlockBasedFileSystem::BlockIndex array_block, u64 index) const
+{
+    if (array_block == 0)
+        return BlockBasedFileSystem::BlockIndex { 0 };
+    u32 pointer = 0;
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(reinterpret_cast<u8*>(&pointer));
+    TRY(fs().read_block(array_block, &buffer, sizeof(pointer), index * sizeof(pointer)));
+    return BlockBasedFileSystem::BlockIndex { pointer };
+}
+
+void Ext2FSInode::invalidate_extent_map()
+{
+    MutexLocker locker(m_extent_map_lock);
+    m_extent_map.clear();
+}
+
+ErrorOr<ext4_extent_header> Ext2FSInode::read_extent_tree_header(ReadonlyBytes node)
+{
+    ext4_extent_header header;
+    VERIFY(node.size() >= sizeof(header));
+    memcpy(&header, node.data(), sizeof(header));
+    if (header.eh_magic != EXT4_EXT_MAGIC || header.eh_entries > header.eh_max)
+        return EIO;
+    // Index entries and extents have the same size.
+    static_assert(sizeof(ext4_extent_idx) == sizeof(ext4_extent));
+    if (sizeof(header) + header.eh_max * sizeof(ext4_extent) > node.size())
+        return EIO;
+    return header;
+}
+
+ErrorOr<Vector<Ext2FSInode::Extent>> Ext2FSInode::block_pointer_window_around(BlockBasedFileSystem::BlockIndex logical_block) const
+{
+    u64 const entries_per_block = EXT2_ADDR_PER_BLOCK(&fs().super_block());
+    auto const total_blocks = block_count();
+    VERIFY(logical_block < total_blocks);
+
+    // Find the array of block pointers covering this block, which is either the i_block array itself
+    // or the single indirect block at the bottom of the tree that leads to it.
+    u64 const indirect_start = EXT2_NDIR_BLOCKS;
+    u64 const doubly_indirect_start = indirect_start + entries_per_block;
+    u64 const triply_indirect_start = doubly_indirect_start + entries_per_block * entries_per_block;
+
+    u64 window_start = 0;
+    u64 window_length = entries_per_block;
+    BlockBasedFileSystem::BlockIndex array_block { 0 };
+    auto block = logical_block.value();
+    if (block < indirect_start) {
+        window_length = EXT2_NDIR_BLOCKS;
+    } else if (block < doubly_indirect_start) {
+        window_start = indirect_start;
+        array_block = m_raw_inode.i_block[EXT2_IND_BLOCK];
+    } else if (block < triply_indirect_start) {
+        auto relative_block = block - doubly_indirect_start;
+        window_start = doubly_indirect_start + (relative_block / entries_per_block) * entries_per_block;
+        array_block = TRY(read_block_pointer(m_raw_inode.i_block[EXT2_DIND_BLOCK], relative_block / entries_per_block));
+    } else {
+        auto relative_block = block - triply_indirect_start;
+        VERIFY(relative_block < entries_per_block * entries_per_block * entries_per_block);
+        window_start = triply_indirect_start + (relative_block / entries_per_block) * entries_per_block;
+        auto doubly_indirect_block = TRY(read_block_pointer(m_raw_inode.i_block[EXT2_TIND_BLOCK], relative_block / (entries_per_block * entries_per_block)));
+        array_block = TRY(read_block_pointer(doubly_indirect_block, (relative_block / entries_per_block) % entries_per_block));
+    }
+    window_length = min(window_length, total_blocks - window_start);
+
+    Vector<u32> pointers;
+    TRY(pointers.try_resize(window_length));
+    if (window_start == 0) {
+        for (size_t i = 0; i < window_length; ++i)
+            pointers[i] = m_raw_inode.i_block[i];
+    } else if (array_block != 0) {
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(reinterpret_cast<u8*>(pointers.data()));
+        TRY(fs().read_block(array_block, &buffer, window_length * sizeof(u32), 0));
+    }
+    // NOTE: If the indirect block leading to this window is missing, all of it is a hole, which `pointers` already is.
+
+    Vector<Extent> window_extents;
+    for (size_t i = 0; i < window_length; ++i) {
+        if (!window_extents.is_empty()) {
+            auto& last = window_extents.last();
+            auto expected_physical_block = last.is_hole() ? 0 : last.physical_start.value() + last.length;
+            if (pointers[i] == expected_physical_block) {
+                ++last.length;
+                continue;
+            }
+        }
+        TRY(window_extents.try_append({ window_start + i, pointers[i], 1 }));
+    }
+    return window_extents;
+}
+
+ErrorOr<Vector<Ext2FSInode::Extent>> Ext2FSInode::extent_tree_window_around(BlockBasedFileSystem::BlockIndex logical_block) const
+{
+    auto const total_blocks = block_count();
+    VERIFY(logical_block < total_blocks);
+
+    // Walk down the tree, narrowing the window of logical blocks to the range covered by the index entry we follow.
+    // The leaf we end up in then describes every block in that window, either as an extent or by leaving it out.
+    u64 window_start = 0;
+    u64 window_end = total_blocks;
+    auto node = ReadonlyBytes { m_raw_inode.i_block, sizeof(m_raw_inode.i_block) };
+    ByteBuffer node_storage;
+    auto block = logical_block.value();
+    auto header = TRY(read_extent_tree_header(node));
+    if (header.eh_depth > max_extent_tree_depth)
+        return EIO;
+    while (header.eh_depth > 0) {
+
+        auto const* indexes = reinterpret_cast<ext4_extent_idx const*>(node.offset_pointer(sizeof(ext4_extent_header)));
+        if (header.eh_entries == 0 || block < indexes[0].ei_block) {
+            // Nothing in the tree covers the blocks in front of the first index entry.
+            window_end = header.eh_entries == 0 ? window_end : min(window_end, static_cast<u64>(indexes[0].ei_block));
+            Vector<Extent> hole;
+            TRY(hole.try_append({ window_start, 0, window_end - window_start }));
+            return hole;
+        }
+        size_t low = 1;
+        size_t high = header.eh_entries;
+        while (low < high) {
+            auto middle = low + (high - low) / 2;
+            if (indexes[middle].ei_block > block)
+                high = middle;
+            else
+                low = middle + 1;
+        }
+        auto& index = indexes[low - 1];
+        window_start = max(window_start, static_cast<u64>(index.ei_block));
+        if (low < header.eh_entries)
+            window_end = min(window_end, static_cast<u64>(indexes[low].ei_block));
+
+        if (node_storage.is_empty())
+            node_storage = TRY(ByteBuffer::create_uninitialized(fs().block_size()));
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(node_storage.data());
+        TRY(fs().read_block(static_cast<u64>(index.ei_leaf_hi) << 32 | index.ei_leaf_lo, &buffer, fs().block_size()));
+        node = node_storage.bytes();
+
+        auto depth = header.eh_depth;
+        header = TRY(read_extent_tree_header(node));
+        if (header.eh_depth != depth - 1)
+            return EIO;
+    }
+
+    Vector<Extent> window_extents;
+    auto append = [&](u64 logical_start, u64 physical_start, u64 length) -> ErrorOr<void> {
+        if (!window_extents.is_empty()) {
+            auto& last = window_extents.last();
+            if (last.is_hole() == (physical_start == 0) && (last.is_hole() || last.physical_start.value() + last.length == physical_start)) {
+                last.length += length;
+                return {};
+            }
+        }
+        return window_extents.try_append({ logical_start, physical_start, length });
+    };
+
+    u64 position = window_start;
+    auto const* extents = reinterpret_cast<ext4_extent const*>(node.offset_pointer(sizeof(ext4_extent_header)));
+    for (size_t i = 0; i < header.eh_entries && position < window_end; ++i) {
+        auto& extent = extents[i];
+        bool is_initialized = extent.ee_len <= EXT4_EXT_INIT_MAX_LEN;
+        u64 length = is_initialized ? extent.ee_len : extent.ee_len - EXT4_EXT_INIT_MAX_LEN;
+        u64 start = extent.ee_block;
+        u64 physical_start = static_cast<u64>(extent.ee_start_hi) << 32 | extent.ee_start_lo;
+        if (start + length <= position)
+            continue;
+        if (start < position) {
+            // Extents in a leaf are sorted and never overlap, so only the first one may reach into our window from the front.
+            if (position != window_start)
+                return EIO;
+            physical_start += position - start;
+            length -= position - start;
+            start = position;
+        }
+        if (start >= window_end)
+            break;
+        length = min(length, window_end - start);
+        if (start > position)
+            TRY(append(position, 0, start - position));
+        // Uninitialized extents are allocated, but read back as zeroes, just like holes.
+        TRY(append(start, is_initialized ? physical_start : 0, length));
+        position = start + length;
+    }
+    if (position < window_end)
+        TRY(append(position, 0, window_end - position));
+    return window_extents;
+}
+
+ErrorOr<void> Ext2FSInode::map_extents_around(BlockBasedFileSystem::BlockIndex logical_block)
+{
+    VERIFY(m_extent_map_lock.is_exclusively_locked_by_current_thread());
+
+    auto window_extents = uses_extents() ? TRY(extent_tree_window_around(logical_block)) : TRY(block_pointer_window_around(logical_block));
+    VERIFY(!window_extents.is_empty());
+    auto window_start = window_extents.first().logical_start;
+
+    // The extents of a window are always mapped together, so it can't overlap with anything we have already.
+    size_t insertion_index = 0;
+    while (insertion_index < m_extent_map.size() && m_extent_map[insertion_index].logical_start < window_start)
+        ++insertion_index;
+    TRY(m_extent_map.try_ensure_capacity(m_extent_map.size() + window_extents.size()));
+    for (size_t i = 0; i < window_extents.size(); ++i)
+        MUST(m_extent_map.try_insert(insertion_index + i, window_extents[i]));
+
+    // Coalesce with the neighbouring windows where the run continues across their boundary.
+    auto try_merge_with_next = [&](size_t index) {
+        if (index + 1 >= m_extent_map.size())
+            return;
+        auto& extent = m_extent_map[index];
+        auto& next = m_extent_map[index + 1];
+        if (extent.end() != next.logical_start || extent.is_hole() != next.is_hole())
+            return;
+        if (!extent.is_hole() && extent.physical_start.value() + extent.length != next.physical_start.value())
+            return;
+        extent.length += next.length;
+        m_extent_map.remove(index + 1);
+    };
+    try_merge_with_next(insertion_index + window_extents.size() - 1);
+    if (insertion_index > 0)
+        try_merge_with_next(insertion_index - 1);
     return {};
 }
 
+ErrorOr<Ext2FSInode::Extent> Ext2FSInode::extent_containing(BlockBasedFileSystem::BlockIndex logical_block)
+{
+    // Note: Readers only hold the inode lock in shared mode, so the extent map needs a lock of its own.
+    MutexLocker locker(m_extent_map_lock);
+    if (logical_block >= block_count())
+        return EINVAL;
+
+    auto find = [&]() -> Optional<Extent> {
+        size_t low = 0;
+        size_t high = m_extent_map.size();
+        while (low < high) {
+            auto middle = low + (high - low) / 2;
+            auto& extent = m_extent_map[middle];
+            if (extent.contains(logical_block))
+                return extent;
+            if (logical_block < extent.logical_start)
+                high = middle;
+            else
+                low = middle + 1;
+        }
+        return {};
+    };
+
+    if (auto extent = find(); extent.has_value())
+        return extent.release_value();
+    TRY(map_extents_around(logical_block));
+    auto extent = find();
+    VERIFY(extent.has_value());
+    return extent.release_value();
+}
+
 ErrorOr<size_t> Ext2FSInode::read_bytes_locked(off_t offset, size_t count, UserOrKernelBuffer& buffer, OpenFileDescription* description) const
 {
     VERIFY(m_inode_lock.is_locked());
@@ -542,45 +898,49 @@ ErrorOr<size_t> Ext2FSInode::read_bytes_locked(off_t offset, size_t count, UserO
         return nread;
     }
 
-    // Note: We bypass the const declaration of this method, but this is a strong
-    // requirement to be able to accomplish the read operation successfully.
-    // We call this special method because it locks a separate mutex to ensure we
-    // update the block list of the inode safely, as the m_inode_lock is locked in
-    // shared mode.
-    TRY(const_cast<Ext2FSInode&>(*this).compute_block_list_with_exclusive_locking());
-
-    if (m_block_list.is_empty()) {
-        dmesgln("Ext2FSInode[{}]::read_bytes(): Empty block list", identifier());
-        return EIO;
-    }
-
     bool allow_cache = !description || !description->is_direct();
 
-    int const block_size = fs().block_size();
-
-    BlockBasedFileSystem::BlockIndex first_block_logical_index = offset / block_size;
-    BlockBasedFileSystem::BlockIndex last_block_logical_index = (offset + count) / block_size;
-    if (last_block_logical_index >= m_block_list.size())
-        last_block_logical_index = m_block_list.size() - 1;
-
-    int offset_into_first_block = offset % block_size;
+    u64 const block_size = fs().block_size();
 
     size_t nread = 0;
     auto remaining_count = min((off_t)count, (off_t)size() - offset);
 
     dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::read_bytes(): Reading up to {} bytes, {} bytes into inode to {}", identifier(), count, offset, buffer.user_or_kernel_ptr());
 
-    for (auto bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index; bi = bi.value() + 1) {
-        auto block_index = m_block_list[bi.value()];
-        size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
-        size_t num_bytes_to_copy = min((size_t)block_size - offset_into_block, (size_t)remaining_count);
+    while (remaining_count > 0) {
+        u64 current_offset = offset + nread;
+        BlockBasedFileSystem::BlockIndex logical_block = current_offset / block_size;
+        size_t offset_into_block = current_offset % block_size;
+
+        // Note: We bypass the const declaration of this method, since looking up a block may have to fill in
+        // the extent map, which has a lock of its own as the inode lock may only be held in shared mode here.
+        auto extent_or_error = const_cast<Ext2FSInode&>(*this).extent_containing(logical_block);
+        if (extent_or_error.is_error()) {
+            dmesgln("Ext2FSInode[{}]::read_bytes(): Failed to map block (index {})", identifier(), logical_block);
+            return extent_or_error.release_error();
+        }
+        auto extent = extent_or_error.release_value();
+
+        // Read as much of the extent as we can in one go.
+        u64 bytes_left_in_extent = (extent.end().value() - logical_block.value()) * block_size - offset_into_block;
+        size_t num_bytes_to_copy = min(bytes_left_in_extent, static_cast<u64>(remaining_count));
         auto buffer_offset = buffer.offset(nread);
-        if (block_index.value() == 0) {
+        if (extent.is_hole()) {
             // This is a hole, act as if it's filled with zeroes.
             TRY(buffer_offset.memset(0, num_bytes_to_copy));
         } else {
-            if (auto result = fs().read_block(block_index, &buffer_offset, num_bytes_to_copy, offset_into_block, allow_cache); result.is_error()) {
-                dmesgln("Ext2FSInode[{}]::read_bytes(): Failed to read block {} (index {})", identifier(), block_index.value(), bi);
+            BlockBasedFileSystem::BlockIndex block_index = extent.physical_start.value() + (logical_block.value() - extent.logical_start.value());
+            ErrorOr<void> result;
+            if (offset_into_block != 0 || num_bytes_to_copy < block_size) {
+                num_bytes_to_copy = min(num_bytes_to_copy, block_size - offset_into_block);
+                result = fs().read_block(block_index, &buffer_offset, num_bytes_to_copy, offset_into_block, allow_cache);
+            } else {
+                auto block_count = min(num_bytes_to_copy / block_size, static_cast<u64>(NumericLimits<unsigned>::max()));
+                num_bytes_to_copy = block_count * block_size;
+                result = fs().read_blocks(block_index, block_count, buffer_offset, allow_cache);
+            }
+            if (result.is_error()) {
+                dmesgln("Ext2FSInode[{}]::read_bytes(): Failed to read block {} (index {})", identifier(), block_index.value(), logical_block);
                 return result.release_error();
             }
         }
@@ -591,12 +951,16 @@ ErrorOr<size_t> Ext2FSInode::read_bytes_locked(off_t offset, size_t count, UserO
     return nread;
 }
 
-ErrorOr<void> Ext2FSInode::resize(u64 new_size)
+ErrorOr<void> Ext2FSInode::resize(u64 new_size, ShouldZeroFill should_zero_fill)
 {
     auto old_size = size();
     if (old_size == new_size)
         return {};
 
+    // FIXME: Grow and shrink extent trees, we can only read and overwrite the blocks they already map.
+    if (uses_extents())
+        return EROFS;
+
     if (!((u32)fs().get_features_readonly() & (u32)Ext2FS::FeaturesReadOnly::FileSize64bits) && (new_size >= static_cast<u32>(-1)))
         return ENOSPC;
 
@@ -611,43 +975,49 @@ ErrorOr<void> Ext2FSInode::resize(u64 new_size)
 
     if (blocks_needed_after > blocks_needed_before) {
         auto additional_blocks_needed = blocks_needed_after - blocks_needed_before;
-        if (additional_blocks_needed > fs().super_block().s_free_blocks_count)
+        if (additional_blocks_needed > fs().super_block().s_free_blocks_count + m_preallocated_count)
             return ENOSPC;
     }
 
-    if (m_block_list.is_empty())
-        m_block_list = TRY(compute_block_list());
+    // NOTE: Flushing the block list rewrites all of the indirect blocks anyway, so there's nothing to gain
+    //       from keeping the full list around between resizes.
+    auto block_list = TRY(compute_block_list());
 
     if (blocks_needed_after > blocks_needed_before) {
-        auto blocks = TRY(fs().allocate_blocks(fs().group_index_from_inode(index()), blocks_needed_after - blocks_needed_before));
-        TRY(m_block_list.try_extend(move(blocks)));
+        auto last_block = block_list.is_empty() ? BlockBasedFileSystem::BlockIndex { 0 } : block_list.last();
+        auto blocks = TRY(allocate_blocks_for_growth(blocks_needed_after - blocks_needed_before, last_block));
+        TRY(block_list.try_extend(move(blocks)));
     } else if (blocks_needed_after < blocks_needed_before) {
+        // Whatever we reserved behind the old end of the file is of no use anymore.
+        TRY(discard_preallocated_blocks());
         if constexpr (EXT2_VERY_DEBUG) {
-            dbgln("Ext2FSInode[{}]::resize(): Shrinking inode, old block list is {} entries:", identifier(), m_block_list.size());
-            for (auto block_index : m_block_list) {
+            dbgln("Ext2FSInode[{}]::resize(): Shrinking inode, old block list is {} entries:", identifier(), block_list.size());
+            for (auto block_index : block_list) {
                 dbgln("    # {}", block_index);
             }
         }
-        while (m_block_list.size() != blocks_needed_after) {
-            auto block_index = m_block_list.take_last();
-            if (block_index.value()) {
-                if (auto result = fs().set_block_allocation_state(block_index, false); result.is_error()) {
-                    dbgln("Ext2FSInode[{}]::resize(): Failed to free block {}: {}", identifier(), block_index, result.error());
-                    return result;
-                }
+        if (block_list.size() > blocks_needed_after) {
+            if (auto result = fs().free_blocks(block_list.span().slice(blocks_needed_after)); result.is_error()) {
+                dbgln("Ext2FSInode[{}]::resize(): Failed to free blocks: {}", identifier(), result.error());
+                return result;
             }
+            block_list.shrink(blocks_needed_after);
         }
     }
 
-    TRY(flush_block_list());
+    if (auto result = flush_block_list(block_list); result.is_error()) {
+        invalidate_extent_map();
+        return result.release_error();
+    }
 
     m_raw_inode.i_size = new_size;
     if (Kernel::is_regular_file(m_raw_inode.i_mode))
         m_raw_inode.i_dir_acl = new_size >> 32;
+    invalidate_extent_map();
 
     set_metadata_dirty(true);
 
-    if (new_size > old_size) {
+    if (new_size > old_size && should_zero_fill == ShouldZeroFill::Yes) {
         // If we're growing the inode, make sure we zero out all the new space.
         // FIXME: There are definitely more efficient ways to achieve this.
         auto bytes_to_clear = new_size - old_size;
@@ -689,34 +1059,47 @@ ErrorOr<size_t> Ext2FSInode::write_bytes_locked(off_t offset, size_t count, User
     auto const block_size = fs().block_size();
     auto new_size = max(static_cast<u64>(offset) + count, size());
 
-    TRY(resize(new_size));
-
-    if (m_block_list.is_empty())
-        m_block_list = TRY(compute_block_list());
-
-    if (m_block_list.is_empty()) {
-        dbgln("Ext2FSInode[{}]::write_bytes(): Empty block list", identifier());
-        return EIO;
+    if (new_size > size()) {
+        // Only the gap between the old end of the file and the start of the write has to be zeroed,
+        // everything after that is about to be overwritten anyway.
+        if (static_cast<u64>(offset) > size())
+            TRY(resize(offset));
+        TRY(resize(new_size, ShouldZeroFill::No));
     }
 
-    BlockBasedFileSystem::BlockIndex first_block_logical_index = offset / block_size;
-    BlockBasedFileSystem::BlockIndex last_block_logical_index = (offset + count) / block_size;
-    if (last_block_logical_index >= m_block_list.size())
-        last_block_logical_index = m_block_list.size() - 1;
-
-    size_t offset_into_first_block = offset % block_size;
-
     size_t nwritten = 0;
     auto remaining_count = min((off_t)count, (off_t)new_size - offset);
 
     dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::write_bytes_locked(): Writing {} bytes, {} bytes into inode from {}", identifier(), count, offset, data.user_or_kernel_ptr());
 
-    for (auto bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index; bi = bi.value() + 1) {
-        size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
-        size_t num_bytes_to_copy = min((size_t)block_size - offset_into_block, (size_t)remaining_count);
-        dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::write_bytes_locked(): Writing block {} (offset_into_block: {})", identifier(), m_block_list[bi.value()], offset_into_block);
-        if (auto result = fs().write_block(m_block_list[bi.value()], data.offset(nwritten), num_bytes_to_copy, offset_into_block, allow_cache); result.is_error()) {
-            dbgln("Ext2FSInode[{}]::write_bytes_locked(): Failed to write block {} (index {})", identifier(), m_block_list[bi.value()], bi);
+    while (remaining_count > 0) {
+        u64 current_offset = offset + nwritten;
+        BlockBasedFileSystem::BlockIndex logical_block = current_offset / block_size;
+        size_t offset_into_block = current_offset % block_size;
+
+        auto extent = TRY(extent_containing(logical_block));
+        if (extent.is_hole()) {
+            // FIXME: Allocate blocks for holes when they are written to.
+            dbgln("Ext2FSInode[{}]::write_bytes_locked(): Can't write into a hole (index {})", identifier(), logical_block);
+            return EIO;
+        }
+
+        // Write as much of the extent as we can in one go.
+        BlockBasedFileSystem::BlockIndex block_index = extent.physical_start.value() + (logical_block.value() - extent.logical_start.value());
+        u64 bytes_left_in_extent = (extent.end().value() - logical_block.value()) * block_size - offset_into_block;
+        size_t num_bytes_to_copy = min(bytes_left_in_extent, static_cast<u64>(remaining_count));
+        dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::write_bytes_locked(): Writing block {} (offset_into_block: {})", identifier(), block_index, offset_into_block);
+        ErrorOr<void> result;
+        if (offset_into_block != 0 || num_bytes_to_copy < block_size) {
+            num_bytes_to_copy = min(num_bytes_to_copy, block_size - offset_into_block);
+            result = fs().write_block(block_index, data.offset(nwritten), num_bytes_to_copy, offset_into_block, allow_cache);
+        } else {
+            auto block_count = min(num_bytes_to_copy / block_size, static_cast<size_t>(NumericLimits<unsigned>::max()));
+            num_bytes_to_copy = block_count * block_size;
+            result = fs().write_blocks(block_index, block_count, data.offset(nwritten), allow_cache);
+        }
+        if (result.is_error()) {
+            dbgln("Ext2FSInode[{}]::write_bytes_locked(): Failed to write block {} (index {})", identifier(), block_index, logical_block);
             return result.release_error();
         }
         remaining_count -= num_bytes_to_copy;
@@ -725,7 +1108,7 @@ ErrorOr<size_t> Ext2FSInode::write_bytes_locked(off_t offset, size_t count, User
 
     did_modify_contents();
 
-    dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::write_bytes_locked(): After write, i_size={}, i_blocks={} ({} blocks in list)", identifier(), size(), m_raw_inode.i_blocks, m_block_list.size());
+    dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::write_bytes_locked(): After write, i_size={}, i_blocks={} ({} blocks)", identifier(), size(), m_raw_inode.i_blocks, block_count());
     return nwritten;
 }
 
@@ -749,6 +1132,8 @@ ErrorOr<void> Ext2FSInode::traverse_as_directory(Function<ErrorOr<void>(FileSyst
         auto* entry = reinterpret_cast<ext2_extended_dir_entry*>(buffer);
         auto* entries_end = reinterpret_cast<ext2_extended_dir_entry*>(buffer + block_size);
         while (entry < entries_end) {
+            if (entry->rec_len < 8)
+                return EIO;
             if (entry->inode != 0) {
                 dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::traverse_as_directory(): inode {}, name_len: {}, rec_len: {}, file_type: {}, name: {}", identifier(), entry->inode, entry->name_len, entry->rec_len, entry->file_type, StringView(entry->name, entry->name_len));
                 TRY(callback({ { entry->name, entry->name_len }, { fsid(), entry->inode }, entry->file_type }));
@@ -787,6 +1172,24 @@ ErrorOr<void> Ext2FSInode::write_directory(Vector<Ext2FSDirectoryEntry>& entries
         directory_size += entry.record_length;
     }
 
+    // Large directories get an index, so looking up a name in them doesn't mean reading all of them.
+    // FIXME: Insert into and remove from the index instead of rebuilding it with the rest of the directory.
+    Optional<ByteBuffer> indexed_directory_data;
+    if (fs().has_directory_index())
+        indexed_directory_data = TRY(fs().directory_index().build(entries));
+    if (indexed_directory_data.has_value()) {
+        dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::write_directory(): Writing indexed directory (size {})", identifier(), indexed_directory_data->size());
+        m_raw_inode.i_flags |= EXT2_INDEX_FL;
+        TRY(resize(indexed_directory_data->size()));
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(indexed_directory_data->data());
+        auto nwritten = TRY(write_bytes(0, indexed_directory_data->size(), buffer, nullptr));
+        set_metadata_dirty(true);
+        if (nwritten != indexed_directory_data->size())
+            return EIO;
+        return {};
+    }
+    m_raw_inode.i_flags &= ~EXT2_INDEX_FL;
+
     dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::write_directory(): New directory contents to write (size {}):", identifier(), directory_size);
 
     auto directory_data = TRY(ByteBuffer::create_uninitialized(directory_size));
@@ -949,6 +1352,11 @@ ErrorOr<void> Ext2FSInode::replace_child(StringView name, Inode& child)
     return {};
 }
 
+bool Ext2FSInode::is_indexed_directory() const
+{
+    return is_directory() && (m_raw_inode.i_flags & EXT2_INDEX_FL) && fs().has_directory_index();
+}
+
 ErrorOr<void> Ext2FSInode::populate_lookup_cache()
 {
     VERIFY(m_inode_lock.is_exclusively_locked_by_current_thread());
@@ -975,6 +1383,24 @@ ErrorOr<NonnullLockRefPtr<Inode>> Ext2FSInode::lookup(StringView name)
     InodeIndex inode_index;
     {
         MutexLocker locker(m_inode_lock);
+        if (m_lookup_cache.is_empty() && is_indexed_directory()) {
+            auto index_or_error = fs().directory_index().lookup(name, [&](u64 logical_block, Bytes bytes) -> ErrorOr<void> {
+                auto buffer = UserOrKernelBuffer::for_kernel_buffer(bytes.data());
+                auto nread = TRY(read_bytes(logical_block * fs().block_size(), bytes.size(), buffer, nullptr));
+                if (nread != bytes.size())
+                    return EIO;
+                return {};
+            });
+            // An index we don't understand is still a perfectly fine directory, we just have to scan all of it.
+            if (!index_or_error.is_error() || index_or_error.error().code() != ENOTSUP) {
+                auto maybe_inode_index = TRY(index_or_error);
+                if (!maybe_inode_index.has_value()) {
+                    dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]:lookup(): '{}' not found in index", identifier(), name);
+                    return ENOENT;
+                }
+                return fs().get_inode({ fsid(), maybe_inode_index.value() });
+            }
+        }
         TRY(populate_lookup_cache());
         auto it = m_lookup_cache.find(name);
         if (it == m_lookup_cache.end()) {
@@ -1074,13 +1500,13 @@ ErrorOr<int> Ext2FSInode::get_block_address(int index)
 {
     MutexLocker locker(m_inode_lock);
 
-    if (m_block_list.is_empty())
-        m_block_list = TRY(compute_block_list());
-
-    if (index < 0 || (size_t)index >= m_block_list.size())
+    if (index < 0 || static_cast<u64>(index) >= block_count())
         return 0;
 
-    return m_block_list[index].value();
+    auto extent = TRY(extent_containing(index));
+    if (extent.is_hole())
+        return 0;
+    return extent.physical_start.value() + (index - extent.logical_start.value());
 }
 
 }
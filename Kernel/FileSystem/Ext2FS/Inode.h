@@ -24,6 +24,8 @@ public:
     u64 size() const;
     bool is_symlink() const { return Kernel::is_symlink(m_raw_inode.i_mode); }
     bool is_directory() const { return Kernel::is_directory(m_raw_inode.i_mode); }
+    bool uses_extents() const { return m_raw_inode.i_flags & EXT4_EXTENTS_FL; }
+    bool is_indexed_directory() const;
 
 private:
     // ^Inode
@@ -47,29 +49,62 @@ private:
 
     ErrorOr<void> write_directory(Vector<Ext2FSDirectoryEntry>&);
     ErrorOr<void> populate_lookup_cache();
-    ErrorOr<void> resize(u64);
+    enum class ShouldZeroFill {
+        No,
+        Yes,
+    };
+    ErrorOr<void> resize(u64, ShouldZeroFill = ShouldZeroFill::Yes);
+    ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> allocate_blocks_for_growth(size_t count, BlockBasedFileSystem::BlockIndex last_block);
+    ErrorOr<void> discard_preallocated_blocks();
     ErrorOr<void> write_indirect_block(BlockBasedFileSystem::BlockIndex, Span<BlockBasedFileSystem::BlockIndex>);
     ErrorOr<void> grow_doubly_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, Span<BlockBasedFileSystem::BlockIndex>, Vector<BlockBasedFileSystem::BlockIndex>&, unsigned&);
     ErrorOr<void> shrink_doubly_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, size_t, unsigned&);
     ErrorOr<void> grow_triply_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, Span<BlockBasedFileSystem::BlockIndex>, Vector<BlockBasedFileSystem::BlockIndex>&, unsigned&);
     ErrorOr<void> shrink_triply_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, size_t, unsigned&);
-    ErrorOr<void> flush_block_list();
+    ErrorOr<void> flush_block_list(Vector<BlockBasedFileSystem::BlockIndex>&);
+
+    // A run of logically contiguous blocks that are also contiguous on disk, or a run of holes.
+    struct Extent {
+        BlockBasedFileSystem::BlockIndex logical_start;
+        BlockBasedFileSystem::BlockIndex physical_start;
+        size_t length { 0 };
+
+        bool is_hole() const { return physical_start == 0; }
+        bool contains(BlockBasedFileSystem::BlockIndex logical_block) const { return logical_block >= logical_start && logical_block.value() < logical_start.value() + length; }
+        BlockBasedFileSystem::BlockIndex end() const { return logical_start.value() + length; }
+    };
+
+    u64 block_count() const;
+    ErrorOr<Extent> extent_containing(BlockBasedFileSystem::BlockIndex logical_block);
+    ErrorOr<void> map_extents_around(BlockBasedFileSystem::BlockIndex logical_block);
+    ErrorOr<Vector<Extent>> block_pointer_window_around(BlockBasedFileSystem::BlockIndex logical_block) const;
+    ErrorOr<Vector<Extent>> extent_tree_window_around(BlockBasedFileSystem::BlockIndex logical_block) const;
+    static ErrorOr<ext4_extent_header> read_extent_tree_header(ReadonlyBytes node);
+    ErrorOr<BlockBasedFileSystem::BlockIndex> read_block_pointer(BlockBasedFileSystem::BlockIndex array_block, u64 index) const;
+    void invalidate_extent_map();
 
-    ErrorOr<void> compute_block_list_with_exclusive_locking();
     ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> compute_block_list() const;
     ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> compute_block_list_with_meta_blocks() const;
     ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> compute_block_list_impl(bool include_block_list_blocks) const;
     ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> compute_block_list_impl_internal(ext2_inode const&, bool include_block_list_blocks) const;
+    ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> compute_extent_tree_block_list(bool include_block_list_blocks) const;
 
     Ext2FS& fs();
     Ext2FS const& fs() const;
     Ext2FSInode(Ext2FS&, InodeIndex);
 
-    Vector<BlockBasedFileSystem::BlockIndex> m_block_list;
+    // Sorted by logical block, and filled in one indirect block's worth of block pointers at a time
+    // whenever a block that isn't covered yet is needed.
+    Vector<Extent> m_extent_map;
+    // Blocks right behind the end of the file that are reserved for it to grow into, so files that are
+    // appended to a little at a time stay contiguous on disk. They are given back when the inode goes away.
+    BlockBasedFileSystem::BlockIndex m_preallocated_start { 0 };
+    size_t m_preallocated_count { 0 };
+
     HashMap<NonnullOwnPtr<KString>, InodeIndex> m_lookup_cache;
     ext2_inode m_raw_inode {};
 
-    Mutex m_block_list_lock { "BlockList"sv };
+    Mutex m_extent_map_lock { "ExtentMap"sv };
 };
 
 inline Ext2FS& Ext2FSInode::fs()
@@ -8,6 +8,7 @@
 
 #include <AK/AtomicRefCounted.h>
 #include <AK/Error.h>
+#include <AK/IntrusiveList.h>
 #include <AK/StringView.h>
 #include <AK/Types.h>
 #include <Kernel/Forward.h>
@@ -21,6 +22,20 @@ namespace Kernel {
 
 class File;
 
+// Gets notified whenever the readiness of a File may have changed, without a thread having to block on it.
+// NOTE: The notification is delivered with a spinlock held, so implementations must not block.
+class FileReadinessObserver {
+public:
+    virtual void file_readiness_may_have_changed() = 0;
+
+protected:
+    ~FileReadinessObserver() = default;
+
+private:
+    friend class FileBlockerSet;
+    IntrusiveListNode<FileReadinessObserver> m_file_blocker_set_list_node;
+};
+
 class FileBlockerSet final : public Thread::BlockerSet {
 public:
     FileBlockerSet() { }
@@ -34,13 +49,35 @@ public:
 
     void unblock_all_blockers_whose_conditions_are_met()
     {
-        SpinlockLocker lock(m_lock);
-        BlockerSet::unblock_all_blockers_whose_conditions_are_met_locked([&](auto& b, void* data, bool&) {
-            VERIFY(b.blocker_type() == Thread::Blocker::Type::File);
-            auto& blocker = static_cast<Thread::FileBlocker&>(b);
-            return blocker.unblock_if_conditions_are_met(false, data);
-        });
+        {
+            SpinlockLocker lock(m_lock);
+            BlockerSet::unblock_all_blockers_whose_conditions_are_met_locked([&](auto& b, void* data, bool&) {
+                VERIFY(b.blocker_type() == Thread::Blocker::Type::File);
+                auto& blocker = static_cast<Thread::FileBlocker&>(b);
+                return blocker.unblock_if_conditions_are_met(false, data);
+            });
+        }
+
+        SpinlockLocker lock(m_readiness_observers_lock);
+        for (auto& observer : m_readiness_observers)
+            observer.file_readiness_may_have_changed();
+    }
+
+    void add_readiness_observer(FileReadinessObserver& observer)
+    {
+        SpinlockLocker lock(m_readiness_observers_lock);
+        m_readiness_observers.append(observer);
     }
+
+    void remove_readiness_observer(FileReadinessObserver& observer)
+    {
+        SpinlockLocker lock(m_readiness_observers_lock);
+        m_readiness_observers.remove(observer);
+    }
+
+private:
+    Spinlock<LockRank::None> m_readiness_observers_lock {};
+    IntrusiveList<&FileReadinessObserver::m_file_blocker_set_list_node> m_readiness_observers;
 };
 
 // File is the base class for anything that can be referenced by a OpenFileDescription.
@@ -114,6 +151,8 @@ public:
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
     virtual bool is_inode_watcher() const { return false; }
+    virtual bool is_io_ring() const { return false; }
+    virtual bool is_epoll() const { return false; }
 
     virtual bool is_regular_file() const { return false; }
 
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <Kernel/FileSystem/IORing.h>
+#include <Kernel/Memory/MemoryManager.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+ErrorOr<NonnullLockRefPtr<IORing>> IORing::try_create(u32 entries)
+{
+    if (entries == 0 || entries > IO_RING_MAX_ENTRIES || !is_power_of_two(entries))
+        return EINVAL;
+
+    auto layout = io_ring_layout(entries);
+    auto vmobject = TRY(Memory::AnonymousVMObject::try_create_with_size(layout.mapping_size, AllocationStrategy::AllocateNow));
+    auto region = TRY(MM.allocate_kernel_region_with_vmobject(*vmobject, layout.mapping_size, "IORing"sv, Memory::Region::Access::ReadWrite));
+    return adopt_nonnull_lock_ref_or_enomem(new (nothrow) IORing(layout, move(vmobject), move(region)));
+}
+
+IORing::IORing(IORingLayout const& layout, NonnullLockRefPtr<Memory::AnonymousVMObject> vmobject, NonnullOwnPtr<Memory::Region> region)
+    : m_layout(layout)
+    , m_vmobject(move(vmobject))
+    , m_region(move(region))
+{
+    auto& header = this->header();
+    header.submission_entries = m_layout.submission_entries;
+    header.completion_entries = m_layout.completion_entries;
+    header.submissions_offset = m_layout.submissions_offset;
+    header.completions_offset = m_layout.completions_offset;
+}
+
+IORing::~IORing() = default;
+
+ErrorOr<NonnullLockRefPtr<Memory::VMObject>> IORing::vmobject_for_mmap(Process&, Memory::VirtualRange const& range, u64& offset, bool shared)
+{
+    if (!shared || offset != 0 || range.size() > m_layout.mapping_size)
+        return EINVAL;
+    return m_vmobject;
+}
+
+ErrorOr<NonnullOwnPtr<KString>> IORing::pseudo_path(OpenFileDescription const&) const
+{
+    return KString::try_create(":io-ring:"sv);
+}
+
+Optional<IORingSubmission> IORing::peek_submission() const
+{
+    VERIFY(m_submission_lock.is_exclusively_locked_by_current_thread());
+    auto tail = AK::atomic_load(&header().submission_tail, AK::MemoryOrder::memory_order_acquire);
+    if (m_submission_head == tail)
+        return {};
+
+    auto index = m_submission_head & (m_layout.submission_entries - 1);
+    auto const* submissions = reinterpret_cast<IORingSubmission const*>(m_region->vaddr().offset(m_layout.submissions_offset).as_ptr());
+    IORingSubmission submission;
+    memcpy(&submission, &submissions[index], sizeof(submission));
+    return submission;
+}
+
+void IORing::consume_submission()
+{
+    VERIFY(m_submission_lock.is_exclusively_locked_by_current_thread());
+    ++m_submission_head;
+    AK::atomic_store(&header().submission_head, m_submission_head, AK::MemoryOrder::memory_order_release);
+}
+
+bool IORing::has_completion_space() const
+{
+    VERIFY(m_submission_lock.is_exclusively_locked_by_current_thread());
+    auto head = AK::atomic_load(&header().completion_head, AK::MemoryOrder::memory_order_acquire);
+    // NOTE: If userspace has corrupted the head, this makes the queue look full rather than letting us overwrite unconsumed completions.
+    return m_completion_tail - head < m_layout.completion_entries;
+}
+
+void IORing::post_completion(u64 user_data, i64 result)
+{
+    VERIFY(has_completion_space());
+    auto index = m_completion_tail & (m_layout.completion_entries - 1);
+    auto* completions = reinterpret_cast<IORingCompletion*>(m_region->vaddr().offset(m_layout.completions_offset).as_ptr());
+    completions[index].user_data = user_data;
+    completions[index].result = result;
+    ++m_completion_tail;
+    AK::atomic_store(&header().completion_tail, m_completion_tail, AK::MemoryOrder::memory_order_release);
+}
+
+}
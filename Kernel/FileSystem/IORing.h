@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <Kernel/API/IORing.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Locking/Mutex.h>
+#include <Kernel/Memory/AnonymousVMObject.h>
+
+namespace Kernel {
+
+// A submission and completion queue shared with userspace, see Kernel/API/IORing.h for the layout.
+class IORing final : public File {
+public:
+    static ErrorOr<NonnullLockRefPtr<IORing>> try_create(u32 entries);
+
+    virtual ~IORing() override;
+
+    virtual ErrorOr<NonnullLockRefPtr<Memory::VMObject>> vmobject_for_mmap(Process&, Memory::VirtualRange const&, u64& offset, bool shared) override;
+
+    Mutex& submission_lock() { return m_submission_lock; }
+
+    // NOTE: The submission is copied out of the shared memory, so userspace can't change it while we're looking at it.
+    Optional<IORingSubmission> peek_submission() const;
+    void consume_submission();
+
+    bool has_completion_space() const;
+    void post_completion(u64 user_data, i64 result);
+
+private:
+    IORing(IORingLayout const&, NonnullLockRefPtr<Memory::AnonymousVMObject>, NonnullOwnPtr<Memory::Region>);
+
+    virtual StringView class_name() const override { return "IORing"sv; }
+    virtual bool is_io_ring() const override { return true; }
+    virtual ErrorOr<NonnullOwnPtr<KString>> pseudo_path(OpenFileDescription const&) const override;
+    virtual bool can_read(OpenFileDescription const&, u64) const override { return false; }
+    virtual bool can_write(OpenFileDescription const&, u64) const override { return false; }
+    virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override { return ENOTSUP; }
+    virtual ErrorOr<size_t> write(OpenFileDescription&, u64, UserOrKernelBuffer const&, size_t) override { return ENOTSUP; }
+
+    IORingHeader& header() const { return *reinterpret_cast<IORingHeader*>(m_region->vaddr().as_ptr()); }
+
+    IORingLayout const m_layout;
+    NonnullLockRefPtr<Memory::AnonymousVMObject> m_vmobject;
+    NonnullOwnPtr<Memory::Region> m_region;
+
+    // The kernel's own copies of the indices it owns, userspace can't be trusted to leave them alone.
+    u32 m_submission_head { 0 };
+    u32 m_completion_tail { 0 };
+
+    Mutex m_submission_lock { "IORing"sv };
+};
+
+}
@@ -10,6 +10,7 @@
 #include <AK/StringView.h>
 #include <Kernel/API/InodeWatcherEvent.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/DirectoryEntryCache.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/InodeWatcher.h>
 #include <Kernel/FileSystem/OpenFileDescription.h>
@@ -31,6 +32,20 @@ SpinlockProtected<Inode::AllInstancesList, LockRank::None>& Inode::all_instances
 
 void Inode::sync_all()
 {
+    NonnullLockRefPtrVector<Memory::SharedInodeVMObject, 32> vmobjects_with_dirty_pages;
+    Inode::all_instances().with([&](auto& all_inodes) {
+        for (auto& inode : all_inodes) {
+            // NOTE: We can't take the inode lock here, but grabbing a strong reference is safe without it.
+            auto vmobject = inode.m_shared_vmobject.strong_ref();
+            if (vmobject && vmobject->amount_dirty() != 0)
+                vmobjects_with_dirty_pages.append(vmobject.release_nonnull());
+        }
+    });
+
+    // Write back pages dirtied through shared mappings first, as that may dirty inode metadata.
+    for (auto& vmobject : vmobjects_with_dirty_pages)
+        (void)vmobject.sync();
+
     NonnullLockRefPtrVector<Inode, 32> inodes;
     Inode::all_instances().with([&](auto& all_inodes) {
         for (auto& inode : all_inodes) {
@@ -110,15 +125,106 @@ ErrorOr<size_t> Inode::write_bytes(off_t offset, size_t length, UserOrKernelBuff
 {
     MutexLocker locker(m_inode_lock);
     TRY(prepare_to_write_data());
-    return write_bytes_locked(offset, length, target_buffer, open_description);
+    auto nwritten = TRY(write_bytes_locked(offset, length, target_buffer, open_description));
+    if (auto vmobject = m_shared_vmobject.strong_ref())
+        TRY(update_page_cache_after_write(*vmobject, offset, nwritten, target_buffer));
+    return nwritten;
+}
+
+ErrorOr<size_t> Inode::write_bytes_from_page_cache(Badge<Memory::SharedInodeVMObject>, off_t offset, size_t length, UserOrKernelBuffer const& data)
+{
+    // NOTE: This is the writeback path for dirty pages, so the page cache already has this data.
+    MutexLocker locker(m_inode_lock);
+    TRY(prepare_to_write_data());
+    return write_bytes_locked(offset, length, data, nullptr);
 }
 
 ErrorOr<size_t> Inode::read_bytes(off_t offset, size_t length, UserOrKernelBuffer& buffer, OpenFileDescription* open_description) const
 {
     MutexLocker locker(m_inode_lock, Mutex::Mode::Shared);
+    if (auto vmobject = m_shared_vmobject.strong_ref())
+        return read_bytes_through_page_cache(*vmobject, offset, length, buffer, open_description);
     return read_bytes_locked(offset, length, buffer, open_description);
 }
 
+ErrorOr<size_t> Inode::read_bytes_through_page_cache(Memory::SharedInodeVMObject& vmobject, off_t offset, size_t length, UserOrKernelBuffer& buffer, OpenFileDescription* open_description) const
+{
+    VERIFY(m_inode_lock.is_locked());
+
+    auto metadata = this->metadata();
+    if (!metadata.is_regular_file() || offset < 0)
+        return read_bytes_locked(offset, length, buffer, open_description);
+
+    u64 file_size = metadata.size;
+    if (static_cast<u64>(offset) >= file_size)
+        return 0;
+    length = min<u64>(length, file_size - offset);
+
+    size_t nread = 0;
+    while (nread < length) {
+        u64 position = offset + nread;
+        size_t page_index = position / PAGE_SIZE;
+        if (page_index >= vmobject.page_count()) {
+            // The file has grown past the end of the VMObject, so the rest can't be cached.
+            auto remaining_buffer = buffer.offset(nread);
+            nread += TRY(read_bytes_locked(position, length - nread, remaining_buffer, open_description));
+            break;
+        }
+
+        size_t offset_in_page = position % PAGE_SIZE;
+        size_t chunk_size = min(PAGE_SIZE - offset_in_page, length - nread);
+
+        u8 page_buffer[PAGE_SIZE];
+        if (!vmobject.read_page_if_resident(page_index, page_buffer)) {
+            u64 page_offset = static_cast<u64>(page_index) * PAGE_SIZE;
+            auto page_buffer_ref = UserOrKernelBuffer::for_kernel_buffer(page_buffer);
+            auto nread_from_inode = TRY(read_bytes_locked(page_offset, PAGE_SIZE, page_buffer_ref, open_description));
+            if (nread_from_inode <= offset_in_page)
+                break;
+            chunk_size = min(chunk_size, nread_from_inode - offset_in_page);
+
+            // Only cache pages we know the full contents of, i.e. full pages or the one holding EOF.
+            if (nread_from_inode == PAGE_SIZE || page_offset + nread_from_inode == file_size) {
+                memset(page_buffer + nread_from_inode, 0, PAGE_SIZE - nread_from_inode);
+                vmobject.cache_page(page_index, page_buffer);
+            }
+        }
+
+        TRY(buffer.write(page_buffer + offset_in_page, nread, chunk_size));
+        nread += chunk_size;
+    }
+    return nread;
+}
+
+ErrorOr<void> Inode::update_page_cache_after_write(Memory::SharedInodeVMObject& vmobject, off_t offset, size_t length, UserOrKernelBuffer const& data)
+{
+    VERIFY(m_inode_lock.is_locked());
+    VERIFY(offset >= 0);
+
+    size_t nupdated = 0;
+    while (nupdated < length) {
+        u64 position = offset + nupdated;
+        size_t page_index = position / PAGE_SIZE;
+        if (page_index >= vmobject.page_count())
+            break;
+
+        size_t offset_in_page = position % PAGE_SIZE;
+        size_t chunk_size = min(PAGE_SIZE - offset_in_page, length - nupdated);
+
+        u8 chunk_buffer[PAGE_SIZE];
+        TRY(data.read(chunk_buffer, nupdated, chunk_size));
+        vmobject.update_resident_page(page_index, offset_in_page, { chunk_buffer, chunk_size });
+        nupdated += chunk_size;
+    }
+    return {};
+}
+
+void Inode::did_truncate_page_cache(u64 new_size)
+{
+    if (auto vmobject = shared_vmobject())
+        vmobject->discard_pages_beyond(new_size);
+}
+
 ErrorOr<void> Inode::update_timestamps([[maybe_unused]] Optional<Time> atime, [[maybe_unused]] Optional<Time> ctime, [[maybe_unused]] Optional<Time> mtime)
 {
     return ENOTIMPL;
@@ -217,6 +323,7 @@ void Inode::set_metadata_dirty(bool metadata_dirty)
 
 void Inode::did_add_child(InodeIdentifier, StringView name)
 {
+    DirectoryEntryCache::the().invalidate(*this, name);
     m_watchers.for_each([&](auto& watcher) {
         watcher->notify_inode_event({}, identifier(), InodeWatcherEvent::Type::ChildCreated, name);
     });
@@ -224,6 +331,8 @@ void Inode::did_add_child(InodeIdentifier, StringView name)
 
 void Inode::did_remove_child(InodeIdentifier, StringView name)
 {
+    DirectoryEntryCache::the().invalidate(*this, name);
+
     if (name == "." || name == "..") {
         // These are just aliases and are not interesting to userspace.
         return;
@@ -248,6 +357,10 @@ void Inode::did_modify_contents()
 
 void Inode::did_delete_self()
 {
+    // Our index may be handed out to a new directory now, which must not find any of our children.
+    if (is_directory())
+        DirectoryEntryCache::the().invalidate_children_of(*this);
+
     m_watchers.for_each([&](auto& watcher) {
         watcher->notify_inode_event({}, identifier(), InodeWatcherEvent::Type::Deleted);
     });
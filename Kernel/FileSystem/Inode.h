@@ -57,6 +57,7 @@ public:
 
     ErrorOr<size_t> write_bytes(off_t, size_t, UserOrKernelBuffer const& data, OpenFileDescription*);
     ErrorOr<size_t> read_bytes(off_t, size_t, UserOrKernelBuffer& buffer, OpenFileDescription*) const;
+    ErrorOr<size_t> write_bytes_from_page_cache(Badge<Memory::SharedInodeVMObject>, off_t, size_t, UserOrKernelBuffer const& data);
 
     virtual ErrorOr<void> attach(OpenFileDescription&) { return {}; }
     virtual void detach(OpenFileDescription&) { }
@@ -93,6 +94,7 @@ public:
 
     ErrorOr<void> set_shared_vmobject(Memory::SharedInodeVMObject&);
     LockRefPtr<Memory::SharedInodeVMObject> shared_vmobject() const;
+    void did_truncate_page_cache(u64 new_size);
 
     static void sync_all();
     void sync();
@@ -126,6 +128,9 @@ protected:
     virtual ErrorOr<size_t> read_bytes_locked(off_t, size_t, UserOrKernelBuffer& buffer, OpenFileDescription*) const = 0;
 
 private:
+    ErrorOr<size_t> read_bytes_through_page_cache(Memory::SharedInodeVMObject&, off_t, size_t, UserOrKernelBuffer& buffer, OpenFileDescription*) const;
+    ErrorOr<void> update_page_cache_after_write(Memory::SharedInodeVMObject&, off_t, size_t, UserOrKernelBuffer const& data);
+
     ErrorOr<bool> try_apply_flock(Process const&, OpenFileDescription const&, flock const&);
 
     FileSystem& m_file_system;
@@ -96,6 +96,7 @@ ErrorOr<NonnullOwnPtr<KString>> InodeFile::pseudo_path(OpenFileDescription const
 ErrorOr<void> InodeFile::truncate(u64 size)
 {
     TRY(m_inode->truncate(size));
+    m_inode->did_truncate_page_cache(size);
     TRY(m_inode->update_timestamps({}, {}, kgettimeofday()));
     return {};
 }
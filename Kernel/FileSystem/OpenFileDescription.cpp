@@ -9,8 +9,10 @@
 #include <Kernel/API/POSIX/errno.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/EPoll.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/InodeFile.h>
+#include <Kernel/FileSystem/IORing.h>
 #include <Kernel/FileSystem/InodeWatcher.h>
 #include <Kernel/FileSystem/OpenFileDescription.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
@@ -210,7 +212,38 @@ ErrorOr<NonnullOwnPtr<KBuffer>> OpenFileDescription::read_entire_file()
     return m_inode->read_entire(this);
 }
 
-ErrorOr<size_t> OpenFileDescription::get_dir_entries(UserOrKernelBuffer& output_buffer, size_t size)
+ErrorOr<Optional<struct stat>> OpenFileDescription::metadata_for_directory_entry(FileSystem::DirectoryEntryView const& entry, StringView directory_path)
+{
+    // Note: Anything that's resolved to a different inode than the one the name refers to in this file system (like
+    //       mount points, or ".." at the root of a mount) is left for userspace to stat() by path.
+    LockRefPtr<Inode> child;
+    if (entry.name == "."sv) {
+        child = m_inode;
+    } else {
+        auto child_or_error = m_inode->lookup(entry.name);
+        if (child_or_error.is_error())
+            return Optional<struct stat> {};
+        child = child_or_error.release_value();
+    }
+    if (child->identifier() != entry.inode)
+        return Optional<struct stat> {};
+
+    if (Process::current().veil_state() != VeilState::None) {
+        // Note: Unveiled paths are always canonical, so "." and ".." are simply left to userspace.
+        if (entry.name == "."sv || entry.name == ".."sv)
+            return Optional<struct stat> {};
+        auto path = TRY(KString::formatted("{}/{}", directory_path == "/"sv ? ""sv : directory_path, entry.name));
+        if (VirtualFileSystem::the().find_matching_unveiled_path(path->view()).permissions() == UnveilAccess::None)
+            return Optional<struct stat> {};
+    }
+
+    auto metadata_or_error = child->metadata().stat();
+    if (metadata_or_error.is_error())
+        return Optional<struct stat> {};
+    return metadata_or_error.release_value();
+}
+
+ErrorOr<size_t> OpenFileDescription::get_dir_entries(UserOrKernelBuffer& output_buffer, size_t size, IncludeMetadata include_metadata)
 {
     if (!is_directory())
         return ENOTDIR;
@@ -244,8 +277,10 @@ ErrorOr<size_t> OpenFileDescription::get_dir_entries(UserOrKernelBuffer& output_
         return true;
     };
 
-    ErrorOr<void> result = VirtualFileSystem::the().traverse_directory_inode(*m_inode, [&flush_stream_to_output_buffer, &error, &stream, this](auto& entry) -> ErrorOr<void> {
+    auto serialize_entry = [&](FileSystem::DirectoryEntryView const& entry, Optional<struct stat> const& entry_metadata) -> ErrorOr<void> {
         size_t serialized_size = sizeof(ino_t) + sizeof(u8) + sizeof(size_t) + sizeof(char) * entry.name.length();
+        if (include_metadata == IncludeMetadata::Yes)
+            serialized_size += sizeof(u8) + sizeof(struct stat);
         if (serialized_size > stream.remaining()) {
             if (!flush_stream_to_output_buffer())
                 return error;
@@ -254,8 +289,64 @@ ErrorOr<size_t> OpenFileDescription::get_dir_entries(UserOrKernelBuffer& output_
         stream << m_inode->fs().internal_file_type_to_directory_entry_type(entry);
         stream << (u32)entry.name.length();
         stream << entry.name.bytes();
+        if (include_metadata == IncludeMetadata::Yes) {
+            struct stat buffer = entry_metadata.value_or({});
+            stream << (u8)entry_metadata.has_value();
+            stream << ReadonlyBytes { &buffer, sizeof(buffer) };
+        }
         return {};
-    });
+    };
+
+    ErrorOr<void> result;
+    if (include_metadata == IncludeMetadata::No) {
+        result = VirtualFileSystem::the().traverse_directory_inode(*m_inode, [&](auto& entry) -> ErrorOr<void> {
+            return serialize_entry(entry, {});
+        });
+    } else {
+        // Note: The inodes are looked up once the traversal is done, as file systems may hold locks of the directory
+        //       while traversing it.
+        struct CollectedEntry {
+            NonnullOwnPtr<KString> name;
+            InodeIdentifier inode;
+            u8 file_type;
+        };
+        Vector<CollectedEntry> entries;
+        result = VirtualFileSystem::the().traverse_directory_inode(*m_inode, [&](auto& entry) -> ErrorOr<void> {
+            TRY(entries.try_append({ TRY(KString::try_create(entry.name)), entry.inode, entry.file_type }));
+            return {};
+        });
+
+        // Looking at entries needs the same permissions as stat()'ing them by path would: being able to search the
+        // directory, and having pledged rpath. Without them, userspace is left to stat() them (and fail) on its own.
+        auto& process = Process::current();
+        bool may_look_at_entries = metadata.may_execute(*process.credentials())
+            && (!process.has_promises() || process.has_promised(Pledge::rpath));
+        OwnPtr<KString> directory_path;
+        if (may_look_at_entries && process.veil_state() != VeilState::None) {
+            auto custody = this->custody();
+            auto path_or_error = custody ? custody->try_serialize_absolute_path() : ENOENT;
+            if (path_or_error.is_error())
+                may_look_at_entries = false;
+            else
+                directory_path = path_or_error.release_value();
+        }
+
+        for (auto const& collected_entry : entries) {
+            if (result.is_error())
+                break;
+            FileSystem::DirectoryEntryView entry { collected_entry.name->view(), collected_entry.inode, collected_entry.file_type };
+            Optional<struct stat> entry_metadata;
+            if (may_look_at_entries) {
+                auto entry_metadata_or_error = metadata_for_directory_entry(entry, directory_path ? directory_path->view() : ""sv);
+                if (entry_metadata_or_error.is_error()) {
+                    result = entry_metadata_or_error.release_error();
+                    break;
+                }
+                entry_metadata = entry_metadata_or_error.release_value();
+            }
+            result = serialize_entry(entry, entry_metadata);
+        }
+    }
     flush_stream_to_output_buffer();
 
     if (result.is_error()) {
@@ -328,6 +419,30 @@ InodeWatcher* OpenFileDescription::inode_watcher()
     return static_cast<InodeWatcher*>(m_file.ptr());
 }
 
+bool OpenFileDescription::is_io_ring() const
+{
+    return m_file->is_io_ring();
+}
+
+IORing* OpenFileDescription::io_ring()
+{
+    if (!is_io_ring())
+        return nullptr;
+    return static_cast<IORing*>(m_file.ptr());
+}
+
+bool OpenFileDescription::is_epoll() const
+{
+    return m_file->is_epoll();
+}
+
+EPoll* OpenFileDescription::epoll()
+{
+    if (!is_epoll())
+        return nullptr;
+    return static_cast<EPoll*>(m_file.ptr());
+}
+
 bool OpenFileDescription::is_master_pty() const
 {
     return m_file->is_master_pty();
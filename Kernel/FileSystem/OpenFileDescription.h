@@ -15,6 +15,7 @@
 #include <Kernel/FileSystem/InodeMetadata.h>
 #include <Kernel/Forward.h>
 #include <Kernel/KBuffer.h>
+#include <Kernel/Library/LockWeakable.h>
 #include <Kernel/VirtualAddress.h>
 
 namespace Kernel {
@@ -24,7 +25,9 @@ public:
     virtual ~OpenFileDescriptionData() = default;
 };
 
-class OpenFileDescription final : public AtomicRefCounted<OpenFileDescription> {
+class OpenFileDescription final
+    : public AtomicRefCounted<OpenFileDescription>
+    , public LockWeakable<OpenFileDescription> {
 public:
     static ErrorOr<NonnullLockRefPtr<OpenFileDescription>> try_create(Custody&);
     static ErrorOr<NonnullLockRefPtr<OpenFileDescription>> try_create(File&);
@@ -56,7 +59,12 @@ public:
     bool can_read() const;
     bool can_write() const;
 
-    ErrorOr<size_t> get_dir_entries(UserOrKernelBuffer& buffer, size_t);
+    enum class IncludeMetadata {
+        No,
+        Yes,
+    };
+    // With metadata, every entry is followed by whether there is a struct stat for it, and that struct stat.
+    ErrorOr<size_t> get_dir_entries(UserOrKernelBuffer& buffer, size_t, IncludeMetadata = IncludeMetadata::No);
 
     ErrorOr<NonnullOwnPtr<KBuffer>> read_entire_file();
 
@@ -82,6 +90,12 @@ public:
     InodeWatcher const* inode_watcher() const;
     InodeWatcher* inode_watcher();
 
+    bool is_io_ring() const;
+    IORing* io_ring();
+
+    bool is_epoll() const;
+    EPoll* epoll();
+
     bool is_master_pty() const;
     MasterPTY const* master_pty() const;
     MasterPTY* master_pty();
@@ -135,6 +149,8 @@ private:
 
     ErrorOr<void> attach();
 
+    ErrorOr<Optional<struct stat>> metadata_for_directory_entry(FileSystem::DirectoryEntryView const&, StringView directory_path);
+
     void evaluate_block_conditions()
     {
         blocker_set().unblock_all_blockers_whose_conditions_are_met();
@@ -18,10 +18,13 @@
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/LoadBase.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Log.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/MemoryStatus.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/MutexContention.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Network/Directory.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/PowerStateSwitch.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/ProcessStatistics.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Processes.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Profile.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/ProfileSamples.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/SystemMode.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/SystemStatistics.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Uptime.h>
@@ -37,6 +40,7 @@ UNMAP_AFTER_INIT NonnullLockRefPtr<SysFSGlobalKernelStatsDirectory> SysFSGlobalK
         list.append(SysFSMemoryStatus::must_create(*global_kernel_stats_directory));
         list.append(SysFSSystemStatistics::must_create(*global_kernel_stats_directory));
         list.append(SysFSOverallProcesses::must_create(*global_kernel_stats_directory));
+        list.append(SysFSProcessStatistics::must_create(*global_kernel_stats_directory));
         list.append(SysFSCPUInformation::must_create(*global_kernel_stats_directory));
         list.append(SysFSKernelLog::must_create(*global_kernel_stats_directory));
         list.append(SysFSInterrupts::must_create(*global_kernel_stats_directory));
@@ -45,9 +49,11 @@ UNMAP_AFTER_INIT NonnullLockRefPtr<SysFSGlobalKernelStatsDirectory> SysFSGlobalK
         list.append(SysFSCommandLine::must_create(*global_kernel_stats_directory));
         list.append(SysFSSystemMode::must_create(*global_kernel_stats_directory));
         list.append(SysFSProfile::must_create(*global_kernel_stats_directory));
+        list.append(SysFSProfileSamples::must_create(*global_kernel_stats_directory));
         list.append(SysFSKernelLoadBase::must_create(*global_kernel_stats_directory));
         list.append(SysFSPowerStateSwitchNode::must_create(*global_kernel_stats_directory));
         list.append(SysFSJails::must_create(*global_kernel_stats_directory));
+        list.append(SysFSMutexContention::must_create(*global_kernel_stats_directory));
 
         list.append(SysFSGlobalNetworkStatsDirectory::must_create(*global_kernel_stats_directory));
         list.append(SysFSGlobalKernelVariablesDirectory::must_create(*global_kernel_stats_directory));
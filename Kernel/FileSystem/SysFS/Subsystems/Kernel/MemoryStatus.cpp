@@ -8,6 +8,7 @@
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/MemoryStatus.h>
 #include <Kernel/Memory/MemoryManager.h>
 #include <Kernel/Sections.h>
+#include <Kernel/Tasks/ReclaimTask.h>
 
 namespace Kernel {
 
@@ -35,8 +36,20 @@ ErrorOr<void> SysFSMemoryStatus::try_generate(KBufferBuilder& builder)
     TRY(json.add("physical_available"sv, system_memory.physical_pages - system_memory.physical_pages_used));
     TRY(json.add("physical_committed"sv, system_memory.physical_pages_committed));
     TRY(json.add("physical_uncommitted"sv, system_memory.physical_pages_uncommitted));
+    auto reclaim_statistics = ReclaimTask::statistics();
+    TRY(json.add("reclaim_rounds"sv, reclaim_statistics.reclaim_rounds));
+    TRY(json.add("reclaim_purged_volatile"sv, reclaim_statistics.purged_volatile_pages));
+    TRY(json.add("reclaim_released_clean_inode"sv, reclaim_statistics.released_clean_inode_pages));
     TRY(json.add("kmalloc_call_count"sv, stats.kmalloc_call_count));
     TRY(json.add("kfree_call_count"sv, stats.kfree_call_count));
+    auto per_cpu_cache_hits = TRY(json.add_array("kmalloc_per_cpu_cache_hits"sv));
+    for (size_t i = 0; i < stats.processor_cache_count; ++i)
+        TRY(per_cpu_cache_hits.add(stats.processor_caches[i].hit_count));
+    TRY(per_cpu_cache_hits.finish());
+    auto per_cpu_cache_misses = TRY(json.add_array("kmalloc_per_cpu_cache_misses"sv));
+    for (size_t i = 0; i < stats.processor_cache_count; ++i)
+        TRY(per_cpu_cache_misses.add(stats.processor_caches[i].miss_count));
+    TRY(per_cpu_cache_misses.finish());
     TRY(json.finish());
     return {};
 }
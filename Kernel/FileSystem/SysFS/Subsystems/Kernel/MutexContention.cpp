@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonObjectSerializer.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/MutexContention.h>
+#include <Kernel/Locking/MutexContention.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT SysFSMutexContention::SysFSMutexContention(SysFSDirectory const& parent_directory)
+    : SysFSGlobalInformation(parent_directory)
+{
+}
+
+UNMAP_AFTER_INIT NonnullLockRefPtr<SysFSMutexContention> SysFSMutexContention::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_lock_ref_if_nonnull(new (nothrow) SysFSMutexContention(parent_directory)).release_nonnull();
+}
+
+ErrorOr<void> SysFSMutexContention::try_generate(KBufferBuilder& builder)
+{
+    auto json = TRY(JsonObjectSerializer<>::try_create(builder));
+    TRY(json.add("untracked"sv, MutexContention::untracked_count()));
+    auto array = TRY(json.add_array("mutexes"sv));
+    ErrorOr<void> result; // FIXME: Make this nicer
+    MutexContention::for_each([&array, &result](auto& statistics) {
+        if (result.is_error())
+            return;
+        result = ([&]() -> ErrorOr<void> {
+            auto obj = TRY(array.add_object());
+            TRY(obj.add("name"sv, statistics.name));
+            TRY(obj.add("spins"sv, statistics.spins));
+            TRY(obj.add("acquired_by_spinning"sv, statistics.acquired_by_spinning));
+            TRY(obj.add("blocks"sv, statistics.blocks));
+            TRY(obj.add("blocked_time_us"sv, statistics.blocked_time_us));
+            TRY(obj.finish());
+            return {};
+        })();
+    });
+    TRY(result);
+    TRY(array.finish());
+    TRY(json.finish());
+    return {};
+}
+
+}
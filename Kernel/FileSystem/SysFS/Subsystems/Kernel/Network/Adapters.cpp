@@ -44,6 +44,14 @@ ErrorOr<void> SysFSNetworkAdaptersStats::try_generate(KBufferBuilder& builder)
         TRY(obj.add("link_speed"sv, adapter.link_speed()));
         TRY(obj.add("link_full_duplex"sv, adapter.link_full_duplex()));
         TRY(obj.add("mtu"sv, adapter.mtu()));
+        auto packet_buffer_statistics = adapter.packet_buffer_statistics();
+        auto packet_buffers = TRY(obj.add_object("packet_buffers"sv));
+        TRY(packet_buffers.add("cpu_cache_hits"sv, packet_buffer_statistics.cpu_cache_hits));
+        TRY(packet_buffers.add("shared_list_hits"sv, packet_buffer_statistics.shared_list_hits));
+        TRY(packet_buffers.add("allocations"sv, packet_buffer_statistics.allocations));
+        TRY(packet_buffers.add("allocation_failures"sv, packet_buffer_statistics.allocation_failures));
+        TRY(packet_buffers.add("frees"sv, packet_buffer_statistics.frees));
+        TRY(packet_buffers.finish());
         TRY(obj.finish());
         return {};
     }));
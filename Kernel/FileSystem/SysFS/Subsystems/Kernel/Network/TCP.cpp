@@ -41,6 +41,20 @@ ErrorOr<void> SysFSNetworkTCPStats::try_generate(KBufferBuilder& builder)
         TRY(obj.add("bytes_in"sv, socket.bytes_in()));
         TRY(obj.add("packets_out"sv, socket.packets_out()));
         TRY(obj.add("bytes_out"sv, socket.bytes_out()));
+        TRY(obj.add("congestion_control"sv, TCPCongestionControl::to_string(socket.congestion_control().algorithm())));
+        TRY(obj.add("congestion_window"sv, socket.congestion_control().congestion_window()));
+        TRY(obj.add("slow_start_threshold"sv, socket.congestion_control().slow_start_threshold()));
+        TRY(obj.add("peer_window_size"sv, socket.peer_window_size()));
+        TRY(obj.add("peer_maximum_segment_size"sv, socket.peer_maximum_segment_size()));
+        TRY(obj.add("send_window_scale"sv, socket.send_window_scale()));
+        TRY(obj.add("receive_window_scale"sv, socket.receive_window_scale()));
+        TRY(obj.add("sack_permitted"sv, socket.is_sack_permitted()));
+        TRY(obj.add("round_trip_time_us"sv, socket.smoothed_round_trip_time_us()));
+        TRY(obj.add("round_trip_time_variance_us"sv, socket.round_trip_time_variance_us()));
+        TRY(obj.add("retransmission_timeout_ms"sv, socket.retransmit_timeout().to_milliseconds()));
+        TRY(obj.add("retransmitted_packets"sv, socket.retransmitted_packets()));
+        TRY(obj.add("fast_retransmits"sv, socket.fast_retransmits()));
+        TRY(obj.add("retransmit_timeouts"sv, socket.retransmit_timeouts()));
         auto current_process_credentials = Process::current().credentials();
         if (current_process_credentials->is_superuser() || current_process_credentials->uid() == socket.origin_uid()) {
             TRY(obj.add("origin_pid"sv, socket.origin_pid().value()));
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/AnyOf.h>
+#include <AK/Array.h>
+#include <AK/NumericLimits.h>
+#include <AK/Try.h>
+#include <Kernel/API/ProcessStatistics.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/ProcessStatistics.h>
+#include <Kernel/Process.h>
+#include <Kernel/Scheduler.h>
+#include <Kernel/Sections.h>
+#include <Kernel/TTY/TTY.h>
+
+namespace Kernel {
+
+struct ProcessStatisticsInodeData final : public SysFSInodeData {
+    // The generation of the snapshot in the buffer.
+    u64 generation { 0 };
+    // The generation of the last snapshot that was read, which the next one is relative to.
+    u64 read_generation { 0 };
+};
+
+UNMAP_AFTER_INIT SysFSProcessStatistics::SysFSProcessStatistics(SysFSDirectory const& parent_directory)
+    : SysFSGlobalInformation(parent_directory)
+{
+}
+
+UNMAP_AFTER_INIT NonnullLockRefPtr<SysFSProcessStatistics> SysFSProcessStatistics::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_lock_ref_if_nonnull(new (nothrow) SysFSProcessStatistics(parent_directory)).release_nonnull();
+}
+
+static StringView truncated(StringView string)
+{
+    return string.substring_view(0, min(string.length(), static_cast<size_t>(NumericLimits<u16>::max())));
+}
+
+// Appends the strings that follow an entry, padded to a multiple of 8 bytes.
+static ErrorOr<void> try_append_strings(KBufferBuilder& builder, Span<StringView const> strings)
+{
+    size_t length = 0;
+    for (auto string : strings) {
+        TRY(builder.append_bytes(string.bytes()));
+        length += string.length();
+    }
+    static constexpr Array<u8, 8> padding {};
+    TRY(builder.append_bytes(padding.span().trim(align_up_to(length, 8) - length)));
+    return {};
+}
+
+static ErrorOr<void> try_generate_thread(KBufferBuilder& builder, Thread& thread, u64 previous_generation)
+{
+    ThreadStatisticsEntry entry {};
+    entry.tid = thread.tid().value();
+    if (thread.statistics_generation() < previous_generation) {
+        entry.flags = ThreadStatisticsEntry::Flags::Unchanged;
+        return builder.append_bytes({ &entry, sizeof(entry) });
+    }
+
+    // Note: The counters are only ever changed by the thread itself, so they are read without taking its lock.
+    entry.time_user = thread.time_in_user();
+    entry.time_kernel = thread.time_in_kernel();
+    entry.times_scheduled = thread.times_scheduled();
+    entry.cpu = thread.cpu();
+    entry.priority = thread.priority();
+    entry.syscall_count = thread.syscall_count();
+    entry.inode_faults = thread.inode_faults();
+    entry.zero_faults = thread.zero_faults();
+    entry.cow_faults = thread.cow_faults();
+    entry.unix_socket_read_bytes = thread.unix_socket_read_bytes();
+    entry.unix_socket_write_bytes = thread.unix_socket_write_bytes();
+    entry.ipv4_socket_read_bytes = thread.ipv4_socket_read_bytes();
+    entry.ipv4_socket_write_bytes = thread.ipv4_socket_write_bytes();
+    entry.file_read_bytes = thread.file_read_bytes();
+    entry.file_write_bytes = thread.file_write_bytes();
+
+    auto name = TRY(thread.name().with([](auto& name) { return KString::try_create(name->view()); }));
+    StringView state;
+    {
+        SpinlockLocker locker(thread.get_lock());
+        state = thread.state_string();
+    }
+
+    Array<StringView, 2> strings { truncated(name->view()), truncated(state) };
+    entry.name_length = strings[0].length();
+    entry.state_length = strings[1].length();
+    TRY(builder.append_bytes({ &entry, sizeof(entry) }));
+    return try_append_strings(builder, strings.span());
+}
+
+static ErrorOr<void> try_generate_process(KBufferBuilder& builder, Process& process, u64 previous_generation)
+{
+    Vector<NonnullLockRefPtr<Thread>> threads;
+    ErrorOr<void> result;
+    process.for_each_thread([&](Thread& thread) {
+        if (auto append_result = threads.try_append(thread); append_result.is_error()) {
+            result = append_result.release_error();
+            return IterationDecision::Break;
+        }
+        return IterationDecision::Continue;
+    });
+    TRY(result);
+
+    // A process can only change when one of its threads runs, so nothing about it is looked at unless one did.
+    bool has_changed = any_of(threads, [&](auto& thread) { return thread->statistics_generation() >= previous_generation; });
+
+    ProcessStatisticsEntry entry {};
+    entry.pid = process.pid().value();
+    entry.thread_count = threads.size();
+    if (!has_changed) {
+        entry.flags = ProcessStatisticsEntry::Flags::Unchanged;
+        TRY(builder.append_bytes({ &entry, sizeof(entry) }));
+        // Note: The threads are still listed, as some of them may have gone away.
+        for (auto& thread : threads)
+            TRY(try_generate_thread(builder, *thread, previous_generation));
+        return {};
+    }
+
+    StringBuilder pledge_builder;
+    if (process.is_user_process()) {
+#define __ENUMERATE_PLEDGE_PROMISE(promise)    \
+    if (process.has_promised(Pledge::promise)) \
+        TRY(pledge_builder.try_append(#promise " "sv));
+        ENUMERATE_PLEDGE_PROMISES
+#undef __ENUMERATE_PLEDGE_PROMISE
+
+        switch (process.veil_state()) {
+        case VeilState::None:
+            entry.veil = ProcessStatisticsEntry::Veil::None;
+            break;
+        case VeilState::Dropped:
+            entry.veil = ProcessStatisticsEntry::Veil::Dropped;
+            break;
+        case VeilState::Locked:
+        case VeilState::LockedInherited:
+            // Note: We don't reveal if the locked state is either by our choice
+            // or someone else applied it.
+            entry.veil = ProcessStatisticsEntry::Veil::Locked;
+            break;
+        }
+    }
+
+    entry.pgid = process.tty() ? process.tty()->pgid().value() : 0;
+    entry.pgp = process.pgid().value();
+    entry.sid = process.sid().value();
+    auto credentials = process.credentials();
+    entry.uid = credentials->uid().value();
+    entry.gid = credentials->gid().value();
+    entry.ppid = process.ppid().value();
+    entry.nfds = process.fds().with_shared([](auto& fds) { return fds.open_count(); });
+    if (process.is_kernel_process())
+        entry.flags |= ProcessStatisticsEntry::Flags::Kernel;
+    if (process.is_dumpable())
+        entry.flags |= ProcessStatisticsEntry::Flags::Dumpable;
+
+    TRY(process.address_space().with([&](auto& space) -> ErrorOr<void> {
+        entry.amount_virtual = space->amount_virtual();
+        entry.amount_resident = space->amount_resident();
+        entry.amount_dirty_private = space->amount_dirty_private();
+        entry.amount_clean_inode = TRY(space->amount_clean_inode());
+        entry.amount_shared = space->amount_shared();
+        entry.amount_purgeable_volatile = space->amount_purgeable_volatile();
+        entry.amount_purgeable_nonvolatile = space->amount_purgeable_nonvolatile();
+        return {};
+    }));
+
+    auto name = TRY(process.name().with([](auto& name) { return KString::try_create(name->view()); }));
+    OwnPtr<KString> executable;
+    if (process.executable())
+        executable = TRY(process.executable()->try_serialize_absolute_path());
+    OwnPtr<KString> tty;
+    if (process.tty())
+        tty = TRY(process.tty()->pseudo_name());
+
+    Array<StringView, 4> strings {
+        truncated(name->view()),
+        executable ? truncated(executable->view()) : ""sv,
+        tty ? truncated(tty->view()) : ""sv,
+        truncated(pledge_builder.string_view()),
+    };
+    entry.name_length = strings[0].length();
+    entry.executable_length = strings[1].length();
+    entry.tty_length = strings[2].length();
+    entry.pledge_length = strings[3].length();
+    TRY(builder.append_bytes({ &entry, sizeof(entry) }));
+    TRY(try_append_strings(builder, strings.span()));
+
+    for (auto& thread : threads)
+        TRY(try_generate_thread(builder, *thread, previous_generation));
+    return {};
+}
+
+ErrorOr<u64> SysFSProcessStatistics::try_generate_snapshot(KBufferBuilder& builder, u64 previous_generation)
+{
+    auto generation = Thread::advance_statistics_generation();
+
+    // Only references to the processes are taken while holding the process list lock, and the rest is looked at after
+    // letting go of it.
+    Vector<NonnullLockRefPtr<Process>> processes;
+    // FIXME: Do we actually want to expose the colonel process in a Jail environment?
+    TRY(processes.try_append(*Scheduler::colonel()));
+    TRY(Process::for_each_in_same_jail([&](Process& process) -> ErrorOr<void> {
+        TRY(processes.try_append(process));
+        return {};
+    }));
+
+    auto total_time_scheduled = Scheduler::get_total_time_scheduled();
+    ProcessStatisticsHeader header {
+        .version = PROCESS_STATISTICS_VERSION,
+        .process_count = static_cast<u32>(processes.size()),
+        .generation = generation,
+        .previous_generation = previous_generation,
+        .total_time_scheduled = total_time_scheduled.total,
+        .total_time_scheduled_kernel = total_time_scheduled.total_kernel,
+    };
+    TRY(builder.append_bytes({ &header, sizeof(header) }));
+
+    for (auto& process : processes)
+        TRY(try_generate_process(builder, *process, previous_generation));
+    return generation;
+}
+
+ErrorOr<void> SysFSProcessStatistics::try_generate(KBufferBuilder& builder)
+{
+    TRY(try_generate_snapshot(builder, 0));
+    return {};
+}
+
+ErrorOr<void> SysFSProcessStatistics::refresh_data(OpenFileDescription& description) const
+{
+    MutexLocker lock(m_refresh_lock);
+    auto& cached_data = description.data();
+    if (!cached_data) {
+        cached_data = adopt_own_if_nonnull(new (nothrow) ProcessStatisticsInodeData);
+        if (!cached_data)
+            return ENOMEM;
+    }
+    auto& data = static_cast<ProcessStatisticsInodeData&>(*cached_data);
+    auto builder = TRY(KBufferBuilder::try_create());
+    auto generation = TRY(const_cast<SysFSProcessStatistics&>(*this).try_generate_snapshot(builder, data.read_generation));
+    data.buffer = builder.build();
+    if (!data.buffer)
+        return ENOMEM;
+    data.generation = generation;
+    return {};
+}
+
+ErrorOr<size_t> SysFSProcessStatistics::read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, OpenFileDescription* description) const
+{
+    auto nread = TRY(SysFSGlobalInformation::read_bytes(offset, count, buffer, description));
+
+    // Note: Snapshots that were never read are skipped over, so that seeking back to the start before reading anything
+    //       doesn't lose what changed.
+    MutexLocker lock(m_refresh_lock);
+    auto& data = static_cast<ProcessStatisticsInodeData&>(*description->data());
+    data.read_generation = data.generation;
+    return nread;
+}
+
+}
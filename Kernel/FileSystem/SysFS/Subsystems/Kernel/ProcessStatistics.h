@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/GlobalInformation.h>
+#include <Kernel/KBufferBuilder.h>
+#include <Kernel/Library/LockRefPtr.h>
+#include <Kernel/UserOrKernelBuffer.h>
+
+namespace Kernel {
+
+// The statistics of /sys/kernel/processes in the binary format of Kernel/API/ProcessStatistics.h. Seeking back to
+// the start of an open file takes a snapshot of only what changed since the last one that was read.
+class SysFSProcessStatistics final : public SysFSGlobalInformation {
+public:
+    virtual StringView name() const override { return "process_statistics"sv; }
+
+    static NonnullLockRefPtr<SysFSProcessStatistics> must_create(SysFSDirectory const& parent_directory);
+
+    virtual ErrorOr<size_t> read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, OpenFileDescription* description) const override;
+
+private:
+    explicit SysFSProcessStatistics(SysFSDirectory const& parent_directory);
+    virtual ErrorOr<void> refresh_data(OpenFileDescription&) const override;
+    virtual ErrorOr<void> try_generate(KBufferBuilder& builder) override;
+
+    ErrorOr<u64> try_generate_snapshot(KBufferBuilder&, u64 previous_generation);
+
+    virtual bool is_readable_by_jailed_processes() const override { return true; }
+};
+
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonArraySerializer.h>
+#include <AK/JsonObjectSerializer.h>
+#include <Kernel/ContinuousProfiler.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/ProfileSamples.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT SysFSProfileSamples::SysFSProfileSamples(SysFSDirectory const& parent_directory)
+    : SysFSGlobalInformation(parent_directory)
+{
+}
+
+UNMAP_AFTER_INIT NonnullLockRefPtr<SysFSProfileSamples> SysFSProfileSamples::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_lock_ref_if_nonnull(new (nothrow) SysFSProfileSamples(parent_directory)).release_nonnull();
+}
+
+ErrorOr<void> SysFSProfileSamples::try_generate(KBufferBuilder& builder)
+{
+    auto json = TRY(JsonObjectSerializer<>::try_create(builder));
+    TRY(json.add("enabled"sv, ContinuousProfiler::is_enabled()));
+    auto array = TRY(json.add_array("samples"sv));
+    auto statistics = TRY(ContinuousProfiler::drain([&](u32 cpu, ContinuousProfilerSample const& sample) -> ErrorOr<void> {
+        auto sample_object = TRY(array.add_object());
+        TRY(sample_object.add("cpu"sv, cpu));
+        TRY(sample_object.add("pid"sv, sample.pid));
+        TRY(sample_object.add("tid"sv, sample.tid));
+        TRY(sample_object.add("timestamp"sv, sample.timestamp_ns));
+        TRY(sample_object.add("lost_samples"sv, sample.lost_samples));
+        auto stack_array = TRY(sample_object.add_array("stack"sv));
+        for (size_t i = 0; i < sample.stack_size; ++i)
+            TRY(stack_array.add(sample.stack[i]));
+        TRY(stack_array.finish());
+        TRY(sample_object.finish());
+        return {};
+    }));
+    TRY(array.finish());
+    TRY(json.add("overwritten"sv, statistics.overwritten));
+    TRY(json.finish());
+    return {};
+}
+
+mode_t SysFSProfileSamples::permissions() const
+{
+    return S_IRUSR;
+}
+
+}
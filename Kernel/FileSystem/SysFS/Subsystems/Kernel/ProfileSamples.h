@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/GlobalInformation.h>
+#include <Kernel/KBufferBuilder.h>
+#include <Kernel/Library/LockRefPtr.h>
+#include <Kernel/UserOrKernelBuffer.h>
+
+namespace Kernel {
+
+// Every time this is opened, it hands out the continuous profiler samples recorded since it was last opened.
+class SysFSProfileSamples final : public SysFSGlobalInformation {
+public:
+    virtual StringView name() const override { return "profile_samples"sv; }
+
+    static NonnullLockRefPtr<SysFSProfileSamples> must_create(SysFSDirectory const& parent_directory);
+
+private:
+    virtual mode_t permissions() const override;
+
+    explicit SysFSProfileSamples(SysFSDirectory const& parent_directory);
+    virtual ErrorOr<void> try_generate(KBufferBuilder& builder) override;
+};
+
+}
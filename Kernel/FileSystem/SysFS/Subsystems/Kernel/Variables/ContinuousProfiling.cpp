@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/ContinuousProfiler.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Variables/ContinuousProfiling.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT SysFSContinuousProfiling::SysFSContinuousProfiling(SysFSDirectory const& parent_directory)
+    : SysFSSystemBooleanVariable(parent_directory)
+{
+}
+
+UNMAP_AFTER_INIT NonnullLockRefPtr<SysFSContinuousProfiling> SysFSContinuousProfiling::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_lock_ref_if_nonnull(new (nothrow) SysFSContinuousProfiling(parent_directory)).release_nonnull();
+}
+
+bool SysFSContinuousProfiling::value() const
+{
+    return ContinuousProfiler::is_enabled();
+}
+
+void SysFSContinuousProfiling::set_value(bool new_value)
+{
+    if (!new_value) {
+        ContinuousProfiler::disable();
+        return;
+    }
+    if (auto result = ContinuousProfiler::enable(); result.is_error())
+        dmesgln("Failed to enable continuous profiling: {}", result.error());
+}
+
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Variables/TCPCongestionControl.h>
+#include <Kernel/Net/TCPCongestionControl.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT SysFSTCPCongestionControl::SysFSTCPCongestionControl(SysFSDirectory const& parent_directory)
+    : SysFSSystemStringVariable(parent_directory)
+{
+}
+
+UNMAP_AFTER_INIT NonnullLockRefPtr<SysFSTCPCongestionControl> SysFSTCPCongestionControl::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_lock_ref_if_nonnull(new (nothrow) SysFSTCPCongestionControl(parent_directory)).release_nonnull();
+}
+
+ErrorOr<NonnullOwnPtr<KString>> SysFSTCPCongestionControl::value() const
+{
+    return KString::try_create(TCPCongestionControl::to_string(TCPCongestionControl::default_algorithm()));
+}
+
+ErrorOr<void> SysFSTCPCongestionControl::set_value(NonnullOwnPtr<KString> new_value)
+{
+    auto algorithm = TCPCongestionControl::algorithm_from_string(new_value->view());
+    if (!algorithm.has_value())
+        return EINVAL;
+    // NOTE: Existing connections keep using the algorithm they were created with.
+    TCPCongestionControl::set_default_algorithm(algorithm.value());
+    return {};
+}
+
+mode_t SysFSTCPCongestionControl::permissions() const
+{
+    // NOTE: This affects every new connection on the system, so only the root user may change it.
+    return S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+}
+
+}
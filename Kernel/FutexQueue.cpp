@@ -11,7 +11,12 @@
 namespace Kernel {
 
 FutexQueue::FutexQueue() = default;
-FutexQueue::~FutexQueue() = default;
+FutexQueue::~FutexQueue()
+{
+    // NOTE: All the waiters went away (e.g. by timing out) before the owner unlocked.
+    if (m_priority_inheriting_owner)
+        m_priority_inheriting_owner->set_priority(m_owner_original_priority);
+}
 
 bool FutexQueue::should_add_blocker(Thread::Blocker& b, void*)
 {
@@ -146,6 +151,34 @@ bool FutexQueue::queue_imminent_wait()
     return true;
 }
 
+void FutexQueue::inherit_priority(Thread& owner, u32 priority)
+{
+    SpinlockLocker lock(m_lock);
+    if (m_priority_inheriting_owner && m_priority_inheriting_owner != &owner) {
+        // The futex changed hands without the previous owner unlocking it through us.
+        m_priority_inheriting_owner->set_priority(m_owner_original_priority);
+        m_priority_inheriting_owner = nullptr;
+    }
+    if (owner.priority() >= priority)
+        return;
+    dbgln_if(FUTEXQUEUE_DEBUG, "FutexQueue @ {}: boosting owner {} from priority {} to {}", this, owner, owner.priority(), priority);
+    if (!m_priority_inheriting_owner) {
+        m_priority_inheriting_owner = owner;
+        m_owner_original_priority = owner.priority();
+    }
+    owner.set_priority(priority);
+}
+
+void FutexQueue::restore_inherited_priority(Thread& owner)
+{
+    SpinlockLocker lock(m_lock);
+    if (m_priority_inheriting_owner != &owner)
+        return;
+    dbgln_if(FUTEXQUEUE_DEBUG, "FutexQueue @ {}: restoring owner {} to priority {}", this, owner, m_owner_original_priority);
+    owner.set_priority(m_owner_original_priority);
+    m_priority_inheriting_owner = nullptr;
+}
+
 bool FutexQueue::try_remove()
 {
     SpinlockLocker lock(m_lock);
@@ -32,6 +32,11 @@ public:
     bool queue_imminent_wait();
     bool try_remove();
 
+    // Priority inheritance: the owner of a priority-inheriting futex runs with the priority of its most important waiter until it unlocks.
+    // FIXME: This only remembers a single owner per futex, and may restore the wrong priority if a thread holds multiple boosted futexes.
+    void inherit_priority(Thread& owner, u32 priority);
+    void restore_inherited_priority(Thread& owner);
+
     bool is_empty_and_no_imminent_waits()
     {
         SpinlockLocker lock(m_lock);
@@ -45,6 +50,9 @@ protected:
 private:
     size_t m_imminent_waits { 1 }; // We only create this object if we're going to be waiting, so start out with 1
     bool m_was_removed { false };
+
+    LockRefPtr<Thread> m_priority_inheriting_owner;
+    u32 m_owner_original_priority { 0 };
 };
 
 }
@@ -10,6 +10,7 @@
 #include <Kernel/Debug.h>
 #include <Kernel/Heap/Heap.h>
 #include <Kernel/Heap/kmalloc.h>
+#include <Kernel/InterruptDisabler.h>
 #include <Kernel/KSyms.h>
 #include <Kernel/Locking/Spinlock.h>
 #include <Kernel/Memory/MemoryManager.h>
@@ -394,7 +395,8 @@ struct KmallocGlobalData {
 
     KmallocSubheap::List subheaps;
 
-    KmallocSlabheap slabheaps[6] = { 16, 32, 64, 128, 256, 512 };
+    static constexpr size_t slabheap_count = 6;
+    KmallocSlabheap slabheaps[slabheap_count] = { 16, 32, 64, 128, 256, 512 };
 
     bool expansion_in_progress { false };
 };
@@ -407,6 +409,105 @@ static size_t g_kfree_call_count;
 static size_t g_nested_kfree_calls;
 bool g_dump_kmalloc_stacks;
 
+// A magazine is a small per-processor stack of free slabs of a single size class.
+// Allocations and frees of slab-sized objects are served from the local magazine
+// with interrupts disabled, and only touch the global heap (and s_lock) when the
+// magazine runs empty or overflows, and then in batches of `batch_size` slabs.
+struct KmallocMagazine {
+    static constexpr size_t capacity = 32;
+    static constexpr size_t batch_size = capacity / 2;
+
+    bool is_empty() const { return count == 0; }
+    bool is_full() const { return count == capacity; }
+
+    size_t count { 0 };
+    void* slabs[capacity];
+};
+
+struct KmallocProcessorCache {
+    KmallocMagazine magazines[KmallocGlobalData::slabheap_count];
+    size_t kmalloc_call_count { 0 };
+    size_t kfree_call_count { 0 };
+    size_t hit_count { 0 };
+    size_t miss_count { 0 };
+    size_t nested_kfree_calls { 0 };
+};
+
+static_assert(MAX_CPU_COUNT <= KMALLOC_MAX_PROCESSOR_CACHE_COUNT);
+static KmallocProcessorCache s_processor_caches[MAX_CPU_COUNT];
+
+static Optional<size_t> slabheap_index_for(size_t size, size_t alignment)
+{
+    // NOTE: There's no need to take the kmalloc lock, as the kmalloc slab-heaps (and their sizes) are constant
+    for (size_t i = 0; i < KmallocGlobalData::slabheap_count; ++i) {
+        auto slab_size = g_kmalloc_global->slabheaps[i].slab_size();
+        if (size <= slab_size && alignment <= slab_size)
+            return i;
+    }
+    return {};
+}
+
+static KmallocProcessorCache* current_processor_cache()
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    // Allocations made before the Processor structure is set up go straight to the global heap.
+    if (!Processor::is_initialized())
+        return nullptr;
+    return &s_processor_caches[Processor::current_id()];
+}
+
+static void* allocate_from_magazine(KmallocProcessorCache& cache, size_t slabheap_index, CallerWillInitializeMemory caller_will_initialize_memory)
+{
+    auto& magazine = cache.magazines[slabheap_index];
+    auto& slabheap = g_kmalloc_global->slabheaps[slabheap_index];
+
+    if (magazine.is_empty()) {
+        ++cache.miss_count;
+        SpinlockLocker lock(s_lock);
+        // Refill half of the magazine so that the next few frees don't immediately overflow it.
+        for (size_t i = 0; i < KmallocMagazine::batch_size; ++i) {
+            auto* slab = slabheap.allocate(CallerWillInitializeMemory::Yes);
+            if (!slab)
+                break;
+            magazine.slabs[magazine.count++] = slab;
+        }
+        if (magazine.is_empty())
+            return g_kmalloc_global->allocate(slabheap.slab_size(), slabheap.slab_size(), caller_will_initialize_memory);
+    } else {
+        ++cache.hit_count;
+    }
+
+    auto* ptr = magazine.slabs[--magazine.count];
+    if (caller_will_initialize_memory == CallerWillInitializeMemory::No)
+        memset(ptr, KMALLOC_SCRUB_BYTE, slabheap.slab_size());
+    return ptr;
+}
+
+static void deallocate_to_magazine(KmallocProcessorCache& cache, size_t slabheap_index, void* ptr)
+{
+    auto& magazine = cache.magazines[slabheap_index];
+    auto& slabheap = g_kmalloc_global->slabheaps[slabheap_index];
+
+    if (magazine.is_full()) {
+        SpinlockLocker lock(s_lock);
+        for (size_t i = 0; i < KmallocMagazine::batch_size; ++i)
+            slabheap.deallocate(magazine.slabs[--magazine.count]);
+    }
+
+    memset(ptr, KFREE_SCRUB_BYTE, slabheap.slab_size());
+    magazine.slabs[magazine.count++] = ptr;
+}
+
+static size_t bytes_cached_in_magazines()
+{
+    size_t total = 0;
+    for (auto const& cache : s_processor_caches) {
+        for (size_t i = 0; i < KmallocGlobalData::slabheap_count; ++i)
+            total += cache.magazines[i].count * g_kmalloc_global->slabheaps[i].slab_size();
+    }
+    return total;
+}
+
 void kmalloc_enable_expand()
 {
     g_kmalloc_global->enable_expansion();
@@ -431,15 +532,34 @@ static void* kmalloc_impl(size_t size, size_t alignment, CallerWillInitializeMem
     // Alignment must be a power of two.
     VERIFY(is_power_of_two(alignment));
 
-    SpinlockLocker lock(s_lock);
-    ++g_kmalloc_call_count;
+    void* ptr = nullptr;
+    {
+        InterruptDisabler disabler;
+        auto* cache = current_processor_cache();
+        auto slabheap_index = slabheap_index_for(size, alignment);
 
-    if (g_dump_kmalloc_stacks && Kernel::g_kernel_symbols_available) {
-        dbgln("kmalloc({})", size);
-        Kernel::dump_backtrace();
-    }
+        if (cache && slabheap_index.has_value()) {
+            ++cache->kmalloc_call_count;
+
+            if (g_dump_kmalloc_stacks && Kernel::g_kernel_symbols_available) {
+                SpinlockLocker lock(s_lock);
+                dbgln("kmalloc({})", size);
+                Kernel::dump_backtrace();
+            }
 
-    void* ptr = g_kmalloc_global->allocate(size, alignment, caller_will_initialize_memory);
+            ptr = allocate_from_magazine(*cache, slabheap_index.value(), caller_will_initialize_memory);
+        } else {
+            SpinlockLocker lock(s_lock);
+            ++g_kmalloc_call_count;
+
+            if (g_dump_kmalloc_stacks && Kernel::g_kernel_symbols_available) {
+                dbgln("kmalloc({})", size);
+                Kernel::dump_backtrace();
+            }
+
+            ptr = g_kmalloc_global->allocate(size, alignment, caller_will_initialize_memory);
+        }
+    }
 
     Thread* current_thread = Thread::current();
     if (!current_thread)
@@ -482,11 +602,7 @@ void kfree_sized(void* ptr, size_t size)
         Processor::verify_no_spinlocks_held();
     }
 
-    SpinlockLocker lock(s_lock);
-    ++g_kfree_call_count;
-    ++g_nested_kfree_calls;
-
-    if (g_nested_kfree_calls == 1) {
+    auto add_kfree_perf_event = [&] {
         Thread* current_thread = Thread::current();
         if (!current_thread)
             current_thread = Processor::idle_thread();
@@ -494,8 +610,30 @@ void kfree_sized(void* ptr, size_t size)
             VERIFY(current_thread->is_allocation_enabled());
             PerformanceManager::add_kfree_perf_event(*current_thread, 0, (FlatPtr)ptr);
         }
+    };
+
+    InterruptDisabler disabler;
+    auto* cache = current_processor_cache();
+    auto slabheap_index = slabheap_index_for(size, 0);
+
+    if (cache && slabheap_index.has_value()) {
+        VERIFY(g_kmalloc_global->is_valid_kmalloc_address(VirtualAddress { ptr }));
+        ++cache->kfree_call_count;
+        ++cache->nested_kfree_calls;
+        if (cache->nested_kfree_calls == 1)
+            add_kfree_perf_event();
+        deallocate_to_magazine(*cache, slabheap_index.value(), ptr);
+        --cache->nested_kfree_calls;
+        return;
     }
 
+    SpinlockLocker lock(s_lock);
+    ++g_kfree_call_count;
+    ++g_nested_kfree_calls;
+
+    if (g_nested_kfree_calls == 1)
+        add_kfree_perf_event();
+
     g_kmalloc_global->deallocate(ptr, size);
     --g_nested_kfree_calls;
 }
@@ -503,11 +641,8 @@ void kfree_sized(void* ptr, size_t size)
 size_t kmalloc_good_size(size_t size)
 {
     VERIFY(size > 0);
-    // NOTE: There's no need to take the kmalloc lock, as the kmalloc slab-heaps (and their sizes) are constant
-    for (auto const& slabheap : g_kmalloc_global->slabheaps) {
-        if (size <= slabheap.slab_size())
-            return slabheap.slab_size();
-    }
+    if (auto slabheap_index = slabheap_index_for(size, 0); slabheap_index.has_value())
+        return g_kmalloc_global->slabheaps[slabheap_index.value()].slab_size();
     return round_up_to_power_of_two(size + Heap<CHUNK_SIZE>::AllocationHeaderSize, CHUNK_SIZE) - Heap<CHUNK_SIZE>::AllocationHeaderSize;
 }
 
@@ -582,8 +717,25 @@ void operator delete[](void* ptr, size_t size) noexcept
 void get_kmalloc_stats(kmalloc_stats& stats)
 {
     SpinlockLocker lock(s_lock);
-    stats.bytes_allocated = g_kmalloc_global->allocated_bytes();
-    stats.bytes_free = g_kmalloc_global->free_bytes();
+    // Slabs sitting in a magazine are allocated as far as the slab heaps are concerned,
+    // but they are really free memory waiting to be handed out again.
+    auto cached_bytes = bytes_cached_in_magazines();
+    stats.bytes_allocated = g_kmalloc_global->allocated_bytes() - cached_bytes;
+    stats.bytes_free = g_kmalloc_global->free_bytes() + cached_bytes;
     stats.kmalloc_call_count = g_kmalloc_call_count;
     stats.kfree_call_count = g_kfree_call_count;
+
+    stats.processor_cache_count = 0;
+    for (size_t i = 0; i < MAX_CPU_COUNT; ++i) {
+        auto const& cache = s_processor_caches[i];
+        stats.kmalloc_call_count += cache.kmalloc_call_count;
+        stats.kfree_call_count += cache.kfree_call_count;
+        // Caches of processors that were never brought up have never seen an allocation.
+        if (cache.kmalloc_call_count != 0 || cache.kfree_call_count != 0)
+            stats.processor_cache_count = i + 1;
+        stats.processor_caches[i] = {
+            .hit_count = cache.hit_count,
+            .miss_count = cache.miss_count,
+        };
+    }
 }
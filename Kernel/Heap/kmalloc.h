@@ -47,11 +47,20 @@ void kmalloc_init();
 
 void kfree_sized(void*, size_t);
 
+#define KMALLOC_MAX_PROCESSOR_CACHE_COUNT 64
+
+struct kmalloc_processor_cache_stats {
+    size_t hit_count;
+    size_t miss_count;
+};
+
 struct kmalloc_stats {
     size_t bytes_allocated;
     size_t bytes_free;
     size_t kmalloc_call_count;
     size_t kfree_call_count;
+    size_t processor_cache_count;
+    kmalloc_processor_cache_stats processor_caches[KMALLOC_MAX_PROCESSOR_CACHE_COUNT];
 };
 void get_kmalloc_stats(kmalloc_stats&);
 
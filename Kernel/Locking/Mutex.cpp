@@ -9,8 +9,10 @@
 #include <Kernel/KSyms.h>
 #include <Kernel/Locking/LockLocation.h>
 #include <Kernel/Locking/Mutex.h>
+#include <Kernel/Locking/MutexContention.h>
 #include <Kernel/Locking/Spinlock.h>
 #include <Kernel/Thread.h>
+#include <Kernel/Time/TimeManagement.h>
 
 extern bool g_in_early_boot;
 
@@ -30,6 +32,9 @@ void Mutex::lock(Mode mode, [[maybe_unused]] LockLocation const& location)
     auto* current_thread = Thread::current();
 
     SpinlockLocker lock(m_lock);
+    if (m_mode == Mode::Exclusive && m_holder != current_thread)
+        spin_while_holder_is_running(*current_thread, lock);
+
     bool did_block = false;
     Mode current_mode = m_mode;
     switch (current_mode) {
@@ -211,6 +216,43 @@ void Mutex::unlock()
     }
 }
 
+void Mutex::spin_while_holder_is_running(Thread& current_thread, SpinlockLocker<Spinlock<LockRank::None>>& lock)
+{
+    VERIFY(m_mode == Mode::Exclusive);
+    VERIFY(m_holder != &current_thread);
+
+    // NOTE: The big lock is held for far too long for spinning to ever pay off.
+    if (m_behavior == MutexBehavior::BigLock || Processor::count() == 1)
+        return;
+
+    // NOTE: An unlock hands the mutex over to a blocked waiter directly, so there's nothing to win if there are any.
+    bool has_blocked_waiters = m_blocked_thread_lists.with([](auto& lists) {
+        return !lists.exclusive.is_empty() || !lists.shared.is_empty();
+    });
+    if (has_blocked_waiters)
+        return;
+
+    {
+        LockRefPtr<Thread> holder = m_holder;
+        // If the holder isn't running, it won't release the mutex any time soon.
+        if (holder->state() != Thread::State::Running)
+            return;
+
+        lock.unlock();
+        for (size_t i = 0; i < maximum_spin_iterations; ++i) {
+            if (AK::atomic_load(&m_mode, AK::memory_order_relaxed) != Mode::Exclusive)
+                break;
+            if (holder->state() != Thread::State::Running)
+                break;
+            Processor::wait_check();
+        }
+    }
+    lock.lock();
+
+    // NOTE: Someone else may have grabbed the mutex before we could, in which case we go on to block.
+    MutexContention::record_spin(m_name, m_mode == Mode::Unlocked);
+}
+
 void Mutex::block(Thread& current_thread, Mode mode, SpinlockLocker<Spinlock<LockRank::None>>& lock, u32 requested_locks)
 {
     if constexpr (LOCK_IN_CRITICAL_DEBUG) {
@@ -231,8 +273,11 @@ void Mutex::block(Thread& current_thread, Mode mode, SpinlockLocker<Spinlock<Loc
     });
 
     dbgln_if(LOCK_TRACE_DEBUG, "Mutex::lock @ {} ({}) waiting...", this, m_name);
+    auto block_start_time = TimeManagement::is_initialized() ? TimeManagement::the().monotonic_time(TimePrecision::Precise) : Time {};
     current_thread.block(*this, lock, requested_locks);
     dbgln_if(LOCK_TRACE_DEBUG, "Mutex::lock @ {} ({}) waited", this, m_name);
+    auto blocked_time = TimeManagement::is_initialized() ? TimeManagement::the().monotonic_time(TimePrecision::Precise) - block_start_time : Time {};
+    MutexContention::record_block(m_name, blocked_time);
 
     m_blocked_thread_lists.with([&](auto& lists) {
         auto remove_from_list = [&]<typename L>(L& list) {
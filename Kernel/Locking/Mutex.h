@@ -82,7 +82,11 @@ private:
     // FIXME: remove this after annihilating Process::m_big_lock
     using BigLockBlockedThreadList = IntrusiveList<&Thread::m_big_lock_blocked_threads_list_node>;
 
+    // How many times we check whether the holder is done before giving up and blocking.
+    static constexpr size_t maximum_spin_iterations = 1000;
+
     // FIXME: Allow any lock rank.
+    void spin_while_holder_is_running(Thread&, SpinlockLocker<Spinlock<LockRank::None>>&);
     void block(Thread&, Mode, SpinlockLocker<Spinlock<LockRank::None>>&, u32);
     void unblock_waiters(Mode);
 
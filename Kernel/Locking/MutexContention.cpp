@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <AK/StringHash.h>
+#include <Kernel/Arch/Processor.h>
+#include <Kernel/Locking/MutexContention.h>
+
+namespace Kernel {
+
+namespace {
+
+enum class EntryState : u8 {
+    Empty,
+    Claimed,
+    Ready,
+};
+
+struct Entry {
+    Atomic<EntryState> state { EntryState::Empty };
+    char name[48] {};
+    size_t name_length { 0 };
+    Atomic<u64> spins { 0 };
+    Atomic<u64> acquired_by_spinning { 0 };
+    Atomic<u64> blocks { 0 };
+    Atomic<u64> blocked_time_us { 0 };
+
+    StringView name_view() const { return { name, name_length }; }
+};
+
+}
+
+static constexpr size_t entry_count = 256;
+static Array<Entry, entry_count> s_entries;
+static Atomic<u64> s_untracked_count { 0 };
+
+static Entry* find_or_create_entry(StringView mutex_name)
+{
+    if (mutex_name.is_empty())
+        mutex_name = "(unnamed)"sv;
+    mutex_name = mutex_name.substring_view(0, min(mutex_name.length(), sizeof(Entry::name)));
+
+    auto hash = string_hash(mutex_name.characters_without_null_termination(), mutex_name.length());
+    for (size_t i = 0; i < entry_count; ++i) {
+        auto& entry = s_entries[(hash + i) % entry_count];
+        auto state = entry.state.load(AK::MemoryOrder::memory_order_acquire);
+        if (state == EntryState::Empty) {
+            auto expected = EntryState::Empty;
+            if (entry.state.compare_exchange_strong(expected, EntryState::Claimed, AK::MemoryOrder::memory_order_acquire)) {
+                __builtin_memcpy(entry.name, mutex_name.characters_without_null_termination(), mutex_name.length());
+                entry.name_length = mutex_name.length();
+                entry.state.store(EntryState::Ready, AK::MemoryOrder::memory_order_release);
+                return &entry;
+            }
+            state = expected;
+        }
+        // Someone else is filling in this entry right now, it won't take long.
+        while (state == EntryState::Claimed) {
+            Processor::pause();
+            state = entry.state.load(AK::MemoryOrder::memory_order_acquire);
+        }
+        if (entry.name_view() == mutex_name)
+            return &entry;
+    }
+    s_untracked_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    return nullptr;
+}
+
+void MutexContention::record_spin(StringView mutex_name, bool acquired)
+{
+    auto* entry = find_or_create_entry(mutex_name);
+    if (!entry)
+        return;
+    entry->spins.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    if (acquired)
+        entry->acquired_by_spinning.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+}
+
+void MutexContention::record_block(StringView mutex_name, Time const& blocked_time)
+{
+    auto* entry = find_or_create_entry(mutex_name);
+    if (!entry)
+        return;
+    entry->blocks.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    entry->blocked_time_us.fetch_add(blocked_time.to_microseconds(), AK::MemoryOrder::memory_order_relaxed);
+}
+
+u64 MutexContention::untracked_count()
+{
+    return s_untracked_count.load(AK::MemoryOrder::memory_order_relaxed);
+}
+
+void MutexContention::for_each(Function<void(Statistics const&)> callback)
+{
+    for (auto& entry : s_entries) {
+        if (entry.state.load(AK::MemoryOrder::memory_order_acquire) != EntryState::Ready)
+            continue;
+        callback({
+            .name = entry.name_view(),
+            .spins = entry.spins.load(AK::MemoryOrder::memory_order_relaxed),
+            .acquired_by_spinning = entry.acquired_by_spinning.load(AK::MemoryOrder::memory_order_relaxed),
+            .blocks = entry.blocks.load(AK::MemoryOrder::memory_order_relaxed),
+            .blocked_time_us = entry.blocked_time_us.load(AK::MemoryOrder::memory_order_relaxed),
+        });
+    }
+}
+
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// Keeps count of how contended acquisitions of each mutex were resolved, keyed by the mutex name.
+// NOTE: Recording never allocates or takes a lock, so it's safe to do from within Mutex itself.
+class MutexContention {
+public:
+    struct Statistics {
+        StringView name;
+        u64 spins { 0 };
+        u64 acquired_by_spinning { 0 };
+        u64 blocks { 0 };
+        u64 blocked_time_us { 0 };
+    };
+
+    static void record_spin(StringView mutex_name, bool acquired);
+    static void record_block(StringView mutex_name, Time const& blocked_time);
+
+    // Mutexes whose names didn't fit into the table anymore.
+    static u64 untracked_count();
+
+    static void for_each(Function<void(Statistics const&)>);
+};
+
+}
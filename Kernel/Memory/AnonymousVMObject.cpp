@@ -276,6 +276,62 @@ NonnullRefPtr<PhysicalPage> AnonymousVMObject::allocate_committed_page(Badge<Reg
     return m_unused_committed_pages->take_one();
 }
 
+bool AnonymousVMObject::try_populate_huge_page(Badge<Region>, size_t first_page_index)
+{
+    VERIFY(first_page_index + PAGES_PER_HUGE_PAGE <= page_count());
+
+    if (m_purgeable)
+        return false;
+
+    // NOTE: We only replace a range that hasn't been touched yet, i.e. one that is entirely
+    //       backed by the shared zero page or lazily committed pages, and isn't shared with a COW peer.
+    auto count_lazy_committed_pages = [&]() -> Optional<size_t> {
+        size_t lazy_committed_page_count = 0;
+        for (size_t i = first_page_index; i < first_page_index + PAGES_PER_HUGE_PAGE; ++i) {
+            auto const& page = m_physical_pages[i];
+            if (!page || !(page->is_shared_zero_page() || page->is_lazy_committed_page()))
+                return {};
+            if (!m_cow_map.is_null() && m_cow_map.get(i))
+                return {};
+            if (page->is_lazy_committed_page())
+                ++lazy_committed_page_count;
+        }
+        return lazy_committed_page_count;
+    };
+
+    {
+        SpinlockLocker locker(m_lock);
+        if (!count_lazy_committed_pages().has_value())
+            return false;
+    }
+
+    auto physical_pages_or_error = MM.allocate_huge_physical_pages();
+    if (physical_pages_or_error.is_error())
+        return false;
+    auto physical_pages = physical_pages_or_error.release_value();
+
+    size_t lazy_committed_page_count = 0;
+    {
+        SpinlockLocker locker(m_lock);
+        auto count = count_lazy_committed_pages();
+        if (!count.has_value()) {
+            // Someone faulted in a page in this range while we were allocating.
+            return false;
+        }
+        lazy_committed_page_count = count.value();
+        for (size_t i = 0; i < PAGES_PER_HUGE_PAGE; ++i)
+            m_physical_pages[first_page_index + i] = physical_pages[i];
+    }
+
+    // The range is now backed by freshly allocated pages, so we no longer need the commitment for its lazy pages.
+    if (lazy_committed_page_count > 0) {
+        VERIFY(m_unused_committed_pages.has_value());
+        for (size_t i = 0; i < lazy_committed_page_count; ++i)
+            m_unused_committed_pages->uncommit_one();
+    }
+    return true;
+}
+
 ErrorOr<void> AnonymousVMObject::ensure_cow_map()
 {
     if (m_cow_map.is_null())
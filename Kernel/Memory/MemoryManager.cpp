@@ -19,6 +19,7 @@
 #include <Kernel/Memory/AnonymousVMObject.h>
 #include <Kernel/Memory/MemoryManager.h>
 #include <Kernel/Memory/PhysicalRegion.h>
+#include <Kernel/Memory/ScopedTLBFlushBatch.h>
 #include <Kernel/Memory/SharedInodeVMObject.h>
 #include <Kernel/Multiboot.h>
 #include <Kernel/Panic.h>
@@ -26,6 +27,7 @@
 #include <Kernel/Process.h>
 #include <Kernel/Sections.h>
 #include <Kernel/StdLib.h>
+#include <Kernel/Tasks/ReclaimTask.h>
 
 extern u8 start_of_kernel_image[];
 extern u8 end_of_kernel_image[];
@@ -570,6 +572,11 @@ PageTableEntry* MemoryManager::pte(PageDirectory& page_directory, VirtualAddress
     PageDirectoryEntry const& pde = pd[page_directory_index];
     if (!pde.is_present())
         return nullptr;
+#if ARCH(X86_64)
+    // NOTE: Huge pages have no page table to return an entry from.
+    if (pde.is_huge())
+        return nullptr;
+#endif
 
     return &quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()))[page_table_index];
 }
@@ -584,6 +591,15 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     auto& pde = pd[page_directory_index];
+#if ARCH(X86_64)
+    if (pde.is_present() && pde.is_huge()) {
+        // Someone wants to change a single page inside a huge page, fall back to mapping it with small pages.
+        if (!split_huge_pde(page_directory, vaddr))
+            return nullptr;
+        pd = quickmap_pd(page_directory, page_directory_table_index);
+        VERIFY(&pde == &pd[page_directory_index]); // Sanity check
+    }
+#endif
     if (pde.is_present())
         return &quickmap_pt(PhysicalAddress(pde.page_table_base()))[page_table_index];
 
@@ -615,6 +631,18 @@ PageTableEntry* MemoryManager::ensure_pte(PageDirectory& page_directory, Virtual
     return &quickmap_pt(PhysicalAddress(pde.page_table_base()))[page_table_index];
 }
 
+static ScopedTLBFlushBatch* tlb_flush_batch_for(PageDirectory const* page_directory, VirtualAddress vaddr)
+{
+    // NOTE: Batches only exist while interrupts are disabled, so we can only be in one if that's the case,
+    //       and then it's also safe to look at this processor's data.
+    if (!is_user_address(vaddr) || Processor::are_interrupts_enabled())
+        return nullptr;
+    auto* batch = MemoryManager::get_data().m_tlb_flush_batch;
+    if (!batch || &batch->page_directory() != page_directory)
+        return nullptr;
+    return batch;
+}
+
 void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress vaddr, IsLastPTERelease is_last_pte_release)
 {
     VERIFY_INTERRUPTS_DISABLED();
@@ -625,6 +653,14 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
 
     auto* pd = quickmap_pd(page_directory, page_directory_table_index);
     PageDirectoryEntry& pde = pd[page_directory_index];
+#if ARCH(X86_64)
+    if (pde.is_present() && pde.is_huge()) {
+        // NOTE: Huge pages are only used for ranges that are entirely covered by one region,
+        //       so releasing any part of it means we're tearing down the whole thing.
+        pde.clear();
+        return;
+    }
+#endif
     if (pde.is_present()) {
         auto* page_table = quickmap_pt(PhysicalAddress((FlatPtr)pde.page_table_base()));
         auto& pte = page_table[page_table_index];
@@ -641,13 +677,87 @@ void MemoryManager::release_pte(PageDirectory& page_directory, VirtualAddress va
                 }
             }
             if (all_clear) {
-                get_physical_page_entry(PhysicalAddress { pde.page_table_base() }).allocated.physical_page.unref();
+                auto& page_table_page = get_physical_page_entry(PhysicalAddress { pde.page_table_base() }).allocated.physical_page;
                 pde.clear();
+                // NOTE: If the TLB shootdown for this range is batched, the page table must stay allocated until it happened.
+                if (auto* batch = tlb_flush_batch_for(&page_directory, vaddr); batch && !batch->add_and_retain_page_table(vaddr, page_table_page))
+                    Processor::flush_tlb(&page_directory, vaddr, 1);
+                page_table_page.unref();
             }
         }
     }
 }
 
+#if ARCH(X86_64)
+PageDirectoryEntry* MemoryManager::ensure_huge_pde(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(page_directory.get_lock().is_locked_by_current_processor());
+    VERIFY(vaddr.get() % HUGE_PAGE_SIZE == 0);
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x1ff;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    auto& pde = pd[page_directory_index];
+    if (pde.is_present() && !pde.is_huge()) {
+        // Drop the page table that mapped this range with small pages.
+        // The caller has made sure that all of its entries belong to the same region.
+        get_physical_page_entry(PhysicalAddress { pde.page_table_base() }).allocated.physical_page.unref();
+        pde.clear();
+    }
+    return &pde;
+}
+
+bool MemoryManager::split_huge_pde(PageDirectory& page_directory, VirtualAddress vaddr)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(page_directory.get_lock().is_locked_by_current_processor());
+    u32 page_directory_table_index = (vaddr.get() >> 30) & 0x1ff;
+    u32 page_directory_index = (vaddr.get() >> 21) & 0x1ff;
+    VirtualAddress huge_page_vaddr { vaddr.get() & ~(HUGE_PAGE_SIZE - 1) };
+
+    auto page_table_or_error = allocate_physical_page(ShouldZeroFill::Yes);
+    if (page_table_or_error.is_error()) {
+        dbgln("MM: Unable to allocate page table to split huge page at {}", huge_page_vaddr);
+        return false;
+    }
+    auto page_table = page_table_or_error.release_value();
+
+    auto* pd = quickmap_pd(page_directory, page_directory_table_index);
+    auto& pde = pd[page_directory_index];
+    if (!pde.is_present() || !pde.is_huge()) {
+        // The huge page went away while we were allocating (e.g. because of a purge), nothing to split.
+        return true;
+    }
+
+    auto* ptes = quickmap_pt(page_table->paddr());
+    for (size_t i = 0; i < PAGES_PER_HUGE_PAGE; ++i) {
+        auto& pte = ptes[i];
+        pte.set_physical_page_base(pde.page_table_base() + i * PAGE_SIZE);
+        pte.set_present(true);
+        pte.set_writable(pde.is_writable());
+        pte.set_user_allowed(pde.is_user_allowed());
+        pte.set_global(pde.is_global());
+        if (Processor::current().has_nx())
+            pte.set_execute_disabled(pde.is_execute_disabled());
+    }
+
+    pde.set_huge(false);
+    pde.set_page_table_base(page_table->paddr().get());
+    pde.set_user_allowed(true);
+    pde.set_present(true);
+    pde.set_writable(true);
+    if (Processor::current().has_nx())
+        pde.set_execute_disabled(false);
+
+    // NOTE: This leaked ref is matched by the unref in MemoryManager::release_pte()
+    (void)page_table.leak_ref();
+
+    flush_tlb(&page_directory, huge_page_vaddr, PAGES_PER_HUGE_PAGE);
+    return true;
+}
+#endif
+
 UNMAP_AFTER_INIT void MemoryManager::initialize(u32 cpu)
 {
     dmesgln("Initialize MMU");
@@ -955,7 +1065,9 @@ NonnullRefPtr<PhysicalPage> MemoryManager::allocate_committed_physical_page(Badg
 
 ErrorOr<NonnullRefPtr<PhysicalPage>> MemoryManager::allocate_physical_page(ShouldZeroFill should_zero_fill, bool* did_purge)
 {
-    return m_global_data.with([&](auto&) -> ErrorOr<NonnullRefPtr<PhysicalPage>> {
+    size_t free_page_count = 0;
+    size_t total_page_count = 0;
+    auto page_or_error = m_global_data.with([&](auto& global_data) -> ErrorOr<NonnullRefPtr<PhysicalPage>> {
         auto page = find_free_physical_page(false);
         bool purged_pages = false;
 
@@ -1006,8 +1118,15 @@ ErrorOr<NonnullRefPtr<PhysicalPage>> MemoryManager::allocate_physical_page(Shoul
 
         if (did_purge)
             *did_purge = purged_pages;
+        free_page_count = global_data.system_memory_info.physical_pages_uncommitted;
+        total_page_count = global_data.system_memory_info.physical_pages;
         return page.release_nonnull();
     });
+
+    // Note: This is done after letting go of the lock, as it may wake up the reclaim task.
+    if (!page_or_error.is_error())
+        ReclaimTask::notify_free_page_count(free_page_count, total_page_count);
+    return page_or_error;
 }
 
 ErrorOr<NonnullRefPtrVector<PhysicalPage>> MemoryManager::allocate_contiguous_physical_pages(size_t size)
@@ -1039,6 +1158,34 @@ ErrorOr<NonnullRefPtrVector<PhysicalPage>> MemoryManager::allocate_contiguous_ph
     return physical_pages;
 }
 
+ErrorOr<NonnullRefPtrVector<PhysicalPage>> MemoryManager::allocate_huge_physical_pages()
+{
+    auto physical_pages = TRY(m_global_data.with([&](auto& global_data) -> ErrorOr<NonnullRefPtrVector<PhysicalPage>> {
+        // We need to make sure we don't touch pages that we have committed to
+        if (global_data.system_memory_info.physical_pages_uncommitted < PAGES_PER_HUGE_PAGE)
+            return ENOMEM;
+
+        for (auto& physical_region : global_data.physical_regions) {
+            auto physical_pages = physical_region.take_contiguous_free_pages(PAGES_PER_HUGE_PAGE, HUGE_PAGE_SIZE);
+            if (!physical_pages.is_empty()) {
+                global_data.system_memory_info.physical_pages_uncommitted -= PAGES_PER_HUGE_PAGE;
+                global_data.system_memory_info.physical_pages_used += PAGES_PER_HUGE_PAGE;
+                return physical_pages;
+            }
+        }
+        // NOTE: This is opportunistic, so callers fall back to small pages without complaining.
+        return ENOMEM;
+    }));
+
+    for (auto& physical_page : physical_pages) {
+        InterruptDisabler disabler;
+        auto* ptr = quickmap_page(physical_page);
+        memset(ptr, 0, PAGE_SIZE);
+        unquickmap_page();
+    }
+    return physical_pages;
+}
+
 void MemoryManager::enter_process_address_space(Process& process)
 {
     process.address_space().with([](auto& space) {
@@ -1060,6 +1207,19 @@ void MemoryManager::flush_tlb_local(VirtualAddress vaddr, size_t page_count)
 
 void MemoryManager::flush_tlb(PageDirectory const* page_directory, VirtualAddress vaddr, size_t page_count)
 {
+    if (auto* batch = tlb_flush_batch_for(page_directory, vaddr)) {
+        batch->add(vaddr, page_count);
+        return;
+    }
+    Processor::flush_tlb(page_directory, vaddr, page_count);
+}
+
+void MemoryManager::flush_tlb_for_unmapped_range(PageDirectory const* page_directory, VirtualAddress vaddr, size_t page_count, VMObject& vmobject)
+{
+    if (auto* batch = tlb_flush_batch_for(page_directory, vaddr)) {
+        if (batch->add_and_retain(vaddr, page_count, vmobject))
+            return;
+    }
     Processor::flush_tlb(page_directory, vaddr, page_count);
 }
 
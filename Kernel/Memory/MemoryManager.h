@@ -27,6 +27,7 @@ namespace Kernel::Memory {
 
 class PageDirectoryEntry;
 class PageTableEntry;
+class ScopedTLBFlushBatch;
 
 ErrorOr<FlatPtr> page_round_up(FlatPtr x);
 
@@ -35,6 +36,10 @@ constexpr FlatPtr page_round_down(FlatPtr x)
     return ((FlatPtr)(x)) & ~(PAGE_SIZE - 1);
 }
 
+// Suitably aligned anonymous memory is transparently mapped with 2 MiB pages where the architecture supports it.
+constexpr size_t HUGE_PAGE_SIZE = 2 * MiB;
+constexpr size_t PAGES_PER_HUGE_PAGE = HUGE_PAGE_SIZE / PAGE_SIZE;
+
 inline FlatPtr virtual_to_low_physical(FlatPtr virtual_)
 {
     return virtual_ - physical_to_virtual_offset;
@@ -89,6 +94,8 @@ struct MemoryManagerData {
 
     Spinlock<LockRank::None> m_quickmap_in_use {};
     InterruptsState m_quickmap_previous_interrupts_state;
+
+    ScopedTLBFlushBatch* m_tlb_flush_batch { nullptr };
 };
 
 // This class represents a set of committed physical pages.
@@ -128,6 +135,7 @@ class MemoryManager {
     friend class AnonymousVMObject;
     friend class Region;
     friend class RegionTree;
+    friend class SharedInodeVMObject;
     friend class VMObject;
     friend struct ::KmallocGlobalData;
 
@@ -167,6 +175,7 @@ public:
     NonnullRefPtr<PhysicalPage> allocate_committed_physical_page(Badge<CommittedPhysicalPageSet>, ShouldZeroFill = ShouldZeroFill::Yes);
     ErrorOr<NonnullRefPtr<PhysicalPage>> allocate_physical_page(ShouldZeroFill = ShouldZeroFill::Yes, bool* did_purge = nullptr);
     ErrorOr<NonnullRefPtrVector<PhysicalPage>> allocate_contiguous_physical_pages(size_t size);
+    ErrorOr<NonnullRefPtrVector<PhysicalPage>> allocate_huge_physical_pages();
     void deallocate_physical_page(PhysicalAddress);
 
     ErrorOr<NonnullOwnPtr<Region>> allocate_contiguous_kernel_region(size_t, StringView name, Region::Access access, Region::Cacheable = Region::Cacheable::Yes);
@@ -250,6 +259,7 @@ private:
     void parse_memory_map();
     static void flush_tlb_local(VirtualAddress, size_t page_count = 1);
     static void flush_tlb(PageDirectory const*, VirtualAddress, size_t page_count = 1);
+    static void flush_tlb_for_unmapped_range(PageDirectory const*, VirtualAddress, size_t page_count, VMObject&);
 
     static Region* kernel_region_from_vaddr(VirtualAddress);
 
@@ -275,6 +285,11 @@ private:
     };
     void release_pte(PageDirectory&, VirtualAddress, IsLastPTERelease);
 
+#if ARCH(X86_64)
+    PageDirectoryEntry* ensure_huge_pde(PageDirectory&, VirtualAddress);
+    bool split_huge_pde(PageDirectory&, VirtualAddress);
+#endif
+
     // NOTE: These are outside of GlobalData as they are only assigned on startup,
     //       and then never change. Atomic ref-counting covers that case without
     //       the need for additional synchronization.
@@ -75,15 +75,29 @@ OwnPtr<PhysicalRegion> PhysicalRegion::try_take_pages_from_beginning(size_t page
     return try_create(taken_lower, taken_upper);
 }
 
-NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(size_t count)
+NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(size_t count, size_t physical_alignment)
 {
     auto rounded_page_count = next_power_of_two(count);
     auto order = count_trailing_zeroes(rounded_page_count);
+    VERIFY(physical_alignment <= rounded_page_count * PAGE_SIZE);
 
     Optional<PhysicalAddress> page_base;
     for (auto& zone : m_usable_zones) {
-        page_base = zone.allocate_block(order);
+        // NOTE: Buddy blocks are only naturally aligned relative to the base of their zone.
+        //       If that isn't aligned enough, allocate twice as much and give back the excess.
+        bool needs_trimming = zone.base().get() % physical_alignment != 0;
+        page_base = zone.allocate_block(needs_trimming ? order + 1 : order);
         if (page_base.has_value()) {
+            if (needs_trimming) {
+                auto block_base = page_base.value();
+                auto block_end = block_base.offset(rounded_page_count * PAGE_SIZE * 2);
+                page_base = PhysicalAddress { align_up_to(block_base.get(), physical_alignment) };
+                auto aligned_end = page_base.value().offset(rounded_page_count * PAGE_SIZE);
+                for (auto paddr = block_base; paddr < page_base.value(); paddr = paddr.offset(PAGE_SIZE))
+                    zone.deallocate_block(paddr, 0);
+                for (auto paddr = aligned_end; paddr < block_end; paddr = paddr.offset(PAGE_SIZE))
+                    zone.deallocate_block(paddr, 0);
+            }
             if (zone.is_empty()) {
                 // We've exhausted this zone, move it to the full zones list.
                 m_full_zones.append(zone);
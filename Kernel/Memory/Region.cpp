@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteBuffer.h>
 #include <AK/StringView.h>
 #include <Kernel/Arch/PageDirectory.h>
 #include <Kernel/Arch/PageFault.h>
@@ -200,6 +201,15 @@ ErrorOr<void> Region::set_should_cow(size_t page_index, bool cow)
     return {};
 }
 
+bool Region::should_write_protect_for_dirty_tracking(size_t page_index) const
+{
+    // NOTE: Clean pages of a shared inode mapping are mapped read-only, so that
+    //       the first write faults and lets us mark the page dirty for writeback.
+    if (!vmobject().is_shared_inode())
+        return false;
+    return !static_cast<SharedInodeVMObject const&>(vmobject()).is_page_dirty(first_page_index() + page_index);
+}
+
 bool Region::map_individual_page_impl(size_t page_index, RefPtr<PhysicalPage> page)
 {
     VERIFY(m_page_directory->get_lock().is_locked_by_current_processor());
@@ -223,7 +233,7 @@ bool Region::map_individual_page_impl(size_t page_index, RefPtr<PhysicalPage> pa
     pte->set_cache_disabled(!m_cacheable);
     pte->set_physical_page_base(page->paddr().get());
     pte->set_present(true);
-    if (page->is_shared_zero_page() || page->is_lazy_committed_page() || should_cow(page_index))
+    if (page->is_shared_zero_page() || page->is_lazy_committed_page() || should_cow(page_index) || should_write_protect_for_dirty_tracking(page_index))
         pte->set_writable(false);
     else
         pte->set_writable(is_writable());
@@ -247,6 +257,53 @@ bool Region::map_individual_page_impl(size_t page_index)
     return map_individual_page_impl(page_index, page);
 }
 
+bool Region::try_map_huge_page_impl(size_t page_index)
+{
+#if ARCH(X86_64)
+    VERIFY(m_page_directory->get_lock().is_locked_by_current_processor());
+
+    if (!is_user() || !vmobject().is_anonymous() || !is_cacheable() || is_write_combine())
+        return false;
+
+    auto page_vaddr = vaddr_from_page_index(page_index);
+    if (page_vaddr.get() % HUGE_PAGE_SIZE != 0 || page_index + PAGES_PER_HUGE_PAGE > page_count())
+        return false;
+
+    // We can only use a huge page if the whole range is backed by one naturally aligned,
+    // physically contiguous chunk of private memory that is mapped with the same permissions.
+    PhysicalAddress huge_page_paddr;
+    {
+        SpinlockLocker vmobject_locker(vmobject().m_lock);
+        for (size_t i = 0; i < PAGES_PER_HUGE_PAGE; ++i) {
+            auto const& page = physical_page_slot(page_index + i);
+            if (!page || !page->may_return_to_freelist() || should_cow(page_index + i))
+                return false;
+            if (i == 0) {
+                huge_page_paddr = page->paddr();
+                if (huge_page_paddr.get() % HUGE_PAGE_SIZE != 0)
+                    return false;
+            } else if (page->paddr() != huge_page_paddr.offset(i * PAGE_SIZE)) {
+                return false;
+            }
+        }
+    }
+
+    auto* pde = MM.ensure_huge_pde(*m_page_directory, page_vaddr);
+    pde->clear();
+    pde->set_page_table_base(huge_page_paddr.get());
+    pde->set_huge(true);
+    pde->set_present(true);
+    pde->set_writable(is_writable());
+    pde->set_user_allowed(true);
+    if (Processor::current().has_nx())
+        pde->set_execute_disabled(!is_executable());
+    return true;
+#else
+    (void)page_index;
+    return false;
+#endif
+}
+
 bool Region::remap_vmobject_page(size_t page_index, NonnullRefPtr<PhysicalPage> physical_page)
 {
     SpinlockLocker page_lock(m_page_directory->get_lock());
@@ -278,7 +335,7 @@ void Region::unmap_with_locks_held(ShouldFlushTLB should_flush_tlb, SpinlockLock
         MM.release_pte(*m_page_directory, vaddr, i == count - 1 ? MemoryManager::IsLastPTERelease::Yes : MemoryManager::IsLastPTERelease::No);
     }
     if (should_flush_tlb == ShouldFlushTLB::Yes)
-        MemoryManager::flush_tlb(m_page_directory, vaddr(), page_count());
+        MemoryManager::flush_tlb_for_unmapped_range(m_page_directory, vaddr(), page_count(), vmobject());
     m_page_directory = nullptr;
 }
 
@@ -300,6 +357,10 @@ ErrorOr<void> Region::map(PageDirectory& page_directory, ShouldFlushTLB should_f
     set_page_directory(page_directory);
     size_t page_index = 0;
     while (page_index < page_count()) {
+        if (try_map_huge_page_impl(page_index)) {
+            page_index += PAGES_PER_HUGE_PAGE;
+            continue;
+        }
         if (!map_individual_page_impl(page_index))
             break;
         ++page_index;
@@ -373,13 +434,17 @@ PageFaultResponse Region::handle_fault(PageFault const& fault)
                 return PageFaultResponse::OutOfMemory;
             return PageFaultResponse::Continue;
         }
-        dbgln("BUG! Unexpected NP fault at {}", fault.vaddr());
-        dbgln("     - Physical page slot pointer: {:p}", page_slot.ptr());
         if (page_slot) {
-            dbgln("     - Physical page: {}", page_slot->paddr());
-            dbgln("     - Lazy committed: {}", page_slot->is_lazy_committed_page());
-            dbgln("     - Shared zero: {}", page_slot->is_shared_zero_page());
+            // Regions cloned by fork() are not mapped up front, so the page is there but has no page table entry yet.
+            dbgln_if(PAGE_FAULT_DEBUG, "NP(unmapped) fault in Region({})[{}]", this, page_index_in_region);
+            if (!remap_vmobject_page(translate_to_vmobject_page(page_index_in_region), *page_slot))
+                return PageFaultResponse::OutOfMemory;
+            vmobject_locker.unlock();
+            fault_around_page(page_index_in_region);
+            return PageFaultResponse::Continue;
         }
+        dbgln("BUG! Unexpected NP fault at {}", fault.vaddr());
+        dbgln("     - Physical page slot pointer: {:p}", page_slot.ptr());
         return PageFaultResponse::ShouldCrash;
     }
     VERIFY(fault.type() == PageFault::Type::ProtectionViolation);
@@ -392,6 +457,10 @@ PageFaultResponse Region::handle_fault(PageFault const& fault)
         }
         return handle_cow_fault(page_index_in_region);
     }
+    if (fault.access() == PageFault::Access::Write && is_writable() && vmobject().is_shared_inode()) {
+        dbgln_if(PAGE_FAULT_DEBUG, "PV(dirty) fault in Region({})[{}] at {}", this, page_index_in_region, fault.vaddr());
+        return handle_inode_write_fault(page_index_in_region);
+    }
     dbgln("PV(error) fault in Region({})[{}] at {}", this, page_index_in_region, fault.vaddr());
     return PageFaultResponse::ShouldCrash;
 }
@@ -406,6 +475,9 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region, Physica
     if (current_thread != nullptr)
         current_thread->did_zero_fault();
 
+    if (try_handle_huge_zero_fault(page_index_in_region))
+        return PageFaultResponse::Continue;
+
     RefPtr<PhysicalPage> new_physical_page;
 
     if (page_in_slot_at_time_of_fault.is_lazy_committed_page()) {
@@ -444,6 +516,40 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region, Physica
     return PageFaultResponse::Continue;
 }
 
+bool Region::try_handle_huge_zero_fault(size_t page_index_in_region)
+{
+#if ARCH(X86_64)
+    if (!is_user() || !is_writable() || !is_cacheable() || is_write_combine())
+        return false;
+
+    // Find the huge page sized and aligned block around the faulting address, it has to be entirely inside this region.
+    auto huge_page_vaddr = VirtualAddress { vaddr_from_page_index(page_index_in_region).get() & ~(HUGE_PAGE_SIZE - 1) };
+    if (huge_page_vaddr < vaddr() || huge_page_vaddr.offset(HUGE_PAGE_SIZE) > range().end())
+        return false;
+    auto first_page_index_in_region = page_index_from_address(huge_page_vaddr);
+
+    auto& anonymous_vmobject = static_cast<AnonymousVMObject&>(vmobject());
+    if (!anonymous_vmobject.try_populate_huge_page({}, translate_to_vmobject_page(first_page_index_in_region)))
+        return false;
+
+    dbgln_if(PAGE_FAULT_DEBUG, "      >> ALLOCATED HUGE PAGE at {}", huge_page_vaddr);
+
+    SpinlockLocker page_lock(m_page_directory->get_lock());
+    if (!try_map_huge_page_impl(first_page_index_in_region)) {
+        // Someone made part of the range unsuitable for a huge page in the meantime (e.g. a fork), map the pages one by one.
+        for (size_t i = 0; i < PAGES_PER_HUGE_PAGE; ++i) {
+            if (!map_individual_page_impl(first_page_index_in_region + i))
+                break;
+        }
+    }
+    MemoryManager::flush_tlb(m_page_directory, huge_page_vaddr, PAGES_PER_HUGE_PAGE);
+    return true;
+#else
+    (void)page_index_in_region;
+    return false;
+#endif
+}
+
 PageFaultResponse Region::handle_cow_fault(size_t page_index_in_region)
 {
     auto current_thread = Thread::current();
@@ -460,6 +566,44 @@ PageFaultResponse Region::handle_cow_fault(size_t page_index_in_region)
     return response;
 }
 
+size_t Region::inode_readahead_page_count(size_t page_index_in_region)
+{
+    // NOTE: This is only a heuristic, so we don't care about racing with faults from other threads.
+    static constexpr size_t max_readahead_page_count = 32;
+    if (page_index_in_region == m_next_sequential_inode_fault_page_index)
+        m_inode_readahead_page_count = clamp<size_t>(m_inode_readahead_page_count * 2, 2, max_readahead_page_count);
+    else
+        m_inode_readahead_page_count = 1;
+
+    auto page_count = min<size_t>(m_inode_readahead_page_count, this->page_count() - page_index_in_region);
+    m_next_sequential_inode_fault_page_index = page_index_in_region + page_count;
+    return page_count;
+}
+
+void Region::fault_around_page(size_t page_index_in_region)
+{
+    // Map the already resident pages around a faulting page, so we don't take a fault for each of them.
+    static constexpr size_t fault_around_page_count = 16;
+    auto first_page_index = page_index_in_region & ~(fault_around_page_count - 1);
+    auto last_page_index = min(first_page_index + fault_around_page_count, page_count());
+
+    SpinlockLocker vmobject_locker(vmobject().m_lock);
+    SpinlockLocker page_lock(m_page_directory->get_lock());
+    for (size_t page_index = first_page_index; page_index < last_page_index; ++page_index) {
+        if (page_index == page_index_in_region)
+            continue;
+        auto page = physical_page(page_index);
+        if (!page)
+            continue;
+        auto* pte = MM.pte(*m_page_directory, vaddr_from_page_index(page_index));
+        if (!pte || pte->is_present())
+            continue;
+        // NOTE: Non-present entries aren't cached in the TLB, so there's nothing to flush here.
+        if (!map_individual_page_impl(page_index, page))
+            break;
+    }
+}
+
 PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
 {
     VERIFY(vmobject().is_inode());
@@ -477,6 +621,8 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
             dbgln_if(PAGE_FAULT_DEBUG, "handle_inode_fault: Page faulted in by someone else before reading, remapping.");
             if (!remap_vmobject_page(page_index_in_vmobject, *vmobject_physical_page_slot))
                 return PageFaultResponse::OutOfMemory;
+            locker.unlock();
+            fault_around_page(page_index_in_region);
             return PageFaultResponse::Continue;
         }
     }
@@ -487,11 +633,26 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
     if (current_thread)
         current_thread->did_inode_fault();
 
+    // If faults in this region look sequential, read ahead so the following pages are resident by the time they're touched.
+    auto readahead_page_count = inode_readahead_page_count(page_index_in_region);
+
     u8 page_buffer[PAGE_SIZE];
+    u8* data = page_buffer;
+    ByteBuffer readahead_buffer;
+    if (readahead_page_count > 1) {
+        auto buffer_or_error = ByteBuffer::create_uninitialized(readahead_page_count * PAGE_SIZE);
+        if (buffer_or_error.is_error()) {
+            readahead_page_count = 1;
+        } else {
+            readahead_buffer = buffer_or_error.release_value();
+            data = readahead_buffer.data();
+        }
+    }
+
     auto& inode = inode_vmobject.inode();
 
-    auto buffer = UserOrKernelBuffer::for_kernel_buffer(page_buffer);
-    auto result = inode.read_bytes(page_index_in_vmobject * PAGE_SIZE, PAGE_SIZE, buffer, nullptr);
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(data);
+    auto result = inode.read_bytes(page_index_in_vmobject * PAGE_SIZE, readahead_page_count * PAGE_SIZE, buffer, nullptr);
 
     if (result.is_error()) {
         dmesgln("handle_inode_fault: Error ({}) while reading from inode", result.error());
@@ -504,44 +665,78 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region)
     if (nread == 0)
         return PageFaultResponse::BusError;
 
-    if (nread < PAGE_SIZE) {
+    auto pages_read = ceil_div(nread, static_cast<size_t>(PAGE_SIZE));
+    if (nread % PAGE_SIZE) {
         // If we read less than a page, zero out the rest to avoid leaking uninitialized data.
-        memset(page_buffer + nread, 0, PAGE_SIZE - nread);
+        memset(data + nread, 0, PAGE_SIZE - (nread % PAGE_SIZE));
     }
 
-    // Allocate a new physical page, and copy the read inode contents into it.
-    auto new_physical_page_or_error = MM.allocate_physical_page(MemoryManager::ShouldZeroFill::No);
-    if (new_physical_page_or_error.is_error()) {
-        dmesgln("MM: handle_inode_fault was unable to allocate a physical page");
-        return PageFaultResponse::OutOfMemory;
-    }
-    auto new_physical_page = new_physical_page_or_error.release_value();
-    {
-        InterruptDisabler disabler;
-        u8* dest_ptr = MM.quickmap_page(*new_physical_page);
-        memcpy(dest_ptr, page_buffer, PAGE_SIZE);
-        MM.unquickmap_page();
-    }
+    for (size_t i = 0; i < pages_read; ++i) {
+        auto& slot = inode_vmobject.physical_pages()[page_index_in_vmobject + i];
+
+        if (inode_vmobject.is_shared_inode()) {
+            // NOTE: Inode::read_bytes() populates the page cache, which is this VMObject, so the slot is usually filled by now.
+            SpinlockLocker locker(inode_vmobject.m_lock);
+            if (!slot.is_null())
+                continue;
+        }
+
+        // Allocate a new physical page, and copy the read inode contents into it.
+        auto new_physical_page_or_error = MM.allocate_physical_page(MemoryManager::ShouldZeroFill::No);
+        if (new_physical_page_or_error.is_error()) {
+            // Readahead is best effort, we only have to succeed for the faulting page.
+            if (i == 0) {
+                dmesgln("MM: handle_inode_fault was unable to allocate a physical page");
+                return PageFaultResponse::OutOfMemory;
+            }
+            break;
+        }
+        auto new_physical_page = new_physical_page_or_error.release_value();
+        {
+            InterruptDisabler disabler;
+            u8* dest_ptr = MM.quickmap_page(*new_physical_page);
+            memcpy(dest_ptr, data + i * PAGE_SIZE, PAGE_SIZE);
+            MM.unquickmap_page();
+        }
 
-    {
         // NOTE: The VMObject lock is required when manipulating the VMObject's physical page slot.
         SpinlockLocker locker(inode_vmobject.m_lock);
-
-        if (!vmobject_physical_page_slot.is_null()) {
+        if (!slot.is_null()) {
             // Someone else faulted in this page while we were reading from the inode.
-            // No harm done (other than some duplicate work), remap the page here and return.
+            // No harm done (other than some duplicate work), we'll map theirs below.
             dbgln_if(PAGE_FAULT_DEBUG, "handle_inode_fault: Page faulted in by someone else, remapping.");
-            if (!remap_vmobject_page(page_index_in_vmobject, *vmobject_physical_page_slot))
-                return PageFaultResponse::OutOfMemory;
-            return PageFaultResponse::Continue;
+            continue;
         }
+        slot = move(new_physical_page);
+    }
+
+    {
+        SpinlockLocker locker(inode_vmobject.m_lock);
+        if (!remap_vmobject_page(page_index_in_vmobject, *vmobject_physical_page_slot))
+            return PageFaultResponse::OutOfMemory;
+    }
+
+    fault_around_page(page_index_in_region);
+    return PageFaultResponse::Continue;
+}
 
-        vmobject_physical_page_slot = new_physical_page;
+PageFaultResponse Region::handle_inode_write_fault(size_t page_index_in_region)
+{
+    VERIFY(vmobject().is_shared_inode());
+
+    auto& inode_vmobject = static_cast<SharedInodeVMObject&>(vmobject());
+    auto page_index_in_vmobject = translate_to_vmobject_page(page_index_in_region);
+
+    SpinlockLocker locker(inode_vmobject.m_lock);
+    auto& vmobject_physical_page_slot = inode_vmobject.physical_pages()[page_index_in_vmobject];
+    if (vmobject_physical_page_slot.is_null()) {
+        // The page was evicted after we took the fault, retrying will fault it back in.
+        return PageFaultResponse::Continue;
     }
 
+    inode_vmobject.set_page_dirty(page_index_in_vmobject, true);
     if (!remap_vmobject_page(page_index_in_vmobject, *vmobject_physical_page_slot))
         return PageFaultResponse::OutOfMemory;
-
     return PageFaultResponse::Continue;
 }
 
@@ -180,6 +180,7 @@ public:
     [[nodiscard]] size_t amount_dirty() const;
 
     [[nodiscard]] bool should_cow(size_t page_index) const;
+    [[nodiscard]] bool should_write_protect_for_dirty_tracking(size_t page_index) const;
     ErrorOr<void> set_should_cow(size_t page_index, bool);
 
     [[nodiscard]] size_t cow_pages() const;
@@ -224,10 +225,15 @@ private:
 
     [[nodiscard]] PageFaultResponse handle_cow_fault(size_t page_index);
     [[nodiscard]] PageFaultResponse handle_inode_fault(size_t page_index);
+    [[nodiscard]] PageFaultResponse handle_inode_write_fault(size_t page_index);
+    [[nodiscard]] size_t inode_readahead_page_count(size_t page_index);
+    void fault_around_page(size_t page_index);
     [[nodiscard]] PageFaultResponse handle_zero_fault(size_t page_index, PhysicalPage& page_in_slot_at_time_of_fault);
+    [[nodiscard]] bool try_handle_huge_zero_fault(size_t page_index);
 
     [[nodiscard]] bool map_individual_page_impl(size_t page_index);
     [[nodiscard]] bool map_individual_page_impl(size_t page_index, RefPtr<PhysicalPage>);
+    [[nodiscard]] bool try_map_huge_page_impl(size_t page_index);
 
     LockRefPtr<PageDirectory> m_page_directory;
     VirtualRange m_range;
@@ -245,6 +251,10 @@ private:
     bool m_mmapped_from_readable : 1 { false };
     bool m_mmapped_from_writable : 1 { false };
 
+    // Sequential fault detection for inode readahead, see handle_inode_fault().
+    size_t m_next_sequential_inode_fault_page_index { 0 };
+    size_t m_inode_readahead_page_count { 0 };
+
     IntrusiveRedBlackTreeNode<FlatPtr, Region, RawPtr<Region>> m_tree_node;
     IntrusiveListNode<Region> m_vmobject_list_node;
 
@@ -26,7 +26,7 @@ ScopedAddressSpaceSwitcher::~ScopedAddressSpaceSwitcher()
     InterruptDisabler disabler;
 #if ARCH(X86_64)
     Thread::current()->regs().cr3 = m_previous_cr3;
-    write_cr3(m_previous_cr3);
+    Processor::load_cr3(m_previous_cr3);
 #elif ARCH(AARC64)
     TODO_AARCH64();
 #endif
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Arch/Processor.h>
+#include <Kernel/Memory/MemoryManager.h>
+#include <Kernel/Memory/ScopedTLBFlushBatch.h>
+
+namespace Kernel::Memory {
+
+ScopedTLBFlushBatch::ScopedTLBFlushBatch(PageDirectory const& page_directory)
+    : m_page_directory(page_directory)
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    auto& mm_data = MemoryManager::get_data();
+    m_previous_batch = mm_data.m_tlb_flush_batch;
+    mm_data.m_tlb_flush_batch = this;
+}
+
+ScopedTLBFlushBatch::~ScopedTLBFlushBatch()
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    auto& mm_data = MemoryManager::get_data();
+    VERIFY(mm_data.m_tlb_flush_batch == this);
+    mm_data.m_tlb_flush_batch = m_previous_batch;
+    flush();
+}
+
+void ScopedTLBFlushBatch::add(VirtualAddress vaddr, size_t page_count)
+{
+    VERIFY(is_user_address(vaddr));
+    auto end = vaddr.offset(page_count * PAGE_SIZE);
+    if (m_start.is_null() || vaddr < m_start)
+        m_start = vaddr;
+    if (end > m_end)
+        m_end = end;
+}
+
+bool ScopedTLBFlushBatch::add_and_retain(VirtualAddress vaddr, size_t page_count, VMObject& vmobject)
+{
+    if (m_retained_vmobjects.try_append(vmobject).is_error())
+        return false;
+    add(vaddr, page_count);
+    return true;
+}
+
+bool ScopedTLBFlushBatch::add_and_retain_page_table(VirtualAddress vaddr, PhysicalPage& page_table)
+{
+    if (m_retained_page_tables.try_append(page_table).is_error())
+        return false;
+    add(vaddr, 1);
+    return true;
+}
+
+void ScopedTLBFlushBatch::flush()
+{
+    if (!m_start.is_null())
+        Processor::flush_tlb(&m_page_directory, m_start, (m_end.get() - m_start.get()) / PAGE_SIZE);
+    m_retained_vmobjects.clear();
+    m_retained_page_tables.clear();
+}
+
+}
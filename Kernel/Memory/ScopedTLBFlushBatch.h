@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Noncopyable.h>
+#include <AK/Vector.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Library/NonnullLockRefPtr.h>
+#include <Kernel/Memory/PhysicalPage.h>
+#include <Kernel/VirtualAddress.h>
+
+namespace Kernel::Memory {
+
+// Collects the TLB invalidations for a user page directory while it's in scope,
+// and performs them as a single shootdown when it goes out of scope.
+// NOTE: The batch is tracked per processor, so it must be created with interrupts disabled
+//       (e.g. while holding the address space lock), and must not outlive that section.
+class ScopedTLBFlushBatch {
+    AK_MAKE_NONCOPYABLE(ScopedTLBFlushBatch);
+    AK_MAKE_NONMOVABLE(ScopedTLBFlushBatch);
+
+public:
+    explicit ScopedTLBFlushBatch(PageDirectory const&);
+    ~ScopedTLBFlushBatch();
+
+    PageDirectory const& page_directory() const { return m_page_directory; }
+
+    void add(VirtualAddress, size_t page_count);
+    [[nodiscard]] bool add_and_retain(VirtualAddress, size_t page_count, VMObject&);
+    [[nodiscard]] bool add_and_retain_page_table(VirtualAddress, PhysicalPage&);
+
+private:
+    void flush();
+
+    PageDirectory const& m_page_directory;
+    ScopedTLBFlushBatch* m_previous_batch { nullptr };
+    VirtualAddress m_start;
+    VirtualAddress m_end;
+
+    // Unmapped memory must stay allocated until no processor can reach it through a stale TLB entry.
+    // The same goes for page tables, which processors may still walk through their paging-structure caches.
+    Vector<NonnullLockRefPtr<VMObject>> m_retained_vmobjects;
+    Vector<NonnullRefPtr<PhysicalPage>> m_retained_page_tables;
+};
+
+}
@@ -5,6 +5,7 @@
  */
 
 #include <Kernel/FileSystem/Inode.h>
+#include <Kernel/InterruptDisabler.h>
 #include <Kernel/Locking/Spinlock.h>
 #include <Kernel/Memory/SharedInodeVMObject.h>
 
@@ -51,22 +52,135 @@ SharedInodeVMObject::SharedInodeVMObject(SharedInodeVMObject const& other, Fixed
 
 ErrorOr<void> SharedInodeVMObject::sync(off_t offset_in_pages, size_t pages)
 {
-    SpinlockLocker locker(m_lock);
-
     size_t highest_page_to_flush = min(page_count(), offset_in_pages + pages);
+    u64 inode_size = m_inode->size();
+
+    Vector<size_t> dirty_page_indices;
+    {
+        SpinlockLocker locker(m_lock);
+        for (size_t page_index = offset_in_pages; page_index < highest_page_to_flush; ++page_index) {
+            if (!m_physical_pages[page_index] || !m_dirty_pages.get(page_index))
+                continue;
+            TRY(dirty_page_indices.try_append(page_index));
+            m_dirty_pages.set(page_index, false);
+        }
+        if (dirty_page_indices.is_empty())
+            return {};
+
+        // Write-protect the pages we're about to flush, so that any store racing with
+        // the writeback below marks the page dirty again instead of being lost.
+        for_each_region([](auto& region) {
+            if (region.is_mapped())
+                region.remap();
+        });
+    }
 
-    for (size_t page_index = offset_in_pages; page_index < highest_page_to_flush; ++page_index) {
-        auto& physical_page = m_physical_pages[page_index];
-        if (!physical_page)
+    for (size_t i = 0; i < dirty_page_indices.size(); ++i) {
+        auto page_index = dirty_page_indices[i];
+        u64 page_offset = static_cast<u64>(page_index) * PAGE_SIZE;
+        if (page_offset >= inode_size)
             continue;
 
         u8 page_buffer[PAGE_SIZE];
-        MM.copy_physical_page(*physical_page, page_buffer);
+        {
+            SpinlockLocker locker(m_lock);
+            auto& physical_page = m_physical_pages[page_index];
+            if (!physical_page)
+                continue;
+            MM.copy_physical_page(*physical_page, page_buffer);
+        }
 
-        TRY(m_inode->write_bytes(page_index * PAGE_SIZE, PAGE_SIZE, UserOrKernelBuffer::for_kernel_buffer(page_buffer), nullptr));
+        auto length = min<u64>(PAGE_SIZE, inode_size - page_offset);
+        auto result = m_inode->write_bytes_from_page_cache({}, page_offset, length, UserOrKernelBuffer::for_kernel_buffer(page_buffer));
+        if (result.is_error()) {
+            SpinlockLocker locker(m_lock);
+            for (size_t j = i; j < dirty_page_indices.size(); ++j)
+                m_dirty_pages.set(dirty_page_indices[j], true);
+            return result.release_error();
+        }
     }
 
     return {};
 }
 
+bool SharedInodeVMObject::read_page_if_resident(size_t page_index, u8 page_buffer[PAGE_SIZE])
+{
+    SpinlockLocker locker(m_lock);
+    VERIFY(page_index < page_count());
+    auto& physical_page = m_physical_pages[page_index];
+    if (!physical_page)
+        return false;
+    MM.copy_physical_page(*physical_page, page_buffer);
+    return true;
+}
+
+void SharedInodeVMObject::cache_page(size_t page_index, u8 const page_buffer[PAGE_SIZE])
+{
+    VERIFY(page_index < page_count());
+
+    // NOTE: Failing to populate the cache is not an error, the next access will simply miss again.
+    auto physical_page_or_error = MM.allocate_physical_page(MemoryManager::ShouldZeroFill::No);
+    if (physical_page_or_error.is_error())
+        return;
+    auto physical_page = physical_page_or_error.release_value();
+    {
+        InterruptDisabler disabler;
+        u8* dest_ptr = MM.quickmap_page(*physical_page);
+        memcpy(dest_ptr, page_buffer, PAGE_SIZE);
+        MM.unquickmap_page();
+    }
+
+    SpinlockLocker locker(m_lock);
+    auto& physical_page_slot = m_physical_pages[page_index];
+    if (physical_page_slot)
+        return;
+    // NOTE: Regions have no mapping for an empty slot, so the next page fault will pick this page up.
+    physical_page_slot = move(physical_page);
+}
+
+void SharedInodeVMObject::update_resident_page(size_t page_index, size_t offset_in_page, ReadonlyBytes data)
+{
+    VERIFY(page_index < page_count());
+    VERIFY(offset_in_page + data.size() <= PAGE_SIZE);
+
+    SpinlockLocker locker(m_lock);
+    auto& physical_page = m_physical_pages[page_index];
+    if (!physical_page)
+        return;
+    u8* dest_ptr = MM.quickmap_page(*physical_page);
+    memcpy(dest_ptr + offset_in_page, data.data(), data.size());
+    MM.unquickmap_page();
+}
+
+void SharedInodeVMObject::discard_pages_beyond(u64 size)
+{
+    SpinlockLocker locker(m_lock);
+
+    size_t first_discarded_page = ceil_div(size, static_cast<u64>(PAGE_SIZE));
+    bool did_discard = false;
+    for (size_t page_index = first_discarded_page; page_index < page_count(); ++page_index) {
+        if (!m_physical_pages[page_index])
+            continue;
+        m_physical_pages[page_index] = nullptr;
+        m_dirty_pages.set(page_index, false);
+        did_discard = true;
+    }
+
+    // Zero the tail of the last page so a later extension of the file doesn't resurrect stale data.
+    size_t offset_in_last_page = size % PAGE_SIZE;
+    size_t last_page = size / PAGE_SIZE;
+    if (offset_in_last_page != 0 && last_page < page_count() && m_physical_pages[last_page]) {
+        u8* dest_ptr = MM.quickmap_page(*m_physical_pages[last_page]);
+        memset(dest_ptr + offset_in_last_page, 0, PAGE_SIZE - offset_in_last_page);
+        MM.unquickmap_page();
+    }
+
+    if (did_discard) {
+        for_each_region([](auto& region) {
+            if (region.is_mapped())
+                region.remap();
+        });
+    }
+}
+
 }
@@ -21,6 +21,13 @@ public:
 
     ErrorOr<void> sync(off_t offset_in_pages = 0, size_t pages = -1);
 
+    // NOTE: These let Inode::read_bytes() and Inode::write_bytes() share the resident pages
+    //       of this VMObject as the inode's page cache, keeping read()/write() coherent with mmap().
+    bool read_page_if_resident(size_t page_index, u8 page_buffer[PAGE_SIZE]);
+    void cache_page(size_t page_index, u8 const page_buffer[PAGE_SIZE]);
+    void update_resident_page(size_t page_index, size_t offset_in_page, ReadonlyBytes);
+    void discard_pages_beyond(u64 size);
+
 private:
     virtual bool is_shared_inode() const override { return true; }
 
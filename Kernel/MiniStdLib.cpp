@@ -79,19 +79,48 @@ void* memset(void* dest_ptr, int c, size_t n)
     return dest_ptr;
 }
 
+// Note: The kernel doesn't touch the SIMD registers, so the routines below look at a whole word at a time instead.
+static constexpr FlatPtr low_bit_of_each_byte = explode_byte(0x01);
+static constexpr FlatPtr high_bit_of_each_byte = explode_byte(0x80);
+
+static ALWAYS_INLINE bool has_zero_byte(FlatPtr word)
+{
+    return ((word - low_bit_of_each_byte) & ~word & high_bit_of_each_byte) != 0;
+}
+
+static ALWAYS_INLINE FlatPtr load_word(void const* ptr)
+{
+    FlatPtr word;
+    __builtin_memcpy(&word, ptr, sizeof(word));
+    return word;
+}
+
 size_t strlen(char const* str)
 {
-    size_t len = 0;
-    while (*(str++))
-        ++len;
-    return len;
+    // Go byte by byte until we're aligned, so none of the word loads can cross into the next page.
+    char const* ptr = str;
+    for (; (FlatPtr)ptr % sizeof(FlatPtr) != 0; ++ptr) {
+        if (*ptr == 0)
+            return ptr - str;
+    }
+    while (!has_zero_byte(load_word(ptr)))
+        ptr += sizeof(FlatPtr);
+    while (*ptr)
+        ++ptr;
+    return ptr - str;
 }
 
 size_t strnlen(char const* str, size_t maxlen)
 {
     size_t len = 0;
-    for (; len < maxlen && *str; str++)
-        len++;
+    for (; len < maxlen && (FlatPtr)(str + len) % sizeof(FlatPtr) != 0; ++len) {
+        if (str[len] == 0)
+            return len;
+    }
+    while (maxlen - len >= sizeof(FlatPtr) && !has_zero_byte(load_word(str + len)))
+        len += sizeof(FlatPtr);
+    for (; len < maxlen && str[len]; ++len)
+        ;
     return len;
 }
 
@@ -108,6 +137,12 @@ int memcmp(void const* v1, void const* v2, size_t n)
 {
     auto const* s1 = (u8 const*)v1;
     auto const* s2 = (u8 const*)v2;
+    // Skip over the words that are equal, and leave finding the differing byte to the loop below.
+    while (n >= sizeof(FlatPtr) && load_word(s1) == load_word(s2)) {
+        s1 += sizeof(FlatPtr);
+        s2 += sizeof(FlatPtr);
+        n -= sizeof(FlatPtr);
+    }
     while (n-- > 0) {
         if (*s1++ != *s2++)
             return s1[-1] < s2[-1] ? -1 : 1;
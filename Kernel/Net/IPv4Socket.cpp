@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ScopeGuard.h>
 #include <AK/Singleton.h>
 #include <AK/StringBuilder.h>
 #include <Kernel/API/Ioctl.h>
@@ -37,7 +38,7 @@ MutexProtected<IPv4Socket::List>& IPv4Socket::all_sockets()
 
 ErrorOr<NonnullOwnPtr<DoubleBuffer>> IPv4Socket::try_create_receive_buffer()
 {
-    return DoubleBuffer::try_create("IPv4Socket: Receive buffer"sv, 256 * KiB);
+    return DoubleBuffer::try_create("IPv4Socket: Receive buffer"sv, receive_buffer_size);
 }
 
 ErrorOr<NonnullLockRefPtr<Socket>> IPv4Socket::create(int type, int protocol)
@@ -288,40 +289,13 @@ ErrorOr<size_t> IPv4Socket::receive_byte_buffered(OpenFileDescription& descripti
 ErrorOr<size_t> IPv4Socket::receive_packet_buffered(OpenFileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*> addr, Userspace<socklen_t*> addr_length, Time& packet_timestamp, bool blocking)
 {
     MutexLocker locker(mutex());
-    ReceivedPacket taken_packet;
-    ReceivedPacket* packet { nullptr };
-    {
-        if (m_receive_queue.is_empty()) {
-            // FIXME: Shouldn't this return ENOTCONN instead of EOF?
-            //        But if so, we still need to deliver at least one EOF read to userspace.. right?
-            if (protocol_is_disconnected())
-                return 0;
-            if (!blocking)
-                return set_so_error(EAGAIN);
-        }
-
-        if (!m_receive_queue.is_empty()) {
-            if (flags & MSG_PEEK) {
-                packet = &m_receive_queue.first();
-            } else {
-                taken_packet = m_receive_queue.take_first();
-                packet = &taken_packet;
-            }
-
-            set_can_read(!m_receive_queue.is_empty());
-
-            dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}): recvfrom without blocking {} bytes, packets in queue: {}",
-                this,
-                packet->data->size(),
-                m_receive_queue.size());
-        }
-    }
-
-    if (!packet) {
-        if (protocol_is_disconnected()) {
-            dbgln("IPv4Socket({}) is protocol-disconnected, returning 0 in recvfrom!", this);
+    if (m_receive_queue.is_empty()) {
+        // FIXME: Shouldn't this return ENOTCONN instead of EOF?
+        //        But if so, we still need to deliver at least one EOF read to userspace.. right?
+        if (protocol_is_disconnected())
             return 0;
-        }
+        if (!blocking)
+            return set_so_error(EAGAIN);
 
         locker.unlock();
         auto unblocked_flags = BlockFlags::None;
@@ -337,31 +311,29 @@ ErrorOr<size_t> IPv4Socket::receive_packet_buffered(OpenFileDescription& descrip
         }
         VERIFY(m_can_read);
         VERIFY(!m_receive_queue.is_empty());
+    }
 
-        if (flags & MSG_PEEK) {
-            packet = &m_receive_queue.first();
-        } else {
-            taken_packet = m_receive_queue.take_first();
-            packet = &taken_packet;
-        }
-
+    // The packet's data lives in the receive queue, so it's only dequeued once it has been copied out.
+    auto packet = m_receive_queue.first();
+    ScopeGuard dequeue_packet = [&] {
+        if (!(flags & MSG_PEEK))
+            m_receive_queue.dequeue();
         set_can_read(!m_receive_queue.is_empty());
+    };
 
-        dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}): recvfrom with blocking {} bytes, packets in queue: {}",
-            this,
-            packet->data->size(),
-            m_receive_queue.size());
-    }
-    VERIFY(packet->data);
+    dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}): recvfrom {} bytes, packets in queue: {}",
+        this,
+        packet.data.size(),
+        m_receive_queue.count());
 
-    packet_timestamp = packet->timestamp;
+    packet_timestamp = packet.timestamp;
 
     if (addr) {
-        dbgln_if(IPV4_SOCKET_DEBUG, "Incoming packet is from: {}:{}", packet->peer_address, packet->peer_port);
+        dbgln_if(IPV4_SOCKET_DEBUG, "Incoming packet is from: {}:{}", packet.peer_address, packet.peer_port);
 
         sockaddr_in out_addr {};
-        memcpy(&out_addr.sin_addr, &packet->peer_address, sizeof(IPv4Address));
-        out_addr.sin_port = htons(packet->peer_port);
+        memcpy(&out_addr.sin_addr, &packet.peer_address, sizeof(IPv4Address));
+        out_addr.sin_port = htons(packet.peer_port);
         out_addr.sin_family = AF_INET;
         Userspace<sockaddr_in*> dest_addr = addr.ptr();
         SOCKET_TRY(copy_to_user(dest_addr, &out_addr));
@@ -372,12 +344,12 @@ ErrorOr<size_t> IPv4Socket::receive_packet_buffered(OpenFileDescription& descrip
     }
 
     if (type() == SOCK_RAW) {
-        size_t bytes_written = min(packet->data->size(), buffer_length);
-        SOCKET_TRY(buffer.write(packet->data->data(), bytes_written));
+        size_t bytes_written = min(packet.data.size(), buffer_length);
+        SOCKET_TRY(buffer.write(packet.data.data(), bytes_written));
         return bytes_written;
     }
 
-    return protocol_receive(packet->data->bytes(), buffer, buffer_length, flags);
+    return protocol_receive(packet.data, buffer, buffer_length, flags);
 }
 
 ErrorOr<size_t> IPv4Socket::recvfrom(OpenFileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*> user_addr, Userspace<socklen_t*> user_addr_length, Time& packet_timestamp, bool blocking)
@@ -440,18 +412,8 @@ bool IPv4Socket::did_receive(IPv4Address const& source_address, u16 source_port,
             return false;
         set_can_read(!m_receive_buffer->is_empty());
     } else {
-        if (m_receive_queue.size() > 2000) {
-            dbgln("IPv4Socket({}): did_receive refusing packet since queue is full.", this);
-            return false;
-        }
-        auto data_or_error = KBuffer::try_create_with_bytes("IPv4Socket: Packet buffer"sv, packet);
-        if (data_or_error.is_error()) {
-            dbgln("IPv4Socket: did_receive unable to allocate storage for incoming packet.");
-            return false;
-        }
-        auto result = m_receive_queue.try_append({ source_address, source_port, packet_timestamp, data_or_error.release_value() });
-        if (result.is_error()) {
-            dbgln("IPv4Socket: Dropped incoming packet because appending to the receive queue failed.");
+        if (auto result = m_receive_queue.try_enqueue(source_address, source_port, packet_timestamp, packet); result.is_error()) {
+            dbgln("IPv4Socket({}): did_receive dropping packet: {}", this, result.error());
             return false;
         }
         set_can_read(true);
@@ -466,7 +428,7 @@ bool IPv4Socket::did_receive(IPv4Address const& source_address, u16 source_port,
                 this,
                 packet_size,
                 m_bytes_received,
-                m_receive_queue.size());
+                m_receive_queue.count());
     }
 
     return true;
@@ -506,6 +468,18 @@ ErrorOr<NonnullOwnPtr<KString>> IPv4Socket::pseudo_path(OpenFileDescription cons
 
 ErrorOr<void> IPv4Socket::setsockopt(int level, int option, Userspace<void const*> user_value, socklen_t user_value_size)
 {
+    if (level == SOL_SOCKET && option == SO_RCVBUF) {
+        if (user_value_size < sizeof(int))
+            return EINVAL;
+        int value;
+        TRY(copy_from_user(&value, static_ptr_cast<int const*>(user_value)));
+        if (value < 0)
+            return EINVAL;
+        // NOTE: Only the packet queue can be resized, the receive buffer of byte streams (and with it the TCP window) is fixed.
+        MutexLocker locker(mutex());
+        m_receive_queue.set_capacity(clamp(static_cast<size_t>(value), minimum_receive_queue_size, maximum_receive_queue_size));
+        return {};
+    }
     if (level != IPPROTO_IP)
         return Socket::setsockopt(level, option, user_value, user_value_size);
 
@@ -572,6 +546,17 @@ ErrorOr<void> IPv4Socket::setsockopt(int level, int option, Userspace<void const
 
 ErrorOr<void> IPv4Socket::getsockopt(OpenFileDescription& description, int level, int option, Userspace<void*> value, Userspace<socklen_t*> value_size)
 {
+    if (level == SOL_SOCKET && option == SO_RCVBUF) {
+        socklen_t size;
+        TRY(copy_from_user(&size, value_size.unsafe_userspace_ptr()));
+        if (size < sizeof(int))
+            return EINVAL;
+        MutexLocker locker(mutex());
+        int buffer_size = buffer_mode() == BufferMode::Bytes ? receive_buffer_size : m_receive_queue.capacity();
+        TRY(copy_to_user(static_ptr_cast<int*>(value), &buffer_size));
+        size = sizeof(int);
+        return copy_to_user(value_size, &size);
+    }
     if (level != IPPROTO_IP)
         return Socket::getsockopt(description, level, option, value, value_size);
 
@@ -815,8 +800,8 @@ ErrorOr<void> IPv4Socket::ioctl(OpenFileDescription&, unsigned request, Userspac
         if (buffer_mode() == BufferMode::Bytes) {
             readable = static_cast<int>(m_receive_buffer->immediately_readable());
         } else {
-            if (m_receive_queue.size() != 0u) {
-                readable = static_cast<int>(TRY(protocol_size(m_receive_queue.first().data->bytes())));
+            if (!m_receive_queue.is_empty()) {
+                readable = static_cast<int>(TRY(protocol_size(m_receive_queue.first().data)));
             }
         }
 
@@ -7,12 +7,12 @@
 #pragma once
 
 #include <AK/HashMap.h>
-#include <AK/SinglyLinkedList.h>
 #include <Kernel/DoubleBuffer.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/Locking/MutexProtected.h>
 #include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/IPv4SocketTuple.h>
+#include <Kernel/Net/ReceivedPacketQueue.h>
 #include <Kernel/Net/Socket.h>
 
 namespace Kernel {
@@ -92,6 +92,10 @@ protected:
     void set_local_address(IPv4Address address) { m_local_address = address; }
     void set_peer_address(IPv4Address address) { m_peer_address = address; }
 
+    static constexpr size_t receive_buffer_size = 256 * KiB;
+    // The bounds for the SO_RCVBUF size of the packet queue.
+    static constexpr size_t minimum_receive_queue_size = 4 * KiB;
+    static constexpr size_t maximum_receive_queue_size = 4 * MiB;
     static ErrorOr<NonnullOwnPtr<DoubleBuffer>> try_create_receive_buffer();
     void drop_receive_buffer();
 
@@ -109,14 +113,8 @@ private:
     Vector<IPv4Address> m_multicast_memberships;
     bool m_multicast_loop { true };
 
-    struct ReceivedPacket {
-        IPv4Address peer_address;
-        u16 peer_port;
-        Time timestamp;
-        OwnPtr<KBuffer> data;
-    };
-
-    SinglyLinkedList<ReceivedPacket, CountingSizeCalculationPolicy> m_receive_queue;
+    // Used in packet buffer mode, its capacity is the SO_RCVBUF size.
+    ReceivedPacketQueue m_receive_queue { receive_buffer_size };
 
     OwnPtr<DoubleBuffer> m_receive_buffer;
 
@@ -7,9 +7,13 @@
 #include <AK/MACAddress.h>
 #include <Kernel/Bus/PCI/API.h>
 #include <Kernel/Bus/PCI/IDs.h>
+#include <Kernel/CommandLine.h>
 #include <Kernel/Debug.h>
+#include <Kernel/Net/EthernetFrameHeader.h>
+#include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/Intel/E1000NetworkAdapter.h>
 #include <Kernel/Net/NetworkingManagement.h>
+#include <Kernel/Net/TCP.h>
 #include <Kernel/Sections.h>
 
 namespace Kernel {
@@ -39,6 +43,7 @@ namespace Kernel {
 #define REG_RADV 0x282C             // RX Int. Absolute Delay Timer
 #define REG_RSRPD 0x2C00            // RX Small Packet Detect Interrupt
 #define REG_TIPG 0x0410             // Transmit Inter Packet Gap
+#define REG_RXCSUM 0x5000           // RX Checksum Control
 #define ECTRL_SLU 0x40              // set link up
 #define RCTL_EN (1 << 1)            // Receiver Enable
 #define RCTL_SBP (1 << 2)           // Store Bad Packets
@@ -90,6 +95,26 @@ namespace Kernel {
 #define TCTL_SWXOFF (1 << 22) // Software XOFF Transmission
 #define TCTL_RTLC (1 << 24)   // Re-transmit on Late Collision
 
+// Extended TX descriptors, see section 3.3.6 and 3.3.7 of the manual
+#define TXD_DTYP_CONTEXT (0 << 20)
+#define TXD_DTYP_DATA (1 << 20)
+#define TXD_CMD_EOP (1 << 24)  // End of Packet
+#define TXD_CMD_IFCS (1 << 25) // Insert FCS
+#define TXD_CMD_TCP (1 << 24)  // Context: Packet is TCP
+#define TXD_CMD_IP (1 << 25)   // Context: Packet is IPv4
+#define TXD_CMD_TSE (1 << 26)  // TCP Segmentation Enable
+#define TXD_CMD_RS (1 << 27)   // Report Status
+#define TXD_CMD_DEXT (1 << 29) // Descriptor Extension
+#define TXD_POPTS_IXSM (1 << 0) // Insert IP Checksum
+#define TXD_POPTS_TXSM (1 << 1) // Insert TCP/UDP Checksum
+
+#define RXCSUM_IPOFL (1 << 8) // IP Checksum Off-load Enable
+#define RXCSUM_TUOFL (1 << 9) // TCP/UDP Checksum Off-load Enable
+
+#define RSTA_IXSM (1 << 2) // Ignore Checksum Indication
+#define RERR_TCPE (1 << 5) // TCP/UDP Checksum Error
+#define RERR_IPE (1 << 6)  // IP Checksum Error
+
 #define TSTA_DD (1 << 0) // Descriptor Done
 #define TSTA_EC (1 << 1) // Excess Collisions
 #define TSTA_LC (1 << 2) // Late Collision
@@ -172,6 +197,7 @@ UNMAP_AFTER_INIT ErrorOr<NonnullLockRefPtr<NetworkAdapter>> E1000NetworkAdapter:
     auto interface_name = TRY(NetworkingManagement::generate_interface_name_from_pci_address(pci_device_identifier));
     auto registers_io_window = TRY(IOWindow::create_for_pci_device_bar(pci_device_identifier, PCI::HeaderType0BaseRegister::BAR0));
 
+    auto number_of_rx_descriptors = rx_descriptor_count();
     auto rx_buffer_region = TRY(MM.allocate_contiguous_kernel_region(rx_buffer_size * number_of_rx_descriptors, "E1000 RX buffers"sv, Memory::Region::Access::ReadWrite));
     auto tx_buffer_region = MM.allocate_contiguous_kernel_region(tx_buffer_size * number_of_tx_descriptors, "E1000 TX buffers"sv, Memory::Region::Access::ReadWrite).release_value();
     auto rx_descriptors_region = TRY(MM.allocate_contiguous_kernel_region(TRY(Memory::page_round_up(sizeof(e1000_rx_desc) * number_of_rx_descriptors)), "E1000 RX Descriptors"sv, Memory::Region::Access::ReadWrite));
@@ -186,6 +212,13 @@ UNMAP_AFTER_INIT ErrorOr<NonnullLockRefPtr<NetworkAdapter>> E1000NetworkAdapter:
         move(interface_name))));
 }
 
+UNMAP_AFTER_INIT size_t E1000NetworkAdapter::rx_descriptor_count()
+{
+    // NOTE: The size of the descriptor ring has to be a multiple of 128 bytes, i.e. of 8 descriptors.
+    auto count = kernel_command_line().network_rx_descriptor_count().value_or(default_number_of_rx_descriptors);
+    return align_up_to(clamp<size_t>(count, 64, 4096), 8);
+}
+
 UNMAP_AFTER_INIT ErrorOr<void> E1000NetworkAdapter::initialize(Badge<NetworkingManagement>)
 {
     dmesgln_pci(*this, "Found @ {}", device_identifier().address());
@@ -205,6 +238,7 @@ UNMAP_AFTER_INIT ErrorOr<void> E1000NetworkAdapter::initialize(Badge<NetworkingM
 
     setup_link();
     setup_interrupts();
+    setup_offloads();
 
     m_link_up = ((in32(REG_STATUS) & STATUS_LU) != 0);
 
@@ -217,14 +251,31 @@ UNMAP_AFTER_INIT void E1000NetworkAdapter::setup_link()
     out32(REG_CTRL, flags | ECTRL_SLU);
 }
 
+// Limits for the interrupt rate, in units of 256 nanoseconds between interrupts. end_receive_polling() switches between
+// them depending on how busy the adapter is.
+static constexpr u32 low_latency_interrupt_interval = 195;  // ~20000 interrupts per second
+static constexpr u32 moderate_interrupt_interval = 488;     // ~8000 interrupts per second
+static constexpr u32 bulk_interrupt_interval = 976;         // ~4000 interrupts per second
+
+static constexpr u32 receive_interrupts = INTERRUPT_RXT0 | INTERRUPT_RXO;
+
 UNMAP_AFTER_INIT void E1000NetworkAdapter::setup_interrupts()
 {
-    out32(REG_INTERRUPT_RATE, 6000); // Interrupt rate of 1.536 milliseconds
-    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | INTERRUPT_RXT0 | INTERRUPT_RXO);
+    m_interrupt_throttling_interval = low_latency_interrupt_interval;
+    out32(REG_INTERRUPT_RATE, m_interrupt_throttling_interval);
+    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | receive_interrupts);
     in32(REG_INTERRUPT_CAUSE_READ);
     enable_irq();
 }
 
+UNMAP_AFTER_INIT void E1000NetworkAdapter::setup_offloads()
+{
+    out32(REG_RXCSUM, in32(REG_RXCSUM) | RXCSUM_IPOFL | RXCSUM_TUOFL);
+    // NOTE: A TCP segmentation job can cover a whole IPv4 packet, which the controller then cuts into MTU-sized frames.
+    set_offloads(NetworkOffload::TransmitTCPChecksum | NetworkOffload::ReceiveChecksum | NetworkOffload::TCPSegmentation,
+        NumericLimits<u16>::max() + sizeof(EthernetFrameHeader));
+}
+
 UNMAP_AFTER_INIT E1000NetworkAdapter::E1000NetworkAdapter(PCI::DeviceIdentifier const& device_identifier, u8 irq,
     NonnullOwnPtr<IOWindow> registers_io_window, NonnullOwnPtr<Memory::Region> rx_buffer_region,
     NonnullOwnPtr<Memory::Region> tx_buffer_region, NonnullOwnPtr<Memory::Region> rx_descriptors_region,
@@ -237,6 +288,7 @@ UNMAP_AFTER_INIT E1000NetworkAdapter::E1000NetworkAdapter(PCI::DeviceIdentifier
     , m_tx_descriptors_region(move(tx_descriptors_region))
     , m_rx_buffer_region(move(rx_buffer_region))
     , m_tx_buffer_region(move(tx_buffer_region))
+    , m_rx_descriptor_count(m_rx_buffer_region->size() / rx_buffer_size)
 {
 }
 
@@ -263,8 +315,9 @@ bool E1000NetworkAdapter::handle_irq(RegisterState const&)
     if (status & INTERRUPT_RXO) {
         dbgln_if(E1000_DEBUG, "E1000: RX buffer overrun");
     }
-    if (status & INTERRUPT_RXT0) {
-        receive();
+    if (status & receive_interrupts) {
+        out32(REG_INTERRUPT_MASK_CLEAR, receive_interrupts);
+        schedule_receive_poll();
     }
 
     m_wait_queue.wake_all();
@@ -325,32 +378,30 @@ UNMAP_AFTER_INIT void E1000NetworkAdapter::read_mac_address()
 UNMAP_AFTER_INIT void E1000NetworkAdapter::initialize_rx_descriptors()
 {
     auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
-    constexpr auto rx_buffer_page_count = rx_buffer_size / PAGE_SIZE;
-    for (size_t i = 0; i < number_of_rx_descriptors; ++i) {
+    for (size_t i = 0; i < m_rx_descriptor_count; ++i) {
         auto& descriptor = rx_descriptors[i];
-        m_rx_buffers[i] = m_rx_buffer_region->vaddr().as_ptr() + rx_buffer_size * i;
-        descriptor.addr = m_rx_buffer_region->physical_page(rx_buffer_page_count * i)->paddr().get();
+        auto buffer_offset = rx_buffer_size * i;
+        descriptor.addr = m_rx_buffer_region->physical_page(buffer_offset / PAGE_SIZE)->paddr().offset(buffer_offset % PAGE_SIZE).get();
         descriptor.status = 0;
     }
 
     out32(REG_RXDESCLO, m_rx_descriptors_region->physical_page(0)->paddr().get());
     out32(REG_RXDESCHI, 0);
-    out32(REG_RXDESCLEN, number_of_rx_descriptors * sizeof(e1000_rx_desc));
+    out32(REG_RXDESCLEN, m_rx_descriptor_count * sizeof(e1000_rx_desc));
     out32(REG_RXDESCHEAD, 0);
-    out32(REG_RXDESCTAIL, number_of_rx_descriptors - 1);
+    out32(REG_RXDESCTAIL, m_rx_descriptor_count - 1);
 
-    out32(REG_RCTRL, RCTL_EN | RCTL_SBP | RCTL_UPE | RCTL_MPE | RCTL_LBM_NONE | RTCL_RDMTS_HALF | RCTL_BAM | RCTL_SECRC | RCTL_BSIZE_8192);
+    out32(REG_RCTRL, RCTL_EN | RCTL_SBP | RCTL_UPE | RCTL_MPE | RCTL_LBM_NONE | RTCL_RDMTS_HALF | RCTL_BAM | RCTL_SECRC | RCTL_BSIZE_2048);
 }
 
 UNMAP_AFTER_INIT void E1000NetworkAdapter::initialize_tx_descriptors()
 {
     auto* tx_descriptors = (e1000_tx_desc*)m_tx_descriptors_region->vaddr().as_ptr();
-    constexpr auto tx_buffer_page_count = tx_buffer_size / PAGE_SIZE;
 
     for (size_t i = 0; i < number_of_tx_descriptors; ++i) {
         auto& descriptor = tx_descriptors[i];
         m_tx_buffers[i] = m_tx_buffer_region->vaddr().as_ptr() + tx_buffer_size * i;
-        descriptor.addr = m_tx_buffer_region->physical_page(tx_buffer_page_count * i)->paddr().get();
+        descriptor.addr = tx_buffer_physical_address(i).get();
         descriptor.cmd = 0;
     }
 
@@ -400,51 +451,160 @@ u32 E1000NetworkAdapter::in32(u16 address)
     return m_registers_io_window->read32(address);
 }
 
+PhysicalAddress E1000NetworkAdapter::tx_buffer_physical_address(size_t index) const
+{
+    constexpr auto tx_buffer_page_count = tx_buffer_size / PAGE_SIZE;
+    return m_tx_buffer_region->physical_page(tx_buffer_page_count * index)->paddr();
+}
+
 void E1000NetworkAdapter::send_raw(ReadonlyBytes payload)
 {
+    transmit(payload, nullptr);
+}
+
+void E1000NetworkAdapter::send_raw_with_offload(ReadonlyBytes payload, TransmitOffload const& offload)
+{
+    transmit(payload, &offload);
+}
+
+void E1000NetworkAdapter::transmit(ReadonlyBytes payload, TransmitOffload const* offload)
+{
+    MutexLocker locker(m_tx_lock);
     disable_irq();
     size_t tx_current = in32(REG_TXDESCTAIL) % number_of_tx_descriptors;
     dbgln_if(E1000_DEBUG, "E1000: Sending packet ({} bytes)", payload.size());
     auto* tx_descriptors = (e1000_tx_desc*)m_tx_descriptors_region->vaddr().as_ptr();
-    auto& descriptor = tx_descriptors[tx_current];
-    VERIFY(payload.size() <= 8192);
-    auto* vptr = (void*)m_tx_buffers[tx_current];
-    memcpy(vptr, payload.data(), payload.size());
-    descriptor.length = payload.size();
-    descriptor.status = 0;
-    descriptor.cmd = CMD_EOP | CMD_IFCS | CMD_RS;
-    dbgln_if(E1000_DEBUG, "E1000: Using tx descriptor {} (head is at {})", tx_current, in32(REG_TXDESCHEAD));
-    tx_current = (tx_current + 1) % number_of_tx_descriptors;
+
+    u8 data_options = 0;
+    u32 data_command = 0;
+    if (offload) {
+        constexpr size_t ipv4_checksum_offset = 10;
+        constexpr size_t tcp_checksum_offset = 16;
+        VERIFY(payload.size() <= max_segmentation_frame_size());
+        VERIFY(payload.size() >= sizeof(EthernetFrameHeader) + sizeof(IPv4Packet));
+        auto const& ipv4_packet = *reinterpret_cast<IPv4Packet const*>(payload.offset(sizeof(EthernetFrameHeader)));
+        size_t ip_header_start = sizeof(EthernetFrameHeader);
+        size_t tcp_header_start = ip_header_start + ipv4_packet.internet_header_length() * sizeof(u32);
+        VERIFY(payload.size() >= tcp_header_start + sizeof(TCPPacket));
+        auto const& tcp_packet = *reinterpret_cast<TCPPacket const*>(payload.offset(tcp_header_start));
+        size_t headers_size = tcp_header_start + tcp_packet.header_size();
+
+        // NOTE: The context descriptor takes the place of a regular descriptor in the ring and overwrites its buffer address.
+        auto& context = *reinterpret_cast<e1000_tx_context_desc*>(&tx_descriptors[tx_current]);
+        context.ipcss = ip_header_start;
+        context.ipcso = ip_header_start + ipv4_checksum_offset;
+        context.ipcse = tcp_header_start - 1;
+        context.tucss = tcp_header_start;
+        context.tucso = tcp_header_start + tcp_checksum_offset;
+        context.tucse = 0;
+        context.status = 0;
+        u32 context_command = TXD_DTYP_CONTEXT | TXD_CMD_DEXT | TXD_CMD_IP | TXD_CMD_TCP;
+        data_options = TXD_POPTS_TXSM;
+        if (offload->tcp_segment_size != 0) {
+            context_command |= TXD_CMD_TSE | (payload.size() - headers_size);
+            context.hdrlen = headers_size;
+            context.mss = offload->tcp_segment_size;
+            // Every segment gets its own IP header, so the controller fills in the length and checksum.
+            data_options |= TXD_POPTS_IXSM;
+            data_command |= TXD_CMD_TSE;
+        } else {
+            context.hdrlen = 0;
+            context.mss = 0;
+        }
+        context.paylen_and_command = context_command;
+        tx_current = (tx_current + 1) % number_of_tx_descriptors;
+    } else {
+        VERIFY(payload.size() <= tx_buffer_size);
+    }
+
+    size_t last_descriptor_index = tx_current;
+    for (size_t offset = 0; offset < payload.size(); offset += tx_buffer_size) {
+        auto chunk = payload.slice(offset, min(tx_buffer_size, payload.size() - offset));
+        bool is_last_chunk = offset + chunk.size() == payload.size();
+        memcpy(m_tx_buffers[tx_current], chunk.data(), chunk.size());
+        if (offload) {
+            if (offset == 0 && offload->tcp_segment_size != 0) {
+                auto& ipv4_packet = *reinterpret_cast<IPv4Packet*>((u8*)m_tx_buffers[tx_current] + sizeof(EthernetFrameHeader));
+                ipv4_packet.set_length(0);
+                ipv4_packet.set_checksum(0);
+            }
+            auto& descriptor = *reinterpret_cast<e1000_tx_data_desc*>(&tx_descriptors[tx_current]);
+            descriptor.addr = tx_buffer_physical_address(tx_current).get();
+            descriptor.status = 0;
+            descriptor.popts = data_options;
+            u32 command = TXD_DTYP_DATA | TXD_CMD_DEXT | TXD_CMD_IFCS | data_command | chunk.size();
+            if (is_last_chunk)
+                command |= TXD_CMD_EOP | TXD_CMD_RS;
+            descriptor.length_and_command = command;
+        } else {
+            auto& descriptor = tx_descriptors[tx_current];
+            descriptor.addr = tx_buffer_physical_address(tx_current).get();
+            descriptor.length = chunk.size();
+            descriptor.cso = 0;
+            descriptor.css = 0;
+            descriptor.status = 0;
+            descriptor.cmd = CMD_EOP | CMD_IFCS | CMD_RS;
+        }
+        dbgln_if(E1000_DEBUG, "E1000: Using tx descriptor {} (head is at {})", tx_current, in32(REG_TXDESCHEAD));
+        last_descriptor_index = tx_current;
+        tx_current = (tx_current + 1) % number_of_tx_descriptors;
+    }
+
+    auto& last_descriptor = tx_descriptors[last_descriptor_index];
     Processor::disable_interrupts();
     enable_irq();
     out32(REG_TXDESCTAIL, tx_current);
     for (;;) {
-        if (descriptor.status) {
+        if (last_descriptor.status) {
             Processor::enable_interrupts();
             break;
         }
         m_wait_queue.wait_forever("E1000NetworkAdapter"sv);
     }
-    dbgln_if(E1000_DEBUG, "E1000: Sent packet, status is now {:#02x}!", (u8)descriptor.status);
+    dbgln_if(E1000_DEBUG, "E1000: Sent packet, status is now {:#02x}!", (u8)last_descriptor.status);
 }
 
-void E1000NetworkAdapter::receive()
+size_t E1000NetworkAdapter::poll_rx_ring(size_t budget)
 {
-    auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
-    u32 rx_current;
-    for (;;) {
-        rx_current = in32(REG_RXDESCTAIL) % number_of_rx_descriptors;
-        rx_current = (rx_current + 1) % number_of_rx_descriptors;
+    auto* rx_descriptors = (e1000_rx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
+    auto rx_tail = in32(REG_RXDESCTAIL) % m_rx_descriptor_count;
+    size_t packet_count = 0;
+    for (; packet_count < budget; ++packet_count) {
+        auto rx_current = (rx_tail + 1) % m_rx_descriptor_count;
         if (!(rx_descriptors[rx_current].status & 1))
             break;
-        auto* buffer = m_rx_buffers[rx_current];
+        auto* buffer = m_rx_buffer_region->vaddr().as_ptr() + rx_buffer_size * rx_current;
         u16 length = rx_descriptors[rx_current].length;
-        VERIFY(length <= 8192);
+        VERIFY(length <= rx_buffer_size);
         dbgln_if(E1000_DEBUG, "E1000: Received 1 packet @ {:p} ({} bytes)", buffer, length);
-        did_receive({ buffer, length });
+        bool checksum_failed = !(rx_descriptors[rx_current].status & RSTA_IXSM) && (rx_descriptors[rx_current].errors & (RERR_TCPE | RERR_IPE));
+        if (checksum_failed)
+            dbgln_if(E1000_DEBUG, "E1000: Dropping packet with a bad checksum");
+        else
+            did_receive({ buffer, length });
         rx_descriptors[rx_current].status = 0;
-        out32(REG_RXDESCTAIL, rx_current);
+        rx_tail = rx_current;
+    }
+    // NOTE: The descriptors are handed back to the adapter all at once, which saves a register write for every packet.
+    if (packet_count > 0)
+        out32(REG_RXDESCTAIL, rx_tail);
+    return packet_count;
+}
+
+void E1000NetworkAdapter::end_receive_polling(size_t packet_count)
+{
+    // Few packets per interrupt mean that someone is waiting for each of them, many mean that throughput matters more.
+    u32 interval = moderate_interrupt_interval;
+    if (packet_count <= 4)
+        interval = low_latency_interrupt_interval;
+    else if (packet_count >= receive_poll_budget)
+        interval = bulk_interrupt_interval;
+    if (interval != m_interrupt_throttling_interval) {
+        dbgln_if(E1000_DEBUG, "E1000: Changing the interrupt throttling interval to {}", interval);
+        m_interrupt_throttling_interval = interval;
+        out32(REG_INTERRUPT_RATE, interval);
     }
+    out32(REG_INTERRUPT_MASK_SET, receive_interrupts);
 }
 
 i32 E1000NetworkAdapter::link_speed()
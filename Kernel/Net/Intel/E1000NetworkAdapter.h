@@ -11,6 +11,7 @@
 #include <Kernel/Bus/PCI/Device.h>
 #include <Kernel/IOWindow.h>
 #include <Kernel/Interrupts/IRQHandler.h>
+#include <Kernel/Locking/Mutex.h>
 #include <Kernel/Net/NetworkAdapter.h>
 #include <Kernel/Random.h>
 
@@ -27,6 +28,7 @@ public:
     virtual ~E1000NetworkAdapter() override;
 
     virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_with_offload(ReadonlyBytes, TransmitOffload const&) override;
     virtual bool link_up() override { return m_link_up; };
     virtual i32 link_speed() override;
     virtual bool link_full_duplex() override;
@@ -36,11 +38,15 @@ public:
     virtual Type adapter_type() const override { return Type::Ethernet; }
 
 protected:
-    static constexpr size_t rx_buffer_size = 8192;
+    // NOTE: Long packet reception is off, so no frame is larger than 1522 bytes.
+    static constexpr size_t rx_buffer_size = 2048;
     static constexpr size_t tx_buffer_size = 8192;
 
+    static size_t rx_descriptor_count();
+
     void setup_interrupts();
     void setup_link();
+    void setup_offloads();
 
     E1000NetworkAdapter(PCI::DeviceIdentifier const&, u8 irq,
         NonnullOwnPtr<IOWindow> registers_io_window, NonnullOwnPtr<Memory::Region> rx_buffer_region,
@@ -69,6 +75,32 @@ protected:
         volatile uint16_t special { 0 };
     };
 
+    // Sets up checksum offloading and TCP segmentation for the data descriptors that follow it, see section 3.3.6 of the manual.
+    struct [[gnu::packed]] e1000_tx_context_desc {
+        volatile uint8_t ipcss { 0 };
+        volatile uint8_t ipcso { 0 };
+        volatile uint16_t ipcse { 0 };
+        volatile uint8_t tucss { 0 };
+        volatile uint8_t tucso { 0 };
+        volatile uint16_t tucse { 0 };
+        volatile uint32_t paylen_and_command { 0 };
+        volatile uint8_t status { 0 };
+        volatile uint8_t hdrlen { 0 };
+        volatile uint16_t mss { 0 };
+    };
+
+    // See section 3.3.7 of the manual.
+    struct [[gnu::packed]] e1000_tx_data_desc {
+        volatile uint64_t addr { 0 };
+        volatile uint32_t length_and_command { 0 };
+        volatile uint8_t status { 0 };
+        volatile uint8_t popts { 0 };
+        volatile uint16_t special { 0 };
+    };
+
+    static_assert(AssertSize<e1000_tx_context_desc, sizeof(e1000_tx_desc)>());
+    static_assert(AssertSize<e1000_tx_data_desc, sizeof(e1000_tx_desc)>());
+
     virtual void detect_eeprom();
     virtual u32 read_eeprom(u8 address);
     void read_mac_address();
@@ -83,9 +115,12 @@ protected:
     u16 in16(u16 address);
     u32 in32(u16 address);
 
-    void receive();
+    virtual size_t poll_rx_ring(size_t budget) override;
+    virtual void end_receive_polling(size_t packet_count) override;
+    void transmit(ReadonlyBytes, TransmitOffload const*);
+    PhysicalAddress tx_buffer_physical_address(size_t index) const;
 
-    static constexpr size_t number_of_rx_descriptors = 256;
+    static constexpr size_t default_number_of_rx_descriptors = 1024;
     static constexpr size_t number_of_tx_descriptors = 256;
 
     NonnullOwnPtr<IOWindow> m_registers_io_window;
@@ -94,12 +129,15 @@ protected:
     NonnullOwnPtr<Memory::Region> m_tx_descriptors_region;
     NonnullOwnPtr<Memory::Region> m_rx_buffer_region;
     NonnullOwnPtr<Memory::Region> m_tx_buffer_region;
-    Array<void*, number_of_rx_descriptors> m_rx_buffers;
+    size_t m_rx_descriptor_count { 0 };
     Array<void*, number_of_tx_descriptors> m_tx_buffers;
     bool m_has_eeprom { false };
     bool m_link_up { false };
+    // In units of 256 nanoseconds, see setup_interrupts().
+    u32 m_interrupt_throttling_interval { 0 };
     EntropySource m_entropy_source;
 
     WaitQueue m_wait_queue;
+    Mutex m_tx_lock { "E1000NetworkAdapter TX"sv };
 };
 }
@@ -45,8 +45,13 @@ ErrorOr<void> LocalSocket::try_for_each(Function<ErrorOr<void>(LocalSocket const
 
 ErrorOr<NonnullLockRefPtr<LocalSocket>> LocalSocket::try_create(int type)
 {
-    auto client_buffer = TRY(DoubleBuffer::try_create("LocalSocket: Client buffer"sv));
-    auto server_buffer = TRY(DoubleBuffer::try_create("LocalSocket: Server buffer"sv));
+    // Stream sockets carry bulk IPC data, so their buffers start out at the default size and grow if a peer writes a lot at once.
+    // That way, a large message is passed on in a few big copies rather than in many round trips through a small buffer.
+    static constexpr size_t initial_buffer_size = 64 * KiB;
+    static constexpr size_t maximum_stream_buffer_size = 512 * KiB;
+    auto maximum_buffer_size = type == SOCK_STREAM ? maximum_stream_buffer_size : initial_buffer_size;
+    auto client_buffer = TRY(DoubleBuffer::try_create("LocalSocket: Client buffer"sv, initial_buffer_size, maximum_buffer_size));
+    auto server_buffer = TRY(DoubleBuffer::try_create("LocalSocket: Server buffer"sv, initial_buffer_size, maximum_buffer_size));
     return adopt_nonnull_lock_ref_or_enomem(new (nothrow) LocalSocket(type, move(client_buffer), move(server_buffer)));
 }
 
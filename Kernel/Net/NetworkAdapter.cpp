@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/HashFunctions.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/InterruptDisabler.h>
 #include <Kernel/Net/EtherType.h>
@@ -17,15 +18,29 @@ namespace Kernel {
 NetworkAdapter::NetworkAdapter(NonnullOwnPtr<KString> interface_name)
     : m_name(move(interface_name))
 {
+    update_packet_buffer_sizes();
 }
 
 NetworkAdapter::~NetworkAdapter() = default;
 
-void NetworkAdapter::send_packet(ReadonlyBytes packet)
+void NetworkAdapter::send_packet(ReadonlyBytes packet, TransmitOffload const& offload)
 {
     m_packets_out++;
     m_bytes_out += packet.size();
-    send_raw(packet);
+    if (offload.is_empty())
+        return send_raw(packet);
+
+    VERIFY(!offload.tcp_checksum || has_offload(NetworkOffload::TransmitTCPChecksum));
+    VERIFY(offload.tcp_segment_size == 0 || (has_offload(NetworkOffload::TCPSegmentation) && packet.size() <= m_max_segmentation_frame_size));
+    send_raw_with_offload(packet, offload);
+}
+
+void NetworkAdapter::set_offloads(NetworkOffload offloads, size_t max_segmentation_frame_size)
+{
+    VERIFY(!has_flag(offloads, NetworkOffload::TCPSegmentation) || max_segmentation_frame_size > mtu());
+    m_offloads = offloads;
+    m_max_segmentation_frame_size = max_segmentation_frame_size;
+    update_packet_buffer_sizes();
 }
 
 void NetworkAdapter::send(MACAddress const& destination, ARPPacket const& packet)
@@ -47,7 +62,8 @@ void NetworkAdapter::send(MACAddress const& destination, ARPPacket const& packet
 void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Address const& source_ipv4, MACAddress const& destination_mac, IPv4Address const& destination_ipv4, IPv4Protocol protocol, size_t payload_size, u8 type_of_service, u8 ttl)
 {
     size_t ipv4_packet_size = sizeof(IPv4Packet) + payload_size;
-    VERIFY(ipv4_packet_size <= mtu());
+    // NOTE: Packets that are larger than the MTU get split up by the adapter.
+    VERIFY(ipv4_packet_size <= mtu() || (has_offload(NetworkOffload::TCPSegmentation) && ipv4_payload_offset() + payload_size <= m_max_segmentation_frame_size));
 
     size_t ethernet_frame_size = ipv4_payload_offset() + payload_size;
     VERIFY(packet.buffer->size() == ethernet_frame_size);
@@ -69,6 +85,35 @@ void NetworkAdapter::fill_in_ipv4_header(PacketWithTimestamp& packet, IPv4Addres
     ipv4.set_checksum(ipv4.compute_checksum());
 }
 
+void NetworkAdapter::set_receive_queue_count(size_t count)
+{
+    VERIFY(count > 0 && count <= max_receive_queues);
+    SpinlockLocker locker(m_packet_queue_lock);
+    // NOTE: Packets that are already queued stay where they are, so they don't get reordered relative to each other.
+    m_receive_queue_count = max(count, m_receive_queue_count);
+}
+
+// Picks the receive queue for a frame, so that all packets of a flow end up in the same queue, and thereby keep their order.
+size_t NetworkAdapter::receive_queue_for_frame(ReadonlyBytes frame) const
+{
+    if (m_receive_queue_count == 1 || frame.size() < sizeof(EthernetFrameHeader) + sizeof(IPv4Packet))
+        return 0;
+    auto& eth = *(EthernetFrameHeader const*)frame.data();
+    if (eth.ether_type() != EtherType::IPv4)
+        return 0;
+
+    auto& ipv4 = *static_cast<IPv4Packet const*>(eth.payload());
+    u32 hash = pair_int_hash(ipv4.source().to_u32(), ipv4.destination().to_u32());
+    auto protocol = static_cast<IPv4Protocol>(ipv4.protocol());
+    if ((protocol == IPv4Protocol::TCP || protocol == IPv4Protocol::UDP) && frame.size() >= ipv4_payload_offset() + sizeof(u32)) {
+        // Both TCP and UDP start with the source and destination port.
+        u32 ports;
+        memcpy(&ports, ipv4.payload(), sizeof(ports));
+        hash = pair_int_hash(hash, ports);
+    }
+    return hash % m_receive_queue_count;
+}
+
 void NetworkAdapter::did_receive(ReadonlyBytes payload)
 {
     InterruptDisabler disabler;
@@ -88,20 +133,54 @@ void NetworkAdapter::did_receive(ReadonlyBytes payload)
 
     memcpy(packet->buffer->data(), payload.data(), payload.size());
 
-    m_packet_queue.append(*packet);
-    m_packet_queue_size++;
+    size_t queue_index;
+    {
+        SpinlockLocker locker(m_packet_queue_lock);
+        queue_index = receive_queue_for_frame(payload);
+        m_packet_queues[queue_index].append(*packet);
+        m_packet_queue_size++;
+    }
 
     if (on_receive)
-        on_receive();
+        on_receive(queue_index);
 }
 
-size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp)
+void NetworkAdapter::schedule_receive_poll()
 {
-    InterruptDisabler disabler;
-    if (m_packet_queue.is_empty())
-        return 0;
-    auto packet_with_timestamp = m_packet_queue.take_first();
-    m_packet_queue_size--;
+    if (m_receive_poll_scheduled.exchange(true))
+        return;
+    if (on_receive_poll_scheduled)
+        on_receive_poll_scheduled();
+}
+
+bool NetworkAdapter::poll_receive()
+{
+    if (!m_receive_poll_scheduled.load())
+        return false;
+
+    // NOTE: The receive interrupts are masked until end_receive_polling(), so nobody else touches the RX ring meanwhile.
+    auto packet_count = poll_rx_ring(receive_poll_budget);
+    m_packets_in_receive_poll += packet_count;
+    if (packet_count == receive_poll_budget)
+        return true;
+
+    m_receive_poll_scheduled.store(false);
+    end_receive_polling(exchange(m_packets_in_receive_poll, 0));
+    return false;
+}
+
+size_t NetworkAdapter::dequeue_packet(size_t queue_index, u8* buffer, size_t buffer_size, Time& packet_timestamp)
+{
+    VERIFY(queue_index < max_receive_queues);
+    LockRefPtr<PacketWithTimestamp> packet_with_timestamp;
+    {
+        SpinlockLocker locker(m_packet_queue_lock);
+        auto& queue = m_packet_queues[queue_index];
+        if (queue.is_empty())
+            return 0;
+        packet_with_timestamp = queue.take_first();
+        m_packet_queue_size--;
+    }
     packet_timestamp = packet_with_timestamp->timestamp;
     auto& packet_buffer = packet_with_timestamp->buffer;
     size_t packet_size = packet_buffer->size();
@@ -111,42 +190,16 @@ size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size, Time& pack
     return packet_size;
 }
 
-LockRefPtr<PacketWithTimestamp> NetworkAdapter::acquire_packet_buffer(size_t size)
+void NetworkAdapter::set_mtu(u32 mtu)
 {
-    auto packet = m_unused_packets.with([size](auto& unused_packets) -> LockRefPtr<PacketWithTimestamp> {
-        if (unused_packets.is_empty())
-            return nullptr;
-
-        auto unused_packet = unused_packets.take_first();
-
-        if (unused_packet->buffer->capacity() >= size)
-            return unused_packet;
-
-        unused_packets.append(*unused_packet);
-        return nullptr;
-    });
-
-    if (packet) {
-        packet->timestamp = kgettimeofday();
-        packet->buffer->set_size(size);
-        return packet;
-    }
-
-    auto buffer_or_error = KBuffer::try_create_with_size("NetworkAdapter: Packet buffer"sv, size, Memory::Region::Access::ReadWrite, AllocationStrategy::AllocateNow);
-    if (buffer_or_error.is_error())
-        return {};
-    packet = adopt_lock_ref_if_nonnull(new (nothrow) PacketWithTimestamp { buffer_or_error.release_value(), kgettimeofday() });
-    if (!packet)
-        return {};
-    packet->buffer->set_size(size);
-    return packet;
+    m_mtu = mtu;
+    update_packet_buffer_sizes();
 }
 
-void NetworkAdapter::release_packet_buffer(PacketWithTimestamp& packet)
+void NetworkAdapter::update_packet_buffer_sizes()
 {
-    m_unused_packets.with([&packet](auto& unused_packets) {
-        unused_packets.append(packet);
-    });
+    size_t standard_size = layer3_payload_offset() + m_mtu;
+    m_packet_buffer_pool.set_buffer_sizes(standard_size, max(standard_size, m_max_segmentation_frame_size));
 }
 
 void NetworkAdapter::set_ipv4_address(IPv4Address const& address)
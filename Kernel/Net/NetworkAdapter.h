@@ -6,8 +6,11 @@
 
 #pragma once
 
+#include <AK/Array.h>
+#include <AK/Atomic.h>
 #include <AK/AtomicRefCounted.h>
 #include <AK/ByteBuffer.h>
+#include <AK/EnumBits.h>
 #include <AK/Function.h>
 #include <AK/IntrusiveList.h>
 #include <AK/MACAddress.h>
@@ -20,6 +23,7 @@
 #include <Kernel/Net/EthernetFrameHeader.h>
 #include <Kernel/Net/ICMP.h>
 #include <Kernel/Net/IPv4.h>
+#include <Kernel/Net/PacketBufferPool.h>
 #include <Kernel/UserOrKernelBuffer.h>
 
 namespace Kernel {
@@ -28,18 +32,28 @@ class NetworkAdapter;
 
 using NetworkByteBuffer = AK::Detail::ByteBuffer<1500>;
 
-struct PacketWithTimestamp final : public AtomicRefCounted<PacketWithTimestamp> {
-    PacketWithTimestamp(NonnullOwnPtr<KBuffer> buffer, Time timestamp)
-        : buffer(move(buffer))
-        , timestamp(timestamp)
-    {
-    }
+// Work that a network adapter can take off the CPU.
+enum class NetworkOffload : u8 {
+    None = 0,
+    // Fills in the TCP checksum of outgoing packets.
+    // The checksum field has to hold the checksum of the pseudo header, see TCPSocket::compute_tcp_pseudo_header_checksum().
+    TransmitTCPChecksum = 1 << 0,
+    // Verifies the IPv4, TCP and UDP checksums of incoming packets, and drops the ones that are broken.
+    ReceiveChecksum = 1 << 1,
+    // Splits outgoing TCP packets that are larger than the MTU into segments.
+    // The checksum field has to hold the checksum of the pseudo header without the length, the adapter fills in the rest for each segment.
+    TCPSegmentation = 1 << 2,
+};
 
-    ReadonlyBytes bytes() { return buffer->bytes(); }
+AK_ENUM_BITWISE_OPERATORS(NetworkOffload);
 
-    NonnullOwnPtr<KBuffer> buffer;
-    Time timestamp;
-    IntrusiveListNode<PacketWithTimestamp, LockRefPtr<PacketWithTimestamp>> packet_node;
+// What the adapter has to do to an outgoing packet before it goes on the wire.
+struct TransmitOffload {
+    bool tcp_checksum { false };
+    // If nonzero, the packet is split into TCP segments with this much payload each.
+    u16 tcp_segment_size { 0 };
+
+    bool is_empty() const { return !tcp_checksum && tcp_segment_size == 0; }
 };
 
 class NetworkingManagement;
@@ -54,6 +68,12 @@ public:
 
     static constexpr i32 LINKSPEED_INVALID = -1;
 
+    // Received packets are spread over this many queues by flow, so they can be processed in parallel.
+    static constexpr size_t max_receive_queues = 8;
+
+    // How many packets an adapter in polling mode hands over at a time, see schedule_receive_poll().
+    static constexpr size_t receive_poll_budget = 64;
+
     virtual ~NetworkAdapter();
 
     virtual StringView class_name() const = 0;
@@ -79,35 +99,64 @@ public:
     void send(MACAddress const&, ARPPacket const&);
     void fill_in_ipv4_header(PacketWithTimestamp&, IPv4Address const&, MACAddress const&, IPv4Address const&, IPv4Protocol, size_t, u8 type_of_service, u8 ttl);
 
-    size_t dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp);
+    size_t dequeue_packet(size_t queue_index, u8* buffer, size_t buffer_size, Time& packet_timestamp);
 
-    bool has_queued_packets() const { return !m_packet_queue.is_empty(); }
+    size_t receive_queue_count() const { return m_receive_queue_count; }
+    void set_receive_queue_count(size_t);
 
     u32 mtu() const { return m_mtu; }
-    void set_mtu(u32 mtu) { m_mtu = mtu; }
+    void set_mtu(u32 mtu);
+
+    NetworkOffload offloads() const { return m_offloads; }
+    bool has_offload(NetworkOffload offload) const { return has_flag(m_offloads, offload); }
+    // The largest frame that can be handed to the adapter for TCP segmentation.
+    size_t max_segmentation_frame_size() const { return m_max_segmentation_frame_size; }
 
     u32 packets_in() const { return m_packets_in; }
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
 
-    LockRefPtr<PacketWithTimestamp> acquire_packet_buffer(size_t);
-    void release_packet_buffer(PacketWithTimestamp&);
+    LockRefPtr<PacketWithTimestamp> acquire_packet_buffer(size_t size) { return m_packet_buffer_pool.acquire(size); }
+    void release_packet_buffer(PacketWithTimestamp& packet) { m_packet_buffer_pool.release(packet); }
+    PacketBufferPool::Statistics packet_buffer_statistics() const { return m_packet_buffer_pool.statistics(); }
 
     constexpr size_t layer3_payload_offset() const { return sizeof(EthernetFrameHeader); }
     constexpr size_t ipv4_payload_offset() const { return layer3_payload_offset() + sizeof(IPv4Packet); }
 
-    Function<void()> on_receive;
+    Function<void(size_t queue_index)> on_receive;
+    Function<void()> on_receive_poll_scheduled;
 
-    void send_packet(ReadonlyBytes);
+    // Takes up to a budget's worth of packets off the RX ring, if a poll has been scheduled. Returns whether the adapter is
+    // still in polling mode afterwards, i.e. whether there may be more.
+    bool poll_receive();
+
+    void send_packet(ReadonlyBytes, TransmitOffload const& = {});
 
 protected:
     NetworkAdapter(NonnullOwnPtr<KString>);
     void set_mac_address(MACAddress const& mac_address) { m_mac_address = mac_address; }
     void did_receive(ReadonlyBytes);
     virtual void send_raw(ReadonlyBytes) = 0;
+    // Only called with offloads that the adapter has advertised with set_offloads().
+    virtual void send_raw_with_offload(ReadonlyBytes, TransmitOffload const&) { VERIFY_NOT_REACHED(); }
+    void set_offloads(NetworkOffload, size_t max_segmentation_frame_size = 0);
+
+    // Taking an interrupt for every received packet can keep a machine busy with nothing else at high packet rates. So
+    // instead of draining its RX ring in the IRQ handler, an adapter can mask its receive interrupts there and call this.
+    // NetworkTask then drains the ring in batches with poll_rx_ring(), taking turns with the handling of the packets,
+    // until it comes up empty. At that point end_receive_polling() unmasks the receive interrupts again.
+    void schedule_receive_poll();
+    // Hands up to `budget` received packets to did_receive(), returns how many there were.
+    virtual size_t poll_rx_ring([[maybe_unused]] size_t budget) { VERIFY_NOT_REACHED(); }
+    // `packet_count` is the number of packets received since the interrupts were masked, adapters can use it to adjust
+    // their interrupt moderation.
+    virtual void end_receive_polling([[maybe_unused]] size_t packet_count) { VERIFY_NOT_REACHED(); }
 
 private:
+    size_t receive_queue_for_frame(ReadonlyBytes) const;
+    void update_packet_buffer_sizes();
+
     MACAddress m_mac_address;
     IPv4Address m_ipv4_address;
     IPv4Address m_ipv4_netmask;
@@ -117,15 +166,21 @@ private:
 
     using PacketList = IntrusiveList<&PacketWithTimestamp::packet_node>;
 
-    PacketList m_packet_queue;
+    Spinlock<LockRank::None> m_packet_queue_lock {};
+    Array<PacketList, max_receive_queues> m_packet_queues;
+    size_t m_receive_queue_count { 1 };
     size_t m_packet_queue_size { 0 };
-    SpinlockProtected<PacketList, LockRank::None> m_unused_packets {};
+    PacketBufferPool m_packet_buffer_pool;
     NonnullOwnPtr<KString> m_name;
     u32 m_packets_in { 0 };
     u32 m_bytes_in { 0 };
     u32 m_packets_out { 0 };
     u32 m_bytes_out { 0 };
     u32 m_mtu { 1500 };
+    NetworkOffload m_offloads { NetworkOffload::None };
+    size_t m_max_segmentation_frame_size { 0 };
+    Atomic<bool> m_receive_poll_scheduled { false };
+    size_t m_packets_in_receive_poll { 0 };
 };
 
 }
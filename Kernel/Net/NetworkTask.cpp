@@ -32,35 +32,48 @@ static void handle_udp(IPv4Packet const&, Time const& packet_timestamp);
 static void handle_tcp(IPv4Packet const&, Time const& packet_timestamp);
 static void send_delayed_tcp_ack(LockRefPtr<TCPSocket> socket);
 static void send_tcp_rst(IPv4Packet const& ipv4_packet, TCPPacket const& tcp_packet, LockRefPtr<NetworkAdapter> adapter);
-static void flush_delayed_tcp_acks();
-static void retransmit_tcp_packets();
 
-static Thread* network_task = nullptr;
-static HashTable<LockRefPtr<TCPSocket>>* delayed_ack_sockets;
+// Every receive worker drains one receive queue of each adapter. Adapters spread packets over their queues by flow,
+// so all packets of a connection are handled by the same worker, in the order they arrived.
+struct ReceiveWorker {
+    Atomic<Thread*> thread { nullptr };
+    WaitQueue packet_wait_queue;
+};
+
+static ReceiveWorker* receive_workers = nullptr;
+static size_t receive_worker_count = 0;
 
 [[noreturn]] static void NetworkTask_main(void*);
 
-void NetworkTask::spawn()
+ErrorOr<void> NetworkTask::spawn()
 {
-    LockRefPtr<Thread> thread;
-    auto name = KString::try_create("Network Task"sv);
-    if (name.is_error())
-        TODO();
-    (void)Process::create_kernel_process(thread, name.release_value(), NetworkTask_main, nullptr);
-    network_task = thread;
-}
+    auto worker_count = min(static_cast<size_t>(Processor::count()), NetworkAdapter::max_receive_queues);
+    receive_workers = new (nothrow) ReceiveWorker[worker_count];
+    if (!receive_workers)
+        return ENOMEM;
+    receive_worker_count = worker_count;
 
-bool NetworkTask::is_current()
-{
-    return Thread::current() == network_task;
-}
-
-void NetworkTask_main(void*)
-{
-    delayed_ack_sockets = new HashTable<LockRefPtr<TCPSocket>>;
+    LockRefPtr<Thread> thread;
+    auto process = Process::create_kernel_process(thread, TRY(KString::try_create("Network Task"sv)), NetworkTask_main, nullptr, receive_worker_count > 1 ? 1u << 0 : THREAD_AFFINITY_DEFAULT);
+    if (!process)
+        return ENOMEM;
+
+    // NOTE: Adapters only spread packets over the queues of workers that are actually running.
+    //       If we can't start all of them, the remaining ones simply never get any packets.
+    size_t started_worker_count = 1;
+    for (; started_worker_count < receive_worker_count; ++started_worker_count) {
+        auto worker_name = KString::formatted("Network Task #{}", started_worker_count);
+        if (worker_name.is_error()) {
+            dmesgln("NetworkTask: Failed to start receive worker #{}: {}", started_worker_count, worker_name.error());
+            break;
+        }
+        // NOTE: Each worker stays on its own CPU, which keeps the sockets of its flows warm in that CPU's cache.
+        if (!process->create_kernel_thread(NetworkTask_main, reinterpret_cast<void*>(started_worker_count), THREAD_PRIORITY_NORMAL, worker_name.release_value(), 1u << started_worker_count, false)) {
+            dmesgln("NetworkTask: Failed to start receive worker #{}", started_worker_count);
+            break;
+        }
+    }
 
-    WaitQueue packet_wait_queue;
-    int pending_packets = 0;
     NetworkingManagement::the().for_each([&](auto& adapter) {
         dmesgln("NetworkTask: {} network adapter found: hw={}", adapter.class_name(), adapter.mac_address().to_string());
 
@@ -69,22 +82,51 @@ void NetworkTask_main(void*)
             adapter.set_ipv4_netmask({ 255, 0, 0, 0 });
         }
 
-        adapter.on_receive = [&]() {
-            pending_packets++;
-            packet_wait_queue.wake_all();
+        adapter.on_receive = [](size_t queue_index) {
+            receive_workers[queue_index].packet_wait_queue.wake_all();
         };
+        // NOTE: Adapters in polling mode are drained by the first worker.
+        adapter.on_receive_poll_scheduled = [] {
+            receive_workers[0].packet_wait_queue.wake_all();
+        };
+        adapter.set_receive_queue_count(started_worker_count);
     });
 
-    auto dequeue_packet = [&pending_packets](u8* buffer, size_t buffer_size, Time& packet_timestamp) -> size_t {
-        if (pending_packets == 0)
-            return 0;
+    return {};
+}
+
+bool NetworkTask::is_current()
+{
+    auto* current_thread = Thread::current();
+    for (size_t i = 0; i < receive_worker_count; ++i) {
+        if (receive_workers[i].thread == current_thread)
+            return true;
+    }
+    return false;
+}
+
+void NetworkTask::wake_timer_worker()
+{
+    // NOTE: The first worker takes care of the TCP timers.
+    if (receive_worker_count > 0)
+        receive_workers[0].packet_wait_queue.wake_all();
+}
+
+void NetworkTask_main(void* data)
+{
+    auto queue_index = reinterpret_cast<FlatPtr>(data);
+    VERIFY(queue_index < receive_worker_count);
+    auto& worker = receive_workers[queue_index];
+    worker.thread = Thread::current();
+
+    auto dequeue_packet = [queue_index](u8* buffer, size_t buffer_size, Time& packet_timestamp) -> size_t {
         size_t packet_size = 0;
         NetworkingManagement::the().for_each([&](auto& adapter) {
-            if (packet_size || !adapter.has_queued_packets())
+            if (packet_size)
                 return;
-            packet_size = adapter.dequeue_packet(buffer, buffer_size, packet_timestamp);
-            pending_packets--;
-            dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} ({} bytes)", adapter.name(), packet_size);
+            packet_size = adapter.dequeue_packet(queue_index, buffer, buffer_size, packet_timestamp);
+            if (packet_size)
+                dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} queue {} ({} bytes)", adapter.name(), queue_index, packet_size);
         });
         return packet_size;
     };
@@ -97,14 +139,37 @@ void NetworkTask_main(void*)
     auto buffer = (u8*)buffer_region->vaddr().get();
     Time packet_timestamp;
 
+    auto poll_adapters = [] {
+        bool more_to_poll = false;
+        NetworkingManagement::the().for_each([&](auto& adapter) {
+            if (adapter.poll_receive())
+                more_to_poll = true;
+        });
+        return more_to_poll;
+    };
+    size_t packets_since_poll = 0;
+
     for (;;) {
-        flush_delayed_tcp_acks();
-        retransmit_tcp_packets();
+        // NOTE: The TCP timers of all sockets share one wheel, so only one worker takes care of them.
+        if (queue_index == 0)
+            TCPSocket::handle_expired_timers();
         size_t packet_size = dequeue_packet(buffer, buffer_size, packet_timestamp);
+        // Packets that are already queued are handled before polling for more, but not so many that the RX rings overflow.
+        if (queue_index == 0 && (!packet_size || ++packets_since_poll >= NetworkAdapter::receive_poll_budget)) {
+            packets_since_poll = 0;
+            bool more_to_poll = poll_adapters();
+            if (!packet_size) {
+                packet_size = dequeue_packet(buffer, buffer_size, packet_timestamp);
+                if (!packet_size && more_to_poll)
+                    continue;
+            }
+        }
         if (!packet_size) {
             auto timeout_time = Time::from_milliseconds(500);
+            if (queue_index == 0)
+                timeout_time = TCPSocket::time_until_next_timer(timeout_time);
             auto timeout = Thread::BlockTimeout { false, &timeout_time };
-            [[maybe_unused]] auto result = packet_wait_queue.wait_on(timeout, "NetworkTask"sv);
+            [[maybe_unused]] auto result = worker.packet_wait_queue.wait_on(timeout, "NetworkTask"sv);
             continue;
         }
         if (packet_size < sizeof(EthernetFrameHeader)) {
@@ -310,28 +375,7 @@ void send_delayed_tcp_ack(LockRefPtr<TCPSocket> socket)
         return;
     }
 
-    delayed_ack_sockets->set(move(socket));
-}
-
-void flush_delayed_tcp_acks()
-{
-    Vector<LockRefPtr<TCPSocket>, 32> remaining_sockets;
-    for (auto& socket : *delayed_ack_sockets) {
-        MutexLocker locker(socket->mutex());
-        if (socket->should_delay_next_ack()) {
-            MUST(remaining_sockets.try_append(socket));
-            continue;
-        }
-        [[maybe_unused]] auto result = socket->send_ack();
-    }
-
-    if (remaining_sockets.size() != delayed_ack_sockets->size()) {
-        delayed_ack_sockets->clear();
-        if (remaining_sockets.size() > 0)
-            dbgln("flush_delayed_tcp_acks: {} sockets remaining", remaining_sockets.size());
-        for (auto&& socket : remaining_sockets)
-            delayed_ack_sockets->set(move(socket));
-    }
+    socket->schedule_delayed_ack();
 }
 
 void send_tcp_rst(IPv4Packet const& ipv4_packet, TCPPacket const& tcp_packet, LockRefPtr<NetworkAdapter> adapter)
@@ -459,6 +503,7 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
             dbgln_if(TCP_DEBUG, "handle_tcp: created new client socket with tuple {}", client->tuple().to_string());
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            client->process_syn_options(tcp_packet);
             [[maybe_unused]] auto rc2 = client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
             client->set_state(TCPSocket::State::SynReceived);
             return;
@@ -653,21 +698,4 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
     }
 }
 
-void retransmit_tcp_packets()
-{
-    // We must keep the sockets alive until after we've unlocked the hash table
-    // in case retransmit_packets() realizes that it wants to close the socket.
-    NonnullLockRefPtrVector<TCPSocket, 16> sockets;
-    TCPSocket::sockets_for_retransmit().for_each_shared([&](auto const& socket) {
-        // We ignore allocation failures above the first 16 guaranteed socket slots, as
-        // we will just retransmit their packets the next time around
-        (void)sockets.try_append(socket);
-    });
-
-    for (auto& socket : sockets) {
-        MutexLocker socket_locker(socket.mutex());
-        socket.retransmit_packets();
-    }
-}
-
 }
@@ -6,10 +6,14 @@
 
 #pragma once
 
+#include <AK/Error.h>
+
 namespace Kernel {
 class NetworkTask {
 public:
-    static void spawn();
+    static ErrorOr<void> spawn();
     static bool is_current();
+    // Makes the network task take another look at the TCP timers, as one of them now expires earlier than it expected.
+    static void wake_timer_worker();
 };
 }
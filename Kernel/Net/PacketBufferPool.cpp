@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/InterruptDisabler.h>
+#include <Kernel/Net/PacketBufferPool.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+// How many buffers move between a CPU's cache and the shared list at once.
+static constexpr size_t transfer_batch_size = 16;
+
+void PacketBufferPool::set_buffer_sizes(size_t standard_size, size_t large_size)
+{
+    standard_size = Memory::page_round_up(standard_size).release_value_but_fixme_should_propagate_errors();
+    large_size = Memory::page_round_up(large_size).release_value_but_fixme_should_propagate_errors();
+    m_standard.buffer_size.store(standard_size, AK::MemoryOrder::memory_order_relaxed);
+    // If everything fits into the standard buffers, large ones are never handed out.
+    m_large.buffer_size.store(large_size > standard_size ? large_size : 0, AK::MemoryOrder::memory_order_relaxed);
+}
+
+PacketBufferPool::SizeClass* PacketBufferPool::size_class_for(size_t size)
+{
+    if (size <= m_standard.buffer_size.load(AK::MemoryOrder::memory_order_relaxed))
+        return &m_standard;
+    if (size <= m_large.buffer_size.load(AK::MemoryOrder::memory_order_relaxed))
+        return &m_large;
+    return nullptr;
+}
+
+LockRefPtr<PacketWithTimestamp> PacketBufferPool::take_cached(SizeClass& size_class)
+{
+    InterruptDisabler disabler;
+    auto& cache = size_class.cpu_caches[Processor::current_id()];
+    if (cache.count == 0) {
+        size_class.shared_list.with([&](auto& shared_list) {
+            while (shared_list.count > 0 && cache.count < transfer_batch_size) {
+                cache.list.append(*shared_list.list.take_first());
+                --shared_list.count;
+                ++cache.count;
+            }
+        });
+        if (cache.count == 0)
+            return nullptr;
+        m_shared_list_hits.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    } else {
+        m_cpu_cache_hits.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    }
+    --cache.count;
+    return cache.list.take_first();
+}
+
+LockRefPtr<PacketWithTimestamp> PacketBufferPool::allocate(size_t buffer_size)
+{
+    m_allocations.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    auto buffer_or_error = KBuffer::try_create_with_size("NetworkAdapter: Packet buffer"sv, buffer_size, Memory::Region::Access::ReadWrite, AllocationStrategy::AllocateNow);
+    if (buffer_or_error.is_error()) {
+        m_allocation_failures.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        return {};
+    }
+    auto packet = adopt_lock_ref_if_nonnull(new (nothrow) PacketWithTimestamp { buffer_or_error.release_value(), kgettimeofday() });
+    if (!packet)
+        m_allocation_failures.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    return packet;
+}
+
+LockRefPtr<PacketWithTimestamp> PacketBufferPool::acquire(size_t size)
+{
+    LockRefPtr<PacketWithTimestamp> packet;
+    auto* size_class = size_class_for(size);
+    if (size_class) {
+        packet = take_cached(*size_class);
+        // The buffer may be left over from before the buffer sizes changed.
+        if (packet && packet->buffer->capacity() < size) {
+            m_frees.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+            packet = nullptr;
+        }
+    }
+    if (!packet) {
+        packet = allocate(size_class ? size_class->buffer_size.load(AK::MemoryOrder::memory_order_relaxed) : size);
+        if (!packet)
+            return {};
+    }
+
+    packet->timestamp = kgettimeofday();
+    packet->buffer->set_size(size);
+    return packet;
+}
+
+void PacketBufferPool::release(PacketWithTimestamp& packet)
+{
+    VERIFY(!packet.packet_node.is_in_list());
+
+    SizeClass* size_class = nullptr;
+    auto capacity = packet.buffer->capacity();
+    if (capacity == m_standard.buffer_size.load(AK::MemoryOrder::memory_order_relaxed))
+        size_class = &m_standard;
+    else if (capacity == m_large.buffer_size.load(AK::MemoryOrder::memory_order_relaxed))
+        size_class = &m_large;
+    if (!size_class) {
+        // The buffer gets freed once the caller drops its last reference to it.
+        m_frees.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        return;
+    }
+
+    InterruptDisabler disabler;
+    auto& cache = size_class->cpu_caches[Processor::current_id()];
+    if (cache.count >= size_class->max_cpu_cache_count) {
+        // Move a whole batch, so that the next few releases on this CPU don't have to take the lock again.
+        size_class->shared_list.with([&](auto& shared_list) {
+            for (size_t i = 0; i < transfer_batch_size && cache.count > 0 && shared_list.count < size_class->max_shared_count; ++i) {
+                shared_list.list.append(*cache.list.take_first());
+                --cache.count;
+                ++shared_list.count;
+            }
+        });
+        if (cache.count >= size_class->max_cpu_cache_count) {
+            m_frees.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+            return;
+        }
+    }
+    cache.list.append(packet);
+    ++cache.count;
+}
+
+PacketBufferPool::Statistics PacketBufferPool::statistics() const
+{
+    return {
+        .cpu_cache_hits = m_cpu_cache_hits.load(AK::MemoryOrder::memory_order_relaxed),
+        .shared_list_hits = m_shared_list_hits.load(AK::MemoryOrder::memory_order_relaxed),
+        .allocations = m_allocations.load(AK::MemoryOrder::memory_order_relaxed),
+        .allocation_failures = m_allocation_failures.load(AK::MemoryOrder::memory_order_relaxed),
+        .frees = m_frees.load(AK::MemoryOrder::memory_order_relaxed),
+    };
+}
+
+}
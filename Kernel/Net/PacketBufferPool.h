@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <AK/AtomicRefCounted.h>
+#include <AK/IntrusiveList.h>
+#include <AK/Time.h>
+#include <Kernel/Arch/Processor.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Library/LockRefPtr.h>
+#include <Kernel/Locking/SpinlockProtected.h>
+
+namespace Kernel {
+
+struct PacketWithTimestamp final : public AtomicRefCounted<PacketWithTimestamp> {
+    PacketWithTimestamp(NonnullOwnPtr<KBuffer> buffer, Time timestamp)
+        : buffer(move(buffer))
+        , timestamp(timestamp)
+    {
+    }
+
+    ReadonlyBytes bytes() { return buffer->bytes(); }
+
+    NonnullOwnPtr<KBuffer> buffer;
+    Time timestamp;
+    IntrusiveListNode<PacketWithTimestamp, LockRefPtr<PacketWithTimestamp>> packet_node;
+};
+
+// Recycles the packet buffers of a network adapter, so that sending and receiving don't have to allocate.
+//
+// Buffers come in two fixed sizes: standard ones that fit any frame up to the MTU, and large ones for the
+// frames that don't (e.g. TCP packets that the adapter segments for us). Every CPU caches a few buffers of
+// each size that it can hand out without taking a lock. Only when that cache runs empty or overflows do
+// buffers move in batches from or to a shared list.
+class PacketBufferPool {
+    AK_MAKE_NONCOPYABLE(PacketBufferPool);
+    AK_MAKE_NONMOVABLE(PacketBufferPool);
+
+public:
+    struct Statistics {
+        u64 cpu_cache_hits { 0 };
+        u64 shared_list_hits { 0 };
+        u64 allocations { 0 };
+        u64 allocation_failures { 0 };
+        u64 frees { 0 };
+    };
+
+    PacketBufferPool() = default;
+
+    LockRefPtr<PacketWithTimestamp> acquire(size_t size);
+    // NOTE: The packet must not be on any list anymore.
+    void release(PacketWithTimestamp&);
+
+    // Buffers of the previous sizes are freed as they come by.
+    void set_buffer_sizes(size_t standard_size, size_t large_size);
+
+    Statistics statistics() const;
+
+private:
+    using PacketList = IntrusiveList<&PacketWithTimestamp::packet_node>;
+
+    struct CachedPackets {
+        PacketList list;
+        size_t count { 0 };
+    };
+
+    struct SizeClass {
+        SizeClass(size_t max_cpu_cache_count, size_t max_shared_count)
+            : max_cpu_cache_count(max_cpu_cache_count)
+            , max_shared_count(max_shared_count)
+        {
+        }
+
+        Atomic<size_t> buffer_size { 0 };
+        size_t const max_cpu_cache_count;
+        size_t const max_shared_count;
+        // NOTE: A CPU only touches its own cache, and only with interrupts disabled.
+        Array<CachedPackets, MAX_CPU_COUNT> cpu_caches;
+        SpinlockProtected<CachedPackets, LockRank::None> shared_list {};
+    };
+
+    SizeClass* size_class_for(size_t size);
+    LockRefPtr<PacketWithTimestamp> take_cached(SizeClass&);
+    LockRefPtr<PacketWithTimestamp> allocate(size_t buffer_size);
+
+    SizeClass m_standard { 64, 1024 };
+    SizeClass m_large { 4, 16 };
+
+    Atomic<u64> m_cpu_cache_hits { 0 };
+    Atomic<u64> m_shared_list_hits { 0 };
+    Atomic<u64> m_allocations { 0 };
+    Atomic<u64> m_allocation_failures { 0 };
+    Atomic<u64> m_frees { 0 };
+};
+
+}
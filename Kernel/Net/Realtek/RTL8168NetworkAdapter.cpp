@@ -7,7 +7,10 @@
 #include <AK/MACAddress.h>
 #include <Kernel/Bus/PCI/API.h>
 #include <Kernel/Bus/PCI/IDs.h>
+#include <Kernel/CommandLine.h>
 #include <Kernel/Debug.h>
+#include <Kernel/Net/EthernetFrameHeader.h>
+#include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/NetworkingManagement.h>
 #include <Kernel/Net/Realtek/RTL8168NetworkAdapter.h>
 #include <Kernel/Sections.h>
@@ -82,6 +85,14 @@ namespace Kernel {
 #define INT_RX_FIFO_OVERFLOW 0x40
 #define INT_SYS_ERR 0x8000
 
+// Masked while NetworkTask polls the RX ring.
+static constexpr u16 receive_interrupts = INT_RXOK | INT_RXERR | INT_RX_OVERFLOW | INT_RX_FIFO_OVERFLOW;
+
+// Values for REG_INT_MOD, see end_receive_polling(). The bulk one is magic from the vendor (Linux Driver uses 0x5151,
+// *BSD Driver uses 0x5100, RTL Driver use 0x5f51???)
+static constexpr u16 low_latency_interrupt_moderation = 0;
+static constexpr u16 bulk_interrupt_moderation = 0x5151;
+
 #define CFG9346_NONE 0x00
 #define CFG9346_EEM0 0x40
 #define CFG9346_EEM1 0x80
@@ -180,6 +191,8 @@ namespace Kernel {
 #define PHYSTATUS_10M 0x04
 
 #define TX_BUFFER_SIZE 0x1FF8
+#define TX_MAX_SEGMENTS_PER_FRAME 8 // large sends may use up to half of the TX ring
+#define MIN_FRAME_SIZE 60
 #define RX_BUFFER_SIZE 0x1FF8 // FIXME: this should be increased (0x3FFF)
 
 UNMAP_AFTER_INIT ErrorOr<bool> RTL8168NetworkAdapter::probe(PCI::DeviceIdentifier const& pci_device_identifier)
@@ -249,7 +262,8 @@ UNMAP_AFTER_INIT RTL8168NetworkAdapter::RTL8168NetworkAdapter(PCI::DeviceIdentif
     , PCI::Device(device_identifier)
     , IRQHandler(irq)
     , m_registers_io_window(move(registers_io_window))
-    , m_rx_descriptors_region(MM.allocate_contiguous_kernel_region(Memory::page_round_up(sizeof(TXDescriptor) * (number_of_rx_descriptors + 1)).release_value_but_fixme_should_propagate_errors(), "RTL8168 RX"sv, Memory::Region::Access::ReadWrite).release_value())
+    , m_rx_descriptor_count(clamp<size_t>(kernel_command_line().network_rx_descriptor_count().value_or(default_number_of_rx_descriptors), 64, 1024))
+    , m_rx_descriptors_region(MM.allocate_contiguous_kernel_region(Memory::page_round_up(sizeof(TXDescriptor) * (m_rx_descriptor_count + 1)).release_value_but_fixme_should_propagate_errors(), "RTL8168 RX"sv, Memory::Region::Access::ReadWrite).release_value())
     , m_tx_descriptors_region(MM.allocate_contiguous_kernel_region(Memory::page_round_up(sizeof(RXDescriptor) * (number_of_tx_descriptors + 1)).release_value_but_fixme_should_propagate_errors(), "RTL8168 TX"sv, Memory::Region::Access::ReadWrite).release_value())
 {
     dmesgln_pci(*this, "Found @ {}", device_identifier.address());
@@ -374,6 +388,12 @@ void RTL8168NetworkAdapter::startup()
     out16(REG_CPLUS_COMMAND, cplus_command);
     in16(REG_CPLUS_COMMAND); // C+ Command barrier
 
+    // The checksum offload bits moved to the second descriptor dword after the RTL8168B.
+    if (m_version >= ChipVersion::Version4)
+        set_offloads(NetworkOffload::TransmitTCPChecksum | NetworkOffload::ReceiveChecksum | NetworkOffload::TCPSegmentation, TX_MAX_SEGMENTS_PER_FRAME * TX_BUFFER_SIZE);
+    else
+        set_offloads(NetworkOffload::ReceiveChecksum);
+
     // power up phy
     if (m_version >= ChipVersion::Version9 && m_version <= ChipVersion::Version15) {
         out8(REG_PMCH, in8(REG_PMCH) | 0x80);
@@ -394,12 +414,12 @@ void RTL8168NetworkAdapter::startup()
     start_hardware();
 
     // re-enable interrupts
-    auto enabled_interrupts = INT_RXOK | INT_RXERR | INT_TXOK | INT_TXERR | INT_RX_OVERFLOW | INT_LINK_CHANGE | INT_SYS_ERR;
+    m_enabled_interrupts = INT_RXOK | INT_RXERR | INT_TXOK | INT_TXERR | INT_RX_OVERFLOW | INT_LINK_CHANGE | INT_SYS_ERR;
     if (m_version == ChipVersion::Version1) {
-        enabled_interrupts |= INT_RX_FIFO_OVERFLOW;
-        enabled_interrupts &= ~INT_RX_OVERFLOW;
+        m_enabled_interrupts |= INT_RX_FIFO_OVERFLOW;
+        m_enabled_interrupts &= ~INT_RX_OVERFLOW;
     }
-    out16(REG_IMR, enabled_interrupts);
+    out16(REG_IMR, m_enabled_interrupts);
 
     // update link status
     m_link_up = (in8(REG_PHYSTATUS) & PHY_LINK_STATUS) != 0;
@@ -808,8 +828,9 @@ void RTL8168NetworkAdapter::start_hardware()
     cplus_command |= 0x1;
     out16(REG_CPLUS_COMMAND, cplus_command);
 
-    // setup interrupt moderation, magic from vendor (Linux Driver uses 0x5151, *BSD Driver uses 0x5100, RTL Driver use 0x5f51???)
-    out16(REG_INT_MOD, 0x5151);
+    // setup interrupt moderation
+    m_interrupt_moderation = bulk_interrupt_moderation;
+    out16(REG_INT_MOD, m_interrupt_moderation);
 
     // point to tx descriptors
     out64(REG_TXADDR, m_tx_descriptors_region->physical_page(0)->paddr().get());
@@ -1095,7 +1116,7 @@ void RTL8168NetworkAdapter::set_phy_speed()
 UNMAP_AFTER_INIT void RTL8168NetworkAdapter::initialize_rx_descriptors()
 {
     auto* rx_descriptors = (RXDescriptor*)m_rx_descriptors_region->vaddr().as_ptr();
-    for (size_t i = 0; i < number_of_rx_descriptors; ++i) {
+    for (size_t i = 0; i < m_rx_descriptor_count; ++i) {
         auto& descriptor = rx_descriptors[i];
         auto region = MM.allocate_contiguous_kernel_region(Memory::page_round_up(RX_BUFFER_SIZE).release_value_but_fixme_should_propagate_errors(), "RTL8168 RX buffer"sv, Memory::Region::Access::ReadWrite).release_value();
         memset(region->vaddr().as_ptr(), 0, region->size()); // MM already zeros out newly allocated pages, but we do it again in case that ever changes
@@ -1107,7 +1128,7 @@ UNMAP_AFTER_INIT void RTL8168NetworkAdapter::initialize_rx_descriptors()
         descriptor.buffer_address_low = physical_address & 0xFFFFFFFF;
         descriptor.buffer_address_high = (u64)physical_address >> 32; // cast to prevent shift count >= with of type warnings in 32 bit systems
     }
-    rx_descriptors[number_of_rx_descriptors - 1].flags = rx_descriptors[number_of_rx_descriptors - 1].flags | RXDescriptor::EndOfRing;
+    rx_descriptors[m_rx_descriptor_count - 1].flags = rx_descriptors[m_rx_descriptor_count - 1].flags | RXDescriptor::EndOfRing;
 }
 
 UNMAP_AFTER_INIT void RTL8168NetworkAdapter::initialize_tx_descriptors()
@@ -1133,7 +1154,11 @@ bool RTL8168NetworkAdapter::handle_irq(RegisterState const&)
 {
     bool was_handled = false;
     for (;;) {
+        // NOTE: The receive statuses are left alone while NetworkTask is polling the RX ring, so that a packet that arrives
+        //       just before end_receive_polling() unmasks them still raises an interrupt.
         int status = in16(REG_ISR);
+        if (m_receive_interrupts_masked)
+            status &= ~receive_interrupts;
         out16(REG_ISR, status);
 
         m_entropy_source.add_random_event(status);
@@ -1146,7 +1171,6 @@ bool RTL8168NetworkAdapter::handle_irq(RegisterState const&)
         was_handled = true;
         if (status & INT_RXOK) {
             dbgln_if(RTL8168_DEBUG, "RTL8168: RX ready");
-            receive();
         }
         if (status & INT_RXERR) {
             dbgln_if(RTL8168_DEBUG, "RTL8168: RX error - invalid packet");
@@ -1160,7 +1184,6 @@ bool RTL8168NetworkAdapter::handle_irq(RegisterState const&)
         }
         if (status & INT_RX_OVERFLOW) {
             dmesgln_pci(*this, "RX descriptor unavailable (packet lost)");
-            receive();
         }
         if (status & INT_LINK_CHANGE) {
             m_link_up = (in8(REG_PHYSTATUS) & PHY_LINK_STATUS) != 0;
@@ -1168,11 +1191,15 @@ bool RTL8168NetworkAdapter::handle_irq(RegisterState const&)
         }
         if (status & INT_RX_FIFO_OVERFLOW) {
             dmesgln_pci(*this, "RX FIFO overflow");
-            receive();
         }
         if (status & INT_SYS_ERR) {
             dmesgln_pci(*this, "Fatal system error");
         }
+        if (status & receive_interrupts) {
+            m_receive_interrupts_masked = true;
+            out16(REG_IMR, m_enabled_interrupts & ~receive_interrupts);
+            schedule_receive_poll();
+        }
     }
     return was_handled;
 }
@@ -1193,47 +1220,121 @@ UNMAP_AFTER_INIT void RTL8168NetworkAdapter::read_mac_address()
 }
 
 void RTL8168NetworkAdapter::send_raw(ReadonlyBytes payload)
+{
+    transmit(payload, nullptr);
+}
+
+void RTL8168NetworkAdapter::send_raw_with_offload(ReadonlyBytes payload, TransmitOffload const& offload)
+{
+    transmit(payload, &offload);
+}
+
+void RTL8168NetworkAdapter::transmit(ReadonlyBytes payload, TransmitOffload const* offload)
 {
     dbgln_if(RTL8168_DEBUG, "RTL8168: send_raw length={}", payload.size());
 
-    if (payload.size() > TX_BUFFER_SIZE) {
+    if (payload.size() > (offload ? max_segmentation_frame_size() : TX_BUFFER_SIZE)) {
         dmesgln_pci(*this, "Packet was too big; discarding");
         return;
     }
 
+    u16 offload_flags = 0;
+    u16 offload_vlan_flags = 0;
+    size_t frame_size = payload.size();
+    if (offload) {
+        VERIFY(payload.size() >= sizeof(EthernetFrameHeader) + sizeof(IPv4Packet));
+        auto const& ipv4_packet = *reinterpret_cast<IPv4Packet const*>(payload.offset(sizeof(EthernetFrameHeader)));
+        u16 tcp_header_offset = sizeof(EthernetFrameHeader) + ipv4_packet.internet_header_length() * sizeof(u32);
+        if (offload->tcp_segment_size != 0) {
+            offload_flags = TXDescriptor::GiantSendIPv4 | (tcp_header_offset << TXDescriptor::GiantSendTCPHeaderOffsetShift);
+            offload_vlan_flags = offload->tcp_segment_size << TXDescriptor::MaximumSegmentSizeShift;
+        } else {
+            offload_vlan_flags = TXDescriptor::IPv4Checksum | TXDescriptor::TCPChecksum | (tcp_header_offset << TXDescriptor::TCPHeaderOffsetShift);
+        }
+        // NOTE: Some revisions compute wrong checksums for frames that they have to pad themselves.
+        frame_size = max(frame_size, static_cast<size_t>(MIN_FRAME_SIZE));
+    }
+
+    MutexLocker locker(m_tx_lock);
     auto* tx_descriptors = (TXDescriptor*)m_tx_descriptors_region->vaddr().as_ptr();
-    auto& free_descriptor = tx_descriptors[m_tx_free_index];
+    size_t descriptor_count = ceil_div(frame_size, static_cast<size_t>(TX_BUFFER_SIZE));
+    VERIFY(descriptor_count <= TX_MAX_SEGMENTS_PER_FRAME);
 
-    if ((free_descriptor.flags & TXDescriptor::Ownership) != 0) {
+    auto descriptors_are_free = [&] {
+        for (size_t i = 0; i < descriptor_count; ++i) {
+            if ((tx_descriptors[(m_tx_free_index + i) % number_of_tx_descriptors].flags & TXDescriptor::Ownership) != 0)
+                return false;
+        }
+        return true;
+    };
+    while (!descriptors_are_free()) {
         dbgln_if(RTL8168_DEBUG, "RTL8168: No free TX buffers, sleeping until one is available");
         m_wait_queue.wait_forever("RTL8168NetworkAdapter"sv);
-        return send_raw(payload);
-        // if we woke up a TX descriptor is guaranteed to be available, so this should never recurse more than once
-        // but this can probably be done more cleanly
     }
 
-    dbgln_if(RTL8168_DEBUG, "RTL8168: Chose descriptor {}", m_tx_free_index);
-    memcpy(m_tx_buffers_regions[m_tx_free_index].vaddr().as_ptr(), payload.data(), payload.size());
-
-    m_tx_free_index = (m_tx_free_index + 1) % number_of_tx_descriptors;
-
-    free_descriptor.frame_length = payload.size() & 0x3FFF;
-    free_descriptor.flags = free_descriptor.flags | TXDescriptor::Ownership;
+    dbgln_if(RTL8168_DEBUG, "RTL8168: Chose descriptors {} to {}", m_tx_free_index, (m_tx_free_index + descriptor_count - 1) % number_of_tx_descriptors);
+    auto first_descriptor_index = m_tx_free_index;
+    u16 first_descriptor_flags = 0;
+    for (size_t i = 0; i < descriptor_count; ++i) {
+        auto descriptor_index = m_tx_free_index;
+        auto& descriptor = tx_descriptors[descriptor_index];
+        size_t offset = i * TX_BUFFER_SIZE;
+        size_t segment_size = min(frame_size - offset, static_cast<size_t>(TX_BUFFER_SIZE));
+        auto* buffer = m_tx_buffers_regions[descriptor_index].vaddr().as_ptr();
+        size_t bytes_to_copy = offset < payload.size() ? min(payload.size() - offset, segment_size) : 0;
+        memcpy(buffer, payload.offset(offset), bytes_to_copy);
+        memset(buffer + bytes_to_copy, 0, segment_size - bytes_to_copy);
+
+        descriptor.frame_length = segment_size & 0x3FFF;
+        descriptor.vlan_tag = 0;
+        descriptor.vlan_flags = offload_vlan_flags;
+        u16 flags = offload_flags;
+        if (i == 0)
+            flags |= TXDescriptor::FirstSegment;
+        if (i == descriptor_count - 1)
+            flags |= TXDescriptor::LastSegment;
+        if (descriptor_index == number_of_tx_descriptors - 1)
+            flags |= TXDescriptor::EndOfRing;
+        // The NIC may only see the first descriptor once all the others of this frame are ready.
+        if (i == 0)
+            first_descriptor_flags = flags;
+        else
+            descriptor.flags = flags | TXDescriptor::Ownership;
+
+        m_tx_free_index = (m_tx_free_index + 1) % number_of_tx_descriptors;
+    }
+    tx_descriptors[first_descriptor_index].flags = first_descriptor_flags | TXDescriptor::Ownership;
 
     out8(REG_TXSTART, TXSTART_START); // FIXME: this shouldn't be done so often, we should look into doing this using the watchdog timer
 }
 
-void RTL8168NetworkAdapter::receive()
+bool RTL8168NetworkAdapter::has_bad_checksum(RXDescriptor const& descriptor)
+{
+    u16 buffer_size = descriptor.buffer_size;
+    u16 flags = descriptor.flags;
+    auto protocol = flags & RXDescriptor::ProtocolMask;
+    // Non-IP packets have no checksum the NIC could have verified.
+    if (protocol == 0)
+        return false;
+    if ((flags & RXDescriptor::IPChecksumFailed) != 0)
+        return true;
+    if (protocol == RXDescriptor::ProtocolTCP)
+        return (buffer_size & RXDescriptor::TCPChecksumFailed) != 0;
+    if (protocol == RXDescriptor::ProtocolUDP)
+        return (buffer_size & RXDescriptor::UDPChecksumFailed) != 0;
+    return false;
+}
+
+size_t RTL8168NetworkAdapter::poll_rx_ring(size_t budget)
 {
     auto* rx_descriptors = (RXDescriptor*)m_rx_descriptors_region->vaddr().as_ptr();
-    for (u16 i = 0; i < number_of_rx_descriptors; ++i) {
-        auto descriptor_index = (m_rx_free_index + i) % number_of_rx_descriptors;
+    size_t packet_count = 0;
+    for (; packet_count < budget; ++packet_count) {
+        auto descriptor_index = m_rx_free_index;
         auto& descriptor = rx_descriptors[descriptor_index];
 
-        if ((descriptor.flags & RXDescriptor::Ownership) != 0) {
-            m_rx_free_index = descriptor_index;
+        if ((descriptor.flags & RXDescriptor::Ownership) != 0)
             break;
-        }
 
         u16 flags = descriptor.flags;
         u16 length = descriptor.buffer_size & 0x3FFF;
@@ -1246,16 +1347,33 @@ void RTL8168NetworkAdapter::receive()
             VERIFY_NOT_REACHED();
             // Our maximum received packet size is smaller than the descriptor buffer size, so packets should never be segmented
             // if this happens on a real NIC it might not respect that, and we will have to support packet segmentation
+        } else if (has_bad_checksum(descriptor)) {
+            dbgln_if(RTL8168_DEBUG, "RTL8168: Dropping packet with a bad checksum");
         } else {
             did_receive({ m_rx_buffers_regions[descriptor_index].vaddr().as_ptr(), length });
         }
 
         descriptor.buffer_size = RX_BUFFER_SIZE;
         flags = RXDescriptor::Ownership;
-        if (descriptor_index == number_of_rx_descriptors - 1)
+        if (descriptor_index == m_rx_descriptor_count - 1)
             flags |= RXDescriptor::EndOfRing;
         descriptor.flags = flags; // let the NIC know it can use this descriptor again
+        m_rx_free_index = (descriptor_index + 1) % m_rx_descriptor_count;
+    }
+    return packet_count;
+}
+
+void RTL8168NetworkAdapter::end_receive_polling(size_t packet_count)
+{
+    // Only moderate the interrupts once there are several packets per interrupt, otherwise it just adds latency.
+    auto moderation = packet_count <= 4 ? low_latency_interrupt_moderation : bulk_interrupt_moderation;
+    if (moderation != m_interrupt_moderation) {
+        dbgln_if(RTL8168_DEBUG, "RTL8168: Changing the interrupt moderation to {:#04x}", moderation);
+        m_interrupt_moderation = moderation;
+        out16(REG_INT_MOD, moderation);
     }
+    m_receive_interrupts_masked = false;
+    out16(REG_IMR, m_enabled_interrupts);
 }
 
 void RTL8168NetworkAdapter::out8(u16 address, u8 data)
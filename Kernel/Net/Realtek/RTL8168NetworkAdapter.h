@@ -12,6 +12,7 @@
 #include <Kernel/Bus/PCI/Device.h>
 #include <Kernel/IOWindow.h>
 #include <Kernel/Interrupts/IRQHandler.h>
+#include <Kernel/Locking/Mutex.h>
 #include <Kernel/Net/NetworkAdapter.h>
 #include <Kernel/Random.h>
 
@@ -29,6 +30,7 @@ public:
     virtual ~RTL8168NetworkAdapter() override;
 
     virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_with_offload(ReadonlyBytes, TransmitOffload const&) override;
     virtual bool link_up() override { return m_link_up; }
     virtual bool link_full_duplex() override;
     virtual i32 link_speed() override;
@@ -38,8 +40,8 @@ public:
     virtual Type adapter_type() const override { return Type::Ethernet; }
 
 private:
-    // FIXME: should this be increased? (maximum allowed here is 1024) - memory usage vs packet loss chance tradeoff
-    static constexpr size_t number_of_rx_descriptors = 64;
+    // Can be changed with the network_rx_descriptors boot parameter, the adapter allows at most 1024.
+    static constexpr size_t default_number_of_rx_descriptors = 256;
     static constexpr size_t number_of_tx_descriptors = 16;
 
     RTL8168NetworkAdapter(PCI::DeviceIdentifier const&, u8 irq, NonnullOwnPtr<IOWindow> registers_io_window, NonnullOwnPtr<KString>);
@@ -63,6 +65,15 @@ private:
         static constexpr u16 FirstSegment = 0x2000u;
         static constexpr u16 LastSegment = 0x1000u;
         static constexpr u16 LargeSend = 0x800u;
+        // NOTE: The following bits are only valid with the second version of the descriptor format.
+        static constexpr u16 GiantSendIPv4 = 0x400u;
+        static constexpr u16 GiantSendTCPHeaderOffsetShift = 2;
+
+        // vlan_flags bit field
+        static constexpr u16 IPv4Checksum = 0x2000u;
+        static constexpr u16 TCPChecksum = 0x4000u;
+        static constexpr u16 TCPHeaderOffsetShift = 2;
+        static constexpr u16 MaximumSegmentSizeShift = 2;
     };
 
     static_assert(AssertSize<TXDescriptor, 16u>());
@@ -87,6 +98,15 @@ private:
         static constexpr u16 ErrorSummary = 0x20;
         static constexpr u16 RuntPacket = 0x10;
         static constexpr u16 CRCError = 0x8;
+        // NOTE: These are only valid if checksum verification is enabled in the C+ command register.
+        static constexpr u16 ProtocolMask = 0x6;
+        static constexpr u16 ProtocolUDP = 0x2;
+        static constexpr u16 ProtocolTCP = 0x4;
+        static constexpr u16 IPChecksumFailed = 0x1;
+
+        // buffer_size bit field
+        static constexpr u16 UDPChecksumFailed = 0x8000u;
+        static constexpr u16 TCPChecksumFailed = 0x4000u;
     };
 
     static_assert(AssertSize<RXDescriptor, 16u>());
@@ -152,7 +172,10 @@ private:
     void initialize_rx_descriptors();
     void initialize_tx_descriptors();
 
-    void receive();
+    virtual size_t poll_rx_ring(size_t budget) override;
+    virtual void end_receive_polling(size_t packet_count) override;
+    void transmit(ReadonlyBytes, TransmitOffload const*);
+    static bool has_bad_checksum(RXDescriptor const&);
 
     void out8(u16 address, u8 data);
     void out16(u16 address, u16 data);
@@ -204,6 +227,10 @@ private:
     bool m_version_uncertain { true };
     NonnullOwnPtr<IOWindow> m_registers_io_window;
     u32 m_ocp_base_address { 0 };
+    u16 m_enabled_interrupts { 0 };
+    bool m_receive_interrupts_masked { false };
+    u16 m_interrupt_moderation { 0 };
+    size_t m_rx_descriptor_count { 0 };
     OwnPtr<Memory::Region> m_rx_descriptors_region;
     NonnullOwnPtrVector<Memory::Region> m_rx_buffers_regions;
     u16 m_rx_free_index { 0 };
@@ -213,5 +240,6 @@ private:
     bool m_link_up { false };
     EntropySource m_entropy_source;
     WaitQueue m_wait_queue;
+    Mutex m_tx_lock { "RTL8168NetworkAdapter TX"sv };
 };
 }
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Net/ReceivedPacketQueue.h>
+#include <Kernel/StdLib.h>
+
+namespace Kernel {
+
+ReceivedPacketQueue::ReceivedPacketQueue(size_t capacity)
+    : m_capacity(capacity)
+{
+}
+
+size_t ReceivedPacketQueue::record_size(size_t data_size)
+{
+    return align_up_to(sizeof(Header) + data_size, alignof(Header));
+}
+
+ReceivedPacketQueue::Header& ReceivedPacketQueue::header_at(size_t offset) const
+{
+    VERIFY(offset + sizeof(Header) <= ring_size());
+    return *reinterpret_cast<Header*>(m_storage->data() + offset);
+}
+
+ErrorOr<void> ReceivedPacketQueue::try_enqueue(IPv4Address const& peer_address, u16 peer_port, Time const& timestamp, ReadonlyBytes data)
+{
+    if (is_empty()) {
+        m_head = 0;
+        m_tail = 0;
+        m_used = 0;
+        // The ring is only allocated once something arrives, and reallocated if the capacity changed in the meantime.
+        if (m_storage && m_storage->size() != m_capacity)
+            m_storage = nullptr;
+        if (!m_storage)
+            m_storage = TRY(KBuffer::try_create_with_size("IPv4Socket: Receive queue"sv, m_capacity));
+    }
+
+    auto size = record_size(data.size());
+    auto needed = size;
+    bool wrap = false;
+    // While the used part of the ring doesn't wrap around, the free part does. If the packet doesn't fit before the end,
+    // the rest of the ring is skipped.
+    if (m_tail >= m_head && size > ring_size() - m_tail) {
+        needed += ring_size() - m_tail;
+        wrap = true;
+    }
+    if (data.size() > NumericLimits<u32>::max() || m_used + needed > ring_size())
+        return ENOBUFS;
+
+    if (wrap) {
+        if (ring_size() - m_tail >= sizeof(Header))
+            header_at(m_tail).size = wrap_marker;
+        m_tail = 0;
+    }
+    header_at(m_tail) = {
+        .peer_address = peer_address,
+        .peer_port = peer_port,
+        .size = static_cast<u32>(data.size()),
+        .timestamp = timestamp,
+    };
+    memcpy(m_storage->data() + m_tail + sizeof(Header), data.data(), data.size());
+    m_tail += size;
+    if (m_tail == ring_size())
+        m_tail = 0;
+    m_used += needed;
+    ++m_count;
+    return {};
+}
+
+ReceivedPacketQueue::Packet ReceivedPacketQueue::first() const
+{
+    VERIFY(!is_empty());
+    auto& header = header_at(m_head);
+    return {
+        .peer_address = header.peer_address,
+        .peer_port = header.peer_port,
+        .timestamp = header.timestamp,
+        .data = { m_storage->data() + m_head + sizeof(Header), header.size },
+    };
+}
+
+void ReceivedPacketQueue::dequeue()
+{
+    VERIFY(!is_empty());
+    auto size = record_size(header_at(m_head).size);
+    m_head += size;
+    if (m_head == ring_size())
+        m_head = 0;
+    m_used -= size;
+    --m_count;
+    if (!is_empty())
+        skip_wrap_marker();
+}
+
+void ReceivedPacketQueue::skip_wrap_marker()
+{
+    // The end of the ring was skipped if it's too small for a header, or if it starts with a wrap marker.
+    auto rest_of_ring = ring_size() - m_head;
+    if (rest_of_ring >= sizeof(Header) && header_at(m_head).size != wrap_marker)
+        return;
+    m_used -= rest_of_ring;
+    m_head = 0;
+}
+
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Noncopyable.h>
+#include <AK/OwnPtr.h>
+#include <AK/Time.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Net/IPv4.h>
+
+namespace Kernel {
+
+// The packets that a datagram socket has received but that haven't been read yet.
+//
+// They're stored back to back in a ring buffer of a fixed number of bytes, so that receiving a packet doesn't
+// allocate and a socket can't hold on to more memory than it was given. A packet that doesn't fit into the
+// rest of the ring starts over at the beginning, leaving the end unused until the reader gets there.
+//
+// NOTE: This isn't synchronized, the socket's mutex protects it.
+class ReceivedPacketQueue {
+    AK_MAKE_NONCOPYABLE(ReceivedPacketQueue);
+    AK_MAKE_NONMOVABLE(ReceivedPacketQueue);
+
+public:
+    struct Packet {
+        IPv4Address peer_address;
+        u16 peer_port { 0 };
+        Time timestamp;
+        // Points into the ring, and is only valid until the packet is dequeued.
+        ReadonlyBytes data;
+    };
+
+    explicit ReceivedPacketQueue(size_t capacity);
+
+    bool is_empty() const { return m_count == 0; }
+    size_t count() const { return m_count; }
+
+    size_t capacity() const { return m_capacity; }
+    // The ring is resized once it's empty.
+    void set_capacity(size_t capacity) { m_capacity = capacity; }
+
+    // Fails with ENOBUFS if there's no room for the packet.
+    ErrorOr<void> try_enqueue(IPv4Address const& peer_address, u16 peer_port, Time const& timestamp, ReadonlyBytes data);
+
+    Packet first() const;
+    void dequeue();
+
+private:
+    struct Header {
+        IPv4Address peer_address;
+        u16 peer_port { 0 };
+        u32 size { 0 };
+        Time timestamp;
+    };
+    // Marks that the next packet is at the start of the ring.
+    static constexpr u32 wrap_marker = NumericLimits<u32>::max();
+
+    static size_t record_size(size_t data_size);
+    size_t ring_size() const { return m_storage ? m_storage->size() : 0; }
+    Header& header_at(size_t offset) const;
+    void skip_wrap_marker();
+
+    OwnPtr<KBuffer> m_storage;
+    size_t m_capacity { 0 };
+    // Offsets of the first packet and of where the next one goes.
+    size_t m_head { 0 };
+    size_t m_tail { 0 };
+    // Bytes between the two, including any that are skipped at the end of the ring.
+    size_t m_used { 0 };
+    size_t m_count { 0 };
+};
+
+}
@@ -7,7 +7,9 @@
 #include <AK/StringView.h>
 #include <Kernel/API/POSIX/errno.h>
 #include <Kernel/Debug.h>
+#include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/KBuffer.h>
 #include <Kernel/Net/IPv4Socket.h>
 #include <Kernel/Net/LocalSocket.h>
 #include <Kernel/Net/NetworkingManagement.h>
@@ -107,7 +109,7 @@ ErrorOr<void> Socket::setsockopt(int level, int option, Userspace<void const*> u
         // NOTE: This is supposed to toggle collection of debugging information on/off, we don't have any right now, so this is a no-op.
         return {};
     case SO_KEEPALIVE:
-        // FIXME: Obviously, this is not a real keepalive.
+        // NOTE: TCPSocket takes care of keepalive itself, there is nothing to keep alive for any other socket.
         return {};
     case SO_TIMESTAMP:
         if (user_value_size != sizeof(int))
@@ -252,6 +254,19 @@ ErrorOr<size_t> Socket::write(OpenFileDescription& description, u64, UserOrKerne
     return sendto(description, data, size, 0, {}, 0);
 }
 
+static constexpr size_t send_from_inode_buffer_size = 64 * KiB;
+
+ErrorOr<size_t> Socket::send_from_inode(OpenFileDescription& description, Inode& inode, off_t offset, size_t size)
+{
+    // NOTE: Sockets that can't read the inode straight into their own buffers still save the trips through userspace.
+    auto buffer = TRY(KBuffer::try_create_with_size("Socket: sendfile buffer"sv, min(size, send_from_inode_buffer_size)));
+    auto kernel_buffer = UserOrKernelBuffer::for_kernel_buffer(buffer->data());
+    auto nread = TRY(inode.read_bytes(offset, buffer->size(), kernel_buffer, nullptr));
+    if (nread == 0)
+        return 0;
+    return write(description, 0, kernel_buffer, nread);
+}
+
 ErrorOr<void> Socket::shutdown(int how)
 {
     MutexLocker locker(mutex());
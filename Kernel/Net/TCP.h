@@ -21,6 +21,15 @@ struct TCPFlags {
     };
 };
 
+enum class TCPOptionKind : u8 {
+    End = 0,
+    NoOperation = 1,
+    MSS = 2,
+    WindowScale = 3,
+    SACKPermitted = 4,
+    SACK = 5,
+};
+
 class [[gnu::packed]] TCPOptionMSS {
 public:
     TCPOptionMSS(u16 value)
@@ -38,6 +47,43 @@ private:
 
 static_assert(AssertSize<TCPOptionMSS, 4>());
 
+class [[gnu::packed]] TCPOptionWindowScale {
+public:
+    TCPOptionWindowScale(u8 shift_count)
+        : m_shift_count(shift_count)
+    {
+    }
+
+    u8 shift_count() const { return m_shift_count; }
+
+private:
+    u8 m_option_kind { 0x03 };
+    u8 m_option_length { sizeof(TCPOptionWindowScale) };
+    u8 m_shift_count { 0 };
+};
+
+static_assert(AssertSize<TCPOptionWindowScale, 3>());
+
+class [[gnu::packed]] TCPOptionSACKPermitted {
+private:
+    u8 m_option_kind { 0x04 };
+    u8 m_option_length { sizeof(TCPOptionSACKPermitted) };
+};
+
+static_assert(AssertSize<TCPOptionSACKPermitted, 2>());
+
+class [[gnu::packed]] TCPSACKBlock {
+public:
+    u32 left_edge() const { return m_left_edge; }
+    u32 right_edge() const { return m_right_edge; }
+
+private:
+    NetworkOrdered<u32> m_left_edge;
+    NetworkOrdered<u32> m_right_edge;
+};
+
+static_assert(AssertSize<TCPSACKBlock, 8>());
+
 class [[gnu::packed]] TCPPacket {
 public:
     TCPPacket() = default;
@@ -77,6 +123,8 @@ public:
     u16 urgent() const { return m_urgent; }
     void set_urgent(u16 urgent) { m_urgent = urgent; }
 
+    ReadonlyBytes options() const { return { ((u8 const*)this) + sizeof(TCPPacket), max(header_size(), sizeof(TCPPacket)) - sizeof(TCPPacket) }; }
+
     void const* payload() const { return ((u8 const*)this) + header_size(); }
     void* payload() { return ((u8*)this) + header_size(); }
 
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/OwnPtr.h>
+#include <Kernel/Net/TCPCongestionControl.h>
+
+namespace Kernel {
+
+static Atomic<TCPCongestionControl::Algorithm> s_default_algorithm { TCPCongestionControl::Algorithm::Cubic };
+
+StringView TCPCongestionControl::to_string(Algorithm algorithm)
+{
+    switch (algorithm) {
+    case Algorithm::NewReno:
+        return "newreno"sv;
+    case Algorithm::Cubic:
+        return "cubic"sv;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+Optional<TCPCongestionControl::Algorithm> TCPCongestionControl::algorithm_from_string(StringView name)
+{
+    if (name == "newreno"sv)
+        return Algorithm::NewReno;
+    if (name == "cubic"sv)
+        return Algorithm::Cubic;
+    return {};
+}
+
+TCPCongestionControl::Algorithm TCPCongestionControl::default_algorithm()
+{
+    return s_default_algorithm.load(AK::MemoryOrder::memory_order_relaxed);
+}
+
+void TCPCongestionControl::set_default_algorithm(Algorithm algorithm)
+{
+    s_default_algorithm.store(algorithm, AK::MemoryOrder::memory_order_relaxed);
+}
+
+ErrorOr<NonnullOwnPtr<TCPCongestionControl>> TCPCongestionControl::try_create(Algorithm algorithm)
+{
+    switch (algorithm) {
+    case Algorithm::NewReno:
+        return TRY(adopt_nonnull_own_or_enomem(new (nothrow) TCPNewReno));
+    case Algorithm::Cubic:
+        return TRY(adopt_nonnull_own_or_enomem(new (nothrow) TCPCubic));
+    }
+    VERIFY_NOT_REACHED();
+}
+
+void TCPCongestionControl::initialize(size_t maximum_segment_size)
+{
+    m_maximum_segment_size = maximum_segment_size;
+    // RFC6928 says we can start out with (about) ten segments.
+    m_congestion_window = min(10 * maximum_segment_size, max(2 * maximum_segment_size, 14600));
+    m_slow_start_threshold = NumericLimits<size_t>::max();
+}
+
+size_t TCPCongestionControl::slow_start(size_t acknowledged_bytes)
+{
+    if (!is_in_slow_start())
+        return acknowledged_bytes;
+    // RFC5681 says we shouldn't grow by more than a segment per ACK, to not burst after stretch ACKs.
+    auto increase = min(acknowledged_bytes, m_maximum_segment_size);
+    m_congestion_window = min(m_congestion_window + increase, m_slow_start_threshold);
+    return acknowledged_bytes - increase;
+}
+
+void TCPCongestionControl::on_retransmit_timeout(size_t bytes_in_flight, Time const&)
+{
+    // RFC5681 says we have to go back to slow start with a window of one segment.
+    m_slow_start_threshold = max(bytes_in_flight / 2, 2 * m_maximum_segment_size);
+    m_congestion_window = m_maximum_segment_size;
+}
+
+void TCPNewReno::on_ack(size_t acknowledged_bytes, Time const&, Time const&)
+{
+    acknowledged_bytes = slow_start(acknowledged_bytes);
+    if (is_in_slow_start() || acknowledged_bytes == 0)
+        return;
+
+    // Congestion avoidance: grow the window by one segment per window of acknowledged data (RFC3465).
+    m_bytes_acknowledged += acknowledged_bytes;
+    if (m_bytes_acknowledged >= m_congestion_window) {
+        m_bytes_acknowledged -= m_congestion_window;
+        m_congestion_window += m_maximum_segment_size;
+    }
+}
+
+void TCPNewReno::on_congestion_event(size_t bytes_in_flight, Time const&)
+{
+    m_slow_start_threshold = max(bytes_in_flight / 2, 2 * m_maximum_segment_size);
+    m_congestion_window = m_slow_start_threshold;
+    m_bytes_acknowledged = 0;
+}
+
+// NOTE: The kernel can't use floating point, so the constants of RFC9438 are applied as fractions:
+//       C = 0.4 segments per second cubed, and beta = 0.7.
+static constexpr u64 cubic_beta_numerator = 7;
+static constexpr u64 cubic_beta_denominator = 10;
+
+static u64 integer_cube_root(u64 value)
+{
+    // The cube root of the largest u64 is just above this.
+    u64 low = 0;
+    u64 high = 2642245;
+    while (low < high) {
+        auto middle = (low + high + 1) / 2;
+        if (middle * middle * middle <= value)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
+
+i64 TCPCubic::window_at(i64 milliseconds_since_epoch_start) const
+{
+    // W_cubic(t) = C * (t - K)^3 + W_max
+    auto offset = clamp(milliseconds_since_epoch_start - m_milliseconds_to_maximum_window, -100'000, 100'000);
+    // C * offset^3 in ten-thousandths of a segment, with offset in milliseconds.
+    auto segments_e4 = 4 * offset * offset * offset / 1'000'000;
+    return static_cast<i64>(m_maximum_window) + segments_e4 * static_cast<i64>(m_maximum_segment_size) / 10'000;
+}
+
+void TCPCubic::on_ack(size_t acknowledged_bytes, Time const& now, Time const& smoothed_round_trip_time)
+{
+    acknowledged_bytes = slow_start(acknowledged_bytes);
+    if (is_in_slow_start() || acknowledged_bytes == 0)
+        return;
+
+    if (!m_epoch_start.has_value()) {
+        m_epoch_start = now;
+        m_pending_increase = 0;
+        m_reno_window = m_congestion_window;
+        if (m_congestion_window < m_maximum_window) {
+            // K = cbrt((W_max - cwnd) / C), in milliseconds.
+            u64 missing_bytes = min(m_maximum_window - m_congestion_window, NumericLimits<u32>::max());
+            m_milliseconds_to_maximum_window = static_cast<i64>(integer_cube_root(2'500'000'000ull * missing_bytes / m_maximum_segment_size));
+        } else {
+            m_milliseconds_to_maximum_window = 0;
+            m_maximum_window = m_congestion_window;
+        }
+    }
+
+    // Aim for where the curve will be one round trip from now, but don't grow by more than half the window per round trip.
+    auto elapsed = (now - m_epoch_start.value() + smoothed_round_trip_time).to_milliseconds();
+    auto target = clamp(window_at(elapsed), static_cast<i64>(m_congestion_window), static_cast<i64>(m_congestion_window + m_congestion_window / 2));
+
+    // Reno-friendly region: alpha = 3 * (1 - beta) / (1 + beta), which is 9/17.
+    m_reno_window += 9 * m_maximum_segment_size * acknowledged_bytes / (17 * m_congestion_window);
+    if (static_cast<i64>(m_reno_window) > target)
+        target = static_cast<i64>(m_reno_window);
+
+    m_pending_increase += static_cast<u64>(target - static_cast<i64>(m_congestion_window)) * acknowledged_bytes;
+    m_congestion_window += m_pending_increase / m_congestion_window;
+    m_pending_increase %= m_congestion_window;
+}
+
+void TCPCubic::on_congestion_event(size_t, Time const&)
+{
+    m_epoch_start.clear();
+    // Fast convergence: if we didn't get back to where we were before, leave some room to other connections.
+    if (m_congestion_window < m_maximum_window)
+        m_maximum_window = m_congestion_window * (cubic_beta_denominator + cubic_beta_numerator) / (2 * cubic_beta_denominator);
+    else
+        m_maximum_window = m_congestion_window;
+
+    m_slow_start_threshold = max(m_congestion_window * cubic_beta_numerator / cubic_beta_denominator, 2 * m_maximum_segment_size);
+    m_congestion_window = m_slow_start_threshold;
+}
+
+void TCPCubic::on_retransmit_timeout(size_t bytes_in_flight, Time const& now)
+{
+    on_congestion_event(bytes_in_flight, now);
+    m_congestion_window = m_maximum_segment_size;
+}
+
+}
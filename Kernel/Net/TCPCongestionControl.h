@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// Decides how much unacknowledged data a TCP connection may have in flight.
+// The socket takes care of detecting loss and retransmitting, the algorithm only looks after the congestion window.
+class TCPCongestionControl {
+public:
+    enum class Algorithm {
+        NewReno,
+        Cubic,
+    };
+
+    static StringView to_string(Algorithm);
+    static Optional<Algorithm> algorithm_from_string(StringView);
+
+    // The algorithm that new connections use.
+    static Algorithm default_algorithm();
+    static void set_default_algorithm(Algorithm);
+
+    static ErrorOr<NonnullOwnPtr<TCPCongestionControl>> try_create(Algorithm);
+
+    virtual ~TCPCongestionControl() = default;
+
+    virtual Algorithm algorithm() const = 0;
+
+    // Has to be called once the handshake is done and the segment size of the connection is known.
+    void initialize(size_t maximum_segment_size);
+
+    size_t congestion_window() const { return m_congestion_window; }
+    size_t slow_start_threshold() const { return m_slow_start_threshold; }
+    bool is_in_slow_start() const { return m_congestion_window < m_slow_start_threshold; }
+
+    // Called for every ACK that acknowledges new data, except during loss recovery.
+    virtual void on_ack(size_t acknowledged_bytes, Time const& now, Time const& smoothed_round_trip_time) = 0;
+    // Called when the socket finds out about a lost segment through duplicate ACKs, and starts recovering from it.
+    virtual void on_congestion_event(size_t bytes_in_flight, Time const& now) = 0;
+    // Called when the retransmission timer expires.
+    virtual void on_retransmit_timeout(size_t bytes_in_flight, Time const& now);
+
+protected:
+    TCPCongestionControl() { initialize(m_maximum_segment_size); }
+
+    // Grows the window during slow start, and returns how many of the acknowledged bytes are left for congestion avoidance.
+    size_t slow_start(size_t acknowledged_bytes);
+
+    size_t m_maximum_segment_size { 536 };
+    size_t m_congestion_window { 0 };
+    size_t m_slow_start_threshold { NumericLimits<size_t>::max() };
+};
+
+// RFC5681 and RFC6582
+class TCPNewReno final : public TCPCongestionControl {
+public:
+    virtual Algorithm algorithm() const override { return Algorithm::NewReno; }
+
+    virtual void on_ack(size_t acknowledged_bytes, Time const& now, Time const& smoothed_round_trip_time) override;
+    virtual void on_congestion_event(size_t bytes_in_flight, Time const& now) override;
+
+private:
+    size_t m_bytes_acknowledged { 0 };
+};
+
+// RFC9438
+class TCPCubic final : public TCPCongestionControl {
+public:
+    virtual Algorithm algorithm() const override { return Algorithm::Cubic; }
+
+    virtual void on_ack(size_t acknowledged_bytes, Time const& now, Time const& smoothed_round_trip_time) override;
+    virtual void on_congestion_event(size_t bytes_in_flight, Time const& now) override;
+    virtual void on_retransmit_timeout(size_t bytes_in_flight, Time const& now) override;
+
+private:
+    i64 window_at(i64 milliseconds_since_epoch_start) const;
+
+    // The window right before the last congestion event.
+    size_t m_maximum_window { 0 };
+    // How long it takes the window to grow back to m_maximum_window after the start of the epoch.
+    i64 m_milliseconds_to_maximum_window { 0 };
+    Optional<Time> m_epoch_start;
+    // The window an AIMD algorithm like NewReno would have, used to never be slower than that.
+    size_t m_reno_window { 0 };
+    u64 m_pending_increase { 0 };
+};
+
+}
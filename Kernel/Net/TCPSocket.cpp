@@ -8,17 +8,21 @@
 #include <AK/Time.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Devices/RandomDevice.h>
+#include <Kernel/FileSystem/Inode.h>
 #include <Kernel/FileSystem/OpenFileDescription.h>
 #include <Kernel/Locking/MutexProtected.h>
+#include <Kernel/Locking/SpinlockProtected.h>
 #include <Kernel/Net/EthernetFrameHeader.h>
 #include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/NetworkTask.h>
 #include <Kernel/Net/NetworkingManagement.h>
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCP.h>
 #include <Kernel/Net/TCPSocket.h>
 #include <Kernel/Process.h>
 #include <Kernel/Random.h>
+#include <Kernel/Time/TimeManagement.h>
 
 namespace Kernel {
 
@@ -60,9 +64,18 @@ void TCPSocket::set_state(State new_state)
 
     auto was_disconnected = protocol_is_disconnected();
     auto previous_role = m_role;
+    auto previous_state = m_state;
 
     m_state = new_state;
 
+    if (new_state == State::Established && previous_state != State::Established) {
+        auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+        m_congestion_control->initialize(routing_decision.is_zero() ? m_peer_maximum_segment_size : maximum_segment_size(*routing_decision.adapter));
+    }
+
+    if (m_keepalive_enabled)
+        restart_keepalive_timer();
+
     if (new_state == State::Established && m_direction == Direction::Outgoing) {
         set_role(Role::Connected);
         clear_so_error();
@@ -162,15 +175,17 @@ void TCPSocket::release_for_accept(NonnullLockRefPtr<TCPSocket> socket)
     [[maybe_unused]] auto rc = queue_connection_from(move(socket));
 }
 
-TCPSocket::TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer)
+TCPSocket::TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer, NonnullOwnPtr<TCPCongestionControl> congestion_control)
     : IPv4Socket(SOCK_STREAM, protocol, move(receive_buffer), move(scratch_buffer))
+    , m_congestion_control(move(congestion_control))
 {
-    m_last_retransmit_time = kgettimeofday();
 }
 
 TCPSocket::~TCPSocket()
 {
-    dequeue_for_retransmit();
+    cancel_timer(m_retransmit_timer);
+    cancel_timer(m_delayed_ack_timer);
+    cancel_timer(m_keepalive_timer);
 
     dbgln_if(TCP_SOCKET_DEBUG, "~TCPSocket in state {}", to_string(state()));
 }
@@ -179,7 +194,8 @@ ErrorOr<NonnullLockRefPtr<TCPSocket>> TCPSocket::try_create(int protocol, Nonnul
 {
     // Note: Scratch buffer is only used for SOCK_STREAM sockets.
     auto scratch_buffer = TRY(KBuffer::try_create_with_size("TCPSocket: Scratch buffer"sv, 65536));
-    return adopt_nonnull_lock_ref_or_enomem(new (nothrow) TCPSocket(protocol, move(receive_buffer), move(scratch_buffer)));
+    auto congestion_control = TRY(TCPCongestionControl::try_create(TCPCongestionControl::default_algorithm()));
+    return adopt_nonnull_lock_ref_or_enomem(new (nothrow) TCPSocket(protocol, move(receive_buffer), move(scratch_buffer), move(congestion_control)));
 }
 
 ErrorOr<size_t> TCPSocket::protocol_size(ReadonlyBytes raw_ipv4_packet)
@@ -205,12 +221,88 @@ ErrorOr<size_t> TCPSocket::protocol_send(UserOrKernelBuffer const& data, size_t
     RoutingDecision routing_decision = route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
         return set_so_error(EHOSTUNREACH);
-    size_t mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-    data_length = min(data_length, mss);
+    data_length = TRY(sendable_payload_size(*routing_decision.adapter, data_length));
     TRY(send_tcp_packet(TCPFlags::PSH | TCPFlags::ACK, &data, data_length, &routing_decision));
     return data_length;
 }
 
+size_t TCPSocket::maximum_segment_size(NetworkAdapter const& adapter) const
+{
+    return min(adapter.mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket), static_cast<size_t>(m_peer_maximum_segment_size));
+}
+
+size_t TCPSocket::max_payload_size(NetworkAdapter const& adapter) const
+{
+    auto mss = maximum_segment_size(adapter);
+    if (!adapter.has_offload(NetworkOffload::TCPSegmentation))
+        return mss;
+    // Hand the adapter as many full segments as it can take at once, and let it split them up.
+    auto max_offloaded_payload_size = adapter.max_segmentation_frame_size() - adapter.ipv4_payload_offset() - sizeof(TCPPacket);
+    return max(mss, max_offloaded_payload_size - max_offloaded_payload_size % mss);
+}
+
+ErrorOr<size_t> TCPSocket::sendable_payload_size(NetworkAdapter const& adapter, size_t size) const
+{
+    auto window = send_window();
+    auto available = m_unacked_packets.with_shared([&](auto& unacked_packets) -> size_t {
+        // FIXME: Implement a persist timer for when the peer closes its window. For now we keep sending
+        //        a segment at a time, and let the retransmit timer take care of probing the window.
+        if (unacked_packets.packets.is_empty())
+            return max(window, maximum_segment_size(adapter));
+        return window > unacked_packets.size ? window - unacked_packets.size : 0;
+    });
+    if (available == 0)
+        return EAGAIN;
+    return min(min(size, available), max_payload_size(adapter));
+}
+
+u8 TCPSocket::receive_window_scale_to_offer()
+{
+    // Just enough to be able to advertise the whole receive buffer.
+    u8 scale = 0;
+    while ((static_cast<size_t>(NumericLimits<u16>::max()) << scale) < receive_buffer_size)
+        ++scale;
+    return scale;
+}
+
+u8 TCPSocket::receive_window_scale() const
+{
+    // Both sides have to agree on scaling windows, so we only do it if the peer does too.
+    if (!m_peer_window_scale.has_value())
+        return 0;
+    return receive_window_scale_to_offer();
+}
+
+u16 TCPSocket::advertised_window_size(bool is_syn) const
+{
+    // FIXME: Advertise how much room is actually left in the receive buffer, and send window updates as it drains.
+    // NOTE: The window of a SYN is never scaled.
+    auto scale = is_syn ? 0 : receive_window_scale();
+    return min(receive_buffer_size >> scale, static_cast<size_t>(NumericLimits<u16>::max()));
+}
+
+ErrorOr<size_t> TCPSocket::send_from_inode(OpenFileDescription&, Inode& inode, off_t offset, size_t size)
+{
+    MutexLocker locker(mutex());
+    if (is_shut_down_for_writing() || !is_connected())
+        return set_so_error(EPIPE);
+
+    RoutingDecision routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return set_so_error(EHOSTUNREACH);
+    auto data_length = TRY(sendable_payload_size(*routing_decision.adapter, size));
+    TRY(send_tcp_packet_with_payload(TCPFlags::PSH | TCPFlags::ACK, data_length, &routing_decision, [&](Bytes payload) -> ErrorOr<void> {
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(payload.data());
+        auto nread = TRY(inode.read_bytes(offset, payload.size(), buffer, nullptr));
+        // The inode may have been truncated since the caller decided how much to send.
+        if (nread != payload.size())
+            return EIO;
+        return {};
+    }));
+    Thread::current()->did_ipv4_socket_write(data_length);
+    return data_length;
+}
+
 ErrorOr<void> TCPSocket::send_ack(bool allow_duplicate)
 {
     if (!allow_duplicate && m_last_ack_number_sent == m_ack_number)
@@ -219,6 +311,15 @@ ErrorOr<void> TCPSocket::send_ack(bool allow_duplicate)
 }
 
 ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* payload, size_t payload_size, RoutingDecision* user_routing_decision)
+{
+    if (!payload)
+        return send_tcp_packet_with_payload(flags, 0, user_routing_decision, nullptr);
+    return send_tcp_packet_with_payload(flags, payload_size, user_routing_decision, [&](Bytes bytes) {
+        return payload->read(bytes);
+    });
+}
+
+ErrorOr<void> TCPSocket::send_tcp_packet_with_payload(u16 flags, size_t payload_size, RoutingDecision* user_routing_decision, Function<ErrorOr<void>(Bytes)> const& write_payload)
 {
     RoutingDecision routing_decision = user_routing_decision ? *user_routing_decision : route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
@@ -226,8 +327,16 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
 
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
 
-    bool const has_mss_option = flags == TCPFlags::SYN;
-    const size_t options_size = has_mss_option ? sizeof(TCPOptionMSS) : 0;
+    // NOTE: We offer all options in our SYN, but only agree to those of them the peer offered in its SYN.
+    bool const is_syn = flags & TCPFlags::SYN;
+    bool const is_syn_ack = is_syn && (flags & TCPFlags::ACK);
+    bool const has_mss_option = is_syn;
+    bool const has_window_scale_option = is_syn && (!is_syn_ack || m_peer_window_scale.has_value());
+    bool const has_sack_permitted_option = is_syn && (!is_syn_ack || m_sack_permitted);
+    // Every option but the MSS one gets padded to a multiple of four bytes with NOPs.
+    const size_t options_size = (has_mss_option ? sizeof(TCPOptionMSS) : 0)
+        + (has_window_scale_option ? 1 + sizeof(TCPOptionWindowScale) : 0)
+        + (has_sack_permitted_option ? 2 + sizeof(TCPOptionSACKPermitted) : 0);
     const size_t tcp_header_size = sizeof(TCPPacket) + options_size;
     const size_t buffer_size = ipv4_payload_offset + tcp_header_size + payload_size;
     auto packet = routing_decision.adapter->acquire_packet_buffer(buffer_size);
@@ -241,13 +350,13 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(NumericLimits<u16>::max());
+    tcp_packet.set_window_size(advertised_window_size(is_syn));
     tcp_packet.set_sequence_number(m_sequence_number);
     tcp_packet.set_data_offset(tcp_header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
 
-    if (payload) {
-        if (auto result = payload->read(tcp_packet.payload(), payload_size); result.is_error()) {
+    if (write_payload) {
+        if (auto result = write_payload({ tcp_packet.payload(), payload_size }); result.is_error()) {
             routing_decision.adapter->release_packet_buffer(*packet);
             return set_so_error(result.release_error());
         }
@@ -257,6 +366,7 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
         m_last_ack_number_sent = m_ack_number;
         m_last_ack_sent_time = kgettimeofday();
         tcp_packet.set_ack_number(m_ack_number);
+        cancel_timer(m_delayed_ack_timer);
     }
 
     if (flags & TCPFlags::SYN) {
@@ -265,27 +375,54 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
         m_sequence_number += payload_size;
     }
 
+    VERIFY(packet->buffer->size() >= ipv4_payload_offset + tcp_header_size);
+    auto* options = packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket);
     if (has_mss_option) {
         u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
         TCPOptionMSS mss_option { mss };
-        VERIFY(packet->buffer->size() >= ipv4_payload_offset + sizeof(TCPPacket) + sizeof(mss_option));
-        memcpy(packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket), &mss_option, sizeof(mss_option));
+        memcpy(options, &mss_option, sizeof(mss_option));
+        options += sizeof(mss_option);
+    }
+    if (has_window_scale_option) {
+        TCPOptionWindowScale window_scale_option { receive_window_scale_to_offer() };
+        *options++ = to_underlying(TCPOptionKind::NoOperation);
+        memcpy(options, &window_scale_option, sizeof(window_scale_option));
+        options += sizeof(window_scale_option);
+    }
+    if (has_sack_permitted_option) {
+        TCPOptionSACKPermitted sack_permitted_option;
+        *options++ = to_underlying(TCPOptionKind::NoOperation);
+        *options++ = to_underlying(TCPOptionKind::NoOperation);
+        memcpy(options, &sack_permitted_option, sizeof(sack_permitted_option));
+        options += sizeof(sack_permitted_option);
     }
 
-    tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    auto& adapter = *routing_decision.adapter;
+    TransmitOffload offload;
+    size_t mss = maximum_segment_size(adapter);
+    if (payload_size > mss) {
+        VERIFY(adapter.has_offload(NetworkOffload::TCPSegmentation));
+        offload.tcp_segment_size = mss;
+        tcp_packet.set_checksum(compute_tcp_pseudo_header_checksum(local_address(), peer_address(), 0));
+    } else if (adapter.has_offload(NetworkOffload::TransmitTCPChecksum)) {
+        offload.tcp_checksum = true;
+        tcp_packet.set_checksum(compute_tcp_pseudo_header_checksum(local_address(), peer_address(), tcp_header_size + payload_size));
+    } else {
+        tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    }
 
     bool expect_ack { tcp_packet.has_syn() || payload_size > 0 };
     if (expect_ack) {
         bool append_failed { false };
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-            auto result = unacked_packets.packets.try_append({ m_sequence_number, packet, ipv4_payload_offset, *routing_decision.adapter });
+            auto result = unacked_packets.packets.try_append({ m_sequence_number, packet, ipv4_payload_offset, adapter, offload, tcp_packet.sequence_number(), TimeManagement::the().monotonic_time() });
             if (result.is_error()) {
                 dbgln("TCPSocket: Dropped outbound packet because try_append() failed");
                 append_failed = true;
                 return;
             }
             unacked_packets.size += payload_size;
-            enqueue_for_retransmit();
+            ensure_timer_scheduled(m_retransmit_timer, retransmit_timeout());
         });
         if (append_failed)
             return set_so_error(ENOMEM);
@@ -293,34 +430,170 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
 
     m_packets_out++;
     m_bytes_out += buffer_size;
-    routing_decision.adapter->send_packet(packet->bytes());
+    adapter.send_packet(packet->bytes(), offload);
     if (!expect_ack)
-        routing_decision.adapter->release_packet_buffer(*packet);
+        adapter.release_packet_buffer(*packet);
 
     return {};
 }
 
+// NOTE: TCP timers only need to be roughly on time, so a coarse tick keeps the wheel small.
+static constexpr i64 timer_tick_milliseconds = 10;
+
+// Sequence numbers wrap around, so they can only be compared to ones that are less than half the number space away.
+static bool sequence_number_less_than(u32 a, u32 b)
+{
+    return static_cast<i32>(a - b) < 0;
+}
+
+static bool sequence_number_less_than_or_equal(u32 a, u32 b)
+{
+    return static_cast<i32>(a - b) <= 0;
+}
+
+template<typename Callback>
+static void for_each_tcp_option(TCPPacket const& packet, Callback callback)
+{
+    auto options = packet.options();
+    for (size_t offset = 0; offset < options.size();) {
+        auto kind = static_cast<TCPOptionKind>(options[offset]);
+        if (kind == TCPOptionKind::End)
+            return;
+        if (kind == TCPOptionKind::NoOperation) {
+            ++offset;
+            continue;
+        }
+        if (offset + 1 >= options.size())
+            return;
+        size_t length = options[offset + 1];
+        if (length < 2 || offset + length > options.size()) {
+            dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: Ignoring malformed options");
+            return;
+        }
+        callback(kind, options.slice(offset + 2, length - 2));
+        offset += length;
+    }
+}
+
+void TCPSocket::process_syn_options(TCPPacket const& packet)
+{
+    // RFC9293 says we have to assume 536 bytes if the peer doesn't tell us its MSS.
+    m_peer_maximum_segment_size = 536;
+    m_peer_window_scale.clear();
+    m_sack_permitted = false;
+
+    for_each_tcp_option(packet, [&](TCPOptionKind kind, ReadonlyBytes data) {
+        switch (kind) {
+        case TCPOptionKind::MSS:
+            if (data.size() == 2 && (data[0] != 0 || data[1] != 0))
+                m_peer_maximum_segment_size = (data[0] << 8) | data[1];
+            break;
+        case TCPOptionKind::WindowScale:
+            // RFC7323 says we have to treat shift counts above 14 as 14.
+            if (data.size() == 1)
+                m_peer_window_scale = min(data[0], 14);
+            break;
+        case TCPOptionKind::SACKPermitted:
+            m_sack_permitted = true;
+            break;
+        default:
+            break;
+        }
+    });
+
+    // NOTE: The window of a SYN is never scaled.
+    m_peer_window_size = packet.window_size();
+}
+
+void TCPSocket::process_sack_blocks(TCPPacket const& packet, UnackedPackets& unacked_packets)
+{
+    for_each_tcp_option(packet, [&](TCPOptionKind kind, ReadonlyBytes data) {
+        if (kind != TCPOptionKind::SACK)
+            return;
+        for (size_t offset = 0; offset + sizeof(TCPSACKBlock) <= data.size(); offset += sizeof(TCPSACKBlock)) {
+            auto const& block = *reinterpret_cast<TCPSACKBlock const*>(data.offset(offset));
+            // NOTE: Blocks at or below the ACK number only report duplicates (RFC2883), there's nothing left to learn from them.
+            if (sequence_number_less_than_or_equal(block.right_edge(), packet.ack_number()))
+                continue;
+            for (auto& outgoing_packet : unacked_packets.packets) {
+                if (sequence_number_less_than_or_equal(block.left_edge(), outgoing_packet.sequence_number) && sequence_number_less_than_or_equal(outgoing_packet.ack_number, block.right_edge()))
+                    outgoing_packet.sacked = true;
+            }
+            if (!m_highest_sacked_sequence_number.has_value() || sequence_number_less_than(m_highest_sacked_sequence_number.value(), block.right_edge()))
+                m_highest_sacked_sequence_number = block.right_edge();
+        }
+    });
+}
+
+void TCPSocket::update_round_trip_time(Time const& sample)
+{
+    // RFC6298
+    auto sample_us = sample.to_microseconds();
+    if (!m_has_round_trip_time_sample) {
+        m_smoothed_round_trip_time_us = sample_us;
+        m_round_trip_time_variance_us = sample_us / 2;
+        m_has_round_trip_time_sample = true;
+    } else {
+        auto deviation = m_smoothed_round_trip_time_us > sample_us ? m_smoothed_round_trip_time_us - sample_us : sample_us - m_smoothed_round_trip_time_us;
+        m_round_trip_time_variance_us = (3 * m_round_trip_time_variance_us + deviation) / 4;
+        m_smoothed_round_trip_time_us = (7 * m_smoothed_round_trip_time_us + sample_us) / 8;
+    }
+    auto timeout_us = m_smoothed_round_trip_time_us + max(4 * m_round_trip_time_variance_us, timer_tick_milliseconds * 1000);
+    m_retransmission_timeout = Time::from_microseconds(clamp(timeout_us, 1'000'000, 60'000'000));
+}
+
 void TCPSocket::receive_tcp_packet(TCPPacket const& packet, u16 size)
 {
+    if (m_keepalive_enabled)
+        restart_keepalive_timer();
+
+    if (packet.has_syn())
+        process_syn_options(packet);
+
     if (packet.has_ack()) {
         u32 ack_number = packet.ack_number();
+        auto now = TimeManagement::the().monotonic_time();
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
 
+        if (!packet.has_syn()) {
+            u32 window_size = static_cast<u32>(packet.window_size()) << send_window_scale();
+            if (window_size != m_peer_window_size) {
+                m_peer_window_size = window_size;
+                evaluate_block_conditions();
+            }
+        }
+
         int removed = 0;
+        size_t acknowledged_bytes = 0;
+        bool is_duplicate_ack = false;
+        size_t bytes_in_flight = 0;
+        Optional<Time> round_trip_time;
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+            if (m_sack_permitted)
+                process_sack_blocks(packet, unacked_packets);
+
+            // RFC5681 says an ACK is a duplicate if it doesn't acknowledge anything new while we have data in flight.
+            is_duplicate_ack = !unacked_packets.packets.is_empty() && ack_number == unacked_packets.packets.first().sequence_number
+                && size == packet.header_size() && !packet.has_syn() && !packet.has_fin();
+
             while (!unacked_packets.packets.is_empty()) {
                 auto& packet = unacked_packets.packets.first();
 
                 dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
 
-                if (packet.ack_number <= ack_number) {
+                if (sequence_number_less_than_or_equal(packet.ack_number, ack_number)) {
+                    TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
+                    auto payload_size = packet.buffer->buffer->data() + packet.buffer->buffer->size() - (u8*)tcp_packet.payload();
+                    // Karn's algorithm: we can't tell which transmission a retransmitted packet's ACK is for.
+                    if (packet.tx_counter == 0)
+                        round_trip_time = now - packet.sent_time;
+                    // NOTE: The buffer may be handed out again right away, so we must be done looking at it.
                     auto old_adapter = packet.adapter.strong_ref();
                     if (old_adapter)
                         old_adapter->release_packet_buffer(*packet.buffer);
-                    TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                    auto payload_size = packet.buffer->buffer->data() + packet.buffer->buffer->size() - (u8*)tcp_packet.payload();
                     unacked_packets.size -= payload_size;
+                    acknowledged_bytes += payload_size;
                     evaluate_block_conditions();
                     unacked_packets.packets.take_first();
                     removed++;
@@ -328,14 +601,49 @@ void TCPSocket::receive_tcp_packet(TCPPacket const& packet, u16 size)
                     break;
                 }
             }
+            bytes_in_flight = unacked_packets.size;
 
             if (unacked_packets.packets.is_empty()) {
                 m_retransmit_attempts = 0;
-                dequeue_for_retransmit();
+                cancel_timer(m_retransmit_timer);
+            } else if (removed > 0) {
+                // RFC6298 says we should restart the timer whenever new data is acknowledged.
+                m_retransmit_attempts = 0;
+                schedule_timer(m_retransmit_timer, retransmit_timeout());
             }
 
             dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
         });
+
+        if (round_trip_time.has_value())
+            update_round_trip_time(round_trip_time.value());
+
+        if (m_highest_sacked_sequence_number.has_value() && sequence_number_less_than_or_equal(m_highest_sacked_sequence_number.value(), ack_number))
+            m_highest_sacked_sequence_number.clear();
+
+        if (removed > 0) {
+            m_received_duplicate_acks = 0;
+            if (!m_in_loss_recovery) {
+                m_congestion_control->on_ack(acknowledged_bytes, now, Time::from_microseconds(m_smoothed_round_trip_time_us));
+            } else if (sequence_number_less_than(ack_number, m_recovery_point)) {
+                // RFC6582: A partial ACK means that the packet right after it got lost as well.
+                retransmit_next_lost_packet(true);
+            } else {
+                m_in_loss_recovery = false;
+            }
+        } else if (is_duplicate_ack) {
+            ++m_received_duplicate_acks;
+            if (m_in_loss_recovery) {
+                // NOTE: Without SACK, we don't know about any other lost packets before the next partial ACK.
+                retransmit_next_lost_packet(false);
+            } else if (m_received_duplicate_acks == fast_retransmit_threshold) {
+                dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) fast retransmit after {} duplicate ACKs", this, m_received_duplicate_acks);
+                ++m_fast_retransmits;
+                m_congestion_control->on_congestion_event(bytes_in_flight, now);
+                enter_loss_recovery();
+                retransmit_next_lost_packet(true);
+            }
+        }
     }
 
     m_packets_in++;
@@ -344,6 +652,10 @@ void TCPSocket::receive_tcp_packet(TCPPacket const& packet, u16 size)
 
 bool TCPSocket::should_delay_next_ack() const
 {
+    // Delaying ACKs saves packets on the wire, but a connection to ourselves has no wire, and its peer would only be kept waiting.
+    if (peer_address()[0] == 127 || peer_address() == local_address())
+        return false;
+
     // FIXME: We don't know the MSS here so make a reasonable guess.
     const size_t mss = 1500;
 
@@ -358,7 +670,13 @@ bool TCPSocket::should_delay_next_ack() const
     return true;
 }
 
-NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(IPv4Address const& source, IPv4Address const& destination, TCPPacket const& packet, u16 payload_size)
+void TCPSocket::schedule_delayed_ack()
+{
+    // RFC 1122 says an ACK must not be delayed for more than 500 milliseconds, so we stay well below that.
+    ensure_timer_scheduled(m_delayed_ack_timer, Time::from_milliseconds(200));
+}
+
+NetworkOrdered<u16> TCPSocket::compute_tcp_pseudo_header_checksum(IPv4Address const& source, IPv4Address const& destination, u16 tcp_length)
 {
     union PseudoHeader {
         struct [[gnu::packed]] {
@@ -372,11 +690,7 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(IPv4Address const& source, I
     };
     static_assert(sizeof(PseudoHeader) == 12);
 
-    Checked<u16> packet_size = packet.header_size();
-    packet_size += payload_size;
-    VERIFY(!packet_size.has_overflow());
-
-    PseudoHeader pseudo_header { .header = { source, destination, 0, (u8)IPv4Protocol::TCP, packet_size.value() } };
+    PseudoHeader pseudo_header { .header = { source, destination, 0, (u8)IPv4Protocol::TCP, tcp_length } };
 
     u32 checksum = 0;
     auto* raw_pseudo_header = pseudo_header.raw;
@@ -385,6 +699,16 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(IPv4Address const& source, I
         if (checksum > 0xffff)
             checksum = (checksum >> 16) + (checksum & 0xffff);
     }
+    return checksum;
+}
+
+NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(IPv4Address const& source, IPv4Address const& destination, TCPPacket const& packet, u16 payload_size)
+{
+    Checked<u16> packet_size = packet.header_size();
+    packet_size += payload_size;
+    VERIFY(!packet_size.has_overflow());
+
+    u32 checksum = compute_tcp_pseudo_header_checksum(source, destination, packet_size.value());
     auto* raw_packet = bit_cast<u16*>(&packet);
     for (size_t i = 0; i < packet.header_size() / sizeof(u16); ++i) {
         checksum += AK::convert_between_host_and_network_endian(raw_packet[i]);
@@ -552,44 +876,177 @@ ErrorOr<void> TCPSocket::close()
     return result;
 }
 
-static Singleton<MutexProtected<TCPSocket::RetransmitList>> s_sockets_for_retransmit;
+static u64 current_timer_tick()
+{
+    return TimeManagement::the().monotonic_time().to_milliseconds() / timer_tick_milliseconds;
+}
+
+struct TimerState {
+    explicit TimerState(u64 current_tick)
+        : wheel(current_tick)
+        , worker_wakeup_tick(current_tick)
+    {
+    }
+
+    TimerWheel wheel;
+    // The tick at which the network task is going to look at the wheel again, unless it gets woken up.
+    u64 worker_wakeup_tick { 0 };
+};
 
-MutexProtected<TCPSocket::RetransmitList>& TCPSocket::sockets_for_retransmit()
+static SpinlockProtected<TimerState, LockRank::None>* create_timer_state()
 {
-    return *s_sockets_for_retransmit;
+    return new SpinlockProtected<TimerState, LockRank::None>(current_timer_tick());
 }
 
-void TCPSocket::enqueue_for_retransmit()
+static Singleton<SpinlockProtected<TimerState, LockRank::None>, create_timer_state> s_timer_state;
+
+static void schedule_on_timer_wheel(TimerWheel::Timer& timer, Time delay, bool reschedule)
 {
-    sockets_for_retransmit().with_exclusive([&](auto& list) {
-        list.append(*this);
+    auto expiry_tick = current_timer_tick() + static_cast<u64>(delay.to_milliseconds() / timer_tick_milliseconds);
+    bool should_wake_worker = s_timer_state->with([&](auto& state) {
+        if (!reschedule && timer.is_scheduled())
+            return false;
+        state.wheel.schedule(timer, expiry_tick);
+        return expiry_tick < state.worker_wakeup_tick;
     });
+    if (should_wake_worker)
+        NetworkTask::wake_timer_worker();
+}
+
+void TCPSocket::schedule_timer(Timer& timer, Time delay)
+{
+    schedule_on_timer_wheel(timer, delay, true);
+}
+
+void TCPSocket::ensure_timer_scheduled(Timer& timer, Time delay)
+{
+    schedule_on_timer_wheel(timer, delay, false);
 }
 
-void TCPSocket::dequeue_for_retransmit()
+void TCPSocket::cancel_timer(Timer& timer)
 {
-    sockets_for_retransmit().with_exclusive([&](auto& list) {
-        list.remove(*this);
+    s_timer_state->with([&](auto& state) {
+        state.wheel.cancel(timer);
     });
 }
 
-void TCPSocket::retransmit_packets()
+void TCPSocket::handle_expired_timers()
 {
-    auto now = kgettimeofday();
+    struct ExpiredTimer {
+        NonnullLockRefPtr<TCPSocket> socket;
+        TimerType type;
+    };
+    Vector<ExpiredTimer, 16> expired_timers;
+
+    auto now = current_timer_tick();
+    s_timer_state->with([&](auto& state) {
+        state.wheel.advance_to(now, [&](TimerWheel::Timer& wheel_timer) {
+            auto& timer = static_cast<Timer&>(wheel_timer);
+            if (expired_timers.try_ensure_capacity(expired_timers.size() + 1).is_error()) {
+                // We'll just try again on the next tick.
+                state.wheel.schedule(timer, now + 1);
+                return;
+            }
+            // NOTE: A socket whose last reference is already gone cancels its timers once it gets destroyed,
+            //       which can't happen before we let go of the wheel.
+            if (!timer.socket.try_ref())
+                return;
+            expired_timers.unchecked_append({ adopt_lock_ref(timer.socket), timer.type });
+        });
+    });
 
-    // RFC6298 says we should have at least one second between retransmits. According to
-    // RFC1122 we must do exponential backoff - even for SYN packets.
-    i64 retransmit_interval = 1;
-    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts; i++)
-        retransmit_interval *= 2;
+    // NOTE: The sockets are only locked after letting go of the wheel, as they schedule timers while being locked.
+    for (auto& expired_timer : expired_timers) {
+        MutexLocker locker(expired_timer.socket->mutex());
+        expired_timer.socket->handle_timer(expired_timer.type);
+    }
+}
 
-    if (m_last_retransmit_time > now - Time::from_seconds(retransmit_interval))
+Time TCPSocket::time_until_next_timer(Time maximum_time)
+{
+    auto now_milliseconds = TimeManagement::the().monotonic_time().to_milliseconds();
+    auto maximum_tick = static_cast<u64>((now_milliseconds + maximum_time.to_milliseconds()) / timer_tick_milliseconds);
+    auto wakeup_tick = s_timer_state->with([&](auto& state) {
+        auto next_expiry_tick = state.wheel.next_expiry_tick();
+        state.worker_wakeup_tick = next_expiry_tick.has_value() ? min(next_expiry_tick.value(), maximum_tick) : maximum_tick;
+        return state.worker_wakeup_tick;
+    });
+    return Time::from_milliseconds(max(static_cast<i64>(wakeup_tick) * timer_tick_milliseconds - now_milliseconds, 0));
+}
+
+void TCPSocket::handle_timer(TimerType type)
+{
+    switch (type) {
+    case TimerType::Retransmit:
+        retransmit_packets();
+        break;
+    case TimerType::DelayedAck: {
+        [[maybe_unused]] auto result = send_ack();
+        break;
+    }
+    case TimerType::KeepAlive:
+        handle_keepalive_timer();
+        break;
+    }
+}
+
+Time TCPSocket::retransmit_timeout() const
+{
+    // RFC6298 says we should have at least one second between retransmits (m_retransmission_timeout is clamped to that).
+    // According to RFC1122 we must do exponential backoff - even for SYN packets.
+    auto timeout_us = m_retransmission_timeout.to_microseconds() << min(m_retransmit_attempts, 6u);
+    return Time::from_microseconds(min(timeout_us, 60'000'000));
+}
+
+void TCPSocket::enter_loss_recovery()
+{
+    m_in_loss_recovery = true;
+    m_recovery_point = m_sequence_number;
+    m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+        for (auto& packet : unacked_packets.packets)
+            packet.retransmitted_during_recovery = false;
+    });
+}
+
+void TCPSocket::retransmit_next_lost_packet(bool first_unacked_packet_is_lost)
+{
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return;
+
+    m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+        bool is_first = true;
+        for (auto& packet : unacked_packets.packets) {
+            // RFC6675: Anything sent before a segment the peer has selectively acknowledged is considered lost.
+            bool is_lost = (is_first && first_unacked_packet_is_lost)
+                || (m_highest_sacked_sequence_number.has_value() && sequence_number_less_than_or_equal(packet.ack_number, m_highest_sacked_sequence_number.value()));
+            is_first = false;
+            if (!is_lost)
+                break;
+            if (packet.sacked || packet.retransmitted_during_recovery)
+                continue;
+            packet.retransmitted_during_recovery = true;
+            retransmit_packet(packet, *routing_decision.adapter, routing_decision.next_hop);
+            return;
+        }
+    });
+}
+
+void TCPSocket::retransmit_packets()
+{
+    // NOTE: The timer may have expired right before the last packet got acknowledged.
+    Optional<size_t> bytes_in_flight = m_unacked_packets.with_shared([](auto& unacked_packets) -> Optional<size_t> {
+        if (unacked_packets.packets.is_empty())
+            return {};
+        return unacked_packets.size;
+    });
+    if (!bytes_in_flight.has_value())
         return;
 
     dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) handling retransmit", this);
 
-    m_last_retransmit_time = now;
     ++m_retransmit_attempts;
+    ++m_retransmit_timeouts;
 
     if (m_retransmit_attempts > maximum_retransmits) {
         set_state(TCPSocket::State::Closed);
@@ -598,46 +1055,122 @@ void TCPSocket::retransmit_packets()
         return;
     }
 
-    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
-    if (routing_decision.is_zero())
-        return;
+    schedule_timer(m_retransmit_timer, retransmit_timeout());
 
+    // RFC5681 says that after a timeout we have to start over in slow start, resending everything the peer hasn't acknowledged.
+    // RFC6675 says we should forget about what was selectively acknowledged, since the peer is allowed to have dropped it.
+    m_congestion_control->on_retransmit_timeout(bytes_in_flight.value(), TimeManagement::the().monotonic_time());
+    m_received_duplicate_acks = 0;
+    m_highest_sacked_sequence_number.clear();
     m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-        for (auto& packet : unacked_packets.packets) {
-            packet.tx_counter++;
-
-            if constexpr (TCP_SOCKET_DEBUG) {
-                auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                    local_address(), local_port(),
-                    peer_address(), peer_port(),
-                    (tcp_packet.has_syn() ? "SYN " : ""),
-                    (tcp_packet.has_ack() ? "ACK " : ""),
-                    (tcp_packet.has_fin() ? "FIN " : ""),
-                    (tcp_packet.has_rst() ? "RST " : ""),
-                    tcp_packet.sequence_number(),
-                    tcp_packet.ack_number(),
-                    packet.tx_counter);
-            }
+        for (auto& packet : unacked_packets.packets)
+            packet.sacked = false;
+    });
+    enter_loss_recovery();
+    retransmit_next_lost_packet(true);
+}
 
-            size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
-            if (ipv4_payload_offset != packet.ipv4_payload_offset) {
-                // FIXME: Add support for this. This can happen if after a route change
-                // we ended up on another adapter which doesn't have the same layer 2 type
-                // like the previous adapter.
-                VERIFY_NOT_REACHED();
-            }
+void TCPSocket::retransmit_packet(OutgoingPacket& packet, NetworkAdapter& adapter, MACAddress const& next_hop)
+{
+    packet.tx_counter++;
+
+    if constexpr (TCP_SOCKET_DEBUG) {
+        auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
+        dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            local_address(), local_port(),
+            peer_address(), peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
+    }
+
+    size_t ipv4_payload_offset = adapter.ipv4_payload_offset();
+    if (ipv4_payload_offset != packet.ipv4_payload_offset) {
+        // FIXME: Add support for this. This can happen if after a route change
+        // we ended up on another adapter which doesn't have the same layer 2 type
+        // like the previous adapter.
+        VERIFY_NOT_REACHED();
+    }
 
-            auto packet_buffer = packet.buffer->bytes();
+    auto packet_buffer = packet.buffer->bytes();
 
-            routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
-                local_address(), routing_decision.next_hop, peer_address(),
-                IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
-            routing_decision.adapter->send_packet(packet_buffer);
-            m_packets_out++;
-            m_bytes_out += packet_buffer.size();
-        }
-    });
+    if (packet.offload.tcp_segment_size > 0 && (!adapter.has_offload(NetworkOffload::TCPSegmentation) || packet_buffer.size() > adapter.max_segmentation_frame_size())) {
+        // FIXME: Split the packet up ourselves. This can happen if after a route change we ended up on an adapter that can't do it for us.
+        dbgln("TCPSocket: Unable to retransmit a {} byte packet over {}", packet_buffer.size(), adapter.name());
+        return;
+    }
+    if (packet.offload.tcp_checksum && !adapter.has_offload(NetworkOffload::TransmitTCPChecksum)) {
+        auto& tcp_packet = *(TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
+        auto payload_size = packet_buffer.size() - packet.ipv4_payload_offset - tcp_packet.header_size();
+        tcp_packet.set_checksum(0);
+        tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+        packet.offload.tcp_checksum = false;
+    }
+
+    adapter.fill_in_ipv4_header(*packet.buffer,
+        local_address(), next_hop, peer_address(),
+        IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
+    adapter.send_packet(packet_buffer, packet.offload);
+    m_packets_out++;
+    m_bytes_out += packet_buffer.size();
+    m_retransmitted_packets++;
+}
+
+void TCPSocket::restart_keepalive_timer()
+{
+    m_keepalive_probes_sent = 0;
+    if (!m_keepalive_enabled || m_state != State::Established) {
+        cancel_timer(m_keepalive_timer);
+        return;
+    }
+    schedule_timer(m_keepalive_timer, Time::from_seconds(keepalive_idle_seconds));
+}
+
+void TCPSocket::handle_keepalive_timer()
+{
+    if (!m_keepalive_enabled || m_state != State::Established)
+        return;
+
+    // NOTE: While there is data in flight, the retransmit timer already finds out whether the peer went away.
+    if (!m_unacked_packets.with_shared([](auto& unacked_packets) { return unacked_packets.packets.is_empty(); })) {
+        schedule_timer(m_keepalive_timer, Time::from_seconds(keepalive_idle_seconds));
+        return;
+    }
+
+    if (m_keepalive_probes_sent >= maximum_keepalive_probes) {
+        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) peer did not answer {} keepalive probes", this, m_keepalive_probes_sent);
+        set_state(State::Closed);
+        set_error(Error::KeepAliveTimeout);
+        return;
+    }
+
+    // RFC1122 says a keepalive probe is a segment with a sequence number one less than the next one,
+    // which the peer has to answer with an ACK.
+    --m_sequence_number;
+    [[maybe_unused]] auto result = send_tcp_packet(TCPFlags::ACK);
+    ++m_sequence_number;
+
+    ++m_keepalive_probes_sent;
+    schedule_timer(m_keepalive_timer, Time::from_seconds(keepalive_interval_seconds));
+}
+
+ErrorOr<void> TCPSocket::setsockopt(int level, int option, Userspace<void const*> user_value, socklen_t user_value_size)
+{
+    if (level != SOL_SOCKET || option != SO_KEEPALIVE)
+        return IPv4Socket::setsockopt(level, option, user_value, user_value_size);
+
+    if (user_value_size != sizeof(int))
+        return EINVAL;
+    auto value = TRY(copy_typed_from_user(static_ptr_cast<int const*>(user_value)));
+
+    MutexLocker locker(mutex());
+    m_keepalive_enabled = value != 0;
+    restart_keepalive_timer();
+    return {};
 }
 
 bool TCPSocket::can_write(OpenFileDescription const& file_description, u64 size) const
@@ -648,11 +1181,9 @@ bool TCPSocket::can_write(OpenFileDescription const& file_description, u64 size)
     if (m_state == State::SynSent || m_state == State::SynReceived)
         return false;
 
-    if (!file_description.is_blocking())
-        return true;
-
+    // NOTE: We can always send at least one segment once everything in flight has been acknowledged.
     return m_unacked_packets.with_shared([&](auto& unacked_packets) {
-        return unacked_packets.size + size <= m_send_window_size;
+        return unacked_packets.packets.is_empty() || unacked_packets.size < send_window();
     });
 }
 }
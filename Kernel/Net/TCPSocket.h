@@ -13,6 +13,8 @@
 #include <Kernel/Library/LockWeakPtr.h>
 #include <Kernel/Locking/MutexProtected.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/TCPCongestionControl.h>
+#include <Kernel/Net/TimerWheel.h>
 
 namespace Kernel {
 
@@ -98,6 +100,7 @@ public:
         RSTDuringConnect,
         UnexpectedFlagsDuringConnect,
         RetransmitTimeout,
+        KeepAliveTimeout,
     };
 
     static StringView to_string(Error error)
@@ -111,6 +114,10 @@ public:
             return "RSTDuringConnect"sv;
         case Error::UnexpectedFlagsDuringConnect:
             return "UnexpectedFlagsDuringConnect"sv;
+        case Error::RetransmitTimeout:
+            return "RetransmitTimeout"sv;
+        case Error::KeepAliveTimeout:
+            return "KeepAliveTimeout"sv;
         default:
             return "Invalid"sv;
         }
@@ -134,6 +141,21 @@ public:
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
 
+    TCPCongestionControl const& congestion_control() const { return *m_congestion_control; }
+    // How much data we may have in flight, as limited by both the congestion window and the peer's receive window.
+    size_t send_window() const { return min(m_congestion_control->congestion_window(), static_cast<size_t>(m_peer_window_size)); }
+    u32 peer_window_size() const { return m_peer_window_size; }
+    u16 peer_maximum_segment_size() const { return m_peer_maximum_segment_size; }
+    u8 send_window_scale() const { return m_peer_window_scale.value_or(0); }
+    u8 receive_window_scale() const;
+    bool is_sack_permitted() const { return m_sack_permitted; }
+    i64 smoothed_round_trip_time_us() const { return m_smoothed_round_trip_time_us; }
+    i64 round_trip_time_variance_us() const { return m_round_trip_time_variance_us; }
+    Time retransmit_timeout() const;
+    u32 retransmitted_packets() const { return m_retransmitted_packets; }
+    u32 fast_retransmits() const { return m_fast_retransmits; }
+    u32 retransmit_timeouts() const { return m_retransmit_timeouts; }
+
     // FIXME: Make this configurable?
     static constexpr u32 maximum_duplicate_acks = 5;
     void set_duplicate_acks(u32 acks) { m_duplicate_acks = acks; }
@@ -142,8 +164,16 @@ public:
     ErrorOr<void> send_ack(bool allow_duplicate = false);
     ErrorOr<void> send_tcp_packet(u16 flags, UserOrKernelBuffer const* = nullptr, size_t = 0, RoutingDecision* = nullptr);
     void receive_tcp_packet(TCPPacket const&, u16 size);
+    // Picks up what the peer told us about itself in the options of its SYN.
+    void process_syn_options(TCPPacket const&);
 
     bool should_delay_next_ack() const;
+    void schedule_delayed_ack();
+
+    // NOTE: The timers of all sockets are handled by the network task.
+    static void handle_expired_timers();
+    // Returns how long the network task can sleep before it has to handle timers again, at most `maximum_time`.
+    static Time time_until_next_timer(Time maximum_time);
 
     static MutexProtected<HashMap<IPv4SocketTuple, TCPSocket*>>& sockets_by_tuple();
     static LockRefPtr<TCPSocket> from_tuple(IPv4SocketTuple const& tuple);
@@ -156,23 +186,34 @@ public:
     void release_to_originator();
     void release_for_accept(NonnullLockRefPtr<TCPSocket>);
 
-    void retransmit_packets();
-
     virtual ErrorOr<void> close() override;
+    virtual ErrorOr<void> setsockopt(int level, int option, Userspace<void const*>, socklen_t) override;
 
     virtual bool can_write(OpenFileDescription const&, u64) const override;
+    virtual ErrorOr<size_t> send_from_inode(OpenFileDescription&, Inode&, off_t offset, size_t size) override;
 
     static NetworkOrdered<u16> compute_tcp_checksum(IPv4Address const& source, IPv4Address const& destination, TCPPacket const&, u16 payload_size);
+    // The (not yet complemented) checksum of the pseudo header that precedes a TCP packet of `tcp_length` bytes.
+    static NetworkOrdered<u16> compute_tcp_pseudo_header_checksum(IPv4Address const& source, IPv4Address const& destination, u16 tcp_length);
 
 protected:
     void set_direction(Direction direction) { m_direction = direction; }
 
 private:
-    explicit TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer);
+    explicit TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer, NonnullOwnPtr<TCPCongestionControl>);
     virtual StringView class_name() const override { return "TCPSocket"sv; }
 
     virtual void shut_down_for_writing() override;
 
+    // The payload is written straight into the packet buffer, which has room for exactly `payload_size` bytes.
+    ErrorOr<void> send_tcp_packet_with_payload(u16 flags, size_t payload_size, RoutingDecision*, Function<ErrorOr<void>(Bytes)> const& write_payload);
+    size_t maximum_segment_size(NetworkAdapter const&) const;
+    size_t max_payload_size(NetworkAdapter const&) const;
+    // How much of `size` bytes we can send right away without overrunning the send window.
+    ErrorOr<size_t> sendable_payload_size(NetworkAdapter const&, size_t size) const;
+    static u8 receive_window_scale_to_offer();
+    u16 advertised_window_size(bool is_syn) const;
+
     virtual ErrorOr<size_t> protocol_receive(ReadonlyBytes raw_ipv4_packet, UserOrKernelBuffer& buffer, size_t buffer_size, int flags) override;
     virtual ErrorOr<size_t> protocol_send(UserOrKernelBuffer const&, size_t) override;
     virtual ErrorOr<void> protocol_connect(OpenFileDescription&) override;
@@ -182,8 +223,41 @@ private:
     virtual ErrorOr<void> protocol_bind() override;
     virtual ErrorOr<void> protocol_listen(bool did_allocate_port) override;
 
-    void enqueue_for_retransmit();
-    void dequeue_for_retransmit();
+    enum class TimerType {
+        Retransmit,
+        DelayedAck,
+        KeepAlive,
+    };
+
+    struct Timer : public TimerWheel::Timer {
+        Timer(TCPSocket& socket, TimerType type)
+            : socket(socket)
+            , type(type)
+        {
+        }
+
+        TCPSocket& socket;
+        TimerType type;
+    };
+
+    void schedule_timer(Timer&, Time delay);
+    // Leaves the timer alone if it is already scheduled.
+    void ensure_timer_scheduled(Timer&, Time delay);
+    void cancel_timer(Timer&);
+    void handle_timer(TimerType);
+
+    struct OutgoingPacket;
+    struct UnackedPackets;
+
+    void update_round_trip_time(Time const& sample);
+    void process_sack_blocks(TCPPacket const&, UnackedPackets&);
+    void enter_loss_recovery();
+    void retransmit_next_lost_packet(bool first_unacked_packet_is_lost);
+    void retransmit_packet(OutgoingPacket&, NetworkAdapter&, MACAddress const& next_hop);
+    void retransmit_packets();
+
+    void restart_keepalive_timer();
+    void handle_keepalive_timer();
 
     LockWeakPtr<TCPSocket> m_originator;
     HashMap<IPv4SocketTuple, NonnullLockRefPtr<TCPSocket>> m_pending_release_for_accept;
@@ -203,7 +277,13 @@ private:
         LockRefPtr<PacketWithTimestamp> buffer;
         size_t ipv4_payload_offset;
         LockWeakPtr<NetworkAdapter> adapter;
+        TransmitOffload offload;
+        u32 sequence_number { 0 };
+        Time sent_time;
         int tx_counter { 0 };
+        // The peer told us it got this packet, even though it can't acknowledge it yet.
+        bool sacked { false };
+        bool retransmitted_during_recovery { false };
     };
 
     struct UnackedPackets {
@@ -215,22 +295,47 @@ private:
 
     u32 m_duplicate_acks { 0 };
 
+    NonnullOwnPtr<TCPCongestionControl> m_congestion_control;
+    // FIXME: Make this configurable (sysctl)
+    static constexpr u32 fast_retransmit_threshold = 3;
+    u32 m_received_duplicate_acks { 0 };
+    bool m_in_loss_recovery { false };
+    // Loss recovery is over once everything we sent before it started got acknowledged.
+    u32 m_recovery_point { 0 };
+    Optional<u32> m_highest_sacked_sequence_number;
+
+    u32 m_peer_window_size { 0 };
+    u16 m_peer_maximum_segment_size { 536 };
+    Optional<u8> m_peer_window_scale;
+    bool m_sack_permitted { false };
+
+    bool m_has_round_trip_time_sample { false };
+    i64 m_smoothed_round_trip_time_us { 0 };
+    i64 m_round_trip_time_variance_us { 0 };
+    // RFC6298 says we should have at least one second between retransmits.
+    Time m_retransmission_timeout { Time::from_seconds(1) };
+
+    u32 m_retransmitted_packets { 0 };
+    u32 m_fast_retransmits { 0 };
+    u32 m_retransmit_timeouts { 0 };
+
     u32 m_last_ack_number_sent { 0 };
     Time m_last_ack_sent_time;
 
     // FIXME: Make this configurable (sysctl)
     static constexpr u32 maximum_retransmits = 5;
-    Time m_last_retransmit_time;
     u32 m_retransmit_attempts { 0 };
+    Timer m_retransmit_timer { *this, TimerType::Retransmit };
 
-    // FIXME: Parse window size TCP option from the peer
-    u32 m_send_window_size { 64 * KiB };
+    Timer m_delayed_ack_timer { *this, TimerType::DelayedAck };
 
-    IntrusiveListNode<TCPSocket> m_retransmit_list_node;
-
-public:
-    using RetransmitList = IntrusiveList<&TCPSocket::m_retransmit_list_node>;
-    static MutexProtected<TCPSocket::RetransmitList>& sockets_for_retransmit();
+    // FIXME: Make these configurable (sysctl)
+    static constexpr i64 keepalive_idle_seconds = 2 * 60 * 60;
+    static constexpr i64 keepalive_interval_seconds = 75;
+    static constexpr u32 maximum_keepalive_probes = 9;
+    bool m_keepalive_enabled { false };
+    u32 m_keepalive_probes_sent { 0 };
+    Timer m_keepalive_timer { *this, TimerType::KeepAlive };
 };
 
 }
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Net/TimerWheel.h>
+
+namespace Kernel {
+
+void TimerWheel::schedule(Timer& timer, u64 expiry_tick)
+{
+    cancel(timer);
+    timer.m_expiry_tick = max(expiry_tick, m_current_tick + 1);
+    insert(timer);
+    ++m_timer_count;
+}
+
+void TimerWheel::cancel(Timer& timer)
+{
+    if (!timer.is_scheduled())
+        return;
+    timer.m_list_node.remove();
+    --m_timers_per_level[timer.m_level];
+    --m_timer_count;
+}
+
+void TimerWheel::insert(Timer& timer)
+{
+    size_t level = 0;
+    u64 slot_tick = m_current_tick;
+    if (timer.m_expiry_tick > m_current_tick) {
+        auto ticks_left = timer.m_expiry_tick - m_current_tick;
+        while (level < level_count - 1 && ticks_left >= ticks_per_slot(level + 1))
+            ++level;
+        // Timers beyond the reach of the wheel wait in its furthest slot, and get sorted in again once the wheel gets there.
+        slot_tick = min(timer.m_expiry_tick, m_current_tick + max_schedulable_ticks - 1);
+    }
+    // NOTE: Only timers that move down a level can be due already, they expire from the current slot right away.
+
+    auto slot = (slot_tick >> (slot_bits * level)) % slots_per_level;
+    timer.m_level = level;
+    m_levels[level][slot].append(timer);
+    ++m_timers_per_level[level];
+}
+
+void TimerWheel::cascade(size_t level)
+{
+    auto& timers = m_levels[level][(m_current_tick >> (slot_bits * level)) % slots_per_level];
+    while (!timers.is_empty()) {
+        auto& timer = *timers.take_first();
+        --m_timers_per_level[level];
+        insert(timer);
+    }
+}
+
+void TimerWheel::advance_to(u64 tick, Function<void(Timer&)> const& on_expired)
+{
+    while (m_current_tick < tick) {
+        if (m_timer_count == 0) {
+            m_current_tick = tick;
+            return;
+        }
+
+        // Nothing expires while the first level is empty, and nothing moves down a level before the wheel
+        // reaches the next slot of the lowest level that has any timers, so we can skip straight to that slot.
+        size_t lowest_level = 0;
+        while (m_timers_per_level[lowest_level] == 0)
+            ++lowest_level;
+        if (lowest_level > 0) {
+            auto next_slot_tick = (m_current_tick / ticks_per_slot(lowest_level) + 1) * ticks_per_slot(lowest_level);
+            if (next_slot_tick > tick) {
+                m_current_tick = tick;
+                return;
+            }
+            m_current_tick = next_slot_tick - 1;
+        }
+
+        ++m_current_tick;
+        for (size_t level = 1; level < level_count; ++level) {
+            if (m_current_tick % ticks_per_slot(level) != 0)
+                break;
+            cascade(level);
+        }
+
+        auto& timers = m_levels[0][m_current_tick % slots_per_level];
+        while (!timers.is_empty()) {
+            auto& timer = *timers.take_first();
+            --m_timers_per_level[0];
+            --m_timer_count;
+            on_expired(timer);
+        }
+    }
+}
+
+Optional<u64> TimerWheel::next_expiry_tick() const
+{
+    if (m_timer_count == 0)
+        return {};
+
+    // Timers on the higher levels don't expire before the wheel reaches their slot, which can't be
+    // earlier than the next slot of the lowest of those levels that has any timers.
+    Optional<u64> next_tick;
+    for (size_t level = 1; level < level_count; ++level) {
+        if (m_timers_per_level[level] == 0)
+            continue;
+        next_tick = (m_current_tick / ticks_per_slot(level) + 1) * ticks_per_slot(level);
+        break;
+    }
+
+    if (m_timers_per_level[0] > 0) {
+        for (u64 tick = m_current_tick + 1; tick < m_current_tick + slots_per_level; ++tick) {
+            if (next_tick.has_value() && tick >= next_tick.value())
+                break;
+            if (!m_levels[0][tick % slots_per_level].is_empty())
+                return tick;
+        }
+    }
+
+    return next_tick;
+}
+
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Function.h>
+#include <AK/IntrusiveList.h>
+#include <AK/Optional.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// A hierarchical timer wheel. Scheduling and cancelling a timer is O(1), and expiring timers only ever
+// looks at the slots of the ticks that have passed, no matter how many timers are armed.
+// Level 0 has one slot per tick, every further level has slots that span a whole turn of the level below it.
+// Timers move down a level whenever the wheel reaches the slot they are in, until they expire from level 0.
+// NOTE: The wheel does no locking of its own.
+class TimerWheel {
+    AK_MAKE_NONCOPYABLE(TimerWheel);
+    AK_MAKE_NONMOVABLE(TimerWheel);
+
+public:
+    class Timer {
+        AK_MAKE_NONCOPYABLE(Timer);
+        AK_MAKE_NONMOVABLE(Timer);
+
+    public:
+        Timer() = default;
+
+        bool is_scheduled() const { return m_list_node.is_in_list(); }
+        u64 expiry_tick() const { return m_expiry_tick; }
+
+    private:
+        friend class TimerWheel;
+
+        IntrusiveListNode<Timer> m_list_node;
+        u64 m_expiry_tick { 0 };
+        u8 m_level { 0 };
+    };
+
+    using TimerList = IntrusiveList<&Timer::m_list_node>;
+
+    explicit TimerWheel(u64 current_tick)
+        : m_current_tick(current_tick)
+    {
+    }
+
+    u64 current_tick() const { return m_current_tick; }
+    bool is_empty() const { return m_timer_count == 0; }
+
+    // Timers that are due at or before the current tick expire on the next tick.
+    void schedule(Timer&, u64 expiry_tick);
+    void cancel(Timer&);
+
+    // Moves the wheel forward to `tick`, calling `on_expired` for every timer that expired on the way.
+    // The timer is no longer scheduled by then, so the callback may schedule it again.
+    void advance_to(u64 tick, Function<void(Timer&)> const& on_expired);
+
+    // The earliest tick at which advancing the wheel might expire a timer, if any are scheduled.
+    Optional<u64> next_expiry_tick() const;
+
+private:
+    static constexpr size_t slot_bits = 6;
+    static constexpr size_t slots_per_level = 1 << slot_bits;
+    static constexpr size_t level_count = 4;
+    static constexpr u64 max_schedulable_ticks = 1ull << (slot_bits * level_count);
+
+    static constexpr u64 ticks_per_slot(size_t level) { return 1ull << (slot_bits * level); }
+
+    void insert(Timer&);
+    void cascade(size_t level);
+
+    Array<Array<TimerList, slots_per_level>, level_count> m_levels;
+    Array<size_t, level_count> m_timers_per_level {};
+    size_t m_timer_count { 0 };
+    u64 m_current_tick { 0 };
+};
+
+}
@@ -87,6 +87,24 @@ ErrorOr<size_t> UDPSocket::protocol_send(UserOrKernelBuffer const& data, size_t
     auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
         return set_so_error(EHOSTUNREACH);
+    if (m_segment_size == 0 || data_length <= m_segment_size)
+        return send_datagram(routing_decision, data, data_length);
+
+    // Segmentation offload: Split the data into datagrams of the segment size, all of which take the same route.
+    // That saves a syscall and a route lookup for each of them, but unlike a large datagram, none of them can be truncated.
+    auto maximum_datagram_size = routing_decision.adapter->mtu() - routing_decision.adapter->ipv4_payload_offset() - sizeof(UDPPacket);
+    if (m_segment_size > maximum_datagram_size)
+        return set_so_error(EMSGSIZE);
+    if (ceil_div(data_length, m_segment_size) > UDP_MAX_SEGMENTS)
+        return set_so_error(EINVAL);
+
+    for (size_t offset = 0; offset < data_length; offset += m_segment_size)
+        TRY(send_datagram(routing_decision, data.offset(offset), min(m_segment_size, data_length - offset)));
+    return data_length;
+}
+
+ErrorOr<size_t> UDPSocket::send_datagram(RoutingDecision& routing_decision, UserOrKernelBuffer const& data, size_t data_length)
+{
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
     data_length = min(data_length, routing_decision.adapter->mtu() - ipv4_payload_offset - sizeof(UDPPacket));
     const size_t udp_buffer_size = sizeof(UDPPacket) + data_length;
@@ -98,13 +116,49 @@ ErrorOr<size_t> UDPSocket::protocol_send(UserOrKernelBuffer const& data, size_t
     udp_packet.set_source_port(local_port());
     udp_packet.set_destination_port(peer_port());
     udp_packet.set_length(udp_buffer_size);
-    SOCKET_TRY(data.read(udp_packet.payload(), data_length));
+    if (auto result = data.read(udp_packet.payload(), data_length); result.is_error()) {
+        routing_decision.adapter->release_packet_buffer(*packet);
+        return set_so_error(result.release_error());
+    }
     routing_decision.adapter->fill_in_ipv4_header(*packet, local_address(), routing_decision.next_hop,
         peer_address(), IPv4Protocol::UDP, udp_buffer_size, type_of_service(), ttl());
     routing_decision.adapter->send_packet(packet->bytes());
+    routing_decision.adapter->release_packet_buffer(*packet);
     return data_length;
 }
 
+ErrorOr<void> UDPSocket::setsockopt(int level, int option, Userspace<void const*> user_value, socklen_t user_value_size)
+{
+    if (level != SOL_UDP || option != UDP_SEGMENT)
+        return IPv4Socket::setsockopt(level, option, user_value, user_value_size);
+
+    if (user_value_size != sizeof(int))
+        return EINVAL;
+    auto value = TRY(copy_typed_from_user(static_ptr_cast<int const*>(user_value)));
+    if (value < 0 || value > NumericLimits<u16>::max())
+        return EINVAL;
+
+    MutexLocker locker(mutex());
+    m_segment_size = value;
+    return {};
+}
+
+ErrorOr<void> UDPSocket::getsockopt(OpenFileDescription& description, int level, int option, Userspace<void*> value, Userspace<socklen_t*> value_size)
+{
+    if (level != SOL_UDP || option != UDP_SEGMENT)
+        return IPv4Socket::getsockopt(description, level, option, value, value_size);
+
+    MutexLocker locker(mutex());
+    socklen_t size;
+    TRY(copy_from_user(&size, value_size.unsafe_userspace_ptr()));
+    if (size < sizeof(int))
+        return EINVAL;
+    int segment_size = m_segment_size;
+    TRY(copy_to_user(static_ptr_cast<int*>(value), &segment_size));
+    size = sizeof(int);
+    return copy_to_user(value_size, &size);
+}
+
 ErrorOr<void> UDPSocket::protocol_connect(OpenFileDescription&)
 {
     set_role(Role::Connected);
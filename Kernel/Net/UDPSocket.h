@@ -9,6 +9,7 @@
 #include <AK/Error.h>
 #include <Kernel/Locking/MutexProtected.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/Routing.h>
 
 namespace Kernel {
 
@@ -21,6 +22,9 @@ public:
     static void for_each(Function<void(UDPSocket const&)>);
     static ErrorOr<void> try_for_each(Function<ErrorOr<void>(UDPSocket const&)>);
 
+    virtual ErrorOr<void> setsockopt(int level, int option, Userspace<void const*>, socklen_t) override;
+    virtual ErrorOr<void> getsockopt(OpenFileDescription&, int level, int option, Userspace<void*>, Userspace<socklen_t*>) override;
+
 private:
     explicit UDPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer);
     virtual StringView class_name() const override { return "UDPSocket"sv; }
@@ -32,6 +36,11 @@ private:
     virtual ErrorOr<void> protocol_connect(OpenFileDescription&) override;
     virtual ErrorOr<u16> protocol_allocate_local_port() override;
     virtual ErrorOr<void> protocol_bind() override;
+
+    ErrorOr<size_t> send_datagram(RoutingDecision&, UserOrKernelBuffer const&, size_t);
+
+    // Set with UDP_SEGMENT, zero if sends aren't split up.
+    size_t m_segment_size { 0 };
 };
 
 }
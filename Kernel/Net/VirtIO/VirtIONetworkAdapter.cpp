@@ -0,0 +1,398 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/MACAddress.h>
+#include <Kernel/Arch/Delay.h>
+#include <Kernel/Bus/PCI/IDs.h>
+#include <Kernel/CommandLine.h>
+#include <Kernel/Debug.h>
+#include <Kernel/Net/EthernetFrameHeader.h>
+#include <Kernel/Net/IPv4.h>
+#include <Kernel/Net/NetworkingManagement.h>
+#include <Kernel/Net/VirtIO/VirtIONetworkAdapter.h>
+#include <Kernel/Random.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+#define VIRTIO_NET_F_CSUM ((u64)1 << 0)
+#define VIRTIO_NET_F_GUEST_CSUM ((u64)1 << 1)
+#define VIRTIO_NET_F_MAC ((u64)1 << 5)
+#define VIRTIO_NET_F_MRG_RXBUF ((u64)1 << 15)
+#define VIRTIO_NET_F_STATUS ((u64)1 << 16)
+#define VIRTIO_NET_F_CTRL_VQ ((u64)1 << 17)
+#define VIRTIO_NET_F_MQ ((u64)1 << 22)
+
+// virtio_net_config
+#define CONFIG_MAC 0x0
+#define CONFIG_STATUS 0x6
+#define CONFIG_MAX_VIRTQUEUE_PAIRS 0x8
+
+#define VIRTIO_NET_S_LINK_UP 0x1
+
+#define VIRTIO_NET_HDR_F_NEEDS_CSUM 0x1
+
+#define VIRTIO_NET_OK 0
+#define VIRTIO_NET_ERR 1
+#define VIRTIO_NET_CTRL_MQ 4
+#define VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET 0
+
+UNMAP_AFTER_INIT ErrorOr<bool> VirtIONetworkAdapter::probe(PCI::DeviceIdentifier const& pci_device_identifier)
+{
+    if (kernel_command_line().disable_virtio())
+        return false;
+    if (pci_device_identifier.hardware_id().vendor_id != PCI::VendorID::VirtIO)
+        return false;
+    if (pci_device_identifier.hardware_id().device_id != PCI::DeviceID::VirtIONetAdapter)
+        return false;
+    return true;
+}
+
+UNMAP_AFTER_INIT ErrorOr<NonnullLockRefPtr<NetworkAdapter>> VirtIONetworkAdapter::create(PCI::DeviceIdentifier const& pci_device_identifier)
+{
+    auto interface_name = TRY(NetworkingManagement::generate_interface_name_from_pci_address(pci_device_identifier));
+    return TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) VirtIONetworkAdapter(pci_device_identifier, move(interface_name))));
+}
+
+UNMAP_AFTER_INIT VirtIONetworkAdapter::VirtIONetworkAdapter(PCI::DeviceIdentifier const& pci_device_identifier, NonnullOwnPtr<KString> interface_name)
+    : NetworkAdapter(move(interface_name))
+    , VirtIO::Device(pci_device_identifier)
+{
+}
+
+UNMAP_AFTER_INIT VirtIONetworkAdapter::~VirtIONetworkAdapter() = default;
+
+UNMAP_AFTER_INIT ErrorOr<void> VirtIONetworkAdapter::initialize(Badge<NetworkingManagement>)
+{
+    VirtIO::Device::initialize();
+    auto const* device_config = get_config(VirtIO::ConfigurationType::Device);
+    if (!device_config) {
+        dmesgln_pci(*this, "Legacy devices are not supported");
+        return Error::from_errno(ENODEV);
+    }
+
+    bool success = negotiate_features([&](u64 supported_features) {
+        u64 negotiated = 0;
+        if (is_feature_set(supported_features, VIRTIO_NET_F_CSUM))
+            negotiated |= VIRTIO_NET_F_CSUM;
+        if (is_feature_set(supported_features, VIRTIO_NET_F_GUEST_CSUM))
+            negotiated |= VIRTIO_NET_F_GUEST_CSUM;
+        if (is_feature_set(supported_features, VIRTIO_NET_F_MAC))
+            negotiated |= VIRTIO_NET_F_MAC;
+        if (is_feature_set(supported_features, VIRTIO_NET_F_MRG_RXBUF))
+            negotiated |= VIRTIO_NET_F_MRG_RXBUF;
+        if (is_feature_set(supported_features, VIRTIO_NET_F_STATUS))
+            negotiated |= VIRTIO_NET_F_STATUS;
+        // Multiple queue pairs are enabled through the control queue.
+        if (is_feature_set(supported_features, VIRTIO_NET_F_CTRL_VQ | VIRTIO_NET_F_MQ))
+            negotiated |= VIRTIO_NET_F_CTRL_VQ | VIRTIO_NET_F_MQ;
+        if (is_feature_set(supported_features, VIRTIO_F_EVENT_IDX))
+            negotiated |= VIRTIO_F_EVENT_IDX;
+        return negotiated;
+    });
+    if (!success)
+        return Error::from_errno(EIO);
+    // NOTE: The header has a different size for legacy devices, and they don't have a device configuration either.
+    if (!is_feature_accepted(VIRTIO_F_VERSION_1)) {
+        dmesgln_pci(*this, "Legacy devices are not supported");
+        return Error::from_errno(ENODEV);
+    }
+    m_device_config = device_config;
+
+    MACAddress mac_address;
+    u16 max_queue_pairs = 1;
+    read_config_atomic([&]() {
+        if (is_feature_accepted(VIRTIO_NET_F_MAC)) {
+            for (size_t i = 0; i < 6; ++i)
+                mac_address[i] = config_read8(*m_device_config, CONFIG_MAC + i);
+        }
+        if (is_feature_accepted(VIRTIO_NET_F_MQ))
+            max_queue_pairs = config_read16(*m_device_config, CONFIG_MAX_VIRTQUEUE_PAIRS);
+    });
+    if (!is_feature_accepted(VIRTIO_NET_F_MAC)) {
+        // The device leaves it up to us, so make up a locally administered address.
+        get_fast_random_bytes({ &mac_address[0], 6 });
+        mac_address[0] = (mac_address[0] & 0xFE) | 0x02;
+    }
+    set_mac_address(mac_address);
+    dmesgln_pci(*this, "MAC address: {}", mac_address.to_string());
+
+    // NOTE: The control queue comes after all the queue pairs the device has, even the ones we don't use.
+    u16 queue_count = 2;
+    if (is_feature_accepted(VIRTIO_NET_F_MQ)) {
+        m_control_queue_index = max_queue_pairs * 2;
+        queue_count = max_queue_pairs * 2 + 1;
+    }
+    if (!setup_queues(queue_count))
+        return Error::from_errno(EIO);
+    finish_init();
+
+    auto queue_pair_count = min(min<size_t>(max_queue_pairs, Processor::count()), max_receive_queues);
+    for (u16 i = 0; i < queue_pair_count; ++i) {
+        auto queue_pair = TRY(adopt_nonnull_own_or_enomem(new (nothrow) QueuePair(i)));
+        TRY(initialize_queue_pair(*queue_pair));
+        TRY(m_queue_pairs.try_append(move(queue_pair)));
+    }
+
+    if (m_control_queue_index.has_value()) {
+        get_queue(*m_control_queue_index).disable_interrupts();
+        m_control_buffer = TRY(MM.allocate_contiguous_kernel_region(PAGE_SIZE, "VirtIONetworkAdapter Control"sv, Memory::Region::Access::ReadWrite));
+        if (m_queue_pairs.size() > 1) {
+            u16 pair_count = m_queue_pairs.size();
+            TRY(send_control_command(VIRTIO_NET_CTRL_MQ, VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET, { &pair_count, sizeof(pair_count) }));
+        }
+    }
+    dmesgln_pci(*this, "Using {} of {} queue pairs", m_queue_pairs.size(), max_queue_pairs);
+
+    // NOTE: The stack doesn't verify received checksums, so there's nothing to do for the ones the device leaves out.
+    if (is_feature_accepted(VIRTIO_NET_F_CSUM))
+        set_offloads(NetworkOffload::TransmitTCPChecksum | NetworkOffload::ReceiveChecksum);
+
+    update_link_status();
+    return {};
+}
+
+UNMAP_AFTER_INIT ErrorOr<void> VirtIONetworkAdapter::initialize_queue_pair(QueuePair& queue_pair)
+{
+    auto& rx_queue = get_queue(rx_queue_index(queue_pair.index));
+    auto& tx_queue = get_queue(tx_queue_index(queue_pair.index));
+    size_t rx_buffer_count = min<size_t>(rx_queue.size(), max_buffers_per_queue);
+    size_t tx_buffer_count = min<size_t>(tx_queue.size(), max_buffers_per_queue);
+    queue_pair.rx_buffers = TRY(MM.allocate_contiguous_kernel_region(TRY(Memory::page_round_up(rx_buffer_count * buffer_size)), "VirtIONetworkAdapter RX buffers"sv, Memory::Region::Access::ReadWrite));
+    queue_pair.tx_buffers = TRY(MM.allocate_contiguous_kernel_region(TRY(Memory::page_round_up(tx_buffer_count * buffer_size)), "VirtIONetworkAdapter TX buffers"sv, Memory::Region::Access::ReadWrite));
+
+    TRY(queue_pair.free_tx_buffers.try_ensure_capacity(tx_buffer_count));
+    for (size_t i = 0; i < tx_buffer_count; ++i)
+        queue_pair.free_tx_buffers.unchecked_append(i);
+    // NOTE: Sent buffers are reclaimed when sending the next packets, so there's no need to hear about them.
+    tx_queue.disable_interrupts();
+
+    SpinlockLocker lock(rx_queue.lock());
+    auto rx_buffers_start = queue_pair.rx_buffers->physical_page(0)->paddr();
+    for (size_t i = 0; i < rx_buffer_count; ++i) {
+        VirtIO::QueueChain chain(rx_queue);
+        bool did_add_buffer = chain.add_buffer_to_chain(rx_buffers_start.offset(i * buffer_size), buffer_size, VirtIO::BufferType::DeviceWritable);
+        VERIFY(did_add_buffer);
+        chain.submit_to_queue();
+    }
+    notify_queue_if_needed(rx_queue_index(queue_pair.index));
+    return {};
+}
+
+UNMAP_AFTER_INIT ErrorOr<void> VirtIONetworkAdapter::send_control_command(u8 command_class, u8 command, ReadonlyBytes data)
+{
+    VERIFY(m_control_queue_index.has_value());
+    auto& queue = get_queue(*m_control_queue_index);
+    auto* buffer = m_control_buffer->vaddr().as_ptr();
+    size_t ack_offset = 2 + data.size();
+    VERIFY(ack_offset < m_control_buffer->size());
+    {
+        SpinlockLocker lock(queue.lock());
+        buffer[0] = command_class;
+        buffer[1] = command;
+        memcpy(buffer + 2, data.data(), data.size());
+        buffer[ack_offset] = VIRTIO_NET_ERR;
+        auto buffer_start = m_control_buffer->physical_page(0)->paddr();
+        VirtIO::QueueChain chain(queue);
+        chain.add_buffer_to_chain(buffer_start, ack_offset, VirtIO::BufferType::DeviceReadable);
+        chain.add_buffer_to_chain(buffer_start.offset(ack_offset), 1, VirtIO::BufferType::DeviceWritable);
+        supply_chain_and_notify(*m_control_queue_index, chain);
+    }
+
+    // NOTE: Commands are only sent during initialization, so we can afford to wait for the answer right here.
+    for (size_t attempt = 0; !queue.new_data_available(); ++attempt) {
+        if (attempt == 1000) {
+            dmesgln_pci(*this, "Control command {}:{} timed out", command_class, command);
+            return Error::from_errno(ETIMEDOUT);
+        }
+        microseconds_delay(100);
+    }
+    SpinlockLocker lock(queue.lock());
+    size_t used;
+    auto chain = queue.pop_used_buffer_chain(used);
+    chain.release_buffer_slots_to_queue();
+    if (buffer[ack_offset] != VIRTIO_NET_OK) {
+        dmesgln_pci(*this, "Control command {}:{} failed", command_class, command);
+        return Error::from_errno(EIO);
+    }
+    return {};
+}
+
+void VirtIONetworkAdapter::update_link_status()
+{
+    // Without the status feature, the link is always up.
+    bool link_up = true;
+    if (is_feature_accepted(VIRTIO_NET_F_STATUS))
+        link_up = (config_read16(*m_device_config, CONFIG_STATUS) & VIRTIO_NET_S_LINK_UP) != 0;
+    if (link_up != m_link_up)
+        dmesgln_pci(*this, "Link status changed up={}", link_up);
+    m_link_up = link_up;
+}
+
+bool VirtIONetworkAdapter::handle_device_config_change()
+{
+    if (!m_device_config)
+        return true;
+    update_link_status();
+    return true;
+}
+
+void VirtIONetworkAdapter::handle_queue_update(u16 queue_index)
+{
+    if (m_control_queue_index.has_value() && queue_index == *m_control_queue_index)
+        return;
+    if (queue_index % 2 == 1) {
+        m_tx_wait_queue.wake_all();
+        return;
+    }
+    get_queue(queue_index).disable_interrupts();
+    schedule_receive_poll();
+}
+
+u8* VirtIONetworkAdapter::rx_buffer_for(QueuePair& queue_pair, VirtIO::QueueChain& chain)
+{
+    VERIFY(chain.length() == 1);
+    u8* buffer = nullptr;
+    chain.for_each([&](PhysicalAddress address, size_t) {
+        auto offset = address.get() - queue_pair.rx_buffers->physical_page(0)->paddr().get();
+        buffer = queue_pair.rx_buffers->vaddr().offset(offset).as_ptr();
+    });
+    return buffer;
+}
+
+size_t VirtIONetworkAdapter::poll_rx_queue(QueuePair& queue_pair, size_t budget)
+{
+    auto queue_index = rx_queue_index(queue_pair.index);
+    auto& queue = get_queue(queue_index);
+    SpinlockLocker lock(queue.lock());
+    size_t packet_count = 0;
+    for (; packet_count < budget; ++packet_count) {
+        size_t used;
+        auto chain = queue.pop_used_buffer_chain(used);
+        if (chain.is_empty())
+            break;
+        auto const& header = *reinterpret_cast<NetHeader const*>(rx_buffer_for(queue_pair, chain));
+        if (used < sizeof(NetHeader) || used > buffer_size) {
+            dmesgln_pci(*this, "Received a buffer of invalid size {}", used);
+        } else if (is_feature_accepted(VIRTIO_NET_F_MRG_RXBUF) && header.buffer_count != 1) {
+            // NOTE: A frame only needs more than one buffer if the device was allowed to hand us frames larger than the MTU.
+            dbgln_if(VIRTIO_DEBUG, "VirtIONetworkAdapter: Dropping frame spread over {} buffers", header.buffer_count);
+            for (size_t i = 1; i < header.buffer_count; ++i) {
+                auto rest_of_frame = queue.pop_used_buffer_chain(used);
+                if (rest_of_frame.is_empty())
+                    break;
+                rest_of_frame.submit_to_queue();
+            }
+        } else {
+            did_receive({ reinterpret_cast<u8 const*>(&header) + sizeof(NetHeader), used - sizeof(NetHeader) });
+        }
+        // The buffer goes straight back to the device.
+        chain.submit_to_queue();
+    }
+    if (packet_count > 0)
+        notify_queue_if_needed(queue_index);
+    return packet_count;
+}
+
+size_t VirtIONetworkAdapter::poll_rx_ring(size_t budget)
+{
+    // Start with a different queue every time, so that a busy one can't starve the others.
+    size_t packet_count = 0;
+    for (size_t i = 0; i < m_queue_pairs.size() && packet_count < budget; ++i)
+        packet_count += poll_rx_queue(m_queue_pairs[(m_next_rx_pair + i) % m_queue_pairs.size()], budget - packet_count);
+    m_next_rx_pair = (m_next_rx_pair + 1) % m_queue_pairs.size();
+    return packet_count;
+}
+
+void VirtIONetworkAdapter::end_receive_polling(size_t)
+{
+    bool has_more_data = false;
+    for (auto& queue_pair : m_queue_pairs) {
+        auto& queue = get_queue(rx_queue_index(queue_pair.index));
+        queue.enable_interrupts();
+        // NOTE: Frames that arrived before the interrupts were enabled again don't raise one.
+        if (queue.new_data_available())
+            has_more_data = true;
+    }
+    if (has_more_data) {
+        for (auto& queue_pair : m_queue_pairs)
+            get_queue(rx_queue_index(queue_pair.index)).disable_interrupts();
+        schedule_receive_poll();
+    }
+}
+
+void VirtIONetworkAdapter::reclaim_tx_buffers(QueuePair& queue_pair)
+{
+    auto& queue = get_queue(tx_queue_index(queue_pair.index));
+    VERIFY(queue.lock().is_locked());
+    auto tx_buffers_start = queue_pair.tx_buffers->physical_page(0)->paddr().get();
+    size_t used;
+    for (auto chain = queue.pop_used_buffer_chain(used); !chain.is_empty(); chain = queue.pop_used_buffer_chain(used)) {
+        chain.for_each([&](PhysicalAddress address, size_t) {
+            queue_pair.free_tx_buffers.unchecked_append((address.get() - tx_buffers_start) / buffer_size);
+        });
+        chain.release_buffer_slots_to_queue();
+    }
+}
+
+void VirtIONetworkAdapter::send_raw(ReadonlyBytes payload)
+{
+    transmit(payload, nullptr);
+}
+
+void VirtIONetworkAdapter::send_raw_with_offload(ReadonlyBytes payload, TransmitOffload const& offload)
+{
+    transmit(payload, &offload);
+}
+
+void VirtIONetworkAdapter::transmit(ReadonlyBytes payload, TransmitOffload const* offload)
+{
+    VERIFY(sizeof(NetHeader) + payload.size() <= buffer_size);
+    auto& queue_pair = m_queue_pairs[Processor::current_id() % m_queue_pairs.size()];
+    auto queue_index = tx_queue_index(queue_pair.index);
+    auto& queue = get_queue(queue_index);
+    MutexLocker locker(queue_pair.tx_lock);
+
+    for (;;) {
+        {
+            SpinlockLocker lock(queue.lock());
+            reclaim_tx_buffers(queue_pair);
+            if (!queue_pair.free_tx_buffers.is_empty())
+                break;
+        }
+        // All buffers are in flight, so wait for the device to send some of them.
+        queue.enable_interrupts();
+        if (!queue.new_data_available())
+            m_tx_wait_queue.wait_forever("VirtIONetworkAdapter"sv);
+        queue.disable_interrupts();
+    }
+
+    SpinlockLocker lock(queue.lock());
+    auto buffer_index = queue_pair.free_tx_buffers.take_last();
+    auto* buffer = queue_pair.tx_buffers->vaddr().offset(buffer_index * buffer_size).as_ptr();
+    auto& header = *reinterpret_cast<NetHeader*>(buffer);
+    header = {};
+    if (offload && offload->tcp_checksum) {
+        constexpr size_t tcp_checksum_offset = 16;
+        VERIFY(payload.size() >= sizeof(EthernetFrameHeader) + sizeof(IPv4Packet));
+        auto const& ipv4_packet = *reinterpret_cast<IPv4Packet const*>(payload.offset(sizeof(EthernetFrameHeader)));
+        // NOTE: The checksum field already holds the checksum of the pseudo header, which is what the device expects.
+        header.flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+        header.checksum_start = sizeof(EthernetFrameHeader) + ipv4_packet.internet_header_length() * sizeof(u32);
+        header.checksum_offset = tcp_checksum_offset;
+    }
+    memcpy(buffer + sizeof(NetHeader), payload.data(), payload.size());
+
+    VirtIO::QueueChain chain(queue);
+    auto buffer_start = queue_pair.tx_buffers->physical_page(0)->paddr().offset(buffer_index * buffer_size);
+    // NOTE: There are no more buffers than descriptors, and every packet takes one of each.
+    bool did_add_buffer = chain.add_buffer_to_chain(buffer_start, sizeof(NetHeader) + payload.size(), VirtIO::BufferType::DeviceReadable);
+    VERIFY(did_add_buffer);
+    supply_chain_and_notify(queue_index, chain);
+    dbgln_if(VIRTIO_DEBUG, "VirtIONetworkAdapter: Sent packet ({} bytes) on queue {}", payload.size(), queue_index);
+}
+
+}
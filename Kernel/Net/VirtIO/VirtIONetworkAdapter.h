@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/OwnPtr.h>
+#include <Kernel/Bus/VirtIO/Device.h>
+#include <Kernel/Locking/Mutex.h>
+#include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+// Driver for the network device of the VirtIO specification, see section 5.1 of https://docs.oasis-open.org/virtio/virtio/v1.1/virtio-v1.1.html
+class VirtIONetworkAdapter final
+    : public NetworkAdapter
+    , public VirtIO::Device {
+public:
+    static ErrorOr<bool> probe(PCI::DeviceIdentifier const&);
+    static ErrorOr<NonnullLockRefPtr<NetworkAdapter>> create(PCI::DeviceIdentifier const&);
+    virtual ErrorOr<void> initialize(Badge<NetworkingManagement>) override;
+
+    virtual ~VirtIONetworkAdapter() override;
+
+    virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_with_offload(ReadonlyBytes, TransmitOffload const&) override;
+    virtual bool link_up() override { return m_link_up; }
+    virtual bool link_full_duplex() override { return true; }
+
+    virtual StringView purpose() const override { return class_name(); }
+    virtual StringView device_name() const override { return class_name(); }
+    virtual Type adapter_type() const override { return Type::Ethernet; }
+
+private:
+    // Every buffer holds a header and a whole frame, as no segmentation offloads are negotiated.
+    static constexpr size_t buffer_size = 2048;
+    static constexpr size_t max_buffers_per_queue = 256;
+
+    struct [[gnu::packed]] NetHeader {
+        u8 flags;
+        u8 gso_type;
+        u16 header_length;
+        u16 gso_size;
+        u16 checksum_start;
+        u16 checksum_offset;
+        u16 buffer_count;
+    };
+
+    // Each pair has its own buffers, and its TX queue its own lock, so that CPUs don't have to take turns sending.
+    struct QueuePair {
+        explicit QueuePair(u16 pair_index)
+            : index(pair_index)
+        {
+        }
+
+        u16 index { 0 };
+        OwnPtr<Memory::Region> rx_buffers;
+        OwnPtr<Memory::Region> tx_buffers;
+        Vector<u16> free_tx_buffers;
+        Mutex tx_lock { "VirtIONetworkAdapter TX"sv };
+    };
+
+    explicit VirtIONetworkAdapter(PCI::DeviceIdentifier const&, NonnullOwnPtr<KString>);
+
+    using VirtIO::Device::initialize;
+    virtual StringView class_name() const override { return "VirtIONetworkAdapter"sv; }
+
+    virtual bool handle_device_config_change() override;
+    virtual void handle_queue_update(u16 queue_index) override;
+
+    virtual size_t poll_rx_ring(size_t budget) override;
+    virtual void end_receive_polling(size_t packet_count) override;
+
+    static u16 rx_queue_index(u16 pair_index) { return pair_index * 2; }
+    static u16 tx_queue_index(u16 pair_index) { return pair_index * 2 + 1; }
+
+    ErrorOr<void> initialize_queue_pair(QueuePair&);
+    ErrorOr<void> send_control_command(u8 command_class, u8 command, ReadonlyBytes data);
+    void update_link_status();
+
+    size_t poll_rx_queue(QueuePair&, size_t budget);
+    u8* rx_buffer_for(QueuePair&, VirtIO::QueueChain&);
+    void transmit(ReadonlyBytes, TransmitOffload const*);
+    void reclaim_tx_buffers(QueuePair&);
+
+    VirtIO::Configuration const* m_device_config { nullptr };
+    NonnullOwnPtrVector<QueuePair> m_queue_pairs;
+    Optional<u16> m_control_queue_index;
+    OwnPtr<Memory::Region> m_control_buffer;
+    size_t m_next_rx_pair { 0 };
+    bool m_link_up { false };
+    WaitQueue m_tx_wait_queue;
+};
+
+}
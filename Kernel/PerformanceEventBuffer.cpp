@@ -28,7 +28,7 @@ NEVER_INLINE ErrorOr<void> PerformanceEventBuffer::append(int type, FlatPtr arg1
     return append_with_ip_and_bp(current_thread->pid(), current_thread->tid(), 0, base_pointer, type, 0, arg1, arg2, arg3, arg4, arg5, arg6);
 }
 
-static Vector<FlatPtr, PerformanceEvent::max_stack_frame_count> raw_backtrace(FlatPtr bp, FlatPtr ip)
+Vector<FlatPtr, PerformanceEvent::max_stack_frame_count> PerformanceEventBuffer::raw_backtrace(FlatPtr bp, FlatPtr ip)
 {
     Vector<FlatPtr, PerformanceEvent::max_stack_frame_count> backtrace;
     if (ip != 0)
@@ -97,6 +97,10 @@ ErrorOr<void> PerformanceEventBuffer::append_with_ip_and_bp(ProcessID pid, Threa
 
     switch (type) {
     case PERF_EVENT_SAMPLE:
+    case PERF_EVENT_CPU_CYCLES:
+    case PERF_EVENT_INSTRUCTIONS:
+    case PERF_EVENT_CACHE_MISSES:
+    case PERF_EVENT_BRANCH_MISSES:
         break;
     case PERF_EVENT_MALLOC:
         event.data.malloc.size = arg1;
@@ -296,6 +300,18 @@ ErrorOr<void> PerformanceEventBuffer::to_json_impl(Serializer& object) const
             TRY(event_object.add("start_timestamp"sv, event.data.read.start_timestamp));
             TRY(event_object.add("success"sv, event.data.read.success));
             break;
+        case PERF_EVENT_CPU_CYCLES:
+            TRY(event_object.add("type"sv, "cpu_cycles"sv));
+            break;
+        case PERF_EVENT_INSTRUCTIONS:
+            TRY(event_object.add("type"sv, "instructions"sv));
+            break;
+        case PERF_EVENT_CACHE_MISSES:
+            TRY(event_object.add("type"sv, "cache_misses"sv));
+            break;
+        case PERF_EVENT_BRANCH_MISSES:
+            TRY(event_object.add("type"sv, "branch_misses"sv));
+            break;
         }
         TRY(event_object.add("pid"sv, event.pid));
         TRY(event_object.add("tid"sv, event.tid));
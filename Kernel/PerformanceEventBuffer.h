@@ -134,6 +134,8 @@ public:
 
     ErrorOr<FlatPtr> register_string(NonnullOwnPtr<KString>);
 
+    static Vector<FlatPtr, PerformanceEvent::max_stack_frame_count> raw_backtrace(FlatPtr bp, FlatPtr ip);
+
 private:
     explicit PerformanceEventBuffer(NonnullOwnPtr<KBuffer>);
 
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <Kernel/ContinuousProfiler.h>
 #include <Kernel/PerformanceEventBuffer.h>
 #include <Kernel/Process.h>
 #include <Kernel/Thread.h>
@@ -66,6 +67,16 @@ public:
         }
     }
 
+    static void add_hardware_counter_event(Thread& current_thread, RegisterState const& regs, int type)
+    {
+        if (current_thread.is_profiling_suppressed())
+            return;
+        if (auto* event_buffer = current_thread.process().current_perf_events_buffer()) {
+            [[maybe_unused]] auto rc = event_buffer->append_with_ip_and_bp(
+                current_thread.pid(), current_thread.tid(), regs, type, 0, 0, 0, {});
+        }
+    }
+
     static void add_mmap_perf_event(Process& current_process, Memory::Region const& region)
     {
         if (auto* event_buffer = current_process.current_perf_events_buffer()) {
@@ -176,6 +187,7 @@ public:
             return;
 
         auto lost_samples = delay.to_microseconds() / ideal_interval.to_microseconds();
+        ContinuousProfiler::add_sample(*current_thread, regs, lost_samples);
         PerformanceManager::add_cpu_sample_event(*current_thread, regs, lost_samples);
     }
 };
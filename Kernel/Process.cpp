@@ -20,6 +20,7 @@
 #include <Kernel/API/POSIX/errno.h>
 #include <Kernel/API/POSIX/sys/limits.h>
 #include <Kernel/Arch/PageDirectory.h>
+#include <Kernel/Arch/PerformanceCounters.h>
 #include <Kernel/Devices/NullDevice.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/OpenFileDescription.h>
@@ -750,6 +751,7 @@ void Process::finalize()
             if (result.is_error())
                 dmesgln("Failed to write perfcore for pid {}: {}", pid(), result.error());
             TimeManagement::the().disable_profile_timer();
+            PerformanceCounters::disable();
         }
     }
 
@@ -14,6 +14,7 @@
 #include <AK/RefPtr.h>
 #include <AK/Userspace.h>
 #include <AK/Variant.h>
+#include <Kernel/API/IORing.h>
 #include <Kernel/API/POSIX/sys/resource.h>
 #include <Kernel/API/Syscall.h>
 #include <Kernel/Assertions.h>
@@ -292,6 +293,9 @@ public:
     void tracer_trap(Thread&, RegisterState const&);
 
     ErrorOr<FlatPtr> sys$emuctl();
+    ErrorOr<FlatPtr> sys$epoll_create(int flags);
+    ErrorOr<FlatPtr> sys$epoll_ctl(int epfd, int op, int fd, Userspace<epoll_event*>);
+    ErrorOr<FlatPtr> sys$epoll_wait(int epfd, Userspace<epoll_event*>, int max_events, int timeout_ms);
     ErrorOr<FlatPtr> sys$yield();
     ErrorOr<FlatPtr> sys$sync();
     ErrorOr<FlatPtr> sys$beep();
@@ -300,6 +304,8 @@ public:
     ErrorOr<FlatPtr> sys$create_inode_watcher(u32 flags);
     ErrorOr<FlatPtr> sys$inode_watcher_add_watch(Userspace<Syscall::SC_inode_watcher_add_watch_params const*> user_params);
     ErrorOr<FlatPtr> sys$inode_watcher_remove_watch(int fd, int wd);
+    ErrorOr<FlatPtr> sys$io_ring_create(u32 entries, int options);
+    ErrorOr<FlatPtr> sys$io_ring_enter(int fd, u32 to_submit);
     ErrorOr<FlatPtr> sys$dbgputstr(Userspace<char const*>, size_t);
     ErrorOr<FlatPtr> sys$dump_backtrace();
     ErrorOr<FlatPtr> sys$gettid();
@@ -345,6 +351,7 @@ public:
     ErrorOr<FlatPtr> sys$purge(int mode);
     ErrorOr<FlatPtr> sys$poll(Userspace<Syscall::SC_poll_params const*>);
     ErrorOr<FlatPtr> sys$get_dir_entries(int fd, Userspace<void*>, size_t);
+    ErrorOr<FlatPtr> sys$get_dir_entries_with_stat(int fd, Userspace<void*>, size_t);
     ErrorOr<FlatPtr> sys$getcwd(Userspace<char*>, size_t);
     ErrorOr<FlatPtr> sys$chdir(Userspace<char const*>, size_t);
     ErrorOr<FlatPtr> sys$fchdir(int fd);
@@ -405,6 +412,8 @@ public:
     ErrorOr<FlatPtr> sys$shutdown(int sockfd, int how);
     ErrorOr<FlatPtr> sys$sendmsg(int sockfd, Userspace<const struct msghdr*>, int flags);
     ErrorOr<FlatPtr> sys$recvmsg(int sockfd, Userspace<struct msghdr*>, int flags);
+    ErrorOr<FlatPtr> sys$sendmmsg(int sockfd, Userspace<struct mmsghdr*>, unsigned message_count, int flags);
+    ErrorOr<FlatPtr> sys$recvmmsg(Userspace<Syscall::SC_recvmmsg_params const*>);
     ErrorOr<FlatPtr> sys$getsockopt(Userspace<Syscall::SC_getsockopt_params const*>);
     ErrorOr<FlatPtr> sys$setsockopt(Userspace<Syscall::SC_setsockopt_params const*>);
     ErrorOr<FlatPtr> sys$getsockname(Userspace<Syscall::SC_getsockname_params const*>);
@@ -437,6 +446,7 @@ public:
     ErrorOr<FlatPtr> sys$get_stack_bounds(Userspace<FlatPtr*> stack_base, Userspace<size_t*> stack_size);
     ErrorOr<FlatPtr> sys$ptrace(Userspace<Syscall::SC_ptrace_params const*>);
     ErrorOr<FlatPtr> sys$sendfd(int sockfd, int fd);
+    ErrorOr<FlatPtr> sys$sendfile(int out_fd, int in_fd, Userspace<off_t*>, size_t);
     ErrorOr<FlatPtr> sys$recvfd(int sockfd, int options);
     ErrorOr<FlatPtr> sys$sysconf(int name);
     ErrorOr<FlatPtr> sys$disown(ProcessID);
@@ -637,6 +647,12 @@ private:
     ErrorOr<void> remap_range_as_stack(FlatPtr address, size_t size);
 
     ErrorOr<FlatPtr> read_impl(int fd, Userspace<u8*> buffer, size_t size);
+    ErrorOr<FlatPtr> pread_impl(int fd, Userspace<u8*> buffer, size_t size, off_t offset);
+    ErrorOr<FlatPtr> pwrite_impl(int fd, Userspace<u8 const*> data, size_t size, off_t offset);
+    ErrorOr<FlatPtr> accept_impl(int accepting_socket_fd, Userspace<sockaddr*> user_address, Userspace<socklen_t*> user_address_size, int flags);
+    ErrorOr<FlatPtr> sendmsg_impl(OpenFileDescription&, struct msghdr const&, int flags);
+    ErrorOr<FlatPtr> recvmsg_impl(OpenFileDescription&, Userspace<struct msghdr*>, int flags);
+    ErrorOr<FlatPtr> execute_io_ring_submission(IORingSubmission const&);
 
 public:
     NonnullLockRefPtr<ProcessProcFSTraits> procfs_traits() const { return *m_procfs_traits; }
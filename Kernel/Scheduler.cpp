@@ -6,7 +6,6 @@
 
 #include <AK/BuiltinWrappers.h>
 #include <AK/ScopeGuard.h>
-#include <AK/Singleton.h>
 #include <AK/Time.h>
 #include <Kernel/Arch/TrapFrame.h>
 #include <Kernel/Debug.h>
@@ -46,16 +45,35 @@ struct ThreadReadyQueues {
     Array<ThreadReadyQueue, count> queues;
 };
 
-static Singleton<SpinlockProtected<ThreadReadyQueues, LockRank::None>> g_ready_queues;
+struct SchedulerPerProcessorData {
+    static ProcessorSpecificDataID processor_specific_data_id() { return ProcessorSpecificDataID::Scheduler; }
 
-static SpinlockProtected<TotalTimeScheduled, LockRank::None> g_total_time_scheduled {};
+    SpinlockProtected<ThreadReadyQueues, LockRank::None> m_ready_queues {};
+
+    // Number of threads in m_ready_queues. This is only a hint that lets other
+    // processors skip empty queues without taking the lock when looking for
+    // work to steal.
+    Atomic<u32> m_runnable_count { 0 };
+
+    // The time scheduled on this processor. These are only summed up when someone asks for the totals, so that
+    // processors don't contend on them on every context switch.
+    Atomic<u64> m_total_time_scheduled { 0 };
+    Atomic<u64> m_total_time_scheduled_kernel { 0 };
+};
+
+// Each processor registers its ready queues here in set_idle_thread(), so that
+// other processors can enqueue threads to it and steal threads from it.
+// NOTE: Affinity masks are 32 bits wide, so we can't schedule on more processors than that.
+static constexpr u32 max_scheduled_processor_count = min<size_t>(MAX_CPU_COUNT, sizeof(u32) * 8);
+static Array<SchedulerPerProcessorData*, max_scheduled_processor_count> s_per_processor_data {};
+static Atomic<u32> s_processors_with_ready_queues_mask { 0 };
 
 static void dump_thread_list(bool = false);
 
 static inline u32 thread_priority_to_priority_index(u32 thread_priority)
 {
     // Converts the priority in the range of THREAD_PRIORITY_MIN...THREAD_PRIORITY_MAX
-    // to a index into g_ready_queues where 0 is the highest priority bucket
+    // to a index into ThreadReadyQueues::queues where 0 is the highest priority bucket
     VERIFY(thread_priority >= THREAD_PRIORITY_MIN && thread_priority <= THREAD_PRIORITY_MAX);
     constexpr u32 thread_priority_count = THREAD_PRIORITY_MAX - THREAD_PRIORITY_MIN + 1;
     static_assert(thread_priority_count > 0);
@@ -64,94 +82,165 @@ static inline u32 thread_priority_to_priority_index(u32 thread_priority)
     return priority_bucket;
 }
 
-Thread& Scheduler::pull_next_runnable_thread()
+Thread* Scheduler::find_runnable_thread(ThreadReadyQueues& ready_queues, u32 affinity_mask)
 {
-    auto affinity_mask = 1u << Processor::current_id();
-
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread& {
-        auto priority_mask = ready_queues.mask;
-        while (priority_mask != 0) {
-            auto priority = bit_scan_forward(priority_mask);
-            VERIFY(priority > 0);
-            auto& ready_queue = ready_queues.queues[--priority];
-            for (auto& thread : ready_queue.thread_list) {
-                VERIFY(thread.m_runnable_priority == (int)priority);
-                if (thread.is_active())
-                    continue;
-                if (!(thread.affinity() & affinity_mask))
-                    continue;
-                thread.m_runnable_priority = -1;
-                ready_queue.thread_list.remove(thread);
-                if (ready_queue.thread_list.is_empty())
-                    ready_queues.mask &= ~(1u << priority);
-                // Mark it as active because we are using this thread. This is similar
-                // to comparing it with Processor::current_thread, but when there are
-                // multiple processors there's no easy way to check whether the thread
-                // is actually still needed. This prevents accidental finalization when
-                // a thread is no longer in Running state, but running on another core.
-
-                // We need to mark it active here so that this thread won't be
-                // scheduled on another core if it were to be queued before actually
-                // switching to it.
-                // FIXME: Figure out a better way maybe?
-                thread.set_active(true);
-                return thread;
-            }
-            priority_mask &= ~(1u << priority);
+    auto priority_mask = ready_queues.mask;
+    while (priority_mask != 0) {
+        auto priority = bit_scan_forward(priority_mask);
+        VERIFY(priority > 0);
+        auto& ready_queue = ready_queues.queues[--priority];
+        for (auto& thread : ready_queue.thread_list) {
+            VERIFY(thread.m_runnable_priority == (int)priority);
+            if (thread.is_active())
+                continue;
+            if (!(thread.affinity() & affinity_mask))
+                continue;
+            return &thread;
         }
-        return *Processor::idle_thread();
+        priority_mask &= ~(1u << priority);
+    }
+    return nullptr;
+}
+
+void Scheduler::remove_runnable_thread(SchedulerPerProcessorData& data, ThreadReadyQueues& ready_queues, Thread& thread)
+{
+    auto priority = thread.m_runnable_priority;
+    VERIFY(priority >= 0);
+    VERIFY(ready_queues.mask & (1u << priority));
+    auto& ready_queue = ready_queues.queues[priority];
+    thread.m_runnable_priority = -1;
+    ready_queue.thread_list.remove(thread);
+    if (ready_queue.thread_list.is_empty())
+        ready_queues.mask &= ~(1u << priority);
+    data.m_runnable_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
+}
+
+Thread* Scheduler::take_runnable_thread(SchedulerPerProcessorData& data, u32 affinity_mask)
+{
+    return data.m_ready_queues.with([&](auto& ready_queues) -> Thread* {
+        auto* thread = find_runnable_thread(ready_queues, affinity_mask);
+        if (!thread)
+            return nullptr;
+        remove_runnable_thread(data, ready_queues, *thread);
+        // Mark it as active because we are using this thread. This is similar
+        // to comparing it with Processor::current_thread, but when there are
+        // multiple processors there's no easy way to check whether the thread
+        // is actually still needed. This prevents accidental finalization when
+        // a thread is no longer in Running state, but running on another core.
+
+        // We need to mark it active here so that this thread won't be
+        // scheduled on another core if it were to be queued before actually
+        // switching to it.
+        // FIXME: Figure out a better way maybe?
+        thread->set_active(true);
+        return thread;
     });
 }
 
-Thread* Scheduler::peek_next_runnable_thread()
+template<typename Callback>
+static Thread* for_each_steal_candidate(u32 current_cpu, Callback callback)
 {
-    auto affinity_mask = 1u << Processor::current_id();
-
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread* {
-        auto priority_mask = ready_queues.mask;
-        while (priority_mask != 0) {
-            auto priority = bit_scan_forward(priority_mask);
-            VERIFY(priority > 0);
-            auto& ready_queue = ready_queues.queues[--priority];
-            for (auto& thread : ready_queue.thread_list) {
-                VERIFY(thread.m_runnable_priority == (int)priority);
-                if (thread.is_active())
-                    continue;
-                if (!(thread.affinity() & affinity_mask))
-                    continue;
-                return &thread;
-            }
-            priority_mask &= ~(1u << priority);
-        }
+    // Walk the other processors' queues, starting with our neighbor so that
+    // not every idle processor goes after the same victim first.
+    auto mask = s_processors_with_ready_queues_mask.load(AK::MemoryOrder::memory_order_acquire);
+    for (u32 i = 1; i < max_scheduled_processor_count; ++i) {
+        auto cpu = (current_cpu + i) % max_scheduled_processor_count;
+        if (!(mask & (1u << cpu)))
+            continue;
+        auto* data = s_per_processor_data[cpu];
+        if (data->m_runnable_count.load(AK::MemoryOrder::memory_order_relaxed) == 0)
+            continue;
+        if (auto* thread = callback(*data))
+            return thread;
+    }
+    return nullptr;
+}
+
+u32 Scheduler::select_processor_for(Thread const& thread)
+{
+    auto online_mask = s_processors_with_ready_queues_mask.load(AK::MemoryOrder::memory_order_acquire);
+    auto allowed_mask = thread.affinity() & online_mask;
+    // If the thread is pinned to processors that are not up yet, park it on the
+    // bootstrap processor. Nobody but an allowed processor will ever pick it up.
+    if (allowed_mask == 0)
+        return 0;
+
+    // Prefer the processor the thread last ran on, its caches are likely still warm.
+    auto last_cpu = thread.cpu();
+    if (allowed_mask & (1u << last_cpu))
+        return last_cpu;
+
+    auto current_cpu = Processor::current_id();
+    if (allowed_mask & (1u << current_cpu))
+        return current_cpu;
+
+    return bit_scan_forward(allowed_mask) - 1;
+}
+
+Thread& Scheduler::pull_next_runnable_thread()
+{
+    auto current_cpu = Processor::current_id();
+    auto affinity_mask = 1u << current_cpu;
 
-        // Unlike in pull_next_runnable_thread() we don't want to fall back to
-        // the idle thread. We just want to see if we have any other thread ready
-        // to be scheduled.
-        return nullptr;
+    if (auto* thread = take_runnable_thread(ProcessorSpecific<SchedulerPerProcessorData>::get(), affinity_mask))
+        return *thread;
+
+    // Our own queue is empty, try to steal work from a busy processor.
+    auto* stolen_thread = for_each_steal_candidate(current_cpu, [&](auto& data) {
+        return take_runnable_thread(data, affinity_mask);
     });
+    if (stolen_thread) {
+        dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Stole thread {} from processor {}", current_cpu, *stolen_thread, stolen_thread->m_runnable_cpu);
+        return *stolen_thread;
+    }
+
+    return *Processor::idle_thread();
+}
+
+Thread* Scheduler::peek_next_runnable_thread()
+{
+    auto current_cpu = Processor::current_id();
+    auto affinity_mask = 1u << current_cpu;
+
+    auto peek = [&](SchedulerPerProcessorData& data) {
+        return data.m_ready_queues.with([&](auto& ready_queues) {
+            return find_runnable_thread(ready_queues, affinity_mask);
+        });
+    };
+
+    if (auto* thread = peek(ProcessorSpecific<SchedulerPerProcessorData>::get()))
+        return thread;
+
+    // Unlike in pull_next_runnable_thread() we don't want to fall back to
+    // the idle thread. We just want to see if we have any other thread ready
+    // to be scheduled, including ones we could steal.
+    return for_each_steal_candidate(current_cpu, peek);
 }
 
 bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
 {
+    // NOTE: Only enqueue_runnable_thread() moves a thread to another processor's queue, and it does so with
+    //       g_scheduler_lock held. Holding it here as well keeps m_runnable_cpu from changing before we have
+    //       taken the lock of the queue it points to.
+    VERIFY(g_scheduler_lock.is_locked_by_current_processor());
     if (thread.is_idle_thread())
         return true;
 
-    return g_ready_queues->with([&](auto& ready_queues) {
-        auto priority = thread.m_runnable_priority;
-        if (priority < 0) {
+    if (thread.m_runnable_priority < 0) {
+        VERIFY(!thread.m_ready_queue_node.is_in_list());
+        return false;
+    }
+
+    if (check_affinity && !(thread.affinity() & (1 << Processor::current_id())))
+        return false;
+
+    auto& data = *s_per_processor_data[thread.m_runnable_cpu];
+    return data.m_ready_queues.with([&](auto& ready_queues) {
+        if (thread.m_runnable_priority < 0) {
             VERIFY(!thread.m_ready_queue_node.is_in_list());
             return false;
         }
-
-        if (check_affinity && !(thread.affinity() & (1 << Processor::current_id())))
-            return false;
-
-        VERIFY(ready_queues.mask & (1u << priority));
-        auto& ready_queue = ready_queues.queues[priority];
-        thread.m_runnable_priority = -1;
-        ready_queue.thread_list.remove(thread);
-        if (ready_queue.thread_list.is_empty())
-            ready_queues.mask &= ~(1u << priority);
+        remove_runnable_thread(data, ready_queues, thread);
         return true;
     });
 }
@@ -162,16 +251,20 @@ void Scheduler::enqueue_runnable_thread(Thread& thread)
     if (thread.is_idle_thread())
         return;
     auto priority = thread_priority_to_priority_index(thread.priority());
+    auto cpu = select_processor_for(thread);
+    auto& data = *s_per_processor_data[cpu];
 
-    g_ready_queues->with([&](auto& ready_queues) {
+    data.m_ready_queues.with([&](auto& ready_queues) {
         VERIFY(thread.m_runnable_priority < 0);
         thread.m_runnable_priority = (int)priority;
+        thread.m_runnable_cpu = cpu;
         VERIFY(!thread.m_ready_queue_node.is_in_list());
         auto& ready_queue = ready_queues.queues[priority];
         bool was_empty = ready_queue.thread_list.is_empty();
         ready_queue.thread_list.append(thread);
         if (was_empty)
             ready_queues.mask |= (1u << priority);
+        data.m_runnable_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
     });
 }
 
@@ -214,6 +307,10 @@ void Scheduler::pick_next()
             Processor::set_current_in_scheduler(false);
         });
 
+    // FIXME: The ready queues have their own per-processor locks now, but thread state changes and the hand-off
+    //        of the scheduler lock across context switches still go through g_scheduler_lock. So picking the next
+    //        thread is still serialized between processors here. Only peeking at the queues from the timer tick
+    //        avoids the global lock so far.
     SpinlockLocker lock(g_scheduler_lock);
 
     if constexpr (SCHEDULER_RUNNABLE_DEBUG) {
@@ -381,6 +478,12 @@ UNMAP_AFTER_INIT void Scheduler::initialize()
 
 UNMAP_AFTER_INIT void Scheduler::set_idle_thread(Thread* idle_thread)
 {
+    ProcessorSpecific<SchedulerPerProcessorData>::initialize();
+    auto cpu = Processor::current_id();
+    VERIFY(cpu < max_scheduled_processor_count);
+    s_per_processor_data[cpu] = &ProcessorSpecific<SchedulerPerProcessorData>::get();
+    s_processors_with_ready_queues_mask.fetch_or(1u << cpu, AK::MemoryOrder::memory_order_release);
+
     idle_thread->set_idle_thread();
     Processor::current().set_idle_thread(*idle_thread);
     Processor::set_current_thread(*idle_thread);
@@ -400,11 +503,10 @@ UNMAP_AFTER_INIT Thread* Scheduler::create_ap_idle_thread(u32 cpu)
 
 void Scheduler::add_time_scheduled(u64 time_to_add, bool is_kernel)
 {
-    g_total_time_scheduled.with([&](auto& total_time_scheduled) {
-        total_time_scheduled.total += time_to_add;
-        if (is_kernel)
-            total_time_scheduled.total_kernel += time_to_add;
-    });
+    auto& data = ProcessorSpecific<SchedulerPerProcessorData>::get();
+    data.m_total_time_scheduled.fetch_add(time_to_add, AK::MemoryOrder::memory_order_relaxed);
+    if (is_kernel)
+        data.m_total_time_scheduled_kernel.fetch_add(time_to_add, AK::MemoryOrder::memory_order_relaxed);
 }
 
 void Scheduler::timer_tick(RegisterState const& regs)
@@ -479,7 +581,9 @@ void Scheduler::idle_loop(void*)
 
     for (;;) {
         proc.idle_begin();
+        TimeManagement::the().enter_idle();
         proc.wait_for_interrupt();
+        TimeManagement::the().leave_idle();
         proc.idle_end();
         VERIFY_INTERRUPTS_ENABLED();
         yield();
@@ -499,7 +603,14 @@ bool Scheduler::is_initialized()
 
 TotalTimeScheduled Scheduler::get_total_time_scheduled()
 {
-    return g_total_time_scheduled.with([&](auto& total_time_scheduled) { return total_time_scheduled; });
+    TotalTimeScheduled total_time_scheduled;
+    for (auto* data : s_per_processor_data) {
+        if (!data)
+            continue;
+        total_time_scheduled.total += data->m_total_time_scheduled.load(AK::MemoryOrder::memory_order_relaxed);
+        total_time_scheduled.total_kernel += data->m_total_time_scheduled_kernel.load(AK::MemoryOrder::memory_order_relaxed);
+    }
+    return total_time_scheduled;
 }
 
 void dump_thread_list(bool with_stack_traces)
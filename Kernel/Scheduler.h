@@ -18,6 +18,8 @@
 namespace Kernel {
 
 struct RegisterState;
+struct SchedulerPerProcessorData;
+struct ThreadReadyQueues;
 
 extern Thread* g_finalizer;
 extern WaitQueue* g_finalizer_wait_queue;
@@ -55,6 +57,12 @@ public:
     static bool is_initialized();
     static TotalTimeScheduled get_total_time_scheduled();
     static void add_time_scheduled(u64, bool);
+
+private:
+    static Thread* find_runnable_thread(ThreadReadyQueues&, u32 affinity_mask);
+    static void remove_runnable_thread(SchedulerPerProcessorData&, ThreadReadyQueues&, Thread&);
+    static Thread* take_runnable_thread(SchedulerPerProcessorData&, u32 affinity_mask);
+    static u32 select_processor_for(Thread const&);
 };
 
 }
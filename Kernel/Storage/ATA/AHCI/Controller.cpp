@@ -93,6 +93,13 @@ void AHCIController::start_request(ATADevice const& device, AsyncBlockDeviceRequ
     port->start_request(request);
 }
 
+size_t AHCIController::queue_depth(ATADevice const& device) const
+{
+    auto port = m_ports[device.ata_address().port];
+    VERIFY(port);
+    return port->queue_depth();
+}
+
 void AHCIController::complete_current_request(AsyncDeviceRequest::RequestResult)
 {
     VERIFY_NOT_REACHED();
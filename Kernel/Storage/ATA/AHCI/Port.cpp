@@ -38,11 +38,11 @@ ErrorOr<void> AHCIPort::allocate_resources_and_initialize_ports()
 
     m_fis_receive_page = TRY(MM.allocate_physical_page());
 
-    for (size_t index = 0; index < 1; index++) {
+    for (size_t index = 0; index < command_slots_count(); index++) {
         auto dma_page = TRY(MM.allocate_physical_page());
         m_dma_buffers.append(move(dma_page));
     }
-    for (size_t index = 0; index < 1; index++) {
+    for (size_t index = 0; index < command_slots_count(); index++) {
         auto command_table_page = TRY(MM.allocate_physical_page());
         m_command_table_pages.append(move(command_table_page));
     }
@@ -66,6 +66,14 @@ UNMAP_AFTER_INIT AHCIPort::AHCIPort(AHCIController const& controller, NonnullRef
 {
 }
 
+size_t AHCIPort::command_slots_count() const
+{
+    // Note: Without native command queuing there's no point in having more than one command in flight.
+    if (!m_hba_capabilities.native_command_queuing_supported)
+        return 1;
+    return min(m_hba_capabilities.max_command_list_entries_count, m_command_slots.size());
+}
+
 void AHCIPort::clear_sata_error_register() const
 {
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Clearing SATA error register.", representative_port_index());
@@ -86,20 +94,14 @@ void AHCIPort::handle_interrupt()
             auto work_item_creation_result = g_io_work->try_queue([this]() {
                 m_connected_device.clear();
             });
-            if (work_item_creation_result.is_error()) {
-                auto current_request = m_current_request;
-                m_current_request.clear();
-                current_request->complete(AsyncDeviceRequest::OutOfMemory);
-            }
+            if (work_item_creation_result.is_error())
+                complete_all_requests(AsyncDeviceRequest::OutOfMemory);
         } else {
             auto work_item_creation_result = g_io_work->try_queue([this]() {
                 reset();
             });
-            if (work_item_creation_result.is_error()) {
-                auto current_request = m_current_request;
-                m_current_request.clear();
-                current_request->complete(AsyncDeviceRequest::OutOfMemory);
-            }
+            if (work_item_creation_result.is_error())
+                complete_all_requests(AsyncDeviceRequest::OutOfMemory);
         }
         return;
     }
@@ -112,61 +114,46 @@ void AHCIPort::handle_interrupt()
         auto work_item_creation_result = g_io_work->try_queue([this]() {
             reset();
         });
-        if (work_item_creation_result.is_error()) {
-            auto current_request = m_current_request;
-            m_current_request.clear();
-            current_request->complete(AsyncDeviceRequest::OutOfMemory);
-        }
+        if (work_item_creation_result.is_error())
+            complete_all_requests(AsyncDeviceRequest::OutOfMemory);
         return;
     }
     if (m_interrupt_status.is_set(AHCI::PortInterruptFlag::IF) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::TFE) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::HBD) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::HBF)) {
         auto work_item_creation_result = g_io_work->try_queue([this]() {
             recover_from_fatal_error();
         });
-        if (work_item_creation_result.is_error()) {
-            auto current_request = m_current_request;
-            m_current_request.clear();
-            current_request->complete(AsyncDeviceRequest::OutOfMemory);
-        }
+        if (work_item_creation_result.is_error())
+            complete_all_requests(AsyncDeviceRequest::OutOfMemory);
         return;
     }
-    if (m_interrupt_status.is_set(AHCI::PortInterruptFlag::DHR) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::PS)) {
-        m_wait_for_completion = false;
+    if (m_interrupt_status.is_set(AHCI::PortInterruptFlag::DHR) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::PS) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::SDB)) {
+        // Note: Clear the interrupt status before looking at which commands are still running,
+        // so a command that completes in between raises another interrupt instead of going unnoticed.
+        m_interrupt_status.clear();
+
+        u32 completed_command_slots;
+        {
+            SpinlockLocker lock(m_command_slots_lock);
+            // Note: With native command queuing, a command is only complete once the device has cleared its bit in PxSACT.
+            u32 running_command_slots = m_port_registers.ci | m_port_registers.sact;
+            completed_command_slots = m_issued_command_slots & ~running_command_slots;
+            m_issued_command_slots &= ~completed_command_slots;
+            m_completed_command_slots |= completed_command_slots;
+        }
 
         // Now schedule reading/writing the buffer as soon as we leave the irq handler.
         // This is important so that we can safely access the buffers, which could
         // trigger page faults
-        if (!m_current_request) {
+        if (!completed_command_slots) {
             dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request handled, probably identify request", representative_port_index());
         } else {
             auto work_item_creation_result = g_io_work->try_queue([this]() {
-                dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request handled", representative_port_index());
-                MutexLocker locker(m_lock);
-                VERIFY(m_current_request);
-                VERIFY(m_current_scatter_list);
-                if (!m_connected_device) {
-                    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request success", representative_port_index());
-                    complete_current_request(AsyncDeviceRequest::Failure);
-                    return;
-                }
-                if (m_current_request->request_type() == AsyncBlockDeviceRequest::Read) {
-                    if (auto result = m_current_request->write_to_buffer(m_current_request->buffer(), m_current_scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * m_current_request->block_count()); result.is_error()) {
-                        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure, memory fault occurred when reading in data.", representative_port_index());
-                        m_current_scatter_list = nullptr;
-                        complete_current_request(AsyncDeviceRequest::MemoryFault);
-                        return;
-                    }
-                }
-                m_current_scatter_list = nullptr;
-                dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request success", representative_port_index());
-                complete_current_request(AsyncDeviceRequest::Success);
+                handle_completed_command_slots();
             });
-            if (work_item_creation_result.is_error()) {
-                auto current_request = m_current_request;
-                m_current_request.clear();
-                current_request->complete(AsyncDeviceRequest::OutOfMemory);
-            }
+            if (work_item_creation_result.is_error())
+                complete_all_requests(AsyncDeviceRequest::OutOfMemory);
         }
+        return;
     }
 
     m_interrupt_status.clear();
@@ -352,7 +339,15 @@ bool AHCIPort::initialize()
             m_port_registers.cmd = m_port_registers.cmd | (1 << 24);
         }
 
-        dmesgln("AHCI Port {}: Device found, Capacity={}, Bytes per logical sector={}, Bytes per physical sector={}", representative_port_index(), max_addressable_sector * logical_sector_size, logical_sector_size, physical_sector_size);
+        // Check if the device supports native command queuing (word 76, bit 8), and how many commands it can queue.
+        m_queue_depth = 1;
+        m_uses_native_command_queuing = false;
+        if (!is_atapi_attached() && m_hba_capabilities.native_command_queuing_supported && identify_block->serial_ata_capabilities != 0xffff && (identify_block->serial_ata_capabilities & (1 << 8))) {
+            m_queue_depth = min((identify_block->queue_depth & 0x1f) + 1u, m_command_table_pages.size());
+            m_uses_native_command_queuing = m_queue_depth > 1;
+        }
+
+        dmesgln("AHCI Port {}: Device found, Capacity={}, Bytes per logical sector={}, Bytes per physical sector={}, Queue depth={}", representative_port_index(), max_addressable_sector * logical_sector_size, logical_sector_size, physical_sector_size, m_queue_depth);
 
         // FIXME: We don't support ATAPI devices yet, so for now we don't "create" them
         if (!is_atapi_attached()) {
@@ -488,25 +483,27 @@ size_t AHCIPort::calculate_descriptors_count(size_t block_count) const
 {
     VERIFY(m_connected_device);
     size_t needed_dma_regions_count = Memory::page_round_up((block_count * m_connected_device->block_size())).value() / PAGE_SIZE;
-    VERIFY(needed_dma_regions_count <= m_dma_buffers.size());
+    // Note: Every command slot has a single page for its DMA buffer.
+    VERIFY(needed_dma_regions_count <= 1);
     return needed_dma_regions_count;
 }
 
-Optional<AsyncDeviceRequest::RequestResult> AHCIPort::prepare_and_set_scatter_list(AsyncBlockDeviceRequest& request)
+Optional<AsyncDeviceRequest::RequestResult> AHCIPort::prepare_and_set_scatter_list(u8 command_slot, AsyncBlockDeviceRequest& request)
 {
     VERIFY(m_lock.is_locked());
     VERIFY(request.block_count() > 0);
 
     NonnullRefPtrVector<Memory::PhysicalPage> allocated_dma_regions;
     for (size_t index = 0; index < calculate_descriptors_count(request.block_count()); index++) {
-        allocated_dma_regions.append(m_dma_buffers.at(index));
+        allocated_dma_regions.append(m_dma_buffers.at(command_slot + index));
     }
 
-    m_current_scatter_list = Memory::ScatterGatherList::try_create(request, allocated_dma_regions.span(), m_connected_device->block_size());
-    if (!m_current_scatter_list)
+    auto& scatter_list = m_command_slots[command_slot].scatter_list;
+    scatter_list = Memory::ScatterGatherList::try_create(request, allocated_dma_regions.span(), m_connected_device->block_size());
+    if (!scatter_list)
         return AsyncDeviceRequest::Failure;
     if (request.request_type() == AsyncBlockDeviceRequest::Write) {
-        if (auto result = request.read_from_buffer(request.buffer(), m_current_scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * request.block_count()); result.is_error()) {
+        if (auto result = request.read_from_buffer(request.buffer(), scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * request.block_count()); result.is_error()) {
             return AsyncDeviceRequest::MemoryFault;
         }
     }
@@ -517,34 +514,92 @@ void AHCIPort::start_request(AsyncBlockDeviceRequest& request)
 {
     MutexLocker locker(m_lock);
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request start", representative_port_index());
-    VERIFY(!m_current_request);
-    VERIFY(!m_current_scatter_list);
 
-    m_current_request = request;
+    // Note: The device never starts more requests at once than our queue depth, so there always is a free command slot.
+    Optional<u8> free_command_slot;
+    for (size_t index = 0; index < m_queue_depth; index++) {
+        if (!m_command_slots[index].request) {
+            free_command_slot = index;
+            break;
+        }
+    }
+    VERIFY(free_command_slot.has_value());
+    auto command_slot = free_command_slot.value();
+    VERIFY(!m_command_slots[command_slot].scatter_list);
+
+    m_command_slots[command_slot].request = request;
 
-    auto result = prepare_and_set_scatter_list(request);
+    auto result = prepare_and_set_scatter_list(command_slot, request);
     if (result.has_value()) {
         dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure.", representative_port_index());
         locker.unlock();
-        complete_current_request(result.value());
+        complete_request_in_command_slot(command_slot, result.value());
         return;
     }
 
-    auto success = access_device(request.request_type(), request.block_index(), request.block_count());
+    auto success = access_device(command_slot, request.request_type(), request.block_index(), request.block_count());
     if (!success) {
         dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure.", representative_port_index());
         locker.unlock();
-        complete_current_request(AsyncDeviceRequest::Failure);
+        complete_request_in_command_slot(command_slot, AsyncDeviceRequest::Failure);
         return;
     }
 }
 
-void AHCIPort::complete_current_request(AsyncDeviceRequest::RequestResult result)
+void AHCIPort::complete_request_in_command_slot(u8 command_slot, AsyncDeviceRequest::RequestResult result)
 {
-    VERIFY(m_current_request);
-    auto current_request = m_current_request;
-    m_current_request.clear();
-    current_request->complete(result);
+    auto& slot = m_command_slots[command_slot];
+    VERIFY(slot.request);
+    auto request = slot.request;
+    slot.request.clear();
+    slot.scatter_list = nullptr;
+    request->complete(result);
+}
+
+void AHCIPort::complete_all_requests(AsyncDeviceRequest::RequestResult result)
+{
+    {
+        SpinlockLocker lock(m_command_slots_lock);
+        m_issued_command_slots = 0;
+        m_completed_command_slots = 0;
+    }
+    for (size_t command_slot = 0; command_slot < m_command_slots.size(); command_slot++) {
+        if (m_command_slots[command_slot].request)
+            complete_request_in_command_slot(command_slot, result);
+    }
+}
+
+void AHCIPort::handle_completed_command_slots()
+{
+    MutexLocker locker(m_lock);
+    u32 completed_command_slots;
+    {
+        SpinlockLocker lock(m_command_slots_lock);
+        completed_command_slots = exchange(m_completed_command_slots, 0);
+    }
+
+    for (size_t command_slot = 0; command_slot < m_command_slots.size(); command_slot++) {
+        if (!(completed_command_slots & (1u << command_slot)))
+            continue;
+        auto& slot = m_command_slots[command_slot];
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request in command slot {} handled", representative_port_index(), command_slot);
+        VERIFY(slot.request);
+        VERIFY(slot.scatter_list);
+        if (!m_connected_device) {
+            dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure, device was removed.", representative_port_index());
+            complete_request_in_command_slot(command_slot, AsyncDeviceRequest::Failure);
+            continue;
+        }
+        if (slot.request->request_type() == AsyncBlockDeviceRequest::Read) {
+            if (auto result = slot.request->write_to_buffer(slot.request->buffer(), slot.scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * slot.request->block_count()); result.is_error()) {
+                dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure, memory fault occurred when reading in data.", representative_port_index());
+                complete_request_in_command_slot(command_slot, AsyncDeviceRequest::MemoryFault);
+                continue;
+            }
+        }
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request success", representative_port_index());
+        complete_request_in_command_slot(command_slot, AsyncDeviceRequest::Success);
+    }
 }
 
 bool AHCIPort::spin_until_ready() const
@@ -563,35 +618,34 @@ bool AHCIPort::spin_until_ready() const
     return true;
 }
 
-bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64 lba, u8 block_count)
+bool AHCIPort::access_device(u8 command_slot, AsyncBlockDeviceRequest::RequestType direction, u64 lba, u8 block_count)
 {
     VERIFY(m_connected_device);
     VERIFY(is_operable());
     VERIFY(m_lock.is_locked());
-    VERIFY(m_current_scatter_list);
+    auto& scatter_list = m_command_slots[command_slot].scatter_list;
+    VERIFY(scatter_list);
     SpinlockLocker lock(m_hard_lock);
 
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {}", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count);
     if (!spin_until_ready())
         return false;
 
-    auto unused_command_header = try_to_find_unused_command_header();
-    VERIFY(unused_command_header.has_value());
     auto* command_list_entries = (volatile AHCI::CommandHeader*)m_command_list_region->vaddr().as_ptr();
-    command_list_entries[unused_command_header.value()].ctba = m_command_table_pages[unused_command_header.value()].paddr().get();
-    command_list_entries[unused_command_header.value()].ctbau = 0;
-    command_list_entries[unused_command_header.value()].prdbc = 0;
-    command_list_entries[unused_command_header.value()].prdtl = m_current_scatter_list->scatters_count();
+    command_list_entries[command_slot].ctba = m_command_table_pages[command_slot].paddr().get();
+    command_list_entries[command_slot].ctbau = 0;
+    command_list_entries[command_slot].prdbc = 0;
+    command_list_entries[command_slot].prdtl = scatter_list->scatters_count();
 
     // Note: we must set the correct Dword count in this register. Real hardware
     // AHCI controllers do care about this field! QEMU doesn't care if we don't
     // set the correct CFL field in this register, real hardware will set an
     // handshake error bit in PxSERR register if CFL is incorrect.
-    command_list_entries[unused_command_header.value()].attributes = (size_t)FIS::DwordCount::RegisterHostToDevice | AHCI::CommandHeaderAttributes::P | (is_atapi_attached() ? AHCI::CommandHeaderAttributes::A : 0) | (direction == AsyncBlockDeviceRequest::RequestType::Write ? AHCI::CommandHeaderAttributes::W : 0);
+    command_list_entries[command_slot].attributes = (size_t)FIS::DwordCount::RegisterHostToDevice | AHCI::CommandHeaderAttributes::P | (is_atapi_attached() ? AHCI::CommandHeaderAttributes::A : 0) | (direction == AsyncBlockDeviceRequest::RequestType::Write ? AHCI::CommandHeaderAttributes::W : 0);
 
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: CLE: ctba={:#08x}, ctbau={:#08x}, prdbc={:#08x}, prdtl={:#04x}, attributes={:#04x}", representative_port_index(), (u32)command_list_entries[unused_command_header.value()].ctba, (u32)command_list_entries[unused_command_header.value()].ctbau, (u32)command_list_entries[unused_command_header.value()].prdbc, (u16)command_list_entries[unused_command_header.value()].prdtl, (u16)command_list_entries[unused_command_header.value()].attributes);
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: CLE: ctba={:#08x}, ctbau={:#08x}, prdbc={:#08x}, prdtl={:#04x}, attributes={:#04x}", representative_port_index(), (u32)command_list_entries[command_slot].ctba, (u32)command_list_entries[command_slot].ctbau, (u32)command_list_entries[command_slot].prdbc, (u16)command_list_entries[command_slot].prdtl, (u16)command_list_entries[command_slot].attributes);
 
-    auto command_table_region = MM.allocate_kernel_region(m_command_table_pages[unused_command_header.value()].paddr().page_base(), Memory::page_round_up(sizeof(AHCI::CommandTable)).value(), "AHCI Command Table"sv, Memory::Region::Access::ReadWrite, Memory::Region::Cacheable::No).release_value();
+    auto command_table_region = MM.allocate_kernel_region(m_command_table_pages[command_slot].paddr().page_base(), Memory::page_round_up(sizeof(AHCI::CommandTable)).value(), "AHCI Command Table"sv, Memory::Region::Access::ReadWrite, Memory::Region::Cacheable::No).release_value();
     auto& command_table = *(volatile AHCI::CommandTable*)command_table_region->vaddr().as_ptr();
 
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Allocated command table at {}", representative_port_index(), command_table_region->vaddr());
@@ -600,7 +654,7 @@ bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64
 
     size_t scatter_entry_index = 0;
     size_t data_transfer_count = (block_count * m_connected_device->block_size());
-    for (auto scatter_page : m_current_scatter_list->vmobject().physical_pages()) {
+    for (auto scatter_page : scatter_list->vmobject().physical_pages()) {
         VERIFY(data_transfer_count != 0);
         VERIFY(scatter_page);
         dbgln_if(AHCI_DEBUG, "AHCI Port {}: Add a transfer scatter entry @ {}", representative_port_index(), scatter_page->paddr());
@@ -624,6 +678,11 @@ bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64
     if (is_atapi_attached()) {
         fis.command = ATA_CMD_PACKET;
         TODO();
+    } else if (m_uses_native_command_queuing) {
+        if (direction == AsyncBlockDeviceRequest::RequestType::Write)
+            fis.command = ATA_CMD_WRITE_FPDMA_QUEUED;
+        else
+            fis.command = ATA_CMD_READ_FPDMA_QUEUED;
     } else {
         if (direction == AsyncBlockDeviceRequest::RequestType::Write)
             fis.command = ATA_CMD_WRITE_DMA_EXT;
@@ -642,17 +701,31 @@ bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64
     fis.lba_low[0] = lba & 0xff;
     fis.lba_low[1] = (lba >> 8) & 0xff;
     fis.lba_low[2] = (lba >> 16) & 0xff;
-    fis.count = (block_count);
+    if (m_uses_native_command_queuing) {
+        // Note: Queued commands take the block count in the features field, and their tag in the count field.
+        fis.features_low = block_count;
+        fis.features_high = 0;
+        fis.count = command_slot << 3;
+    } else {
+        fis.count = (block_count);
+    }
 
     // The below loop waits until the port is no longer busy before issuing a new command
     if (!spin_until_ready())
         return false;
 
     full_memory_barrier();
-    mark_command_header_ready_to_process(unused_command_header.value());
+    {
+        SpinlockLocker slots_lock(m_command_slots_lock);
+        m_issued_command_slots |= 1u << command_slot;
+        // Note: The bit of a queued command has to be set in PxSACT before the command is issued.
+        if (m_uses_native_command_queuing)
+            m_port_registers.sact = 1u << command_slot;
+        mark_command_header_ready_to_process(command_slot);
+    }
     full_memory_barrier();
 
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {} @ {}, ended", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count, m_dma_buffers[0].paddr());
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {} @ {}, ended", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count, m_dma_buffers[command_slot].paddr());
     return true;
 }
 
@@ -782,8 +855,6 @@ void AHCIPort::mark_command_header_ready_to_process(u8 command_header_index) con
     VERIFY(m_lock.is_locked());
     VERIFY(m_hard_lock.is_locked());
     VERIFY(is_operable());
-    VERIFY(!m_wait_for_completion);
-    m_wait_for_completion = true;
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Marking command header at index {} as ready to process.", representative_port_index(), command_header_index);
     m_port_registers.ci = 1 << command_header_index;
 }
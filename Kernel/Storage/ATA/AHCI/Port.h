@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
@@ -47,6 +48,10 @@ public:
 
     LockRefPtr<StorageDevice> connected_device() const { return m_connected_device; }
 
+    // How many requests we hand to the device at once. This is one, unless both the HBA and the device
+    // support native command queuing.
+    size_t queue_depth() const { return m_queue_depth; }
+
     bool reset();
     bool initialize_without_reset();
     void handle_interrupt();
@@ -74,10 +79,13 @@ private:
     ALWAYS_INLINE void power_on() const;
 
     void start_request(AsyncBlockDeviceRequest&);
-    void complete_current_request(AsyncDeviceRequest::RequestResult);
-    bool access_device(AsyncBlockDeviceRequest::RequestType, u64 lba, u8 block_count);
+    void complete_request_in_command_slot(u8 command_slot, AsyncDeviceRequest::RequestResult);
+    void complete_all_requests(AsyncDeviceRequest::RequestResult);
+    void handle_completed_command_slots();
+    bool access_device(u8 command_slot, AsyncBlockDeviceRequest::RequestType, u64 lba, u8 block_count);
     size_t calculate_descriptors_count(size_t block_count) const;
-    [[nodiscard]] Optional<AsyncDeviceRequest::RequestResult> prepare_and_set_scatter_list(AsyncBlockDeviceRequest& request);
+    [[nodiscard]] Optional<AsyncDeviceRequest::RequestResult> prepare_and_set_scatter_list(u8 command_slot, AsyncBlockDeviceRequest& request);
+    size_t command_slots_count() const;
 
     ALWAYS_INLINE bool is_interrupts_enabled() const;
 
@@ -106,11 +114,24 @@ private:
     // Data members
 
     EntropySource m_entropy_source;
-    LockRefPtr<AsyncBlockDeviceRequest> m_current_request;
     Spinlock<LockRank::None> m_hard_lock {};
     Mutex m_lock { "AHCIPort"sv };
 
-    mutable bool m_wait_for_completion { false };
+    struct CommandSlot {
+        LockRefPtr<AsyncBlockDeviceRequest> request;
+        LockRefPtr<Memory::ScatterGatherList> scatter_list;
+    };
+    // Every command slot has its own DMA buffer and command table page, at the same index.
+    Array<CommandSlot, 32> m_command_slots;
+    size_t m_queue_depth { 1 };
+    bool m_uses_native_command_queuing { false };
+
+    // Note: This lock protects the two masks below, which are also updated by the interrupt handler.
+    Spinlock<LockRank::None> m_command_slots_lock {};
+    // The command slots that were issued to the HBA, and haven't been seen completing yet.
+    u32 m_issued_command_slots { 0 };
+    // The command slots whose command completed, but whose request wasn't completed yet.
+    u32 m_completed_command_slots { 0 };
 
     NonnullRefPtrVector<Memory::PhysicalPage> m_dma_buffers;
     NonnullRefPtrVector<Memory::PhysicalPage> m_command_table_pages;
@@ -133,7 +154,6 @@ private:
     AHCI::PortInterruptStatusBitField m_interrupt_status;
     AHCI::PortInterruptEnableBitField m_interrupt_enable;
 
-    LockRefPtr<Memory::ScatterGatherList> m_current_scatter_list;
     bool m_disabled_by_firmware { false };
 };
 }
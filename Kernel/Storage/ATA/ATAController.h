@@ -23,6 +23,9 @@ class ATAController
 public:
     virtual void start_request(ATADevice const&, AsyncBlockDeviceRequest&) = 0;
 
+    // How many requests to the device can be handled at the same time.
+    virtual size_t queue_depth(ATADevice const&) const { return 1; }
+
 protected:
     ATAController();
 };
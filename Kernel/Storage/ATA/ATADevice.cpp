@@ -26,6 +26,14 @@ ATADevice::ATADevice(ATAController const& controller, ATADevice::Address ata_add
 
 ATADevice::~ATADevice() = default;
 
+size_t ATADevice::queue_depth() const
+{
+    auto controller = m_controller.strong_ref();
+    if (!controller)
+        return 1;
+    return controller->queue_depth(*this);
+}
+
 void ATADevice::start_request(AsyncBlockDeviceRequest& request)
 {
     auto controller = m_controller.strong_ref();
@@ -29,6 +29,9 @@ public:
 public:
     virtual ~ATADevice() override;
 
+    // ^Device
+    virtual size_t queue_depth() const override;
+
     // ^BlockDevice
     virtual void start_request(AsyncBlockDeviceRequest&) override;
 
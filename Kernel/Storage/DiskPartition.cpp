@@ -33,6 +33,15 @@ Partition::DiskPartitionMetadata const& DiskPartition::metadata() const
     return m_metadata;
 }
 
+size_t DiskPartition::queue_depth() const
+{
+    // Every request is passed on to the underlying device, which does the actual queueing.
+    auto device = m_device.strong_ref();
+    if (!device)
+        return 1;
+    return device->queue_depth();
+}
+
 void DiskPartition::start_request(AsyncBlockDeviceRequest& request)
 {
     auto device = m_device.strong_ref();
@@ -22,6 +22,9 @@ public:
 
     virtual void start_request(AsyncBlockDeviceRequest&) override;
 
+    // ^Device
+    virtual size_t queue_depth() const override;
+
     // ^BlockDevice
     virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override;
     virtual bool can_read(OpenFileDescription const&, u64) const override;
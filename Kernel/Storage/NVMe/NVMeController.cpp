@@ -34,8 +34,6 @@ UNMAP_AFTER_INIT NVMeController::NVMeController(const PCI::DeviceIdentifier& dev
 
 UNMAP_AFTER_INIT ErrorOr<void> NVMeController::initialize(bool is_queue_polled)
 {
-    // Nr of queues = one queue per core
-    auto nr_of_queues = Processor::count();
     auto irq = is_queue_polled ? Optional<u8> {} : device_identifier().interrupt_line().value();
 
     PCI::enable_memory_space(device_identifier());
@@ -58,7 +56,10 @@ UNMAP_AFTER_INIT ErrorOr<void> NVMeController::initialize(bool is_queue_polled)
     VERIFY(IO_QUEUE_SIZE < MQES(caps));
     dbgln_if(NVME_DEBUG, "NVMe: IO queue depth is: {}", IO_QUEUE_SIZE);
 
-    // Create an IO queue per core
+    // Create an IO queue per core, or as many as the controller is willing to give us.
+    // The namespaces spread the processors over the queues we got.
+    auto nr_of_queues = TRY(request_io_queue_count(Processor::count()));
+    dbgln_if(NVME_DEBUG, "NVMe: Using {} IO queues for {} processors", nr_of_queues, Processor::count());
     for (u32 cpuid = 0; cpuid < nr_of_queues; ++cpuid) {
         // qid is zero is used for admin queue
         TRY(create_io_queue(cpuid + 1, irq));
@@ -212,6 +213,24 @@ UNMAP_AFTER_INIT ErrorOr<void> NVMeController::identify_and_init_namespaces()
     return {};
 }
 
+UNMAP_AFTER_INIT ErrorOr<u32> NVMeController::request_io_queue_count(u32 count)
+{
+    VERIFY(count > 0);
+    NVMeSubmission sub {};
+    u32 allocated_queues = 0;
+    sub.op = OP_ADMIN_SET_FEATURES;
+    sub.generic.cdw10 = AK::convert_between_host_and_little_endian((u32)NVMe_FEATURE_NUMBER_OF_QUEUES);
+    // Both counts are 0 based
+    sub.generic.cdw11 = AK::convert_between_host_and_little_endian(((count - 1) << 16) | (count - 1));
+    auto status = m_admin_queue->submit_sync_sqe(sub, &allocated_queues);
+    if (status) {
+        dmesgln_pci(*this, "Failed to set the number of IO queues");
+        return EFAULT;
+    }
+    // The controller may give us more queues than we asked for, but never fewer than one pair.
+    return min(count, (u32)min(NVMe_NUMBER_OF_SUBMISSION_QUEUES(allocated_queues), NVMe_NUMBER_OF_COMPLETION_QUEUES(allocated_queues)));
+}
+
 UNMAP_AFTER_INIT Tuple<u64, u8> NVMeController::get_ns_features(IdentifyNamespace& identify_data_struct)
 {
     auto flbas = identify_data_struct.flbas & FLBA_SIZE_MASK;
@@ -62,6 +62,7 @@ private:
     Tuple<u64, u8> get_ns_features(IdentifyNamespace& identify_data_struct);
     ErrorOr<void> create_admin_queue(Optional<u8> irq);
     ErrorOr<void> create_io_queue(u8 qid, Optional<u8> irq);
+    ErrorOr<u32> request_io_queue_count(u32 count);
     void calculate_doorbell_stride()
     {
         m_dbl_stride = (m_controller_regs->cap >> CAP_DBL_SHIFT) & CAP_DBL_MASK;
@@ -98,6 +98,20 @@ static constexpr u16 CQ_STATUS_FIELD(u16 x)
 }
 
 static constexpr u16 IO_QUEUE_SIZE = 64; // TODO:Need to be configurable
+// A request is split into page sized commands, which are all submitted with a single doorbell write.
+static constexpr u16 IO_QUEUE_MAX_TRANSFER_PAGES = 8;
+static_assert(IO_QUEUE_MAX_TRANSFER_PAGES < IO_QUEUE_SIZE);
+
+// SET FEATURES
+static constexpr u8 NVMe_FEATURE_NUMBER_OF_QUEUES = 0x7;
+static constexpr u16 NVMe_NUMBER_OF_SUBMISSION_QUEUES(u32 x)
+{
+    return (x & 0xffff) + 1;
+}
+static constexpr u16 NVMe_NUMBER_OF_COMPLETION_QUEUES(u32 x)
+{
+    return ((x >> 16) & 0xffff) + 1;
+}
 
 // IDENTIFY
 static constexpr u16 NVMe_IDENTIFY_SIZE = 4096;
@@ -114,6 +128,7 @@ enum AdminCommandOpCode {
     OP_ADMIN_CREATE_COMPLETION_QUEUE = 0x5,
     OP_ADMIN_CREATE_SUBMISSION_QUEUE = 0x1,
     OP_ADMIN_IDENTIFY = 0x6,
+    OP_ADMIN_SET_FEATURES = 0x9,
 };
 
 // IO opcodes
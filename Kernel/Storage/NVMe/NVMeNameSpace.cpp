@@ -25,13 +25,19 @@ UNMAP_AFTER_INIT NVMeNameSpace::NVMeNameSpace(LUNAddress logical_unit_number_add
 {
 }
 
+u32 NVMeNameSpace::max_blocks_per_request() const
+{
+    return IO_QUEUE_MAX_TRANSFER_PAGES * (PAGE_SIZE / block_size());
+}
+
 void NVMeNameSpace::start_request(AsyncBlockDeviceRequest& request)
 {
-    auto index = Processor::current_id();
+    // Submit on the queue of the current processor, so concurrent submitters don't contend on the same submission queue lock.
+    auto index = Processor::current_id() % m_queues.size();
     auto& queue = m_queues.at(index);
-    // TODO: For now we support only IO transfers of size PAGE_SIZE (Going along with the current constraint in the block layer)
-    // Eventually remove this constraint by using the PRP2 field in the submission struct and remove block layer constraint for NVMe driver.
-    VERIFY(request.block_count() <= (PAGE_SIZE / block_size()));
+    // NOTE: Each command only transfers a single page (we don't use the PRP2 field yet), so bigger requests are split
+    //       into several commands by the queue and submitted in one go.
+    VERIFY(request.block_count() <= max_blocks_per_request());
 
     if (request.request_type() == AsyncBlockDeviceRequest::Read) {
         queue.read(request, m_nsid, request.block_index(), request.block_count());
@@ -14,18 +14,20 @@
 namespace Kernel {
 ErrorOr<NonnullLockRefPtr<NVMeQueue>> NVMeQueue::try_create(u16 qid, Optional<u8> irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs)
 {
-    // Note: Allocate DMA region for RW operation. For now the requests don't exceed more than 4096 bytes (Storage device takes care of it)
-    RefPtr<Memory::PhysicalPage> rw_dma_page;
-    auto rw_dma_region = TRY(MM.allocate_dma_buffer_page("NVMe Queue Read/Write DMA"sv, Memory::Region::Access::ReadWrite, rw_dma_page));
+    // Note: Allocate DMA region for RW operation. Requests are limited to IO_QUEUE_MAX_TRANSFER_PAGES (NVMeNameSpace takes care of it),
+    //       and each page sized command transfers into its own page of the region. The queue holds on to all of the pages,
+    //       as the region only maps them and doesn't keep them allocated.
+    NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages;
+    auto rw_dma_region = TRY(MM.allocate_dma_buffer_pages(IO_QUEUE_MAX_TRANSFER_PAGES * PAGE_SIZE, "NVMe Queue Read/Write DMA"sv, Memory::Region::Access::ReadWrite, rw_dma_pages));
     if (!irq.has_value()) {
-        auto queue = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) NVMePollQueue(move(rw_dma_region), *rw_dma_page, qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
+        auto queue = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) NVMePollQueue(move(rw_dma_region), move(rw_dma_pages), qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
         return queue;
     }
-    auto queue = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) NVMeInterruptQueue(move(rw_dma_region), *rw_dma_page, qid, irq.value(), q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
+    auto queue = TRY(adopt_nonnull_lock_ref_or_enomem(new (nothrow) NVMeInterruptQueue(move(rw_dma_region), move(rw_dma_pages), qid, irq.value(), q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
     return queue;
 }
 
-UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalPage const& rw_dma_page, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs)
+UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs)
     : m_current_request(nullptr)
     , m_rw_dma_region(move(rw_dma_region))
     , m_qid(qid)
@@ -36,7 +38,7 @@ UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_regio
     , m_sq_dma_region(move(sq_dma_region))
     , m_sq_dma_page(sq_dma_page)
     , m_db_regs(move(db_regs))
-    , m_rw_dma_page(rw_dma_page)
+    , m_rw_dma_pages(move(rw_dma_pages))
 
 {
     m_sqe_array = { reinterpret_cast<NVMeSubmission*>(m_sq_dma_region->vaddr().as_ptr()), m_qdepth };
@@ -75,10 +77,15 @@ u32 NVMeQueue::process_cq()
         if (m_admin_queue == false) {
             // As the block layer calls are now sync (as we wait on each requests),
             // everything is operated on a single request similar to BMIDE driver.
+            // A request may be split into several commands though, so only complete
+            // it once the last one of them came back.
             // TODO: Remove this constraint eventually.
-            VERIFY(cmdid == m_prev_sq_tail);
             if (m_current_request) {
-                complete_current_request(status);
+                VERIFY(m_pending_io_commands > 0);
+                if (status)
+                    m_io_status = status;
+                if (--m_pending_io_commands == 0)
+                    complete_current_request(m_io_status);
             }
         }
         update_cqe_head();
@@ -89,36 +96,38 @@ u32 NVMeQueue::process_cq()
     return nr_of_processed_cqes;
 }
 
-void NVMeQueue::submit_sqe(NVMeSubmission& sub)
+void NVMeQueue::submit_sqes(Span<NVMeSubmission> submissions)
 {
     SpinlockLocker lock(m_sq_lock);
-    // For now let's use sq tail as a unique command id.
-    sub.cmdid = m_sq_tail;
-    m_prev_sq_tail = m_sq_tail;
-
-    memcpy(&m_sqe_array[m_sq_tail], &sub, sizeof(NVMeSubmission));
-    {
-        u32 temp_sq_tail = m_sq_tail + 1;
-        if (temp_sq_tail == m_qdepth)
-            m_sq_tail = 0;
-        else
-            m_sq_tail = temp_sq_tail;
+    for (auto& sub : submissions) {
+        // For now let's use sq tail as a unique command id.
+        sub.cmdid = m_sq_tail;
+
+        memcpy(&m_sqe_array[m_sq_tail], &sub, sizeof(NVMeSubmission));
+        {
+            u32 temp_sq_tail = m_sq_tail + 1;
+            if (temp_sq_tail == m_qdepth)
+                m_sq_tail = 0;
+            else
+                m_sq_tail = temp_sq_tail;
+        }
+
+        dbgln_if(NVME_DEBUG, "NVMe: Submission with command identifier {}. SQ_TAIL: {}", sub.cmdid, m_sq_tail);
     }
 
-    dbgln_if(NVME_DEBUG, "NVMe: Submission with command identifier {}. SQ_TAIL: {}", sub.cmdid, m_sq_tail);
     full_memory_barrier();
     update_sq_doorbell();
 }
 
-u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub)
+u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub, u32* command_specific_result)
 {
     // For now let's use sq tail as a unique command id.
     u16 cqe_cid;
     u16 cid = m_sq_tail;
+    int index;
 
     submit_sqe(sub);
     do {
-        int index;
         {
             SpinlockLocker lock(m_cq_lock);
             index = m_cq_head - 1;
@@ -129,30 +138,52 @@ u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub)
         microseconds_delay(1);
     } while (cid != cqe_cid);
 
+    if (command_specific_result)
+        *command_specific_result = m_cqe_array[index].cmd_spec;
+
     auto status = CQ_STATUS_FIELD(m_cqe_array[m_cq_head].status);
     return status;
 }
 
+void NVMeQueue::submit_rw(IOCommandOpcode op, u16 nsid, u64 index, u32 count)
+{
+    VERIFY(m_request_lock.is_locked());
+    VERIFY(m_current_request);
+
+    u32 blocks_per_page = PAGE_SIZE / m_current_request->block_size();
+    u32 submission_count = ceil_div(count, blocks_per_page);
+    VERIFY(submission_count > 0 && submission_count <= IO_QUEUE_MAX_TRANSFER_PAGES);
+
+    Array<NVMeSubmission, IO_QUEUE_MAX_TRANSFER_PAGES> submissions {};
+    for (u32 i = 0; i < submission_count; ++i) {
+        auto& sub = submissions[i];
+        auto first_block = i * blocks_per_page;
+        auto block_count = min(blocks_per_page, count - first_block);
+        sub.op = op;
+        sub.rw.nsid = nsid;
+        sub.rw.slba = AK::convert_between_host_and_little_endian(index + first_block);
+        // No. of lbas is 0 based
+        sub.rw.length = AK::convert_between_host_and_little_endian((block_count - 1) & 0xFFFF);
+        sub.rw.data_ptr.prp1 = reinterpret_cast<u64>(AK::convert_between_host_and_little_endian(m_rw_dma_pages[i].paddr().as_ptr()));
+    }
+
+    m_pending_io_commands = submission_count;
+    m_io_status = 0;
+
+    full_memory_barrier();
+    submit_sqes(submissions.span().trim(submission_count));
+}
+
 void NVMeQueue::read(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count)
 {
-    NVMeSubmission sub {};
     SpinlockLocker m_lock(m_request_lock);
     m_current_request = request;
 
-    sub.op = OP_NVME_READ;
-    sub.rw.nsid = nsid;
-    sub.rw.slba = AK::convert_between_host_and_little_endian(index);
-    // No. of lbas is 0 based
-    sub.rw.length = AK::convert_between_host_and_little_endian((count - 1) & 0xFFFF);
-    sub.rw.data_ptr.prp1 = reinterpret_cast<u64>(AK::convert_between_host_and_little_endian(m_rw_dma_page->paddr().as_ptr()));
-
-    full_memory_barrier();
-    submit_sqe(sub);
+    submit_rw(OP_NVME_READ, nsid, index, count);
 }
 
 void NVMeQueue::write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count)
 {
-    NVMeSubmission sub {};
     SpinlockLocker m_lock(m_request_lock);
     m_current_request = request;
 
@@ -160,15 +191,8 @@ void NVMeQueue::write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32
         complete_current_request(AsyncDeviceRequest::MemoryFault);
         return;
     }
-    sub.op = OP_NVME_WRITE;
-    sub.rw.nsid = nsid;
-    sub.rw.slba = AK::convert_between_host_and_little_endian(index);
-    // No. of lbas is 0 based
-    sub.rw.length = AK::convert_between_host_and_little_endian((count - 1) & 0xFFFF);
-    sub.rw.data_ptr.prp1 = reinterpret_cast<u64>(AK::convert_between_host_and_little_endian(m_rw_dma_page->paddr().as_ptr()));
 
-    full_memory_barrier();
-    submit_sqe(sub);
+    submit_rw(OP_NVME_WRITE, nsid, index, count);
 }
 
 UNMAP_AFTER_INIT NVMeQueue::~NVMeQueue() = default;
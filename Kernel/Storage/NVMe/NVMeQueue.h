@@ -32,10 +32,12 @@ class NVMeQueue : public AtomicRefCounted<NVMeQueue> {
 public:
     static ErrorOr<NonnullLockRefPtr<NVMeQueue>> try_create(u16 qid, Optional<u8> irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs);
     bool is_admin_queue() { return m_admin_queue; };
-    u16 submit_sync_sqe(NVMeSubmission&);
+    u16 submit_sync_sqe(NVMeSubmission&, u32* command_specific_result = nullptr);
     void read(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
     void write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
-    virtual void submit_sqe(NVMeSubmission&);
+    void submit_sqe(NVMeSubmission& submission) { submit_sqes({ &submission, 1 }); }
+    // Queues all submissions and then rings the doorbell once.
+    virtual void submit_sqes(Span<NVMeSubmission>);
     virtual ~NVMeQueue();
 
 protected:
@@ -44,11 +46,12 @@ protected:
     {
         m_db_regs->sq_tail = m_sq_tail;
     }
-    NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalPage const& rw_dma_page, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs);
+    NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<DoorbellRegister volatile> db_regs);
 
 private:
     bool cqe_available();
     void update_cqe_head();
+    void submit_rw(IOCommandOpcode, u16 nsid, u64 index, u32 count);
     virtual void complete_current_request(u16 status) = 0;
     void update_cq_doorbell()
     {
@@ -65,7 +68,8 @@ private:
     u16 m_qid {};
     u8 m_cq_valid_phase { 1 };
     u16 m_sq_tail {};
-    u16 m_prev_sq_tail {};
+    u16 m_pending_io_commands {};
+    u16 m_io_status {};
     u16 m_cq_head {};
     bool m_admin_queue { false };
     u32 m_qdepth {};
@@ -77,6 +81,6 @@ private:
     NonnullRefPtrVector<Memory::PhysicalPage> m_sq_dma_page;
     Span<NVMeCompletion> m_cqe_array;
     Memory::TypedMapping<DoorbellRegister volatile> m_db_regs;
-    NonnullRefPtr<Memory::PhysicalPage> m_rw_dma_page;
+    NonnullRefPtrVector<Memory::PhysicalPage> m_rw_dma_pages;
 };
 }
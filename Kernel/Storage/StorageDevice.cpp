@@ -90,8 +90,9 @@ ErrorOr<size_t> StorageDevice::read(OpenFileDescription&, u64 offset, UserOrKern
 
     // PATAChannel will chuck a wobbly if we try to read more than PAGE_SIZE
     // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= m_blocks_per_page) {
-        whole_blocks = m_blocks_per_page;
+    // Other devices may allow bigger requests, see max_blocks_per_request().
+    if (whole_blocks >= max_blocks_per_request()) {
+        whole_blocks = max_blocks_per_request();
         remaining = 0;
     }
 
@@ -156,8 +157,9 @@ ErrorOr<size_t> StorageDevice::write(OpenFileDescription&, u64 offset, UserOrKer
 
     // PATAChannel will chuck a wobbly if we try to write more than PAGE_SIZE
     // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= m_blocks_per_page) {
-        whole_blocks = m_blocks_per_page;
+    // Other devices may allow bigger requests, see max_blocks_per_request().
+    if (whole_blocks >= max_blocks_per_request()) {
+        whole_blocks = max_blocks_per_request();
         remaining = 0;
     }
 
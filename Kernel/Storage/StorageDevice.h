@@ -54,6 +54,8 @@ public:
 
 public:
     virtual u64 max_addressable_block() const { return m_max_addressable_block; }
+    // The maximum number of blocks a single AsyncBlockDeviceRequest may transfer.
+    virtual u32 max_blocks_per_request() const { return m_blocks_per_page; }
 
     // ^BlockDevice
     virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override;
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+static constexpr size_t max_events_per_wait = 1024;
+
+ErrorOr<FlatPtr> Process::sys$epoll_create(int flags)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    auto epoll = TRY(EPoll::try_create());
+    auto description = TRY(OpenFileDescription::try_create(move(epoll)));
+
+    description->set_readable(true);
+
+    u32 fd_flags = 0;
+    if (flags & EPOLL_CLOEXEC)
+        fd_flags |= FD_CLOEXEC;
+
+    return m_fds.with_exclusive([&](auto& fds) -> ErrorOr<FlatPtr> {
+        auto new_fd = TRY(fds.allocate());
+        fds[new_fd.fd].set(move(description), fd_flags);
+        return new_fd.fd;
+    });
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_ctl(int epfd, int op, int fd, Userspace<epoll_event*> user_event)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    auto epoll_description = TRY(open_file_description(epfd));
+    auto* epoll = epoll_description->epoll();
+    if (!epoll)
+        return EINVAL;
+
+    auto description = TRY(open_file_description(fd));
+    if (description.ptr() == epoll_description.ptr())
+        return EINVAL;
+
+    switch (op) {
+    case EPOLL_CTL_ADD: {
+        auto event = TRY(copy_typed_from_user(user_event));
+        TRY(epoll->add_interest(fd, *description, event));
+        return 0;
+    }
+    case EPOLL_CTL_MOD: {
+        auto event = TRY(copy_typed_from_user(user_event));
+        TRY(epoll->modify_interest(fd, *description, event));
+        return 0;
+    }
+    case EPOLL_CTL_DEL:
+        TRY(epoll->remove_interest(fd, *description));
+        return 0;
+    }
+    return EINVAL;
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_wait(int epfd, Userspace<epoll_event*> user_events, int max_events, int timeout_ms)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    if (max_events <= 0)
+        return EINVAL;
+
+    auto description = TRY(open_file_description(epfd));
+    auto* epoll = description->epoll();
+    if (!epoll)
+        return EINVAL;
+
+    Vector<epoll_event> events;
+    auto events_to_collect = min(static_cast<size_t>(max_events), max_events_per_wait);
+    TRY(events.try_ensure_capacity(events_to_collect));
+
+    // NOTE: A negative timeout waits forever. The deadline is computed once, so spurious wakeups don't extend it.
+    Thread::BlockTimeout timeout;
+    if (timeout_ms >= 0) {
+        auto timeout_time = Time::from_milliseconds(timeout_ms);
+        timeout = Thread::BlockTimeout(false, &timeout_time);
+    }
+
+    for (;;) {
+        TRY(epoll->collect_ready_events(events, events_to_collect));
+        if (!events.is_empty() || timeout_ms == 0)
+            break;
+
+        auto unblock_flags = Thread::FileBlocker::BlockFlags::None;
+        auto result = Thread::current()->block<Thread::ReadBlocker>(timeout, *description, unblock_flags);
+        if (result == Thread::BlockResult::InterruptedByTimeout) {
+            TRY(epoll->collect_ready_events(events, events_to_collect));
+            break;
+        }
+        if (result.was_interrupted())
+            return EINTR;
+    }
+
+    if (!events.is_empty())
+        TRY(try_copy_n_to_user(user_events, events.data(), events.size()));
+    return events.size();
+}
+
+}
@@ -138,7 +138,10 @@ ErrorOr<FlatPtr> Process::sys$fork(RegisterState& regs)
             for (auto& region : parent_space->region_tree().regions()) {
                 dbgln_if(FORK_DEBUG, "fork: cloning Region '{}' @ {}", region.name(), region.vaddr());
                 auto region_clone = TRY(region.try_clone());
-                TRY(region_clone->map(child_space->page_directory(), Memory::ShouldFlushTLB::No));
+                // NOTE: The child starts out without any page table entries for the region, they are filled in by
+                //       page faults as it touches the pages it shares with us. This keeps fork() cheap for large
+                //       processes, especially when the child goes on to exec() right away.
+                region_clone->set_page_directory(child_space->page_directory());
                 TRY(child_space->region_tree().place_specifically(*region_clone, region.range()));
                 auto* child_region = region_clone.leak_ptr();
 
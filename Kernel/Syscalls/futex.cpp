@@ -106,12 +106,12 @@ ErrorOr<FlatPtr> Process::sys$futex(Userspace<Syscall::SC_futex_params const*> u
     switch (cmd) {
     case FUTEX_WAIT:
     case FUTEX_WAIT_BITSET:
-    case FUTEX_REQUEUE:
-    case FUTEX_CMP_REQUEUE: {
+    case FUTEX_LOCK_PI: {
         if (params.timeout) {
             auto timeout_time = TRY(copy_time_from_user(params.timeout));
             bool is_absolute = cmd != FUTEX_WAIT;
-            clockid_t clock_id = use_realtime_clock ? CLOCK_REALTIME_COARSE : CLOCK_MONOTONIC_COARSE;
+            // NOTE: Like on Linux, the timeout of FUTEX_LOCK_PI is always measured against the realtime clock.
+            clockid_t clock_id = (use_realtime_clock || cmd == FUTEX_LOCK_PI) ? CLOCK_REALTIME_COARSE : CLOCK_MONOTONIC_COARSE;
             timeout = Thread::BlockTimeout(is_absolute, &timeout_time, nullptr, clock_id);
         }
         if (cmd == FUTEX_WAIT_BITSET && params.val3 == FUTEX_BITSET_MATCH_ANY)
@@ -238,6 +238,100 @@ ErrorOr<FlatPtr> Process::sys$futex(Userspace<Syscall::SC_futex_params const*> u
         return woken_or_requeued;
     };
 
+    auto do_lock_pi = [&](bool should_block) -> ErrorOr<FlatPtr> {
+        auto* current_thread = Thread::current();
+        u32 tid = current_thread->tid().value();
+        auto futex_key = TRY(get_futex_key(user_address, shared));
+        for (;;) {
+            auto user_value = user_atomic_load_relaxed(params.userspace_address);
+            if (!user_value.has_value())
+                return EFAULT;
+            u32 value = user_value.value();
+            u32 owner_tid = value & FUTEX_TID_MASK;
+
+            if (owner_tid == 0) {
+                // NOTE: FUTEX_WAITERS has to stay, everyone still waiting relies on the next unlock to come through us.
+                auto exchanged = user_atomic_compare_exchange_relaxed(params.userspace_address, value, tid | (value & FUTEX_WAITERS));
+                if (!exchanged.has_value())
+                    return EFAULT;
+                if (!exchanged.value())
+                    continue;
+                atomic_thread_fence(AK::MemoryOrder::memory_order_acquire);
+                return 0;
+            }
+            if (owner_tid == tid)
+                return EDEADLK;
+            if (!should_block)
+                return EAGAIN;
+
+            // Make sure the owner can't unlock without letting us know.
+            if (!(value & FUTEX_WAITERS)) {
+                auto exchanged = user_atomic_compare_exchange_relaxed(params.userspace_address, value, value | FUTEX_WAITERS);
+                if (!exchanged.has_value())
+                    return EFAULT;
+                if (!exchanged.value())
+                    continue;
+            }
+
+            bool did_create;
+            LockRefPtr<FutexQueue> futex_queue;
+            do {
+                did_create = false;
+                futex_queue = TRY(find_futex_queue(futex_key, true, &did_create));
+                VERIFY(futex_queue);
+            } while (!did_create && !futex_queue->queue_imminent_wait());
+
+            if (auto owner = Thread::from_tid(owner_tid))
+                futex_queue->inherit_priority(*owner, current_thread->priority());
+
+            Thread::BlockResult block_result = futex_queue->wait_on(timeout, 0);
+
+            if (futex_queue->is_empty_and_no_imminent_waits())
+                remove_futex_queue(futex_key);
+            if (block_result == Thread::BlockResult::InterruptedByTimeout)
+                return ETIMEDOUT;
+            if (block_result.was_interrupted())
+                return EINTR;
+            // We were woken up by an unlock, but someone else may still beat us to the futex.
+        }
+    };
+
+    auto do_unlock_pi = [&]() -> ErrorOr<FlatPtr> {
+        auto* current_thread = Thread::current();
+        u32 tid = current_thread->tid().value();
+        auto user_value = user_atomic_load_relaxed(params.userspace_address);
+        if (!user_value.has_value())
+            return EFAULT;
+        if ((user_value.value() & FUTEX_TID_MASK) != tid)
+            return EPERM;
+
+        auto futex_key = TRY(get_futex_key(user_address, shared));
+        auto futex_queue = TRY(find_futex_queue(futex_key, false));
+        bool is_empty = true;
+        if (futex_queue) {
+            futex_queue->restore_inherited_priority(*current_thread);
+            futex_queue->wake_n(1, {}, is_empty);
+        }
+
+        // Whoever we didn't wake still needs the next unlock to come through us.
+        atomic_thread_fence(AK::MemoryOrder::memory_order_release);
+        auto value = user_value.value();
+        for (;;) {
+            auto exchanged = user_atomic_compare_exchange_relaxed(params.userspace_address, value, is_empty ? 0 : FUTEX_WAITERS);
+            if (!exchanged.has_value())
+                return EFAULT;
+            if (exchanged.value())
+                break;
+            if ((value & FUTEX_TID_MASK) != tid)
+                return EPERM;
+            // NOTE: Someone in another process started waiting on a shared futex in the meantime.
+            is_empty = is_empty && !(value & FUTEX_WAITERS);
+        }
+        if (is_empty && futex_queue)
+            remove_futex_queue(futex_key);
+        return 0;
+    };
+
     switch (cmd) {
     case FUTEX_WAIT:
         return do_wait(0);
@@ -251,7 +345,7 @@ ErrorOr<FlatPtr> Process::sys$futex(Userspace<Syscall::SC_futex_params const*> u
         auto op = _FUTEX_OP(params.val3);
         if (op & FUTEX_OP_ARG_SHIFT) {
             op_arg = 1 << op_arg;
-            op &= FUTEX_OP_ARG_SHIFT;
+            op &= ~FUTEX_OP_ARG_SHIFT;
         }
         atomic_thread_fence(AK::MemoryOrder::memory_order_release);
         switch (op) {
@@ -313,6 +407,15 @@ ErrorOr<FlatPtr> Process::sys$futex(Userspace<Syscall::SC_futex_params const*> u
     case FUTEX_CMP_REQUEUE:
         return do_requeue(params.val3);
 
+    case FUTEX_LOCK_PI:
+        return do_lock_pi(true);
+
+    case FUTEX_TRYLOCK_PI:
+        return do_lock_pi(false);
+
+    case FUTEX_UNLOCK_PI:
+        return do_unlock_pi();
+
     case FUTEX_WAIT_BITSET:
         VERIFY(params.val3 != FUTEX_BITSET_MATCH_ANY); // we should have turned it into FUTEX_WAIT
         if (params.val3 == 0)
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/API/IORing.h>
+#include <Kernel/FileSystem/IORing.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+ErrorOr<FlatPtr> Process::sys$io_ring_create(u32 entries, int options)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    auto io_ring = TRY(IORing::try_create(entries));
+    auto description = TRY(OpenFileDescription::try_create(move(io_ring)));
+
+    description->set_readable(true);
+    description->set_writable(true);
+
+    u32 fd_flags = 0;
+    if (options & O_CLOEXEC)
+        fd_flags |= FD_CLOEXEC;
+
+    return m_fds.with_exclusive([&](auto& fds) -> ErrorOr<FlatPtr> {
+        auto new_fd = TRY(fds.allocate());
+        fds[new_fd.fd].set(move(description), fd_flags);
+        return new_fd.fd;
+    });
+}
+
+ErrorOr<FlatPtr> Process::execute_io_ring_submission(IORingSubmission const& submission)
+{
+    Userspace<u8*> buffer(static_cast<FlatPtr>(submission.address));
+
+    // NOTE: These are the same code paths as the corresponding syscalls, so they need the big lock if those do.
+    switch (submission.opcode) {
+    case IORingOpcode::Nop:
+        return 0;
+    case IORingOpcode::Read: {
+        MutexLocker locker(big_lock());
+        if (submission.offset < 0)
+            return read_impl(submission.fd, buffer, submission.length);
+        return pread_impl(submission.fd, buffer, submission.length, submission.offset);
+    }
+    case IORingOpcode::Write: {
+        MutexLocker locker(big_lock());
+        Userspace<u8 const*> data(static_cast<FlatPtr>(submission.address));
+        if (submission.offset < 0)
+            return sys$write(submission.fd, data, submission.length);
+        return pwrite_impl(submission.fd, data, submission.length, submission.offset);
+    }
+    case IORingOpcode::Accept: {
+        Userspace<sockaddr*> user_address(static_cast<FlatPtr>(submission.address));
+        Userspace<socklen_t*> user_address_size(static_cast<FlatPtr>(submission.offset));
+        return accept_impl(submission.fd, user_address, user_address_size, submission.flags);
+    }
+    case IORingOpcode::SendMessage: {
+        MutexLocker locker(big_lock());
+        Userspace<const struct msghdr*> user_message(static_cast<FlatPtr>(submission.address));
+        return sys$sendmsg(submission.fd, user_message, submission.flags);
+    }
+    case IORingOpcode::ReceiveMessage: {
+        MutexLocker locker(big_lock());
+        Userspace<struct msghdr*> user_message(static_cast<FlatPtr>(submission.address));
+        return sys$recvmsg(submission.fd, user_message, submission.flags);
+    }
+    }
+    return EINVAL;
+}
+
+// Executes up to `to_submit` queued submissions and posts their completions.
+// Submissions are only consumed while there is room for their completion, so none are ever dropped,
+// and the return value tells userspace how many were consumed.
+// NOTE: Operations on blocking descriptors block the calling thread just like the corresponding syscall would,
+//       userspace should use non-blocking descriptors to keep a batch from stalling behind a single operation.
+ErrorOr<FlatPtr> Process::sys$io_ring_enter(int fd, u32 to_submit)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+
+    auto description = TRY(open_file_description(fd));
+    auto* io_ring = description->io_ring();
+    if (!io_ring)
+        return EBADF;
+
+    MutexLocker locker(io_ring->submission_lock());
+    u32 submitted = 0;
+    while (submitted < to_submit && io_ring->has_completion_space()) {
+        auto submission = io_ring->peek_submission();
+        if (!submission.has_value())
+            break;
+        io_ring->consume_submission();
+        ++submitted;
+
+        auto result = execute_io_ring_submission(submission.value());
+        io_ring->post_completion(submission->user_data, result.is_error() ? -static_cast<i64>(result.error().code()) : static_cast<i64>(result.value()));
+
+        if (Thread::current()->should_die())
+            break;
+    }
+    return submitted;
+}
+
+}
@@ -16,6 +16,7 @@
 #include <Kernel/Memory/MemoryManager.h>
 #include <Kernel/Memory/PrivateInodeVMObject.h>
 #include <Kernel/Memory/Region.h>
+#include <Kernel/Memory/ScopedTLBFlushBatch.h>
 #include <Kernel/Memory/SharedInodeVMObject.h>
 #include <Kernel/PerformanceEventBuffer.h>
 #include <Kernel/PerformanceManager.h>
@@ -231,6 +232,8 @@ ErrorOr<FlatPtr> Process::sys$mmap(Userspace<Syscall::SC_mmap_params const*> use
     }
 
     return address_space().with([&](auto& space) -> ErrorOr<FlatPtr> {
+        Memory::ScopedTLBFlushBatch flush_batch(space->page_directory());
+
         // If MAP_FIXED is specified, existing mappings that intersect the requested range are removed.
         if (map_fixed)
             TRY(space->unmap_mmap_range(VirtualAddress(addr), size));
@@ -284,6 +287,7 @@ ErrorOr<FlatPtr> Process::sys$mprotect(Userspace<void*> addr, size_t size, int p
         return EFAULT;
 
     return address_space().with([&](auto& space) -> ErrorOr<FlatPtr> {
+        Memory::ScopedTLBFlushBatch flush_batch(space->page_directory());
         if (auto* whole_region = space->find_region_from_range(range_to_mprotect)) {
             if (!whole_region->is_mmap())
                 return EPERM;
@@ -474,6 +478,7 @@ ErrorOr<FlatPtr> Process::sys$munmap(Userspace<void*> addr, size_t size)
     VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
     TRY(require_promise(Pledge::stdio));
     TRY(address_space().with([&](auto& space) {
+        Memory::ScopedTLBFlushBatch flush_batch(space->page_directory());
         return space->unmap_mmap_range(addr.vaddr(), size);
     }));
     return 0;
@@ -488,6 +493,7 @@ ErrorOr<FlatPtr> Process::sys$mremap(Userspace<Syscall::SC_mremap_params const*>
     auto old_range = TRY(Memory::expand_range_to_page_boundaries((FlatPtr)params.old_address, params.old_size));
 
     return address_space().with([&](auto& space) -> ErrorOr<FlatPtr> {
+        Memory::ScopedTLBFlushBatch flush_batch(space->page_directory());
         auto* old_region = space->find_region_from_range(old_range);
         if (!old_region)
             return EINVAL;
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <Kernel/Arch/PerformanceCounters.h>
 #include <Kernel/Coredump.h>
 #include <Kernel/PerformanceManager.h>
 #include <Kernel/Process.h>
@@ -51,6 +52,10 @@ ErrorOr<FlatPtr> Process::profiling_enable(pid_t pid, u64 event_mask)
         SpinlockLocker lock(g_profiling_lock);
         if (!TimeManagement::the().enable_profile_timer())
             return ENOTSUP;
+        if (auto result = PerformanceCounters::enable(event_mask); result.is_error()) {
+            TimeManagement::the().disable_profile_timer();
+            return result.release_error();
+        }
         g_profiling_all_threads = true;
         PerformanceManager::add_process_created_event(*Scheduler::colonel());
         TRY(Process::for_each_in_same_jail([](auto& process) -> ErrorOr<void> {
@@ -82,6 +87,11 @@ ErrorOr<FlatPtr> Process::profiling_enable(pid_t pid, u64 event_mask)
         process->set_profiling(false);
         return ENOTSUP;
     }
+    if (auto result = PerformanceCounters::enable(event_mask); result.is_error()) {
+        TimeManagement::the().disable_profile_timer();
+        process->set_profiling(false);
+        return result.release_error();
+    }
     return 0;
 }
 
@@ -97,6 +107,7 @@ ErrorOr<FlatPtr> Process::sys$profiling_disable(pid_t pid)
         ScopedCritical critical;
         if (!TimeManagement::the().disable_profile_timer())
             return ENOTSUP;
+        PerformanceCounters::disable();
         g_profiling_all_threads = false;
         return 0;
     }
@@ -114,6 +125,7 @@ ErrorOr<FlatPtr> Process::sys$profiling_disable(pid_t pid)
     // FIXME: If we enabled the profile timer and it's not supported, how do we disable it now?
     if (!TimeManagement::the().disable_profile_timer())
         return ENOTSUP;
+    PerformanceCounters::disable();
     process->set_profiling(false);
     return 0;
 }
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/FileSystem/Inode.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Net/Socket.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+// NOTE: The offset is passed by pointer because off_t is 64bit,
+// hence it can't be passed by register on 32bit platforms.
+ErrorOr<FlatPtr> Process::sys$sendfile(int out_fd, int in_fd, Userspace<off_t*> userspace_offset, size_t count)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::stdio));
+    if (count > NumericLimits<ssize_t>::max())
+        return EINVAL;
+
+    auto in_description = TRY(open_file_description(in_fd));
+    auto out_description = TRY(open_file_description(out_fd));
+    if (!in_description->is_readable() || !out_description->is_writable())
+        return EBADF;
+    // NOTE: The data is read straight from the inode, so only regular files can be sent.
+    auto* inode = in_description->inode();
+    if (!inode || !in_description->file().is_regular_file())
+        return EINVAL;
+    if (!out_description->is_socket())
+        return EINVAL;
+    auto& socket = *out_description->socket();
+
+    off_t offset = userspace_offset ? TRY(copy_typed_from_user(userspace_offset)) : in_description->offset();
+    if (offset < 0)
+        return EINVAL;
+    auto inode_size = inode->size();
+    count = static_cast<u64>(offset) >= inode_size ? 0 : min<u64>(count, inode_size - offset);
+
+    size_t total_sent = 0;
+    while (total_sent < count) {
+        if (!out_description->can_write()) {
+            if (!out_description->is_blocking()) {
+                if (total_sent > 0)
+                    break;
+                return EAGAIN;
+            }
+            auto unblock_flags = Thread::FileBlocker::BlockFlags::None;
+            if (Thread::current()->block<Thread::WriteBlocker>({}, *out_description, unblock_flags).was_interrupted()) {
+                if (total_sent > 0)
+                    break;
+                return EINTR;
+            }
+            continue;
+        }
+
+        auto nsent_or_error = socket.send_from_inode(*out_description, *inode, offset + total_sent, count - total_sent);
+        if (nsent_or_error.is_error()) {
+            // NOTE: The send window may have closed since we checked, so wait for it to open up again.
+            if (nsent_or_error.error().code() == EAGAIN && out_description->is_blocking())
+                continue;
+            if (total_sent > 0)
+                break;
+            if (nsent_or_error.error().code() == EPIPE)
+                Thread::current()->send_signal(SIGPIPE, &Process::current());
+            return nsent_or_error.release_error();
+        }
+        // The file got shorter while we were sending it.
+        if (nsent_or_error.value() == 0)
+            break;
+        total_sent += nsent_or_error.value();
+    }
+
+    off_t new_offset = offset + total_sent;
+    if (userspace_offset)
+        TRY(copy_to_user(userspace_offset, &new_offset));
+    else
+        TRY(in_description->seek(new_offset, SEEK_SET));
+    return total_sent;
+}
+
+}
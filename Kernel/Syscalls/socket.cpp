@@ -7,6 +7,7 @@
 #include <Kernel/FileSystem/OpenFileDescription.h>
 #include <Kernel/Net/LocalSocket.h>
 #include <Kernel/Process.h>
+#include <Kernel/Time/TimeManagement.h>
 #include <Kernel/UnixTypes.h>
 
 namespace Kernel {
@@ -83,10 +84,15 @@ ErrorOr<FlatPtr> Process::sys$accept4(Userspace<Syscall::SC_accept4_params const
     TRY(require_promise(Pledge::accept));
     auto params = TRY(copy_typed_from_user(user_params));
 
-    int accepting_socket_fd = params.sockfd;
     Userspace<sockaddr*> user_address((FlatPtr)params.addr);
     Userspace<socklen_t*> user_address_size((FlatPtr)params.addrlen);
-    int flags = params.flags;
+    return accept_impl(params.sockfd, user_address, user_address_size, params.flags);
+}
+
+ErrorOr<FlatPtr> Process::accept_impl(int accepting_socket_fd, Userspace<sockaddr*> user_address, Userspace<socklen_t*> user_address_size, int flags)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this);
+    TRY(require_promise(Pledge::accept));
 
     socklen_t address_size = 0;
     if (user_address)
@@ -177,7 +183,12 @@ ErrorOr<FlatPtr> Process::sys$sendmsg(int sockfd, Userspace<const struct msghdr*
     VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
     TRY(require_promise(Pledge::stdio));
     auto msg = TRY(copy_typed_from_user(user_msg));
+    auto description = TRY(open_file_description(sockfd));
+    return sendmsg_impl(*description, msg, flags);
+}
 
+ErrorOr<FlatPtr> Process::sendmsg_impl(OpenFileDescription& description, struct msghdr const& msg, int flags)
+{
     if (msg.msg_iovlen != 1)
         return ENOTSUP; // FIXME: Support this :)
     Vector<iovec, 1> iovs;
@@ -189,11 +200,10 @@ ErrorOr<FlatPtr> Process::sys$sendmsg(int sockfd, Userspace<const struct msghdr*
     Userspace<sockaddr const*> user_addr((FlatPtr)msg.msg_name);
     socklen_t addr_length = msg.msg_namelen;
 
-    auto description = TRY(open_file_description(sockfd));
-    if (!description->is_socket())
+    if (!description.is_socket())
         return ENOTSOCK;
 
-    auto& socket = *description->socket();
+    auto& socket = *description.socket();
     if (socket.is_shut_down_for_writing()) {
         if ((flags & MSG_NOSIGNAL) == 0)
             Thread::current()->send_signal(SIGPIPE, &Process::current());
@@ -202,19 +212,19 @@ ErrorOr<FlatPtr> Process::sys$sendmsg(int sockfd, Userspace<const struct msghdr*
     auto data_buffer = TRY(UserOrKernelBuffer::for_user_buffer((u8*)iovs[0].iov_base, iovs[0].iov_len));
 
     while (true) {
-        while (!description->can_write()) {
-            if (!description->is_blocking()) {
+        while (!description.can_write()) {
+            if (!description.is_blocking()) {
                 return EAGAIN;
             }
 
             auto unblock_flags = Thread::FileBlocker::BlockFlags::None;
-            if (Thread::current()->block<Thread::WriteBlocker>({}, *description, unblock_flags).was_interrupted()) {
+            if (Thread::current()->block<Thread::WriteBlocker>({}, description, unblock_flags).was_interrupted()) {
                 return EINTR;
             }
             // TODO: handle exceptions in unblock_flags
         }
 
-        auto bytes_sent_or_error = socket.sendto(*description, data_buffer, iovs[0].iov_len, flags, user_addr, addr_length);
+        auto bytes_sent_or_error = socket.sendto(description, data_buffer, iovs[0].iov_len, flags, user_addr, addr_length);
         if (bytes_sent_or_error.is_error()) {
             if ((flags & MSG_NOSIGNAL) == 0 && bytes_sent_or_error.error().code() == EPIPE)
                 Thread::current()->send_signal(SIGPIPE, &Process::current());
@@ -231,7 +241,12 @@ ErrorOr<FlatPtr> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> user
 {
     VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
     TRY(require_promise(Pledge::stdio));
+    auto description = TRY(open_file_description(sockfd));
+    return recvmsg_impl(*description, user_msg, flags);
+}
 
+ErrorOr<FlatPtr> Process::recvmsg_impl(OpenFileDescription& description, Userspace<struct msghdr*> user_msg, int flags)
+{
     struct msghdr msg;
     TRY(copy_from_user(&msg, user_msg));
 
@@ -244,18 +259,17 @@ ErrorOr<FlatPtr> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> user
     Userspace<sockaddr*> user_addr((FlatPtr)msg.msg_name);
     Userspace<socklen_t*> user_addr_length(msg.msg_name ? (FlatPtr)&user_msg.unsafe_userspace_ptr()->msg_namelen : 0);
 
-    auto description = TRY(open_file_description(sockfd));
-    if (!description->is_socket())
+    if (!description.is_socket())
         return ENOTSOCK;
-    auto& socket = *description->socket();
+    auto& socket = *description.socket();
 
     if (socket.is_shut_down_for_reading())
         return 0;
 
     auto data_buffer = TRY(UserOrKernelBuffer::for_user_buffer((u8*)iovs[0].iov_base, iovs[0].iov_len));
     Time timestamp {};
-    bool blocking = (flags & MSG_DONTWAIT) ? false : description->is_blocking();
-    auto result = socket.recvfrom(*description, data_buffer, iovs[0].iov_len, flags, user_addr, user_addr_length, timestamp, blocking);
+    bool blocking = (flags & MSG_DONTWAIT) ? false : description.is_blocking();
+    auto result = socket.recvfrom(description, data_buffer, iovs[0].iov_len, flags, user_addr, user_addr_length, timestamp, blocking);
 
     if (result.is_error())
         return result.release_error();
@@ -286,6 +300,62 @@ ErrorOr<FlatPtr> Process::sys$recvmsg(int sockfd, Userspace<struct msghdr*> user
     return result.value();
 }
 
+ErrorOr<FlatPtr> Process::sys$sendmmsg(int sockfd, Userspace<struct mmsghdr*> user_messages, unsigned message_count, int flags)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    TRY(require_promise(Pledge::stdio));
+    auto description = TRY(open_file_description(sockfd));
+    message_count = min(message_count, static_cast<unsigned>(IOV_MAX));
+
+    for (unsigned i = 0; i < message_count; ++i) {
+        auto* user_message = &user_messages.unsafe_userspace_ptr()[i];
+        auto message = TRY(copy_typed_from_user(Userspace<struct msghdr const*>((FlatPtr)&user_message->msg_hdr)));
+        auto bytes_sent_or_error = sendmsg_impl(*description, message, flags);
+        // NOTE: An error after the first message is dropped, the caller will run into it again with the next one it sends.
+        if (bytes_sent_or_error.is_error()) {
+            if (i == 0)
+                return bytes_sent_or_error.release_error();
+            return i;
+        }
+        unsigned bytes_sent = bytes_sent_or_error.release_value();
+        TRY(copy_to_user(&user_message->msg_len, &bytes_sent));
+    }
+    return message_count;
+}
+
+ErrorOr<FlatPtr> Process::sys$recvmmsg(Userspace<Syscall::SC_recvmmsg_params const*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    TRY(require_promise(Pledge::stdio));
+    auto params = TRY(copy_typed_from_user(user_params));
+    auto description = TRY(open_file_description(params.sockfd));
+    auto message_count = min(params.message_count, static_cast<unsigned>(IOV_MAX));
+
+    // NOTE: Like on other systems, the timeout is only checked after each message, it doesn't keep us from blocking.
+    Optional<Time> deadline;
+    if (params.timeout)
+        deadline = TimeManagement::the().monotonic_time() + TRY(copy_time_from_user(params.timeout));
+
+    auto flags = params.flags;
+    for (unsigned i = 0; i < message_count; ++i) {
+        auto* user_message = &params.messages[i];
+        auto bytes_received_or_error = recvmsg_impl(*description, Userspace<struct msghdr*>((FlatPtr)&user_message->msg_hdr), flags);
+        if (bytes_received_or_error.is_error()) {
+            if (i == 0)
+                return bytes_received_or_error.release_error();
+            return i;
+        }
+        unsigned bytes_received = bytes_received_or_error.release_value();
+        TRY(copy_to_user(&user_message->msg_len, &bytes_received));
+
+        if (flags & MSG_WAITFORONE)
+            flags |= MSG_DONTWAIT;
+        if (deadline.has_value() && TimeManagement::the().monotonic_time() >= *deadline)
+            return i + 1;
+    }
+    return message_count;
+}
+
 template<bool sockname, typename Params>
 ErrorOr<void> Process::get_sock_or_peer_name(Params const& params)
 {
@@ -116,4 +116,25 @@ ErrorOr<FlatPtr> Process::sys$write(int fd, Userspace<u8 const*> data, size_t si
     return do_write(*description, buffer, size);
 }
 
+ErrorOr<FlatPtr> Process::pwrite_impl(int fd, Userspace<u8 const*> data, size_t size, off_t offset)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    TRY(require_promise(Pledge::stdio));
+    if (size == 0)
+        return 0;
+    if (size > NumericLimits<ssize_t>::max())
+        return EINVAL;
+    if (offset < 0)
+        return EINVAL;
+
+    auto description = TRY(open_file_description(fd));
+    if (!description->is_writable())
+        return EBADF;
+    if (!description->file().is_seekable())
+        return EINVAL;
+
+    auto buffer = TRY(UserOrKernelBuffer::for_user_buffer(data, static_cast<size_t>(size)));
+    return do_write(*description, buffer, size, offset);
+}
+
 }
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/NumericLimits.h>
+#include <Kernel/Library/NonnullLockRefPtrVector.h>
+#include <Kernel/Memory/AnonymousVMObject.h>
+#include <Kernel/Memory/InodeVMObject.h>
+#include <Kernel/Memory/MemoryManager.h>
+#include <Kernel/Process.h>
+#include <Kernel/Sections.h>
+#include <Kernel/Tasks/ReclaimTask.h>
+#include <Kernel/Time/TimeManagement.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+static constexpr StringView reclaim_task_name = "Memory Reclaim Task"sv;
+READONLY_AFTER_INIT static WaitQueue* s_reclaim_task_wait_queue;
+static Atomic<bool> s_reclaim_requested;
+
+static Atomic<u64> s_reclaim_rounds;
+static Atomic<u64> s_purged_volatile_pages;
+static Atomic<u64> s_released_clean_inode_pages;
+
+// The watermarks are fractions of all physical memory, in free pages.
+static size_t low_watermark(size_t total_page_count) { return total_page_count / 32; }
+static size_t high_watermark(size_t total_page_count) { return total_page_count / 16; }
+
+static size_t free_page_count()
+{
+    return MM.get_system_memory_info().physical_pages_uncommitted;
+}
+
+// Note: The VMObjects are collected first and looked at after letting go of the list of all VMObjects, as purging
+//       and releasing pages takes their own locks.
+template<typename VMObjectType>
+static NonnullLockRefPtrVector<VMObjectType> collect_vmobjects(Function<bool(Memory::VMObject&)> filter)
+{
+    NonnullLockRefPtrVector<VMObjectType> vmobjects;
+    Memory::MemoryManager::for_each_vmobject([&](auto& vmobject) {
+        if (!filter(vmobject))
+            return IterationDecision::Continue;
+        if (vmobjects.try_append(static_cast<VMObjectType&>(vmobject)).is_error())
+            return IterationDecision::Break;
+        return IterationDecision::Continue;
+    });
+    return vmobjects;
+}
+
+static void reclaim(size_t total_page_count)
+{
+    auto target = high_watermark(total_page_count);
+    if (free_page_count() >= low_watermark(total_page_count))
+        return;
+
+    ++s_reclaim_rounds;
+
+    // Volatile memory is given up first, as its owners have already said that they can do without it.
+    auto anonymous_vmobjects = collect_vmobjects<Memory::AnonymousVMObject>([](auto& vmobject) {
+        if (!vmobject.is_anonymous())
+            return false;
+        auto& anonymous_vmobject = static_cast<Memory::AnonymousVMObject&>(vmobject);
+        return anonymous_vmobject.is_purgeable() && anonymous_vmobject.is_volatile();
+    });
+    for (auto& vmobject : anonymous_vmobjects) {
+        if (free_page_count() >= target)
+            return;
+        s_purged_volatile_pages += vmobject.purge();
+    }
+
+    // Clean pages of files can always be read back in, but doing so costs I/O.
+    auto inode_vmobjects = collect_vmobjects<Memory::InodeVMObject>([](auto& vmobject) { return vmobject.is_inode(); });
+    for (auto& vmobject : inode_vmobjects) {
+        auto free_pages = free_page_count();
+        if (free_pages >= target)
+            return;
+        s_released_clean_inode_pages += vmobject.try_release_clean_pages(static_cast<int>(min(target - free_pages, static_cast<size_t>(NumericLimits<int>::max()))));
+    }
+}
+
+UNMAP_AFTER_INIT void ReclaimTask::spawn()
+{
+    s_reclaim_task_wait_queue = new WaitQueue;
+    LockRefPtr<Thread> reclaim_thread;
+    (void)Process::create_kernel_process(reclaim_thread, KString::must_create(reclaim_task_name), [] {
+        dbgln("ReclaimTask is running");
+        Thread::current()->set_priority(THREAD_PRIORITY_LOW);
+        auto total_page_count = MM.get_system_memory_info().physical_pages;
+        for (;;) {
+            s_reclaim_requested = false;
+            reclaim(total_page_count);
+            auto timeout = Time::from_seconds(1);
+            (void)s_reclaim_task_wait_queue->wait_on(Thread::BlockTimeout(false, &timeout), reclaim_task_name);
+        }
+    });
+}
+
+void ReclaimTask::notify_free_page_count(size_t free_page_count, size_t total_page_count)
+{
+    if (!s_reclaim_task_wait_queue || free_page_count >= low_watermark(total_page_count))
+        return;
+    // Only the first allocation below the watermark wakes the task up, and the rest don't bother it until it's done.
+    if (s_reclaim_requested.exchange(true))
+        return;
+    s_reclaim_task_wait_queue->wake_all();
+}
+
+ReclaimTask::Statistics ReclaimTask::statistics()
+{
+    return {
+        .reclaim_rounds = s_reclaim_rounds.load(),
+        .purged_volatile_pages = s_purged_volatile_pages.load(),
+        .released_clean_inode_pages = s_released_clean_inode_pages.load(),
+    };
+}
+
+}
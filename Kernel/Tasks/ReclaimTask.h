@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// Frees up physical memory in the background before allocations start failing, by purging volatile memory and then
+// releasing clean pages of file-backed memory. It kicks in when the number of free pages drops below a low watermark,
+// and keeps going until there are as many free pages as the high watermark (or there is nothing left to reclaim).
+class ReclaimTask {
+public:
+    struct Statistics {
+        u64 reclaim_rounds { 0 };
+        u64 purged_volatile_pages { 0 };
+        u64 released_clean_inode_pages { 0 };
+    };
+
+    static void spawn();
+
+    // Called by the MemoryManager after handing out a page, so the task can be woken up early.
+    static void notify_free_page_count(size_t free_page_count, size_t total_page_count);
+
+    static Statistics statistics();
+};
+
+}
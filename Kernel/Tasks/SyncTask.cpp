@@ -9,19 +9,31 @@
 #include <Kernel/Sections.h>
 #include <Kernel/Tasks/SyncTask.h>
 #include <Kernel/Time/TimeManagement.h>
+#include <Kernel/WaitQueue.h>
 
 namespace Kernel {
 
+static constexpr StringView sync_task_name = "VFS Sync Task"sv;
+READONLY_AFTER_INIT static WaitQueue* s_sync_task_wait_queue;
+
 UNMAP_AFTER_INIT void SyncTask::spawn()
 {
+    s_sync_task_wait_queue = new WaitQueue;
     LockRefPtr<Thread> syncd_thread;
-    (void)Process::create_kernel_process(syncd_thread, KString::must_create("VFS Sync Task"sv), [] {
+    (void)Process::create_kernel_process(syncd_thread, KString::must_create(sync_task_name), [] {
         dbgln("VFS SyncTask is running");
         for (;;) {
             VirtualFileSystem::sync();
-            (void)Thread::current()->sleep(Time::from_seconds(1));
+            auto timeout = Time::from_seconds(1);
+            (void)s_sync_task_wait_queue->wait_on(Thread::BlockTimeout(false, &timeout), sync_task_name);
         }
     });
 }
 
+void SyncTask::request_writeback()
+{
+    if (s_sync_task_wait_queue)
+        s_sync_task_wait_queue->wake_all();
+}
+
 }
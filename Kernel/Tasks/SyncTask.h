@@ -10,5 +10,8 @@ namespace Kernel {
 class SyncTask {
 public:
     static void spawn();
+
+    // Wakes the sync task up before its next regular round, e.g. when a disk cache is filling up with dirty blocks.
+    static void request_writeback();
 };
 }
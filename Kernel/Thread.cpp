@@ -35,6 +35,8 @@ namespace Kernel {
 
 static Singleton<SpinlockProtected<Thread::GlobalList, LockRank::None>> s_list;
 
+Atomic<u64> Thread::s_statistics_generation { 1 };
+
 SpinlockProtected<Thread::GlobalList, LockRank::None>& Thread::all_instances()
 {
     return *s_list;
@@ -630,6 +632,7 @@ void Thread::update_time_scheduled(u64 current_scheduler_time, bool is_kernel, b
         m_last_time_scheduled = {};
     else
         m_last_time_scheduled = current_scheduler_time;
+    did_change_statistics();
 }
 
 bool Thread::tick()
@@ -1232,6 +1235,7 @@ void Thread::set_state(State new_state, u8 stop_signal)
     VERIFY(g_scheduler_lock.is_locked_by_current_processor());
     if (new_state == m_state)
         return;
+    did_change_statistics();
 
     {
         previous_state = m_state;
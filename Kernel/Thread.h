@@ -760,6 +760,12 @@ public:
     void did_schedule() { ++m_times_scheduled; }
     u32 times_scheduled() const { return m_times_scheduled; }
 
+    // Every snapshot of /sys/kernel/process_statistics starts a new statistics generation. Threads remember the last
+    // generation in which they ran or changed state, so that a snapshot can leave out those that haven't since.
+    static u64 advance_statistics_generation() { return s_statistics_generation.fetch_add(1, AK::MemoryOrder::memory_order_relaxed); }
+    u64 statistics_generation() const { return m_statistics_generation.load(AK::MemoryOrder::memory_order_relaxed); }
+    void did_change_statistics() { m_statistics_generation.store(s_statistics_generation.load(AK::MemoryOrder::memory_order_relaxed), AK::MemoryOrder::memory_order_relaxed); }
+
     void resume_from_stopped();
 
     [[nodiscard]] bool should_be_stopped() const;
@@ -1089,6 +1095,8 @@ private:
 
     IntrusiveListNode<Thread> m_process_thread_list_node;
     int m_runnable_priority { -1 };
+    // The processor whose ready queue this thread is on. Only changed with g_scheduler_lock held.
+    u32 m_runnable_cpu { 0 };
 
     friend class WaitQueue;
 
@@ -1168,6 +1176,8 @@ private:
     Atomic<u64> m_total_time_scheduled_kernel { 0 };
     u32 m_ticks_left { 0 };
     u32 m_times_scheduled { 0 };
+    static Atomic<u64> s_statistics_generation;
+    Atomic<u64> m_statistics_generation { s_statistics_generation.load(AK::MemoryOrder::memory_order_relaxed) };
     u32 m_ticks_in_user { 0 };
     u32 m_ticks_in_kernel { 0 };
     u32 m_pending_signals { 0 };
@@ -23,6 +23,7 @@
 #endif
 
 #include <Kernel/Arch/CurrentTime.h>
+#include <Kernel/Arch/Processor.h>
 #include <Kernel/CommandLine.h>
 #include <Kernel/Firmware/ACPI/Parser.h>
 #include <Kernel/InterruptDisabler.h>
@@ -37,6 +38,19 @@ namespace Kernel {
 
 static Singleton<TimeManagement> s_the;
 
+#if ARCH(X86_64)
+struct TimerEventPerProcessorData {
+    static ProcessorSpecificDataID processor_specific_data_id() { return ProcessorSpecificDataID::TimeManagement; }
+
+    u64 next_tick_ns { 0 };
+    bool is_idle { false };
+};
+
+// Events are never programmed closer together than this, so that a timer that is already due can't keep a processor
+// from doing anything but handling interrupts.
+static constexpr u64 minimum_timer_event_delay_ns = 10'000;
+#endif
+
 bool TimeManagement::is_initialized()
 {
     return s_the.is_initialized();
@@ -188,13 +202,19 @@ UNMAP_AFTER_INIT void TimeManagement::initialize([[maybe_unused]] u32 cpu)
             if (auto* apic_timer = APIC::the().initialize_timers(*s_the->m_system_timer)) {
                 dmesgln("Time: Using APIC timer as system timer");
                 s_the->set_system_timer(*apic_timer);
+                // Programming the timer one event at a time needs a clock to work out when the next one is due.
+                if (kernel_command_line().is_tickless_enabled() && s_the->can_query_precise_time())
+                    s_the->enable_tickless_mode(*apic_timer);
             }
         }
     } else {
         VERIFY(s_the.is_initialized());
         if (auto* apic_timer = APIC::the().get_timer()) {
             dmesgln("Time: Enable APIC timer on CPU #{}", cpu);
-            apic_timer->enable_local_timer();
+            if (s_the->is_tickless())
+                s_the->initialize_tickless_mode_on_current_processor();
+            else
+                apic_timer->enable_local_timer();
         }
     }
 #elif ARCH(AARCH64)
@@ -364,6 +384,9 @@ UNMAP_AFTER_INIT bool TimeManagement::probe_and_set_x86_non_legacy_hardware_time
     m_can_query_precise_time = true;
     m_time_ticks_per_second = HPET::the().frequency();
 
+    // Note: The TSC is only good for extrapolating time from if it doesn't change its frequency with the CPU's.
+    m_can_publish_tsc_clocks = Processor::current().has_feature(CPUFeature::TSC) && Processor::current().has_feature(CPUFeature::CONSTANT_TSC);
+
     m_system_timer->try_to_set_frequency(m_system_timer->calculate_nearest_possible_frequency(OPTIMAL_TICKS_PER_SECOND_RATE));
 
     // We don't need an interrupt for time keeping purposes because we
@@ -412,6 +435,80 @@ void TimeManagement::update_time(RegisterState const&)
     TimeManagement::the().increment_time_since_boot();
 }
 
+UNMAP_AFTER_INIT void TimeManagement::enable_tickless_mode(APICTimer& apic_timer)
+{
+    VERIFY(Processor::is_bootstrap_processor());
+    VERIFY(m_system_timer.ptr() == &apic_timer);
+
+    dmesgln("Time: Using tickless mode");
+    m_nanoseconds_per_tick = 1'000'000'000ull / apic_timer.ticks_per_second();
+    m_tick_callback = apic_timer.set_callback([](RegisterState const& regs) {
+        TimeManagement::the().handle_timer_event(regs);
+    });
+    apic_timer.set_non_periodic();
+    m_tickless = true;
+
+    initialize_tickless_mode_on_current_processor();
+}
+
+UNMAP_AFTER_INIT void TimeManagement::initialize_tickless_mode_on_current_processor()
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    VERIFY(m_tickless);
+
+    ProcessorSpecific<TimerEventPerProcessorData>::initialize();
+    auto& data = ProcessorSpecific<TimerEventPerProcessorData>::get();
+    data.next_tick_ns = monotonic_time(TimePrecision::Precise).to_nanoseconds() + m_nanoseconds_per_tick;
+    program_next_timer_event();
+}
+
+void TimeManagement::handle_timer_event(RegisterState const& regs)
+{
+    auto& data = ProcessorSpecific<TimerEventPerProcessorData>::get();
+    u64 now = monotonic_time(TimePrecision::Precise).to_nanoseconds();
+    if (now >= data.next_tick_ns) {
+        // Note: Ticks that were skipped while idle aren't made up for, the next one is simply a tick from now.
+        data.next_tick_ns = now + m_nanoseconds_per_tick;
+        m_tick_callback(regs);
+    } else if (Processor::current_in_irq() <= 1) {
+        // This event was only for a timer, which doesn't count as a tick for the scheduler.
+        TimerQueue::the().fire();
+    }
+    program_next_timer_event();
+}
+
+void TimeManagement::program_next_timer_event()
+{
+    VERIFY_INTERRUPTS_DISABLED();
+
+    auto& data = ProcessorSpecific<TimerEventPerProcessorData>::get();
+    u64 now = monotonic_time(TimePrecision::Precise).to_nanoseconds();
+    bool is_bootstrap_processor = Processor::is_bootstrap_processor();
+
+    // Idle processors don't need ticks, with the exception of the BSP while others are busy: its ticks keep the
+    // coarse clocks up to date. Timers are left to the BSP and to busy processors, so that an idle system only wakes
+    // up when there is something to do.
+    u64 next_event;
+    if (!data.is_idle || (is_bootstrap_processor && !Processor::is_every_other_processor_idle()))
+        next_event = data.next_tick_ns;
+    else
+        next_event = now + 1'000'000'000ull / MINIMUM_IDLE_TICKS_PER_SECOND_RATE;
+
+    auto& timer_queue = TimerQueue::the();
+    if (!data.is_idle || is_bootstrap_processor) {
+        if (auto time_until_next_timer = timer_queue.time_until_next_timer(CLOCK_MONOTONIC); time_until_next_timer.has_value())
+            next_event = min(next_event, now + static_cast<u64>(max(time_until_next_timer->to_nanoseconds(), (i64)0)));
+    }
+    // The realtime clock only moves on ticks of the BSP, so there's no point in waking up for its timers any sooner.
+    if (is_bootstrap_processor) {
+        if (auto time_until_next_timer = timer_queue.time_until_next_timer(CLOCK_REALTIME); time_until_next_timer.has_value())
+            next_event = min(next_event, max(now + static_cast<u64>(max(time_until_next_timer->to_nanoseconds(), (i64)0)), data.next_tick_ns));
+    }
+
+    auto delay = next_event > now ? next_event - now : 0;
+    static_cast<APICTimer&>(*m_system_timer).program_one_shot(max(delay, minimum_timer_event_delay_ns));
+}
+
 void TimeManagement::increment_time_since_boot_hpet()
 {
     VERIFY(!m_time_keeper_timer.is_null());
@@ -436,6 +533,40 @@ void TimeManagement::increment_time_since_boot_hpet()
 
     update_time_page();
 }
+
+void TimeManagement::update_precise_clocks_in_time_page(TimePage& page, Time coarse_monotonic_time)
+{
+    auto tsc = read_tsc();
+    auto now_ns = static_cast<u64>(monotonic_time(TimePrecision::Precise).to_nanoseconds());
+
+    if (m_tsc_calibration_start_tsc == 0) {
+        m_tsc_calibration_start_tsc = tsc;
+        m_tsc_calibration_start_ns = now_ns;
+        return;
+    }
+    // Until there's been a second to measure the TSC over, userspace has to use the syscall.
+    if (now_ns - m_tsc_calibration_start_ns < 1'000'000'000ull)
+        return;
+
+    // Measuring over everything since the first update makes the multiplier more accurate the longer we run.
+    auto multiplier = static_cast<u64>((static_cast<unsigned __int128>(now_ns - m_tsc_calibration_start_ns) << 32) / (tsc - m_tsc_calibration_start_tsc));
+
+    // Userspace may have extrapolated past the precise time with the previous multiplier, which mustn't make its
+    // monotonic clock go backwards.
+    if (m_tsc_to_ns_multiplier != 0) {
+        auto extrapolated_ns = m_last_published_monotonic_ns + static_cast<u64>((static_cast<unsigned __int128>(tsc - m_last_published_tsc) * m_tsc_to_ns_multiplier) >> 32);
+        now_ns = max(now_ns, extrapolated_ns);
+    }
+    m_tsc_to_ns_multiplier = multiplier;
+    m_last_published_tsc = tsc;
+    m_last_published_monotonic_ns = now_ns;
+
+    auto published_monotonic_time = Time::from_nanoseconds(static_cast<i64>(now_ns));
+    page.clocks[CLOCK_MONOTONIC] = published_monotonic_time.to_timespec();
+    page.clocks[CLOCK_REALTIME] = (Time::from_timespec(m_epoch_time) + (published_monotonic_time - coarse_monotonic_time)).to_timespec();
+    page.tsc_reference = tsc;
+    page.tsc_to_ns_multiplier = multiplier;
+}
 #elif ARCH(AARCH64)
 UNMAP_AFTER_INIT bool TimeManagement::probe_and_set_aarch64_hardware_timers()
 {
@@ -511,6 +642,47 @@ void TimeManagement::system_timer_tick(RegisterState const& regs)
     Scheduler::timer_tick(regs);
 }
 
+void TimeManagement::enter_idle()
+{
+#if ARCH(X86_64)
+    if (!m_tickless)
+        return;
+    InterruptDisabler disabler;
+    auto* data = Processor::current().get_specific<TimerEventPerProcessorData>();
+    if (!data)
+        return;
+    data->is_idle = true;
+    program_next_timer_event();
+#endif
+}
+
+void TimeManagement::leave_idle()
+{
+#if ARCH(X86_64)
+    if (!m_tickless)
+        return;
+    InterruptDisabler disabler;
+    auto* data = Processor::current().get_specific<TimerEventPerProcessorData>();
+    if (!data)
+        return;
+    data->is_idle = false;
+    program_next_timer_event();
+#endif
+}
+
+void TimeManagement::next_timer_deadline_changed()
+{
+#if ARCH(X86_64)
+    if (!m_tickless)
+        return;
+    InterruptDisabler disabler;
+    // Note: Timers can be added on processors that haven't started using the system timer yet.
+    if (!Processor::current().get_specific<TimerEventPerProcessorData>())
+        return;
+    program_next_timer_event();
+#endif
+}
+
 bool TimeManagement::enable_profile_timer()
 {
     if (!m_profile_timer)
@@ -534,7 +706,12 @@ void TimeManagement::update_time_page()
     auto& page = time_page();
     u32 update_iteration = AK::atomic_fetch_add(&page.update2, 1u, AK::MemoryOrder::memory_order_acquire);
     page.clocks[CLOCK_REALTIME_COARSE] = m_epoch_time;
-    page.clocks[CLOCK_MONOTONIC_COARSE] = monotonic_time(TimePrecision::Coarse).to_timespec();
+    auto coarse_monotonic_time = monotonic_time(TimePrecision::Coarse);
+    page.clocks[CLOCK_MONOTONIC_COARSE] = coarse_monotonic_time.to_timespec();
+#if ARCH(X86_64)
+    if (m_can_publish_tsc_clocks)
+        update_precise_clocks_in_time_page(page, coarse_monotonic_time);
+#endif
     AK::atomic_store(&page.update1, update_iteration + 1u, AK::MemoryOrder::memory_order_release);
 }
 
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Error.h>
+#include <AK/Function.h>
 #include <AK/OwnPtr.h>
 #include <AK/Platform.h>
 #include <AK/Time.h>
@@ -22,7 +23,10 @@ namespace Kernel {
 
 #define OPTIMAL_TICKS_PER_SECOND_RATE 250
 #define OPTIMAL_PROFILE_TICKS_PER_SECOND_RATE 1000
+// How often an idle processor wakes up when it has nothing else to wake up for, in tickless mode.
+#define MINIMUM_IDLE_TICKS_PER_SECOND_RATE 10
 
+class APICTimer;
 class HardwareTimerBase;
 
 enum class TimePrecision {
@@ -74,6 +78,13 @@ public:
 
     bool can_query_precise_time() const { return m_can_query_precise_time; }
 
+    // In tickless mode, the system timer is programmed for one event at a time: the next scheduler tick, or the next
+    // TimerQueue timer if that's due earlier. Idle processors skip the ticks.
+    bool is_tickless() const { return m_tickless; }
+    void enter_idle();
+    void leave_idle();
+    void next_timer_deadline_changed();
+
     Memory::VMObject& time_page_vmobject();
 
 private:
@@ -85,6 +96,12 @@ private:
     bool probe_and_set_x86_non_legacy_hardware_timers();
     void increment_time_since_boot_hpet();
     static void update_time(RegisterState const&);
+
+    void enable_tickless_mode(APICTimer&);
+    void initialize_tickless_mode_on_current_processor();
+    void handle_timer_event(RegisterState const&);
+    void program_next_timer_event();
+    void update_precise_clocks_in_time_page(TimePage&, Time coarse_monotonic_time);
 #elif ARCH(AARCH64)
     bool probe_and_set_aarch64_hardware_timers();
 #else
@@ -116,6 +133,20 @@ private:
     Atomic<u32> m_profile_enable_count { 0 };
     LockRefPtr<HardwareTimerBase> m_profile_timer;
 
+    bool m_tickless { false };
+    u64 m_nanoseconds_per_tick { 0 };
+    // What the system timer used to do on every interrupt, which is now only done once per tick.
+    Function<void(RegisterState const&)> m_tick_callback;
+
+    // The TSC is measured against the precise clock from the first time page update on, for userspace to extrapolate
+    // precise clocks from the time page with it.
+    bool m_can_publish_tsc_clocks { false };
+    u64 m_tsc_calibration_start_tsc { 0 };
+    u64 m_tsc_calibration_start_ns { 0 };
+    u64 m_tsc_to_ns_multiplier { 0 };
+    u64 m_last_published_tsc { 0 };
+    u64 m_last_published_monotonic_ns { 0 };
+
     NonnullOwnPtr<Memory::Region> m_time_page_region;
 };
 
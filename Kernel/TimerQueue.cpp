@@ -23,10 +23,19 @@ Time Timer::remaining() const
 
 Time Timer::now(bool is_firing) const
 {
+    auto clock_id = m_clock_id;
+    if (TimeManagement::the().is_tickless()) {
+        // NOTE: In tickless mode, timers fire in between ticks, so the coarse monotonic
+        // clock usually hasn't caught up with them yet. The realtime clock is only ever
+        // as precise as the ticks, which is what its timers are fired on.
+        if (clock_id == CLOCK_MONOTONIC_COARSE)
+            clock_id = CLOCK_MONOTONIC;
+        return TimeManagement::the().current_time(clock_id);
+    }
+
     // NOTE: If is_firing is true then TimePrecision::Precise isn't really useful here.
     // We already have a quite precise time stamp because we just updated the time in the
     // interrupt handler. In those cases, just use coarse timestamps.
-    auto clock_id = m_clock_id;
     if (is_firing) {
         switch (clock_id) {
         case CLOCK_MONOTONIC:
@@ -67,24 +76,35 @@ bool TimerQueue::add_timer_without_id(NonnullLockRefPtr<Timer> timer, clockid_t
     // returning from the timer handler and a call to cancel_timer().
     timer->setup(clock_id, deadline, move(callback));
 
-    SpinlockLocker lock(g_timerqueue_lock);
-    timer->m_id = 0; // Don't generate a timer id
-    add_timer_locked(move(timer));
+    bool is_next_timer;
+    {
+        SpinlockLocker lock(g_timerqueue_lock);
+        timer->m_id = 0; // Don't generate a timer id
+        is_next_timer = add_timer_locked(move(timer));
+    }
+    if (is_next_timer)
+        TimeManagement::the().next_timer_deadline_changed();
     return true;
 }
 
 TimerId TimerQueue::add_timer(NonnullLockRefPtr<Timer>&& timer)
 {
-    SpinlockLocker lock(g_timerqueue_lock);
+    TimerId id;
+    bool is_next_timer;
+    {
+        SpinlockLocker lock(g_timerqueue_lock);
 
-    timer->m_id = ++m_timer_id_count;
-    VERIFY(timer->m_id != 0); // wrapped
-    auto id = timer->m_id;
-    add_timer_locked(move(timer));
+        timer->m_id = ++m_timer_id_count;
+        VERIFY(timer->m_id != 0); // wrapped
+        id = timer->m_id;
+        is_next_timer = add_timer_locked(move(timer));
+    }
+    if (is_next_timer)
+        TimeManagement::the().next_timer_deadline_changed();
     return id;
 }
 
-void TimerQueue::add_timer_locked(NonnullLockRefPtr<Timer> timer)
+bool TimerQueue::add_timer_locked(NonnullLockRefPtr<Timer> timer)
 {
     Time timer_expiration = timer->m_expires;
 
@@ -96,23 +116,25 @@ void TimerQueue::add_timer_locked(NonnullLockRefPtr<Timer> timer)
     if (queue.list.is_empty()) {
         queue.list.append(timer.leak_ref());
         queue.next_timer_due = timer_expiration;
-    } else {
-        Timer* following_timer = nullptr;
-        for (auto& t : queue.list) {
-            if (t.m_expires > timer_expiration) {
-                following_timer = &t;
-                break;
-            }
-        }
-        if (following_timer) {
-            bool next_timer_needs_update = queue.list.first() == following_timer;
-            queue.list.insert_before(*following_timer, timer.leak_ref());
-            if (next_timer_needs_update)
-                queue.next_timer_due = timer_expiration;
-        } else {
-            queue.list.append(timer.leak_ref());
+        return true;
+    }
+
+    Timer* following_timer = nullptr;
+    for (auto& t : queue.list) {
+        if (t.m_expires > timer_expiration) {
+            following_timer = &t;
+            break;
         }
     }
+    if (following_timer) {
+        bool next_timer_needs_update = queue.list.first() == following_timer;
+        queue.list.insert_before(*following_timer, timer.leak_ref());
+        if (next_timer_needs_update)
+            queue.next_timer_due = timer_expiration;
+        return next_timer_needs_update;
+    }
+    queue.list.append(timer.leak_ref());
+    return false;
 }
 
 bool TimerQueue::cancel_timer(Timer& timer, bool* was_in_use)
@@ -183,7 +205,7 @@ void TimerQueue::fire()
         VERIFY(timer);
         VERIFY(queue.next_timer_due == timer->m_expires);
 
-        while (timer && timer->now(true) > timer->m_expires) {
+        while (timer && timer->now(true) >= timer->m_expires) {
             queue.list.remove(*timer);
 
             m_timers_executing.append(*timer);
@@ -219,6 +241,16 @@ void TimerQueue::fire()
         fire_timers(m_timer_queue_realtime);
 }
 
+Optional<Time> TimerQueue::time_until_next_timer(clockid_t clock_id)
+{
+    SpinlockLocker lock(g_timerqueue_lock);
+
+    auto& queue = queue_for_clock(clock_id);
+    if (queue.list.is_empty())
+        return {};
+    return queue.next_timer_due - TimeManagement::the().current_time(clock_id);
+}
+
 void TimerQueue::update_next_timer_due(Queue& queue)
 {
     VERIFY(g_timerqueue_lock.is_locked());
@@ -92,6 +92,9 @@ public:
     bool cancel_timer(Timer& timer, bool* was_in_use = nullptr);
     void fire();
 
+    // How long until the first timer on the clock is due (which may have already passed), if there are any.
+    Optional<Time> time_until_next_timer(clockid_t);
+
 private:
     struct Queue {
         Timer::List list;
@@ -99,11 +102,17 @@ private:
     };
     void remove_timer_locked(Queue&, Timer&);
     void update_next_timer_due(Queue&);
-    void add_timer_locked(NonnullLockRefPtr<Timer>);
+    // Returns whether the timer is now the first one to be due in its queue.
+    bool add_timer_locked(NonnullLockRefPtr<Timer>);
 
     Queue& queue_for_timer(Timer& timer)
     {
-        switch (timer.m_clock_id) {
+        return queue_for_clock(timer.m_clock_id);
+    }
+
+    Queue& queue_for_clock(clockid_t clock_id)
+    {
+        switch (clock_id) {
         case CLOCK_MONOTONIC:
         case CLOCK_MONOTONIC_COARSE:
         case CLOCK_MONOTONIC_RAW:
@@ -13,11 +13,13 @@
 #include <Kernel/API/POSIX/net/if_arp.h>
 #include <Kernel/API/POSIX/net/route.h>
 #include <Kernel/API/POSIX/netinet/in.h>
+#include <Kernel/API/POSIX/netinet/udp.h>
 #include <Kernel/API/POSIX/poll.h>
 #include <Kernel/API/POSIX/sched.h>
 #include <Kernel/API/POSIX/serenity.h>
 #include <Kernel/API/POSIX/signal.h>
 #include <Kernel/API/POSIX/stdio.h>
+#include <Kernel/API/POSIX/sys/epoll.h>
 #include <Kernel/API/POSIX/sys/mman.h>
 #include <Kernel/API/POSIX/sys/ptrace.h>
 #include <Kernel/API/POSIX/sys/socket.h>
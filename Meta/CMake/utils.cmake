@@ -130,6 +130,12 @@ if (NOT COMMAND serenity_test)
     endfunction()
 endif()
 
+if (NOT COMMAND serenity_benchmark)
+    function(serenity_benchmark benchmark_src sub_dir)
+        serenity_test(${benchmark_src} ${sub_dir} ${ARGN})
+    endfunction()
+endif()
+
 function(serenity_testjs_test test_src sub_dir)
     cmake_parse_arguments(PARSE_ARGV 2 SERENITY_TEST "" "CUSTOM_MAIN" "LIBS")
     if ("${SERENITY_TEST_CUSTOM_MAIN}" STREQUAL "")
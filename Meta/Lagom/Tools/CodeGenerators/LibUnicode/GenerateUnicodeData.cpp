@@ -12,6 +12,7 @@
 #include <AK/Error.h>
 #include <AK/Find.h>
 #include <AK/HashMap.h>
+#include <AK/NumericLimits.h>
 #include <AK/Optional.h>
 #include <AK/QuickSort.h>
 #include <AK/SourceGenerator.h>
@@ -30,6 +31,14 @@ struct CodePointRange {
     u32 last;
 };
 
+static constexpr u32 max_code_point = 0x10ffff;
+
+// Properties that a code point has at most one value of are looked up in two stages: the high bits of the code point
+// pick a block, and the low bits pick the code point's property in the block. Blocks that are alike are only stored
+// once, so this is both smaller and faster than searching through the code point ranges of every value.
+static constexpr u32 code_point_block_shift = 7;
+static constexpr u32 code_point_block_size = 1 << code_point_block_shift;
+
 // https://www.unicode.org/reports/tr44/#SpecialCasing.txt
 struct SpecialCasing {
     u32 index { 0 };
@@ -1015,8 +1024,22 @@ struct CodePointNameComparator : public CodePointRangeComparator {
         return CodePointRangeComparator::operator()(code_point, name.code_point_range);
     }
 };
+
+static constexpr u32 code_point_block_shift = @code_point_block_shift@;
+static constexpr u32 code_point_block_size = 1 << code_point_block_shift;
+
+// Returns one plus the index of the property of the code point, or zero if it doesn't have one.
+template<typename ValueType, size_t BlockCount, size_t ValueCount>
+static constexpr ValueType lookup_code_point_property(Array<u16, BlockCount> const& blocks, Array<ValueType, ValueCount> const& values, u32 code_point)
+{
+    auto block_index = code_point >> code_point_block_shift;
+    if (block_index >= BlockCount)
+        return 0;
+    return values[blocks[block_index] * code_point_block_size + (code_point & (code_point_block_size - 1))];
+}
 )~~~");
 
+    generator.set("code_point_block_shift", DeprecatedString::number(code_point_block_shift));
     generator.set("decomposition_mappings_size", DeprecatedString::number(unicode_data.decomposition_mappings.size()));
     generator.append("\nstatic constexpr Array<u32, @decomposition_mappings_size@> s_decomposition_mappings_data { ");
     generator.append(DeprecatedString::join(", "sv, unicode_data.decomposition_mappings, "{:#x}"sv));
@@ -1148,12 +1171,90 @@ static constexpr Array<Span<CodePointRange const>, @size@> @name@ { {)~~~");
 
     append_prop_list("s_general_categories"sv, "s_general_category_{}"sv, unicode_data.general_categories);
     append_prop_list("s_properties"sv, "s_property_{}"sv, unicode_data.prop_list);
-    append_prop_list("s_scripts"sv, "s_script_{}"sv, unicode_data.script_list);
     append_prop_list("s_script_extensions"sv, "s_script_extension_{}"sv, unicode_data.script_extensions);
-    append_prop_list("s_blocks"sv, "s_block_{}"sv, unicode_data.block_list);
-    append_prop_list("s_grapheme_break_properties"sv, "s_grapheme_break_property_{}"sv, unicode_data.grapheme_break_props);
-    append_prop_list("s_word_break_properties"sv, "s_word_break_property_{}"sv, unicode_data.word_break_props);
-    append_prop_list("s_sentence_break_properties"sv, "s_sentence_break_property_{}"sv, unicode_data.sentence_break_props);
+
+    auto append_number_list = [&](auto const& numbers) {
+        constexpr size_t max_values_per_row = 40;
+        size_t values_in_current_row = 0;
+
+        for (auto number : numbers) {
+            if (values_in_current_row++ > 0)
+                generator.append(" ");
+
+            generator.set("number", DeprecatedString::number(number));
+            generator.append("@number@,");
+
+            if (values_in_current_row == max_values_per_row) {
+                values_in_current_row = 0;
+                generator.append("\n    ");
+            }
+        }
+    };
+
+    auto append_property_lookup_table = [&](StringView name, PropList const& property_list) {
+        auto property_names = property_list.keys();
+        quick_sort(property_names);
+        VERIFY(property_names.size() < NumericLimits<u16>::max());
+
+        Vector<u16> property_of_code_point;
+        property_of_code_point.resize(max_code_point + 1);
+
+        for (size_t i = 0; i < property_names.size(); ++i) {
+            for (auto const& range : property_list.find(property_names[i])->value) {
+                for (u32 code_point = range.first; code_point <= range.last; ++code_point) {
+                    // Note: These properties are only ever looked up like this if no code point has more than one of them.
+                    VERIFY(property_of_code_point[code_point] == 0);
+                    property_of_code_point[code_point] = i + 1;
+                }
+            }
+        }
+
+        Vector<u16> blocks;
+        Vector<u16> values;
+        HashMap<DeprecatedString, u16> unique_blocks;
+
+        for (u32 first_code_point = 0; first_code_point <= max_code_point; first_code_point += code_point_block_size) {
+            auto block = property_of_code_point.span().slice(first_code_point, code_point_block_size);
+            DeprecatedString block_key { ReadonlyBytes { reinterpret_cast<u8 const*>(block.data()), block.size() * sizeof(u16) } };
+
+            if (auto block_index = unique_blocks.get(block_key); block_index.has_value()) {
+                blocks.append(*block_index);
+                continue;
+            }
+
+            auto block_index = static_cast<u16>(values.size() / code_point_block_size);
+            values.append(block.data(), block.size());
+            unique_blocks.set(move(block_key), block_index);
+            blocks.append(block_index);
+        }
+
+        VERIFY(values.size() / code_point_block_size <= NumericLimits<u16>::max());
+
+        generator.set("name", name);
+        generator.set("value_type", property_names.size() < NumericLimits<u8>::max() ? "u8"sv : "u16"sv);
+        generator.set("blocks_size", DeprecatedString::number(blocks.size()));
+        generator.set("values_size", DeprecatedString::number(values.size()));
+
+        generator.append(R"~~~(
+static constexpr Array<u16, @blocks_size@> @name@_blocks { {
+    )~~~");
+        append_number_list(blocks);
+        generator.append(R"~~~(
+} };
+
+static constexpr Array<@value_type@, @values_size@> @name@_values { {
+    )~~~");
+        append_number_list(values);
+        generator.append(R"~~~(
+} };
+)~~~");
+    };
+
+    append_property_lookup_table("s_scripts"sv, unicode_data.script_list);
+    append_property_lookup_table("s_blocks"sv, unicode_data.block_list);
+    append_property_lookup_table("s_grapheme_break_properties"sv, unicode_data.grapheme_break_props);
+    append_property_lookup_table("s_word_break_properties"sv, unicode_data.word_break_props);
+    append_property_lookup_table("s_sentence_break_properties"sv, unicode_data.sentence_break_props);
 
     auto append_code_point_display_names = [&](StringView type, StringView name, auto const& display_names) {
         constexpr size_t max_values_per_row = 30;
@@ -1309,6 +1410,19 @@ bool code_point_has_@enum_snake@(u32 code_point, @enum_title@ @enum_snake@)
 )~~~");
     };
 
+    auto append_property_lookup = [&](StringView enum_title, StringView enum_snake, StringView table_name) {
+        generator.set("enum_title", enum_title);
+        generator.set("enum_snake", enum_snake);
+        generator.set("table_name", table_name);
+        generator.append(R"~~~(
+bool code_point_has_@enum_snake@(u32 code_point, @enum_title@ @enum_snake@)
+{
+    auto index = static_cast<@enum_title@UnderlyingType>(@enum_snake@);
+    return lookup_code_point_property(@table_name@_blocks, @table_name@_values, code_point) == index + 1;
+}
+)~~~");
+    };
+
     auto append_from_string = [&](StringView enum_title, StringView enum_snake, auto const& prop_list, Vector<Alias> const& aliases) -> ErrorOr<void> {
         HashValueMap<StringView> hashes;
         TRY(hashes.try_ensure_capacity(prop_list.size() + aliases.size()));
@@ -1340,16 +1454,16 @@ bool code_point_has_@enum_snake@(u32 code_point, @enum_title@ @enum_snake@)
     append_prop_search("Property"sv, "property"sv, "s_properties"sv);
     TRY(append_from_string("Property"sv, "property"sv, unicode_data.prop_list, unicode_data.prop_aliases));
 
-    append_prop_search("Script"sv, "script"sv, "s_scripts"sv);
+    append_property_lookup("Script"sv, "script"sv, "s_scripts"sv);
     append_prop_search("Script"sv, "script_extension"sv, "s_script_extensions"sv);
     TRY(append_from_string("Script"sv, "script"sv, unicode_data.script_list, unicode_data.script_aliases));
 
-    append_prop_search("Block"sv, "block"sv, "s_blocks"sv);
+    append_property_lookup("Block"sv, "block"sv, "s_blocks"sv);
     TRY(append_from_string("Block"sv, "block"sv, unicode_data.block_list, unicode_data.block_aliases));
 
-    append_prop_search("GraphemeBreakProperty"sv, "grapheme_break_property"sv, "s_grapheme_break_properties"sv);
-    append_prop_search("WordBreakProperty"sv, "word_break_property"sv, "s_word_break_properties"sv);
-    append_prop_search("SentenceBreakProperty"sv, "sentence_break_property"sv, "s_sentence_break_properties"sv);
+    append_property_lookup("GraphemeBreakProperty"sv, "grapheme_break_property"sv, "s_grapheme_break_properties"sv);
+    append_property_lookup("WordBreakProperty"sv, "word_break_property"sv, "s_word_break_properties"sv);
+    append_property_lookup("SentenceBreakProperty"sv, "sentence_break_property"sv, "s_sentence_break_properties"sv);
 
     generator.append(R"~~~(
 }
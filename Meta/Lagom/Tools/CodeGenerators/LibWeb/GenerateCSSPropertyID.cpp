@@ -150,6 +150,7 @@ ErrorOr<void> generate_implementation_file(JsonObject& properties, Core::Stream:
 
     generator.append(R"~~~(
 #include <AK/Assertions.h>
+#include <AK/HashMap.h>
 #include <LibWeb/CSS/Enums.h>
 #include <LibWeb/CSS/Parser/Parser.h>
 #include <LibWeb/CSS/PropertyID.h>
@@ -157,29 +158,24 @@ ErrorOr<void> generate_implementation_file(JsonObject& properties, Core::Stream:
 
 namespace Web::CSS {
 
-PropertyID property_id_from_camel_case_string(StringView string)
-{
+static HashMap<StringView, PropertyID, AK::CaseInsensitiveStringViewTraits> g_camel_case_stringview_to_property_id_map {
 )~~~");
 
     properties.for_each_member([&](auto& name, auto& value) {
         VERIFY(value.is_object());
 
         auto member_generator = generator.fork();
-        member_generator.set("name", name);
         member_generator.set("name:titlecase", title_casify(name));
         member_generator.set("name:camelcase", camel_casify(name));
         member_generator.append(R"~~~(
-    if (string.equals_ignoring_case("@name:camelcase@"sv))
-        return PropertyID::@name:titlecase@;
+    { "@name:camelcase@"sv, PropertyID::@name:titlecase@ },
 )~~~");
     });
 
     generator.append(R"~~~(
-    return PropertyID::Invalid;
-}
+};
 
-PropertyID property_id_from_string(StringView string)
-{
+static HashMap<StringView, PropertyID, AK::CaseInsensitiveStringViewTraits> g_stringview_to_property_id_map {
 )~~~");
 
     properties.for_each_member([&](auto& name, auto& value) {
@@ -189,13 +185,21 @@ PropertyID property_id_from_string(StringView string)
         member_generator.set("name", name);
         member_generator.set("name:titlecase", title_casify(name));
         member_generator.append(R"~~~(
-    if (string.equals_ignoring_case("@name@"sv))
-        return PropertyID::@name:titlecase@;
+    { "@name@"sv, PropertyID::@name:titlecase@ },
 )~~~");
     });
 
     generator.append(R"~~~(
-    return PropertyID::Invalid;
+};
+
+PropertyID property_id_from_camel_case_string(StringView string)
+{
+    return g_camel_case_stringview_to_property_id_map.get(string).value_or(PropertyID::Invalid);
+}
+
+PropertyID property_id_from_string(StringView string)
+{
+    return g_stringview_to_property_id_map.get(string).value_or(PropertyID::Invalid);
 }
 
 StringView string_from_property_id(PropertyID property_id) {
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Arena.h>
+#include <AK/DeprecatedString.h>
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
+#include <AK/Vector.h>
+
+TEST_CASE(allocations_are_aligned)
+{
+    Arena arena;
+    for (size_t alignment = 1; alignment <= 64; alignment *= 2) {
+        auto* pointer = arena.allocate(3, alignment);
+        EXPECT_NE(pointer, nullptr);
+        EXPECT_EQ(reinterpret_cast<FlatPtr>(pointer) % alignment, 0u);
+    }
+
+    auto* large = arena.allocate(Arena::chunk_size, 64);
+    EXPECT_NE(large, nullptr);
+    EXPECT_EQ(reinterpret_cast<FlatPtr>(large) % 64, 0u);
+    EXPECT_EQ(arena.allocated_bytes(), 3 * 7 + Arena::chunk_size);
+
+    arena.reset();
+    EXPECT_EQ(arena.allocated_bytes(), 0u);
+}
+
+TEST_CASE(vector_in_arena)
+{
+    Arena arena;
+    Vector<int, 0, ArenaAllocator> vector { ArenaAllocator { arena } };
+    for (int i = 0; i < 10000; ++i)
+        vector.append(i);
+    EXPECT_EQ(vector.size(), 10000u);
+    EXPECT_EQ(vector[1234], 1234);
+    EXPECT(arena.allocated_bytes() >= 10000 * sizeof(int));
+
+    auto moved = move(vector);
+    EXPECT_EQ(&moved.allocator().arena(), &arena);
+    moved.append(10000);
+    EXPECT_EQ(moved.last(), 10000);
+
+    Vector<int> copy { moved };
+    EXPECT_EQ(copy.size(), moved.size());
+    EXPECT_EQ(copy[5000], 5000);
+}
+
+TEST_CASE(inline_vector_in_arena)
+{
+    Arena arena;
+    Vector<DeprecatedString, 4, ArenaAllocator> vector { ArenaAllocator { arena } };
+    vector.append("a");
+    vector.append("b");
+    EXPECT_EQ(arena.allocated_bytes(), 0u);
+
+    for (size_t i = 0; i < 100; ++i)
+        vector.append(DeprecatedString::number(i));
+    EXPECT_NE(arena.allocated_bytes(), 0u);
+    EXPECT_EQ(vector[0], "a");
+    EXPECT_EQ(vector[101], "99");
+
+    vector.clear();
+    EXPECT(vector.is_empty());
+    vector.append("c");
+    EXPECT_EQ(vector[0], "c");
+}
+
+TEST_CASE(hash_map_in_arena)
+{
+    Arena arena;
+    {
+        HashMap<int, int, Traits<int>, Traits<int>, false, false, ArenaAllocator> map { ArenaAllocator { arena } };
+        for (int i = 0; i < 1000; ++i)
+            map.set(i, i * 2);
+        EXPECT_EQ(map.size(), 1000u);
+        EXPECT_EQ(map.get(500), 1000);
+        EXPECT(map.remove(500));
+        EXPECT(!map.get(500).has_value());
+
+        map.clear();
+        EXPECT(map.is_empty());
+        map.set(1, 2);
+        EXPECT_EQ(map.get(1), 2);
+    }
+    EXPECT_NE(arena.allocated_bytes(), 0u);
+
+    arena.reset();
+    HashTable<DeprecatedString, Traits<DeprecatedString>, true, ArenaAllocator> table { ArenaAllocator { arena } };
+    table.set("foo");
+    table.set("bar");
+    table.set("foo");
+    EXPECT_EQ(table.size(), 2u);
+    EXPECT_EQ(*table.begin(), "foo");
+}
@@ -348,3 +348,36 @@ TEST_CASE(offset_of_with_until_and_after_wrapping_around)
     result = circular_buffer.offset_of("Well "sv, 14, 19);
     EXPECT_EQ(result.value_or(42), 14ul);
 }
+
+TEST_CASE(copy_from_seekback_overlapping)
+{
+    auto circular_buffer = MUST(CircularBuffer::create_empty(8));
+
+    auto written_bytes = circular_buffer.write("ab"sv.bytes());
+    EXPECT_EQ(written_bytes, 2ul);
+
+    auto copied_bytes = MUST(circular_buffer.copy_from_seekback(2, 5));
+    EXPECT_EQ(copied_bytes, 5ul);
+
+    Array<u8, 7> result {};
+    EXPECT_EQ(circular_buffer.read(result).size(), 7ul);
+    EXPECT_EQ(StringView { result.span() }, "abababa"sv);
+}
+
+TEST_CASE(copy_from_seekback_wrapping_around)
+{
+    auto circular_buffer = MUST(CircularBuffer::create_empty(8));
+
+    EXPECT_EQ(circular_buffer.write("Hello!"sv.bytes()), 6ul);
+    Array<u8, 6> discarded {};
+    EXPECT_EQ(circular_buffer.read(discarded).size(), 6ul);
+
+    auto copied_bytes = MUST(circular_buffer.copy_from_seekback(6, 6));
+    EXPECT_EQ(copied_bytes, 6ul);
+
+    Array<u8, 6> result {};
+    EXPECT_EQ(circular_buffer.read(result).size(), 6ul);
+    EXPECT_EQ(StringView { result.span() }, "Hello!"sv);
+
+    EXPECT(circular_buffer.copy_from_seekback(9, 1).is_error());
+}
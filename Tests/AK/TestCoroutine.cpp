@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Coroutine.h>
+#include <AK/NonnullOwnPtr.h>
+
+namespace {
+
+// Suspends whoever awaits it until fire() is called.
+struct Trigger {
+    bool await_ready() const { return false; }
+    void await_suspend(std::coroutine_handle<> awaiter) { m_awaiter = awaiter; }
+    void await_resume() const { }
+
+    bool has_awaiter() const { return static_cast<bool>(m_awaiter); }
+    void fire() { exchange(m_awaiter, {}).resume(); }
+
+private:
+    std::coroutine_handle<> m_awaiter;
+};
+
+}
+
+static Coroutine<int> return_immediately()
+{
+    co_return 42;
+}
+
+TEST_CASE(runs_right_away)
+{
+    auto coroutine = return_immediately();
+    EXPECT(coroutine.is_ready());
+    EXPECT_EQ(coroutine.take_result(), 42);
+}
+
+static Coroutine<int> add_after(Trigger& trigger, int a, int b)
+{
+    co_await trigger;
+    co_return a + b;
+}
+
+TEST_CASE(suspends_and_resumes)
+{
+    Trigger trigger;
+    auto coroutine = add_after(trigger, 20, 22);
+    EXPECT(!coroutine.is_ready());
+    EXPECT(trigger.has_awaiter());
+
+    trigger.fire();
+    EXPECT(coroutine.is_ready());
+    EXPECT_EQ(coroutine.take_result(), 42);
+}
+
+static Coroutine<int> await_both(Trigger& trigger)
+{
+    auto first = co_await return_immediately();
+    auto second = co_await add_after(trigger, 1, 2);
+    co_return first + second;
+}
+
+TEST_CASE(awaiting_other_coroutines)
+{
+    Trigger trigger;
+    auto coroutine = await_both(trigger);
+    EXPECT(!coroutine.is_ready());
+
+    // This resumes the inner coroutine, which then resumes the outer one when it's done.
+    trigger.fire();
+    EXPECT(coroutine.is_ready());
+    EXPECT_EQ(coroutine.take_result(), 45);
+}
+
+static Coroutine<void> count_up(Trigger& trigger, int& counter)
+{
+    for (int i = 0; i < 3; ++i) {
+        co_await trigger;
+        ++counter;
+    }
+}
+
+TEST_CASE(void_coroutines)
+{
+    Trigger trigger;
+    int counter = 0;
+    auto coroutine = count_up(trigger, counter);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT(!coroutine.is_ready());
+        trigger.fire();
+        EXPECT_EQ(counter, i + 1);
+    }
+    EXPECT(coroutine.is_ready());
+    coroutine.take_result();
+}
+
+static Coroutine<NonnullOwnPtr<int>> make_after(Trigger& trigger)
+{
+    co_await trigger;
+    co_return make<int>(42);
+}
+
+TEST_CASE(move_only_results)
+{
+    Trigger trigger;
+    auto coroutine = make_after(trigger);
+    trigger.fire();
+    EXPECT_EQ(*coroutine.take_result(), 42);
+}
+
+struct SetOnDestruction {
+    ~SetOnDestruction() { flag = true; }
+    bool& flag;
+};
+
+static Coroutine<void> never_finish(Trigger& trigger, bool& destroyed)
+{
+    SetOnDestruction guard { destroyed };
+    co_await trigger;
+    VERIFY_NOT_REACHED();
+}
+
+TEST_CASE(destroying_an_unfinished_coroutine_cancels_it)
+{
+    Trigger trigger;
+    bool destroyed = false;
+    {
+        auto coroutine = never_finish(trigger, destroyed);
+        auto moved_coroutine = move(coroutine);
+        EXPECT(!destroyed);
+    }
+    EXPECT(destroyed);
+}
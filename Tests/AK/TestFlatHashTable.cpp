@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/DeprecatedString.h>
+#include <AK/FlatHashTable.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+
+TEST_CASE(construct)
+{
+    using IntTable = FlatHashTable<int>;
+    EXPECT(IntTable().is_empty());
+    EXPECT_EQ(IntTable().size(), 0u);
+    EXPECT(IntTable().begin() == IntTable().end());
+}
+
+TEST_CASE(basic_move)
+{
+    FlatHashTable<int> foo;
+    foo.set(1);
+    EXPECT_EQ(foo.size(), 1u);
+    auto bar = move(foo);
+    EXPECT_EQ(bar.size(), 1u);
+    EXPECT_EQ(foo.size(), 0u);
+    foo = move(bar);
+    EXPECT_EQ(bar.size(), 0u);
+    EXPECT_EQ(foo.size(), 1u);
+    EXPECT(foo.contains(1));
+}
+
+TEST_CASE(set_and_find)
+{
+    FlatHashTable<DeprecatedString> strings;
+    EXPECT_EQ(strings.set("One"), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(strings.set("Two"), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(strings.set("Two"), AK::HashSetResult::ReplacedExistingEntry);
+    EXPECT_EQ(strings.set("Two", AK::HashSetExistingEntryBehavior::Keep), AK::HashSetResult::KeptExistingEntry);
+    EXPECT_EQ(strings.size(), 2u);
+
+    EXPECT(strings.contains("One"));
+    EXPECT(strings.contains("Two"sv));
+    EXPECT(!strings.contains("Three"));
+    EXPECT_EQ(*strings.find("One"), "One");
+    EXPECT(strings.find("Three") == strings.end());
+}
+
+TEST_CASE(range_loop)
+{
+    FlatHashTable<DeprecatedString> strings;
+    strings.set("One");
+    strings.set("Two");
+    strings.set("Three");
+
+    int loop_counter = 0;
+    for (auto& it : strings) {
+        EXPECT_EQ(it.is_null(), false);
+        ++loop_counter;
+    }
+    EXPECT_EQ(loop_counter, 3);
+}
+
+TEST_CASE(many_values)
+{
+    FlatHashTable<int> numbers;
+    for (int i = 0; i < 10'000; ++i)
+        EXPECT_EQ(numbers.set(i), AK::HashSetResult::InsertedNewEntry);
+    EXPECT_EQ(numbers.size(), 10'000u);
+
+    for (int i = 0; i < 10'000; ++i)
+        EXPECT(numbers.contains(i));
+    EXPECT(!numbers.contains(10'000));
+
+    for (int i = 0; i < 10'000; i += 2)
+        EXPECT(numbers.remove(i));
+    EXPECT_EQ(numbers.size(), 5'000u);
+
+    size_t sum = 0;
+    for (auto number : numbers) {
+        EXPECT(number % 2);
+        sum += number;
+    }
+    EXPECT_EQ(sum, 25'000'000u);
+}
+
+TEST_CASE(churn_with_tombstones)
+{
+    // Repeatedly adding and removing values must not let the table fill up with deleted slots.
+    FlatHashTable<int> numbers;
+    for (int i = 0; i < 100'000; ++i) {
+        numbers.set(i);
+        if (i >= 10)
+            EXPECT(numbers.remove(i - 10));
+    }
+    EXPECT_EQ(numbers.size(), 10u);
+    EXPECT(numbers.capacity() < 100u);
+    for (int i = 99'990; i < 100'000; ++i)
+        EXPECT(numbers.contains(i));
+}
+
+TEST_CASE(remove_all_matching)
+{
+    FlatHashTable<int> numbers;
+    for (int i = 0; i < 100; ++i)
+        numbers.set(i);
+
+    EXPECT(numbers.remove_all_matching([](int value) { return value >= 50; }));
+    EXPECT_EQ(numbers.size(), 50u);
+    EXPECT(!numbers.remove_all_matching([](int value) { return value >= 50; }));
+
+    numbers.clear_with_capacity();
+    EXPECT(numbers.is_empty());
+    EXPECT(numbers.begin() == numbers.end());
+    numbers.set(1234);
+    EXPECT_EQ(numbers.pop(), 1234);
+    EXPECT(numbers.is_empty());
+}
+
+TEST_CASE(copy_and_non_trivial_values)
+{
+    FlatHashTable<NonnullOwnPtr<DeprecatedString>, Traits<NonnullOwnPtr<DeprecatedString>>> owned;
+    for (int i = 0; i < 100; ++i)
+        owned.set(make<DeprecatedString>(DeprecatedString::number(i)));
+    EXPECT_EQ(owned.size(), 100u);
+
+    FlatHashTable<DeprecatedString> strings;
+    for (int i = 0; i < 100; ++i)
+        strings.set(DeprecatedString::number(i));
+    auto copy = strings;
+    strings.clear();
+    EXPECT_EQ(copy.size(), 100u);
+    EXPECT(copy.contains("42"sv));
+}
+
+TEST_CASE(flat_hash_map)
+{
+    FlatHashMap<DeprecatedString, int> map;
+    for (int i = 0; i < 1000; ++i)
+        map.set(DeprecatedString::number(i), i);
+    EXPECT_EQ(map.size(), 1000u);
+    EXPECT_EQ(map.get("123"sv).value(), 123);
+    EXPECT(!map.get("1000"sv).has_value());
+
+    map.ensure("1000") = 1000;
+    EXPECT_EQ(map.take("1000").value(), 1000);
+    EXPECT(map.remove("999"));
+    EXPECT_EQ(map.size(), 999u);
+}
@@ -6,6 +6,7 @@
 
 #include <LibTest/TestCase.h>
 
+#include <AK/DeprecatedFlyString.h>
 #include <AK/FlyString.h>
 #include <AK/String.h>
 #include <AK/Try.h>
@@ -118,3 +119,36 @@ TEST_CASE(moved_fly_string_becomes_empty)
     EXPECT_EQ(fly1, "thisisdefinitelymorethan7bytes"sv);
     EXPECT_EQ(FlyString::number_of_fly_strings(), 1u);
 }
+
+TEST_CASE(from_utf8_reuses_interned_string)
+{
+    EXPECT_EQ(FlyString::number_of_fly_strings(), 0u);
+    {
+        FlyString fly1 { MUST(String::from_utf8("thisisdefinitelymorethan7bytes"sv)) };
+        auto fly2 = MUST(FlyString::from_utf8("thisisdefinitelymorethan7bytes"sv));
+        EXPECT_EQ(FlyString::number_of_fly_strings(), 1u);
+
+        EXPECT_EQ(fly1, fly2);
+        EXPECT_EQ(fly1.bytes().data(), fly2.bytes().data());
+        EXPECT_EQ(fly1.hash(), "thisisdefinitelymorethan7bytes"sv.hash());
+    }
+    EXPECT_EQ(FlyString::number_of_fly_strings(), 0u);
+}
+
+TEST_CASE(deprecated_fly_string_conversion)
+{
+    EXPECT_EQ(FlyString::number_of_fly_strings(), 0u);
+    {
+        DeprecatedFlyString deprecated { "thisisdefinitelymorethan7bytes"sv };
+
+        auto fly1 = MUST(FlyString::from_deprecated_fly_string(deprecated));
+        auto fly2 = MUST(FlyString::from_deprecated_fly_string(deprecated));
+        EXPECT_EQ(FlyString::number_of_fly_strings(), 1u);
+        EXPECT_EQ(fly1, fly2);
+        EXPECT_EQ(fly1.hash(), deprecated.hash());
+
+        EXPECT_EQ(fly1.to_deprecated_fly_string(), deprecated);
+        EXPECT_EQ(FlyString { MUST(String::from_utf8("short"sv)) }.to_deprecated_fly_string(), DeprecatedFlyString { "short" });
+    }
+    EXPECT_EQ(FlyString::number_of_fly_strings(), 0u);
+}
@@ -276,6 +276,35 @@ TEST_CASE(magnitude_less_than_zero)
     EXPECT_EQ(DeprecatedString::formatted("{}", 0.654), "0.654");
 }
 
+TEST_CASE(shortest_representation)
+{
+    EXPECT_EQ(DeprecatedString::formatted("{}", 0.1), "0.1");
+    EXPECT_EQ(DeprecatedString::formatted("{}", 0.3), "0.3");
+    EXPECT_EQ(DeprecatedString::formatted("{}", 0.000001), "0.000001");
+    EXPECT_EQ(DeprecatedString::formatted("{}", 123456.5), "123456.5");
+    EXPECT_EQ(DeprecatedString::formatted("{}", 1e20), "100000000000000000000");
+    EXPECT_EQ(DeprecatedString::formatted("{}", 18446744073709551616.0), "18446744073709552000");
+    EXPECT_EQ(DeprecatedString::formatted("{}", -0.0), "0");
+    EXPECT_EQ(DeprecatedString::formatted("{:+}", 2.5), "+2.5");
+    EXPECT_EQ(DeprecatedString::formatted("{: }", 2.5), " 2.5");
+    EXPECT_EQ(DeprecatedString::formatted("{:.3f}", 2.5), "2.500");
+    EXPECT_EQ(DeprecatedString::formatted("{:0.3}", -2.5), "-2.500");
+    EXPECT_EQ(DeprecatedString::formatted("{:>8}", 0.25), "    0.25");
+}
+
+TEST_CASE(integers_in_all_bases)
+{
+    EXPECT_EQ(DeprecatedString::formatted("{}", NumericLimits<u64>::max()), "18446744073709551615");
+    EXPECT_EQ(DeprecatedString::formatted("{}", NumericLimits<i64>::min()), "-9223372036854775808");
+    EXPECT_EQ(DeprecatedString::formatted("{}", 7), "7");
+    EXPECT_EQ(DeprecatedString::formatted("{}", 42), "42");
+    EXPECT_EQ(DeprecatedString::formatted("{}", 100), "100");
+    EXPECT_EQ(DeprecatedString::formatted("{:b}", 10), "1010");
+    EXPECT_EQ(DeprecatedString::formatted("{:o}", 511), "777");
+    EXPECT_EQ(DeprecatedString::formatted("{:X}", NumericLimits<u64>::max()), "FFFFFFFFFFFFFFFF");
+    EXPECT_EQ(DeprecatedString::formatted("{:x}", 0), "0");
+}
+
 TEST_CASE(format_nullptr)
 {
     EXPECT_EQ(DeprecatedString::formatted("{}", nullptr), DeprecatedString::formatted("{:p}", static_cast<FlatPtr>(0)));
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/JsonObject.h>
+#include <AK/JsonObjectSerializer.h>
+#include <AK/JsonView.h>
+#include <AK/MemoryStream.h>
+#include <AK/StreamBuilder.h>
+#include <AK/StringBuilder.h>
+
+TEST_CASE(read_values)
+{
+    auto input = R"(
+    {
+        "name": "Form1",
+        "enabled": true,
+        "visible":false,
+        "tooltip": null,
+        "x": 155,
+        "y": -10,
+        "opacity": 0.5,
+        "big": 18446744073709551615,
+        "widgets": [ { "class": "GTextEditor" }, [], {}, 1 ]
+    })"sv;
+
+    auto document = MUST(JsonDocument::parse(input));
+    auto root = document.root();
+    EXPECT(root.is_object());
+    EXPECT_EQ(root.size(), 9u);
+
+    EXPECT_EQ(root.get_deprecated_string("name"sv), "Form1");
+    EXPECT_EQ(root.get_bool("enabled"sv), true);
+    EXPECT_EQ(root.get_bool("visible"sv), false);
+    EXPECT(root.get("tooltip"sv)->is_null());
+    EXPECT_EQ(root.get_u32("x"sv), 155u);
+    EXPECT_EQ(root.get_i32("y"sv), -10);
+    EXPECT(!root.get_u32("y"sv).has_value());
+    EXPECT_EQ(root.get_double("opacity"sv), 0.5);
+    EXPECT_EQ(root.get_u64("big"sv), NumericLimits<u64>::max());
+    EXPECT(!root.get_u32("big"sv).has_value());
+    EXPECT(!root.get("missing"sv).has_value());
+    EXPECT(!root.get_array("name"sv).has_value());
+
+    auto widgets = root.get_array("widgets"sv).value();
+    EXPECT_EQ(widgets.size(), 4u);
+    Vector<StringView> raw_widgets;
+    widgets.for_each([&](JsonView widget) {
+        raw_widgets.append(widget.raw_value());
+        return IterationDecision::Continue;
+    });
+    EXPECT_EQ(raw_widgets.size(), 4u);
+    EXPECT_EQ(raw_widgets[0], R"({ "class": "GTextEditor" })"sv);
+    EXPECT_EQ(raw_widgets[1], "[]"sv);
+    EXPECT_EQ(raw_widgets[2], "{}"sv);
+    EXPECT_EQ(raw_widgets[3], "1"sv);
+}
+
+TEST_CASE(root_scalars)
+{
+    EXPECT_EQ(MUST(JsonDocument::parse("  42 "sv)).root().as_integer<int>(), 42);
+    EXPECT_EQ(MUST(JsonDocument::parse("\"hi\""sv)).root().as_deprecated_string(), "hi");
+    EXPECT(MUST(JsonDocument::parse("null"sv)).root().is_null());
+}
+
+TEST_CASE(escaped_strings)
+{
+    auto input = R"({"a\"b": "x\\", "c": "\"}A\n", "d\\\"": 1})"sv;
+    auto document = MUST(JsonDocument::parse(input));
+    auto root = document.root();
+    EXPECT_EQ(root.size(), 3u);
+    EXPECT_EQ(root.get_deprecated_string("a\"b"sv), "x\\");
+    EXPECT_EQ(root.get_deprecated_string("c"sv), "\"}A\n");
+    EXPECT_EQ(root.get("c"sv)->as_raw_string(), R"(\"}A\n)"sv);
+    EXPECT_EQ(root.get_u32("d\\\""sv), 1u);
+}
+
+TEST_CASE(values_across_blocks)
+{
+    // Put strings, escapes, and numbers across the 64-byte boundaries of the indexer.
+    for (size_t padding = 0; padding < 130; ++padding) {
+        StringBuilder builder;
+        builder.append('[');
+        builder.append_repeated(' ', padding);
+        builder.append(R"("\\\\\"\\", 12345678, "a,b]c", {"k": [true]}])"sv);
+        auto input = builder.to_deprecated_string();
+
+        auto document = MUST(JsonDocument::parse(input));
+        auto root = document.root();
+        EXPECT_EQ(root.size(), 4u);
+
+        Vector<JsonView> items;
+        root.for_each([&](JsonView item) {
+            items.append(item);
+            return IterationDecision::Continue;
+        });
+        EXPECT_EQ(items[0].as_deprecated_string(), "\\\\\"\\");
+        EXPECT_EQ(items[1].as_integer<u32>(), 12345678u);
+        EXPECT_EQ(items[2].as_raw_string(), "a,b]c"sv);
+        EXPECT_EQ(items[3].get_array("k"sv)->raw_value(), "[true]"sv);
+    }
+}
+
+TEST_CASE(matches_json_parser)
+{
+    StringBuilder builder;
+    builder.append('[');
+    for (int i = 0; i < 200; ++i) {
+        if (i != 0)
+            builder.append(',');
+        builder.appendff(R"({{"id": {}, "name": "item \"{}\"", "tags": ["a", "b{}"]}})", i, i, i);
+    }
+    builder.append(']');
+    auto input = builder.to_deprecated_string();
+
+    auto parsed = MUST(JsonValue::from_string(input)).as_array();
+    auto document = MUST(JsonDocument::parse(input));
+    EXPECT_EQ(document.root().size(), parsed.size());
+
+    size_t index = 0;
+    document.root().for_each([&](JsonView item) {
+        auto& object = parsed[index++].as_object();
+        EXPECT_EQ(item.get_u32("id"sv), object.get_u32("id"sv));
+        EXPECT_EQ(item.get_deprecated_string("name"sv), object.get_deprecated_string("name"sv));
+        EXPECT_EQ(item.get_array("tags"sv)->size(), 2u);
+        return IterationDecision::Continue;
+    });
+    EXPECT_EQ(index, parsed.size());
+}
+
+TEST_CASE(iteration_decision)
+{
+    auto document = MUST(JsonDocument::parse("[1, 2, 3, 4]"sv));
+    int sum = 0;
+    document.root().for_each([&](JsonView item) {
+        sum += item.as_integer<int>().value();
+        return sum >= 3 ? IterationDecision::Break : IterationDecision::Continue;
+    });
+    EXPECT_EQ(sum, 3);
+}
+
+TEST_CASE(invalid_documents)
+{
+    auto invalid = {
+        ""sv,
+        "   "sv,
+        "{"sv,
+        "]"sv,
+        "[1,]"sv,
+        "[1 2]"sv,
+        "[1,,2]"sv,
+        "{\"a\" 1}"sv,
+        "{\"a\": 1,}"sv,
+        "{1: 2}"sv,
+        "[}"sv,
+        "{]"sv,
+        "[] []"sv,
+        "\"unterminated"sv,
+        "[\"escaped quote\\\"]"sv,
+    };
+    for (auto input : invalid)
+        EXPECT(JsonDocument::parse(input).is_error());
+}
+
+TEST_CASE(stream_serializer)
+{
+    AllocatingMemoryStream stream;
+    {
+        StreamBuilder builder { stream };
+        auto object = MUST(JsonObjectSerializer<>::try_create(builder));
+        MUST(object.add("name"sv, "a \"quoted\" name"sv));
+        MUST(object.add("count"sv, 5000));
+        auto array = MUST(object.add_array("items"sv));
+        for (int i = 0; i < 5000; ++i)
+            MUST(array.add(i));
+        MUST(array.finish());
+        JsonObject nested;
+        nested.set("x", 1);
+        MUST(object.add("nested"sv, JsonValue(nested)));
+        MUST(object.finish());
+        MUST(builder.flush());
+    }
+
+    auto buffer = MUST(stream.read_until_eof());
+    auto document = MUST(JsonDocument::parse(StringView { buffer.bytes() }));
+    auto root = document.root();
+    EXPECT_EQ(root.get_deprecated_string("name"sv), "a \"quoted\" name");
+    EXPECT_EQ(root.get_array("items"sv)->size(), 5000u);
+    EXPECT_EQ(root.get_object("nested"sv)->get_i32("x"sv), 1);
+}
@@ -11,6 +11,7 @@
 #include <AK/StringView.h>
 #include <AK/Types.h>
 #include <AK/Utf16View.h>
+#include <AK/Utf8View.h>
 
 TEST_CASE(decode_ascii)
 {
@@ -50,6 +51,38 @@ TEST_CASE(decode_utf8)
     EXPECT_EQ(i, expected.size());
 }
 
+TEST_CASE(decode_mixed_ascii_runs)
+{
+    auto input = "A fairly long run of plain ASCII text, then ä, then 😀 and a bit more ASCII"sv;
+    auto string = MUST(AK::utf8_to_utf16(input));
+    Utf16View view { string };
+
+    Vector<u32> expected;
+    for (auto code_point : Utf8View { input })
+        expected.append(code_point);
+    EXPECT_EQ(view.length_in_code_points(), expected.size());
+    EXPECT_EQ(view.length_in_code_units(), expected.size() + 1);
+
+    size_t i = 0;
+    for (u32 code_point : view)
+        EXPECT_EQ(code_point, expected[i++]);
+    EXPECT_EQ(i, expected.size());
+}
+
+TEST_CASE(utf16_code_unit_length_from_utf8)
+{
+    auto test = [](StringView input) {
+        auto string = MUST(AK::utf8_to_utf16(input));
+        EXPECT_EQ(AK::utf16_code_unit_length_from_utf8(input), string.size());
+    };
+
+    test(""sv);
+    test("Hello World!11"sv);
+    test("Привет, мир! 😀 γειά σου κόσμος こんにちは世界"sv);
+    test("😀😀😀"sv);
+    test("invalid \xff\xfe bytes"sv);
+}
+
 TEST_CASE(encode_utf8)
 {
     {
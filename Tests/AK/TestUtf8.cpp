@@ -7,6 +7,7 @@
 #include <LibTest/TestCase.h>
 
 #include <AK/ByteBuffer.h>
+#include <AK/StringBuilder.h>
 #include <AK/Utf8View.h>
 
 TEST_CASE(decode_ascii)
@@ -82,6 +83,30 @@ TEST_CASE(validate_invalid_ut8)
     EXPECT(valid_bytes == 0);
 }
 
+TEST_CASE(validate_long_ascii_runs)
+{
+    // Put the non-ASCII byte at every position within and after the words that are checked at once.
+    for (size_t position = 0; position < 40; ++position) {
+        StringBuilder builder;
+        builder.append_repeated('a', position);
+        builder.append("é"sv);
+        builder.append_repeated('b', 40 - position);
+        auto string = builder.to_deprecated_string();
+
+        Utf8View utf8 { string };
+        size_t valid_bytes = 0;
+        EXPECT(utf8.validate(valid_bytes));
+        EXPECT_EQ(valid_bytes, string.length());
+        EXPECT_EQ(utf8.length(), 41u);
+        EXPECT_EQ(Utf8View::count_leading_ascii_bytes(string.bytes()), position);
+
+        string = builder.to_deprecated_string().substring(0, position + 1);
+        Utf8View truncated { string };
+        EXPECT(!truncated.validate(valid_bytes));
+        EXPECT_EQ(valid_bytes, position);
+    }
+}
+
 TEST_CASE(iterate_utf8)
 {
     Utf8View view("Some weird characters \u00A9\u266A\uA755"sv);
@@ -572,3 +572,69 @@ TEST_CASE(reverse_range_for_loop)
     for (auto item : v.in_reverse())
         EXPECT_EQ(item, index--);
 }
+
+struct RelocationCounter {
+    static inline size_t s_moves = 0;
+
+    explicit RelocationCounter(int value)
+        : value(value)
+    {
+    }
+    RelocationCounter(RelocationCounter&& other)
+        : value(exchange(other.value, 0))
+    {
+        ++s_moves;
+    }
+    ~RelocationCounter() { value = -1; }
+
+    int value { 0 };
+};
+
+template<>
+struct AK::Traits<RelocationCounter> : public GenericTraits<RelocationCounter> {
+    static constexpr bool is_trivially_relocatable() { return true; }
+};
+
+TEST_CASE(trivially_relocatable_types)
+{
+    static_assert(IsTriviallyRelocatable<int>);
+    static_assert(IsTriviallyRelocatable<OwnPtr<int>>);
+    static_assert(IsTriviallyRelocatable<NonnullOwnPtr<int>>);
+    static_assert(IsTriviallyRelocatable<DeprecatedString>);
+    static_assert(!IsTriviallyRelocatable<Vector<int, 4>>);
+
+    RelocationCounter::s_moves = 0;
+    Vector<RelocationCounter> v;
+    for (int i = 0; i < 1000; ++i)
+        v.empend(i);
+    v.insert(0, RelocationCounter { -2 });
+    v.remove(v.size() / 2);
+    v.remove(10, 5);
+
+    // Note: Only the insert() above needs to move any of the objects, everything else just copies them around.
+    EXPECT_EQ(RelocationCounter::s_moves, 1u);
+    EXPECT_EQ(v.size(), 995u);
+    EXPECT_EQ(v[0].value, -2);
+    EXPECT_EQ(v[9].value, 8);
+    EXPECT_EQ(v[10].value, 14);
+    EXPECT_EQ(v.last().value, 999);
+}
+
+TEST_CASE(relocate_inline_vector_of_strings)
+{
+    Vector<DeprecatedString, 4> v;
+    v.append("hello");
+    v.append("friends");
+
+    auto w = move(v);
+    EXPECT(v.is_empty());
+    EXPECT_EQ(w.size(), 2u);
+    EXPECT_EQ(w[0], "hello"sv);
+    EXPECT_EQ(w[1], "friends"sv);
+
+    for (int i = 0; i < 10; ++i)
+        w.prepend(DeprecatedString::number(i));
+    EXPECT_EQ(w.size(), 12u);
+    EXPECT_EQ(w.first(), "9"sv);
+    EXPECT_EQ(w.last(), "friends"sv);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/DeprecatedString.h>
+#include <AK/HashMap.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/JsonValue.h>
+#include <AK/StringBuilder.h>
+
+BENCHMARK_CASE_WITH_PARAMETERS(hash_map_insert, count, 1'000, 100'000)
+{
+    HashMap<u32, u32> map;
+    for (u32 i = 0; i < count; ++i)
+        map.set(i * 2654435761u, i);
+    Test::do_not_optimize(map);
+}
+
+BENCHMARK_CASE_WITH_PARAMETERS(hash_map_lookup, count, 1'000, 100'000)
+{
+    HashMap<u32, u32> map;
+    for (u32 i = 0; i < count; ++i)
+        map.set(i * 2654435761u, i);
+
+    u32 found = 0;
+    for (size_t run = 0; run < 10; ++run) {
+        for (u32 i = 0; i < count * 2; ++i)
+            found += map.get(i * 2654435761u).value_or(0);
+    }
+    Test::do_not_optimize(found);
+}
+
+BENCHMARK_CASE(hash_map_string_keys)
+{
+    Vector<DeprecatedString> keys;
+    for (size_t i = 0; i < 10'000; ++i)
+        keys.append(DeprecatedString::formatted("key-{}", i));
+
+    HashMap<DeprecatedString, size_t> map;
+    for (size_t i = 0; i < keys.size(); ++i)
+        map.set(keys[i], i);
+
+    size_t sum = 0;
+    for (auto const& key : keys)
+        sum += map.get(key).value();
+    Test::do_not_optimize(sum);
+}
+
+BENCHMARK_CASE(string_builder_append)
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < 100'000; ++i) {
+        builder.append("Well hello friends"sv);
+        builder.append(' ');
+    }
+    auto string = builder.to_deprecated_string();
+    Test::do_not_optimize(string);
+}
+
+BENCHMARK_CASE(string_builder_appendff)
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < 100'000; ++i)
+        builder.appendff("{}: {:x} {:.2}\n", i, i * 31, static_cast<double>(i) / 7);
+    auto string = builder.to_deprecated_string();
+    Test::do_not_optimize(string);
+}
+
+static DeprecatedString make_json_document()
+{
+    JsonArray array;
+    for (size_t i = 0; i < 5'000; ++i) {
+        JsonObject object;
+        object.set("id", i);
+        object.set("name", DeprecatedString::formatted("Object number {}", i));
+        object.set("ratio", static_cast<double>(i) / 3);
+        object.set("enabled", i % 2 == 0);
+        JsonArray tags;
+        tags.append("one");
+        tags.append("two");
+        tags.append("three");
+        object.set("tags", move(tags));
+        array.append(move(object));
+    }
+    return array.to_deprecated_string();
+}
+
+BENCHMARK_CASE(json_parse)
+{
+    static auto document = make_json_document();
+    auto value = MUST(JsonValue::from_string(document));
+    EXPECT_EQ(value.as_array().size(), 5'000u);
+}
+
+BENCHMARK_CASE(json_serialize)
+{
+    static auto value = MUST(JsonValue::from_string(make_json_document()));
+    auto string = value.to_deprecated_string();
+    Test::do_not_optimize(string);
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/ByteBuffer.h>
+#include <AK/StringBuilder.h>
+#include <LibCompress/Deflate.h>
+
+// Text-like input that compresses reasonably well, but not trivially.
+static ByteBuffer const& input()
+{
+    static ByteBuffer buffer = [] {
+        StringBuilder builder;
+        u32 state = 1;
+        for (size_t i = 0; i < 100'000; ++i) {
+            state = state * 1103515245 + 12345;
+            builder.appendff("line {} has value {}\n", i, (state >> 16) % 1000);
+        }
+        return builder.to_byte_buffer();
+    }();
+    return buffer;
+}
+
+BENCHMARK_CASE(deflate_compress_fast)
+{
+    auto compressed = MUST(Compress::DeflateCompressor::compress_all(input(), Compress::DeflateCompressor::CompressionLevel::FAST));
+    Test::do_not_optimize(compressed);
+}
+
+BENCHMARK_CASE(deflate_compress_good)
+{
+    auto compressed = MUST(Compress::DeflateCompressor::compress_all(input(), Compress::DeflateCompressor::CompressionLevel::GOOD));
+    Test::do_not_optimize(compressed);
+}
+
+BENCHMARK_CASE(deflate_decompress)
+{
+    static auto compressed = MUST(Compress::DeflateCompressor::compress_all(input()));
+    auto decompressed = MUST(Compress::DeflateDecompressor::decompress_all(compressed));
+    EXPECT_EQ(decompressed.size(), input().size());
+}
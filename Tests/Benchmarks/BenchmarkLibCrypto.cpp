@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/ByteBuffer.h>
+#include <LibCrypto/Cipher/AES.h>
+#include <LibCrypto/Hash/SHA2.h>
+
+static constexpr size_t input_size = 1 * MiB;
+
+static ReadonlyBytes operator""_b(char const* string, size_t length)
+{
+    return ReadonlyBytes(string, length);
+}
+
+static ByteBuffer const& input()
+{
+    static ByteBuffer buffer = [] {
+        auto buffer = MUST(ByteBuffer::create_uninitialized(input_size));
+        for (size_t i = 0; i < input_size; ++i)
+            buffer[i] = static_cast<u8>(i * 7 + (i >> 8));
+        return buffer;
+    }();
+    return buffer;
+}
+
+BENCHMARK_CASE(sha256)
+{
+    auto digest = Crypto::Hash::SHA256::hash(input());
+    Test::do_not_optimize(digest);
+}
+
+BENCHMARK_CASE(sha512)
+{
+    auto digest = Crypto::Hash::SHA512::hash(input());
+    Test::do_not_optimize(digest);
+}
+
+BENCHMARK_CASE(aes_gcm_128_encrypt)
+{
+    Crypto::Cipher::AESCipher::GCMMode cipher("\xfe\xff\xe9\x92\x86\x65\x73\x1c\x6d\x6a\x8f\x94\x67\x30\x83\x08"_b, 128, Crypto::Cipher::Intent::Encryption);
+    auto out = MUST(ByteBuffer::create_uninitialized(input_size));
+    auto tag = MUST(ByteBuffer::create_uninitialized(16));
+    cipher.encrypt(input(), out.bytes(), "\xca\xfe\xba\xbe\xfa\xce\xdb\xad\xde\xca\xf8\x88\x00\x00\x00\x00"_b, {}, tag);
+    Test::do_not_optimize(out);
+}
+
+BENCHMARK_CASE(aes_gcm_256_encrypt)
+{
+    Crypto::Cipher::AESCipher::GCMMode cipher("\xfe\xff\xe9\x92\x86\x65\x73\x1c\x6d\x6a\x8f\x94\x67\x30\x83\x08\xfe\xff\xe9\x92\x86\x65\x73\x1c\x6d\x6a\x8f\x94\x67\x30\x83\x08"_b, 256, Crypto::Cipher::Intent::Encryption);
+    auto out = MUST(ByteBuffer::create_uninitialized(input_size));
+    auto tag = MUST(ByteBuffer::create_uninitialized(16));
+    cipher.encrypt(input(), out.bytes(), "\xca\xfe\xba\xbe\xfa\xce\xdb\xad\xde\xca\xf8\x88\x00\x00\x00\x00"_b, {}, tag);
+    Test::do_not_optimize(out);
+}
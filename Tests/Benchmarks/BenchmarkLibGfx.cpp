@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibCore/MappedFile.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/JPGLoader.h>
+#include <LibGfx/PNGLoader.h>
+#include <LibGfx/Painter.h>
+
+#ifdef AK_OS_SERENITY
+#    define TEST_INPUT(x) ("/usr/Tests/LibGfx/test-inputs/" x)
+#else
+#    define TEST_INPUT(x) ("../LibGfx/test-inputs/" x)
+#endif
+
+static NonnullRefPtr<Gfx::Bitmap> make_source_bitmap(Gfx::BitmapFormat format)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(format, { 512, 512 }));
+    for (int y = 0; y < bitmap->height(); ++y) {
+        for (int x = 0; x < bitmap->width(); ++x)
+            bitmap->set_pixel(x, y, Color(x & 0xff, y & 0xff, (x ^ y) & 0xff, (x + y) & 0xff));
+    }
+    return bitmap;
+}
+
+BENCHMARK_CASE(blit_opaque)
+{
+    static auto source = make_source_bitmap(Gfx::BitmapFormat::BGRx8888);
+    auto target = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { 1024, 1024 }));
+    Gfx::Painter painter(target);
+    for (int run = 0; run < 10; ++run) {
+        for (int y = 0; y < 1024; y += 256) {
+            for (int x = 0; x < 1024; x += 256)
+                painter.blit({ x, y }, source, source->rect());
+        }
+    }
+}
+
+BENCHMARK_CASE(blit_with_alpha)
+{
+    static auto source = make_source_bitmap(Gfx::BitmapFormat::BGRA8888);
+    auto target = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { 1024, 1024 }));
+    Gfx::Painter painter(target);
+    for (int run = 0; run < 10; ++run) {
+        for (int y = 0; y < 1024; y += 256) {
+            for (int x = 0; x < 1024; x += 256)
+                painter.blit({ x, y }, source, source->rect());
+        }
+    }
+}
+
+BENCHMARK_CASE(blit_with_opacity)
+{
+    static auto source = make_source_bitmap(Gfx::BitmapFormat::BGRx8888);
+    auto target = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { 1024, 1024 }));
+    Gfx::Painter painter(target);
+    for (int y = 0; y < 1024; y += 256) {
+        for (int x = 0; x < 1024; x += 256)
+            painter.blit({ x, y }, source, source->rect(), 0.5f);
+    }
+}
+
+BENCHMARK_CASE(decode_png)
+{
+    static auto file = MUST(Core::MappedFile::map(TEST_INPUT("buggie.png"sv)));
+    for (int run = 0; run < 10; ++run) {
+        auto decoder = MUST(Gfx::PNGImageDecoderPlugin::create(file->bytes()));
+        EXPECT(!decoder->frame(0).is_error());
+    }
+}
+
+BENCHMARK_CASE(decode_png_interlaced)
+{
+    static auto file = MUST(Core::MappedFile::map(TEST_INPUT("interlaced.png"sv)));
+    for (int run = 0; run < 10; ++run) {
+        auto decoder = MUST(Gfx::PNGImageDecoderPlugin::create(file->bytes()));
+        EXPECT(!decoder->frame(0).is_error());
+    }
+}
+
+BENCHMARK_CASE(decode_jpeg)
+{
+    static auto file = MUST(Core::MappedFile::map(TEST_INPUT("rgb24.jpg"sv)));
+    for (int run = 0; run < 10; ++run) {
+        auto decoder = MUST(Gfx::JPGImageDecoderPlugin::create(file->bytes()));
+        EXPECT(!decoder->frame(0).is_error());
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/VM.h>
+#include <LibJS/Script.h>
+
+// Parses, compiles and optimizes the script once per run, but most of the time should go into executing it.
+static void run_bytecode(StringView source)
+{
+    auto vm = JS::VM::create();
+    auto ast_interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+
+    auto script_or_error = JS::Script::parse(source, ast_interpreter->realm());
+    VERIFY(!script_or_error.is_error());
+    auto script = script_or_error.release_value();
+    auto executable = MUST(JS::Bytecode::Generator::generate(script->parse_node()));
+    JS::Bytecode::Interpreter::optimization_pipeline().perform(*executable);
+
+    JS::Bytecode::Interpreter bytecode_interpreter(ast_interpreter->realm());
+    auto result = bytecode_interpreter.run(*executable);
+    EXPECT(!result.is_error());
+}
+
+BENCHMARK_CASE(js_fibonacci)
+{
+    run_bytecode(R"(
+        function fib(n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); }
+        if (fib(22) !== 17711)
+            throw new Error("wrong result");
+    )"sv);
+}
+
+BENCHMARK_CASE(js_numeric_loop)
+{
+    run_bytecode(R"(
+        let sum = 0;
+        for (let i = 0; i < 1000000; ++i)
+            sum = (sum + i * 3) % 65521;
+    )"sv);
+}
+
+BENCHMARK_CASE(js_property_access)
+{
+    run_bytecode(R"(
+        const points = [];
+        for (let i = 0; i < 10000; ++i)
+            points.push({ x: i, y: i * 2 });
+        let total = 0;
+        for (let run = 0; run < 20; ++run) {
+            for (const point of points)
+                total += point.x + point.y;
+        }
+    )"sv);
+}
+
+BENCHMARK_CASE(js_string_building)
+{
+    run_bytecode(R"(
+        let s = "";
+        for (let i = 0; i < 20000; ++i)
+            s += i.toString(16);
+        if (s.length === 0)
+            throw new Error("empty string");
+    )"sv);
+}
+
+BENCHMARK_CASE(js_array_sort)
+{
+    run_bytecode(R"(
+        const values = [];
+        let state = 1;
+        for (let i = 0; i < 20000; ++i) {
+            state = (state * 1103515245 + 12345) % 2147483648;
+            values.push(state);
+        }
+        values.sort((a, b) => a - b);
+    )"sv);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/StringBuilder.h>
+#include <LibRegex/Regex.h>
+
+static DeprecatedString const& haystack()
+{
+    static DeprecatedString text = [] {
+        StringBuilder builder;
+        for (size_t i = 0; i < 10'000; ++i)
+            builder.appendff("{} user{}@example.com visited /path/to/page{}.html?id={}\n", i, i % 97, i % 13, i * 7);
+        return builder.to_deprecated_string();
+    }();
+    return text;
+}
+
+BENCHMARK_CASE(regex_ecma262_literal_search)
+{
+    Regex<ECMA262> re("page12\\.html", ECMAScriptFlags::Global);
+    auto result = re.match(haystack());
+    EXPECT(result.success);
+}
+
+BENCHMARK_CASE(regex_ecma262_email_search)
+{
+    Regex<ECMA262> re("[a-z0-9]+@[a-z]+\\.[a-z]{2,}", ECMAScriptFlags::Global);
+    auto result = re.match(haystack());
+    EXPECT_EQ(result.count, 10'000u);
+}
+
+BENCHMARK_CASE(regex_ecma262_captures_per_line)
+{
+    Regex<ECMA262> re("^(\\d+) (\\w+)@[^ ]+ visited (\\S+)$", ECMAScriptFlags::Multiline | ECMAScriptFlags::Global);
+    auto result = re.match(haystack());
+    EXPECT_EQ(result.count, 10'000u);
+}
+
+BENCHMARK_CASE(regex_posix_extended_match_lines)
+{
+    Regex<PosixExtended> re("^[0-9]+ user[0-9]+@example\\.com visited .*$");
+    size_t matches = 0;
+    for (auto line : haystack().split_view('\n')) {
+        if (re.match(line).success)
+            ++matches;
+    }
+    EXPECT_EQ(matches, 10'000u);
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Math.h>
+#include <AK/Vector.h>
+#include <LibAudio/Resampler.h>
+#include <LibTest/TestCase.h>
+
+static Vector<Audio::Sample> sine(u32 sample_rate, float frequency, size_t count)
+{
+    Vector<Audio::Sample> samples;
+    for (size_t i = 0; i < count; ++i) {
+        auto value = 0.5f * AK::sin(2 * AK::Pi<float> * frequency * i / sample_rate);
+        samples.append({ value, 0.25f });
+    }
+    return samples;
+}
+
+TEST_CASE(resample_sine)
+{
+    for (auto quality : { Audio::ResamplingQuality::Low, Audio::ResamplingQuality::Medium, Audio::ResamplingQuality::High }) {
+        Audio::ResampleHelper<Audio::Sample> resampler(44100, 48000, quality);
+        auto resampled = resampler.resample(sine(44100, 1000, 44100));
+        EXPECT(resampled.size() > 47900 && resampled.size() <= 48000);
+
+        // Output sample n lies at n * 44100 / 48000 in the input, beyond the edges where the filter runs into silence.
+        for (size_t i = 100; i < resampled.size() - 100; ++i) {
+            auto expected = 0.5 * AK::sin(2 * AK::Pi<double> * 1000 * (i * 44100.0 / 48000) / 44100);
+            EXPECT(AK::fabs(resampled[i].left - expected) < 0.001);
+            EXPECT(AK::fabs(resampled[i].right - 0.25) < 0.001);
+        }
+    }
+}
+
+TEST_CASE(resample_in_blocks)
+{
+    auto input = sine(48000, 440, 10000);
+
+    Audio::ResampleHelper<Audio::Sample> resampler(48000, 22050);
+    auto resampled = resampler.resample(input);
+
+    Audio::ResampleHelper<Audio::Sample> block_resampler(48000, 22050);
+    Vector<Audio::Sample> block_resampled;
+    for (size_t start = 0; start < input.size(); start += 777) {
+        Vector<Audio::Sample> block;
+        block.append(input.data() + start, min<size_t>(777, input.size() - start));
+        MUST(block_resampler.try_resample_into_end(block_resampled, block));
+    }
+
+    EXPECT_EQ(block_resampled.size(), resampled.size());
+    for (size_t i = 0; i < resampled.size(); ++i)
+        EXPECT_EQ(block_resampled[i].left, resampled[i].left);
+}
+
+TEST_CASE(resample_integers)
+{
+    Vector<i32> input;
+    input.resize(4800);
+    input.span().fill(1000);
+
+    Audio::ResampleHelper<i32> resampler(48000, 44100);
+    auto resampled = resampler.resample(input);
+    for (size_t i = 100; i < resampled.size(); ++i)
+        EXPECT_EQ(resampled[i], 1000);
+}
+
+TEST_CASE(same_rate_is_unchanged)
+{
+    auto input = sine(44100, 1000, 1000);
+    Audio::ResampleHelper<Audio::Sample> resampler(44100, 44100);
+    auto resampled = resampler.resample(input);
+    EXPECT_EQ(resampled.size(), input.size());
+    for (size_t i = 0; i < input.size(); ++i)
+        EXPECT_EQ(resampled[i].left, input[i].left);
+}
@@ -29,3 +29,47 @@ TEST_CASE(strtok_r_delimiters_only)
     // The string to which `saved_str` initially points to shouldn't be modified.
     EXPECT_EQ(strcmp(dummy, "a;"), 0);
 }
+
+TEST_CASE(string_scanning_at_all_alignments)
+{
+    char buffer[128];
+    for (size_t offset = 0; offset < 32; ++offset) {
+        for (size_t length = 0; length < 80; ++length) {
+            char* str = buffer + offset;
+            memset(buffer, 'x', sizeof(buffer));
+            str[length] = '\0';
+
+            EXPECT_EQ(strlen(str), length);
+            EXPECT_EQ(strnlen(str, length / 2), length / 2);
+            EXPECT_EQ(strnlen(str, SIZE_MAX), length);
+            EXPECT_EQ(strchr(str, 'x'), length ? str : nullptr);
+            EXPECT_EQ(strchr(str, '\0'), str + length);
+            EXPECT_EQ(memchr(str, '\0', length), nullptr);
+            EXPECT_EQ(memchr(str, '\0', length + 1), str + length);
+            EXPECT_EQ(memchr(str, '\0', SIZE_MAX), str + length);
+        }
+    }
+}
+
+TEST_CASE(memcmp_and_memcpy_at_all_alignments)
+{
+    u8 source[128];
+    u8 destination[128];
+    for (size_t i = 0; i < sizeof(source); ++i)
+        source[i] = i % 100;
+
+    for (size_t offset = 0; offset < 16; ++offset) {
+        for (size_t length = 0; length < 100; ++length) {
+            memset(destination, 0, sizeof(destination));
+            EXPECT_EQ(memcpy(destination + offset, source, length), destination + offset);
+            EXPECT_EQ(memcmp(destination + offset, source, length), 0);
+            EXPECT_EQ(destination[offset + length], 0);
+            if (length == 0)
+                continue;
+
+            destination[offset + length - 1]++;
+            EXPECT(memcmp(destination + offset, source, length) > 0);
+            EXPECT(memcmp(source, destination + offset, length) < 0);
+        }
+    }
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+static constexpr size_t thread_count = 8;
+
+TEST_CASE(cond_broadcast_wakes_all_waiters)
+{
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+    struct Context {
+        pthread_mutex_t* mutex;
+        pthread_cond_t* cond;
+        bool go { false };
+        size_t waiting { 0 };
+        size_t woken { 0 };
+    } context { &mutex, &cond };
+
+    pthread_t threads[thread_count];
+    for (auto& thread : threads) {
+        auto result = pthread_create(
+            &thread, nullptr, [](void* argument) -> void* {
+                auto& context = *static_cast<Context*>(argument);
+                pthread_mutex_lock(context.mutex);
+                ++context.waiting;
+                while (!context.go)
+                    pthread_cond_wait(context.cond, context.mutex);
+                ++context.woken;
+                pthread_mutex_unlock(context.mutex);
+                return nullptr;
+            },
+            &context);
+        EXPECT_EQ(result, 0);
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&mutex);
+        bool everyone_is_waiting = context.waiting == thread_count;
+        if (everyone_is_waiting) {
+            context.go = true;
+            pthread_cond_broadcast(&cond);
+        }
+        pthread_mutex_unlock(&mutex);
+        if (everyone_is_waiting)
+            break;
+        usleep(1000);
+    }
+
+    for (auto& thread : threads)
+        EXPECT_EQ(pthread_join(thread, nullptr), 0);
+    EXPECT_EQ(context.woken, thread_count);
+}
+
+TEST_CASE(mutexattr_protocol)
+{
+    pthread_mutexattr_t attributes;
+    EXPECT_EQ(pthread_mutexattr_init(&attributes), 0);
+    int protocol = -1;
+    EXPECT_EQ(pthread_mutexattr_getprotocol(&attributes, &protocol), 0);
+    EXPECT_EQ(protocol, PTHREAD_PRIO_NONE);
+    EXPECT_EQ(pthread_mutexattr_setprotocol(&attributes, PTHREAD_PRIO_INHERIT), 0);
+    EXPECT_EQ(pthread_mutexattr_getprotocol(&attributes, &protocol), 0);
+    EXPECT_EQ(protocol, PTHREAD_PRIO_INHERIT);
+    EXPECT_EQ(pthread_mutexattr_setprotocol(&attributes, PTHREAD_PRIO_PROTECT), ENOTSUP);
+    EXPECT_EQ(pthread_mutexattr_setprotocol(&attributes, 1234), EINVAL);
+    EXPECT_EQ(pthread_mutexattr_destroy(&attributes), 0);
+}
+
+TEST_CASE(priority_inheriting_mutex)
+{
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_setprotocol(&attributes, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_t mutex;
+    EXPECT_EQ(pthread_mutex_init(&mutex, &attributes), 0);
+
+    EXPECT_EQ(pthread_mutex_lock(&mutex), 0);
+    EXPECT_EQ(pthread_mutex_lock(&mutex), EDEADLK);
+    EXPECT_EQ(pthread_mutex_unlock(&mutex), 0);
+
+    struct Context {
+        pthread_mutex_t* mutex;
+        size_t counter { 0 };
+    } context { &mutex };
+
+    pthread_t threads[thread_count];
+    for (auto& thread : threads) {
+        auto result = pthread_create(
+            &thread, nullptr, [](void* argument) -> void* {
+                auto& context = *static_cast<Context*>(argument);
+                for (size_t i = 0; i < 1000; ++i) {
+                    pthread_mutex_lock(context.mutex);
+                    auto counter = context.counter;
+                    if (i % 100 == 0)
+                        sched_yield();
+                    context.counter = counter + 1;
+                    pthread_mutex_unlock(context.mutex);
+                }
+                return nullptr;
+            },
+            &context);
+        EXPECT_EQ(result, 0);
+    }
+
+    for (auto& thread : threads)
+        EXPECT_EQ(pthread_join(thread, nullptr), 0);
+    EXPECT_EQ(context.counter, thread_count * 1000);
+    EXPECT_EQ(pthread_mutex_trylock(&mutex), 0);
+    EXPECT_EQ(pthread_mutex_unlock(&mutex), 0);
+}
+
+TEST_CASE(adaptive_mutex)
+{
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    EXPECT_EQ(pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_ADAPTIVE_NP), 0);
+    int type = -1;
+    EXPECT_EQ(pthread_mutexattr_gettype(&attributes, &type), 0);
+    EXPECT_EQ(type, PTHREAD_MUTEX_ADAPTIVE_NP);
+    pthread_mutex_t mutex;
+    EXPECT_EQ(pthread_mutex_init(&mutex, &attributes), 0);
+
+    struct Context {
+        pthread_mutex_t* mutex;
+        size_t counter { 0 };
+    } context { &mutex };
+
+    pthread_t threads[thread_count];
+    for (auto& thread : threads) {
+        auto result = pthread_create(
+            &thread, nullptr, [](void* argument) -> void* {
+                auto& context = *static_cast<Context*>(argument);
+                for (size_t i = 0; i < 10000; ++i) {
+                    pthread_mutex_lock(context.mutex);
+                    ++context.counter;
+                    pthread_mutex_unlock(context.mutex);
+                }
+                return nullptr;
+            },
+            &context);
+        EXPECT_EQ(result, 0);
+    }
+
+    for (auto& thread : threads)
+        EXPECT_EQ(pthread_join(thread, nullptr), 0);
+    EXPECT_EQ(context.counter, thread_count * 10000);
+    EXPECT_EQ(pthread_mutex_trylock(&mutex), 0);
+    EXPECT_EQ(pthread_mutex_trylock(&mutex), EBUSY);
+    EXPECT_EQ(pthread_mutex_unlock(&mutex), 0);
+}
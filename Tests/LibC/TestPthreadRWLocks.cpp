@@ -5,7 +5,9 @@
  */
 
 #include <LibTest/TestCase.h>
+#include <errno.h>
 #include <pthread.h>
+#include <time.h>
 
 TEST_CASE(rwlock_init)
 {
@@ -88,3 +90,85 @@ TEST_CASE(rwlock_wrlock_init_in_once)
     result = pthread_rwlock_unlock(&lock);
     EXPECT_EQ(0, result);
 }
+
+TEST_CASE(rwlock_try_and_timed_locks)
+{
+    pthread_rwlock_t lock;
+    EXPECT_EQ(pthread_rwlock_init(&lock, nullptr), 0);
+
+    EXPECT_EQ(pthread_rwlock_rdlock(&lock), 0);
+    EXPECT_EQ(pthread_rwlock_tryrdlock(&lock), 0);
+    EXPECT_EQ(pthread_rwlock_trywrlock(&lock), EBUSY);
+    EXPECT_EQ(pthread_rwlock_unlock(&lock), 0);
+    EXPECT_EQ(pthread_rwlock_unlock(&lock), 0);
+    EXPECT_EQ(pthread_rwlock_unlock(&lock), EPERM);
+
+    EXPECT_EQ(pthread_rwlock_trywrlock(&lock), 0);
+    EXPECT_EQ(pthread_rwlock_tryrdlock(&lock), EBUSY);
+
+    pthread_t thread;
+    pthread_create(
+        &thread, nullptr, [](void* argument) -> void* {
+            auto* lock = static_cast<pthread_rwlock_t*>(argument);
+            timespec timeout;
+            clock_gettime(CLOCK_REALTIME, &timeout);
+            timeout.tv_nsec += 10'000'000;
+            if (timeout.tv_nsec >= 1'000'000'000) {
+                timeout.tv_sec++;
+                timeout.tv_nsec -= 1'000'000'000;
+            }
+            EXPECT_EQ(pthread_rwlock_timedrdlock(lock, &timeout), ETIMEDOUT);
+            EXPECT_EQ(pthread_rwlock_timedwrlock(lock, &timeout), ETIMEDOUT);
+            EXPECT_EQ(pthread_rwlock_unlock(lock), EPERM);
+            return nullptr;
+        },
+        &lock);
+    EXPECT_EQ(pthread_join(thread, nullptr), 0);
+
+    EXPECT_EQ(pthread_rwlock_unlock(&lock), 0);
+}
+
+TEST_CASE(rwlock_readers_and_writers)
+{
+    static constexpr size_t thread_count = 8;
+    static constexpr size_t iterations = 10000;
+
+    struct Context {
+        pthread_rwlock_t lock;
+        size_t first { 0 };
+        size_t second { 0 };
+        bool saw_torn_write { false };
+    } context;
+    EXPECT_EQ(pthread_rwlock_init(&context.lock, nullptr), 0);
+
+    pthread_t threads[thread_count];
+    for (size_t i = 0; i < thread_count; ++i) {
+        auto* writer = +[](void* argument) -> void* {
+            auto& context = *static_cast<Context*>(argument);
+            for (size_t i = 0; i < iterations; ++i) {
+                pthread_rwlock_wrlock(&context.lock);
+                ++context.first;
+                ++context.second;
+                pthread_rwlock_unlock(&context.lock);
+            }
+            return nullptr;
+        };
+        auto* reader = +[](void* argument) -> void* {
+            auto& context = *static_cast<Context*>(argument);
+            for (size_t i = 0; i < iterations; ++i) {
+                pthread_rwlock_rdlock(&context.lock);
+                if (context.first != context.second)
+                    context.saw_torn_write = true;
+                pthread_rwlock_unlock(&context.lock);
+            }
+            return nullptr;
+        };
+        EXPECT_EQ(pthread_create(&threads[i], nullptr, i % 2 ? reader : writer, &context), 0);
+    }
+
+    for (auto& thread : threads)
+        EXPECT_EQ(pthread_join(thread, nullptr), 0);
+    EXPECT(!context.saw_torn_write);
+    EXPECT_EQ(context.first, thread_count / 2 * iterations);
+    EXPECT_EQ(context.second, thread_count / 2 * iterations);
+}
@@ -6,6 +6,9 @@
 
 #include <LibTest/TestCase.h>
 
+#include <AK/MemoryStream.h>
+#include <AK/Random.h>
+#include <AK/StringBuilder.h>
 #include <LibCompress/Brotli.h>
 #include <LibCore/Stream.h>
 
@@ -120,3 +123,52 @@ TEST_CASE(brotli_decompress_zero_one_bin)
     EXPECT(bytes_read == 32 * MiB);
     EXPECT(brotli_stream.is_eof());
 }
+
+static ByteBuffer brotli_decompress_all(ReadonlyBytes compressed)
+{
+    auto memory_stream = MUST(FixedMemoryStream::construct(compressed));
+    auto brotli_stream = Compress::BrotliDecompressionStream { *memory_stream };
+    return MUST(brotli_stream.read_until_eof());
+}
+
+TEST_CASE(brotli_round_trip_empty)
+{
+    auto compressed = MUST(Compress::BrotliCompressionStream::compress_all({}));
+    EXPECT(brotli_decompress_all(compressed).is_empty());
+}
+
+TEST_CASE(brotli_round_trip_random)
+{
+    auto original = ByteBuffer::create_uninitialized(4096).release_value();
+    fill_with_random(original.data(), original.size());
+
+    auto compressed = MUST(Compress::BrotliCompressionStream::compress_all(original));
+    EXPECT(brotli_decompress_all(compressed) == original);
+}
+
+TEST_CASE(brotli_round_trip_large)
+{
+    // Larger than a meta-block and made up of repeated chunks, so that matches reach back into the previous one.
+    auto size = Compress::BrotliCompressionStream::block_size * 3 + 123;
+    auto original = ByteBuffer::create_uninitialized(size).release_value();
+    size_t chunk_size = 10000;
+    fill_with_random(original.data(), chunk_size);
+    for (size_t offset = chunk_size; offset < size; offset += chunk_size)
+        memcpy(original.data() + offset, original.data(), min(chunk_size, size - offset));
+
+    auto compressed = MUST(Compress::BrotliCompressionStream::compress_all(original));
+    EXPECT(compressed.size() < size / 10);
+    EXPECT(brotli_decompress_all(compressed) == original);
+}
+
+TEST_CASE(brotli_round_trip_text)
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < 1000; ++i)
+        builder.appendff("Line {}: The quick brown fox jumps over the lazy dog.\n", i);
+    auto original = builder.string_view().bytes();
+
+    auto compressed = MUST(Compress::BrotliCompressionStream::compress_all(original));
+    EXPECT(compressed.size() < original.size() / 4);
+    EXPECT(brotli_decompress_all(compressed).bytes() == original);
+}
@@ -155,3 +155,24 @@ TEST_CASE(deflate_compress_literals)
     auto compressed = Compress::DeflateCompressor::compress_all(test, Compress::DeflateCompressor::CompressionLevel::GOOD);
     EXPECT(!compressed.is_error());
 }
+
+TEST_CASE(deflate_round_trip_compress_thread_pool)
+{
+    auto size = Compress::DeflateCompressor::block_size * 5 + 123;
+    auto original = ByteBuffer::create_uninitialized(size).release_value();
+    // Repeat a random chunk that straddles the block boundaries, so that back references reach into the previous block.
+    auto chunk_size = Compress::DeflateCompressor::block_size / 3;
+    fill_with_random(original.data(), chunk_size);
+    for (size_t offset = chunk_size; offset < size; offset += chunk_size)
+        memcpy(original.data() + offset, original.data(), min(chunk_size, size - offset));
+
+    auto compressed = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::GOOD);
+    EXPECT(!compressed.is_error());
+    auto compressed_in_parallel = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::GOOD, Compress::DeflateCompressor::UseThreadPool::Yes);
+    EXPECT(!compressed_in_parallel.is_error());
+    EXPECT(compressed_in_parallel.value() == compressed.value());
+
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed_in_parallel.value());
+    EXPECT(!uncompressed.is_error());
+    EXPECT(uncompressed.value() == original);
+}
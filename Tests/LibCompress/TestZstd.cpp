@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Array.h>
+#include <AK/MemoryStream.h>
+#include <AK/Random.h>
+#include <AK/StringBuilder.h>
+#include <LibCompress/Zstd.h>
+
+TEST_CASE(zstd_decompress_raw_block)
+{
+    Array<u8, 23> const compressed {
+        0x28, 0xb5, 0x2f, 0xfd, 0x20, 0x0e, 0x71, 0x00, 0x00, 0x48, 0x65, 0x6c,
+        0x6c, 0x6f, 0x2c, 0x20, 0x57, 0x6f, 0x72, 0x6c, 0x64, 0x21, 0x0a
+    };
+
+    auto const uncompressed = "Hello, World!\n"sv;
+
+    EXPECT(Compress::ZstdDecompressor::is_likely_compressed(compressed));
+    auto decompressed = Compress::ZstdDecompressor::decompress_all(compressed);
+    EXPECT(decompressed.value().bytes() == uncompressed.bytes());
+}
+
+TEST_CASE(zstd_decompress_compressed_block)
+{
+    // Huffman coded literals and FSE coded sequences, followed by a checksum.
+    Array<u8, 181> const compressed {
+        0x28, 0xb5, 0x2f, 0xfd, 0x64, 0x2a, 0x00, 0x3d, 0x05, 0x00, 0xe2, 0x8c,
+        0x20, 0x15, 0xb0, 0xa9, 0x03, 0x60, 0x6b, 0x69, 0x3d, 0x11, 0x27, 0x4c,
+        0xee, 0x66, 0xea, 0xf6, 0xe4, 0x4d, 0x6e, 0x2a, 0x53, 0x02, 0x11, 0xc2,
+        0xad, 0x57, 0x49, 0x41, 0xf5, 0x02, 0xa7, 0x06, 0xd6, 0xa9, 0xa4, 0xf5,
+        0x47, 0x31, 0xb7, 0x9e, 0x35, 0x0f, 0xed, 0x27, 0x97, 0x97, 0x43, 0xd4,
+        0x85, 0x4d, 0x2f, 0xe5, 0xc8, 0x92, 0xe2, 0xdd, 0x7a, 0x85, 0x28, 0x90,
+        0xce, 0x8a, 0xe3, 0x75, 0x20, 0xe2, 0xcf, 0x5a, 0x38, 0xb1, 0x93, 0x16,
+        0x47, 0xd5, 0x2a, 0x6b, 0x64, 0xcc, 0xbb, 0xb0, 0x46, 0x87, 0x0d, 0xb0,
+        0x50, 0xc7, 0x6b, 0x3a, 0x5b, 0x8e, 0xba, 0x53, 0xe0, 0xb8, 0x43, 0xd4,
+        0xea, 0x3d, 0xec, 0xf2, 0xd3, 0xb2, 0xcb, 0xaa, 0x0d, 0xd1, 0x74, 0xf6,
+        0x5b, 0xd6, 0xc0, 0x16, 0x5e, 0xf6, 0x36, 0xcb, 0x4b, 0xef, 0x54, 0x7c,
+        0xd3, 0xd9, 0x9d, 0x25, 0x13, 0xcd, 0xc3, 0xd4, 0xc8, 0x90, 0x21, 0x0c,
+        0x00, 0x59, 0x30, 0x99, 0x61, 0xb7, 0x80, 0x1c, 0x42, 0x51, 0xf8, 0x87,
+        0xd7, 0x48, 0xf2, 0xe6, 0xd9, 0x7a, 0xc5, 0xb1, 0xb6, 0xc6, 0x88, 0xae,
+        0x4c, 0x60, 0x12, 0x85, 0x9c, 0x4e, 0x6b, 0x55, 0x14, 0x44, 0xec, 0x3c,
+        0xe7
+    };
+
+    auto const uncompressed = "Alice was beginning to get very tired of sitting by her sister on the bank, and of having nothing to do: once or twice she had peeped into the book her sister was reading, but it had no pictures or conversations in it, and what is the use of a book, thought Alice without pictures or conversations?"sv;
+
+    auto decompressed = Compress::ZstdDecompressor::decompress_all(compressed);
+    EXPECT(decompressed.value().bytes() == uncompressed.bytes());
+}
+
+TEST_CASE(zstd_decompress_streaming)
+{
+    Array<u8, 23> const compressed {
+        0x28, 0xb5, 0x2f, 0xfd, 0x20, 0x0e, 0x71, 0x00, 0x00, 0x48, 0x65, 0x6c,
+        0x6c, 0x6f, 0x2c, 0x20, 0x57, 0x6f, 0x72, 0x6c, 0x64, 0x21, 0x0a
+    };
+
+    auto memory_stream = MUST(FixedMemoryStream::construct(compressed));
+    auto zstd_stream = MUST(Compress::ZstdDecompressor::construct(MaybeOwned<AK::Stream>(*memory_stream)));
+
+    u8 buffer_raw[5];
+    Bytes buffer { buffer_raw, sizeof(buffer_raw) };
+    ByteBuffer decompressed;
+    while (!zstd_stream->is_eof())
+        MUST(decompressed.try_append(MUST(zstd_stream->read(buffer))));
+
+    EXPECT(decompressed.bytes() == "Hello, World!\n"sv.bytes());
+}
+
+TEST_CASE(zstd_decompress_bad_magic)
+{
+    Array<u8, 8> const compressed { 0x28, 0xb5, 0x2f, 0xfe, 0x20, 0x00, 0x01, 0x00 };
+
+    EXPECT(!Compress::ZstdDecompressor::is_likely_compressed(compressed));
+    EXPECT(Compress::ZstdDecompressor::decompress_all(compressed).is_error());
+}
+
+TEST_CASE(zstd_round_trip_empty)
+{
+    auto compressed = MUST(Compress::ZstdCompressor::compress_all({}));
+    auto decompressed = MUST(Compress::ZstdDecompressor::decompress_all(compressed));
+    EXPECT(decompressed.is_empty());
+}
+
+TEST_CASE(zstd_round_trip_random)
+{
+    auto original = ByteBuffer::create_uninitialized(4096).release_value();
+    fill_with_random(original.data(), original.size());
+
+    auto compressed = MUST(Compress::ZstdCompressor::compress_all(original));
+    auto decompressed = MUST(Compress::ZstdDecompressor::decompress_all(compressed));
+    EXPECT(decompressed == original);
+}
+
+TEST_CASE(zstd_round_trip_large)
+{
+    // Larger than a block and made up of repeated chunks, so that matches reach back into the previous block.
+    auto size = Compress::ZstdCompressor::block_size * 3 + 123;
+    auto original = ByteBuffer::create_uninitialized(size).release_value();
+    size_t chunk_size = 10000;
+    fill_with_random(original.data(), chunk_size);
+    for (size_t offset = chunk_size; offset < size; offset += chunk_size)
+        memcpy(original.data() + offset, original.data(), min(chunk_size, size - offset));
+
+    auto compressed = MUST(Compress::ZstdCompressor::compress_all(original));
+    EXPECT(compressed.size() < size / 10);
+    auto decompressed = MUST(Compress::ZstdDecompressor::decompress_all(compressed));
+    EXPECT(decompressed == original);
+}
+
+TEST_CASE(zstd_round_trip_text)
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < 1000; ++i)
+        builder.appendff("Line {}: The quick brown fox jumps over the lazy dog.\n", i);
+    auto original = builder.string_view().bytes();
+
+    auto compressed = MUST(Compress::ZstdCompressor::compress_all(original));
+    EXPECT(compressed.size() < original.size() / 4);
+    auto decompressed = MUST(Compress::ZstdDecompressor::decompress_all(compressed));
+    EXPECT(decompressed.bytes() == original);
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashTable.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/EventLoopGroup.h>
+#include <LibCore/TCPServer.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/Mutex.h>
+#include <pthread.h>
+
+TEST_CASE(work_is_spread_over_all_loops)
+{
+    Core::EventLoop event_loop;
+    auto group = MUST(Core::EventLoopGroup::try_create(3));
+    EXPECT_EQ(group->size(), 3u);
+
+    Threading::Mutex mutex;
+    HashTable<pthread_t> threads;
+    Atomic<size_t> finished { 0 };
+    for (size_t i = 0; i < 6; ++i) {
+        group->deferred_invoke([&] {
+            {
+                Threading::MutexLocker locker(mutex);
+                threads.set(pthread_self());
+            }
+            ++finished;
+            event_loop.wake();
+        });
+    }
+
+    event_loop.spin_until([&] { return finished.load() == 6; });
+    EXPECT_EQ(threads.size(), 3u);
+    EXPECT(!threads.contains(pthread_self()));
+}
+
+TEST_CASE(connections_are_served_on_the_group_loops)
+{
+    static constexpr u16 port = 9091;
+    static constexpr size_t client_count = 4;
+    static constexpr auto greeting = "Hello from a worker"sv;
+
+    Core::EventLoop event_loop;
+    auto group = MUST(Core::EventLoopGroup::try_create(2));
+
+    auto server = MUST(Core::TCPServer::try_create());
+    MUST(server->listen({ 127, 0, 0, 1 }, port, Core::TCPServer::AllowAddressReuse::Yes));
+
+    Threading::Mutex mutex;
+    HashTable<pthread_t> threads;
+    Atomic<size_t> served { 0 };
+    group->distribute_connections(*server, [&](NonnullOwnPtr<Core::Stream::TCPSocket> socket) {
+        {
+            Threading::MutexLocker locker(mutex);
+            threads.set(pthread_self());
+        }
+        EXPECT(!socket->write_entire_buffer(greeting.bytes()).is_error());
+        socket->close();
+        ++served;
+        event_loop.wake();
+    });
+
+    Vector<NonnullOwnPtr<Core::Stream::TCPSocket>> clients;
+    for (size_t i = 0; i < client_count; ++i)
+        clients.append(MUST(Core::Stream::TCPSocket::connect({ { 127, 0, 0, 1 }, port })));
+
+    event_loop.spin_until([&] { return served.load() == client_count; });
+    EXPECT_EQ(threads.size(), 2u);
+    EXPECT(!threads.contains(pthread_self()));
+
+    for (auto& client : clients) {
+        MUST(client->set_blocking(true));
+        auto buffer = MUST(ByteBuffer::create_uninitialized(64));
+        auto received = MUST(client->read(buffer));
+        EXPECT_EQ(StringView { received }, greeting);
+    }
+}
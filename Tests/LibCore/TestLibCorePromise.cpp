@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/Promise.h>
+#include <LibTest/TestCase.h>
+
+TEST_CASE(coroutines_can_await_promises)
+{
+    Core::EventLoop event_loop;
+
+    auto promise = Core::Promise<int>::construct();
+    int resolved_value = 0;
+    promise->on_resolved = [&](int& value) { resolved_value = value; };
+
+    auto add_one = [&]() -> Coroutine<int> {
+        auto value = co_await *promise;
+        co_return value + 1;
+    };
+    auto coroutine = add_one();
+    EXPECT(!coroutine.is_ready());
+
+    promise->resolve(41);
+    EXPECT_EQ(resolved_value, 41);
+    EXPECT(coroutine.is_ready());
+    EXPECT_EQ(coroutine.take_result(), 42);
+}
+
+TEST_CASE(awaiting_a_resolved_promise_does_not_suspend)
+{
+    auto promise = Core::Promise<int>::construct();
+    promise->resolve(1);
+
+    auto await_promise = [&]() -> Coroutine<int> { co_return co_await *promise; };
+    auto coroutine = await_promise();
+    EXPECT(coroutine.is_ready());
+    EXPECT_EQ(coroutine.take_result(), 1);
+}
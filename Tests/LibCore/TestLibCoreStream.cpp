@@ -7,6 +7,7 @@
 #include <AK/Format.h>
 #include <AK/MaybeOwned.h>
 #include <AK/String.h>
+#include <AK/StringBuilder.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalServer.h>
 #include <LibCore/Stream.h>
@@ -234,6 +235,42 @@ TEST_CASE(tcp_socket_write)
     EXPECT_EQ(sent_data, received_data);
 }
 
+TEST_CASE(tcp_socket_async_read)
+{
+    Core::EventLoop event_loop;
+
+    auto tcp_server = MUST(Core::TCPServer::try_create());
+    EXPECT(!tcp_server->listen({ 127, 0, 0, 1 }, 9090).is_error());
+    EXPECT(!tcp_server->set_blocking(true).is_error());
+
+    auto client_socket = MUST(Core::Stream::TCPSocket::connect({ { 127, 0, 0, 1 }, 9090 }));
+    auto server_socket = MUST(tcp_server->accept());
+
+    auto receive_buffer = MUST(ByteBuffer::create_uninitialized(8));
+    auto read_everything = [&]() -> Coroutine<ErrorOr<DeprecatedString>> {
+        StringBuilder builder;
+        while (true) {
+            auto read_bytes = co_await client_socket->async_read(receive_buffer);
+            if (read_bytes.is_error())
+                co_return read_bytes.release_error();
+            if (read_bytes.value().is_empty())
+                co_return builder.to_deprecated_string();
+            builder.append(StringView { read_bytes.value() });
+        }
+    };
+    auto coroutine = read_everything();
+
+    // Nothing has been sent yet, so the coroutine has to wait for the event loop to tell it that there's data.
+    EXPECT(!coroutine.is_ready());
+
+    EXPECT(!server_socket->write(sent_data.bytes()).is_error());
+    server_socket->close();
+
+    event_loop.spin_until([&] { return coroutine.is_ready(); });
+    auto received_data = MUST(coroutine.take_result());
+    EXPECT_EQ(received_data, sent_data);
+}
+
 TEST_CASE(tcp_socket_eof)
 {
     Core::EventLoop event_loop;
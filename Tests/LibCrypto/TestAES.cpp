@@ -129,6 +129,35 @@ TEST_CASE(test_AES_CBC_256bit_key_decrypt)
     test_aes_cbc_decrypt(cipher, result, 48);
 }
 
+// Long enough to go through the multi-block path, which works on eight blocks at a time, and the single blocks after it.
+TEST_CASE(test_AES_CBC_128bit_key_decrypt_many_blocks)
+{
+    u8 key[16];
+    u8 ivec[16];
+    for (u8 i = 0; i < 16; ++i) {
+        key[i] = i;
+        ivec[i] = 0xf0 + i;
+    }
+    u8 in[] {
+        0x75, 0x3d, 0x5e, 0xac, 0xf8, 0x8e, 0xd4, 0xc2, 0xc3, 0x04, 0x96, 0x11, 0x2e, 0x5f, 0x22, 0x21,
+        0x38, 0x04, 0x49, 0x12, 0x0c, 0x43, 0xe6, 0x1d, 0x91, 0xc6, 0x6c, 0xae, 0x50, 0x65, 0xcd, 0xad,
+        0xa9, 0x2a, 0x5c, 0x41, 0x7f, 0x79, 0x93, 0x02, 0x3b, 0x11, 0xfd, 0xc5, 0x78, 0x0e, 0x1e, 0xfb,
+        0x5a, 0x37, 0xfc, 0xea, 0xbb, 0x20, 0x46, 0xeb, 0x70, 0xa9, 0x2e, 0x5d, 0x61, 0x56, 0xe1, 0x93,
+        0x34, 0x40, 0x3b, 0xe8, 0xcf, 0x76, 0x0a, 0xa5, 0x51, 0x4e, 0xee, 0x34, 0x28, 0x89, 0x31, 0x2d,
+        0x4e, 0x94, 0xba, 0xf3, 0xb3, 0x5a, 0xb0, 0x02, 0xb1, 0x76, 0x05, 0xd1, 0xc9, 0xc6, 0xb0, 0xcc,
+        0x43, 0x37, 0x7f, 0xb1, 0x61, 0x8f, 0x77, 0x5d, 0x94, 0x9e, 0xc9, 0xff, 0x70, 0x32, 0xca, 0x81,
+        0xff, 0x90, 0x6e, 0xd3, 0x06, 0x86, 0xcf, 0x7d, 0xa7, 0x3d, 0xb4, 0xfb, 0x00, 0xad, 0x0a, 0x19,
+        0x18, 0xd4, 0x73, 0xac, 0x0f, 0x0a, 0x55, 0x67, 0xde, 0xb7, 0xea, 0x21, 0x90, 0x50, 0x06, 0x60
+    };
+    Crypto::Cipher::AESCipher::CBCMode cipher(ReadonlyBytes { key, sizeof(key) }, 128, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::Null);
+    auto out = ByteBuffer::create_uninitialized(sizeof(in)).release_value();
+    auto out_bytes = out.bytes();
+    cipher.decrypt(ReadonlyBytes { in, sizeof(in) }, out_bytes, ReadonlyBytes { ivec, sizeof(ivec) });
+    EXPECT_EQ(out_bytes.size(), sizeof(in));
+    for (size_t i = 0; i < out_bytes.size(); ++i)
+        EXPECT_EQ(out_bytes[i], i);
+}
+
 // TODO: Test non-CMS padding options for AES CBC decrypt
 
 TEST_CASE(test_AES_CTR_name)
@@ -336,6 +365,31 @@ TEST_CASE(test_AES_CTR_128bit_decrypt_16bytes)
     // If encryption works, then decryption works, too.
 }
 
+TEST_CASE(test_AES_CTR_128bit_key_encrypt_many_blocks)
+{
+    u8 key[16];
+    u8 ivec[16];
+    u8 in[136];
+    for (u8 i = 0; i < 16; ++i) {
+        key[i] = i;
+        ivec[i] = 0xf0 + i;
+    }
+    for (u8 i = 0; i < sizeof(in); ++i)
+        in[i] = i;
+    u8 out[] {
+        0x66, 0xa6, 0xc5, 0xeb, 0x30, 0x57, 0x37, 0x4f, 0x9f, 0x58, 0xd4, 0x0c, 0x3f, 0x1b, 0xa3, 0xa2,
+        0xa2, 0x90, 0xc5, 0x13, 0xa3, 0x8b, 0x2a, 0xba, 0xbc, 0xb4, 0x69, 0xa0, 0x72, 0x81, 0x01, 0xf5,
+        0xf2, 0x50, 0xb0, 0x75, 0x58, 0x7e, 0xcd, 0xba, 0xd3, 0xa8, 0xa1, 0x72, 0x63, 0xbf, 0x7b, 0x5e,
+        0x40, 0xe9, 0x54, 0x69, 0x08, 0x8a, 0x6e, 0x70, 0x6f, 0x54, 0x39, 0x23, 0x73, 0x5d, 0x09, 0xa5,
+        0x2b, 0x40, 0xe0, 0x6b, 0x69, 0xd3, 0x15, 0x25, 0xcc, 0xcb, 0x93, 0x59, 0xb3, 0xb3, 0xcf, 0x72,
+        0xb9, 0x65, 0x73, 0xa3, 0x31, 0x81, 0x6f, 0x09, 0xf0, 0xd4, 0x7f, 0x25, 0x1c, 0x12, 0x66, 0xdc,
+        0x84, 0x67, 0x38, 0x56, 0x3f, 0xb8, 0x73, 0xbb, 0xf3, 0xd6, 0x1a, 0xb4, 0x14, 0xba, 0x50, 0x56,
+        0x96, 0x55, 0xdf, 0xa6, 0x77, 0xfe, 0xb0, 0xbc, 0x3e, 0x8c, 0xfd, 0xe9, 0xe1, 0xbe, 0xdf, 0x85,
+        0xb3, 0xf4, 0x65, 0xfd, 0xbb, 0xa6, 0x97, 0x49
+    };
+    test_aes_ctr_encrypt(AS_BB(key), AS_BB(ivec), AS_BB(in), AS_BB(out));
+}
+
 TEST_CASE(test_AES_GCM_name)
 {
     Crypto::Cipher::AESCipher::GCMMode cipher("WellHelloFriends"_b, 128, Crypto::Cipher::Intent::Encryption);
@@ -454,3 +508,31 @@ TEST_CASE(test_AES_GCM_128bit_decrypt_multiple_blocks_with_aad)
     EXPECT(memcmp(result_pt, out.data(), out.size()) == 0);
     EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
 }
+
+TEST_CASE(test_AES_GCM_128bit_encrypt_many_blocks_with_aad)
+{
+    u8 key[16];
+    u8 ivec[16] {};
+    u8 aad[20];
+    u8 in[136];
+    for (u8 i = 0; i < 16; ++i)
+        key[i] = i;
+    for (u8 i = 0; i < 12; ++i)
+        ivec[i] = 0xf0 + i;
+    for (u8 i = 0; i < sizeof(aad); ++i)
+        aad[i] = 0xa0 + i;
+    for (u8 i = 0; i < sizeof(in); ++i)
+        in[i] = i;
+    u8 result_tag[] { 0x31, 0x52, 0x03, 0x46, 0xc3, 0xd8, 0x41, 0xfa, 0x28, 0x3e, 0x90, 0x59, 0xe8, 0x55, 0xfd, 0xb3 };
+
+    Crypto::Cipher::AESCipher::GCMMode cipher(AS_BB(key), 128, Crypto::Cipher::Intent::Encryption);
+    auto tag = ByteBuffer::create_uninitialized(16).release_value();
+    auto ciphertext = ByteBuffer::create_uninitialized(sizeof(in)).release_value();
+    cipher.encrypt(AS_BB(in), ciphertext.bytes(), AS_BB(ivec), AS_BB(aad), tag);
+    EXPECT(memcmp(result_tag, tag.data(), tag.size()) == 0);
+
+    auto plaintext = ByteBuffer::create_uninitialized(sizeof(in)).release_value();
+    auto consistency = cipher.decrypt(ciphertext, plaintext.bytes(), AS_BB(ivec), AS_BB(aad), tag);
+    EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
+    EXPECT(memcmp(in, plaintext.data(), sizeof(in)) == 0);
+}
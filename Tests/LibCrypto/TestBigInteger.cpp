@@ -201,6 +201,27 @@ TEST_CASE(test_unsigned_bigint_multiplication_with_big_numbers2)
     EXPECT_EQ(result.words(), expected_result);
 }
 
+TEST_CASE(test_unsigned_bigint_multiplication_with_big_numbers3)
+{
+    // (B^m - 1) * (B^n - 1) = B^(m + n) - B^m - B^n + 1, for sizes that are multiplied with Karatsuba.
+    auto all_ones = [](size_t words) {
+        Vector<u32, Crypto::STARTING_WORD_SIZE> result;
+        result.resize(words);
+        result.span().fill(0xffffffff);
+        return Crypto::UnsignedBigInteger(move(result));
+    };
+    Crypto::UnsignedBigInteger one { 1 };
+    struct {
+        size_t m;
+        size_t n;
+    } sizes[] = { { 32, 32 }, { 100, 100 }, { 77, 250 }, { 301, 40 } };
+    for (auto [m, n] : sizes) {
+        auto result = all_ones(m).multiplied_by(all_ones(n));
+        auto expected = one.shift_left(32 * (m + n)).minus(one.shift_left(32 * m)).minus(one.shift_left(32 * n)).plus(one);
+        EXPECT_EQ(result, expected);
+    }
+}
+
 TEST_CASE(test_unsigned_bigint_simple_division)
 {
     Crypto::UnsignedBigInteger num1(27194);
@@ -331,6 +352,20 @@ TEST_CASE(test_bigint_modular_power_extra_tests)
     }
 }
 
+TEST_CASE(test_bigint_modular_power_with_montgomery_context)
+{
+    // 2^521 - 1 is prime, so by Fermat's little theorem a^p = a (mod p).
+    auto one = Crypto::UnsignedBigInteger { 1 };
+    auto prime = one.shift_left(521).minus(one);
+    auto context = Crypto::NumberTheory::make_montgomery_context(prime);
+
+    EXPECT_EQ(Crypto::NumberTheory::ModularPower(3, prime.minus(one), context), 1);
+    EXPECT_EQ(Crypto::NumberTheory::ModularPower(3, prime, context), 3);
+    EXPECT_EQ(Crypto::NumberTheory::ModularPower(prime.multiplied_by(prime).plus(12345), prime, context), 12345);
+    EXPECT_EQ(Crypto::NumberTheory::ModularPower(prime.minus(one), 0, context), 1);
+    EXPECT_EQ(Crypto::NumberTheory::ModularPower(0, prime, context), 0);
+}
+
 TEST_CASE(test_bigint_primality_test)
 {
     struct {
@@ -6,6 +6,7 @@
 
 #include <AK/ByteBuffer.h>
 #include <LibCrypto/Cipher/ChaCha20.h>
+#include <LibCrypto/Cipher/ChaCha20Poly1305.h>
 #include <LibTest/TestCase.h>
 
 // https://datatracker.ietf.org/doc/html/rfc7539#appendix-A.2
@@ -139,3 +140,43 @@ TEST_CASE(test_vector_3)
     auto expected = ReadonlyBytes { ciphertext, 127 };
     EXPECT_EQ(result, expected);
 }
+
+// https://datatracker.ietf.org/doc/html/rfc8439#section-2.8.2
+TEST_CASE(test_aead_chacha20_poly1305)
+{
+    u8 key[32] {
+        0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
+        0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f
+    };
+    u8 nonce[12] { 0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47 };
+    u8 aad[12] { 0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7 };
+    auto plaintext = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it."sv;
+    u8 ciphertext[114] {
+        0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86, 0xaf, 0xbc, 0x53, 0xef, 0x7e, 0xc2,
+        0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe, 0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6,
+        0x3d, 0xbe, 0xa4, 0x5e, 0x8c, 0xa9, 0x67, 0x12, 0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b,
+        0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29, 0x05, 0xd6, 0xa5, 0xb6, 0x7e, 0xcd, 0x3b, 0x36,
+        0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c, 0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58,
+        0xfa, 0xb3, 0x24, 0xe4, 0xfa, 0xd6, 0x75, 0x94, 0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc,
+        0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d, 0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce, 0xc6, 0x4b,
+        0x61, 0x16
+    };
+    u8 tag[16] { 0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a, 0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91 };
+
+    Crypto::Cipher::ChaCha20Poly1305 aead(ReadonlyBytes { key, 32 });
+
+    auto encrypted = MUST(ByteBuffer::create_uninitialized(plaintext.length()));
+    u8 computed_tag[16];
+    MUST(aead.encrypt(plaintext.bytes(), encrypted, ReadonlyBytes { nonce, 12 }, ReadonlyBytes { aad, 12 }, Bytes { computed_tag, 16 }));
+    EXPECT_EQ(encrypted.bytes(), (ReadonlyBytes { ciphertext, sizeof(ciphertext) }));
+    EXPECT_EQ((ReadonlyBytes { computed_tag, 16 }), (ReadonlyBytes { tag, 16 }));
+
+    auto decrypted = MUST(ByteBuffer::create_uninitialized(sizeof(ciphertext)));
+    auto consistency = MUST(aead.decrypt(ReadonlyBytes { ciphertext, sizeof(ciphertext) }, decrypted, ReadonlyBytes { nonce, 12 }, ReadonlyBytes { aad, 12 }, ReadonlyBytes { tag, 16 }));
+    EXPECT(consistency == Crypto::VerificationConsistency::Consistent);
+    EXPECT_EQ(decrypted.bytes(), plaintext.bytes());
+
+    tag[0] ^= 1;
+    consistency = MUST(aead.decrypt(ReadonlyBytes { ciphertext, sizeof(ciphertext) }, decrypted, ReadonlyBytes { nonce, 12 }, ReadonlyBytes { aad, 12 }, ReadonlyBytes { tag, 16 }));
+    EXPECT(consistency == Crypto::VerificationConsistency::Inconsistent);
+}
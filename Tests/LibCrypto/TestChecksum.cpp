@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteBuffer.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Checksum/CRC32.h>
 #include <LibTest/TestCase.h>
@@ -33,3 +34,37 @@ TEST_CASE(test_crc32)
     do_test(DeprecatedString("The quick brown fox jumps over the lazy dog").bytes(), 0x414FA339);
     do_test(DeprecatedString("various CRC algorithms input data").bytes(), 0x9BD366AE);
 }
+
+static ByteBuffer make_long_test_input(Optional<u8> fill_value = {})
+{
+    auto buffer = MUST(ByteBuffer::create_uninitialized(100000));
+    for (size_t i = 0; i < buffer.size(); ++i)
+        buffer[i] = fill_value.value_or(static_cast<u8>(i * 7 + i / 255));
+    return buffer;
+}
+
+TEST_CASE(test_adler32_long_input)
+{
+    auto input = make_long_test_input();
+    EXPECT_EQ(Crypto::Checksum::Adler32(input).digest(), 0x68239513u);
+    EXPECT_EQ(Crypto::Checksum::Adler32(make_long_test_input(0xff)).digest(), 0x149a302cu);
+
+    // Updating in uneven pieces has to give the same result as all at once.
+    Crypto::Checksum::Adler32 adler32;
+    for (size_t offset = 0, piece_size = 1; offset < input.size(); offset += piece_size, piece_size = piece_size * 3 + 1)
+        adler32.update(input.bytes().slice(offset, min(piece_size, input.size() - offset)));
+    EXPECT_EQ(adler32.digest(), 0x68239513u);
+}
+
+TEST_CASE(test_crc32_long_input)
+{
+    auto input = make_long_test_input();
+    EXPECT_EQ(Crypto::Checksum::CRC32(input).digest(), 0x85161755u);
+    EXPECT_EQ(Crypto::Checksum::CRC32(make_long_test_input(0xff)).digest(), 0x68c6cec4u);
+
+    // Updating in uneven pieces has to give the same result as all at once.
+    Crypto::Checksum::CRC32 crc32;
+    for (size_t offset = 0, piece_size = 1; offset < input.size(); offset += piece_size, piece_size = piece_size * 3 + 1)
+        crc32.update(input.bytes().slice(offset, min(piece_size, input.size() - offset)));
+    EXPECT_EQ(crc32.digest(), 0x85161755u);
+}
@@ -6,6 +6,7 @@
 
 #include <LibCrypto/Authentication/GHash.h>
 #include <LibCrypto/Authentication/HMAC.h>
+#include <LibCrypto/Hash/HashManager.h>
 #include <LibCrypto/Hash/MD5.h>
 #include <LibCrypto/Hash/SHA1.h>
 #include <LibCrypto/Hash/SHA2.h>
@@ -142,6 +143,22 @@ TEST_CASE(test_SHA1_hash_successive_updates)
     EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
 }
 
+TEST_CASE(test_SHA1_hash_successive_updates_of_varying_length)
+{
+    u8 result[] {
+        0xc9, 0xc9, 0x60, 0xa0, 0xb9, 0x25, 0x47, 0x4f, 0xab, 0x83, 0x94, 0x2c, 0xc2, 0x7d, 0x50, 0x4f, 0xc2, 0x4a, 0xc3, 0x7b
+    };
+    u8 data[1000];
+    for (size_t i = 0; i < sizeof(data); ++i)
+        data[i] = i % 251;
+
+    Crypto::Hash::SHA1 hasher;
+    for (size_t offset = 0, length = 1; offset < sizeof(data); offset += length, length = length * 3 + 1)
+        hasher.update(data + offset, min(length, sizeof(data) - offset));
+    auto digest = hasher.digest();
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
+}
+
 TEST_CASE(test_SHA256_name)
 {
     Crypto::Hash::SHA256 sha;
@@ -166,6 +183,61 @@ TEST_CASE(test_SHA256_hash_empty_string)
     EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
 }
 
+// Goes through whole blocks that are hashed straight from the input as well as through the buffer.
+TEST_CASE(test_SHA256_hash_successive_updates_of_varying_length)
+{
+    u8 result[] {
+        0x4e, 0x4c, 0x29, 0x4b, 0x33, 0x1f, 0x7a, 0x20, 0x99, 0xa3, 0x79, 0xbe, 0xc3, 0x4b, 0x9f, 0x9f, 0xc0, 0x3d, 0xc4, 0x6a, 0xb4, 0x65, 0xd9, 0x98, 0xf4, 0xd6, 0x83, 0xda, 0x53, 0x48, 0x7e, 0x6d
+    };
+    u8 data[1000];
+    for (size_t i = 0; i < sizeof(data); ++i)
+        data[i] = i % 251;
+
+    Crypto::Hash::SHA256 hasher;
+    for (size_t offset = 0, length = 1; offset < sizeof(data); offset += length, length = length * 3 + 1)
+        hasher.update(data + offset, min(length, sizeof(data) - offset));
+    auto digest = hasher.digest();
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+}
+
+TEST_CASE(test_SHA256_hash_many)
+{
+    u8 data[1000];
+    for (size_t i = 0; i < sizeof(data); ++i)
+        data[i] = i % 251;
+
+    // More messages than are hashed at once, of lengths that need one or two padding blocks.
+    Vector<ReadonlyBytes> messages;
+    for (size_t length : { 0, 3, 55, 56, 63, 64, 65, 119, 120, 128, 500, 1000 })
+        messages.append({ data, length });
+    messages.append("abc"sv.bytes());
+
+    Vector<Crypto::Hash::SHA256::DigestType> digests;
+    digests.resize(messages.size());
+    Crypto::Hash::SHA256::hash_many(messages.span(), digests.span());
+    for (size_t i = 0; i < messages.size(); ++i)
+        EXPECT_EQ(digests[i], Crypto::Hash::SHA256::hash(messages[i].data(), messages[i].size()));
+
+    u8 abc_result[] {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23, 0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+    };
+    EXPECT(memcmp(abc_result, digests.last().data, Crypto::Hash::SHA256::digest_size()) == 0);
+}
+
+TEST_CASE(test_hash_manager_hash_many)
+{
+    Vector<ReadonlyBytes> messages { "abc"sv.bytes(), ""sv.bytes(), "Well hello friends"sv.bytes() };
+    for (auto kind : { Crypto::Hash::HashKind::SHA1, Crypto::Hash::HashKind::SHA256, Crypto::Hash::HashKind::SHA512 }) {
+        auto digests = Crypto::Hash::Manager::hash_many(kind, messages.span());
+        EXPECT_EQ(digests.size(), messages.size());
+        for (size_t i = 0; i < messages.size(); ++i) {
+            Crypto::Hash::Manager hash(kind);
+            hash.update(messages[i]);
+            EXPECT_EQ(digests[i].bytes(), hash.digest().bytes());
+        }
+    }
+}
+
 TEST_CASE(test_SHA384_name)
 {
     Crypto::Hash::SHA384 sha;
@@ -135,3 +135,23 @@ TEST_CASE(test_RSA_EMSA_PSS_construction)
     Crypto::PK::RSA rsa;
     Crypto::PK::RSA_EMSA_PSS<Crypto::Hash::SHA256> rsa_esma_pss(rsa);
 }
+
+TEST_CASE(test_RSA_EMSA_PSS_verify)
+{
+    // Signed by OpenSSL with SHA-256 and a 32 byte salt.
+    u8 signature[] { 0x5b, 0x12, 0x3f, 0x92, 0xb4, 0x59, 0x38, 0x17, 0x51, 0xa4, 0xdf, 0xc5, 0x39, 0x6d, 0xb0, 0xc0, 0x60, 0x78, 0xbd, 0x5f, 0xeb, 0xa2, 0x9b, 0xcd, 0xdf, 0xda, 0x2f, 0xd8, 0x2b, 0x56, 0xd1, 0x2c, 0xb0, 0x33, 0x85, 0x1d, 0x47, 0x99, 0x0e, 0xb0, 0x3c, 0xb5, 0x99, 0x88, 0xad, 0xb3, 0x6f, 0x44, 0xa6, 0xb2, 0x93, 0x39, 0x9b, 0xf3, 0xc8, 0x4c, 0x39, 0x0c, 0x5a, 0x0b, 0xe9, 0xcf, 0x21, 0x16, 0xbf, 0x23, 0x5b, 0x6d, 0xf7, 0x5a, 0xc4, 0x9d, 0xda, 0xdd, 0xcc, 0x88, 0x2f, 0x15, 0x6a, 0xec, 0x27, 0x05, 0x6d, 0x9b, 0x02, 0x2f, 0xf5, 0x13, 0x70, 0x9a, 0x32, 0xbc, 0x39, 0x9e, 0x23, 0x93, 0xde, 0x64, 0x49, 0x27, 0xf1, 0xe9, 0x7b, 0x9f, 0x09, 0xa1, 0xe1, 0x15, 0x36, 0x4d, 0x6a, 0x7c, 0x9e, 0x4a, 0x49, 0xc1, 0x2b, 0xc8, 0x00, 0x20, 0x97, 0x89, 0xfb, 0xd1, 0xb5, 0x27, 0x96, 0x92 };
+    Crypto::PK::RSAPublicKey public_key {
+        "141773273226463505709201287842499821359721540163029026266537248562424432554580643643932266833057178534023283824355679503359613414214498770918569951105303222791255023708241620099152696507626041688251208926979563666202895411715055439145029928491452256064021297587922211874338164326190853663014301416561543730513"_bigint,
+        "65537"_bigint
+    };
+    Crypto::PK::RSAPrivateKey dummy_private_key;
+    Crypto::PK::RSA rsa(public_key, dummy_private_key);
+
+    u8 encoded_message[sizeof(signature)];
+    auto encoded_message_bytes = Bytes { encoded_message, sizeof(encoded_message) };
+    rsa.verify({ signature, sizeof(signature) }, encoded_message_bytes);
+
+    Crypto::PK::EMSA_PSS<Crypto::Hash::SHA256, Crypto::Hash::SHA256::DigestSize> pss;
+    EXPECT_EQ(pss.verify("WellHelloFriends"sv.bytes(), encoded_message_bytes, sizeof(signature) * 8 - 1), Crypto::VerificationConsistency::Consistent);
+    EXPECT_EQ(pss.verify("WellHelloEnemies"sv.bytes(), encoded_message_bytes, sizeof(signature) * 8 - 1), Crypto::VerificationConsistency::Inconsistent);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGPU/DisplayListPlayer.h>
+#include <LibGPU/Driver.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/DisplayList.h>
+#include <LibGfx/Painter.h>
+#include <LibTest/TestCase.h>
+
+static constexpr Gfx::IntSize target_size { 64, 48 };
+
+static NonnullRefPtr<Gfx::Bitmap> play_on_painter(Gfx::DisplayList const& display_list)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, target_size));
+    bitmap->fill(Gfx::Color::White);
+    Gfx::Painter painter(*bitmap);
+    display_list.paint(painter);
+    return bitmap;
+}
+
+static NonnullRefPtr<Gfx::Bitmap> play_on_gpu(Gfx::DisplayList const& display_list)
+{
+    auto driver = MUST(GPU::Driver::try_create("softgpu"sv));
+    auto device = MUST(driver->try_create_device(target_size));
+    device->clear_color({ 1, 1, 1, 1 });
+    {
+        GPU::DisplayListPlayer player(*device, target_size);
+        display_list.replay(player);
+    }
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, target_size));
+    device->blit_from_color_buffer(*bitmap);
+    return bitmap;
+}
+
+static void expect_close_enough(Gfx::Bitmap const& actual, Gfx::Bitmap const& expected, int tolerance)
+{
+    for (int y = 0; y < target_size.height(); ++y) {
+        for (int x = 0; x < target_size.width(); ++x) {
+            auto actual_color = actual.get_pixel(x, y);
+            auto expected_color = expected.get_pixel(x, y);
+            if (abs(actual_color.red() - expected_color.red()) > tolerance
+                || abs(actual_color.green() - expected_color.green()) > tolerance
+                || abs(actual_color.blue() - expected_color.blue()) > tolerance) {
+                FAIL(DeprecatedString::formatted("Pixel {},{} is {} instead of {}", x, y, actual_color, expected_color));
+                return;
+            }
+        }
+    }
+}
+
+static NonnullRefPtr<Gfx::Bitmap> create_test_bitmap(Gfx::BitmapFormat format)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(format, { 10, 7 }));
+    for (int y = 0; y < 7; ++y) {
+        for (int x = 0; x < 10; ++x)
+            bitmap->set_pixel(x, y, Gfx::Color(x * 25, y * 36, 200, format == Gfx::BitmapFormat::BGRA8888 ? x * 28 : 255));
+    }
+    return bitmap;
+}
+
+TEST_CASE(opaque_rects_and_bitmaps_are_exact)
+{
+    auto bitmap = create_test_bitmap(Gfx::BitmapFormat::BGRx8888);
+
+    Gfx::DisplayList display_list;
+    display_list.fill_rect({ 2, 3, 40, 20 }, Gfx::Color::Red);
+    display_list.save();
+    display_list.translate({ 5, 7 });
+    display_list.add_clip_rect({ 0, 0, 30, 30 });
+    display_list.fill_rect({ 20, 20, 30, 30 }, Gfx::Color::Blue);
+    display_list.blit({ 1, 2 }, bitmap, bitmap->rect());
+    display_list.restore();
+    display_list.blit({ 50, 40 }, bitmap, { 2, 1, 6, 5 });
+
+    auto expected = play_on_painter(display_list);
+    auto actual = play_on_gpu(display_list);
+    expect_close_enough(actual, expected, 0);
+}
+
+TEST_CASE(translucent_rects_and_bitmaps)
+{
+    auto bitmap = create_test_bitmap(Gfx::BitmapFormat::BGRA8888);
+
+    Gfx::DisplayList display_list;
+    display_list.fill_rect({ 0, 0, 64, 48 }, Gfx::Color(10, 200, 30));
+    display_list.fill_rect({ 4, 4, 30, 30 }, Gfx::Color(200, 0, 100, 128));
+    display_list.blit({ 20, 20 }, bitmap, bitmap->rect());
+    display_list.blit({ 40, 20 }, bitmap, bitmap->rect(), 0.5f);
+
+    auto expected = play_on_painter(display_list);
+    auto actual = play_on_gpu(display_list);
+    expect_close_enough(actual, expected, 2);
+}
+
+TEST_CASE(paths_are_rasterized_in_place)
+{
+    Gfx::Path path;
+    path.move_to({ 10, 10 });
+    path.line_to({ 50, 12 });
+    path.line_to({ 30, 40 });
+    path.close();
+
+    Gfx::DisplayList display_list;
+    display_list.translate({ 3, 2 });
+    display_list.fill_path(path, Gfx::Color::Black);
+
+    auto expected = play_on_painter(display_list);
+    auto actual = play_on_gpu(display_list);
+    expect_close_enough(actual, expected, 0);
+}
@@ -6,11 +6,20 @@
 
 #include <LibTest/TestCase.h>
 
+#include <LibGfx/AntiAliasingPainter.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Font/FontDatabase.h>
+#include <LibGfx/Font/OpenType/Font.h>
+#include <LibGfx/Font/ScaledFont.h>
 #include <LibGfx/Painter.h>
 #include <stdio.h>
 
+#ifdef AK_OS_SERENITY
+#    define FONT_PATH(x) ("/res/fonts/" x)
+#else
+#    define FONT_PATH(x) ("../../Base/res/fonts/" x)
+#endif
+
 BENCHMARK_CASE(diagonal_lines)
 {
     int const run_count = 50;
@@ -52,3 +61,77 @@ BENCHMARK_CASE(fill_with_gradient)
         painter.fill_rect_with_gradient(bitmap->rect(), Color::Blue, Color::Red);
     }
 }
+
+BENCHMARK_CASE(fill_with_alpha)
+{
+    int const run_count = 50;
+    int const bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    Gfx::Painter painter(bitmap);
+    painter.clear_rect(bitmap->rect(), Color::White);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.fill_rect(bitmap->rect(), Color(Color::Blue).with_alpha(100));
+    }
+}
+
+BENCHMARK_CASE(blit_with_alpha)
+{
+    int const run_count = 50;
+    int const bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    auto source = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    source->fill(Color(Color::Red).with_alpha(100));
+    Gfx::Painter painter(bitmap);
+
+    for (int run = 0; run < run_count; run++) {
+        painter.blit({}, source, source->rect());
+    }
+}
+
+BENCHMARK_CASE(fill_path_anti_aliased)
+{
+    int const run_count = 50;
+    int const bitmap_size = 2000;
+
+    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    Gfx::Painter painter(bitmap);
+    painter.clear_rect(bitmap->rect(), Color::White);
+    Gfx::AntiAliasingPainter aa_painter(painter);
+
+    Gfx::Path path;
+    for (int i = 0; i < 200; i++) {
+        float angle = i * 2 * AK::Pi<float> / 200;
+        float radius = i % 2 ? 990 : 700;
+        Gfx::FloatPoint point { 1000 + radius * cosf(angle), 1000 + radius * sinf(angle) };
+        if (i == 0)
+            path.move_to(point);
+        else
+            path.line_to(point);
+    }
+    path.close();
+
+    for (int run = 0; run < run_count; run++) {
+        aa_painter.fill_path(path, Color(Color::Blue).with_alpha(200 + run % 2));
+    }
+}
+
+BENCHMARK_CASE(draw_text_with_vector_font)
+{
+    int const run_count = 200;
+    int const bitmap_size = 1000;
+
+    auto bitmap = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { bitmap_size, bitmap_size }).release_value_but_fixme_should_propagate_errors();
+    auto vector_font = OpenType::Font::try_load_from_file(FONT_PATH("LiberationSerif-Regular.ttf")).release_value_but_fixme_should_propagate_errors();
+    auto font = adopt_ref(*new Gfx::ScaledFont(vector_font, 10, 10));
+    Gfx::Painter painter(bitmap);
+    painter.clear_rect(bitmap->rect(), Color::White);
+
+    auto text = "The quick brown fox jumps over the lazy dog, again and again, until it's had enough."sv;
+    for (int run = 0; run < run_count; run++) {
+        for (int line = 0; line < bitmap_size / 14; line++)
+            painter.draw_text_run(Gfx::FloatPoint { 2.0f + run % 3 * 0.3f, line * 14.0f + 12 }, Utf8View(text), font, Color::Black);
+    }
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Random.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Filters/BrightnessFilter.h>
+#include <LibGfx/Filters/ContrastFilter.h>
+#include <LibGfx/Filters/FastBoxBlurFilter.h>
+#include <LibGfx/Filters/FilterPipeline.h>
+#include <LibGfx/Filters/GrayscaleFilter.h>
+#include <LibGfx/Filters/HueRotateFilter.h>
+#include <LibGfx/Filters/InvertFilter.h>
+#include <LibGfx/Filters/OpacityFilter.h>
+#include <LibGfx/Filters/SaturateFilter.h>
+#include <LibGfx/Filters/SepiaFilter.h>
+#include <LibGfx/Filters/StackBlurFilter.h>
+#include <LibGfx/Filters/TintFilter.h>
+
+static NonnullRefPtr<Gfx::Bitmap> create_random_bitmap(Gfx::IntSize size)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, size));
+    for (int y = 0; y < size.height(); ++y) {
+        for (int x = 0; x < size.width(); ++x)
+            bitmap->scanline(y)[x] = get_random<u32>();
+    }
+    return bitmap;
+}
+
+static void apply_color_filter(Gfx::Bitmap& bitmap, Gfx::ColorFilter& filter)
+{
+    filter.apply(bitmap, bitmap.rect(), bitmap, bitmap.rect());
+}
+
+static void expect_close_enough(Gfx::Bitmap const& actual, Gfx::Bitmap const& expected, int tolerance)
+{
+    for (int y = 0; y < actual.height(); ++y) {
+        for (int x = 0; x < actual.width(); ++x) {
+            auto actual_color = actual.get_pixel(x, y);
+            auto expected_color = expected.get_pixel(x, y);
+            if (abs(actual_color.red() - expected_color.red()) > tolerance
+                || abs(actual_color.green() - expected_color.green()) > tolerance
+                || abs(actual_color.blue() - expected_color.blue()) > tolerance
+                || abs(actual_color.alpha() - expected_color.alpha()) > tolerance) {
+                FAIL(DeprecatedString::formatted("Pixel {},{} is {} instead of {}", x, y, actual_color, expected_color));
+                return;
+            }
+        }
+    }
+}
+
+TEST_CASE(color_matrices_match_color_filters)
+{
+    Gfx::BrightnessFilter brightness { 1.3f };
+    Gfx::ContrastFilter contrast { 0.7f };
+    Gfx::InvertFilter invert { 0.6f };
+    Gfx::GrayscaleFilter grayscale { 0.8f };
+    Gfx::SepiaFilter sepia { 0.5f };
+    Gfx::SaturateFilter saturate { 1.5f };
+    Gfx::HueRotateFilter hue_rotate { 90.0f };
+    Gfx::OpacityFilter opacity { 0.5f };
+    Gfx::TintFilter tint { Gfx::Color::Magenta, 0.25f };
+    Gfx::ColorFilter* filters[] = { &brightness, &contrast, &invert, &grayscale, &sepia, &saturate, &hue_rotate, &opacity, &tint };
+
+    auto bitmap = create_random_bitmap({ 37, 23 });
+    for (auto* filter : filters) {
+        auto expected = MUST(bitmap->clone());
+        apply_color_filter(*expected, *filter);
+
+        auto actual = MUST(bitmap->clone());
+        Gfx::FilterPipeline pipeline;
+        pipeline.add_color_filter(*filter);
+        pipeline.apply(*actual);
+
+        // Note: Color filters round their results in slightly different ways.
+        expect_close_enough(*actual, *expected, 1);
+    }
+}
+
+TEST_CASE(pipeline_combines_color_filters_that_stay_in_range)
+{
+    Gfx::GrayscaleFilter grayscale { 1.0f };
+    Gfx::BrightnessFilter darken { 0.5f };
+    Gfx::BrightnessFilter brighten { 2.0f };
+    Gfx::InvertFilter invert { 1.0f };
+
+    {
+        Gfx::FilterPipeline pipeline;
+        pipeline.add_color_filter(grayscale);
+        pipeline.add_color_filter(darken);
+        pipeline.add_color_filter(invert);
+        EXPECT_EQ(pipeline.pass_count(), 1u);
+
+        auto bitmap = create_random_bitmap({ 40, 30 });
+        auto expected = MUST(bitmap->clone());
+        apply_color_filter(*expected, grayscale);
+        apply_color_filter(*expected, darken);
+        apply_color_filter(*expected, invert);
+        pipeline.apply(*bitmap);
+        expect_close_enough(*bitmap, *expected, 1);
+    }
+
+    {
+        // Note: Brightening pushes channels out of range, so they have to be clamped before inverting.
+        Gfx::FilterPipeline pipeline;
+        pipeline.add_color_filter(brighten);
+        pipeline.add_color_filter(invert);
+        EXPECT_EQ(pipeline.pass_count(), 2u);
+
+        auto bitmap = create_random_bitmap({ 40, 30 });
+        auto expected = MUST(bitmap->clone());
+        apply_color_filter(*expected, brighten);
+        apply_color_filter(*expected, invert);
+        pipeline.apply(*bitmap);
+        expect_close_enough(*bitmap, *expected, 1);
+    }
+}
+
+static NonnullRefPtr<Gfx::Bitmap> create_striped_bitmap(Gfx::IntSize size)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, size));
+    for (int x = 0; x < size.width(); ++x) {
+        auto color = Gfx::Color(x * 7, 255 - x, x * 13, x % 5 == 0 ? 0 : 200);
+        for (int y = 0; y < size.height(); ++y)
+            bitmap->set_pixel(x, y, color);
+    }
+    return bitmap;
+}
+
+static void expect_all_rows_equal(Gfx::Bitmap const& bitmap)
+{
+    for (int y = 1; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+            if (bitmap.scanline(y)[x] != bitmap.scanline(0)[x]) {
+                FAIL(DeprecatedString::formatted("Pixel {},{} differs from the one in the first row", x, y));
+                return;
+            }
+        }
+    }
+}
+
+TEST_CASE(blurs_treat_all_rows_and_columns_the_same)
+{
+    // Note: The bitmap is large enough for its rows and columns to be blurred in chunks, possibly on other threads.
+    Gfx::IntSize size { 512, 300 };
+
+    auto stack_blurred = create_striped_bitmap(size);
+    Gfx::StackBlurFilter { *stack_blurred }.process_rgba(9, Gfx::Color::Transparent);
+    expect_all_rows_equal(*stack_blurred);
+    EXPECT_NE(stack_blurred->scanline(0)[100], create_striped_bitmap(size)->scanline(0)[100]);
+
+    auto box_blurred = create_striped_bitmap(size);
+    Gfx::FastBoxBlurFilter { *box_blurred }.apply_three_passes(9);
+    expect_all_rows_equal(*box_blurred);
+    EXPECT_NE(box_blurred->scanline(0)[100], create_striped_bitmap(size)->scanline(0)[100]);
+}
+
+TEST_CASE(blurs_keep_uniform_bitmaps)
+{
+    auto color = Gfx::Color(30, 140, 250, 255);
+    auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, { 100, 70 }));
+    bitmap->fill(color);
+
+    Gfx::FastBoxBlurFilter { *bitmap }.apply_single_pass(4, 7);
+    for (int y = 0; y < bitmap->height(); ++y) {
+        for (int x = 0; x < bitmap->width(); ++x)
+            EXPECT_EQ(bitmap->get_pixel(x, y), color);
+    }
+}
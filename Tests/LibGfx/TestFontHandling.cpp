@@ -5,8 +5,13 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Utf32View.h>
+#include <AK/Utf8View.h>
 #include <LibGfx/Font/BitmapFont.h>
 #include <LibGfx/Font/FontDatabase.h>
+#include <LibGfx/Font/OpenType/Font.h>
+#include <LibGfx/Font/ScaledFont.h>
+#include <LibGfx/Painter.h>
 #include <LibTest/TestCase.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -18,6 +23,12 @@
 #    define TEST_INPUT(x) ("test-inputs/" x)
 #endif
 
+#ifdef AK_OS_SERENITY
+#    define FONT_PATH(x) ("/res/fonts/" x)
+#else
+#    define FONT_PATH(x) ("../../Base/res/fonts/" x)
+#endif
+
 TEST_CASE(test_fontdatabase_get_by_name)
 {
     Gfx::FontDatabase::set_default_fonts_lookup_path(TEST_INPUT(""));
@@ -163,3 +174,91 @@ TEST_CASE(test_character_set_masking)
     EXPECT(!masked_font.value()->glyph_index(0x0100).has_value());
     EXPECT(masked_font.value()->glyph_index(0xFFFD).value() == 0x1FD);
 }
+
+TEST_CASE(test_scaled_font_glyphs_share_an_atlas)
+{
+    auto vector_font = MUST(OpenType::Font::try_load_from_file(FONT_PATH("LiberationSerif-Regular.ttf")));
+    auto font_ref = adopt_ref(*new Gfx::ScaledFont(vector_font, 12, 12));
+    auto& font = *font_ref;
+    float scale = (12.0f * DEFAULT_DPI) / (POINTS_PER_INCH * vector_font->units_per_em());
+
+    Vector<Gfx::Glyph> glyphs;
+    for (auto code_point : Utf8View("Hello, friends!"sv)) {
+        if (code_point == ' ')
+            continue;
+        auto glyph = font.glyph(code_point, { 1, 0 });
+        EXPECT(!glyph.is_glyph_bitmap());
+        EXPECT_EQ(glyph.bitmap(), glyphs.is_empty() ? glyph.bitmap() : glyphs.first().bitmap());
+        for (auto& other_glyph : glyphs)
+            EXPECT(!glyph.bitmap_rect().intersects(other_glyph.bitmap_rect()) || glyph.bitmap_rect() == other_glyph.bitmap_rect());
+
+        auto expected = vector_font->rasterize_glyph(font.glyph_id_for_code_point(code_point), scale, scale, { 1, 0 });
+        EXPECT_EQ(glyph.bitmap_rect().size(), expected->size());
+        for (int y = 0; y < expected->height(); ++y) {
+            for (int x = 0; x < expected->width(); ++x)
+                EXPECT_EQ(glyph.bitmap()->get_pixel(glyph.bitmap_rect().location().translated(x, y)), expected->get_pixel(x, y));
+        }
+        glyphs.append(move(glyph));
+    }
+}
+
+TEST_CASE(test_scaled_font_draws_glyphs_in_color)
+{
+    auto vector_font = MUST(OpenType::Font::try_load_from_file(FONT_PATH("LiberationSerif-Regular.ttf")));
+    auto font_ref = adopt_ref(*new Gfx::ScaledFont(vector_font, 20, 20));
+    auto& font = *font_ref;
+
+    for (auto format : { Gfx::BitmapFormat::BGRx8888, Gfx::BitmapFormat::BGRA8888 }) {
+        for (auto color : { Gfx::Color(Gfx::Color::Black), Gfx::Color(200, 30, 90, 150) }) {
+            auto bitmap = MUST(Gfx::Bitmap::create(format, { 60, 40 }));
+            bitmap->fill(Gfx::Color(20, 200, 240, format == Gfx::BitmapFormat::BGRA8888 ? 230 : 255));
+            auto background = MUST(bitmap->clone());
+            auto expected = MUST(bitmap->clone());
+
+            Gfx::Painter painter(*bitmap);
+            painter.add_clip_rect({ 5, 5, 50, 30 });
+            struct {
+                Gfx::FloatPoint position;
+                u32 code_point;
+            } glyphs[] = { { { 3, 10 }, 'W' }, { { 30.4f, 2 }, 'g' } };
+            for (auto& glyph : glyphs)
+                painter.draw_glyph(glyph.position, glyph.code_point, font, color);
+
+            // Blitting separately rasterized glyph bitmaps like this is how glyphs used to be drawn.
+            Gfx::Painter expected_painter(*expected);
+            expected_painter.add_clip_rect({ 5, 5, 50, 30 });
+            for (auto& [position, code_point] : glyphs) {
+                auto top_left = position + Gfx::FloatPoint(font.glyph_left_bearing(code_point), 0);
+                auto glyph_position = Gfx::GlyphRasterPosition::get_nearest_fit_for(top_left);
+                auto glyph = font.glyph(code_point, glyph_position.subpixel_offset);
+                auto glyph_bitmap = MUST(glyph.bitmap()->cropped(glyph.bitmap_rect()));
+                expected_painter.blit_filtered(glyph_position.blit_position, *glyph_bitmap, glyph_bitmap->rect(), [color](Gfx::Color pixel) {
+                    return pixel.multiply(color);
+                });
+            }
+
+            EXPECT(bitmap->visually_equals(*expected));
+            EXPECT(!bitmap->visually_equals(*background));
+        }
+    }
+}
+
+TEST_CASE(test_scaled_font_text_width)
+{
+    auto vector_font = MUST(OpenType::Font::try_load_from_file(FONT_PATH("LiberationSerif-Regular.ttf")));
+    auto font_ref = adopt_ref(*new Gfx::ScaledFont(vector_font, 12, 12));
+    auto& font = *font_ref;
+
+    float width = 0;
+    u32 last_code_point = 0;
+    for (auto code_point : Utf8View("AVery long word"sv)) {
+        width += font.glyphs_horizontal_kerning(last_code_point, code_point) + font.glyph_width(code_point);
+        last_code_point = code_point;
+    }
+
+    EXPECT_EQ(font.width("AVery long word"sv), width);
+    // The second time around, the width comes from the cache.
+    EXPECT_EQ(font.width(Utf8View("AVery long word"sv)), width);
+    Array<u32, 10> code_points { 'A', 'V', 'e', 'r', 'y', ' ', 'l', 'o', 'n', 'g' };
+    EXPECT_EQ(font.width("AVery long"sv), font.width(Utf32View(code_points.data(), code_points.size())));
+}
@@ -153,6 +153,72 @@ TEST_CASE(test_png)
     EXPECT(frame.duration == 0);
 }
 
+TEST_CASE(test_interlaced_png_taller_than_wide)
+{
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("interlaced-tall.png"sv)));
+    auto frame = MUST(MUST(Gfx::PNGImageDecoderPlugin::create(file->bytes()))->frame(0));
+    EXPECT_EQ(frame.image->size(), Gfx::IntSize(6, 20));
+    for (int y = 0; y < 20; ++y) {
+        for (int x = 0; x < 6; ++x)
+            EXPECT_EQ(frame.image->get_pixel(x, y), Gfx::Color(x * 40, y * 12, (x + y) * 8));
+    }
+}
+
+TEST_CASE(test_png_partial_frame)
+{
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("buggie.png"sv)));
+    auto full_frame = MUST(MUST(Gfx::PNGImageDecoderPlugin::create(file->bytes()))->frame(0));
+
+    auto complete_frame = MUST(MUST(Gfx::PNGImageDecoderPlugin::create(file->bytes()))->partial_frame());
+    EXPECT_EQ(complete_frame.image->format(), full_frame.image->format());
+    for (int y = 0; y < full_frame.image->height(); ++y) {
+        for (int x = 0; x < full_frame.image->width(); ++x)
+            EXPECT_EQ(complete_frame.image->get_pixel(x, y), full_frame.image->get_pixel(x, y));
+    }
+
+    // Note: Only the rows that have arrived are shown, everything below them is transparent.
+    auto truncated_bytes = file->bytes().trim(file->size() / 2);
+    auto truncated_decoder = MUST(Gfx::PNGImageDecoderPlugin::create(truncated_bytes));
+    EXPECT(truncated_decoder->frame(0).is_error());
+    auto partial_frame = MUST(MUST(Gfx::PNGImageDecoderPlugin::create(truncated_bytes))->partial_frame());
+    EXPECT_EQ(partial_frame.image->size(), full_frame.image->size());
+
+    auto rows_equal = [&](int y) {
+        for (int x = 0; x < full_frame.image->width(); ++x) {
+            if (partial_frame.image->get_pixel(x, y) != full_frame.image->get_pixel(x, y))
+                return false;
+        }
+        return true;
+    };
+    int decoded_rows = 0;
+    while (decoded_rows < full_frame.image->height() && rows_equal(decoded_rows))
+        ++decoded_rows;
+    EXPECT(decoded_rows > 0);
+    EXPECT(decoded_rows < full_frame.image->height());
+    for (int y = decoded_rows; y < full_frame.image->height(); ++y) {
+        for (int x = 0; x < full_frame.image->width(); ++x)
+            EXPECT_EQ(partial_frame.image->get_pixel(x, y).alpha(), 0);
+    }
+}
+
+TEST_CASE(test_interlaced_png_partial_frame)
+{
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("interlaced.png"sv)));
+    auto full_frame = MUST(MUST(Gfx::PNGImageDecoderPlugin::create(file->bytes()))->frame(0));
+    EXPECT_EQ(full_frame.image->size(), Gfx::IntSize(64, 64));
+    EXPECT_EQ(full_frame.image->get_pixel(4, 7), Gfx::Color(16, 28, 12, 255));
+    EXPECT_EQ(full_frame.image->get_pixel(63, 63), Gfx::Color(252, 252, 0, 128));
+
+    // Note: The image data is stored uncompressed, and this cuts it off in the middle of the sixth pass. The first five
+    //       passes have a pixel in every other row and column, which the missing ones are filled in from.
+    auto truncated_bytes = file->bytes().trim(6200);
+    auto partial_frame = MUST(MUST(Gfx::PNGImageDecoderPlugin::create(truncated_bytes))->partial_frame());
+    for (int y = 0; y < 64; ++y) {
+        for (int x = 0; x < 64; ++x)
+            EXPECT_EQ(partial_frame.image->get_pixel(x, y), full_frame.image->get_pixel(x & ~1, y & ~1));
+    }
+}
+
 TEST_CASE(test_ppm)
 {
     auto file = MUST(Core::MappedFile::map(TEST_INPUT("buggie-raw.ppm"sv)));
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Random.h>
+#include <LibGfx/AntiAliasingPainter.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Painter.h>
+#include <LibGfx/Path.h>
+#include <math.h>
+
+static NonnullRefPtr<Gfx::Bitmap> create_random_bitmap(Gfx::BitmapFormat format, Gfx::IntSize size)
+{
+    auto bitmap = MUST(Gfx::Bitmap::create(format, size));
+    for (int y = 0; y < size.height(); ++y) {
+        for (int x = 0; x < size.width(); ++x) {
+            auto value = get_random<u32>();
+            // Make plenty of pixels opaque, and plenty of them fully transparent.
+            if (value & 0x100)
+                value |= 0xff000000;
+            else if (value & 0x200)
+                value &= 0x00ffffff;
+            bitmap->scanline(y)[x] = value;
+        }
+    }
+    return bitmap;
+}
+
+TEST_CASE(fill_rect_with_alpha_matches_color_blend)
+{
+    for (auto format : { Gfx::BitmapFormat::BGRx8888, Gfx::BitmapFormat::BGRA8888 }) {
+        auto bitmap = create_random_bitmap(format, { 67, 31 });
+        auto expected = MUST(bitmap->clone());
+
+        for (auto alpha : { 1, 77, 128, 254 }) {
+            Gfx::Color color { 12, 200, 99, static_cast<u8>(alpha) };
+            Gfx::Painter painter(*bitmap);
+            painter.fill_rect({ 3, 2, 61, 27 }, color);
+
+            for (int y = 2; y < 29; ++y) {
+                for (int x = 3; x < 64; ++x) {
+                    auto& pixel = expected->scanline(y)[x];
+                    pixel = Gfx::Color::from_argb(pixel).blend(color).value();
+                }
+            }
+            for (int y = 0; y < 31; ++y) {
+                for (int x = 0; x < 67; ++x)
+                    EXPECT_EQ(bitmap->scanline(y)[x], expected->scanline(y)[x]);
+            }
+        }
+    }
+}
+
+TEST_CASE(blit_with_alpha_matches_color_blend)
+{
+    auto source = create_random_bitmap(Gfx::BitmapFormat::BGRA8888, { 45, 20 });
+
+    for (auto target_format : { Gfx::BitmapFormat::BGRx8888, Gfx::BitmapFormat::BGRA8888 }) {
+        for (auto opacity : { 1.0f, 0.6f }) {
+            auto target = create_random_bitmap(target_format, { 50, 25 });
+            auto expected = MUST(target->clone());
+
+            Gfx::Painter painter(*target);
+            painter.blit({ 2, 3 }, *source, source->rect(), opacity);
+
+            for (int y = 0; y < 20; ++y) {
+                for (int x = 0; x < 45; ++x) {
+                    auto& pixel = expected->scanline(y + 3)[x + 2];
+                    auto destination = target_format == Gfx::BitmapFormat::BGRA8888 ? Gfx::Color::from_argb(pixel) : Gfx::Color::from_rgb(pixel);
+                    auto source_color = Gfx::Color::from_argb(source->scanline(y)[x]);
+                    float pixel_opacity = source_color.alpha() / 255.0;
+                    source_color.set_alpha(255 * (opacity * pixel_opacity));
+                    pixel = destination.blend(source_color).value();
+                }
+            }
+            for (int y = 0; y < 25; ++y) {
+                for (int x = 0; x < 50; ++x)
+                    EXPECT_EQ(target->scanline(y)[x], expected->scanline(y)[x]);
+            }
+        }
+    }
+}
+
+TEST_CASE(blend_over_opaque_pixels_is_exact_for_all_inputs)
+{
+    // Every combination of source alpha, source channel and destination channel, in the red channel at least.
+    auto source = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, { 256, 256 }));
+    auto target = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { 256, 256 }));
+
+    for (int alpha = 0; alpha < 256; ++alpha) {
+        for (int y = 0; y < 256; ++y) {
+            for (int x = 0; x < 256; ++x) {
+                source->scanline(y)[x] = Gfx::Color(x, y, x ^ y, alpha).value();
+                target->scanline(y)[x] = Gfx::Color(y, x, 255 - x).value();
+            }
+        }
+
+        Gfx::Painter painter(*target);
+        painter.blit({}, *source, source->rect());
+
+        for (int y = 0; y < 256; ++y) {
+            for (int x = 0; x < 256; ++x) {
+                auto expected = Gfx::Color(y, x, 255 - x).blend(Gfx::Color(x, y, x ^ y, alpha));
+                if (target->scanline(y)[x] != expected.value()) {
+                    FAIL(DeprecatedString::formatted("Blending {} over {} went wrong", Gfx::Color(x, y, x ^ y, alpha), Gfx::Color(y, x, 255 - x)));
+                    return;
+                }
+            }
+        }
+    }
+}
+
+static Gfx::Path rect_path(Gfx::FloatRect const& rect)
+{
+    Gfx::Path path;
+    path.move_to(rect.top_left());
+    path.line_to({ rect.x() + rect.width(), rect.y() });
+    path.line_to({ rect.x() + rect.width(), rect.y() + rect.height() });
+    path.line_to({ rect.x(), rect.y() + rect.height() });
+    path.close();
+    return path;
+}
+
+static float overlap(float pixel, float from, float to)
+{
+    return max(0.0f, min(pixel + 1.0f, to) - max(pixel, from));
+}
+
+TEST_CASE(anti_aliased_fill_path_covers_pixels_partially)
+{
+    Gfx::FloatRect rect { 10.25f, 5.5f, 40.5f, 20.75f };
+    for (auto format : { Gfx::BitmapFormat::BGRx8888, Gfx::BitmapFormat::BGRA8888 }) {
+        auto bitmap = MUST(Gfx::Bitmap::create(format, { 64, 32 }));
+        bitmap->fill(Gfx::Color::White);
+        Gfx::Painter painter(*bitmap);
+        Gfx::AntiAliasingPainter aa_painter(painter);
+        aa_painter.fill_path(rect_path(rect), Gfx::Color::Black);
+
+        for (int y = 0; y < 32; ++y) {
+            for (int x = 0; x < 64; ++x) {
+                auto coverage = overlap(x, rect.x(), rect.x() + rect.width()) * overlap(y, rect.y(), rect.y() + rect.height());
+                auto expected = 255 - static_cast<int>(roundf(coverage * 255));
+                auto actual = bitmap->get_pixel(x, y).red();
+                if (abs(actual - expected) > 1) {
+                    FAIL(DeprecatedString::formatted("Pixel {},{} is {} instead of {}", x, y, actual, expected));
+                    return;
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(anti_aliased_fill_path_winding_rules)
+{
+    // Note: Both squares go round in the same direction, so the inner one is only a hole with the even-odd rule.
+    Gfx::Path path;
+    path.move_to({ 2, 2 });
+    path.line_to({ 22, 2 });
+    path.line_to({ 22, 22 });
+    path.line_to({ 2, 22 });
+    path.close();
+    path.move_to({ 8, 8 });
+    path.line_to({ 16, 8 });
+    path.line_to({ 16, 16 });
+    path.line_to({ 8, 16 });
+    path.close();
+
+    for (auto rule : { Gfx::Painter::WindingRule::Nonzero, Gfx::Painter::WindingRule::EvenOdd }) {
+        auto bitmap = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, { 24, 24 }));
+        bitmap->fill(Gfx::Color::White);
+        Gfx::Painter painter(*bitmap);
+        Gfx::AntiAliasingPainter aa_painter(painter);
+        aa_painter.fill_path(path, Gfx::Color::Black, rule);
+
+        EXPECT_EQ(bitmap->get_pixel(0, 0), Gfx::Color::White);
+        EXPECT_EQ(bitmap->get_pixel(4, 12), Gfx::Color::Black);
+        EXPECT_EQ(bitmap->get_pixel(12, 12), rule == Gfx::Painter::WindingRule::EvenOdd ? Gfx::Color::White : Gfx::Color::Black);
+    }
+}
+
+static Gfx::Path star_path(Gfx::FloatPoint center, float radius)
+{
+    Gfx::Path path;
+    for (int i = 0; i < 11; ++i) {
+        float angle = i * 4 * AK::Pi<float> / 11;
+        Gfx::FloatPoint point { center.x() + radius * cosf(angle), center.y() + radius * sinf(angle) };
+        if (i == 0)
+            path.move_to(point);
+        else
+            path.line_to(point);
+    }
+    path.close();
+    return path;
+}
+
+TEST_CASE(anti_aliased_fill_path_is_independent_of_clipping)
+{
+    // Note: This is large enough to be rasterized in several bands, partly outside the bitmap.
+    auto path = star_path({ 300.3f, 250.7f }, 330);
+    Gfx::IntSize size { 600, 520 };
+
+    for (auto rule : { Gfx::Painter::WindingRule::Nonzero, Gfx::Painter::WindingRule::EvenOdd }) {
+        auto expected = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, size));
+        expected->fill(Gfx::Color::White);
+        {
+            Gfx::Painter painter(*expected);
+            Gfx::AntiAliasingPainter aa_painter(painter);
+            aa_painter.fill_path(path, Gfx::Color::Blue, rule);
+        }
+        if (rule == Gfx::Painter::WindingRule::Nonzero)
+            EXPECT_EQ(expected->get_pixel(300, 250), Gfx::Color::Blue);
+
+        auto actual = MUST(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, size));
+        actual->fill(Gfx::Color::White);
+        for (auto clip_rect : { Gfx::IntRect { 0, 0, 211, 97 }, Gfx::IntRect { 211, 0, 389, 97 }, Gfx::IntRect { 0, 97, 600, 423 } }) {
+            Gfx::Painter painter(*actual);
+            painter.add_clip_rect(clip_rect);
+            Gfx::AntiAliasingPainter aa_painter(painter);
+            aa_painter.fill_path(path, Gfx::Color::Blue, rule);
+        }
+
+        for (int y = 0; y < size.height(); ++y) {
+            for (int x = 0; x < size.width(); ++x) {
+                auto actual_color = actual->get_pixel(x, y);
+                auto expected_color = expected->get_pixel(x, y);
+                if (abs(actual_color.red() - expected_color.red()) > 1 || abs(actual_color.blue() - expected_color.blue()) > 1) {
+                    FAIL(DeprecatedString::formatted("Pixel {},{} is {} instead of {}", x, y, actual_color, expected_color));
+                    return;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCompress/Brotli.h>
+#include <LibCompress/Deflate.h>
+#include <LibCompress/Gzip.h>
+#include <LibCompress/Zlib.h>
+#include <LibCompress/Zstd.h>
+#include <LibHTTP/ContentDecoder.h>
+#include <LibTest/TestCase.h>
+
+// Text that compresses to about half its size, so that a good part of the body can be decoded before all of it has arrived.
+static ByteBuffer make_body(size_t size)
+{
+    auto body = ByteBuffer::create_uninitialized(size).release_value();
+    u32 state = 1;
+    for (auto& byte : body.bytes()) {
+        state = state * 1103515245 + 12345;
+        byte = "abcdefghijklmnop"[(state >> 16) % 16];
+    }
+    return body;
+}
+
+struct DecodedBody {
+    ByteBuffer data;
+    size_t size_decoded_while_receiving { 0 };
+};
+
+static DecodedBody decode_in_pieces(StringView content_coding, ReadonlyBytes encoded_body, size_t piece_size)
+{
+    auto decoder = MUST(HTTP::ContentDecoder::create(content_coding));
+    VERIFY(decoder);
+
+    DecodedBody decoded_body;
+    for (size_t offset = 0; offset < encoded_body.size(); offset += piece_size) {
+        MUST(decoder->append(encoded_body.slice(offset, min(piece_size, encoded_body.size() - offset))));
+        while (true) {
+            auto decoded = MUST(decoder->decode(false));
+            if (decoded.is_empty())
+                break;
+            decoded_body.data.append(decoded);
+        }
+    }
+    decoded_body.size_decoded_while_receiving = decoded_body.data.size();
+
+    while (true) {
+        auto decoded = MUST(decoder->decode(true));
+        if (decoded.is_empty())
+            break;
+        decoded_body.data.append(decoded);
+    }
+    EXPECT_EQ(decoder->buffered_input_size(), 0u);
+    return decoded_body;
+}
+
+static void expect_streamed_decoding(StringView content_coding, ReadonlyBytes body, ReadonlyBytes encoded_body)
+{
+    for (size_t piece_size : { size_t { 1000 }, size_t { 16384 }, encoded_body.size() }) {
+        auto decoded_body = decode_in_pieces(content_coding, encoded_body, piece_size);
+        EXPECT(decoded_body.data.bytes() == body);
+        if (piece_size < encoded_body.size())
+            EXPECT(decoded_body.size_decoded_while_receiving > 0);
+    }
+}
+
+TEST_CASE(gzip)
+{
+    auto body = make_body(2 * MiB);
+    expect_streamed_decoding("gzip"sv, body, MUST(Compress::GzipCompressor::compress_all(body)));
+}
+
+TEST_CASE(deflate_with_zlib_wrapper)
+{
+    auto body = make_body(2 * MiB);
+    expect_streamed_decoding("deflate"sv, body, MUST(Compress::ZlibCompressor::compress_all(body)));
+}
+
+TEST_CASE(deflate_without_zlib_wrapper)
+{
+    auto body = make_body(2 * MiB);
+    expect_streamed_decoding("deflate"sv, body, MUST(Compress::DeflateCompressor::compress_all(body)));
+}
+
+TEST_CASE(brotli)
+{
+    auto body = make_body(2 * MiB);
+    expect_streamed_decoding("br"sv, body, MUST(Compress::BrotliCompressionStream::compress_all(body)));
+}
+
+TEST_CASE(zstd)
+{
+    auto body = make_body(2 * MiB);
+    expect_streamed_decoding("zstd"sv, body, MUST(Compress::ZstdCompressor::compress_all(body)));
+}
+
+TEST_CASE(small_body_is_decoded_once_complete)
+{
+    auto body = make_body(1000);
+    auto decoded_body = decode_in_pieces("gzip"sv, MUST(Compress::GzipCompressor::compress_all(body)), 100);
+    EXPECT_EQ(decoded_body.size_decoded_while_receiving, 0u);
+    EXPECT(decoded_body.data.bytes() == body.bytes());
+}
+
+TEST_CASE(empty_body)
+{
+    for (auto content_coding : { "gzip"sv, "deflate"sv, "br"sv, "zstd"sv }) {
+        auto decoder = MUST(HTTP::ContentDecoder::create(content_coding));
+        EXPECT(MUST(decoder->decode(true)).is_empty());
+    }
+}
+
+TEST_CASE(unknown_coding)
+{
+    EXPECT(!MUST(HTTP::ContentDecoder::create("identity"sv)));
+    EXPECT(!MUST(HTTP::ContentDecoder::create("compress"sv)));
+    EXPECT(MUST(HTTP::ContentDecoder::create(" GZip "sv)));
+}
+
+TEST_CASE(corrupt_body)
+{
+    auto body = make_body(64 * KiB);
+    auto encoded_body = MUST(Compress::GzipCompressor::compress_all(body));
+    encoded_body[encoded_body.size() / 2] ^= 0xff;
+    encoded_body[encoded_body.size() / 2 + 1] ^= 0xff;
+
+    auto decoder = MUST(HTTP::ContentDecoder::create("gzip"sv));
+    MUST(decoder->append(encoded_body));
+    ErrorOr<ByteBuffer> decoded = ByteBuffer {};
+    do {
+        decoded = decoder->decode(true);
+    } while (!decoded.is_error() && !decoded.value().is_empty());
+    EXPECT(decoded.is_error());
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibHTTP/HPACK.h>
+#include <LibTest/TestCase.h>
+
+using HTTP::HPACK::Header;
+
+static ByteBuffer from_hex(StringView hex)
+{
+    auto buffer = ByteBuffer::create_uninitialized(hex.length() / 2).release_value();
+    for (size_t i = 0; i < buffer.size(); ++i)
+        buffer[i] = AK::StringUtils::convert_to_uint_from_hex<u8>(hex.substring_view(i * 2, 2)).value();
+    return buffer;
+}
+
+static void expect_headers(Vector<Header> const& actual, Vector<Header> const& expected)
+{
+    EXPECT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < min(actual.size(), expected.size()); ++i) {
+        EXPECT_EQ(actual[i].name, expected[i].name);
+        EXPECT_EQ(actual[i].value, expected[i].value);
+    }
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#appendix-C.1
+TEST_CASE(integer_representation)
+{
+    ByteBuffer buffer;
+    MUST(HTTP::HPACK::encode_integer(10, 5, 0, buffer));
+    EXPECT_EQ(buffer, from_hex("0a"sv));
+
+    buffer.clear();
+    MUST(HTTP::HPACK::encode_integer(1337, 5, 0, buffer));
+    EXPECT_EQ(buffer, from_hex("1f9a0a"sv));
+
+    buffer.clear();
+    MUST(HTTP::HPACK::encode_integer(42, 8, 0, buffer));
+    EXPECT_EQ(buffer, from_hex("2a"sv));
+
+    auto encoded = from_hex("1f9a0a"sv);
+    ReadonlyBytes input = encoded;
+    EXPECT_EQ(MUST(HTTP::HPACK::decode_integer(input, 5)), 1337u);
+    EXPECT(input.is_empty());
+}
+
+TEST_CASE(integer_overflow)
+{
+    auto encoded = from_hex("1fffffffffffffffffffff7f"sv);
+    ReadonlyBytes input = encoded;
+    EXPECT(HTTP::HPACK::decode_integer(input, 5).is_error());
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#appendix-C.3
+TEST_CASE(request_examples_without_huffman_coding)
+{
+    HTTP::HPACK::Decoder decoder;
+
+    expect_headers(MUST(decoder.decode(from_hex("828684410f7777772e6578616d706c652e636f6d"sv))),
+        { { ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" } });
+    EXPECT_EQ(decoder.dynamic_table_size(), 57u);
+
+    expect_headers(MUST(decoder.decode(from_hex("828684be58086e6f2d6361636865"sv))),
+        { { ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" }, { "cache-control", "no-cache" } });
+    EXPECT_EQ(decoder.dynamic_table_size(), 110u);
+
+    expect_headers(MUST(decoder.decode(from_hex("828785bf400a637573746f6d2d6b65790c637573746f6d2d76616c7565"sv))),
+        { { ":method", "GET" }, { ":scheme", "https" }, { ":path", "/index.html" }, { ":authority", "www.example.com" }, { "custom-key", "custom-value" } });
+    EXPECT_EQ(decoder.dynamic_table_size(), 164u);
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#appendix-C.4
+TEST_CASE(request_examples_with_huffman_coding)
+{
+    HTTP::HPACK::Decoder decoder;
+
+    expect_headers(MUST(decoder.decode(from_hex("828684418cf1e3c2e5f23a6ba0ab90f4ff"sv))),
+        { { ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" } });
+
+    expect_headers(MUST(decoder.decode(from_hex("828684be5886a8eb10649cbf"sv))),
+        { { ":method", "GET" }, { ":scheme", "http" }, { ":path", "/" }, { ":authority", "www.example.com" }, { "cache-control", "no-cache" } });
+
+    expect_headers(MUST(decoder.decode(from_hex("828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf"sv))),
+        { { ":method", "GET" }, { ":scheme", "https" }, { ":path", "/index.html" }, { ":authority", "www.example.com" }, { "custom-key", "custom-value" } });
+    EXPECT_EQ(decoder.dynamic_table_size(), 164u);
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#appendix-C.6
+TEST_CASE(response_examples_with_eviction)
+{
+    HTTP::HPACK::Decoder decoder { 256 };
+
+    expect_headers(MUST(decoder.decode(from_hex("488264025885aec3771a4b6196d07abe941054d444a8200595040b8166e082a62d1bff6e919d29ad171863c78f0b97c8e9ae82ae43d3"sv))),
+        { { ":status", "302" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:21 GMT" }, { "location", "https://www.example.com" } });
+    EXPECT_EQ(decoder.dynamic_table_size(), 222u);
+
+    expect_headers(MUST(decoder.decode(from_hex("4883640effc1c0bf"sv))),
+        { { ":status", "307" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:21 GMT" }, { "location", "https://www.example.com" } });
+    EXPECT_EQ(decoder.dynamic_table_size(), 222u);
+
+    expect_headers(MUST(decoder.decode(from_hex("88c16196d07abe941054d444a8200595040b8166e084a62d1bffc05a839bd9ab77ad94e7821dd7f2e6c7b335dfdfcd5b3960d5af27087f3672c1ab270fb5291f9587316065c003ed4ee5b1063d5007"sv))),
+        { { ":status", "200" }, { "cache-control", "private" }, { "date", "Mon, 21 Oct 2013 20:13:22 GMT" }, { "location", "https://www.example.com" }, { "content-encoding", "gzip" }, { "set-cookie", "foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1" } });
+    EXPECT_EQ(decoder.dynamic_table_size(), 215u);
+}
+
+TEST_CASE(index_out_of_range)
+{
+    HTTP::HPACK::Decoder decoder;
+    EXPECT(decoder.decode(from_hex("be"sv)).is_error());
+}
+
+TEST_CASE(huffman_roundtrip)
+{
+    auto input = "https://www.example.com/index.html?q=\x01\xff"sv;
+    ByteBuffer encoded;
+    MUST(HTTP::HPACK::huffman_encode(input, encoded));
+    EXPECT_EQ(encoded.size(), HTTP::HPACK::huffman_encoded_length(input));
+    EXPECT_EQ(MUST(HTTP::HPACK::huffman_decode(encoded)), input);
+}
+
+TEST_CASE(encoder_roundtrip)
+{
+    Vector<Header> headers {
+        { ":method", "POST" },
+        { ":path", "/upload" },
+        { "authorization", "Bearer secret" },
+        { "x-custom", "a value that does not compress well: \x7f\x80" },
+    };
+
+    ByteBuffer encoded;
+    MUST(HTTP::HPACK::Encoder {}.encode(headers, encoded));
+
+    HTTP::HPACK::Decoder decoder;
+    expect_headers(MUST(decoder.decode(encoded)), headers);
+    EXPECT_EQ(decoder.dynamic_table_size(), 0u);
+}
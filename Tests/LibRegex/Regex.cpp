@@ -1025,6 +1025,38 @@ TEST_CASE(optimizer_alternation)
     }
 }
 
+TEST_CASE(optimizer_possible_match_starts)
+{
+    {
+        Regex<ECMA262> re("foo(bar|baz)"sv, ECMAScriptFlags::Global);
+        EXPECT_EQ(re.parser_result.optimization_data.literal_prefix.size(), 3u);
+        auto result = re.match("foobaz fooba foobar"sv);
+        EXPECT_EQ(result.matches.size(), 2u);
+        EXPECT_EQ(result.matches[0].view.to_deprecated_string(), "foobaz"sv);
+        EXPECT_EQ(result.matches[1].view.to_deprecated_string(), "foobar"sv);
+    }
+    {
+        Regex<ECMA262> re("x|[0-9]+"sv, ECMAScriptFlags::Global);
+        EXPECT(re.parser_result.optimization_data.literal_prefix.is_empty());
+        EXPECT_EQ(re.parser_result.optimization_data.starting_ranges.size(), 2u);
+        auto result = re.match("abc 123 x"sv);
+        EXPECT_EQ(result.matches.size(), 2u);
+        EXPECT_EQ(result.matches[0].view.to_deprecated_string(), "123"sv);
+        EXPECT_EQ(result.matches[1].view.to_deprecated_string(), "x"sv);
+    }
+    {
+        // Anything that can match the empty string can start anywhere.
+        Regex<ECMA262> re("a*"sv, ECMAScriptFlags::Global);
+        EXPECT(re.parser_result.optimization_data.starting_ranges.is_empty());
+    }
+    {
+        Regex<ECMA262> re("ERROR"sv, ECMAScriptFlags::Global | ECMAScriptFlags::Insensitive);
+        auto result = re.match("some error"sv);
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.matches.first().view.to_deprecated_string(), "error"sv);
+    }
+}
+
 TEST_CASE(posix_basic_dollar_is_end_anchor)
 {
     // Ensure that a dollar sign at the end only matches the end of the line.
@@ -1123,3 +1155,64 @@ TEST_CASE(inversion_state_in_char_class)
         EXPECT_EQ(result.capture_group_matches.first()[1].view.to_deprecated_string(), "}"sv);
     }
 }
+
+TEST_CASE(patterns_without_backtracking)
+{
+    {
+        // Nested repetitions used to take exponential time to fail.
+        Regex<ECMA262> re("(a*)*b"sv, ECMAScriptFlags::Global);
+        auto result = re.match(DeprecatedString::repeated('a', 64));
+        EXPECT_EQ(result.success, false);
+    }
+    {
+        Regex<ECMA262> re("(a|aa)*c"sv, ECMAScriptFlags::Global);
+        auto subject = DeprecatedString::formatted("x{}c", DeprecatedString::repeated('a', 64));
+        auto result = re.match(subject);
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.matches.first().view.to_deprecated_string(), subject.substring_view(1));
+        EXPECT_EQ(result.capture_group_matches.first()[0].view.to_deprecated_string(), "a"sv);
+    }
+    {
+        // The same captures as the backtracking VM would have found.
+        Regex<ECMA262> re("(a|ab)(c|bcd)(d*)"sv, ECMAScriptFlags::Global | (ECMAScriptFlags)regex::AllFlags::SingleMatch);
+        auto result = re.match("xabcd"sv);
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.matches.first().view.to_deprecated_string(), "abcd"sv);
+        EXPECT_EQ(result.capture_group_matches.first()[0].view.to_deprecated_string(), "a"sv);
+        EXPECT_EQ(result.capture_group_matches.first()[1].view.to_deprecated_string(), "bcd"sv);
+        EXPECT_EQ(result.capture_group_matches.first()[2].view.to_deprecated_string(), ""sv);
+    }
+    {
+        // A group from an alternative that failed at an earlier position shouldn't have a match.
+        Regex<ECMA262> re("b|(a)x"sv, ECMAScriptFlags::Global | (ECMAScriptFlags)regex::AllFlags::SingleMatch | (ECMAScriptFlags)regex::AllFlags::SkipTrimEmptyMatches);
+        auto result = re.match("ac b"sv);
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.matches.first().view.to_deprecated_string(), "b"sv);
+        EXPECT(result.capture_group_matches.first()[0].view.is_null());
+    }
+    {
+        Regex<ECMA262> re("^abc$"sv, ECMAScriptFlags::Global | ECMAScriptFlags::Multiline);
+        auto result = re.match("x\nabc\ny"sv);
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.matches.size(), 1u);
+        EXPECT_EQ(result.matches.first().view.to_deprecated_string(), "abc"sv);
+    }
+}
+
+TEST_CASE(compiled_pattern_cache)
+{
+    for (size_t i = 0; i < 3; ++i) {
+        Regex<ECMA262> re("(a+)b"sv, ECMAScriptFlags::Global);
+        auto result = re.match("xaab"sv);
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.capture_group_matches.first()[0].view.to_deprecated_string(), "aa"sv);
+
+        Regex<ECMA262> insensitive_re("(a+)b"sv, ECMAScriptFlags::Global | ECMAScriptFlags::Insensitive);
+        EXPECT_EQ(insensitive_re.match("xAAB"sv).success, true);
+        EXPECT_EQ(re.match("xAAB"sv).success, false);
+
+        // A different syntax shouldn't find the ECMA262 pattern.
+        Regex<PosixExtended> posix_re("(a+)b"sv);
+        EXPECT_EQ(posix_re.search("xaab"sv).success, true);
+    }
+}
@@ -7,6 +7,7 @@
 #include <unistd.h>
 
 #include <AK/ScopeGuard.h>
+#include <LibCore/Stream.h>
 #include <LibSQL/BTree.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Heap.h>
@@ -197,6 +198,37 @@ TEST_CASE(get_table_from_database)
     }
 }
 
+TEST_CASE(recover_commit_from_log)
+{
+    ScopeGuard guard([]() {
+        unlink("/tmp/test.db");
+        unlink("/tmp/test-crashed.db");
+    });
+    auto copy_file = [](StringView from, StringView to) {
+        auto contents = MUST(MUST(Core::Stream::File::open(from, Core::Stream::OpenMode::Read))->read_until_eof());
+        auto file = MUST(Core::Stream::File::open(to, Core::Stream::OpenMode::Write | Core::Stream::OpenMode::Truncate));
+        MUST(file->write_entire_buffer(contents));
+    };
+    {
+        auto db = SQL::Database::construct("/tmp/test.db");
+        EXPECT(!db->open().is_error());
+        (void)setup_table(db);
+        commit(db);
+
+        // The commit only made it into the log, as if the process crashed right after it.
+        copy_file("/tmp/test.db"sv, "/tmp/test-crashed.db"sv);
+        copy_file("/tmp/test.db.wal"sv, "/tmp/test-crashed.db.wal"sv);
+    }
+    {
+        auto db = SQL::Database::construct("/tmp/test-crashed.db");
+        EXPECT(!db->open().is_error());
+
+        auto table = MUST(db->get_table("TestSchema", "TestTable"));
+        EXPECT_EQ(table->name(), "TestTable");
+        EXPECT_EQ(table->num_columns(), 2u);
+    }
+}
+
 TEST_CASE(insert_one_into_and_select_from_table)
 {
     insert_and_verify(1);
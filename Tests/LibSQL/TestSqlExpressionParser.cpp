@@ -282,6 +282,43 @@ TEST_CASE(binary_operator)
     }
 }
 
+TEST_CASE(binary_operator_precedence)
+{
+    auto validate = [](StringView sql, SQL::AST::BinaryOperator expected_operator, Optional<SQL::AST::BinaryOperator> expected_lhs_operator, Optional<SQL::AST::BinaryOperator> expected_rhs_operator) {
+        auto result = parse(sql);
+        EXPECT(!result.is_error());
+
+        auto expression = result.release_value();
+        EXPECT(is<SQL::AST::BinaryOperatorExpression>(*expression));
+
+        const auto& binary = static_cast<const SQL::AST::BinaryOperatorExpression&>(*expression);
+        EXPECT_EQ(binary.type(), expected_operator);
+
+        auto validate_operand = [](SQL::AST::Expression const& operand, Optional<SQL::AST::BinaryOperator> expected_operand_operator) {
+            if (!expected_operand_operator.has_value()) {
+                EXPECT(!is<SQL::AST::BinaryOperatorExpression>(operand));
+                return;
+            }
+            EXPECT(is<SQL::AST::BinaryOperatorExpression>(operand));
+            EXPECT_EQ(static_cast<const SQL::AST::BinaryOperatorExpression&>(operand).type(), *expected_operand_operator);
+        };
+        validate_operand(*binary.lhs(), expected_lhs_operator);
+        validate_operand(*binary.rhs(), expected_rhs_operator);
+    };
+
+    validate("1 = 2 AND 3 = 4"sv, SQL::AST::BinaryOperator::And, SQL::AST::BinaryOperator::Equals, SQL::AST::BinaryOperator::Equals);
+    validate("1 = 2 AND 3 = 4 AND 5 < 6"sv, SQL::AST::BinaryOperator::And, SQL::AST::BinaryOperator::And, SQL::AST::BinaryOperator::LessThan);
+    validate("1 AND 2 OR 3 AND 4"sv, SQL::AST::BinaryOperator::Or, SQL::AST::BinaryOperator::And, SQL::AST::BinaryOperator::And);
+    validate("1 + 2 * 3"sv, SQL::AST::BinaryOperator::Plus, {}, SQL::AST::BinaryOperator::Multiplication);
+    validate("1 * 2 + 3"sv, SQL::AST::BinaryOperator::Plus, SQL::AST::BinaryOperator::Multiplication, {});
+    validate("1 - 2 - 3"sv, SQL::AST::BinaryOperator::Minus, SQL::AST::BinaryOperator::Minus, {});
+    validate("1 < 2 = 3 > 4"sv, SQL::AST::BinaryOperator::Equals, SQL::AST::BinaryOperator::LessThan, SQL::AST::BinaryOperator::GreaterThan);
+    validate("1 || 2 + 3"sv, SQL::AST::BinaryOperator::Plus, SQL::AST::BinaryOperator::Concatenate, {});
+    validate("(1 + 2) * 3"sv, SQL::AST::BinaryOperator::Multiplication, {}, {});
+    validate("-1 + 2"sv, SQL::AST::BinaryOperator::Plus, {}, {});
+    validate("NOT 1 = 2 AND 3"sv, SQL::AST::BinaryOperator::And, {}, {});
+}
+
 TEST_CASE(chained_expression)
 {
     EXPECT(parse("()"sv).is_error());
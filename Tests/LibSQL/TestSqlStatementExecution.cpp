@@ -388,6 +388,42 @@ TEST_CASE(select_inner_join)
     EXPECT_EQ(result[0].row[2].to_deprecated_string(), "Test_12");
 }
 
+TEST_CASE(select_three_way_join)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_two_tables(database);
+    auto result = execute(database, "CREATE TABLE TestSchema.TestTable3 ( TextColumn3 text, IntColumn3 integer );");
+    EXPECT_EQ(result.command(), SQL::SQLCommand::Create);
+
+    for (auto count = 0; count < 20; ++count) {
+        result = execute(database, "INSERT INTO TestSchema.TestTable1 VALUES ( ?, ? );", placeholders(DeprecatedString::formatted("T1_{}", count), count));
+        EXPECT_EQ(result.size(), 1u);
+        result = execute(database, "INSERT INTO TestSchema.TestTable2 VALUES ( ?, ? );", placeholders(DeprecatedString::formatted("T2_{}", count), count * 2));
+        EXPECT_EQ(result.size(), 1u);
+        result = execute(database, "INSERT INTO TestSchema.TestTable3 VALUES ( ?, ? );", placeholders(DeprecatedString::formatted("T2_{}", count), count % 3));
+        EXPECT_EQ(result.size(), 1u);
+    }
+
+    result = execute(database,
+        "SELECT TestTable1.IntColumn, TextColumn2, IntColumn3 "
+        "FROM TestSchema.TestTable1, TestSchema.TestTable2, TestSchema.TestTable3 "
+        "WHERE TestTable1.IntColumn = TestTable2.IntColumn AND TextColumn2 = TextColumn3 AND IntColumn3 = 1 AND TestTable1.IntColumn < 30 "
+        "ORDER BY TestTable1.IntColumn;");
+
+    // Only the first ten rows of TestTable2 match TestTable1, and TestTable3 keeps every third of those.
+    Vector<i32> expected { 2, 8, 14 };
+    EXPECT_EQ(result.size(), expected.size());
+    for (size_t i = 0; i < result.size(); ++i) {
+        auto const& row = result[i].row;
+        EXPECT_EQ(row.size(), 3u);
+        EXPECT_EQ(row[0].to_int<i32>(), expected[i]);
+        EXPECT_EQ(row[1].to_deprecated_string(), DeprecatedString::formatted("T2_{}", expected[i] / 2));
+        EXPECT_EQ(row[2].to_int<i32>(), 1);
+    }
+}
+
 TEST_CASE(select_with_like)
 {
     ScopeGuard guard([]() { unlink(db_name); });
@@ -638,6 +674,33 @@ TEST_CASE(select_with_order_limit_and_offset)
     EXPECT_EQ(result[9].row[1].to_int<i32>(), 19);
 }
 
+TEST_CASE(select_with_order_and_limit_over_cross_join)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_two_tables(database);
+    for (auto count = 9; count >= 0; count--) {
+        auto result = execute(database, "INSERT INTO TestSchema.TestTable1 VALUES ( ?, ? );", placeholders(DeprecatedString::formatted("T1_{}", count), count));
+        EXPECT_EQ(result.size(), 1u);
+        result = execute(database, "INSERT INTO TestSchema.TestTable2 VALUES ( ?, ? );", placeholders(DeprecatedString::formatted("T2_{}", count), count));
+        EXPECT_EQ(result.size(), 1u);
+    }
+
+    auto result = execute(database,
+        "SELECT TestTable1.IntColumn, TestTable2.IntColumn "
+        "FROM TestSchema.TestTable1, TestSchema.TestTable2 "
+        "ORDER BY TestTable1.IntColumn, TestTable2.IntColumn LIMIT 3 OFFSET 1;");
+    EXPECT_EQ(result.size(), 3u);
+    for (size_t i = 0; i < result.size(); ++i) {
+        EXPECT_EQ(result[i].row[0].to_int<i32>(), 0);
+        EXPECT_EQ(result[i].row[1].to_int<i32>(), static_cast<i32>(i + 1));
+    }
+
+    result = execute(database, "SELECT * FROM TestSchema.TestTable1, TestSchema.TestTable2 LIMIT 15;");
+    EXPECT_EQ(result.size(), 15u);
+}
+
 TEST_CASE(select_with_limit_out_of_bounds)
 {
     ScopeGuard guard([]() { unlink(db_name); });
@@ -634,6 +634,31 @@ TEST_CASE(serialize_tuple)
     EXPECT_EQ(tuple2[1], 42);
 }
 
+TEST_CASE(serialize_tuple_with_nulls)
+{
+    NonnullRefPtr<SQL::TupleDescriptor> descriptor = adopt_ref(*new SQL::TupleDescriptor);
+    descriptor->append({ "schema", "table", "col1", SQL::SQLType::Text, SQL::Order::Ascending });
+    descriptor->append({ "schema", "table", "col2", SQL::SQLType::Integer, SQL::Order::Ascending });
+    descriptor->append({ "schema", "table", "col3", SQL::SQLType::Text, SQL::Order::Ascending });
+    SQL::Tuple tuple(descriptor, 300);
+
+    tuple["col1"] = "Test";
+    tuple["col3"] = "";
+
+    SQL::Serializer serializer;
+    serializer.serialize<SQL::Tuple>(tuple);
+    EXPECT_EQ(serializer.offset(), tuple.length());
+
+    serializer.rewind();
+    auto tuple2 = serializer.deserialize<SQL::Tuple>(descriptor);
+    EXPECT_EQ(tuple2.size(), 3u);
+    EXPECT_EQ(tuple2[0], "Test"sv);
+    EXPECT(tuple2[1].is_null());
+    EXPECT_EQ(tuple2[1].type(), SQL::SQLType::Integer);
+    EXPECT_EQ(tuple2[2], ""sv);
+    EXPECT_EQ(tuple2.pointer(), 300u);
+}
+
 TEST_CASE(copy_tuple)
 {
     NonnullRefPtr<SQL::TupleDescriptor> descriptor = adopt_ref(*new SQL::TupleDescriptor);
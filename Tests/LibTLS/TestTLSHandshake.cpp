@@ -113,3 +113,24 @@ TEST_CASE(test_TLS_hello_handshake)
 
     loop.exec();
 }
+
+TEST_CASE(test_certificate_cache)
+{
+    if (s_root_ca_certificates.is_empty())
+        return;
+
+    auto const& root = s_root_ca_certificates.first();
+    EXPECT_EQ(root.fingerprint.size(), 32u);
+
+    auto& cache = TLS::CertificateCache::the();
+    auto first = cache.parse(root.original_asn1);
+    auto second = cache.parse(root.original_asn1);
+    EXPECT(first.has_value());
+    EXPECT(second.has_value());
+    EXPECT_EQ(first->fingerprint, root.fingerprint);
+    EXPECT_EQ(second->subject_identifier_string(), root.subject_identifier_string());
+
+    EXPECT(!cache.has_verified_signature(root, root));
+    cache.did_verify_signature(root, root);
+    EXPECT(cache.has_verified_signature(root, root));
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/NonnullOwnPtr.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/EpochReclaimer.h>
+#include <LibThreading/Thread.h>
+#include <sched.h>
+
+TEST_CASE(reclaims_only_after_pinned_participants_unpin)
+{
+    Threading::EpochReclaimer reclaimer;
+    auto& reader = reclaimer.register_participant();
+    bool reclaimed = false;
+
+    reader.pin();
+    reclaimer.retire([&] { reclaimed = true; });
+    for (int i = 0; i < 10; ++i)
+        reclaimer.collect();
+    EXPECT(!reclaimed);
+
+    reader.unpin();
+    for (int i = 0; i < 3; ++i)
+        reclaimer.collect();
+    EXPECT(reclaimed);
+
+    reclaimer.unregister_participant(reader);
+}
+
+TEST_CASE(participants_that_pin_later_dont_hold_back_reclamation)
+{
+    Threading::EpochReclaimer reclaimer;
+    auto& reader = reclaimer.register_participant();
+    bool reclaimed = false;
+
+    reclaimer.retire([&] { reclaimed = true; });
+    reclaimer.collect();
+
+    {
+        // This participant can't have seen the retired memory, it was gone by the time it pinned.
+        Threading::EpochReclaimer::Guard guard { reader };
+        EXPECT(reader.is_pinned());
+        for (int i = 0; i < 3; ++i)
+            reclaimer.collect();
+        EXPECT(reclaimed);
+    }
+    EXPECT(!reader.is_pinned());
+}
+
+TEST_CASE(destructor_reclaims_everything)
+{
+    size_t reclaimed = 0;
+    {
+        Threading::EpochReclaimer reclaimer;
+        auto& reader = reclaimer.register_participant();
+        reader.pin();
+        for (int i = 0; i < 10; ++i)
+            reclaimer.retire([&] { ++reclaimed; });
+        reader.unpin();
+    }
+    EXPECT_EQ(reclaimed, 10u);
+}
+
+TEST_CASE(participants_are_reused)
+{
+    Threading::EpochReclaimer reclaimer;
+    auto* first = &reclaimer.register_participant();
+    reclaimer.unregister_participant(*first);
+    EXPECT_EQ(&reclaimer.register_participant(), first);
+    EXPECT_NE(&reclaimer.register_participant(), first);
+}
+
+// A shared pointer that one thread keeps replacing while others read what it points to.
+TEST_CASE(readers_never_see_reclaimed_memory)
+{
+    struct Node {
+        Atomic<bool> is_alive { true };
+        size_t value { 0 };
+    };
+
+    // Note: Nodes are only marked dead instead of freed, so that readers that get to one too late notice.
+    Vector<NonnullOwnPtr<Node>> nodes;
+    nodes.append(make<Node>());
+
+    Threading::EpochReclaimer reclaimer;
+    Atomic<Node*> current { nodes.last().ptr() };
+    Atomic<bool> done { false };
+    Atomic<size_t> reclaimed { 0 };
+
+    Vector<NonnullRefPtr<Threading::Thread>> readers;
+    for (int i = 0; i < 3; ++i) {
+        readers.append(Threading::Thread::construct([&] {
+            auto& participant = reclaimer.register_participant();
+            while (!done.load()) {
+                Threading::EpochReclaimer::Guard guard { participant };
+                auto* node = current.load();
+                VERIFY(node->is_alive.load());
+                sched_yield();
+                VERIFY(node->is_alive.load());
+            }
+            reclaimer.unregister_participant(participant);
+            return 0;
+        }));
+        readers.last()->start();
+    }
+
+    for (size_t i = 1; i <= 5000; ++i) {
+        nodes.append(make<Node>());
+        nodes.last()->value = i;
+        auto* old_node = current.exchange(nodes.last().ptr());
+        reclaimer.retire([&reclaimed, old_node] {
+            old_node->is_alive.store(false);
+            ++reclaimed;
+        });
+        if (i % 100 == 0)
+            sched_yield();
+    }
+
+    done.store(true);
+    for (auto& reader : readers)
+        (void)reader->join();
+    for (int i = 0; i < 3; ++i)
+        reclaimer.collect();
+
+    EXPECT_EQ(reclaimed.load(), 5000u);
+    EXPECT(current.load()->is_alive.load());
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/DeprecatedString.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Queue.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/LockFreeQueue.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+#include <sched.h>
+
+using Threading::QueueStatus;
+
+template<typename Queue>
+static void expect_fills_up_and_drains()
+{
+    Queue queue;
+    EXPECT(queue.dequeue().is_error());
+
+    for (size_t i = 0; i < queue.capacity(); ++i)
+        EXPECT(!queue.enqueue(DeprecatedString::number(i)).is_error());
+    EXPECT_EQ(queue.weak_used(), queue.capacity());
+
+    auto overflow = DeprecatedString("overflow"sv);
+    auto result = queue.enqueue(overflow);
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.error(), QueueStatus::Full);
+    EXPECT_EQ(overflow, "overflow"sv);
+
+    for (size_t i = 0; i < queue.capacity(); ++i)
+        EXPECT_EQ(queue.dequeue().value(), DeprecatedString::number(i));
+
+    auto empty = queue.dequeue();
+    EXPECT(empty.is_error());
+    EXPECT_EQ(empty.error(), QueueStatus::Empty);
+
+    // Wrap around a couple of times, and leave some values in there for the destructor.
+    size_t next_expected = 0;
+    for (size_t i = 0; i < queue.capacity() * 2; ++i) {
+        EXPECT(!queue.enqueue(DeprecatedString::number(i)).is_error());
+        if (i % 3 != 0)
+            EXPECT_EQ(queue.dequeue().value(), DeprecatedString::number(next_expected++));
+    }
+}
+
+TEST_CASE(spsc_fills_up_and_drains)
+{
+    expect_fills_up_and_drains<Threading::SPSCQueue<DeprecatedString, 16>>();
+}
+
+TEST_CASE(mpmc_fills_up_and_drains)
+{
+    expect_fills_up_and_drains<Threading::MPMCQueue<DeprecatedString, 16>>();
+}
+
+TEST_CASE(move_only_values)
+{
+    Threading::MPMCQueue<NonnullOwnPtr<int>, 4> queue;
+    EXPECT(!queue.enqueue(make<int>(42)).is_error());
+    EXPECT_EQ(*queue.dequeue().value(), 42);
+}
+
+static constexpr size_t item_count = 200'000;
+
+TEST_CASE(spsc_keeps_the_order)
+{
+    Threading::SPSCQueue<size_t, 64> queue;
+
+    auto producer = Threading::Thread::construct([&] {
+        for (size_t i = 0; i < item_count;) {
+            if (queue.enqueue(i).is_error())
+                sched_yield();
+            else
+                ++i;
+        }
+        return 0;
+    });
+    producer->start();
+
+    for (size_t expected = 0; expected < item_count;) {
+        auto result = queue.dequeue();
+        if (result.is_error()) {
+            sched_yield();
+            continue;
+        }
+        EXPECT_EQ(result.value(), expected);
+        ++expected;
+    }
+
+    (void)producer->join();
+}
+
+TEST_CASE(mpmc_delivers_everything_exactly_once)
+{
+    static constexpr size_t thread_count = 4;
+    Threading::MPMCQueue<size_t, 64> queue;
+    Atomic<size_t> sum { 0 };
+    Atomic<size_t> received { 0 };
+
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t producer = 0; producer < thread_count; ++producer) {
+        threads.append(Threading::Thread::construct([&, producer] {
+            for (size_t i = producer; i < item_count; i += thread_count) {
+                while (queue.enqueue(i).is_error())
+                    sched_yield();
+            }
+            return 0;
+        }));
+    }
+    for (size_t consumer = 0; consumer < thread_count; ++consumer) {
+        threads.append(Threading::Thread::construct([&] {
+            while (received.load() < item_count) {
+                auto result = queue.dequeue();
+                if (result.is_error()) {
+                    sched_yield();
+                    continue;
+                }
+                sum.fetch_add(result.value());
+                received.fetch_add(1);
+            }
+            return 0;
+        }));
+    }
+
+    for (auto& thread : threads)
+        thread->start();
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    EXPECT_EQ(received.load(), item_count);
+    EXPECT_EQ(sum.load(), item_count * (item_count - 1) / 2);
+    EXPECT(queue.dequeue().is_error());
+}
+
+#define BENCHMARK_ITEMS (1'000'000)
+
+template<typename Enqueue, typename Dequeue>
+static void run_producer_consumer_benchmark(Enqueue enqueue, Dequeue dequeue)
+{
+    auto producer = Threading::Thread::construct([&] {
+        for (size_t i = 0; i < BENCHMARK_ITEMS;) {
+            if (enqueue(i))
+                ++i;
+            else
+                sched_yield();
+        }
+        return 0;
+    });
+    producer->start();
+
+    size_t sum = 0;
+    for (size_t received = 0; received < BENCHMARK_ITEMS;) {
+        if (auto value = dequeue(); value.has_value()) {
+            sum += *value;
+            ++received;
+        } else {
+            sched_yield();
+        }
+    }
+
+    (void)producer->join();
+    EXPECT_EQ(sum, static_cast<size_t>(BENCHMARK_ITEMS) * (BENCHMARK_ITEMS - 1) / 2);
+}
+
+BENCHMARK_CASE(spsc_throughput)
+{
+    Threading::SPSCQueue<size_t, 1024> queue;
+    run_producer_consumer_benchmark(
+        [&](size_t value) { return !queue.enqueue(value).is_error(); },
+        [&]() -> Optional<size_t> {
+            auto result = queue.dequeue();
+            if (result.is_error())
+                return {};
+            return result.value();
+        });
+}
+
+BENCHMARK_CASE(mpmc_throughput)
+{
+    Threading::MPMCQueue<size_t, 1024> queue;
+    run_producer_consumer_benchmark(
+        [&](size_t value) { return !queue.enqueue(value).is_error(); },
+        [&]() -> Optional<size_t> {
+            auto result = queue.dequeue();
+            if (result.is_error())
+                return {};
+            return result.value();
+        });
+}
+
+// For comparison: what we'd have done without the lock-free queues.
+BENCHMARK_CASE(mutex_queue_throughput)
+{
+    Threading::Mutex mutex;
+    Queue<size_t> queue;
+    run_producer_consumer_benchmark(
+        [&](size_t value) {
+            Threading::MutexLocker locker(mutex);
+            if (queue.size() >= 1024)
+                return false;
+            queue.enqueue(value);
+            return true;
+        },
+        [&]() -> Optional<size_t> {
+            Threading::MutexLocker locker(mutex);
+            if (queue.is_empty())
+                return {};
+            return queue.dequeue();
+        });
+}
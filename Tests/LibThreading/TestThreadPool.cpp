@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/FixedArray.h>
+#include <AK/Random.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/ThreadPool.h>
+
+TEST_CASE(futures_resolve_to_the_job_result)
+{
+    Threading::ThreadPool pool(2);
+
+    Vector<NonnullRefPtr<Threading::Future<int>>> futures;
+    for (int i = 0; i < 100; ++i)
+        futures.append(pool.submit([i] { return i * i; }));
+
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(futures[i]->await(), i * i);
+
+    Atomic<int> counter { 0 };
+    auto future = pool.submit([&] { ++counter; });
+    future->await();
+    EXPECT(future->is_resolved());
+    EXPECT_EQ(counter.load(), 1);
+}
+
+TEST_CASE(jobs_can_await_other_jobs)
+{
+    Threading::ThreadPool pool(1);
+
+    // With a single worker, the inner jobs can only ever run if awaiting them runs other jobs.
+    auto outer = pool.submit([&] {
+        auto first = pool.submit([] { return 20; });
+        auto second = pool.submit([] { return 22; });
+        return first->await() + second->await();
+    });
+    EXPECT_EQ(outer->await(), 42);
+}
+
+TEST_CASE(parallel_for_covers_every_index_once)
+{
+    Threading::ThreadPool pool(3);
+
+    for (size_t grain_size : { 1u, 7u, 1000u, 5000u }) {
+        auto visits = MUST(FixedArray<Atomic<u32>>::create(4321));
+        pool.parallel_for(visits.size(), grain_size, [&](size_t begin, size_t end) {
+            EXPECT(end - begin <= grain_size);
+            for (size_t i = begin; i < end; ++i)
+                visits[i].fetch_add(1);
+        });
+        for (auto& visit : visits)
+            EXPECT_EQ(visit.load(), 1u);
+    }
+
+    pool.parallel_for(0, 1, [&](size_t, size_t) { FAIL("Callback called for an empty range"); });
+
+    Vector<int> values;
+    values.resize(1000);
+    pool.parallel_for_each(values.span(), [](int& value) { value = 1; }, 10);
+    for (auto value : values)
+        EXPECT_EQ(value, 1);
+}
+
+TEST_CASE(parallel_sort)
+{
+    Threading::ThreadPool pool(3);
+
+    for (size_t size : { 0u, 1u, 100u, 10000u, 100001u }) {
+        Vector<u32> values;
+        values.ensure_capacity(size);
+        for (size_t i = 0; i < size; ++i)
+            values.unchecked_append(get_random_uniform(1000));
+
+        pool.parallel_sort(values.span());
+        for (size_t i = 1; i < size; ++i)
+            EXPECT(values[i - 1] <= values[i]);
+
+        pool.parallel_sort(values.span(), [](u32 a, u32 b) { return a > b; });
+        for (size_t i = 1; i < size; ++i)
+            EXPECT(values[i - 1] >= values[i]);
+    }
+}
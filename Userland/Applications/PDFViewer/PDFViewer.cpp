@@ -115,6 +115,7 @@ void PDFViewer::paint_event(GUI::PaintEvent& event)
         int y = max(0, (height() - page->height()) / 2);
 
         painter.blit({ x, y }, *page, page->rect());
+        render_adjacent_pages_later(m_current_page_index, m_current_page_index);
         return;
     }
 
@@ -158,6 +159,29 @@ void PDFViewer::paint_event(GUI::PaintEvent& event)
 
         y_offset += diff_y;
     }
+
+    render_adjacent_pages_later(first_page_index, last_page_index);
+}
+
+void PDFViewer::render_adjacent_pages_later(u32 first_visible_page, u32 last_visible_page)
+{
+    // The pages right before and after the visible ones are rendered once the event loop is idle,
+    // so that turning the page or scrolling to it doesn't have to wait for them.
+    if (m_adjacent_page_rendering_pending)
+        return;
+    m_adjacent_page_rendering_pending = true;
+
+    deferred_invoke([this, first_visible_page, last_visible_page] {
+        m_adjacent_page_rendering_pending = false;
+        if (!m_document)
+            return;
+
+        // Errors that keep a page from being rendered at all come up again once it is shown.
+        if (first_visible_page > 0)
+            (void)get_rendered_page(first_visible_page - 1);
+        if (last_visible_page + 1 < m_rendered_page_list.size())
+            (void)get_rendered_page(last_visible_page + 1);
+    });
 }
 
 void PDFViewer::set_current_page(u32 current_page)
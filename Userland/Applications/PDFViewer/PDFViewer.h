@@ -86,12 +86,14 @@ private:
 
     PDF::PDFErrorOr<NonnullRefPtr<Gfx::Bitmap>> get_rendered_page(u32 index);
     PDF::PDFErrorOr<NonnullRefPtr<Gfx::Bitmap>> render_page(u32 page_index);
+    void render_adjacent_pages_later(u32 first_visible_page, u32 last_visible_page);
     PDF::PDFErrorOr<void> cache_page_dimensions(bool recalculate_fixed_info = false);
     void change_page(u32 new_page);
 
     RefPtr<PDF::Document> m_document;
     u32 m_current_page_index { 0 };
     Vector<HashMap<u32, RenderedPage>> m_rendered_page_list;
+    bool m_adjacent_page_rendering_pending { false };
 
     u8 m_zoom_level { initial_zoom_level };
     PageDimensionCache m_page_dimension_cache;
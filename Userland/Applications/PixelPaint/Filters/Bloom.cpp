@@ -27,7 +27,7 @@ void Bloom::apply(Gfx::Bitmap& target_bitmap, Gfx::Bitmap const& source_bitmap)
     Gfx::LumaFilter luma_filter(intermediate_bitmap);
     luma_filter.apply(m_luma_lower, 255);
 
-    Gfx::FastBoxBlurFilter blur_filter(intermediate_bitmap);
+    Gfx::FastBoxBlurFilter blur_filter(intermediate_bitmap, Gfx::FastBoxBlurFilter::UseThreadPool::Yes);
     blur_filter.apply_three_passes(m_blur_radius);
 
     Gfx::BitmapMixer mixer(target_bitmap);
@@ -16,7 +16,7 @@ namespace PixelPaint::Filters {
 
 void FastBoxBlur::apply(Gfx::Bitmap& target_bitmap) const
 {
-    Gfx::FastBoxBlurFilter filter(target_bitmap);
+    Gfx::FastBoxBlurFilter filter(target_bitmap, Gfx::FastBoxBlurFilter::UseThreadPool::Yes);
 
     if (m_use_asymmetric_radii) {
         if (m_use_vector) {
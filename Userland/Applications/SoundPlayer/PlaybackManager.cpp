@@ -62,6 +62,8 @@ void PlaybackManager::seek(int const position)
     set_paused(true);
 
     [[maybe_unused]] auto result = m_loader->seek(position);
+    if (m_resampler.has_value())
+        m_resampler->reset();
 
     m_connection->clear_client_buffer();
     m_connection->async_clear_buffer();
@@ -122,7 +124,6 @@ void PlaybackManager::next_buffer()
         m_current_buffer.swap(buffer);
         VERIFY(m_resampler.has_value());
 
-        m_resampler->reset();
         // FIXME: Handle OOM better.
         auto resampled = MUST(FixedArray<Audio::Sample>::create(m_resampler->resample(move(m_current_buffer)).span()));
         m_current_buffer.swap(resampled);
@@ -32,6 +32,7 @@ void Cell::set_data(DeprecatedString new_data)
     m_data = move(new_data);
     m_dirty = true;
     m_evaluated_externally = false;
+    m_compiled_formula = {};
 }
 
 void Cell::set_data(JS::Value new_data)
@@ -43,6 +44,7 @@ void Cell::set_data(JS::Value new_data)
 
     builder.append(new_data.to_string_without_side_effects());
     m_data = builder.to_deprecated_string();
+    m_compiled_formula = {};
 
     m_evaluated_data = move(new_data);
 }
@@ -98,9 +100,14 @@ void Cell::update_data(Badge<Sheet>)
 
     if (m_dirty) {
         m_dirty = false;
+        // What the cell depends on is found out anew by evaluating it. Cells that are set from other cells' formulas keep
+        // depending on those though.
+        if (!m_evaluated_externally)
+            clear_references();
+
         if (m_kind == Formula) {
             if (!m_evaluated_externally) {
-                auto value_or_error = m_sheet->evaluate(m_data, this);
+                auto value_or_error = evaluate_formula();
                 if (value_or_error.is_error()) {
                     m_evaluated_data = JS::js_undefined();
                     m_thrown_value = *value_or_error.release_error().release_value();
@@ -111,10 +118,13 @@ void Cell::update_data(Badge<Sheet>)
             }
         }
 
+        // Note: The cells in this sheet are updated by Sheet::update() in the order of their dependencies, so only the
+        //       ones in other sheets are updated right away.
         for (auto& ref : m_referencing_cells) {
             if (ref) {
                 ref->m_dirty = true;
-                ref->update();
+                if (&ref->sheet() != m_sheet.ptr())
+                    ref->update();
             }
         }
     }
@@ -140,6 +150,13 @@ void Cell::update_data(Badge<Sheet>)
     }
 }
 
+JS::ThrowCompletionOr<JS::Value> Cell::evaluate_formula()
+{
+    if (m_compiled_formula.is_null())
+        m_compiled_formula = JS::make_handle(TRY(m_sheet->parse(m_data, this)).ptr());
+    return m_sheet->evaluate(*m_compiled_formula, this);
+}
+
 void Cell::update()
 {
     m_sheet->update(*this);
@@ -176,6 +193,16 @@ void Cell::reference_from(Cell* other)
         return;
 
     m_referencing_cells.append(other->make_weak_ptr());
+    other->m_referenced_cells.append(make_weak_ptr());
+}
+
+void Cell::clear_references()
+{
+    for (auto& cell : m_referenced_cells) {
+        if (cell)
+            cell->m_referencing_cells.remove_all_matching([this](auto const& ptr) { return ptr.ptr() == this || !ptr; });
+    }
+    m_referenced_cells.clear();
 }
 
 void Cell::copy_from(Cell const& other)
@@ -185,6 +212,7 @@ void Cell::copy_from(Cell const& other)
     m_data = other.m_data;
     m_evaluated_data = other.m_evaluated_data;
     m_kind = other.m_kind;
+    m_compiled_formula = {};
     m_type = other.m_type;
     m_type_metadata = other.m_type_metadata;
     m_conditional_formats = other.m_conditional_formats;
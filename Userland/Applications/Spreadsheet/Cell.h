@@ -15,6 +15,8 @@
 #include <AK/Types.h>
 #include <AK/WeakPtr.h>
 #include <LibGUI/Command.h>
+#include <LibJS/Heap/Handle.h>
+#include <LibJS/Script.h>
 
 namespace Spreadsheet {
 
@@ -48,6 +50,7 @@ struct Cell : public Weakable<Cell> {
     void set_data(DeprecatedString new_data);
     void set_data(JS::Value new_data);
     bool dirty() const { return m_dirty; }
+    void mark_dirty() { m_dirty = true; }
     void clear_dirty() { m_dirty = false; }
 
     StringView name_for_javascript(Sheet const& sheet) const
@@ -70,7 +73,10 @@ struct Cell : public Weakable<Cell> {
     DeprecatedString const& data() const { return m_data; }
     const JS::Value& evaluated_data() const { return m_evaluated_data; }
     Kind kind() const { return m_kind; }
+    // The cells that read this one when they were last evaluated.
     Vector<WeakPtr<Cell>> const& referencing_cells() const { return m_referencing_cells; }
+    // The cells that this one read when it was last evaluated.
+    Vector<WeakPtr<Cell>> const& referenced_cells() const { return m_referenced_cells; }
 
     void set_type(StringView name);
     void set_type(CellType const*);
@@ -82,6 +88,8 @@ struct Cell : public Weakable<Cell> {
         if (position != m_position) {
             m_dirty = true;
             m_position = move(position);
+            m_name_for_javascript = {};
+            m_compiled_formula = {};
         }
     }
 
@@ -114,6 +122,9 @@ struct Cell : public Weakable<Cell> {
     void copy_from(Cell const&);
 
 private:
+    void clear_references();
+    JS::ThrowCompletionOr<JS::Value> evaluate_formula();
+
     bool m_dirty { false };
     bool m_evaluated_externally { false };
     DeprecatedString m_data;
@@ -122,6 +133,9 @@ private:
     Kind m_kind { LiteralString };
     WeakPtr<Sheet> m_sheet;
     Vector<WeakPtr<Cell>> m_referencing_cells;
+    Vector<WeakPtr<Cell>> m_referenced_cells;
+    // The formula as it was last parsed, which is only parsed again after it changes.
+    JS::Handle<JS::Script> m_compiled_formula;
     CellType const* m_type { nullptr };
     CellTypeMetadata m_type_metadata;
     Position m_position;
@@ -121,6 +121,64 @@ DeprecatedString Sheet::add_column()
     return next_column;
 }
 
+// Gives the dirty cells and everything in this sheet that depends on them, ordered so that every cell comes after the
+// cells it depends on. Cells in a dependency cycle come last.
+Vector<Cell&> Sheet::cells_to_update_in_dependency_order()
+{
+    Vector<Cell*> cells;
+    HashTable<Cell*> cells_to_update;
+    for (auto& it : m_cells) {
+        if (it.value->dirty() && !has_been_visited(it.value))
+            cells.append(it.value);
+    }
+    for (auto* cell : cells)
+        cells_to_update.set(cell);
+
+    for (size_t i = 0; i < cells.size(); ++i) {
+        for (auto& referencing_cell : cells[i]->referencing_cells()) {
+            if (referencing_cell && &referencing_cell->sheet() == this && cells_to_update.set(referencing_cell.ptr()) == HashSetResult::InsertedNewEntry)
+                cells.append(referencing_cell.ptr());
+        }
+    }
+
+    HashMap<Cell*, size_t> dependencies_left;
+    Vector<Cell*> ready_cells;
+    for (auto* cell : cells) {
+        size_t count = 0;
+        for (auto& referenced_cell : cell->referenced_cells()) {
+            if (referenced_cell && referenced_cell.ptr() != cell && cells_to_update.contains(referenced_cell.ptr()))
+                ++count;
+        }
+        if (count == 0)
+            ready_cells.append(cell);
+        else
+            dependencies_left.set(cell, count);
+    }
+
+    Vector<Cell&> ordered_cells;
+    while (!ready_cells.is_empty()) {
+        auto* cell = ready_cells.take_last();
+        ordered_cells.append(*cell);
+        for (auto& referencing_cell : cell->referencing_cells()) {
+            if (!referencing_cell)
+                continue;
+            auto it = dependencies_left.find(referencing_cell.ptr());
+            if (it == dependencies_left.end())
+                continue;
+            if (--it->value == 0) {
+                dependencies_left.remove(it);
+                ready_cells.append(referencing_cell.ptr());
+            }
+        }
+    }
+
+    for (auto* cell : cells) {
+        if (dependencies_left.contains(cell))
+            ordered_cells.append(*cell);
+    }
+    return ordered_cells;
+}
+
 void Sheet::update()
 {
     if (m_should_ignore_updates) {
@@ -128,19 +186,21 @@ void Sheet::update()
         return;
     }
     m_visited_cells_in_update.clear();
-    Vector<Cell&> cells_copy;
 
-    // Grab a copy as updates might insert cells into the table.
-    for (auto& it : m_cells) {
-        if (it.value->dirty()) {
-            cells_copy.append(*it.value);
-            m_workbook.set_dirty(true);
-        }
+    // Only the cells that changed and the ones that depend on them are evaluated again, each of them once, and after
+    // everything it depends on. Evaluating a cell may set other cells, so this goes on until nothing is left to do.
+    while (true) {
+        auto cells = cells_to_update_in_dependency_order();
+        if (cells.is_empty())
+            break;
+
+        m_workbook.set_dirty(true);
+        for (auto& cell : cells)
+            cell.mark_dirty();
+        for (auto& cell : cells)
+            update(cell);
     }
 
-    for (auto& cell : cells_copy)
-        update(cell);
-
     m_visited_cells_in_update.clear();
 }
 
@@ -163,8 +223,19 @@ void Sheet::update(Cell& cell)
 }
 
 JS::ThrowCompletionOr<JS::Value> Sheet::evaluate(StringView source, Cell* on_behalf_of)
+{
+    auto script = TRY(parse(source, on_behalf_of));
+    return evaluate(*script, on_behalf_of);
+}
+
+JS::ThrowCompletionOr<JS::Value> Sheet::evaluate(JS::Script& script, Cell* on_behalf_of)
 {
     TemporaryChange cell_change { m_current_cell_being_evaluated, on_behalf_of };
+    return interpreter().run(script);
+}
+
+JS::ThrowCompletionOr<JS::NonnullGCPtr<JS::Script>> Sheet::parse(StringView source, Cell* on_behalf_of)
+{
     auto name = on_behalf_of ? on_behalf_of->name_for_javascript(*this) : "cell <unknown>"sv;
     auto script_or_error = JS::Script::parse(
         source,
@@ -174,7 +245,7 @@ JS::ThrowCompletionOr<JS::Value> Sheet::evaluate(StringView source, Cell* on_beh
     if (script_or_error.is_error())
         return interpreter().vm().throw_completion<JS::SyntaxError>(script_or_error.error().first().to_deprecated_string());
 
-    return interpreter().run(script_or_error.value());
+    return script_or_error.release_value();
 }
 
 Cell* Sheet::at(StringView name)
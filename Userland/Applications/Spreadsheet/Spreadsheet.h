@@ -122,6 +122,8 @@ public:
     }
 
     JS::ThrowCompletionOr<JS::Value> evaluate(StringView, Cell* = nullptr);
+    JS::ThrowCompletionOr<JS::Value> evaluate(JS::Script&, Cell* = nullptr);
+    JS::ThrowCompletionOr<JS::NonnullGCPtr<JS::Script>> parse(StringView, Cell* = nullptr);
     JS::Interpreter& interpreter() const;
     SheetGlobalObject& global_object() const { return *m_global_object; }
 
@@ -146,6 +148,8 @@ public:
 
 private:
     explicit Sheet(Workbook&);
+
+    Vector<Cell&> cells_to_update_in_dependency_order();
     explicit Sheet(StringView name, Workbook&);
 
     DeprecatedString m_name;
@@ -429,20 +429,26 @@ static DeprecatedString read_command_line(pid_t pid)
 void ProcessModel::update()
 {
     auto previous_tid_count = m_threads.size();
-    auto all_processes = Core::ProcessStatisticsReader::get_all(m_proc_all);
+    if (!m_process_statistics) {
+        if (auto reader = Core::ProcessStatisticsReader::create(); !reader.is_error())
+            m_process_statistics = reader.release_value();
+    }
 
     HashTable<int> live_tids;
     u64 total_time_scheduled_diff = 0;
-    if (!all_processes.is_error()) {
+    size_t process_count = 0;
+    if (m_process_statistics && !m_process_statistics->update().is_error()) {
+        auto const& all_processes = m_process_statistics->statistics();
+        process_count = all_processes.processes.size();
         if (m_has_total_scheduled_time)
-            total_time_scheduled_diff = all_processes.value().total_time_scheduled - m_total_time_scheduled;
+            total_time_scheduled_diff = all_processes.total_time_scheduled - m_total_time_scheduled;
 
-        m_total_time_scheduled = all_processes.value().total_time_scheduled;
-        m_total_time_scheduled_kernel = all_processes.value().total_time_scheduled_kernel;
+        m_total_time_scheduled = all_processes.total_time_scheduled;
+        m_total_time_scheduled_kernel = all_processes.total_time_scheduled_kernel;
         m_has_total_scheduled_time = true;
 
-        for (size_t i = 0; i < all_processes.value().processes.size(); ++i) {
-            auto const& process = all_processes.value().processes[i];
+        for (size_t i = 0; i < all_processes.processes.size(); ++i) {
+            auto const& process = all_processes.processes[i];
             NonnullOwnPtr<Process>* process_state = nullptr;
             for (size_t i = 0; i < m_processes.size(); ++i) {
                 auto* other_process = &m_processes.ptr_at(i);
@@ -549,7 +555,7 @@ void ProcessModel::update()
         on_cpu_info_change(m_cpus);
 
     if (on_state_update)
-        on_state_update(!all_processes.is_error() ? all_processes.value().processes.size() : 0, m_threads.size());
+        on_state_update(process_count, m_threads.size());
 
     // FIXME: This is a rather hackish way of invalidating indices.
     //        It would be good if GUI::Model had a way to orchestrate removal/insertion while preserving indices.
@@ -55,7 +55,7 @@ ErrorOr<NonnullRefPtr<CatDog>> CatDog::create()
 }
 
 CatDog::CatDog()
-    : m_proc_all(MUST(Core::Stream::File::open("/sys/kernel/processes"sv, Core::Stream::OpenMode::Read)))
+    : m_process_statistics(MUST(Core::ProcessStatisticsReader::create(false)))
 {
     m_idle_sleep_timer.start();
 }
@@ -68,11 +68,10 @@ void CatDog::set_roaming(bool roaming)
 
 CatDog::State CatDog::special_application_states() const
 {
-    auto maybe_proc_info = Core::ProcessStatisticsReader::get_all(*m_proc_all);
-    if (maybe_proc_info.is_error())
+    if (m_process_statistics->update().is_error())
         return State::GenericCatDog;
 
-    auto proc_info = maybe_proc_info.release_value();
+    auto const& proc_info = m_process_statistics->statistics();
     auto maybe_paint_program = proc_info.processes.first_matching([](auto& process) {
         return process.name.equals_ignoring_case("pixelpaint"sv) || process.name.equals_ignoring_case("fonteditor"sv);
     });
@@ -13,6 +13,7 @@
 #include <AK/Types.h>
 #include <LibCore/ElapsedTimer.h>
 #include <LibCore/File.h>
+#include <LibCore/ProcessStatisticsReader.h>
 #include <LibCore/Stream.h>
 #include <LibGUI/Menu.h>
 #include <LibGUI/MouseTracker.h>
@@ -75,7 +76,7 @@ private:
     Gfx::IntPoint m_mouse_offset {};
     Core::ElapsedTimer m_idle_sleep_timer;
 
-    NonnullOwnPtr<Core::Stream::File> m_proc_all;
+    NonnullOwnPtr<Core::ProcessStatisticsReader> m_process_statistics;
 
     State m_state { State::Roaming };
     State m_frame { State::Frame1 };
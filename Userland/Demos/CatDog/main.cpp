@@ -26,9 +26,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     TRY(Core::System::pledge("stdio recvfd sendfd rpath"));
     TRY(Core::System::unveil("/res", "r"));
-    TRY(Core::System::unveil("/sys/kernel/processes", "r"));
-    // FIXME: For some reason, this is needed in the /sys/kernel/processes shenanigans.
-    TRY(Core::System::unveil("/etc/passwd", "r"));
+    TRY(Core::System::unveil("/sys/kernel/process_statistics", "r"));
     TRY(Core::System::unveil(nullptr, nullptr));
 
     auto window = TRY(GUI::Window::try_create());
@@ -8,6 +8,7 @@
 #include "ConnectionFromClient.h"
 #include <AK/Debug.h>
 #include <AK/HashMap.h>
+#include <AK/LexicalPath.h>
 #include <LibCore/File.h>
 #include <LibGUI/TextDocument.h>
 
@@ -34,10 +35,17 @@ void ConnectionFromClient::greet(DeprecatedString const& project_root)
         perror("unveil");
         exit(1);
     }
+    // This is where the symbol index of the project is kept, see CodeComprehensionEngine::project_opened().
+    auto project_data_path = LexicalPath::join(project_root, ".hackstudio"sv).string();
+    if (unveil(project_data_path.characters(), "rwc") < 0) {
+        perror("unveil");
+        exit(1);
+    }
     if (unveil(nullptr, nullptr) < 0) {
         perror("unveil");
         exit(1);
     }
+    m_autocomplete_engine->project_opened();
 }
 
 void ConnectionFromClient::file_opened(DeprecatedString const& filename, IPC::File const& file)
@@ -288,7 +288,9 @@ ErrorOr<NonnullOwnPtr<Profile>> Profile::load_from_perfcore_file(StringView path
 
         auto type_string = perf_event.get_deprecated_string("type"sv).value_or({});
 
-        if (type_string == "sample"sv) {
+        if (type_string == "sample"sv || type_string == "cpu_cycles"sv || type_string == "instructions"sv
+            || type_string == "cache_misses"sv || type_string == "branch_misses"sv) {
+            // Hardware counter overflows are samples too, they're just weighted by a different event than time.
             event.data = Event::SampleData {};
         } else if (type_string == "malloc"sv) {
             event.data = Event::MallocData {
@@ -231,8 +231,7 @@ int Emulator::exec()
 
     while (!m_shutdown) {
         if (m_steps_til_pause) [[likely]] {
-            m_cpu->save_base_eip();
-            auto insn = X86::Instruction::from_stream(*m_cpu, X86::ProcessorMode::Protected);
+            auto const& insn = m_cpu->fetch_instruction();
             // Exec cycle
             if constexpr (trace) {
                 outln("{:p}  \033[33;1m{}\033[0m", m_cpu->base_eip(), insn.to_deprecated_string(m_cpu->base_eip(), symbol_provider));
@@ -65,6 +65,7 @@ public:
     u32 virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3);
 
     SoftMMU& mmu() { return m_mmu; }
+    SoftCPU& cpu() { return *m_cpu; }
 
     MallocTracer* malloc_tracer() { return m_malloc_tracer; }
 
@@ -171,6 +172,7 @@ private:
     int virt$ftruncate(int fd, FlatPtr length_addr);
     int virt$futex(FlatPtr);
     int virt$get_dir_entries(int fd, FlatPtr buffer, ssize_t);
+    int virt$get_dir_entries_with_stat(int fd, FlatPtr buffer, ssize_t);
     int virt$get_process_name(FlatPtr buffer, int size);
     int virt$get_stack_bounds(FlatPtr, FlatPtr);
     int virt$getcwd(FlatPtr buffer, size_t buffer_size);
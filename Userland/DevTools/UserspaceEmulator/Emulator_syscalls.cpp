@@ -100,6 +100,8 @@ u32 Emulator::virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3)
         return virt$futex(arg1);
     case SC_get_dir_entries:
         return virt$get_dir_entries(arg1, arg2, arg3);
+    case SC_get_dir_entries_with_stat:
+        return virt$get_dir_entries_with_stat(arg1, arg2, arg3);
     case SC_get_process_name:
         return virt$get_process_name(arg1, arg2);
     case SC_get_stack_bounds:
@@ -1008,6 +1010,8 @@ u32 Emulator::virt$mprotect(FlatPtr base, size_t size, int prot)
     if (has_non_mmapped_region)
         return -EINVAL;
 
+    // Code that is no longer executable mustn't keep on running from the cache.
+    m_cpu->invalidate_instruction_cache();
     return 0;
 }
 
@@ -1112,6 +1116,19 @@ int Emulator::virt$get_dir_entries(int fd, FlatPtr buffer, ssize_t size)
     return rc;
 }
 
+int Emulator::virt$get_dir_entries_with_stat(int fd, FlatPtr buffer, ssize_t size)
+{
+    auto buffer_result = ByteBuffer::create_uninitialized(size);
+    if (buffer_result.is_error())
+        return -ENOMEM;
+    auto& host_buffer = buffer_result.value();
+    int rc = syscall(SC_get_dir_entries_with_stat, fd, host_buffer.data(), host_buffer.size());
+    if (rc < 0)
+        return rc;
+    mmu().copy_to_vm(buffer, host_buffer.data(), host_buffer.size());
+    return rc;
+}
+
 int Emulator::virt$ioctl([[maybe_unused]] int fd, unsigned request, [[maybe_unused]] FlatPtr arg)
 {
     switch (request) {
@@ -305,6 +305,26 @@ void MallocTracer::audit_write(Region const& region, FlatPtr address, size_t siz
     }
 }
 
+void MallocTracer::audit_read_range(Region const& region, FlatPtr address, size_t size)
+{
+    if (!size)
+        return;
+    if (auto* mallocation = find_mallocation(region, address); mallocation && !mallocation->freed && mallocation->contains(address + size - 1))
+        return;
+    for (size_t i = 0; i < size; ++i)
+        audit_read(region, address + i, 1);
+}
+
+void MallocTracer::audit_write_range(Region const& region, FlatPtr address, size_t size)
+{
+    if (!size)
+        return;
+    if (auto* mallocation = find_mallocation(region, address); mallocation && !mallocation->freed && mallocation->contains(address + size - 1))
+        return;
+    for (size_t i = 0; i < size; ++i)
+        audit_write(region, address + i, 1);
+}
+
 void MallocTracer::populate_memory_graph()
 {
     // Create Node for each live Mallocation
@@ -66,6 +66,11 @@ public:
     void audit_read(Region const&, FlatPtr address, size_t);
     void audit_write(Region const&, FlatPtr address, size_t);
 
+    // Audit whole ranges at once, as long as they lie within a single live mallocation. Anything else is audited byte
+    // by byte, so that the reports are the same as for separate accesses.
+    void audit_read_range(Region const&, FlatPtr address, size_t);
+    void audit_write_range(Region const&, FlatPtr address, size_t);
+
     void dump_leak_report();
 
 private:
@@ -141,11 +141,49 @@ void SoftCPU::update_code_cache()
         TODO();
     }
 
-    // FIXME: This cache needs to be invalidated if the code region is ever unmapped.
     m_cached_code_region = region;
     m_cached_code_base_ptr = region->data();
 }
 
+void SoftCPU::did_remove_region(Region const& region)
+{
+    if (m_cached_code_region == &region) {
+        m_cached_code_region = nullptr;
+        m_cached_code_base_ptr = nullptr;
+    }
+    if (region.is_executable())
+        invalidate_instruction_cache();
+}
+
+X86::Instruction const& SoftCPU::fetch_instruction()
+{
+    if (m_block_cache_invalidated) [[unlikely]] {
+        m_block_cache.clear();
+        m_current_block = nullptr;
+        m_block_cache_invalidated = false;
+    }
+
+    // Anything but falling through to the next instruction (e.g. a jump, or a signal handler being entered) ends up
+    // in the block for wherever EIP went.
+    if (!m_current_block || m_eip != m_current_block_next_eip) {
+        auto& block = m_block_cache.ensure(m_eip, [] { return make<CachedBlock>(); });
+        m_current_block = block.ptr();
+        m_current_block_index = 0;
+    }
+
+    if (m_current_block_index == m_current_block->size()) {
+        save_base_eip();
+        auto instruction = X86::Instruction::from_stream(*this, X86::ProcessorMode::Protected);
+        m_current_block->append({ move(instruction), m_base_eip, m_eip });
+    }
+
+    auto const& cached_instruction = m_current_block->at(m_current_block_index++);
+    m_base_eip = cached_instruction.eip;
+    m_eip = cached_instruction.next_eip;
+    m_current_block_next_eip = cached_instruction.next_eip;
+    return cached_instruction.instruction;
+}
+
 ValueWithShadow<u8> SoftCPU::read_memory8(X86::LogicalAddress address)
 {
     VERIFY(address.selector() == 0x1b || address.selector() == 0x23 || address.selector() == 0x2b);
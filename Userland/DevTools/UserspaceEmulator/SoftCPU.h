@@ -13,6 +13,8 @@
 #include "ValueWithShadow.h"
 #include <AK/ByteReader.h>
 #include <AK/Debug.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
 #include <LibX86/Instruction.h>
 #include <LibX86/Interpreter.h>
 
@@ -61,6 +63,16 @@ public:
         m_eip = eip;
     }
 
+    // Decodes the instruction at EIP, or picks it up from the block cache if it has been decoded before, and leaves EIP
+    // pointing past it like X86::Instruction::from_stream() does. The instruction stays valid until the next fetch.
+    X86::Instruction const& fetch_instruction();
+
+    // Forgets about everything that has been decoded, for when code may have changed. Takes effect at the next fetch,
+    // so that the instruction that is currently executing isn't pulled out from under it.
+    void invalidate_instruction_cache() { m_block_cache_invalidated = true; }
+
+    void did_remove_region(Region const&);
+
     struct Flags {
         enum Flag {
             CF = 0x0001, // 0b0000'0000'0000'0001
@@ -1366,6 +1378,22 @@ private:
 
     Region* m_cached_code_region { nullptr };
     u8* m_cached_code_base_ptr { nullptr };
+
+    struct CachedInstruction {
+        X86::Instruction instruction;
+        u32 eip { 0 };
+        u32 next_eip { 0 };
+    };
+
+    // A run of instructions that have been executed one after the other, starting at the EIP it's cached under. Blocks
+    // grow whenever execution falls through their last instruction, so nothing is decoded that isn't executed.
+    using CachedBlock = Vector<CachedInstruction>;
+
+    HashMap<u32, NonnullOwnPtr<CachedBlock>> m_block_cache;
+    CachedBlock* m_current_block { nullptr };
+    size_t m_current_block_index { 0 };
+    u32 m_current_block_next_eip { 0 };
+    bool m_block_cache_invalidated { false };
 };
 
 ALWAYS_INLINE u8 SoftCPU::read8()
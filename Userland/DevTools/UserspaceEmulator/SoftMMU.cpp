@@ -8,6 +8,7 @@
 #include "Emulator.h"
 #include "MmapRegion.h"
 #include "Report.h"
+#include "SoftCPU.h"
 #include <AK/ByteBuffer.h>
 #include <AK/Memory.h>
 #include <AK/QuickSort.h>
@@ -35,6 +36,10 @@ void SoftMMU::add_region(NonnullOwnPtr<Region> region)
 
 void SoftMMU::remove_region(Region& region)
 {
+    m_emulator.cpu().did_remove_region(region);
+    if (m_last_region == &region)
+        m_last_region = nullptr;
+
     size_t first_page_in_region = region.base() / PAGE_SIZE;
     for (size_t i = 0; i < ceil_div(region.size(), PAGE_SIZE); ++i) {
         m_page_to_region_map[first_page_in_region + i] = nullptr;
@@ -66,6 +71,7 @@ void SoftMMU::ensure_split_at(X86::LogicalAddress address)
     // dbgln("splitting at {:p}", address.offset());
     // dbgln("    old region: {:p}-{:p}", old_region->base(), old_region->end() - 1);
 
+    m_last_region = nullptr;
     NonnullOwnPtr<MmapRegion> new_region = old_region->split_at(VirtualAddress(offset));
     // dbgln("    new region: {:p}-{:p}", new_region->base(), new_region->end() - 1);
     // dbgln(" up old region: {:p}-{:p}", old_region->base(), old_region->end() - 1);
@@ -212,6 +218,7 @@ void SoftMMU::write8(X86::LogicalAddress address, ValueWithShadow<u8> value)
         m_emulator.dump_backtrace();
         TODO();
     }
+    will_write_to(*region);
     region->write8(address.offset() - region->base(), value);
 }
 
@@ -230,6 +237,7 @@ void SoftMMU::write16(X86::LogicalAddress address, ValueWithShadow<u16> value)
         TODO();
     }
 
+    will_write_to(*region);
     region->write16(address.offset() - region->base(), value);
 }
 
@@ -248,6 +256,7 @@ void SoftMMU::write32(X86::LogicalAddress address, ValueWithShadow<u32> value)
         TODO();
     }
 
+    will_write_to(*region);
     region->write32(address.offset() - region->base(), value);
 }
 
@@ -266,6 +275,7 @@ void SoftMMU::write64(X86::LogicalAddress address, ValueWithShadow<u64> value)
         TODO();
     }
 
+    will_write_to(*region);
     region->write64(address.offset() - region->base(), value);
 }
 
@@ -284,6 +294,7 @@ void SoftMMU::write128(X86::LogicalAddress address, ValueWithShadow<u128> value)
         TODO();
     }
 
+    will_write_to(*region);
     region->write128(address.offset() - region->base(), value);
 }
 
@@ -302,21 +313,69 @@ void SoftMMU::write256(X86::LogicalAddress address, ValueWithShadow<u256> value)
         TODO();
     }
 
+    will_write_to(*region);
     region->write256(address.offset() - region->base(), value);
 }
 
+void SoftMMU::will_write_to(Region const& region)
+{
+    // Code that has been written to has to be decoded again before it's executed.
+    if (region.is_executable()) [[unlikely]]
+        m_emulator.cpu().invalidate_instruction_cache();
+}
+
 void SoftMMU::copy_to_vm(FlatPtr destination, void const* source, size_t size)
 {
     // FIXME: We should have a way to preserve the shadow data here as well.
-    for (size_t i = 0; i < size; ++i)
-        write8({ 0x23, destination + i }, shadow_wrap_as_initialized(((u8 const*)source)[i]));
+    while (size > 0) {
+        auto* region = find_region({ 0x23, destination });
+        if (!region || !region->is_writable()) {
+            // Let write8() report the problem.
+            write8({ 0x23, destination }, shadow_wrap_as_initialized(*(u8 const*)source));
+            VERIFY_NOT_REACHED();
+        }
+
+        // Everything that goes into the same region is copied, and audited, as a whole.
+        size_t offset_in_region = destination - region->base();
+        size_t chunk_size = min(size, static_cast<size_t>(region->size()) - offset_in_region);
+        if (is<MmapRegion>(*region) && static_cast<MmapRegion const&>(*region).is_malloc_block()) {
+            if (auto* tracer = m_emulator.malloc_tracer())
+                tracer->audit_write_range(*region, destination, chunk_size);
+        }
+        will_write_to(*region);
+        memcpy(region->data() + offset_in_region, source, chunk_size);
+        memset(region->shadow_data() + offset_in_region, 0x01, chunk_size);
+
+        destination += chunk_size;
+        source = (u8 const*)source + chunk_size;
+        size -= chunk_size;
+    }
 }
 
 void SoftMMU::copy_from_vm(void* destination, const FlatPtr source, size_t size)
 {
     // FIXME: We should have a way to preserve the shadow data here as well.
-    for (size_t i = 0; i < size; ++i)
-        ((u8*)destination)[i] = read8({ 0x23, source + i }).value();
+    FlatPtr address = source;
+    while (size > 0) {
+        auto* region = find_region({ 0x23, address });
+        if (!region || !region->is_readable()) {
+            // Let read8() report the problem.
+            (void)read8({ 0x23, address });
+            VERIFY_NOT_REACHED();
+        }
+
+        size_t offset_in_region = address - region->base();
+        size_t chunk_size = min(size, static_cast<size_t>(region->size()) - offset_in_region);
+        if (is<MmapRegion>(*region) && static_cast<MmapRegion const&>(*region).is_malloc_block()) {
+            if (auto* tracer = m_emulator.malloc_tracer())
+                tracer->audit_read_range(*region, address, chunk_size);
+        }
+        memcpy(destination, region->data() + offset_in_region, chunk_size);
+
+        destination = (u8*)destination + chunk_size;
+        address += chunk_size;
+        size -= chunk_size;
+    }
 }
 
 ByteBuffer SoftMMU::copy_buffer_from_vm(const FlatPtr source, size_t size)
@@ -337,14 +396,12 @@ bool SoftMMU::fast_fill_memory8(X86::LogicalAddress address, size_t size, ValueW
         return false;
 
     if (is<MmapRegion>(*region) && static_cast<MmapRegion const&>(*region).is_malloc_block()) {
-        if (auto* tracer = m_emulator.malloc_tracer()) {
-            // FIXME: Add a way to audit an entire range of memory instead of looping here!
-            for (size_t i = 0; i < size; ++i) {
-                tracer->audit_write(*region, address.offset() + (i * sizeof(u8)), sizeof(u8));
-            }
-        }
+        if (auto* tracer = m_emulator.malloc_tracer())
+            tracer->audit_write_range(*region, address.offset(), size);
     }
 
+    will_write_to(*region);
+
     size_t offset_in_region = address.offset() - region->base();
     memset(region->data() + offset_in_region, value.value(), size);
     memset(region->shadow_data() + offset_in_region, value.shadow()[0], size);
@@ -362,14 +419,12 @@ bool SoftMMU::fast_fill_memory32(X86::LogicalAddress address, size_t count, Valu
         return false;
 
     if (is<MmapRegion>(*region) && static_cast<MmapRegion const&>(*region).is_malloc_block()) {
-        if (auto* tracer = m_emulator.malloc_tracer()) {
-            // FIXME: Add a way to audit an entire range of memory instead of looping here!
-            for (size_t i = 0; i < count; ++i) {
-                tracer->audit_write(*region, address.offset() + (i * sizeof(u32)), sizeof(u32));
-            }
-        }
+        if (auto* tracer = m_emulator.malloc_tracer())
+            tracer->audit_write_range(*region, address.offset(), count * sizeof(u32));
     }
 
+    will_write_to(*region);
+
     size_t offset_in_region = address.offset() - region->base();
     fast_u32_fill((u32*)(region->data() + offset_in_region), value.value(), count);
     fast_u32_fill((u32*)(region->shadow_data() + offset_in_region), value.shadow_as_value(), count);
@@ -76,8 +76,16 @@ public:
         if (address.selector() == 0x2b)
             return m_tls_region.ptr();
 
+        // Accesses tend to come in runs to the same region (e.g. the stack, or whatever a loop is working on), and
+        // checking for that is cheaper than going through the page table.
+        if (m_last_region && m_last_region->contains(address.offset()))
+            return m_last_region;
+
         size_t page_index = address.offset() / PAGE_SIZE;
-        return m_page_to_region_map[page_index];
+        auto* region = m_page_to_region_map[page_index];
+        if (region)
+            m_last_region = region;
+        return region;
     }
 
     void add_region(NonnullOwnPtr<Region>);
@@ -139,9 +147,12 @@ public:
     }
 
 private:
+    void will_write_to(Region const&);
+
     Emulator& m_emulator;
 
     Region* m_page_to_region_map[786432] = { nullptr };
+    Region* m_last_region { nullptr };
 
     OwnPtr<Region> m_tls_region;
     NonnullOwnPtrVector<Region> m_regions;
@@ -42,6 +42,20 @@ bool TarFileHeader::is_zero_block() const
     return true;
 }
 
+ErrorOr<bool> TarFileHeader::is_valid() const
+{
+    auto const header_magic = magic();
+    auto const header_version = version();
+
+    if (!((header_magic == gnu_magic && header_version == gnu_version)
+            || (header_magic == ustar_magic && header_version == ustar_version)
+            || (header_magic == posix1_tar_magic && header_version == posix1_tar_version)))
+        return false;
+
+    // POSIX.1-1988 tar does not have magic numbers, so we also need to verify the header checksum.
+    return TRY(checksum()) == expected_checksum();
+}
+
 bool TarFileHeader::content_is_like_extended_header() const
 {
     return type_flag() == TarFileType::ExtendedHeader || type_flag() == TarFileType::GlobalExtendedHeader;
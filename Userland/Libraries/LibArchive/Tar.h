@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <AK/Concepts.h>
 #include <AK/String.h>
 #include <AK/StringView.h>
 #include <string.h>
@@ -131,6 +132,8 @@ public:
     ErrorOr<void> calculate_checksum();
 
     bool is_zero_block() const;
+    // Checks the magic, version and checksum of a header that isn't a zero block.
+    ErrorOr<bool> is_valid() const;
     bool content_is_like_extended_header() const;
 
     void set_filename_and_prefix(StringView filename);
@@ -154,4 +157,43 @@ private:
     char m_prefix[155] { 0 }; // zero out the prefix for archiving
 };
 
+// Calls `func` with the key and value of each record in the contents of a pax extended header.
+template<VoidFunction<StringView, StringView> F>
+inline ErrorOr<void> for_each_extended_header_record(StringView file_contents, F func)
+{
+    while (!file_contents.is_empty()) {
+        // Split off the length (until the first space).
+        Optional<size_t> length_end_index = file_contents.find(' ');
+        if (!length_end_index.has_value())
+            return Error::from_string_literal("Malformed extended header: No length found.");
+        Optional<unsigned int> length = file_contents.substring_view(0, length_end_index.value()).to_uint();
+        if (!length.has_value())
+            return Error::from_string_literal("Malformed extended header: Could not parse length.");
+        unsigned int remaining_length = length.value();
+
+        remaining_length -= length_end_index.value() + 1;
+        file_contents = file_contents.substring_view(length_end_index.value() + 1);
+
+        // Extract the header.
+        StringView header = file_contents.substring_view(0, remaining_length - 1);
+        file_contents = file_contents.substring_view(remaining_length - 1);
+
+        // Ensure that the header ends at the expected location.
+        if (file_contents.length() < 1 || !file_contents.starts_with('\n'))
+            return Error::from_string_literal("Malformed extended header: Header does not end at expected location.");
+        file_contents = file_contents.substring_view(1);
+
+        // Find the delimiting '='.
+        Optional<size_t> header_delimiter_index = header.find('=');
+        if (!header_delimiter_index.has_value())
+            return Error::from_string_literal("Malformed extended header: Header does not have a delimiter.");
+        StringView key = header.substring_view(0, header_delimiter_index.value());
+        StringView value = header.substring_view(header_delimiter_index.value() + 1);
+
+        func(key, value);
+    }
+
+    return {};
+}
+
 }
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/LexicalPath.h>
+#include <LibArchive/TarIndex.h>
+
+namespace Archive {
+
+ErrorOr<TarIndex> TarIndex::create(ReadonlyBytes archive)
+{
+    TarIndex index;
+
+    Optional<DeprecatedString> global_path_override;
+    Optional<DeprecatedString> local_path_override;
+    size_t number_of_consecutive_zero_blocks = 0;
+
+    size_t offset = 0;
+    while (true) {
+        // Like TarInputStream, accept archives that end without the end-of-archive marker.
+        if (offset == archive.size())
+            break;
+        if (archive.size() - offset < block_size)
+            return Error::from_string_literal("Failed to read the entire header");
+
+        auto const& header = *reinterpret_cast<TarFileHeader const*>(archive.offset_pointer(offset));
+        offset += block_size;
+
+        if (header.is_zero_block()) {
+            // Two zero blocks in a row marks the end of the archive.
+            if (++number_of_consecutive_zero_blocks >= 2)
+                break;
+            continue;
+        }
+        number_of_consecutive_zero_blocks = 0;
+
+        if (!TRY(header.is_valid()))
+            return Error::from_string_literal("Header has an invalid magic or checksum");
+
+        auto size = TRY(header.size());
+        if (size > archive.size() - offset)
+            return Error::from_string_literal("Member contents extend past the end of the archive");
+        auto contents = archive.slice(offset, size);
+        offset += min(archive.size() - offset, align_up_to(size, block_size));
+
+        switch (header.type_flag()) {
+        case TarFileType::GlobalExtendedHeader:
+            TRY(for_each_extended_header_record(StringView { contents }, [&](StringView key, StringView value) {
+                if (key != "path"sv)
+                    return;
+                if (value.is_empty())
+                    global_path_override.clear();
+                else
+                    global_path_override = value;
+            }));
+            continue;
+        case TarFileType::ExtendedHeader:
+            TRY(for_each_extended_header_record(StringView { contents }, [&](StringView key, StringView value) {
+                if (key == "path"sv)
+                    local_path_override = value;
+            }));
+            continue;
+        case TarFileType::LongName: {
+            // The name may be padded with null bytes.
+            StringView long_name { contents };
+            if (auto null_index = long_name.find('\0'); null_index.has_value())
+                long_name = long_name.substring_view(0, *null_index);
+            local_path_override = long_name;
+            continue;
+        }
+        default:
+            break;
+        }
+
+        DeprecatedString path;
+        if (local_path_override.has_value()) {
+            path = local_path_override.release_value();
+        } else if (global_path_override.has_value()) {
+            path = *global_path_override;
+        } else {
+            LexicalPath lexical_path { header.filename() };
+            if (!header.prefix().is_empty())
+                lexical_path = lexical_path.prepend(header.prefix());
+            path = lexical_path.string();
+        }
+
+        TRY(index.m_member_indices.try_set(path, index.m_members.size()));
+        TRY(index.m_members.try_append({ move(path), &header, contents }));
+    }
+
+    return index;
+}
+
+TarMember const* TarIndex::member_with_path(StringView path) const
+{
+    auto member_index = m_member_indices.get(path);
+    if (!member_index.has_value())
+        return nullptr;
+    return &m_members[*member_index];
+}
+
+}
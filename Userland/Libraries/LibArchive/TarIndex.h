@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/DeprecatedString.h>
+#include <AK/HashMap.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
+#include <LibArchive/Tar.h>
+
+namespace Archive {
+
+struct TarMember {
+    // The path after applying pax extended headers and GNU long names.
+    DeprecatedString path;
+    TarFileHeader const* header { nullptr };
+    ReadonlyBytes contents;
+};
+
+// An index over the members of an uncompressed tar archive that is entirely in memory (usually because it's mapped), so
+// that they can be looked up by path and read in any order. Unlike TarInputStream, this skips over member contents
+// without touching them, and the members point into the archive data, which has to outlive the index.
+class TarIndex {
+public:
+    static ErrorOr<TarIndex> create(ReadonlyBytes archive);
+
+    Span<TarMember const> members() const { return m_members; }
+
+    // Returns the last member with the given path, which is the one that ends up on disk when extracting everything.
+    TarMember const* member_with_path(StringView path) const;
+
+private:
+    TarIndex() = default;
+
+    Vector<TarMember> m_members;
+    HashMap<DeprecatedString, size_t> m_member_indices;
+};
+
+}
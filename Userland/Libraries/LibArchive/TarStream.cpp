@@ -118,16 +118,7 @@ ErrorOr<void> TarInputStream::load_next_header()
 
 ErrorOr<bool> TarInputStream::valid() const
 {
-    auto const header_magic = header().magic();
-    auto const header_version = header().version();
-
-    if (!((header_magic == gnu_magic && header_version == gnu_version)
-            || (header_magic == ustar_magic && header_version == ustar_version)
-            || (header_magic == posix1_tar_magic && header_version == posix1_tar_version)))
-        return false;
-
-    // POSIX.1-1988 tar does not have magic numbers, so we also need to verify the header checksum.
-    return TRY(header().checksum()) == header().expected_checksum();
+    return header().is_valid();
 }
 
 TarFileStream TarInputStream::file_contents()
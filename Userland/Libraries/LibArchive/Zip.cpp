@@ -39,6 +39,11 @@ Optional<Zip> Zip::try_create(ReadonlyBytes buffer)
     if (end_of_central_directory.disk_number != 0 || end_of_central_directory.central_directory_start_disk != 0 || end_of_central_directory.disk_records_count != end_of_central_directory.total_records_count)
         return {}; // TODO: support multi-volume zip archives
 
+    Vector<size_t> member_offsets;
+    HashMap<StringView, size_t> member_indices;
+    if (member_offsets.try_ensure_capacity(end_of_central_directory.total_records_count).is_error())
+        return {};
+
     size_t member_offset = end_of_central_directory.central_directory_offset;
     for (size_t i = 0; i < end_of_central_directory.total_records_count; i++) {
         CentralDirectoryRecord central_directory_record {};
@@ -65,37 +70,49 @@ Optional<Zip> Zip::try_create(ReadonlyBytes buffer)
             return {};
         if (buffer.size() - (local_file_header.compressed_data - buffer.data()) < central_directory_record.compressed_size)
             return {};
+
+        // Later members with the same name replace earlier ones when extracting everything, so they win here as well.
+        StringView name { central_directory_record.name, central_directory_record.name_length };
+        if (member_indices.try_set(name, i).is_error())
+            return {};
+        member_offsets.unchecked_append(member_offset);
         member_offset += central_directory_record.size();
     }
 
     return Zip {
-        end_of_central_directory.total_records_count,
-        end_of_central_directory.central_directory_offset,
+        move(member_offsets),
+        move(member_indices),
         buffer,
     };
 }
 
-ErrorOr<bool> Zip::for_each_member(Function<IterationDecision(ZipMember const&)> callback)
+ErrorOr<ZipMember> Zip::member_at(size_t index) const
 {
-    size_t member_offset = m_members_start_offset;
-    for (size_t i = 0; i < m_member_count; i++) {
-        CentralDirectoryRecord central_directory_record {};
-        VERIFY(central_directory_record.read(m_input_data.slice(member_offset)));
-        LocalFileHeader local_file_header {};
-        VERIFY(local_file_header.read(m_input_data.slice(central_directory_record.local_file_header_offset)));
+    CentralDirectoryRecord central_directory_record {};
+    VERIFY(central_directory_record.read(m_input_data.slice(m_member_offsets[index])));
+    LocalFileHeader local_file_header {};
+    VERIFY(local_file_header.read(m_input_data.slice(central_directory_record.local_file_header_offset)));
+
+    ZipMember member;
+    member.name = TRY(String::from_utf8({ central_directory_record.name, central_directory_record.name_length }));
+    member.compressed_data = { local_file_header.compressed_data, central_directory_record.compressed_size };
+    member.compression_method = central_directory_record.compression_method;
+    member.uncompressed_size = central_directory_record.uncompressed_size;
+    member.crc32 = central_directory_record.crc32;
+    member.is_directory = central_directory_record.external_attributes & zip_directory_external_attribute || member.name.bytes_as_string_view().ends_with('/'); // FIXME: better directory detection
+    return member;
+}
 
-        ZipMember member;
-        member.name = TRY(String::from_utf8({ central_directory_record.name, central_directory_record.name_length }));
-        member.compressed_data = { local_file_header.compressed_data, central_directory_record.compressed_size };
-        member.compression_method = central_directory_record.compression_method;
-        member.uncompressed_size = central_directory_record.uncompressed_size;
-        member.crc32 = central_directory_record.crc32;
-        member.is_directory = central_directory_record.external_attributes & zip_directory_external_attribute || member.name.bytes_as_string_view().ends_with('/'); // FIXME: better directory detection
+Optional<size_t> Zip::index_of_member(StringView name) const
+{
+    return m_member_indices.get(name);
+}
 
-        if (callback(member) == IterationDecision::Break)
+ErrorOr<bool> Zip::for_each_member(Function<IterationDecision(ZipMember const&)> callback)
+{
+    for (size_t i = 0; i < member_count(); i++) {
+        if (callback(TRY(member_at(i))) == IterationDecision::Break)
             return false;
-
-        member_offset += central_directory_record.size();
     }
     return true;
 }
@@ -9,6 +9,7 @@
 
 #include <AK/Array.h>
 #include <AK/Function.h>
+#include <AK/HashMap.h>
 #include <AK/IterationDecision.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
@@ -246,22 +247,31 @@ struct ZipMember {
     bool is_directory;
 };
 
+// The central directory is indexed up front, so members can be looked up by name and read in any order, also from
+// several threads at once.
 class Zip {
 public:
     static Optional<Zip> try_create(ReadonlyBytes buffer);
     ErrorOr<bool> for_each_member(Function<IterationDecision(ZipMember const&)>);
 
+    size_t member_count() const { return m_member_offsets.size(); }
+    ErrorOr<ZipMember> member_at(size_t index) const;
+    Optional<size_t> index_of_member(StringView name) const;
+
 private:
     static bool find_end_of_central_directory_offset(ReadonlyBytes, size_t& offset);
 
-    Zip(u16 member_count, size_t members_start_offset, ReadonlyBytes input_data)
-        : m_member_count { member_count }
-        , m_members_start_offset { members_start_offset }
+    Zip(Vector<size_t> member_offsets, HashMap<StringView, size_t> member_indices, ReadonlyBytes input_data)
+        : m_member_offsets { move(member_offsets) }
+        , m_member_indices { move(member_indices) }
         , m_input_data { input_data }
     {
     }
-    u16 m_member_count { 0 };
-    size_t m_members_start_offset { 0 };
+
+    // The offsets of the central directory records.
+    Vector<size_t> m_member_offsets;
+    // Names point into the central directory records, so they don't need to be copied.
+    HashMap<StringView, size_t> m_member_indices;
     ReadonlyBytes m_input_data;
 };
 
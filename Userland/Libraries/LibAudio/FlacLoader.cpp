@@ -195,6 +195,9 @@ MaybeLoaderError FlacLoaderPlugin::load_seektable(FlacRawMetadataBlock& block)
             .byte_offset = LOADER_TRY(seektable_bytes->read_bits<u64>(64)),
             .num_samples = LOADER_TRY(seektable_bytes->read_bits<u16>(16))
         };
+        // Placeholder points don't point anywhere.
+        if (seekpoint.sample_index == NumericLimits<u64>::max())
+            continue;
         m_seektable.append(seekpoint);
     }
     dbgln_if(AFLACLOADER_DEBUG, "Loaded seektable of size {}", m_seektable.size());
@@ -261,6 +264,7 @@ MaybeLoaderError FlacLoaderPlugin::seek(int int_sample_index)
         if (sample_index < m_loaded_samples) {
             LOADER_TRY(m_stream->seek(m_data_start_location, SeekMode::SetPosition));
             m_loaded_samples = 0;
+            m_unread_data.clear_with_capacity();
         }
         auto to_read = sample_index - m_loaded_samples;
         if (to_read == 0)
@@ -271,7 +275,7 @@ MaybeLoaderError FlacLoaderPlugin::seek(int int_sample_index)
         auto target_seekpoint = maybe_target_seekpoint.release_value();
 
         // When a small seek happens, we may already be closer to the target than the seekpoint.
-        if (sample_index - target_seekpoint.sample_index > sample_index - m_loaded_samples) {
+        if (sample_index > m_loaded_samples && sample_index - target_seekpoint.sample_index > sample_index - m_loaded_samples) {
             dbgln_if(AFLACLOADER_DEBUG, "Close enough to target: seeking {} samples manually", sample_index - m_loaded_samples);
             (void)TRY(get_more_samples(sample_index - m_loaded_samples));
             return {};
@@ -282,10 +286,12 @@ MaybeLoaderError FlacLoaderPlugin::seek(int int_sample_index)
         if (m_stream->seek(static_cast<i64>(position), SeekMode::SetPosition).is_error())
             return LoaderError { LoaderError::Category::IO, m_loaded_samples, DeprecatedString::formatted("Invalid seek position {}", position) };
 
-        auto remaining_samples_after_seekpoint = sample_index - m_data_start_location;
+        m_unread_data.clear_with_capacity();
+        m_loaded_samples = target_seekpoint.sample_index;
+
+        auto remaining_samples_after_seekpoint = sample_index - target_seekpoint.sample_index;
         if (remaining_samples_after_seekpoint > 0)
             (void)TRY(get_more_samples(remaining_samples_after_seekpoint));
-        m_loaded_samples = target_seekpoint.sample_index;
     }
     return {};
 }
@@ -314,7 +320,9 @@ LoaderSamples FlacLoaderPlugin::get_more_samples(size_t max_bytes_to_read_from_i
     }
 
     while (sample_index < samples_to_read) {
+        auto frame_byte_offset = LOADER_TRY(m_stream->tell()) - m_data_start_location;
         TRY(next_frame(samples.span().slice(sample_index)));
+        add_seekpoint(m_loaded_samples + sample_index, frame_byte_offset, m_current_frame->sample_count);
         sample_index += m_current_frame->sample_count;
     }
 
@@ -323,6 +331,13 @@ LoaderSamples FlacLoaderPlugin::get_more_samples(size_t max_bytes_to_read_from_i
     return samples;
 }
 
+void FlacLoaderPlugin::add_seekpoint(u64 sample_index, u64 byte_offset, u16 sample_count)
+{
+    if (!m_seektable.is_empty() && sample_index < m_seektable.last().sample_index + m_sample_rate)
+        return;
+    m_seektable.append({ .sample_index = sample_index, .byte_offset = byte_offset, .num_samples = sample_count });
+}
+
 // 11.21. FRAME
 MaybeLoaderError FlacLoaderPlugin::next_frame(Span<Sample> target_vector)
 {
@@ -393,13 +408,9 @@ MaybeLoaderError FlacLoaderPlugin::next_frame(Span<Sample> target_vector)
     };
 
     u8 subframe_count = frame_channel_type_to_channel_count(channel_type);
-    Vector<Vector<i32>> current_subframes;
-    current_subframes.ensure_capacity(subframe_count);
-
     for (u8 i = 0; i < subframe_count; ++i) {
         FlacSubframeHeader new_subframe = TRY(next_subframe_header(*bit_stream, i));
-        Vector<i32> subframe_samples = TRY(parse_subframe(new_subframe, *bit_stream));
-        current_subframes.unchecked_append(move(subframe_samples));
+        TRY(parse_subframe(new_subframe, *bit_stream, m_subframe_samples[i]));
     }
 
     // 11.2. Overview ("The audio data is composed of...")
@@ -410,13 +421,12 @@ MaybeLoaderError FlacLoaderPlugin::next_frame(Span<Sample> target_vector)
     [[maybe_unused]] u16 footer_checksum = LOADER_TRY(bit_stream->read_bits<u16>(16));
     dbgln_if(AFLACLOADER_DEBUG, "Subframe footer checksum: {}", footer_checksum);
 
-    Vector<i32> left;
-    Vector<i32> right;
+    // The channels are turned into left and right in place.
+    auto& left = m_subframe_samples[0];
+    auto& right = channel_type == FlacFrameChannelType::Mono ? m_subframe_samples[0] : m_subframe_samples[1];
 
     switch (channel_type) {
     case FlacFrameChannelType::Mono:
-        left = right = current_subframes[0];
-        break;
     case FlacFrameChannelType::Stereo:
     // TODO mix together surround channels on each side?
     case FlacFrameChannelType::StereoCenter:
@@ -425,38 +435,30 @@ MaybeLoaderError FlacLoaderPlugin::next_frame(Span<Sample> target_vector)
     case FlacFrameChannelType::Surround5p1:
     case FlacFrameChannelType::Surround6p1:
     case FlacFrameChannelType::Surround7p1:
-        left = current_subframes[0];
-        right = current_subframes[1];
         break;
     case FlacFrameChannelType::LeftSideStereo:
         // channels are left (0) and side (1)
-        left = current_subframes[0];
-        right.ensure_capacity(left.size());
         for (size_t i = 0; i < left.size(); ++i) {
             // right = left - side
-            right.unchecked_append(left[i] - current_subframes[1][i]);
+            right[i] = left[i] - right[i];
         }
         break;
     case FlacFrameChannelType::RightSideStereo:
         // channels are side (0) and right (1)
-        right = current_subframes[1];
-        left.ensure_capacity(right.size());
         for (size_t i = 0; i < right.size(); ++i) {
             // left = right + side
-            left.unchecked_append(right[i] + current_subframes[0][i]);
+            left[i] = right[i] + left[i];
         }
         break;
     case FlacFrameChannelType::MidSideStereo:
         // channels are mid (0) and side (1)
-        left.ensure_capacity(current_subframes[0].size());
-        right.ensure_capacity(current_subframes[0].size());
-        for (size_t i = 0; i < current_subframes[0].size(); ++i) {
-            i64 mid = current_subframes[0][i];
-            i64 side = current_subframes[1][i];
+        for (size_t i = 0; i < left.size(); ++i) {
+            i64 mid = left[i];
+            i64 side = right[i];
             mid *= 2;
             // prevent integer division errors
-            left.unchecked_append(static_cast<i32>((mid + side) / 2));
-            right.unchecked_append(static_cast<i32>((mid - side) / 2));
+            left[i] = static_cast<i32>((mid + side) / 2);
+            right[i] = static_cast<i32>((mid - side) / 2);
         }
         break;
     }
@@ -638,9 +640,11 @@ ErrorOr<FlacSubframeHeader, LoaderError> FlacLoaderPlugin::next_subframe_header(
     };
 }
 
-ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::parse_subframe(FlacSubframeHeader& subframe_header, BigEndianInputBitStream& bit_input)
+MaybeLoaderError FlacLoaderPlugin::parse_subframe(FlacSubframeHeader& subframe_header, BigEndianInputBitStream& bit_input, Vector<i32>& samples)
 {
-    Vector<i32> samples;
+    samples.clear_with_capacity();
+    if (samples.try_ensure_capacity(m_current_frame->sample_count).is_error())
+        return LoaderError { LoaderError::Category::Internal, static_cast<size_t>(m_current_sample_or_frame), "Couldn't allocate subframe buffer" };
 
     switch (subframe_header.type) {
     case FlacSubframeType::Constant: {
@@ -648,7 +652,6 @@ ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::parse_subframe(FlacSubframeH
         u64 constant_value = LOADER_TRY(bit_input.read_bits<u64>(subframe_header.bits_per_sample - subframe_header.wasted_bits_per_sample));
         dbgln_if(AFLACLOADER_DEBUG, "Constant subframe: {}", constant_value);
 
-        samples.ensure_capacity(m_current_frame->sample_count);
         VERIFY(subframe_header.bits_per_sample - subframe_header.wasted_bits_per_sample != 0);
         i32 constant = sign_extend(static_cast<u32>(constant_value), subframe_header.bits_per_sample - subframe_header.wasted_bits_per_sample);
         for (u32 i = 0; i < m_current_frame->sample_count; ++i) {
@@ -658,38 +661,40 @@ ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::parse_subframe(FlacSubframeH
     }
     case FlacSubframeType::Fixed: {
         dbgln_if(AFLACLOADER_DEBUG, "Fixed LPC subframe order {}", subframe_header.order);
-        samples = TRY(decode_fixed_lpc(subframe_header, bit_input));
+        TRY(decode_fixed_lpc(subframe_header, bit_input, samples));
         break;
     }
     case FlacSubframeType::Verbatim: {
         dbgln_if(AFLACLOADER_DEBUG, "Verbatim subframe");
-        samples = TRY(decode_verbatim(subframe_header, bit_input));
+        TRY(decode_verbatim(subframe_header, bit_input, samples));
         break;
     }
     case FlacSubframeType::LPC: {
         dbgln_if(AFLACLOADER_DEBUG, "Custom LPC subframe order {}", subframe_header.order);
-        samples = TRY(decode_custom_lpc(subframe_header, bit_input));
+        TRY(decode_custom_lpc(subframe_header, bit_input, samples));
         break;
     }
     default:
         return LoaderError { LoaderError::Category::Unimplemented, static_cast<size_t>(m_current_sample_or_frame), "Unhandled FLAC subframe type" };
     }
 
-    for (size_t i = 0; i < samples.size(); ++i) {
-        samples[i] <<= subframe_header.wasted_bits_per_sample;
+    if (subframe_header.wasted_bits_per_sample != 0) {
+        for (size_t i = 0; i < samples.size(); ++i) {
+            samples[i] <<= subframe_header.wasted_bits_per_sample;
+        }
     }
 
-    ResampleHelper<i32> resampler(m_current_frame->sample_rate, m_sample_rate);
-    return resampler.resample(samples);
+    if (m_current_frame->sample_rate != m_sample_rate) {
+        ResampleHelper<i32> resampler(m_current_frame->sample_rate, m_sample_rate);
+        samples = resampler.resample(samples);
+    }
+    return {};
 }
 
 // 11.29. SUBFRAME_VERBATIM
 // Decode a subframe that isn't actually encoded, usually seen in random data
-ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::decode_verbatim(FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input)
+MaybeLoaderError FlacLoaderPlugin::decode_verbatim(FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input, Vector<i32>& decoded)
 {
-    Vector<i32> decoded;
-    decoded.ensure_capacity(m_current_frame->sample_count);
-
     VERIFY(subframe.bits_per_sample - subframe.wasted_bits_per_sample != 0);
     for (size_t i = 0; i < m_current_frame->sample_count; ++i) {
         decoded.unchecked_append(sign_extend(
@@ -697,16 +702,13 @@ ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::decode_verbatim(FlacSubframe
             subframe.bits_per_sample - subframe.wasted_bits_per_sample));
     }
 
-    return decoded;
+    return {};
 }
 
 // 11.28. SUBFRAME_LPC
 // Decode a subframe encoded with a custom linear predictor coding, i.e. the subframe provides the polynomial order and coefficients
-ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::decode_custom_lpc(FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input)
+MaybeLoaderError FlacLoaderPlugin::decode_custom_lpc(FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input, Vector<i32>& decoded)
 {
-    Vector<i32> decoded;
-    decoded.ensure_capacity(m_current_frame->sample_count);
-
     VERIFY(subframe.bits_per_sample - subframe.wasted_bits_per_sample != 0);
     // warm-up samples
     for (auto i = 0; i < subframe.order; ++i) {
@@ -724,21 +726,35 @@ ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::decode_custom_lpc(FlacSubfra
     // shift needed on the data (signed!)
     i8 lpc_shift = sign_extend(LOADER_TRY(bit_input.read_bits<u8>(5)), 5);
 
-    Vector<i32> coefficients;
-    coefficients.ensure_capacity(subframe.order);
-    // read coefficients
+    // The coefficients are stored back to front, so that the prediction of a sample is a dot product of them and the
+    // samples before it, with both running in the same direction. This makes the loops below easy to vectorize.
+    Array<i32, 32> reversed_coefficients {};
     for (auto i = 0; i < subframe.order; ++i) {
         u32 raw_coefficient = LOADER_TRY(bit_input.read_bits<u32>(lpc_precision));
-        i32 coefficient = static_cast<i32>(sign_extend(raw_coefficient, lpc_precision));
-        coefficients.unchecked_append(coefficient);
+        reversed_coefficients[subframe.order - 1 - i] = static_cast<i32>(sign_extend(raw_coefficient, lpc_precision));
     }
 
-    dbgln_if(AFLACLOADER_DEBUG, "{}-bit {} shift coefficients: {}", lpc_precision, lpc_shift, coefficients);
+    dbgln_if(AFLACLOADER_DEBUG, "{}-bit {} shift reversed coefficients: {}", lpc_precision, lpc_shift, reversed_coefficients.span().trim(subframe.order));
 
     TRY(decode_residual(decoded, subframe, bit_input));
 
     // approximate the waveform with the predictor
+    // Every product of a coefficient and a sample fits into bits_per_sample + lpc_precision bits, and adding up `order` of
+    // them needs up to log2(order) more. If that still fits into 32 bits, so does the whole computation.
+    auto const* coefficients = reversed_coefficients.data();
+    if (subframe.bits_per_sample + lpc_precision + AK::ceil_log2(static_cast<u32>(subframe.order)) <= 32) {
+        for (size_t i = subframe.order; i < m_current_frame->sample_count; ++i) {
+            auto const* previous_samples = decoded.data() + i - subframe.order;
+            i32 sample = 0;
+            for (size_t t = 0; t < subframe.order; ++t)
+                sample += coefficients[t] * previous_samples[t];
+            decoded[i] += sample >> lpc_shift;
+        }
+        return {};
+    }
+
     for (size_t i = subframe.order; i < m_current_frame->sample_count; ++i) {
+        auto const* previous_samples = decoded.data() + i - subframe.order;
         // (see below)
         i64 sample = 0;
         for (size_t t = 0; t < subframe.order; ++t) {
@@ -747,21 +763,18 @@ ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::decode_custom_lpc(FlacSubfra
             // These will easily overflow 32 bits and cause strange white noise that abruptly stops intermittently (at the end of a frame).
             // The simple fix of course is to do intermediate computations in 64 bits.
             // These considerations are not in the original FLAC spec, but have been added to the IETF standard: https://datatracker.ietf.org/doc/html/draft-ietf-cellar-flac-03#appendix-A.3
-            sample += static_cast<i64>(coefficients[t]) * static_cast<i64>(decoded[i - t - 1]);
+            sample += static_cast<i64>(coefficients[t]) * static_cast<i64>(previous_samples[t]);
         }
         decoded[i] += sample >> lpc_shift;
     }
 
-    return decoded;
+    return {};
 }
 
 // 11.27. SUBFRAME_FIXED
 // Decode a subframe encoded with one of the fixed linear predictor codings
-ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::decode_fixed_lpc(FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input)
+MaybeLoaderError FlacLoaderPlugin::decode_fixed_lpc(FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input, Vector<i32>& decoded)
 {
-    Vector<i32> decoded;
-    decoded.ensure_capacity(m_current_frame->sample_count);
-
     VERIFY(subframe.bits_per_sample - subframe.wasted_bits_per_sample != 0);
     // warm-up samples
     for (auto i = 0; i < subframe.order; ++i) {
@@ -820,7 +833,7 @@ ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::decode_fixed_lpc(FlacSubfram
     default:
         return LoaderError { LoaderError::Category::Format, static_cast<size_t>(m_current_sample_or_frame), DeprecatedString::formatted("Unrecognized predictor order {}", subframe.order) };
     }
-    return decoded;
+    return {};
 }
 
 // 11.30. RESIDUAL
@@ -835,17 +848,13 @@ MaybeLoaderError FlacLoaderPlugin::decode_residual(Vector<i32>& decoded, FlacSub
     if (residual_mode == FlacResidualMode::Rice4Bit) {
         // 11.30.2. RESIDUAL_CODING_METHOD_PARTITIONED_EXP_GOLOMB
         // decode a single Rice partition with four bits for the order k
-        for (size_t i = 0; i < partitions; ++i) {
-            auto rice_partition = TRY(decode_rice_partition(4, partitions, i, subframe, bit_input));
-            decoded.extend(move(rice_partition));
-        }
+        for (size_t i = 0; i < partitions; ++i)
+            TRY(decode_rice_partition(decoded, 4, partitions, i, subframe, bit_input));
     } else if (residual_mode == FlacResidualMode::Rice5Bit) {
         // 11.30.3. RESIDUAL_CODING_METHOD_PARTITIONED_EXP_GOLOMB2
         // five bits equivalent
-        for (size_t i = 0; i < partitions; ++i) {
-            auto rice_partition = TRY(decode_rice_partition(5, partitions, i, subframe, bit_input));
-            decoded.extend(move(rice_partition));
-        }
+        for (size_t i = 0; i < partitions; ++i)
+            TRY(decode_rice_partition(decoded, 5, partitions, i, subframe, bit_input));
     } else
         return LoaderError { LoaderError::Category::Format, static_cast<size_t>(m_current_sample_or_frame), "Reserved residual coding method" };
 
@@ -854,7 +863,7 @@ MaybeLoaderError FlacLoaderPlugin::decode_residual(Vector<i32>& decoded, FlacSub
 
 // 11.30.2.1. EXP_GOLOMB_PARTITION and 11.30.3.1. EXP_GOLOMB2_PARTITION
 // Decode a single Rice partition as part of the residual, every partition can have its own Rice parameter k
-ALWAYS_INLINE ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::decode_rice_partition(u8 partition_type, u32 partitions, u32 partition_index, FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input)
+ALWAYS_INLINE MaybeLoaderError FlacLoaderPlugin::decode_rice_partition(Vector<i32>& decoded, u8 partition_type, u32 partitions, u32 partition_index, FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input)
 {
     // 11.30.2.2. EXP GOLOMB PARTITION ENCODING PARAMETER and 11.30.3.2. EXP-GOLOMB2 PARTITION ENCODING PARAMETER
     u8 k = LOADER_TRY(bit_input.read_bits<u8>(partition_type));
@@ -867,22 +876,23 @@ ALWAYS_INLINE ErrorOr<Vector<i32>, LoaderError> FlacLoaderPlugin::decode_rice_pa
     if (partition_index == 0)
         residual_sample_count -= subframe.order;
 
-    Vector<i32> rice_partition;
-    rice_partition.resize(residual_sample_count);
+    // The subframe's buffer has room for the whole frame, so a partition claiming to go past its end is invalid.
+    if (decoded.size() + residual_sample_count > decoded.capacity())
+        return LoaderError { LoaderError::Category::Format, static_cast<size_t>(m_current_sample_or_frame), "Residual partition is too large" };
 
     // escape code for unencoded binary partition
     if (k == (1 << partition_type) - 1) {
         u8 unencoded_bps = LOADER_TRY(bit_input.read_bits<u8>(5));
         for (size_t r = 0; r < residual_sample_count; ++r) {
-            rice_partition[r] = LOADER_TRY(bit_input.read_bits<u8>(unencoded_bps));
+            decoded.unchecked_append(LOADER_TRY(bit_input.read_bits<u8>(unencoded_bps)));
         }
     } else {
         for (size_t r = 0; r < residual_sample_count; ++r) {
-            rice_partition[r] = LOADER_TRY(decode_unsigned_exp_golomb(k, bit_input));
+            decoded.unchecked_append(LOADER_TRY(decode_unsigned_exp_golomb(k, bit_input)));
         }
     }
 
-    return rice_partition;
+    return {};
 }
 
 // Decode a single number encoded with Rice/Exponential-Golomb encoding (the unsigned variant)
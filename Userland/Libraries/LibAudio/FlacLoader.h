@@ -8,6 +8,7 @@
 
 #include "FlacTypes.h"
 #include "Loader.h"
+#include <AK/Array.h>
 #include <AK/BitStream.h>
 #include <AK/Error.h>
 #include <AK/Span.h>
@@ -75,17 +76,19 @@ private:
     MaybeLoaderError next_frame(Span<Sample>);
     // Helper of next_frame that fetches a sub frame's header
     ErrorOr<FlacSubframeHeader, LoaderError> next_subframe_header(BigEndianInputBitStream& bit_input, u8 channel_index);
-    // Helper of next_frame that decompresses a subframe
-    ErrorOr<Vector<i32>, LoaderError> parse_subframe(FlacSubframeHeader& subframe_header, BigEndianInputBitStream& bit_input);
+    // Helper of next_frame that decompresses a subframe into the given buffer
+    MaybeLoaderError parse_subframe(FlacSubframeHeader& subframe_header, BigEndianInputBitStream& bit_input, Vector<i32>& samples);
     // Subframe-internal data decoders (heavy lifting)
-    ErrorOr<Vector<i32>, LoaderError> decode_fixed_lpc(FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input);
-    ErrorOr<Vector<i32>, LoaderError> decode_verbatim(FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input);
-    ErrorOr<Vector<i32>, LoaderError> decode_custom_lpc(FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input);
+    MaybeLoaderError decode_fixed_lpc(FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input, Vector<i32>& decoded);
+    MaybeLoaderError decode_verbatim(FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input, Vector<i32>& decoded);
+    MaybeLoaderError decode_custom_lpc(FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input, Vector<i32>& decoded);
     MaybeLoaderError decode_residual(Vector<i32>& decoded, FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input);
-    // decode a single rice partition that has its own rice parameter
-    ALWAYS_INLINE ErrorOr<Vector<i32>, LoaderError> decode_rice_partition(u8 partition_type, u32 partitions, u32 partition_index, FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input);
+    // decode a single rice partition that has its own rice parameter, and append it to the decoded samples
+    ALWAYS_INLINE MaybeLoaderError decode_rice_partition(Vector<i32>& decoded, u8 partition_type, u32 partitions, u32 partition_index, FlacSubframeHeader& subframe, BigEndianInputBitStream& bit_input);
     MaybeLoaderError load_seektable(FlacRawMetadataBlock&);
     MaybeLoaderError load_picture(FlacRawMetadataBlock&);
+    // Remembers where a frame that was just decoded started, if the seektable doesn't already have a point close to it.
+    void add_seekpoint(u64 sample_index, u64 byte_offset, u16 sample_count);
 
     // Converters for special coding used in frame headers
     ALWAYS_INLINE ErrorOr<u32, LoaderError> convert_sample_count_code(u8 sample_count_code);
@@ -112,7 +115,11 @@ private:
     // Whatever the last get_more_samples() call couldn't return gets stored here.
     Vector<Sample, FLAC_BUFFER_SIZE> m_unread_data;
     u64 m_current_sample_or_frame { 0 };
+    // Sorted by sample index. Besides the points from the SEEKTABLE block, this gets a point about every second while
+    // decoding, so seeking back to where we've already been doesn't have to start over from the beginning.
     Vector<FlacSeekPoint> m_seektable;
+    // The decoded samples of each subframe of the current frame. They're kept around so that their buffers can be reused.
+    Array<Vector<i32>, 8> m_subframe_samples;
 };
 
 }
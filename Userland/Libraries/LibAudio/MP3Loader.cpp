@@ -8,6 +8,7 @@
 #include "MP3HuffmanTables.h"
 #include "MP3Tables.h"
 #include <AK/FixedArray.h>
+#include <AK/SIMD.h>
 
 namespace Audio {
 
@@ -802,39 +803,49 @@ void MP3LoaderPlugin::transform_samples_to_time(Array<float, 576> const& input,
 }
 
 // ISO/IEC 11172-3 (Figure A.2)
-void MP3LoaderPlugin::synthesis(Array<float, 1024>& V, Array<float, 32>& samples, Array<float, 32>& result)
+void MP3LoaderPlugin::synthesis(SynthesisBuffer& V, Array<float, 32>& samples, Array<float, 32>& result)
 {
-    for (size_t i = 1023; i >= 64; i--) {
-        V[i] = V[i - 64];
-    }
+    using AK::SIMD::f32x4;
 
-    for (size_t i = 0; i < 64; i++) {
-        V[i] = 0;
-        for (size_t k = 0; k < 32; k++) {
-            float const N = MP3::Tables::SynthesisSubbandFilterCoefficients[i][k];
-            V[i] += N * samples[k];
-        }
-    }
+    // Shifting V by 64 is the same as moving its start back by 64.
+    V.newest_block_offset = (V.newest_block_offset + V.values.size() - 64) % V.values.size();
 
-    Array<float, 512> U;
-    for (size_t i = 0; i < 8; i++) {
-        for (size_t j = 0; j < 32; j++) {
-            U[i * 64 + j] = V[i * 128 + j];
-            U[i * 64 + 32 + j] = V[i * 128 + 96 + j];
-        }
-    }
+    Array<f32x4, 8> sample_vectors;
+    __builtin_memcpy(sample_vectors.data(), samples.data(), sizeof(samples));
 
-    Array<float, 512> W;
-    for (size_t i = 0; i < 512; i++) {
-        W[i] = U[i] * MP3::Tables::WindowSynthesis[i];
+    auto* newest_block = V.values.data() + V.newest_block_offset;
+    for (size_t i = 0; i < 64; i++) {
+        f32x4 sum {};
+        auto const* N = MP3::Tables::SynthesisSubbandFilterCoefficients[i].data();
+        for (size_t k = 0; k < 8; k++) {
+            f32x4 coefficients;
+            __builtin_memcpy(&coefficients, N + k * 4, sizeof(coefficients));
+            sum += coefficients * sample_vectors[k];
+        }
+        newest_block[i] = sum[0] + sum[1] + sum[2] + sum[3];
     }
 
-    for (size_t j = 0; j < 32; j++) {
-        result[j] = 0;
-        for (size_t k = 0; k < 16; k++) {
-            result[j] += W[j + 32 * k];
+    // Building U from V, windowing it into W and summing up W are done in one go:
+    // result[j] = sum over i of V[i * 128 + j] * D[i * 64 + j] + V[i * 128 + 96 + j] * D[i * 64 + 32 + j]
+    // Every block of 64 values in V starts at a multiple of 64, so none of the runs of 32 wrap around.
+    auto values_at = [&](size_t index) { return V.values.data() + (V.newest_block_offset + index) % V.values.size(); };
+    Array<f32x4, 8> sums {};
+    for (size_t i = 0; i < 8; i++) {
+        auto const* first_values = values_at(i * 128);
+        auto const* second_values = values_at(i * 128 + 96);
+        auto const* first_window = MP3::Tables::WindowSynthesis.data() + i * 64;
+        auto const* second_window = first_window + 32;
+        for (size_t j = 0; j < 8; j++) {
+            f32x4 value, window;
+            __builtin_memcpy(&value, first_values + j * 4, sizeof(value));
+            __builtin_memcpy(&window, first_window + j * 4, sizeof(window));
+            sums[j] += value * window;
+            __builtin_memcpy(&value, second_values + j * 4, sizeof(value));
+            __builtin_memcpy(&window, second_window + j * 4, sizeof(window));
+            sums[j] += value * window;
         }
     }
+    __builtin_memcpy(result.data(), sums.data(), sizeof(result));
 }
 
 Span<MP3::Tables::ScaleFactorBand const> MP3LoaderPlugin::get_scalefactor_bands(MP3::Granule const& granule, int samplerate)
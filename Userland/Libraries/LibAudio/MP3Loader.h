@@ -55,12 +55,18 @@ private:
     static void reduce_alias(MP3::Granule&, size_t max_subband_index = 576);
     static void process_stereo(MP3::MP3Frame&, size_t granule_index);
     static void transform_samples_to_time(Array<float, 576> const& input, size_t input_offset, Array<float, 36>& output, MP3::BlockType block_type);
-    static void synthesis(Array<float, 1024>& V, Array<float, 32>& samples, Array<float, 32>& result);
+    // The last 16 blocks of synthesis values. Instead of shifting them along every time a block comes in, the newest
+    // block is written in front of the previous one, wrapping around at the start.
+    struct SynthesisBuffer {
+        Array<float, 1024> values {};
+        size_t newest_block_offset { 0 };
+    };
+    static void synthesis(SynthesisBuffer& V, Array<float, 32>& samples, Array<float, 32>& result);
     static Span<MP3::Tables::ScaleFactorBand const> get_scalefactor_bands(MP3::Granule const&, int samplerate);
 
     AK::Vector<AK::Tuple<size_t, int>> m_seek_table;
     AK::Array<AK::Array<AK::Array<float, 18>, 32>, 2> m_last_values {};
-    AK::Array<AK::Array<float, 1024>, 2> m_synthesis_buffer {};
+    AK::Array<SynthesisBuffer, 2> m_synthesis_buffer {};
     static DSP::MDCT<36> s_mdct_36;
     static DSP::MDCT<12> s_mdct_12;
 
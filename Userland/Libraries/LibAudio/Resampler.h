@@ -7,48 +7,65 @@
 #pragma once
 
 #include <AK/Concepts.h>
+#include <AK/Math.h>
+#include <AK/SIMD.h>
+#include <AK/StdLibExtras.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
+#include <LibAudio/Sample.h>
 
 namespace Audio {
 
-// Small helper to resample from one playback rate to another
-// This isn't really "smart", in that we just insert (or drop) samples.
-// Should do better...
+enum class ResamplingQuality {
+    // 8 taps per output sample.
+    Low,
+    // 16 taps per output sample.
+    Medium,
+    // 32 taps per output sample.
+    High,
+};
+
+// Resamples from one playback rate to another with a polyphase windowed-sinc filter.
+//
+// The ratio between the rates is reduced to target:source = L:M, and every output sample is a weighted sum of the input
+// samples around it. Where an output sample falls between two input samples decides which of L "phases" of the filter
+// is used; all of them are worked out up front. Rates with an awkward ratio get at most max_phase_count phases, with
+// output samples snapped to the one right before them.
+//
+// The resampler keeps its state between calls, so a stream can be fed to it in blocks of any size. In return, its output
+// lags half a filter length behind its input.
 template<typename SampleType>
 class ResampleHelper {
 public:
-    ResampleHelper(u32 source, u32 target)
+    ResampleHelper(u32 source, u32 target, ResamplingQuality quality = ResamplingQuality::Medium)
         : m_source(source)
         , m_target(target)
     {
         VERIFY(source > 0);
         VERIFY(target > 0);
-    }
-
-    // To be used as follows:
-    // while the resampler doesn't need a new sample, read_sample(current) and store the resulting samples.
-    // as long as the resampler needs a new sample, process_sample(current)
-
-    // Stores a new sample
-    void process_sample(SampleType sample_l, SampleType sample_r)
-    {
-        m_last_sample_l = sample_l;
-        m_last_sample_r = sample_r;
-        m_current_ratio += m_target;
-    }
 
-    // Assigns the given sample to its correct value and returns false if there is a new sample required
-    bool read_sample(SampleType& next_l, SampleType& next_r)
-    {
-        if (m_current_ratio >= m_source) {
-            m_current_ratio -= m_source;
-            next_l = m_last_sample_l;
-            next_r = m_last_sample_r;
-            return true;
+        auto divisor = greatest_common_divisor(source, target);
+        m_upsampling_factor = target / divisor;
+        m_downsampling_factor = source / divisor;
+        m_phase_count = min(m_upsampling_factor, max_phase_count);
+
+        switch (quality) {
+        case ResamplingQuality::Low:
+            m_tap_count = 8;
+            break;
+        case ResamplingQuality::Medium:
+            m_tap_count = 16;
+            break;
+        case ResamplingQuality::High:
+            m_tap_count = 32;
+            break;
         }
 
-        return false;
+        compute_filter_bank();
+        // Every input sample is stored twice, a filter length apart, so that the last m_tap_count of them are always
+        // next to each other in memory.
+        m_history.resize(2 * m_tap_count);
+        reset();
     }
 
     template<ArrayLike<SampleType> Samples>
@@ -62,13 +79,27 @@ public:
     template<ArrayLike<SampleType> Samples, size_t vector_inline_capacity = 0>
     ErrorOr<void> try_resample_into_end(Vector<SampleType, vector_inline_capacity>& destination, Samples&& to_resample)
     {
-        float ratio = (m_source > m_target) ? static_cast<float>(m_source) / m_target : static_cast<float>(m_target) / m_source;
-        TRY(destination.try_ensure_capacity(destination.size() + to_resample.size() * ratio));
-        for (auto sample : to_resample) {
-            process_sample(sample, sample);
-
-            while (read_sample(sample, sample))
+        if (m_source == m_target) {
+            TRY(destination.try_ensure_capacity(destination.size() + to_resample.size()));
+            for (auto const& sample : to_resample)
                 destination.unchecked_append(sample);
+            return {};
+        }
+
+        // The output of a block is at most one sample longer than the block times L / M.
+        auto maximum_output_size = (static_cast<u64>(to_resample.size()) * m_upsampling_factor) / m_downsampling_factor + 1;
+        TRY(destination.try_ensure_capacity(destination.size() + maximum_output_size));
+        for (auto const& sample : to_resample) {
+            append_to_history(sample);
+            if (--m_inputs_until_next_output > 0)
+                continue;
+
+            while (m_inputs_until_next_output == 0) {
+                destination.unchecked_append(interpolate());
+                m_phase += m_downsampling_factor;
+                m_inputs_until_next_output = m_phase / m_upsampling_factor;
+                m_phase %= m_upsampling_factor;
+            }
         }
         return {};
     }
@@ -79,22 +110,122 @@ public:
         return MUST(try_resample(forward<Samples>(to_resample)));
     }
 
+    // Forgets about the input so far, for when the next input doesn't continue it (e.g. after seeking).
     void reset()
     {
-        m_current_ratio = 0;
-        m_last_sample_l = {};
-        m_last_sample_r = {};
+        m_history.span().fill({});
+        m_history_position = 0;
+        m_phase = 0;
+        // The first output sample lines up with the first input sample, which needs the half filter after it.
+        m_inputs_until_next_output = m_tap_count / 2 + 1;
     }
 
     u32 source() const { return m_source; }
     u32 target() const { return m_target; }
 
 private:
+    static constexpr u32 max_phase_count = 256;
+    // Where the passband ends, relative to the lower of the two Nyquist frequencies.
+    static constexpr double passband = 0.95;
+    // Stereo samples are two floats next to each other, which lets four filter taps go through a vector at a time.
+    static constexpr bool is_stereo_float = IsSame<SampleType, Sample>;
+    static constexpr size_t values_per_sample = is_stereo_float ? 2 : 1;
+
+    static u32 greatest_common_divisor(u32 a, u32 b)
+    {
+        while (b != 0) {
+            auto remainder = a % b;
+            a = b;
+            b = remainder;
+        }
+        return a;
+    }
+
+    void compute_filter_bank()
+    {
+        auto cutoff = passband * min(1.0, static_cast<double>(m_upsampling_factor) / m_downsampling_factor);
+        auto half_length = static_cast<double>(m_tap_count) / 2;
+
+        m_filter_bank.resize(m_phase_count * m_tap_count * values_per_sample);
+        Vector<double> coefficients;
+        coefficients.resize(m_tap_count);
+        for (size_t phase = 0; phase < m_phase_count; ++phase) {
+            // Tap m_tap_count / 2 - 1 holds the input sample at or right before the output sample.
+            auto fraction = static_cast<double>(phase) / m_phase_count;
+            double sum = 0;
+            for (size_t tap = 0; tap < m_tap_count; ++tap) {
+                auto distance = static_cast<double>(tap) - (half_length - 1) - fraction;
+                auto x = AK::Pi<double> * cutoff * distance;
+                auto sinc = distance == 0 ? 1.0 : AK::sin(x) / x;
+                // Blackman window
+                auto window_position = AK::Pi<double> * distance / half_length;
+                auto window = 0.42 + 0.5 * AK::cos(window_position) + 0.08 * AK::cos(2 * window_position);
+                coefficients[tap] = sinc * window;
+                sum += coefficients[tap];
+            }
+
+            // Normalizing each phase keeps its gain at 0 Hz at exactly 1, so that phases don't add a ripple of their own.
+            auto* phase_coefficients = m_filter_bank.data() + phase * m_tap_count * values_per_sample;
+            for (size_t tap = 0; tap < m_tap_count; ++tap) {
+                for (size_t i = 0; i < values_per_sample; ++i)
+                    phase_coefficients[tap * values_per_sample + i] = static_cast<float>(coefficients[tap] / sum);
+            }
+        }
+    }
+
+    void append_to_history(SampleType const& sample)
+    {
+        m_history[m_history_position] = sample;
+        m_history[m_history_position + m_tap_count] = sample;
+        m_history_position = (m_history_position + 1) % m_tap_count;
+    }
+
+    SampleType interpolate() const
+    {
+        auto phase = static_cast<size_t>(static_cast<u64>(m_phase) * m_phase_count / m_upsampling_factor);
+        auto const* coefficients = m_filter_bank.data() + phase * m_tap_count * values_per_sample;
+        // The oldest sample comes first.
+        auto const* window = m_history.data() + m_history_position;
+
+        if constexpr (is_stereo_float) {
+            using AK::SIMD::f32x4;
+            auto const* values = reinterpret_cast<float const*>(window);
+            f32x4 sum {};
+            for (size_t i = 0; i < m_tap_count * 2; i += 4) {
+                f32x4 value;
+                f32x4 coefficient;
+                __builtin_memcpy(&value, values + i, sizeof(value));
+                __builtin_memcpy(&coefficient, coefficients + i, sizeof(coefficient));
+                sum += value * coefficient;
+            }
+            return { sum[0] + sum[2], sum[1] + sum[3] };
+        } else if constexpr (IsIntegral<SampleType>) {
+            float sum = 0;
+            for (size_t i = 0; i < m_tap_count; ++i)
+                sum += static_cast<float>(window[i]) * coefficients[i];
+            return round_to<SampleType>(sum);
+        } else {
+            SampleType sum {};
+            for (size_t i = 0; i < m_tap_count; ++i)
+                sum += window[i] * coefficients[i];
+            return sum;
+        }
+    }
+
     const u32 m_source;
     const u32 m_target;
-    u32 m_current_ratio { 0 };
-    SampleType m_last_sample_l {};
-    SampleType m_last_sample_r {};
+    u32 m_upsampling_factor { 1 };
+    u32 m_downsampling_factor { 1 };
+    u32 m_phase_count { 1 };
+    size_t m_tap_count { 0 };
+    // m_phase_count phases of m_tap_count taps each, with every tap repeated for both channels of stereo samples.
+    Vector<float> m_filter_bank;
+
+    Vector<SampleType> m_history;
+    size_t m_history_position { 0 };
+    // Where the next output sample lies between two input samples, in units of 1 / L.
+    u32 m_phase { 0 };
+    u32 m_inputs_until_next_output { 0 };
 };
 
 }
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Types.h>
+#include <cpuid.h>
+#include <string.h>
+
+extern "C" {
+
+extern size_t strlen_sse2(char const*);
+extern size_t strlen_avx2(char const*);
+extern size_t strnlen_sse2(char const*, size_t);
+extern char* strchr_sse2(char const*, int);
+extern void* memchr_sse2(void const*, int, size_t);
+extern void* memchr_avx2(void const*, int, size_t);
+extern int memcmp_sse2(void const*, void const*, size_t);
+extern void* memcpy_sse2(void*, void const*, size_t);
+extern void* memcpy_erms(void*, void const*, size_t);
+
+constexpr u32 tcg_signature_ebx = 0x54474354;
+constexpr u32 tcg_signature_ecx = 0x43544743;
+constexpr u32 tcg_signature_edx = 0x47435447;
+
+// Bits 27 and 28 of ecx in cpuid[eax = 1] indicate that the OS uses XSAVE, and support for AVX
+constexpr u32 cpuid_1_ecx_bit_osxsave = 1 << 27;
+constexpr u32 cpuid_1_ecx_bit_avx = 1 << 28;
+
+// Bits 5 and 9 of ebx in cpuid[eax = 7] indicate support for AVX2 and "Enhanced REP MOVSB/STOSB"
+constexpr u32 cpuid_7_ebx_bit_avx2 = 1 << 5;
+constexpr u32 cpuid_7_ebx_bit_erms = 1 << 9;
+
+// Bits 1 and 2 of XCR0 indicate that the OS saves the SSE and AVX registers on context switches
+constexpr u64 xcr0_sse_and_avx_state = 0b110;
+
+namespace {
+bool is_tcg()
+{
+    u32 eax, ebx, ecx, edx;
+    __cpuid(0x40000000, eax, ebx, ecx, edx);
+    return ebx == tcg_signature_ebx && ecx == tcg_signature_ecx && edx == tcg_signature_edx;
+}
+
+bool has_avx2()
+{
+    u32 eax, ebx, ecx, edx;
+    __cpuid(1, eax, ebx, ecx, edx);
+    if (!(ecx & cpuid_1_ecx_bit_osxsave) || !(ecx & cpuid_1_ecx_bit_avx))
+        return false;
+
+    u32 xcr0_low, xcr0_high;
+    asm volatile("xgetbv"
+                 : "=a"(xcr0_low), "=d"(xcr0_high)
+                 : "c"(0));
+    if ((xcr0_low & xcr0_sse_and_avx_state) != xcr0_sse_and_avx_state)
+        return false;
+
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return ebx & cpuid_7_ebx_bit_avx2;
+}
+
+// Note: SSE2 is part of the x86-64 baseline, so it is always available as a fallback.
+[[gnu::used]] decltype(&strlen) resolve_strlen()
+{
+    return has_avx2() ? strlen_avx2 : strlen_sse2;
+}
+
+[[gnu::used]] decltype(&strnlen) resolve_strnlen()
+{
+    return strnlen_sse2;
+}
+
+[[gnu::used]] decltype(&memchr) resolve_memchr()
+{
+    return has_avx2() ? memchr_avx2 : memchr_sse2;
+}
+
+[[gnu::used]] decltype(&memcmp) resolve_memcmp()
+{
+    return memcmp_sse2;
+}
+
+[[gnu::used]] decltype(&memcpy) resolve_memcpy()
+{
+    // Like with memset, TCG's rep movsb is slower than SSE copies despite it reporting ERMS support.
+    if (is_tcg())
+        return memcpy_sse2;
+
+    u32 eax, ebx, ecx, edx;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    if (ebx & cpuid_7_ebx_bit_erms)
+        return memcpy_erms;
+
+    return memcpy_sse2;
+}
+}
+
+// Note: strchr() only comes in one variant, so it doesn't need to be resolved at all.
+char* strchr(char const* str, int c)
+{
+    return strchr_sse2(str, c);
+}
+
+#if !defined(AK_COMPILER_CLANG) && !defined(_DYNAMIC_LOADER)
+[[gnu::ifunc("resolve_strlen")]] size_t strlen(char const*);
+[[gnu::ifunc("resolve_strnlen")]] size_t strnlen(char const*, size_t);
+[[gnu::ifunc("resolve_memchr")]] void* memchr(void const*, int, size_t);
+[[gnu::ifunc("resolve_memcmp")]] int memcmp(void const*, void const*, size_t);
+[[gnu::ifunc("resolve_memcpy")]] void* memcpy(void*, void const*, size_t);
+#else
+// DynamicLoader can't self-relocate IFUNCs.
+// FIXME: There's a circular dependency between LibC and libunwind when built with Clang,
+// so the IFUNC resolver could be called before LibC has been relocated, returning bogus addresses.
+size_t strlen(char const* str)
+{
+    static decltype(&strlen) s_impl = nullptr;
+    if (s_impl == nullptr)
+        s_impl = resolve_strlen();
+
+    return s_impl(str);
+}
+
+size_t strnlen(char const* str, size_t maxlen)
+{
+    return strnlen_sse2(str, maxlen);
+}
+
+void* memchr(void const* ptr, int c, size_t size)
+{
+    static decltype(&memchr) s_impl = nullptr;
+    if (s_impl == nullptr)
+        s_impl = resolve_memchr();
+
+    return s_impl(ptr, c, size);
+}
+
+int memcmp(void const* v1, void const* v2, size_t n)
+{
+    return memcmp_sse2(v1, v2, n);
+}
+
+void* memcpy(void* dest_ptr, void const* src_ptr, size_t n)
+{
+    static decltype(&memcpy) s_impl = nullptr;
+    if (s_impl == nullptr)
+        s_impl = resolve_memcpy();
+
+    return s_impl(dest_ptr, src_ptr, n);
+}
+#endif
+}
@@ -24,16 +24,35 @@ typedef void (*KeyDestructor)(void*);
 
 void __pthread_key_destroy_for_current_thread(void);
 
+// Tells the CPU that we're busy-waiting on a lock, so it can relax a bit.
+static inline void __pthread_spin_loop_hint(void)
+{
+#if defined(__x86_64__)
+    __asm__ volatile("pause");
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+}
+
 #define __PTHREAD_MUTEX_NORMAL 0
 #define __PTHREAD_MUTEX_RECURSIVE 1
-#define __PTHREAD_MUTEX_INITIALIZER     \
-    {                                   \
-        0, 0, 0, __PTHREAD_MUTEX_NORMAL \
+#define __PTHREAD_MUTEX_ADAPTIVE_NP 2
+#define __PTHREAD_PRIO_NONE 0
+#define __PTHREAD_PRIO_INHERIT 1
+#define __PTHREAD_PRIO_PROTECT 2
+#define __PTHREAD_MUTEX_INITIALIZER                          \
+    {                                                        \
+        0, 0, 0, __PTHREAD_MUTEX_NORMAL, __PTHREAD_PRIO_NONE \
+    }
+
+#define __PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP                \
+    {                                                           \
+        0, 0, 0, __PTHREAD_MUTEX_RECURSIVE, __PTHREAD_PRIO_NONE \
     }
 
-#define __PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP \
-    {                                            \
-        0, 0, 0, __PTHREAD_MUTEX_RECURSIVE       \
+#define __PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP                   \
+    {                                                             \
+        0, 0, 0, __PTHREAD_MUTEX_ADAPTIVE_NP, __PTHREAD_PRIO_NONE \
     }
 
 __END_DECLS
@@ -39,6 +39,7 @@ DIR* fdopendir(int fd)
     dirp->buffer = nullptr;
     dirp->buffer_size = 0;
     dirp->nextptr = nullptr;
+    dirp->buffer_has_stat = 0;
     return dirp;
 }
 
@@ -62,6 +63,7 @@ void rewinddir(DIR* dirp)
     dirp->buffer = nullptr;
     dirp->buffer_size = 0;
     dirp->nextptr = nullptr;
+    dirp->buffer_has_stat = 0;
     lseek(dirp->fd, 0, SEEK_SET);
 }
 
@@ -76,6 +78,17 @@ struct [[gnu::packed]] sys_dirent {
     }
 };
 
+// With get_dir_entries_with_stat(), every entry is followed by whether there's metadata for it, and the metadata.
+struct [[gnu::packed]] sys_dirent_stat {
+    u8 has_stat;
+    struct stat stat;
+};
+
+static size_t entry_size(DIR* dirp, sys_dirent* sys_ent)
+{
+    return sys_ent->total_size() + (dirp->buffer_has_stat ? sizeof(sys_dirent_stat) : 0);
+}
+
 static void create_struct_dirent(sys_dirent* sys_ent, struct dirent* str_ent)
 {
     str_ent->d_ino = sys_ent->ino;
@@ -92,7 +105,7 @@ static void create_struct_dirent(sys_dirent* sys_ent, struct dirent* str_ent)
     str_ent->d_name[sys_ent->namelen] = '\0';
 }
 
-static int allocate_dirp_buffer(DIR* dirp)
+static int allocate_dirp_buffer(DIR* dirp, bool with_stat = false)
 {
     if (dirp->buffer) {
         return 0;
@@ -111,8 +124,9 @@ static int allocate_dirp_buffer(DIR* dirp)
     dirp->buffer = (char*)malloc(size_to_allocate);
     if (!dirp->buffer)
         return ENOMEM;
+    dirp->buffer_has_stat = with_stat;
     for (;;) {
-        ssize_t nread = syscall(SC_get_dir_entries, dirp->fd, dirp->buffer, size_to_allocate);
+        ssize_t nread = syscall(with_stat ? SC_get_dir_entries_with_stat : SC_get_dir_entries, dirp->fd, dirp->buffer, size_to_allocate);
         if (nread < 0) {
             if (nread == -EINVAL) {
                 size_to_allocate *= 2;
@@ -156,7 +170,38 @@ dirent* readdir(DIR* dirp)
     auto* sys_ent = (sys_dirent*)dirp->nextptr;
     create_struct_dirent(sys_ent, &dirp->cur_ent);
 
-    dirp->nextptr += sys_ent->total_size();
+    dirp->nextptr += entry_size(dirp, sys_ent);
+    return &dirp->cur_ent;
+}
+
+struct dirent* readdir_with_stat(DIR* dirp, struct stat* statbuf, int* has_stat)
+{
+    *has_stat = 0;
+    if (!dirp)
+        return nullptr;
+    if (dirp->fd == -1)
+        return nullptr;
+
+    if (int new_errno = allocate_dirp_buffer(dirp, true)) {
+        errno = new_errno;
+        return nullptr;
+    }
+
+    if (dirp->nextptr >= (dirp->buffer + dirp->buffer_size))
+        return nullptr;
+
+    auto* sys_ent = (sys_dirent*)dirp->nextptr;
+    create_struct_dirent(sys_ent, &dirp->cur_ent);
+
+    if (dirp->buffer_has_stat) {
+        auto* sys_ent_stat = (sys_dirent_stat*)(dirp->nextptr + sys_ent->total_size());
+        if (sys_ent_stat->has_stat) {
+            memcpy(statbuf, &sys_ent_stat->stat, sizeof(struct stat));
+            *has_stat = 1;
+        }
+    }
+
+    dirp->nextptr += entry_size(dirp, sys_ent);
     return &dirp->cur_ent;
 }
 
@@ -193,7 +238,7 @@ int readdir_r(DIR* dirp, struct dirent* entry, struct dirent** result)
         found = compare_sys_struct_dirent(sys_ent, entry);
 
         // Make sure if we found one, it's the one after (end of buffer or not)
-        buffer += sys_ent->total_size();
+        buffer += entry_size(dirp, sys_ent);
         sys_ent = (sys_dirent*)buffer;
     }
 
@@ -8,6 +8,7 @@
 
 #include <Kernel/API/POSIX/dirent.h>
 #include <sys/cdefs.h>
+#include <sys/stat.h>
 
 __BEGIN_DECLS
 
@@ -25,6 +26,8 @@ struct __DIR {
     char* buffer;
     size_t buffer_size;
     char* nextptr;
+    // Whether the buffer holds the metadata of the entries as well, see readdir_with_stat().
+    int buffer_has_stat;
 };
 typedef struct __DIR DIR;
 
@@ -33,6 +36,10 @@ DIR* opendir(char const* name);
 int closedir(DIR*);
 void rewinddir(DIR*);
 struct dirent* readdir(DIR*);
+// Serenity extension: Like readdir(), but also stores the metadata of the entry into *statbuf and sets *has_stat to 1
+// when the kernel could provide it (as if by fstatat() without following symlinks), saving a stat() per entry.
+// Only works if it's used for the first read from the DIR, otherwise *has_stat is always 0.
+struct dirent* readdir_with_stat(DIR*, struct stat* statbuf, int* has_stat);
 int readdir_r(DIR*, struct dirent*, struct dirent**);
 int dirfd(DIR*);
 
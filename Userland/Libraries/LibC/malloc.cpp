@@ -43,18 +43,20 @@ private:
 
 #define RECYCLE_BIG_ALLOCATIONS
 
-static pthread_mutex_t s_malloc_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t s_malloc_mutex = PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP;
 bool __heap_is_stable = true;
 
 constexpr size_t number_of_hot_chunked_blocks_to_keep_around = 16;
 constexpr size_t number_of_cold_chunked_blocks_to_keep_around = 16;
 constexpr size_t number_of_big_blocks_to_keep_around_per_size_class = 8;
+constexpr size_t number_of_chunks_to_cache_per_thread_and_size_class = 32;
 
 static bool s_log_malloc = false;
 static bool s_scrub_malloc = true;
 static bool s_scrub_free = true;
 static bool s_profiling = false;
 static bool s_in_userspace_emulator = false;
+static bool s_use_thread_caches = true;
 
 ALWAYS_INLINE static void ue_notify_malloc(void const* ptr, size_t size)
 {
@@ -96,6 +98,8 @@ struct MemoryAuditingSuppressor {
 struct MallocStats {
     size_t number_of_malloc_calls;
 
+    size_t number_of_thread_cache_hits;
+
     size_t number_of_big_allocator_hits;
     size_t number_of_big_allocator_purge_hits;
     size_t number_of_big_allocs;
@@ -108,6 +112,9 @@ struct MallocStats {
 
     size_t number_of_free_calls;
 
+    size_t number_of_thread_cache_keeps;
+    size_t number_of_thread_cache_flushes;
+
     size_t number_of_big_allocator_keeps;
     size_t number_of_big_allocator_frees;
 
@@ -134,6 +141,17 @@ struct BigAllocator {
     Vector<BigAllocationBlock*, number_of_big_blocks_to_keep_around_per_size_class> blocks;
 };
 
+#ifndef NO_TLS
+// Every thread keeps some of the chunks it freed around, so most malloc() and free() calls
+// don't need to take s_malloc_mutex at all. It doesn't matter which thread allocated a chunk,
+// a thread whose cache overflows hands half of it back to the blocks in one go.
+struct ThreadCache {
+    FreelistEntry* chunks[num_size_classes];
+    size_t chunk_count[num_size_classes];
+};
+static __thread ThreadCache s_thread_cache;
+#endif
+
 // Allocators will be initialized in __malloc_init.
 // We can not rely on global constructors to initialize them,
 // because they must be initialized before other global constructors
@@ -321,6 +339,26 @@ static ErrorOr<void*> malloc_impl(size_t size, size_t align, CallerWillInitializ
     size_t good_size;
     auto* allocator = allocator_for_size(size, good_size, align);
 
+#ifndef NO_TLS
+    // Note: All chunks are at least 16-byte aligned, so any cached one will do for a standard-aligned malloc.
+    if (allocator && align <= 16 && s_use_thread_caches) {
+        size_t size_class = allocator - allocators();
+        if (auto* entry = s_thread_cache.chunks[size_class]) {
+            g_malloc_stats.number_of_thread_cache_hits++;
+            s_thread_cache.chunks[size_class] = entry->next;
+            --s_thread_cache.chunk_count[size_class];
+
+            void* ptr = entry;
+            dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} from the thread cache (size {})", ptr, good_size);
+            if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
+                memset(ptr, MALLOC_SCRUB_BYTE, good_size);
+
+            ue_notify_malloc(ptr, size);
+            return ptr;
+        }
+    }
+#endif
+
     PthreadMutexLocker locker(s_malloc_mutex);
 
     if (!allocator) {
@@ -443,6 +481,76 @@ static ErrorOr<void*> malloc_impl(size_t size, size_t align, CallerWillInitializ
     return ptr;
 }
 
+static size_t size_class_for_chunk_size(size_t bytes_per_chunk)
+{
+    for (size_t i = 0; size_classes[i]; ++i) {
+        if (size_classes[i] == bytes_per_chunk)
+            return i;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+// Puts a freed chunk back onto the freelist of its block. s_malloc_mutex has to be held for this.
+static void release_chunk(ChunkedBlock* block, void* ptr)
+{
+    auto* entry = (FreelistEntry*)ptr;
+    entry->next = block->m_freelist;
+    block->m_freelist = entry;
+
+    if (block->is_full()) {
+        size_t good_size;
+        auto* allocator = allocator_for_size(block->m_size, good_size);
+        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", block, good_size);
+        g_malloc_stats.number_of_freed_full_blocks++;
+        allocator->full_blocks.remove(*block);
+        allocator->usable_blocks.prepend(*block);
+    }
+
+    ++block->m_free_chunks;
+
+    if (!block->used_chunks()) {
+        size_t good_size;
+        auto* allocator = allocator_for_size(block->m_size, good_size);
+        if (s_hot_empty_block_count < number_of_hot_chunked_blocks_to_keep_around) {
+            dbgln_if(MALLOC_DEBUG, "Keeping hot block {:p} around", block);
+            g_malloc_stats.number_of_hot_keeps++;
+            allocator->usable_blocks.remove(*block);
+            s_hot_empty_blocks[s_hot_empty_block_count++] = block;
+            return;
+        }
+        if (s_cold_empty_block_count < number_of_cold_chunked_blocks_to_keep_around) {
+            dbgln_if(MALLOC_DEBUG, "Keeping cold block {:p} around", block);
+            g_malloc_stats.number_of_cold_keeps++;
+            allocator->usable_blocks.remove(*block);
+            s_cold_empty_blocks[s_cold_empty_block_count++] = block;
+            mprotect(block, ChunkedBlock::block_size, PROT_NONE);
+            madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
+            return;
+        }
+        dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", block, good_size);
+        g_malloc_stats.number_of_frees++;
+        allocator->usable_blocks.remove(*block);
+        --allocator->block_count;
+        os_free(block, ChunkedBlock::block_size);
+    }
+}
+
+#ifndef NO_TLS
+// Hands the given number of chunks of a size class from the thread cache back to their blocks.
+static void flush_thread_cache(size_t size_class, size_t count)
+{
+    g_malloc_stats.number_of_thread_cache_flushes++;
+    PthreadMutexLocker locker(s_malloc_mutex);
+    for (size_t i = 0; i < count; ++i) {
+        auto* entry = s_thread_cache.chunks[size_class];
+        VERIFY(entry);
+        s_thread_cache.chunks[size_class] = entry->next;
+        --s_thread_cache.chunk_count[size_class];
+        release_chunk((ChunkedBlock*)((FlatPtr)entry & ChunkedBlock::block_mask), entry);
+    }
+}
+#endif
+
 static void free_impl(void* ptr)
 {
 #ifndef NO_TLS
@@ -459,6 +567,27 @@ static void free_impl(void* ptr)
     void* block_base = (void*)((FlatPtr)ptr & ChunkedBlock::ChunkedBlock::block_mask);
     size_t magic = *(size_t*)block_base;
 
+#ifndef NO_TLS
+    if (magic == MAGIC_PAGE_HEADER && s_use_thread_caches) {
+        auto* block = (ChunkedBlock*)block_base;
+        dbgln_if(MALLOC_DEBUG, "LibC: freeing {:p} into the thread cache (size={})", ptr, block->bytes_per_chunk());
+
+        if (s_scrub_free)
+            memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
+
+        auto size_class = size_class_for_chunk_size(block->bytes_per_chunk());
+        if (s_thread_cache.chunk_count[size_class] == number_of_chunks_to_cache_per_thread_and_size_class)
+            flush_thread_cache(size_class, number_of_chunks_to_cache_per_thread_and_size_class / 2);
+
+        g_malloc_stats.number_of_thread_cache_keeps++;
+        auto* entry = (FreelistEntry*)ptr;
+        entry->next = s_thread_cache.chunks[size_class];
+        s_thread_cache.chunks[size_class] = entry;
+        ++s_thread_cache.chunk_count[size_class];
+        return;
+    }
+#endif
+
     PthreadMutexLocker locker(s_malloc_mutex);
 
     if (magic == MAGIC_BIGALLOC_HEADER) {
@@ -494,46 +623,7 @@ static void free_impl(void* ptr)
     if (s_scrub_free)
         memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
 
-    auto* entry = (FreelistEntry*)ptr;
-    entry->next = block->m_freelist;
-    block->m_freelist = entry;
-
-    if (block->is_full()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", block, good_size);
-        g_malloc_stats.number_of_freed_full_blocks++;
-        allocator->full_blocks.remove(*block);
-        allocator->usable_blocks.prepend(*block);
-    }
-
-    ++block->m_free_chunks;
-
-    if (!block->used_chunks()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        if (s_hot_empty_block_count < number_of_hot_chunked_blocks_to_keep_around) {
-            dbgln_if(MALLOC_DEBUG, "Keeping hot block {:p} around", block);
-            g_malloc_stats.number_of_hot_keeps++;
-            allocator->usable_blocks.remove(*block);
-            s_hot_empty_blocks[s_hot_empty_block_count++] = block;
-            return;
-        }
-        if (s_cold_empty_block_count < number_of_cold_chunked_blocks_to_keep_around) {
-            dbgln_if(MALLOC_DEBUG, "Keeping cold block {:p} around", block);
-            g_malloc_stats.number_of_cold_keeps++;
-            allocator->usable_blocks.remove(*block);
-            s_cold_empty_blocks[s_cold_empty_block_count++] = block;
-            mprotect(block, ChunkedBlock::block_size, PROT_NONE);
-            madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
-            return;
-        }
-        dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", block, good_size);
-        g_malloc_stats.number_of_frees++;
-        allocator->usable_blocks.remove(*block);
-        --allocator->block_count;
-        os_free(block, ChunkedBlock::block_size);
-    }
+    release_chunk(block, ptr);
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/malloc.html
@@ -663,6 +753,8 @@ void __malloc_init()
         // keeps track of heap memory anyway.
         s_scrub_malloc = false;
         s_scrub_free = false;
+        // Chunks sitting in a thread cache would look like they are still in use.
+        s_use_thread_caches = false;
     }
 
     if (secure_getenv("LIBC_NOSCRUB_MALLOC"))
@@ -673,6 +765,8 @@ void __malloc_init()
         s_log_malloc = true;
     if (secure_getenv("LIBC_PROFILE_MALLOC"))
         s_profiling = true;
+    if (secure_getenv("LIBC_NO_MALLOC_THREAD_CACHES"))
+        s_use_thread_caches = false;
 
     for (size_t i = 0; i < num_size_classes; ++i) {
         new (&allocators()[i]) Allocator();
@@ -682,10 +776,22 @@ void __malloc_init()
     new (&big_allocators()[0])(BigAllocator);
 }
 
+void __malloc_flush_thread_cache()
+{
+#ifndef NO_TLS
+    for (size_t size_class = 0; size_class < num_size_classes; ++size_class) {
+        if (s_thread_cache.chunk_count[size_class])
+            flush_thread_cache(size_class, s_thread_cache.chunk_count[size_class]);
+    }
+#endif
+}
+
 void serenity_dump_malloc_stats()
 {
     dbgln("# malloc() calls: {}", g_malloc_stats.number_of_malloc_calls);
     dbgln();
+    dbgln("thread cache hits: {}", g_malloc_stats.number_of_thread_cache_hits);
+    dbgln();
     dbgln("big alloc hits: {}", g_malloc_stats.number_of_big_allocator_hits);
     dbgln("big alloc hits that were purged: {}", g_malloc_stats.number_of_big_allocator_purge_hits);
     dbgln("big allocs: {}", g_malloc_stats.number_of_big_allocs);
@@ -698,6 +804,9 @@ void serenity_dump_malloc_stats()
     dbgln();
     dbgln("# free() calls: {}", g_malloc_stats.number_of_free_calls);
     dbgln();
+    dbgln("thread cache keeps: {}", g_malloc_stats.number_of_thread_cache_keeps);
+    dbgln("thread cache flushes: {}", g_malloc_stats.number_of_thread_cache_flushes);
+    dbgln();
     dbgln("big alloc keeps: {}", g_malloc_stats.number_of_big_allocator_keeps);
     dbgln("big alloc frees: {}", g_malloc_stats.number_of_big_allocator_frees);
     dbgln();
@@ -21,6 +21,7 @@
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/internals.h>
 #include <sys/mman.h>
 #include <syscall.h>
 #include <time.h>
@@ -57,6 +58,7 @@ extern "C" {
 [[noreturn]] static void exit_thread(void* code, void* stack_location, size_t stack_size)
 {
     __pthread_key_destroy_for_current_thread();
+    __malloc_flush_thread_cache();
     syscall(SC_exit_thread, code, stack_location, stack_size);
     VERIFY_NOT_REACHED();
 }
@@ -229,6 +231,7 @@ int pthread_mutex_destroy(pthread_mutex_t*)
 int pthread_mutexattr_init(pthread_mutexattr_t* attr)
 {
     attr->type = PTHREAD_MUTEX_NORMAL;
+    attr->protocol = PTHREAD_PRIO_NONE;
     return 0;
 }
 
@@ -242,7 +245,7 @@ int pthread_mutexattr_settype(pthread_mutexattr_t* attr, int type)
 {
     if (!attr)
         return EINVAL;
-    if (type != PTHREAD_MUTEX_NORMAL && type != PTHREAD_MUTEX_RECURSIVE)
+    if (type != PTHREAD_MUTEX_NORMAL && type != PTHREAD_MUTEX_RECURSIVE && type != PTHREAD_MUTEX_ADAPTIVE_NP)
         return EINVAL;
     attr->type = type;
     return 0;
@@ -255,6 +258,26 @@ int pthread_mutexattr_gettype(pthread_mutexattr_t* attr, int* type)
     return 0;
 }
 
+// https://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_mutexattr_setprotocol.html
+int pthread_mutexattr_setprotocol(pthread_mutexattr_t* attr, int protocol)
+{
+    if (!attr)
+        return EINVAL;
+    if (protocol == PTHREAD_PRIO_PROTECT)
+        return ENOTSUP;
+    if (protocol != PTHREAD_PRIO_NONE && protocol != PTHREAD_PRIO_INHERIT)
+        return EINVAL;
+    attr->protocol = protocol;
+    return 0;
+}
+
+// https://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_mutexattr_getprotocol.html
+int pthread_mutexattr_getprotocol(pthread_mutexattr_t const* attr, int* protocol)
+{
+    *protocol = attr->protocol;
+    return 0;
+}
+
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_attr_init.html
 int pthread_attr_init(pthread_attr_t* attributes)
 {
@@ -657,8 +680,6 @@ int pthread_equal(pthread_t t1, pthread_t t2)
     return t1 == t2;
 }
 
-// FIXME: Use the fancy futex mechanism above to write an rw lock.
-//        For the time being, let's just use a less-than-good lock to get things working.
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_destroy.html
 int pthread_rwlock_destroy(pthread_rwlock_t* rl)
 {
@@ -667,18 +688,22 @@ int pthread_rwlock_destroy(pthread_rwlock_t* rl)
     return 0;
 }
 
-// In a very non-straightforward way, this value is composed of two 32-bit integers
-// the top 32 bits are reserved for the ID of write-locking thread (if any)
-// and the bottom 32 bits are:
-//     top 2 bits (30,31): reader wake mask, writer wake mask
-//     middle 16 bits: information
-//        bit 16: someone is waiting to write
-//        bit 17: locked for write
-//     bottom 16 bits (0..15): reader count
+// The lock is made up of two 32-bit integers: the top 32 bits hold the ID of the write-locking thread (if any),
+// and the bottom 32 bits are the futex word:
+//     bit 31: a writer is waiting to be woken up
+//     bit 30: a reader is waiting to be woken up
+//     bit 29: locked for write
+//     bits 0..28: reader count
+// The lock prefers readers: they only ever wait for a writer that is holding the lock, so an uncontended
+// read lock is a single compare-and-swap, and readers never have to wait for each other.
+constexpr static u32 writer_wake_mask = 1u << 31;
 constexpr static u32 reader_wake_mask = 1 << 30;
-constexpr static u32 writer_wake_mask = 1 << 31;
-constexpr static u32 writer_locked_mask = 1 << 17;
-constexpr static u32 writer_intent_mask = 1 << 16;
+constexpr static u32 writer_locked_mask = 1 << 29;
+constexpr static u32 reader_count_mask = writer_locked_mask - 1;
+
+// Like adaptive mutexes, waiters spin for a bit before they go to sleep.
+constexpr static int max_rwlock_spin_count = 100;
+
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_init.html
 int pthread_rwlock_init(pthread_rwlock_t* __restrict lockp, pthread_rwlockattr_t const* __restrict attr)
 {
@@ -690,100 +715,92 @@ int pthread_rwlock_init(pthread_rwlock_t* __restrict lockp, pthread_rwlockattr_t
     return 0;
 }
 
-// Note that this function does not care about the top 32 bits at all.
-static int rwlock_rdlock_maybe_timed(u32* lockp, const struct timespec* timeout = nullptr, bool only_once = false, int value_if_timeout = -1, int value_if_okay = -2)
+static u32* rwlock_futex_word(pthread_rwlock_t* lockp)
 {
-    auto current = AK::atomic_load(lockp);
-    for (; !only_once;) {
-        // First, see if this is locked for writing
-        // if it's not, try to add to the counter.
-        // If someone is waiting to write, and there is one or no other readers, let them have the lock.
-        if (!(current & writer_locked_mask)) {
-            auto count = (u16)current;
-            if (!(current & writer_intent_mask) || count > 1) {
-                ++count;
-                auto desired = (current & 0xffff0000u) | count;
-                auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_acquire);
-                if (!did_exchange)
-                    continue; // tough luck, try again.
-                return value_if_okay;
-            }
-        }
+    return reinterpret_cast<u32*>(lockp);
+}
 
-        // If no one else is waiting for the read wake bit, set it.
-        if (!(current & reader_wake_mask)) {
-            auto desired = current | reader_wake_mask;
-            auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_acquire);
-            if (!did_exchange)
-                continue; // Something interesting happened!
+static pthread_t* rwlock_writer(pthread_rwlock_t* lockp)
+{
+    return reinterpret_cast<pthread_t*>(lockp) + 1;
+}
 
-            current = desired;
-        }
+// Sets `wake_mask` on the lock and sleeps until somebody signals it, or the lock changes under us.
+static int rwlock_wait(u32* futex_word, u32& current, u32 wake_mask, const struct timespec* abstime)
+{
+    if (!(current & wake_mask)) {
+        if (!AK::atomic_compare_exchange_strong(futex_word, current, current | wake_mask, AK::memory_order_relaxed))
+            return 0;
+        current |= wake_mask;
+    }
 
-        // Seems like someone is writing (or is interested in writing and we let them have the lock)
-        // wait until they're done.
-        auto rc = futex(lockp, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG, current, timeout, nullptr, reader_wake_mask);
-        if (rc < 0 && errno == ETIMEDOUT && timeout) {
-            return value_if_timeout;
-        }
-        if (rc < 0 && errno != EAGAIN) {
-            // Something broke. let's just bail out.
+    // Note: POSIX timeouts for rwlocks are measured against CLOCK_REALTIME.
+    int op = FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG | (abstime ? FUTEX_CLOCK_REALTIME : 0);
+    if (futex(futex_word, op, current, abstime, nullptr, wake_mask) < 0) {
+        if (errno != EAGAIN && errno != EINTR)
             return errno;
-        }
-        errno = 0;
-        // Reload the 'current' value
-        current = AK::atomic_load(lockp);
     }
-    return value_if_timeout;
-}
-
-static int rwlock_wrlock_maybe_timed(pthread_rwlock_t* lockval_p, const struct timespec* timeout = nullptr, bool only_once = false, int value_if_timeout = -1, int value_if_okay = -2)
-{
-    u32* lockp = reinterpret_cast<u32*>(lockval_p);
-    auto current = AK::atomic_load(lockp);
-    for (; !only_once;) {
-        // First, see if this is locked for writing, and if there are any readers.
-        // if not, lock it.
-        // If someone is waiting to write, let them have the lock.
-        if (!(current & writer_locked_mask) && ((u16)current) == 0) {
-            if (!(current & writer_intent_mask)) {
-                auto desired = current | writer_locked_mask | writer_intent_mask;
-                auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_acquire);
-                if (!did_exchange)
-                    continue;
-
-                // Now that we've locked the value, it's safe to set our thread ID.
-                AK::atomic_store(reinterpret_cast<i32*>(lockval_p) + 1, pthread_self());
-                return value_if_okay;
-            }
+    current = AK::atomic_load(futex_word, AK::memory_order_relaxed);
+    return 0;
+}
+
+static int rwlock_rdlock(pthread_rwlock_t* lockp, const struct timespec* abstime, bool should_block)
+{
+    auto* futex_word = rwlock_futex_word(lockp);
+    auto current = AK::atomic_load(futex_word, AK::memory_order_relaxed);
+    int spins = 0;
+    for (;;) {
+        if (!(current & writer_locked_mask)) {
+            if ((current & reader_count_mask) == reader_count_mask)
+                return EAGAIN;
+            if (AK::atomic_compare_exchange_strong(futex_word, current, current + 1, AK::memory_order_acquire))
+                return 0;
+            continue;
         }
 
-        // That didn't work, if no one else is waiting for the write bit, set it.
-        if (!(current & writer_wake_mask)) {
-            auto desired = current | writer_wake_mask | writer_intent_mask;
-            auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_acquire);
-            if (!did_exchange)
-                continue; // Something interesting happened!
+        if (!should_block)
+            return EBUSY;
 
-            current = desired;
+        if (spins < max_rwlock_spin_count) {
+            ++spins;
+            __pthread_spin_loop_hint();
+            current = AK::atomic_load(futex_word, AK::memory_order_relaxed);
+            continue;
         }
 
-        // Seems like someone is writing (or is interested in writing and we let them have the lock)
-        // wait until they're done.
-        auto rc = futex(lockp, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG, current, timeout, nullptr, writer_wake_mask);
-        if (rc < 0 && errno == ETIMEDOUT && timeout) {
-            return value_if_timeout;
+        if (auto rc = rwlock_wait(futex_word, current, reader_wake_mask, abstime); rc != 0)
+            return rc;
+    }
+}
+
+static int rwlock_wrlock(pthread_rwlock_t* lockp, const struct timespec* abstime, bool should_block)
+{
+    auto* futex_word = rwlock_futex_word(lockp);
+    auto current = AK::atomic_load(futex_word, AK::memory_order_relaxed);
+    int spins = 0;
+    for (;;) {
+        if (!(current & (writer_locked_mask | reader_count_mask))) {
+            if (!AK::atomic_compare_exchange_strong(futex_word, current, current | writer_locked_mask, AK::memory_order_acquire))
+                continue;
+
+            // Now that we've locked the value, it's safe to set our thread ID.
+            AK::atomic_store(rwlock_writer(lockp), pthread_self(), AK::memory_order_relaxed);
+            return 0;
         }
-        if (rc < 0 && errno != EAGAIN) {
-            // Something broke. let's just bail out.
-            return errno;
+
+        if (!should_block)
+            return EBUSY;
+
+        if (spins < max_rwlock_spin_count) {
+            ++spins;
+            __pthread_spin_loop_hint();
+            current = AK::atomic_load(futex_word, AK::memory_order_relaxed);
+            continue;
         }
-        errno = 0;
-        // Reload the 'current' value
-        current = AK::atomic_load(lockp);
-    }
 
-    return value_if_timeout;
+        if (auto rc = rwlock_wait(futex_word, current, writer_wake_mask, abstime); rc != 0)
+            return rc;
+    }
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_rdlock.html
@@ -792,7 +809,7 @@ int pthread_rwlock_rdlock(pthread_rwlock_t* lockp)
     if (!lockp)
         return EINVAL;
 
-    return rwlock_rdlock_maybe_timed(reinterpret_cast<u32*>(lockp), nullptr, false, 0, 0);
+    return rwlock_rdlock(lockp, nullptr, true);
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_timedrdlock.html
@@ -801,12 +818,7 @@ int pthread_rwlock_timedrdlock(pthread_rwlock_t* __restrict lockp, const struct
     if (!lockp)
         return EINVAL;
 
-    auto rc = rwlock_rdlock_maybe_timed(reinterpret_cast<u32*>(lockp), timespec);
-    if (rc == -1) // "ok"
-        return 0;
-    if (rc == -2) // "timed out"
-        return 1;
-    return rc;
+    return rwlock_rdlock(lockp, timespec, true);
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_timedwrlock.html
@@ -815,12 +827,7 @@ int pthread_rwlock_timedwrlock(pthread_rwlock_t* __restrict lockp, const struct
     if (!lockp)
         return EINVAL;
 
-    auto rc = rwlock_wrlock_maybe_timed(lockp, timespec);
-    if (rc == -1) // "ok"
-        return 0;
-    if (rc == -2) // "timed out"
-        return 1;
-    return rc;
+    return rwlock_wrlock(lockp, timespec, true);
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_tryrdlock.html
@@ -829,7 +836,7 @@ int pthread_rwlock_tryrdlock(pthread_rwlock_t* lockp)
     if (!lockp)
         return EINVAL;
 
-    return rwlock_rdlock_maybe_timed(reinterpret_cast<u32*>(lockp), nullptr, true, EBUSY, 0);
+    return rwlock_rdlock(lockp, nullptr, false);
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_trywrlock.html
@@ -838,49 +845,53 @@ int pthread_rwlock_trywrlock(pthread_rwlock_t* lockp)
     if (!lockp)
         return EINVAL;
 
-    return rwlock_wrlock_maybe_timed(lockp, nullptr, true, EBUSY, 0);
+    return rwlock_wrlock(lockp, nullptr, false);
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlock_unlock.html
-int pthread_rwlock_unlock(pthread_rwlock_t* lockval_p)
+int pthread_rwlock_unlock(pthread_rwlock_t* lockp)
 {
-    if (!lockval_p)
+    if (!lockp)
         return EINVAL;
 
     // This is a weird API, we don't really know whether we're unlocking write or read...
-    auto lockp = reinterpret_cast<u32*>(lockval_p);
-    auto current = AK::atomic_load(lockp, AK::MemoryOrder::memory_order_relaxed);
+    auto* futex_word = rwlock_futex_word(lockp);
+    auto current = AK::atomic_load(futex_word, AK::memory_order_relaxed);
     if (current & writer_locked_mask) {
         // If this lock is locked for writing, its owner better be us!
-        auto owner_id = AK::atomic_load(reinterpret_cast<i32*>(lockval_p) + 1);
-        auto my_id = pthread_self();
-        if (owner_id != my_id)
-            return EINVAL; // you don't own this lock, silly.
-
-        // Now just unlock it.
-        auto desired = current & ~(writer_locked_mask | writer_intent_mask);
-        AK::atomic_store(lockp, desired, AK::MemoryOrder::memory_order_release);
-        // Then wake both readers and writers, if any.
-        auto rc = futex(lockp, FUTEX_WAKE_BITSET | FUTEX_PRIVATE_FLAG, current, nullptr, nullptr, (current & writer_wake_mask) | reader_wake_mask);
-        if (rc < 0)
-            return errno;
+        if (AK::atomic_load(rwlock_writer(lockp), AK::memory_order_relaxed) != pthread_self())
+            return EPERM;
+
+        // Now just unlock it, and wake up everybody who waited for us.
+        AK::atomic_store(rwlock_writer(lockp), 0, AK::memory_order_relaxed);
+        auto previous = AK::atomic_exchange(futex_word, 0u, AK::memory_order_release);
+        if (auto wake_mask = previous & (reader_wake_mask | writer_wake_mask)) {
+            if (futex(futex_word, FUTEX_WAKE_BITSET | FUTEX_PRIVATE_FLAG, INT_MAX, nullptr, nullptr, wake_mask) < 0)
+                return errno;
+        }
         return 0;
     }
 
     for (;;) {
-        auto count = (u16)current;
+        auto count = current & reader_count_mask;
         if (!count) {
             // Are you crazy? this isn't even locked!
-            return EINVAL;
+            return EPERM;
         }
-        --count;
-        auto desired = (current & 0xffff0000u) | count;
-        auto did_exchange = AK::atomic_compare_exchange_strong(lockp, current, desired, AK::MemoryOrder::memory_order_release);
-        if (did_exchange)
+        // The last reader to leave lets the waiting writers have a go.
+        auto desired = current - 1;
+        if (count == 1)
+            desired &= ~writer_wake_mask;
+        if (AK::atomic_compare_exchange_strong(futex_word, current, desired, AK::memory_order_release))
             break;
         // tough luck, try again.
     }
 
+    if ((current & reader_count_mask) == 1 && (current & writer_wake_mask)) {
+        if (futex(futex_word, FUTEX_WAKE_BITSET | FUTEX_PRIVATE_FLAG, INT_MAX, nullptr, nullptr, writer_wake_mask) < 0)
+            return errno;
+    }
+
     // Finally, unlocked at last!
     return 0;
 }
@@ -891,7 +902,7 @@ int pthread_rwlock_wrlock(pthread_rwlock_t* lockp)
     if (!lockp)
         return EINVAL;
 
-    return rwlock_wrlock_maybe_timed(lockp, nullptr, false, 0, 0);
+    return rwlock_wrlock(lockp, nullptr, true);
 }
 
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_rwlockattr_destroy.html
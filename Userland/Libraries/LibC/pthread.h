@@ -66,9 +66,15 @@ int pthread_setschedparam(pthread_t thread, int policy, const struct sched_param
 
 #define PTHREAD_MUTEX_NORMAL __PTHREAD_MUTEX_NORMAL
 #define PTHREAD_MUTEX_RECURSIVE __PTHREAD_MUTEX_RECURSIVE
+#define PTHREAD_MUTEX_ADAPTIVE_NP __PTHREAD_MUTEX_ADAPTIVE_NP
 #define PTHREAD_MUTEX_DEFAULT PTHREAD_MUTEX_NORMAL
 #define PTHREAD_MUTEX_INITIALIZER __PTHREAD_MUTEX_INITIALIZER
+
+#define PTHREAD_PRIO_NONE __PTHREAD_PRIO_NONE
+#define PTHREAD_PRIO_INHERIT __PTHREAD_PRIO_INHERIT
+#define PTHREAD_PRIO_PROTECT __PTHREAD_PRIO_PROTECT
 #define PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP __PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP
+#define PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP __PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP
 
 #define PTHREAD_PROCESS_PRIVATE 1
 #define PTHREAD_PROCESS_SHARED 2
@@ -120,6 +126,8 @@ int pthread_equal(pthread_t, pthread_t);
 int pthread_mutexattr_init(pthread_mutexattr_t*);
 int pthread_mutexattr_settype(pthread_mutexattr_t*, int);
 int pthread_mutexattr_gettype(pthread_mutexattr_t*, int*);
+int pthread_mutexattr_setprotocol(pthread_mutexattr_t*, int);
+int pthread_mutexattr_getprotocol(pthread_mutexattr_t const*, int*);
 int pthread_mutexattr_destroy(pthread_mutexattr_t*);
 
 int pthread_setname_np(pthread_t, char const*);
@@ -150,12 +150,26 @@ int pthread_cond_broadcast(pthread_cond_t* cond)
     if (!(value & NEED_TO_WAKE_ALL)) [[likely]]
         return 0;
 
-    AK::atomic_fetch_and(&cond->value, ~(NEED_TO_WAKE_ONE | NEED_TO_WAKE_ALL), AK::memory_order_acquire);
+    value = AK::atomic_fetch_and(&cond->value, ~(NEED_TO_WAKE_ONE | NEED_TO_WAKE_ALL), AK::memory_order_acquire) & ~(NEED_TO_WAKE_ONE | NEED_TO_WAKE_ALL);
 
     pthread_mutex_t* mutex = AK::atomic_load(&cond->mutex, AK::memory_order_relaxed);
     VERIFY(mutex);
 
-    int rc = futex(&cond->value, FUTEX_REQUEUE | FUTEX_PRIVATE_FLAG, 1, nullptr, &mutex->lock, INT_MAX);
-    VERIFY(rc >= 0);
+    // Only the owner of a priority-inheriting mutex may sleep on it, so waiters can't be moved over.
+    if (mutex->protocol == PTHREAD_PRIO_INHERIT) {
+        int rc = futex_wake(&cond->value, INT_MAX, false);
+        VERIFY(rc >= 0);
+        return 0;
+    }
+
+    // Wake up a single waiter and move everyone else over to the mutex. It will then wake them one by one
+    // as it gets unlocked, instead of all of them waking up at once only to fight over it.
+    // NOTE: FUTEX_CMP_REQUEUE takes the number of waiters to requeue in place of the timeout.
+    auto const* requeue_count = reinterpret_cast<struct timespec const*>(static_cast<uintptr_t>(INT_MAX));
+    while (futex(&cond->value, FUTEX_CMP_REQUEUE | FUTEX_PRIVATE_FLAG, 1, requeue_count, &mutex->lock, value) < 0) {
+        // Someone else changed the value in the meantime, so the set of waiters we'd requeue changed too.
+        VERIFY(errno == EAGAIN);
+        value = AK::atomic_load(&cond->value, AK::memory_order_relaxed);
+    }
     return 0;
 }
@@ -104,12 +104,75 @@ int pthread_mutex_init(pthread_mutex_t* mutex, pthread_mutexattr_t const* attrib
     mutex->owner = 0;
     mutex->level = 0;
     mutex->type = attributes ? attributes->type : __PTHREAD_MUTEX_NORMAL;
+    mutex->protocol = attributes ? attributes->protocol : __PTHREAD_PRIO_NONE;
+    mutex->spins = 0;
     return 0;
 }
 
+// Adaptive mutexes spin for a bit before going to sleep, as the owner of a mutex guarding a short critical section
+// is likely to release it soon. Like in glibc, how long we spin follows how long it took to get the mutex before.
+static constexpr int max_adaptive_mutex_spin_count = 100;
+
+static bool pthread_mutex_spin_for_lock(pthread_mutex_t* mutex)
+{
+    int max_spins = min(max_adaptive_mutex_spin_count, mutex->spins * 2 + 10);
+    int spins = 0;
+    bool did_lock = false;
+    for (; spins < max_spins; ++spins) {
+        u32 value = AK::atomic_load(&mutex->lock, AK::memory_order_relaxed);
+        if (value == MUTEX_UNLOCKED && AK::atomic_compare_exchange_strong(&mutex->lock, value, MUTEX_LOCKED_NO_NEED_TO_WAKE, AK::memory_order_acquire)) {
+            did_lock = true;
+            break;
+        }
+        __pthread_spin_loop_hint();
+    }
+    mutex->spins += (spins - mutex->spins) / 8;
+    return did_lock;
+}
+
+// A priority-inheriting mutex holds the thread ID of its owner, so that the kernel knows whose priority to raise
+// while we wait for it. Once anyone had to wait, FUTEX_WAITERS is set and the owner has to unlock through the kernel.
+static int pthread_mutex_lock_priority_inheriting(pthread_mutex_t* mutex, bool should_block)
+{
+    u32 self = static_cast<u32>(pthread_self());
+    u32 value = MUTEX_UNLOCKED;
+    if (!AK::atomic_compare_exchange_strong(&mutex->lock, value, self, AK::memory_order_acquire)) {
+        if ((value & FUTEX_TID_MASK) == self) {
+            if (mutex->type != __PTHREAD_MUTEX_RECURSIVE)
+                return EDEADLK;
+            // We already own the mutex!
+            mutex->level++;
+            return 0;
+        }
+        if (!should_block)
+            return EBUSY;
+        int rc;
+        do {
+            rc = futex(&mutex->lock, FUTEX_LOCK_PI | FUTEX_PRIVATE_FLAG, 0, nullptr, nullptr, 0);
+        } while (rc < 0 && errno == EINTR);
+        if (rc < 0)
+            return errno;
+    }
+
+    mutex->level = 0;
+    return 0;
+}
+
+static void pthread_mutex_unlock_priority_inheriting(pthread_mutex_t* mutex)
+{
+    u32 value = static_cast<u32>(pthread_self());
+    if (AK::atomic_compare_exchange_strong(&mutex->lock, value, MUTEX_UNLOCKED, AK::memory_order_release)) [[likely]]
+        return;
+    int rc = futex(&mutex->lock, FUTEX_UNLOCK_PI | FUTEX_PRIVATE_FLAG, 0, nullptr, nullptr, 0);
+    VERIFY(rc >= 0);
+}
+
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_mutex_trylock.html
 int pthread_mutex_trylock(pthread_mutex_t* mutex)
 {
+    if (mutex->protocol == __PTHREAD_PRIO_INHERIT) [[unlikely]]
+        return pthread_mutex_lock_priority_inheriting(mutex, false);
+
     u32 expected = MUTEX_UNLOCKED;
     bool exchanged = AK::atomic_compare_exchange_strong(&mutex->lock, expected, MUTEX_LOCKED_NO_NEED_TO_WAKE, AK::memory_order_acquire);
 
@@ -132,6 +195,9 @@ int pthread_mutex_trylock(pthread_mutex_t* mutex)
 // https://pubs.opengroup.org/onlinepubs/009695399/functions/pthread_mutex_lock.html
 int pthread_mutex_lock(pthread_mutex_t* mutex)
 {
+    if (mutex->protocol == __PTHREAD_PRIO_INHERIT) [[unlikely]]
+        return pthread_mutex_lock_priority_inheriting(mutex, true);
+
     // Fast path: attempt to claim the mutex without waiting.
     u32 value = MUTEX_UNLOCKED;
     bool exchanged = AK::atomic_compare_exchange_strong(&mutex->lock, value, MUTEX_LOCKED_NO_NEED_TO_WAKE, AK::memory_order_acquire);
@@ -147,6 +213,9 @@ int pthread_mutex_lock(pthread_mutex_t* mutex)
             mutex->level++;
             return 0;
         }
+    } else if (mutex->type == __PTHREAD_MUTEX_ADAPTIVE_NP && pthread_mutex_spin_for_lock(mutex)) {
+        mutex->level = 0;
+        return 0;
     }
 
     // Slow path: wait, record the fact that we're going to wait, and always
@@ -170,6 +239,9 @@ int __pthread_mutex_lock_pessimistic_np(pthread_mutex_t* mutex)
     // Same as pthread_mutex_lock(), but always set MUTEX_LOCKED_NEED_TO_WAKE,
     // and also don't bother checking for already owning the mutex recursively,
     // because we know we don't. Used in the condition variable implementation.
+    if (mutex->protocol == __PTHREAD_PRIO_INHERIT) [[unlikely]]
+        return pthread_mutex_lock_priority_inheriting(mutex, true);
+
     u32 value = AK::atomic_exchange(&mutex->lock, MUTEX_LOCKED_NEED_TO_WAKE, AK::memory_order_acquire);
     while (value != MUTEX_UNLOCKED) {
         futex_wait(&mutex->lock, value, nullptr, 0, false);
@@ -190,6 +262,11 @@ int pthread_mutex_unlock(pthread_mutex_t* mutex)
         return 0;
     }
 
+    if (mutex->protocol == __PTHREAD_PRIO_INHERIT) [[unlikely]] {
+        pthread_mutex_unlock_priority_inheriting(mutex);
+        return 0;
+    }
+
     if (mutex->type == __PTHREAD_MUTEX_RECURSIVE)
         AK::atomic_store(&mutex->owner, 0, AK::memory_order_relaxed);
 
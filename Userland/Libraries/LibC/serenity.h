@@ -61,6 +61,9 @@ int get_stack_bounds(uintptr_t* user_stack_base, size_t* user_stack_size);
 
 int anon_create(size_t size, int options);
 
+int io_ring_create(unsigned entries, int options);
+int io_ring_enter(int fd, unsigned to_submit);
+
 int serenity_readlink(char const* path, size_t path_length, char* buffer, size_t buffer_size);
 
 int getkeymap(char* name_buffer, size_t name_buffer_size, uint32_t* map, uint32_t* shift_map, uint32_t* alt_map, uint32_t* altgr_map, uint32_t* shift_altgr_map);
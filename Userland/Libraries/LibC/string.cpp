@@ -50,6 +50,8 @@ size_t strcspn(char const* s, char const* reject)
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/strlen.html
+// For x86-64, optimized ASM implementations are found in ./arch/x86_64/string.S
+#if !ARCH(X86_64)
 size_t strlen(char const* str)
 {
     size_t len = 0;
@@ -66,6 +68,7 @@ size_t strnlen(char const* str, size_t maxlen)
         len++;
     return len;
 }
+#endif
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/strdup.html
 char* strdup(char const* str)
@@ -111,6 +114,8 @@ int strncmp(char const* s1, char const* s2, size_t n)
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/memcmp.html
+// For x86-64, an optimized ASM implementation is found in ./arch/x86_64/string.S
+#if !ARCH(X86_64)
 int memcmp(void const* v1, void const* v2, size_t n)
 {
     auto* s1 = (uint8_t const*)v1;
@@ -121,6 +126,7 @@ int memcmp(void const* v1, void const* v2, size_t n)
     }
     return 0;
 }
+#endif
 
 int timingsafe_memcmp(void const* b1, void const* b2, size_t len)
 {
@@ -128,23 +134,19 @@ int timingsafe_memcmp(void const* b1, void const* b2, size_t len)
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/memcpy.html
+// For x86-64, optimized ASM implementations are found in ./arch/x86_64/string.S
+#if ARCH(AARCH64)
 void* memcpy(void* dest_ptr, void const* src_ptr, size_t n)
 {
-#if ARCH(X86_64)
-    void* original_dest = dest_ptr;
-    asm volatile(
-        "rep movsb"
-        : "+D"(dest_ptr), "+S"(src_ptr), "+c"(n)::"memory");
-    return original_dest;
-#elif ARCH(AARCH64)
     (void)dest_ptr;
     (void)src_ptr;
     (void)n;
     TODO_AARCH64();
+}
+#elif ARCH(X86_64)
 #else
 #    error Unknown architecture
 #endif
-}
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/memset.html
 // For x86-64, an optimized ASM implementation is found in ./arch/x86_64/memset.S
@@ -213,6 +215,8 @@ size_t strlcpy(char* dest, char const* src, size_t n)
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/strchr.html
+// For x86-64, an optimized ASM implementation is found in ./arch/x86_64/string.S
+#if !ARCH(X86_64)
 char* strchr(char const* str, int c)
 {
     char ch = c;
@@ -223,6 +227,7 @@ char* strchr(char const* str, int c)
             return nullptr;
     }
 }
+#endif
 
 // https://pubs.opengroup.org/onlinepubs/9699959399/functions/index.html
 char* index(char const* str, int c)
@@ -240,6 +245,8 @@ char* strchrnul(char const* str, int c)
 }
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/memchr.html
+// For x86-64, optimized ASM implementations are found in ./arch/x86_64/string.S
+#if !ARCH(X86_64)
 void* memchr(void const* ptr, int c, size_t size)
 {
     char ch = c;
@@ -250,6 +257,7 @@ void* memchr(void const* ptr, int c, size_t size)
     }
     return nullptr;
 }
+#endif
 
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/strrchr.html
 char* strrchr(char const* str, int ch)
@@ -14,6 +14,7 @@ typedef void (*AtExitFunction)(void*);
 
 extern void __libc_init(void);
 extern void __malloc_init(void);
+extern void __malloc_flush_thread_cache(void);
 extern void __stdio_init(void);
 extern void __begin_atexit_locking(void);
 extern void _init(void);
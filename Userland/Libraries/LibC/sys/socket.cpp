@@ -99,6 +99,25 @@ ssize_t recvmsg(int sockfd, struct msghdr* msg, int flags)
     __RETURN_WITH_ERRNO(rc, rc, -1);
 }
 
+// https://man7.org/linux/man-pages/man2/sendmmsg.2.html
+int sendmmsg(int sockfd, struct mmsghdr* messages, unsigned int message_count, int flags)
+{
+    __pthread_maybe_cancel();
+
+    int rc = syscall(SC_sendmmsg, sockfd, messages, message_count, flags);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
+// https://man7.org/linux/man-pages/man2/recvmmsg.2.html
+int recvmmsg(int sockfd, struct mmsghdr* messages, unsigned int message_count, int flags, struct timespec* timeout)
+{
+    __pthread_maybe_cancel();
+
+    Syscall::SC_recvmmsg_params params { sockfd, messages, message_count, flags, timeout };
+    int rc = syscall(SC_recvmmsg, &params);
+    __RETURN_WITH_ERRNO(rc, rc, -1);
+}
+
 // https://pubs.opengroup.org/onlinepubs/9699919799/functions/recvfrom.html
 ssize_t recvfrom(int sockfd, void* buffer, size_t buffer_length, int flags, struct sockaddr* addr, socklen_t* addr_length)
 {
@@ -12,6 +12,8 @@
 
 __BEGIN_DECLS
 
+struct timespec;
+
 int socket(int domain, int type, int protocol);
 int bind(int sockfd, const struct sockaddr* addr, socklen_t);
 int listen(int sockfd, int backlog);
@@ -33,6 +35,10 @@ int socketpair(int domain, int type, int protocol, int sv[2]);
 int sendfd(int sockfd, int fd);
 int recvfd(int sockfd, int options);
 
+// These two are non-POSIX, but common:
+int sendmmsg(int sockfd, struct mmsghdr*, unsigned int vlen, int flags);
+int recvmmsg(int sockfd, struct mmsghdr*, unsigned int vlen, int flags, struct timespec* timeout);
+
 // These three are non-POSIX, but common:
 #define CMSG_ALIGN(x) (((x) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
 #define CMSG_SPACE(x) (CMSG_ALIGN(sizeof(struct cmsghdr)) + CMSG_ALIGN(x))
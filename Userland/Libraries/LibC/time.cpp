@@ -435,11 +435,13 @@ clock_t clock()
 static Kernel::TimePage* get_kernel_time_page()
 {
     static Kernel::TimePage* s_kernel_time_page;
+    static bool s_kernel_time_page_unavailable;
     // FIXME: Thread safety
-    if (!s_kernel_time_page) {
+    if (!s_kernel_time_page && !s_kernel_time_page_unavailable) {
         auto rc = syscall(SC_map_time_page);
+        // Note: Callers fall back to syscalls, so errno is left alone for them to succeed with.
         if ((int)rc < 0 && (int)rc > -EMAXERRNO) {
-            errno = -(int)rc;
+            s_kernel_time_page_unavailable = true;
             return nullptr;
         }
         s_kernel_time_page = (Kernel::TimePage*)rc;
@@ -447,8 +449,42 @@ static Kernel::TimePage* get_kernel_time_page()
     return s_kernel_time_page;
 }
 
+#if ARCH(X86_64)
+static bool read_precise_clock_from_time_page(Kernel::TimePage& kernel_time_page, clockid_t clock_id, struct timespec* ts)
+{
+    u32 update_iteration;
+    u64 tsc_reference;
+    u64 tsc_to_ns_multiplier;
+    u64 tsc;
+    timespec base;
+    do {
+        update_iteration = AK::atomic_load(&kernel_time_page.update1, AK::memory_order_acquire);
+        tsc_reference = kernel_time_page.tsc_reference;
+        tsc_to_ns_multiplier = kernel_time_page.tsc_to_ns_multiplier;
+        base = kernel_time_page.clocks[clock_id];
+        tsc = __builtin_ia32_rdtsc();
+    } while (update_iteration != AK::atomic_load(&kernel_time_page.update2, AK::memory_order_acquire));
+
+    if (tsc_to_ns_multiplier == 0)
+        return false;
+
+    // Note: The TSC of the processor we're on may be ever so slightly behind the one the kernel read.
+    u64 tsc_delta = tsc > tsc_reference ? tsc - tsc_reference : 0;
+    auto ns = static_cast<u64>((static_cast<unsigned __int128>(tsc_delta) * tsc_to_ns_multiplier) >> 32);
+    *ts = (Time::from_timespec(base) + Time::from_nanoseconds(static_cast<i64>(ns))).to_timespec();
+    return true;
+}
+#endif
+
 int clock_gettime(clockid_t clock_id, struct timespec* ts)
 {
+#if ARCH(X86_64)
+    if (Kernel::time_page_supports_precise(clock_id) && ts) {
+        if (auto* kernel_time_page = get_kernel_time_page(); kernel_time_page && read_precise_clock_from_time_page(*kernel_time_page, clock_id, ts))
+            return 0;
+    }
+#endif
+
     if (Kernel::time_page_supports(clock_id)) {
         if (!ts) {
             errno = EFAULT;
@@ -29,6 +29,8 @@ public:
     // TODO: In the future we can pass the range that was edited and only re-parse what we have to.
     virtual void on_edit([[maybe_unused]] DeprecatedString const& file) {};
     virtual void file_opened([[maybe_unused]] DeprecatedString const& file) {};
+    // Called once the project root is known, see FileDB::project_root().
+    virtual void project_opened() {};
 
     virtual Optional<ProjectLocation> find_declaration_of(DeprecatedString const&, GUI::TextPosition const&) { return {}; }
 
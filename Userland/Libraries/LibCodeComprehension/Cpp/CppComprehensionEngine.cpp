@@ -7,15 +7,20 @@
 #include "CppComprehensionEngine.h"
 #include <AK/Assertions.h>
 #include <AK/HashTable.h>
+#include <AK/LexicalPath.h>
 #include <AK/OwnPtr.h>
 #include <AK/ScopeGuard.h>
 #include <LibCore/DirIterator.h>
+#include <LibCore/Directory.h>
 #include <LibCore/File.h>
+#include <LibCore/Stream.h>
 #include <LibCpp/AST.h>
 #include <LibCpp/Lexer.h>
 #include <LibCpp/Parser.h>
 #include <LibCpp/Preprocessor.h>
 #include <LibRegex/Regex.h>
+#include <LibThreading/BackgroundAction.h>
+#include <LibThreading/TreeWalker.h>
 #include <Userland/DevTools/HackStudio/LanguageServers/ConnectionFromClient.h>
 
 namespace CodeComprehension::Cpp {
@@ -336,12 +341,12 @@ CppComprehensionEngine::Symbol CppComprehensionEngine::Symbol::create(StringView
     return { { name, scope }, move(declaration), is_local == IsLocal::Yes };
 }
 
-Vector<CppComprehensionEngine::Symbol> CppComprehensionEngine::get_child_symbols(ASTNode const& node) const
+Vector<CppComprehensionEngine::Symbol> CppComprehensionEngine::get_child_symbols(ASTNode const& node)
 {
     return get_child_symbols(node, {}, Symbol::IsLocal::No);
 }
 
-Vector<CppComprehensionEngine::Symbol> CppComprehensionEngine::get_child_symbols(ASTNode const& node, Vector<StringView> const& scope, Symbol::IsLocal is_local) const
+Vector<CppComprehensionEngine::Symbol> CppComprehensionEngine::get_child_symbols(ASTNode const& node, Vector<StringView> const& scope, Symbol::IsLocal is_local)
 {
     Vector<Symbol> symbols;
 
@@ -401,6 +406,131 @@ void CppComprehensionEngine::file_opened([[maybe_unused]] DeprecatedString const
     get_or_create_document_data(file);
 }
 
+DeprecatedString CppComprehensionEngine::symbol_index_path() const
+{
+    return LexicalPath::absolute_path(filedb().project_root(), ".hackstudio/symbols.json"sv);
+}
+
+void CppComprehensionEngine::project_opened()
+{
+    // Whatever was indexed last time is reported right away, and then brought up to date in the background.
+    m_symbol_index = SymbolIndex::load(symbol_index_path());
+    HashMap<DeprecatedString, i64> known_modification_times;
+    for (auto const& it : m_symbol_index.entries()) {
+        // Note: The paths are copied, as DeprecatedStrings can't be shared with the indexing threads.
+        known_modification_times.set(DeprecatedString(it.key.view()), it.value.modification_time);
+        auto declarations = it.value.declarations;
+        set_declarations_of_document(it.key, move(declarations));
+    }
+
+    (void)Threading::BackgroundAction<ErrorOr<Vector<IndexedFile>>>::construct(
+        [project_root = DeprecatedString(filedb().project_root().view()), known_modification_times = move(known_modification_times)](auto&) {
+            return index_project(project_root, known_modification_times);
+        },
+        [this](ErrorOr<Vector<IndexedFile>> result) -> ErrorOr<void> {
+            return did_index_project(TRY(move(result)));
+        });
+}
+
+ErrorOr<Vector<CppComprehensionEngine::IndexedFile>> CppComprehensionEngine::index_project(DeprecatedString const& project_root, HashMap<DeprecatedString, i64> const& known_modification_times)
+{
+    Threading::TreeWalker<Vector<IndexedFile>> walker;
+    walker.should_enter_directory = [](auto const& entry) {
+        // Note: Hidden directories (like .git and .hackstudio) are never part of the project's sources.
+        return entry.depth == 0 || !entry.name.starts_with('.');
+    };
+    walker.on_file = [&](auto const& entry) -> ErrorOr<Vector<IndexedFile>> {
+        Vector<IndexedFile> files;
+        if (entry.type != DT_REG || !(entry.name.ends_with(".cpp"sv) || entry.name.ends_with(".h"sv)))
+            return files;
+
+        i64 modification_time = TRY(entry.stat()).st_mtime;
+        auto known_modification_time = known_modification_times.get(entry.path);
+        if (known_modification_time.has_value() && known_modification_time.value() == modification_time) {
+            files.append({ entry.path, modification_time, {} });
+            return files;
+        }
+
+        // Note: Files that can't be read are left out, which drops them from the index until they can be.
+        auto declarations = index_file(entry.path);
+        if (declarations.has_value())
+            files.append({ entry.path, modification_time, declarations.release_value() });
+        return files;
+    };
+    walker.on_leave_directory = [](auto const&, Vector<Vector<IndexedFile>>& results) -> ErrorOr<Vector<IndexedFile>> {
+        Vector<IndexedFile> files;
+        for (auto& result : results)
+            files.extend(move(result));
+        return files;
+    };
+    return walker.walk(project_root);
+}
+
+Optional<Vector<CodeComprehension::Declaration>> CppComprehensionEngine::index_file(DeprecatedString const& path)
+{
+    auto file_or_error = Core::Stream::File::open(path, Core::Stream::OpenMode::Read);
+    if (file_or_error.is_error()) {
+        dbgln("Couldn't index {}: {}", path, file_or_error.error());
+        return {};
+    }
+    auto text_or_error = file_or_error.value()->read_until_eof();
+    if (text_or_error.is_error()) {
+        dbgln("Couldn't index {}: {}", path, text_or_error.error());
+        return {};
+    }
+
+    // Note: Included headers are not followed, as they are indexed by themselves. This keeps every file from being
+    //       parsed more than once, and doesn't need anything that isn't safe to use from more than one thread.
+    Preprocessor preprocessor(path, StringView { text_or_error.value() });
+    preprocessor.set_ignore_unsupported_keywords(true);
+    preprocessor.set_ignore_invalid_statements(true);
+    preprocessor.set_keep_include_statements(true);
+    Parser parser(preprocessor.process_and_lex(), path);
+    auto root = parser.parse();
+
+    HashMap<SymbolName, Symbol> symbols;
+    for (auto& symbol : get_child_symbols(*root))
+        symbols.set(symbol.name, move(symbol));
+    return declarations_of(path, symbols, preprocessor.definitions());
+}
+
+ErrorOr<void> CppComprehensionEngine::did_index_project(Vector<IndexedFile> files)
+{
+    bool index_has_changed = false;
+    HashTable<DeprecatedString> indexed_paths;
+    for (auto& file : files) {
+        indexed_paths.set(file.path);
+        if (!file.declarations.has_value())
+            continue;
+
+        // Note: Documents that were parsed in the meantime have already reported their own (and more recent) declarations.
+        if (!m_documents.contains(file.path)) {
+            auto declarations = file.declarations.value();
+            set_declarations_of_document(file.path, move(declarations));
+        }
+        m_symbol_index.set(file.path, { file.modification_time, file.declarations.release_value() });
+        index_has_changed = true;
+    }
+
+    Vector<DeprecatedString> removed_paths;
+    for (auto const& it : m_symbol_index.entries()) {
+        if (!indexed_paths.contains(it.key))
+            removed_paths.append(it.key);
+    }
+    for (auto const& path : removed_paths) {
+        m_symbol_index.remove(path);
+        if (!m_documents.contains(path))
+            set_declarations_of_document(path, {});
+        index_has_changed = true;
+    }
+
+    if (!index_has_changed)
+        return {};
+    auto path = symbol_index_path();
+    TRY(Core::Directory::create(LexicalPath::dirname(path), Core::Directory::CreateDirectories::Yes));
+    return m_symbol_index.save(path);
+}
+
 Optional<CodeComprehension::ProjectLocation> CppComprehensionEngine::find_declaration_of(DeprecatedString const& filename, const GUI::TextPosition& identifier_position)
 {
     auto const* document_ptr = get_or_create_document_data(filename);
@@ -413,7 +543,34 @@ Optional<CodeComprehension::ProjectLocation> CppComprehensionEngine::find_declar
         return CodeComprehension::ProjectLocation { decl->filename(), decl->start().line, decl->start().column };
     }
 
-    return find_preprocessor_definition(document, identifier_position);
+    if (auto location = find_preprocessor_definition(document, identifier_position); location.has_value())
+        return location;
+
+    return find_declaration_in_project(document, identifier_position);
+}
+
+Optional<CodeComprehension::ProjectLocation> CppComprehensionEngine::find_declaration_in_project(DocumentData const& document, const GUI::TextPosition& identifier_position) const
+{
+    // The declaration may be in a file that this document doesn't (visibly) include, but which is in the symbol index.
+    auto token = document.parser().token_at(Cpp::Position { identifier_position.line(), identifier_position.column() });
+    if (!token.has_value() || token->type() != Token::Type::Identifier)
+        return {};
+
+    auto name = token->text();
+    Optional<CodeComprehension::ProjectLocation> variable_location;
+    for (auto const& it : all_declarations()) {
+        for (auto const& declaration : it.value) {
+            if (declaration.name != name)
+                continue;
+            // Note: Variables and members are too likely to share their names with unrelated ones, so anything else
+            //       that goes by the same name is preferred.
+            if (declaration.type != CodeComprehension::DeclarationType::Variable && declaration.type != CodeComprehension::DeclarationType::Member)
+                return declaration.position;
+            if (!variable_location.has_value())
+                variable_location = declaration.position;
+        }
+    }
+    return variable_location;
 }
 
 RefPtr<Cpp::Declaration> CppComprehensionEngine::find_declaration_of(DocumentData const& document, const GUI::TextPosition& identifier_position)
@@ -578,16 +735,21 @@ void CppComprehensionEngine::update_declared_symbols(DocumentData& document)
         document.m_symbols.set(symbol.name, move(symbol));
     }
 
+    set_declarations_of_document(document.filename(), declarations_of(document.filename(), document.m_symbols, document.preprocessor().definitions()));
+}
+
+Vector<CodeComprehension::Declaration> CppComprehensionEngine::declarations_of(DeprecatedString const& filename, HashMap<SymbolName, Symbol> const& symbols, Preprocessor::Definitions const& definitions)
+{
     Vector<CodeComprehension::Declaration> declarations;
-    for (auto& symbol_entry : document.m_symbols) {
+    for (auto& symbol_entry : symbols) {
         auto& symbol = symbol_entry.value;
-        declarations.append({ symbol.name.name, { document.filename(), symbol.declaration->start().line, symbol.declaration->start().column }, type_of_declaration(symbol.declaration), symbol.name.scope_as_string() });
+        declarations.append({ symbol.name.name, { filename, symbol.declaration->start().line, symbol.declaration->start().column }, type_of_declaration(symbol.declaration), symbol.name.scope_as_string() });
     }
 
-    for (auto& definition : document.preprocessor().definitions()) {
-        declarations.append({ definition.key, { document.filename(), definition.value.line, definition.value.column }, CodeComprehension::DeclarationType::PreprocessorDefinition, {} });
+    for (auto& definition : definitions) {
+        declarations.append({ definition.key, { filename, definition.value.line, definition.value.column }, CodeComprehension::DeclarationType::PreprocessorDefinition, {} });
     }
-    set_declarations_of_document(document.filename(), move(declarations));
+    return declarations;
 }
 
 void CppComprehensionEngine::update_todo_entries(DocumentData& document)
@@ -622,12 +784,12 @@ OwnPtr<CppComprehensionEngine::DocumentData> CppComprehensionEngine::create_docu
     document_data->preprocessor().set_ignore_invalid_statements(true);
     document_data->preprocessor().set_keep_include_statements(true);
 
-    document_data->preprocessor().definitions_in_header_callback = [this](StringView include_path) -> Preprocessor::Definitions {
+    document_data->preprocessor().definitions_in_header_callback = [this](StringView include_path) -> Preprocessor::Definitions const* {
         auto included_document = get_or_create_document_data(document_path_from_include_path(include_path));
         if (!included_document)
-            return {};
+            return nullptr;
 
-        return included_document->preprocessor().definitions();
+        return &included_document->preprocessor().definitions();
     };
 
     auto tokens = document_data->preprocessor().process_and_lex();
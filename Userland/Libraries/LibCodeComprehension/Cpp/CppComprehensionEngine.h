@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "SymbolIndex.h"
 #include <AK/DeprecatedString.h>
 #include <AK/Function.h>
 #include <AK/Vector.h>
@@ -28,6 +29,7 @@ public:
     virtual Vector<CodeComprehension::AutocompleteResultEntry> get_suggestions(DeprecatedString const& file, GUI::TextPosition const& autocomplete_position) override;
     virtual void on_edit(DeprecatedString const& file) override;
     virtual void file_opened([[maybe_unused]] DeprecatedString const& file) override;
+    virtual void project_opened() override;
     virtual Optional<CodeComprehension::ProjectLocation> find_declaration_of(DeprecatedString const& filename, GUI::TextPosition const& identifier_position) override;
     virtual Optional<FunctionParamsHint> get_function_params_hint(DeprecatedString const&, GUI::TextPosition const&) override;
     virtual Vector<CodeComprehension::TokenInfo> get_tokens_info(DeprecatedString const& filename) override;
@@ -111,8 +113,8 @@ private:
     };
 
     Vector<Symbol> properties_of_type(DocumentData const& document, DeprecatedString const& type) const;
-    Vector<Symbol> get_child_symbols(ASTNode const&) const;
-    Vector<Symbol> get_child_symbols(ASTNode const&, Vector<StringView> const& scope, Symbol::IsLocal) const;
+    static Vector<Symbol> get_child_symbols(ASTNode const&);
+    static Vector<Symbol> get_child_symbols(ASTNode const&, Vector<StringView> const& scope, Symbol::IsLocal);
 
     DocumentData const* get_document_data(DeprecatedString const& file) const;
     DocumentData const* get_or_create_document_data(DeprecatedString const& file);
@@ -122,11 +124,24 @@ private:
     DeprecatedString document_path_from_include_path(StringView include_path) const;
     void update_declared_symbols(DocumentData&);
     void update_todo_entries(DocumentData&);
-    CodeComprehension::DeclarationType type_of_declaration(Cpp::Declaration const&);
+    static Vector<CodeComprehension::Declaration> declarations_of(DeprecatedString const& filename, HashMap<SymbolName, Symbol> const&, Preprocessor::Definitions const&);
+    static CodeComprehension::DeclarationType type_of_declaration(Cpp::Declaration const&);
     Vector<StringView> scope_of_node(ASTNode const&) const;
     Vector<StringView> scope_of_reference_to_symbol(ASTNode const&) const;
 
     Optional<CodeComprehension::ProjectLocation> find_preprocessor_definition(DocumentData const&, const GUI::TextPosition&);
+    Optional<CodeComprehension::ProjectLocation> find_declaration_in_project(DocumentData const&, const GUI::TextPosition&) const;
+
+    struct IndexedFile {
+        DeprecatedString path;
+        i64 modification_time { 0 };
+        // Empty if the file didn't change since it was last indexed.
+        Optional<Vector<CodeComprehension::Declaration>> declarations;
+    };
+    DeprecatedString symbol_index_path() const;
+    static ErrorOr<Vector<IndexedFile>> index_project(DeprecatedString const& project_root, HashMap<DeprecatedString, i64> const& known_modification_times);
+    static Optional<Vector<CodeComprehension::Declaration>> index_file(DeprecatedString const& path);
+    ErrorOr<void> did_index_project(Vector<IndexedFile>);
     Optional<Cpp::Preprocessor::Substitution> find_preprocessor_substitution(DocumentData const&, Cpp::Position const&);
 
     OwnPtr<DocumentData> create_document_data(DeprecatedString text, DeprecatedString const& filename);
@@ -151,6 +166,8 @@ private:
     // A document is added to this set when we start processing it (e.g because it was #included) and removed when we're done.
     // We use this to prevent circular #includes from looping indefinitely.
     HashTable<DeprecatedString> m_unfinished_documents;
+
+    SymbolIndex m_symbol_index;
 };
 
 template<typename Func>
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "SymbolIndex.h"
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/JsonValue.h>
+#include <LibCore/Stream.h>
+#include <LibCore/System.h>
+
+namespace CodeComprehension::Cpp {
+
+// Bump this whenever the format (or what the declarations of a file are) changes, which throws away older indexes.
+static constexpr u32 symbol_index_version = 1;
+
+static Optional<CodeComprehension::Declaration> declaration_from_json(DeprecatedString const& file, JsonValue const& value)
+{
+    // Every declaration is stored as [name, line, column, type, scope].
+    if (!value.is_array() || value.as_array().size() != 5)
+        return {};
+    auto const& fields = value.as_array();
+    if (!fields[0].is_string() || !fields[1].is_number() || !fields[2].is_number() || !fields[3].is_number() || !fields[4].is_string())
+        return {};
+    auto type = fields[3].to_u32();
+    if (type > to_underlying(CodeComprehension::DeclarationType::Member))
+        return {};
+    return CodeComprehension::Declaration {
+        fields[0].as_string(),
+        { file, fields[1].to_u32(), fields[2].to_u32() },
+        static_cast<CodeComprehension::DeclarationType>(type),
+        fields[4].as_string(),
+    };
+}
+
+static ErrorOr<SymbolIndex::Entry> entry_from_json(DeprecatedString const& file, JsonValue const& value)
+{
+    if (!value.is_object())
+        return Error::from_string_literal("Malformed symbol index entry");
+    auto const& object = value.as_object();
+    auto modification_time = object.get_i64("modification_time"sv);
+    auto declarations = object.get_array("declarations"sv);
+    if (!modification_time.has_value() || !declarations.has_value())
+        return Error::from_string_literal("Malformed symbol index entry");
+
+    SymbolIndex::Entry entry { modification_time.value(), {} };
+    TRY(entry.declarations.try_ensure_capacity(declarations->size()));
+    for (auto const& declaration_value : declarations->values()) {
+        auto declaration = declaration_from_json(file, declaration_value);
+        if (!declaration.has_value())
+            return Error::from_string_literal("Malformed declaration in symbol index");
+        entry.declarations.unchecked_append(declaration.release_value());
+    }
+    return entry;
+}
+
+static ErrorOr<SymbolIndex> try_load(StringView path)
+{
+    auto file = TRY(Core::Stream::File::open(path, Core::Stream::OpenMode::Read));
+    auto contents = TRY(file->read_until_eof());
+    auto json = TRY(JsonValue::from_string(contents));
+    if (!json.is_object())
+        return Error::from_string_literal("Malformed symbol index");
+    auto const& object = json.as_object();
+    if (object.get_u32("version"sv) != symbol_index_version)
+        return Error::from_string_literal("Symbol index has the wrong version");
+    auto files = object.get_object("files"sv);
+    if (!files.has_value())
+        return Error::from_string_literal("Malformed symbol index");
+
+    SymbolIndex index;
+    TRY(files->try_for_each_member([&](DeprecatedString const& file, JsonValue const& value) -> ErrorOr<void> {
+        index.set(file, TRY(entry_from_json(file, value)));
+        return {};
+    }));
+    return index;
+}
+
+SymbolIndex SymbolIndex::load(StringView path)
+{
+    auto index_or_error = try_load(path);
+    if (index_or_error.is_error()) {
+        dbgln("Couldn't load the symbol index at {}: {}", path, index_or_error.error());
+        return {};
+    }
+    return index_or_error.release_value();
+}
+
+ErrorOr<void> SymbolIndex::save(StringView path) const
+{
+    JsonObject files;
+    for (auto const& it : m_entries) {
+        JsonArray declarations;
+        for (auto const& declaration : it.value.declarations) {
+            JsonArray fields;
+            fields.append(declaration.name);
+            fields.append(declaration.position.line);
+            fields.append(declaration.position.column);
+            fields.append(to_underlying(declaration.type));
+            fields.append(declaration.scope);
+            declarations.append(move(fields));
+        }
+        JsonObject entry;
+        entry.set("modification_time", it.value.modification_time);
+        entry.set("declarations", move(declarations));
+        files.set(it.key, move(entry));
+    }
+
+    JsonObject index;
+    index.set("version", symbol_index_version);
+    index.set("files", move(files));
+
+    // Note: The index is written next to where it's going to end up and then moved into place, so that a reader never
+    //       sees half of it.
+    auto temporary_path = DeprecatedString::formatted("{}.tmp", path);
+    {
+        auto file = TRY(Core::Stream::File::open(temporary_path, Core::Stream::OpenMode::Write | Core::Stream::OpenMode::Truncate));
+        TRY(file->write_entire_buffer(index.to_deprecated_string().bytes()));
+    }
+    TRY(Core::System::rename(temporary_path, path));
+    return {};
+}
+
+SymbolIndex::Entry const* SymbolIndex::get(DeprecatedString const& file) const
+{
+    auto it = m_entries.find(file);
+    if (it == m_entries.end())
+        return nullptr;
+    return &it->value;
+}
+
+}
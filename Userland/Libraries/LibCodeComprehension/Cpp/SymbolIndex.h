@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/DeprecatedString.h>
+#include <AK/HashMap.h>
+#include <AK/Vector.h>
+#include <LibCodeComprehension/Types.h>
+
+namespace CodeComprehension::Cpp {
+
+// The declarations of every file in a project, along with the modification times of the files they came from.
+// It's kept on disk between sessions, so that only the files that changed since have to be parsed again.
+class SymbolIndex {
+public:
+    struct Entry {
+        i64 modification_time { 0 };
+        Vector<CodeComprehension::Declaration> declarations;
+    };
+
+    // Note: A missing or malformed index is simply empty, as everything in it can be found again.
+    static SymbolIndex load(StringView path);
+    ErrorOr<void> save(StringView path) const;
+
+    Entry const* get(DeprecatedString const& file) const;
+    void set(DeprecatedString const& file, Entry entry) { m_entries.set(file, move(entry)); }
+    void remove(DeprecatedString const& file) { m_entries.remove(file); }
+
+    HashMap<DeprecatedString, Entry> const& entries() const { return m_entries; }
+
+private:
+    HashMap<DeprecatedString, Entry> m_entries;
+};
+
+}
@@ -5,29 +5,74 @@
  */
 
 #include <AK/BinarySearch.h>
+#include <AK/IntegralMath.h>
+#include <AK/MemoryStream.h>
 #include <AK/QuickSort.h>
 #include <LibCompress/Brotli.h>
+#include <LibCompress/Huffman.h>
 #include <LibCompress/BrotliDictionary.h>
 
 namespace Compress {
 
+// RFC 7932 section 5: Each insert-and-copy length symbol picks one of these cells, which determine the ranges of the
+// insert and copy length codes, and whether the distance of the previous command is reused.
+static constexpr size_t insert_length_code_base[11] { 0, 0, 0, 0, 8, 8, 0, 16, 8, 16, 16 };
+static constexpr size_t copy_length_code_base[11] { 0, 8, 0, 8, 0, 8, 16, 0, 16, 8, 16 };
+static constexpr bool implicit_zero_distance[11] { true, true, false, false, false, false, false, false, false, false, false };
+
+static constexpr size_t insert_length_base[24] { 0, 1, 2, 3, 4, 5, 6, 8, 10, 14, 18, 26, 34, 50, 66, 98, 130, 194, 322, 578, 1090, 2114, 6210, 22594 };
+static constexpr size_t insert_length_extra[24] { 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 7, 8, 9, 10, 12, 14, 24 };
+static constexpr size_t copy_length_base[24] { 2, 3, 4, 5, 6, 7, 8, 9, 10, 12, 14, 18, 22, 30, 38, 54, 70, 102, 134, 198, 326, 582, 1094, 2118 };
+static constexpr size_t copy_length_extra[24] { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 7, 8, 9, 10, 24 };
+
 ErrorOr<size_t> BrotliDecompressionStream::CanonicalCode::read_symbol(LittleEndianInputBitStream& input_stream)
 {
+    // A code with a single symbol takes up no bits at all.
+    if (m_symbol_codes.size() == 1 && m_symbol_codes[0] == 1)
+        return m_symbol_values[0];
+
+    // Note: Peeking past the end of the stream yields zeroes, running out of input is only an error if the code that
+    //       was found actually extends past it.
+    auto bits = TRY(input_stream.peek_bits<u16>(max_code_length));
+
+    auto const& entry = m_prefix_table[bits & ((1 << prefix_table_bits) - 1)];
+    if (entry.code_length != 0) {
+        TRY(input_stream.discard_previously_peeked_bits(entry.code_length));
+        return entry.symbol_value;
+    }
+
     size_t code_bits = 1;
+    for (size_t code_length = 1; code_length <= max_code_length; ++code_length) {
+        code_bits = (code_bits << 1) | ((bits >> (code_length - 1)) & 1);
 
-    while (code_bits < (1 << 16)) {
-        // FIXME: This is very inefficient and could greatly be improved by implementing this
-        //        algorithm: https://www.hanshq.net/zip.html#huffdec
         size_t index;
-        if (binary_search(m_symbol_codes.span(), code_bits, &index))
+        if (binary_search(m_symbol_codes.span(), code_bits, &index)) {
+            TRY(input_stream.discard_previously_peeked_bits(code_length));
             return m_symbol_values[index];
-
-        code_bits = (code_bits << 1) | TRY(input_stream.read_bit());
+        }
     }
 
     return Error::from_string_literal("no matching code found");
 }
 
+void BrotliDecompressionStream::CanonicalCode::build_prefix_table()
+{
+    m_prefix_table.fill({});
+    for (size_t i = 0; i < m_symbol_codes.size(); ++i) {
+        // The codes are stored with a marker bit in front of them, and their first bit is the first one in the stream.
+        size_t code_length = AK::log2(m_symbol_codes[i]);
+        if (code_length == 0 || code_length > prefix_table_bits)
+            continue;
+
+        size_t reversed_code = 0;
+        for (size_t bit = 0; bit < code_length; ++bit)
+            reversed_code |= ((m_symbol_codes[i] >> bit) & 1) << (code_length - 1 - bit);
+
+        for (size_t index = reversed_code; index < m_prefix_table.size(); index += 1 << code_length)
+            m_prefix_table[index] = { static_cast<u16>(m_symbol_values[i]), static_cast<u16>(code_length) };
+    }
+}
+
 BrotliDecompressionStream::BrotliDecompressionStream(Stream& stream)
     : m_input_stream(MaybeOwned(stream))
 {
@@ -181,6 +226,7 @@ ErrorOr<void> BrotliDecompressionStream::read_prefix_code(CanonicalCode& code, s
         TRY(read_complex_prefix_code(code, alphabet_size, hskip));
     }
 
+    code.build_prefix_table();
     return {};
 }
 
@@ -290,6 +336,8 @@ ErrorOr<void> BrotliDecompressionStream::read_complex_prefix_code(CanonicalCode&
         }
     }
 
+    temp_code.build_prefix_table();
+
     // Read the actual prefix code_value
     sum = 0;
     size_t i = 0;
@@ -759,10 +807,6 @@ ErrorOr<Bytes> BrotliDecompressionStream::read(Bytes output_buffer)
 
             size_t insert_and_copy_symbol = TRY(m_insert_and_copy_codes[m_insert_and_copy_block.type].read_symbol(m_input_stream));
 
-            size_t const insert_length_code_base[11] { 0, 0, 0, 0, 8, 8, 0, 16, 8, 16, 16 };
-            size_t const copy_length_code_base[11] { 0, 8, 0, 8, 0, 8, 16, 0, 16, 8, 16 };
-            bool const implicit_zero_distance[11] { true, true, false, false, false, false, false, false, false, false, false };
-
             size_t insert_and_copy_index = insert_and_copy_symbol >> 6;
             size_t insert_length_code_offset = (insert_and_copy_symbol >> 3) & 0b111;
             size_t copy_length_code_offset = insert_and_copy_symbol & 0b111;
@@ -772,11 +816,6 @@ ErrorOr<Bytes> BrotliDecompressionStream::read(Bytes output_buffer)
 
             m_implicit_zero_distance = implicit_zero_distance[insert_and_copy_index];
 
-            size_t const insert_length_base[24] { 0, 1, 2, 3, 4, 5, 6, 8, 10, 14, 18, 26, 34, 50, 66, 98, 130, 194, 322, 578, 1090, 2114, 6210, 22594 };
-            size_t const insert_length_extra[24] { 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 7, 8, 9, 10, 12, 14, 24 };
-            size_t const copy_length_base[24] { 2, 3, 4, 5, 6, 7, 8, 9, 10, 12, 14, 18, 22, 30, 38, 54, 70, 102, 134, 198, 326, 582, 1094, 2118 };
-            size_t const copy_length_extra[24] { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 7, 8, 9, 10, 24 };
-
             m_insert_length = insert_length_base[insert_length_code] + TRY(m_input_stream.read_bits(insert_length_extra[insert_length_code]));
             m_copy_length = copy_length_base[copy_length_code] + TRY(m_input_stream.read_bits(copy_length_extra[copy_length_code]));
 
@@ -949,4 +988,435 @@ bool BrotliDecompressionStream::is_eof() const
     return m_read_final_block && m_current_state == State::Idle;
 }
 
+ErrorOr<NonnullOwnPtr<BrotliCompressionStream>> BrotliCompressionStream::construct(MaybeOwned<Stream> stream)
+{
+    auto output_stream = TRY(LittleEndianOutputBitStream::construct(move(stream)));
+    auto window = TRY(ByteBuffer::create_uninitialized(2 * block_size));
+    auto compressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) BrotliCompressionStream(move(output_stream), move(window))));
+
+    // RFC 7932 section 9.1: WBITS, for window sizes from 2^18 up, is a 1 followed by WBITS - 17 in three bits.
+    static_assert(window_bits >= 18 && window_bits <= 24);
+    TRY(compressor->m_output_stream->write_bits(1u, 1));
+    TRY(compressor->m_output_stream->write_bits(window_bits - 17, 3));
+
+    return compressor;
+}
+
+BrotliCompressionStream::BrotliCompressionStream(NonnullOwnPtr<LittleEndianOutputBitStream> output_stream, ByteBuffer window)
+    : m_output_stream(move(output_stream))
+    , m_window(move(window))
+    , m_match_finder(32)
+{
+}
+
+BrotliCompressionStream::~BrotliCompressionStream()
+{
+    VERIFY(m_finished);
+}
+
+ErrorOr<Bytes> BrotliCompressionStream::read(Bytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+ErrorOr<size_t> BrotliCompressionStream::write(ReadonlyBytes bytes)
+{
+    VERIFY(!m_finished);
+
+    size_t total_written = 0;
+    while (total_written < bytes.size()) {
+        auto written = bytes.slice(total_written).copy_trimmed_to(m_window.bytes().slice(m_dictionary_size + m_block_size, block_size - m_block_size));
+        m_block_size += written;
+        total_written += written;
+
+        // Meta-blocks are never marked as the last one, the stream ends with an empty meta-block instead.
+        if (m_block_size == block_size)
+            TRY(flush_meta_block());
+    }
+    return total_written;
+}
+
+ErrorOr<void> BrotliCompressionStream::final_flush()
+{
+    VERIFY(!m_finished);
+    m_finished = true;
+
+    TRY(flush_meta_block());
+
+    // ISLAST and ISLASTEMPTY
+    TRY(m_output_stream->write_bits(1u, 1));
+    TRY(m_output_stream->write_bits(1u, 1));
+    TRY(m_output_stream->align_to_byte_boundary());
+    return {};
+}
+
+ErrorOr<ByteBuffer> BrotliCompressionStream::compress_all(ReadonlyBytes bytes)
+{
+    auto output_stream = TRY(try_make<AllocatingMemoryStream>());
+    auto brotli_stream = TRY(BrotliCompressionStream::construct(MaybeOwned<Stream>(*output_stream)));
+
+    TRY(brotli_stream->write_entire_buffer(bytes));
+    TRY(brotli_stream->final_flush());
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(output_stream->used_buffer_size()));
+    TRY(output_stream->read_entire_buffer(buffer));
+
+    return buffer;
+}
+
+static ErrorOr<void> write_meta_block_header(LittleEndianOutputBitStream& stream, size_t length, bool is_uncompressed)
+{
+    // ISLAST
+    TRY(stream.write_bits(0u, 1));
+
+    // MNIBBLES and MLEN - 1, where only the smallest number of nibbles is allowed.
+    size_t nibbles = length - 1 < (1 << 16) ? 4 : length - 1 < (1 << 20) ? 5 : 6;
+    TRY(stream.write_bits(nibbles - 4, 2));
+    TRY(stream.write_bits(length - 1, 4 * nibbles));
+
+    // ISUNCOMPRESSED
+    TRY(stream.write_bits(is_uncompressed ? 1u : 0u, 1));
+    return {};
+}
+
+ErrorOr<void> BrotliCompressionStream::write_uncompressed_meta_block()
+{
+    auto block = m_window.bytes().slice(m_dictionary_size, m_block_size);
+    TRY(write_meta_block_header(*m_output_stream, block.size(), true));
+    TRY(m_output_stream->align_to_byte_boundary());
+    TRY(m_output_stream->write_entire_buffer(block));
+    return {};
+}
+
+ErrorOr<void> BrotliCompressionStream::flush_meta_block()
+{
+    if (m_block_size == 0)
+        return {};
+
+    // The compressed meta-block is put together on the side, as an uncompressed one is written instead if it turns out
+    // to be larger. That one doesn't use any distances, so their state is restored to what the decoder will have.
+    AllocatingMemoryStream compressed_stream;
+    auto compressed_bit_stream = TRY(LittleEndianOutputBitStream::construct(MaybeOwned<Stream>(compressed_stream)));
+    size_t previous_distances[4];
+    memcpy(previous_distances, m_distances, sizeof(m_distances));
+    TRY(write_compressed_meta_block(*compressed_bit_stream));
+
+    size_t trailing_bit_count = compressed_bit_stream->bit_offset();
+    TRY(compressed_bit_stream->align_to_byte_boundary());
+    auto compressed_data = TRY(ByteBuffer::create_uninitialized(compressed_stream.used_buffer_size()));
+    TRY(compressed_stream.read_entire_buffer(compressed_data));
+
+    size_t compressed_bit_count = compressed_data.size() * 8 - (trailing_bit_count == 0 ? 0 : 8 - trailing_bit_count);
+    if (compressed_bit_count >= m_block_size * 8) {
+        memcpy(m_distances, previous_distances, sizeof(m_distances));
+        TRY(write_uncompressed_meta_block());
+    } else {
+        // Note: The meta-block doesn't have to start at a byte boundary, so its bits are shifted into place.
+        auto full_bytes = compressed_data.bytes().trim(compressed_bit_count / 8);
+        size_t offset = 0;
+        for (; offset + sizeof(u32) <= full_bytes.size(); offset += sizeof(u32)) {
+            u32 value = full_bytes[offset] | (full_bytes[offset + 1] << 8) | (full_bytes[offset + 2] << 16) | (static_cast<u32>(full_bytes[offset + 3]) << 24);
+            TRY(m_output_stream->write_bits(value, 32));
+        }
+        for (; offset < full_bytes.size(); ++offset)
+            TRY(m_output_stream->write_bits(full_bytes[offset], 8));
+        if (trailing_bit_count != 0)
+            TRY(m_output_stream->write_bits(compressed_data.bytes().last(), trailing_bit_count));
+    }
+
+    // Later matches may refer back into this block.
+    memmove(m_window.data(), m_window.data() + m_dictionary_size, m_block_size);
+    m_dictionary_size = m_block_size;
+    m_block_size = 0;
+    return {};
+}
+
+// Assigns canonical codes to the given lengths, with their bits reversed so that they can be written as they are.
+template<size_t Size>
+static void generate_reversed_codes(Array<u8, Size> const& lengths, Array<u16, Size>& codes)
+{
+    Array<u16, 16> length_counts {};
+    for (auto length : lengths) {
+        if (length != 0)
+            ++length_counts[length];
+    }
+
+    Array<u16, 16> next_codes {};
+    u16 code = 0;
+    for (size_t bits = 1; bits < 16; ++bits) {
+        code = (code + length_counts[bits - 1]) << 1;
+        next_codes[bits] = code;
+    }
+
+    for (size_t symbol = 0; symbol < Size; ++symbol) {
+        auto length = lengths[symbol];
+        if (length == 0)
+            continue;
+        auto canonical_code = next_codes[length]++;
+        u16 reversed_code = 0;
+        for (size_t bit = 0; bit < length; ++bit)
+            reversed_code |= ((canonical_code >> bit) & 1) << (length - 1 - bit);
+        codes[symbol] = reversed_code;
+    }
+}
+
+static ErrorOr<void> write_code_length_code_length(LittleEndianOutputBitStream& stream, u8 length)
+{
+    // The counterpart to read_complex_prefix_code_length().
+    static constexpr struct {
+        u8 bits;
+        u8 bit_count;
+    } codes[6] { { 0, 2 }, { 7, 4 }, { 3, 3 }, { 2, 2 }, { 1, 2 }, { 15, 4 } };
+    return stream.write_bits(codes[length].bits, codes[length].bit_count);
+}
+
+// Writes a prefix code for the given symbol counts (RFC 7932 section 3.4 and 3.5), and fills in the code lengths and
+// the codes that the symbols have to be written with.
+template<size_t Size>
+static ErrorOr<void> write_prefix_code(LittleEndianOutputBitStream& stream, Array<u32, Size> const& counts, Array<u8, Size>& lengths, Array<u16, Size>& codes)
+{
+    static constexpr size_t max_code_length = 15;
+
+    lengths.fill(0);
+    codes.fill(0);
+
+    size_t used_symbol_count = 0;
+    size_t last_used_symbol = 0;
+    u64 total_count = 0;
+    for (size_t symbol = 0; symbol < Size; ++symbol) {
+        if (counts[symbol] == 0)
+            continue;
+        ++used_symbol_count;
+        last_used_symbol = symbol;
+        total_count += counts[symbol];
+    }
+
+    if (used_symbol_count <= 1) {
+        // A simple prefix code with a single symbol, which takes up no bits at all.
+        TRY(stream.write_bits(1u, 2));
+        TRY(stream.write_bits(0u, 2));
+        TRY(stream.write_bits(last_used_symbol, AK::ceil_log2(Size)));
+        return {};
+    }
+
+    // Note: generate_huffman_lengths() expects the frequencies to fit into 16 bits together.
+    Array<u16, Size> frequencies {};
+    u64 frequency_divisor = total_count / (NumericLimits<u16>::max() / 2) + 1;
+    for (size_t symbol = 0; symbol < Size; ++symbol) {
+        if (counts[symbol] != 0)
+            frequencies[symbol] = max<u64>(1, counts[symbol] / frequency_divisor);
+    }
+    generate_huffman_lengths(lengths, frequencies, max_code_length);
+    generate_reversed_codes(lengths, codes);
+
+    // The code lengths are themselves prefix coded. Lengths after the last used symbol are left out, as the code is
+    // complete at that point.
+    static constexpr size_t code_length_alphabet_size = 18;
+    Array<u16, code_length_alphabet_size> code_length_frequencies {};
+    for (size_t symbol = 0; symbol <= last_used_symbol; ++symbol)
+        ++code_length_frequencies[lengths[symbol]];
+    Array<u8, code_length_alphabet_size> code_length_lengths {};
+    Array<u16, code_length_alphabet_size> code_length_codes {};
+    generate_huffman_lengths(code_length_lengths, code_length_frequencies, 5);
+    generate_reversed_codes(code_length_lengths, code_length_codes);
+
+    static constexpr size_t code_length_order[code_length_alphabet_size] { 1, 2, 3, 4, 0, 5, 17, 6, 16, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+    size_t used_code_length_count = 0;
+    size_t last_code_length_index = 0;
+    for (size_t i = 0; i < code_length_alphabet_size; ++i) {
+        if (code_length_lengths[code_length_order[i]] != 0) {
+            ++used_code_length_count;
+            last_code_length_index = i;
+        }
+    }
+    // With a single code length in use, the decoder can't tell that it has seen all of them until it has read all 18.
+    if (used_code_length_count == 1)
+        last_code_length_index = code_length_alphabet_size - 1;
+
+    // HSKIP
+    TRY(stream.write_bits(0u, 2));
+    for (size_t i = 0; i <= last_code_length_index; ++i)
+        TRY(write_code_length_code_length(stream, code_length_lengths[code_length_order[i]]));
+
+    for (size_t symbol = 0; symbol <= last_used_symbol; ++symbol) {
+        auto length = lengths[symbol];
+        if (used_code_length_count > 1)
+            TRY(stream.write_bits(code_length_codes[length], code_length_lengths[length]));
+    }
+    return {};
+}
+
+static size_t length_code(size_t const (&bases)[24], size_t length)
+{
+    size_t code = 23;
+    while (bases[code] > length)
+        --code;
+    return code;
+}
+
+ErrorOr<void> BrotliCompressionStream::write_compressed_meta_block(LittleEndianOutputBitStream& stream)
+{
+    static constexpr size_t insert_and_copy_alphabet_size = 704;
+    static constexpr size_t distance_alphabet_size = 16 + 48;
+
+    auto buffer = m_window.bytes().trim(m_dictionary_size + m_block_size);
+    TRY(m_match_finder.reset(buffer.size()));
+    for (size_t position = 0; position < m_dictionary_size; ++position)
+        m_match_finder.insert(buffer, position);
+
+    struct Command {
+        u32 insert_length { 0 };
+        u32 copy_length { 0 };
+        u16 insert_and_copy_symbol { 0 };
+        bool has_distance_symbol { false };
+        u8 distance_symbol { 0 };
+        u8 distance_extra_bit_count { 0 };
+        u32 distance_extra_bits { 0 };
+    };
+    Vector<Command> commands;
+
+    Array<u32, 256> literal_counts {};
+    Array<u32, insert_and_copy_alphabet_size> insert_and_copy_counts {};
+    Array<u32, distance_alphabet_size> distance_counts {};
+
+    auto add_command = [&](size_t literal_start, size_t insert_length, size_t copy_length, size_t distance) -> ErrorOr<void> {
+        for (size_t i = 0; i < insert_length; ++i)
+            ++literal_counts[buffer[literal_start + i]];
+
+        Command command;
+        command.insert_length = insert_length;
+        command.copy_length = copy_length;
+
+        // The command that holds the literals at the end of the meta-block has no copy, and its distance is never read.
+        bool has_distance = copy_length != 0;
+        size_t distance_symbol = 0;
+        if (has_distance) {
+            if (distance == m_distances[0]) {
+                distance_symbol = 0;
+            } else {
+                if (distance == m_distances[1]) {
+                    distance_symbol = 1;
+                } else if (distance == m_distances[2]) {
+                    distance_symbol = 2;
+                } else if (distance == m_distances[3]) {
+                    distance_symbol = 3;
+                } else {
+                    // RFC 7932 section 4, with NPOSTFIX and NDIRECT both being 0.
+                    size_t x = distance + 3;
+                    size_t extra_bit_count = AK::log2(x) - 1;
+                    size_t prefix = (x >> extra_bit_count) & 1;
+                    distance_symbol = 16 + 2 * (extra_bit_count - 1) + prefix;
+                    command.distance_extra_bit_count = extra_bit_count;
+                    command.distance_extra_bits = x - ((2 + prefix) << extra_bit_count);
+                }
+                m_distances[3] = m_distances[2];
+                m_distances[2] = m_distances[1];
+                m_distances[1] = m_distances[0];
+                m_distances[0] = distance;
+            }
+        }
+
+        size_t insert_code = length_code(insert_length_base, insert_length);
+        size_t copy_code = length_code(copy_length_base, max<size_t>(copy_length, 2));
+
+        // The first two cells reuse the last distance without a distance symbol.
+        size_t cell = 0;
+        if ((!has_distance || distance_symbol == 0) && insert_code < 8 && copy_code < 16) {
+            cell = copy_code < 8 ? 0 : 1;
+        } else {
+            for (cell = 2; cell < 11; ++cell) {
+                if (insert_length_code_base[cell] == (insert_code & ~7) && copy_length_code_base[cell] == (copy_code & ~7))
+                    break;
+            }
+            VERIFY(cell < 11);
+            command.has_distance_symbol = has_distance;
+        }
+        VERIFY(!implicit_zero_distance[cell] || !command.has_distance_symbol);
+
+        command.insert_and_copy_symbol = (cell << 6) | ((insert_code & 7) << 3) | (copy_code & 7);
+        command.distance_symbol = distance_symbol;
+        ++insert_and_copy_counts[command.insert_and_copy_symbol];
+        if (command.has_distance_symbol)
+            ++distance_counts[distance_symbol];
+
+        TRY(commands.try_append(command));
+        return {};
+    };
+
+    size_t literal_start = m_dictionary_size;
+    size_t position = m_dictionary_size;
+    while (position + MatchFinder::min_match_length <= buffer.size()) {
+        auto match = m_match_finder.find_longest_match(buffer, position, window_size, block_size);
+        m_match_finder.insert(buffer, position);
+        if (match.length == 0) {
+            ++position;
+            continue;
+        }
+
+        // A longer match that starts at the next byte is worth a literal.
+        auto next_match = m_match_finder.find_longest_match(buffer, position + 1, window_size, block_size);
+        if (next_match.length > match.length) {
+            ++position;
+            continue;
+        }
+
+        TRY(add_command(literal_start, position - literal_start, match.length, match.distance));
+
+        for (size_t i = 1; i < match.length; ++i)
+            m_match_finder.insert(buffer, position + i);
+        position += match.length;
+        literal_start = position;
+    }
+    if (literal_start < buffer.size())
+        TRY(add_command(literal_start, buffer.size() - literal_start, 0, 0));
+
+    TRY(write_meta_block_header(stream, m_block_size, false));
+
+    // NBLTYPESL, NBLTYPESI and NBLTYPESD are all 1, so there's no block switching.
+    TRY(stream.write_bits(0u, 1));
+    TRY(stream.write_bits(0u, 1));
+    TRY(stream.write_bits(0u, 1));
+    // NPOSTFIX and NDIRECT
+    TRY(stream.write_bits(0u, 2));
+    TRY(stream.write_bits(0u, 4));
+    // The context mode of the only literal block type, which doesn't matter with a single literal prefix code.
+    TRY(stream.write_bits(0u, 2));
+    // NTREESL and NTREESD
+    TRY(stream.write_bits(0u, 1));
+    TRY(stream.write_bits(0u, 1));
+
+    Array<u8, 256> literal_lengths;
+    Array<u16, 256> literal_codes;
+    TRY(write_prefix_code(stream, literal_counts, literal_lengths, literal_codes));
+    Array<u8, insert_and_copy_alphabet_size> insert_and_copy_lengths;
+    Array<u16, insert_and_copy_alphabet_size> insert_and_copy_codes;
+    TRY(write_prefix_code(stream, insert_and_copy_counts, insert_and_copy_lengths, insert_and_copy_codes));
+    Array<u8, distance_alphabet_size> distance_lengths;
+    Array<u16, distance_alphabet_size> distance_codes;
+    TRY(write_prefix_code(stream, distance_counts, distance_lengths, distance_codes));
+
+    position = m_dictionary_size;
+    for (auto const& command : commands) {
+        TRY(stream.write_bits(insert_and_copy_codes[command.insert_and_copy_symbol], insert_and_copy_lengths[command.insert_and_copy_symbol]));
+
+        size_t insert_code = insert_length_code_base[command.insert_and_copy_symbol >> 6] + ((command.insert_and_copy_symbol >> 3) & 7);
+        size_t copy_code = copy_length_code_base[command.insert_and_copy_symbol >> 6] + (command.insert_and_copy_symbol & 7);
+        TRY(stream.write_bits(command.insert_length - insert_length_base[insert_code], insert_length_extra[insert_code]));
+        TRY(stream.write_bits(max<u32>(command.copy_length, 2) - copy_length_base[copy_code], copy_length_extra[copy_code]));
+
+        for (size_t i = 0; i < command.insert_length; ++i) {
+            auto literal = buffer[position + i];
+            TRY(stream.write_bits(literal_codes[literal], literal_lengths[literal]));
+        }
+        position += command.insert_length + command.copy_length;
+
+        if (command.has_distance_symbol) {
+            TRY(stream.write_bits(distance_codes[command.distance_symbol], distance_lengths[command.distance_symbol]));
+            TRY(stream.write_bits(command.distance_extra_bits, command.distance_extra_bit_count));
+        }
+    }
+
+    return {};
+}
+
 }
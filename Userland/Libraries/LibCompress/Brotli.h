@@ -7,13 +7,18 @@
 #pragma once
 
 #include <AK/BitStream.h>
+#include <AK/ByteBuffer.h>
 #include <AK/CircularQueue.h>
 #include <AK/FixedArray.h>
+#include <AK/MaybeOwned.h>
+#include <AK/NonnullOwnPtr.h>
+#include <LibCompress/MatchFinder.h>
 #include <LibCore/Stream.h>
 
 namespace Compress {
 
 using AK::LittleEndianInputBitStream;
+using AK::LittleEndianOutputBitStream;
 using AK::Stream;
 
 class BrotliDecompressionStream : public Stream {
@@ -39,9 +44,24 @@ public:
         {
             m_symbol_codes.clear();
             m_symbol_values.clear();
+            m_prefix_table.fill({});
         }
 
     private:
+        // Has to be called once all codes have been added, before any symbols are read.
+        void build_prefix_table();
+
+        static constexpr size_t max_code_length = 15;
+        static constexpr size_t prefix_table_bits = 8;
+
+        struct PrefixTableEntry {
+            u16 symbol_value { 0 };
+            u16 code_length { 0 };
+        };
+
+        // Indexed by the next prefix_table_bits bits of input, for all codes that aren't longer than that.
+        Array<PrefixTableEntry, 1 << prefix_table_bits> m_prefix_table {};
+
         Vector<size_t> m_symbol_codes;
         Vector<size_t> m_symbol_values;
     };
@@ -160,4 +180,47 @@ private:
     Vector<CanonicalCode> m_distance_codes;
 };
 
+// Compresses data into a single Brotli stream, one meta-block per block of input. Matches are found through hash chains
+// and may reach back into the previous block. Every meta-block uses a single prefix code per alphabet, without any
+// block switching or literal context modeling.
+class BrotliCompressionStream final : public Stream {
+public:
+    static constexpr size_t block_size = 128 * KiB;
+    // The window has to cover the previous block as well as the current one, and is 16 bytes short of a power of two.
+    static constexpr size_t window_bits = 18;
+    static constexpr size_t window_size = (1 << window_bits) - 16;
+    static_assert(2 * block_size - 1 <= (1 << window_bits));
+
+    static ErrorOr<NonnullOwnPtr<BrotliCompressionStream>> construct(MaybeOwned<Stream>);
+    ~BrotliCompressionStream();
+
+    ErrorOr<Bytes> read(Bytes) override;
+    ErrorOr<size_t> write(ReadonlyBytes) override;
+    bool is_eof() const override { return true; }
+    bool is_open() const override { return m_output_stream->is_open(); }
+    void close() override { }
+
+    ErrorOr<void> final_flush();
+
+    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes);
+
+private:
+    BrotliCompressionStream(NonnullOwnPtr<LittleEndianOutputBitStream>, ByteBuffer window);
+
+    ErrorOr<void> flush_meta_block();
+    ErrorOr<void> write_compressed_meta_block(LittleEndianOutputBitStream&);
+    ErrorOr<void> write_uncompressed_meta_block();
+
+    NonnullOwnPtr<LittleEndianOutputBitStream> m_output_stream;
+    bool m_finished { false };
+
+    // The previous block, followed by the block that is being collected.
+    ByteBuffer m_window;
+    size_t m_dictionary_size { 0 };
+    size_t m_block_size { 0 };
+
+    MatchFinder m_match_finder;
+    size_t m_distances[4] { 4, 11, 15, 16 };
+};
+
 }
@@ -7,13 +7,14 @@
 
 #include <AK/Array.h>
 #include <AK/Assertions.h>
-#include <AK/BinaryHeap.h>
 #include <AK/BinarySearch.h>
 #include <AK/BitStream.h>
 #include <AK/MemoryStream.h>
 #include <string.h>
 
 #include <LibCompress/Deflate.h>
+#include <LibCompress/Huffman.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace Compress {
 
@@ -23,29 +24,15 @@ static constexpr u8 deflate_special_code_length_long_zeros = 18;
 
 CanonicalCode const& CanonicalCode::fixed_literal_codes()
 {
-    static CanonicalCode code;
-    static bool initialized = false;
-
-    if (initialized)
-        return code;
-
-    code = CanonicalCode::from_bytes(fixed_literal_bit_lengths).value();
-    initialized = true;
-
+    // Note: This is thread-safe, unlike initializing it by hand.
+    static CanonicalCode const code = CanonicalCode::from_bytes(fixed_literal_bit_lengths).value();
     return code;
 }
 
 CanonicalCode const& CanonicalCode::fixed_distance_codes()
 {
-    static CanonicalCode code;
-    static bool initialized = false;
-
-    if (initialized)
-        return code;
-
-    code = CanonicalCode::from_bytes(fixed_distance_bit_lengths).value();
-    initialized = true;
-
+    // Note: This is thread-safe, unlike initializing it by hand.
+    static CanonicalCode const code = CanonicalCode::from_bytes(fixed_distance_bit_lengths).value();
     return code;
 }
 
@@ -68,11 +55,12 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         code.m_symbol_values.append(last_non_zero);
         code.m_bit_codes[last_non_zero] = 0;
         code.m_bit_code_lengths[last_non_zero] = 1;
+        code.fill_prefix_table(last_non_zero);
         return code;
     }
 
     auto next_code = 0;
-    for (size_t code_length = 1; code_length <= 15; ++code_length) {
+    for (size_t code_length = 1; code_length <= max_code_length; ++code_length) {
         next_code <<= 1;
         auto start_bit = 1 << code_length;
 
@@ -87,6 +75,7 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
             code.m_symbol_values.append(symbol);
             code.m_bit_codes[symbol] = fast_reverse16(start_bit | next_code, code_length); // DEFLATE writes huffman encoded symbols as lsb-first
             code.m_bit_code_lengths[symbol] = code_length;
+            code.fill_prefix_table(symbol);
 
             next_code++;
         }
@@ -99,21 +88,42 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
     return code;
 }
 
+void CanonicalCode::fill_prefix_table(u32 symbol)
+{
+    auto code_length = m_bit_code_lengths[symbol];
+    if (code_length > prefix_table_bits)
+        return;
+
+    // The code only determines the lowest bits of the index, every combination of the bits above them maps to it too.
+    for (size_t index = m_bit_codes[symbol]; index < m_prefix_table.size(); index += 1 << code_length)
+        m_prefix_table[index] = { static_cast<u16>(symbol), code_length };
+}
+
 ErrorOr<u32> CanonicalCode::read_symbol(LittleEndianInputBitStream& stream) const
 {
-    u32 code_bits = 1;
+    auto prefix = TRY(stream.peek_bits<size_t>(prefix_table_bits));
+    auto const& entry = m_prefix_table[prefix];
+    if (entry.code_length != 0) {
+        TRY(stream.discard_previously_peeked_bits(entry.code_length));
+        return entry.symbol_value;
+    }
 
-    for (;;) {
-        code_bits = code_bits << 1 | TRY(stream.read_bits(1));
-        if (code_bits >= (1 << 16))
-            return Error::from_string_literal("Symbol exceeds maximum symbol number");
+    // Codes that are too long for the prefix table are looked up one length at a time.
+    auto bits = TRY(stream.peek_bits<u32>(max_code_length));
+    u32 code_bits = 1;
+    for (size_t code_length = 1; code_length <= max_code_length; ++code_length) {
+        code_bits = code_bits << 1 | ((bits >> (code_length - 1)) & 1);
+        if (code_length <= prefix_table_bits)
+            continue;
 
-        // FIXME: This is very inefficient and could greatly be improved by implementing this
-        //        algorithm: https://www.hanshq.net/zip.html#huffdec
         size_t index;
-        if (binary_search(m_symbol_codes.span(), code_bits, &index))
+        if (binary_search(m_symbol_codes.span(), code_bits, &index)) {
+            TRY(stream.discard_previously_peeked_bits(code_length));
             return m_symbol_values[index];
+        }
     }
+
+    return Error::from_string_literal("Symbol exceeds maximum symbol number");
 }
 
 ErrorOr<void> CanonicalCode::write_symbol(LittleEndianOutputBitStream& stream, u32 symbol) const
@@ -134,19 +144,26 @@ ErrorOr<bool> DeflateDecompressor::CompressedBlock::try_read_more()
     if (m_eof == true)
         return false;
 
-    auto const symbol = TRY(m_literal_codes.read_symbol(*m_decompressor.m_input_stream));
+    // Decode as many symbols as are guaranteed to fit into the output buffer in one go.
+    bool has_written_output = false;
+    while (m_decompressor.m_output_buffer.empty_space() >= DeflateCompressor::max_match_length) {
+        auto const symbol = TRY(m_literal_codes.read_symbol(*m_decompressor.m_input_stream));
 
-    if (symbol >= 286)
-        return Error::from_string_literal("Invalid deflate literal/length symbol");
+        if (symbol >= 286)
+            return Error::from_string_literal("Invalid deflate literal/length symbol");
+
+        if (symbol < 256) {
+            u8 byte_symbol = symbol;
+            m_decompressor.m_output_buffer.write({ &byte_symbol, sizeof(byte_symbol) });
+            has_written_output = true;
+            continue;
+        }
+
+        if (symbol == 256) {
+            m_eof = true;
+            return has_written_output;
+        }
 
-    if (symbol < 256) {
-        u8 byte_symbol = symbol;
-        m_decompressor.m_output_buffer.write({ &byte_symbol, sizeof(byte_symbol) });
-        return true;
-    } else if (symbol == 256) {
-        m_eof = true;
-        return false;
-    } else {
         if (!m_distance_codes.has_value())
             return Error::from_string_literal("Distance codes have not been initialized");
 
@@ -157,15 +174,12 @@ ErrorOr<bool> DeflateDecompressor::CompressedBlock::try_read_more()
 
         auto const distance = TRY(m_decompressor.decode_distance(distance_symbol));
 
-        for (size_t idx = 0; idx < length; ++idx) {
-            u8 byte = 0;
-            TRY(m_decompressor.m_output_buffer.read_with_seekback({ &byte, sizeof(byte) }, distance));
-
-            m_decompressor.m_output_buffer.write({ &byte, sizeof(byte) });
-        }
-
-        return true;
+        auto copied_length = TRY(m_decompressor.m_output_buffer.copy_from_seekback(distance, length));
+        VERIFY(copied_length == length);
+        has_written_output = true;
     }
+
+    return true;
 }
 
 DeflateDecompressor::UncompressedBlock::UncompressedBlock(DeflateDecompressor& decompressor, size_t length)
@@ -182,6 +196,8 @@ ErrorOr<bool> DeflateDecompressor::UncompressedBlock::try_read_more()
     Array<u8, 4096> temporary_buffer;
     auto readable_bytes = temporary_buffer.span().trim(min(m_bytes_remaining, m_decompressor.m_output_buffer.empty_space()));
     auto read_bytes = TRY(m_decompressor.m_input_stream->read(readable_bytes));
+    if (read_bytes.is_empty())
+        return Error::from_string_literal("Input data ends in the middle of an uncompressed block");
     auto written_bytes = m_decompressor.m_output_buffer.write(read_bytes);
     VERIFY(read_bytes.size() == written_bytes);
 
@@ -190,13 +206,19 @@ ErrorOr<bool> DeflateDecompressor::UncompressedBlock::try_read_more()
 }
 
 ErrorOr<NonnullOwnPtr<DeflateDecompressor>> DeflateDecompressor::construct(MaybeOwned<AK::Stream> stream)
+{
+    auto bit_stream = TRY(LittleEndianInputBitStream::construct(move(stream)));
+    return construct(MaybeOwned<LittleEndianInputBitStream>(move(bit_stream)));
+}
+
+ErrorOr<NonnullOwnPtr<DeflateDecompressor>> DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream> stream)
 {
     auto output_buffer = TRY(CircularBuffer::create_empty(32 * KiB));
     return TRY(adopt_nonnull_own_or_enomem(new (nothrow) DeflateDecompressor(move(stream), move(output_buffer))));
 }
 
-DeflateDecompressor::DeflateDecompressor(MaybeOwned<AK::Stream> stream, CircularBuffer output_buffer)
-    : m_input_stream(make<LittleEndianInputBitStream>(move(stream)))
+DeflateDecompressor::DeflateDecompressor(MaybeOwned<LittleEndianInputBitStream> stream, CircularBuffer output_buffer)
+    : m_input_stream(move(stream))
     , m_output_buffer(move(output_buffer))
 {
 }
@@ -447,20 +469,30 @@ ErrorOr<void> DeflateDecompressor::decode_codes(CanonicalCode& literal_code, Opt
     return {};
 }
 
-ErrorOr<NonnullOwnPtr<DeflateCompressor>> DeflateCompressor::construct(MaybeOwned<AK::Stream> stream, CompressionLevel compression_level)
+ErrorOr<NonnullOwnPtr<DeflateCompressor>> DeflateCompressor::construct(MaybeOwned<AK::Stream> stream, CompressionLevel compression_level, UseThreadPool use_thread_pool)
 {
     auto bit_stream = TRY(LittleEndianOutputBitStream::construct(move(stream)));
-    auto deflate_compressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DeflateCompressor(move(bit_stream), compression_level)));
+
+    // Note: Storing blocks uncompressed is about as fast as copying them, so there is nothing to gain from threads.
+    size_t block_count = 1;
+    if (use_thread_pool == UseThreadPool::Yes && compression_level != CompressionLevel::STORE)
+        block_count = Threading::ThreadPool::the().worker_count() + 1;
+
+    Vector<NonnullOwnPtr<Block>> blocks;
+    TRY(blocks.try_ensure_capacity(block_count));
+    for (size_t i = 0; i < block_count; ++i)
+        blocks.unchecked_append(TRY(adopt_nonnull_own_or_enomem(new (nothrow) Block)));
+
+    auto deflate_compressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DeflateCompressor(move(bit_stream), compression_level, move(blocks))));
     return deflate_compressor;
 }
 
-DeflateCompressor::DeflateCompressor(NonnullOwnPtr<LittleEndianOutputBitStream> stream, CompressionLevel compression_level)
+DeflateCompressor::DeflateCompressor(NonnullOwnPtr<LittleEndianOutputBitStream> stream, CompressionLevel compression_level, Vector<NonnullOwnPtr<Block>> blocks)
     : m_compression_level(compression_level)
     , m_compression_constants(compression_constants[static_cast<int>(m_compression_level)])
     , m_output_stream(move(stream))
+    , m_blocks(move(blocks))
 {
-    m_symbol_frequencies.fill(0);
-    m_distance_frequencies.fill(0);
 }
 
 DeflateCompressor::~DeflateCompressor()
@@ -480,11 +512,12 @@ ErrorOr<size_t> DeflateCompressor::write(ReadonlyBytes bytes)
     if (bytes.size() == 0)
         return 0; // recursion base case
 
-    auto n_written = bytes.copy_trimmed_to(pending_block().slice(m_pending_block_size));
-    m_pending_block_size += n_written;
+    auto& block = *m_blocks[m_current_block];
+    auto n_written = bytes.copy_trimmed_to(block.data().slice(block.size));
+    block.size += n_written;
 
-    if (m_pending_block_size == block_size)
-        TRY(flush());
+    if (block.size == block_size)
+        TRY(finish_block());
 
     return n_written + TRY(write(bytes.slice(n_written)));
 }
@@ -510,19 +543,30 @@ u16 DeflateCompressor::hash_sequence(u8 const* bytes)
     return ((bytes[0] | bytes[1] << 8 | bytes[2] << 16 | bytes[3] << 24) * knuth_constant) >> (32 - hash_bits);
 }
 
-size_t DeflateCompressor::compare_match_candidate(size_t start, size_t candidate, size_t previous_match_length, size_t maximum_match_length)
+size_t DeflateCompressor::compare_match_candidate(Block const& block, size_t start, size_t candidate, size_t previous_match_length, size_t maximum_match_length)
 {
     VERIFY(previous_match_length < maximum_match_length);
+    auto const* window = block.window;
 
     // We firstly check that the match is at least (prev_match_length + 1) long, we check backwards as there's a higher chance the end mismatches
     for (ssize_t i = previous_match_length; i >= 0; i--) {
-        if (m_rolling_window[start + i] != m_rolling_window[candidate + i])
+        if (window[start + i] != window[candidate + i])
             return 0;
     }
 
-    // Find the actual length
+    // Find the actual length, 8 bytes at a time while we can
     auto match_length = previous_match_length + 1;
-    while (match_length < maximum_match_length && m_rolling_window[start + match_length] == m_rolling_window[candidate + match_length]) {
+    while (match_length + sizeof(u64) <= maximum_match_length) {
+        u64 start_bytes;
+        u64 candidate_bytes;
+        __builtin_memcpy(&start_bytes, &window[start + match_length], sizeof(u64));
+        __builtin_memcpy(&candidate_bytes, &window[candidate + match_length], sizeof(u64));
+        auto difference = AK::convert_between_host_and_little_endian(start_bytes ^ candidate_bytes);
+        if (difference != 0)
+            return match_length + count_trailing_zeroes(difference) / 8;
+        match_length += sizeof(u64);
+    }
+    while (match_length < maximum_match_length && window[start + match_length] == window[candidate + match_length]) {
         match_length++;
     }
 
@@ -531,7 +575,7 @@ size_t DeflateCompressor::compare_match_candidate(size_t start, size_t candidate
     return match_length;
 }
 
-size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previous_match_length, size_t maximum_match_length, size_t& match_position)
+size_t DeflateCompressor::find_back_match(Block const& block, size_t start, u16 hash, size_t previous_match_length, size_t maximum_match_length, size_t& match_position) const
 {
     auto max_chain_length = m_compression_constants.max_chain;
     if (previous_match_length == 0)
@@ -543,17 +587,17 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
     if (previous_match_length >= m_compression_constants.good_match_length)
         max_chain_length /= 4; // we already have a pretty good much, so do a shorter search
 
-    auto candidate = m_hash_head[hash];
+    auto candidate = block.hash_head[hash];
     auto match_found = false;
     while (max_chain_length--) {
         if (candidate == empty_slot)
             break; // no remaining candidates
 
         VERIFY(candidate < start);
-        if (start - candidate > window_size)
+        if (start - candidate > max_distance)
             break; // outside the window
 
-        auto match_length = compare_match_candidate(start, candidate, previous_match_length, maximum_match_length);
+        auto match_length = compare_match_candidate(block, start, candidate, previous_match_length, maximum_match_length);
 
         if (match_length != 0) {
             match_found = true;
@@ -564,7 +608,7 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
                 return match_length; // bail if we got the maximum possible length
         }
 
-        candidate = m_hash_prev[candidate % window_size];
+        candidate = block.hash_prev[candidate % window_size];
     }
     if (!match_found)
         return 0;                 // we didn't find any matches
@@ -576,119 +620,52 @@ ALWAYS_INLINE u8 DeflateCompressor::distance_to_base(u16 distance)
     return (distance <= 256) ? distance_to_base_lo[distance - 1] : distance_to_base_hi[(distance - 1) >> 7];
 }
 
-template<size_t Size>
-void DeflateCompressor::generate_huffman_lengths(Array<u8, Size>& lengths, Array<u16, Size> const& frequencies, size_t max_bit_length, u16 frequency_cap)
-{
-    VERIFY((1u << max_bit_length) >= Size);
-    u16 heap_keys[Size]; // Used for O(n) heap construction
-    u16 heap_values[Size];
-
-    u16 huffman_links[Size * 2 + 1] = { 0 };
-    size_t non_zero_freqs = 0;
-    for (size_t i = 0; i < Size; i++) {
-        auto frequency = frequencies[i];
-        if (frequency == 0)
-            continue;
-
-        if (frequency > frequency_cap) {
-            frequency = frequency_cap;
-        }
-
-        heap_keys[non_zero_freqs] = frequency;               // sort symbols by frequency
-        heap_values[non_zero_freqs] = Size + non_zero_freqs; // huffman_links "links"
-        non_zero_freqs++;
-    }
-
-    // special case for only 1 used symbol
-    if (non_zero_freqs < 2) {
-        for (size_t i = 0; i < Size; i++)
-            lengths[i] = (frequencies[i] == 0) ? 0 : 1;
-        return;
-    }
-
-    BinaryHeap<u16, u16, Size> heap { heap_keys, heap_values, non_zero_freqs };
-
-    // build the huffman tree - binary heap is used for efficient frequency comparisons
-    while (heap.size() > 1) {
-        u16 lowest_frequency = heap.peek_min_key();
-        u16 lowest_link = heap.pop_min();
-        u16 second_lowest_frequency = heap.peek_min_key();
-        u16 second_lowest_link = heap.pop_min();
-
-        u16 new_link = heap.size() + 2;
-
-        heap.insert(lowest_frequency + second_lowest_frequency, new_link);
-
-        huffman_links[lowest_link] = new_link;
-        huffman_links[second_lowest_link] = new_link;
-    }
-
-    non_zero_freqs = 0;
-    for (size_t i = 0; i < Size; i++) {
-        if (frequencies[i] == 0) {
-            lengths[i] = 0;
-            continue;
-        }
-
-        u16 link = huffman_links[Size + non_zero_freqs];
-        non_zero_freqs++;
-
-        size_t bit_length = 1;
-        while (link != 2) {
-            bit_length++;
-            link = huffman_links[link];
-        }
-
-        if (bit_length > max_bit_length) {
-            VERIFY(frequency_cap != 1);
-            return generate_huffman_lengths(lengths, frequencies, max_bit_length, frequency_cap / 2);
-        }
-
-        lengths[i] = bit_length;
-    }
-}
-
-void DeflateCompressor::lz77_compress_block()
+void DeflateCompressor::lz77_compress_block(Block& block) const
 {
-    for (auto& slot : m_hash_head) { // initialize chained hash table
+    for (auto& slot : block.hash_head) { // initialize chained hash table
         slot = empty_slot;
     }
 
     auto insert_hash = [&](auto pos, auto hash) {
         auto window_pos = pos % window_size;
-        m_hash_prev[window_pos] = m_hash_head[hash];
-        m_hash_head[hash] = window_pos;
+        block.hash_prev[window_pos] = block.hash_head[hash];
+        block.hash_head[hash] = window_pos;
     };
 
     auto emit_literal = [&](auto literal) {
-        VERIFY(m_pending_symbol_size <= block_size + 1);
-        auto index = m_pending_symbol_size++;
-        m_symbol_buffer[index].distance = 0;
-        m_symbol_buffer[index].literal = literal;
-        m_symbol_frequencies[literal]++;
+        VERIFY(block.pending_symbol_size <= block_size + 1);
+        auto index = block.pending_symbol_size++;
+        block.symbol_buffer[index].distance = 0;
+        block.symbol_buffer[index].literal = literal;
+        block.symbol_frequencies[literal]++;
     };
 
     auto emit_back_reference = [&](auto distance, auto length) {
-        VERIFY(m_pending_symbol_size <= block_size + 1);
-        auto index = m_pending_symbol_size++;
-        m_symbol_buffer[index].distance = distance;
-        m_symbol_buffer[index].length = length;
-        m_symbol_frequencies[length_to_symbol[length]]++;
-        m_distance_frequencies[distance_to_base(distance)]++;
+        VERIFY(block.pending_symbol_size <= block_size + 1);
+        auto index = block.pending_symbol_size++;
+        block.symbol_buffer[index].distance = distance;
+        block.symbol_buffer[index].length = length;
+        block.symbol_frequencies[length_to_symbol[length]]++;
+        block.distance_frequencies[distance_to_base(distance)]++;
     };
 
-    size_t previous_match_length = 0;
-    size_t previous_match_position = 0;
+    // the previous block is put into the hash table first, so that we can find matches that reach back into it
+    for (size_t position = block_size - block.dictionary_size; position < block_size; position++) {
+        insert_hash(position, hash_sequence(&block.window[position]));
+    }
 
     VERIFY(m_compression_constants.great_match_length <= max_match_length);
 
-    // our block starts at block_size and is m_pending_block_size in length
-    auto block_end = block_size + m_pending_block_size;
+    size_t previous_match_length = 0;
+    size_t previous_match_position = 0;
+
+    // our block starts at block_size and is block.size in length
+    auto block_end = block_size + block.size;
     size_t current_position;
     for (current_position = block_size; current_position < block_end - min_match_length + 1; current_position++) {
-        auto hash = hash_sequence(&m_rolling_window[current_position]);
+        auto hash = hash_sequence(&block.window[current_position]);
         size_t match_position;
-        auto match_length = find_back_match(current_position, hash, previous_match_length,
+        auto match_length = find_back_match(block, current_position, hash, previous_match_length,
             min(m_compression_constants.great_match_length, block_end - current_position), match_position);
 
         insert_hash(current_position, hash);
@@ -699,7 +676,7 @@ void DeflateCompressor::lz77_compress_block()
 
             // skip all the bytes that are included in this match
             for (size_t j = current_position + 1; j < min(current_position - 1 + previous_match_length, block_end - min_match_length + 1); j++) {
-                insert_hash(j, hash_sequence(&m_rolling_window[j]));
+                insert_hash(j, hash_sequence(&block.window[j]));
             }
             current_position = (current_position - 1) + previous_match_length - 1;
             previous_match_length = 0;
@@ -708,13 +685,13 @@ void DeflateCompressor::lz77_compress_block()
 
         if (match_length == 0) {
             VERIFY(previous_match_length == 0);
-            emit_literal(m_rolling_window[current_position]);
+            emit_literal(block.window[current_position]);
             continue;
         }
 
         // if this is a lazy match, and the new match is better than the old one, output previous as literal
         if (previous_match_length != 0) {
-            emit_literal(m_rolling_window[current_position - 1]);
+            emit_literal(block.window[current_position - 1]);
         }
 
         previous_match_length = match_length;
@@ -729,16 +706,16 @@ void DeflateCompressor::lz77_compress_block()
 
     // output remaining literals
     while (current_position < block_end) {
-        emit_literal(m_rolling_window[current_position++]);
+        emit_literal(block.window[current_position++]);
     }
 }
 
-size_t DeflateCompressor::huffman_block_length(Array<u8, max_huffman_literals> const& literal_bit_lengths, Array<u8, max_huffman_distances> const& distance_bit_lengths)
+size_t DeflateCompressor::huffman_block_length(Block const& block, Array<u8, max_huffman_literals> const& literal_bit_lengths, Array<u8, max_huffman_distances> const& distance_bit_lengths)
 {
     size_t length = 0;
 
     for (size_t i = 0; i < 286; i++) {
-        auto frequency = m_symbol_frequencies[i];
+        auto frequency = block.symbol_frequencies[i];
         length += literal_bit_lengths[i] * frequency;
 
         if (i >= 257) // back reference length symbols
@@ -746,7 +723,7 @@ size_t DeflateCompressor::huffman_block_length(Array<u8, max_huffman_literals> c
     }
 
     for (size_t i = 0; i < 30; i++) {
-        auto frequency = m_distance_frequencies[i];
+        auto frequency = block.distance_frequencies[i];
         length += distance_bit_lengths[i] * frequency;
         length += packed_distances[i].extra_bits * frequency;
     }
@@ -754,30 +731,30 @@ size_t DeflateCompressor::huffman_block_length(Array<u8, max_huffman_literals> c
     return length;
 }
 
-size_t DeflateCompressor::uncompressed_block_length()
+size_t DeflateCompressor::uncompressed_block_length(Block const& block, size_t bit_offset)
 {
-    auto padding = 8 - ((m_output_stream->bit_offset() + 3) % 8);
+    auto padding = 8 - ((bit_offset + 3) % 8);
     // 3 bit block header + align to byte + 2 * 16 bit length fields + block contents
-    return 3 + padding + (2 * 16) + m_pending_block_size * 8;
+    return 3 + padding + (2 * 16) + block.size * 8;
 }
 
-size_t DeflateCompressor::fixed_block_length()
+size_t DeflateCompressor::fixed_block_length(Block const& block)
 {
     // block header + fixed huffman encoded block contents
-    return 3 + huffman_block_length(fixed_literal_bit_lengths, fixed_distance_bit_lengths);
+    return 3 + huffman_block_length(block, fixed_literal_bit_lengths, fixed_distance_bit_lengths);
 }
 
-size_t DeflateCompressor::dynamic_block_length(Array<u8, max_huffman_literals> const& literal_bit_lengths, Array<u8, max_huffman_distances> const& distance_bit_lengths, Array<u8, 19> const& code_lengths_bit_lengths, Array<u16, 19> const& code_lengths_frequencies, size_t code_lengths_count)
+size_t DeflateCompressor::dynamic_block_length(Block const& block, Array<u16, 19> const& code_lengths_frequencies)
 {
     // block header + literal code count + distance code count + code length count
     auto length = 3 + 5 + 5 + 4;
 
     // 3 bits per code_length
-    length += 3 * code_lengths_count;
+    length += 3 * block.code_lengths_count;
 
     for (size_t i = 0; i < code_lengths_frequencies.size(); i++) {
         auto frequency = code_lengths_frequencies[i];
-        length += code_lengths_bit_lengths[i] * frequency;
+        length += block.code_lengths_bit_lengths[i] * frequency;
 
         if (i == deflate_special_code_length_copy) {
             length += 2 * frequency;
@@ -788,27 +765,28 @@ size_t DeflateCompressor::dynamic_block_length(Array<u8, max_huffman_literals> c
         }
     }
 
-    return length + huffman_block_length(literal_bit_lengths, distance_bit_lengths);
+    return length + huffman_block_length(block, block.literal_bit_lengths, block.distance_bit_lengths);
 }
 
-ErrorOr<void> DeflateCompressor::write_huffman(CanonicalCode const& literal_code, Optional<CanonicalCode> const& distance_code)
+ErrorOr<void> DeflateCompressor::write_huffman(LittleEndianOutputBitStream& stream, Block const& block, CanonicalCode const& literal_code, Optional<CanonicalCode> const& distance_code)
 {
     auto has_distances = distance_code.has_value();
-    for (size_t i = 0; i < m_pending_symbol_size; i++) {
-        if (m_symbol_buffer[i].distance == 0) {
-            TRY(literal_code.write_symbol(*m_output_stream, m_symbol_buffer[i].literal));
+    for (size_t i = 0; i < block.pending_symbol_size; i++) {
+        auto const& symbol_entry = block.symbol_buffer[i];
+        if (symbol_entry.distance == 0) {
+            TRY(literal_code.write_symbol(stream, symbol_entry.literal));
             continue;
         }
         VERIFY(has_distances);
-        auto symbol = length_to_symbol[m_symbol_buffer[i].length];
-        TRY(literal_code.write_symbol(*m_output_stream, symbol));
+        auto symbol = length_to_symbol[symbol_entry.length];
+        TRY(literal_code.write_symbol(stream, symbol));
         // Emit extra bits if needed
-        TRY(m_output_stream->write_bits<u16>(m_symbol_buffer[i].length - packed_length_symbols[symbol - 257].base_length, packed_length_symbols[symbol - 257].extra_bits));
+        TRY(stream.write_bits<u16>(symbol_entry.length - packed_length_symbols[symbol - 257].base_length, packed_length_symbols[symbol - 257].extra_bits));
 
-        auto base_distance = distance_to_base(m_symbol_buffer[i].distance);
-        TRY(distance_code.value().write_symbol(*m_output_stream, base_distance));
+        auto base_distance = distance_to_base(symbol_entry.distance);
+        TRY(distance_code.value().write_symbol(stream, base_distance));
         // Emit extra bits if needed
-        TRY(m_output_stream->write_bits<u16>(m_symbol_buffer[i].distance - packed_distances[base_distance].base_distance, packed_distances[base_distance].extra_bits));
+        TRY(stream.write_bits<u16>(symbol_entry.distance - packed_distances[base_distance].base_distance, packed_distances[base_distance].extra_bits));
     }
     return {};
 }
@@ -881,129 +859,237 @@ size_t DeflateCompressor::encode_block_lengths(Array<u8, max_huffman_literals> c
     return encode_huffman_lengths(all_lengths, lengths_count, encoded_lengths);
 }
 
-ErrorOr<void> DeflateCompressor::write_dynamic_huffman(CanonicalCode const& literal_code, size_t literal_code_count, Optional<CanonicalCode> const& distance_code, size_t distance_code_count, Array<u8, 19> const& code_lengths_bit_lengths, size_t code_length_count, Array<code_length_symbol, max_huffman_literals + max_huffman_distances> const& encoded_lengths, size_t encoded_lengths_count)
+ErrorOr<void> DeflateCompressor::write_dynamic_huffman(LittleEndianOutputBitStream& stream, Block const& block, CanonicalCode const& literal_code, Optional<CanonicalCode> const& distance_code)
 {
-    TRY(m_output_stream->write_bits(literal_code_count - 257, 5));
-    TRY(m_output_stream->write_bits(distance_code_count - 1, 5));
-    TRY(m_output_stream->write_bits(code_length_count - 4, 4));
+    TRY(stream.write_bits(block.literal_code_count - 257, 5));
+    TRY(stream.write_bits(block.distance_code_count - 1, 5));
+    TRY(stream.write_bits(block.code_lengths_count - 4, 4));
 
-    for (size_t i = 0; i < code_length_count; i++) {
-        TRY(m_output_stream->write_bits(code_lengths_bit_lengths[code_lengths_code_lengths_order[i]], 3));
+    for (size_t i = 0; i < block.code_lengths_count; i++) {
+        TRY(stream.write_bits(block.code_lengths_bit_lengths[code_lengths_code_lengths_order[i]], 3));
     }
 
-    auto code_lengths_code = CanonicalCode::from_bytes(code_lengths_bit_lengths);
+    auto code_lengths_code = CanonicalCode::from_bytes(block.code_lengths_bit_lengths);
     VERIFY(code_lengths_code.has_value());
-    for (size_t i = 0; i < encoded_lengths_count; i++) {
-        auto encoded_length = encoded_lengths[i];
-        TRY(code_lengths_code->write_symbol(*m_output_stream, encoded_length.symbol));
+    for (size_t i = 0; i < block.encoded_lengths_count; i++) {
+        auto encoded_length = block.encoded_lengths[i];
+        TRY(code_lengths_code->write_symbol(stream, encoded_length.symbol));
         if (encoded_length.symbol == deflate_special_code_length_copy) {
-            TRY(m_output_stream->write_bits<u8>(encoded_length.count - 3, 2));
+            TRY(stream.write_bits<u8>(encoded_length.count - 3, 2));
         } else if (encoded_length.symbol == deflate_special_code_length_zeros) {
-            TRY(m_output_stream->write_bits<u8>(encoded_length.count - 3, 3));
+            TRY(stream.write_bits<u8>(encoded_length.count - 3, 3));
         } else if (encoded_length.symbol == deflate_special_code_length_long_zeros) {
-            TRY(m_output_stream->write_bits<u8>(encoded_length.count - 11, 7));
+            TRY(stream.write_bits<u8>(encoded_length.count - 11, 7));
         }
     }
 
-    TRY(write_huffman(literal_code, distance_code));
+    TRY(write_huffman(stream, block, literal_code, distance_code));
     return {};
 }
 
-ErrorOr<void> DeflateCompressor::flush()
+void DeflateCompressor::compress_block(Block& block) const
 {
-    TRY(m_output_stream->write_bits(m_finished, 1));
-
-    // if this is just an empty block to signify the end of the deflate stream use the smallest block possible (10 bits total)
-    if (m_pending_block_size == 0) {
-        VERIFY(m_finished);                              // we shouldn't be writing empty blocks unless this is the final one
-        TRY(m_output_stream->write_bits(0b01u, 2));      // fixed huffman codes
-        TRY(m_output_stream->write_bits(0b0000000u, 7)); // end of block symbol
-        TRY(m_output_stream->align_to_byte_boundary());
-        return {};
-    }
-
-    auto write_uncompressed = [&]() -> ErrorOr<void> {
-        TRY(m_output_stream->write_bits(0b00u, 2)); // no compression
-        TRY(m_output_stream->align_to_byte_boundary());
-        LittleEndian<u16> len = m_pending_block_size;
-        TRY(m_output_stream->write_entire_buffer(len.bytes()));
-        LittleEndian<u16> nlen = ~m_pending_block_size;
-        TRY(m_output_stream->write_entire_buffer(nlen.bytes()));
-        TRY(m_output_stream->write_entire_buffer(pending_block().slice(0, m_pending_block_size)));
-        return {};
-    };
-
-    if (m_compression_level == CompressionLevel::STORE) { // disabled compression fast path
-        TRY(write_uncompressed());
-        m_pending_block_size = 0;
-        return {};
-    }
+    // an empty block is only written to signify the end of the deflate stream, so there's nothing to compress
+    if (block.size == 0)
+        return;
 
     // The following implementation of lz77 compression and huffman encoding is based on the reference implementation by Hans Wennborg https://www.hanshq.net/zip.html
 
-    // this reads from the pending block and writes to m_symbol_buffer
-    lz77_compress_block();
+    block.pending_symbol_size = 0;
+    block.symbol_frequencies.fill(0);
+    block.distance_frequencies.fill(0);
+
+    // this reads from the block and writes to its symbol buffer
+    lz77_compress_block(block);
 
     // insert EndOfBlock marker to the symbol buffer
-    m_symbol_buffer[m_pending_symbol_size].distance = 0;
-    m_symbol_buffer[m_pending_symbol_size++].literal = 256;
-    m_symbol_frequencies[256]++;
+    block.symbol_buffer[block.pending_symbol_size].distance = 0;
+    block.symbol_buffer[block.pending_symbol_size++].literal = 256;
+    block.symbol_frequencies[256]++;
 
     // generate optimal dynamic huffman code lengths
-    Array<u8, max_huffman_literals> dynamic_literal_bit_lengths {};
-    Array<u8, max_huffman_distances> dynamic_distance_bit_lengths {};
-    generate_huffman_lengths(dynamic_literal_bit_lengths, m_symbol_frequencies, 15); // deflate data huffman can use up to 15 bits per symbol
-    generate_huffman_lengths(dynamic_distance_bit_lengths, m_distance_frequencies, 15);
+    block.literal_bit_lengths.fill(0);
+    block.distance_bit_lengths.fill(0);
+    generate_huffman_lengths(block.literal_bit_lengths, block.symbol_frequencies, 15); // deflate data huffman can use up to 15 bits per symbol
+    generate_huffman_lengths(block.distance_bit_lengths, block.distance_frequencies, 15);
 
     // encode literal and distance lengths together in deflate format
-    Array<code_length_symbol, max_huffman_literals + max_huffman_distances> encoded_lengths {};
-    size_t literal_code_count;
-    size_t distance_code_count;
-    auto encoded_lengths_count = encode_block_lengths(dynamic_literal_bit_lengths, dynamic_distance_bit_lengths, encoded_lengths, literal_code_count, distance_code_count);
+    block.encoded_lengths_count = encode_block_lengths(block.literal_bit_lengths, block.distance_bit_lengths, block.encoded_lengths, block.literal_code_count, block.distance_code_count);
 
     // count code length frequencies
     Array<u16, 19> code_lengths_frequencies { 0 };
-    for (size_t i = 0; i < encoded_lengths_count; i++) {
-        code_lengths_frequencies[encoded_lengths[i].symbol]++;
+    for (size_t i = 0; i < block.encoded_lengths_count; i++) {
+        code_lengths_frequencies[block.encoded_lengths[i].symbol]++;
     }
     // generate optimal huffman code lengths code lengths
-    Array<u8, 19> code_lengths_bit_lengths {};
-    generate_huffman_lengths(code_lengths_bit_lengths, code_lengths_frequencies, 7); // deflate code length huffman can use up to 7 bits per symbol
+    block.code_lengths_bit_lengths.fill(0);
+    generate_huffman_lengths(block.code_lengths_bit_lengths, code_lengths_frequencies, 7); // deflate code length huffman can use up to 7 bits per symbol
     // calculate actual code length code lengths count (without trailing zeros)
-    auto code_lengths_count = code_lengths_bit_lengths.size();
-    while (code_lengths_bit_lengths[code_lengths_code_lengths_order[code_lengths_count - 1]] == 0)
-        code_lengths_count--;
+    block.code_lengths_count = block.code_lengths_bit_lengths.size();
+    while (block.code_lengths_bit_lengths[code_lengths_code_lengths_order[block.code_lengths_count - 1]] == 0)
+        block.code_lengths_count--;
+
+    block.fixed_huffman_size = fixed_block_length(block);
+    block.dynamic_huffman_size = dynamic_block_length(block, code_lengths_frequencies);
+}
+
+void DeflateCompressor::choose_block_type(Block& block, size_t start_bit_offset, bool is_final) const
+{
+    block.is_final = is_final;
+    block.start_bit_offset = start_bit_offset;
+
+    // if this is just an empty block to signify the end of the deflate stream use the smallest block possible (10 bits total)
+    if (block.size == 0) {
+        VERIFY(is_final); // we shouldn't be writing empty blocks unless this is the final one
+        block.type = BlockType::Empty;
+        block.size_in_bits = 3 + 7;
+        return;
+    }
 
-    auto uncompressed_size = uncompressed_block_length();
-    auto fixed_huffman_size = fixed_block_length();
-    auto dynamic_huffman_size = dynamic_block_length(dynamic_literal_bit_lengths, dynamic_distance_bit_lengths, code_lengths_bit_lengths, code_lengths_frequencies, code_lengths_count);
+    auto uncompressed_size = uncompressed_block_length(block, start_bit_offset);
 
     // If the compression somehow didn't reduce the size enough, just write out the block uncompressed as it allows for much faster decompression
-    if (uncompressed_size <= min(fixed_huffman_size, dynamic_huffman_size)) {
-        TRY(write_uncompressed());
-    } else if (fixed_huffman_size <= dynamic_huffman_size) {
+    if (m_compression_level == CompressionLevel::STORE || uncompressed_size <= min(block.fixed_huffman_size, block.dynamic_huffman_size)) {
+        block.type = BlockType::Uncompressed;
+        // 3 bit block header + align to byte + 2 * 16 bit length fields + block contents
+        block.size_in_bits = round_up_to_power_of_two(start_bit_offset + 3, 8) - start_bit_offset + (2 * 16) + block.size * 8;
+    } else if (block.fixed_huffman_size <= block.dynamic_huffman_size) {
         // If the fixed and dynamic huffman codes come out the same size, prefer the fixed version, as it takes less time to decode fixed huffman codes.
-        TRY(m_output_stream->write_bits(0b01u, 2));
-        TRY(write_huffman(CanonicalCode::fixed_literal_codes(), CanonicalCode::fixed_distance_codes()));
+        block.type = BlockType::FixedHuffman;
+        block.size_in_bits = block.fixed_huffman_size;
     } else {
-        // dynamic huffman codes
-        TRY(m_output_stream->write_bits(0b10u, 2));
-        auto literal_code = CanonicalCode::from_bytes(dynamic_literal_bit_lengths);
+        block.type = BlockType::DynamicHuffman;
+        block.size_in_bits = block.dynamic_huffman_size;
+    }
+}
+
+ErrorOr<void> DeflateCompressor::encode_block(Block& block) const
+{
+    block.encoded_data.clear();
+    TRY(block.encoded_data.try_resize(ceil_div(block.start_bit_offset + block.size_in_bits, static_cast<size_t>(8))));
+    auto memory_stream = TRY(FixedMemoryStream::construct(block.encoded_data.bytes()));
+    auto stream = TRY(LittleEndianOutputBitStream::construct(MaybeOwned<AK::Stream>(*memory_stream)));
+
+    // the block is encoded as if the bits of the previous block were there, so that it can be put right after them
+    TRY(stream->write_bits(0u, block.start_bit_offset));
+    TRY(stream->write_bits(block.is_final, 1));
+
+    switch (block.type) {
+    case BlockType::Empty:
+        TRY(stream->write_bits(0b01u, 2));      // fixed huffman codes
+        TRY(stream->write_bits(0b0000000u, 7)); // end of block symbol
+        break;
+    case BlockType::Uncompressed: {
+        TRY(stream->write_bits(0b00u, 2)); // no compression
+        TRY(stream->align_to_byte_boundary());
+        LittleEndian<u16> len = block.size;
+        TRY(stream->write_entire_buffer(len.bytes()));
+        LittleEndian<u16> nlen = ~block.size;
+        TRY(stream->write_entire_buffer(nlen.bytes()));
+        TRY(stream->write_entire_buffer({ block.window + block_size, block.size }));
+        break;
+    }
+    case BlockType::FixedHuffman:
+        TRY(stream->write_bits(0b01u, 2));
+        TRY(write_huffman(*stream, block, CanonicalCode::fixed_literal_codes(), CanonicalCode::fixed_distance_codes()));
+        break;
+    case BlockType::DynamicHuffman: {
+        TRY(stream->write_bits(0b10u, 2));
+        auto literal_code = CanonicalCode::from_bytes(block.literal_bit_lengths);
         VERIFY(literal_code.has_value());
-        auto distance_code = CanonicalCode::from_bytes(dynamic_distance_bit_lengths);
-        TRY(write_dynamic_huffman(literal_code.value(), literal_code_count, distance_code, distance_code_count, code_lengths_bit_lengths, code_lengths_count, encoded_lengths, encoded_lengths_count));
+        auto distance_code = CanonicalCode::from_bytes(block.distance_bit_lengths);
+        TRY(write_dynamic_huffman(*stream, block, literal_code.value(), distance_code));
+        break;
     }
-    if (m_finished)
+    }
+
+    VERIFY(memory_stream->offset() * 8 + stream->bit_offset() == block.start_bit_offset + block.size_in_bits);
+    TRY(stream->align_to_byte_boundary());
+    return {};
+}
+
+ErrorOr<void> DeflateCompressor::write_block(Block const& block)
+{
+    VERIFY(m_output_stream->bit_offset() == block.start_bit_offset);
+    auto data = block.encoded_data.bytes();
+    auto remaining_bits = block.size_in_bits;
+
+    // the first byte is shared with the end of the previous block
+    if (block.start_bit_offset != 0) {
+        auto bit_count = min(8 - block.start_bit_offset, remaining_bits);
+        TRY(m_output_stream->write_bits(static_cast<u8>(data[0] >> block.start_bit_offset), bit_count));
+        remaining_bits -= bit_count;
+        data = data.slice(1);
+    }
+
+    auto whole_byte_count = remaining_bits / 8;
+    if (whole_byte_count > 0)
+        TRY(m_output_stream->write_entire_buffer(data.trim(whole_byte_count)));
+    if (remaining_bits % 8 != 0)
+        TRY(m_output_stream->write_bits(data[whole_byte_count], remaining_bits % 8));
+
+    if (block.is_final)
         TRY(m_output_stream->align_to_byte_boundary());
+    return {};
+}
 
-    // reset all block specific members
-    m_pending_block_size = 0;
-    m_pending_symbol_size = 0;
-    m_symbol_frequencies.fill(0);
-    m_distance_frequencies.fill(0);
-    // On the final block this copy will potentially produce an invalid search window, but since its the final block we dont care
-    pending_block().copy_trimmed_to({ m_rolling_window, block_size });
+ErrorOr<void> DeflateCompressor::finish_block()
+{
+    auto& finished_block = *m_blocks[m_current_block++];
+    if (m_current_block == m_blocks.size())
+        TRY(flush());
+
+    // the finished block becomes the dictionary of the next one
+    auto& next_block = *m_blocks[m_current_block];
+    finished_block.data().copy_to({ next_block.window, block_size });
+    next_block.dictionary_size = finished_block.size;
+    next_block.size = 0;
+    return {};
+}
+
+ErrorOr<void> DeflateCompressor::flush()
+{
+    // all the blocks before the current one are full, and on the final flush the current one is the last one
+    auto block_count = m_current_block;
+    if (m_finished)
+        block_count++;
+    m_current_block = 0;
+
+    auto for_each_block = [&](auto callback) {
+        if (block_count == 1) {
+            callback(0);
+            return;
+        }
+        Threading::ThreadPool::the().parallel_for(block_count, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                callback(i);
+        });
+    };
 
+    if (m_compression_level != CompressionLevel::STORE)
+        for_each_block([&](size_t i) { compress_block(*m_blocks[i]); });
+
+    // every block starts where the previous one ended, so we can only choose how to encode them one after another
+    auto bit_offset = m_output_stream->bit_offset();
+    for (size_t i = 0; i < block_count; ++i) {
+        auto& block = *m_blocks[i];
+        choose_block_type(block, bit_offset, m_finished && i == block_count - 1);
+        bit_offset = (bit_offset + block.size_in_bits) % 8;
+    }
+
+    Vector<Optional<Error>> encoding_errors;
+    TRY(encoding_errors.try_resize(block_count));
+    for_each_block([&](size_t i) {
+        auto result = encode_block(*m_blocks[i]);
+        if (result.is_error())
+            encoding_errors[i] = result.release_error();
+    });
+
+    for (size_t i = 0; i < block_count; ++i) {
+        if (encoding_errors[i].has_value())
+            return encoding_errors[i].release_value();
+        TRY(write_block(*m_blocks[i]));
+    }
     return {};
 }
 
@@ -1015,10 +1101,10 @@ ErrorOr<void> DeflateCompressor::final_flush()
     return {};
 }
 
-ErrorOr<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, CompressionLevel compression_level)
+ErrorOr<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, CompressionLevel compression_level, UseThreadPool use_thread_pool)
 {
     auto output_stream = TRY(try_make<AllocatingMemoryStream>());
-    auto deflate_stream = TRY(DeflateCompressor::construct(MaybeOwned<AK::Stream>(*output_stream), compression_level));
+    auto deflate_stream = TRY(DeflateCompressor::construct(MaybeOwned<AK::Stream>(*output_stream), compression_level, use_thread_pool));
 
     TRY(deflate_stream->write_entire_buffer(bytes));
     TRY(deflate_stream->final_flush());
@@ -11,6 +11,7 @@
 #include <AK/Endian.h>
 #include <AK/Forward.h>
 #include <AK/MaybeOwned.h>
+#include <AK/NonnullOwnPtr.h>
 #include <AK/Vector.h>
 #include <LibCompress/DeflateTables.h>
 #include <LibCore/Stream.h>
@@ -29,7 +30,21 @@ public:
     static Optional<CanonicalCode> from_bytes(ReadonlyBytes);
 
 private:
-    // Decompression - indexed by code
+    void fill_prefix_table(u32 symbol);
+
+    static constexpr size_t max_code_length = 15;
+    static constexpr size_t prefix_table_bits = 9;
+
+    struct PrefixTableEntry {
+        u16 symbol_value { 0 };
+        u16 code_length { 0 };
+    };
+
+    // Decompression - indexed by the next prefix_table_bits bits of input, which resolves every code that is no longer
+    // than that in a single lookup. Entries with a code length of 0 belong to longer codes.
+    Array<PrefixTableEntry, 1 << prefix_table_bits> m_prefix_table {};
+
+    // Decompression - indexed by code, only needed for codes that are too long for the prefix table
     Vector<u16> m_symbol_codes;
     Vector<u16> m_symbol_values;
 
@@ -76,6 +91,9 @@ public:
     friend UncompressedBlock;
 
     static ErrorOr<NonnullOwnPtr<DeflateDecompressor>> construct(MaybeOwned<AK::Stream> stream);
+    // Note: The bit stream may read ahead of the end of the deflate stream, so anything that follows it has to be read
+    //       through the same bit stream.
+    static ErrorOr<NonnullOwnPtr<DeflateDecompressor>> construct(MaybeOwned<LittleEndianInputBitStream> stream);
     ~DeflateDecompressor();
 
     virtual ErrorOr<Bytes> read(Bytes) override;
@@ -87,7 +105,7 @@ public:
     static ErrorOr<ByteBuffer> decompress_all(ReadonlyBytes);
 
 private:
-    DeflateDecompressor(MaybeOwned<AK::Stream> stream, CircularBuffer buffer);
+    DeflateDecompressor(MaybeOwned<LittleEndianInputBitStream> stream, CircularBuffer buffer);
 
     ErrorOr<u32> decode_length(u32);
     ErrorOr<u32> decode_distance(u32);
@@ -112,8 +130,9 @@ public:
     static constexpr size_t hash_bits = 15;
     static constexpr size_t max_huffman_literals = 288;
     static constexpr size_t max_huffman_distances = 32;
-    static constexpr size_t min_match_length = 4;   // matches smaller than these are not worth the size of the back reference
-    static constexpr size_t max_match_length = 258; // matches longer than these cannot be encoded using huffman codes
+    static constexpr size_t min_match_length = 4;    // matches smaller than these are not worth the size of the back reference
+    static constexpr size_t max_match_length = 258;  // matches longer than these cannot be encoded using huffman codes
+    static constexpr size_t max_distance = 32 * KiB; // back references cannot reach further than this
     static constexpr u16 empty_slot = UINT16_MAX;
 
     struct CompressionConstants {
@@ -140,7 +159,13 @@ public:
         BEST // WARNING: this one can take an unreasonable amount of time!
     };
 
-    static ErrorOr<NonnullOwnPtr<DeflateCompressor>> construct(MaybeOwned<AK::Stream>, CompressionLevel = CompressionLevel::GOOD);
+    // Blocks can be compressed on the shared thread pool, several of them at once. The output is the same either way.
+    enum class UseThreadPool {
+        No,
+        Yes,
+    };
+
+    static ErrorOr<NonnullOwnPtr<DeflateCompressor>> construct(MaybeOwned<AK::Stream>, CompressionLevel = CompressionLevel::GOOD, UseThreadPool = UseThreadPool::No);
     ~DeflateCompressor();
 
     virtual ErrorOr<Bytes> read(Bytes) override;
@@ -150,36 +175,93 @@ public:
     virtual void close() override;
     ErrorOr<void> final_flush();
 
-    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD);
+    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD, UseThreadPool = UseThreadPool::No);
 
 private:
-    DeflateCompressor(NonnullOwnPtr<LittleEndianOutputBitStream>, CompressionLevel = CompressionLevel::GOOD);
+    struct code_length_symbol {
+        u8 symbol;
+        u8 count; // used for special symbols 16-18
+    };
+
+    enum class BlockType {
+        Empty,
+        Uncompressed,
+        FixedHuffman,
+        DynamicHuffman,
+    };
+
+    // Everything that is needed to compress one block, so that several blocks can be compressed at once.
+    struct Block {
+        Bytes data() { return { window + block_size, block_size }; }
+
+        // The previous block followed by this one, so that back references can reach into the previous block.
+        u8 window[window_size];
+        size_t dictionary_size { 0 };
+        size_t size { 0 };
+
+        struct [[gnu::packed]] {
+            u16 distance; // back reference length
+            union {
+                u16 literal; // literal byte or on of block symbol
+                u16 length;  // back reference length (if distance != 0)
+            };
+        } symbol_buffer[block_size + 1];
+        size_t pending_symbol_size { 0 };
+        Array<u16, max_huffman_literals> symbol_frequencies;    // there are 286 valid symbol values (symbols 286-287 never occur)
+        Array<u16, max_huffman_distances> distance_frequencies; // there are 30 valid distance values (distances 30-31 never occur)
+
+        // LZ77 Chained hash table
+        u16 hash_head[1 << hash_bits];
+        u16 hash_prev[window_size];
+
+        // Huffman codes for the block, and how long it would be with them
+        Array<u8, max_huffman_literals> literal_bit_lengths;
+        Array<u8, max_huffman_distances> distance_bit_lengths;
+        Array<code_length_symbol, max_huffman_literals + max_huffman_distances> encoded_lengths;
+        size_t encoded_lengths_count { 0 };
+        size_t literal_code_count { 0 };
+        size_t distance_code_count { 0 };
+        Array<u8, 19> code_lengths_bit_lengths;
+        size_t code_lengths_count { 0 };
+        size_t fixed_huffman_size { 0 };
+        size_t dynamic_huffman_size { 0 };
+
+        // How the block is written out, which depends on where the previous block ended
+        BlockType type { BlockType::Uncompressed };
+        bool is_final { false };
+        size_t start_bit_offset { 0 };
+        size_t size_in_bits { 0 };
+        // The encoded block, with the bits before start_bit_offset in its first byte left zero
+        ByteBuffer encoded_data;
+    };
 
-    Bytes pending_block() { return { m_rolling_window + block_size, block_size }; }
+    DeflateCompressor(NonnullOwnPtr<LittleEndianOutputBitStream>, CompressionLevel, Vector<NonnullOwnPtr<Block>>);
 
     // LZ77 Compression
     static u16 hash_sequence(u8 const* bytes);
-    size_t compare_match_candidate(size_t start, size_t candidate, size_t prev_match_length, size_t max_match_length);
-    size_t find_back_match(size_t start, u16 hash, size_t previous_match_length, size_t max_match_length, size_t& match_position);
-    void lz77_compress_block();
+    static size_t compare_match_candidate(Block const&, size_t start, size_t candidate, size_t prev_match_length, size_t max_match_length);
+    size_t find_back_match(Block const&, size_t start, u16 hash, size_t previous_match_length, size_t max_match_length, size_t& match_position) const;
+    void lz77_compress_block(Block&) const;
 
     // Huffman Coding
-    struct code_length_symbol {
-        u8 symbol;
-        u8 count; // used for special symbols 16-18
-    };
     static u8 distance_to_base(u16 distance);
-    template<size_t Size>
-    static void generate_huffman_lengths(Array<u8, Size>& lengths, Array<u16, Size> const& frequencies, size_t max_bit_length, u16 frequency_cap = UINT16_MAX);
-    size_t huffman_block_length(Array<u8, max_huffman_literals> const& literal_bit_lengths, Array<u8, max_huffman_distances> const& distance_bit_lengths);
-    ErrorOr<void> write_huffman(CanonicalCode const& literal_code, Optional<CanonicalCode> const& distance_code);
+    static size_t huffman_block_length(Block const&, Array<u8, max_huffman_literals> const& literal_bit_lengths, Array<u8, max_huffman_distances> const& distance_bit_lengths);
+    static ErrorOr<void> write_huffman(LittleEndianOutputBitStream&, Block const&, CanonicalCode const& literal_code, Optional<CanonicalCode> const& distance_code);
     static size_t encode_huffman_lengths(Array<u8, max_huffman_literals + max_huffman_distances> const& lengths, size_t lengths_count, Array<code_length_symbol, max_huffman_literals + max_huffman_distances>& encoded_lengths);
-    size_t encode_block_lengths(Array<u8, max_huffman_literals> const& literal_bit_lengths, Array<u8, max_huffman_distances> const& distance_bit_lengths, Array<code_length_symbol, max_huffman_literals + max_huffman_distances>& encoded_lengths, size_t& literal_code_count, size_t& distance_code_count);
-    ErrorOr<void> write_dynamic_huffman(CanonicalCode const& literal_code, size_t literal_code_count, Optional<CanonicalCode> const& distance_code, size_t distance_code_count, Array<u8, 19> const& code_lengths_bit_lengths, size_t code_length_count, Array<code_length_symbol, max_huffman_literals + max_huffman_distances> const& encoded_lengths, size_t encoded_lengths_count);
-
-    size_t uncompressed_block_length();
-    size_t fixed_block_length();
-    size_t dynamic_block_length(Array<u8, max_huffman_literals> const& literal_bit_lengths, Array<u8, max_huffman_distances> const& distance_bit_lengths, Array<u8, 19> const& code_lengths_bit_lengths, Array<u16, 19> const& code_lengths_frequencies, size_t code_lengths_count);
+    static size_t encode_block_lengths(Array<u8, max_huffman_literals> const& literal_bit_lengths, Array<u8, max_huffman_distances> const& distance_bit_lengths, Array<code_length_symbol, max_huffman_literals + max_huffman_distances>& encoded_lengths, size_t& literal_code_count, size_t& distance_code_count);
+    static ErrorOr<void> write_dynamic_huffman(LittleEndianOutputBitStream&, Block const&, CanonicalCode const& literal_code, Optional<CanonicalCode> const& distance_code);
+
+    static size_t uncompressed_block_length(Block const&, size_t bit_offset);
+    static size_t fixed_block_length(Block const&);
+    static size_t dynamic_block_length(Block const&, Array<u16, 19> const& code_lengths_frequencies);
+
+    // Compressing and encoding a block only depend on the block itself, so they can happen on any thread. Only choosing
+    // how each block is encoded and writing them out have to happen in order.
+    void compress_block(Block&) const;
+    void choose_block_type(Block&, size_t start_bit_offset, bool is_final) const;
+    ErrorOr<void> encode_block(Block&) const;
+    ErrorOr<void> write_block(Block const&);
+    ErrorOr<void> finish_block();
     ErrorOr<void> flush();
 
     bool m_finished { false };
@@ -187,23 +269,10 @@ private:
     CompressionConstants m_compression_constants;
     NonnullOwnPtr<LittleEndianOutputBitStream> m_output_stream;
 
-    u8 m_rolling_window[window_size];
-    size_t m_pending_block_size { 0 };
-
-    struct [[gnu::packed]] {
-        u16 distance; // back reference length
-        union {
-            u16 literal; // literal byte or on of block symbol
-            u16 length;  // back reference length (if distance != 0)
-        };
-    } m_symbol_buffer[block_size + 1];
-    size_t m_pending_symbol_size { 0 };
-    Array<u16, max_huffman_literals> m_symbol_frequencies;    // there are 286 valid symbol values (symbols 286-287 never occur)
-    Array<u16, max_huffman_distances> m_distance_frequencies; // there are 30 valid distance values (distances 30-31 never occur)
-
-    // LZ77 Chained hash table
-    u16 m_hash_head[1 << hash_bits];
-    u16 m_hash_prev[window_size];
+    // One block to compress at a time, or one for every thread of the pool and one for this one.
+    Vector<NonnullOwnPtr<Block>> m_blocks;
+    // The blocks before this one are full and waiting to be compressed, this one is being filled.
+    size_t m_current_block { 0 };
 };
 
 }
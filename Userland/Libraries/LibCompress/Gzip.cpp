@@ -38,9 +38,9 @@ bool BlockHeader::supported_by_implementation() const
     return true;
 }
 
-ErrorOr<NonnullOwnPtr<GzipDecompressor::Member>> GzipDecompressor::Member::construct(BlockHeader header, AK::Stream& stream)
+ErrorOr<NonnullOwnPtr<GzipDecompressor::Member>> GzipDecompressor::Member::construct(BlockHeader header, LittleEndianInputBitStream& stream)
 {
-    auto deflate_stream = TRY(DeflateDecompressor::construct(MaybeOwned<AK::Stream>(stream)));
+    auto deflate_stream = TRY(DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream>(stream)));
     return TRY(adopt_nonnull_own_or_enomem(new (nothrow) Member(header, move(deflate_stream))));
 }
 
@@ -50,8 +50,8 @@ GzipDecompressor::Member::Member(BlockHeader header, NonnullOwnPtr<DeflateDecomp
 {
 }
 
-GzipDecompressor::GzipDecompressor(NonnullOwnPtr<AK::Stream> stream)
-    : m_input_stream(move(stream))
+GzipDecompressor::GzipDecompressor(MaybeOwned<AK::Stream> stream)
+    : m_input_stream(make<LittleEndianInputBitStream>(move(stream)))
 {
 }
 
@@ -186,8 +186,10 @@ ErrorOr<size_t> GzipDecompressor::write(ReadonlyBytes)
     return Error::from_errno(EBADF);
 }
 
-GzipCompressor::GzipCompressor(MaybeOwned<AK::Stream> stream)
+GzipCompressor::GzipCompressor(MaybeOwned<AK::Stream> stream, DeflateCompressor::CompressionLevel compression_level, DeflateCompressor::UseThreadPool use_thread_pool)
     : m_output_stream(move(stream))
+    , m_compression_level(compression_level)
+    , m_use_thread_pool(use_thread_pool)
 {
 }
 
@@ -207,7 +209,7 @@ ErrorOr<size_t> GzipCompressor::write(ReadonlyBytes bytes)
     header.extra_flags = 3;      // DEFLATE sets 2 for maximum compression and 4 for minimum compression
     header.operating_system = 3; // unix
     TRY(m_output_stream->write_entire_buffer({ &header, sizeof(header) }));
-    auto compressed_stream = TRY(DeflateCompressor::construct(MaybeOwned(*m_output_stream)));
+    auto compressed_stream = TRY(DeflateCompressor::construct(MaybeOwned(*m_output_stream), m_compression_level, m_use_thread_pool));
     TRY(compressed_stream->write_entire_buffer(bytes));
     TRY(compressed_stream->final_flush());
     Crypto::Checksum::CRC32 crc32;
@@ -233,10 +235,10 @@ void GzipCompressor::close()
 {
 }
 
-ErrorOr<ByteBuffer> GzipCompressor::compress_all(ReadonlyBytes bytes)
+ErrorOr<ByteBuffer> GzipCompressor::compress_all(ReadonlyBytes bytes, DeflateCompressor::CompressionLevel compression_level, DeflateCompressor::UseThreadPool use_thread_pool)
 {
     auto output_stream = TRY(try_make<AllocatingMemoryStream>());
-    GzipCompressor gzip_stream { MaybeOwned<AK::Stream>(*output_stream) };
+    GzipCompressor gzip_stream { MaybeOwned<AK::Stream>(*output_stream), compression_level, use_thread_pool };
 
     TRY(gzip_stream.write_entire_buffer(bytes));
 
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <AK/BitStream.h>
 #include <LibCompress/Deflate.h>
 #include <LibCore/Stream.h>
 #include <LibCrypto/Checksum/CRC32.h>
@@ -40,7 +41,7 @@ struct Flags {
 
 class GzipDecompressor final : public AK::Stream {
 public:
-    GzipDecompressor(NonnullOwnPtr<AK::Stream>);
+    GzipDecompressor(MaybeOwned<AK::Stream>);
     ~GzipDecompressor();
 
     virtual ErrorOr<Bytes> read(Bytes) override;
@@ -56,7 +57,7 @@ public:
 private:
     class Member {
     public:
-        static ErrorOr<NonnullOwnPtr<Member>> construct(BlockHeader header, AK::Stream&);
+        static ErrorOr<NonnullOwnPtr<Member>> construct(BlockHeader header, LittleEndianInputBitStream&);
 
         BlockHeader m_header;
         NonnullOwnPtr<DeflateDecompressor> m_stream;
@@ -70,7 +71,8 @@ private:
     Member const& current_member() const { return *m_current_member; }
     Member& current_member() { return *m_current_member; }
 
-    NonnullOwnPtr<AK::Stream> m_input_stream;
+    // Note: The deflate stream may read ahead of its end, so everything is read through the same bit stream.
+    NonnullOwnPtr<LittleEndianInputBitStream> m_input_stream;
     u8 m_partial_header[sizeof(BlockHeader)];
     size_t m_partial_header_offset { 0 };
     OwnPtr<Member> m_current_member {};
@@ -80,7 +82,7 @@ private:
 
 class GzipCompressor final : public AK::Stream {
 public:
-    GzipCompressor(MaybeOwned<AK::Stream>);
+    GzipCompressor(MaybeOwned<AK::Stream>, DeflateCompressor::CompressionLevel = DeflateCompressor::CompressionLevel::GOOD, DeflateCompressor::UseThreadPool = DeflateCompressor::UseThreadPool::No);
 
     virtual ErrorOr<Bytes> read(Bytes) override;
     virtual ErrorOr<size_t> write(ReadonlyBytes) override;
@@ -88,10 +90,12 @@ public:
     virtual bool is_open() const override;
     virtual void close() override;
 
-    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes);
+    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes, DeflateCompressor::CompressionLevel = DeflateCompressor::CompressionLevel::GOOD, DeflateCompressor::UseThreadPool = DeflateCompressor::UseThreadPool::No);
 
 private:
     MaybeOwned<AK::Stream> m_output_stream;
+    DeflateCompressor::CompressionLevel m_compression_level;
+    DeflateCompressor::UseThreadPool m_use_thread_pool;
 };
 
 }
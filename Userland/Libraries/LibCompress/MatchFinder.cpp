@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BuiltinWrappers.h>
+#include <AK/Endian.h>
+#include <LibCompress/MatchFinder.h>
+#include <string.h>
+
+namespace Compress {
+
+ErrorOr<void> MatchFinder::reset(size_t buffer_size)
+{
+    TRY(m_hash_head.try_resize(1 << hash_bits));
+    TRY(m_hash_previous.try_resize(buffer_size));
+    m_hash_head.span().fill(empty_slot);
+    return {};
+}
+
+u32 MatchFinder::hash_at(ReadonlyBytes buffer, size_t position)
+{
+    u32 bytes;
+    memcpy(&bytes, buffer.offset_pointer(position), sizeof(bytes));
+    return (bytes * 2654435761u) >> (32 - hash_bits);
+}
+
+void MatchFinder::insert(ReadonlyBytes buffer, size_t position)
+{
+    if (position + min_match_length > buffer.size())
+        return;
+
+    auto hash = hash_at(buffer, position);
+    m_hash_previous[position] = m_hash_head[hash];
+    m_hash_head[hash] = position;
+}
+
+static size_t common_prefix_length(u8 const* a, u8 const* b, size_t max_length)
+{
+    size_t length = 0;
+    while (length + sizeof(u64) <= max_length) {
+        u64 a_bytes, b_bytes;
+        memcpy(&a_bytes, a + length, sizeof(u64));
+        memcpy(&b_bytes, b + length, sizeof(u64));
+        auto difference = AK::convert_between_host_and_little_endian(a_bytes ^ b_bytes);
+        if (difference != 0)
+            return length + count_trailing_zeroes(difference) / 8;
+        length += sizeof(u64);
+    }
+    while (length < max_length && a[length] == b[length])
+        ++length;
+    return length;
+}
+
+MatchFinder::Match MatchFinder::find_longest_match(ReadonlyBytes buffer, size_t position, size_t max_distance, size_t max_length) const
+{
+    max_length = min(max_length, buffer.size() - position);
+    if (max_length < min_match_length)
+        return {};
+
+    Match best_match;
+    auto candidate = m_hash_head[hash_at(buffer, position)];
+    for (size_t chain_length = 0; candidate != empty_slot && chain_length < m_max_chain_length; ++chain_length) {
+        VERIFY(candidate < position);
+        auto distance = position - candidate;
+        if (distance > max_distance)
+            break;
+
+        // Only candidates that beat the best match so far in its last byte are worth comparing in full.
+        if (buffer[candidate + best_match.length] == buffer[position + best_match.length]) {
+            auto length = common_prefix_length(buffer.offset_pointer(candidate), buffer.offset_pointer(position), max_length);
+            if (length > best_match.length) {
+                best_match = { length, distance };
+                if (length == max_length)
+                    break;
+            }
+        }
+
+        candidate = m_hash_previous[candidate];
+    }
+
+    if (best_match.length < min_match_length)
+        return {};
+    return best_match;
+}
+
+}
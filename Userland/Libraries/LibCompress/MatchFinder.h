@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
+
+namespace Compress {
+
+// Finds earlier occurrences of the bytes at a position in a buffer through hash chains, for the LZ77 stages of the
+// Brotli and Zstandard compressors. Positions are offsets into the buffer that is being compressed, which may start
+// with data from a previous block that matches are allowed to refer to.
+class MatchFinder {
+public:
+    static constexpr size_t min_match_length = 4;
+
+    struct Match {
+        size_t length { 0 };
+        size_t distance { 0 };
+    };
+
+    explicit MatchFinder(size_t max_chain_length)
+        : m_max_chain_length(max_chain_length)
+    {
+    }
+
+    ErrorOr<void> reset(size_t buffer_size);
+    void insert(ReadonlyBytes buffer, size_t position);
+
+    // Returns the longest match that is no further away than max_distance and no longer than max_length, or a match of
+    // length 0 if there is none that is at least min_match_length bytes long.
+    Match find_longest_match(ReadonlyBytes buffer, size_t position, size_t max_distance, size_t max_length) const;
+
+private:
+    static constexpr size_t hash_bits = 15;
+    static constexpr u32 empty_slot = NumericLimits<u32>::max();
+
+    static u32 hash_at(ReadonlyBytes buffer, size_t position);
+
+    size_t m_max_chain_length { 0 };
+    Vector<u32> m_hash_head;
+    Vector<u32> m_hash_previous;
+};
+
+}
@@ -51,6 +51,13 @@ Optional<ByteBuffer> ZlibDecompressor::decompress()
     return buffer_or_error.release_value();
 }
 
+ErrorOr<NonnullOwnPtr<AK::Stream>> ZlibDecompressor::decompression_stream()
+{
+    auto memory_stream = TRY(FixedMemoryStream::construct(m_data_bytes));
+    auto deflate_stream = TRY(DeflateDecompressor::construct(move(memory_stream)));
+    return NonnullOwnPtr<AK::Stream> { move(deflate_stream) };
+}
+
 Optional<ByteBuffer> ZlibDecompressor::decompress_all(ReadonlyBytes bytes)
 {
     auto zlib = try_create(bytes);
@@ -46,6 +46,8 @@ static_assert(sizeof(ZlibHeader) == sizeof(u16));
 class ZlibDecompressor {
 public:
     Optional<ByteBuffer> decompress();
+    // Returns a stream that decompresses the data as it is read, instead of all at once.
+    ErrorOr<NonnullOwnPtr<AK::Stream>> decompression_stream();
     u32 checksum();
 
     static Optional<ZlibDecompressor> try_create(ReadonlyBytes data);
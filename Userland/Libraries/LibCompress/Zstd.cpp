@@ -0,0 +1,1561 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/BuiltinWrappers.h>
+#include <AK/Endian.h>
+#include <AK/Math.h>
+#include <AK/MemoryStream.h>
+#include <LibCompress/Huffman.h>
+#include <LibCompress/Zstd.h>
+#include <string.h>
+
+namespace Compress {
+
+static constexpr u32 frame_magic = 0xFD2FB528;
+static constexpr u32 skippable_frame_magic = 0x184D2A50;
+static constexpr u32 skippable_frame_magic_mask = 0xFFFFFFF0;
+
+static constexpr size_t maximum_block_size = 128 * KiB;
+// Note: Encoders are allowed to ask for windows of up to 3.75 TiB, but the reference decoder refuses anything above
+//       128 MiB by default as well, and we have to keep the entire window around.
+static constexpr size_t maximum_window_size = 128 * MiB;
+
+static constexpr size_t maximum_huffman_bit_count = 11;
+static constexpr size_t maximum_huffman_weight_count = 255;
+
+static constexpr size_t literal_length_code_count = 36;
+static constexpr size_t match_length_code_count = 53;
+static constexpr size_t offset_code_count = 32;
+
+static constexpr size_t maximum_literal_length_accuracy_log = 9;
+static constexpr size_t maximum_match_length_accuracy_log = 9;
+static constexpr size_t maximum_offset_accuracy_log = 8;
+
+struct LengthCode {
+    u32 baseline;
+    u8 extra_bits;
+};
+
+static constexpr Array<LengthCode, literal_length_code_count> literal_length_codes { {
+    { 0, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 4, 0 }, { 5, 0 }, { 6, 0 }, { 7, 0 },
+    { 8, 0 }, { 9, 0 }, { 10, 0 }, { 11, 0 }, { 12, 0 }, { 13, 0 }, { 14, 0 }, { 15, 0 },
+    { 16, 1 }, { 18, 1 }, { 20, 1 }, { 22, 1 }, { 24, 2 }, { 28, 2 }, { 32, 3 }, { 40, 3 },
+    { 48, 4 }, { 64, 6 }, { 128, 7 }, { 256, 8 }, { 512, 9 }, { 1024, 10 }, { 2048, 11 }, { 4096, 12 },
+    { 8192, 13 }, { 16384, 14 }, { 32768, 15 }, { 65536, 16 },
+} };
+
+static constexpr Array<LengthCode, match_length_code_count> match_length_codes { {
+    { 3, 0 }, { 4, 0 }, { 5, 0 }, { 6, 0 }, { 7, 0 }, { 8, 0 }, { 9, 0 }, { 10, 0 },
+    { 11, 0 }, { 12, 0 }, { 13, 0 }, { 14, 0 }, { 15, 0 }, { 16, 0 }, { 17, 0 }, { 18, 0 },
+    { 19, 0 }, { 20, 0 }, { 21, 0 }, { 22, 0 }, { 23, 0 }, { 24, 0 }, { 25, 0 }, { 26, 0 },
+    { 27, 0 }, { 28, 0 }, { 29, 0 }, { 30, 0 }, { 31, 0 }, { 32, 0 }, { 33, 0 }, { 34, 0 },
+    { 35, 1 }, { 37, 1 }, { 39, 1 }, { 41, 1 }, { 43, 2 }, { 47, 2 }, { 51, 3 }, { 59, 3 },
+    { 67, 4 }, { 83, 4 }, { 99, 5 }, { 131, 7 }, { 259, 8 }, { 515, 9 }, { 1027, 10 }, { 2051, 11 },
+    { 4099, 12 }, { 8195, 13 }, { 16387, 14 }, { 32771, 15 }, { 65539, 16 },
+} };
+
+// The distributions that the "Predefined_Mode" refers to, see RFC 8878, section 3.1.1.3.2.2.
+static constexpr size_t predefined_literal_length_accuracy_log = 6;
+static constexpr Array<i16, literal_length_code_count> predefined_literal_length_distribution { {
+    4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1,
+    -1, -1, -1, -1,
+} };
+
+static constexpr size_t predefined_match_length_accuracy_log = 6;
+static constexpr Array<i16, match_length_code_count> predefined_match_length_distribution { {
+    1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1,
+    -1, -1, -1, -1, -1,
+} };
+
+static constexpr size_t predefined_offset_accuracy_log = 5;
+static constexpr Array<i16, 29> predefined_offset_distribution { {
+    1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1,
+} };
+
+static size_t highest_bit_index(u32 value)
+{
+    VERIFY(value != 0);
+    return 31 - count_leading_zeroes(value);
+}
+
+// FSE and Huffman coded data is written forwards but read backwards, starting right below the highest set bit of the
+// last byte. Reading past the start of the data yields zero bits, which the end of some streams depend on.
+class ReverseBitStream {
+public:
+    static ErrorOr<ReverseBitStream> create(ReadonlyBytes bytes)
+    {
+        if (bytes.is_empty() || bytes.last() == 0)
+            return Error::from_string_literal("Bitstream is missing its end marker");
+        return ReverseBitStream { bytes, static_cast<i64>((bytes.size() - 1) * 8 + highest_bit_index(bytes.last())) };
+    }
+
+    u64 peek_bits(size_t count) const
+    {
+        VERIFY(count <= 56);
+        if (m_bits_remaining >= static_cast<i64>(count))
+            return bits_at(m_bits_remaining - count, count);
+        if (m_bits_remaining <= 0)
+            return 0;
+        return bits_at(0, m_bits_remaining) << (count - m_bits_remaining);
+    }
+
+    void discard_bits(size_t count) { m_bits_remaining -= count; }
+
+    u64 read_bits(size_t count)
+    {
+        if (count == 0)
+            return 0;
+        auto bits = peek_bits(count);
+        discard_bits(count);
+        return bits;
+    }
+
+    bool is_empty() const { return m_bits_remaining == 0; }
+    bool is_overflowed() const { return m_bits_remaining < 0; }
+
+private:
+    ReverseBitStream(ReadonlyBytes bytes, i64 bits_remaining)
+        : m_bytes(bytes)
+        , m_bits_remaining(bits_remaining)
+    {
+    }
+
+    u64 bits_at(size_t bit_offset, size_t count) const
+    {
+        size_t byte_offset = bit_offset / 8;
+        u64 bytes = 0;
+        memcpy(&bytes, m_bytes.offset_pointer(byte_offset), min(sizeof(bytes), m_bytes.size() - byte_offset));
+        bytes = AK::convert_between_host_and_little_endian(bytes);
+        return (bytes >> (bit_offset % 8)) & ((1ull << count) - 1);
+    }
+
+    ReadonlyBytes m_bytes;
+    i64 m_bits_remaining { 0 };
+};
+
+// Collects bits from the lowest bit of each byte upwards. Streams that are meant for ReverseBitStream are terminated
+// by an end marker, FSE table descriptions are not.
+class BitWriter {
+public:
+    void write_bits(u64 value, size_t count)
+    {
+        VERIFY(count <= 32);
+        m_bit_buffer |= (value & ((1ull << count) - 1)) << m_bit_count;
+        m_bit_count += count;
+        while (m_bit_count >= 8) {
+            m_bytes.append(static_cast<u8>(m_bit_buffer));
+            m_bit_buffer >>= 8;
+            m_bit_count -= 8;
+        }
+    }
+
+    void write_end_marker() { write_bits(1, 1); }
+
+    Vector<u8> finish()
+    {
+        if (m_bit_count > 0)
+            m_bytes.append(static_cast<u8>(m_bit_buffer));
+        m_bit_buffer = 0;
+        m_bit_count = 0;
+        return move(m_bytes);
+    }
+
+private:
+    Vector<u8> m_bytes;
+    u64 m_bit_buffer { 0 };
+    size_t m_bit_count { 0 };
+};
+
+// Distributes the symbols over the table in the order that both the encoder and the decoder agree on, see RFC 8878,
+// section 4.1.1. Symbols with a probability of "less than 1" get a single slot at the very end of the table.
+static ErrorOr<Vector<u16>> spread_symbols(Span<i16 const> distribution, size_t accuracy_log)
+{
+    size_t table_size = 1u << accuracy_log;
+    Vector<u16> symbols;
+    TRY(symbols.try_resize(table_size));
+
+    size_t high_threshold = table_size - 1;
+    for (size_t symbol = 0; symbol < distribution.size(); ++symbol) {
+        if (distribution[symbol] == -1)
+            symbols[high_threshold--] = symbol;
+    }
+
+    size_t step = (table_size >> 1) + (table_size >> 3) + 3;
+    size_t mask = table_size - 1;
+    size_t position = 0;
+    for (size_t symbol = 0; symbol < distribution.size(); ++symbol) {
+        for (i16 i = 0; i < distribution[symbol]; ++i) {
+            symbols[position] = symbol;
+            do {
+                position = (position + step) & mask;
+            } while (position > high_threshold);
+        }
+    }
+    if (position != 0)
+        return Error::from_string_literal("FSE distribution does not add up to the table size");
+
+    return symbols;
+}
+
+static ErrorOr<ZstdDecompressor::FSETable> build_fse_table(Span<i16 const> distribution, size_t accuracy_log)
+{
+    auto symbols = TRY(spread_symbols(distribution, accuracy_log));
+    size_t table_size = symbols.size();
+
+    Vector<u16, match_length_code_count> next_state_for_symbol;
+    for (auto probability : distribution)
+        next_state_for_symbol.append(probability == -1 ? 1 : probability);
+
+    ZstdDecompressor::FSETable table;
+    table.accuracy_log = accuracy_log;
+    TRY(table.entries.try_resize(table_size));
+    for (size_t i = 0; i < table_size; ++i) {
+        auto symbol = symbols[i];
+        auto next_state = next_state_for_symbol[symbol]++;
+        auto bit_count = accuracy_log - highest_bit_index(next_state);
+        table.entries[i] = { symbol, static_cast<u8>(bit_count), static_cast<u16>((next_state << bit_count) - table_size) };
+    }
+    return table;
+}
+
+static ZstdDecompressor::FSETable build_rle_table(u8 symbol)
+{
+    ZstdDecompressor::FSETable table;
+    table.entries.append({ symbol, 0, 0 });
+    return table;
+}
+
+// Reads an FSE table description (RFC 8878, section 4.1.1), returning the number of bytes that it took up.
+static ErrorOr<size_t> read_fse_distribution(ReadonlyBytes bytes, size_t maximum_symbol_count, size_t maximum_accuracy_log, Vector<i16>& distribution, size_t& accuracy_log)
+{
+    size_t bit_offset = 0;
+    auto read_bits = [&](size_t count, bool consume = true) {
+        u32 value = 0;
+        for (size_t i = 0; i < count; ++i) {
+            size_t offset = bit_offset + i;
+            if (offset / 8 < bytes.size())
+                value |= ((bytes[offset / 8] >> (offset % 8)) & 1) << i;
+        }
+        if (consume)
+            bit_offset += count;
+        return value;
+    };
+
+    accuracy_log = read_bits(4) + 5;
+    if (accuracy_log > maximum_accuracy_log)
+        return Error::from_string_literal("FSE accuracy log is too large");
+
+    i32 remaining = (1 << accuracy_log) + 1;
+    i32 threshold = 1 << accuracy_log;
+    size_t bit_count = accuracy_log + 1;
+
+    distribution.clear();
+    while (remaining > 1) {
+        if (distribution.size() >= maximum_symbol_count)
+            return Error::from_string_literal("FSE distribution has too many symbols");
+
+        i32 largest_short_value = (2 * threshold - 1) - remaining;
+        i32 value = read_bits(bit_count, false);
+        if ((value & (threshold - 1)) < largest_short_value) {
+            value &= threshold - 1;
+            bit_offset += bit_count - 1;
+        } else {
+            value &= 2 * threshold - 1;
+            if (value >= threshold)
+                value -= largest_short_value;
+            bit_offset += bit_count;
+        }
+
+        i16 probability = value - 1;
+        remaining -= probability < 0 ? -probability : probability;
+        distribution.append(probability);
+
+        if (probability == 0) {
+            while (true) {
+                auto repeat = read_bits(2);
+                for (size_t i = 0; i < repeat; ++i)
+                    distribution.append(0);
+                if (repeat != 3)
+                    break;
+            }
+            if (distribution.size() > maximum_symbol_count)
+                return Error::from_string_literal("FSE distribution has too many symbols");
+        }
+
+        while (remaining < threshold && bit_count > 1) {
+            --bit_count;
+            threshold >>= 1;
+        }
+    }
+
+    if (remaining != 1)
+        return Error::from_string_literal("FSE distribution does not add up to the table size");
+
+    size_t size = (bit_offset + 7) / 8;
+    if (size > bytes.size())
+        return Error::from_string_literal("FSE table description is truncated");
+    return size;
+}
+
+ErrorOr<NonnullOwnPtr<ZstdDecompressor>> ZstdDecompressor::construct(MaybeOwned<AK::Stream> stream)
+{
+    return TRY(adopt_nonnull_own_or_enomem(new (nothrow) ZstdDecompressor(move(stream))));
+}
+
+ZstdDecompressor::ZstdDecompressor(MaybeOwned<AK::Stream> stream)
+    : m_input_stream(move(stream))
+{
+}
+
+ErrorOr<void> ZstdDecompressor::read_frame_header()
+{
+    while (true) {
+        auto magic = TRY(m_input_stream->read_value<LittleEndian<u32>>());
+        if (magic == frame_magic)
+            break;
+        if ((magic & skippable_frame_magic_mask) != skippable_frame_magic)
+            return Error::from_string_literal("Invalid Zstandard frame magic");
+
+        auto skipped_size = TRY(m_input_stream->read_value<LittleEndian<u32>>());
+        TRY(m_input_stream->discard(skipped_size));
+        if (m_input_stream->is_eof()) {
+            m_state = State::Finished;
+            return {};
+        }
+    }
+
+    auto descriptor = TRY(m_input_stream->read_value<u8>());
+    auto frame_content_size_flag = descriptor >> 6;
+    bool single_segment = descriptor & 0x20;
+    if (descriptor & 0x08)
+        return Error::from_string_literal("Reserved bit in Zstandard frame header is set");
+    m_has_checksum = descriptor & 0x04;
+    auto dictionary_id_flag = descriptor & 0x03;
+
+    u64 window_size = 0;
+    if (!single_segment) {
+        auto window_descriptor = TRY(m_input_stream->read_value<u8>());
+        auto exponent = window_descriptor >> 3;
+        auto mantissa = window_descriptor & 0x07;
+        window_size = 1ull << (10 + exponent);
+        window_size += (window_size / 8) * mantissa;
+    }
+
+    static constexpr Array<size_t, 4> dictionary_id_sizes { 0, 1, 2, 4 };
+    u32 dictionary_id = 0;
+    for (size_t i = 0; i < dictionary_id_sizes[dictionary_id_flag]; ++i)
+        dictionary_id |= TRY(m_input_stream->read_value<u8>()) << (8 * i);
+    if (dictionary_id != 0)
+        return Error::from_string_literal("Zstandard dictionaries are not supported");
+
+    size_t frame_content_size_size = frame_content_size_flag == 0 ? (single_segment ? 1 : 0) : 1u << frame_content_size_flag;
+    u64 frame_content_size = 0;
+    for (size_t i = 0; i < frame_content_size_size; ++i)
+        frame_content_size |= static_cast<u64>(TRY(m_input_stream->read_value<u8>())) << (8 * i);
+    if (frame_content_size_size == 2)
+        frame_content_size += 256;
+
+    if (single_segment)
+        window_size = frame_content_size;
+    if (window_size > maximum_window_size)
+        return Error::from_string_literal("Zstandard window size is too large");
+
+    m_window_size = window_size;
+    m_maximum_block_size = min(window_size, maximum_block_size);
+    m_output_buffer = TRY(CircularBuffer::create_empty(max(window_size, maximum_block_size)));
+    m_read_last_block = false;
+
+    m_huffman_table.clear();
+    m_literal_length_table.clear();
+    m_offset_table.clear();
+    m_match_length_table.clear();
+    m_repeated_offsets[0] = 1;
+    m_repeated_offsets[1] = 4;
+    m_repeated_offsets[2] = 8;
+
+    m_state = State::BlockHeader;
+    return {};
+}
+
+ErrorOr<void> ZstdDecompressor::read_block()
+{
+    u8 header_bytes[3];
+    TRY(m_input_stream->read_entire_buffer({ header_bytes, sizeof(header_bytes) }));
+    u32 header = header_bytes[0] | (header_bytes[1] << 8) | (header_bytes[2] << 16);
+
+    bool is_last_block = header & 1;
+    auto block_type = (header >> 1) & 0x03;
+    size_t block_size = header >> 3;
+
+    switch (block_type) {
+    case 0: {
+        // Raw_Block
+        if (block_size > m_maximum_block_size)
+            return Error::from_string_literal("Zstandard block is too large");
+        TRY(m_block_buffer.try_resize(block_size));
+        TRY(m_input_stream->read_entire_buffer(m_block_buffer));
+        m_output_buffer->write(m_block_buffer);
+        break;
+    }
+    case 1: {
+        // RLE_Block
+        if (block_size > m_maximum_block_size)
+            return Error::from_string_literal("Zstandard block is too large");
+        auto value = TRY(m_input_stream->read_value<u8>());
+        TRY(m_block_buffer.try_resize(block_size));
+        m_block_buffer.bytes().fill(value);
+        m_output_buffer->write(m_block_buffer);
+        break;
+    }
+    case 2: {
+        // Compressed_Block
+        if (block_size > m_maximum_block_size)
+            return Error::from_string_literal("Zstandard block is too large");
+        TRY(m_block_buffer.try_resize(block_size));
+        TRY(m_input_stream->read_entire_buffer(m_block_buffer));
+        TRY(decode_compressed_block(m_block_buffer));
+        break;
+    }
+    default:
+        return Error::from_string_literal("Reserved Zstandard block type");
+    }
+
+    if (is_last_block)
+        m_state = State::FrameChecksum;
+    return {};
+}
+
+ErrorOr<void> ZstdDecompressor::decode_compressed_block(ReadonlyBytes block)
+{
+    auto literals_section_size = TRY(decode_literals(block));
+    TRY(decode_sequences(block.slice(literals_section_size)));
+    return {};
+}
+
+ErrorOr<size_t> ZstdDecompressor::decode_literals(ReadonlyBytes block)
+{
+    if (block.is_empty())
+        return Error::from_string_literal("Zstandard literals section is truncated");
+
+    auto block_type = block[0] & 0x03;
+    auto size_format = (block[0] >> 2) & 0x03;
+
+    if (block_type == 0 || block_type == 1) {
+        // Raw_Literals_Block or RLE_Literals_Block
+        size_t header_size = 0;
+        size_t regenerated_size = 0;
+        if ((size_format & 1) == 0) {
+            header_size = 1;
+            regenerated_size = block[0] >> 3;
+        } else if (size_format == 1) {
+            header_size = 2;
+            if (block.size() < header_size)
+                return Error::from_string_literal("Zstandard literals section is truncated");
+            regenerated_size = (block[0] >> 4) | (block[1] << 4);
+        } else {
+            header_size = 3;
+            if (block.size() < header_size)
+                return Error::from_string_literal("Zstandard literals section is truncated");
+            regenerated_size = (block[0] >> 4) | (block[1] << 4) | (block[2] << 12);
+        }
+        if (regenerated_size > maximum_block_size)
+            return Error::from_string_literal("Zstandard literals section is too large");
+
+        TRY(m_literals.try_resize(regenerated_size));
+        m_literals_size = regenerated_size;
+        if (block_type == 0) {
+            if (block.size() < header_size + regenerated_size)
+                return Error::from_string_literal("Zstandard literals section is truncated");
+            block.slice(header_size, regenerated_size).copy_to(m_literals);
+            return header_size + regenerated_size;
+        }
+
+        if (block.size() < header_size + 1)
+            return Error::from_string_literal("Zstandard literals section is truncated");
+        m_literals.bytes().fill(block[header_size]);
+        return header_size + 1;
+    }
+
+    // Compressed_Literals_Block or Treeless_Literals_Block
+    static constexpr Array<size_t, 4> header_sizes { 3, 3, 4, 5 };
+    static constexpr Array<size_t, 4> size_bit_counts { 10, 10, 14, 18 };
+    size_t header_size = header_sizes[size_format];
+    if (block.size() < header_size)
+        return Error::from_string_literal("Zstandard literals section is truncated");
+
+    u64 header = 0;
+    for (size_t i = 0; i < header_size; ++i)
+        header |= static_cast<u64>(block[i]) << (8 * i);
+    auto size_mask = (1u << size_bit_counts[size_format]) - 1;
+    size_t regenerated_size = (header >> 4) & size_mask;
+    size_t compressed_size = (header >> (4 + size_bit_counts[size_format])) & size_mask;
+    size_t stream_count = size_format == 0 ? 1 : 4;
+
+    if (regenerated_size > maximum_block_size)
+        return Error::from_string_literal("Zstandard literals section is too large");
+    if (block.size() < header_size + compressed_size)
+        return Error::from_string_literal("Zstandard literals section is truncated");
+
+    auto compressed_literals = block.slice(header_size, compressed_size);
+    if (block_type == 2) {
+        auto table_size = TRY(read_huffman_table(compressed_literals));
+        compressed_literals = compressed_literals.slice(table_size);
+    } else if (!m_huffman_table.has_value()) {
+        return Error::from_string_literal("Zstandard treeless literals block without a previous Huffman table");
+    }
+
+    TRY(m_literals.try_resize(regenerated_size));
+    m_literals_size = regenerated_size;
+
+    if (stream_count == 1) {
+        TRY(decode_huffman_stream(compressed_literals, m_literals));
+        return header_size + compressed_size;
+    }
+
+    if (compressed_literals.size() < 6)
+        return Error::from_string_literal("Zstandard literals jump table is truncated");
+    Array<size_t, 4> stream_sizes;
+    stream_sizes[0] = compressed_literals[0] | (compressed_literals[1] << 8);
+    stream_sizes[1] = compressed_literals[2] | (compressed_literals[3] << 8);
+    stream_sizes[2] = compressed_literals[4] | (compressed_literals[5] << 8);
+    compressed_literals = compressed_literals.slice(6);
+    if (stream_sizes[0] + stream_sizes[1] + stream_sizes[2] > compressed_literals.size())
+        return Error::from_string_literal("Zstandard literals jump table is invalid");
+    stream_sizes[3] = compressed_literals.size() - stream_sizes[0] - stream_sizes[1] - stream_sizes[2];
+
+    size_t segment_size = (regenerated_size + 3) / 4;
+    if (segment_size * 3 > regenerated_size)
+        return Error::from_string_literal("Zstandard literals section is too small for four streams");
+
+    size_t stream_offset = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        auto literals = m_literals.bytes().slice(i * segment_size, i == 3 ? regenerated_size - 3 * segment_size : segment_size);
+        TRY(decode_huffman_stream(compressed_literals.slice(stream_offset, stream_sizes[i]), literals));
+        stream_offset += stream_sizes[i];
+    }
+    return header_size + compressed_size;
+}
+
+ErrorOr<size_t> ZstdDecompressor::read_huffman_table(ReadonlyBytes bytes)
+{
+    if (bytes.is_empty())
+        return Error::from_string_literal("Zstandard Huffman table description is truncated");
+
+    Vector<u8, maximum_huffman_weight_count + 1> weights;
+    size_t header = bytes[0];
+    size_t description_size = 0;
+
+    if (header >= 128) {
+        // The weights are stored directly, as 4-bit values.
+        size_t weight_count = header - 127;
+        description_size = 1 + (weight_count + 1) / 2;
+        if (bytes.size() < description_size)
+            return Error::from_string_literal("Zstandard Huffman table description is truncated");
+        for (size_t i = 0; i < weight_count; ++i) {
+            auto byte = bytes[1 + i / 2];
+            weights.append(i % 2 == 0 ? byte >> 4 : byte & 0x0F);
+        }
+    } else {
+        // The weights are FSE compressed, using two interleaved states over the same table.
+        description_size = 1 + header;
+        if (bytes.size() < description_size)
+            return Error::from_string_literal("Zstandard Huffman table description is truncated");
+        auto compressed_weights = bytes.slice(1, header);
+
+        Vector<i16> distribution;
+        size_t accuracy_log = 0;
+        auto distribution_size = TRY(read_fse_distribution(compressed_weights, maximum_huffman_bit_count + 1, 6, distribution, accuracy_log));
+        auto table = TRY(build_fse_table(distribution, accuracy_log));
+
+        auto stream = TRY(ReverseBitStream::create(compressed_weights.slice(distribution_size)));
+        Array<u16, 2> states;
+        states[0] = stream.read_bits(accuracy_log);
+        states[1] = stream.read_bits(accuracy_log);
+
+        // Decoding stops once updating a state has run past the start of the data, at which point the other state
+        // still holds one last symbol.
+        for (size_t current = 0;; current ^= 1) {
+            if (weights.size() >= maximum_huffman_weight_count)
+                return Error::from_string_literal("Zstandard Huffman table has too many weights");
+            auto const& entry = table.entries[states[current]];
+            weights.append(entry.symbol);
+            states[current] = entry.baseline + stream.read_bits(entry.bit_count);
+            if (stream.is_overflowed()) {
+                weights.append(table.entries[states[current ^ 1]].symbol);
+                break;
+            }
+        }
+    }
+
+    if (weights.size() > maximum_huffman_weight_count)
+        return Error::from_string_literal("Zstandard Huffman table has too many weights");
+
+    // The weight of the last symbol is implied by the others, as the weights have to add up to a power of two.
+    u32 weight_total = 0;
+    for (auto weight : weights) {
+        if (weight > maximum_huffman_bit_count)
+            return Error::from_string_literal("Zstandard Huffman weight is too large");
+        if (weight > 0)
+            weight_total += 1u << (weight - 1);
+    }
+    if (weight_total == 0)
+        return Error::from_string_literal("Zstandard Huffman table is empty");
+
+    size_t max_bit_count = highest_bit_index(weight_total) + 1;
+    u32 left_over = (1u << max_bit_count) - weight_total;
+    if (max_bit_count > maximum_huffman_bit_count || !is_power_of_two(left_over))
+        return Error::from_string_literal("Zstandard Huffman weights are invalid");
+    weights.append(highest_bit_index(left_over) + 1);
+
+    // Each symbol gets 2^(weight - 1) consecutive entries, lower weights first and then in the order of the symbols.
+    Array<u32, maximum_huffman_bit_count + 2> rank_starts {};
+    for (auto weight : weights) {
+        if (weight > 0)
+            rank_starts[weight] += 1u << (weight - 1);
+    }
+    u32 next_rank_start = 0;
+    for (size_t weight = 1; weight <= max_bit_count; ++weight) {
+        auto count = rank_starts[weight];
+        rank_starts[weight] = next_rank_start;
+        next_rank_start += count;
+    }
+
+    HuffmanTable table;
+    table.max_bit_count = max_bit_count;
+    TRY(table.symbols.try_resize(1u << max_bit_count));
+    TRY(table.bit_counts.try_resize(1u << max_bit_count));
+    for (size_t symbol = 0; symbol < weights.size(); ++symbol) {
+        auto weight = weights[symbol];
+        if (weight == 0)
+            continue;
+        auto length = 1u << (weight - 1);
+        for (u32 i = rank_starts[weight]; i < rank_starts[weight] + length; ++i) {
+            table.symbols[i] = symbol;
+            table.bit_counts[i] = max_bit_count + 1 - weight;
+        }
+        rank_starts[weight] += length;
+    }
+
+    m_huffman_table = move(table);
+    return description_size;
+}
+
+ErrorOr<void> ZstdDecompressor::decode_huffman_stream(ReadonlyBytes bytes, Bytes literals) const
+{
+    auto const& table = *m_huffman_table;
+    auto stream = TRY(ReverseBitStream::create(bytes));
+    for (auto& literal : literals) {
+        auto index = stream.peek_bits(table.max_bit_count);
+        literal = table.symbols[index];
+        stream.discard_bits(table.bit_counts[index]);
+    }
+    if (!stream.is_empty())
+        return Error::from_string_literal("Zstandard Huffman stream does not end with its last literal");
+    return {};
+}
+
+ErrorOr<void> ZstdDecompressor::decode_sequences(ReadonlyBytes bytes)
+{
+    auto literals = m_literals.bytes().trim(m_literals_size);
+    size_t literals_offset = 0;
+    size_t regenerated_size = 0;
+
+    auto copy_literals = [&](size_t length) -> ErrorOr<void> {
+        if (length > literals.size() - literals_offset)
+            return Error::from_string_literal("Zstandard sequence uses more literals than there are");
+        if (regenerated_size + length > m_maximum_block_size)
+            return Error::from_string_literal("Zstandard block regenerates too much data");
+        m_output_buffer->write(literals.slice(literals_offset, length));
+        literals_offset += length;
+        regenerated_size += length;
+        return {};
+    };
+
+    if (bytes.is_empty())
+        return Error::from_string_literal("Zstandard sequences section is truncated");
+
+    size_t sequence_count = bytes[0];
+    size_t header_size = 1;
+    if (sequence_count == 255) {
+        if (bytes.size() < 3)
+            return Error::from_string_literal("Zstandard sequences section is truncated");
+        sequence_count = bytes[1] + (bytes[2] << 8) + 0x7F00;
+        header_size = 3;
+    } else if (sequence_count >= 128) {
+        if (bytes.size() < 2)
+            return Error::from_string_literal("Zstandard sequences section is truncated");
+        sequence_count = ((sequence_count - 128) << 8) + bytes[1];
+        header_size = 2;
+    }
+
+    if (sequence_count == 0) {
+        // The block consists of nothing but literals.
+        return copy_literals(literals.size());
+    }
+
+    if (bytes.size() < header_size + 1)
+        return Error::from_string_literal("Zstandard sequences section is truncated");
+    auto modes = bytes[header_size];
+    if (modes & 0x03)
+        return Error::from_string_literal("Reserved bits in Zstandard sequences section are set");
+    bytes = bytes.slice(header_size + 1);
+
+    auto read_table = [&](Optional<FSETable>& table, size_t mode, Span<i16 const> predefined_distribution, size_t predefined_accuracy_log, size_t maximum_symbol_count, size_t maximum_accuracy_log) -> ErrorOr<void> {
+        switch (mode) {
+        case 0:
+            // Predefined_Mode
+            table = TRY(build_fse_table(predefined_distribution, predefined_accuracy_log));
+            break;
+        case 1:
+            // RLE_Mode
+            if (bytes.is_empty())
+                return Error::from_string_literal("Zstandard sequences section is truncated");
+            if (bytes[0] >= maximum_symbol_count)
+                return Error::from_string_literal("Zstandard RLE symbol is out of range");
+            table = build_rle_table(bytes[0]);
+            bytes = bytes.slice(1);
+            break;
+        case 2: {
+            // FSE_Compressed_Mode
+            Vector<i16> distribution;
+            size_t accuracy_log = 0;
+            auto size = TRY(read_fse_distribution(bytes, maximum_symbol_count, maximum_accuracy_log, distribution, accuracy_log));
+            table = TRY(build_fse_table(distribution, accuracy_log));
+            bytes = bytes.slice(size);
+            break;
+        }
+        case 3:
+            // Repeat_Mode
+            if (!table.has_value())
+                return Error::from_string_literal("Zstandard sequences repeat a table that was never defined");
+            break;
+        }
+        return {};
+    };
+
+    TRY(read_table(m_literal_length_table, (modes >> 6) & 0x03, predefined_literal_length_distribution, predefined_literal_length_accuracy_log, literal_length_code_count, maximum_literal_length_accuracy_log));
+    TRY(read_table(m_offset_table, (modes >> 4) & 0x03, predefined_offset_distribution, predefined_offset_accuracy_log, offset_code_count, maximum_offset_accuracy_log));
+    TRY(read_table(m_match_length_table, (modes >> 2) & 0x03, predefined_match_length_distribution, predefined_match_length_accuracy_log, match_length_code_count, maximum_match_length_accuracy_log));
+
+    auto const& literal_length_table = *m_literal_length_table;
+    auto const& offset_table = *m_offset_table;
+    auto const& match_length_table = *m_match_length_table;
+
+    auto stream = TRY(ReverseBitStream::create(bytes));
+    size_t literal_length_state = stream.read_bits(literal_length_table.accuracy_log);
+    size_t offset_state = stream.read_bits(offset_table.accuracy_log);
+    size_t match_length_state = stream.read_bits(match_length_table.accuracy_log);
+
+    for (size_t i = 0; i < sequence_count; ++i) {
+        auto const& literal_length_entry = literal_length_table.entries[literal_length_state];
+        auto const& offset_entry = offset_table.entries[offset_state];
+        auto const& match_length_entry = match_length_table.entries[match_length_state];
+
+        auto offset_code = offset_entry.symbol;
+        if (offset_code >= offset_code_count)
+            return Error::from_string_literal("Zstandard offset code is out of range");
+        u32 offset_value = (1u << offset_code) + stream.read_bits(offset_code);
+
+        auto match_length_code = match_length_codes[match_length_entry.symbol];
+        size_t match_length = match_length_code.baseline + stream.read_bits(match_length_code.extra_bits);
+
+        auto literal_length_code = literal_length_codes[literal_length_entry.symbol];
+        size_t literal_length = literal_length_code.baseline + stream.read_bits(literal_length_code.extra_bits);
+
+        // Offset values of 1 to 3 refer to the repeated offsets, where a sequence without literals shifts them by one.
+        u32 offset = 0;
+        if (offset_value > 3) {
+            offset = offset_value - 3;
+            m_repeated_offsets[2] = m_repeated_offsets[1];
+            m_repeated_offsets[1] = m_repeated_offsets[0];
+            m_repeated_offsets[0] = offset;
+        } else {
+            size_t index = literal_length == 0 ? offset_value : offset_value - 1;
+            if (index == 0) {
+                offset = m_repeated_offsets[0];
+            } else {
+                offset = index < 3 ? m_repeated_offsets[index] : m_repeated_offsets[0] - 1;
+                if (offset == 0)
+                    return Error::from_string_literal("Zstandard repeated offset is zero");
+                if (index > 1)
+                    m_repeated_offsets[2] = m_repeated_offsets[1];
+                m_repeated_offsets[1] = m_repeated_offsets[0];
+                m_repeated_offsets[0] = offset;
+            }
+        }
+
+        TRY(copy_literals(literal_length));
+
+        if (regenerated_size + match_length > m_maximum_block_size)
+            return Error::from_string_literal("Zstandard block regenerates too much data");
+        if (offset > m_window_size)
+            return Error::from_string_literal("Zstandard offset is larger than the window");
+        TRY(m_output_buffer->copy_from_seekback(offset, match_length));
+        regenerated_size += match_length;
+
+        if (i + 1 < sequence_count) {
+            literal_length_state = literal_length_entry.baseline + stream.read_bits(literal_length_entry.bit_count);
+            match_length_state = match_length_entry.baseline + stream.read_bits(match_length_entry.bit_count);
+            offset_state = offset_entry.baseline + stream.read_bits(offset_entry.bit_count);
+        }
+    }
+
+    if (!stream.is_empty())
+        return Error::from_string_literal("Zstandard sequences bitstream does not end with its last sequence");
+
+    return copy_literals(literals.size() - literals_offset);
+}
+
+ErrorOr<Bytes> ZstdDecompressor::read(Bytes bytes)
+{
+    size_t total_read = 0;
+    while (total_read < bytes.size()) {
+        if (m_output_buffer.has_value() && m_output_buffer->used_space() > 0) {
+            total_read += m_output_buffer->read(bytes.slice(total_read)).size();
+            continue;
+        }
+
+        switch (m_state) {
+        case State::FrameHeader:
+            if (m_input_stream->is_eof()) {
+                m_state = State::Finished;
+                break;
+            }
+            TRY(read_frame_header());
+            break;
+        case State::BlockHeader:
+            TRY(read_block());
+            break;
+        case State::FrameChecksum:
+            // Note: The checksum is the lower half of an XXH64 hash of the content, which we don't implement.
+            if (m_has_checksum)
+                TRY(m_input_stream->discard(4));
+            m_state = State::FrameHeader;
+            break;
+        case State::Finished:
+            return bytes.trim(total_read);
+        }
+    }
+    return bytes.trim(total_read);
+}
+
+ErrorOr<size_t> ZstdDecompressor::write(ReadonlyBytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+bool ZstdDecompressor::is_eof() const
+{
+    if (m_output_buffer.has_value() && m_output_buffer->used_space() > 0)
+        return false;
+    return m_state == State::Finished || (m_state == State::FrameHeader && m_input_stream->is_eof());
+}
+
+ErrorOr<ByteBuffer> ZstdDecompressor::decompress_all(ReadonlyBytes bytes)
+{
+    auto memory_stream = TRY(FixedMemoryStream::construct(bytes));
+    auto zstd_stream = TRY(ZstdDecompressor::construct(move(memory_stream)));
+
+    AllocatingMemoryStream output_stream;
+    auto buffer = TRY(ByteBuffer::create_uninitialized(4096));
+    while (!zstd_stream->is_eof()) {
+        auto data = TRY(zstd_stream->read(buffer));
+        TRY(output_stream.write_entire_buffer(data));
+    }
+
+    auto output_buffer = TRY(ByteBuffer::create_uninitialized(output_stream.used_buffer_size()));
+    TRY(output_stream.read_entire_buffer(output_buffer));
+    return output_buffer;
+}
+
+bool ZstdDecompressor::is_likely_compressed(ReadonlyBytes bytes)
+{
+    if (bytes.size() < 4)
+        return false;
+    u32 magic = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<u32>(bytes[3]) << 24);
+    return magic == frame_magic || (magic & skippable_frame_magic_mask) == skippable_frame_magic;
+}
+
+// The encoding side of an FSE table, as in the reference implementation: the state that a symbol moves the encoder to
+// is looked up through a table that is sorted by symbol, and the number of bits to write follows from the state.
+struct FSEEncodingTable {
+    struct SymbolTransform {
+        i32 delta_find_state { 0 };
+        u32 delta_bit_count { 0 };
+    };
+
+    size_t accuracy_log { 0 };
+    Vector<u16> state_table;
+    Vector<SymbolTransform> symbol_transforms;
+
+    u32 initial_state(u16 symbol) const
+    {
+        // This picks the state with the lowest value, so that the last symbol to be read costs as little as possible.
+        auto const& transform = symbol_transforms[symbol];
+        u32 bit_count = (transform.delta_bit_count + (1 << 15)) >> 16;
+        u32 value = (bit_count << 16) - transform.delta_bit_count;
+        return state_table[(value >> bit_count) + transform.delta_find_state];
+    }
+
+    void encode(BitWriter& writer, u32& state, u16 symbol) const
+    {
+        auto const& transform = symbol_transforms[symbol];
+        u32 bit_count = (state + transform.delta_bit_count) >> 16;
+        writer.write_bits(state, bit_count);
+        state = state_table[(state >> bit_count) + transform.delta_find_state];
+    }
+
+    void flush(BitWriter& writer, u32 state) const
+    {
+        writer.write_bits(state, accuracy_log);
+    }
+};
+
+static ErrorOr<FSEEncodingTable> build_fse_encoding_table(Span<i16 const> distribution, size_t accuracy_log)
+{
+    auto symbols = TRY(spread_symbols(distribution, accuracy_log));
+    u32 table_size = symbols.size();
+
+    Vector<u32, match_length_code_count + 1> cumulative_counts;
+    cumulative_counts.append(0);
+    for (auto probability : distribution)
+        cumulative_counts.append(cumulative_counts.last() + (probability == -1 ? 1 : probability));
+
+    FSEEncodingTable table;
+    table.accuracy_log = accuracy_log;
+    TRY(table.state_table.try_resize(table_size));
+    for (u32 i = 0; i < table_size; ++i)
+        table.state_table[cumulative_counts[symbols[i]]++] = table_size + i;
+
+    i32 total = 0;
+    for (auto probability : distribution) {
+        FSEEncodingTable::SymbolTransform transform;
+        if (probability == 0) {
+            transform.delta_bit_count = ((accuracy_log + 1) << 16) - table_size;
+        } else if (probability == -1 || probability == 1) {
+            transform.delta_find_state = total - 1;
+            transform.delta_bit_count = (accuracy_log << 16) - table_size;
+            ++total;
+        } else {
+            u32 maximum_bit_count = accuracy_log - highest_bit_index(probability - 1);
+            u32 minimum_state = static_cast<u32>(probability) << maximum_bit_count;
+            transform.delta_find_state = total - probability;
+            transform.delta_bit_count = (maximum_bit_count << 16) - minimum_state;
+            total += probability;
+        }
+        TRY(table.symbol_transforms.try_append(transform));
+    }
+    return table;
+}
+
+// Scales the symbol counts to probabilities that add up to the table size, where every symbol that occurs at all gets
+// a probability of at least 1.
+static Vector<i16> normalize_distribution(Span<u32 const> counts, size_t accuracy_log)
+{
+    i32 table_size = 1 << accuracy_log;
+    u64 total = 0;
+    for (auto count : counts)
+        total += count;
+    VERIFY(total > 0);
+
+    Vector<i16> distribution;
+    i32 distribution_total = 0;
+    size_t most_frequent_symbol = 0;
+    for (size_t symbol = 0; symbol < counts.size(); ++symbol) {
+        i16 probability = 0;
+        if (counts[symbol] > 0)
+            probability = max<i64>(1, counts[symbol] * table_size / total);
+        distribution.append(probability);
+        distribution_total += probability;
+        if (counts[symbol] > counts[most_frequent_symbol])
+            most_frequent_symbol = symbol;
+    }
+
+    // Rounding down leaves slots over that go to the most frequent symbol, while rounding rare symbols up to 1 may have
+    // taken too many, which are then taken away from whichever symbol has the most.
+    if (distribution_total < table_size)
+        distribution[most_frequent_symbol] += table_size - distribution_total;
+    while (distribution_total > table_size) {
+        size_t largest_symbol = 0;
+        for (size_t symbol = 1; symbol < distribution.size(); ++symbol) {
+            if (distribution[symbol] > distribution[largest_symbol])
+                largest_symbol = symbol;
+        }
+        VERIFY(distribution[largest_symbol] > 1);
+        --distribution[largest_symbol];
+        --distribution_total;
+    }
+
+    while (!distribution.is_empty() && distribution.last() == 0)
+        distribution.take_last();
+    return distribution;
+}
+
+// Writes an FSE table description, the counterpart to read_fse_distribution().
+static void write_fse_distribution(BitWriter& writer, Span<i16 const> distribution, size_t accuracy_log)
+{
+    writer.write_bits(accuracy_log - 5, 4);
+
+    i32 remaining = (1 << accuracy_log) + 1;
+    i32 threshold = 1 << accuracy_log;
+    size_t bit_count = accuracy_log + 1;
+    bool previous_was_zero = false;
+
+    for (size_t symbol = 0; remaining > 1;) {
+        if (previous_was_zero) {
+            size_t start = symbol;
+            while (distribution[symbol] == 0)
+                ++symbol;
+            for (; symbol >= start + 3; start += 3)
+                writer.write_bits(3, 2);
+            writer.write_bits(symbol - start, 2);
+        }
+
+        i32 value = distribution[symbol++];
+        i32 largest_short_value = (2 * threshold - 1) - remaining;
+        remaining -= value < 0 ? -value : value;
+        ++value;
+        if (value >= threshold)
+            value += largest_short_value;
+        writer.write_bits(value, value < largest_short_value ? bit_count - 1 : bit_count);
+        previous_was_zero = value == 1;
+
+        while (remaining < threshold) {
+            --bit_count;
+            threshold >>= 1;
+        }
+    }
+}
+
+// Estimates how many bits it takes to encode symbols with the given counts using the given distribution.
+static Optional<float> estimate_fse_cost(Span<u32 const> counts, Span<i16 const> distribution, size_t accuracy_log)
+{
+    float cost = 0;
+    for (size_t symbol = 0; symbol < counts.size(); ++symbol) {
+        if (counts[symbol] == 0)
+            continue;
+        if (symbol >= distribution.size() || distribution[symbol] == 0)
+            return {};
+        auto probability = distribution[symbol] == -1 ? 1 : distribution[symbol];
+        cost += counts[symbol] * (accuracy_log - AK::log2(static_cast<float>(probability)));
+    }
+    return cost;
+}
+
+static u8 literal_length_code(u32 literal_length)
+{
+    if (literal_length < 16)
+        return literal_length;
+    u8 code = literal_length_code_count - 1;
+    while (literal_length_codes[code].baseline > literal_length)
+        --code;
+    return code;
+}
+
+static u8 match_length_code(u32 match_length)
+{
+    if (match_length < 35)
+        return match_length - 3;
+    u8 code = match_length_code_count - 1;
+    while (match_length_codes[code].baseline > match_length)
+        --code;
+    return code;
+}
+
+// Picks the cheapest way to describe the distribution of one kind of code in a sequences section, appends its
+// description to the output and returns the table to encode the codes with.
+static ErrorOr<FSEEncodingTable> write_sequence_table(Vector<u8>& output, u8& mode, Span<u8 const> codes, size_t code_count, Span<i16 const> predefined_distribution, size_t predefined_accuracy_log, size_t maximum_accuracy_log)
+{
+    Vector<u32, match_length_code_count> counts;
+    counts.resize(code_count);
+    for (auto code : codes)
+        ++counts[code];
+
+    size_t distinct_code_count = 0;
+    size_t last_code = 0;
+    for (size_t code = 0; code < code_count; ++code) {
+        if (counts[code] > 0) {
+            ++distinct_code_count;
+            last_code = code;
+        }
+    }
+
+    if (distinct_code_count == 1 && codes.size() > 2) {
+        // RLE_Mode, the one symbol doesn't cost any bits at all.
+        mode = 1;
+        TRY(output.try_append(last_code));
+        Vector<i16, match_length_code_count> distribution;
+        distribution.resize(last_code + 1);
+        distribution[last_code] = 1;
+        return build_fse_encoding_table(distribution, 0);
+    }
+
+    auto predefined_cost = estimate_fse_cost(counts.span().trim(last_code + 1), predefined_distribution, predefined_accuracy_log);
+
+    size_t accuracy_log = clamp<size_t>(highest_bit_index(codes.size()), code_count > 32 ? 6 : 5, maximum_accuracy_log);
+    auto distribution = normalize_distribution(counts.span().trim(last_code + 1), accuracy_log);
+    BitWriter description_writer;
+    write_fse_distribution(description_writer, distribution, accuracy_log);
+    auto description = description_writer.finish();
+    auto compressed_cost = *estimate_fse_cost(counts.span().trim(last_code + 1), distribution, accuracy_log) + description.size() * 8;
+
+    if (predefined_cost.has_value() && *predefined_cost <= compressed_cost) {
+        // Predefined_Mode
+        mode = 0;
+        return build_fse_encoding_table(predefined_distribution, predefined_accuracy_log);
+    }
+
+    // FSE_Compressed_Mode
+    mode = 2;
+    TRY(output.try_extend(description));
+    return build_fse_encoding_table(distribution, accuracy_log);
+}
+
+static ErrorOr<void> write_sequences_section(Vector<u8>& output, Span<ZstdCompressor::Sequence const> sequences)
+{
+    size_t sequence_count = sequences.size();
+    if (sequence_count < 128) {
+        TRY(output.try_append(sequence_count));
+    } else if (sequence_count < 0x7F00) {
+        TRY(output.try_append((sequence_count >> 8) + 128));
+        TRY(output.try_append(sequence_count & 0xFF));
+    } else {
+        TRY(output.try_append(255));
+        TRY(output.try_append((sequence_count - 0x7F00) & 0xFF));
+        TRY(output.try_append((sequence_count - 0x7F00) >> 8));
+    }
+    if (sequence_count == 0)
+        return {};
+
+    Vector<u8> literal_length_codes_of_sequences;
+    Vector<u8> offset_codes_of_sequences;
+    Vector<u8> match_length_codes_of_sequences;
+    TRY(literal_length_codes_of_sequences.try_ensure_capacity(sequence_count));
+    TRY(offset_codes_of_sequences.try_ensure_capacity(sequence_count));
+    TRY(match_length_codes_of_sequences.try_ensure_capacity(sequence_count));
+    for (auto const& sequence : sequences) {
+        literal_length_codes_of_sequences.unchecked_append(literal_length_code(sequence.literal_length));
+        offset_codes_of_sequences.unchecked_append(highest_bit_index(sequence.offset_value));
+        match_length_codes_of_sequences.unchecked_append(match_length_code(sequence.match_length));
+    }
+
+    auto modes_offset = output.size();
+    TRY(output.try_append(0));
+    u8 literal_length_mode = 0;
+    u8 offset_mode = 0;
+    u8 match_length_mode = 0;
+    auto literal_length_table = TRY(write_sequence_table(output, literal_length_mode, literal_length_codes_of_sequences, literal_length_code_count, predefined_literal_length_distribution, predefined_literal_length_accuracy_log, maximum_literal_length_accuracy_log));
+    auto offset_table = TRY(write_sequence_table(output, offset_mode, offset_codes_of_sequences, offset_code_count, predefined_offset_distribution, predefined_offset_accuracy_log, maximum_offset_accuracy_log));
+    auto match_length_table = TRY(write_sequence_table(output, match_length_mode, match_length_codes_of_sequences, match_length_code_count, predefined_match_length_distribution, predefined_match_length_accuracy_log, maximum_match_length_accuracy_log));
+    output[modes_offset] = (literal_length_mode << 6) | (offset_mode << 4) | (match_length_mode << 2);
+
+    // The decoder reads the sequences front to back, so they are encoded back to front, with every field in the
+    // opposite order of how it is read.
+    BitWriter writer;
+    auto write_extra_bits = [&](size_t index) {
+        auto const& sequence = sequences[index];
+        auto const& literal_length_code = literal_length_codes[literal_length_codes_of_sequences[index]];
+        auto const& match_length_code = match_length_codes[match_length_codes_of_sequences[index]];
+        auto offset_code = offset_codes_of_sequences[index];
+        writer.write_bits(sequence.literal_length - literal_length_code.baseline, literal_length_code.extra_bits);
+        writer.write_bits(sequence.match_length - match_length_code.baseline, match_length_code.extra_bits);
+        writer.write_bits(sequence.offset_value - (1u << offset_code), offset_code);
+    };
+
+    auto last = sequence_count - 1;
+    u32 literal_length_state = literal_length_table.initial_state(literal_length_codes_of_sequences[last]);
+    u32 offset_state = offset_table.initial_state(offset_codes_of_sequences[last]);
+    u32 match_length_state = match_length_table.initial_state(match_length_codes_of_sequences[last]);
+    write_extra_bits(last);
+
+    for (size_t i = last; i-- > 0;) {
+        offset_table.encode(writer, offset_state, offset_codes_of_sequences[i]);
+        match_length_table.encode(writer, match_length_state, match_length_codes_of_sequences[i]);
+        literal_length_table.encode(writer, literal_length_state, literal_length_codes_of_sequences[i]);
+        write_extra_bits(i);
+    }
+
+    match_length_table.flush(writer, match_length_state);
+    offset_table.flush(writer, offset_state);
+    literal_length_table.flush(writer, literal_length_state);
+    writer.write_end_marker();
+    TRY(output.try_extend(writer.finish()));
+    return {};
+}
+
+// Writes the header of a Raw_Literals_Block or an RLE_Literals_Block, which only differ in what follows it.
+static ErrorOr<void> write_literals_header(Vector<u8>& output, u8 block_type, size_t size)
+{
+    if (size < 32) {
+        TRY(output.try_append(block_type | (size << 3)));
+    } else if (size < 4096) {
+        TRY(output.try_append(block_type | (1 << 2) | (size << 4)));
+        TRY(output.try_append(size >> 4));
+    } else {
+        TRY(output.try_append(block_type | (3 << 2) | (size << 4)));
+        TRY(output.try_append(size >> 4));
+        TRY(output.try_append(size >> 12));
+    }
+    return {};
+}
+
+static ErrorOr<void> write_raw_literals_section(Vector<u8>& output, ReadonlyBytes literals)
+{
+    TRY(write_literals_header(output, 0, literals.size()));
+    TRY(output.try_append(literals.data(), literals.size()));
+    return {};
+}
+
+// Describes the Huffman weights as FSE compressed data, or returns an empty vector if they can't be described that way.
+static ErrorOr<Vector<u8>> compress_huffman_weights(Span<u8 const> weights)
+{
+    static constexpr size_t accuracy_log = 6;
+
+    Array<u32, maximum_huffman_bit_count + 1> counts {};
+    for (auto weight : weights)
+        ++counts[weight];
+
+    // Decoding stops when the bitstream runs out, which can't happen if every state costs zero bits.
+    size_t distinct_weight_count = 0;
+    for (auto count : counts) {
+        if (count > 0)
+            ++distinct_weight_count;
+    }
+    if (weights.size() < 2 || distinct_weight_count < 2)
+        return Vector<u8> {};
+
+    auto distribution = normalize_distribution(counts, accuracy_log);
+    auto table = TRY(build_fse_encoding_table(distribution, accuracy_log));
+
+    BitWriter writer;
+    write_fse_distribution(writer, distribution, accuracy_log);
+    auto description = writer.finish();
+
+    // Two states take turns, with the first weight coming from the first state. The last two weights are where the
+    // states start out.
+    Array<u32, 2> states;
+    auto last = weights.size() - 1;
+    states[last % 2] = table.initial_state(weights[last]);
+    states[(last - 1) % 2] = table.initial_state(weights[last - 1]);
+    for (size_t i = last - 1; i-- > 0;)
+        table.encode(writer, states[i % 2], weights[i]);
+    table.flush(writer, states[1]);
+    table.flush(writer, states[0]);
+    writer.write_end_marker();
+
+    TRY(description.try_extend(writer.finish()));
+    return description;
+}
+
+static ErrorOr<void> write_literals_section(Vector<u8>& output, ReadonlyBytes literals)
+{
+    static constexpr size_t minimum_compressed_literal_count = 64;
+
+    Array<u16, 256> frequencies {};
+    Array<u32, 256> counts {};
+    size_t last_symbol = 0;
+    size_t distinct_symbol_count = 0;
+    for (auto literal : literals) {
+        if (counts[literal]++ == 0)
+            ++distinct_symbol_count;
+        last_symbol = max<size_t>(last_symbol, literal);
+    }
+
+    if (distinct_symbol_count == 1 && literals.size() > 2) {
+        // RLE_Literals_Block
+        TRY(write_literals_header(output, 1, literals.size()));
+        TRY(output.try_append(literals[0]));
+        return {};
+    }
+
+    if (literals.size() < minimum_compressed_literal_count || distinct_symbol_count < 2)
+        return write_raw_literals_section(output, literals);
+
+    // Note: generate_huffman_lengths() expects the frequencies to fit into 16 bits together.
+    u32 frequency_divisor = literals.size() / (NumericLimits<u16>::max() / 2) + 1;
+    for (size_t symbol = 0; symbol < 256; ++symbol) {
+        if (counts[symbol] > 0)
+            frequencies[symbol] = max<u32>(1, counts[symbol] / frequency_divisor);
+    }
+    Array<u8, 256> lengths {};
+    generate_huffman_lengths(lengths, frequencies, maximum_huffman_bit_count);
+
+    u8 max_bit_count = 0;
+    for (auto length : lengths)
+        max_bit_count = max(max_bit_count, length);
+
+    Array<u8, 256> weights {};
+    for (size_t symbol = 0; symbol <= last_symbol; ++symbol)
+        weights[symbol] = lengths[symbol] > 0 ? max_bit_count + 1 - lengths[symbol] : 0;
+
+    // The weight of the last symbol is left out, as the decoder can work it out from the others.
+    Vector<u8> description;
+    auto compressed_weights = TRY(compress_huffman_weights(Span<u8 const> { weights.data(), last_symbol }));
+    if (!compressed_weights.is_empty() && compressed_weights.size() < 128 && (last_symbol > 128 || compressed_weights.size() < (last_symbol + 1) / 2)) {
+        TRY(description.try_append(compressed_weights.size()));
+        TRY(description.try_extend(compressed_weights));
+    } else if (last_symbol <= 128) {
+        TRY(description.try_append(127 + last_symbol));
+        for (size_t i = 0; i < last_symbol; i += 2)
+            TRY(description.try_append((weights[i] << 4) | weights[i + 1]));
+    } else {
+        return write_raw_literals_section(output, literals);
+    }
+
+    // Codes are handed out in the same order as the decoder fills its table: by increasing weight, then by symbol.
+    Array<u32, maximum_huffman_bit_count + 2> rank_starts {};
+    for (size_t symbol = 0; symbol <= last_symbol; ++symbol) {
+        if (weights[symbol] > 0)
+            rank_starts[weights[symbol]] += 1u << (weights[symbol] - 1);
+    }
+    u32 next_rank_start = 0;
+    for (size_t weight = 1; weight <= max_bit_count; ++weight) {
+        auto count = rank_starts[weight];
+        rank_starts[weight] = next_rank_start;
+        next_rank_start += count;
+    }
+    VERIFY(next_rank_start == 1u << max_bit_count);
+
+    Array<u16, 256> codes {};
+    for (size_t symbol = 0; symbol <= last_symbol; ++symbol) {
+        auto weight = weights[symbol];
+        if (weight == 0)
+            continue;
+        codes[symbol] = rank_starts[weight] >> (weight - 1);
+        rank_starts[weight] += 1u << (weight - 1);
+    }
+
+    auto encode_stream = [&](ReadonlyBytes stream_literals) {
+        BitWriter writer;
+        for (size_t i = stream_literals.size(); i-- > 0;) {
+            auto literal = stream_literals[i];
+            writer.write_bits(codes[literal], lengths[literal]);
+        }
+        writer.write_end_marker();
+        return writer.finish();
+    };
+
+    Vector<u8> streams;
+    size_t stream_count = literals.size() < 256 ? 1 : 4;
+    if (stream_count == 1) {
+        streams = encode_stream(literals);
+    } else {
+        size_t segment_size = (literals.size() + 3) / 4;
+        Array<Vector<u8>, 4> encoded_streams;
+        for (size_t i = 0; i < 4; ++i)
+            encoded_streams[i] = encode_stream(literals.slice(i * segment_size, i == 3 ? literals.size() - 3 * segment_size : segment_size));
+        for (size_t i = 0; i < 3; ++i) {
+            TRY(streams.try_append(encoded_streams[i].size() & 0xFF));
+            TRY(streams.try_append(encoded_streams[i].size() >> 8));
+        }
+        for (auto& stream : encoded_streams)
+            TRY(streams.try_extend(stream));
+    }
+
+    size_t compressed_size = description.size() + streams.size();
+    size_t size_format = 0;
+    if (stream_count == 4) {
+        auto largest_size = max(literals.size(), compressed_size);
+        size_format = largest_size < 1024 ? 1 : largest_size < 16384 ? 2 : 3;
+    }
+    static constexpr Array<size_t, 4> header_sizes { 3, 3, 4, 5 };
+    static constexpr Array<size_t, 4> size_bit_counts { 10, 10, 14, 18 };
+    if (header_sizes[size_format] + compressed_size >= literals.size())
+        return write_raw_literals_section(output, literals);
+
+    // Compressed_Literals_Block
+    u64 header = 2 | (size_format << 2) | (literals.size() << 4) | (static_cast<u64>(compressed_size) << (4 + size_bit_counts[size_format]));
+    for (size_t i = 0; i < header_sizes[size_format]; ++i)
+        TRY(output.try_append(static_cast<u8>(header >> (8 * i))));
+    TRY(output.try_extend(description));
+    TRY(output.try_extend(streams));
+    return {};
+}
+
+ErrorOr<NonnullOwnPtr<ZstdCompressor>> ZstdCompressor::construct(MaybeOwned<AK::Stream> stream)
+{
+    auto window = TRY(ByteBuffer::create_uninitialized(window_size));
+    return TRY(adopt_nonnull_own_or_enomem(new (nothrow) ZstdCompressor(move(stream), move(window))));
+}
+
+ZstdCompressor::ZstdCompressor(MaybeOwned<AK::Stream> stream, ByteBuffer window)
+    : m_output_stream(move(stream))
+    , m_window(move(window))
+    , m_match_finder(32)
+{
+}
+
+ZstdCompressor::~ZstdCompressor()
+{
+    VERIFY(m_finished);
+}
+
+ErrorOr<Bytes> ZstdCompressor::read(Bytes)
+{
+    return Error::from_errno(EBADF);
+}
+
+ErrorOr<size_t> ZstdCompressor::write(ReadonlyBytes bytes)
+{
+    VERIFY(!m_finished);
+
+    size_t total_written = 0;
+    while (total_written < bytes.size()) {
+        // A full block is only flushed once there is more data, as the last block of the frame has to be marked as such.
+        if (m_block_size == block_size)
+            TRY(flush_block(false));
+
+        auto written = bytes.slice(total_written).copy_trimmed_to(m_window.bytes().slice(m_dictionary_size + m_block_size, block_size - m_block_size));
+        m_block_size += written;
+        total_written += written;
+    }
+    return total_written;
+}
+
+ErrorOr<void> ZstdCompressor::final_flush()
+{
+    VERIFY(!m_finished);
+    m_finished = true;
+    return flush_block(true);
+}
+
+ErrorOr<void> ZstdCompressor::write_frame_header()
+{
+    TRY(m_output_stream->write_value<LittleEndian<u32>>(frame_magic));
+    // No content size, no checksum and no dictionary, followed by a window descriptor for the window size.
+    static_assert(window_size == 1 << 18);
+    u8 header[] = { 0x00, (18 - 10) << 3 };
+    TRY(m_output_stream->write_entire_buffer({ header, sizeof(header) }));
+    m_wrote_frame_header = true;
+    return {};
+}
+
+ErrorOr<void> ZstdCompressor::flush_block(bool is_last)
+{
+    if (!m_wrote_frame_header)
+        TRY(write_frame_header());
+
+    auto block = m_window.bytes().slice(m_dictionary_size, m_block_size);
+    bool is_single_byte = !block.is_empty() && all_of(block, [&](u8 byte) { return byte == block[0]; });
+
+    ByteBuffer compressed_block;
+    if (!is_single_byte && !block.is_empty())
+        compressed_block = TRY(compress_block());
+
+    u32 block_type = 0;
+    ReadonlyBytes block_content = block;
+    if (is_single_byte) {
+        // RLE_Block
+        block_type = 1;
+        block_content = block.trim(1);
+    } else if (!compressed_block.is_empty() && compressed_block.size() < block.size()) {
+        // Compressed_Block
+        block_type = 2;
+        block_content = compressed_block;
+    }
+
+    // The size of an RLE block is the size that it expands to.
+    u32 header = (is_last ? 1 : 0) | (block_type << 1) | ((block_type == 1 ? block.size() : block_content.size()) << 3);
+    u8 header_bytes[] = { static_cast<u8>(header), static_cast<u8>(header >> 8), static_cast<u8>(header >> 16) };
+    TRY(m_output_stream->write_entire_buffer({ header_bytes, sizeof(header_bytes) }));
+    TRY(m_output_stream->write_entire_buffer(block_content));
+
+    // Later matches may refer back into this block.
+    memmove(m_window.data(), block.data(), block.size());
+    m_dictionary_size = block.size();
+    m_block_size = 0;
+    return {};
+}
+
+ErrorOr<ByteBuffer> ZstdCompressor::compress_block()
+{
+    auto buffer = m_window.bytes().trim(m_dictionary_size + m_block_size);
+    TRY(m_match_finder.reset(buffer.size()));
+    for (size_t position = 0; position < m_dictionary_size; ++position)
+        m_match_finder.insert(buffer, position);
+
+    Vector<Sequence> sequences;
+    Vector<u8> literals;
+    TRY(literals.try_ensure_capacity(m_block_size));
+
+    // Offsets that were used recently are cheaper to refer to. This keeps track of them the same way the decoder does,
+    // where a sequence without literals can't refer to the most recent offset, but to that offset minus 1 instead.
+    auto offset_value_for = [&](u32 offset, u32 literal_length) -> u32 {
+        auto& repeated_offsets = m_repeated_offsets;
+        Optional<size_t> index;
+        if (literal_length > 0 && offset == repeated_offsets[0])
+            return 1;
+        if (offset == repeated_offsets[1])
+            index = 1;
+        else if (offset == repeated_offsets[2])
+            index = 2;
+        else if (literal_length == 0 && offset == repeated_offsets[0] - 1)
+            index = 3;
+
+        if (!index.has_value() || *index > 1)
+            repeated_offsets[2] = repeated_offsets[1];
+        repeated_offsets[1] = repeated_offsets[0];
+        repeated_offsets[0] = offset;
+
+        if (!index.has_value())
+            return offset + 3;
+        return literal_length > 0 ? *index + 1 : *index;
+    };
+
+    size_t literal_start = m_dictionary_size;
+    size_t position = m_dictionary_size;
+    while (position + MatchFinder::min_match_length <= buffer.size()) {
+        auto match = m_match_finder.find_longest_match(buffer, position, window_size, block_size);
+        m_match_finder.insert(buffer, position);
+        if (match.length == 0) {
+            ++position;
+            continue;
+        }
+
+        // A longer match that starts at the next byte is worth a literal.
+        auto next_match = m_match_finder.find_longest_match(buffer, position + 1, window_size, block_size);
+        if (next_match.length > match.length) {
+            ++position;
+            continue;
+        }
+
+        u32 literal_length = position - literal_start;
+        TRY(literals.try_append(buffer.offset_pointer(literal_start), literal_length));
+        TRY(sequences.try_append({ literal_length, static_cast<u32>(match.length), offset_value_for(match.distance, literal_length) }));
+
+        for (size_t i = 1; i < match.length; ++i)
+            m_match_finder.insert(buffer, position + i);
+        position += match.length;
+        literal_start = position;
+    }
+    TRY(literals.try_append(buffer.offset_pointer(literal_start), buffer.size() - literal_start));
+
+    Vector<u8> output;
+    TRY(write_literals_section(output, literals));
+    TRY(write_sequences_section(output, sequences));
+    return ByteBuffer::copy(output.span());
+}
+
+ErrorOr<ByteBuffer> ZstdCompressor::compress_all(ReadonlyBytes bytes)
+{
+    auto output_stream = TRY(try_make<AllocatingMemoryStream>());
+    auto zstd_stream = TRY(ZstdCompressor::construct(MaybeOwned<AK::Stream>(*output_stream)));
+
+    TRY(zstd_stream->write_entire_buffer(bytes));
+    TRY(zstd_stream->final_flush());
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(output_stream->used_buffer_size()));
+    TRY(output_stream->read_entire_buffer(buffer));
+
+    return buffer;
+}
+
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/CircularBuffer.h>
+#include <AK/MaybeOwned.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Stream.h>
+#include <AK/Vector.h>
+#include <LibCompress/MatchFinder.h>
+
+namespace Compress {
+
+// Zstandard, as specified by RFC 8878.
+class ZstdDecompressor final : public AK::Stream {
+public:
+    static ErrorOr<NonnullOwnPtr<ZstdDecompressor>> construct(MaybeOwned<AK::Stream>);
+
+    virtual ErrorOr<Bytes> read(Bytes) override;
+    virtual ErrorOr<size_t> write(ReadonlyBytes) override;
+    virtual bool is_eof() const override;
+    virtual bool is_open() const override { return m_input_stream->is_open(); }
+    virtual void close() override { }
+
+    static ErrorOr<ByteBuffer> decompress_all(ReadonlyBytes);
+    static bool is_likely_compressed(ReadonlyBytes);
+
+    struct FSETableEntry {
+        u16 symbol { 0 };
+        u8 bit_count { 0 };
+        u16 baseline { 0 };
+    };
+
+    struct FSETable {
+        size_t accuracy_log { 0 };
+        Vector<FSETableEntry> entries;
+    };
+
+    struct HuffmanTable {
+        size_t max_bit_count { 0 };
+        // Indexed by the next max_bit_count bits of input.
+        Vector<u8> symbols;
+        Vector<u8> bit_counts;
+    };
+
+private:
+    enum class State {
+        FrameHeader,
+        BlockHeader,
+        FrameChecksum,
+        Finished,
+    };
+
+    ZstdDecompressor(MaybeOwned<AK::Stream>);
+
+    ErrorOr<void> read_frame_header();
+    ErrorOr<void> read_block();
+    ErrorOr<void> decode_compressed_block(ReadonlyBytes);
+    ErrorOr<size_t> decode_literals(ReadonlyBytes);
+    ErrorOr<size_t> read_huffman_table(ReadonlyBytes);
+    ErrorOr<void> decode_huffman_stream(ReadonlyBytes, Bytes literals) const;
+    ErrorOr<void> decode_sequences(ReadonlyBytes);
+
+    MaybeOwned<AK::Stream> m_input_stream;
+    State m_state { State::FrameHeader };
+
+    Optional<CircularBuffer> m_output_buffer;
+    size_t m_window_size { 0 };
+    size_t m_maximum_block_size { 0 };
+    bool m_has_checksum { false };
+    bool m_read_last_block { false };
+
+    ByteBuffer m_block_buffer;
+    ByteBuffer m_literals;
+    size_t m_literals_size { 0 };
+
+    // State that is carried over from one block to the next within a frame.
+    Optional<HuffmanTable> m_huffman_table;
+    Optional<FSETable> m_literal_length_table;
+    Optional<FSETable> m_offset_table;
+    Optional<FSETable> m_match_length_table;
+    u32 m_repeated_offsets[3] { 1, 4, 8 };
+};
+
+class ZstdCompressor final : public AK::Stream {
+public:
+    static constexpr size_t block_size = 128 * KiB;
+    // Matches may reach back into the previous block, so the window has to cover two of them.
+    static constexpr size_t window_size = 2 * block_size;
+
+    static ErrorOr<NonnullOwnPtr<ZstdCompressor>> construct(MaybeOwned<AK::Stream>);
+    ~ZstdCompressor();
+
+    virtual ErrorOr<Bytes> read(Bytes) override;
+    virtual ErrorOr<size_t> write(ReadonlyBytes) override;
+    virtual bool is_eof() const override { return true; }
+    virtual bool is_open() const override { return m_output_stream->is_open(); }
+    virtual void close() override { }
+
+    ErrorOr<void> final_flush();
+
+    static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes);
+
+    struct Sequence {
+        u32 literal_length { 0 };
+        u32 match_length { 0 };
+        u32 offset_value { 0 };
+    };
+
+private:
+    ZstdCompressor(MaybeOwned<AK::Stream>, ByteBuffer window);
+
+    ErrorOr<void> write_frame_header();
+    ErrorOr<void> flush_block(bool is_last);
+    ErrorOr<ByteBuffer> compress_block();
+
+    MaybeOwned<AK::Stream> m_output_stream;
+    bool m_wrote_frame_header { false };
+    bool m_finished { false };
+
+    // The previous block, followed by the block that is being collected.
+    ByteBuffer m_window;
+    size_t m_dictionary_size { 0 };
+    size_t m_block_size { 0 };
+
+    MatchFinder m_match_finder;
+    u32 m_repeated_offsets[3] { 1, 4, 8 };
+};
+
+}
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Platform.h>
 #include <AK/Vector.h>
 #include <LibCore/DirIterator.h>
 #include <errno.h>
@@ -33,6 +34,8 @@ DirIterator::DirIterator(DirIterator&& other)
     : m_dir(other.m_dir)
     , m_error(other.m_error)
     , m_next(move(other.m_next))
+    , m_next_stat(move(other.m_next_stat))
+    , m_current_stat(move(other.m_current_stat))
     , m_path(move(other.m_path))
     , m_flags(other.m_flags)
 {
@@ -46,7 +49,16 @@ bool DirIterator::advance_next()
 
     while (true) {
         errno = 0;
+        m_next_stat.clear();
+#ifdef AK_OS_SERENITY
+        struct stat st;
+        int has_stat = 0;
+        auto* de = (m_flags & Flags::StatEntries) ? readdir_with_stat(m_dir, &st, &has_stat) : readdir(m_dir);
+        if (has_stat)
+            m_next_stat = st;
+#else
         auto* de = readdir(m_dir);
+#endif
         if (!de) {
             m_error = errno;
             m_next = DeprecatedString();
@@ -82,6 +94,8 @@ DeprecatedString DirIterator::next_path()
 
     auto tmp = m_next;
     m_next = DeprecatedString();
+    m_current_stat = m_next_stat;
+    m_next_stat.clear();
     return tmp;
 }
 
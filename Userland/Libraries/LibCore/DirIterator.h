@@ -7,8 +7,10 @@
 #pragma once
 
 #include <AK/DeprecatedString.h>
+#include <AK/Optional.h>
 #include <dirent.h>
 #include <string.h>
+#include <sys/stat.h>
 
 namespace Core {
 
@@ -18,6 +20,8 @@ public:
         NoFlags = 0x0,
         SkipDots = 0x1,
         SkipParentAndBaseDir = 0x2,
+        // Asks for the metadata of entries to come along with them, see current_stat().
+        StatEntries = 0x4,
     };
 
     explicit DirIterator(DeprecatedString path, Flags = Flags::NoFlags);
@@ -34,10 +38,16 @@ public:
     DeprecatedString next_full_path();
     int fd() const;
 
+    // The metadata of the entry that was last returned by next_path() or next_full_path(), as if by lstat(), if it came
+    // along with the entry. Always empty without Flags::StatEntries, and where the system can't provide it.
+    Optional<struct stat> const& current_stat() const { return m_current_stat; }
+
 private:
     DIR* m_dir = nullptr;
     int m_error = 0;
     DeprecatedString m_next;
+    Optional<struct stat> m_next_stat;
+    Optional<struct stat> m_current_stat;
     DeprecatedString m_path;
     int m_flags;
 
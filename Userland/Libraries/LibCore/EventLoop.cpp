@@ -38,6 +38,7 @@
 
 #ifdef AK_OS_SERENITY
 #    include <LibCore/Account.h>
+#    include <sys/epoll.h>
 
 extern bool s_global_initializers_ran;
 #endif
@@ -76,6 +77,57 @@ static thread_local HashTable<Notifier*>* s_notifiers;
 thread_local int EventLoop::s_wake_pipe_fds[2];
 thread_local bool EventLoop::s_wake_pipe_initialized { false };
 
+#ifdef AK_OS_SERENITY
+// On Serenity, the notifiers (and the wake pipe) are kept registered with an epoll instance,
+// so waiting for events doesn't have to hand every file descriptor to the kernel each time.
+static thread_local int s_epoll_fd { -1 };
+static thread_local HashMap<int, Vector<Notifier*, 1>>* s_notifiers_by_fd;
+
+static void initialize_epoll(int wake_pipe_fd)
+{
+    if (s_epoll_fd >= 0)
+        return;
+    s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    VERIFY(s_epoll_fd >= 0);
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = wake_pipe_fd;
+    int rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, wake_pipe_fd, &event);
+    VERIFY(rc == 0);
+}
+
+// Brings the epoll interest for `fd` in line with the combined event masks of its notifiers.
+static void update_epoll_interest(int fd)
+{
+    u32 events = 0;
+    if (auto it = s_notifiers_by_fd->find(fd); it != s_notifiers_by_fd->end()) {
+        for (auto* notifier : it->value) {
+            if (notifier->event_mask() & Notifier::Read)
+                events |= EPOLLIN;
+            if (notifier->event_mask() & Notifier::Write)
+                events |= EPOLLOUT;
+            if (notifier->event_mask() & Notifier::Exceptional)
+                VERIFY_NOT_REACHED();
+        }
+    }
+
+    if (events == 0) {
+        // NOTE: This fails if the file descriptor has already been closed, which is fine, the kernel drops the interest on its own.
+        (void)epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        return;
+    }
+
+    epoll_event event {};
+    event.events = events;
+    event.data.fd = fd;
+    if (epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event) < 0 && errno == ENOENT) {
+        if (epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+            dbgln("Core::EventLoop: Failed to watch fd {}: {}", fd, strerror(errno));
+    }
+}
+#endif
+
 void EventLoop::initialize_wake_pipes()
 {
     if (!s_wake_pipe_initialized) {
@@ -330,6 +382,9 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
         s_event_loop_stack = new Vector<EventLoop&>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
         s_notifiers = new HashTable<Notifier*>;
+#ifdef AK_OS_SERENITY
+        s_notifiers_by_fd = new HashMap<int, Vector<Notifier*, 1>>;
+#endif
     }
 
     if (s_event_loop_stack->is_empty()) {
@@ -351,6 +406,9 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
     }
 
     initialize_wake_pipes();
+#ifdef AK_OS_SERENITY
+    initialize_epoll(s_wake_pipe_fds[0]);
+#endif
 
     dbgln_if(EVENTLOOP_DEBUG, "{} Core::EventLoop constructed :)", getpid());
 }
@@ -667,6 +725,13 @@ void EventLoop::notify_forked(ForkEvent event)
         s_notifiers->clear();
         s_wake_pipe_initialized = false;
         initialize_wake_pipes();
+#ifdef AK_OS_SERENITY
+        // NOTE: The epoll instance is shared with the parent, which still wants to hear about its notifiers.
+        s_notifiers_by_fd->clear();
+        close(s_epoll_fd);
+        s_epoll_fd = -1;
+        initialize_epoll(s_wake_pipe_fds[0]);
+#endif
         if (auto* info = signals_info<false>()) {
             info->signal_handlers.clear();
             info->next_signal_id = 0;
@@ -680,6 +745,10 @@ void EventLoop::notify_forked(ForkEvent event)
 
 void EventLoop::wait_for_event(WaitMode mode)
 {
+#ifdef AK_OS_SERENITY
+    epoll_event events[64];
+retry:
+#else
     fd_set rfds;
     fd_set wfds;
 retry:
@@ -709,6 +778,7 @@ retry:
         if (notifier->event_mask() & Notifier::Exceptional)
             VERIFY_NOT_REACHED();
     }
+#endif
 
     bool queued_events_is_empty;
     {
@@ -719,7 +789,7 @@ retry:
     // Figure out how long to wait at maximum.
     // This mainly depends on the WaitMode and whether we have pending events, but also the next expiring timer.
     Time now;
-    struct timeval timeout = { 0, 0 };
+    Time timeout;
     bool should_wait_forever = false;
     if (mode == WaitMode::WaitForEvents && queued_events_is_empty) {
         auto next_timer_expiration = get_next_timer_expiration();
@@ -728,15 +798,21 @@ retry:
             auto computed_timeout = next_timer_expiration.value() - now;
             if (computed_timeout.is_negative())
                 computed_timeout = Time::zero();
-            timeout = computed_timeout.to_timeval();
+            timeout = computed_timeout;
         } else {
             should_wait_forever = true;
         }
     }
 
 try_select_again:
+#ifdef AK_OS_SERENITY
+    // Wait for file system events, calls to wake(), POSIX signals, or timer expirations.
+    int marked_fd_count = epoll_wait(s_epoll_fd, events, array_size(events), should_wait_forever ? -1 : static_cast<int>(timeout.to_milliseconds()));
+#else
     // select() and wait for file system events, calls to wake(), POSIX signals, or timer expirations.
-    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+    auto timeout_timeval = timeout.to_timeval();
+    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout_timeval);
+#endif
     // Because POSIX, we might spuriously return from select() with EINTR; just select again.
     if (marked_fd_count < 0) {
         int saved_errno = errno;
@@ -749,9 +825,19 @@ try_select_again:
         VERIFY_NOT_REACHED();
     }
 
+#ifdef AK_OS_SERENITY
+    bool wake_pipe_is_readable = false;
+    for (int i = 0; i < marked_fd_count; ++i) {
+        if (events[i].data.fd == s_wake_pipe_fds[0])
+            wake_pipe_is_readable = true;
+    }
+#else
+    bool wake_pipe_is_readable = FD_ISSET(s_wake_pipe_fds[0], &rfds);
+#endif
+
     // We woke up due to a call to wake() or a POSIX signal.
     // Handle signals and see whether we need to handle events as well.
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+    if (wake_pipe_is_readable) {
         int wake_events[8];
         ssize_t nread;
         // We might receive another signal while read()ing here. The signal will go to the handle_signal properly,
@@ -811,6 +897,20 @@ try_select_again:
         return;
 
     // Handle file system notifiers by making them normal events.
+#ifdef AK_OS_SERENITY
+    for (int i = 0; i < marked_fd_count; ++i) {
+        auto& event = events[i];
+        auto it = s_notifiers_by_fd->find(event.data.fd);
+        if (it == s_notifiers_by_fd->end())
+            continue;
+        for (auto* notifier : it->value) {
+            if ((event.events & EPOLLIN) && (notifier->event_mask() & Notifier::Event::Read))
+                post_event(*notifier, make<NotifierReadEvent>(notifier->fd()));
+            if ((event.events & EPOLLOUT) && (notifier->event_mask() & Notifier::Event::Write))
+                post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
+        }
+    }
+#else
     for (auto& notifier : *s_notifiers) {
         if (FD_ISSET(notifier->fd(), &rfds)) {
             if (notifier->event_mask() & Notifier::Event::Read)
@@ -821,6 +921,7 @@ try_select_again:
                 post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
         }
     }
+#endif
 }
 
 bool EventLoopTimer::has_expired(Time const& now) const
@@ -884,13 +985,35 @@ bool EventLoop::unregister_timer(int timer_id)
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
     VERIFY_EVENT_LOOP_INITIALIZED();
-    s_notifiers->set(&notifier);
+    if (s_notifiers->set(&notifier) != HashSetResult::InsertedNewEntry)
+        return;
+#ifdef AK_OS_SERENITY
+    s_notifiers_by_fd->ensure(notifier.fd()).append(&notifier);
+    update_epoll_interest(notifier.fd());
+#endif
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
     VERIFY_EVENT_LOOP_INITIALIZED();
-    s_notifiers->remove(&notifier);
+    if (!s_notifiers->remove(&notifier))
+        return;
+#ifdef AK_OS_SERENITY
+    if (auto it = s_notifiers_by_fd->find(notifier.fd()); it != s_notifiers_by_fd->end()) {
+        it->value.remove_first_matching([&](auto* entry) { return entry == &notifier; });
+        if (it->value.is_empty())
+            s_notifiers_by_fd->remove(it);
+    }
+    update_epoll_interest(notifier.fd());
+#endif
+}
+
+void EventLoop::update_notifier(Badge<Notifier>, [[maybe_unused]] Notifier& notifier)
+{
+#ifdef AK_OS_SERENITY
+    if (s_notifiers && s_notifiers->contains(&notifier))
+        update_epoll_interest(notifier.fd());
+#endif
 }
 
 void EventLoop::wake_current()
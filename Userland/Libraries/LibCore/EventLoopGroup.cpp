@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/AtomicRefCounted.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/EventLoopGroup.h>
+#include <LibCore/TCPServer.h>
+#include <unistd.h>
+
+namespace Core {
+
+ErrorOr<NonnullOwnPtr<EventLoopGroup>> EventLoopGroup::try_create(size_t thread_count)
+{
+    if (thread_count == 0)
+        thread_count = max(sysconf(_SC_NPROCESSORS_ONLN), 1l);
+
+    auto group = TRY(adopt_nonnull_own_or_enomem(new (nothrow) EventLoopGroup));
+    TRY(group->m_workers.try_ensure_capacity(thread_count));
+    for (size_t i = 0; i < thread_count; ++i) {
+        auto worker = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Worker));
+        if (auto rc = pthread_create(&worker->thread, nullptr, run_worker, worker.ptr()); rc != 0)
+            return Error::from_errno(rc);
+#ifdef AK_OS_SERENITY
+        (void)pthread_setname_np(worker->thread, "EventLoopGroup");
+#endif
+
+        // Wait for the loop to exist, so that work can be handed to it right away.
+        {
+            Threading::MutexLocker locker(worker->mutex);
+            while (!worker->event_loop)
+                worker->event_loop_started.wait();
+        }
+
+        group->m_workers.unchecked_append(move(worker));
+    }
+    return group;
+}
+
+EventLoopGroup::~EventLoopGroup()
+{
+    for (auto& worker : m_workers) {
+        auto& event_loop = *worker->event_loop;
+        event_loop.deferred_invoke([&event_loop] { event_loop.quit(0); });
+        event_loop.wake();
+    }
+    for (auto& worker : m_workers)
+        pthread_join(worker->thread, nullptr);
+}
+
+void* EventLoopGroup::run_worker(void* argument)
+{
+    auto& worker = *static_cast<Worker*>(argument);
+    EventLoop event_loop;
+    {
+        Threading::MutexLocker locker(worker.mutex);
+        worker.event_loop = &event_loop;
+        worker.event_loop_started.signal();
+    }
+    event_loop.exec();
+    return nullptr;
+}
+
+EventLoop& EventLoopGroup::next_event_loop()
+{
+    return *m_workers[m_next_worker.fetch_add(1) % m_workers.size()]->event_loop;
+}
+
+void EventLoopGroup::deferred_invoke(Function<void()> invokee)
+{
+    auto& event_loop = next_event_loop();
+    event_loop.deferred_invoke(move(invokee));
+    event_loop.wake();
+}
+
+void EventLoopGroup::distribute_connections(TCPServer& server, Function<void(NonnullOwnPtr<Stream::TCPSocket>)> on_accept)
+{
+    // Note: Connections that have been accepted but not handed over yet keep the handler alive, even if the server is gone by then.
+    struct AcceptHandler : public AtomicRefCounted<AcceptHandler> {
+        explicit AcceptHandler(Function<void(NonnullOwnPtr<Stream::TCPSocket>)> on_accept)
+            : on_accept(move(on_accept))
+        {
+        }
+
+        Function<void(NonnullOwnPtr<Stream::TCPSocket>)> on_accept;
+    };
+    auto handler = adopt_ref(*new AcceptHandler(move(on_accept)));
+
+    server.on_ready_to_accept = [this, &server, handler] {
+        auto maybe_fd = server.accept_fd();
+        if (maybe_fd.is_error()) {
+            dbgln("EventLoopGroup: Failed to accept a connection: {}", maybe_fd.error());
+            return;
+        }
+
+        // The socket is only created on the loop that's going to serve it, so that its notifier ends up on that loop.
+        deferred_invoke([handler, fd = maybe_fd.value()] {
+            auto maybe_socket = Stream::TCPSocket::adopt_fd(fd);
+            if (maybe_socket.is_error()) {
+                dbgln("EventLoopGroup: Failed to adopt an accepted connection: {}", maybe_socket.error());
+                ::close(fd);
+                return;
+            }
+            handler->on_accept(maybe_socket.release_value());
+        });
+    };
+}
+
+}
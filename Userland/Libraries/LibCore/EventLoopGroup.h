@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Error.h>
+#include <AK/Function.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Vector.h>
+#include <LibCore/Forward.h>
+#include <LibCore/Stream.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <pthread.h>
+
+namespace Core {
+
+// A set of threads that each run an event loop of their own, for servers that want to spread their clients over all cores.
+// Work handed to the group goes to its loops in turn. Everything that happens on a loop stays on that loop's thread, so
+// each client is still handled single-threadedly, as usual.
+class EventLoopGroup {
+    AK_MAKE_NONCOPYABLE(EventLoopGroup);
+    AK_MAKE_NONMOVABLE(EventLoopGroup);
+
+public:
+    // Starts `thread_count` threads, or one per processor if that's zero.
+    static ErrorOr<NonnullOwnPtr<EventLoopGroup>> try_create(size_t thread_count = 0);
+    // Quits all loops and waits for their threads to exit.
+    ~EventLoopGroup();
+
+    size_t size() const { return m_workers.size(); }
+
+    // The loop that the next piece of work is going to.
+    EventLoop& next_event_loop();
+
+    // Runs `invokee` on the next loop.
+    void deferred_invoke(Function<void()> invokee);
+
+    // Accepts the connections of `server` on the current thread's loop, and hands them to the group's loops in turn.
+    // on_accept is called on the thread of the loop that's going to serve the connection, and the socket it gets belongs
+    // to that loop. This takes over the server's on_ready_to_accept.
+    void distribute_connections(TCPServer& server, Function<void(NonnullOwnPtr<Stream::TCPSocket>)> on_accept);
+
+private:
+    struct Worker {
+        pthread_t thread {};
+        EventLoop* event_loop { nullptr };
+        Threading::Mutex mutex;
+        Threading::ConditionVariable event_loop_started { mutex };
+    };
+
+    EventLoopGroup() = default;
+
+    static void* run_worker(void*);
+
+    Vector<NonnullOwnPtr<Worker>> m_workers;
+    Atomic<size_t> m_next_worker { 0 };
+};
+
+}
@@ -13,8 +13,10 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <libgen.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <utime.h>
@@ -435,6 +437,49 @@ ErrorOr<void, File::CopyError> File::copy_file_or_directory(DeprecatedString con
     return copy_file(dst_path, src_stat, source, preserve_mode);
 }
 
+// Note: The umask can't be looked at without changing it, so this keeps other threads that copy files from ever seeing it
+//       while it's 0.
+static mode_t current_umask()
+{
+    static pthread_mutex_t s_umask_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_mutex_lock(&s_umask_mutex);
+    auto mask = umask(0);
+    umask(mask);
+    pthread_mutex_unlock(&s_umask_mutex);
+    return mask;
+}
+
+static ErrorOr<void, File::CopyError> write_all(int fd, u8 const* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t nwritten = ::write(fd, data, size);
+        if (nwritten < 0)
+            return File::CopyError { errno, false };
+
+        VERIFY(nwritten > 0);
+        size -= nwritten;
+        data += nwritten;
+    }
+    return {};
+}
+
+// Copies from the page cache of the source straight into the destination, without reading into a buffer of our own first.
+// Returns false if the source can't be mapped, in which case nothing has been written.
+static ErrorOr<bool, File::CopyError> copy_file_contents_mapped(int dst_fd, int src_fd, struct stat const& src_stat)
+{
+    if (!S_ISREG(src_stat.st_mode) || src_stat.st_size <= 0)
+        return false;
+
+    auto size = static_cast<size_t>(src_stat.st_size);
+    auto* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, src_fd, 0);
+    if (data == MAP_FAILED)
+        return false;
+
+    ScopeGuard unmap_guard([data, size] { munmap(data, size); });
+    TRY(write_all(dst_fd, static_cast<u8 const*>(data), size));
+    return true;
+}
+
 ErrorOr<void, File::CopyError> File::copy_file(DeprecatedString const& dst_path, struct stat const& src_stat, File& source, PreserveMode preserve_mode)
 {
     int dst_fd = creat(dst_path.characters(), 0666);
@@ -455,29 +500,20 @@ ErrorOr<void, File::CopyError> File::copy_file(DeprecatedString const& dst_path,
             return CopyError { errno, false };
     }
 
-    for (;;) {
-        char buffer[32768];
-        ssize_t nread = ::read(source.fd(), buffer, sizeof(buffer));
-        if (nread < 0) {
-            return CopyError { errno, false };
-        }
-        if (nread == 0)
-            break;
-        ssize_t remaining_to_write = nread;
-        char* bufptr = buffer;
-        while (remaining_to_write) {
-            ssize_t nwritten = ::write(dst_fd, bufptr, remaining_to_write);
-            if (nwritten < 0)
+    if (!TRY(copy_file_contents_mapped(dst_fd, source.fd(), src_stat))) {
+        for (;;) {
+            u8 buffer[32768];
+            ssize_t nread = ::read(source.fd(), buffer, sizeof(buffer));
+            if (nread < 0) {
                 return CopyError { errno, false };
-
-            VERIFY(nwritten > 0);
-            remaining_to_write -= nwritten;
-            bufptr += nwritten;
+            }
+            if (nread == 0)
+                break;
+            TRY(write_all(dst_fd, buffer, nread));
         }
     }
 
-    auto my_umask = umask(0);
-    umask(my_umask);
+    auto my_umask = current_umask();
     // NOTE: We don't copy the set-uid and set-gid bits unless requested.
     if (!has_flag(preserve_mode, PreserveMode::Permissions))
         my_umask |= 06000;
@@ -534,8 +570,12 @@ ErrorOr<void, File::CopyError> File::copy_directory(DeprecatedString const& dst_
             return result.error();
     }
 
-    auto my_umask = umask(0);
-    umask(my_umask);
+    return copy_directory_attributes(dst_path, src_stat, preserve_mode);
+}
+
+ErrorOr<void, File::CopyError> File::copy_directory_attributes(DeprecatedString const& dst_path, struct stat const& src_stat, PreserveMode preserve_mode)
+{
+    auto my_umask = current_umask();
 
     if (chmod(dst_path.characters(), src_stat.st_mode & ~my_umask) < 0)
         return CopyError { errno, false };
@@ -88,6 +88,9 @@ public:
 
     static ErrorOr<void, CopyError> copy_file(DeprecatedString const& dst_path, struct stat const& src_stat, File& source, PreserveMode = PreserveMode::Nothing);
     static ErrorOr<void, CopyError> copy_directory(DeprecatedString const& dst_path, DeprecatedString const& src_path, struct stat const& src_stat, LinkMode = LinkMode::Disallowed, PreserveMode = PreserveMode::Nothing);
+    // Gives a copied directory the mode (and, if asked to, the ownership and timestamps) of the original, once everything
+    // has been copied into it.
+    static ErrorOr<void, CopyError> copy_directory_attributes(DeprecatedString const& dst_path, struct stat const& src_stat, PreserveMode = PreserveMode::Nothing);
     static ErrorOr<void, CopyError> copy_file_or_directory(DeprecatedString const& dst_path, DeprecatedString const& src_path, RecursionMode = RecursionMode::Allowed, LinkMode = LinkMode::Disallowed, AddDuplicateFileMarker = AddDuplicateFileMarker::Yes, PreserveMode = PreserveMode::Nothing);
 
     static DeprecatedString real_path_for(DeprecatedString const& filename);
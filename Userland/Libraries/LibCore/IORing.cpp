@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <LibCore/IORing.h>
+#include <LibCore/System.h>
+#include <sys/mman.h>
+
+namespace Core {
+
+ErrorOr<NonnullRefPtr<IORing>> IORing::try_create(u32 entries, Object* parent)
+{
+    auto layout = io_ring_layout(entries);
+    int fd = TRY(Core::System::io_ring_create(entries, O_CLOEXEC));
+    auto mapping_or_error = Core::System::mmap(nullptr, layout.mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0, 0, "IORing"sv);
+    if (mapping_or_error.is_error()) {
+        (void)Core::System::close(fd);
+        return mapping_or_error.release_error();
+    }
+    auto* mapping = static_cast<u8*>(mapping_or_error.release_value());
+    auto io_ring_or_error = adopt_nonnull_ref_or_enomem(new (nothrow) IORing(fd, layout, mapping, parent));
+    if (io_ring_or_error.is_error()) {
+        (void)Core::System::munmap(mapping, layout.mapping_size);
+        (void)Core::System::close(fd);
+    }
+    return io_ring_or_error;
+}
+
+IORing::IORing(int fd, IORingLayout const& layout, u8* mapping, Object* parent)
+    : Object(parent)
+    , m_fd(fd)
+    , m_layout(layout)
+    , m_mapping(mapping)
+{
+    VERIFY(m_fd >= 0);
+}
+
+IORing::~IORing()
+{
+    MUST(Core::System::munmap(m_mapping, m_layout.mapping_size));
+    MUST(Core::System::close(m_fd));
+}
+
+ErrorOr<void> IORing::enqueue(IORingSubmission& submission, Callback callback)
+{
+    // If the submission queue is full, hand what we have to the kernel to make room.
+    auto head = AK::atomic_load(&header().submission_head, AK::MemoryOrder::memory_order_acquire);
+    if (m_submission_tail - head >= m_layout.submission_entries) {
+        TRY(submit());
+        head = AK::atomic_load(&header().submission_head, AK::MemoryOrder::memory_order_acquire);
+        if (m_submission_tail - head >= m_layout.submission_entries)
+            return Error::from_errno(EBUSY);
+    }
+
+    submission.user_data = m_next_user_data++;
+    TRY(m_callbacks.try_set(submission.user_data, move(callback)));
+
+    submissions()[m_submission_tail & (m_layout.submission_entries - 1)] = submission;
+    ++m_submission_tail;
+    ++m_unsubmitted_count;
+    AK::atomic_store(&header().submission_tail, m_submission_tail, AK::MemoryOrder::memory_order_release);
+
+    if (!m_submit_scheduled) {
+        m_submit_scheduled = true;
+        deferred_invoke([this] {
+            m_submit_scheduled = false;
+            if (auto result = submit(); result.is_error())
+                dbgln("IORing: Failed to submit: {}", result.error());
+        });
+    }
+    return {};
+}
+
+ErrorOr<void> IORing::submit()
+{
+    while (m_unsubmitted_count > 0) {
+        auto submitted = TRY(Core::System::io_ring_enter(m_fd, m_unsubmitted_count));
+        m_unsubmitted_count -= submitted;
+        // NOTE: The kernel stops consuming submissions while the completion queue is full,
+        //       so keep going as long as draining it makes room for more.
+        auto completed = dispatch_completions();
+        if (submitted == 0 && completed == 0)
+            return Error::from_errno(EBUSY);
+    }
+    dispatch_completions();
+    return {};
+}
+
+size_t IORing::dispatch_completions()
+{
+    size_t count = 0;
+    auto& header = this->header();
+    auto tail = AK::atomic_load(&header.completion_tail, AK::MemoryOrder::memory_order_acquire);
+    auto head = header.completion_head;
+    while (head != tail) {
+        auto completion = completions()[head & (m_layout.completion_entries - 1)];
+        ++head;
+        AK::atomic_store(&header.completion_head, head, AK::MemoryOrder::memory_order_release);
+
+        auto callback = m_callbacks.take(completion.user_data);
+        VERIFY(callback.has_value());
+        if (completion.result < 0)
+            callback.value()(Error::from_errno(static_cast<int>(-completion.result)));
+        else
+            callback.value()(completion.result);
+        ++count;
+    }
+    return count;
+}
+
+ErrorOr<void> IORing::read(int fd, Bytes buffer, i64 offset, Callback callback)
+{
+    IORingSubmission submission {};
+    submission.opcode = IORingOpcode::Read;
+    submission.fd = fd;
+    submission.offset = offset;
+    submission.address = reinterpret_cast<FlatPtr>(buffer.data());
+    submission.length = buffer.size();
+    return enqueue(submission, move(callback));
+}
+
+ErrorOr<void> IORing::write(int fd, ReadonlyBytes buffer, i64 offset, Callback callback)
+{
+    IORingSubmission submission {};
+    submission.opcode = IORingOpcode::Write;
+    submission.fd = fd;
+    submission.offset = offset;
+    submission.address = reinterpret_cast<FlatPtr>(buffer.data());
+    submission.length = buffer.size();
+    return enqueue(submission, move(callback));
+}
+
+ErrorOr<void> IORing::accept(int fd, sockaddr* address, socklen_t* address_size, int flags, Callback callback)
+{
+    IORingSubmission submission {};
+    submission.opcode = IORingOpcode::Accept;
+    submission.fd = fd;
+    submission.address = reinterpret_cast<FlatPtr>(address);
+    submission.offset = static_cast<i64>(reinterpret_cast<FlatPtr>(address_size));
+    submission.flags = flags;
+    return enqueue(submission, move(callback));
+}
+
+ErrorOr<void> IORing::send_message(int fd, msghdr const& message, int flags, Callback callback)
+{
+    IORingSubmission submission {};
+    submission.opcode = IORingOpcode::SendMessage;
+    submission.fd = fd;
+    submission.address = reinterpret_cast<FlatPtr>(&message);
+    submission.flags = flags;
+    return enqueue(submission, move(callback));
+}
+
+ErrorOr<void> IORing::receive_message(int fd, msghdr& message, int flags, Callback callback)
+{
+    IORingSubmission submission {};
+    submission.opcode = IORingOpcode::ReceiveMessage;
+    submission.fd = fd;
+    submission.address = reinterpret_cast<FlatPtr>(&message);
+    submission.flags = flags;
+    return enqueue(submission, move(callback));
+}
+
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/Span.h>
+#include <Kernel/API/IORing.h>
+#include <LibCore/Object.h>
+#include <sys/socket.h>
+
+namespace Core {
+
+// Batches file and socket operations into a single kernel entry.
+//
+// Operations are queued as they are requested, and submitted together on the next event loop iteration
+// (or when the submission queue fills up). The completion callbacks are invoked once the kernel is done with them.
+// NOTE: Buffers passed to an operation must stay alive until its callback has been invoked.
+class IORing final : public Object {
+    C_OBJECT_ABSTRACT(IORing)
+public:
+    using Callback = Function<void(ErrorOr<i64>)>;
+
+    static ErrorOr<NonnullRefPtr<IORing>> try_create(u32 entries = 256, Object* parent = nullptr);
+    virtual ~IORing() override;
+
+    // An offset of -1 uses (and advances) the current file offset.
+    ErrorOr<void> read(int fd, Bytes, i64 offset, Callback);
+    ErrorOr<void> write(int fd, ReadonlyBytes, i64 offset, Callback);
+    // The result is the file descriptor of the accepted socket.
+    ErrorOr<void> accept(int fd, sockaddr*, socklen_t*, int flags, Callback);
+    ErrorOr<void> send_message(int fd, msghdr const&, int flags, Callback);
+    ErrorOr<void> receive_message(int fd, msghdr&, int flags, Callback);
+
+    // Submits everything that has been queued so far, and dispatches the completions that are available.
+    ErrorOr<void> submit();
+
+    size_t pending_operation_count() const { return m_callbacks.size(); }
+
+private:
+    IORing(int fd, IORingLayout const&, u8* mapping, Object* parent);
+
+    ErrorOr<void> enqueue(IORingSubmission&, Callback);
+    size_t dispatch_completions();
+
+    IORingHeader& header() { return *reinterpret_cast<IORingHeader*>(m_mapping); }
+    IORingSubmission* submissions() { return reinterpret_cast<IORingSubmission*>(m_mapping + m_layout.submissions_offset); }
+    IORingCompletion* completions() { return reinterpret_cast<IORingCompletion*>(m_mapping + m_layout.completions_offset); }
+
+    int m_fd { -1 };
+    IORingLayout m_layout;
+    u8* m_mapping { nullptr };
+
+    u32 m_submission_tail { 0 };
+    u32 m_unsubmitted_count { 0 };
+    bool m_submit_scheduled { false };
+
+    u64 m_next_user_data { 1 };
+    HashMap<u64, Callback> m_callbacks;
+};
+
+}
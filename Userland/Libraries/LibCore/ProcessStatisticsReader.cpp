@@ -4,94 +4,222 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <AK/ByteBuffer.h>
-#include <AK/JsonArray.h>
-#include <AK/JsonObject.h>
-#include <AK/JsonValue.h>
+#include <Kernel/API/ProcessStatistics.h>
 #include <LibCore/ProcessStatisticsReader.h>
 #include <pwd.h>
+#include <string.h>
 
 namespace Core {
 
 HashMap<uid_t, DeprecatedString> ProcessStatisticsReader::s_usernames;
 
-ErrorOr<AllProcessesStatistics> ProcessStatisticsReader::get_all(SeekableStream& proc_all_file, bool include_usernames)
+namespace {
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(ReadonlyBytes bytes)
+        : m_bytes(bytes)
+    {
+    }
+
+    template<typename T>
+    ErrorOr<T> read()
+    {
+        auto bytes = TRY(read_bytes(sizeof(T)));
+        T value;
+        memcpy(&value, bytes.data(), sizeof(T));
+        return value;
+    }
+
+    // The strings after an entry are padded to a multiple of 8 bytes together.
+    template<size_t count>
+    ErrorOr<Array<DeprecatedString, count>> read_strings(Array<size_t, count> lengths)
+    {
+        Array<DeprecatedString, count> strings;
+        size_t total_length = 0;
+        for (size_t i = 0; i < count; ++i) {
+            strings[i] = StringView { TRY(read_bytes(lengths[i])) };
+            total_length += lengths[i];
+        }
+        TRY(read_bytes(align_up_to(total_length, 8) - total_length));
+        return strings;
+    }
+
+private:
+    ErrorOr<ReadonlyBytes> read_bytes(size_t count)
+    {
+        if (m_bytes.size() - m_offset < count)
+            return Error::from_string_literal("ProcessStatisticsReader: Snapshot is truncated");
+        auto bytes = m_bytes.slice(m_offset, count);
+        m_offset += count;
+        return bytes;
+    }
+
+    ReadonlyBytes m_bytes;
+    size_t m_offset { 0 };
+};
+
+}
+
+static StringView veil_name(ProcessStatisticsEntry::Veil veil)
 {
-    TRY(proc_all_file.seek(0, SeekMode::SetPosition));
+    switch (veil) {
+    case ProcessStatisticsEntry::Veil::NotApplicable:
+        return ""sv;
+    case ProcessStatisticsEntry::Veil::None:
+        return "None"sv;
+    case ProcessStatisticsEntry::Veil::Dropped:
+        return "Dropped"sv;
+    case ProcessStatisticsEntry::Veil::Locked:
+        return "Locked"sv;
+    }
+    return ""sv;
+}
+
+static ErrorOr<NonnullOwnPtr<Stream::File>> open_statistics_file()
+{
+    return Stream::File::open("/sys/kernel/process_statistics"sv, Stream::OpenMode::Read);
+}
+
+ProcessStatisticsReader::ProcessStatisticsReader(NonnullOwnPtr<Stream::File> file, bool include_usernames)
+    : m_file(move(file))
+    , m_include_usernames(include_usernames)
+{
+}
+
+ErrorOr<NonnullOwnPtr<ProcessStatisticsReader>> ProcessStatisticsReader::create(bool include_usernames)
+{
+    auto file = TRY(open_statistics_file());
+    return adopt_nonnull_own_or_enomem(new (nothrow) ProcessStatisticsReader(move(file), include_usernames));
+}
+
+ErrorOr<void> ProcessStatisticsReader::update()
+{
+    // Note: The file already has a snapshot in it from when it was opened, and seeking back to the start takes another.
+    if (m_has_read_snapshot)
+        TRY(m_file->seek(0, SeekMode::SetPosition));
+    auto contents = TRY(m_file->read_until_eof());
+    m_has_read_snapshot = true;
+
+    SnapshotReader reader(contents);
+    auto header = TRY(reader.read<ProcessStatisticsHeader>());
+    if (header.version != PROCESS_STATISTICS_VERSION)
+        return Error::from_string_literal("ProcessStatisticsReader: Unsupported snapshot version");
+    if (header.previous_generation != 0 && header.previous_generation != m_generation) {
+        // We've lost track of what the kernel sent us last (because we failed to parse it), so start over.
+        m_file = TRY(open_statistics_file());
+        m_has_read_snapshot = false;
+        return update();
+    }
+    // Until this snapshot is parsed, the next one can't be made sense of.
+    m_generation = 0;
+
+    HashMap<pid_t, size_t> previous_process_indices;
+    for (size_t i = 0; i < m_statistics.processes.size(); ++i)
+        TRY(previous_process_indices.try_set(m_statistics.processes[i].pid, i));
 
     AllProcessesStatistics all_processes_statistics;
+    TRY(all_processes_statistics.processes.try_ensure_capacity(header.process_count));
+    for (u32 i = 0; i < header.process_count; ++i) {
+        auto entry = TRY(reader.read<ProcessStatisticsEntry>());
+
+        ProcessStatistics* previous_process = nullptr;
+        if (auto index = previous_process_indices.get(entry.pid); index.has_value())
+            previous_process = &m_statistics.processes[*index];
 
-    auto file_contents = TRY(proc_all_file.read_until_eof());
-    auto json_obj = TRY(JsonValue::from_string(file_contents)).as_object();
-    json_obj.get_array("processes"sv)->for_each([&](auto& value) {
-        const JsonObject& process_object = value.as_object();
         Core::ProcessStatistics process;
+        if (has_flag(entry.flags, ProcessStatisticsEntry::Flags::Unchanged)) {
+            if (!previous_process)
+                return Error::from_string_literal("ProcessStatisticsReader: Unknown process is unchanged");
+            process = move(*previous_process);
+            process.threads.clear_with_capacity();
+        } else {
+            // kernel data first
+            process.pid = entry.pid;
+            process.pgid = entry.pgid;
+            process.pgp = entry.pgp;
+            process.sid = entry.sid;
+            process.uid = entry.uid;
+            process.gid = entry.gid;
+            process.ppid = entry.ppid;
+            process.nfds = entry.nfds;
+            process.kernel = has_flag(entry.flags, ProcessStatisticsEntry::Flags::Kernel);
+            auto strings = TRY(reader.read_strings<4>({ entry.name_length, entry.executable_length, entry.tty_length, entry.pledge_length }));
+            process.name = move(strings[0]);
+            process.executable = move(strings[1]);
+            process.tty = move(strings[2]);
+            process.pledge = move(strings[3]);
+            process.veil = veil_name(entry.veil);
+            process.amount_virtual = entry.amount_virtual;
+            process.amount_resident = entry.amount_resident;
+            process.amount_shared = entry.amount_shared;
+            process.amount_dirty_private = entry.amount_dirty_private;
+            process.amount_clean_inode = entry.amount_clean_inode;
+            process.amount_purgeable_volatile = entry.amount_purgeable_volatile;
+            process.amount_purgeable_nonvolatile = entry.amount_purgeable_nonvolatile;
+
+            // and synthetic data last
+            if (m_include_usernames)
+                process.username = username_from_uid(process.uid);
+        }
+
+        HashMap<pid_t, size_t> previous_thread_indices;
+        if (previous_process) {
+            for (size_t j = 0; j < previous_process->threads.size(); ++j)
+                TRY(previous_thread_indices.try_set(previous_process->threads[j].tid, j));
+        }
+
+        TRY(process.threads.try_ensure_capacity(entry.thread_count));
+        for (u32 j = 0; j < entry.thread_count; ++j) {
+            auto thread_entry = TRY(reader.read<ThreadStatisticsEntry>());
+            if (has_flag(thread_entry.flags, ThreadStatisticsEntry::Flags::Unchanged)) {
+                auto index = previous_thread_indices.get(thread_entry.tid);
+                if (!index.has_value())
+                    return Error::from_string_literal("ProcessStatisticsReader: Unknown thread is unchanged");
+                process.threads.unchecked_append(move(previous_process->threads[*index]));
+                continue;
+            }
 
-        // kernel data first
-        process.pid = process_object.get_u32("pid"sv).value_or(0);
-        process.pgid = process_object.get_u32("pgid"sv).value_or(0);
-        process.pgp = process_object.get_u32("pgp"sv).value_or(0);
-        process.sid = process_object.get_u32("sid"sv).value_or(0);
-        process.uid = process_object.get_u32("uid"sv).value_or(0);
-        process.gid = process_object.get_u32("gid"sv).value_or(0);
-        process.ppid = process_object.get_u32("ppid"sv).value_or(0);
-        process.nfds = process_object.get_u32("nfds"sv).value_or(0);
-        process.kernel = process_object.get_bool("kernel"sv).value_or(false);
-        process.name = process_object.get_deprecated_string("name"sv).value_or("");
-        process.executable = process_object.get_deprecated_string("executable"sv).value_or("");
-        process.tty = process_object.get_deprecated_string("tty"sv).value_or("");
-        process.pledge = process_object.get_deprecated_string("pledge"sv).value_or("");
-        process.veil = process_object.get_deprecated_string("veil"sv).value_or("");
-        process.amount_virtual = process_object.get_u32("amount_virtual"sv).value_or(0);
-        process.amount_resident = process_object.get_u32("amount_resident"sv).value_or(0);
-        process.amount_shared = process_object.get_u32("amount_shared"sv).value_or(0);
-        process.amount_dirty_private = process_object.get_u32("amount_dirty_private"sv).value_or(0);
-        process.amount_clean_inode = process_object.get_u32("amount_clean_inode"sv).value_or(0);
-        process.amount_purgeable_volatile = process_object.get_u32("amount_purgeable_volatile"sv).value_or(0);
-        process.amount_purgeable_nonvolatile = process_object.get_u32("amount_purgeable_nonvolatile"sv).value_or(0);
-
-        auto& thread_array = process_object.get_array("threads"sv).value();
-        process.threads.ensure_capacity(thread_array.size());
-        thread_array.for_each([&](auto& value) {
-            auto& thread_object = value.as_object();
             Core::ThreadStatistics thread;
-            thread.tid = thread_object.get_u32("tid"sv).value_or(0);
-            thread.times_scheduled = thread_object.get_u32("times_scheduled"sv).value_or(0);
-            thread.name = thread_object.get_deprecated_string("name"sv).value_or("");
-            thread.state = thread_object.get_deprecated_string("state"sv).value_or("");
-            thread.time_user = thread_object.get_u64("time_user"sv).value_or(0);
-            thread.time_kernel = thread_object.get_u64("time_kernel"sv).value_or(0);
-            thread.cpu = thread_object.get_u32("cpu"sv).value_or(0);
-            thread.priority = thread_object.get_u32("priority"sv).value_or(0);
-            thread.syscall_count = thread_object.get_u32("syscall_count"sv).value_or(0);
-            thread.inode_faults = thread_object.get_u32("inode_faults"sv).value_or(0);
-            thread.zero_faults = thread_object.get_u32("zero_faults"sv).value_or(0);
-            thread.cow_faults = thread_object.get_u32("cow_faults"sv).value_or(0);
-            thread.unix_socket_read_bytes = thread_object.get_u32("unix_socket_read_bytes"sv).value_or(0);
-            thread.unix_socket_write_bytes = thread_object.get_u32("unix_socket_write_bytes"sv).value_or(0);
-            thread.ipv4_socket_read_bytes = thread_object.get_u32("ipv4_socket_read_bytes"sv).value_or(0);
-            thread.ipv4_socket_write_bytes = thread_object.get_u32("ipv4_socket_write_bytes"sv).value_or(0);
-            thread.file_read_bytes = thread_object.get_u32("file_read_bytes"sv).value_or(0);
-            thread.file_write_bytes = thread_object.get_u32("file_write_bytes"sv).value_or(0);
-            process.threads.append(move(thread));
-        });
-
-        // and synthetic data last
-        if (include_usernames) {
-            process.username = username_from_uid(process.uid);
+            thread.tid = thread_entry.tid;
+            thread.times_scheduled = thread_entry.times_scheduled;
+            auto strings = TRY(reader.read_strings<2>({ thread_entry.name_length, thread_entry.state_length }));
+            thread.name = move(strings[0]);
+            thread.state = move(strings[1]);
+            thread.time_user = thread_entry.time_user;
+            thread.time_kernel = thread_entry.time_kernel;
+            thread.cpu = thread_entry.cpu;
+            thread.priority = thread_entry.priority;
+            thread.syscall_count = thread_entry.syscall_count;
+            thread.inode_faults = thread_entry.inode_faults;
+            thread.zero_faults = thread_entry.zero_faults;
+            thread.cow_faults = thread_entry.cow_faults;
+            thread.unix_socket_read_bytes = thread_entry.unix_socket_read_bytes;
+            thread.unix_socket_write_bytes = thread_entry.unix_socket_write_bytes;
+            thread.ipv4_socket_read_bytes = thread_entry.ipv4_socket_read_bytes;
+            thread.ipv4_socket_write_bytes = thread_entry.ipv4_socket_write_bytes;
+            thread.file_read_bytes = thread_entry.file_read_bytes;
+            thread.file_write_bytes = thread_entry.file_write_bytes;
+            process.threads.unchecked_append(move(thread));
         }
-        all_processes_statistics.processes.append(move(process));
-    });
 
-    all_processes_statistics.total_time_scheduled = json_obj.get_u64("total_time"sv).value_or(0);
-    all_processes_statistics.total_time_scheduled_kernel = json_obj.get_u64("total_time_kernel"sv).value_or(0);
-    return all_processes_statistics;
+        all_processes_statistics.processes.unchecked_append(move(process));
+    }
+
+    all_processes_statistics.total_time_scheduled = header.total_time_scheduled;
+    all_processes_statistics.total_time_scheduled_kernel = header.total_time_scheduled_kernel;
+    m_statistics = move(all_processes_statistics);
+    m_generation = header.generation;
+    return {};
 }
 
 ErrorOr<AllProcessesStatistics> ProcessStatisticsReader::get_all(bool include_usernames)
 {
-    auto proc_all_file = TRY(Core::Stream::File::open("/sys/kernel/processes"sv, Core::Stream::OpenMode::Read));
-    return get_all(*proc_all_file, include_usernames);
+    auto reader = TRY(create(include_usernames));
+    TRY(reader->update());
+    return move(reader->m_statistics);
 }
 
 DeprecatedString ProcessStatisticsReader::username_from_uid(uid_t uid)
@@ -34,7 +34,7 @@ struct ThreadStatistics {
 };
 
 struct ProcessStatistics {
-    // Keep this in sync with /sys/kernel/processes.
+    // Keep this in sync with /sys/kernel/process_statistics.
     // From the kernel side:
     pid_t pid;
     pid_t pgid;
@@ -66,18 +66,32 @@ struct ProcessStatistics {
 
 struct AllProcessesStatistics {
     Vector<ProcessStatistics> processes;
-    u64 total_time_scheduled;
-    u64 total_time_scheduled_kernel;
+    u64 total_time_scheduled { 0 };
+    u64 total_time_scheduled_kernel { 0 };
 };
 
+// Reads /sys/kernel/process_statistics. A reader that's kept around only gets what changed from the kernel on every
+// update after the first, which makes polling much cheaper than calling get_all() every time.
 class ProcessStatisticsReader {
 public:
-    static ErrorOr<AllProcessesStatistics> get_all(SeekableStream&, bool include_usernames = true);
     static ErrorOr<AllProcessesStatistics> get_all(bool include_usernames = true);
 
+    static ErrorOr<NonnullOwnPtr<ProcessStatisticsReader>> create(bool include_usernames = true);
+
+    ErrorOr<void> update();
+    AllProcessesStatistics const& statistics() const { return m_statistics; }
+
 private:
+    ProcessStatisticsReader(NonnullOwnPtr<Stream::File>, bool include_usernames);
+
     static DeprecatedString username_from_uid(uid_t);
     static HashMap<uid_t, DeprecatedString> s_usernames;
+
+    NonnullOwnPtr<Stream::File> m_file;
+    bool m_include_usernames { true };
+    bool m_has_read_snapshot { false };
+    u64 m_generation { 0 };
+    AllProcessesStatistics m_statistics;
 };
 
 }
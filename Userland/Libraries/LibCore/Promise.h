@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Coroutine.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/Object.h>
 
@@ -22,6 +23,8 @@ public:
         m_pending = move(result);
         if (on_resolved)
             on_resolved(m_pending.value());
+        if (auto awaiter = exchange(m_awaiter, {}))
+            awaiter.resume();
     }
 
     bool is_resolved()
@@ -37,6 +40,24 @@ public:
         return m_pending.release_value();
     }
 
+    // Lets coroutines `co_await *promise` instead of pumping the event loop.
+    // They're resumed from resolve(), after on_resolved has been called.
+    auto operator co_await()
+    {
+        struct Awaiter {
+            bool await_ready() const { return promise.is_resolved(); }
+            void await_suspend(std::coroutine_handle<> awaiter)
+            {
+                VERIFY(!promise.m_awaiter);
+                promise.m_awaiter = awaiter;
+            }
+            Result await_resume() { return promise.m_pending.release_value(); }
+
+            Promise& promise;
+        };
+        return Awaiter { *this };
+    }
+
     // Converts a Promise<A> to a Promise<B> using a function func: A -> B
     template<typename T>
     RefPtr<Promise<T>> map(T func(Result&))
@@ -53,5 +74,6 @@ private:
     Promise() = default;
 
     Optional<Result> m_pending;
+    std::coroutine_handle<> m_awaiter;
 };
 }
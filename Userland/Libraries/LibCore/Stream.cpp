@@ -280,6 +280,35 @@ ErrorOr<void> Socket::connect_inet(int fd, SocketAddress const& address)
     return System::connect(fd, bit_cast<struct sockaddr*>(&addr), sizeof(addr));
 }
 
+void Socket::ReadyToReadAwaiter::await_suspend(std::coroutine_handle<> awaiter)
+{
+    VERIFY(!m_socket.m_read_awaiter);
+    m_socket.m_read_awaiter = awaiter;
+    m_socket.set_notifications_enabled(true);
+}
+
+void Socket::notify_ready_to_read()
+{
+    if (auto awaiter = exchange(m_read_awaiter, {})) {
+        awaiter.resume();
+        return;
+    }
+    if (on_ready_to_read)
+        on_ready_to_read();
+}
+
+Coroutine<ErrorOr<Bytes>> Socket::async_read(Bytes buffer)
+{
+    while (true) {
+        auto can_read = can_read_without_blocking();
+        if (can_read.is_error())
+            co_return can_read.release_error();
+        if (can_read.value())
+            co_return read(buffer);
+        co_await ready_to_read();
+    }
+}
+
 ErrorOr<Bytes> PosixSocketHelper::read(Bytes buffer, int flags)
 {
     if (!is_open()) {
@@ -571,6 +600,13 @@ ErrorOr<Bytes> LocalSocket::read_without_waiting(Bytes buffer)
     return m_helper.read(buffer, MSG_DONTWAIT);
 }
 
+Optional<int> TCPSocket::fd() const
+{
+    if (!is_open())
+        return {};
+    return m_helper.fd();
+}
+
 Optional<int> LocalSocket::fd() const
 {
     if (!is_open())
@@ -10,6 +10,7 @@
 #include <AK/Badge.h>
 #include <AK/BufferedStream.h>
 #include <AK/CircularBuffer.h>
+#include <AK/Coroutine.h>
 #include <AK/DeprecatedStream.h>
 #include <AK/DeprecatedString.h>
 #include <AK/EnumBits.h>
@@ -66,6 +67,31 @@ public:
 
     Function<void()> on_ready_to_read;
 
+    class ReadyToReadAwaiter {
+    public:
+        explicit ReadyToReadAwaiter(Socket& socket)
+            : m_socket(socket)
+        {
+        }
+
+        bool await_ready() const { return false; }
+        void await_suspend(std::coroutine_handle<>);
+        void await_resume() const { }
+
+    private:
+        Socket& m_socket;
+    };
+
+    /// Suspends the calling coroutine until there's data to read (or the
+    /// other end has gone away), without blocking the event loop. Only one
+    /// coroutine can wait on a socket at a time, and it's resumed instead of
+    /// calling `on_ready_to_read`.
+    ReadyToReadAwaiter ready_to_read() { return ReadyToReadAwaiter { *this }; }
+
+    /// Like read(), but suspends the calling coroutine until the socket can
+    /// be read from instead of blocking or failing with EAGAIN.
+    Coroutine<ErrorOr<Bytes>> async_read(Bytes);
+
 protected:
     enum class SocketDomain {
         Local,
@@ -98,8 +124,12 @@ protected:
         return flags;
     }
 
+    // Called by the concrete sockets whenever their notifier says there's something to read.
+    void notify_ready_to_read();
+
 private:
     bool m_prevent_sigpipe { false };
+    std::coroutine_handle<> m_read_awaiter;
 };
 
 /// A reusable socket maintains state about being connected in addition to
@@ -293,6 +323,8 @@ public:
     ErrorOr<void> set_blocking(bool enabled) override { return m_helper.set_blocking(enabled); }
     ErrorOr<void> set_close_on_exec(bool enabled) override { return m_helper.set_close_on_exec(enabled); }
 
+    Optional<int> fd() const;
+
     virtual ~TCPSocket() override { close(); }
 
 private:
@@ -307,8 +339,7 @@ private:
 
         m_helper.setup_notifier();
         m_helper.notifier()->on_ready_to_read = [this] {
-            if (on_ready_to_read)
-                on_ready_to_read();
+            notify_ready_to_read();
         };
     }
 
@@ -381,8 +412,7 @@ private:
 
         m_helper.setup_notifier();
         m_helper.notifier()->on_ready_to_read = [this] {
-            if (on_ready_to_read)
-                on_ready_to_read();
+            notify_ready_to_read();
         };
     }
 
@@ -455,8 +485,7 @@ private:
 
         m_helper.setup_notifier();
         m_helper.notifier()->on_ready_to_read = [this] {
-            if (on_ready_to_read)
-                on_ready_to_read();
+            notify_ready_to_read();
         };
     }
 
@@ -522,6 +551,13 @@ public:
 
     virtual size_t buffer_size() const override { return m_helper.buffer_size(); }
 
+    // NOTE: Writes aren't buffered, so the fd can be written to directly (e.g. with sendfile()).
+    Optional<int> fd() const
+    requires(requires(T const& stream) { stream.fd(); })
+    {
+        return m_helper.stream().fd();
+    }
+
     virtual ~BufferedSocket() override = default;
 
 private:
@@ -534,8 +570,7 @@ private:
     void setup_notifier()
     {
         m_helper.stream().on_ready_to_read = [this] {
-            if (on_ready_to_read)
-                on_ready_to_read();
+            notify_ready_to_read();
         };
     }
 
@@ -30,6 +30,7 @@
 #    include <LibSystem/syscall.h>
 #    include <serenity.h>
 #    include <sys/ptrace.h>
+#    include <sys/sendfile.h>
 #endif
 
 #if defined(AK_OS_LINUX) && !defined(MFD_CLOEXEC)
@@ -216,6 +217,14 @@ ErrorOr<int> recvfd(int sockfd, int options)
     return fd;
 }
 
+ErrorOr<size_t> sendfile(int out_fd, int in_fd, off_t* offset, size_t count)
+{
+    auto rc = ::sendfile(out_fd, in_fd, offset, count);
+    if (rc < 0)
+        return Error::from_syscall("sendfile"sv, -errno);
+    return static_cast<size_t>(rc);
+}
+
 ErrorOr<void> ptrace_peekbuf(pid_t tid, void const* tracee_addr, Bytes destination_buf)
 {
     Syscall::SC_ptrace_buf_params buf_params {
@@ -286,6 +295,18 @@ ErrorOr<void> profiling_free_buffer(pid_t pid)
     int rc = ::profiling_free_buffer(pid);
     HANDLE_SYSCALL_RETURN_VALUE("profiling_free_buffer", rc, {});
 }
+
+ErrorOr<int> io_ring_create(u32 entries, int options)
+{
+    int rc = ::io_ring_create(entries, options);
+    HANDLE_SYSCALL_RETURN_VALUE("io_ring_create", rc, rc);
+}
+
+ErrorOr<u32> io_ring_enter(int fd, u32 to_submit)
+{
+    int rc = ::io_ring_enter(fd, to_submit);
+    HANDLE_SYSCALL_RETURN_VALUE("io_ring_enter", rc, static_cast<u32>(rc));
+}
 #endif
 
 #if !defined(AK_OS_BSD_GENERIC) && !defined(AK_OS_ANDROID)
@@ -473,6 +494,13 @@ ErrorOr<void> ftruncate(int fd, off_t length)
     return {};
 }
 
+ErrorOr<void> fsync(int fd)
+{
+    if (::fsync(fd) < 0)
+        return Error::from_syscall("fsync"sv, -errno);
+    return {};
+}
+
 ErrorOr<struct stat> stat(StringView path)
 {
     if (!path.characters_without_null_termination())
@@ -509,6 +537,24 @@ ErrorOr<struct stat> lstat(StringView path)
 #endif
 }
 
+ErrorOr<struct stat> fstatat(int fd, StringView path, int flags)
+{
+    if (!path.characters_without_null_termination())
+        return Error::from_syscall("fstatat"sv, -EFAULT);
+
+    struct stat st = {};
+#ifdef AK_OS_SERENITY
+    Syscall::SC_stat_params params { { path.characters_without_null_termination(), path.length() }, &st, fd, !(flags & AT_SYMLINK_NOFOLLOW) };
+    int rc = syscall(SC_stat, &params);
+    HANDLE_SYSCALL_RETURN_VALUE("fstatat", rc, st);
+#else
+    DeprecatedString path_string = path;
+    if (::fstatat(fd, path_string.characters(), &st, flags) < 0)
+        return Error::from_syscall("fstatat"sv, -errno);
+    return st;
+#endif
+}
+
 ErrorOr<ssize_t> read(int fd, Bytes buffer)
 {
     ssize_t rc = ::read(fd, buffer.data(), buffer.size());
@@ -1030,6 +1076,22 @@ ErrorOr<void> unlink(StringView path)
 #endif
 }
 
+ErrorOr<void> unlinkat(int fd, StringView path, int flags)
+{
+    if (path.is_null())
+        return Error::from_errno(EFAULT);
+
+#ifdef AK_OS_SERENITY
+    int rc = syscall(SC_unlink, fd, path.characters_without_null_termination(), path.length(), flags);
+    HANDLE_SYSCALL_RETURN_VALUE("unlinkat", rc, {});
+#else
+    DeprecatedString path_string = path;
+    if (::unlinkat(fd, path_string.characters(), flags) < 0)
+        return Error::from_syscall("unlinkat"sv, -errno);
+    return {};
+#endif
+}
+
 ErrorOr<void> utime(StringView path, Optional<struct utimbuf> maybe_buf)
 {
     if (path.is_null())
@@ -74,28 +74,29 @@ ErrorOr<void> TCPServer::set_blocking(bool blocking)
     return {};
 }
 
-ErrorOr<NonnullOwnPtr<Stream::TCPSocket>> TCPServer::accept()
+ErrorOr<int> TCPServer::accept_fd()
 {
     VERIFY(m_listening);
     sockaddr_in in;
     socklen_t in_size = sizeof(in);
 #ifndef AK_OS_MACOS
-    int accepted_fd = TRY(Core::System::accept4(m_fd, (sockaddr*)&in, &in_size, SOCK_NONBLOCK | SOCK_CLOEXEC));
+    return Core::System::accept4(m_fd, (sockaddr*)&in, &in_size, SOCK_NONBLOCK | SOCK_CLOEXEC);
 #else
     int accepted_fd = TRY(Core::System::accept(m_fd, (sockaddr*)&in, &in_size));
-#endif
-
-    auto socket = TRY(Stream::TCPSocket::adopt_fd(accepted_fd));
 
-#ifdef AK_OS_MACOS
     // FIXME: Ideally, we should let the caller decide whether it wants the
     //        socket to be nonblocking or not, but there are currently places
     //        which depend on this.
-    TRY(socket->set_blocking(false));
-    TRY(socket->set_close_on_exec(true));
+    int flags = TRY(Core::System::fcntl(accepted_fd, F_GETFL, 0));
+    TRY(Core::System::fcntl(accepted_fd, F_SETFL, flags | O_NONBLOCK));
+    TRY(Core::System::fcntl(accepted_fd, F_SETFD, FD_CLOEXEC));
+    return accepted_fd;
 #endif
+}
 
-    return socket;
+ErrorOr<NonnullOwnPtr<Stream::TCPSocket>> TCPServer::accept()
+{
+    return Stream::TCPSocket::adopt_fd(TRY(accept_fd()));
 }
 
 Optional<IPv4Address> TCPServer::local_address() const
@@ -30,6 +30,9 @@ public:
     ErrorOr<void> set_blocking(bool blocking);
 
     ErrorOr<NonnullOwnPtr<Stream::TCPSocket>> accept();
+    // Like accept(), but leaves it to the caller to adopt the file descriptor, e.g. on the thread that's going to
+    // use the socket (sockets register their notifiers with the event loop of the thread that creates them).
+    ErrorOr<int> accept_fd();
 
     Optional<IPv4Address> local_address() const;
     Optional<u16> local_port() const;
@@ -138,11 +138,23 @@ Optional<FlatPtr> Reader::peek_memory(FlatPtr address) const
     if (!region.has_value())
         return {};
 
-    FlatPtr offset_in_region = address - region->region_start;
-    auto* region_data = bit_cast<u8 const*>(image().program_header(region->program_header_index).raw_data());
-    FlatPtr value { 0 };
-    ByteReader::load(region_data + offset_in_region, value);
-    return value;
+    // Note: A region can be made up of several segments, starting with the one that the region info points to. Only
+    //       the pages that had any data in them are in the coredump, and everything past those reads as zeroes.
+    for (unsigned index = region->program_header_index; index < image().program_header_count(); ++index) {
+        auto segment = image().program_header(index);
+        if (segment.type() != PT_LOAD)
+            break;
+        auto segment_start = segment.vaddr().get();
+        if (address < segment_start || address >= segment_start + segment.size_in_memory())
+            continue;
+
+        FlatPtr offset_in_segment = address - segment_start;
+        FlatPtr value { 0 };
+        if (offset_in_segment + sizeof(value) <= segment.size_in_image())
+            ByteReader::load(bit_cast<u8 const*>(segment.raw_data()) + offset_in_segment, value);
+        return value;
+    }
+    return {};
 }
 
 const JsonObject Reader::process_info() const
@@ -205,19 +205,22 @@ constexpr StringView s_known_types[] = {
 
 static bool is_keyword(StringView string)
 {
-    static HashTable<DeprecatedString> keywords(array_size(s_known_keywords));
-    if (keywords.is_empty()) {
+    // Note: The table is filled in by its initializer, so that lexers on different threads can't race to fill it in.
+    static HashTable<DeprecatedString> const keywords = [] {
+        HashTable<DeprecatedString> keywords(array_size(s_known_keywords));
         keywords.set_from(s_known_keywords);
-    }
+        return keywords;
+    }();
     return keywords.contains(string);
 }
 
 static bool is_known_type(StringView string)
 {
-    static HashTable<DeprecatedString> types(array_size(s_known_types));
-    if (types.is_empty()) {
+    static HashTable<DeprecatedString> const types = [] {
+        HashTable<DeprecatedString> types(array_size(s_known_types));
         types.set_from(s_known_types);
-    }
+        return types;
+    }();
     return types.contains(string);
 }
 
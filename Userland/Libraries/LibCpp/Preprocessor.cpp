@@ -108,8 +108,10 @@ void Preprocessor::handle_preprocessor_statement(StringView line)
 void Preprocessor::handle_include_statement(StringView include_path)
 {
     m_included_paths.append(include_path);
-    if (definitions_in_header_callback) {
-        for (auto& def : definitions_in_header_callback(include_path))
+    if (!definitions_in_header_callback)
+        return;
+    if (auto const* definitions = definitions_in_header_callback(include_path)) {
+        for (auto& def : *definitions)
             m_definitions.set(def.key, def.value);
     }
 }
@@ -47,7 +47,8 @@ public:
     void set_ignore_invalid_statements(bool ignore) { m_options.ignore_invalid_statements = ignore; }
     void set_keep_include_statements(bool keep) { m_options.keep_include_statements = keep; }
 
-    Function<Definitions(StringView)> definitions_in_header_callback { nullptr };
+    // Returns the definitions of an included header, or nullptr if there are none.
+    Function<Definitions const*(StringView)> definitions_in_header_callback { nullptr };
 
     Vector<Token> const& unprocessed_tokens() const { return m_unprocessed_tokens; }
 
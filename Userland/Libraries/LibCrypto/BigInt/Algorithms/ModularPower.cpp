@@ -26,7 +26,7 @@ void UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(
     while (!(ep < 1)) {
         if (ep.words()[0] % 2 == 1) {
             // exp = (exp * base) % m;
-            multiply_without_allocation(exp, base, temp_1, temp_2, temp_3, temp_multiply);
+            multiply_without_allocation(exp, base, temp_multiply);
             divide_without_allocation(temp_multiply, m, temp_1, temp_2, temp_3, temp_4, temp_quotient, temp_remainder);
             exp.set_to(temp_remainder);
         }
@@ -36,7 +36,7 @@ void UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(
         ep.set_to(temp_quotient);
 
         // base = (base * base) % m;
-        multiply_without_allocation(base, base, temp_1, temp_2, temp_3, temp_multiply);
+        multiply_without_allocation(base, base, temp_multiply);
         divide_without_allocation(temp_multiply, m, temp_1, temp_2, temp_3, temp_4, temp_quotient, temp_remainder);
         base.set_to(temp_remainder);
 
@@ -49,236 +49,260 @@ void UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(
     }
 }
 
+using u128 = unsigned __int128;
+
 /**
- * Compute (1/value) % 2^32.
- * This needs an odd input value
- * Algorithm from: Dumas, J.G. "On Newton–Raphson Iteration for Multiplicative Inverses Modulo Prime Powers".
+ * Compute -(1/value) % 2^64.
+ * This needs an odd input value. Every Newton-Raphson step doubles the number of correct low bits, and since
+ * value * value = 1 (mod 8) for odd values, value itself is already correct in the lowest three.
  */
-ALWAYS_INLINE static u32 inverse_wrapped(u32 value)
+static u64 negated_inverse_wrapped(u64 value)
 {
     VERIFY(value & 1);
 
-    u64 b = static_cast<u64>(value);
-    u64 k0 = (2 - b);
-    u64 t = (b - 1);
-    size_t i = 1;
-    while (i < 32) {
-        t = t * t;
-        k0 = k0 * (t + 1);
-        i <<= 1;
-    }
-    return static_cast<u32>(-k0);
+    u64 inverse = value;
+    for (size_t i = 0; i < 5; ++i)
+        inverse *= 2 - value * inverse;
+    return -inverse;
 }
 
-/**
- * Computes z = x * y + c. z_carry contains the top bits, z contains the bottom bits.
- */
-ALWAYS_INLINE static void linear_multiplication_with_carry(u32 x, u32 y, u32 c, u32& z_carry, u32& z)
+static Vector<u64> to_limbs(UnsignedBigInteger const& number, size_t limb_count)
 {
-    u64 result = static_cast<u64>(x) * static_cast<u64>(y) + static_cast<u64>(c);
-    z_carry = static_cast<u32>(result >> 32);
-    z = static_cast<u32>(result);
+    auto const& words = number.words();
+    auto word_count = number.trimmed_length();
+    VERIFY(word_count <= 2 * limb_count);
+
+    Vector<u64> limbs;
+    limbs.resize(limb_count);
+    for (size_t i = 0; i < word_count; ++i)
+        limbs[i / 2] |= static_cast<u64>(words[i]) << (i % 2 * 32);
+    return limbs;
 }
 
-/**
- * Computes z = a + b. z_carry contains the top bit (1 or 0), z contains the bottom bits.
- */
-ALWAYS_INLINE static void addition_with_carry(u32 a, u32 b, u32& z_carry, u32& z)
+static UnsignedBigInteger from_limbs(Span<u64 const> limbs)
 {
-    u64 result = static_cast<u64>(a) + static_cast<u64>(b);
-    z_carry = static_cast<u32>(result >> 32);
-    z = static_cast<u32>(result);
+    Vector<UnsignedBigInteger::Word, STARTING_WORD_SIZE> words;
+    words.resize(2 * limbs.size());
+    for (size_t i = 0; i < limbs.size(); ++i) {
+        words[2 * i] = static_cast<UnsignedBigInteger::Word>(limbs[i]);
+        words[2 * i + 1] = static_cast<UnsignedBigInteger::Word>(limbs[i] >> 32);
+    }
+    UnsignedBigInteger result { move(words) };
+    result.clamp_to_trimmed_length();
+    return result;
 }
 
 /**
- * Computes a montgomery "fragment" for y_i. This computes "z[i] += x[i] * y_i" for all words while rippling the carry, and returns the carry.
- * Algorithm from: Gueron, "Efficient Software Implementations of Modular Exponentiation". (https://eprint.iacr.org/2011/239.pdf)
+ * Computes result = left * right / R % modulus, for left < R and right < modulus. scratch needs room for two more
+ * limbs than the modulus, and result may be the same as left or right.
+ * The reduction is done word by word, interleaved with the multiplication ("CIOS" in Koc, Acar, Kaliski,
+ * "Analyzing and Comparing Montgomery Multiplication Algorithms"), and the result is fully reduced without branches.
  */
-UnsignedBigInteger::Word UnsignedBigIntegerAlgorithms::montgomery_fragment(UnsignedBigInteger& z, size_t offset_in_z, UnsignedBigInteger const& x, UnsignedBigInteger::Word y_digit, size_t num_words)
+static void montgomery_multiply(u64 const* left, u64 const* right, MontgomeryContext const& context, u64* scratch, u64* result)
 {
-    UnsignedBigInteger::Word carry { 0 };
-    for (size_t i = 0; i < num_words; ++i) {
-        UnsignedBigInteger::Word a_carry;
-        UnsignedBigInteger::Word a;
-        linear_multiplication_with_carry(x.m_words[i], y_digit, z.m_words[offset_in_z + i], a_carry, a);
-        UnsignedBigInteger::Word b_carry;
-        UnsignedBigInteger::Word b;
-        addition_with_carry(a, carry, b_carry, b);
-        z.m_words[offset_in_z + i] = b;
-        carry = a_carry + b_carry;
+    auto const* modulus = context.modulus_limbs.data();
+    size_t limb_count = context.modulus_limbs.size();
+    auto* t = scratch;
+    __builtin_memset(t, 0, (limb_count + 2) * sizeof(u64));
+
+    for (size_t i = 0; i < limb_count; ++i) {
+        // t += left * right[i]
+        u128 carry = 0;
+        for (size_t j = 0; j < limb_count; ++j) {
+            u128 product = static_cast<u128>(left[j]) * right[i] + t[j] + carry;
+            t[j] = static_cast<u64>(product);
+            carry = product >> 64;
+        }
+        u128 sum = static_cast<u128>(t[limb_count]) + carry;
+        t[limb_count] = static_cast<u64>(sum);
+        t[limb_count + 1] = static_cast<u64>(sum >> 64);
+
+        // t = (t + modulus * m) / 2^64, where m is chosen so that the division is exact.
+        u64 m = t[0] * context.inverse;
+        carry = (static_cast<u128>(m) * modulus[0] + t[0]) >> 64;
+        for (size_t j = 1; j < limb_count; ++j) {
+            u128 product = static_cast<u128>(m) * modulus[j] + t[j] + carry;
+            t[j - 1] = static_cast<u64>(product);
+            carry = product >> 64;
+        }
+        sum = static_cast<u128>(t[limb_count]) + carry;
+        t[limb_count - 1] = static_cast<u64>(sum);
+        t[limb_count] = t[limb_count + 1] + static_cast<u64>(sum >> 64);
+    }
+
+    // t < 2 * modulus now, so subtracting the modulus once is enough. The difference is used unless it underflowed
+    // without t having a limb beyond the modulus.
+    u64 borrow = 0;
+    for (size_t j = 0; j < limb_count; ++j) {
+        u128 difference = static_cast<u128>(t[j]) - modulus[j] - borrow;
+        result[j] = static_cast<u64>(difference);
+        borrow = static_cast<u64>(difference >> 64) & 1;
     }
-    return carry;
+    u64 use_difference = 0 - (t[limb_count] | (borrow ^ 1));
+    for (size_t j = 0; j < limb_count; ++j)
+        result[j] = (result[j] & use_difference) | (t[j] & ~use_difference);
 }
 
-/**
- * Computes the "almost montgomery" product : x * y * 2 ^ (-num_words * BITS_IN_WORD) % modulo
- * [Note : that means that the result z satisfies z * 2^(num_words * BITS_IN_WORD) % modulo = x * y % modulo]
- * assuming :
- *  - x, y and modulo are all already padded to num_words
- *  - k = inverse_wrapped(modulo) (optimization to not recompute K each time)
- * Algorithm from: Gueron, "Efficient Software Implementations of Modular Exponentiation". (https://eprint.iacr.org/2011/239.pdf)
- */
-void UnsignedBigIntegerAlgorithms::almost_montgomery_multiplication_without_allocation(
-    UnsignedBigInteger const& x,
-    UnsignedBigInteger const& y,
-    UnsignedBigInteger const& modulo,
-    UnsignedBigInteger& z,
-    UnsignedBigInteger::Word k,
-    size_t num_words,
-    UnsignedBigInteger& result)
+MontgomeryContext UnsignedBigIntegerAlgorithms::montgomery_context(UnsignedBigInteger const& modulo)
 {
-    VERIFY(x.length() >= num_words);
-    VERIFY(y.length() >= num_words);
-    VERIFY(modulo.length() >= num_words);
-
-    z.set_to(0);
-    z.resize_with_leading_zeros(num_words * 2);
-
-    UnsignedBigInteger::Word previous_double_carry { 0 };
-    for (size_t i = 0; i < num_words; ++i) {
-        // z[i->num_words+i] += x * y_i
-        UnsignedBigInteger::Word carry_1 = montgomery_fragment(z, i, x, y.m_words[i], num_words);
-        // z[i->num_words+i] += modulo * (z_i * k)
-        UnsignedBigInteger::Word t = z.m_words[i] * k;
-        UnsignedBigInteger::Word carry_2 = montgomery_fragment(z, i, modulo, t, num_words);
-
-        // Compute the carry by combining all of the carries of the previous computations
-        // Put it "right after" the range that we computed above
-        UnsignedBigInteger::Word temp_carry = previous_double_carry + carry_1;
-        UnsignedBigInteger::Word overall_carry = temp_carry + carry_2;
-        z.m_words[num_words + i] = overall_carry;
-
-        // Detect if there was a "double carry" for this word by checking if our carry results are smaller than their components
-        previous_double_carry = (temp_carry < carry_1 || overall_carry < carry_2) ? 1 : 0;
+    VERIFY(modulo.is_odd());
+    VERIFY(modulo != 1);
+
+    MontgomeryContext context;
+    context.modulus.set_to(modulo);
+    context.modulus.clamp_to_trimmed_length();
+    size_t limb_count = (modulo.trimmed_length() + 1) / 2;
+    context.modulus_limbs = to_limbs(modulo, limb_count);
+    context.inverse = negated_inverse_wrapped(context.modulus_limbs[0]);
+
+    // Doubling 1 (with modular reduction) 64 * limb_count + limb_count times gives R * 2^limb_count, which is
+    // 2^limb_count in Montgomery form. Squaring that six times in Montgomery form then gives 2^(64 * limb_count) = R
+    // in Montgomery form, which is R^2.
+    auto const* modulus = context.modulus_limbs.data();
+    Vector<u64> value;
+    value.resize(limb_count);
+    value[0] = 1;
+    for (size_t doubling = 0; doubling < 65 * limb_count; ++doubling) {
+        u64 overflow = value[limb_count - 1] >> 63;
+        for (size_t j = limb_count - 1; j > 0; --j)
+            value[j] = (value[j] << 1) | (value[j - 1] >> 63);
+        value[0] <<= 1;
+
+        bool is_at_least_modulus = overflow != 0;
+        if (!is_at_least_modulus) {
+            is_at_least_modulus = true;
+            for (size_t j = limb_count; j-- > 0;) {
+                if (value[j] != modulus[j]) {
+                    is_at_least_modulus = value[j] > modulus[j];
+                    break;
+                }
+            }
+        }
+        if (!is_at_least_modulus)
+            continue;
+
+        u64 borrow = 0;
+        for (size_t j = 0; j < limb_count; ++j) {
+            u128 difference = static_cast<u128>(value[j]) - modulus[j] - borrow;
+            value[j] = static_cast<u64>(difference);
+            borrow = static_cast<u64>(difference >> 64) & 1;
+        }
     }
 
-    if (previous_double_carry == 0) {
-        // Return the top num_words bytes of Z, which contains our result.
-        shift_right_by_n_words(z, num_words, result);
-        result.resize_with_leading_zeros(num_words);
-        return;
-    }
+    Vector<u64> scratch;
+    scratch.resize(limb_count + 2);
+    for (size_t squaring = 0; squaring < 6; ++squaring)
+        montgomery_multiply(value.data(), value.data(), context, scratch.data(), value.data());
+    context.r_squared = move(value);
 
-    // We have a carry, so we're "one bigger" than we need to be.
-    // Subtract the modulo from the result (the top half of z), and write it to the bottom half of Z since we have space.
-    // (With carry, of course.)
-    UnsignedBigInteger::Word c { 0 };
-    for (size_t i = 0; i < num_words; ++i) {
-        UnsignedBigInteger::Word z_digit = z.m_words[num_words + i];
-        UnsignedBigInteger::Word modulo_digit = modulo.m_words[i];
-        UnsignedBigInteger::Word new_z_digit = z_digit - modulo_digit - c;
-        z.m_words[i] = new_z_digit;
-        // Detect if the subtraction underflowed - from "Hacker's Delight"
-        c = ((modulo_digit & ~z_digit) | ((modulo_digit | ~z_digit) & new_z_digit)) >> (UnsignedBigInteger::BITS_IN_WORD - 1);
-    }
+    return context;
+}
 
-    // Return the bottom num_words bytes of Z (with the carry bit handled)
-    z.m_words.resize(num_words);
-    result.set_to(z);
-    result.resize_with_leading_zeros(num_words);
+// Larger windows need fewer multiplications while going over the exponent, but more of them to precompute the powers
+// of the base. These are the sizes where that evens out.
+static size_t sliding_window_size_for_exponent(size_t bits)
+{
+    if (bits > 671)
+        return 6;
+    if (bits > 239)
+        return 5;
+    if (bits > 79)
+        return 4;
+    if (bits > 23)
+        return 3;
+    return 1;
 }
 
 /**
- * Complexity: still O(N^3) with N the number of words in the largest word, but less complex than the classical mod power.
- * Note: the montgomery multiplications requires an inverse modulo over 2^32, which is only defined for odd numbers.
+ * Complexity: O(N^2 * E) where N is the number of words in the modulus and E the number of bits in the exponent
+ * Exponentiation method:
+ * Left-to-right sliding window exponentiation over Montgomery forms (x * R % modulus) of the base and the result.
+ * Only odd powers of the base are needed, since windows always end with a set bit of the exponent.
  */
-void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocations(
+void UnsignedBigIntegerAlgorithms::montgomery_modular_power(
     UnsignedBigInteger const& base,
     UnsignedBigInteger const& exponent,
-    UnsignedBigInteger const& modulo,
-    UnsignedBigInteger& temp_z,
-    UnsignedBigInteger& rr,
-    UnsignedBigInteger& one,
-    UnsignedBigInteger& z,
-    UnsignedBigInteger& zz,
-    UnsignedBigInteger& x,
-    UnsignedBigInteger& temp_extra,
+    MontgomeryContext const& context,
     UnsignedBigInteger& result)
 {
-    VERIFY(modulo.is_odd());
-
-    // Note: While this is a constexpr variable for clarity and could be changed in theory,
-    // various optimized parts of the algorithm rely on this value being exactly 4.
-    constexpr size_t window_size = 4;
-
-    size_t num_words = modulo.trimmed_length();
-    UnsignedBigInteger::Word k = inverse_wrapped(modulo.m_words[0]);
-
-    one.set_to(1);
-
-    // rr = ( 2 ^ (2 * modulo.length() * BITS_IN_WORD) ) % modulo
-    shift_left_by_n_words(one, 2 * num_words, x);
-    divide_without_allocation(x, modulo, temp_z, one, z, zz, temp_extra, rr);
-    rr.resize_with_leading_zeros(num_words);
-
-    // x = base [% modulo, if x doesn't already fit in modulo's words]
-    x.set_to(base);
-    if (x.trimmed_length() > num_words)
-        divide_without_allocation(base, modulo, temp_z, one, z, zz, temp_extra, x);
-    x.resize_with_leading_zeros(num_words);
-
-    one.set_to(1);
-    one.resize_with_leading_zeros(num_words);
-
-    // Compute the montgomery powers from 0 to 2^window_size. powers[i] = x^i
-    UnsignedBigInteger powers[1 << window_size];
-    almost_montgomery_multiplication_without_allocation(one, rr, modulo, temp_z, k, num_words, powers[0]);
-    almost_montgomery_multiplication_without_allocation(x, rr, modulo, temp_z, k, num_words, powers[1]);
-    for (size_t i = 2; i < (1 << window_size); ++i)
-        almost_montgomery_multiplication_without_allocation(powers[i - 1], powers[1], modulo, temp_z, k, num_words, powers[i]);
-
-    z.set_to(powers[0]);
-    z.resize_with_leading_zeros(num_words);
-    zz.set_to(0);
-    zz.resize_with_leading_zeros(num_words);
-
-    ssize_t exponent_length = exponent.trimmed_length();
-    for (ssize_t word_in_exponent = exponent_length - 1; word_in_exponent >= 0; --word_in_exponent) {
-        UnsignedBigInteger::Word exponent_word = exponent.m_words[word_in_exponent];
-        size_t bit_in_word = 0;
-        while (bit_in_word < UnsignedBigInteger::BITS_IN_WORD) {
-            if (word_in_exponent != exponent_length - 1 || bit_in_word != 0) {
-                almost_montgomery_multiplication_without_allocation(z, z, modulo, temp_z, k, num_words, zz);
-                almost_montgomery_multiplication_without_allocation(zz, zz, modulo, temp_z, k, num_words, z);
-                almost_montgomery_multiplication_without_allocation(z, z, modulo, temp_z, k, num_words, zz);
-                almost_montgomery_multiplication_without_allocation(zz, zz, modulo, temp_z, k, num_words, z);
-            }
-            auto power_index = exponent_word >> (UnsignedBigInteger::BITS_IN_WORD - window_size);
-            auto& power = powers[power_index];
-            almost_montgomery_multiplication_without_allocation(z, power, modulo, temp_z, k, num_words, zz);
-
-            swap(z, zz);
-
-            // Move to the next window
-            exponent_word <<= window_size;
-            bit_in_word += window_size;
-        }
+    size_t limb_count = context.modulus_limbs.size();
+
+    Vector<u64> x;
+    if (base.trimmed_length() > 2 * limb_count) {
+        UnsignedBigInteger temp_1;
+        UnsignedBigInteger temp_2;
+        UnsignedBigInteger temp_3;
+        UnsignedBigInteger temp_4;
+        UnsignedBigInteger quotient;
+        UnsignedBigInteger remainder;
+        divide_without_allocation(base, context.modulus, temp_1, temp_2, temp_3, temp_4, quotient, remainder);
+        x = to_limbs(remainder, limb_count);
+    } else {
+        x = to_limbs(base, limb_count);
     }
 
-    almost_montgomery_multiplication_without_allocation(z, one, modulo, temp_z, k, num_words, zz);
-
-    if (zz < modulo) {
-        result.set_to(zz);
-        result.clamp_to_trimmed_length();
-        return;
+    Vector<u64> scratch;
+    scratch.resize(limb_count + 2);
+
+    size_t exponent_bits = exponent.one_based_index_of_highest_set_bit();
+    size_t window_size = sliding_window_size_for_exponent(exponent_bits);
+
+    // powers[i] = x^(2 * i + 1) in Montgomery form
+    Vector<u64> powers;
+    powers.resize(limb_count << (window_size - 1));
+    auto power = [&](size_t index) { return powers.data() + index * limb_count; };
+    montgomery_multiply(x.data(), context.r_squared.data(), context, scratch.data(), power(0));
+    if (window_size > 1) {
+        Vector<u64> square;
+        square.resize(limb_count);
+        montgomery_multiply(power(0), power(0), context, scratch.data(), square.data());
+        for (size_t i = 1; i < (1u << (window_size - 1)); ++i)
+            montgomery_multiply(power(i - 1), square.data(), context, scratch.data(), power(i));
     }
 
-    // Note : Since we were using "almost montgomery" multiplications, we aren't guaranteed to be under the modulo already.
-    // So, if we're here, we need to respect the modulo.
-    // We can, however, start by trying to subtract the modulo, just in case we're close.
-    subtract_without_allocation(zz, modulo, result);
-
-    if (modulo < zz) {
-        // Note: This branch shouldn't happen in theory (as noted in https://github.com/rust-num/num-bigint/blob/master/src/biguint/monty.rs#L210)
-        // Let's dbgln the values we used. That way, if we hit this branch, we can contribute these values for test cases.
-        dbgln("Encountered the modulo branch during a montgomery modular power. Params : {} - {} - {}", base, exponent, modulo);
-        // We just clobber all the other temporaries that we don't need for the division.
-        // This is wasteful, but we're on the edgiest of cases already.
-        divide_without_allocation(zz, modulo, temp_z, rr, z, x, temp_extra, result);
+    Vector<u64> one;
+    one.resize(limb_count);
+    one[0] = 1;
+
+    // z = 1 in Montgomery form
+    Vector<u64> z;
+    z.resize(limb_count);
+    montgomery_multiply(context.r_squared.data(), one.data(), context, scratch.data(), z.data());
+    bool z_is_one = true;
+
+    auto const& exponent_words = exponent.words();
+    auto bit = [&](size_t index) { return (exponent_words[index / UnsignedBigInteger::BITS_IN_WORD] >> (index % UnsignedBigInteger::BITS_IN_WORD)) & 1; };
+
+    for (ssize_t i = static_cast<ssize_t>(exponent_bits) - 1; i >= 0;) {
+        if (!bit(i)) {
+            if (!z_is_one)
+                montgomery_multiply(z.data(), z.data(), context, scratch.data(), z.data());
+            --i;
+            continue;
+        }
+
+        // Find the longest window of bits from i downwards that fits and ends with a set bit.
+        ssize_t j = max(i - static_cast<ssize_t>(window_size) + 1, static_cast<ssize_t>(0));
+        while (!bit(j))
+            ++j;
+        size_t window = 0;
+        for (ssize_t k = i; k >= j; --k)
+            window = (window << 1) | bit(k);
+
+        if (z_is_one) {
+            __builtin_memcpy(z.data(), power(window >> 1), limb_count * sizeof(u64));
+            z_is_one = false;
+        } else {
+            for (ssize_t k = i; k >= j; --k)
+                montgomery_multiply(z.data(), z.data(), context, scratch.data(), z.data());
+            montgomery_multiply(z.data(), power(window >> 1), context, scratch.data(), z.data());
+        }
+        i = j - 1;
     }
 
-    result.clamp_to_trimmed_length();
-    return;
+    // Leave the Montgomery form.
+    montgomery_multiply(z.data(), one.data(), context, scratch.data(), z.data());
+    result = from_limbs(z.span());
 }
 
 }
@@ -9,38 +9,150 @@
 
 namespace Crypto {
 
+using Word = UnsignedBigInteger::Word;
+
+// Below this many words, splitting the numbers up costs more than the schoolbook method saves.
+static constexpr size_t karatsuba_threshold = 32;
+
+/**
+ * Adds the words of value into accumulator and returns the carry out of its last word.
+ */
+static Word add_words(Word* accumulator, size_t accumulator_length, Word const* value, size_t value_length)
+{
+    VERIFY(value_length <= accumulator_length);
+    u64 carry = 0;
+    for (size_t i = 0; i < accumulator_length; ++i) {
+        if (i >= value_length && carry == 0)
+            return 0;
+        u64 sum = static_cast<u64>(accumulator[i]) + (i < value_length ? value[i] : 0) + carry;
+        accumulator[i] = static_cast<Word>(sum);
+        carry = sum >> UnsignedBigInteger::BITS_IN_WORD;
+    }
+    return static_cast<Word>(carry);
+}
+
+/**
+ * Subtracts the words of value from accumulator, which must not be the smaller one of the two.
+ */
+static void subtract_words(Word* accumulator, size_t accumulator_length, Word const* value, size_t value_length)
+{
+    VERIFY(value_length <= accumulator_length);
+    Word borrow = 0;
+    for (size_t i = 0; i < accumulator_length; ++i) {
+        if (i >= value_length && borrow == 0)
+            return;
+        u64 difference = static_cast<u64>(accumulator[i]) - (i < value_length ? value[i] : 0) - borrow;
+        accumulator[i] = static_cast<Word>(difference);
+        borrow = (difference >> 63) & 1;
+    }
+    VERIFY(borrow == 0);
+}
+
+/**
+ * Complexity: O(N*M) where N and M are the number of words in the numbers
+ */
+static void schoolbook_multiply_words(Word const* left, size_t left_length, Word const* right, size_t right_length, Word* output)
+{
+    __builtin_memset(output, 0, (left_length + right_length) * sizeof(Word));
+    for (size_t i = 0; i < left_length; ++i) {
+        u64 carry = 0;
+        for (size_t j = 0; j < right_length; ++j) {
+            // This can't overflow: (2^32 - 1)^2 + 2 * (2^32 - 1) = 2^64 - 1
+            u64 product = static_cast<u64>(left[i]) * right[j] + output[i + j] + carry;
+            output[i + j] = static_cast<Word>(product);
+            carry = product >> UnsignedBigInteger::BITS_IN_WORD;
+        }
+        output[i + right_length] = static_cast<Word>(carry);
+    }
+}
+
 /**
- * Complexity: O(N^2) where N is the number of words in the larger number
- * Multiplication method:
- * An integer is equal to the sum of the powers of two
- * according to the indices of its 'on' bits.
- * So to multiple x*y, we go over each '1' bit in x (say the i'th bit),
- * and add y<<i to the result.
+ * Writes the left_length + right_length words of left * right to output.
+ * Complexity: O(N^1.58) where N is the number of words in the larger number
+ * Multiplication method (Karatsuba):
+ * With B = 2^(32 * half), split left = left_high * B + left_low and right = right_high * B + right_low. Then
+ * left * right = high * B^2 + (middle - high - low) * B + low, where high = left_high * right_high,
+ * low = left_low * right_low and middle = (left_low + left_high) * (right_low + right_high).
+ * That is three multiplications of half the size instead of four.
  */
+static void multiply_words(Word const* left, size_t left_length, Word const* right, size_t right_length, Word* output)
+{
+    if (left_length < right_length) {
+        swap(left, right);
+        swap(left_length, right_length);
+    }
+
+    if (right_length < karatsuba_threshold) {
+        schoolbook_multiply_words(left, left_length, right, right_length, output);
+        return;
+    }
+
+    // Karatsuba only pays off for numbers of similar size, so multiply a much longer number in slices instead.
+    if (left_length >= 2 * right_length) {
+        __builtin_memset(output, 0, (left_length + right_length) * sizeof(Word));
+        Vector<Word> product;
+        product.resize(2 * right_length);
+        for (size_t offset = 0; offset < left_length; offset += right_length) {
+            auto slice_length = min(right_length, left_length - offset);
+            multiply_words(left + offset, slice_length, right, right_length, product.data());
+            add_words(output + offset, left_length + right_length - offset, product.data(), slice_length + right_length);
+        }
+        return;
+    }
+
+    // Since right_length > left_length / 2, both numbers have at least half words.
+    size_t half = (left_length + 1) / 2;
+    // Note: GCC can't tell how long the numbers can be through the recursion, and warns about the copies below otherwise.
+    VERIFY(half < NumericLimits<ssize_t>::max() / sizeof(Word));
+    size_t left_high_length = left_length - half;
+    size_t right_high_length = right_length - half;
+
+    // low goes into the bottom and high into the top of the output, where they don't overlap.
+    multiply_words(left, half, right, half, output);
+    auto* high = output + 2 * half;
+    if (right_high_length == 0)
+        __builtin_memset(high, 0, left_high_length * sizeof(Word));
+    else
+        multiply_words(left + half, left_high_length, right + half, right_high_length, high);
+
+    Vector<Word> scratch;
+    scratch.resize(4 * (half + 1));
+    auto* left_sum = scratch.data();
+    auto* right_sum = left_sum + half + 1;
+    auto* middle = right_sum + half + 1;
+
+    Span<Word const> { left, half }.copy_to({ left_sum, half });
+    left_sum[half] = add_words(left_sum, half, left + half, left_high_length);
+    Span<Word const> { right, half }.copy_to({ right_sum, half });
+    right_sum[half] = add_words(right_sum, half, right + half, right_high_length);
+    multiply_words(left_sum, half + 1, right_sum, half + 1, middle);
+
+    size_t middle_length = 2 * (half + 1);
+    subtract_words(middle, middle_length, output, 2 * half);
+    subtract_words(middle, middle_length, high, left_high_length + right_high_length);
+
+    // The whole product fits into the output, so any words of the middle term that reach past it are zero.
+    size_t output_length = left_length + right_length;
+    add_words(output + half, output_length - half, middle, min(middle_length, output_length - half));
+}
+
 FLATTEN void UnsignedBigIntegerAlgorithms::multiply_without_allocation(
     UnsignedBigInteger const& left,
     UnsignedBigInteger const& right,
-    UnsignedBigInteger& temp_shift_result,
-    UnsignedBigInteger& temp_shift_plus,
-    UnsignedBigInteger& temp_shift,
     UnsignedBigInteger& output)
 {
-    output.set_to_0();
+    VERIFY(&output != &left && &output != &right);
 
-    // iterate all bits
-    for (size_t word_index = 0; word_index < left.length(); ++word_index) {
-        for (size_t bit_index = 0; bit_index < UnsignedBigInteger::BITS_IN_WORD; ++bit_index) {
-            // If the bit is off - skip over it
-            if (!(left.m_words[word_index] & (1 << bit_index)))
-                continue;
+    output.set_to_0();
 
-            size_t shift_amount = word_index * UnsignedBigInteger::BITS_IN_WORD + bit_index;
+    auto left_length = left.trimmed_length();
+    auto right_length = right.trimmed_length();
+    if (left_length == 0 || right_length == 0)
+        return;
 
-            // output += (right << shift_amount);
-            shift_left_without_allocation(right, shift_amount, temp_shift_result, temp_shift_plus, temp_shift);
-            add_into_accumulator_without_allocation(output, temp_shift);
-        }
-    }
+    output.m_words.resize_and_keep_capacity(left_length + right_length);
+    multiply_words(left.m_words.data(), left_length, right.m_words.data(), right_length, output.m_words.data());
+    output.clamp_to_trimmed_length();
 }
 
 }
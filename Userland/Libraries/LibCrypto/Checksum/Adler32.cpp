@@ -8,13 +8,69 @@
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/Adler32.h>
 
+#if defined(__SSE2__)
+#    include <emmintrin.h>
+#endif
+
 namespace Crypto::Checksum {
 
+static constexpr u32 modulus = 65521;
+
+// The largest number of bytes after which the sums have to be reduced, so that they can't overflow 32 bits.
+static constexpr size_t max_bytes_between_reductions = 5552;
+
+#if defined(__SSE2__)
+// Sums up 16 bytes at a time. b grows by a for every byte, so for a block of 16 that's 16 times a as it was before the
+// block, plus the bytes of the block weighted by how many bytes there are from them to its end.
+// The data has to be a multiple of 16 bytes long, and no longer than max_bytes_between_reductions.
+static void update_sse2(u32& a, u32& b, ReadonlyBytes data)
+{
+    auto const zero = _mm_setzero_si128();
+    auto const weights_low = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+    auto const weights_high = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+
+    auto byte_sums = zero;
+    auto previous_byte_sums = zero;
+    auto weighted_sums = zero;
+    for (size_t i = 0; i < data.size(); i += 16) {
+        auto bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data.offset_pointer(i)));
+        previous_byte_sums = _mm_add_epi32(previous_byte_sums, byte_sums);
+        byte_sums = _mm_add_epi32(byte_sums, _mm_sad_epu8(bytes, zero));
+        weighted_sums = _mm_add_epi32(weighted_sums, _mm_madd_epi16(_mm_unpacklo_epi8(bytes, zero), weights_low));
+        weighted_sums = _mm_add_epi32(weighted_sums, _mm_madd_epi16(_mm_unpackhi_epi8(bytes, zero), weights_high));
+    }
+
+    auto horizontal_sum = [](__m128i value) -> u64 {
+        alignas(16) u32 lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), value);
+        return static_cast<u64>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    };
+
+    u64 new_b = b + static_cast<u64>(data.size()) * a + 16 * horizontal_sum(previous_byte_sums) + horizontal_sum(weighted_sums);
+    a = (a + horizontal_sum(byte_sums)) % modulus;
+    b = new_b % modulus;
+}
+#endif
+
 void Adler32::update(ReadonlyBytes data)
 {
-    for (size_t i = 0; i < data.size(); i++) {
-        m_state_a = (m_state_a + data.at(i)) % 65521;
-        m_state_b = (m_state_b + m_state_a) % 65521;
+    while (!data.is_empty()) {
+        auto chunk = data.trim(max_bytes_between_reductions);
+        data = data.slice(chunk.size());
+
+#if defined(__SSE2__)
+        auto vectorized_size = chunk.size() & ~static_cast<size_t>(15);
+        update_sse2(m_state_a, m_state_b, chunk.trim(vectorized_size));
+        chunk = chunk.slice(vectorized_size);
+#endif
+
+        // Note: Taking the remainder once per chunk is enough, as neither sum can overflow within one.
+        for (size_t i = 0; i < chunk.size(); i++) {
+            m_state_a += chunk[i];
+            m_state_b += m_state_a;
+        }
+        m_state_a %= modulus;
+        m_state_b %= modulus;
     }
 };
 
@@ -5,38 +5,155 @@
  */
 
 #include <AK/Array.h>
+#include <AK/Endian.h>
+#include <AK/Platform.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/CRC32.h>
+#include <string.h>
+
+#if ARCH(X86_64)
+#    include <cpuid.h>
+#    include <immintrin.h>
+#endif
 
 namespace Crypto::Checksum {
 
-static constexpr auto generate_table()
+static constexpr u32 polynomial = 0xEDB88320;
+
+// tables[0] is the usual byte-at-a-time table. tables[n][i] is the CRC of byte i followed by n zero bytes, which lets
+// update() fold in eight bytes at once ("slicing-by-8").
+static constexpr auto generate_tables()
 {
-    Array<u32, 256> data {};
-    for (auto i = 0u; i < data.size(); i++) {
+    Array<Array<u32, 256>, 8> tables {};
+    for (auto i = 0u; i < 256; i++) {
         u32 value = i;
 
         for (auto j = 0; j < 8; j++) {
             if (value & 1) {
-                value = 0xEDB88320 ^ (value >> 1);
+                value = polynomial ^ (value >> 1);
             } else {
                 value = value >> 1;
             }
         }
 
-        data[i] = value;
+        tables[0][i] = value;
+    }
+    for (auto i = 0u; i < 256; i++) {
+        for (auto n = 1u; n < tables.size(); n++)
+            tables[n][i] = tables[0][tables[n - 1][i] & 0xFF] ^ (tables[n - 1][i] >> 8);
+    }
+    return tables;
+}
+
+static constexpr auto tables = generate_tables();
+
+static u32 update_sliced(u32 state, ReadonlyBytes data)
+{
+    size_t i = 0;
+    for (; i + 8 <= data.size(); i += 8) {
+        u32 low;
+        u32 high;
+        memcpy(&low, data.offset_pointer(i), sizeof(low));
+        memcpy(&high, data.offset_pointer(i + 4), sizeof(high));
+        low = AK::convert_between_host_and_little_endian(low) ^ state;
+        high = AK::convert_between_host_and_little_endian(high);
+
+        state = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24]
+            ^ tables[3][high & 0xFF] ^ tables[2][(high >> 8) & 0xFF] ^ tables[1][(high >> 16) & 0xFF] ^ tables[0][high >> 24];
     }
-    return data;
+    for (; i < data.size(); i++)
+        state = tables[0][(state ^ data[i]) & 0xFF] ^ (state >> 8);
+    return state;
+}
+
+#if ARCH(X86_64)
+// Note: The SSE4.2 crc32 instruction computes CRC-32C, which uses a different polynomial, so it can't be used here.
+static bool has_pclmulqdq()
+{
+    static bool const result = [] {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            return false;
+        return (ecx & bit_PCLMUL) && (ecx & bit_SSE4_1);
+    }();
+    return result;
+}
+
+[[gnu::target("pclmul,sse4.1")]] ALWAYS_INLINE static __m128i fold(__m128i value, __m128i constants, __m128i next)
+{
+    auto low = _mm_clmulepi64_si128(value, constants, 0x00);
+    auto high = _mm_clmulepi64_si128(value, constants, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(high, low), next);
 }
 
-static constexpr auto table = generate_table();
+// Folds 64 bytes at a time with carry-less multiplications, then reduces the remainder with a Barrett reduction, as
+// described in "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" by Gopal et al.
+// The data has to be at least 64 bytes long, and its length has to be a multiple of 16.
+[[gnu::target("pclmul,sse4.1")]] static u32 update_pclmulqdq(u32 state, ReadonlyBytes data)
+{
+    VERIFY(data.size() >= 64 && data.size() % 16 == 0);
+
+    // The constants for the bit-reflected polynomial, from the end of the paper.
+    auto const k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    auto const k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    auto const k5k0 = _mm_set_epi64x(0, 0x0163cd6124);
+    auto const poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+
+    auto const* pointer = data.data();
+    auto load = [&](size_t offset) { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(pointer + offset)); };
+
+    auto x1 = _mm_xor_si128(load(0x00), _mm_cvtsi32_si128(static_cast<int>(state)));
+    auto x2 = load(0x10);
+    auto x3 = load(0x20);
+    auto x4 = load(0x30);
+    pointer += 64;
+    size_t remaining = data.size() - 64;
+
+    for (; remaining >= 64; remaining -= 64, pointer += 64) {
+        x1 = fold(x1, k1k2, load(0x00));
+        x2 = fold(x2, k1k2, load(0x10));
+        x3 = fold(x3, k1k2, load(0x20));
+        x4 = fold(x4, k1k2, load(0x30));
+    }
+
+    x1 = fold(x1, k3k4, x2);
+    x1 = fold(x1, k3k4, x3);
+    x1 = fold(x1, k3k4, x4);
+
+    for (; remaining >= 16; remaining -= 16, pointer += 16)
+        x1 = fold(x1, k3k4, load(0));
+
+    // Fold 128 bits down to 64 bits.
+    auto const low_32_bits = _mm_setr_epi32(~0, 0, ~0, 0);
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, low_32_bits);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, k5k0, 0x00), x2);
+
+    // Barrett reduction to 32 bits.
+    x2 = _mm_and_si128(x1, low_32_bits);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, low_32_bits);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<u32>(_mm_extract_epi32(x1, 1));
+}
+#endif
 
 void CRC32::update(ReadonlyBytes data)
 {
-    for (size_t i = 0; i < data.size(); i++) {
-        m_state = table[(m_state ^ data.at(i)) & 0xFF] ^ (m_state >> 8);
+#if ARCH(X86_64)
+    if (data.size() >= 64 && has_pclmulqdq()) {
+        auto folded_size = data.size() & ~static_cast<size_t>(15);
+        m_state = update_pclmulqdq(m_state, data.trim(folded_size));
+        data = data.slice(folded_size);
     }
+#endif
+    m_state = update_sliced(m_state, data);
 };
 
 u32 CRC32::digest()
@@ -4,10 +4,17 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Endian.h>
+#include <AK/Platform.h>
 #include <AK/StringBuilder.h>
 #include <LibCrypto/Cipher/AES.h>
 #include <LibCrypto/Cipher/AESTables.h>
 
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <cpuid.h>
+#    include <immintrin.h>
+#endif
+
 namespace Crypto {
 namespace Cipher {
 
@@ -197,8 +204,205 @@ void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
     }
 }
 
+#if ARCH(X86_64) && !defined(KERNEL)
+static bool has_aes_ni()
+{
+    static bool const result = [] {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            return false;
+        return (ecx & bit_AES) && (ecx & bit_SSSE3);
+    }();
+    return result;
+}
+
+// The round keys are stored as big-endian words for the table-based implementation, so they have to be byte-swapped
+// into the order that the AES instructions expect. The decryption keys are already in the form that aesdec wants,
+// with InvMixColumns applied to the middle rounds.
+[[gnu::target("aes,ssse3")]] static size_t load_round_keys(AESCipherKey const& key, __m128i (&round_keys)[15])
+{
+    auto const swap_words = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    for (size_t i = 0; i <= key.rounds(); ++i)
+        round_keys[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(key.round_keys() + 4 * i)), swap_words);
+    return key.rounds();
+}
+
+// Running several independent blocks through each round at once hides the latency of the AES instructions.
+template<size_t N>
+[[gnu::target("aes,ssse3")]] ALWAYS_INLINE static void encrypt_with_aes_ni(__m128i (&blocks)[N], __m128i const (&round_keys)[15], size_t rounds)
+{
+    for (auto& block : blocks)
+        block = _mm_xor_si128(block, round_keys[0]);
+    for (size_t i = 1; i < rounds; ++i) {
+        for (auto& block : blocks)
+            block = _mm_aesenc_si128(block, round_keys[i]);
+    }
+    for (auto& block : blocks)
+        block = _mm_aesenclast_si128(block, round_keys[rounds]);
+}
+
+template<size_t N>
+[[gnu::target("aes,ssse3")]] ALWAYS_INLINE static void decrypt_with_aes_ni(__m128i (&blocks)[N], __m128i const (&round_keys)[15], size_t rounds)
+{
+    for (auto& block : blocks)
+        block = _mm_xor_si128(block, round_keys[0]);
+    for (size_t i = 1; i < rounds; ++i) {
+        for (auto& block : blocks)
+            block = _mm_aesdec_si128(block, round_keys[i]);
+    }
+    for (auto& block : blocks)
+        block = _mm_aesdeclast_si128(block, round_keys[rounds]);
+}
+
+[[gnu::target("aes,ssse3")]] static void encrypt_block_with_aes_ni(AESCipherKey const& key, u8 const* in, u8* out)
+{
+    __m128i round_keys[15];
+    auto rounds = load_round_keys(key, round_keys);
+    __m128i blocks[1] { _mm_loadu_si128(reinterpret_cast<__m128i const*>(in)) };
+    encrypt_with_aes_ni(blocks, round_keys, rounds);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), blocks[0]);
+}
+
+[[gnu::target("aes,ssse3")]] static void decrypt_block_with_aes_ni(AESCipherKey const& key, u8 const* in, u8* out)
+{
+    __m128i round_keys[15];
+    auto rounds = load_round_keys(key, round_keys);
+    __m128i blocks[1] { _mm_loadu_si128(reinterpret_cast<__m128i const*>(in)) };
+    decrypt_with_aes_ni(blocks, round_keys, rounds);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), blocks[0]);
+}
+
+static constexpr size_t blocks_in_flight = 8;
+
+[[gnu::target("aes,ssse3")]] static void encrypt_ctr_with_aes_ni(AESCipherKey const& key, u8 const* in, u8* out, size_t length, u8* counter)
+{
+    __m128i round_keys[15];
+    auto rounds = load_round_keys(key, round_keys);
+
+    u64 high;
+    u64 low;
+    __builtin_memcpy(&high, counter, sizeof(high));
+    __builtin_memcpy(&low, counter + 8, sizeof(low));
+    high = AK::convert_between_host_and_big_endian(high);
+    low = AK::convert_between_host_and_big_endian(low);
+
+    auto next_counter_block = [&] {
+        auto block = _mm_set_epi64x(static_cast<i64>(AK::convert_between_host_and_big_endian(low)), static_cast<i64>(AK::convert_between_host_and_big_endian(high)));
+        if (++low == 0)
+            ++high;
+        return block;
+    };
+
+    for (; length >= blocks_in_flight * 16; length -= blocks_in_flight * 16) {
+        __m128i blocks[blocks_in_flight];
+        for (auto& block : blocks)
+            block = next_counter_block();
+        encrypt_with_aes_ni(blocks, round_keys, rounds);
+        for (size_t i = 0; i < blocks_in_flight; ++i) {
+            if (in)
+                blocks[i] = _mm_xor_si128(blocks[i], _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i * 16)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 16), blocks[i]);
+        }
+        if (in)
+            in += blocks_in_flight * 16;
+        out += blocks_in_flight * 16;
+    }
+
+    while (length > 0) {
+        __m128i blocks[1] { next_counter_block() };
+        encrypt_with_aes_ni(blocks, round_keys, rounds);
+        u8 key_stream[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(key_stream), blocks[0]);
+
+        auto size = min(length, sizeof(key_stream));
+        for (size_t i = 0; i < size; ++i)
+            out[i] = in ? in[i] ^ key_stream[i] : key_stream[i];
+        if (in)
+            in += size;
+        out += size;
+        length -= size;
+    }
+
+    high = AK::convert_between_host_and_big_endian(high);
+    low = AK::convert_between_host_and_big_endian(low);
+    __builtin_memcpy(counter, &high, sizeof(high));
+    __builtin_memcpy(counter + 8, &low, sizeof(low));
+}
+
+// Unlike encryption, CBC decryption doesn't depend on the previous block's result, so it can be pipelined as well.
+// Each chunk of ciphertext is read before any plaintext is written, so |in| and |out| may be the same buffer.
+[[gnu::target("aes,ssse3")]] static void decrypt_cbc_with_aes_ni(AESCipherKey const& key, u8 const* in, u8* out, size_t length, u8 const* ivec)
+{
+    __m128i round_keys[15];
+    auto rounds = load_round_keys(key, round_keys);
+    auto previous = _mm_loadu_si128(reinterpret_cast<__m128i const*>(ivec));
+
+    for (; length >= blocks_in_flight * 16; length -= blocks_in_flight * 16) {
+        __m128i ciphertext[blocks_in_flight];
+        __m128i blocks[blocks_in_flight];
+        for (size_t i = 0; i < blocks_in_flight; ++i)
+            blocks[i] = ciphertext[i] = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i * 16));
+        decrypt_with_aes_ni(blocks, round_keys, rounds);
+        for (size_t i = 0; i < blocks_in_flight; ++i) {
+            blocks[i] = _mm_xor_si128(blocks[i], i == 0 ? previous : ciphertext[i - 1]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 16), blocks[i]);
+        }
+        previous = ciphertext[blocks_in_flight - 1];
+        in += blocks_in_flight * 16;
+        out += blocks_in_flight * 16;
+    }
+
+    for (; length >= 16; length -= 16) {
+        auto ciphertext = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in));
+        __m128i blocks[1] { ciphertext };
+        decrypt_with_aes_ni(blocks, round_keys, rounds);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_xor_si128(blocks[0], previous));
+        previous = ciphertext;
+        in += 16;
+        out += 16;
+    }
+}
+#endif
+
+bool AESCipher::encrypt_ctr_accelerated([[maybe_unused]] ReadonlyBytes const* in, [[maybe_unused]] Bytes out, [[maybe_unused]] Bytes counter) const
+{
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (!has_aes_ni())
+        return false;
+    VERIFY(counter.size() >= block_size());
+    VERIFY(!in || in->size() <= out.size());
+    auto length = in ? in->size() : out.size();
+    encrypt_ctr_with_aes_ni(m_key, in ? in->data() : nullptr, out.data(), length, counter.data());
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool AESCipher::decrypt_cbc_accelerated([[maybe_unused]] ReadonlyBytes in, [[maybe_unused]] Bytes out, [[maybe_unused]] ReadonlyBytes ivec) const
+{
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (!has_aes_ni())
+        return false;
+    VERIFY(in.size() % block_size() == 0);
+    VERIFY(in.size() <= out.size());
+    VERIFY(ivec.size() >= block_size());
+    decrypt_cbc_with_aes_ni(m_key, in.data(), out.data(), in.size(), ivec.data());
+    return true;
+#else
+    return false;
+#endif
+}
+
 void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 {
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_aes_ni()) {
+        encrypt_block_with_aes_ni(m_key, in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -288,6 +492,13 @@ void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 
 void AESCipher::decrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 {
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_aes_ni()) {
+        decrypt_block_with_aes_ni(m_key, in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
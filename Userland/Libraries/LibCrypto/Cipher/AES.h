@@ -120,6 +120,12 @@ public:
     virtual void encrypt_block(BlockType const& in, BlockType& out) override;
     virtual void decrypt_block(BlockType const& in, BlockType& out) override;
 
+    // Multi-block versions of CTR encryption (with a 128-bit big-endian counter, which is advanced past the blocks that
+    // were used) and CBC decryption, which keep several blocks in flight at once. They return false without touching
+    // anything when the CPU has no AES instructions, in which case the modes go block by block instead.
+    bool encrypt_ctr_accelerated(ReadonlyBytes const* in, Bytes out, Bytes counter) const;
+    bool decrypt_cbc_accelerated(ReadonlyBytes in, Bytes out, ReadonlyBytes ivec) const;
+
 #ifndef KERNEL
     virtual DeprecatedString class_name() const override
     {
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Endian.h>
+#include <AK/Memory.h>
+#include <LibCrypto/Authentication/Poly1305.h>
+#include <LibCrypto/Cipher/ChaCha20.h>
+#include <LibCrypto/Cipher/ChaCha20Poly1305.h>
+
+namespace Crypto::Cipher {
+
+ChaCha20Poly1305::ChaCha20Poly1305(ReadonlyBytes key)
+{
+    VERIFY(key.size() == key_size);
+    key.copy_to({ m_key, key_size });
+}
+
+// https://datatracker.ietf.org/doc/html/rfc8439#section-2.8
+ErrorOr<void> ChaCha20Poly1305::compute_tag(ReadonlyBytes ciphertext, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag) const
+{
+    // The one-time Poly1305 key is the start of the ChaCha20 block with counter 0.
+    u8 zeros[32] {};
+    u8 one_time_key[32];
+    Bytes one_time_key_bytes { one_time_key, sizeof(one_time_key) };
+    ChaCha20 key_generator({ m_key, key_size }, nonce, 0);
+    key_generator.encrypt({ zeros, sizeof(zeros) }, one_time_key_bytes);
+
+    Authentication::Poly1305 poly1305({ one_time_key, sizeof(one_time_key) });
+    auto update_padded = [&](ReadonlyBytes data) {
+        poly1305.update(data);
+        if (auto remainder = data.size() % 16; remainder != 0)
+            poly1305.update({ zeros, 16 - remainder });
+    };
+    update_padded(aad);
+    update_padded(ciphertext);
+
+    LittleEndian<u64> lengths[2] { aad.size(), ciphertext.size() };
+    poly1305.update({ lengths, sizeof(lengths) });
+
+    auto digest = TRY(poly1305.digest());
+    digest.bytes().copy_to(tag);
+    return {};
+}
+
+ErrorOr<void> ChaCha20Poly1305::encrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag) const
+{
+    VERIFY(nonce.size() == nonce_size);
+    VERIFY(out.size() >= in.size());
+    VERIFY(tag.size() == tag_size);
+
+    auto ciphertext = out.trim(in.size());
+    ChaCha20 cipher({ m_key, key_size }, nonce, 1);
+    cipher.encrypt(in, ciphertext);
+    return compute_tag(ciphertext, nonce, aad, tag);
+}
+
+ErrorOr<VerificationConsistency> ChaCha20Poly1305::decrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes tag) const
+{
+    VERIFY(nonce.size() == nonce_size);
+    VERIFY(out.size() >= in.size());
+
+    if (tag.size() != tag_size)
+        return VerificationConsistency::Inconsistent;
+
+    u8 expected_tag[tag_size];
+    TRY(compute_tag(in, nonce, aad, { expected_tag, tag_size }));
+    if (!timing_safe_compare(expected_tag, tag.data(), tag_size))
+        return VerificationConsistency::Inconsistent;
+
+    auto plaintext = out.trim(in.size());
+    ChaCha20 cipher({ m_key, key_size }, nonce, 1);
+    cipher.decrypt(in, plaintext);
+    return VerificationConsistency::Consistent;
+}
+
+}
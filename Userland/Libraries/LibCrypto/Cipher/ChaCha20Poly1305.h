@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/Span.h>
+#include <LibCrypto/Verification.h>
+
+namespace Crypto::Cipher {
+
+// The AEAD_CHACHA20_POLY1305 construction, as specified by RFC 8439 section 2.8.
+class ChaCha20Poly1305 {
+public:
+    static constexpr size_t key_size = 32;
+    static constexpr size_t nonce_size = 12;
+    static constexpr size_t tag_size = 16;
+
+    explicit ChaCha20Poly1305(ReadonlyBytes key);
+
+    ErrorOr<void> encrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag) const;
+    ErrorOr<VerificationConsistency> decrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes tag) const;
+
+private:
+    ErrorOr<void> compute_tag(ReadonlyBytes ciphertext, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag) const;
+
+    u8 m_key[key_size];
+};
+
+}
@@ -102,6 +102,14 @@ public:
         // FIXME (ponder): Should we simply decrypt as much as we can?
         VERIFY(length % block_size == 0);
 
+        if constexpr (requires { cipher.decrypt_cbc_accelerated(in, out, ivec); }) {
+            if (cipher.decrypt_cbc_accelerated(in, out, ivec)) {
+                out = out.slice(0, length);
+                this->prune_padding(out);
+                return;
+            }
+        }
+
         m_cipher_block.set_padding_mode(cipher.padding_mode());
         size_t offset { 0 };
 
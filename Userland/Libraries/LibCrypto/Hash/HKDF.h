@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <LibCrypto/Authentication/HMAC.h>
+
+namespace Crypto::Hash {
+
+// HMAC-based Extract-and-Expand Key Derivation Function, as specified by RFC 5869.
+// Any extra arguments are passed on to the constructor of the hash function, e.g. the HashKind for a Manager.
+template<typename HashT>
+class HKDF {
+public:
+    using HMACType = Authentication::HMAC<HashT>;
+    using DigestType = typename HMACType::TagType;
+
+    // RFC 5869 section 2.2: An empty salt acts like a string of HashLen zeros.
+    template<typename... Args>
+    static DigestType extract(ReadonlyBytes salt, ReadonlyBytes input_key_material, Args... hash_args)
+    {
+        HMACType hmac(salt, hash_args...);
+        return hmac.process(input_key_material);
+    }
+
+    // RFC 5869 section 2.3: The output may be at most 255 times as long as a digest.
+    template<typename... Args>
+    static void expand(ReadonlyBytes pseudorandom_key, ReadonlyBytes info, Bytes output, Args... hash_args)
+    {
+        HMACType hmac(pseudorandom_key, hash_args...);
+        auto digest_size = hmac.digest_size();
+        VERIFY(output.size() <= 255 * digest_size);
+
+        // T(i) = HMAC(PRK, T(i - 1) | info | i), where T(0) is empty.
+        u8 counter = 1;
+        for (size_t offset = 0; offset < output.size(); offset += digest_size, ++counter) {
+            if (offset > 0)
+                hmac.update(output.slice(offset - digest_size, digest_size));
+            hmac.update(info);
+            hmac.update(&counter, 1);
+            auto block = hmac.digest();
+            output.overwrite(offset, block.immutable_data(), min(digest_size, output.size() - offset));
+        }
+    }
+};
+
+}
@@ -9,6 +9,7 @@
 #include <AK/Optional.h>
 #include <AK/OwnPtr.h>
 #include <AK/Variant.h>
+#include <AK/Vector.h>
 #include <LibCrypto/Hash/HashFunction.h>
 #include <LibCrypto/Hash/MD5.h>
 #include <LibCrypto/Hash/SHA1.h>
@@ -205,6 +206,29 @@ public:
         return m_kind;
     }
 
+    // Hashes each of the messages on its own. Some algorithms can work on several of them at once.
+    static Vector<DigestType> hash_many(HashKind kind, Span<ReadonlyBytes const> messages)
+    {
+        Vector<DigestType> digests;
+        digests.ensure_capacity(messages.size());
+
+        if (kind == HashKind::SHA256) {
+            Vector<SHA256::DigestType> sha256_digests;
+            sha256_digests.resize(messages.size());
+            SHA256::hash_many(messages, sha256_digests.span());
+            for (auto const& digest : sha256_digests)
+                digests.unchecked_append(digest);
+            return digests;
+        }
+
+        Manager hash(kind);
+        for (auto const& message : messages) {
+            hash.update(message);
+            digests.unchecked_append(hash.digest());
+        }
+        return digests;
+    }
+
     inline bool is(HashKind kind) const
     {
         return m_kind == kind;
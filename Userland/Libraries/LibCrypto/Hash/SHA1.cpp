@@ -6,9 +6,15 @@
 
 #include <AK/Endian.h>
 #include <AK/Memory.h>
+#include <AK/Platform.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA1.h>
 
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <cpuid.h>
+#    include <immintrin.h>
+#endif
+
 namespace Crypto::Hash {
 
 static constexpr auto ROTATE_LEFT(u32 value, size_t bits)
@@ -16,8 +22,74 @@ static constexpr auto ROTATE_LEFT(u32 value, size_t bits)
     return (value << bits) | (value >> (32 - bits));
 }
 
+#if ARCH(X86_64) && !defined(KERNEL)
+static bool has_sha_ni()
+{
+    static bool const result = [] {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSE4_1))
+            return false;
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+            return false;
+        return (ebx & bit_SHA) != 0;
+    }();
+    return result;
+}
+
+// Four rounds of SHA-1 with the SHA extensions, which also advance the message schedule for the groups that follow.
+// E is carried between groups in alternating registers, since sha1nexte derives it from the previous A.
+template<size_t Group>
+[[gnu::target("sha,sse4.1")]] ALWAYS_INLINE static void rounds_with_sha_ni(__m128i& abcd, __m128i (&e)[2], __m128i (&words)[4], u8 const* data)
+{
+    auto& current = words[Group % 4];
+    if constexpr (Group < 4) {
+        auto const reverse_bytes = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+        current = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data + Group * 16)), reverse_bytes);
+    }
+
+    if constexpr (Group == 0)
+        e[0] = _mm_add_epi32(e[0], current);
+    else
+        e[Group % 2] = _mm_sha1nexte_epu32(e[Group % 2], current);
+    e[(Group + 1) % 2] = abcd;
+    if constexpr (Group >= 3 && Group < 19)
+        words[(Group + 1) % 4] = _mm_sha1msg2_epu32(words[(Group + 1) % 4], current);
+    abcd = _mm_sha1rnds4_epu32(abcd, e[Group % 2], Group / 5);
+    if constexpr (Group >= 1 && Group < 17)
+        words[(Group + 3) % 4] = _mm_sha1msg1_epu32(words[(Group + 3) % 4], current);
+    if constexpr (Group >= 2 && Group < 18)
+        words[(Group + 2) % 4] = _mm_xor_si128(words[(Group + 2) % 4], current);
+
+    if constexpr (Group < 19)
+        rounds_with_sha_ni<Group + 1>(abcd, e, words, data);
+}
+
+[[gnu::target("sha,sse4.1")]] static void transform_with_sha_ni(u32 (&state)[5], u8 const* data)
+{
+    auto abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(state)), 0x1b);
+    auto const initial_abcd = abcd;
+    auto const initial_e = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+
+    __m128i e[2] { initial_e, {} };
+    __m128i words[4];
+    rounds_with_sha_ni<0>(abcd, e, words, data);
+
+    abcd = _mm_add_epi32(abcd, initial_abcd);
+    e[0] = _mm_sha1nexte_epu32(e[0], initial_e);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = static_cast<u32>(_mm_extract_epi32(e[0], 3));
+}
+#endif
+
 inline void SHA1::transform(u8 const* data)
 {
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_sha_ni()) {
+        transform_with_sha_ni(m_state, data);
+        return;
+    }
+#endif
+
     u32 blocks[80];
     for (size_t i = 0; i < 16; ++i)
         blocks[i] = AK::convert_between_host_and_network_endian(((u32 const*)data)[i]);
@@ -68,13 +140,28 @@ inline void SHA1::transform(u8 const* data)
 
 void SHA1::update(u8 const* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
+    while (length > 0) {
         if (m_data_length == BlockSize) {
             transform(m_data_buffer);
-            m_bit_length += 512;
+            m_bit_length += BlockSize * 8;
             m_data_length = 0;
         }
-        m_data_buffer[m_data_length++] = message[i];
+
+        // Whole blocks are hashed straight from the message, without copying them into the buffer first.
+        if (m_data_length == 0) {
+            for (; length >= BlockSize; length -= BlockSize, message += BlockSize) {
+                transform(message);
+                m_bit_length += BlockSize * 8;
+            }
+            if (length == 0)
+                break;
+        }
+
+        auto size = min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, size);
+        m_data_length += size;
+        message += size;
+        length -= size;
     }
 }
 
@@ -4,9 +4,17 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Endian.h>
+#include <AK/Optional.h>
+#include <AK/Platform.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA2.h>
 
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <cpuid.h>
+#    include <immintrin.h>
+#endif
+
 namespace Crypto::Hash {
 constexpr static auto ROTRIGHT(u32 a, size_t b) { return (a >> b) | (a << (32 - b)); }
 constexpr static auto CH(u32 x, u32 y, u32 z) { return (x & y) ^ (z & ~x); }
@@ -24,8 +32,257 @@ constexpr static auto EP1(u64 x) { return ROTRIGHT(x, 14) ^ ROTRIGHT(x, 18) ^ RO
 constexpr static auto SIGN0(u64 x) { return ROTRIGHT(x, 1) ^ ROTRIGHT(x, 8) ^ (x >> 7); }
 constexpr static auto SIGN1(u64 x) { return ROTRIGHT(x, 19) ^ ROTRIGHT(x, 61) ^ (x >> 6); }
 
+#if ARCH(X86_64) && !defined(KERNEL)
+static bool has_sha_ni()
+{
+    static bool const result = [] {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSE4_1))
+            return false;
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+            return false;
+        return (ebx & bit_SHA) != 0;
+    }();
+    return result;
+}
+
+static bool has_avx2()
+{
+    static bool const result = [] {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+            return false;
+
+        // The OS also has to save the SSE and AVX registers on context switches.
+        unsigned xcr0_low, xcr0_high;
+        asm volatile("xgetbv"
+                     : "=a"(xcr0_low), "=d"(xcr0_high)
+                     : "c"(0));
+        if ((xcr0_low & 0b110) != 0b110)
+            return false;
+
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+            return false;
+        return (ebx & bit_AVX2) != 0;
+    }();
+    return result;
+}
+
+// Four rounds of SHA-256 with the SHA extensions. Each group also advances the message schedule for the groups that
+// follow it, as in Intel's "New Instructions Supporting the Secure Hash Algorithm on Intel Architecture Processors".
+template<size_t Group>
+[[gnu::target("sha,sse4.1")]] ALWAYS_INLINE static void sha256_rounds_with_sha_ni(__m128i& abef, __m128i& cdgh, __m128i (&words)[4], u8 const* data)
+{
+    auto& current = words[Group % 4];
+    if constexpr (Group < 4) {
+        auto const swap_bytes = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        current = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data + Group * 16)), swap_bytes);
+    }
+
+    auto message = _mm_add_epi32(current, _mm_loadu_si128(reinterpret_cast<__m128i const*>(&SHA256Constants::RoundConstants[Group * 4])));
+    cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+    if constexpr (Group >= 3 && Group < 15) {
+        auto& next = words[(Group + 1) % 4];
+        next = _mm_add_epi32(next, _mm_alignr_epi8(current, words[(Group + 3) % 4], 4));
+        next = _mm_sha256msg2_epu32(next, current);
+    }
+    abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(message, 0x0e));
+    if constexpr (Group >= 1 && Group < 13) {
+        auto& previous = words[(Group + 3) % 4];
+        previous = _mm_sha256msg1_epu32(previous, current);
+    }
+
+    if constexpr (Group < 15)
+        sha256_rounds_with_sha_ni<Group + 1>(abef, cdgh, words, data);
+}
+
+[[gnu::target("sha,sse4.1")]] static void sha256_transform_with_sha_ni(u32 (&state)[8], u8 const* data)
+{
+    // The instructions want the state as ABEF and CDGH, with A and C in the highest lanes.
+    auto dcba = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&state[0]));
+    auto hgfe = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&state[4]));
+    auto cdab = _mm_shuffle_epi32(dcba, 0xb1);
+    auto efgh = _mm_shuffle_epi32(hgfe, 0x1b);
+    auto abef = _mm_alignr_epi8(cdab, efgh, 8);
+    auto cdgh = _mm_blend_epi16(efgh, cdab, 0xf0);
+
+    auto const initial_abef = abef;
+    auto const initial_cdgh = cdgh;
+    __m128i words[4];
+    sha256_rounds_with_sha_ni<0>(abef, cdgh, words, data);
+    abef = _mm_add_epi32(abef, initial_abef);
+    cdgh = _mm_add_epi32(cdgh, initial_cdgh);
+
+    auto feba = _mm_shuffle_epi32(abef, 0x1b);
+    auto dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+namespace {
+
+// Runs one block for each of eight independent messages through SHA-256, with every 32-bit lane of the AVX2 registers
+// working on a different message. The state is kept transposed, with word i of lane n at state[i][n].
+struct SHA256Lanes {
+    static constexpr size_t Count = 8;
+
+    u32 state[8][Count];
+    u8 const* blocks[Count];
+    u32 active_mask[Count];
+};
+
+}
+
+[[gnu::target("avx2")]] ALWAYS_INLINE static __m256i rotate_right(__m256i value, int bits)
+{
+    return _mm256_or_si256(_mm256_srli_epi32(value, bits), _mm256_slli_epi32(value, 32 - bits));
+}
+
+[[gnu::target("avx2")]] static void sha256_transform_lanes_with_avx2(SHA256Lanes& lanes)
+{
+    __m256i m[64];
+    for (size_t i = 0; i < 16; ++i) {
+        u32 words[SHA256Lanes::Count];
+        for (size_t lane = 0; lane < SHA256Lanes::Count; ++lane) {
+            __builtin_memcpy(&words[lane], lanes.blocks[lane] + i * 4, sizeof(u32));
+            words[lane] = AK::convert_between_host_and_big_endian(words[lane]);
+        }
+        m[i] = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(words));
+    }
+    for (size_t i = 16; i < 64; ++i) {
+        auto sign0 = _mm256_xor_si256(_mm256_xor_si256(rotate_right(m[i - 15], 7), rotate_right(m[i - 15], 18)), _mm256_srli_epi32(m[i - 15], 3));
+        auto sign1 = _mm256_xor_si256(_mm256_xor_si256(rotate_right(m[i - 2], 17), rotate_right(m[i - 2], 19)), _mm256_srli_epi32(m[i - 2], 10));
+        m[i] = _mm256_add_epi32(_mm256_add_epi32(sign1, m[i - 7]), _mm256_add_epi32(sign0, m[i - 16]));
+    }
+
+    __m256i initial[8];
+    for (size_t i = 0; i < 8; ++i)
+        initial[i] = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(lanes.state[i]));
+
+    auto a = initial[0], b = initial[1], c = initial[2], d = initial[3];
+    auto e = initial[4], f = initial[5], g = initial[6], h = initial[7];
+    for (size_t i = 0; i < 64; ++i) {
+        auto ep1 = _mm256_xor_si256(_mm256_xor_si256(rotate_right(e, 6), rotate_right(e, 11)), rotate_right(e, 25));
+        auto ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        auto temp0 = _mm256_add_epi32(_mm256_add_epi32(h, ep1), _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(SHA256Constants::RoundConstants[i])), m[i])));
+        auto ep0 = _mm256_xor_si256(_mm256_xor_si256(rotate_right(a, 2), rotate_right(a, 13)), rotate_right(a, 22));
+        auto maj = _mm256_or_si256(_mm256_and_si256(a, _mm256_or_si256(b, c)), _mm256_and_si256(b, c));
+        auto temp1 = _mm256_add_epi32(ep0, maj);
+        h = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi32(d, temp0);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi32(temp0, temp1);
+    }
+
+    // Lanes that have run out of blocks keep their state.
+    auto active = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(lanes.active_mask));
+    __m256i const results[8] { a, b, c, d, e, f, g, h };
+    for (size_t i = 0; i < 8; ++i) {
+        auto updated = _mm256_add_epi32(initial[i], results[i]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.state[i]), _mm256_blendv_epi8(initial[i], updated, active));
+    }
+}
+
+// Hashes eight messages at a time, refilling each lane with the next message as soon as it is done with the last one.
+static void sha256_hash_many_with_avx2(Span<ReadonlyBytes const> messages, Span<SHA256::DigestType> digests)
+{
+    static constexpr size_t block_size = SHA256::block_size();
+
+    struct Lane {
+        Optional<size_t> message_index;
+        size_t block_index { 0 };
+        size_t block_count { 0 };
+        size_t whole_block_count { 0 };
+        // The last one or two blocks of the message, with its padding and length.
+        u8 final_blocks[2 * block_size];
+    };
+
+    SHA256Lanes lanes;
+    Lane lane_states[SHA256Lanes::Count];
+    u8 const idle_block[block_size] {};
+    size_t next_message = 0;
+
+    auto start_message = [&](size_t lane, size_t index) {
+        auto& lane_state = lane_states[lane];
+        auto message = messages[index];
+        lane_state.message_index = index;
+        lane_state.block_index = 0;
+        lane_state.whole_block_count = message.size() / block_size;
+
+        auto remainder = message.size() % block_size;
+        auto final_block_count = remainder + 9 <= block_size ? 1 : 2;
+        lane_state.block_count = lane_state.whole_block_count + final_block_count;
+        __builtin_memset(lane_state.final_blocks, 0, sizeof(lane_state.final_blocks));
+        __builtin_memcpy(lane_state.final_blocks, message.offset_pointer(message.size() - remainder), remainder);
+        lane_state.final_blocks[remainder] = 0x80;
+        u64 bit_length = AK::convert_between_host_and_big_endian(static_cast<u64>(message.size()) * 8);
+        __builtin_memcpy(lane_state.final_blocks + final_block_count * block_size - sizeof(u64), &bit_length, sizeof(u64));
+
+        for (size_t i = 0; i < 8; ++i)
+            lanes.state[i][lane] = SHA256Constants::InitializationHashes[i];
+    };
+
+    auto finish_message = [&](size_t lane) {
+        auto& digest = digests[*lane_states[lane].message_index];
+        for (size_t i = 0; i < 8; ++i) {
+            auto word = AK::convert_between_host_and_big_endian(lanes.state[i][lane]);
+            __builtin_memcpy(digest.data + i * sizeof(u32), &word, sizeof(u32));
+        }
+        lane_states[lane].message_index = {};
+    };
+
+    for (size_t lane = 0; lane < SHA256Lanes::Count; ++lane) {
+        if (next_message < messages.size())
+            start_message(lane, next_message++);
+    }
+
+    while (true) {
+        bool any_active = false;
+        for (size_t lane = 0; lane < SHA256Lanes::Count; ++lane) {
+            auto& lane_state = lane_states[lane];
+            if (!lane_state.message_index.has_value()) {
+                lanes.blocks[lane] = idle_block;
+                lanes.active_mask[lane] = 0;
+                continue;
+            }
+
+            any_active = true;
+            lanes.active_mask[lane] = NumericLimits<u32>::max();
+            if (lane_state.block_index < lane_state.whole_block_count)
+                lanes.blocks[lane] = messages[*lane_state.message_index].offset_pointer(lane_state.block_index * block_size);
+            else
+                lanes.blocks[lane] = lane_state.final_blocks + (lane_state.block_index - lane_state.whole_block_count) * block_size;
+        }
+        if (!any_active)
+            break;
+
+        sha256_transform_lanes_with_avx2(lanes);
+
+        for (size_t lane = 0; lane < SHA256Lanes::Count; ++lane) {
+            auto& lane_state = lane_states[lane];
+            if (!lane_state.message_index.has_value() || ++lane_state.block_index < lane_state.block_count)
+                continue;
+            finish_message(lane);
+            if (next_message < messages.size())
+                start_message(lane, next_message++);
+        }
+    }
+}
+#endif
+
 inline void SHA256::transform(u8 const* data)
 {
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_sha_ni()) {
+        sha256_transform_with_sha_ni(m_state, data);
+        return;
+    }
+#endif
+
     u32 m[64];
 
     size_t i = 0;
@@ -67,24 +324,62 @@ inline void SHA256::transform(u8 const* data)
 
 void SHA256::update(u8 const* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
+    while (length > 0) {
         if (m_data_length == BlockSize) {
             transform(m_data_buffer);
-            m_bit_length += 512;
+            m_bit_length += BlockSize * 8;
             m_data_length = 0;
         }
-        m_data_buffer[m_data_length++] = message[i];
+
+        // Whole blocks are hashed straight from the message, without copying them into the buffer first.
+        if (m_data_length == 0) {
+            for (; length >= BlockSize; length -= BlockSize, message += BlockSize) {
+                transform(message);
+                m_bit_length += BlockSize * 8;
+            }
+            if (length == 0)
+                break;
+        }
+
+        auto size = min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, size);
+        m_data_length += size;
+        message += size;
+        length -= size;
     }
 }
 
+void SHA256::hash_many(Span<ReadonlyBytes const> messages, Span<DigestType> digests)
+{
+    VERIFY(messages.size() == digests.size());
+
+#if ARCH(X86_64) && !defined(KERNEL)
+    // The SHA extensions are faster one message at a time than AVX2 is with eight of them.
+    if (!has_sha_ni() && has_avx2()) {
+        sha256_hash_many_with_avx2(messages, digests);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < messages.size(); ++i)
+        digests[i] = hash(messages[i].data(), messages[i].size());
+}
+
 SHA256::DigestType SHA256::digest()
 {
-    auto digest = peek();
+    auto digest = finish();
     reset();
     return digest;
 }
 
 SHA256::DigestType SHA256::peek()
+{
+    // Padding and transforming the last block changes the state, so finish a copy to leave the running hash alone.
+    SHA256 copy { *this };
+    return copy.finish();
+}
+
+SHA256::DigestType SHA256::finish()
 {
     DigestType digest;
     size_t i = m_data_length;
@@ -185,24 +480,45 @@ inline void SHA384::transform(u8 const* data)
 
 void SHA384::update(u8 const* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
+    while (length > 0) {
         if (m_data_length == BlockSize) {
             transform(m_data_buffer);
-            m_bit_length += 1024;
+            m_bit_length += BlockSize * 8;
             m_data_length = 0;
         }
-        m_data_buffer[m_data_length++] = message[i];
+
+        if (m_data_length == 0) {
+            for (; length >= BlockSize; length -= BlockSize, message += BlockSize) {
+                transform(message);
+                m_bit_length += BlockSize * 8;
+            }
+            if (length == 0)
+                break;
+        }
+
+        auto size = min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, size);
+        m_data_length += size;
+        message += size;
+        length -= size;
     }
 }
 
 SHA384::DigestType SHA384::digest()
 {
-    auto digest = peek();
+    auto digest = finish();
     reset();
     return digest;
 }
 
 SHA384::DigestType SHA384::peek()
+{
+    // Padding and transforming the last block changes the state, so finish a copy to leave the running hash alone.
+    SHA384 copy { *this };
+    return copy.finish();
+}
+
+SHA384::DigestType SHA384::finish()
 {
     DigestType digest;
     size_t i = m_data_length;
@@ -309,24 +625,45 @@ inline void SHA512::transform(u8 const* data)
 
 void SHA512::update(u8 const* message, size_t length)
 {
-    for (size_t i = 0; i < length; ++i) {
+    while (length > 0) {
         if (m_data_length == BlockSize) {
             transform(m_data_buffer);
-            m_bit_length += 1024;
+            m_bit_length += BlockSize * 8;
             m_data_length = 0;
         }
-        m_data_buffer[m_data_length++] = message[i];
+
+        if (m_data_length == 0) {
+            for (; length >= BlockSize; length -= BlockSize, message += BlockSize) {
+                transform(message);
+                m_bit_length += BlockSize * 8;
+            }
+            if (length == 0)
+                break;
+        }
+
+        auto size = min(length, BlockSize - m_data_length);
+        __builtin_memcpy(m_data_buffer + m_data_length, message, size);
+        m_data_length += size;
+        message += size;
+        length -= size;
     }
 }
 
 SHA512::DigestType SHA512::digest()
 {
-    auto digest = peek();
+    auto digest = finish();
     reset();
     return digest;
 }
 
 SHA512::DigestType SHA512::peek()
+{
+    // Padding and transforming the last block changes the state, so finish a copy to leave the running hash alone.
+    SHA512 copy { *this };
+    return copy.finish();
+}
+
+SHA512::DigestType SHA512::finish()
 {
     DigestType digest;
     size_t i = m_data_length;
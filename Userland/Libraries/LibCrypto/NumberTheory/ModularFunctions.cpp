@@ -37,19 +37,8 @@ UnsignedBigInteger ModularPower(UnsignedBigInteger const& b, UnsignedBigInteger
     if (m == 1)
         return 0;
 
-    if (m.is_odd()) {
-        UnsignedBigInteger temp_z0 { 0 };
-        UnsignedBigInteger temp_rr { 0 };
-        UnsignedBigInteger temp_one { 0 };
-        UnsignedBigInteger temp_z { 0 };
-        UnsignedBigInteger temp_zz { 0 };
-        UnsignedBigInteger temp_x { 0 };
-        UnsignedBigInteger temp_extra { 0 };
-
-        UnsignedBigInteger result;
-        UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocations(b, e, m, temp_z0, temp_rr, temp_one, temp_z, temp_zz, temp_x, temp_extra, result);
-        return result;
-    }
+    if (m.is_odd())
+        return ModularPower(b, e, make_montgomery_context(m));
 
     UnsignedBigInteger ep { e };
     UnsignedBigInteger base { b };
@@ -68,6 +57,18 @@ UnsignedBigInteger ModularPower(UnsignedBigInteger const& b, UnsignedBigInteger
     return result;
 }
 
+MontgomeryContext make_montgomery_context(UnsignedBigInteger const& m)
+{
+    return UnsignedBigIntegerAlgorithms::montgomery_context(m);
+}
+
+UnsignedBigInteger ModularPower(UnsignedBigInteger const& b, UnsignedBigInteger const& e, MontgomeryContext const& context)
+{
+    UnsignedBigInteger result;
+    UnsignedBigIntegerAlgorithms::montgomery_modular_power(b, e, context, result);
+    return result;
+}
+
 UnsignedBigInteger GCD(UnsignedBigInteger const& a, UnsignedBigInteger const& b)
 {
     UnsignedBigInteger temp_a { a };
@@ -106,7 +107,7 @@ UnsignedBigInteger LCM(UnsignedBigInteger const& a, UnsignedBigInteger const& b)
 
     // output = (a / gcd_output) * b
     UnsignedBigIntegerAlgorithms::divide_without_allocation(a, gcd_output, temp_1, temp_2, temp_3, temp_4, temp_quotient, temp_remainder);
-    UnsignedBigIntegerAlgorithms::multiply_without_allocation(temp_quotient, b, temp_1, temp_2, temp_3, output);
+    UnsignedBigIntegerAlgorithms::multiply_without_allocation(temp_quotient, b, output);
 
     dbgln_if(NT_DEBUG, "quot: {} rem: {} out: {}", temp_quotient, temp_remainder, output);
 
@@ -135,16 +136,17 @@ static bool MR_primality_test(UnsignedBigInteger n, Vector<UnsignedBigInteger, 2
         return n == 2;
     }
 
+    auto context = make_montgomery_context(n);
     for (auto& a : tests) {
         // Technically: VERIFY(2 <= a && a <= n - 2)
         VERIFY(a < n);
-        auto x = ModularPower(a, d, n);
+        auto x = ModularPower(a, d, context);
         if (x == 1 || x == predecessor)
             continue;
         bool skip_this_witness = false;
         // r − 1 iterations.
         for (size_t i = 0; i < r - 1; ++i) {
-            x = ModularPower(x, 2, n);
+            x = ModularPower(x, 2, context);
             if (x == predecessor) {
                 skip_this_witness = true;
                 break;
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Random.h>
+#include <LibCrypto/BigInt/Algorithms/UnsignedBigIntegerAlgorithms.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
 
 namespace Crypto {
@@ -14,6 +15,10 @@ namespace NumberTheory {
 
 UnsignedBigInteger ModularInverse(UnsignedBigInteger const& a_, UnsignedBigInteger const& b);
 UnsignedBigInteger ModularPower(UnsignedBigInteger const& b, UnsignedBigInteger const& e, UnsignedBigInteger const& m);
+// Note: Making the context once with |make_montgomery_context| and reusing it saves working it out again for every
+//       exponentiation with the same odd modulus.
+MontgomeryContext make_montgomery_context(UnsignedBigInteger const& m);
+UnsignedBigInteger ModularPower(UnsignedBigInteger const& b, UnsignedBigInteger const& e, MontgomeryContext const& context);
 
 // Note: This function _will_ generate extremely huge numbers, and in doing so,
 //       it will allocate and free a lot of memory!
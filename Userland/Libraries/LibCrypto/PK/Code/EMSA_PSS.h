@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Array.h>
+#include <AK/Endian.h>
 #include <AK/Format.h>
 #include <AK/Memory.h>
 #include <AK/Random.h>
@@ -78,20 +79,28 @@ public:
         for (size_t i = 0; i < DB.size(); ++i)
             DB_data[i] ^= DB_mask[i];
 
-        auto count = (8 - (em_length * 8 - em_bits));
-        DB_data[0] &= (0xff >> count) << count;
+        DB_data[0] &= 0xff >> (em_length * 8 - em_bits);
 
         out.overwrite(0, DB.data(), DB.size());
         out.overwrite(DB.size(), hash.data, hash_fn.DigestSize);
         out[DB.size() + hash_fn.DigestSize] = 0xbc;
     }
 
+    // RFC 8017 section 9.1.2
     virtual VerificationConsistency verify(ReadonlyBytes msg, ReadonlyBytes emsg, size_t em_bits) override
     {
         auto& hash_fn = this->hasher();
         hash_fn.update(msg);
         auto message_hash = hash_fn.digest();
 
+        // The encoded message may have been handed to us with the leading zero octets of the RSA output.
+        auto em_length = (em_bits + 7) / 8;
+        while (emsg.size() > em_length) {
+            if (emsg[0] != 0)
+                return VerificationConsistency::Inconsistent;
+            emsg = emsg.slice(1);
+        }
+
         if (emsg.size() < HashFunction::DigestSize + SaltLength + 2)
             return VerificationConsistency::Inconsistent;
 
@@ -103,10 +112,8 @@ public:
         auto H = emsg.slice(mask_length, HashFunction::DigestSize);
 
         auto length_to_check = 8 * emsg.size() - em_bits;
-        auto octet = masked_DB[0];
-        for (size_t i = 0; i < length_to_check; ++i)
-            if ((octet >> (8 - i)) & 0x01)
-                return VerificationConsistency::Inconsistent;
+        if (masked_DB[0] & ~(0xff >> length_to_check))
+            return VerificationConsistency::Inconsistent;
 
         Vector<u8, 256> DB_mask;
         DB_mask.resize(mask_length);
@@ -119,7 +126,7 @@ public:
         for (size_t i = 0; i < mask_length; ++i)
             DB[i] = masked_DB[i] ^ DB_mask[i];
 
-        DB[0] &= 0xff >> (8 - length_to_check);
+        DB[0] &= 0xff >> length_to_check;
 
         auto check_octets = emsg.size() - HashFunction::DigestSize - SaltLength - 2;
         for (size_t i = 0; i < check_octets; ++i) {
@@ -127,7 +134,7 @@ public:
                 return VerificationConsistency::Inconsistent;
         }
 
-        if (DB[check_octets + 1] != 0x01)
+        if (DB[check_octets] != 0x01)
             return VerificationConsistency::Inconsistent;
 
         auto* salt = DB.span().offset(mask_length - SaltLength);
@@ -141,25 +148,23 @@ public:
         hash_fn.update(m_prime_buffer);
         auto H_prime = hash_fn.digest();
 
-        if (!timing_safe_compare(message_hash.data, H_prime.data, HashFunction::DigestSize))
+        if (!timing_safe_compare(H.data(), H_prime.data, HashFunction::DigestSize))
             return VerificationConsistency::Inconsistent;
 
         return VerificationConsistency::Consistent;
     }
 
+    // RFC 8017 appendix B.2.1
     void MGF1(ReadonlyBytes seed, size_t length, Bytes out)
     {
         auto& hash_fn = this->hasher();
-        ByteBuffer T;
-        for (size_t counter = 0; counter < length / HashFunction::DigestSize - 1; ++counter) {
+        for (u32 counter = 0, offset = 0; offset < length; ++counter, offset += HashFunction::DigestSize) {
+            BigEndian<u32> counter_octets = counter;
             hash_fn.update(seed);
-            hash_fn.update((u8*)&counter, 4);
-            if (auto result = T.try_append(hash_fn.digest().data, HashFunction::DigestSize); result.is_error()) {
-                dbgln("EMSA_PSS: MGF1 digest failed: {}", result.error());
-                return;
-            }
+            hash_fn.update((u8 const*)&counter_octets, sizeof(counter_octets));
+            auto digest = hash_fn.digest();
+            out.overwrite(offset, digest.data, min<size_t>(HashFunction::DigestSize, length - offset));
         }
-        out.overwrite(0, T.data(), length);
     }
 
 private:
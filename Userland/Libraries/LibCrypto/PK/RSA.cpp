@@ -210,6 +210,15 @@ RSA::KeyPairType RSA::parse_rsa_key(ReadonlyBytes der)
     }
 }
 
+template<typename KeyType>
+static UnsignedBigInteger modular_power_with_key(UnsignedBigInteger const& base, UnsignedBigInteger const& exponent, KeyType const& key)
+{
+    // Valid keys always have an odd modulus, but broken ones shouldn't trip the assertions of the Montgomery context.
+    if (!key.modulus().is_odd() || key.modulus() == 1)
+        return NumberTheory::ModularPower(base, exponent, key.modulus());
+    return NumberTheory::ModularPower(base, exponent, key.montgomery_context());
+}
+
 void RSA::encrypt(ReadonlyBytes in, Bytes& out)
 {
     dbgln_if(CRYPTO_DEBUG, "in size: {}", in.size());
@@ -219,7 +228,7 @@ void RSA::encrypt(ReadonlyBytes in, Bytes& out)
         out = {};
         return;
     }
-    auto exp = NumberTheory::ModularPower(in_integer, m_public_key.public_exponent(), m_public_key.modulus());
+    auto exp = modular_power_with_key(in_integer, m_public_key.public_exponent(), m_public_key);
     auto size = exp.export_data(out);
     auto outsize = out.size();
     if (size != outsize) {
@@ -233,7 +242,7 @@ void RSA::decrypt(ReadonlyBytes in, Bytes& out)
     // FIXME: Actually use the private key properly
 
     auto in_integer = UnsignedBigInteger::import_data(in.data(), in.size());
-    auto exp = NumberTheory::ModularPower(in_integer, m_private_key.private_exponent(), m_private_key.modulus());
+    auto exp = modular_power_with_key(in_integer, m_private_key.private_exponent(), m_private_key);
     auto size = exp.export_data(out);
 
     auto align = m_private_key.length();
@@ -247,7 +256,7 @@ void RSA::decrypt(ReadonlyBytes in, Bytes& out)
 void RSA::sign(ReadonlyBytes in, Bytes& out)
 {
     auto in_integer = UnsignedBigInteger::import_data(in.data(), in.size());
-    auto exp = NumberTheory::ModularPower(in_integer, m_private_key.private_exponent(), m_private_key.modulus());
+    auto exp = modular_power_with_key(in_integer, m_private_key.private_exponent(), m_private_key);
     auto size = exp.export_data(out);
     out = out.slice(out.size() - size, size);
 }
@@ -255,7 +264,7 @@ void RSA::sign(ReadonlyBytes in, Bytes& out)
 void RSA::verify(ReadonlyBytes in, Bytes& out)
 {
     auto in_integer = UnsignedBigInteger::import_data(in.data(), in.size());
-    auto exp = NumberTheory::ModularPower(in_integer, m_public_key.public_exponent(), m_public_key.modulus());
+    auto exp = modular_power_with_key(in_integer, m_public_key.public_exponent(), m_public_key);
     auto size = exp.export_data(out);
     out = out.slice(out.size() - size, size);
 }
@@ -41,12 +41,23 @@ public:
         m_modulus = move(n);
         m_public_exponent = move(e);
         m_length = (m_modulus.trimmed_length() * sizeof(u32));
+        m_montgomery_context.clear();
+    }
+
+    // Only valid for an odd modulus. It is worked out on first use, since most keys (e.g. those of CA certificates)
+    // are never used at all.
+    MontgomeryContext const& montgomery_context() const
+    {
+        if (!m_montgomery_context.has_value())
+            m_montgomery_context = NumberTheory::make_montgomery_context(m_modulus);
+        return *m_montgomery_context;
     }
 
 private:
     Integer m_modulus;
     Integer m_public_exponent;
     size_t m_length { 0 };
+    mutable Optional<MontgomeryContext> m_montgomery_context;
 };
 
 template<typename Integer = UnsignedBigInteger>
@@ -74,6 +85,15 @@ public:
         m_private_exponent = move(d);
         m_public_exponent = move(e);
         m_length = m_modulus.trimmed_length() * sizeof(u32);
+        m_montgomery_context.clear();
+    }
+
+    // Only valid for an odd modulus, see RSAPublicKey::montgomery_context().
+    MontgomeryContext const& montgomery_context() const
+    {
+        if (!m_montgomery_context.has_value())
+            m_montgomery_context = NumberTheory::make_montgomery_context(m_modulus);
+        return *m_montgomery_context;
     }
 
 private:
@@ -81,6 +101,7 @@ private:
     Integer m_private_exponent;
     Integer m_public_exponent;
     size_t m_length { 0 };
+    mutable Optional<MontgomeryContext> m_montgomery_context;
 };
 
 template<typename PubKey, typename PrivKey>
@@ -115,6 +115,7 @@ Optional<Packet> Packet::from_raw_packet(u8 const* raw_data, size_t raw_size)
     packet.m_id = header.id();
     packet.m_query_or_response = header.is_response();
     packet.m_code = header.response_code();
+    packet.m_truncated = header.is_truncated();
 
     // FIXME: Should we parse further in this case?
     if (packet.code() != Code::NOERROR)
@@ -30,6 +30,8 @@ public:
     bool is_query() const { return !m_query_or_response; }
     bool is_response() const { return m_query_or_response; }
     bool is_authoritative_answer() const { return m_authoritative_answer; }
+    // The response didn't fit into a UDP datagram, so it has to be asked for again over TCP.
+    bool is_truncated() const { return m_truncated; }
     bool recursion_desired() const { return m_recursion_desired; }
     bool recursion_available() const { return m_recursion_available; }
     void set_is_query() { m_query_or_response = false; }
@@ -79,6 +81,7 @@ private:
     u16 m_id { 0 };
     u8 m_code { 0 };
     bool m_authoritative_answer { false };
+    bool m_truncated { false };
     bool m_query_or_response { false };
     bool m_recursion_desired { true };
     bool m_recursion_available { true };
@@ -7,6 +7,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <AK/ByteBuffer.h>
 #include <AK/Debug.h>
 #include <AK/HashMap.h>
@@ -61,17 +62,42 @@ static StringView s_ld_library_path;
 static StringView s_main_program_pledge_promises;
 static DeprecatedString s_loader_pledge_promises;
 
+// Relocations in different libraries keep referring to the same symbols (malloc, free, the AK formatting
+// machinery, ...), and looking up a global symbol means going through the hash table of every loaded object.
+// Until the first initializer runs, nothing but the loader can look up symbols, so while the program and its
+// dependencies are linked, we remember what every name resolved to.
+// NOTE: Libraries opened later on don't use this, as they could race with lazy PLT fixups on other threads.
+static bool s_may_cache_global_symbols = true;
+static HashMap<StringView, Optional<DynamicObject::SymbolLookupResult>>* s_global_symbol_cache = nullptr;
+
+// Once the program runs, symbols are looked up by lazy PLT fixups instead, which can happen on any thread and
+// even in signal handlers. They go through a small direct-mapped cache that doesn't need to allocate, and that
+// is simply bypassed whenever somebody else is using it.
+struct LazySymbolCacheEntry {
+    StringView name;
+    Optional<DynamicObject::SymbolLookupResult> result;
+};
+static constexpr size_t lazy_symbol_cache_size = 256;
+static Array<LazySymbolCacheEntry, lazy_symbol_cache_size> s_lazy_symbol_cache;
+static __pthread_mutex_t s_lazy_symbol_cache_lock = __PTHREAD_MUTEX_INITIALIZER;
+
+static void invalidate_lazy_symbol_cache()
+{
+    // NOTE: Objects that are added later on may provide a symbol that wasn't found before, or override a weak one.
+    pthread_mutex_lock(&s_lazy_symbol_cache_lock);
+    s_lazy_symbol_cache.fill({});
+    pthread_mutex_unlock(&s_lazy_symbol_cache_lock);
+}
+
 static Result<void, DlErrorMessage> __dlclose(void* handle);
 static Result<void*, DlErrorMessage> __dlopen(char const* filename, int flags);
 static Result<void*, DlErrorMessage> __dlsym(void* handle, char const* symbol_name);
 static Result<void, DlErrorMessage> __dladdr(void* addr, Dl_info* info);
 
-Optional<DynamicObject::SymbolLookupResult> DynamicLinker::lookup_global_symbol(StringView name)
+static Optional<DynamicObject::SymbolLookupResult> lookup_global_symbol_uncached(DynamicObject::HashSymbol const& symbol)
 {
     Optional<DynamicObject::SymbolLookupResult> weak_result;
 
-    auto symbol = DynamicObject::HashSymbol { name };
-
     for (auto& lib : s_global_objects) {
         auto res = lib.value->lookup_symbol(symbol);
         if (!res.has_value())
@@ -85,6 +111,34 @@ Optional<DynamicObject::SymbolLookupResult> DynamicLinker::lookup_global_symbol(
     return weak_result;
 }
 
+static Optional<DynamicObject::SymbolLookupResult> lookup_global_symbol_lazily(DynamicObject::HashSymbol const& symbol)
+{
+    if (pthread_mutex_trylock(&s_lazy_symbol_cache_lock) != 0)
+        return lookup_global_symbol_uncached(symbol);
+    ScopeGuard unlock_guard = [] { pthread_mutex_unlock(&s_lazy_symbol_cache_lock); };
+
+    auto& entry = s_lazy_symbol_cache[symbol.gnu_hash() % lazy_symbol_cache_size];
+    if (!entry.name.is_null() && entry.name == symbol.name())
+        return entry.result;
+    auto result = lookup_global_symbol_uncached(symbol);
+    entry = { symbol.name(), result };
+    return result;
+}
+
+Optional<DynamicObject::SymbolLookupResult> DynamicLinker::lookup_global_symbol(StringView name)
+{
+    auto symbol = DynamicObject::HashSymbol { name };
+    // NOTE: The names are borrowed from the string tables of the objects, which are never unmapped.
+    if (!s_global_symbol_cache)
+        return lookup_global_symbol_lazily(symbol);
+
+    if (auto it = s_global_symbol_cache->find(name); it != s_global_symbol_cache->end())
+        return it->value;
+    auto result = lookup_global_symbol_uncached(symbol);
+    s_global_symbol_cache->set(name, result);
+    return result;
+}
+
 static Result<NonnullRefPtr<DynamicLoader>, DlErrorMessage> map_library(DeprecatedString const& filepath, int fd)
 {
     VERIFY(filepath.starts_with('/'));
@@ -101,6 +155,7 @@ static Result<NonnullRefPtr<DynamicLoader>, DlErrorMessage> map_library(Deprecat
     // This actually maps the library at the intended and final place.
     auto main_library_object = loader->map();
     s_global_objects.set(filepath, *main_library_object);
+    invalidate_lazy_symbol_cache();
 
     return loader;
 }
@@ -389,6 +444,12 @@ static Result<void, DlErrorMessage> link_main_library(DeprecatedString const& pa
         if (dynamic_object)
             s_global_objects.set(dynamic_object->filepath(), *dynamic_object);
     }
+    invalidate_lazy_symbol_cache();
+
+    HashMap<StringView, Optional<DynamicObject::SymbolLookupResult>> global_symbol_cache;
+    if (s_may_cache_global_symbols)
+        s_global_symbol_cache = &global_symbol_cache;
+    ScopeGuard symbol_cache_guard = [] { s_global_symbol_cache = nullptr; };
 
     for (auto& loader : loaders) {
         bool success = loader.link(flags);
@@ -426,6 +487,10 @@ static Result<void, DlErrorMessage> link_main_library(DeprecatedString const& pa
 
     drop_loader_promise("prot_exec"sv);
 
+    // Initializers may start threads, which would then look up symbols on their own.
+    s_global_symbol_cache = nullptr;
+    s_may_cache_global_symbols = false;
+
     for (auto& loader : loaders) {
         loader.load_stage_4();
     }
@@ -127,49 +127,43 @@ void GLContext::gl_clear_depth(GLfloat depth)
     m_clear_depth = clamp(depth, 0.f, 1.f);
 }
 
-void GLContext::gl_end()
+GPU::PrimitiveType GLContext::to_primitive_type(GLenum draw_mode)
 {
-    APPEND_TO_CALL_LIST_AND_RETURN_IF_NEEDED(gl_end);
-
-    // Make sure we had a `glBegin` before this call...
-    RETURN_WITH_ERROR_IF(!m_in_draw_state, GL_INVALID_OPERATION);
-    m_in_draw_state = false;
-
-    sync_device_config();
-
-    GPU::PrimitiveType primitive_type;
-    switch (m_current_draw_mode) {
+    switch (draw_mode) {
     case GL_LINE_LOOP:
-        primitive_type = GPU::PrimitiveType::LineLoop;
-        break;
+        return GPU::PrimitiveType::LineLoop;
     case GL_LINE_STRIP:
-        primitive_type = GPU::PrimitiveType::LineStrip;
-        break;
+        return GPU::PrimitiveType::LineStrip;
     case GL_LINES:
-        primitive_type = GPU::PrimitiveType::Lines;
-        break;
+        return GPU::PrimitiveType::Lines;
     case GL_POINTS:
-        primitive_type = GPU::PrimitiveType::Points;
-        break;
+        return GPU::PrimitiveType::Points;
     case GL_TRIANGLES:
-        primitive_type = GPU::PrimitiveType::Triangles;
-        break;
+        return GPU::PrimitiveType::Triangles;
     case GL_TRIANGLE_STRIP:
     case GL_QUAD_STRIP:
-        primitive_type = GPU::PrimitiveType::TriangleStrip;
-        break;
+        return GPU::PrimitiveType::TriangleStrip;
     case GL_TRIANGLE_FAN:
     case GL_POLYGON:
-        primitive_type = GPU::PrimitiveType::TriangleFan;
-        break;
+        return GPU::PrimitiveType::TriangleFan;
     case GL_QUADS:
-        primitive_type = GPU::PrimitiveType::Quads;
-        break;
+        return GPU::PrimitiveType::Quads;
     default:
         VERIFY_NOT_REACHED();
     }
+}
+
+void GLContext::gl_end()
+{
+    APPEND_TO_CALL_LIST_AND_RETURN_IF_NEEDED(gl_end);
+
+    // Make sure we had a `glBegin` before this call...
+    RETURN_WITH_ERROR_IF(!m_in_draw_state, GL_INVALID_OPERATION);
+    m_in_draw_state = false;
+
+    sync_device_config();
 
-    m_rasterizer->draw_primitives(primitive_type, model_view_matrix(), projection_matrix(), m_vertex_list);
+    m_rasterizer->draw_primitives(to_primitive_type(m_current_draw_mode), model_view_matrix(), projection_matrix(), m_vertex_list);
     m_vertex_list.clear_with_capacity();
 }
 
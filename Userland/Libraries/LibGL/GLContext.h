@@ -251,6 +251,9 @@ private:
 
     ErrorOr<ByteBuffer> build_extension_string();
 
+    static GPU::PrimitiveType to_primitive_type(GLenum draw_mode);
+    GPU::Vertex read_vertex_from_client_arrays(int index) const;
+
     template<typename T>
     T* store_in_listing(T value)
     {
@@ -318,6 +321,7 @@ private:
     FloatVector3 m_current_vertex_normal { 0.0f, 0.0f, 1.0f };
 
     Vector<GPU::Vertex> m_vertex_list;
+    Vector<u32> m_index_list;
 
     GLenum m_error = GL_NO_ERROR;
     bool m_in_draw_state = false;
@@ -8,6 +8,7 @@
 
 #include <AK/Assertions.h>
 #include <AK/NumericLimits.h>
+#include <AK/ScopeGuard.h>
 #include <LibGL/GLContext.h>
 
 namespace GL {
@@ -119,6 +120,40 @@ void GLContext::gl_color_pointer(GLint size, GLenum type, GLsizei stride, void c
     m_client_color_pointer = { .size = size, .type = type, .normalize = true, .stride = stride, .pointer = data_pointer };
 }
 
+GPU::Vertex GLContext::read_vertex_from_client_arrays(int index) const
+{
+    GPU::Vertex vertex;
+
+    vertex.color = m_current_vertex_color;
+    if (m_client_side_color_array_enabled) {
+        float color[4] { 0.f, 0.f, 0.f, 1.f };
+        read_from_vertex_attribute_pointer(m_client_color_pointer, index, color);
+        vertex.color = { color[0], color[1], color[2], color[3] };
+    }
+
+    for (size_t t = 0; t < m_device_info.num_texture_units; ++t) {
+        vertex.tex_coords[t] = m_current_vertex_tex_coord[t];
+        if (m_client_side_texture_coord_array_enabled[t]) {
+            float tex_coords[4] { 0.f, 0.f, 0.f, 1.f };
+            read_from_vertex_attribute_pointer(m_client_tex_coord_pointer[t], index, tex_coords);
+            vertex.tex_coords[t] = { tex_coords[0], tex_coords[1], tex_coords[2], tex_coords[3] };
+        }
+    }
+
+    vertex.normal = m_current_vertex_normal;
+    if (m_client_side_normal_array_enabled) {
+        float normal[3];
+        read_from_vertex_attribute_pointer(m_client_normal_pointer, index, normal);
+        vertex.normal = { normal[0], normal[1], normal[2] };
+    }
+
+    float position[4] { 0.f, 0.f, 0.f, 1.f };
+    read_from_vertex_attribute_pointer(m_client_vertex_pointer, index, position);
+    vertex.position = { position[0], position[1], position[2], position[3] };
+
+    return vertex;
+}
+
 void GLContext::gl_draw_arrays(GLenum mode, GLint first, GLsizei count)
 {
     // NOTE: This always dereferences data; display list support is deferred to the
@@ -137,35 +172,26 @@ void GLContext::gl_draw_arrays(GLenum mode, GLint first, GLsizei count)
     RETURN_WITH_ERROR_IF(count < 0, GL_INVALID_VALUE);
 
     auto last = first + count;
-    gl_begin(mode);
-    for (int i = first; i < last; i++) {
-        if (m_client_side_color_array_enabled) {
-            float color[4] { 0.f, 0.f, 0.f, 1.f };
-            read_from_vertex_attribute_pointer(m_client_color_pointer, i, color);
-            gl_color(color[0], color[1], color[2], color[3]);
-        }
+    if (should_append_to_listing()) {
+        gl_begin(mode);
+        for (int i = first; i < last; i++)
+            gl_array_element(i);
+        gl_end();
+        return;
+    }
 
-        for (size_t t = 0; t < m_client_tex_coord_pointer.size(); ++t) {
-            if (m_client_side_texture_coord_array_enabled[t]) {
-                float tex_coords[4] { 0.f, 0.f, 0.f, 1.f };
-                read_from_vertex_attribute_pointer(m_client_tex_coord_pointer[t], i, tex_coords);
-                gl_multi_tex_coord(GL_TEXTURE0 + t, tex_coords[0], tex_coords[1], tex_coords[2], tex_coords[3]);
-            }
-        }
+    // Without a vertex array, no vertices are specified at all
+    if (!m_client_side_vertex_array_enabled)
+        return;
 
-        if (m_client_side_normal_array_enabled) {
-            float normal[3];
-            read_from_vertex_attribute_pointer(m_client_normal_pointer, i, normal);
-            gl_normal(normal[0], normal[1], normal[2]);
-        }
+    // The vertices are put together straight from the client arrays, without going through the immediate mode calls
+    RETURN_WITH_ERROR_IF(m_vertex_list.try_ensure_capacity(count).is_error(), GL_OUT_OF_MEMORY);
+    for (int i = first; i < last; i++)
+        m_vertex_list.unchecked_append(read_vertex_from_client_arrays(i));
 
-        if (m_client_side_vertex_array_enabled) {
-            float vertex[4] { 0.f, 0.f, 0.f, 1.f };
-            read_from_vertex_attribute_pointer(m_client_vertex_pointer, i, vertex);
-            gl_vertex(vertex[0], vertex[1], vertex[2], vertex[3]);
-        }
-    }
-    gl_end();
+    sync_device_config();
+    m_rasterizer->draw_primitives(to_primitive_type(mode), model_view_matrix(), projection_matrix(), m_vertex_list);
+    m_vertex_list.clear_with_capacity();
 }
 
 void GLContext::gl_draw_elements(GLenum mode, GLsizei count, GLenum type, void const* indices)
@@ -196,48 +222,64 @@ void GLContext::gl_draw_elements(GLenum mode, GLsizei count, GLenum type, void c
         index_data = m_element_array_buffer->offset_data(data_offset);
     }
 
-    gl_begin(mode);
+    RETURN_WITH_ERROR_IF(m_index_list.try_ensure_capacity(count).is_error(), GL_OUT_OF_MEMORY);
     for (int index = 0; index < count; index++) {
-        int i = 0;
         switch (type) {
         case GL_UNSIGNED_BYTE:
-            i = reinterpret_cast<GLubyte const*>(index_data)[index];
+            m_index_list.unchecked_append(reinterpret_cast<GLubyte const*>(index_data)[index]);
             break;
         case GL_UNSIGNED_SHORT:
-            i = reinterpret_cast<GLushort const*>(index_data)[index];
+            m_index_list.unchecked_append(reinterpret_cast<GLushort const*>(index_data)[index]);
             break;
         case GL_UNSIGNED_INT:
-            i = reinterpret_cast<GLuint const*>(index_data)[index];
+            m_index_list.unchecked_append(reinterpret_cast<GLuint const*>(index_data)[index]);
             break;
         }
+    }
+    ScopeGuard clear_index_list = [&] { m_index_list.clear_with_capacity(); };
+
+    if (should_append_to_listing()) {
+        gl_begin(mode);
+        for (auto i : m_index_list)
+            gl_array_element(static_cast<GLint>(i));
+        gl_end();
+        return;
+    }
 
-        if (m_client_side_color_array_enabled) {
-            float color[4] { 0.f, 0.f, 0.f, 1.f };
-            read_from_vertex_attribute_pointer(m_client_color_pointer, i, color);
-            gl_color(color[0], color[1], color[2], color[3]);
-        }
-
-        for (size_t t = 0; t < m_client_tex_coord_pointer.size(); ++t) {
-            if (m_client_side_texture_coord_array_enabled[t]) {
-                float tex_coords[4] { 0.f, 0.f, 0.f, 1.f };
-                read_from_vertex_attribute_pointer(m_client_tex_coord_pointer[t], i, tex_coords);
-                gl_multi_tex_coord(GL_TEXTURE0 + t, tex_coords[0], tex_coords[1], tex_coords[2], tex_coords[3]);
-            }
-        }
+    // Without a vertex array, no vertices are specified at all
+    if (!m_client_side_vertex_array_enabled || m_index_list.is_empty())
+        return;
+
+    // Every vertex in the range of used indices is read and transformed only once, however many primitives share it.
+    // If that range is mostly unused, the vertices are read for each index instead.
+    auto min_index = NumericLimits<u32>::max();
+    auto max_index = NumericLimits<u32>::min();
+    for (auto i : m_index_list) {
+        min_index = min(min_index, i);
+        max_index = max(max_index, i);
+    }
+    RETURN_WITH_ERROR_IF(max_index > static_cast<u32>(NumericLimits<GLint>::max()), GL_INVALID_VALUE);
+
+    sync_device_config();
+
+    size_t vertex_count = max_index - min_index + 1;
+    if (vertex_count > m_index_list.size() * 2) {
+        RETURN_WITH_ERROR_IF(m_vertex_list.try_ensure_capacity(m_index_list.size()).is_error(), GL_OUT_OF_MEMORY);
+        for (auto i : m_index_list)
+            m_vertex_list.unchecked_append(read_vertex_from_client_arrays(static_cast<int>(i)));
+        m_rasterizer->draw_primitives(to_primitive_type(mode), model_view_matrix(), projection_matrix(), m_vertex_list);
+        m_vertex_list.clear_with_capacity();
+        return;
+    }
 
-        if (m_client_side_normal_array_enabled) {
-            float normal[3];
-            read_from_vertex_attribute_pointer(m_client_normal_pointer, i, normal);
-            gl_normal(normal[0], normal[1], normal[2]);
-        }
+    RETURN_WITH_ERROR_IF(m_vertex_list.try_ensure_capacity(vertex_count).is_error(), GL_OUT_OF_MEMORY);
+    for (auto i = min_index; i <= max_index; i++)
+        m_vertex_list.unchecked_append(read_vertex_from_client_arrays(static_cast<int>(i)));
+    for (auto& i : m_index_list)
+        i -= min_index;
 
-        if (m_client_side_vertex_array_enabled) {
-            float vertex[4] { 0.f, 0.f, 0.f, 1.f };
-            read_from_vertex_attribute_pointer(m_client_vertex_pointer, i, vertex);
-            gl_vertex(vertex[0], vertex[1], vertex[2], vertex[3]);
-        }
-    }
-    gl_end();
+    m_rasterizer->draw_indexed_primitives(to_primitive_type(mode), model_view_matrix(), projection_matrix(), m_vertex_list, m_index_list);
+    m_vertex_list.clear_with_capacity();
 }
 
 void GLContext::gl_normal(GLfloat nx, GLfloat ny, GLfloat nz)
@@ -40,6 +40,8 @@ public:
     virtual DeviceInfo info() const = 0;
 
     virtual void draw_primitives(PrimitiveType, FloatMatrix4x4 const& model_view_transform, FloatMatrix4x4 const& projection_transform, Vector<Vertex>& vertices) = 0;
+    // Draws the vertices in the order given by the indices. Devices can transform each vertex only once, no matter how many primitives share it.
+    virtual void draw_indexed_primitives(PrimitiveType, FloatMatrix4x4 const& model_view_transform, FloatMatrix4x4 const& projection_transform, Vector<Vertex>& vertices, Vector<u32> const& indices) = 0;
     virtual void resize(Gfx::IntSize min_size) = 0;
     virtual void clear_color(FloatVector4 const&) = 0;
     virtual void clear_depth(DepthType) = 0;
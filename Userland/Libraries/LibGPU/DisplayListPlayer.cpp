@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGPU/DisplayListPlayer.h>
+#include <LibGfx/Painter.h>
+
+namespace GPU {
+
+static ImageDataLayout bitmap_data_layout(Gfx::Bitmap const& bitmap)
+{
+    auto width = static_cast<u32>(bitmap.physical_width());
+    auto height = static_cast<u32>(bitmap.physical_height());
+    return {
+        .pixel_type = {
+            .format = PixelFormat::BGRA,
+            .bits = PixelComponentBits::B8_8_8_8,
+            .data_type = PixelDataType::UnsignedInt,
+            .components_order = ComponentsOrder::Reversed,
+        },
+        .packing = {
+            .row_stride = static_cast<u32>(bitmap.pitch() / sizeof(Gfx::ARGB32)),
+        },
+        .dimensions = {
+            .width = width,
+            .height = height,
+            .depth = 1,
+        },
+        .selection = {
+            .width = width,
+            .height = height,
+            .depth = 1,
+        },
+    };
+}
+
+static FloatVector4 to_vector(Gfx::Color color)
+{
+    return { color.red() / 255.0f, color.green() / 255.0f, color.blue() / 255.0f, color.alpha() / 255.0f };
+}
+
+DisplayListPlayer::DisplayListPlayer(Device& device, Gfx::IntSize size)
+    : m_device(device)
+    , m_saved_options(device.options())
+    , m_size(size)
+    // Note: The color buffer's rows are stored bottom-up, so this turns the y axis upside down as well.
+    , m_projection(
+          2.0f / size.width(), 0, 0, -1,
+          0, -2.0f / size.height(), 0, 1,
+          0, 0, 1, 0,
+          0, 0, 0, 1)
+{
+    m_state_stack.append({ {}, { {}, size } });
+
+    auto options = m_saved_options;
+    options.viewport = { {}, size };
+    // Note: All vertices of a quad have the same color, so there is nothing to interpolate.
+    options.shade_smooth = false;
+    options.enable_depth_test = false;
+    options.enable_stencil_test = false;
+    options.enable_alpha_test = false;
+    options.enable_culling = false;
+    options.lighting_enabled = false;
+    options.fog_enabled = false;
+    options.polygon_mode = PolygonMode::Fill;
+    options.color_mask = 0xffffffff;
+    options.enable_color_write = true;
+    options.enable_blending = false;
+    options.blend_source_factor = BlendFactor::SrcAlpha;
+    options.blend_destination_factor = BlendFactor::OneMinusSrcAlpha;
+    options.scissor_enabled = true;
+    m_device.set_options(options);
+    apply_clip_rect();
+
+    for (TextureUnitIndex i = 1; i < NUM_TEXTURE_UNITS; ++i)
+        m_device.set_texture_unit_configuration(i, {});
+    unbind_bitmap();
+}
+
+DisplayListPlayer::~DisplayListPlayer()
+{
+    unbind_bitmap();
+    m_device.set_options(m_saved_options);
+}
+
+void DisplayListPlayer::save()
+{
+    m_state_stack.append(state());
+}
+
+void DisplayListPlayer::restore()
+{
+    VERIFY(m_state_stack.size() > 1);
+    m_state_stack.take_last();
+    apply_clip_rect();
+}
+
+void DisplayListPlayer::translate(Gfx::IntPoint delta)
+{
+    state().translation.translate_by(delta);
+}
+
+void DisplayListPlayer::add_clip_rect(Gfx::IntRect const& rect)
+{
+    state().clip_rect.intersect(rect.translated(state().translation));
+    apply_clip_rect();
+}
+
+void DisplayListPlayer::apply_clip_rect()
+{
+    auto& clip_rect = state().clip_rect;
+    auto options = m_device.options();
+    options.scissor_box = { clip_rect.x(), m_size.height() - clip_rect.y() - clip_rect.height(), clip_rect.width(), clip_rect.height() };
+    m_device.set_options(options);
+}
+
+void DisplayListPlayer::set_blending_enabled(bool enabled)
+{
+    if (m_blending_enabled == enabled)
+        return;
+    auto options = m_device.options();
+    options.enable_blending = enabled;
+    m_device.set_options(options);
+    m_blending_enabled = enabled;
+}
+
+void DisplayListPlayer::fill_rect(Gfx::DisplayList::FillRect const& command)
+{
+    unbind_bitmap();
+    set_blending_enabled(command.color.alpha() < 255);
+    draw_quad(command.rect.translated(state().translation).to_type<float>(), to_vector(command.color));
+}
+
+void DisplayListPlayer::draw_bitmap(Gfx::DisplayList::DrawBitmap const& command)
+{
+    auto format = command.bitmap->format();
+    if (format != Gfx::BitmapFormat::BGRx8888 && format != Gfx::BitmapFormat::BGRA8888) {
+        draw_with_painter(command.dst_rect, [&](auto& painter) {
+            painter.draw_scaled_bitmap(command.dst_rect, command.bitmap, command.src_rect, command.opacity, command.scaling_mode);
+        });
+        return;
+    }
+
+    bool smooth = command.dst_rect.size() != command.src_rect.size()
+        && (command.scaling_mode == Gfx::Painter::ScalingMode::BilinearBlend || command.scaling_mode == Gfx::Painter::ScalingMode::SmoothPixels);
+    bind_bitmap(command.bitmap, smooth, true);
+    set_blending_enabled(command.bitmap->has_alpha_channel() || command.opacity < 1.0f);
+    auto texture_rect = (command.src_rect * command.bitmap->scale()).to_type<float>();
+    draw_quad(command.dst_rect.translated(state().translation).to_type<float>(), { 1, 1, 1, command.opacity }, texture_rect);
+}
+
+void DisplayListPlayer::draw_glyph_run(Gfx::DisplayList::DrawGlyphRun const& command)
+{
+    auto& font = *command.font;
+    auto glyph_height = max(font.pixel_size(), static_cast<float>(font.glyph_height()));
+    Gfx::FloatRect bounds;
+    for (auto& glyph : command.glyphs)
+        bounds = bounds.united({ glyph.position, { font.glyph_or_emoji_width(glyph.code_point), glyph_height } });
+
+    // Note: Glyphs may stick out of their boxes a little, by their bearings and antialiasing.
+    draw_with_painter(bounds.to_rounded<int>().inflated(4, 4), [&](auto& painter) {
+        for (auto& glyph : command.glyphs)
+            painter.draw_glyph_or_emoji(glyph.position, glyph.code_point, font, command.color);
+    });
+}
+
+void DisplayListPlayer::fill_path(Gfx::DisplayList::FillPath const& command)
+{
+    draw_with_painter(command.path.bounding_box().to_rounded<int>().inflated(2, 2), [&](auto& painter) {
+        painter.fill_path(command.path, command.color, command.winding_rule);
+    });
+}
+
+void DisplayListPlayer::flush()
+{
+    unbind_bitmap();
+    m_images.clear();
+}
+
+void DisplayListPlayer::draw_with_painter(Gfx::IntRect const& bounds, Function<void(Gfx::Painter&)> paint)
+{
+    auto clipped_bounds = bounds.translated(state().translation).intersected(state().clip_rect);
+    if (clipped_bounds.is_empty())
+        return;
+
+    auto bitmap_or_error = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, clipped_bounds.size());
+    if (bitmap_or_error.is_error()) {
+        dbgln("DisplayListPlayer: Could not allocate a {} bitmap to paint into", clipped_bounds.size());
+        return;
+    }
+    auto bitmap = bitmap_or_error.release_value();
+    bitmap->fill(Gfx::Color::Transparent);
+
+    Gfx::Painter painter(*bitmap);
+    painter.translate(state().translation - clipped_bounds.location());
+    paint(painter);
+
+    bind_bitmap(*bitmap, false, false);
+    set_blending_enabled(true);
+    draw_quad(clipped_bounds.to_type<float>(), { 1, 1, 1, 1 }, bitmap->rect().to_type<float>());
+    // Note: The bitmap is about to go away, so nobody must find its image again.
+    unbind_bitmap();
+}
+
+void DisplayListPlayer::bind_bitmap(Gfx::Bitmap const& bitmap, bool smooth, bool may_be_drawn_again)
+{
+    RefPtr<Image> image;
+    if (may_be_drawn_again) {
+        if (auto it = m_images.find(&bitmap); it != m_images.end())
+            image = it->value;
+    }
+    if (!image) {
+        image = m_device.create_image(PixelFormat::RGBA, bitmap.physical_width(), bitmap.physical_height(), 1, 1);
+        image->write_texels(0, { 0, 0, 0 }, bitmap.scanline_u8(0), bitmap_data_layout(bitmap));
+        if (may_be_drawn_again)
+            m_images.set(&bitmap, *image);
+    }
+
+    SamplerConfig config;
+    config.bound_image = image;
+    config.mipmap_filter = MipMapFilter::None;
+    config.texture_mag_filter = smooth ? TextureFilter::Linear : TextureFilter::Nearest;
+    config.texture_min_filter = smooth ? TextureFilter::Linear : TextureFilter::Nearest;
+    config.texture_wrap_u = TextureWrapMode::ClampToEdge;
+    config.texture_wrap_v = TextureWrapMode::ClampToEdge;
+    auto& environment = config.fixed_function_texture_environment;
+    if (bitmap.has_alpha_channel()) {
+        environment.env_mode = TextureEnvMode::Modulate;
+    } else {
+        // Note: The alpha bytes of BGRx bitmaps are undefined, so only the vertex color's alpha is used.
+        environment.env_mode = TextureEnvMode::Combine;
+        environment.rgb_combinator = TextureCombinator::Modulate;
+        environment.rgb_source = { TextureSource::Texture, TextureSource::PrimaryColor, TextureSource::Constant };
+        environment.alpha_combinator = TextureCombinator::Replace;
+        environment.alpha_source = { TextureSource::PrimaryColor, TextureSource::Previous, TextureSource::Constant };
+    }
+    m_device.set_sampler_config(0, config);
+
+    if (!m_texturing_enabled) {
+        TextureUnitConfiguration texture_unit;
+        texture_unit.enabled = true;
+        texture_unit.tex_coord_generation_enabled = 0;
+        m_device.set_texture_unit_configuration(0, texture_unit);
+        m_texturing_enabled = true;
+    }
+    m_bound_image_size = bitmap.physical_size();
+}
+
+void DisplayListPlayer::unbind_bitmap()
+{
+    if (!m_texturing_enabled)
+        return;
+    TextureUnitConfiguration texture_unit;
+    texture_unit.enabled = false;
+    texture_unit.tex_coord_generation_enabled = 0;
+    m_device.set_texture_unit_configuration(0, texture_unit);
+    m_device.set_sampler_config(0, {});
+    m_texturing_enabled = false;
+}
+
+void DisplayListPlayer::draw_quad(Gfx::FloatRect const& rect, FloatVector4 const& color, Optional<Gfx::FloatRect> texture_rect)
+{
+    if (rect.is_empty())
+        return;
+
+    m_vertices.clear_with_capacity();
+    auto add_vertex = [&](float x, float y, float s, float t) {
+        Vertex vertex {};
+        vertex.position = { x, y, 0, 1 };
+        vertex.color = color;
+        vertex.tex_coords[0] = { s, t, 0, 1 };
+        m_vertices.append(vertex);
+    };
+
+    float left_s = 0, top_t = 0, right_s = 0, bottom_t = 0;
+    if (texture_rect.has_value()) {
+        VERIFY(m_texturing_enabled);
+        left_s = texture_rect->x() / m_bound_image_size.width();
+        right_s = (texture_rect->x() + texture_rect->width()) / m_bound_image_size.width();
+        top_t = texture_rect->y() / m_bound_image_size.height();
+        bottom_t = (texture_rect->y() + texture_rect->height()) / m_bound_image_size.height();
+    }
+
+    auto right = rect.x() + rect.width();
+    auto bottom = rect.y() + rect.height();
+    add_vertex(rect.x(), rect.y(), left_s, top_t);
+    add_vertex(rect.x(), bottom, left_s, bottom_t);
+    add_vertex(right, bottom, right_s, bottom_t);
+    add_vertex(right, rect.y(), right_s, top_t);
+
+    m_device.draw_primitives(PrimitiveType::Quads, FloatMatrix4x4::identity(), m_projection, m_vertices);
+}
+
+}
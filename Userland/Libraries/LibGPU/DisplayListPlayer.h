@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibGPU/Device.h>
+#include <LibGfx/DisplayList.h>
+#include <LibGfx/Matrix4x4.h>
+
+namespace GPU {
+
+// Plays a Gfx::DisplayList on a GPU device, into its color buffer. Rects and bitmaps are drawn as textured quads, while
+// glyph runs and paths are rasterized on the CPU first and then drawn like bitmaps.
+// Note: The device blends color channels like a Painter does, but not alpha, so the color buffer should be treated as
+//       opaque. Read the result back with Device::blit_from_color_buffer().
+class DisplayListPlayer final : public Gfx::DisplayListPlayer {
+public:
+    // `size` is the size of the device's color buffer. The device's options are restored once the player goes away.
+    DisplayListPlayer(Device&, Gfx::IntSize size);
+    virtual ~DisplayListPlayer() override;
+
+    virtual void save() override;
+    virtual void restore() override;
+    virtual void translate(Gfx::IntPoint delta) override;
+    virtual void add_clip_rect(Gfx::IntRect const&) override;
+
+    virtual void fill_rect(Gfx::DisplayList::FillRect const&) override;
+    virtual void draw_bitmap(Gfx::DisplayList::DrawBitmap const&) override;
+    virtual void draw_glyph_run(Gfx::DisplayList::DrawGlyphRun const&) override;
+    virtual void fill_path(Gfx::DisplayList::FillPath const&) override;
+
+    virtual void flush() override;
+
+private:
+    struct State {
+        Gfx::IntPoint translation;
+        Gfx::IntRect clip_rect;
+    };
+
+    State& state() { return m_state_stack.last(); }
+    void apply_clip_rect();
+    // Note: Opaque things are simply copied, which is cheaper and doesn't lose any precision.
+    void set_blending_enabled(bool);
+
+    // Draws `rect`, which is already translated, in `color`. If a bitmap is bound, `texture_rect` of it (in physical
+    // pixels) is multiplied with `color`.
+    void draw_quad(Gfx::FloatRect const& rect, FloatVector4 const& color, Optional<Gfx::FloatRect> texture_rect = {});
+    void bind_bitmap(Gfx::Bitmap const&, bool smooth, bool may_be_drawn_again);
+    void unbind_bitmap();
+
+    // Rasterizes what `paint` paints into `bounds` on the CPU, and draws the result.
+    void draw_with_painter(Gfx::IntRect const& bounds, Function<void(Gfx::Painter&)> paint);
+
+    Device& m_device;
+    RasterizerOptions m_saved_options;
+    Gfx::IntSize m_size;
+    FloatMatrix4x4 m_projection;
+    Vector<State> m_state_stack;
+    Vector<Vertex> m_vertices;
+
+    // Bitmaps are uploaded only once per replay, no matter how often they're drawn.
+    HashMap<Gfx::Bitmap const*, NonnullRefPtr<Image>> m_images;
+    bool m_blending_enabled { false };
+    bool m_texturing_enabled { false };
+    Gfx::IntSize m_bound_image_size;
+};
+
+}
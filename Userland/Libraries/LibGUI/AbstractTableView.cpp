@@ -94,6 +94,13 @@ void AbstractTableView::update_column_sizes()
     int column_count = model.column_count();
     int row_count = model.row_count();
 
+    // Note: Only the rows that are on screen are measured, so that big models don't have all of their data looked up
+    //       on every update. Columns grow to fit the other rows as they are scrolled into view.
+    auto visible_rect = visible_content_rect();
+    int y_offset = column_header().is_visible() ? column_header().height() : 0;
+    int first_visible_row = clamp((visible_rect.top() - y_offset) / row_height(), 0, row_count);
+    int end_visible_row = clamp((visible_rect.bottom() - y_offset) / row_height() + 1, first_visible_row, row_count);
+
     for (int column = 0; column < column_count; ++column) {
         if (!column_header().is_section_visible(column))
             continue;
@@ -101,7 +108,7 @@ void AbstractTableView::update_column_sizes()
         if (column == m_key_column && model.is_column_sortable(column))
             header_width += HeaderView::sorting_arrow_width + HeaderView::sorting_arrow_offset;
         int column_width = header_width;
-        for (int row = 0; row < row_count; ++row) {
+        for (int row = first_visible_row; row < end_visible_row; ++row) {
             auto cell_data = model.index(row, column).data();
             int cell_width = 0;
             if (cell_data.is_icon()) {
@@ -360,6 +367,7 @@ void AbstractTableView::model_did_update(unsigned flags)
 void AbstractTableView::resize_event(ResizeEvent& event)
 {
     AbstractView::resize_event(event);
+    update_column_sizes();
     layout_headers();
 }
 
@@ -398,6 +406,7 @@ bool AbstractTableView::column_headers_visible() const
 void AbstractTableView::did_scroll()
 {
     AbstractView::did_scroll();
+    update_column_sizes();
     layout_headers();
 }
 
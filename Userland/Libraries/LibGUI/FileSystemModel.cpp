@@ -39,18 +39,22 @@ ModelIndex FileSystemModel::Node::index(int column) const
     VERIFY_NOT_REACHED();
 }
 
-bool FileSystemModel::Node::fetch_data(DeprecatedString const& full_path, bool is_root)
+bool FileSystemModel::Node::fetch_data(DeprecatedString const& full_path, bool is_root, Optional<struct stat> const& known_stat)
 {
     struct stat st;
-    int rc;
-    if (is_root)
-        rc = stat(full_path.characters(), &st);
-    else
-        rc = lstat(full_path.characters(), &st);
-    if (rc < 0) {
-        m_error = errno;
-        perror("stat/lstat");
-        return false;
+    if (known_stat.has_value() && !is_root) {
+        st = *known_stat;
+    } else {
+        int rc;
+        if (is_root)
+            rc = stat(full_path.characters(), &st);
+        else
+            rc = lstat(full_path.characters(), &st);
+        if (rc < 0) {
+            m_error = errno;
+            perror("stat/lstat");
+            return false;
+        }
     }
 
     size = st.st_size;
@@ -97,24 +101,30 @@ void FileSystemModel::Node::traverse_if_needed()
     total_size = 0;
 
     auto full_path = this->full_path();
-    Core::DirIterator di(full_path, m_model.should_show_dotfiles() ? Core::DirIterator::SkipParentAndBaseDir : Core::DirIterator::SkipDots);
+    auto flags = m_model.should_show_dotfiles() ? Core::DirIterator::SkipParentAndBaseDir : Core::DirIterator::SkipDots;
+    Core::DirIterator di(full_path, static_cast<Core::DirIterator::Flags>(flags | Core::DirIterator::StatEntries));
     if (di.has_error()) {
         m_error = di.error();
         warnln("DirIterator: {}", di.error_string());
         return;
     }
 
-    Vector<DeprecatedString> child_names;
+    struct ChildEntry {
+        DeprecatedString name;
+        Optional<struct stat> stat;
+    };
+    Vector<ChildEntry> child_entries;
     while (di.has_next()) {
-        child_names.append(di.next_path());
+        auto name = di.next_path();
+        child_entries.append({ move(name), di.current_stat() });
     }
-    quick_sort(child_names);
+    quick_sort(child_entries, [](auto const& a, auto const& b) { return a.name < b.name; });
 
     NonnullOwnPtrVector<Node> directory_children;
     NonnullOwnPtrVector<Node> file_children;
 
-    for (auto& child_name : child_names) {
-        auto maybe_child = create_child(child_name);
+    for (auto& [child_name, child_stat] : child_entries) {
+        auto maybe_child = create_child(child_name, child_stat);
         if (!maybe_child)
             continue;
 
@@ -156,12 +166,12 @@ void FileSystemModel::Node::traverse_if_needed()
     }
 }
 
-OwnPtr<FileSystemModel::Node> FileSystemModel::Node::create_child(DeprecatedString const& child_name)
+OwnPtr<FileSystemModel::Node> FileSystemModel::Node::create_child(DeprecatedString const& child_name, Optional<struct stat> const& known_stat)
 {
     DeprecatedString child_path = LexicalPath::join(full_path(), child_name).string();
     auto child = adopt_own(*new Node(m_model));
 
-    bool ok = child->fetch_data(child_path, false);
+    bool ok = child->fetch_data(child_path, false, known_stat);
     if (!ok)
         return {};
 
@@ -94,9 +94,10 @@ public:
         ModelIndex index(int column) const;
         void traverse_if_needed();
         void reify_if_needed();
-        bool fetch_data(DeprecatedString const& full_path, bool is_root);
+        // Note: If the metadata is already known (e.g. from listing the parent directory), it doesn't have to be stat'ed again.
+        bool fetch_data(DeprecatedString const& full_path, bool is_root, Optional<struct stat> const& known_stat = {});
 
-        OwnPtr<Node> create_child(DeprecatedString const& child_name);
+        OwnPtr<Node> create_child(DeprecatedString const& child_name, Optional<struct stat> const& known_stat = {});
     };
 
     static NonnullRefPtr<FileSystemModel> create(DeprecatedString root_path = "/", Mode mode = Mode::FilesAndDirectories)
@@ -9,6 +9,14 @@
 #include <LibGUI/Icon.h>
 #include <LibGfx/Bitmap.h>
 
+#ifdef AK_OS_SERENITY
+#    include <LibGUI/Application.h>
+#    include <LibGUI/ConnectionToWindowServer.h>
+#    include <LibGfx/ShareableBitmap.h>
+#    include <stdio.h>
+#    include <sys/mman.h>
+#endif
+
 namespace GUI {
 
 Icon::Icon()
@@ -78,14 +86,36 @@ Icon Icon::default_icon(StringView name)
     return MUST(try_create_default_icon(name));
 }
 
+static RefPtr<Gfx::Bitmap> load_default_icon_bitmap(DeprecatedString const& path)
+{
+#ifdef AK_OS_SERENITY
+    // Note: Every application uses the same icons, so WindowServer decodes each of them once and hands out its copy.
+    //       Processes without a connection to it decode their own.
+    if (Application::the()) {
+        static HashMap<DeprecatedString, RefPtr<Gfx::Bitmap>> s_shared_bitmaps;
+        return s_shared_bitmaps.ensure(path, [&]() -> RefPtr<Gfx::Bitmap> {
+            auto shared_bitmap = ConnectionToWindowServer::the().get_shared_bitmap(path, 1);
+            auto* bitmap = shared_bitmap.bitmap();
+            if (!bitmap)
+                return nullptr;
+            // Note: The pixels are seen by every other application, so make sure we never write to them.
+            if (mprotect(bitmap->scanline_u8(0), bitmap->size_in_bytes(), PROT_READ) < 0)
+                perror("mprotect");
+            return bitmap;
+        });
+    }
+#endif
+
+    auto bitmap_or_error = Gfx::Bitmap::load_from_file(path);
+    if (bitmap_or_error.is_error())
+        return nullptr;
+    return bitmap_or_error.release_value();
+}
+
 ErrorOr<Icon> Icon::try_create_default_icon(StringView name)
 {
-    RefPtr<Gfx::Bitmap> bitmap16;
-    RefPtr<Gfx::Bitmap> bitmap32;
-    if (auto bitmap_or_error = Gfx::Bitmap::load_from_file(DeprecatedString::formatted("/res/icons/16x16/{}.png", name)); !bitmap_or_error.is_error())
-        bitmap16 = bitmap_or_error.release_value();
-    if (auto bitmap_or_error = Gfx::Bitmap::load_from_file(DeprecatedString::formatted("/res/icons/32x32/{}.png", name)); !bitmap_or_error.is_error())
-        bitmap32 = bitmap_or_error.release_value();
+    auto bitmap16 = load_default_icon_bitmap(DeprecatedString::formatted("/res/icons/16x16/{}.png", name));
+    auto bitmap32 = load_default_icon_bitmap(DeprecatedString::formatted("/res/icons/32x32/{}.png", name));
 
     if (!bitmap16 && !bitmap32) {
         dbgln("Default icon not found: {}", name);
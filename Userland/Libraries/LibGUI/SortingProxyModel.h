@@ -38,7 +38,9 @@ public:
 
     virtual bool is_column_sortable(int column_index) const override;
 
-    virtual bool less_than(ModelIndex const&, ModelIndex const&) const;
+    // Sorting looks up the key of every row once, and then only compares the keys.
+    virtual Variant sort_key(ModelIndex const&) const;
+    virtual bool less_than(Variant const&, Variant const&) const;
 
     ModelIndex map_to_source(ModelIndex const&) const;
     ModelIndex map_to_proxy(ModelIndex const&) const;
@@ -166,16 +166,22 @@ TextDocumentLine::TextDocumentLine(TextDocument& document, StringView text)
     set_text(document, text);
 }
 
+void TextDocumentLine::did_change(TextDocument& document)
+{
+    m_revision = document.next_line_revision({});
+    document.update_views({});
+}
+
 void TextDocumentLine::clear(TextDocument& document)
 {
     m_text.clear();
-    document.update_views({});
+    did_change(document);
 }
 
 void TextDocumentLine::set_text(TextDocument& document, Vector<u32> const text)
 {
     m_text = move(text);
-    document.update_views({});
+    did_change(document);
 }
 
 bool TextDocumentLine::set_text(TextDocument& document, StringView text)
@@ -187,11 +193,12 @@ bool TextDocumentLine::set_text(TextDocument& document, StringView text)
     m_text.clear();
     Utf8View utf8_view(text);
     if (!utf8_view.validate()) {
+        did_change(document);
         return false;
     }
     for (auto code_point : utf8_view)
         m_text.append(code_point);
-    document.update_views({});
+    did_change(document);
     return true;
 }
 
@@ -200,7 +207,7 @@ void TextDocumentLine::append(TextDocument& document, u32 const* code_points, si
     if (length == 0)
         return;
     m_text.append(code_points, length);
-    document.update_views({});
+    did_change(document);
 }
 
 void TextDocumentLine::append(TextDocument& document, u32 code_point)
@@ -220,7 +227,7 @@ void TextDocumentLine::insert(TextDocument& document, size_t index, u32 code_poi
     } else {
         m_text.insert(index, code_point);
     }
-    document.update_views({});
+    did_change(document);
 }
 
 void TextDocumentLine::remove(TextDocument& document, size_t index)
@@ -230,7 +237,7 @@ void TextDocumentLine::remove(TextDocument& document, size_t index)
     } else {
         m_text.remove(index);
     }
-    document.update_views({});
+    did_change(document);
 }
 
 void TextDocumentLine::remove_range(TextDocument& document, size_t start, size_t length)
@@ -244,7 +251,7 @@ void TextDocumentLine::remove_range(TextDocument& document, size_t start, size_t
     for (size_t i = (start + length); i < m_text.size(); ++i)
         new_data.append(m_text[i]);
     m_text = move(new_data);
-    document.update_views({});
+    did_change(document);
 }
 
 void TextDocumentLine::keep_range(TextDocument& document, size_t start_index, size_t length)
@@ -257,13 +264,13 @@ void TextDocumentLine::keep_range(TextDocument& document, size_t start_index, si
         new_data.append(m_text[i]);
 
     m_text = move(new_data);
-    document.update_views({});
+    did_change(document);
 }
 
 void TextDocumentLine::truncate(TextDocument& document, size_t length)
 {
     m_text.resize(length);
-    document.update_views({});
+    did_change(document);
 }
 
 void TextDocument::append_line(NonnullOwnPtr<TextDocumentLine> line)
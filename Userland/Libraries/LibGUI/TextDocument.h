@@ -89,6 +89,7 @@ public:
     void unregister_client(Client&);
 
     void update_views(Badge<TextDocumentLine>);
+    u64 next_line_revision(Badge<TextDocumentLine>) { return ++m_last_line_revision; }
 
     DeprecatedString text() const;
     DeprecatedString text_in_range(TextRange const&) const;
@@ -148,6 +149,7 @@ private:
 
     HashTable<Client*> m_clients;
     bool m_client_notifications_enabled { true };
+    u64 m_last_line_revision { 0 };
 
     UndoStack m_undo_stack;
 
@@ -188,9 +190,15 @@ public:
     bool is_empty() const { return length() == 0; }
     size_t leading_spaces() const;
 
+    // Changes whenever the text of the line does, and is never the same for two lines of the same document.
+    u64 revision() const { return m_revision; }
+
 private:
+    void did_change(TextDocument&);
+
     // NOTE: This vector is null terminated.
     Vector<u32> m_text;
+    u64 m_revision { 0 };
 };
 
 class TextDocumentUndoCommand : public Command {
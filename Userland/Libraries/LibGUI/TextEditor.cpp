@@ -1905,9 +1905,23 @@ void TextEditor::recompute_all_visual_lines()
 
     m_reflow_requested = false;
 
+    VisualLineLayout layout {
+        .font = &font(),
+        .available_width = visible_text_rect_in_inner_coordinates().width(),
+        .line_height = line_height(),
+        .horizontal_content_padding = m_horizontal_content_padding,
+        .wrapping_mode = m_wrapping_mode,
+        .substitution_code_point = m_substitution_code_point,
+    };
+    bool layout_changed = layout != m_visual_line_layout;
+    m_visual_line_layout = layout;
+
     int y_offset = 0;
     for (size_t line_index = 0; line_index < line_count(); ++line_index) {
-        recompute_visual_lines(line_index);
+        // NOTE: Measuring every glyph of a large document again after each keystroke is what makes editing it slow,
+        //       so lines whose text hasn't changed keep their visual lines.
+        if (layout_changed || m_line_visual_data[line_index].line_revision != line(line_index).revision())
+            recompute_visual_lines(line_index);
         m_line_visual_data[line_index].visual_rect.set_y(y_offset);
         y_offset += m_line_visual_data[line_index].visual_rect.height();
     }
@@ -1944,6 +1958,7 @@ void TextEditor::recompute_visual_lines(size_t line_index)
     auto& visual_data = m_line_visual_data[line_index];
 
     visual_data.visual_line_breaks.clear_with_capacity();
+    visual_data.line_revision = line.revision();
 
     int available_width = visible_text_rect_in_inner_coordinates().width();
 
@@ -422,9 +422,25 @@ private:
     struct LineVisualData {
         Vector<size_t, 1> visual_line_breaks;
         Gfx::IntRect visual_rect;
+        // The revision of the document line that the visual lines were computed for.
+        u64 line_revision { 0 };
+    };
+
+    // Everything besides the text itself that goes into laying out visual lines. When any of it changes, all lines
+    // have to be laid out again; otherwise, only the lines whose text changed have to be.
+    struct VisualLineLayout {
+        Gfx::Font const* font { nullptr };
+        int available_width { 0 };
+        int line_height { 0 };
+        int horizontal_content_padding { 0 };
+        WrappingMode wrapping_mode { WrappingMode::NoWrap };
+        Optional<u32> substitution_code_point;
+
+        bool operator==(VisualLineLayout const&) const = default;
     };
 
     NonnullOwnPtrVector<LineVisualData> m_line_visual_data;
+    VisualLineLayout m_visual_line_layout;
 
     OwnPtr<Syntax::Highlighter> m_highlighter;
     OwnPtr<AutocompleteProvider> m_autocomplete_provider;
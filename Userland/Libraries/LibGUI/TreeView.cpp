@@ -710,6 +710,10 @@ void TreeView::update_column_sizes()
     int column_count = model.column_count();
     int tree_column = model.tree_column();
 
+    // Note: Like in AbstractTableView, only the rows that are on screen are measured, and columns grow to fit the
+    //       other rows as they are scrolled into view.
+    auto visible_content_rect = this->visible_content_rect();
+
     for (int column = 0; column < column_count; ++column) {
         if (column == tree_column)
             continue;
@@ -719,7 +723,9 @@ void TreeView::update_column_sizes()
         if (column == m_key_column && model.is_column_sortable(column))
             header_width += HeaderView::sorting_arrow_width + HeaderView::sorting_arrow_offset;
         int column_width = header_width;
-        traverse_in_paint_order([&](ModelIndex const& index, Gfx::IntRect const&, Gfx::IntRect const&, int) {
+        traverse_in_paint_order([&](ModelIndex const& index, Gfx::IntRect const& rect, Gfx::IntRect const&, int) {
+            if (!rect.intersects_vertically(visible_content_rect))
+                return IterationDecision::Continue;
             auto cell_data = model.index(index.row(), column, index.parent()).data();
             int cell_width = 0;
             if (cell_data.is_icon()) {
@@ -740,7 +746,9 @@ void TreeView::update_column_sizes()
     if (tree_column == m_key_column && model.is_column_sortable(tree_column))
         tree_column_header_width += HeaderView::sorting_arrow_width + HeaderView::sorting_arrow_offset;
     int tree_column_width = tree_column_header_width;
-    traverse_in_paint_order([&](ModelIndex const& index, Gfx::IntRect const&, Gfx::IntRect const&, int indent_level) {
+    traverse_in_paint_order([&](ModelIndex const& index, Gfx::IntRect const& rect, Gfx::IntRect const&, int indent_level) {
+        if (!rect.intersects_vertically(visible_content_rect))
+            return IterationDecision::Continue;
         auto cell_data = model.index(index.row(), tree_column, index.parent()).data();
         int cell_width = 0;
         if (cell_data.is_valid()) {
@@ -751,7 +759,7 @@ void TreeView::update_column_sizes()
         return IterationDecision::Continue;
     });
 
-    set_column_width(tree_column, tree_column_width);
+    set_column_width(tree_column, max(this->column_width(tree_column), tree_column_width));
 }
 
 int TreeView::tree_column_x_offset() const
@@ -10,11 +10,12 @@
 #    pragma GCC optimize("O3")
 #endif
 
-#include "FillPathImplementation.h"
 #include <AK/Function.h>
 #include <AK/NumericLimits.h>
 #include <LibGfx/AntiAliasingPainter.h>
+#include <LibGfx/Font/PathRasterizer.h>
 #include <LibGfx/Line.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace Gfx {
 
@@ -208,19 +209,96 @@ void AntiAliasingPainter::draw_line(FloatPoint actual_from, FloatPoint actual_to
     draw_anti_aliased_line<FixmeEnableHacksForBetterPathPainting::No>(actual_from, actual_to, color, thickness, style, alternate_color, line_length_mode);
 }
 
+// Paths are rasterized in bands of this many rows, so that the rasterizer needs little memory even for huge paths, and so
+// that the bands of a large path can be rasterized on several threads at once.
+static constexpr int path_band_height = 64;
+// Paths that cover fewer pixels than this are not worth the trouble of handing them to other threads.
+static constexpr int minimum_parallel_path_area = 256 * 256;
+
+// Calls `callback` with the coverage of the physical pixels that `path`, moved by `offset`, covers within the clip rect.
+// Note: If `allow_parallel` is set, `callback` is called from several threads at once, though never for the same row.
+static void rasterize_path(Painter& painter, Path const& path, FloatPoint offset, Painter::WindingRule winding_rule, bool allow_parallel, PathRasterizer::SpanCallback const& callback)
+{
+    auto const& split_lines = path.split_lines();
+    if (split_lines.is_empty())
+        return;
+
+    float const scale = painter.scale();
+    auto const physical_offset = offset + painter.translation().to_type<float>();
+    auto to_physical = [&](FloatPoint point) -> FloatPoint {
+        return { (point.x() + physical_offset.x()) * scale, (point.y() + physical_offset.y()) * scale };
+    };
+
+    auto bounding_box = path.bounding_box();
+    auto physical_bounding_box = FloatRect { to_physical(bounding_box.location()), { bounding_box.width() * scale, bounding_box.height() * scale } };
+    auto bounds = enclosing_int_rect(physical_bounding_box).inflated(2, 2).intersected(painter.clip_rect() * painter.scale());
+    if (bounds.is_empty())
+        return;
+
+    Vector<FloatLine> lines;
+    lines.ensure_capacity(split_lines.size());
+    for (auto& line : split_lines)
+        lines.unchecked_append({ to_physical(line.from), to_physical(line.to) });
+
+    auto rasterize_band = [&](int band) {
+        int band_top = bounds.y() + band * path_band_height;
+        IntRect band_rect { bounds.x(), band_top, bounds.width(), min(path_band_height, bounds.y() + bounds.height() - band_top) };
+        PathRasterizer rasterizer(band_rect);
+        float const top = band_rect.y();
+        float const bottom = band_rect.y() + band_rect.height();
+        for (auto& line : lines) {
+            if (max(line.a().y(), line.b().y()) <= top || min(line.a().y(), line.b().y()) >= bottom)
+                continue;
+            rasterizer.draw_line(line.a(), line.b());
+        }
+        rasterizer.for_each_covered_span(winding_rule, [&](int y, int x, Span<u8 const> coverage) {
+            callback(y, x, coverage);
+        });
+    };
+
+    int band_count = ceil_div(bounds.height(), path_band_height);
+    if (allow_parallel && band_count > 1 && bounds.width() * bounds.height() >= minimum_parallel_path_area) {
+        Threading::ThreadPool::the().parallel_for(band_count, 1, [&](size_t begin, size_t end) {
+            for (size_t band = begin; band < end; ++band)
+                rasterize_band(band);
+        });
+        return;
+    }
+    for (int band = 0; band < band_count; ++band)
+        rasterize_band(band);
+}
+
 // FIXME: In the fill_paths() m_transform.translation() throws away any other transforms
 // this currently does not matter -- but may in future.
 
 void AntiAliasingPainter::fill_path(Path const& path, Color color, Painter::WindingRule rule)
 {
-    Detail::fill_path<Detail::FillPathMode::AllowFloatingPoints>(
-        m_underlying_painter, path, [=](IntPoint) { return color; }, rule, m_transform.translation());
+    if (color.alpha() == 0)
+        return;
+    bool allow_parallel = m_use_thread_pool == UseThreadPool::Yes;
+    rasterize_path(m_underlying_painter, path, m_transform.translation(), rule, allow_parallel, [&](int y, int x, Span<u8 const> coverage) {
+        m_underlying_painter.blend_physical_coverage_span({ x, y }, coverage, color);
+    });
 }
 
 void AntiAliasingPainter::fill_path(Path const& path, PaintStyle const& paint_style, Painter::WindingRule rule)
 {
+    auto offset = m_transform.translation();
     paint_style.paint(enclosing_int_rect(path.bounding_box()), [&](PaintStyle::SamplerFunction sampler) {
-        Detail::fill_path<Detail::FillPathMode::AllowFloatingPoints>(m_underlying_painter, path, move(sampler), rule, m_transform.translation());
+        auto& painter = m_underlying_painter;
+        auto* target = painter.target();
+        int scale = painter.scale();
+        auto draw_origin = (path.bounding_box().top_left() + offset).to_type<int>() + painter.translation();
+        // Note: Samplers may keep state of their own, so they are only ever called from this thread.
+        rasterize_path(painter, path, offset, rule, false, [&](int y, int x, Span<u8 const> coverage) {
+            auto* dst = target->scanline(y) + x;
+            for (size_t i = 0; i < coverage.size(); ++i) {
+                if (!coverage[i])
+                    continue;
+                auto color = sampler(IntPoint(x + i, y) / scale - draw_origin);
+                dst[i] = Color::from_argb(dst[i]).blend(color.with_alpha(color.alpha() * coverage[i] / 255)).value();
+            }
+        });
     });
 }
 
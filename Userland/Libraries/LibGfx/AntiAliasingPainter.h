@@ -14,8 +14,15 @@ namespace Gfx {
 
 class AntiAliasingPainter {
 public:
-    explicit AntiAliasingPainter(Painter& painter)
+    // Large path fills can be spread over the shared thread pool. Only do this if the process is allowed to create threads.
+    enum class UseThreadPool {
+        No,
+        Yes,
+    };
+
+    explicit AntiAliasingPainter(Painter& painter, UseThreadPool use_thread_pool = UseThreadPool::No)
         : m_underlying_painter(painter)
+        , m_use_thread_pool(use_thread_pool)
     {
     }
 
@@ -106,6 +113,7 @@ private:
 
     Painter& m_underlying_painter;
     AffineTransform m_transform;
+    UseThreadPool m_use_thread_pool { UseThreadPool::No };
 };
 
 }
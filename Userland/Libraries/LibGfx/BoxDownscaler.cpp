@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibGfx/BoxDownscaler.h>
+
+namespace Gfx {
+
+ErrorOr<BoxDownscaler> BoxDownscaler::create(IntSize source_size, int factor, BitmapFormat format)
+{
+    VERIFY(factor >= 1);
+    VERIFY(format == BitmapFormat::BGRA8888 || format == BitmapFormat::BGRx8888);
+    IntSize size { ceil_div(source_size.width(), factor), ceil_div(source_size.height(), factor) };
+    auto bitmap = TRY(Bitmap::create(format, size));
+    BoxDownscaler downscaler { move(bitmap), source_size, factor };
+    TRY(downscaler.m_sums.try_resize(size.width() * 4));
+    return downscaler;
+}
+
+BoxDownscaler::BoxDownscaler(NonnullRefPtr<Bitmap> bitmap, IntSize source_size, int factor)
+    : m_bitmap(move(bitmap))
+    , m_source_size(source_size)
+    , m_factor(factor)
+    , m_has_alpha(m_bitmap->has_alpha_channel())
+{
+}
+
+ErrorOr<NonnullRefPtr<Bitmap>> BoxDownscaler::downscale(Bitmap const& bitmap, int factor)
+{
+    auto format = bitmap.has_alpha_channel() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888;
+    auto downscaler = TRY(create(bitmap.size(), factor, format));
+    for (int y = 0; y < bitmap.height(); ++y)
+        downscaler.add_row(y, bitmap.scanline(y));
+    return downscaler.bitmap();
+}
+
+void BoxDownscaler::add_row(int y, ARGB32 const* pixels)
+{
+    VERIFY(y >= 0 && y < m_source_size.height());
+    for (int x = 0; x < m_source_size.width(); ++x) {
+        auto pixel = pixels[x];
+        u32 alpha = m_has_alpha ? pixel >> 24 : 0xff;
+        auto* sums = &m_sums[(x / m_factor) * 4];
+        sums[0] += ((pixel >> 16) & 0xff) * alpha;
+        sums[1] += ((pixel >> 8) & 0xff) * alpha;
+        sums[2] += (pixel & 0xff) * alpha;
+        sums[3] += alpha;
+    }
+
+    if (y % m_factor == m_factor - 1)
+        emit_row(y / m_factor, m_factor);
+    else if (y == m_source_size.height() - 1)
+        emit_row(y / m_factor, y % m_factor + 1);
+}
+
+void BoxDownscaler::emit_row(int y, int source_rows)
+{
+    auto* row = m_bitmap->scanline(y);
+    for (int x = 0; x < m_bitmap->width(); ++x) {
+        auto* sums = &m_sums[x * 4];
+        u32 source_columns = min(m_factor, m_source_size.width() - x * m_factor);
+        u32 pixel_count = source_columns * source_rows;
+        u32 alpha_sum = sums[3];
+        if (alpha_sum == 0) {
+            row[x] = 0;
+        } else {
+            auto average = [&](u32 sum, u32 count) { return (sum + count / 2) / count; };
+            row[x] = (average(alpha_sum, pixel_count) << 24)
+                | (average(sums[0], alpha_sum) << 16)
+                | (average(sums[1], alpha_sum) << 8)
+                | average(sums[2], alpha_sum);
+        }
+        sums[0] = sums[1] = sums[2] = sums[3] = 0;
+    }
+}
+
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullRefPtr.h>
+#include <AK/Vector.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Size.h>
+
+namespace Gfx {
+
+// Shrinks an image by an integer factor while its rows are handed over one after another, so that decoders can
+// downscale images without ever holding them at their full size. Every square of `factor` by `factor` pixels is
+// averaged into one pixel of the result (the squares at the right and bottom edge may be cut off).
+class BoxDownscaler {
+public:
+    static ErrorOr<BoxDownscaler> create(IntSize source_size, int factor, BitmapFormat);
+
+    // Downscales a whole bitmap at once.
+    static ErrorOr<NonnullRefPtr<Bitmap>> downscale(Bitmap const&, int factor);
+
+    // Note: Rows have to be added from top to bottom, each of them exactly once.
+    void add_row(int y, ARGB32 const* pixels);
+
+    NonnullRefPtr<Bitmap> bitmap() const { return m_bitmap; }
+
+private:
+    BoxDownscaler(NonnullRefPtr<Bitmap>, IntSize source_size, int factor);
+
+    void emit_row(int y, int source_rows);
+
+    NonnullRefPtr<Bitmap> m_bitmap;
+    IntSize m_source_size;
+    int m_factor { 1 };
+    bool m_has_alpha { true };
+    // The sums of the red, green and blue channels, premultiplied with alpha, and of alpha, of each pixel of the row
+    // of squares that is being averaged.
+    Vector<u32> m_sums;
+};
+
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/CharacterTypes.h>
+#include <AK/Utf8View.h>
+#include <LibGfx/DisplayList.h>
+
+namespace Gfx {
+
+void DisplayList::fill_rect(IntRect const& rect, Color color)
+{
+    if (rect.is_empty() || color.alpha() == 0)
+        return;
+    m_commands.append(FillRect { rect, color });
+}
+
+void DisplayList::blit(IntPoint position, Bitmap const& bitmap, IntRect const& src_rect, float opacity)
+{
+    draw_scaled_bitmap({ position, src_rect.size() }, bitmap, src_rect, opacity, Painter::ScalingMode::None);
+}
+
+void DisplayList::draw_scaled_bitmap(IntRect const& dst_rect, Bitmap const& bitmap, IntRect const& src_rect, float opacity, Painter::ScalingMode scaling_mode)
+{
+    if (dst_rect.is_empty() || src_rect.is_empty() || opacity <= 0.0f)
+        return;
+    m_commands.append(DrawBitmap { dst_rect, bitmap, src_rect, opacity, scaling_mode });
+}
+
+void DisplayList::draw_glyph(FloatPoint position, u32 code_point, Font const& font, Color color)
+{
+    if (!m_commands.is_empty()) {
+        if (auto* run = m_commands.last().get_pointer<DrawGlyphRun>(); run && run->font.ptr() == &font && run->color == color) {
+            run->glyphs.append({ position, code_point });
+            return;
+        }
+    }
+    m_commands.append(DrawGlyphRun { font, color, { { position, code_point } } });
+}
+
+void DisplayList::draw_text_run(FloatPoint baseline_start, Utf8View const& string, Font const& font, Color color)
+{
+    // Note: This lays out the glyphs just like Painter::draw_text_run() does.
+    float x = baseline_start.x();
+    float y = baseline_start.y() - font.pixel_metrics().ascent;
+    float space_width = font.glyph_or_emoji_width(' ');
+
+    u32 last_code_point = 0;
+    for (auto code_point : string) {
+        if (is_ascii_space(code_point) || code_point == 0xa0) {
+            x += space_width + font.glyph_spacing();
+            last_code_point = code_point;
+            continue;
+        }
+
+        x += font.glyphs_horizontal_kerning(last_code_point, code_point);
+        draw_glyph({ x, y }, code_point, font, color);
+        x += font.glyph_or_emoji_width(code_point) + font.glyph_spacing();
+        last_code_point = code_point;
+    }
+}
+
+void DisplayList::fill_path(Path const& path, Color color, Painter::WindingRule winding_rule)
+{
+    m_commands.append(FillPath { path, color, winding_rule });
+}
+
+void DisplayList::replay(DisplayListPlayer& player) const
+{
+    for (auto& command : m_commands) {
+        command.visit(
+            [&](Save const&) { player.save(); },
+            [&](Restore const&) { player.restore(); },
+            [&](Translate const& translate) { player.translate(translate.delta); },
+            [&](AddClipRect const& add_clip_rect) { player.add_clip_rect(add_clip_rect.rect); },
+            [&](FillRect const& fill_rect) { player.fill_rect(fill_rect); },
+            [&](DrawBitmap const& draw_bitmap) { player.draw_bitmap(draw_bitmap); },
+            [&](DrawGlyphRun const& draw_glyph_run) { player.draw_glyph_run(draw_glyph_run); },
+            [&](FillPath const& fill_path) { player.fill_path(fill_path); });
+    }
+    player.flush();
+}
+
+void DisplayList::paint(Painter& painter) const
+{
+    PainterDisplayListPlayer player { painter };
+    replay(player);
+}
+
+void PainterDisplayListPlayer::fill_rect(DisplayList::FillRect const& command)
+{
+    m_painter.fill_rect(command.rect, command.color);
+}
+
+void PainterDisplayListPlayer::draw_bitmap(DisplayList::DrawBitmap const& command)
+{
+    if (command.dst_rect.size() == command.src_rect.size())
+        m_painter.blit(command.dst_rect.location(), command.bitmap, command.src_rect, command.opacity);
+    else
+        m_painter.draw_scaled_bitmap(command.dst_rect, command.bitmap, command.src_rect, command.opacity, command.scaling_mode);
+}
+
+void PainterDisplayListPlayer::draw_glyph_run(DisplayList::DrawGlyphRun const& command)
+{
+    for (auto& glyph : command.glyphs)
+        m_painter.draw_glyph_or_emoji(glyph.position, glyph.code_point, command.font, command.color);
+}
+
+void PainterDisplayListPlayer::fill_path(DisplayList::FillPath const& command)
+{
+    m_painter.fill_path(command.path, command.color, command.winding_rule);
+}
+
+}
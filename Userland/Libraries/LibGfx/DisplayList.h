@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NonnullRefPtr.h>
+#include <AK/Variant.h>
+#include <AK/Vector.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Color.h>
+#include <LibGfx/Font/Font.h>
+#include <LibGfx/Painter.h>
+#include <LibGfx/Path.h>
+#include <LibGfx/Point.h>
+#include <LibGfx/Rect.h>
+
+namespace Gfx {
+
+class DisplayListPlayer;
+
+// A recording of painting operations, to be replayed later on by whatever can paint them: a Painter on the CPU, or a GPU.
+// Coordinates are the same as a Painter's, and so are the semantics of save(), restore(), translate() and add_clip_rect().
+class DisplayList {
+public:
+    struct Save {
+    };
+    struct Restore {
+    };
+    struct Translate {
+        IntPoint delta;
+    };
+    struct AddClipRect {
+        IntRect rect;
+    };
+    struct FillRect {
+        IntRect rect;
+        Color color;
+    };
+    struct DrawBitmap {
+        IntRect dst_rect;
+        NonnullRefPtr<Bitmap const> bitmap;
+        IntRect src_rect;
+        float opacity;
+        Painter::ScalingMode scaling_mode;
+    };
+    struct Glyph {
+        FloatPoint position;
+        u32 code_point;
+    };
+    struct DrawGlyphRun {
+        NonnullRefPtr<Font const> font;
+        Color color;
+        Vector<Glyph> glyphs;
+    };
+    struct FillPath {
+        Path path;
+        Color color;
+        Painter::WindingRule winding_rule;
+    };
+
+    using Command = Variant<Save, Restore, Translate, AddClipRect, FillRect, DrawBitmap, DrawGlyphRun, FillPath>;
+
+    void save() { m_commands.append(Save {}); }
+    void restore() { m_commands.append(Restore {}); }
+    void translate(IntPoint delta) { m_commands.append(Translate { delta }); }
+    void add_clip_rect(IntRect const& rect) { m_commands.append(AddClipRect { rect }); }
+
+    void fill_rect(IntRect const&, Color);
+    void blit(IntPoint, Bitmap const&, IntRect const& src_rect, float opacity = 1.0f);
+    void draw_scaled_bitmap(IntRect const& dst_rect, Bitmap const&, IntRect const& src_rect, float opacity = 1.0f, Painter::ScalingMode = Painter::ScalingMode::NearestNeighbor);
+    // Consecutive glyphs of the same font and color end up in the same run.
+    void draw_glyph(FloatPoint, u32 code_point, Font const&, Color);
+    void draw_text_run(FloatPoint baseline_start, Utf8View const&, Font const&, Color);
+    void fill_path(Path const&, Color, Painter::WindingRule = Painter::WindingRule::Nonzero);
+
+    Vector<Command> const& commands() const { return m_commands; }
+    bool is_empty() const { return m_commands.is_empty(); }
+    void clear() { m_commands.clear_with_capacity(); }
+
+    void replay(DisplayListPlayer&) const;
+    void paint(Painter&) const;
+
+private:
+    Vector<Command> m_commands;
+};
+
+// Something that can paint a DisplayList. Players start out untranslated and unclipped, apart from their own bounds.
+class DisplayListPlayer {
+public:
+    virtual ~DisplayListPlayer() = default;
+
+    virtual void save() = 0;
+    virtual void restore() = 0;
+    virtual void translate(IntPoint delta) = 0;
+    virtual void add_clip_rect(IntRect const&) = 0;
+
+    virtual void fill_rect(DisplayList::FillRect const&) = 0;
+    virtual void draw_bitmap(DisplayList::DrawBitmap const&) = 0;
+    virtual void draw_glyph_run(DisplayList::DrawGlyphRun const&) = 0;
+    virtual void fill_path(DisplayList::FillPath const&) = 0;
+
+    // Called once all commands have been played.
+    virtual void flush() { }
+};
+
+// Plays a DisplayList with a regular Painter.
+class PainterDisplayListPlayer final : public DisplayListPlayer {
+public:
+    explicit PainterDisplayListPlayer(Painter& painter)
+        : m_painter(painter)
+    {
+    }
+
+    virtual void save() override { m_painter.save(); }
+    virtual void restore() override { m_painter.restore(); }
+    virtual void translate(IntPoint delta) override { m_painter.translate(delta); }
+    virtual void add_clip_rect(IntRect const& rect) override { m_painter.add_clip_rect(rect); }
+
+    virtual void fill_rect(DisplayList::FillRect const&) override;
+    virtual void draw_bitmap(DisplayList::DrawBitmap const&) override;
+    virtual void draw_glyph_run(DisplayList::DrawGlyphRun const&) override;
+    virtual void fill_path(DisplayList::FillPath const&) override;
+
+private:
+    Painter& m_painter;
+};
+
+}
@@ -36,6 +36,11 @@ protected:
             original.alpha()
         };
     };
+
+    virtual Optional<ColorMatrix> conversion_matrix() const override
+    {
+        return ColorMatrix::from_rgb_scale_and_offset(m_amount, 0);
+    }
 };
 
 }
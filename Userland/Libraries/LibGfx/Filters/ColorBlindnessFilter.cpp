@@ -81,4 +81,12 @@ Color ColorBlindnessFilter::convert_color(Color original)
         original.alpha());
 };
 
+Optional<ColorMatrix> ColorBlindnessFilter::conversion_matrix() const
+{
+    return ColorMatrix::from_rgb_matrix(FloatMatrix3x3(
+        m_red_in_red_band, m_green_in_red_band, m_blue_in_red_band,
+        m_red_in_green_band, m_green_in_green_band, m_blue_in_green_band,
+        m_red_in_blue_band, m_green_in_blue_band, m_blue_in_blue_band));
+}
+
 }
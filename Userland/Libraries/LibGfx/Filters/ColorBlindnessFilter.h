@@ -49,6 +49,7 @@ public:
 
 protected:
     Color convert_color(Color original) override;
+    virtual Optional<ColorMatrix> conversion_matrix() const override;
 
 private:
     double m_red_in_red_band;
@@ -7,6 +7,8 @@
 #pragma once
 
 #include "Filter.h"
+#include <AK/Optional.h>
+#include <LibGfx/Filters/ColorMatrix.h>
 
 namespace Gfx {
 
@@ -24,6 +26,16 @@ public:
         return false;
     }
 
+    // The color matrix that this filter applies to each pixel, if it can be described by one. Such filters can be
+    // combined with each other by a FilterPipeline.
+    Optional<ColorMatrix> color_matrix() const
+    {
+        auto matrix = conversion_matrix();
+        if (!matrix.has_value() || m_amount >= 1.0f || amount_handled_in_filter())
+            return matrix;
+        return matrix->mixed_with_identity(m_amount);
+    }
+
     virtual void apply(Bitmap& target_bitmap, IntRect const& target_rect, Bitmap const& source_bitmap, IntRect const& source_rect) override
     {
         VERIFY(source_rect.size() == target_rect.size());
@@ -47,6 +59,8 @@ public:
 
 protected:
     virtual Color convert_color(Color) = 0;
+    // The color matrix that convert_color() applies, if it is just that.
+    virtual Optional<ColorMatrix> conversion_matrix() const { return {}; }
     float m_amount { 1.0f };
 };
 
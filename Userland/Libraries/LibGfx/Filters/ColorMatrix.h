@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Math.h>
+#include <LibGfx/Color.h>
+#include <LibGfx/Matrix.h>
+#include <LibGfx/Matrix3x3.h>
+
+namespace Gfx {
+
+// An affine map of colors, like SVG's feColorMatrix. It works on (red, green, blue, alpha, 1) vectors with channels from
+// 0 to 255, so the last column holds what is added to each channel.
+class ColorMatrix {
+public:
+    using MatrixType = Matrix<5, float>;
+
+    constexpr ColorMatrix()
+        : m_matrix(MatrixType::identity())
+    {
+    }
+
+    explicit constexpr ColorMatrix(MatrixType const& matrix)
+        : m_matrix(matrix)
+    {
+    }
+
+    // Applies `rgb_matrix` to red, green and blue, and keeps alpha.
+    static constexpr ColorMatrix from_rgb_matrix(FloatMatrix3x3 const& rgb_matrix)
+    {
+        ColorMatrix color_matrix;
+        for (size_t row = 0; row < 3; ++row) {
+            for (size_t column = 0; column < 3; ++column)
+                color_matrix.m_matrix.elements()[row][column] = rgb_matrix.elements()[row][column];
+        }
+        return color_matrix;
+    }
+
+    // Maps each of red, green and blue to `channel * scale + offset`, and keeps alpha.
+    static constexpr ColorMatrix from_rgb_scale_and_offset(float scale, float offset)
+    {
+        ColorMatrix color_matrix;
+        for (size_t channel = 0; channel < 3; ++channel) {
+            color_matrix.m_matrix.elements()[channel][channel] = scale;
+            color_matrix.m_matrix.elements()[channel][4] = offset;
+        }
+        return color_matrix;
+    }
+
+    constexpr MatrixType const& matrix() const { return m_matrix; }
+    constexpr float weight(size_t row, size_t column) const { return m_matrix.elements()[row][column]; }
+    constexpr float offset(size_t row) const { return m_matrix.elements()[row][4]; }
+    constexpr void set_weight(size_t row, size_t column, float weight) { m_matrix.elements()[row][column] = weight; }
+    constexpr void set_offset(size_t row, float offset) { m_matrix.elements()[row][4] = offset; }
+
+    // The matrix that mixes the original color with what this one maps it to, like Color::mixed_with() does.
+    constexpr ColorMatrix mixed_with_identity(float amount) const
+    {
+        return ColorMatrix { m_matrix * amount + MatrixType::identity() * (1.0f - amount) };
+    }
+
+    // Applies `first` first, and then this.
+    constexpr ColorMatrix operator*(ColorMatrix const& first) const
+    {
+        return ColorMatrix { m_matrix * first.m_matrix };
+    }
+
+    // Whether every color is mapped to channels from 0 to 255 (give or take rounding), so that none need to be clamped.
+    constexpr bool keeps_channels_in_range() const
+    {
+        for (size_t row = 0; row < 4; ++row) {
+            float minimum = offset(row);
+            float maximum = offset(row);
+            for (size_t column = 0; column < 4; ++column) {
+                auto weight = this->weight(row, column);
+                if (weight < 0)
+                    minimum += weight * 255;
+                else
+                    maximum += weight * 255;
+            }
+            if (minimum < -0.5f || maximum > 255.5f)
+                return false;
+        }
+        return true;
+    }
+
+    Color apply(Color color) const
+    {
+        float const channels[4] = { static_cast<float>(color.red()), static_cast<float>(color.green()), static_cast<float>(color.blue()), static_cast<float>(color.alpha()) };
+        u8 results[4];
+        for (size_t row = 0; row < 4; ++row) {
+            float value = offset(row);
+            for (size_t column = 0; column < 4; ++column)
+                value += weight(row, column) * channels[column];
+            results[row] = AK::clamp(round_to<int>(value), 0, 255);
+        }
+        return Color(results[0], results[1], results[2], results[3]);
+    }
+
+private:
+    MatrixType m_matrix;
+};
+
+}
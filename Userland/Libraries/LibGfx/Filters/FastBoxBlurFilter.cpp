@@ -9,26 +9,29 @@
 #endif
 
 #include <AK/Function.h>
+#include <AK/SIMD.h>
 #include <AK/Vector.h>
 #include <LibGfx/Filters/FastBoxBlurFilter.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace Gfx {
 
-ALWAYS_INLINE static constexpr u8 red_value(Color color)
-{
-    return (color.alpha() == 0) ? 0xFF : color.red();
-}
-ALWAYS_INLINE static constexpr u8 green_value(Color color)
-{
-    return (color.alpha() == 0) ? 0xFF : color.green();
-}
-ALWAYS_INLINE static constexpr u8 blue_value(Color color)
+using AK::SIMD::u32x4;
+
+// Rows and columns are handed to other threads in chunks of at least this many pixels.
+static constexpr int minimum_pixels_per_job = 16384;
+
+// Note: The color channels of fully transparent pixels count as white.
+ALWAYS_INLINE static u32x4 to_vector(Color color)
 {
-    return (color.alpha() == 0) ? 0xFF : color.blue();
+    if (color.alpha() == 0)
+        return u32x4 { 0xFF, 0xFF, 0xFF, 0 };
+    return u32x4 { color.red(), color.green(), color.blue(), color.alpha() };
 }
 
-FastBoxBlurFilter::FastBoxBlurFilter(Bitmap& bitmap)
+FastBoxBlurFilter::FastBoxBlurFilter(Bitmap& bitmap, UseThreadPool use_thread_pool)
     : m_bitmap(bitmap)
+    , m_use_thread_pool(use_thread_pool)
 {
 }
 
@@ -37,99 +40,78 @@ void FastBoxBlurFilter::apply_single_pass(size_t radius)
     apply_single_pass(radius, radius);
 }
 
+// Calls `callback` for ranges that together cover [0, count), on the thread pool if the caller allowed that.
+static void for_each_range(FastBoxBlurFilter::UseThreadPool use_thread_pool, size_t count, size_t grain_size, Function<void(size_t begin, size_t end)> callback)
+{
+    if (use_thread_pool == FastBoxBlurFilter::UseThreadPool::Yes) {
+        Threading::ThreadPool::the().parallel_for(count, grain_size, move(callback));
+        return;
+    }
+    if (count > 0)
+        callback(0, count);
+}
+
 template<typename GetPixelFunction, typename SetPixelFunction>
-static void do_single_pass(int width, int height, size_t radius_x, size_t radius_y, GetPixelFunction get_pixel_function, SetPixelFunction set_pixel_function)
+static void do_single_pass(FastBoxBlurFilter::UseThreadPool use_thread_pool, int width, int height, size_t radius_x, size_t radius_y, GetPixelFunction get_pixel_function, SetPixelFunction set_pixel_function)
 {
-    int div_x = 2 * radius_x + 1;
-    int div_y = 2 * radius_y + 1;
+    u32 div_x = 2 * radius_x + 1;
+    u32 div_y = 2 * radius_y + 1;
 
     Vector<Color, 1024> intermediate;
     intermediate.resize(width * height);
 
+    // Note: All four channels of a pixel are summed up at once, in one vector. Rows (and then columns) don't depend on
+    //       each other, so they can be spread over the thread pool.
+
     // First pass: vertical
-    for (int y = 0; y < height; ++y) {
-        size_t sum_red = 0;
-        size_t sum_green = 0;
-        size_t sum_blue = 0;
-        size_t sum_alpha = 0;
-
-        // Setup sliding window
-        for (int i = -(int)radius_x; i <= (int)radius_x; ++i) {
-            auto color_at_px = get_pixel_function(clamp(i, 0, width - 1), y);
-            sum_red += red_value(color_at_px);
-            sum_green += green_value(color_at_px);
-            sum_blue += blue_value(color_at_px);
-            sum_alpha += color_at_px.alpha();
-        }
-        // Slide horizontally
-        for (int x = 0; x < width; ++x) {
-            auto const index = y * width + x;
-            auto& current_intermediate = intermediate[index];
-            current_intermediate.set_red(sum_red / div_x);
-            current_intermediate.set_green(sum_green / div_x);
-            current_intermediate.set_blue(sum_blue / div_x);
-            current_intermediate.set_alpha(sum_alpha / div_x);
-
-            auto leftmost_x_coord = max(x - (int)radius_x, 0);
-            auto rightmost_x_coord = min(x + (int)radius_x + 1, width - 1);
-
-            auto leftmost_x_color = get_pixel_function(leftmost_x_coord, y);
-            auto rightmost_x_color = get_pixel_function(rightmost_x_coord, y);
-
-            sum_red -= red_value(leftmost_x_color);
-            sum_red += red_value(rightmost_x_color);
-            sum_green -= green_value(leftmost_x_color);
-            sum_green += green_value(rightmost_x_color);
-            sum_blue -= blue_value(leftmost_x_color);
-            sum_blue += blue_value(rightmost_x_color);
-            sum_alpha -= leftmost_x_color.alpha();
-            sum_alpha += rightmost_x_color.alpha();
+    for_each_range(use_thread_pool, height, max(1, minimum_pixels_per_job / max(width, 1)), [&](size_t begin, size_t end) {
+        for (int y = begin; y < (int)end; ++y) {
+            u32x4 sum {};
+
+            // Setup sliding window
+            for (int i = -(int)radius_x; i <= (int)radius_x; ++i)
+                sum += to_vector(get_pixel_function(clamp(i, 0, width - 1), y));
+
+            // Slide horizontally
+            for (int x = 0; x < width; ++x) {
+                auto average = sum / div_x;
+                intermediate[y * width + x] = Color(average[0], average[1], average[2], average[3]);
+
+                auto leftmost_x_coord = max(x - (int)radius_x, 0);
+                auto rightmost_x_coord = min(x + (int)radius_x + 1, width - 1);
+
+                sum -= to_vector(get_pixel_function(leftmost_x_coord, y));
+                sum += to_vector(get_pixel_function(rightmost_x_coord, y));
+            }
         }
-    }
+    });
+
+    auto intermediate_vector = [&](int index) -> u32x4 {
+        auto color = intermediate[index];
+        return u32x4 { color.red(), color.green(), color.blue(), color.alpha() };
+    };
 
     // Second pass: horizontal
-    for (int x = 0; x < width; ++x) {
-        size_t sum_red = 0;
-        size_t sum_green = 0;
-        size_t sum_blue = 0;
-        size_t sum_alpha = 0;
-
-        // Setup sliding window
-        for (int i = -(int)radius_y; i <= (int)radius_y; ++i) {
-            int offset = clamp(i, 0, height - 1) * width + x;
-            auto& current_intermediate = intermediate[offset];
-            sum_red += current_intermediate.red();
-            sum_green += current_intermediate.green();
-            sum_blue += current_intermediate.blue();
-            sum_alpha += current_intermediate.alpha();
-        }
+    for_each_range(use_thread_pool, width, max(1, minimum_pixels_per_job / max(height, 1)), [&](size_t begin, size_t end) {
+        for (int x = begin; x < (int)end; ++x) {
+            u32x4 sum {};
+
+            // Setup sliding window
+            for (int i = -(int)radius_y; i <= (int)radius_y; ++i)
+                sum += intermediate_vector(clamp(i, 0, height - 1) * width + x);
 
-        for (int y = 0; y < height; ++y) {
-            auto color = Color(
-                sum_red / div_y,
-                sum_green / div_y,
-                sum_blue / div_y,
-                sum_alpha / div_y);
-
-            set_pixel_function(x, y, color);
-
-            auto const bottommost_y_coord = min(y + (int)radius_y + 1, height - 1);
-            auto const bottom_index = x + bottommost_y_coord * width;
-            auto& bottom_intermediate = intermediate[bottom_index];
-            sum_red += bottom_intermediate.red();
-            sum_green += bottom_intermediate.green();
-            sum_blue += bottom_intermediate.blue();
-            sum_alpha += bottom_intermediate.alpha();
-
-            auto const topmost_y_coord = max(y - (int)radius_y, 0);
-            auto const top_index = x + topmost_y_coord * width;
-            auto& top_intermediate = intermediate[top_index];
-            sum_red -= top_intermediate.red();
-            sum_green -= top_intermediate.green();
-            sum_blue -= top_intermediate.blue();
-            sum_alpha -= top_intermediate.alpha();
+            for (int y = 0; y < height; ++y) {
+                auto average = sum / div_y;
+                set_pixel_function(x, y, Color(average[0], average[1], average[2], average[3]));
+
+                auto const bottommost_y_coord = min(y + (int)radius_y + 1, height - 1);
+                sum += intermediate_vector(x + bottommost_y_coord * width);
+
+                auto const topmost_y_coord = max(y - (int)radius_y, 0);
+                sum -= intermediate_vector(x + topmost_y_coord * width);
+            }
         }
-    }
+    });
 }
 
 // Based on the super fast blur algorithm by Quasimondo, explored here: https://stackoverflow.com/questions/21418892/understanding-super-fast-blur-algorithm
@@ -141,13 +123,13 @@ FLATTEN void FastBoxBlurFilter::apply_single_pass(size_t radius_x, size_t radius
     switch (format) {
     case BitmapFormat::BGRx8888:
         do_single_pass(
-            m_bitmap.width(), m_bitmap.height(), radius_x, radius_y,
+            m_use_thread_pool, m_bitmap.width(), m_bitmap.height(), radius_x, radius_y,
             [&](int x, int y) { return m_bitmap.get_pixel<StorageFormat::BGRx8888>(x, y); },
             [&](int x, int y, Color color) { return m_bitmap.set_pixel<StorageFormat::BGRx8888>(x, y, color); });
         break;
     case BitmapFormat::BGRA8888:
         do_single_pass(
-            m_bitmap.width(), m_bitmap.height(), radius_x, radius_y,
+            m_use_thread_pool, m_bitmap.width(), m_bitmap.height(), radius_x, radius_y,
             [&](int x, int y) { return m_bitmap.get_pixel<StorageFormat::BGRA8888>(x, y); },
             [&](int x, int y, Color color) { return m_bitmap.set_pixel<StorageFormat::BGRA8888>(x, y, color); });
         break;
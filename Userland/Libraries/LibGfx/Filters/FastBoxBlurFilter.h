@@ -12,7 +12,13 @@ namespace Gfx {
 
 class FastBoxBlurFilter {
 public:
-    FastBoxBlurFilter(Bitmap&);
+    // Rows and columns can be blurred on the shared thread pool. Only do this if the process is allowed to create threads.
+    enum class UseThreadPool {
+        No,
+        Yes,
+    };
+
+    FastBoxBlurFilter(Bitmap&, UseThreadPool = UseThreadPool::No);
 
     void apply_single_pass(size_t radius);
     void apply_single_pass(size_t radius_x, size_t radius_y);
@@ -21,6 +27,7 @@ public:
 
 private:
     Bitmap& m_bitmap;
+    UseThreadPool m_use_thread_pool { UseThreadPool::No };
 };
 
 }
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#if defined(AK_COMPILER_GCC)
+#    pragma GCC optimize("O3")
+#endif
+
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
+#include <AK/SIMDMath.h>
+#include <LibGfx/Filters/FilterPipeline.h>
+#include <LibGfx/Filters/StackBlurFilter.h>
+#include <LibThreading/ThreadPool.h>
+
+// See the comment in SIMDMath.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace Gfx {
+
+// Passes hand rows to other threads in chunks of at least this many pixels.
+static constexpr int minimum_pixels_per_job = 16384;
+
+void FilterPipeline::add_color_matrix(ColorMatrix const& matrix)
+{
+    // Note: If the previous matrix may push channels out of range, they have to be clamped before this one is applied,
+    //       so the two can't be combined.
+    if (!m_passes.is_empty()) {
+        if (auto* previous = m_passes.last().get_pointer<ColorMatrix>(); previous && previous->keeps_channels_in_range()) {
+            *previous = matrix * *previous;
+            return;
+        }
+    }
+    m_passes.append(matrix);
+}
+
+void FilterPipeline::add_color_filter(ColorFilter const& filter)
+{
+    auto matrix = filter.color_matrix();
+    VERIFY(matrix.has_value());
+    add_color_matrix(*matrix);
+}
+
+void FilterPipeline::add_stack_blur(u8 radius, Color fill_color)
+{
+    if (radius == 0)
+        return;
+    m_passes.append(StackBlur { radius, fill_color });
+}
+
+void FilterPipeline::apply(Bitmap& bitmap) const
+{
+    for (auto& pass : m_passes) {
+        pass.visit(
+            [&](ColorMatrix const& matrix) {
+                apply_color_matrix(bitmap, matrix, m_use_thread_pool);
+            },
+            [&](StackBlur const& blur) {
+                StackBlurFilter filter { bitmap, m_use_thread_pool == UseThreadPool::Yes ? StackBlurFilter::UseThreadPool::Yes : StackBlurFilter::UseThreadPool::No };
+                filter.process_rgba(blur.radius, blur.fill_color);
+            });
+    }
+}
+
+void FilterPipeline::apply_color_matrix(Bitmap& bitmap, ColorMatrix const& matrix, UseThreadPool use_thread_pool)
+{
+    auto format = bitmap.format();
+    VERIFY(format == BitmapFormat::BGRA8888 || format == BitmapFormat::BGRx8888);
+
+    // Note: Pixels keep their channels as blue, green, red and alpha in memory, and so do the vectors here. This is the
+    //       row (and column) of the color matrix that belongs to each of them.
+    constexpr size_t channel_indices[4] = { 2, 1, 0, 3 };
+    AK::SIMD::f32x4 columns[4];
+    AK::SIMD::f32x4 offsets;
+    for (size_t lane = 0; lane < 4; ++lane) {
+        // Note: Adding a half before truncating rounds to the nearest integer.
+        offsets[lane] = matrix.offset(channel_indices[lane]) + 0.5f;
+        for (size_t column = 0; column < 4; ++column)
+            columns[column][lane] = matrix.weight(channel_indices[lane], channel_indices[column]);
+    }
+
+    u32 const alpha_mask = format == BitmapFormat::BGRx8888 ? 0xff000000 : 0;
+    int const width = bitmap.physical_width();
+    int const height = bitmap.physical_height();
+    auto apply_to_rows = [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; ++y) {
+            auto* pixels = bitmap.scanline(y);
+            for (int x = 0; x < width; ++x) {
+                u32 pixel = pixels[x] | alpha_mask;
+                AK::SIMD::u8x4 channels;
+                memcpy(&channels, &pixel, sizeof(pixel));
+                auto values = AK::SIMD::to_f32x4(channels);
+                auto result = offsets + columns[0] * values[0] + columns[1] * values[1] + columns[2] * values[2] + columns[3] * values[3];
+                auto result_channels = AK::SIMD::to_u8x4(AK::SIMD::clamp(result, 0.0f, 255.0f));
+                memcpy(&pixels[x], &result_channels, sizeof(pixel));
+            }
+        }
+    };
+    if (use_thread_pool == UseThreadPool::Yes)
+        Threading::ThreadPool::the().parallel_for(height, max(1, minimum_pixels_per_job / max(width, 1)), move(apply_to_rows));
+    else
+        apply_to_rows(0, height);
+}
+
+}
+
+#pragma GCC diagnostic pop
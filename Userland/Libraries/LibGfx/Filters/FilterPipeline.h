@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Variant.h>
+#include <AK/Vector.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Filters/ColorFilter.h>
+#include <LibGfx/Filters/ColorMatrix.h>
+
+namespace Gfx {
+
+// A list of filters that are applied to a bitmap, one after another.
+// Neighbouring color matrices are combined into one wherever that doesn't change the result (except for rounding), so
+// the bitmap only needs to be gone over once for all of them. Each pass can be spread over the shared thread pool.
+class FilterPipeline {
+public:
+    // Only use the thread pool if the process is allowed to create threads.
+    enum class UseThreadPool {
+        No,
+        Yes,
+    };
+
+    explicit FilterPipeline(UseThreadPool use_thread_pool = UseThreadPool::No)
+        : m_use_thread_pool(use_thread_pool)
+    {
+    }
+
+    void add_color_matrix(ColorMatrix const&);
+    // Note: Only color filters that have a color matrix can be added.
+    void add_color_filter(ColorFilter const&);
+    void add_stack_blur(u8 radius, Color fill_color = Color::NamedColor::White);
+
+    // How often the bitmap needs to be gone over.
+    size_t pass_count() const { return m_passes.size(); }
+
+    // Note: The bitmap must be a BGRx8888 or BGRA8888 one.
+    void apply(Bitmap&) const;
+
+    // Applies `matrix` to every pixel of `bitmap`, four channels at a time.
+    static void apply_color_matrix(Bitmap&, ColorMatrix const&, UseThreadPool = UseThreadPool::No);
+
+private:
+    struct StackBlur {
+        u8 radius;
+        Color fill_color;
+    };
+
+    Vector<Variant<ColorMatrix, StackBlur>> m_passes;
+    UseThreadPool m_use_thread_pool { UseThreadPool::No };
+};
+
+}
@@ -20,6 +20,16 @@ public:
 
 protected:
     Color convert_color(Color original) override { return original.to_grayscale(); };
+
+    virtual Optional<ColorMatrix> conversion_matrix() const override
+    {
+        // Note: These are the weights that Color::luminosity() uses.
+        return ColorMatrix::from_rgb_matrix({
+            0.2126f, 0.7152f, 0.0722f,
+            0.2126f, 0.7152f, 0.0722f,
+            0.2126f, 0.7152f, 0.0722f,
+        });
+    }
 };
 
 }
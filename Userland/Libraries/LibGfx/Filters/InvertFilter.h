@@ -20,6 +20,11 @@ public:
 
 protected:
     Color convert_color(Color original) override { return original.inverted(); };
+
+    virtual Optional<ColorMatrix> conversion_matrix() const override
+    {
+        return ColorMatrix::from_rgb_scale_and_offset(-1, 255);
+    }
 };
 
 }
@@ -39,6 +39,11 @@ protected:
         };
     }
 
+    virtual Optional<ColorMatrix> conversion_matrix() const override
+    {
+        return ColorMatrix::from_rgb_matrix(m_operation);
+    }
+
 private:
     FloatMatrix3x3 const m_operation;
 };
@@ -28,6 +28,14 @@ protected:
     {
         return original.with_alpha(m_amount * 255);
     };
+
+    virtual Optional<ColorMatrix> conversion_matrix() const override
+    {
+        ColorMatrix matrix;
+        matrix.set_weight(3, 3, 0);
+        matrix.set_offset(3, m_amount * 255);
+        return matrix;
+    }
 };
 
 }
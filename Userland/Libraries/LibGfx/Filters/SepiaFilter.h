@@ -26,6 +26,16 @@ public:
 
 protected:
     Color convert_color(Color original) override { return original.sepia(m_amount); };
+
+    virtual Optional<ColorMatrix> conversion_matrix() const override
+    {
+        // Note: This is the matrix that Color::sepia() uses.
+        auto blend_factor = 1.0f - m_amount;
+        return ColorMatrix::from_rgb_matrix(FloatMatrix3x3(
+            0.393f + 0.607f * blend_factor, 0.769f - 0.769f * blend_factor, 0.189f - 0.189f * blend_factor,
+            0.349f - 0.349f * blend_factor, 0.686f + 0.314f * blend_factor, 0.168f - 0.168f * blend_factor,
+            0.272f - 0.272f * blend_factor, 0.534f - 0.534f * blend_factor, 0.131f + 0.869f * blend_factor));
+    }
 };
 
 }
@@ -10,17 +10,24 @@
 #endif
 
 #include <AK/Array.h>
+#include <AK/Function.h>
 #include <AK/IntegralMath.h>
 #include <AK/Math.h>
+#include <AK/SIMD.h>
 #include <AK/Vector.h>
 #include <LibGfx/Filters/StackBlurFilter.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace Gfx {
 
 using uint = unsigned;
+using AK::SIMD::u32x4;
 
 constexpr size_t MAX_RADIUS = 256;
 
+// Rows and columns are handed to other threads in chunks of at least this many pixels.
+constexpr uint minimum_pixels_per_job = 16384;
+
 // Magic lookup tables!
 // `(value * sum_mult[radius - 2]) >> shift_table[radius - 2]` closely approximates value/(radius*radius)
 // These LUTs are the same as the original, but converted to constexpr functions rather than magic numbers.
@@ -43,22 +50,19 @@ constexpr auto mult_table = [] {
 struct BlurStack {
     BlurStack(size_t size)
     {
-        m_data.resize(size);
+        m_data.ensure_capacity(size);
+        for (size_t i = 0; i < size; ++i)
+            m_data.unchecked_append(u32x4 {});
     }
 
     struct Iterator {
         friend BlurStack;
 
-        ALWAYS_INLINE Color& operator*()
+        ALWAYS_INLINE u32x4& operator*()
         {
             return m_data.at(m_idx);
         }
 
-        ALWAYS_INLINE Color* operator->()
-        {
-            return &m_data.at(m_idx);
-        }
-
         ALWAYS_INLINE Iterator operator++()
         {
             // Note: This seemed to profile slightly better than %
@@ -75,14 +79,14 @@ struct BlurStack {
         }
 
     private:
-        Iterator(size_t idx, Span<Color> data)
+        Iterator(size_t idx, Span<u32x4> data)
             : m_idx(idx)
             , m_data(data)
         {
         }
 
         size_t m_idx;
-        Span<Color> m_data;
+        Span<u32x4> m_data;
     };
 
     Iterator iterator_from_position(size_t position)
@@ -92,9 +96,76 @@ struct BlurStack {
     }
 
 private:
-    Vector<Color, 512> m_data;
+    Vector<u32x4, 512> m_data;
 };
 
+ALWAYS_INLINE static u32x4 to_vector(Color color)
+{
+    return u32x4 { color.red(), color.green(), color.blue(), color.alpha() };
+}
+
+// Blurs one row or column of `length` pixels. All four channels of a pixel are summed up at once, in one vector.
+template<typename GetPixel, typename SetPixel>
+ALWAYS_INLINE static void blur_line(BlurStack& blur_stack, uint length, uint radius, Color fill_color, GetPixel get_pixel, SetPixel set_pixel)
+{
+    uint radius_plus_1 = radius + 1;
+    uint sum_factor = radius_plus_1 * (radius_plus_1 + 1) / 2;
+    auto const sum_mult = mult_table[radius - 1];
+    auto const sum_shift = shift_table[radius - 1];
+
+    auto const stack_start = blur_stack.iterator_from_position(0);
+    auto const stack_end = blur_stack.iterator_from_position(radius_plus_1);
+    auto stack_iterator = stack_start;
+
+    auto color = get_pixel(0);
+    for (uint i = 0; i < radius_plus_1; i++)
+        *(stack_iterator++) = color;
+
+    // All the sums here work to approximate a gaussian.
+    // Note: Only about 17 bits are actually used in each sum.
+    u32x4 in_sum {};
+    u32x4 out_sum = radius_plus_1 * color;
+    u32x4 sum = sum_factor * color;
+
+    for (uint i = 1; i <= radius; i++) {
+        auto color = get_pixel(min(i, length - 1));
+
+        auto bias = radius_plus_1 - i;
+        *stack_iterator = color;
+        sum += color * bias;
+        in_sum += color;
+
+        ++stack_iterator;
+    }
+
+    auto stack_in_iterator = stack_start;
+    auto stack_out_iterator = stack_end;
+
+    for (uint i = 0; i < length; i++) {
+        auto result = (sum * sum_mult) >> sum_shift;
+        if (result[3] != 0)
+            set_pixel(i, Color(result[0], result[1], result[2], result[3]));
+        else
+            set_pixel(i, fill_color);
+
+        sum -= out_sum;
+        out_sum -= *stack_in_iterator;
+
+        auto color = get_pixel(min(i + radius_plus_1, length - 1));
+        *stack_in_iterator = color;
+        in_sum += color;
+        sum += in_sum;
+
+        ++stack_in_iterator;
+
+        color = *stack_out_iterator;
+        out_sum += color;
+        in_sum -= color;
+
+        ++stack_out_iterator;
+    }
+}
+
 // This is an implementation of StackBlur by Mario Klingemann (https://observablehq.com/@jobleonard/mario-klingemans-stackblur)
 // (Link is to a secondary source as the original site is now down)
 FLATTEN void StackBlurFilter::process_rgba(u8 radius, Color fill_color)
@@ -105,208 +176,49 @@ FLATTEN void StackBlurFilter::process_rgba(u8 radius, Color fill_color)
         return;
 
     fill_color = fill_color.with_alpha(0);
+    auto const fill_vector = to_vector(fill_color);
 
     uint width = m_bitmap.width();
     uint height = m_bitmap.height();
-
     uint div = 2 * radius + 1;
-    uint radius_plus_1 = radius + 1;
-    uint sum_factor = radius_plus_1 * (radius_plus_1 + 1) / 2;
 
     auto get_pixel = [&](int x, int y) {
         auto color = m_bitmap.get_pixel<StorageFormat::BGRA8888>(x, y);
         if (color.alpha() == 0)
-            return fill_color;
-        return color;
+            return fill_vector;
+        return to_vector(color);
     };
 
     auto set_pixel = [&](int x, int y, Color color) {
         return m_bitmap.set_pixel<StorageFormat::BGRA8888>(x, y, color);
     };
 
-    BlurStack blur_stack { div };
-    auto const stack_start = blur_stack.iterator_from_position(0);
-    auto const stack_end = blur_stack.iterator_from_position(radius_plus_1);
-    auto stack_iterator = stack_start;
-
-    auto const sum_mult = mult_table[radius - 1];
-    auto const sum_shift = shift_table[radius - 1];
-
-    for (uint y = 0; y < height; y++) {
-        stack_iterator = stack_start;
-
-        auto color = get_pixel(0, y);
-        for (uint i = 0; i < radius_plus_1; i++)
-            *(stack_iterator++) = color;
-
-        // All the sums here work to approximate a gaussian.
-        // Note: Only about 17 bits are actually used in each sum.
-        uint red_in_sum = 0;
-        uint green_in_sum = 0;
-        uint blue_in_sum = 0;
-        uint alpha_in_sum = 0;
-        uint red_out_sum = radius_plus_1 * color.red();
-        uint green_out_sum = radius_plus_1 * color.green();
-        uint blue_out_sum = radius_plus_1 * color.blue();
-        uint alpha_out_sum = radius_plus_1 * color.alpha();
-        uint red_sum = sum_factor * color.red();
-        uint green_sum = sum_factor * color.green();
-        uint blue_sum = sum_factor * color.blue();
-        uint alpha_sum = sum_factor * color.alpha();
-
-        for (uint i = 1; i <= radius; i++) {
-            auto color = get_pixel(min(i, width - 1), y);
-
-            auto bias = radius_plus_1 - i;
-            *stack_iterator = color;
-            red_sum += color.red() * bias;
-            green_sum += color.green() * bias;
-            blue_sum += color.blue() * bias;
-            alpha_sum += color.alpha() * bias;
-
-            red_in_sum += color.red();
-            green_in_sum += color.green();
-            blue_in_sum += color.blue();
-            alpha_in_sum += color.alpha();
-
-            ++stack_iterator;
-        }
-
-        auto stack_in_iterator = stack_start;
-        auto stack_out_iterator = stack_end;
-
-        for (uint x = 0; x < width; x++) {
-            auto alpha = (alpha_sum * sum_mult) >> sum_shift;
-            if (alpha != 0)
-                set_pixel(x, y, Color((red_sum * sum_mult) >> sum_shift, (green_sum * sum_mult) >> sum_shift, (blue_sum * sum_mult) >> sum_shift, alpha));
-            else
-                set_pixel(x, y, fill_color);
-
-            red_sum -= red_out_sum;
-            green_sum -= green_out_sum;
-            blue_sum -= blue_out_sum;
-            alpha_sum -= alpha_out_sum;
-
-            red_out_sum -= stack_in_iterator->red();
-            green_out_sum -= stack_in_iterator->green();
-            blue_out_sum -= stack_in_iterator->blue();
-            alpha_out_sum -= stack_in_iterator->alpha();
-
-            auto color = get_pixel(min(x + radius_plus_1, width - 1), y);
-            *stack_in_iterator = color;
-            red_in_sum += color.red();
-            green_in_sum += color.green();
-            blue_in_sum += color.blue();
-            alpha_in_sum += color.alpha();
-
-            red_sum += red_in_sum;
-            green_sum += green_in_sum;
-            blue_sum += blue_in_sum;
-            alpha_sum += alpha_in_sum;
-
-            ++stack_in_iterator;
-
-            color = *stack_out_iterator;
-            red_out_sum += color.red();
-            green_out_sum += color.green();
-            blue_out_sum += color.blue();
-            alpha_out_sum += color.alpha();
-
-            red_in_sum -= color.red();
-            green_in_sum -= color.green();
-            blue_in_sum -= color.blue();
-            alpha_in_sum -= color.alpha();
-
-            ++stack_out_iterator;
-        }
-    }
-
-    for (uint x = 0; x < width; x++) {
-        stack_iterator = stack_start;
-
-        auto color = get_pixel(x, 0);
-        for (uint i = 0; i < radius_plus_1; i++)
-            *(stack_iterator++) = color;
-
-        uint red_in_sum = 0;
-        uint green_in_sum = 0;
-        uint blue_in_sum = 0;
-        uint alpha_in_sum = 0;
-        uint red_out_sum = radius_plus_1 * color.red();
-        uint green_out_sum = radius_plus_1 * color.green();
-        uint blue_out_sum = radius_plus_1 * color.blue();
-        uint alpha_out_sum = radius_plus_1 * color.alpha();
-        uint red_sum = sum_factor * color.red();
-        uint green_sum = sum_factor * color.green();
-        uint blue_sum = sum_factor * color.blue();
-        uint alpha_sum = sum_factor * color.alpha();
-
-        for (uint i = 1; i <= radius; i++) {
-            auto color = get_pixel(x, min(i, height - 1));
-
-            auto bias = radius_plus_1 - i;
-            *stack_iterator = color;
-            red_sum += color.red() * bias;
-            green_sum += color.green() * bias;
-            blue_sum += color.blue() * bias;
-            alpha_sum += color.alpha() * bias;
-
-            red_in_sum += color.red();
-            green_in_sum += color.green();
-            blue_in_sum += color.blue();
-            alpha_in_sum += color.alpha();
-
-            ++stack_iterator;
+    // Note: Rows (and then columns) are blurred independently of each other, so they can be spread over the thread pool.
+    auto for_each_range = [&](size_t count, size_t grain_size, Function<void(size_t begin, size_t end)> callback) {
+        if (m_use_thread_pool == UseThreadPool::Yes)
+            Threading::ThreadPool::the().parallel_for(count, grain_size, move(callback));
+        else if (count > 0)
+            callback(0, count);
+    };
+    for_each_range(height, max(1u, minimum_pixels_per_job / max(width, 1u)), [&](size_t begin, size_t end) {
+        BlurStack blur_stack { div };
+        for (uint y = begin; y < end; y++) {
+            blur_line(
+                blur_stack, width, radius, fill_color,
+                [&](uint x) { return get_pixel(x, y); },
+                [&](uint x, Color color) { set_pixel(x, y, color); });
         }
-
-        auto stack_in_iterator = stack_start;
-        auto stack_out_iterator = stack_end;
-
-        for (uint y = 0; y < height; y++) {
-            auto alpha = (alpha_sum * sum_mult) >> sum_shift;
-            if (alpha != 0)
-                set_pixel(x, y, Color((red_sum * sum_mult) >> sum_shift, (green_sum * sum_mult) >> sum_shift, (blue_sum * sum_mult) >> sum_shift, alpha));
-            else
-                set_pixel(x, y, fill_color);
-
-            red_sum -= red_out_sum;
-            green_sum -= green_out_sum;
-            blue_sum -= blue_out_sum;
-            alpha_sum -= alpha_out_sum;
-
-            red_out_sum -= stack_in_iterator->red();
-            green_out_sum -= stack_in_iterator->green();
-            blue_out_sum -= stack_in_iterator->blue();
-            alpha_out_sum -= stack_in_iterator->alpha();
-
-            auto color = get_pixel(x, min(y + radius_plus_1, height - 1));
-            *stack_in_iterator = color;
-            red_in_sum += color.red();
-            green_in_sum += color.green();
-            blue_in_sum += color.blue();
-            alpha_in_sum += color.alpha();
-
-            red_sum += red_in_sum;
-            green_sum += green_in_sum;
-            blue_sum += blue_in_sum;
-            alpha_sum += alpha_in_sum;
-
-            ++stack_in_iterator;
-
-            color = *stack_out_iterator;
-            red_out_sum += color.red();
-            green_out_sum += color.green();
-            blue_out_sum += color.blue();
-            alpha_out_sum += color.alpha();
-
-            red_in_sum -= color.red();
-            green_in_sum -= color.green();
-            blue_in_sum -= color.blue();
-            alpha_in_sum -= color.alpha();
-
-            ++stack_out_iterator;
+    });
+
+    for_each_range(width, max(1u, minimum_pixels_per_job / max(height, 1u)), [&](size_t begin, size_t end) {
+        BlurStack blur_stack { div };
+        for (uint x = begin; x < end; x++) {
+            blur_line(
+                blur_stack, height, radius, fill_color,
+                [&](uint y) { return get_pixel(x, y); },
+                [&](uint y, Color color) { set_pixel(x, y, color); });
         }
-    }
+    });
 }
 
 }
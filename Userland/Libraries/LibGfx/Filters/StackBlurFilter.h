@@ -12,8 +12,15 @@ namespace Gfx {
 
 class StackBlurFilter {
 public:
-    StackBlurFilter(Bitmap& bitmap)
+    // Rows and columns can be blurred on the shared thread pool. Only do this if the process is allowed to create threads.
+    enum class UseThreadPool {
+        No,
+        Yes,
+    };
+
+    StackBlurFilter(Bitmap& bitmap, UseThreadPool use_thread_pool = UseThreadPool::No)
         : m_bitmap(bitmap)
+        , m_use_thread_pool(use_thread_pool)
     {
     }
 
@@ -22,6 +29,7 @@ public:
 
 private:
     Bitmap& m_bitmap;
+    UseThreadPool m_use_thread_pool { UseThreadPool::No };
 };
 
 }
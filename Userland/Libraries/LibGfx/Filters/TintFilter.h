@@ -31,6 +31,15 @@ protected:
             .with_alpha(dest.alpha());
     };
 
+    virtual Optional<ColorMatrix> conversion_matrix() const override
+    {
+        auto matrix = ColorMatrix::from_rgb_scale_and_offset(1 - m_amount, 0);
+        matrix.set_offset(0, m_color.red() * m_amount);
+        matrix.set_offset(1, m_color.green() * m_amount);
+        matrix.set_offset(2, m_color.blue() * m_amount);
+        return matrix;
+    }
+
 private:
     Gfx::Color m_color;
 };
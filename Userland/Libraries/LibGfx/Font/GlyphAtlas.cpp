@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BuiltinWrappers.h>
+#include <LibGfx/Font/GlyphAtlas.h>
+
+namespace Gfx {
+
+GlyphAtlas::GlyphAtlas(int glyph_height)
+{
+    // Note: Room for about 64 glyphs per page, but nothing too tiny or huge.
+    auto page_size = 8 * max(glyph_height, 1);
+    m_page_size = clamp(1 << (32 - count_leading_zeroes(static_cast<u32>(page_size - 1))), 128, 1024);
+}
+
+ErrorOr<GlyphAtlas::Entry> GlyphAtlas::add(Bitmap const& glyph)
+{
+    VERIFY(glyph.format() == BitmapFormat::BGRA8888 && glyph.scale() == 1);
+    auto size = glyph.size();
+
+    if (size.width() > m_page_size || size.height() > m_page_size) {
+        auto bitmap = TRY(Bitmap::create(BitmapFormat::BGRA8888, size));
+        for (int y = 0; y < size.height(); ++y)
+            memcpy(bitmap->scanline(y), glyph.scanline(y), size.width() * sizeof(ARGB32));
+        return Entry { move(bitmap), { {}, size } };
+    }
+
+    // Note: Only the last page ever has room left, earlier pages are as full as they're going to get.
+    Page* page = m_pages.is_empty() ? nullptr : &m_pages.last();
+    if (page && page->row_start.x() + size.width() > m_page_size) {
+        page->row_start = { 0, page->row_start.y() + page->row_height };
+        page->row_height = 0;
+    }
+    if (!page || page->row_start.y() + size.height() > m_page_size) {
+        auto bitmap = TRY(Bitmap::create(BitmapFormat::BGRA8888, { m_page_size, m_page_size }));
+        TRY(m_pages.try_append({ move(bitmap), {}, 0 }));
+        page = &m_pages.last();
+    }
+
+    IntRect rect { page->row_start, size };
+    for (int y = 0; y < size.height(); ++y)
+        memcpy(page->bitmap->scanline(rect.y() + y) + rect.x(), glyph.scanline(y), size.width() * sizeof(ARGB32));
+
+    page->row_start.translate_by(size.width(), 0);
+    page->row_height = max(page->row_height, size.height());
+    return Entry { page->bitmap, rect };
+}
+
+}
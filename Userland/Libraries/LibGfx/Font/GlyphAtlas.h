@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Vector.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Rect.h>
+
+namespace Gfx {
+
+// Keeps rasterized glyphs packed together in a few large bitmaps ("pages"), rather than in a bitmap of their own each.
+// Glyphs are put next to each other in rows, and a row is as tall as the tallest glyph in it, which works out well
+// enough since all glyphs of a font at one size are roughly as tall as each other.
+class GlyphAtlas {
+public:
+    struct Entry {
+        NonnullRefPtr<Bitmap> page;
+        IntRect rect;
+    };
+
+    // `glyph_height` is used to decide how large the pages should be.
+    explicit GlyphAtlas(int glyph_height);
+
+    // Copies `glyph` into one of the pages. Glyphs that don't fit into a page get a bitmap of their own.
+    ErrorOr<Entry> add(Bitmap const& glyph);
+
+    size_t page_count() const { return m_pages.size(); }
+
+private:
+    struct Page {
+        NonnullRefPtr<Bitmap> bitmap;
+        IntPoint row_start;
+        int row_height { 0 };
+    };
+
+    int m_page_size { 0 };
+    Vector<Page> m_pages;
+};
+
+}
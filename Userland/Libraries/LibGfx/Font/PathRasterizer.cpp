@@ -4,17 +4,29 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
+#include <AK/SIMDMath.h>
 #include <LibGfx/Font/PathRasterizer.h>
 
+// See the comment in SIMDMath.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
 namespace Gfx {
 
 PathRasterizer::PathRasterizer(Gfx::IntSize size)
-    : m_size(size)
+    : PathRasterizer(Gfx::IntRect { {}, size })
 {
-    m_data.resize(m_size.width() * m_size.height());
-    for (int i = 0; i < m_size.width() * m_size.height(); i++) {
-        m_data[i] = 0.0f;
-    }
+}
+
+PathRasterizer::PathRasterizer(Gfx::IntRect const& bounds)
+    : m_bounds(bounds)
+    , m_row_stride(bounds.width() + 4)
+{
+    m_data.resize(m_row_stride * m_bounds.height());
+    m_row_extents.resize(m_bounds.height());
+    m_coverage.resize(m_bounds.width() + 4);
 }
 
 void PathRasterizer::draw_path(Gfx::Path& path)
@@ -25,119 +37,177 @@ void PathRasterizer::draw_path(Gfx::Path& path)
 
 RefPtr<Gfx::Bitmap> PathRasterizer::accumulate()
 {
-    auto bitmap_or_error = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, m_size);
+    auto bitmap_or_error = Gfx::Bitmap::create(Gfx::BitmapFormat::BGRA8888, m_bounds.size());
     if (bitmap_or_error.is_error())
         return {};
     auto bitmap = bitmap_or_error.release_value_but_fixme_should_propagate_errors();
-    Color base_color = Color::from_rgb(0xffffff);
-    for (int y = 0; y < m_size.height(); y++) {
-        float accumulator = 0.0;
-        for (int x = 0; x < m_size.width(); x++) {
-            accumulator += m_data[y * m_size.width() + x];
-            float value = accumulator;
-            if (value < 0.0f) {
-                value = -value;
-            }
-            if (value > 1.0f) {
-                value = 1.0;
-            }
-            u8 alpha = value * 255.0f;
-            bitmap->set_pixel(x, y, base_color.with_alpha(alpha));
-        }
-    }
+    bitmap->fill(Color(255, 255, 255, 0));
+    for_each_covered_span(Painter::WindingRule::Nonzero, [&](int y, int x, Span<u8 const> coverage) {
+        auto* scanline = bitmap->scanline(y - m_bounds.y()) + (x - m_bounds.x());
+        for (size_t i = 0; i < coverage.size(); ++i)
+            scanline[i] = 0xffffff | (coverage[i] << 24);
+    });
     return bitmap;
 }
 
-void PathRasterizer::draw_line(Gfx::FloatPoint p0, Gfx::FloatPoint p1)
+void PathRasterizer::for_each_covered_span(Painter::WindingRule winding_rule, SpanCallback callback)
 {
-    // FIXME: Shift x and y according to dy/dx
-    if (p0.x() < 0.0f) {
-        p0.set_x(roundf(p0.x()));
-    }
-    if (p0.y() < 0.0f) {
-        p0.set_y(roundf(p0.y()));
-    }
-    if (p1.x() < 0.0f) {
-        p1.set_x(roundf(p1.x()));
-    }
-    if (p1.y() < 0.0f) {
-        p1.set_y(roundf(p1.y()));
-    }
+    int const width = m_bounds.width();
+    for (int y = 0; y < m_bounds.height(); ++y) {
+        auto& extent = m_row_extents[y];
+        if (extent.min_x > extent.max_x)
+            continue;
+
+        float* row = &m_data[y * m_row_stride];
+        int const start = extent.min_x;
+        int end = min(extent.max_x + 1, width);
+        if (start < end) {
+            // Note: This sums up four cells at a time, so it may read a few cells past `end`. The results for those are
+            //       never used though.
+            float accumulator = 0.0f;
+            for (int x = start; x < end; x += 4) {
+                AK::SIMD::f32x4 cells;
+                memcpy(&cells, row + x, sizeof(cells));
+                cells += AK::SIMD::f32x4 { 0, cells[0], cells[1], cells[2] };
+                cells += AK::SIMD::f32x4 { 0, 0, cells[0], cells[1] };
+                auto sums = cells + accumulator;
+                accumulator = sums[3];
+
+                auto values = sums < 0.0f ? -sums : sums;
+                if (winding_rule == Painter::WindingRule::EvenOdd) {
+                    values -= 2.0f * AK::SIMD::floor_int_range(values * 0.5f);
+                    values = values > 1.0f ? 2.0f - values : values;
+                }
+                auto coverage = AK::SIMD::to_u8x4(AK::SIMD::clamp(values, 0.0f, 1.0f) * 255.0f + 0.5f);
+                memcpy(&m_coverage[x - start], &coverage, sizeof(coverage));
+            }
 
-    if (!(p0.x() >= 0.0f && p0.y() >= 0.0f && p0.x() <= m_size.width() && p0.y() <= m_size.height())) {
-        dbgln("!P0({},{})", p0.x(), p0.y());
-        return;
-    }
+            // Note: Past the last cell that a line touched, the coverage stays the same. That is no coverage at all for
+            //       closed paths, but paths that aren't closed may cover the rest of the row.
+            if (auto last_coverage = m_coverage[end - start - 1]; last_coverage != 0 && end < width) {
+                memset(&m_coverage[end - start], last_coverage, width - end);
+                end = width;
+            }
 
-    if (!(p1.x() >= 0.0f && p1.y() >= 0.0f && p1.x() <= m_size.width() && p1.y() <= m_size.height())) {
-        dbgln("!P1({},{})", p1.x(), p1.y());
-        return;
+            callback(m_bounds.y() + y, m_bounds.x() + start, m_coverage.span().slice(0, end - start));
+        }
+
+        memset(row + extent.min_x, 0, (extent.max_x - extent.min_x + 1) * sizeof(float));
+        extent = {};
     }
+}
 
-    VERIFY(p0.x() >= 0.0f && p0.y() >= 0.0f && p0.x() <= m_size.width() && p0.y() <= m_size.height());
-    VERIFY(p1.x() >= 0.0f && p1.y() >= 0.0f && p1.x() <= m_size.width() && p1.y() <= m_size.height());
+void PathRasterizer::draw_line(Gfx::FloatPoint p0, Gfx::FloatPoint p1)
+{
+    p0.translate_by(-m_bounds.x(), -m_bounds.y());
+    p1.translate_by(-m_bounds.x(), -m_bounds.y());
 
     // If we're on the same Y, there's no need to draw
-    if (p0.y() == p1.y()) {
+    if (p0.y() == p1.y())
         return;
-    }
 
     float direction = -1.0;
     if (p1.y() < p0.y()) {
         direction = 1.0;
-        auto tmp = p0;
-        p0 = p1;
-        p1 = tmp;
+        swap(p0, p1);
+    }
+
+    // Note: The parts of a line above and below the bounds don't affect any of the rows in between, so they are cut off.
+    float const height = m_bounds.height();
+    if (p1.y() <= 0.0f || p0.y() >= height)
+        return;
+    float dxdy = (p1.x() - p0.x()) / (p1.y() - p0.y());
+    if (p0.y() < 0.0f)
+        p0 = { p0.x() - p0.y() * dxdy, 0.0f };
+    if (p1.y() > height)
+        p1 = { p1.x() - (p1.y() - height) * dxdy, height };
+
+    // Note: A line left of the bounds covers all pixels to its right, just like a line on the left edge would, and a line
+    //       right of the bounds covers none of them, just like one on the right edge. So lines are split where they cross
+    //       an edge, and the parts outside are moved onto that edge.
+    float const width = m_bounds.width();
+    Vector<Gfx::FloatPoint, 4> points;
+    points.append(p0);
+    auto add_crossing = [&](float edge_x) {
+        if ((p0.x() - edge_x) * (p1.x() - edge_x) < 0.0f)
+            points.append({ edge_x, p0.y() + (edge_x - p0.x()) / dxdy });
+    };
+    if (p0.x() < p1.x()) {
+        add_crossing(0.0f);
+        add_crossing(width);
+    } else {
+        add_crossing(width);
+        add_crossing(0.0f);
+    }
+    points.append(p1);
+
+    for (size_t i = 0; i + 1 < points.size(); ++i) {
+        auto from = points[i];
+        auto to = points[i + 1];
+        if (from.y() >= to.y())
+            continue;
+        from.set_x(clamp(from.x(), 0.0f, width));
+        to.set_x(clamp(to.x(), 0.0f, width));
+        accumulate_line(from, to, direction);
     }
+}
 
+void PathRasterizer::accumulate_line(Gfx::FloatPoint p0, Gfx::FloatPoint p1, float direction)
+{
+    float const width = m_bounds.width();
     float dxdy = (p1.x() - p0.x()) / (p1.y() - p0.y());
-    u32 y0 = floorf(p0.y());
-    u32 y1 = ceilf(p1.y());
+    int y0 = floorf(p0.y());
+    int y1 = min(static_cast<int>(ceilf(p1.y())), m_bounds.height());
     float x_cur = p0.x();
 
-    for (u32 y = y0; y < y1; y++) {
-        u32 line_offset = m_size.width() * y;
+    for (int y = max(y0, 0); y < y1; y++) {
+        float* row = &m_data[y * m_row_stride];
 
-        float dy = min(y + 1.0f, p1.y()) - max((float)y, p0.y());
+        float dy = min(y + 1.0f, p1.y()) - max(static_cast<float>(y), p0.y());
         float directed_dy = dy * direction;
-        float x_next = x_cur + dy * dxdy;
-        if (x_next < 0.0f) {
-            x_next = 0.0f;
-        }
-        float x0 = x_cur;
-        float x1 = x_next;
-        if (x1 < x0) {
-            x1 = x_cur;
-            x0 = x_next;
-        }
-        float x0_floor = floorf(x0);
-        float x1_ceil = ceilf(x1);
-        u32 x0i = x0_floor;
-
-        if (x1_ceil <= x0_floor + 1.0f) {
+        float x_next = clamp(x_cur + dy * dxdy, 0.0f, width);
+        float x0 = min(x_cur, x_next);
+        float x1 = max(x_cur, x_next);
+        int x0i = x0;
+        float x0_floor = x0i;
+        int x1i = ceilf(x1);
+
+        if (x1i <= x0i + 1) {
             // If x0 and x1 are within the same pixel, then area to the right is (1 - (mid(x0, x1) - x0_floor)) * dy
             float area = ((x0 + x1) * 0.5f) - x0_floor;
-            m_data[line_offset + x0i] += directed_dy * (1.0f - area);
-            m_data[line_offset + x0i + 1] += directed_dy * area;
+            row[x0i] += directed_dy * (1.0f - area);
+            row[x0i + 1] += directed_dy * area;
+            x1i = x0i + 1;
         } else {
-            float dydx = 1.0f / dxdy;
-            if (dydx < 0)
-                dydx = -dydx;
-
-            float x0_right = 1.0f - (x0 - x0_floor);
-            u32 x1_floor_i = floorf(x1);
-            float area_upto_here = 0.5f * x0_right * x0_right * dydx;
-            m_data[line_offset + x0i] += direction * area_upto_here;
-            for (u32 x = x0i + 1; x < x1_floor_i; x++) {
-                m_data[line_offset + x] += direction * dydx;
-                area_upto_here += dydx;
+            // Note: The line crosses several pixels, and covers a triangle of the first and the last one, and a
+            //       trapezoid of each of the pixels in between.
+            float dydx = 1.0f / (x1 - x0);
+            float x0_fraction = x0 - x0_floor;
+            float first_area = 0.5f * dydx * (1.0f - x0_fraction) * (1.0f - x0_fraction);
+            float x1_fraction = x1 - x1i + 1.0f;
+            float last_area = 0.5f * dydx * x1_fraction * x1_fraction;
+            row[x0i] += directed_dy * first_area;
+            if (x1i == x0i + 2) {
+                row[x0i + 1] += directed_dy * (1.0f - first_area - last_area);
+            } else {
+                float area_upto_here = dydx * (1.5f - x0_fraction);
+                row[x0i + 1] += directed_dy * (area_upto_here - first_area);
+                for (int x = x0i + 2; x < x1i - 1; x++)
+                    row[x] += directed_dy * dydx;
+                area_upto_here += (x1i - x0i - 3) * dydx;
+                row[x1i - 1] += directed_dy * (1.0f - area_upto_here - last_area);
             }
-            float remaining_area = (dy - area_upto_here);
-            m_data[line_offset + x1_floor_i] += direction * remaining_area;
+            row[x1i] += directed_dy * last_area;
         }
 
+        auto& extent = m_row_extents[y];
+        extent.min_x = min(extent.min_x, x0i);
+        extent.max_x = max(extent.max_x, x1i);
+
         x_cur = x_next;
     }
 }
 
 }
+
+#pragma GCC diagnostic pop
@@ -6,23 +6,51 @@
 
 #pragma once
 
+#include <AK/Function.h>
+#include <AK/NumericLimits.h>
+#include <AK/Span.h>
 #include <AK/Vector.h>
 #include <LibGfx/Bitmap.h>
+#include <LibGfx/Painter.h>
 #include <LibGfx/Path.h>
 
 namespace Gfx {
 
+// Computes how much of each pixel is covered by a path, by accumulating signed areas along scanlines (like font-rs does).
+// Only the part of the path that lies within the rasterizer's bounds is rasterized, so a large path can be split into
+// horizontal bands, each with a rasterizer of its own.
 class PathRasterizer {
 public:
     PathRasterizer(Gfx::IntSize);
+    explicit PathRasterizer(Gfx::IntRect const& bounds);
+
     void draw_path(Gfx::Path&);
+    void draw_line(Gfx::FloatPoint, Gfx::FloatPoint);
+
     RefPtr<Gfx::Bitmap> accumulate();
 
+    // Calls `callback` for each row with covered pixels, with the coverage of the pixels from (x, y) on to the right.
+    // Rows are only visited from their first to their last covered pixel. This resets the rasterizer.
+    using SpanCallback = Function<void(int y, int x, Span<u8 const> coverage)>;
+    void for_each_covered_span(Painter::WindingRule, SpanCallback);
+
 private:
-    void draw_line(Gfx::FloatPoint, Gfx::FloatPoint);
+    // Adds a line that lies within [0, width] x [0, height] to the cells, with p0 above p1.
+    void accumulate_line(Gfx::FloatPoint p0, Gfx::FloatPoint p1, float direction);
 
-    Gfx::IntSize m_size;
+    Gfx::IntRect m_bounds;
+    // Each row has two cells more than there are pixels, for lines on (or beyond) the right edge, and a few to spare so
+    // that the cells can always be summed up four at a time.
+    size_t m_row_stride { 0 };
     Vector<float> m_data;
+
+    // The first and last cell that a line has touched in each row.
+    struct RowExtent {
+        int min_x { NumericLimits<int>::max() };
+        int max_x { NumericLimits<int>::min() };
+    };
+    Vector<RowExtent> m_row_extents;
+    Vector<u8> m_coverage;
 };
 
 }
@@ -7,6 +7,7 @@
 #include <AK/Utf32View.h>
 #include <AK/Utf8View.h>
 #include <LibGfx/Font/ScaledFont.h>
+#include <math.h>
 
 namespace Gfx {
 
@@ -14,6 +15,7 @@ ScaledFont::ScaledFont(NonnullRefPtr<VectorFont> font, float point_width, float
     : m_font(move(font))
     , m_point_width(point_width)
     , m_point_height(point_height)
+    , m_glyph_atlas(ceilf(pixel_size()))
 {
     float units_per_em = m_font->units_per_em();
     m_x_scale = (point_width * dpi_x) / (POINTS_PER_INCH * units_per_em);
@@ -32,10 +34,26 @@ ScaledFont::ScaledFont(NonnullRefPtr<VectorFont> font, float point_width, float
     };
 }
 
-float ScaledFont::width(StringView view) const { return unicode_view_width(Utf8View(view)); }
-float ScaledFont::width(Utf8View const& view) const { return unicode_view_width(view); }
+float ScaledFont::width(StringView view) const { return utf8_view_width(Utf8View(view)); }
+float ScaledFont::width(Utf8View const& view) const { return utf8_view_width(view); }
 float ScaledFont::width(Utf32View const& view) const { return unicode_view_width(view); }
 
+float ScaledFont::utf8_view_width(Utf8View const& view) const
+{
+    auto string = view.as_string();
+    auto hash = string.hash();
+    auto it = m_cached_text_widths.find(hash, [&](auto& entry) { return entry.key == string; });
+    if (it != m_cached_text_widths.end())
+        return it->value;
+
+    auto width = unicode_view_width(view);
+    // Note: Forgetting everything every now and then is much cheaper than keeping track of what was used recently.
+    if (m_cached_text_widths.size() >= max_cached_text_widths)
+        m_cached_text_widths.clear();
+    m_cached_text_widths.set(string, width);
+    return width;
+}
+
 template<typename T>
 ALWAYS_INLINE float ScaledFont::unicode_view_width(T const& view) const
 {
@@ -60,16 +78,30 @@ ALWAYS_INLINE float ScaledFont::unicode_view_width(T const& view) const
     return longest_width;
 }
 
-RefPtr<Gfx::Bitmap> ScaledFont::rasterize_glyph(u32 glyph_id, GlyphSubpixelOffset subpixel_offset) const
+ScaledGlyphMetrics ScaledFont::glyph_metrics(u32 glyph_id) const
+{
+    return m_cached_glyph_metrics.ensure(glyph_id, [&] { return m_font->glyph_metrics(glyph_id, m_x_scale, m_y_scale); });
+}
+
+Optional<GlyphAtlas::Entry> ScaledFont::rasterize_glyph(u32 glyph_id, GlyphSubpixelOffset subpixel_offset) const
 {
     GlyphIndexWithSubpixelOffset index { glyph_id, subpixel_offset };
-    auto glyph_iterator = m_cached_glyph_bitmaps.find(index);
-    if (glyph_iterator != m_cached_glyph_bitmaps.end())
+    auto glyph_iterator = m_cached_glyphs.find(index);
+    if (glyph_iterator != m_cached_glyphs.end())
         return glyph_iterator->value;
 
-    auto glyph_bitmap = m_font->rasterize_glyph(glyph_id, m_x_scale, m_y_scale, subpixel_offset);
-    m_cached_glyph_bitmaps.set(index, glyph_bitmap);
-    return glyph_bitmap;
+    Optional<GlyphAtlas::Entry> entry;
+    if (auto glyph_bitmap = m_font->rasterize_glyph(glyph_id, m_x_scale, m_y_scale, subpixel_offset)) {
+        auto entry_or_error = m_glyph_atlas.add(*glyph_bitmap);
+        if (entry_or_error.is_error()) {
+            auto rect = glyph_bitmap->rect();
+            entry = GlyphAtlas::Entry { glyph_bitmap.release_nonnull(), rect };
+        } else {
+            entry = entry_or_error.release_value();
+        }
+    }
+    m_cached_glyphs.set(index, entry);
+    return entry;
 }
 
 Gfx::Glyph ScaledFont::glyph(u32 code_point) const
@@ -80,9 +112,11 @@ Gfx::Glyph ScaledFont::glyph(u32 code_point) const
 Gfx::Glyph ScaledFont::glyph(u32 code_point, GlyphSubpixelOffset subpixel_offset) const
 {
     auto id = glyph_id_for_code_point(code_point);
-    auto bitmap = rasterize_glyph(id, subpixel_offset);
+    auto entry = rasterize_glyph(id, subpixel_offset);
     auto metrics = glyph_metrics(id);
-    return Gfx::Glyph(bitmap, metrics.left_side_bearing, metrics.advance_width, metrics.ascender);
+    if (!entry.has_value())
+        return Gfx::Glyph(RefPtr<Gfx::Bitmap> {}, metrics.left_side_bearing, metrics.advance_width, metrics.ascender);
+    return Gfx::Glyph(entry->page, entry->rect, metrics.left_side_bearing, metrics.advance_width, metrics.ascender);
 }
 
 float ScaledFont::glyph_left_bearing(u32 code_point) const
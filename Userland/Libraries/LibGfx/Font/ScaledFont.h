@@ -7,8 +7,10 @@
 #pragma once
 
 #include <AK/HashMap.h>
+#include <AK/Optional.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Font/Font.h>
+#include <LibGfx/Font/GlyphAtlas.h>
 #include <LibGfx/Font/VectorFont.h>
 
 #define POINTS_PER_INCH 72.0f
@@ -28,8 +30,9 @@ public:
     ScaledFont(NonnullRefPtr<VectorFont>, float point_width, float point_height, unsigned dpi_x = DEFAULT_DPI, unsigned dpi_y = DEFAULT_DPI);
     u32 glyph_id_for_code_point(u32 code_point) const { return m_font->glyph_id_for_code_point(code_point); }
     ScaledFontMetrics metrics() const { return m_font->metrics(m_x_scale, m_y_scale); }
-    ScaledGlyphMetrics glyph_metrics(u32 glyph_id) const { return m_font->glyph_metrics(glyph_id, m_x_scale, m_y_scale); }
-    RefPtr<Gfx::Bitmap> rasterize_glyph(u32 glyph_id, GlyphSubpixelOffset) const;
+    ScaledGlyphMetrics glyph_metrics(u32 glyph_id) const;
+    // The glyph's bitmap is part of a glyph atlas, which is shared with all other glyphs in this font.
+    Optional<GlyphAtlas::Entry> rasterize_glyph(u32 glyph_id, GlyphSubpixelOffset) const;
 
     // ^Gfx::Font
     virtual NonnullRefPtr<Font> clone() const override { return MUST(try_clone()); } // FIXME: clone() should not need to be implemented
@@ -73,11 +76,18 @@ private:
     float m_y_scale { 0.0f };
     float m_point_width { 0.0f };
     float m_point_height { 0.0f };
-    mutable HashMap<GlyphIndexWithSubpixelOffset, RefPtr<Gfx::Bitmap>> m_cached_glyph_bitmaps;
+    mutable GlyphAtlas m_glyph_atlas;
+    mutable HashMap<GlyphIndexWithSubpixelOffset, Optional<GlyphAtlas::Entry>> m_cached_glyphs;
+    mutable HashMap<u32, ScaledGlyphMetrics> m_cached_glyph_metrics;
+    // Widths of strings that were measured before, since layout tends to measure the same words over and over again.
+    mutable HashMap<DeprecatedString, float> m_cached_text_widths;
     Gfx::FontPixelMetrics m_pixel_metrics;
 
+    static constexpr size_t max_cached_text_widths = 1024;
+
     template<typename T>
     float unicode_view_width(T const& view) const;
+    float utf8_view_width(Utf8View const&) const;
 };
 
 }
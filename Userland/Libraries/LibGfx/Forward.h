@@ -15,6 +15,8 @@ class Color;
 template<typename T>
 class DisjointRectSet;
 
+class DisplayList;
+class DisplayListPlayer;
 class Emoji;
 class Font;
 class GlyphBitmap;
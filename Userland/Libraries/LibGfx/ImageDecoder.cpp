@@ -6,6 +6,7 @@
 
 #include <AK/LexicalPath.h>
 #include <LibGfx/BMPLoader.h>
+#include <LibGfx/BoxDownscaler.h>
 #include <LibGfx/DDSLoader.h>
 #include <LibGfx/GIFLoader.h>
 #include <LibGfx/ICOLoader.h>
@@ -91,6 +92,24 @@ RefPtr<ImageDecoder> ImageDecoder::try_create_for_raw_bytes(ReadonlyBytes bytes,
     return adopt_ref_if_nonnull(new (nothrow) ImageDecoder(plugin.release_nonnull()));
 }
 
+ErrorOr<ImageFrameDescriptor> ImageDecoderPlugin::downscaled_frame(size_t index, IntSize minimum_size)
+{
+    auto descriptor = TRY(frame(index));
+    auto factor = downscale_factor_for(descriptor.image->size(), minimum_size);
+    if (factor > 1)
+        descriptor.image = TRY(BoxDownscaler::downscale(*descriptor.image, factor));
+    return descriptor;
+}
+
+int ImageDecoderPlugin::downscale_factor_for(IntSize image_size, IntSize minimum_size)
+{
+    for (int factor = 8; factor > 1; factor /= 2) {
+        if (ceil_div(image_size.width(), factor) >= minimum_size.width() && ceil_div(image_size.height(), factor) >= minimum_size.height())
+            return factor;
+    }
+    return 1;
+}
+
 ImageDecoder::ImageDecoder(NonnullOwnPtr<ImageDecoderPlugin> plugin)
     : m_plugin(move(plugin))
 {
@@ -42,6 +42,18 @@ public:
     virtual ErrorOr<ImageFrameDescriptor> frame(size_t index) = 0;
     virtual ErrorOr<Optional<ReadonlyBytes>> icc_data() = 0;
 
+    // Decodes the first frame from data whose end may still be missing, e.g. because it is still being downloaded.
+    // Whatever has not arrived yet is left transparent, or is filled in from what did arrive (like interlaced passes).
+    virtual ErrorOr<ImageFrameDescriptor> partial_frame() { return Error::from_string_literal("ImageDecoderPlugin: Partial decoding is not supported"); }
+
+    // Decodes a frame at 1/2, 1/4 or 1/8 of the image's size, for images that are going to be shown at a much smaller
+    // size anyway. The frame is as small as it can be while still being at least `minimum_size` large (or at its full
+    // size if that's not possible). By default, the frame is decoded at its full size and downscaled afterwards.
+    virtual ErrorOr<ImageFrameDescriptor> downscaled_frame(size_t index, IntSize minimum_size);
+
+    // How much the image can be downscaled for downscaled_frame(): 1, 2, 4 or 8.
+    static int downscale_factor_for(IntSize image_size, IntSize minimum_size);
+
 protected:
     ImageDecoderPlugin() = default;
 };
@@ -61,6 +73,8 @@ public:
     size_t frame_count() const { return m_plugin->frame_count(); }
     ErrorOr<ImageFrameDescriptor> frame(size_t index) const { return m_plugin->frame(index); }
     ErrorOr<Optional<ReadonlyBytes>> icc_data() const { return m_plugin->icc_data(); }
+    ErrorOr<ImageFrameDescriptor> partial_frame() const { return m_plugin->partial_frame(); }
+    ErrorOr<ImageFrameDescriptor> downscaled_frame(size_t index, IntSize minimum_size) const { return m_plugin->downscaled_frame(index, minimum_size); }
 
 private:
     explicit ImageDecoder(NonnullOwnPtr<ImageDecoderPlugin>);
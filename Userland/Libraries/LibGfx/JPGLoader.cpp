@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BuiltinWrappers.h>
 #include <AK/Debug.h>
 #include <AK/Endian.h>
 #include <AK/Error.h>
@@ -11,10 +12,18 @@
 #include <AK/HashMap.h>
 #include <AK/Math.h>
 #include <AK/MemoryStream.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
+#include <AK/SIMDMath.h>
 #include <AK/String.h>
 #include <AK/Try.h>
 #include <AK/Vector.h>
 #include <LibGfx/JPGLoader.h>
+#include <LibThreading/ThreadPool.h>
+
+// See the comment in SIMDMath.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
 
 #define JPG_INVALID 0X0000
 
@@ -154,18 +163,25 @@ struct StartOfFrame {
     u16 width { 0 };
 };
 
+// Huffman codes that are at most this long are decoded with a single table lookup.
+static constexpr u8 huffman_lookup_bits = 9;
+
 struct HuffmanTableSpec {
     u8 type { 0 };
     u8 destination_id { 0 };
     u8 code_counts[16] = { 0 };
     Vector<u8> symbols;
     Vector<u16> codes;
+    // Indexed by the next `huffman_lookup_bits` bits of the stream. Non-zero entries hold the length of the code those
+    // bits start with in the high byte, and its symbol in the low byte.
+    u16 lookup_table[1 << huffman_lookup_bits] = { 0 };
 };
 
 struct HuffmanStreamState {
-    Vector<u8> stream;
+    ReadonlyBytes stream;
     u8 bit_offset { 0 };
     size_t byte_offset { 0 };
+    i32 previous_dc_values[3] = { 0 };
 };
 
 struct ICCMultiChunkState {
@@ -196,31 +212,91 @@ struct JPGLoadingContext {
     u16 dc_reset_interval { 0 };
     HashMap<u8, HuffmanTableSpec> dc_tables;
     HashMap<u8, HuffmanTableSpec> ac_tables;
-    HuffmanStreamState huffman_stream;
-    i32 previous_dc_values[3] = { 0 };
+    Vector<u8> huffman_data;
+    // Where the restart markers are in `huffman_data`.
+    Vector<size_t> restart_marker_offsets;
     MacroblockMeta mblock_meta;
+    // The width and height in pixels that every block of 8x8 coefficients is decoded to: 8, or 4, 2 or 1 when the
+    // image is decoded at a fraction of its size.
+    u8 block_size { 8 };
     OwnPtr<FixedMemoryStream> stream;
+    JPGImageDecoderPlugin::UseThreadPool use_thread_pool { JPGImageDecoderPlugin::UseThreadPool::No };
 
     Optional<ICCMultiChunkState> icc_multi_chunk_state;
     Optional<ByteBuffer> icc_data;
 };
 
+// Calls `callback` for ranges that together cover [0, count), on the thread pool if the caller allowed that.
+static void for_each_range(JPGLoadingContext const& context, size_t count, size_t grain_size, Function<void(size_t begin, size_t end)> callback)
+{
+    if (context.use_thread_pool == JPGImageDecoderPlugin::UseThreadPool::Yes) {
+        Threading::ThreadPool::the().parallel_for(count, grain_size, move(callback));
+        return;
+    }
+    if (count > 0)
+        callback(0, count);
+}
+
 static void generate_huffman_codes(HuffmanTableSpec& table)
 {
     unsigned code = 0;
-    for (auto number_of_codes : table.code_counts) {
-        for (int i = 0; i < number_of_codes; i++)
-            table.codes.append(code++);
+    size_t code_cursor = 0;
+    for (u8 length = 1; length <= 16; length++) {
+        for (int i = 0; i < table.code_counts[length - 1]; i++) {
+            table.codes.append(code);
+            // Note: Broken tables can have codes that don't fit in their length, or several symbols for the same code.
+            //       Such codes are left to get_next_symbol(), and the first symbol wins, so lookups behave the same.
+            if (length <= huffman_lookup_bits && code < (1u << length) && code_cursor < table.symbols.size()) {
+                u16 const entry = (length << 8) | table.symbols[code_cursor];
+                unsigned const first_index = code << (huffman_lookup_bits - length);
+                unsigned const last_index = first_index + (1u << (huffman_lookup_bits - length));
+                for (unsigned index = first_index; index < last_index; index++) {
+                    if (table.lookup_table[index] == 0)
+                        table.lookup_table[index] = entry;
+                }
+            }
+            code++;
+            code_cursor++;
+        }
         code <<= 1;
     }
 }
 
+// Returns the next 16 bits of the stream without consuming them. Bits past the end of the stream are zero.
+static ALWAYS_INLINE u16 peek_huffman_bits(HuffmanStreamState const& hstream)
+{
+    auto byte_at = [&](size_t offset) -> u32 {
+        return offset < hstream.stream.size() ? hstream.stream[offset] : 0;
+    };
+    u32 const window = (byte_at(hstream.byte_offset) << 16) | (byte_at(hstream.byte_offset + 1) << 8) | byte_at(hstream.byte_offset + 2);
+    return (window >> (8 - hstream.bit_offset)) & 0xFFFF;
+}
+
+static ALWAYS_INLINE ErrorOr<void> skip_huffman_bits(HuffmanStreamState& hstream, size_t count)
+{
+    size_t const bit_position = hstream.byte_offset * 8 + hstream.bit_offset + count;
+    if (bit_position > hstream.stream.size() * 8) {
+        dbgln_if(JPG_DEBUG, "Huffman stream exhausted. This could be an error!");
+        return Error::from_string_literal("Huffman stream exhausted.");
+    }
+    hstream.byte_offset = bit_position / 8;
+    hstream.bit_offset = bit_position % 8;
+    return {};
+}
+
 static ErrorOr<size_t> read_huffman_bits(HuffmanStreamState& hstream, size_t count = 1)
 {
     if (count > (8 * sizeof(size_t))) {
         dbgln_if(JPG_DEBUG, "Can't read {} bits at once!", count);
         return Error::from_string_literal("Reading too much huffman bits at once");
     }
+    if (count == 0)
+        return 0;
+    if (count <= 16) {
+        size_t const value = peek_huffman_bits(hstream) >> (16 - count);
+        TRY(skip_huffman_bits(hstream, count));
+        return value;
+    }
     size_t value = 0;
     while (count--) {
         if (hstream.byte_offset >= hstream.stream.size()) {
@@ -241,6 +317,11 @@ static ErrorOr<size_t> read_huffman_bits(HuffmanStreamState& hstream, size_t cou
 
 static ErrorOr<u8> get_next_symbol(HuffmanStreamState& hstream, HuffmanTableSpec const& table)
 {
+    if (auto entry = table.lookup_table[peek_huffman_bits(hstream) >> (16 - huffman_lookup_bits)]; entry != 0) {
+        TRY(skip_huffman_bits(hstream, entry >> 8));
+        return entry & 0xFF;
+    }
+
     unsigned code = 0;
     size_t code_cursor = 0;
     for (int i = 0; i < 16; i++) { // Codes can't be longer than 16 bits.
@@ -284,7 +365,7 @@ static inline i32* get_component(Macroblock& block, unsigned component)
  * macroblocks that share the chrominance data. Next two iterations (assuming that
  * we are dealing with three components) will fill up the blocks with chroma data.
  */
-static ErrorOr<void> build_macroblocks(JPGLoadingContext& context, Vector<Macroblock>& macroblocks, u32 hcursor, u32 vcursor)
+static ErrorOr<void> build_macroblocks(JPGLoadingContext const& context, HuffmanStreamState& hstream, Vector<Macroblock>& macroblocks, u32 hcursor, u32 vcursor)
 {
     for (unsigned component_i = 0; component_i < context.component_count; component_i++) {
         auto& component = context.components[component_i];
@@ -303,21 +384,21 @@ static ErrorOr<void> build_macroblocks(JPGLoadingContext& context, Vector<Macrob
                 auto& ac_table = context.ac_tables.find(component.ac_destination_id)->value;
 
                 // For DC coefficients, symbol encodes the length of the coefficient.
-                auto dc_length = TRY(get_next_symbol(context.huffman_stream, dc_table));
+                auto dc_length = TRY(get_next_symbol(hstream, dc_table));
                 if (dc_length > 11) {
                     dbgln_if(JPG_DEBUG, "DC coefficient too long: {}!", dc_length);
                     return Error::from_string_literal("DC coefficient too long");
                 }
 
                 // DC coefficients are encoded as the difference between previous and current DC values.
-                i32 dc_diff = TRY(read_huffman_bits(context.huffman_stream, dc_length));
+                i32 dc_diff = TRY(read_huffman_bits(hstream, dc_length));
 
                 // If MSB in diff is 0, the difference is -ve. Otherwise +ve.
                 if (dc_length != 0 && dc_diff < (1 << (dc_length - 1)))
                     dc_diff -= (1 << dc_length) - 1;
 
                 auto select_component = get_component(block, component_i);
-                auto& previous_dc = context.previous_dc_values[component_i];
+                auto& previous_dc = hstream.previous_dc_values[component_i];
                 select_component[0] = previous_dc += dc_diff;
 
                 // Compute the AC coefficients.
@@ -325,7 +406,7 @@ static ErrorOr<void> build_macroblocks(JPGLoadingContext& context, Vector<Macrob
                     // AC symbols encode 2 pieces of information, the high 4 bits represent
                     // number of zeroes to be stuffed before reading the coefficient. Low 4
                     // bits represent the magnitude of the coefficient.
-                    auto ac_symbol = TRY(get_next_symbol(context.huffman_stream, ac_table));
+                    auto ac_symbol = TRY(get_next_symbol(hstream, ac_table));
                     if (ac_symbol == 0)
                         break;
 
@@ -345,7 +426,7 @@ static ErrorOr<void> build_macroblocks(JPGLoadingContext& context, Vector<Macrob
                     }
 
                     if (coeff_length != 0) {
-                        i32 ac_coefficient = TRY(read_huffman_bits(context.huffman_stream, coeff_length));
+                        i32 ac_coefficient = TRY(read_huffman_bits(hstream, coeff_length));
                         if (ac_coefficient < (1 << (coeff_length - 1)))
                             ac_coefficient -= (1 << coeff_length) - 1;
 
@@ -359,6 +440,59 @@ static ErrorOr<void> build_macroblocks(JPGLoadingContext& context, Vector<Macrob
     return {};
 }
 
+static u32 mcus_per_row(JPGLoadingContext const& context)
+{
+    return ceil_div(context.mblock_meta.hcount, static_cast<u32>(context.hsample_factor));
+}
+
+static u32 mcu_row_count(JPGLoadingContext const& context)
+{
+    return ceil_div(context.mblock_meta.vcount, static_cast<u32>(context.vsample_factor));
+}
+
+static bool is_restart_mcu(JPGLoadingContext const& context, u32 hcursor, u32 vcursor)
+{
+    u32 i = vcursor * context.mblock_meta.hpadded_count + hcursor;
+    return context.dc_reset_interval > 0 && i % context.dc_reset_interval == 0;
+}
+
+// Decodes the MCUs from `first_mcu` up to (but not including) `end_mcu`, counting in the order they're stored in.
+static ErrorOr<void> decode_mcus(JPGLoadingContext const& context, HuffmanStreamState& hstream, Vector<Macroblock>& macroblocks, u32 first_mcu, u32 end_mcu)
+{
+    u32 const mcus_in_a_row = mcus_per_row(context);
+    for (u32 mcu = first_mcu; mcu < end_mcu; mcu++) {
+        u32 const vcursor = (mcu / mcus_in_a_row) * context.vsample_factor;
+        u32 const hcursor = (mcu % mcus_in_a_row) * context.hsample_factor;
+        if (is_restart_mcu(context, hcursor, vcursor)) {
+            hstream.previous_dc_values[0] = 0;
+            hstream.previous_dc_values[1] = 0;
+            hstream.previous_dc_values[2] = 0;
+
+            // Restart markers are stored in byte boundaries. Advance the huffman stream cursor to
+            //  the 0th bit of the next byte.
+            if (hstream.byte_offset < hstream.stream.size()) {
+                if (hstream.bit_offset > 0) {
+                    hstream.bit_offset = 0;
+                    hstream.byte_offset++;
+                }
+
+                // Skip the restart marker (RSTn).
+                hstream.byte_offset++;
+            }
+        }
+
+        if (auto result = build_macroblocks(context, hstream, macroblocks, hcursor, vcursor); result.is_error()) {
+            if constexpr (JPG_DEBUG) {
+                dbgln("Failed to build Macroblock {}", vcursor * context.mblock_meta.hpadded_count + hcursor);
+                dbgln("Huffman stream byte offset {}", hstream.byte_offset);
+                dbgln("Huffman stream bit offset {}", hstream.bit_offset);
+            }
+            return result.release_error();
+        }
+    }
+    return {};
+}
+
 static ErrorOr<Vector<Macroblock>> decode_huffman_stream(JPGLoadingContext& context)
 {
     Vector<Macroblock> macroblocks;
@@ -379,40 +513,41 @@ static ErrorOr<Vector<Macroblock>> decode_huffman_stream(JPGLoadingContext& cont
     for (auto it = context.ac_tables.begin(); it != context.ac_tables.end(); ++it)
         generate_huffman_codes(it->value);
 
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            u32 i = vcursor * context.mblock_meta.hpadded_count + hcursor;
-            if (context.dc_reset_interval > 0) {
-                if (i % context.dc_reset_interval == 0) {
-                    context.previous_dc_values[0] = 0;
-                    context.previous_dc_values[1] = 0;
-                    context.previous_dc_values[2] = 0;
-
-                    // Restart markers are stored in byte boundaries. Advance the huffman stream cursor to
-                    //  the 0th bit of the next byte.
-                    if (context.huffman_stream.byte_offset < context.huffman_stream.stream.size()) {
-                        if (context.huffman_stream.bit_offset > 0) {
-                            context.huffman_stream.bit_offset = 0;
-                            context.huffman_stream.byte_offset++;
-                        }
-
-                        // Skip the restart marker (RSTn).
-                        context.huffman_stream.byte_offset++;
-                    }
-                }
-            }
+    u32 const mcus_in_a_row = mcus_per_row(context);
+    u32 const mcu_count = mcus_in_a_row * mcu_row_count(context);
 
-            if (auto result = build_macroblocks(context, macroblocks, hcursor, vcursor); result.is_error()) {
-                if constexpr (JPG_DEBUG) {
-                    dbgln("Failed to build Macroblock {}", i);
-                    dbgln("Huffman stream byte offset {}", context.huffman_stream.byte_offset);
-                    dbgln("Huffman stream bit offset {}", context.huffman_stream.bit_offset);
-                }
-                return result.release_error();
-            }
+    // Every restart interval starts right after its restart marker, so the intervals don't depend on each other and
+    // can be decoded in parallel. The first MCU always counts as a restart, but there's no marker in front of it.
+    Vector<u32> restart_mcus;
+    if (context.dc_reset_interval > 0) {
+        for (u32 mcu = 0; mcu < mcu_count; mcu++) {
+            if (is_restart_mcu(context, (mcu % mcus_in_a_row) * context.hsample_factor, (mcu / mcus_in_a_row) * context.vsample_factor))
+                TRY(restart_mcus.try_append(mcu));
         }
     }
 
+    // Note: If any restart markers are missing, the intervals can't be told apart, so the whole stream is decoded in one go.
+    if (restart_mcus.size() < 2 || context.restart_marker_offsets.size() < restart_mcus.size() - 1) {
+        HuffmanStreamState hstream { .stream = context.huffman_data.span() };
+        TRY(decode_mcus(context, hstream, macroblocks, 0, mcu_count));
+        return macroblocks;
+    }
+
+    Vector<Optional<Error>> errors;
+    TRY(errors.try_resize(restart_mcus.size()));
+    for_each_range(context, restart_mcus.size(), 1, [&](size_t begin, size_t end) {
+        HuffmanStreamState hstream { .stream = context.huffman_data.span() };
+        if (begin > 0)
+            hstream.byte_offset = context.restart_marker_offsets[begin - 1];
+        u32 const end_mcu = end < restart_mcus.size() ? restart_mcus[end] : mcu_count;
+        if (auto result = decode_mcus(context, hstream, macroblocks, restart_mcus[begin], end_mcu); result.is_error())
+            errors[begin] = result.release_error();
+    });
+
+    for (auto& error : errors) {
+        if (error.has_value())
+            return error.release_value();
+    }
     return macroblocks;
 }
 
@@ -846,28 +981,47 @@ static ErrorOr<void> skip_marker_with_length(AK::Stream& stream)
     return {};
 }
 
-static void dequantize(JPGLoadingContext& context, Vector<Macroblock>& macroblocks)
+static void dequantize(JPGLoadingContext const& context, Vector<Macroblock>& macroblocks, u32 vcursor, u32 hcursor)
 {
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u32 i = 0; i < context.component_count; i++) {
-                auto& component = context.components[i];
-                u32 const* table = component.qtable_id == 0 ? context.luma_table : context.chroma_table;
-                for (u32 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
-                    for (u32 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
-                        u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                        Macroblock& block = macroblocks[mb_index];
-                        int* block_component = get_component(block, i);
-                        for (u32 k = 0; k < 64; k++)
-                            block_component[k] *= table[k];
-                    }
-                }
+    for (u32 i = 0; i < context.component_count; i++) {
+        auto& component = context.components[i];
+        u32 const* table = component.qtable_id == 0 ? context.luma_table : context.chroma_table;
+        for (u32 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
+            for (u32 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
+                u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
+                Macroblock& block = macroblocks[mb_index];
+                int* block_component = get_component(block, i);
+                for (u32 k = 0; k < 64; k++)
+                    block_component[k] *= table[k];
             }
         }
     }
 }
 
-static void inverse_dct(JPGLoadingContext const& context, Vector<Macroblock>& macroblocks)
+static ALWAYS_INLINE AK::SIMD::f32x4 load_coefficients(i32 const* coefficients)
+{
+    AK::SIMD::i32x4 values;
+    memcpy(&values, coefficients, sizeof(values));
+    return AK::SIMD::to_f32x4(values);
+}
+
+static ALWAYS_INLINE void store_coefficients(i32* coefficients, AK::SIMD::f32x4 values)
+{
+    // Note: Like assigning a float to an int, this truncates towards zero.
+    auto truncated = AK::SIMD::to_i32x4(values);
+    memcpy(coefficients, &truncated, sizeof(truncated));
+}
+
+static void transpose_block(i32* block_component)
+{
+    for (u32 row = 0; row < 8; ++row) {
+        for (u32 column = row + 1; column < 8; ++column)
+            swap(block_component[row * 8 + column], block_component[column * 8 + row]);
+    }
+}
+
+// Transforms four neighbouring columns of a block at once, starting at `column`.
+static ALWAYS_INLINE void inverse_dct_columns(i32* block_component, u32 column)
 {
     static float const m0 = 2.0f * AK::cos(1.0f / 16.0f * 2.0f * AK::Pi<float>);
     static float const m1 = 2.0f * AK::cos(2.0f / 16.0f * 2.0f * AK::Pi<float>);
@@ -884,182 +1038,185 @@ static void inverse_dct(JPGLoadingContext const& context, Vector<Macroblock>& ma
     static float const s6 = AK::cos(6.0f / 16.0f * AK::Pi<float>) / 2.0f;
     static float const s7 = AK::cos(7.0f / 16.0f * AK::Pi<float>) / 2.0f;
 
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u32 component_i = 0; component_i < context.component_count; component_i++) {
-                auto& component = context.components[component_i];
-                for (u8 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
-                    for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
-                        u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                        Macroblock& block = macroblocks[mb_index];
-                        i32* block_component = get_component(block, component_i);
-                        for (u32 k = 0; k < 8; ++k) {
-                            float const g0 = block_component[0 * 8 + k] * s0;
-                            float const g1 = block_component[4 * 8 + k] * s4;
-                            float const g2 = block_component[2 * 8 + k] * s2;
-                            float const g3 = block_component[6 * 8 + k] * s6;
-                            float const g4 = block_component[5 * 8 + k] * s5;
-                            float const g5 = block_component[1 * 8 + k] * s1;
-                            float const g6 = block_component[7 * 8 + k] * s7;
-                            float const g7 = block_component[3 * 8 + k] * s3;
-
-                            float const f0 = g0;
-                            float const f1 = g1;
-                            float const f2 = g2;
-                            float const f3 = g3;
-                            float const f4 = g4 - g7;
-                            float const f5 = g5 + g6;
-                            float const f6 = g5 - g6;
-                            float const f7 = g4 + g7;
-
-                            float const e0 = f0;
-                            float const e1 = f1;
-                            float const e2 = f2 - f3;
-                            float const e3 = f2 + f3;
-                            float const e4 = f4;
-                            float const e5 = f5 - f7;
-                            float const e6 = f6;
-                            float const e7 = f5 + f7;
-                            float const e8 = f4 + f6;
-
-                            float const d0 = e0;
-                            float const d1 = e1;
-                            float const d2 = e2 * m1;
-                            float const d3 = e3;
-                            float const d4 = e4 * m2;
-                            float const d5 = e5 * m3;
-                            float const d6 = e6 * m4;
-                            float const d7 = e7;
-                            float const d8 = e8 * m5;
-
-                            float const c0 = d0 + d1;
-                            float const c1 = d0 - d1;
-                            float const c2 = d2 - d3;
-                            float const c3 = d3;
-                            float const c4 = d4 + d8;
-                            float const c5 = d5 + d7;
-                            float const c6 = d6 - d8;
-                            float const c7 = d7;
-                            float const c8 = c5 - c6;
-
-                            float const b0 = c0 + c3;
-                            float const b1 = c1 + c2;
-                            float const b2 = c1 - c2;
-                            float const b3 = c0 - c3;
-                            float const b4 = c4 - c8;
-                            float const b5 = c8;
-                            float const b6 = c6 - c7;
-                            float const b7 = c7;
-
-                            block_component[0 * 8 + k] = b0 + b7;
-                            block_component[1 * 8 + k] = b1 + b6;
-                            block_component[2 * 8 + k] = b2 + b5;
-                            block_component[3 * 8 + k] = b3 + b4;
-                            block_component[4 * 8 + k] = b3 - b4;
-                            block_component[5 * 8 + k] = b2 - b5;
-                            block_component[6 * 8 + k] = b1 - b6;
-                            block_component[7 * 8 + k] = b0 - b7;
-                        }
-                        for (u32 l = 0; l < 8; ++l) {
-                            float const g0 = block_component[l * 8 + 0] * s0;
-                            float const g1 = block_component[l * 8 + 4] * s4;
-                            float const g2 = block_component[l * 8 + 2] * s2;
-                            float const g3 = block_component[l * 8 + 6] * s6;
-                            float const g4 = block_component[l * 8 + 5] * s5;
-                            float const g5 = block_component[l * 8 + 1] * s1;
-                            float const g6 = block_component[l * 8 + 7] * s7;
-                            float const g7 = block_component[l * 8 + 3] * s3;
-
-                            float const f0 = g0;
-                            float const f1 = g1;
-                            float const f2 = g2;
-                            float const f3 = g3;
-                            float const f4 = g4 - g7;
-                            float const f5 = g5 + g6;
-                            float const f6 = g5 - g6;
-                            float const f7 = g4 + g7;
-
-                            float const e0 = f0;
-                            float const e1 = f1;
-                            float const e2 = f2 - f3;
-                            float const e3 = f2 + f3;
-                            float const e4 = f4;
-                            float const e5 = f5 - f7;
-                            float const e6 = f6;
-                            float const e7 = f5 + f7;
-                            float const e8 = f4 + f6;
-
-                            float const d0 = e0;
-                            float const d1 = e1;
-                            float const d2 = e2 * m1;
-                            float const d3 = e3;
-                            float const d4 = e4 * m2;
-                            float const d5 = e5 * m3;
-                            float const d6 = e6 * m4;
-                            float const d7 = e7;
-                            float const d8 = e8 * m5;
-
-                            float const c0 = d0 + d1;
-                            float const c1 = d0 - d1;
-                            float const c2 = d2 - d3;
-                            float const c3 = d3;
-                            float const c4 = d4 + d8;
-                            float const c5 = d5 + d7;
-                            float const c6 = d6 - d8;
-                            float const c7 = d7;
-                            float const c8 = c5 - c6;
-
-                            float const b0 = c0 + c3;
-                            float const b1 = c1 + c2;
-                            float const b2 = c1 - c2;
-                            float const b3 = c0 - c3;
-                            float const b4 = c4 - c8;
-                            float const b5 = c8;
-                            float const b6 = c6 - c7;
-                            float const b7 = c7;
-
-                            block_component[l * 8 + 0] = b0 + b7;
-                            block_component[l * 8 + 1] = b1 + b6;
-                            block_component[l * 8 + 2] = b2 + b5;
-                            block_component[l * 8 + 3] = b3 + b4;
-                            block_component[l * 8 + 4] = b3 - b4;
-                            block_component[l * 8 + 5] = b2 - b5;
-                            block_component[l * 8 + 6] = b1 - b6;
-                            block_component[l * 8 + 7] = b0 - b7;
-                        }
-                    }
+    using AK::SIMD::f32x4;
+    i32* k = block_component + column;
+
+    f32x4 const g0 = load_coefficients(k + 0 * 8) * s0;
+    f32x4 const g1 = load_coefficients(k + 4 * 8) * s4;
+    f32x4 const g2 = load_coefficients(k + 2 * 8) * s2;
+    f32x4 const g3 = load_coefficients(k + 6 * 8) * s6;
+    f32x4 const g4 = load_coefficients(k + 5 * 8) * s5;
+    f32x4 const g5 = load_coefficients(k + 1 * 8) * s1;
+    f32x4 const g6 = load_coefficients(k + 7 * 8) * s7;
+    f32x4 const g7 = load_coefficients(k + 3 * 8) * s3;
+
+    f32x4 const f0 = g0;
+    f32x4 const f1 = g1;
+    f32x4 const f2 = g2;
+    f32x4 const f3 = g3;
+    f32x4 const f4 = g4 - g7;
+    f32x4 const f5 = g5 + g6;
+    f32x4 const f6 = g5 - g6;
+    f32x4 const f7 = g4 + g7;
+
+    f32x4 const e0 = f0;
+    f32x4 const e1 = f1;
+    f32x4 const e2 = f2 - f3;
+    f32x4 const e3 = f2 + f3;
+    f32x4 const e4 = f4;
+    f32x4 const e5 = f5 - f7;
+    f32x4 const e6 = f6;
+    f32x4 const e7 = f5 + f7;
+    f32x4 const e8 = f4 + f6;
+
+    f32x4 const d0 = e0;
+    f32x4 const d1 = e1;
+    f32x4 const d2 = e2 * m1;
+    f32x4 const d3 = e3;
+    f32x4 const d4 = e4 * m2;
+    f32x4 const d5 = e5 * m3;
+    f32x4 const d6 = e6 * m4;
+    f32x4 const d7 = e7;
+    f32x4 const d8 = e8 * m5;
+
+    f32x4 const c0 = d0 + d1;
+    f32x4 const c1 = d0 - d1;
+    f32x4 const c2 = d2 - d3;
+    f32x4 const c3 = d3;
+    f32x4 const c4 = d4 + d8;
+    f32x4 const c5 = d5 + d7;
+    f32x4 const c6 = d6 - d8;
+    f32x4 const c7 = d7;
+    f32x4 const c8 = c5 - c6;
+
+    f32x4 const b0 = c0 + c3;
+    f32x4 const b1 = c1 + c2;
+    f32x4 const b2 = c1 - c2;
+    f32x4 const b3 = c0 - c3;
+    f32x4 const b4 = c4 - c8;
+    f32x4 const b5 = c8;
+    f32x4 const b6 = c6 - c7;
+    f32x4 const b7 = c7;
+
+    store_coefficients(k + 0 * 8, b0 + b7);
+    store_coefficients(k + 1 * 8, b1 + b6);
+    store_coefficients(k + 2 * 8, b2 + b5);
+    store_coefficients(k + 3 * 8, b3 + b4);
+    store_coefficients(k + 4 * 8, b3 - b4);
+    store_coefficients(k + 5 * 8, b2 - b5);
+    store_coefficients(k + 6 * 8, b1 - b6);
+    store_coefficients(k + 7 * 8, b0 - b7);
+}
+
+static void inverse_dct(JPGLoadingContext const& context, Vector<Macroblock>& macroblocks, u32 vcursor, u32 hcursor)
+{
+    for (u32 component_i = 0; component_i < context.component_count; component_i++) {
+        auto& component = context.components[component_i];
+        for (u8 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
+            for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
+                u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
+                Macroblock& block = macroblocks[mb_index];
+                i32* block_component = get_component(block, component_i);
+                inverse_dct_columns(block_component, 0);
+                inverse_dct_columns(block_component, 4);
+                // Note: The rows go through the same steps as the columns, so they're transformed as the columns of the
+                //       transposed block.
+                transpose_block(block_component);
+                inverse_dct_columns(block_component, 0);
+                inverse_dct_columns(block_component, 4);
+                transpose_block(block_component);
+            }
+        }
+    }
+}
+
+static void ycbcr_to_rgb(JPGLoadingContext const& context, Vector<Macroblock>& macroblocks, u32 vcursor, u32 hcursor)
+{
+    using AK::SIMD::f32x4;
+
+    const u32 chroma_block_index = vcursor * context.mblock_meta.hpadded_count + hcursor;
+    Macroblock const& chroma = macroblocks[chroma_block_index];
+    // Note: The chroma block is converted last and its rows from the bottom up, so chroma values are always read before
+    //       they are overwritten. Overflows are intentional.
+    for (u8 vfactor_i = context.vsample_factor - 1; vfactor_i < context.vsample_factor; --vfactor_i) {
+        for (u8 hfactor_i = context.hsample_factor - 1; hfactor_i < context.hsample_factor; --hfactor_i) {
+            u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
+            i32* y = macroblocks[mb_index].y;
+            i32* cb = macroblocks[mb_index].cb;
+            i32* cr = macroblocks[mb_index].cr;
+            for (u8 i = 7; i < 8; --i) {
+                const u32 chroma_pxrow = (i / context.vsample_factor) + 4 * vfactor_i;
+                alignas(16) i32 row_cb[8];
+                alignas(16) i32 row_cr[8];
+                for (u8 j = 0; j < 8; ++j) {
+                    const u32 chroma_pxcol = (j / context.hsample_factor) + 4 * hfactor_i;
+                    row_cb[j] = chroma.cb[chroma_pxrow * 8 + chroma_pxcol];
+                    row_cr[j] = chroma.cr[chroma_pxrow * 8 + chroma_pxcol];
+                }
+                for (u8 j = 0; j < 8; j += 4) {
+                    const u8 pixel = i * 8 + j;
+                    f32x4 const luma = load_coefficients(y + pixel);
+                    f32x4 const blue_difference = load_coefficients(row_cb + j);
+                    f32x4 const red_difference = load_coefficients(row_cr + j);
+                    f32x4 const r = luma + 1.402f * red_difference + 128.0f;
+                    f32x4 const g = luma - 0.344f * blue_difference - 0.714f * red_difference + 128.0f;
+                    f32x4 const b = luma + 1.772f * blue_difference + 128.0f;
+                    // Note: Clamping before truncating gives the same results as truncating before clamping.
+                    store_coefficients(y + pixel, AK::SIMD::clamp(r, 0.0f, 255.0f));
+                    store_coefficients(cb + pixel, AK::SIMD::clamp(g, 0.0f, 255.0f));
+                    store_coefficients(cr + pixel, AK::SIMD::clamp(b, 0.0f, 255.0f));
                 }
             }
         }
     }
 }
 
-static void ycbcr_to_rgb(JPGLoadingContext const& context, Vector<Macroblock>& macroblocks)
+// Weights of the 8 coefficients of a row or column for the `block_size` pixels that they're decoded to, when a block
+// is decoded at a fraction of its size. Only the lowest `block_size` frequencies are used, which is like downscaling
+// the block after it's been decoded at its full size, but far cheaper.
+struct ScaledInverseDCTTable {
+    explicit ScaledInverseDCTTable(u8 block_size)
+        : block_size(block_size)
+    {
+        VERIFY(block_size == 1 || block_size == 2 || block_size == 4);
+        for (u32 x = 0; x < block_size; ++x) {
+            for (u32 u = 0; u < block_size; ++u) {
+                float scale = u == 0 ? AK::rsqrt(2.0f) / 2.0f : 0.5f;
+                weights[x][u] = scale * AK::cos((2 * x + 1) * u * AK::Pi<float> / (2 * block_size));
+            }
+        }
+    }
+
+    u8 block_size;
+    float weights[4][4];
+};
+
+static void scaled_inverse_dct(JPGLoadingContext const& context, ScaledInverseDCTTable const& table, Vector<Macroblock>& macroblocks, u32 vcursor, u32 hcursor)
 {
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            const u32 chroma_block_index = vcursor * context.mblock_meta.hpadded_count + hcursor;
-            Macroblock const& chroma = macroblocks[chroma_block_index];
-            // Overflows are intentional.
-            for (u8 vfactor_i = context.vsample_factor - 1; vfactor_i < context.vsample_factor; --vfactor_i) {
-                for (u8 hfactor_i = context.hsample_factor - 1; hfactor_i < context.hsample_factor; --hfactor_i) {
-                    u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
-                    i32* y = macroblocks[mb_index].y;
-                    i32* cb = macroblocks[mb_index].cb;
-                    i32* cr = macroblocks[mb_index].cr;
-                    for (u8 i = 7; i < 8; --i) {
-                        for (u8 j = 7; j < 8; --j) {
-                            const u8 pixel = i * 8 + j;
-                            const u32 chroma_pxrow = (i / context.vsample_factor) + 4 * vfactor_i;
-                            const u32 chroma_pxcol = (j / context.hsample_factor) + 4 * hfactor_i;
-                            const u32 chroma_pixel = chroma_pxrow * 8 + chroma_pxcol;
-                            int r = y[pixel] + 1.402f * chroma.cr[chroma_pixel] + 128;
-                            int g = y[pixel] - 0.344f * chroma.cb[chroma_pixel] - 0.714f * chroma.cr[chroma_pixel] + 128;
-                            int b = y[pixel] + 1.772f * chroma.cb[chroma_pixel] + 128;
-                            y[pixel] = r < 0 ? 0 : (r > 255 ? 255 : r);
-                            cb[pixel] = g < 0 ? 0 : (g > 255 ? 255 : g);
-                            cr[pixel] = b < 0 ? 0 : (b > 255 ? 255 : b);
-                        }
+    u32 const n = table.block_size;
+    for (u32 component_i = 0; component_i < context.component_count; component_i++) {
+        auto& component = context.components[component_i];
+        for (u8 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
+            for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
+                u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
+                i32* block_component = get_component(macroblocks[mb_index], component_i);
+
+                float columns[4][4];
+                for (u32 y = 0; y < n; ++y) {
+                    for (u32 u = 0; u < n; ++u) {
+                        float sum = 0;
+                        for (u32 v = 0; v < n; ++v)
+                            sum += table.weights[y][v] * block_component[v * 8 + u];
+                        columns[y][u] = sum;
+                    }
+                }
+                // Note: The pixels are stored at the top left of the block, in rows that are 8 wide as usual.
+                for (u32 y = 0; y < n; ++y) {
+                    for (u32 x = 0; x < n; ++x) {
+                        float sum = 0;
+                        for (u32 u = 0; u < n; ++u)
+                            sum += table.weights[x][u] * columns[y][u];
+                        block_component[y * 8 + x] = static_cast<i32>(sum);
                     }
                 }
             }
@@ -1067,22 +1224,80 @@ static void ycbcr_to_rgb(JPGLoadingContext const& context, Vector<Macroblock>& m
     }
 }
 
-static ErrorOr<void> compose_bitmap(JPGLoadingContext& context, Vector<Macroblock> const& macroblocks)
+static void scaled_ycbcr_to_rgb(JPGLoadingContext const& context, Vector<Macroblock>& macroblocks, u32 vcursor, u32 hcursor)
 {
-    context.bitmap = TRY(Bitmap::create(BitmapFormat::BGRx8888, { context.frame.width, context.frame.height }));
-
-    for (u32 y = context.frame.height - 1; y < context.frame.height; y--) {
-        const u32 block_row = y / 8;
-        const u32 pixel_row = y % 8;
-        for (u32 x = 0; x < context.frame.width; x++) {
-            const u32 block_column = x / 8;
-            auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
-            const u32 pixel_column = x % 8;
-            const u32 pixel_index = pixel_row * 8 + pixel_column;
-            const Color color { (u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index] };
-            context.bitmap->set_pixel(x, y, color);
+    u32 const n = context.block_size;
+    Macroblock const& chroma = macroblocks[vcursor * context.mblock_meta.hpadded_count + hcursor];
+    // Note: As in ycbcr_to_rgb(), everything is converted backwards so that chroma values are read before they're
+    //       overwritten.
+    for (u8 vfactor_i = context.vsample_factor - 1; vfactor_i < context.vsample_factor; --vfactor_i) {
+        for (u8 hfactor_i = context.hsample_factor - 1; hfactor_i < context.hsample_factor; --hfactor_i) {
+            Macroblock& block = macroblocks[(vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i)];
+            for (u32 i = n - 1; i < n; --i) {
+                u32 const chroma_pxrow = (vfactor_i * n + i) / context.vsample_factor;
+                for (u32 j = n - 1; j < n; --j) {
+                    u32 const chroma_pxcol = (hfactor_i * n + j) / context.hsample_factor;
+                    u32 const pixel = i * 8 + j;
+                    float const luma = block.y[pixel];
+                    float const blue_difference = chroma.cb[chroma_pxrow * 8 + chroma_pxcol];
+                    float const red_difference = chroma.cr[chroma_pxrow * 8 + chroma_pxcol];
+                    block.r[pixel] = clamp(luma + 1.402f * red_difference + 128.0f, 0.0f, 255.0f);
+                    block.g[pixel] = clamp(luma - 0.344f * blue_difference - 0.714f * red_difference + 128.0f, 0.0f, 255.0f);
+                    block.b[pixel] = clamp(luma + 1.772f * blue_difference + 128.0f, 0.0f, 255.0f);
+                }
+            }
         }
     }
+}
+
+// Turns the coefficients of every MCU into pixels. The MCUs don't depend on each other, so rows of them can be handed to
+// the thread pool.
+static void convert_macroblocks_to_rgb(JPGLoadingContext const& context, Vector<Macroblock>& macroblocks)
+{
+    Optional<ScaledInverseDCTTable> scaled_table;
+    if (context.block_size != 8)
+        scaled_table.emplace(context.block_size);
+
+    for_each_range(context, mcu_row_count(context), 1, [&](size_t begin, size_t end) {
+        for (size_t mcu_row = begin; mcu_row < end; ++mcu_row) {
+            u32 const vcursor = mcu_row * context.vsample_factor;
+            for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
+                dequantize(context, macroblocks, vcursor, hcursor);
+                if (scaled_table.has_value()) {
+                    scaled_inverse_dct(context, *scaled_table, macroblocks, vcursor, hcursor);
+                    scaled_ycbcr_to_rgb(context, macroblocks, vcursor, hcursor);
+                } else {
+                    inverse_dct(context, macroblocks, vcursor, hcursor);
+                    ycbcr_to_rgb(context, macroblocks, vcursor, hcursor);
+                }
+            }
+        }
+    });
+}
+
+static ErrorOr<void> compose_bitmap(JPGLoadingContext& context, Vector<Macroblock> const& macroblocks)
+{
+    u32 const scale = 8 / context.block_size;
+    u32 const block_size_log2 = count_trailing_zeroes(static_cast<u32>(context.block_size));
+    u32 const width = ceil_div(static_cast<u32>(context.frame.width), scale);
+    u32 const height = ceil_div(static_cast<u32>(context.frame.height), scale);
+    context.bitmap = TRY(Bitmap::create(BitmapFormat::BGRx8888, { static_cast<int>(width), static_cast<int>(height) }));
+
+    auto& bitmap = *context.bitmap;
+    for_each_range(context, height, 8, [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; y++) {
+            const u32 block_row = y >> block_size_log2;
+            const u32 pixel_row = y & (context.block_size - 1);
+            auto* scanline = bitmap.scanline(y);
+            for (u32 x = 0; x < width; x++) {
+                const u32 block_column = x >> block_size_log2;
+                auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
+                const u32 pixel_column = x & (context.block_size - 1);
+                const u32 pixel_index = pixel_row * 8 + pixel_column;
+                scanline[x] = Color((u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index]).value();
+            }
+        }
+    });
 
     return {};
 }
@@ -1178,21 +1393,22 @@ static ErrorOr<void> scan_huffman_stream(AK::SeekableStream& stream, JPGLoadingC
                 continue;
             if (current_byte == 0x00) {
                 current_byte = TRY(stream.read_value<u8>());
-                context.huffman_stream.stream.append(last_byte);
+                context.huffman_data.append(last_byte);
                 continue;
             }
             Marker marker = 0xFF00 | current_byte;
             if (marker == JPG_EOI)
                 return {};
             if (marker >= JPG_RST0 && marker <= JPG_RST7) {
-                context.huffman_stream.stream.append(marker);
+                context.restart_marker_offsets.append(context.huffman_data.size());
+                context.huffman_data.append(marker);
                 current_byte = TRY(stream.read_value<u8>());
                 continue;
             }
             dbgln_if(JPG_DEBUG, "{}: Invalid marker: {:x}!", TRY(stream.tell()), marker);
             return Error::from_string_literal("Invalid marker");
         } else {
-            context.huffman_stream.stream.append(last_byte);
+            context.huffman_data.append(last_byte);
         }
     }
 
@@ -1218,20 +1434,19 @@ static ErrorOr<void> decode_jpg(JPGLoadingContext& context)
     TRY(decode_header(context));
     TRY(scan_huffman_stream(*context.stream, context));
     auto macroblocks = TRY(decode_huffman_stream(context));
-    dequantize(context, macroblocks);
-    inverse_dct(context, macroblocks);
-    ycbcr_to_rgb(context, macroblocks);
+    convert_macroblocks_to_rgb(context, macroblocks);
     TRY(compose_bitmap(context, macroblocks));
     context.stream.clear();
     return {};
 }
 
-JPGImageDecoderPlugin::JPGImageDecoderPlugin(u8 const* data, size_t size)
+JPGImageDecoderPlugin::JPGImageDecoderPlugin(u8 const* data, size_t size, UseThreadPool use_thread_pool)
 {
     m_context = make<JPGLoadingContext>();
     m_context->data = data;
     m_context->data_size = size;
-    m_context->huffman_stream.stream.ensure_capacity(50 * KiB);
+    m_context->use_thread_pool = use_thread_pool;
+    m_context->huffman_data.ensure_capacity(50 * KiB);
 }
 
 JPGImageDecoderPlugin::~JPGImageDecoderPlugin() = default;
@@ -1274,7 +1489,12 @@ ErrorOr<bool> JPGImageDecoderPlugin::sniff(ReadonlyBytes data)
 
 ErrorOr<NonnullOwnPtr<ImageDecoderPlugin>> JPGImageDecoderPlugin::create(ReadonlyBytes data)
 {
-    return adopt_nonnull_own_or_enomem(new (nothrow) JPGImageDecoderPlugin(data.data(), data.size()));
+    return create(data, UseThreadPool::No);
+}
+
+ErrorOr<NonnullOwnPtr<ImageDecoderPlugin>> JPGImageDecoderPlugin::create(ReadonlyBytes data, UseThreadPool use_thread_pool)
+{
+    return adopt_nonnull_own_or_enomem(new (nothrow) JPGImageDecoderPlugin(data.data(), data.size(), use_thread_pool));
 }
 
 bool JPGImageDecoderPlugin::is_animated()
@@ -1311,6 +1531,30 @@ ErrorOr<ImageFrameDescriptor> JPGImageDecoderPlugin::frame(size_t index)
     return ImageFrameDescriptor { m_context->bitmap, 0 };
 }
 
+ErrorOr<ImageFrameDescriptor> JPGImageDecoderPlugin::downscaled_frame(size_t index, IntSize minimum_size)
+{
+    if (index > 0)
+        return Error::from_string_literal("JPGImageDecoderPlugin: Invalid frame index");
+
+    // Note: There's no point in decoding the image again if it has already been decoded at its full size.
+    if (m_context->state == JPGLoadingContext::State::BitmapDecoded)
+        return ImageDecoderPlugin::downscaled_frame(index, minimum_size);
+
+    TRY(decode_header(*m_context));
+    auto factor = downscale_factor_for(size(), minimum_size);
+    if (factor == 1)
+        return frame(index);
+
+    // Note: Blocks are decoded to fewer pixels straight away, rather than downscaling them afterwards. The result isn't
+    //       kept around, so it is decoded with a context of its own.
+    JPGLoadingContext context;
+    context.data = m_context->data;
+    context.data_size = m_context->data_size;
+    context.block_size = 8 / factor;
+    TRY(decode_jpg(context));
+    return ImageFrameDescriptor { context.bitmap, 0 };
+}
+
 ErrorOr<Optional<ReadonlyBytes>> JPGImageDecoderPlugin::icc_data()
 {
     TRY(decode_header(*m_context));
@@ -1321,3 +1565,5 @@ ErrorOr<Optional<ReadonlyBytes>> JPGImageDecoderPlugin::icc_data()
 }
 
 }
+
+#pragma GCC diagnostic pop
@@ -14,8 +14,15 @@ struct JPGLoadingContext;
 
 class JPGImageDecoderPlugin : public ImageDecoderPlugin {
 public:
+    // Decoding can be spread over the shared thread pool. Only do this if the process is allowed to create threads.
+    enum class UseThreadPool {
+        No,
+        Yes,
+    };
+
     static ErrorOr<bool> sniff(ReadonlyBytes);
     static ErrorOr<NonnullOwnPtr<ImageDecoderPlugin>> create(ReadonlyBytes);
+    static ErrorOr<NonnullOwnPtr<ImageDecoderPlugin>> create(ReadonlyBytes, UseThreadPool);
 
     virtual ~JPGImageDecoderPlugin() override;
     virtual IntSize size() override;
@@ -26,10 +33,11 @@ public:
     virtual size_t loop_count() override;
     virtual size_t frame_count() override;
     virtual ErrorOr<ImageFrameDescriptor> frame(size_t index) override;
+    virtual ErrorOr<ImageFrameDescriptor> downscaled_frame(size_t index, IntSize minimum_size) override;
     virtual ErrorOr<Optional<ReadonlyBytes>> icc_data() override;
 
 private:
-    JPGImageDecoderPlugin(u8 const*, size_t);
+    JPGImageDecoderPlugin(u8 const*, size_t, UseThreadPool);
 
     OwnPtr<JPGLoadingContext> m_context;
 };
@@ -7,12 +7,21 @@
 
 #include <AK/Debug.h>
 #include <AK/Endian.h>
+#include <AK/FixedArray.h>
+#include <AK/MemoryStream.h>
+#include <AK/SIMD.h>
 #include <AK/Vector.h>
+#include <LibCompress/Deflate.h>
 #include <LibCompress/Zlib.h>
+#include <LibGfx/BoxDownscaler.h>
 #include <LibGfx/PNGLoader.h>
 #include <LibGfx/PNGShared.h>
 #include <string.h>
 
+// See the comment in SIMDMath.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
 namespace Gfx {
 
 struct PNG_IHDR {
@@ -52,11 +61,6 @@ struct EmbeddedICCProfile {
     ReadonlyBytes compressed_data;
 };
 
-struct Scanline {
-    PNG::FilterType filter;
-    ReadonlyBytes data {};
-};
-
 struct [[gnu::packed]] PaletteEntry {
     u8 r;
     u8 g;
@@ -120,11 +124,15 @@ struct PNGLoadingContext {
     u8 interlace_method { 0 };
     u8 channels { 0 };
     bool has_seen_zlib_header { false };
+    // Whether the end of the data may be missing, and whether it actually was.
+    bool allow_truncated_data { false };
+    bool is_truncated { false };
+    size_t decompressed_data_size { 0 };
     bool has_alpha() const { return to_underlying(color_type) & 4 || palette_transparency_data.size() > 0; }
-    Vector<Scanline> scanlines;
-    ByteBuffer unfiltered_data;
+    // Note: Whether the data got cut off is only known once it runs out, so images that may be cut off always get an
+    //       alpha channel for hiding what's missing.
+    BitmapFormat bitmap_format() const { return has_alpha() || allow_truncated_data ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888; }
     RefPtr<Gfx::Bitmap> bitmap;
-    ByteBuffer* decompression_buffer { nullptr };
     Vector<u8> compressed_data;
     Vector<PaletteEntry> palette_data;
     Vector<u8> palette_transparency_data;
@@ -190,6 +198,13 @@ public:
         return true;
     }
 
+    void wrap_remaining_bytes(ReadonlyBytes& buffer)
+    {
+        buffer = ReadonlyBytes { m_data_ptr, m_size_remaining };
+        m_data_ptr += m_size_remaining;
+        m_size_remaining = 0;
+    }
+
     bool at_end() const { return !m_size_remaining; }
 
 private:
@@ -199,22 +214,101 @@ private:
 
 static bool process_chunk(Streamer&, PNGLoadingContext& context);
 
-union [[gnu::packed]] Pixel {
-    ARGB32 rgba { 0 };
-    u8 v[4];
-    struct {
-        u8 r;
-        u8 g;
-        u8 b;
-        u8 a;
-    };
-};
-static_assert(AssertSize<Pixel, 4>());
+// Note: This is how the bitmap stores pixels, like Color::value() does.
+static ALWAYS_INLINE ARGB32 make_pixel(u8 r, u8 g, u8 b, u8 a = 0xff)
+{
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+template<size_t bytes_per_pixel>
+using FilterLanes = Conditional<(bytes_per_pixel <= 4), AK::SIMD::i16x4, AK::SIMD::i16x8>;
+
+template<size_t bytes_per_pixel>
+static ALWAYS_INLINE FilterLanes<bytes_per_pixel> load_filter_lanes(u8 const* data)
+{
+    using ByteLanes = Conditional<(bytes_per_pixel <= 4), AK::SIMD::u8x4, AK::SIMD::u8x8>;
+    ByteLanes bytes {};
+    memcpy(&bytes, data, bytes_per_pixel);
+    return __builtin_convertvector(bytes, FilterLanes<bytes_per_pixel>);
+}
+
+template<size_t bytes_per_pixel>
+static ALWAYS_INLINE void store_filter_lanes(u8* data, FilterLanes<bytes_per_pixel> lanes)
+{
+    using ByteLanes = Conditional<(bytes_per_pixel <= 4), AK::SIMD::u8x4, AK::SIMD::u8x8>;
+    auto bytes = __builtin_convertvector(lanes, ByteLanes);
+    memcpy(data, &bytes, bytes_per_pixel);
+}
+
+template<typename Lanes>
+static ALWAYS_INLINE Lanes absolute_value(Lanes lanes)
+{
+    auto sign = lanes >> 15;
+    return (lanes ^ sign) - sign;
+}
+
+// Undoes the Sub, Average and Paeth filters one pixel at a time, with each channel of the pixel in its own lane. The
+// filters make every pixel depend on the one to its left, so that's as wide as they can be done in parallel.
+template<size_t bytes_per_pixel>
+static void unfilter_scanline_by_pixel(PNG::FilterType filter, Bytes scanline_data, ReadonlyBytes previous_scanlines_data)
+{
+    using Lanes = FilterLanes<bytes_per_pixel>;
+    Lanes left {};
+    Lanes upper_left {};
+    for (size_t i = 0; i < scanline_data.size(); i += bytes_per_pixel) {
+        auto filtered = load_filter_lanes<bytes_per_pixel>(&scanline_data[i]);
+        Lanes above {};
+        if (filter != PNG::FilterType::Sub)
+            above = load_filter_lanes<bytes_per_pixel>(&previous_scanlines_data[i]);
+
+        switch (filter) {
+        case PNG::FilterType::Sub:
+            left = (filtered + left) & 0xff;
+            break;
+        case PNG::FilterType::Average:
+            left = (filtered + ((left + above) >> 1)) & 0xff;
+            break;
+        case PNG::FilterType::Paeth: {
+            // Note: With p = left + above - upper_left, these are |p - left|, |p - above| and |p - upper_left|.
+            auto distance_to_left = above - upper_left;
+            auto distance_to_above = left - upper_left;
+            auto distance_to_upper_left = absolute_value(distance_to_left + distance_to_above);
+            distance_to_left = absolute_value(distance_to_left);
+            distance_to_above = absolute_value(distance_to_above);
+            auto use_left = (distance_to_left <= distance_to_above) & (distance_to_left <= distance_to_upper_left);
+            auto use_above = ~use_left & (distance_to_above <= distance_to_upper_left);
+            auto use_upper_left = ~(use_left | use_above);
+            auto nearest = (left & use_left) | (above & use_above) | (upper_left & use_upper_left);
+            left = (filtered + nearest) & 0xff;
+            upper_left = above;
+            break;
+        }
+        default:
+            VERIFY_NOT_REACHED();
+        }
+        store_filter_lanes<bytes_per_pixel>(&scanline_data[i], left);
+    }
+}
 
 static void unfilter_scanline(PNG::FilterType filter, Bytes scanline_data, ReadonlyBytes previous_scanlines_data, u8 bytes_per_complete_pixel)
 {
     VERIFY(filter != PNG::FilterType::None);
 
+    if (filter != PNG::FilterType::Up) {
+        switch (bytes_per_complete_pixel) {
+        case 3:
+            return unfilter_scanline_by_pixel<3>(filter, scanline_data, previous_scanlines_data);
+        case 4:
+            return unfilter_scanline_by_pixel<4>(filter, scanline_data, previous_scanlines_data);
+        case 6:
+            return unfilter_scanline_by_pixel<6>(filter, scanline_data, previous_scanlines_data);
+        case 8:
+            return unfilter_scanline_by_pixel<8>(filter, scanline_data, previous_scanlines_data);
+        default:
+            break;
+        }
+    }
+
     switch (filter) {
     case PNG::FilterType::Sub:
         // This loop starts at bytes_per_complete_pixel because all bytes before that are
@@ -227,12 +321,22 @@ static void unfilter_scanline(PNG::FilterType filter, Bytes scanline_data, Reado
             scanline_data[i] += left;
         }
         break;
-    case PNG::FilterType::Up:
-        for (size_t i = 0; i < scanline_data.size(); ++i) {
+    case PNG::FilterType::Up: {
+        size_t i = 0;
+        for (; i + sizeof(AK::SIMD::u8x16) <= scanline_data.size(); i += sizeof(AK::SIMD::u8x16)) {
+            AK::SIMD::u8x16 current;
+            AK::SIMD::u8x16 above;
+            memcpy(&current, &scanline_data[i], sizeof(current));
+            memcpy(&above, &previous_scanlines_data[i], sizeof(above));
+            current += above;
+            memcpy(&scanline_data[i], &current, sizeof(current));
+        }
+        for (; i < scanline_data.size(); ++i) {
             u8 above = previous_scanlines_data[i];
             scanline_data[i] += above;
         }
         break;
+    }
     case PNG::FilterType::Average:
         for (size_t i = 0; i < scanline_data.size(); ++i) {
             u32 left = (i < bytes_per_complete_pixel) ? 0 : scanline_data[i - bytes_per_complete_pixel];
@@ -246,19 +350,7 @@ static void unfilter_scanline(PNG::FilterType filter, Bytes scanline_data, Reado
             u8 left = (i < bytes_per_complete_pixel) ? 0 : scanline_data[i - bytes_per_complete_pixel];
             u8 above = previous_scanlines_data[i];
             u8 upper_left = (i < bytes_per_complete_pixel) ? 0 : previous_scanlines_data[i - bytes_per_complete_pixel];
-            i32 predictor = left + above - upper_left;
-            u32 predictor_left = abs(predictor - left);
-            u32 predictor_above = abs(predictor - above);
-            u32 predictor_upper_left = abs(predictor - upper_left);
-            u8 nearest;
-            if (predictor_left <= predictor_above && predictor_left <= predictor_upper_left) {
-                nearest = left;
-            } else if (predictor_above <= predictor_upper_left) {
-                nearest = above;
-            } else {
-                nearest = upper_left;
-            }
-            scanline_data[i] += nearest;
+            scanline_data[i] += PNG::paeth_predictor(left, above, upper_left);
         }
         break;
     default:
@@ -267,132 +359,56 @@ static void unfilter_scanline(PNG::FilterType filter, Bytes scanline_data, Reado
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_without_alpha(PNGLoadingContext& context)
+ALWAYS_INLINE static void unpack_grayscale_without_alpha(ReadonlyBytes scanline_data, int width, ARGB32* pixels)
 {
-    for (int y = 0; y < context.height; ++y) {
-        auto* gray_values = reinterpret_cast<T const*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = gray_values[i];
-            pixel.g = gray_values[i];
-            pixel.b = gray_values[i];
-            pixel.a = 0xff;
-        }
-    }
+    auto* gray_values = reinterpret_cast<T const*>(scanline_data.data());
+    for (int i = 0; i < width; ++i)
+        pixels[i] = make_pixel(gray_values[i], gray_values[i], gray_values[i]);
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_with_alpha(PNGLoadingContext& context)
+ALWAYS_INLINE static void unpack_grayscale_with_alpha(ReadonlyBytes scanline_data, int width, ARGB32* pixels)
 {
-    for (int y = 0; y < context.height; ++y) {
-        auto* tuples = reinterpret_cast<Tuple<T> const*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = tuples[i].gray;
-            pixel.g = tuples[i].gray;
-            pixel.b = tuples[i].gray;
-            pixel.a = tuples[i].a;
-        }
-    }
+    auto* tuples = reinterpret_cast<Tuple<T> const*>(scanline_data.data());
+    for (int i = 0; i < width; ++i)
+        pixels[i] = make_pixel(tuples[i].gray, tuples[i].gray, tuples[i].gray, tuples[i].a);
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_triplets_without_alpha(PNGLoadingContext& context)
+ALWAYS_INLINE static void unpack_triplets_without_alpha(ReadonlyBytes scanline_data, int width, ARGB32* pixels)
 {
-    for (int y = 0; y < context.height; ++y) {
-        auto* triplets = reinterpret_cast<Triplet<T> const*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = triplets[i].r;
-            pixel.g = triplets[i].g;
-            pixel.b = triplets[i].b;
-            pixel.a = 0xff;
-        }
-    }
+    auto* triplets = reinterpret_cast<Triplet<T> const*>(scanline_data.data());
+    for (int i = 0; i < width; ++i)
+        pixels[i] = make_pixel(triplets[i].r, triplets[i].g, triplets[i].b);
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_triplets_with_transparency_value(PNGLoadingContext& context, Triplet<T> transparency_value)
+ALWAYS_INLINE static void unpack_triplets_with_transparency_value(ReadonlyBytes scanline_data, int width, ARGB32* pixels, Triplet<T> transparency_value)
 {
-    for (int y = 0; y < context.height; ++y) {
-        auto* triplets = reinterpret_cast<Triplet<T> const*>(context.scanlines[y].data.data());
-        for (int i = 0; i < context.width; ++i) {
-            auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-            pixel.r = triplets[i].r;
-            pixel.g = triplets[i].g;
-            pixel.b = triplets[i].b;
-            if (triplets[i] == transparency_value)
-                pixel.a = 0x00;
-            else
-                pixel.a = 0xff;
-        }
-    }
+    auto* triplets = reinterpret_cast<Triplet<T> const*>(scanline_data.data());
+    for (int i = 0; i < width; ++i)
+        pixels[i] = make_pixel(triplets[i].r, triplets[i].g, triplets[i].b, triplets[i] == transparency_value ? 0x00 : 0xff);
 }
 
-NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
+// Unpacks one unfiltered scanline that is `width` pixels wide straight into the bitmap's pixel format.
+static ErrorOr<void> unpack_scanline(PNGLoadingContext const& context, ReadonlyBytes scanline_data, int width, ARGB32* pixels)
 {
-    // First unfilter the scanlines:
-
-    // FIXME: Instead of creating a separate buffer for the scanlines that need to be
-    //        mutated, the mutation could be done in place (if the data was non-const).
-    size_t bytes_per_scanline = context.scanlines[0].data.size();
-    size_t bytes_needed_for_all_unfiltered_scanlines = 0;
-    for (int y = 0; y < context.height; ++y) {
-        if (context.scanlines[y].filter != PNG::FilterType::None) {
-            bytes_needed_for_all_unfiltered_scanlines += bytes_per_scanline;
-        }
-    }
-    context.unfiltered_data = TRY(ByteBuffer::create_uninitialized(bytes_needed_for_all_unfiltered_scanlines));
-
-    // From section 6.3 of http://www.libpng.org/pub/png/spec/1.2/PNG-Filters.html
-    // "bpp is defined as the number of bytes per complete pixel, rounding up to one.
-    // For example, for color type 2 with a bit depth of 16, bpp is equal to 6
-    // (three samples, two bytes per sample); for color type 0 with a bit depth of 2,
-    // bpp is equal to 1 (rounding up); for color type 4 with a bit depth of 16, bpp
-    // is equal to 4 (two-byte grayscale sample, plus two-byte alpha sample)."
-    u8 bytes_per_complete_pixel = (context.bit_depth + 7) / 8 * context.channels;
-
-    u8 dummy_scanline_bytes[bytes_per_scanline];
-    memset(dummy_scanline_bytes, 0, sizeof(dummy_scanline_bytes));
-    auto previous_scanlines_data = ReadonlyBytes { dummy_scanline_bytes, sizeof(dummy_scanline_bytes) };
-
-    for (int y = 0, data_start = 0; y < context.height; ++y) {
-        if (context.scanlines[y].filter != PNG::FilterType::None) {
-            auto scanline_data_slice = context.unfiltered_data.bytes().slice(data_start, bytes_per_scanline);
-
-            // Copy the current values over and set the scanline's data to the to-be-mutated slice
-            context.scanlines[y].data.copy_to(scanline_data_slice);
-            context.scanlines[y].data = scanline_data_slice;
-
-            unfilter_scanline(context.scanlines[y].filter, scanline_data_slice, previous_scanlines_data, bytes_per_complete_pixel);
-
-            data_start += bytes_per_scanline;
-        }
-        previous_scanlines_data = context.scanlines[y].data;
-    }
-
-    // Now unpack the scanlines to RGBA:
     switch (context.color_type) {
     case PNG::ColorType::Greyscale:
         if (context.bit_depth == 8) {
-            unpack_grayscale_without_alpha<u8>(context);
+            unpack_grayscale_without_alpha<u8>(scanline_data, width, pixels);
         } else if (context.bit_depth == 16) {
-            unpack_grayscale_without_alpha<u16>(context);
+            unpack_grayscale_without_alpha<u16>(scanline_data, width, pixels);
         } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
             auto bit_depth_squared = context.bit_depth * context.bit_depth;
             auto pixels_per_byte = 8 / context.bit_depth;
             auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
-                auto* gray_values = context.scanlines[y].data.data();
-                for (int x = 0; x < context.width; ++x) {
-                    auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (x % pixels_per_byte));
-                    auto value = (gray_values[x / pixels_per_byte] >> bit_offset) & mask;
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[x];
-                    pixel.r = value * (0xff / bit_depth_squared);
-                    pixel.g = value * (0xff / bit_depth_squared);
-                    pixel.b = value * (0xff / bit_depth_squared);
-                    pixel.a = 0xff;
-                }
+            auto* gray_values = scanline_data.data();
+            for (int x = 0; x < width; ++x) {
+                auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (x % pixels_per_byte));
+                auto value = (gray_values[x / pixels_per_byte] >> bit_offset) & mask;
+                u8 gray = value * (0xff / bit_depth_squared);
+                pixels[x] = make_pixel(gray, gray, gray);
             }
         } else {
             VERIFY_NOT_REACHED();
@@ -400,9 +416,9 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
         break;
     case PNG::ColorType::GreyscaleWithAlpha:
         if (context.bit_depth == 8) {
-            unpack_grayscale_with_alpha<u8>(context);
+            unpack_grayscale_with_alpha<u8>(scanline_data, width, pixels);
         } else if (context.bit_depth == 16) {
-            unpack_grayscale_with_alpha<u16>(context);
+            unpack_grayscale_with_alpha<u16>(scanline_data, width, pixels);
         } else {
             VERIFY_NOT_REACHED();
         }
@@ -410,82 +426,63 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
     case PNG::ColorType::Truecolor:
         if (context.palette_transparency_data.size() == 6) {
             if (context.bit_depth == 8) {
-                unpack_triplets_with_transparency_value<u8>(context, Triplet<u8> { context.palette_transparency_data[0], context.palette_transparency_data[2], context.palette_transparency_data[4] });
+                unpack_triplets_with_transparency_value<u8>(scanline_data, width, pixels, Triplet<u8> { context.palette_transparency_data[0], context.palette_transparency_data[2], context.palette_transparency_data[4] });
             } else if (context.bit_depth == 16) {
                 u16 tr = context.palette_transparency_data[0] | context.palette_transparency_data[1] << 8;
                 u16 tg = context.palette_transparency_data[2] | context.palette_transparency_data[3] << 8;
                 u16 tb = context.palette_transparency_data[4] | context.palette_transparency_data[5] << 8;
-                unpack_triplets_with_transparency_value<u16>(context, Triplet<u16> { tr, tg, tb });
+                unpack_triplets_with_transparency_value<u16>(scanline_data, width, pixels, Triplet<u16> { tr, tg, tb });
             } else {
                 VERIFY_NOT_REACHED();
             }
         } else {
             if (context.bit_depth == 8)
-                unpack_triplets_without_alpha<u8>(context);
+                unpack_triplets_without_alpha<u8>(scanline_data, width, pixels);
             else if (context.bit_depth == 16)
-                unpack_triplets_without_alpha<u16>(context);
+                unpack_triplets_without_alpha<u16>(scanline_data, width, pixels);
             else
                 VERIFY_NOT_REACHED();
         }
         break;
     case PNG::ColorType::TruecolorWithAlpha:
         if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
-                memcpy(context.bitmap->scanline(y), context.scanlines[y].data.data(), context.scanlines[y].data.size());
-            }
+            auto* quartets = reinterpret_cast<Quartet<u8> const*>(scanline_data.data());
+            for (int i = 0; i < width; ++i)
+                pixels[i] = make_pixel(quartets[i].r, quartets[i].g, quartets[i].b, quartets[i].a);
         } else if (context.bit_depth == 16) {
-            for (int y = 0; y < context.height; ++y) {
-                auto* quartets = reinterpret_cast<Quartet<u16> const*>(context.scanlines[y].data.data());
-                for (int i = 0; i < context.width; ++i) {
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    pixel.r = quartets[i].r & 0xFF;
-                    pixel.g = quartets[i].g & 0xFF;
-                    pixel.b = quartets[i].b & 0xFF;
-                    pixel.a = quartets[i].a & 0xFF;
-                }
-            }
+            auto* quartets = reinterpret_cast<Quartet<u16> const*>(scanline_data.data());
+            for (int i = 0; i < width; ++i)
+                pixels[i] = make_pixel(quartets[i].r & 0xFF, quartets[i].g & 0xFF, quartets[i].b & 0xFF, quartets[i].a & 0xFF);
         } else {
             VERIFY_NOT_REACHED();
         }
         break;
     case PNG::ColorType::IndexedColor:
         if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
-                auto* palette_index = context.scanlines[y].data.data();
-                for (int i = 0; i < context.width; ++i) {
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    if (palette_index[i] >= context.palette_data.size())
-                        return Error::from_string_literal("PNGImageDecoderPlugin: Palette index out of range");
-                    auto& color = context.palette_data.at((int)palette_index[i]);
-                    auto transparency = context.palette_transparency_data.size() >= palette_index[i] + 1u
-                        ? context.palette_transparency_data.data()[palette_index[i]]
-                        : 0xff;
-                    pixel.r = color.r;
-                    pixel.g = color.g;
-                    pixel.b = color.b;
-                    pixel.a = transparency;
-                }
+            auto* palette_index = scanline_data.data();
+            for (int i = 0; i < width; ++i) {
+                if (palette_index[i] >= context.palette_data.size())
+                    return Error::from_string_literal("PNGImageDecoderPlugin: Palette index out of range");
+                auto& color = context.palette_data.at((int)palette_index[i]);
+                auto transparency = context.palette_transparency_data.size() >= palette_index[i] + 1u
+                    ? context.palette_transparency_data.data()[palette_index[i]]
+                    : 0xff;
+                pixels[i] = make_pixel(color.r, color.g, color.b, transparency);
             }
         } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
             auto pixels_per_byte = 8 / context.bit_depth;
             auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
-                auto* palette_indices = context.scanlines[y].data.data();
-                for (int i = 0; i < context.width; ++i) {
-                    auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (i % pixels_per_byte));
-                    auto palette_index = (palette_indices[i / pixels_per_byte] >> bit_offset) & mask;
-                    auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
-                    if ((size_t)palette_index >= context.palette_data.size())
-                        return Error::from_string_literal("PNGImageDecoderPlugin: Palette index out of range");
-                    auto& color = context.palette_data.at(palette_index);
-                    auto transparency = context.palette_transparency_data.size() >= palette_index + 1u
-                        ? context.palette_transparency_data.data()[palette_index]
-                        : 0xff;
-                    pixel.r = color.r;
-                    pixel.g = color.g;
-                    pixel.b = color.b;
-                    pixel.a = transparency;
-                }
+            auto* palette_indices = scanline_data.data();
+            for (int i = 0; i < width; ++i) {
+                auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (i % pixels_per_byte));
+                auto palette_index = (palette_indices[i / pixels_per_byte] >> bit_offset) & mask;
+                if ((size_t)palette_index >= context.palette_data.size())
+                    return Error::from_string_literal("PNGImageDecoderPlugin: Palette index out of range");
+                auto& color = context.palette_data.at(palette_index);
+                auto transparency = context.palette_transparency_data.size() >= palette_index + 1u
+                    ? context.palette_transparency_data.data()[palette_index]
+                    : 0xff;
+                pixels[i] = make_pixel(color.r, color.g, color.b, transparency);
             }
         } else {
             VERIFY_NOT_REACHED();
@@ -496,15 +493,6 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
         break;
     }
 
-    // Swap r and b values:
-    for (int y = 0; y < context.height; ++y) {
-        auto* pixels = (Pixel*)context.bitmap->scanline(y);
-        for (int i = 0; i < context.bitmap->width(); ++i) {
-            auto& x = pixels[i];
-            swap(x.r, x.b);
-        }
-    }
-
     return {};
 }
 
@@ -585,36 +573,73 @@ static bool decode_png_chunks(PNGLoadingContext& context)
     return true;
 }
 
-static ErrorOr<void> decode_png_bitmap_simple(PNGLoadingContext& context)
+// Fills `buffer` with the next bytes of the decompressed image data.
+static ErrorOr<void> read_image_data(PNGLoadingContext& context, AK::Stream& stream, Bytes buffer)
 {
-    Streamer streamer(context.decompression_buffer->data(), context.decompression_buffer->size());
-
-    for (int y = 0; y < context.height; ++y) {
-        PNG::FilterType filter;
-        if (!streamer.read(filter)) {
-            context.state = PNGLoadingContext::State::Error;
+    while (!buffer.is_empty()) {
+        // Note: Whatever a failing read() decompressed is lost, so data that may be cut off is read in small pieces.
+        auto piece = context.allow_truncated_data ? buffer.trim(1 * KiB) : buffer;
+        auto read_bytes_or_error = stream.read(piece);
+        if (read_bytes_or_error.is_error() || read_bytes_or_error.value().is_empty()) {
+            if (context.allow_truncated_data)
+                context.is_truncated = true;
+            else
+                context.state = PNGLoadingContext::State::Error;
             return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed");
         }
+        auto read_size = read_bytes_or_error.value().size();
+        context.decompressed_data_size += read_size;
+        buffer = buffer.slice(read_size);
+    }
+    return {};
+}
+
+// Decompresses the scanlines of a `width` by `height` image, undoes their filters, and hands each of them to
+// `on_scanline` as soon as it is complete. Only the previous scanline is kept around, which the next one is
+// unfiltered against.
+template<typename Callback>
+static ErrorOr<void> decode_scanlines(PNGLoadingContext& context, AK::Stream& stream, int width, int height, Callback on_scanline)
+{
+    auto row_size = context.compute_row_size_for_width(width);
+    if (row_size.has_overflow())
+        return Error::from_string_literal("PNGImageDecoderPlugin: Row size overflow");
 
+    // From section 6.3 of http://www.libpng.org/pub/png/spec/1.2/PNG-Filters.html
+    // "bpp is defined as the number of bytes per complete pixel, rounding up to one.
+    // For example, for color type 2 with a bit depth of 16, bpp is equal to 6
+    // (three samples, two bytes per sample); for color type 0 with a bit depth of 2,
+    // bpp is equal to 1 (rounding up); for color type 4 with a bit depth of 16, bpp
+    // is equal to 4 (two-byte grayscale sample, plus two-byte alpha sample)."
+    u8 bytes_per_complete_pixel = (context.bit_depth + 7) / 8 * context.channels;
+
+    // Note: Every scanline starts with its filter type.
+    auto scanline_buffer = TRY(ByteBuffer::create_zeroed(row_size.value() + 1));
+    auto previous_scanline_buffer = TRY(ByteBuffer::create_zeroed(row_size.value() + 1));
+    for (int y = 0; y < height; ++y) {
+        TRY(read_image_data(context, stream, scanline_buffer.bytes()));
+
+        auto filter = static_cast<PNG::FilterType>(scanline_buffer[0]);
         if (to_underlying(filter) > 4) {
             context.state = PNGLoadingContext::State::Error;
             return Error::from_string_literal("PNGImageDecoderPlugin: Invalid PNG filter");
         }
 
-        context.scanlines.append({ filter });
-        auto& scanline_buffer = context.scanlines.last().data;
-        auto row_size = context.compute_row_size_for_width(context.width);
-        if (row_size.has_overflow())
-            return Error::from_string_literal("PNGImageDecoderPlugin: Row size overflow");
+        auto scanline_data = scanline_buffer.bytes().slice(1);
+        if (filter != PNG::FilterType::None)
+            unfilter_scanline(filter, scanline_data, previous_scanline_buffer.bytes().slice(1), bytes_per_complete_pixel);
+        TRY(on_scanline(y, scanline_data));
 
-        if (!streamer.wrap_bytes(scanline_buffer, row_size.value())) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed");
-        }
+        swap(scanline_buffer, previous_scanline_buffer);
     }
+    return {};
+}
 
-    context.bitmap = TRY(Bitmap::create(context.has_alpha() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, { context.width, context.height }));
-    return unfilter(context);
+static ErrorOr<void> decode_png_bitmap_simple(PNGLoadingContext& context, AK::Stream& stream)
+{
+    context.bitmap = TRY(Bitmap::create(context.bitmap_format(), { context.width, context.height }));
+    return decode_scanlines(context, stream, context.width, context.height, [&](int y, ReadonlyBytes scanline_data) {
+        return unpack_scanline(context, scanline_data, context.width, context.bitmap->scanline(y));
+    });
 }
 
 static int adam7_height(PNGLoadingContext& context, int pass)
@@ -667,66 +692,116 @@ static int adam7_startx[8] = { 0, 0, 4, 0, 2, 0, 1, 0 };
 static int adam7_stepy[8] = { 1, 8, 8, 8, 4, 4, 2, 2 };
 static int adam7_stepx[8] = { 1, 8, 8, 4, 4, 2, 2, 1 };
 
-static ErrorOr<void> decode_adam7_pass(PNGLoadingContext& context, Streamer& streamer, int pass)
+static ErrorOr<void> decode_adam7_pass(PNGLoadingContext& context, AK::Stream& stream, int pass)
 {
-    PNGLoadingContext subimage_context;
-    subimage_context.width = adam7_width(context, pass);
-    subimage_context.height = adam7_height(context, pass);
-    subimage_context.channels = context.channels;
-    subimage_context.color_type = context.color_type;
-    subimage_context.palette_data = context.palette_data;
-    subimage_context.palette_transparency_data = context.palette_transparency_data;
-    subimage_context.bit_depth = context.bit_depth;
-    subimage_context.filter_method = context.filter_method;
+    int pass_width = adam7_width(context, pass);
+    int pass_height = adam7_height(context, pass);
 
     // For small images, some passes might be empty
-    if (!subimage_context.width || !subimage_context.height)
+    if (!pass_width || !pass_height)
         return {};
 
-    subimage_context.scanlines.clear_with_capacity();
-    for (int y = 0; y < subimage_context.height; ++y) {
-        PNG::FilterType filter;
-        if (!streamer.read(filter)) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed");
-        }
+    Vector<ARGB32> pass_pixels;
+    TRY(pass_pixels.try_resize(pass_width));
+    return decode_scanlines(context, stream, pass_width, pass_height, [&](int y, ReadonlyBytes scanline_data) -> ErrorOr<void> {
+        TRY(unpack_scanline(context, scanline_data, pass_width, pass_pixels.data()));
 
-        if (to_underlying(filter) > 4) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Invalid PNG filter");
-        }
+        // Copy the scanline into the main image according to the pass pattern
+        int dy = adam7_starty[pass] + y * adam7_stepy[pass];
+        if (dy >= context.height)
+            return {};
+        auto* pixels = context.bitmap->scanline(dy);
+        for (int x = 0, dx = adam7_startx[pass]; x < pass_width && dx < context.width; ++x, dx += adam7_stepx[pass])
+            pixels[dx] = pass_pixels[x];
+        return {};
+    });
+}
 
-        subimage_context.scanlines.append({ filter });
-        auto& scanline_buffer = subimage_context.scanlines.last().data;
+static ErrorOr<void> decode_png_adam7(PNGLoadingContext& context, AK::Stream& stream)
+{
+    context.bitmap = TRY(Bitmap::create(context.bitmap_format(), { context.width, context.height }));
+    for (int pass = 1; pass <= 7; ++pass)
+        TRY(decode_adam7_pass(context, stream, pass));
+    return {};
+}
 
-        auto row_size = context.compute_row_size_for_width(subimage_context.width);
-        if (row_size.has_overflow())
-            return Error::from_string_literal("PNGImageDecoderPlugin: Row size overflow");
-        if (!streamer.wrap_bytes(scanline_buffer, row_size.value())) {
-            context.state = PNGLoadingContext::State::Error;
-            return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed");
-        }
-    }
+static Checked<size_t> compute_image_data_size(PNGLoadingContext const& context, int width, int height)
+{
+    if (!width || !height)
+        return 0;
+    // Note: This is the row size from compute_row_size_for_width(), plus the filter type every scanline starts with.
+    Checked<size_t> size = width;
+    size *= context.channels;
+    size *= context.bit_depth;
+    size += 7;
+    size /= 8;
+    size += 1;
+    size *= height;
+    return size;
+}
 
-    subimage_context.bitmap = TRY(Bitmap::create(context.bitmap->format(), { subimage_context.width, subimage_context.height }));
-    TRY(unfilter(subimage_context));
+static Checked<size_t> compute_adam7_pass_data_size(PNGLoadingContext& context, int pass)
+{
+    return compute_image_data_size(context, adam7_width(context, pass), adam7_height(context, pass));
+}
 
-    // Copy the subimage data into the main image according to the pass pattern
-    for (int y = 0, dy = adam7_starty[pass]; y < subimage_context.height && dy < context.height; ++y, dy += adam7_stepy[pass]) {
-        for (int x = 0, dx = adam7_startx[pass]; x < subimage_context.width && dy < context.width; ++x, dx += adam7_stepx[pass]) {
-            context.bitmap->set_pixel(dx, dy, subimage_context.bitmap->get_pixel(x, y));
-        }
+static ErrorOr<NonnullOwnPtr<AK::Stream>> create_image_data_stream(PNGLoadingContext& context)
+{
+    if (context.allow_truncated_data) {
+        // Note: This skips the zlib header. The Adler-32 checksum at the end is never read, so it may as well be missing.
+        auto compressed_data = context.compressed_data.span();
+        auto memory_stream = TRY(FixedMemoryStream::construct(compressed_data.slice(min<size_t>(2, compressed_data.size()))));
+        auto deflate_stream = TRY(Compress::DeflateDecompressor::construct(move(memory_stream)));
+        return NonnullOwnPtr<AK::Stream> { move(deflate_stream) };
     }
-    return {};
+
+    auto zlib = Compress::ZlibDecompressor::try_create(context.compressed_data.span());
+    if (!zlib.has_value())
+        return Error::from_string_literal("PNGImageDecoderPlugin: Invalid zlib header");
+    return zlib->decompression_stream();
 }
 
-static ErrorOr<void> decode_png_adam7(PNGLoadingContext& context)
+// Makes the pixels for which no data has arrived transparent. Interlaced images get the pixels of missing passes copied
+// from those of the passes they already have, which shows a coarser version of the whole image.
+static void hide_missing_image_data(PNGLoadingContext& context, size_t available_size)
 {
-    Streamer streamer(context.decompression_buffer->data(), context.decompression_buffer->size());
-    context.bitmap = TRY(Bitmap::create(context.has_alpha() ? BitmapFormat::BGRA8888 : BitmapFormat::BGRx8888, { context.width, context.height }));
-    for (int pass = 1; pass <= 7; ++pass)
-        TRY(decode_adam7_pass(context, streamer, pass));
-    return {};
+    auto clear_rows_from = [&](int first_row) {
+        for (int y = first_row; y < context.height; ++y)
+            memset(context.bitmap->scanline(y), 0, context.width * sizeof(ARGB32));
+    };
+
+    if (context.interlace_method == PngInterlaceMethod::Null) {
+        auto row_data_size = compute_image_data_size(context, context.width, 1);
+        clear_rows_from(available_size / row_data_size.value());
+        return;
+    }
+
+    // How far apart the known pixels are once each pass has been decoded.
+    static constexpr int step_x_after_pass[8] = { 0, 8, 4, 4, 2, 2, 1, 1 };
+    static constexpr int step_y_after_pass[8] = { 0, 8, 8, 4, 4, 2, 2, 1 };
+
+    int complete_passes = 0;
+    size_t pass_data_start = 0;
+    for (int pass = 1; pass <= 7; ++pass) {
+        pass_data_start += compute_adam7_pass_data_size(context, pass).value();
+        if (pass_data_start > available_size)
+            break;
+        complete_passes = pass;
+    }
+
+    if (complete_passes == 0) {
+        clear_rows_from(0);
+        return;
+    }
+
+    int step_x = step_x_after_pass[complete_passes];
+    int step_y = step_y_after_pass[complete_passes];
+    for (int y = 0; y < context.height; ++y) {
+        auto* known_row = context.bitmap->scanline(y - y % step_y);
+        auto* row = context.bitmap->scanline(y);
+        for (int x = 0; x < context.width; ++x)
+            row[x] = known_row[x - x % step_x];
+    }
 }
 
 static ErrorOr<void> decode_png_bitmap(PNGLoadingContext& context)
@@ -745,33 +820,62 @@ static ErrorOr<void> decode_png_bitmap(PNGLoadingContext& context)
     if (context.color_type == PNG::ColorType::IndexedColor && context.palette_data.is_empty())
         return Error::from_string_literal("PNGImageDecoderPlugin: Didn't see a PLTE chunk for a palletized image, or it was empty.");
 
-    auto result = Compress::ZlibDecompressor::decompress_all(context.compressed_data.span());
-    if (!result.has_value()) {
+    auto stream_or_error = create_image_data_stream(context);
+    if (stream_or_error.is_error()) {
         context.state = PNGLoadingContext::State::Error;
         return Error::from_string_literal("PNGImageDecoderPlugin: Decompression failed");
     }
-    context.decompression_buffer = &result.value();
-    context.compressed_data.clear();
+    auto stream = stream_or_error.release_value();
 
-    context.scanlines.ensure_capacity(context.height);
+    ErrorOr<void> result;
     switch (context.interlace_method) {
     case PngInterlaceMethod::Null:
-        TRY(decode_png_bitmap_simple(context));
+        result = decode_png_bitmap_simple(context, *stream);
         break;
     case PngInterlaceMethod::Adam7:
-        TRY(decode_png_adam7(context));
+        result = decode_png_adam7(context, *stream);
         break;
     default:
         context.state = PNGLoadingContext::State::Error;
         return Error::from_string_literal("PNGImageDecoderPlugin: Invalid interlace method");
     }
+    // Note: If the data got cut off, whatever arrived is shown, and the rest is hidden.
+    if (result.is_error() && !context.is_truncated)
+        return result.release_error();
+
+    context.compressed_data.clear();
 
-    context.decompression_buffer = nullptr;
+    if (context.is_truncated)
+        hide_missing_image_data(context, context.decompressed_data_size);
 
     context.state = PNGLoadingContext::State::BitmapDecoded;
     return {};
 }
 
+// Decodes a non-interlaced image straight into a downscaled bitmap, so that it's never held at its full size. Every
+// scanline is unpacked into the same row of pixels and then added to the downscaled bitmap.
+static ErrorOr<NonnullRefPtr<Bitmap>> decode_png_bitmap_downscaled(PNGLoadingContext& context, int factor)
+{
+    VERIFY(context.state == PNGLoadingContext::State::ChunksDecoded);
+    VERIFY(context.interlace_method == PngInterlaceMethod::Null);
+
+    if (context.width == -1 || context.height == -1)
+        return Error::from_string_literal("PNGImageDecoderPlugin: Didn't see an IHDR chunk.");
+
+    if (context.color_type == PNG::ColorType::IndexedColor && context.palette_data.is_empty())
+        return Error::from_string_literal("PNGImageDecoderPlugin: Didn't see a PLTE chunk for a palletized image, or it was empty.");
+
+    auto stream = TRY(create_image_data_stream(context));
+    auto downscaler = TRY(BoxDownscaler::create({ context.width, context.height }, factor, context.bitmap_format()));
+    auto row = TRY(FixedArray<ARGB32>::create(context.width));
+    TRY(decode_scanlines(context, *stream, context.width, context.height, [&](int y, ReadonlyBytes scanline_data) -> ErrorOr<void> {
+        TRY(unpack_scanline(context, scanline_data, context.width, row.data()));
+        downscaler.add_row(y, row.data());
+        return {};
+    }));
+    return downscaler.bitmap();
+}
+
 static bool is_valid_compression_method(u8 compression_method)
 {
     return compression_method == 0;
@@ -960,14 +1064,22 @@ static bool process_chunk(Streamer& streamer, PNGLoadingContext& context)
         dbgln_if(PNG_DEBUG, "Bail at chunk_type");
         return false;
     }
+    // Note: While an image is still being loaded, the image data that did arrive can be shown already.
+    bool keep_truncated_chunk = context.allow_truncated_data && !strcmp((char const*)chunk_type, "IDAT");
     ReadonlyBytes chunk_data;
     if (!streamer.wrap_bytes(chunk_data, chunk_size)) {
         dbgln_if(PNG_DEBUG, "Bail at chunk_data");
+        if (keep_truncated_chunk) {
+            streamer.wrap_remaining_bytes(chunk_data);
+            process_IDAT(chunk_data, context);
+        }
         return false;
     }
     u32 chunk_crc;
     if (!streamer.read(chunk_crc)) {
         dbgln_if(PNG_DEBUG, "Bail at chunk_crc");
+        if (keep_truncated_chunk)
+            process_IDAT(chunk_data, context);
         return false;
     }
     dbgln_if(PNG_DEBUG, "Chunk type: '{}', size: {}, crc: {:x}", chunk_type, chunk_size, chunk_crc);
@@ -1079,6 +1191,42 @@ ErrorOr<ImageFrameDescriptor> PNGImageDecoderPlugin::frame(size_t index)
     return ImageFrameDescriptor { m_context->bitmap, 0 };
 }
 
+ErrorOr<ImageFrameDescriptor> PNGImageDecoderPlugin::partial_frame()
+{
+    if (m_context->state == PNGLoadingContext::State::Error)
+        return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed");
+
+    if (m_context->state < PNGLoadingContext::State::BitmapDecoded) {
+        m_context->allow_truncated_data = true;
+        TRY(decode_png_bitmap(*m_context));
+    }
+
+    VERIFY(m_context->bitmap);
+    return ImageFrameDescriptor { m_context->bitmap, 0 };
+}
+
+ErrorOr<ImageFrameDescriptor> PNGImageDecoderPlugin::downscaled_frame(size_t index, IntSize minimum_size)
+{
+    if (index > 0)
+        return Error::from_string_literal("PNGImageDecoderPlugin: Invalid frame index");
+
+    if (m_context->state == PNGLoadingContext::State::Error)
+        return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed");
+
+    if (!decode_png_chunks(*m_context))
+        return Error::from_string_literal("PNGImageDecoderPlugin: Decoding failed");
+
+    // Note: Interlaced images need all of their pixels for putting the passes together, so they're decoded at their
+    //       full size first, and so are images that already have been.
+    if (m_context->state >= PNGLoadingContext::State::BitmapDecoded || m_context->interlace_method != PngInterlaceMethod::Null)
+        return ImageDecoderPlugin::downscaled_frame(index, minimum_size);
+
+    auto factor = downscale_factor_for({ m_context->width, m_context->height }, minimum_size);
+    if (factor == 1)
+        return frame(index);
+    return ImageFrameDescriptor { TRY(decode_png_bitmap_downscaled(*m_context, factor)), 0 };
+}
+
 ErrorOr<Optional<ReadonlyBytes>> PNGImageDecoderPlugin::icc_data()
 {
     if (!decode_png_chunks(*m_context))
@@ -1109,3 +1257,5 @@ ErrorOr<Optional<ReadonlyBytes>> PNGImageDecoderPlugin::icc_data()
 }
 
 }
+
+#pragma GCC diagnostic pop
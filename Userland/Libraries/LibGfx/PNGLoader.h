@@ -27,6 +27,8 @@ public:
     virtual size_t loop_count() override;
     virtual size_t frame_count() override;
     virtual ErrorOr<ImageFrameDescriptor> frame(size_t index) override;
+    virtual ErrorOr<ImageFrameDescriptor> partial_frame() override;
+    virtual ErrorOr<ImageFrameDescriptor> downscaled_frame(size_t index, IntSize minimum_size) override;
     virtual ErrorOr<Optional<ReadonlyBytes>> icc_data() override;
 
 private:
@@ -22,6 +22,8 @@
 #include <AK/Memory.h>
 #include <AK/Queue.h>
 #include <AK/QuickSort.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
 #include <AK/StdLibExtras.h>
 #include <AK/StringBuilder.h>
 #include <AK/Utf32View.h>
@@ -114,6 +116,45 @@ void Painter::clear_rect(IntRect const& a_rect, Color color)
     }
 }
 
+// Blends four source pixels over four opaque destination pixels, with the same result as Color::blend().
+// Note: Over an opaque destination, Color::blend() boils down to (destination * (255 - alpha) + source * alpha) / 255 for
+//       each channel, and for x <= 255 * 255, x / 255 is (x + 1 + (x >> 8)) >> 8.
+ALWAYS_INLINE static AK::SIMD::u32x4 blend_over_opaque(AK::SIMD::u32x4 destination, AK::SIMD::u32x4 source)
+{
+    auto alpha = source >> 24;
+    auto inverse_alpha = 255u - alpha;
+    auto result = AK::SIMD::expand4(0xff000000u);
+    for (u32 shift = 0; shift < 24; shift += 8) {
+        auto x = ((destination >> shift) & 0xffu) * inverse_alpha + ((source >> shift) & 0xffu) * alpha;
+        result |= ((x + 1u + (x >> 8)) >> 8) << shift;
+    }
+    return result;
+}
+
+// Blends a row of pixels over `dst` like Color::blend() would, four pixels at a time wherever the destination is opaque.
+// If `dst_is_opaque`, the destination's alpha channel is ignored, as with Color::from_rgb().
+template<bool dst_is_opaque, typename GetSourcePixel>
+ALWAYS_INLINE static void blend_row(ARGB32* dst, int count, GetSourcePixel get_source_pixel)
+{
+    int x = 0;
+    for (; x + 4 <= count; x += 4) {
+        AK::SIMD::u32x4 source { get_source_pixel(x), get_source_pixel(x + 1), get_source_pixel(x + 2), get_source_pixel(x + 3) };
+        if (dst_is_opaque || ((dst[x] & dst[x + 1] & dst[x + 2] & dst[x + 3]) >> 24) == 0xff) {
+            AK::SIMD::u32x4 destination;
+            memcpy(&destination, dst + x, sizeof(destination));
+            auto result = blend_over_opaque(destination, source);
+            memcpy(dst + x, &result, sizeof(result));
+            continue;
+        }
+        for (int i = 0; i < 4; ++i)
+            dst[x + i] = Color::from_argb(dst[x + i]).blend(Color::from_argb(source[i])).value();
+    }
+    for (; x < count; ++x) {
+        auto destination = dst_is_opaque ? Color::from_rgb(dst[x]) : Color::from_argb(dst[x]);
+        dst[x] = destination.blend(Color::from_argb(get_source_pixel(x))).value();
+    }
+}
+
 void Painter::fill_physical_rect(IntRect const& physical_rect, Color color)
 {
     // Callers must do clipping.
@@ -121,8 +162,7 @@ void Painter::fill_physical_rect(IntRect const& physical_rect, Color color)
     size_t const dst_skip = m_target->pitch() / sizeof(ARGB32);
 
     for (int i = physical_rect.height() - 1; i >= 0; --i) {
-        for (int j = 0; j < physical_rect.width(); ++j)
-            dst[j] = Color::from_argb(dst[j]).blend(color).value();
+        blend_row<false>(dst, physical_rect.width(), [&](int) { return color.value(); });
         dst += dst_skip;
     }
 }
@@ -834,37 +874,35 @@ struct BlitState {
 
 // FIXME: This is a hack to support blit_with_opacity() with RGBA8888 source.
 //        Ideally we'd have a more generic solution that allows any source format.
-static void swap_red_and_blue_channels(Color& color)
+static ARGB32 swap_red_and_blue_channels(u32 rgba)
 {
-    u32 rgba = color.value();
-    u32 bgra = (rgba & 0xff00ff00)
+    return (rgba & 0xff00ff00)
         | ((rgba & 0x000000ff) << 16)
         | ((rgba & 0x00ff0000) >> 16);
-    color = Color::from_argb(bgra);
 }
 
-// FIXME: This function is very unoptimized.
 template<BlitState::AlphaState has_alpha>
 static void do_blit_with_opacity(BlitState& state)
 {
-    for (int row = 0; row < state.row_count; ++row) {
-        for (int x = 0; x < state.column_count; ++x) {
-            Color dest_color = (has_alpha & BlitState::DstAlpha) ? Color::from_argb(state.dst[x]) : Color::from_rgb(state.dst[x]);
-            if constexpr (has_alpha & BlitState::SrcAlpha) {
-                Color src_color_with_alpha = Color::from_argb(state.src[x]);
-                if (state.src_format == BitmapFormat::RGBA8888)
-                    swap_red_and_blue_channels(src_color_with_alpha);
-                float pixel_opacity = src_color_with_alpha.alpha() / 255.0;
-                src_color_with_alpha.set_alpha(255 * (state.opacity * pixel_opacity));
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
-            } else {
-                Color src_color_with_alpha = Color::from_rgb(state.src[x]);
-                if (state.src_format == BitmapFormat::RGBA8888)
-                    swap_red_and_blue_channels(src_color_with_alpha);
-                src_color_with_alpha.set_alpha(state.opacity * 255);
-                state.dst[x] = dest_color.blend(src_color_with_alpha).value();
-            }
+    // Note: These are the alphas that the source pixels end up with, computed once for every possible value.
+    Array<u8, 256> source_alphas;
+    for (size_t alpha = 0; alpha < source_alphas.size(); ++alpha) {
+        if constexpr (has_alpha & BlitState::SrcAlpha) {
+            float pixel_opacity = alpha / 255.0;
+            source_alphas[alpha] = 255 * (state.opacity * pixel_opacity);
+        } else {
+            source_alphas[alpha] = state.opacity * 255;
         }
+    }
+
+    bool const swap_red_and_blue = state.src_format == BitmapFormat::RGBA8888;
+    for (int row = 0; row < state.row_count; ++row) {
+        blend_row<!(has_alpha & BlitState::DstAlpha)>(state.dst, state.column_count, [&](int x) -> u32 {
+            u32 pixel = state.src[x];
+            if (swap_red_and_blue)
+                pixel = swap_red_and_blue_channels(pixel);
+            return (pixel & 0xffffff) | (source_alphas[pixel >> 24] << 24);
+        });
         state.dst += state.dst_pitch;
         state.src += state.src_pitch;
     }
@@ -985,6 +1023,116 @@ void Painter::blit_filtered(IntPoint position, Gfx::Bitmap const& source, IntRec
     }
 }
 
+void Painter::draw_glyph_coverage(IntPoint position, Gfx::Bitmap const& coverage, IntRect const& src_rect, Color color)
+{
+    // Note: Glyph bitmaps are white, with the coverage in their alpha channel, so this is exactly what blitting them
+    //       with a filter that multiplies them with `color` would do.
+    if (coverage.scale() != 1 || scale() != 1 || coverage.format() != BitmapFormat::BGRA8888) {
+        blit_filtered(position, coverage, src_rect, [color](Color pixel) -> Color {
+            return pixel.multiply(color);
+        });
+        return;
+    }
+
+    IntRect safe_src_rect = src_rect.intersected(coverage.rect());
+    auto dst_rect = IntRect(position, safe_src_rect.size()).translated(translation());
+    auto clipped_rect = dst_rect.intersected(clip_rect());
+    if (clipped_rect.is_empty())
+        return;
+
+    int const first_row = clipped_rect.top() - dst_rect.top();
+    int const first_column = clipped_rect.left() - dst_rect.left();
+    int const width = clipped_rect.width();
+    ARGB32* dst = m_target->scanline(clipped_rect.y()) + clipped_rect.x();
+    size_t const dst_skip = m_target->pitch() / sizeof(ARGB32);
+    ARGB32 const* src = coverage.scanline(safe_src_rect.top() + first_row) + safe_src_rect.left() + first_column;
+    size_t const src_skip = coverage.pitch() / sizeof(ARGB32);
+
+    u32 const rgb = color.value() & 0xffffff;
+    u32 const alpha = color.alpha();
+    auto source_pixel = [&](ARGB32 coverage_pixel) -> u32 {
+        return rgb | ((coverage_pixel >> 24) * alpha / 255) << 24;
+    };
+
+    bool const dst_is_opaque = m_target->format() == BitmapFormat::BGRx8888;
+    for (int row = 0; row < clipped_rect.height(); ++row) {
+        if (dst_is_opaque) {
+            // Note: Most of a glyph's pixels are either not covered at all or fully covered, so those get away cheaply.
+            int x = 0;
+            for (; x + 4 <= width; x += 4) {
+                AK::SIMD::u32x4 coverage_pixels;
+                memcpy(&coverage_pixels, src + x, sizeof(coverage_pixels));
+                auto coverage_alpha = coverage_pixels >> 24;
+                if ((coverage_alpha[0] | coverage_alpha[1] | coverage_alpha[2] | coverage_alpha[3]) == 0)
+                    continue;
+                if (alpha == 255 && (coverage_alpha[0] & coverage_alpha[1] & coverage_alpha[2] & coverage_alpha[3]) == 255) {
+                    auto result = AK::SIMD::expand4(color.value());
+                    memcpy(dst + x, &result, sizeof(result));
+                    continue;
+                }
+                auto scaled_alpha = coverage_alpha * alpha;
+                auto source = AK::SIMD::expand4(rgb) | (((scaled_alpha + 1u + (scaled_alpha >> 8)) >> 8) << 24);
+                AK::SIMD::u32x4 destination;
+                memcpy(&destination, dst + x, sizeof(destination));
+                auto result = blend_over_opaque(destination, source);
+                memcpy(dst + x, &result, sizeof(result));
+            }
+            for (; x < width; ++x)
+                dst[x] = Color::from_rgb(dst[x]).blend(Color::from_argb(source_pixel(src[x]))).value();
+        } else {
+            for (int x = 0; x < width; ++x) {
+                if (src[x] >> 24)
+                    dst[x] = Color::from_argb(dst[x]).blend(Color::from_argb(source_pixel(src[x]))).value();
+            }
+        }
+        dst += dst_skip;
+        src += src_skip;
+    }
+}
+
+void Painter::blend_physical_coverage_span(IntPoint physical_start, Span<u8 const> coverage, Color color)
+{
+    ARGB32* dst = m_target->scanline(physical_start.y()) + physical_start.x();
+    int const width = coverage.size();
+    u32 const rgb = color.value() & 0xffffff;
+    u32 const alpha = color.alpha();
+    auto source_pixel = [&](u8 pixel_coverage) -> u32 {
+        return rgb | (pixel_coverage * alpha / 255) << 24;
+    };
+
+    if (m_target->format() != BitmapFormat::BGRx8888) {
+        for (int x = 0; x < width; ++x) {
+            if (coverage[x])
+                dst[x] = Color::from_argb(dst[x]).blend(Color::from_argb(source_pixel(coverage[x]))).value();
+        }
+        return;
+    }
+
+    // Note: Most pixels of a filled path are either fully covered or not at all, so those get away cheaply.
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        u32 coverage_bytes;
+        memcpy(&coverage_bytes, coverage.data() + x, sizeof(coverage_bytes));
+        if (coverage_bytes == 0)
+            continue;
+        if (alpha == 255 && coverage_bytes == 0xffffffff) {
+            auto result = AK::SIMD::expand4(color.value());
+            memcpy(dst + x, &result, sizeof(result));
+            continue;
+        }
+        AK::SIMD::u32x4 scaled_alpha { coverage[x] * alpha, coverage[x + 1] * alpha, coverage[x + 2] * alpha, coverage[x + 3] * alpha };
+        auto source = AK::SIMD::expand4(rgb) | (((scaled_alpha + 1u + (scaled_alpha >> 8)) >> 8) << 24);
+        AK::SIMD::u32x4 destination;
+        memcpy(&destination, dst + x, sizeof(destination));
+        auto result = blend_over_opaque(destination, source);
+        memcpy(dst + x, &result, sizeof(result));
+    }
+    for (; x < width; ++x) {
+        if (coverage[x])
+            dst[x] = Color::from_rgb(dst[x]).blend(Color::from_argb(source_pixel(coverage[x]))).value();
+    }
+}
+
 void Painter::blit_brightened(IntPoint position, Gfx::Bitmap const& source, IntRect const& src_rect)
 {
     return blit_filtered(position, source, src_rect, [](Color src) {
@@ -1367,9 +1515,7 @@ FLATTEN void Painter::draw_glyph(FloatPoint point, u32 code_point, Font const& f
     if (glyph.is_glyph_bitmap()) {
         draw_bitmap(top_left.to_type<int>(), glyph.glyph_bitmap(), color);
     } else {
-        blit_filtered(glyph_position.blit_position, *glyph.bitmap(), glyph.bitmap()->rect(), [color](Color pixel) -> Color {
-            return pixel.multiply(color);
-        });
+        draw_glyph_coverage(glyph_position.blit_position, *glyph.bitmap(), glyph.bitmap_rect(), color);
     }
 }
 
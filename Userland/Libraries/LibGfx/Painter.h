@@ -182,6 +182,7 @@ public:
     int scale() const { return state().scale; }
 
 protected:
+    friend AntiAliasingPainter;
     friend GradientLine;
 
     IntRect to_physical(IntRect const& r) const { return r.translated(translation()) * scale(); }
@@ -190,6 +191,9 @@ protected:
     void fill_physical_scanline_with_draw_op(int y, int x, int width, Color color);
     void fill_rect_with_draw_op(IntRect const&, Color);
     void blit_with_opacity(IntPoint, Gfx::Bitmap const&, IntRect const& src_rect, float opacity, bool apply_alpha = true);
+    void draw_glyph_coverage(IntPoint, Gfx::Bitmap const& coverage, IntRect const& src_rect, Color);
+    // Blends `color` over a run of physical pixels, as much as each of them is covered. Callers must do clipping.
+    void blend_physical_coverage_span(IntPoint physical_start, Span<u8 const> coverage, Color);
     void draw_physical_pixel(IntPoint, Color, int thickness = 1);
     void set_physical_pixel(IntPoint, Color color, bool blend);
 
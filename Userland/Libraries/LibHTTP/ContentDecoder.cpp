@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibCompress/Brotli.h>
+#include <LibCompress/Deflate.h>
+#include <LibCompress/Gzip.h>
+#include <LibCompress/Zlib.h>
+#include <LibCompress/Zstd.h>
+#include <LibHTTP/ContentDecoder.h>
+
+namespace HTTP {
+
+// How far the input has to run ahead of the decompressor before it may decode the next piece of output. A single
+// Zstandard block can be 128 KiB large, and none of the other formats need nearly as much for this much output.
+static constexpr size_t input_lookahead_size = 256 * KiB;
+static constexpr size_t max_decode_size = 32 * KiB;
+
+ErrorOr<OwnPtr<ContentDecoder>> ContentDecoder::create(StringView content_coding)
+{
+    content_coding = content_coding.trim_whitespace();
+    Optional<Coding> coding;
+    if (content_coding.equals_ignoring_case("gzip"sv))
+        coding = Coding::Gzip;
+    else if (content_coding.equals_ignoring_case("deflate"sv))
+        coding = Coding::Deflate;
+    else if (content_coding.equals_ignoring_case("br"sv))
+        coding = Coding::Brotli;
+    else if (content_coding.equals_ignoring_case("zstd"sv))
+        coding = Coding::Zstd;
+
+    if (!coding.has_value())
+        return nullptr;
+    dbgln_if(JOB_DEBUG, "ContentDecoder: Decoding body with content coding '{}'", content_coding);
+    return adopt_nonnull_own_or_enomem(new (nothrow) ContentDecoder(*coding));
+}
+
+ErrorOr<void> ContentDecoder::append(ReadonlyBytes bytes)
+{
+    auto first_bytes = bytes.trim(m_first_bytes.size() - m_first_bytes_size);
+    first_bytes.copy_to(m_first_bytes.span().slice(m_first_bytes_size));
+    m_first_bytes_size += first_bytes.size();
+
+    TRY(m_input.write_entire_buffer(bytes));
+    return {};
+}
+
+ErrorOr<void> ContentDecoder::create_decompressor()
+{
+    switch (m_coding) {
+    case Coding::Gzip:
+        m_decompressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Compress::GzipDecompressor(MaybeOwned<AK::Stream>(m_input))));
+        return {};
+    case Coding::Deflate: {
+        // Even though the content coding is "deflate", it's actually deflate with the zlib wrapper.
+        // https://www.rfc-editor.org/rfc/rfc9110#section-8.4.1.2
+        // Some non-conformant implementations send the "deflate" compressed data without the zlib wrapper, though.
+        if (m_first_bytes_size == m_first_bytes.size()) {
+            Compress::ZlibHeader header { .as_u16 = static_cast<u16>(m_first_bytes[0] << 8 | m_first_bytes[1]) };
+            bool is_zlib_wrapped = header.compression_method == Compress::ZlibCompressionMethod::Deflate && header.compression_info <= 7
+                && !header.present_dictionary && header.as_u16 % 31 == 0;
+            if (is_zlib_wrapped)
+                TRY(m_input.discard(m_first_bytes.size()));
+            else
+                dbgln_if(JOB_DEBUG, "ContentDecoder: Deflate data comes without a zlib header");
+        }
+        m_decompressor = TRY(Compress::DeflateDecompressor::construct(MaybeOwned<AK::Stream>(m_input)));
+        return {};
+    }
+    case Coding::Brotli:
+        m_decompressor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Compress::BrotliDecompressionStream(m_input)));
+        return {};
+    case Coding::Zstd:
+        m_decompressor = TRY(Compress::ZstdDecompressor::construct(MaybeOwned<AK::Stream>(m_input)));
+        return {};
+    }
+    VERIFY_NOT_REACHED();
+}
+
+ErrorOr<ByteBuffer> ContentDecoder::decode(bool input_is_complete)
+{
+    if (!input_is_complete && m_input.used_buffer_size() <= input_lookahead_size)
+        return ByteBuffer {};
+
+    if (!m_decompressor) {
+        // Responses without a body (such as those to HEAD requests) still name the coding their body would have had.
+        if (m_input.used_buffer_size() == 0)
+            return ByteBuffer {};
+        TRY(create_decompressor());
+    }
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(max_decode_size));
+    auto decoded = TRY(m_decompressor->read(buffer));
+    buffer.resize(decoded.size());
+    return buffer;
+}
+
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/ByteBuffer.h>
+#include <AK/Error.h>
+#include <AK/MemoryStream.h>
+#include <AK/OwnPtr.h>
+#include <AK/Stream.h>
+
+namespace HTTP {
+
+// Decodes a response body that was sent with a content coding (RFC 9110, section 8.4.1) while it is still arriving.
+//
+// The decompressors pull their input from a stream and can't stop in the middle of a block to wait for more of it, so
+// they are only given the data that has arrived once it runs far enough ahead of them to hold the next piece of output
+// in any case. Whatever is left is decoded once the entire body is there.
+class ContentDecoder {
+public:
+    // Returns null for the identity coding, and for codings we don't know, which are passed on to the client as is.
+    static ErrorOr<OwnPtr<ContentDecoder>> create(StringView content_coding);
+
+    ErrorOr<void> append(ReadonlyBytes);
+
+    // Returns the next piece of decoded data, or an empty buffer if the decoder is waiting for more input.
+    // Once the input is complete, an empty buffer means that everything has been decoded.
+    ErrorOr<ByteBuffer> decode(bool input_is_complete);
+
+    size_t buffered_input_size() const { return m_input.used_buffer_size(); }
+
+private:
+    enum class Coding {
+        Gzip,
+        Deflate,
+        Brotli,
+        Zstd,
+    };
+
+    explicit ContentDecoder(Coding coding)
+        : m_coding(coding)
+    {
+    }
+
+    ErrorOr<void> create_decompressor();
+
+    Coding m_coding;
+    AllocatingMemoryStream m_input;
+    // Tells us whether "deflate" data actually comes with the zlib wrapper it is supposed to have.
+    Array<u8, 2> m_first_bytes {};
+    size_t m_first_bytes_size { 0 };
+    OwnPtr<AK::Stream> m_decompressor;
+};
+
+}
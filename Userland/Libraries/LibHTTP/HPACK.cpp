@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/StringBuilder.h>
+#include <LibHTTP/HPACK.h>
+
+namespace HTTP::HPACK {
+
+struct StaticTableEntry {
+    StringView name;
+    StringView value;
+};
+
+// https://www.rfc-editor.org/rfc/rfc7541#appendix-A
+static constexpr StaticTableEntry s_static_table[] = {
+    { ":authority"sv, ""sv },
+    { ":method"sv, "GET"sv },
+    { ":method"sv, "POST"sv },
+    { ":path"sv, "/"sv },
+    { ":path"sv, "/index.html"sv },
+    { ":scheme"sv, "http"sv },
+    { ":scheme"sv, "https"sv },
+    { ":status"sv, "200"sv },
+    { ":status"sv, "204"sv },
+    { ":status"sv, "206"sv },
+    { ":status"sv, "304"sv },
+    { ":status"sv, "400"sv },
+    { ":status"sv, "404"sv },
+    { ":status"sv, "500"sv },
+    { "accept-charset"sv, ""sv },
+    { "accept-encoding"sv, "gzip, deflate"sv },
+    { "accept-language"sv, ""sv },
+    { "accept-ranges"sv, ""sv },
+    { "accept"sv, ""sv },
+    { "access-control-allow-origin"sv, ""sv },
+    { "age"sv, ""sv },
+    { "allow"sv, ""sv },
+    { "authorization"sv, ""sv },
+    { "cache-control"sv, ""sv },
+    { "content-disposition"sv, ""sv },
+    { "content-encoding"sv, ""sv },
+    { "content-language"sv, ""sv },
+    { "content-length"sv, ""sv },
+    { "content-location"sv, ""sv },
+    { "content-range"sv, ""sv },
+    { "content-type"sv, ""sv },
+    { "cookie"sv, ""sv },
+    { "date"sv, ""sv },
+    { "etag"sv, ""sv },
+    { "expect"sv, ""sv },
+    { "expires"sv, ""sv },
+    { "from"sv, ""sv },
+    { "host"sv, ""sv },
+    { "if-match"sv, ""sv },
+    { "if-modified-since"sv, ""sv },
+    { "if-none-match"sv, ""sv },
+    { "if-range"sv, ""sv },
+    { "if-unmodified-since"sv, ""sv },
+    { "last-modified"sv, ""sv },
+    { "link"sv, ""sv },
+    { "location"sv, ""sv },
+    { "max-forwards"sv, ""sv },
+    { "proxy-authenticate"sv, ""sv },
+    { "proxy-authorization"sv, ""sv },
+    { "range"sv, ""sv },
+    { "referer"sv, ""sv },
+    { "refresh"sv, ""sv },
+    { "retry-after"sv, ""sv },
+    { "server"sv, ""sv },
+    { "set-cookie"sv, ""sv },
+    { "strict-transport-security"sv, ""sv },
+    { "transfer-encoding"sv, ""sv },
+    { "user-agent"sv, ""sv },
+    { "vary"sv, ""sv },
+    { "via"sv, ""sv },
+    { "www-authenticate"sv, ""sv },
+};
+static constexpr size_t static_table_size = array_size(s_static_table);
+
+struct HuffmanCode {
+    u32 code;
+    u8 length;
+};
+
+// https://www.rfc-editor.org/rfc/rfc7541#appendix-B, indexed by symbol. Symbol 256 is EOS.
+static constexpr HuffmanCode s_huffman_codes[257] = {
+    { 0x1ff8, 13 }, { 0x7fffd8, 23 }, { 0xfffffe2, 28 }, { 0xfffffe3, 28 },
+    { 0xfffffe4, 28 }, { 0xfffffe5, 28 }, { 0xfffffe6, 28 }, { 0xfffffe7, 28 },
+    { 0xfffffe8, 28 }, { 0xffffea, 24 }, { 0x3ffffffc, 30 }, { 0xfffffe9, 28 },
+    { 0xfffffea, 28 }, { 0x3ffffffd, 30 }, { 0xfffffeb, 28 }, { 0xfffffec, 28 },
+    { 0xfffffed, 28 }, { 0xfffffee, 28 }, { 0xfffffef, 28 }, { 0xffffff0, 28 },
+    { 0xffffff1, 28 }, { 0xffffff2, 28 }, { 0x3ffffffe, 30 }, { 0xffffff3, 28 },
+    { 0xffffff4, 28 }, { 0xffffff5, 28 }, { 0xffffff6, 28 }, { 0xffffff7, 28 },
+    { 0xffffff8, 28 }, { 0xffffff9, 28 }, { 0xffffffa, 28 }, { 0xffffffb, 28 },
+    { 0x14, 6 }, { 0x3f8, 10 }, { 0x3f9, 10 }, { 0xffa, 12 },
+    { 0x1ff9, 13 }, { 0x15, 6 }, { 0xf8, 8 }, { 0x7fa, 11 },
+    { 0x3fa, 10 }, { 0x3fb, 10 }, { 0xf9, 8 }, { 0x7fb, 11 },
+    { 0xfa, 8 }, { 0x16, 6 }, { 0x17, 6 }, { 0x18, 6 },
+    { 0x0, 5 }, { 0x1, 5 }, { 0x2, 5 }, { 0x19, 6 },
+    { 0x1a, 6 }, { 0x1b, 6 }, { 0x1c, 6 }, { 0x1d, 6 },
+    { 0x1e, 6 }, { 0x1f, 6 }, { 0x5c, 7 }, { 0xfb, 8 },
+    { 0x7ffc, 15 }, { 0x20, 6 }, { 0xffb, 12 }, { 0x3fc, 10 },
+    { 0x1ffa, 13 }, { 0x21, 6 }, { 0x5d, 7 }, { 0x5e, 7 },
+    { 0x5f, 7 }, { 0x60, 7 }, { 0x61, 7 }, { 0x62, 7 },
+    { 0x63, 7 }, { 0x64, 7 }, { 0x65, 7 }, { 0x66, 7 },
+    { 0x67, 7 }, { 0x68, 7 }, { 0x69, 7 }, { 0x6a, 7 },
+    { 0x6b, 7 }, { 0x6c, 7 }, { 0x6d, 7 }, { 0x6e, 7 },
+    { 0x6f, 7 }, { 0x70, 7 }, { 0x71, 7 }, { 0x72, 7 },
+    { 0xfc, 8 }, { 0x73, 7 }, { 0xfd, 8 }, { 0x1ffb, 13 },
+    { 0x7fff0, 19 }, { 0x1ffc, 13 }, { 0x3ffc, 14 }, { 0x22, 6 },
+    { 0x7ffd, 15 }, { 0x3, 5 }, { 0x23, 6 }, { 0x4, 5 },
+    { 0x24, 6 }, { 0x5, 5 }, { 0x25, 6 }, { 0x26, 6 },
+    { 0x27, 6 }, { 0x6, 5 }, { 0x74, 7 }, { 0x75, 7 },
+    { 0x28, 6 }, { 0x29, 6 }, { 0x2a, 6 }, { 0x7, 5 },
+    { 0x2b, 6 }, { 0x76, 7 }, { 0x2c, 6 }, { 0x8, 5 },
+    { 0x9, 5 }, { 0x2d, 6 }, { 0x77, 7 }, { 0x78, 7 },
+    { 0x79, 7 }, { 0x7a, 7 }, { 0x7b, 7 }, { 0x7ffe, 15 },
+    { 0x7fc, 11 }, { 0x3ffd, 14 }, { 0x1ffd, 13 }, { 0xffffffc, 28 },
+    { 0xfffe6, 20 }, { 0x3fffd2, 22 }, { 0xfffe7, 20 }, { 0xfffe8, 20 },
+    { 0x3fffd3, 22 }, { 0x3fffd4, 22 }, { 0x3fffd5, 22 }, { 0x7fffd9, 23 },
+    { 0x3fffd6, 22 }, { 0x7fffda, 23 }, { 0x7fffdb, 23 }, { 0x7fffdc, 23 },
+    { 0x7fffdd, 23 }, { 0x7fffde, 23 }, { 0xffffeb, 24 }, { 0x7fffdf, 23 },
+    { 0xffffec, 24 }, { 0xffffed, 24 }, { 0x3fffd7, 22 }, { 0x7fffe0, 23 },
+    { 0xffffee, 24 }, { 0x7fffe1, 23 }, { 0x7fffe2, 23 }, { 0x7fffe3, 23 },
+    { 0x7fffe4, 23 }, { 0x1fffdc, 21 }, { 0x3fffd8, 22 }, { 0x7fffe5, 23 },
+    { 0x3fffd9, 22 }, { 0x7fffe6, 23 }, { 0x7fffe7, 23 }, { 0xffffef, 24 },
+    { 0x3fffda, 22 }, { 0x1fffdd, 21 }, { 0xfffe9, 20 }, { 0x3fffdb, 22 },
+    { 0x3fffdc, 22 }, { 0x7fffe8, 23 }, { 0x7fffe9, 23 }, { 0x1fffde, 21 },
+    { 0x7fffea, 23 }, { 0x3fffdd, 22 }, { 0x3fffde, 22 }, { 0xfffff0, 24 },
+    { 0x1fffdf, 21 }, { 0x3fffdf, 22 }, { 0x7fffeb, 23 }, { 0x7fffec, 23 },
+    { 0x1fffe0, 21 }, { 0x1fffe1, 21 }, { 0x3fffe0, 22 }, { 0x1fffe2, 21 },
+    { 0x7fffed, 23 }, { 0x3fffe1, 22 }, { 0x7fffee, 23 }, { 0x7fffef, 23 },
+    { 0xfffea, 20 }, { 0x3fffe2, 22 }, { 0x3fffe3, 22 }, { 0x3fffe4, 22 },
+    { 0x7ffff0, 23 }, { 0x3fffe5, 22 }, { 0x3fffe6, 22 }, { 0x7ffff1, 23 },
+    { 0x3ffffe0, 26 }, { 0x3ffffe1, 26 }, { 0xfffeb, 20 }, { 0x7fff1, 19 },
+    { 0x3fffe7, 22 }, { 0x7ffff2, 23 }, { 0x3fffe8, 22 }, { 0x1ffffec, 25 },
+    { 0x3ffffe2, 26 }, { 0x3ffffe3, 26 }, { 0x3ffffe4, 26 }, { 0x7ffffde, 27 },
+    { 0x7ffffdf, 27 }, { 0x3ffffe5, 26 }, { 0xfffff1, 24 }, { 0x1ffffed, 25 },
+    { 0x7fff2, 19 }, { 0x1fffe3, 21 }, { 0x3ffffe6, 26 }, { 0x7ffffe0, 27 },
+    { 0x7ffffe1, 27 }, { 0x3ffffe7, 26 }, { 0x7ffffe2, 27 }, { 0xfffff2, 24 },
+    { 0x1fffe4, 21 }, { 0x1fffe5, 21 }, { 0x3ffffe8, 26 }, { 0x3ffffe9, 26 },
+    { 0xffffffd, 28 }, { 0x7ffffe3, 27 }, { 0x7ffffe4, 27 }, { 0x7ffffe5, 27 },
+    { 0xfffec, 20 }, { 0xfffff3, 24 }, { 0xfffed, 20 }, { 0x1fffe6, 21 },
+    { 0x3fffe9, 22 }, { 0x1fffe7, 21 }, { 0x1fffe8, 21 }, { 0x7ffff3, 23 },
+    { 0x3fffea, 22 }, { 0x3fffeb, 22 }, { 0x1ffffee, 25 }, { 0x1ffffef, 25 },
+    { 0xfffff4, 24 }, { 0xfffff5, 24 }, { 0x3ffffea, 26 }, { 0x7ffff4, 23 },
+    { 0x3ffffeb, 26 }, { 0x7ffffe6, 27 }, { 0x3ffffec, 26 }, { 0x3ffffed, 26 },
+    { 0x7ffffe7, 27 }, { 0x7ffffe8, 27 }, { 0x7ffffe9, 27 }, { 0x7ffffea, 27 },
+    { 0x7ffffeb, 27 }, { 0xffffffe, 28 }, { 0x7ffffec, 27 }, { 0x7ffffed, 27 },
+    { 0x7ffffee, 27 }, { 0x7ffffef, 27 }, { 0x7fffff0, 27 }, { 0x3ffffee, 26 },
+    { 0x3fffffff, 30 },
+};
+static constexpr u16 huffman_eos_symbol = 256;
+static constexpr u8 huffman_max_code_length = 30;
+
+// The code is canonical, so every code length covers a contiguous range of codes, assigned in symbol order.
+struct HuffmanDecodingTable {
+    u32 first_code[huffman_max_code_length + 1] {};
+    u16 first_symbol_index[huffman_max_code_length + 1] {};
+    u16 code_count[huffman_max_code_length + 1] {};
+    u16 symbols[array_size(s_huffman_codes)] {};
+};
+
+static HuffmanDecodingTable const& huffman_decoding_table()
+{
+    static auto const table = [] {
+        HuffmanDecodingTable table;
+        u16 symbol_index = 0;
+        u32 code = 0;
+        for (u8 length = 1; length <= huffman_max_code_length; ++length) {
+            table.first_code[length] = code;
+            table.first_symbol_index[length] = symbol_index;
+            for (u16 symbol = 0; symbol < array_size(s_huffman_codes); ++symbol) {
+                if (s_huffman_codes[symbol].length == length)
+                    table.symbols[symbol_index++] = symbol;
+            }
+            table.code_count[length] = symbol_index - table.first_symbol_index[length];
+            code = (code + table.code_count[length]) << 1;
+        }
+        return table;
+    }();
+    return table;
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#section-5.1
+ErrorOr<void> encode_integer(u64 value, u8 prefix_bits, u8 first_byte_flags, ByteBuffer& output)
+{
+    u64 max_prefix_value = (1u << prefix_bits) - 1;
+    if (value < max_prefix_value) {
+        TRY(output.try_append(static_cast<u8>(first_byte_flags | value)));
+        return {};
+    }
+    TRY(output.try_append(static_cast<u8>(first_byte_flags | max_prefix_value)));
+    value -= max_prefix_value;
+    while (value >= 128) {
+        TRY(output.try_append(static_cast<u8>((value & 0x7f) | 0x80)));
+        value >>= 7;
+    }
+    TRY(output.try_append(static_cast<u8>(value)));
+    return {};
+}
+
+ErrorOr<u64> decode_integer(ReadonlyBytes& input, u8 prefix_bits)
+{
+    if (input.is_empty())
+        return Error::from_string_literal("HPACK: Truncated integer");
+
+    u64 max_prefix_value = (1u << prefix_bits) - 1;
+    u64 value = input[0] & max_prefix_value;
+    input = input.slice(1);
+    if (value < max_prefix_value)
+        return value;
+
+    // Nothing we decode comes anywhere near 2^32, so anything longer than that is an attempt to overflow us.
+    for (u8 shift = 0; shift <= 28; shift += 7) {
+        if (input.is_empty())
+            return Error::from_string_literal("HPACK: Truncated integer");
+        u8 byte = input[0];
+        input = input.slice(1);
+        value += static_cast<u64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+    return Error::from_string_literal("HPACK: Integer is too large");
+}
+
+size_t huffman_encoded_length(StringView string)
+{
+    size_t bit_length = 0;
+    for (auto ch : string)
+        bit_length += s_huffman_codes[static_cast<u8>(ch)].length;
+    return (bit_length + 7) / 8;
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#section-5.2
+ErrorOr<void> huffman_encode(StringView string, ByteBuffer& output)
+{
+    u64 bits = 0;
+    u8 bit_count = 0;
+    for (auto ch : string) {
+        auto const& code = s_huffman_codes[static_cast<u8>(ch)];
+        bits = (bits << code.length) | code.code;
+        bit_count += code.length;
+        while (bit_count >= 8) {
+            bit_count -= 8;
+            TRY(output.try_append(static_cast<u8>(bits >> bit_count)));
+        }
+    }
+    // The last byte is padded with the most significant bits of EOS, i.e. with ones.
+    if (bit_count > 0)
+        TRY(output.try_append(static_cast<u8>((bits << (8 - bit_count)) | (0xff >> bit_count))));
+    return {};
+}
+
+ErrorOr<DeprecatedString> huffman_decode(ReadonlyBytes input)
+{
+    auto const& table = huffman_decoding_table();
+    StringBuilder builder;
+    u32 code = 0;
+    u8 length = 0;
+    for (auto byte : input) {
+        for (int bit = 7; bit >= 0; --bit) {
+            code = (code << 1) | ((byte >> bit) & 1);
+            ++length;
+            if (code >= table.first_code[length] && code - table.first_code[length] < table.code_count[length]) {
+                auto symbol = table.symbols[table.first_symbol_index[length] + code - table.first_code[length]];
+                if (symbol == huffman_eos_symbol)
+                    return Error::from_string_literal("HPACK: Huffman-encoded string contains EOS");
+                TRY(builder.try_append(static_cast<char>(symbol)));
+                code = 0;
+                length = 0;
+            } else if (length == huffman_max_code_length) {
+                return Error::from_string_literal("HPACK: Invalid Huffman code");
+            }
+        }
+    }
+    // Padding longer than 7 bits, or padding that isn't a prefix of EOS, is a decoding error.
+    if (length > 7 || code != (1u << length) - 1)
+        return Error::from_string_literal("HPACK: Invalid Huffman padding");
+    return builder.to_deprecated_string();
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#section-5.2
+static ErrorOr<DeprecatedString> decode_string(ReadonlyBytes& input)
+{
+    if (input.is_empty())
+        return Error::from_string_literal("HPACK: Truncated string literal");
+    bool is_huffman_encoded = input[0] & 0x80;
+    auto length = TRY(decode_integer(input, 7));
+    if (length > input.size())
+        return Error::from_string_literal("HPACK: Truncated string literal");
+    auto string = input.trim(length);
+    input = input.slice(length);
+    if (is_huffman_encoded)
+        return huffman_decode(string);
+    return DeprecatedString { string };
+}
+
+static ErrorOr<void> encode_string(StringView string, ByteBuffer& output)
+{
+    if (auto encoded_length = huffman_encoded_length(string); encoded_length < string.length()) {
+        TRY(encode_integer(encoded_length, 7, 0x80, output));
+        return huffman_encode(string, output);
+    }
+    TRY(encode_integer(string.length(), 7, 0, output));
+    return output.try_append(string.bytes());
+}
+
+static size_t entry_size(Header const& header)
+{
+    // https://www.rfc-editor.org/rfc/rfc7541#section-4.1
+    return header.name.length() + header.value.length() + 32;
+}
+
+Decoder::Decoder(size_t max_header_table_size, size_t max_header_list_size)
+    : m_max_dynamic_table_size(max_header_table_size)
+    , m_max_header_table_size(max_header_table_size)
+    , m_max_header_list_size(max_header_list_size)
+{
+}
+
+ErrorOr<Header> Decoder::header_at(u64 index) const
+{
+    // https://www.rfc-editor.org/rfc/rfc7541#section-2.3.3
+    if (index == 0)
+        return Error::from_string_literal("HPACK: Header index 0 is invalid");
+    if (index <= static_table_size)
+        return Header { s_static_table[index - 1].name, s_static_table[index - 1].value };
+    auto dynamic_index = index - static_table_size - 1;
+    if (dynamic_index >= m_dynamic_table.size())
+        return Error::from_string_literal("HPACK: Header index is out of range");
+    return m_dynamic_table[m_dynamic_table.size() - dynamic_index - 1];
+}
+
+void Decoder::evict_entries_until_size_is_at_most(size_t size)
+{
+    size_t entries_to_evict = 0;
+    while (m_dynamic_table_size > size) {
+        m_dynamic_table_size -= entry_size(m_dynamic_table[entries_to_evict]);
+        ++entries_to_evict;
+    }
+    m_dynamic_table.remove(0, entries_to_evict);
+}
+
+void Decoder::add_to_dynamic_table(Header header)
+{
+    // https://www.rfc-editor.org/rfc/rfc7541#section-4.4
+    auto size = entry_size(header);
+    if (size > m_max_dynamic_table_size) {
+        evict_entries_until_size_is_at_most(0);
+        return;
+    }
+    evict_entries_until_size_is_at_most(m_max_dynamic_table_size - size);
+    m_dynamic_table.append(move(header));
+    m_dynamic_table_size += size;
+}
+
+// https://www.rfc-editor.org/rfc/rfc7541#section-6
+ErrorOr<Vector<Header>> Decoder::decode(ReadonlyBytes input)
+{
+    Vector<Header> headers;
+    size_t header_list_size = 0;
+
+    auto decode_literal = [&](u8 prefix_bits) -> ErrorOr<Header> {
+        auto name_index = TRY(decode_integer(input, prefix_bits));
+        auto name = name_index == 0 ? TRY(decode_string(input)) : TRY(header_at(name_index)).name;
+        auto value = TRY(decode_string(input));
+        return Header { move(name), move(value) };
+    };
+
+    while (!input.is_empty()) {
+        u8 first_byte = input[0];
+        Header header;
+        if (first_byte & 0x80) {
+            // Indexed Header Field Representation.
+            header = TRY(header_at(TRY(decode_integer(input, 7))));
+        } else if ((first_byte & 0xc0) == 0x40) {
+            // Literal Header Field with Incremental Indexing.
+            header = TRY(decode_literal(6));
+            add_to_dynamic_table(header);
+        } else if ((first_byte & 0xe0) == 0x20) {
+            // Dynamic Table Size Update.
+            auto new_size = TRY(decode_integer(input, 5));
+            if (new_size > m_max_header_table_size)
+                return Error::from_string_literal("HPACK: Dynamic table size update exceeds our limit");
+            m_max_dynamic_table_size = new_size;
+            evict_entries_until_size_is_at_most(new_size);
+            continue;
+        } else {
+            // Literal Header Field without Indexing, or Never Indexed.
+            header = TRY(decode_literal(4));
+        }
+
+        header_list_size += entry_size(header);
+        if (header_list_size > m_max_header_list_size)
+            return Error::from_string_literal("HPACK: Header list is too large");
+        TRY(headers.try_append(move(header)));
+    }
+    return headers;
+}
+
+ErrorOr<void> Encoder::encode(Vector<Header> const& headers, ByteBuffer& output) const
+{
+    for (auto& header : headers) {
+        size_t name_index = 0;
+        for (size_t i = 0; i < static_table_size; ++i) {
+            if (s_static_table[i].name != header.name)
+                continue;
+            if (s_static_table[i].value == header.value) {
+                // Indexed Header Field Representation.
+                name_index = i + 1;
+                break;
+            }
+            if (name_index == 0)
+                name_index = i + 1;
+        }
+        if (name_index != 0 && s_static_table[name_index - 1].value == header.value) {
+            TRY(encode_integer(name_index, 7, 0x80, output));
+            continue;
+        }
+
+        // Credentials should not end up in the dynamic table of any intermediary either, so they are never indexed.
+        bool is_sensitive = header.name == "authorization"sv || header.name == "cookie"sv || header.name == "proxy-authorization"sv;
+        TRY(encode_integer(name_index, 4, is_sensitive ? 0x10 : 0, output));
+        if (name_index == 0)
+            TRY(encode_string(header.name, output));
+        TRY(encode_string(header.value, output));
+    }
+    return {};
+}
+
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/DeprecatedString.h>
+#include <AK/Error.h>
+#include <AK/Vector.h>
+
+// HPACK: Header Compression for HTTP/2, as specified by RFC 7541.
+namespace HTTP::HPACK {
+
+struct Header {
+    DeprecatedString name;
+    DeprecatedString value;
+
+    bool operator==(Header const&) const = default;
+};
+
+// RFC 7541 section 4.2 and RFC 9113 section 6.5.2: SETTINGS_HEADER_TABLE_SIZE starts out as 4096.
+constexpr static size_t DefaultHeaderTableSize = 4096;
+
+class Decoder {
+public:
+    // The header list limit protects us from servers that would make us decode an arbitrarily large header block.
+    explicit Decoder(size_t max_header_table_size = DefaultHeaderTableSize, size_t max_header_list_size = 256 * KiB);
+
+    ErrorOr<Vector<Header>> decode(ReadonlyBytes header_block);
+
+    size_t dynamic_table_size() const { return m_dynamic_table_size; }
+
+private:
+    ErrorOr<Header> header_at(u64 index) const;
+    void add_to_dynamic_table(Header);
+    void evict_entries_until_size_is_at_most(size_t);
+
+    // Oldest entry first, the newest entry is index 62.
+    Vector<Header> m_dynamic_table;
+    size_t m_dynamic_table_size { 0 };
+    size_t m_max_dynamic_table_size { DefaultHeaderTableSize };
+    size_t m_max_header_table_size { DefaultHeaderTableSize };
+    size_t m_max_header_list_size { 0 };
+};
+
+// Never adds anything to the dynamic table, so the peer's SETTINGS_HEADER_TABLE_SIZE does not matter to us.
+class Encoder {
+public:
+    ErrorOr<void> encode(Vector<Header> const&, ByteBuffer& output) const;
+};
+
+ErrorOr<void> encode_integer(u64 value, u8 prefix_bits, u8 first_byte_flags, ByteBuffer& output);
+ErrorOr<u64> decode_integer(ReadonlyBytes& input, u8 prefix_bits);
+
+ErrorOr<void> huffman_encode(StringView, ByteBuffer& output);
+ErrorOr<DeprecatedString> huffman_decode(ReadonlyBytes);
+size_t huffman_encoded_length(StringView);
+
+}
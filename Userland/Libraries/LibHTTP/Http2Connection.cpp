@@ -0,0 +1,634 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/StringBuilder.h>
+#include <LibHTTP/Http2Connection.h>
+
+namespace HTTP {
+
+static constexpr auto connection_preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"sv;
+static constexpr size_t frame_header_size = 9;
+static constexpr i64 max_window_size = 0x7fffffff;
+static constexpr u32 max_stream_id = 0x7fffffff;
+
+// We never raise SETTINGS_MAX_FRAME_SIZE, so this is the largest frame the server may send us.
+static constexpr size_t max_received_frame_size = 16384;
+
+// The default windows of 64 KiB would limit a single stream to 64 KiB per round trip.
+static constexpr u32 stream_receive_window_size = 1 * MiB;
+static constexpr u32 connection_receive_window_size = 16 * MiB;
+static constexpr u32 max_header_list_size = 256 * KiB;
+
+namespace Flags {
+static constexpr u8 EndStream = 0x1;
+static constexpr u8 Ack = 0x1;
+static constexpr u8 EndHeaders = 0x4;
+static constexpr u8 Padded = 0x8;
+static constexpr u8 Priority = 0x20;
+}
+
+// https://www.rfc-editor.org/rfc/rfc9113#section-6.5.2
+enum class SettingsParameter : u16 {
+    HeaderTableSize = 0x1,
+    EnablePush = 0x2,
+    MaxConcurrentStreams = 0x3,
+    InitialWindowSize = 0x4,
+    MaxFrameSize = 0x5,
+    MaxHeaderListSize = 0x6,
+};
+
+static u32 read_u32(ReadonlyBytes bytes)
+{
+    return (bytes[0] << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+}
+
+static void write_u32(u8* bytes, u32 value)
+{
+    bytes[0] = value >> 24;
+    bytes[1] = value >> 16;
+    bytes[2] = value >> 8;
+    bytes[3] = value;
+}
+
+// Padded frames start with the length of the padding, which follows the actual payload.
+static ErrorOr<ReadonlyBytes, Http2Connection::ErrorCode> remove_padding(ReadonlyBytes payload)
+{
+    if (payload.is_empty())
+        return Http2Connection::ErrorCode::FrameSizeError;
+    size_t padding_length = payload[0];
+    if (padding_length >= payload.size())
+        return Http2Connection::ErrorCode::ProtocolError;
+    return payload.slice(1, payload.size() - 1 - padding_length);
+}
+
+ErrorOr<NonnullOwnPtr<Http2Connection>> Http2Connection::try_create(Core::Stream::BufferedSocketBase& socket)
+{
+    auto connection = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Http2Connection(socket)));
+    TRY(connection->send_connection_preface());
+    return connection;
+}
+
+Http2Connection::Http2Connection(Core::Stream::BufferedSocketBase& socket)
+    : m_socket(socket)
+    , m_decoder(HPACK::DefaultHeaderTableSize, max_header_list_size)
+{
+    m_socket.on_ready_to_read = [this] { read_from_socket(); };
+}
+
+Http2Connection::~Http2Connection()
+{
+    m_socket.on_ready_to_read = nullptr;
+}
+
+bool Http2Connection::can_open_stream() const
+{
+    // Stream identifiers can't be reused, so a connection that has used them all up is done.
+    return !m_is_going_away && m_socket.is_open() && m_streams.size() < m_peer_max_concurrent_streams && m_next_stream_id <= max_stream_id;
+}
+
+ErrorOr<void> Http2Connection::send_connection_preface()
+{
+    // https://www.rfc-editor.org/rfc/rfc9113#section-3.4
+    u8 settings[3 * 6];
+    auto set_parameter = [&](size_t index, SettingsParameter parameter, u32 value) {
+        settings[index * 6] = to_underlying(parameter) >> 8;
+        settings[index * 6 + 1] = to_underlying(parameter);
+        write_u32(settings + index * 6 + 2, value);
+    };
+    set_parameter(0, SettingsParameter::EnablePush, 0);
+    set_parameter(1, SettingsParameter::InitialWindowSize, stream_receive_window_size);
+    set_parameter(2, SettingsParameter::MaxHeaderListSize, max_header_list_size);
+
+    TRY(m_socket.write_entire_buffer(connection_preface.bytes()));
+    TRY(send_frame(FrameType::Settings, 0, 0, { settings, sizeof(settings) }));
+    // The connection window can only be changed with WINDOW_UPDATE.
+    TRY(send_window_update(0, connection_receive_window_size - 65535));
+    return {};
+}
+
+ErrorOr<void> Http2Connection::send_frame(FrameType type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    // https://www.rfc-editor.org/rfc/rfc9113#section-4.1
+    VERIFY(payload.size() <= 0xffffff);
+    auto frame = TRY(ByteBuffer::create_uninitialized(frame_header_size + payload.size()));
+    frame[0] = payload.size() >> 16;
+    frame[1] = payload.size() >> 8;
+    frame[2] = payload.size();
+    frame[3] = to_underlying(type);
+    frame[4] = flags;
+    write_u32(frame.data() + 5, stream_id & 0x7fffffff);
+    payload.copy_to(frame.bytes().slice(frame_header_size));
+    TRY(m_socket.write_entire_buffer(frame));
+    return {};
+}
+
+ErrorOr<void> Http2Connection::send_window_update(u32 stream_id, u32 increment)
+{
+    u8 payload[4];
+    write_u32(payload, increment);
+    return send_frame(FrameType::WindowUpdate, 0, stream_id, { payload, sizeof(payload) });
+}
+
+ErrorOr<u32> Http2Connection::open_stream(HttpRequest const& request, StreamCallbacks callbacks)
+{
+    if (!can_open_stream())
+        return Error::from_string_literal("HTTP/2 connection can't take any more streams");
+
+    // https://www.rfc-editor.org/rfc/rfc9113#section-8.3.1
+    auto const& url = request.url();
+    StringBuilder path;
+    path.append(URL::percent_encode(url.path(), URL::PercentEncodeSet::EncodeURI));
+    if (!url.query().is_empty()) {
+        path.append('?');
+        path.append(url.query());
+    }
+    StringBuilder authority;
+    authority.append(url.host());
+    if (url.port().has_value())
+        authority.appendff(":{}", *url.port());
+
+    Vector<HPACK::Header> headers;
+    TRY(headers.try_append({ ":method", request.method_name() }));
+    TRY(headers.try_append({ ":scheme", url.scheme() }));
+    TRY(headers.try_append({ ":authority", authority.to_deprecated_string() }));
+    TRY(headers.try_append({ ":path", path.to_deprecated_string() }));
+    for (auto& header : request.headers()) {
+        // https://www.rfc-editor.org/rfc/rfc9113#section-8.2: Field names are lowercase, and connection-specific fields are not allowed.
+        auto name = header.name.to_lowercase();
+        if (name.is_one_of("connection"sv, "host"sv, "keep-alive"sv, "proxy-connection"sv, "transfer-encoding"sv, "upgrade"sv))
+            continue;
+        if (name == "te"sv && !header.value.equals_ignoring_case("trailers"sv))
+            continue;
+        TRY(headers.try_append({ move(name), header.value }));
+    }
+    if (!request.body().is_empty() || request.method() == HttpRequest::Method::POST)
+        TRY(headers.try_append({ "content-length", DeprecatedString::number(request.body().size()) }));
+
+    ByteBuffer header_block;
+    TRY(m_encoder.encode(headers, header_block));
+
+    auto body = TRY(ByteBuffer::copy(request.body()));
+    auto stream = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Stream {
+        .id = m_next_stream_id,
+        .callbacks = move(callbacks),
+        .send_window = m_peer_initial_window_size,
+        .unacknowledged_received_bytes = 0,
+        .has_received_headers = false,
+        .body = move(body),
+        .sent_body_size = 0,
+    }));
+    m_next_stream_id += 2;
+
+    // Header blocks that don't fit into a single frame continue in CONTINUATION frames.
+    ReadonlyBytes remaining_header_block = header_block;
+    auto frame_type = FrameType::Headers;
+    do {
+        auto fragment = remaining_header_block.trim(m_peer_max_frame_size);
+        remaining_header_block = remaining_header_block.slice(fragment.size());
+        u8 flags = remaining_header_block.is_empty() ? Flags::EndHeaders : 0;
+        if (frame_type == FrameType::Headers && stream->body.is_empty())
+            flags |= Flags::EndStream;
+        TRY(send_frame(frame_type, flags, stream->id, fragment));
+        frame_type = FrameType::Continuation;
+    } while (!remaining_header_block.is_empty());
+
+    auto stream_id = stream->id;
+    dbgln_if(HTTP2_DEBUG, "HTTP/2: Opened stream {} for {}", stream_id, url);
+    TRY(send_pending_data(*stream));
+    TRY(m_streams.try_set(stream_id, move(stream)));
+    return stream_id;
+}
+
+void Http2Connection::reset_stream(u32 stream_id, ErrorCode error_code)
+{
+    dbgln_if(HTTP2_DEBUG, "HTTP/2: Resetting stream {} with error {}", stream_id, to_underlying(error_code));
+    m_streams.remove(stream_id);
+    u8 payload[4];
+    write_u32(payload, to_underlying(error_code));
+    (void)send_frame(FrameType::ResetStream, 0, stream_id, { payload, sizeof(payload) });
+}
+
+void Http2Connection::did_consume_data(u32 stream_id, size_t size)
+{
+    auto* stream = find_stream(stream_id);
+    if (!stream)
+        return;
+    (void)acknowledge_consumed_data(*stream, size);
+}
+
+ErrorOr<void> Http2Connection::send_pending_data(Stream& stream)
+{
+    // https://www.rfc-editor.org/rfc/rfc9113#section-6.9: Data may only be sent while both the connection and the stream have room in their window.
+    while (stream.sent_body_size < stream.body.size()) {
+        auto window = min(m_send_window, stream.send_window);
+        if (window <= 0)
+            break;
+        auto size = min(stream.body.size() - stream.sent_body_size, min<size_t>(window, m_peer_max_frame_size));
+        bool is_last = stream.sent_body_size + size == stream.body.size();
+        TRY(send_frame(FrameType::Data, is_last ? Flags::EndStream : 0, stream.id, stream.body.bytes().slice(stream.sent_body_size, size)));
+        stream.sent_body_size += size;
+        stream.send_window -= size;
+        m_send_window -= size;
+    }
+    return {};
+}
+
+ErrorOr<void> Http2Connection::send_all_pending_data()
+{
+    for (auto& it : m_streams)
+        TRY(send_pending_data(*it.value));
+    return {};
+}
+
+ErrorOr<void> Http2Connection::acknowledge_received_data(size_t size)
+{
+    // Hand the window back once half of it is used up, so that the server never has to wait for us.
+    // The connection's window is handed back as soon as the data is received, as one slow receiver must not hold up
+    // the others. Each stream's own window bounds how much of its data can pile up in the meantime.
+    m_unacknowledged_received_bytes += size;
+    if (m_unacknowledged_received_bytes >= connection_receive_window_size / 2) {
+        TRY(send_window_update(0, m_unacknowledged_received_bytes));
+        m_unacknowledged_received_bytes = 0;
+    }
+    return {};
+}
+
+ErrorOr<void> Http2Connection::acknowledge_consumed_data(Stream& stream, size_t size)
+{
+    stream.unacknowledged_received_bytes += size;
+    if (stream.unacknowledged_received_bytes >= stream_receive_window_size / 2) {
+        TRY(send_window_update(stream.id, stream.unacknowledged_received_bytes));
+        stream.unacknowledged_received_bytes = 0;
+    }
+    return {};
+}
+
+void Http2Connection::read_from_socket()
+{
+    // As the socket is buffered, we might not get another notification for data that's still in the buffer.
+    while (true) {
+        auto can_read_without_blocking = m_socket.can_read_without_blocking();
+        if (can_read_without_blocking.is_error())
+            return fail_connection(ErrorCode::InternalError, Core::NetworkJob::Error::TransmissionFailed);
+        if (!can_read_without_blocking.value())
+            break;
+
+        auto old_size = m_received_data.size();
+        if (m_received_data.try_resize(old_size + 64 * KiB).is_error())
+            return fail_connection(ErrorCode::InternalError, Core::NetworkJob::Error::TransmissionFailed);
+        auto result = m_socket.read(m_received_data.bytes().slice(old_size));
+        if (result.is_error() && result.error().is_errno() && result.error().code() == EINTR) {
+            m_received_data.resize(old_size);
+            continue;
+        }
+        if (result.is_error()) {
+            dbgln_if(HTTP2_DEBUG, "HTTP/2: Failed to read from socket: {}", result.error());
+            return fail_connection(ErrorCode::InternalError, Core::NetworkJob::Error::TransmissionFailed);
+        }
+        m_received_data.resize(old_size + result.value().size());
+        if (result.value().is_empty())
+            break;
+    }
+
+    size_t offset = 0;
+    while (m_received_data.size() - offset >= frame_header_size) {
+        auto frame = m_received_data.bytes().slice(offset);
+        size_t length = (frame[0] << 16) | (frame[1] << 8) | frame[2];
+        if (length > max_received_frame_size)
+            return fail_connection(ErrorCode::FrameSizeError, Core::NetworkJob::Error::ProtocolFailed);
+        if (frame.size() < frame_header_size + length)
+            break;
+        auto type = static_cast<FrameType>(frame[3]);
+        auto flags = frame[4];
+        auto stream_id = read_u32(frame.slice(5)) & 0x7fffffff;
+        offset += frame_header_size + length;
+
+        dbgln_if(HTTP2_DEBUG, "HTTP/2: Received frame of type {} with flags {:#x} and {} bytes for stream {}", to_underlying(type), flags, length, stream_id);
+        if (auto result = handle_frame(type, flags, stream_id, frame.slice(frame_header_size, length)); result.is_error())
+            return fail_connection(result.error(), Core::NetworkJob::Error::ProtocolFailed);
+    }
+    if (offset > 0) {
+        auto remaining = m_received_data.size() - offset;
+        memmove(m_received_data.data(), m_received_data.data() + offset, remaining);
+        m_received_data.resize(remaining);
+    }
+
+    if (m_socket.is_eof() || !m_socket.is_open()) {
+        dbgln_if(HTTP2_DEBUG, "HTTP/2: Connection closed with {} streams left", m_streams.size());
+        m_is_going_away = true;
+        fail_all_streams(Core::NetworkJob::Error::TransmissionFailed);
+    }
+}
+
+ErrorOr<void, Http2Connection::ErrorCode> Http2Connection::handle_frame(FrameType type, u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    // https://www.rfc-editor.org/rfc/rfc9113#section-6.10: Nothing may come between the frames of a header block.
+    if (m_header_block_stream_id.has_value() && (type != FrameType::Continuation || stream_id != *m_header_block_stream_id))
+        return ErrorCode::ProtocolError;
+
+    switch (type) {
+    case FrameType::Data:
+        return handle_data(flags, stream_id, payload);
+    case FrameType::Headers:
+        return handle_headers(flags, stream_id, payload);
+    case FrameType::Continuation:
+        if (!m_header_block_stream_id.has_value())
+            return ErrorCode::ProtocolError;
+        if (m_header_block.try_append(payload).is_error())
+            return ErrorCode::InternalError;
+        if (flags & Flags::EndHeaders)
+            return handle_header_block(stream_id, m_header_block_ends_stream);
+        return {};
+    case FrameType::Priority:
+        // We don't prioritize anything.
+        return {};
+    case FrameType::ResetStream: {
+        if (stream_id == 0)
+            return ErrorCode::ProtocolError;
+        if (payload.size() != 4)
+            return ErrorCode::FrameSizeError;
+        auto error_code = static_cast<ErrorCode>(read_u32(payload));
+        dbgln_if(HTTP2_DEBUG, "HTTP/2: Server reset stream {} with error {}", stream_id, to_underlying(error_code));
+        // A refused stream was not processed at all, so it is safe to try again on another connection.
+        fail_stream(stream_id, error_code == ErrorCode::RefusedStream ? Core::NetworkJob::Error::ConnectionFailed : Core::NetworkJob::Error::TransmissionFailed);
+        return {};
+    }
+    case FrameType::Settings:
+        return handle_settings(flags, stream_id, payload);
+    case FrameType::PushPromise:
+        // We told the server not to push anything.
+        return ErrorCode::ProtocolError;
+    case FrameType::Ping:
+        if (stream_id != 0)
+            return ErrorCode::ProtocolError;
+        if (payload.size() != 8)
+            return ErrorCode::FrameSizeError;
+        if (!(flags & Flags::Ack) && send_frame(FrameType::Ping, Flags::Ack, 0, payload).is_error())
+            return ErrorCode::InternalError;
+        return {};
+    case FrameType::GoAway:
+        return handle_go_away(stream_id, payload);
+    case FrameType::WindowUpdate:
+        return handle_window_update(stream_id, payload);
+    }
+
+    // https://www.rfc-editor.org/rfc/rfc9113#section-5.5: Unknown frame types are ignored.
+    return {};
+}
+
+ErrorOr<void, Http2Connection::ErrorCode> Http2Connection::handle_data(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id == 0)
+        return ErrorCode::ProtocolError;
+
+    // Flow control covers the entire frame, even for a stream we've already reset.
+    auto* stream = find_stream(stream_id);
+    if (acknowledge_received_data(payload.size()).is_error())
+        return ErrorCode::InternalError;
+    auto frame_size = payload.size();
+    if (flags & Flags::Padded)
+        payload = TRY(remove_padding(payload));
+    if (!stream)
+        return {};
+    // The receiver only tells us about the data it has consumed, the padding is gone right away.
+    if (acknowledge_consumed_data(*stream, frame_size - payload.size()).is_error())
+        return ErrorCode::InternalError;
+
+    if (!stream->has_received_headers) {
+        fail_stream(stream_id, Core::NetworkJob::Error::ProtocolFailed);
+        reset_stream(stream_id, ErrorCode::ProtocolError);
+        return {};
+    }
+    if (!payload.is_empty())
+        stream->callbacks.on_data(payload);
+    if (flags & Flags::EndStream)
+        finish_stream(stream_id);
+    return {};
+}
+
+ErrorOr<void, Http2Connection::ErrorCode> Http2Connection::handle_headers(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id == 0)
+        return ErrorCode::ProtocolError;
+    if (flags & Flags::Padded)
+        payload = TRY(remove_padding(payload));
+    if (flags & Flags::Priority) {
+        if (payload.size() < 5)
+            return ErrorCode::FrameSizeError;
+        payload = payload.slice(5);
+    }
+
+    m_header_block.clear();
+    if (m_header_block.try_append(payload).is_error())
+        return ErrorCode::InternalError;
+    m_header_block_stream_id = stream_id;
+    m_header_block_ends_stream = flags & Flags::EndStream;
+    if (flags & Flags::EndHeaders)
+        return handle_header_block(stream_id, m_header_block_ends_stream);
+    return {};
+}
+
+ErrorOr<void, Http2Connection::ErrorCode> Http2Connection::handle_header_block(u32 stream_id, bool ends_stream)
+{
+    m_header_block_stream_id.clear();
+
+    // The decoder's dynamic table is shared by the entire connection, so every header block has to be decoded.
+    auto headers_or_error = m_decoder.decode(m_header_block);
+    m_header_block.clear();
+    if (headers_or_error.is_error()) {
+        dbgln_if(HTTP2_DEBUG, "HTTP/2: Failed to decode headers for stream {}: {}", stream_id, headers_or_error.error());
+        return ErrorCode::CompressionError;
+    }
+
+    auto* stream = find_stream(stream_id);
+    if (!stream)
+        return {};
+
+    if (stream->has_received_headers) {
+        // Trailers, which we have no use for.
+        if (ends_stream)
+            finish_stream(stream_id);
+        return {};
+    }
+
+    Optional<u32> status_code;
+    Vector<HPACK::Header> headers;
+    for (auto& header : headers_or_error.value()) {
+        if (header.name == ":status"sv)
+            status_code = header.value.to_uint();
+        else if (!header.name.starts_with(':'))
+            headers.append(move(header));
+    }
+    if (!status_code.has_value()) {
+        fail_stream(stream_id, Core::NetworkJob::Error::ProtocolFailed);
+        reset_stream(stream_id, ErrorCode::ProtocolError);
+        return {};
+    }
+
+    // Informational responses are followed by the actual response on the same stream.
+    if (*status_code >= 100 && *status_code < 200)
+        return {};
+
+    stream->has_received_headers = true;
+    stream->callbacks.on_headers(*status_code, move(headers));
+    if (ends_stream)
+        finish_stream(stream_id);
+    return {};
+}
+
+ErrorOr<void, Http2Connection::ErrorCode> Http2Connection::handle_settings(u8 flags, u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id != 0)
+        return ErrorCode::ProtocolError;
+    if (flags & Flags::Ack) {
+        if (!payload.is_empty())
+            return ErrorCode::FrameSizeError;
+        return {};
+    }
+    if (payload.size() % 6 != 0)
+        return ErrorCode::FrameSizeError;
+
+    for (size_t offset = 0; offset < payload.size(); offset += 6) {
+        auto parameter = static_cast<SettingsParameter>((payload[offset] << 8) | payload[offset + 1]);
+        auto value = read_u32(payload.slice(offset + 2));
+        dbgln_if(HTTP2_DEBUG, "HTTP/2: Server setting {} = {}", to_underlying(parameter), value);
+        switch (parameter) {
+        case SettingsParameter::MaxConcurrentStreams:
+            m_peer_max_concurrent_streams = value;
+            break;
+        case SettingsParameter::InitialWindowSize: {
+            if (value > max_window_size)
+                return ErrorCode::FlowControlError;
+            // https://www.rfc-editor.org/rfc/rfc9113#section-6.9.2: This changes the windows of all open streams as well.
+            auto delta = static_cast<i64>(value) - m_peer_initial_window_size;
+            for (auto& it : m_streams) {
+                it.value->send_window += delta;
+                if (it.value->send_window > max_window_size)
+                    return ErrorCode::FlowControlError;
+            }
+            m_peer_initial_window_size = value;
+            break;
+        }
+        case SettingsParameter::MaxFrameSize:
+            if (value < 16384 || value > 0xffffff)
+                return ErrorCode::ProtocolError;
+            m_peer_max_frame_size = value;
+            break;
+        default:
+            // We never add anything to the dynamic table, and don't accept any pushes.
+            break;
+        }
+    }
+
+    if (send_frame(FrameType::Settings, Flags::Ack, 0, {}).is_error())
+        return ErrorCode::InternalError;
+    if (send_all_pending_data().is_error())
+        return ErrorCode::InternalError;
+    return {};
+}
+
+ErrorOr<void, Http2Connection::ErrorCode> Http2Connection::handle_window_update(u32 stream_id, ReadonlyBytes payload)
+{
+    if (payload.size() != 4)
+        return ErrorCode::FrameSizeError;
+    auto increment = read_u32(payload) & 0x7fffffff;
+
+    if (stream_id == 0) {
+        if (increment == 0)
+            return ErrorCode::ProtocolError;
+        m_send_window += increment;
+        if (m_send_window > max_window_size)
+            return ErrorCode::FlowControlError;
+        if (send_all_pending_data().is_error())
+            return ErrorCode::InternalError;
+        return {};
+    }
+
+    auto* stream = find_stream(stream_id);
+    if (!stream)
+        return {};
+    stream->send_window += increment;
+    if (increment == 0 || stream->send_window > max_window_size) {
+        fail_stream(stream_id, Core::NetworkJob::Error::ProtocolFailed);
+        reset_stream(stream_id, increment == 0 ? ErrorCode::ProtocolError : ErrorCode::FlowControlError);
+        return {};
+    }
+    if (send_pending_data(*stream).is_error())
+        return ErrorCode::InternalError;
+    return {};
+}
+
+ErrorOr<void, Http2Connection::ErrorCode> Http2Connection::handle_go_away(u32 stream_id, ReadonlyBytes payload)
+{
+    if (stream_id != 0)
+        return ErrorCode::ProtocolError;
+    if (payload.size() < 8)
+        return ErrorCode::FrameSizeError;
+
+    auto last_stream_id = read_u32(payload) & 0x7fffffff;
+    auto error_code = read_u32(payload.slice(4));
+    dbgln_if(HTTP2_DEBUG, "HTTP/2: Server is going away after stream {} with error {}", last_stream_id, error_code);
+
+    // The streams after the last one the server processed can safely be retried on another connection.
+    m_is_going_away = true;
+    fail_all_streams(Core::NetworkJob::Error::ConnectionFailed, last_stream_id);
+    return {};
+}
+
+Http2Connection::Stream* Http2Connection::find_stream(u32 stream_id)
+{
+    auto it = m_streams.find(stream_id);
+    if (it == m_streams.end())
+        return nullptr;
+    return it->value.ptr();
+}
+
+void Http2Connection::finish_stream(u32 stream_id)
+{
+    auto stream = m_streams.take(stream_id);
+    if (!stream.has_value())
+        return;
+    dbgln_if(HTTP2_DEBUG, "HTTP/2: Stream {} finished", stream_id);
+    (*stream)->callbacks.on_finish();
+}
+
+void Http2Connection::fail_stream(u32 stream_id, Core::NetworkJob::Error error)
+{
+    auto stream = m_streams.take(stream_id);
+    if (!stream.has_value())
+        return;
+    (*stream)->callbacks.on_error(error);
+}
+
+void Http2Connection::fail_all_streams(Core::NetworkJob::Error error, u32 after_stream_id)
+{
+    Vector<u32> stream_ids;
+    for (auto& it : m_streams) {
+        if (it.key > after_stream_id)
+            stream_ids.append(it.key);
+    }
+    for (auto stream_id : stream_ids)
+        fail_stream(stream_id, error);
+}
+
+void Http2Connection::fail_connection(ErrorCode error_code, Core::NetworkJob::Error error)
+{
+    dbgln("HTTP/2: Connection error {}", to_underlying(error_code));
+
+    // https://www.rfc-editor.org/rfc/rfc9113#section-5.4.1: We never accept any streams from the server, so the last one is 0.
+    if (!m_is_going_away) {
+        u8 payload[8];
+        write_u32(payload, 0);
+        write_u32(payload + 4, to_underlying(error_code));
+        (void)send_frame(FrameType::GoAway, 0, 0, { payload, sizeof(payload) });
+    }
+    m_is_going_away = true;
+    fail_all_streams(error);
+    m_socket.close();
+}
+
+}
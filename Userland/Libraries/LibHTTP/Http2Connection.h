@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Weakable.h>
+#include <LibCore/NetworkJob.h>
+#include <LibCore/Stream.h>
+#include <LibHTTP/HPACK.h>
+#include <LibHTTP/HttpRequest.h>
+
+namespace HTTP {
+
+// The client side of an HTTP/2 connection (RFC 9113), multiplexing any number of requests over one socket.
+// The connection does not own the socket; whoever owns both must destroy the connection first.
+class Http2Connection : public Weakable<Http2Connection> {
+public:
+    // https://www.rfc-editor.org/rfc/rfc9113#section-7
+    enum class ErrorCode : u32 {
+        NoError = 0x0,
+        ProtocolError = 0x1,
+        InternalError = 0x2,
+        FlowControlError = 0x3,
+        SettingsTimeout = 0x4,
+        StreamClosed = 0x5,
+        FrameSizeError = 0x6,
+        RefusedStream = 0x7,
+        Cancel = 0x8,
+        CompressionError = 0x9,
+        ConnectError = 0xa,
+        EnhanceYourCalm = 0xb,
+        InadequateSecurity = 0xc,
+        Http11Required = 0xd,
+    };
+
+    struct StreamCallbacks {
+        // Called once, with the final (non-1xx) response headers, without any pseudo-header fields.
+        Function<void(u32 status_code, Vector<HPACK::Header> headers)> on_headers;
+        Function<void(ReadonlyBytes)> on_data;
+        Function<void()> on_finish;
+        Function<void(Core::NetworkJob::Error)> on_error;
+    };
+
+    static ErrorOr<NonnullOwnPtr<Http2Connection>> try_create(Core::Stream::BufferedSocketBase&);
+    ~Http2Connection();
+
+    ErrorOr<u32> open_stream(HttpRequest const&, StreamCallbacks);
+    void reset_stream(u32 stream_id, ErrorCode = ErrorCode::Cancel);
+    // The server may only send as much data on a stream as its receiver has room for, so the receiver has to tell us
+    // whenever it is done with some of the data it was given.
+    void did_consume_data(u32 stream_id, size_t);
+
+    bool can_open_stream() const;
+    size_t active_stream_count() const { return m_streams.size(); }
+    bool is_going_away() const { return m_is_going_away; }
+
+private:
+    // https://www.rfc-editor.org/rfc/rfc9113#section-6
+    enum class FrameType : u8 {
+        Data = 0x0,
+        Headers = 0x1,
+        Priority = 0x2,
+        ResetStream = 0x3,
+        Settings = 0x4,
+        PushPromise = 0x5,
+        Ping = 0x6,
+        GoAway = 0x7,
+        WindowUpdate = 0x8,
+        Continuation = 0x9,
+    };
+
+    struct Stream {
+        u32 id { 0 };
+        StreamCallbacks callbacks;
+        i64 send_window { 0 };
+        size_t unacknowledged_received_bytes { 0 };
+        bool has_received_headers { false };
+
+        // The request body, sent as fast as flow control allows.
+        ByteBuffer body;
+        size_t sent_body_size { 0 };
+    };
+
+    explicit Http2Connection(Core::Stream::BufferedSocketBase&);
+
+    ErrorOr<void> send_connection_preface();
+    ErrorOr<void> send_frame(FrameType, u8 flags, u32 stream_id, ReadonlyBytes payload);
+    ErrorOr<void> send_window_update(u32 stream_id, u32 increment);
+    ErrorOr<void> send_pending_data(Stream&);
+    ErrorOr<void> send_all_pending_data();
+    ErrorOr<void> acknowledge_received_data(size_t);
+    ErrorOr<void> acknowledge_consumed_data(Stream&, size_t);
+
+    void read_from_socket();
+    ErrorOr<void, ErrorCode> handle_frame(FrameType, u8 flags, u32 stream_id, ReadonlyBytes payload);
+    ErrorOr<void, ErrorCode> handle_data(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    ErrorOr<void, ErrorCode> handle_headers(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    ErrorOr<void, ErrorCode> handle_header_block(u32 stream_id, bool ends_stream);
+    ErrorOr<void, ErrorCode> handle_settings(u8 flags, u32 stream_id, ReadonlyBytes payload);
+    ErrorOr<void, ErrorCode> handle_window_update(u32 stream_id, ReadonlyBytes payload);
+    ErrorOr<void, ErrorCode> handle_go_away(u32 stream_id, ReadonlyBytes payload);
+
+    Stream* find_stream(u32 stream_id);
+    void finish_stream(u32 stream_id);
+    void fail_stream(u32 stream_id, Core::NetworkJob::Error);
+    void fail_all_streams(Core::NetworkJob::Error, u32 after_stream_id = 0);
+    void fail_connection(ErrorCode, Core::NetworkJob::Error);
+
+    Core::Stream::BufferedSocketBase& m_socket;
+    HashMap<u32, NonnullOwnPtr<Stream>> m_streams;
+    u32 m_next_stream_id { 1 };
+    bool m_is_going_away { false };
+
+    HPACK::Encoder m_encoder;
+    HPACK::Decoder m_decoder;
+
+    ByteBuffer m_received_data;
+
+    // A header block that is split over HEADERS and CONTINUATION frames, which have to follow each other directly.
+    ByteBuffer m_header_block;
+    Optional<u32> m_header_block_stream_id;
+    bool m_header_block_ends_stream { false };
+
+    // https://www.rfc-editor.org/rfc/rfc9113#section-6.5.2: The server's settings, until it tells us otherwise.
+    u32 m_peer_max_concurrent_streams { 100 };
+    u32 m_peer_initial_window_size { 65535 };
+    u32 m_peer_max_frame_size { 16384 };
+
+    i64 m_send_window { 65535 };
+    size_t m_unacknowledged_received_bytes { 0 };
+};
+
+}
@@ -8,11 +8,7 @@
 #include <AK/CharacterTypes.h>
 #include <AK/Debug.h>
 #include <AK/JsonObject.h>
-#include <AK/MemoryStream.h>
 #include <AK/Try.h>
-#include <LibCompress/Brotli.h>
-#include <LibCompress/Gzip.h>
-#include <LibCompress/Zlib.h>
 #include <LibCore/Event.h>
 #include <LibHTTP/HttpResponse.h>
 #include <LibHTTP/Job.h>
@@ -21,70 +17,8 @@
 
 namespace HTTP {
 
-static ErrorOr<ByteBuffer> handle_content_encoding(ByteBuffer const& buf, DeprecatedString const& content_encoding)
-{
-    dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: buf has content_encoding={}", content_encoding);
-
-    // FIXME: Actually do the decompression of the data using streams, instead of all at once when everything has been
-    //        received. This will require that some of the decompression algorithms are implemented in a streaming way.
-    //        Gzip and Deflate are implemented using AK::Stream, while Brotli uses the newer Core::Stream. The Gzip and
-    //        Deflate implementations will likely need to be changed to LibCore::Stream for this to work easily.
-
-    if (content_encoding == "gzip") {
-        if (!Compress::GzipDecompressor::is_likely_compressed(buf)) {
-            dbgln("Job::handle_content_encoding: buf is not gzip compressed!");
-        }
-
-        dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: buf is gzip compressed!");
-
-        auto uncompressed = TRY(Compress::GzipDecompressor::decompress_all(buf));
-
-        if constexpr (JOB_DEBUG) {
-            dbgln("Job::handle_content_encoding: Gzip::decompress() successful.");
-            dbgln("  Input size: {}", buf.size());
-            dbgln("  Output size: {}", uncompressed.size());
-        }
-
-        return uncompressed;
-    } else if (content_encoding == "deflate") {
-        dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: buf is deflate compressed!");
-
-        // Even though the content encoding is "deflate", it's actually deflate with the zlib wrapper.
-        // https://tools.ietf.org/html/rfc7230#section-4.2.2
-        auto uncompressed = Compress::ZlibDecompressor::decompress_all(buf);
-        if (!uncompressed.has_value()) {
-            // From the RFC:
-            // "Note: Some non-conformant implementations send the "deflate"
-            //        compressed data without the zlib wrapper."
-            dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: ZlibDecompressor::decompress_all() failed. Trying DeflateDecompressor::decompress_all()");
-            uncompressed = TRY(Compress::DeflateDecompressor::decompress_all(buf));
-        }
-
-        if constexpr (JOB_DEBUG) {
-            dbgln("Job::handle_content_encoding: Deflate decompression successful.");
-            dbgln("  Input size: {}", buf.size());
-            dbgln("  Output size: {}", uncompressed.value().size());
-        }
-
-        return uncompressed.release_value();
-    } else if (content_encoding == "br") {
-        dbgln_if(JOB_DEBUG, "Job::handle_content_encoding: buf is brotli compressed!");
-
-        auto bufstream = TRY(FixedMemoryStream::construct({ buf.data(), buf.size() }));
-        auto brotli_stream = Compress::BrotliDecompressionStream { *bufstream };
-
-        auto uncompressed = TRY(brotli_stream.read_until_eof());
-        if constexpr (JOB_DEBUG) {
-            dbgln("Job::handle_content_encoding: Brotli::decompress() successful.");
-            dbgln("  Input size: {}", buf.size());
-            dbgln("  Output size: {}", uncompressed.size());
-        }
-
-        return uncompressed;
-    }
-
-    return buf;
-}
+// How much of the body may wait for the client before we stop reading more of it from the server.
+static constexpr size_t max_pending_body_size = 1 * MiB;
 
 Job::Job(HttpRequest&& request, AK::Stream& output_stream)
     : Core::NetworkJob(output_stream)
@@ -92,6 +26,12 @@ Job::Job(HttpRequest&& request, AK::Stream& output_stream)
 {
 }
 
+Job::~Job()
+{
+    if (m_http2_stream_id.has_value() && m_http2_connection)
+        m_http2_connection->reset_stream(*m_http2_stream_id);
+}
+
 void Job::start(Core::Stream::Socket& socket)
 {
     VERIFY(!m_socket);
@@ -103,10 +43,94 @@ void Job::start(Core::Stream::Socket& socket)
     });
 }
 
+void Job::start_with_http2(Core::Stream::Socket& socket, Http2Connection& connection)
+{
+    VERIFY(!m_socket);
+    m_socket = static_cast<Core::Stream::BufferedSocketBase*>(&socket);
+    m_uses_http2 = true;
+    m_http2_connection = connection;
+    dbgln_if(HTTPJOB_DEBUG, "Opening an HTTP/2 stream for {}", url());
+
+    // The stream has to be opened right away, so that the connection knows how many streams it has left for other jobs.
+    auto stream_id = connection.open_stream(m_request,
+        {
+            .on_headers = [this](auto status_code, auto headers) { on_http2_headers_received(status_code, move(headers)); },
+            .on_data = [this](auto data) { on_http2_data_received(data); },
+            .on_finish = [this] {
+                m_http2_stream_id.clear();
+                finish_up();
+            },
+            .on_error = [this](auto error) {
+                m_http2_stream_id.clear();
+                deferred_invoke([this, error] { did_fail(error); });
+            },
+        });
+    if (stream_id.is_error()) {
+        dbgln("Job: Failed to open an HTTP/2 stream for {}: {}", url(), stream_id.error());
+        deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
+        return;
+    }
+    m_http2_stream_id = stream_id.release_value();
+}
+
+void Job::on_http2_headers_received(u32 status_code, Vector<HPACK::Header> headers)
+{
+    m_code = status_code;
+    for (auto& header : headers) {
+        if (header.name == "set-cookie"sv) {
+            m_set_cookie_headers.append(move(header.value));
+            continue;
+        }
+        if (header.name == "content-length"sv) {
+            if (auto length = header.value.to_uint(); length.has_value())
+                m_content_length = length.value();
+        }
+        if (auto existing_value = m_headers.get(header.name); existing_value.has_value())
+            m_headers.set(header.name, DeprecatedString::formatted("{},{}", existing_value.value(), header.value));
+        else
+            m_headers.set(header.name, move(header.value));
+    }
+    if (!m_set_cookie_headers.is_empty())
+        m_headers.set("Set-Cookie", JsonArray { m_set_cookie_headers }.to_deprecated_string());
+
+    if (create_content_decoder().is_error()) {
+        m_http2_connection->reset_stream(m_http2_stream_id.release_value());
+        return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
+    }
+
+    if (on_headers_received)
+        on_headers_received(m_headers, m_code);
+    m_state = State::InBody;
+}
+
+void Job::on_http2_data_received(ReadonlyBytes data)
+{
+    m_unconsumed_http2_data_size += data.size();
+    auto buffer = ByteBuffer::copy(data);
+    if (buffer.is_error() || receive_body_data(buffer.release_value()).is_error()) {
+        m_http2_connection->reset_stream(m_http2_stream_id.release_value());
+        return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
+    }
+
+    deferred_invoke([this] { did_progress(m_content_length, m_received_size); });
+}
+
 void Job::shutdown(ShutdownMode mode)
 {
     if (!m_socket)
         return;
+    // The socket might be reused for another request, which expects to hear from it.
+    if (m_is_receiving_paused) {
+        m_socket->set_notifications_enabled(true);
+        m_is_receiving_paused = false;
+    }
+    if (m_uses_http2) {
+        // Other streams are still using the socket, so all we can do is to stop our own.
+        if (m_http2_stream_id.has_value() && m_http2_connection)
+            m_http2_connection->reset_stream(m_http2_stream_id.release_value());
+        m_socket = nullptr;
+        return;
+    }
     if (mode == ShutdownMode::CloseSocket) {
         m_socket->close();
         m_socket->on_ready_to_read = nullptr;
@@ -116,9 +140,84 @@ void Job::shutdown(ShutdownMode mode)
     }
 }
 
-void Job::flush_received_buffers()
+ErrorOr<void> Job::create_content_decoder()
 {
-    if (!m_can_stream_response || m_buffered_size == 0)
+    auto content_encoding = m_headers.get("Content-Encoding"sv);
+    if (!content_encoding.has_value())
+        return {};
+    m_content_decoder = TRY(ContentDecoder::create(*content_encoding));
+    return {};
+}
+
+ErrorOr<void> Job::receive_body_data(ByteBuffer data)
+{
+    m_received_size += data.size();
+    if (m_content_decoder) {
+        TRY(m_content_decoder->append(data));
+    } else {
+        m_buffered_size += data.size();
+        m_received_buffers.append(make<ReceivedBuffer>(move(data)));
+    }
+    return flush_received_buffers();
+}
+
+size_t Job::pending_body_size() const
+{
+    return m_buffered_size + (m_content_decoder ? m_content_decoder->buffered_input_size() : 0);
+}
+
+ErrorOr<void> Job::flush_received_buffers()
+{
+    while (true) {
+        write_received_buffers();
+
+        // More of the body is only decoded once the client has taken everything else, so that it stays encoded (and small)
+        // for as long as the client can't keep up.
+        if (m_buffered_size != 0 || !m_content_decoder)
+            break;
+        auto decoded = TRY(m_content_decoder->decode(m_state == State::Finished));
+        if (decoded.is_empty())
+            break;
+        m_buffered_size += decoded.size();
+        m_received_buffers.append(make<ReceivedBuffer>(move(decoded)));
+    }
+
+    if (pending_body_size() < max_pending_body_size / 2) {
+        if (m_unconsumed_http2_data_size != 0 && m_http2_stream_id.has_value() && m_http2_connection)
+            m_http2_connection->did_consume_data(*m_http2_stream_id, exchange(m_unconsumed_http2_data_size, 0));
+        if (m_is_receiving_paused && m_socket)
+            resume_receiving();
+    }
+
+    // We don't get to know when the client is ready for more, so we just have to try again in a bit.
+    if (m_buffered_size != 0 && !has_timer())
+        start_timer(50);
+    return {};
+}
+
+void Job::pause_receiving()
+{
+    dbgln_if(JOB_DEBUG, "Job: Have {} bytes of the body waiting for the client, pausing {}", pending_body_size(), m_request.url());
+    m_is_receiving_paused = true;
+    m_socket->set_notifications_enabled(false);
+}
+
+void Job::resume_receiving()
+{
+    dbgln_if(JOB_DEBUG, "Job: Resuming {}", m_request.url());
+    m_is_receiving_paused = false;
+    m_socket->set_notifications_enabled(true);
+
+    // The socket is buffered, so it may well hold data that we won't be notified about.
+    deferred_invoke([this] {
+        if (m_socket && m_socket->on_ready_to_read)
+            m_socket->on_ready_to_read();
+    });
+}
+
+void Job::write_received_buffers()
+{
+    if (m_buffered_size == 0)
         return;
     dbgln_if(JOB_DEBUG, "Job: Flushing received buffers: have {} bytes in {} buffers for {}", m_buffered_size, m_received_buffers.size(), m_request.url());
     for (size_t i = 0; i < m_received_buffers.size(); ++i) {
@@ -160,7 +259,7 @@ void Job::register_on_ready_to_read(Function<void()> callback)
         auto can_read_without_blocking = m_socket->can_read_without_blocking();
         if (can_read_without_blocking.is_error())
             return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
-        if (can_read_without_blocking.value() && m_state != State::Finished && !has_error()) {
+        if (can_read_without_blocking.value() && m_state != State::Finished && !m_is_receiving_paused && !has_error()) {
             deferred_invoke([this] {
                 if (m_socket && m_socket->on_ready_to_read)
                     m_socket->on_ready_to_read();
@@ -318,6 +417,8 @@ void Job::on_socket_connected()
                     on_headers_received(m_headers, m_code > 0 ? m_code : Optional<u32> {});
                 }
                 m_state = State::InBody;
+                if (create_content_decoder().is_error())
+                    return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
 
                 // We've reached the end of the headers, there's a possibility that the server
                 // responds with nothing (content-length = 0 with normal encoding); if that's the case,
@@ -329,7 +430,9 @@ void Job::on_socket_connected()
                 // There's also the possibility that the server responds with 204 (No Content),
                 // and manages to set a Content-Length anyway, in such cases ignore Content-Length and quit early;
                 // As the HTTP spec explicitly prohibits presence of Content-Length when the response code is 204.
-                if (m_code == 204)
+                // The same goes for 304 (Not Modified) and for responses to HEAD requests, both of which may
+                // well come with the Content-Length of a body that is never sent (RFC 9112, section 6.3).
+                if (m_code == 204 || m_code == 304 || m_request.method() == HttpRequest::Method::HEAD)
                     return finish_up();
 
                 break;
@@ -375,11 +478,7 @@ void Job::on_socket_connected()
             } else {
                 m_headers.set(name, value);
             }
-            if (name.equals_ignoring_case("Content-Encoding"sv)) {
-                // Assume that any content-encoding means that we can't decode it as a stream :(
-                dbgln_if(JOB_DEBUG, "Content-Encoding {} detected, cannot stream output :(", value);
-                m_can_stream_response = false;
-            } else if (name.equals_ignoring_case("Content-Length"sv)) {
+            if (name.equals_ignoring_case("Content-Length"sv)) {
                 auto length = value.to_uint();
                 if (length.has_value())
                     m_content_length = length.value();
@@ -397,6 +496,11 @@ void Job::on_socket_connected()
         VERIFY(m_state == State::InBody);
 
         while (true) {
+            if (pending_body_size() >= max_pending_body_size) {
+                pause_receiving();
+                break;
+            }
+
             auto can_read_without_blocking = m_socket->can_read_without_blocking();
             if (can_read_without_blocking.is_error())
                 return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
@@ -409,6 +513,17 @@ void Job::on_socket_connected()
                 auto remaining = m_current_chunk_remaining_size.value();
                 if (remaining == -1) {
                     // read size
+                    // Note: A partial line would be read as well, so we have to wait until the entire line has arrived.
+                    auto can_read_line = m_socket->can_read_line();
+                    if (can_read_line.is_error())
+                        return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
+                    if (!can_read_line.value()) {
+                        if (!m_socket->is_eof())
+                            break;
+                        dbgln("Job: Reached end of stream");
+                        finish_up();
+                        break;
+                    }
                     auto maybe_size_data = read_line(PAGE_SIZE);
                     if (maybe_size_data.is_error()) {
                         dbgln_if(JOB_DEBUG, "Job: Could not receive chunk: {}", maybe_size_data.error());
@@ -488,7 +603,8 @@ void Job::on_socket_connected()
                 break;
 
             dbgln_if(JOB_DEBUG, "Waiting for payload for {}", m_request.url());
-            auto maybe_payload = receive(read_size);
+            // Note: A chunk can be arbitrarily large, but we never take in more than 64 KiB of it at once.
+            auto maybe_payload = receive(min(read_size, 64 * KiB));
             if (maybe_payload.is_error()) {
                 dbgln_if(JOB_DEBUG, "Could not read the payload: {}", maybe_payload.error());
                 return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
@@ -510,10 +626,9 @@ void Job::on_socket_connected()
                 }
             }
 
-            m_received_buffers.append(make<ReceivedBuffer>(payload));
-            m_buffered_size += payload.size();
-            m_received_size += payload.size();
-            flush_received_buffers();
+            auto payload_size = payload.size();
+            if (receive_body_data(move(payload)).is_error())
+                return deferred_invoke([this] { did_fail(Core::NetworkJob::Error::TransmissionFailed); });
 
             deferred_invoke([this] { did_progress(m_content_length, m_received_size); });
 
@@ -532,7 +647,7 @@ void Job::on_socket_connected()
             }
 
             if (m_current_chunk_remaining_size.has_value()) {
-                auto size = m_current_chunk_remaining_size.value() - payload.size();
+                auto size = m_current_chunk_remaining_size.value() - payload_size;
 
                 dbgln_if(JOB_DEBUG, "Job: We have {} bytes left over in this chunk", size);
                 if (size == 0) {
@@ -574,7 +689,12 @@ void Job::on_socket_connected()
 void Job::timer_event(Core::TimerEvent& event)
 {
     event.accept();
-    finish_up();
+    if (m_state == State::Finished) {
+        finish_up();
+    } else if (flush_received_buffers().is_error()) {
+        stop_timer();
+        return did_fail(Core::NetworkJob::Error::TransmissionFailed);
+    }
     if (m_buffered_size == 0)
         stop_timer();
 }
@@ -583,43 +703,17 @@ void Job::finish_up()
 {
     VERIFY(!m_has_scheduled_finish);
     m_state = State::Finished;
-    if (!m_can_stream_response) {
-        auto maybe_flattened_buffer = ByteBuffer::create_uninitialized(m_buffered_size);
-        if (maybe_flattened_buffer.is_error())
-            return did_fail(Core::NetworkJob::Error::TransmissionFailed);
-        auto flattened_buffer = maybe_flattened_buffer.release_value();
-
-        u8* flat_ptr = flattened_buffer.data();
-        for (auto& received_buffer : m_received_buffers) {
-            memcpy(flat_ptr, received_buffer.pending_flush.data(), received_buffer.pending_flush.size());
-            flat_ptr += received_buffer.pending_flush.size();
-        }
-        m_received_buffers.clear();
-
-        // For the time being, we cannot stream stuff with content-encoding set to _anything_.
-        // FIXME: LibCompress exposes a streaming interface, so this can be resolved
-        auto content_encoding = m_headers.get("Content-Encoding");
-        if (content_encoding.has_value()) {
-            if (auto result = handle_content_encoding(flattened_buffer, content_encoding.value()); !result.is_error())
-                flattened_buffer = result.release_value();
-            else
-                return did_fail(Core::NetworkJob::Error::TransmissionFailed);
-        }
 
-        m_buffered_size = flattened_buffer.size();
-        m_received_buffers.append(make<ReceivedBuffer>(move(flattened_buffer)));
-        m_can_stream_response = true;
+    if (flush_received_buffers().is_error()) {
+        stop_timer();
+        return did_fail(Core::NetworkJob::Error::TransmissionFailed);
     }
-
-    flush_received_buffers();
     if (m_buffered_size != 0) {
         // We have to wait for the client to consume all the downloaded data
         // before we can actually call `did_finish`. in a normal flow, this should
         // never be hit since the client is reading as we are writing, unless there
         // are too many concurrent downloads going on.
         dbgln_if(JOB_DEBUG, "Flush finished with {} bytes remaining, will try again later", m_buffered_size);
-        if (!has_timer())
-            start_timer(50);
         return;
     }
 
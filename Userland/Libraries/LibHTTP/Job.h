@@ -9,7 +9,10 @@
 #include <AK/HashMap.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/Optional.h>
+#include <AK/WeakPtr.h>
 #include <LibCore/NetworkJob.h>
+#include <LibHTTP/ContentDecoder.h>
+#include <LibHTTP/Http2Connection.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 
@@ -20,9 +23,11 @@ class Job : public Core::NetworkJob {
 
 public:
     explicit Job(HttpRequest&&, AK::Stream&);
-    virtual ~Job() override = default;
+    virtual ~Job() override;
 
     virtual void start(Core::Stream::Socket&) override;
+    // Sends the request as a new stream of the HTTP/2 connection that runs over the socket, rather than on the socket itself.
+    void start_with_http2(Core::Stream::Socket&, Http2Connection&);
     virtual void shutdown(ShutdownMode) override;
 
     Core::Stream::Socket const* socket() const { return m_socket; }
@@ -34,7 +39,15 @@ public:
 protected:
     void finish_up();
     void on_socket_connected();
-    void flush_received_buffers();
+    void on_http2_headers_received(u32 status_code, Vector<HPACK::Header>);
+    void on_http2_data_received(ReadonlyBytes);
+    ErrorOr<void> create_content_decoder();
+    ErrorOr<void> receive_body_data(ByteBuffer);
+    ErrorOr<void> flush_received_buffers();
+    void write_received_buffers();
+    size_t pending_body_size() const;
+    void pause_receiving();
+    void resume_receiving();
     void register_on_ready_to_read(Function<void()>);
     ErrorOr<DeprecatedString> read_line(size_t);
     ErrorOr<ByteBuffer> receive(size_t);
@@ -77,9 +90,20 @@ protected:
     Optional<u32> m_content_length;
     Optional<ssize_t> m_current_chunk_remaining_size;
     Optional<size_t> m_current_chunk_total_size;
-    bool m_can_stream_response { true };
     bool m_should_read_chunk_ending_line { false };
     bool m_has_scheduled_finish { false };
+
+    // The body is decoded as it arrives, but only as fast as the client reads it; the encoded remainder waits in here.
+    OwnPtr<ContentDecoder> m_content_decoder;
+
+    // We stop reading from the server while too much of the body is waiting for the client.
+    bool m_is_receiving_paused { false };
+
+    // The socket is shared with the other streams of the connection, so we never read from or close it ourselves.
+    bool m_uses_http2 { false };
+    WeakPtr<Http2Connection> m_http2_connection;
+    Optional<u32> m_http2_stream_id;
+    size_t m_unconsumed_http2_data_size { 0 };
 };
 
 }
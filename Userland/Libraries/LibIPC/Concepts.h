@@ -69,4 +69,9 @@ concept Variant = Detail::IsVariant<T>;
 template<typename T>
 concept Vector = Detail::IsVector<T>;
 
+// Integers are encoded as little-endian, so vectors of them already are in the right format on little-endian hosts
+// and can be copied in and out of messages as a whole.
+template<typename T>
+concept BulkCopyable = IsIntegral<T> && !IsSame<T, bool> && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+
 }
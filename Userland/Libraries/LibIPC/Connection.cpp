@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibCore/AnonymousBuffer.h>
 #include <LibCore/System.h>
 #include <LibIPC/Connection.h>
 #include <LibIPC/Stub.h>
@@ -21,6 +22,9 @@ struct CoreEventLoopDeferredInvoker final : public DeferredInvoker {
     }
 };
 
+// The connections on this thread that have messages waiting to be written to their sockets.
+static thread_local Vector<ConnectionBase*> s_connections_with_outgoing_bytes;
+
 ConnectionBase::ConnectionBase(IPC::Stub& local_stub, NonnullOwnPtr<Core::Stream::LocalSocket> socket, u32 local_endpoint_magic)
     : m_local_stub(local_stub)
     , m_socket(move(socket))
@@ -30,6 +34,15 @@ ConnectionBase::ConnectionBase(IPC::Stub& local_stub, NonnullOwnPtr<Core::Stream
     m_responsiveness_timer = Core::Timer::create_single_shot(3000, [this] { may_have_become_unresponsive(); }).release_value_but_fixme_should_propagate_errors();
 }
 
+ConnectionBase::~ConnectionBase()
+{
+    // Note: Messages are posted after the current event loop iteration, which may never come if the connection is
+    //       being torn down together with its event loop.
+    if (m_socket->is_open())
+        (void)flush_outgoing_bytes();
+    s_connections_with_outgoing_bytes.remove_first_matching([this](auto* connection) { return connection == this; });
+}
+
 void ConnectionBase::set_deferred_invoker(NonnullOwnPtr<DeferredInvoker> deferred_invoker)
 {
     m_deferred_invoker = move(deferred_invoker);
@@ -59,8 +72,20 @@ ErrorOr<void> ConnectionBase::post_message(MessageBuffer buffer)
     if (!m_socket->is_open())
         return Error::from_string_literal("Trying to post_message during IPC shutdown");
 
-    // Prepend the message size.
     uint32_t message_size = buffer.data.size();
+    if (message_size >= shared_memory_message_threshold) {
+        VERIFY(!(message_size & shared_memory_message_flag));
+        auto shared_buffer = TRY(Core::AnonymousBuffer::create_with_size(message_size));
+        memcpy(shared_buffer.data<void>(), buffer.data.data(), message_size);
+        if (auto result = fd_passing_socket().send_fd(shared_buffer.fd()); result.is_error()) {
+            shutdown_with_error(result.error());
+            return result;
+        }
+        buffer.data.clear_with_capacity();
+        message_size |= shared_memory_message_flag;
+    }
+
+    // Prepend the message size.
     TRY(buffer.data.try_prepend(reinterpret_cast<u8 const*>(&message_size), sizeof(message_size)));
 
     for (auto& fd : buffer.fds) {
@@ -70,7 +95,38 @@ ErrorOr<void> ConnectionBase::post_message(MessageBuffer buffer)
         }
     }
 
-    ReadonlyBytes bytes_to_write { buffer.data.span() };
+    // Note: Messages are collected until the current event loop iteration is over, and then written to the socket all
+    //       at once. Without an event loop, that moment might never come, so they're written right away instead.
+    if (m_outgoing_bytes.is_empty())
+        s_connections_with_outgoing_bytes.append(this);
+    TRY(m_outgoing_bytes.try_extend(buffer.data));
+
+    if (!Core::EventLoop::has_been_instantiated() || m_outgoing_bytes.size() >= outgoing_bytes_flush_threshold)
+        return flush_outgoing_bytes();
+
+    if (!m_is_flush_scheduled) {
+        m_is_flush_scheduled = true;
+        m_deferred_invoker->schedule([strong_this = NonnullRefPtr(*this)] {
+            strong_this->m_is_flush_scheduled = false;
+            if (auto result = strong_this->flush_outgoing_bytes(); result.is_error())
+                dbgln("IPC::ConnectionBase::post_message: {}", result.error());
+        });
+    }
+    return {};
+}
+
+ErrorOr<void> ConnectionBase::flush_outgoing_bytes()
+{
+    s_connections_with_outgoing_bytes.remove_first_matching([this](auto* connection) { return connection == this; });
+    if (m_outgoing_bytes.is_empty())
+        return {};
+
+    auto outgoing_bytes = move(m_outgoing_bytes);
+
+    if (!m_socket->is_open())
+        return Error::from_string_literal("Trying to post_message during IPC shutdown");
+
+    ReadonlyBytes bytes_to_write { outgoing_bytes.span() };
     int writes_done = 0;
     size_t initial_size = bytes_to_write.size();
     while (!bytes_to_write.is_empty()) {
@@ -102,7 +158,7 @@ ErrorOr<void> ConnectionBase::post_message(MessageBuffer buffer)
         bytes_to_write = bytes_to_write.slice(maybe_nwritten.value());
     }
     if (writes_done > 1) {
-        dbgln("LibIPC::Connection FIXME Warning, needed {} writes needed to send message of size {}B, this is pretty bad, as it spins on the EventLoop", writes_done, initial_size);
+        dbgln("LibIPC::Connection FIXME Warning, needed {} writes needed to send messages of size {}B, this is pretty bad, as it spins on the EventLoop", writes_done, initial_size);
     }
 
     // Note: This disables responsiveness detection when an event loop is absent.
@@ -112,6 +168,35 @@ ErrorOr<void> ConnectionBase::post_message(MessageBuffer buffer)
     return {};
 }
 
+void ConnectionBase::flush_all_outgoing_bytes_on_this_thread()
+{
+    // Note: Every flush takes its connection off the list, and connections that die while we're at it leave it too.
+    while (!s_connections_with_outgoing_bytes.is_empty()) {
+        if (auto result = s_connections_with_outgoing_bytes.first()->flush_outgoing_bytes(); result.is_error())
+            dbgln("IPC::ConnectionBase::post_message: {}", result.error());
+    }
+}
+
+ErrorOr<Core::AnonymousBuffer> ConnectionBase::receive_shared_memory_message(size_t message_size)
+{
+    auto fd = TRY(fd_passing_socket().receive_fd(O_CLOEXEC));
+#if !defined(AK_OS_SERENITY)
+    // Note: Mapping more than the peer actually put in the buffer would have us crash when reading the rest.
+    //       Serenity refuses to map past the end of an anonymous file in the first place.
+    auto stat = Core::System::fstat(fd);
+    if (stat.is_error() || static_cast<size_t>(stat.value().st_size) < message_size) {
+        (void)Core::System::close(fd);
+        if (stat.is_error())
+            return stat.release_error();
+        return Error::from_string_literal("Shared memory message is larger than its buffer");
+    }
+#endif
+    auto buffer = Core::AnonymousBuffer::create_from_anon_fd(fd, message_size);
+    if (buffer.is_error())
+        (void)Core::System::close(fd);
+    return buffer;
+}
+
 void ConnectionBase::shutdown()
 {
     m_socket->close();
@@ -165,8 +250,6 @@ ErrorOr<Vector<u8>> ConnectionBase::read_as_much_as_possible_from_socket_without
         m_unprocessed_bytes.clear();
     }
 
-    u8 buffer[4096];
-
     bool should_shut_down = false;
     auto schedule_shutdown = [this, &should_shut_down]() {
         should_shut_down = true;
@@ -176,8 +259,15 @@ ErrorOr<Vector<u8>> ConnectionBase::read_as_much_as_possible_from_socket_without
     };
 
     while (m_socket->is_open()) {
-        auto maybe_bytes_read = m_socket->read_without_waiting({ buffer, 4096 });
+        // Note: Reading straight into the end of `bytes` saves copying everything over from a separate buffer.
+        size_t chunk_size = 4096;
+        if (auto pending_bytes = m_socket->pending_bytes(); !pending_bytes.is_error())
+            chunk_size = max(chunk_size, pending_bytes.value());
+        auto old_size = bytes.size();
+        TRY(bytes.try_resize(old_size + chunk_size));
+        auto maybe_bytes_read = m_socket->read_without_waiting(bytes.span().slice(old_size));
         if (maybe_bytes_read.is_error()) {
+            bytes.shrink(old_size, true);
             auto error = maybe_bytes_read.release_error();
             if (error.is_syscall() && error.code() == EAGAIN) {
                 break;
@@ -194,12 +284,11 @@ ErrorOr<Vector<u8>> ConnectionBase::read_as_much_as_possible_from_socket_without
         }
 
         auto bytes_read = maybe_bytes_read.release_value();
+        bytes.shrink(old_size + bytes_read.size(), true);
         if (bytes_read.is_empty()) {
             schedule_shutdown();
             break;
         }
-
-        bytes.append(bytes_read.data(), bytes_read.size());
     }
 
     if (!bytes.is_empty()) {
@@ -241,6 +330,9 @@ ErrorOr<void> ConnectionBase::drain_messages_from_peer()
 
 OwnPtr<IPC::Message> ConnectionBase::wait_for_specific_endpoint_message_impl(u32 endpoint_magic, int message_id)
 {
+    // Note: The peer can't answer what it hasn't seen yet, and it may have to hear from our other connections first.
+    flush_all_outgoing_bytes_on_this_thread();
+
     for (;;) {
         // Double check we don't already have the event waiting for us.
         // Otherwise we might end up blocked for a while for no reason.
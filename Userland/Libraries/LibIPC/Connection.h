@@ -10,6 +10,7 @@
 #include <AK/ByteBuffer.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/Try.h>
+#include <LibCore/AnonymousBuffer.h>
 #include <LibCore/Event.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/Notifier.h>
@@ -37,7 +38,7 @@ class ConnectionBase : public Core::Object {
     C_OBJECT_ABSTRACT(ConnectionBase);
 
 public:
-    virtual ~ConnectionBase() override = default;
+    virtual ~ConnectionBase() override;
 
     void set_fd_passing_socket(NonnullOwnPtr<Core::Stream::LocalSocket>);
     void set_deferred_invoker(NonnullOwnPtr<DeferredInvoker>);
@@ -64,8 +65,11 @@ protected:
     void wait_for_socket_to_become_readable();
     ErrorOr<Vector<u8>> read_as_much_as_possible_from_socket_without_blocking();
     ErrorOr<void> drain_messages_from_peer();
+    ErrorOr<Core::AnonymousBuffer> receive_shared_memory_message(size_t message_size);
 
     ErrorOr<void> post_message(MessageBuffer);
+    ErrorOr<void> flush_outgoing_bytes();
+    static void flush_all_outgoing_bytes_on_this_thread();
     void handle_messages();
 
     IPC::Stub& m_local_stub;
@@ -78,6 +82,11 @@ protected:
     NonnullOwnPtrVector<Message> m_unprocessed_messages;
     ByteBuffer m_unprocessed_bytes;
 
+    // Messages written to the socket in one go once the current event loop iteration is over, or sooner if this gets big.
+    static constexpr size_t outgoing_bytes_flush_threshold = 64 * KiB;
+    Vector<u8> m_outgoing_bytes;
+    bool m_is_flush_scheduled { false };
+
     u32 m_local_endpoint_magic { 0 };
 
     NonnullOwnPtr<DeferredInvoker> m_deferred_invoker;
@@ -132,12 +141,28 @@ protected:
     virtual void try_parse_messages(Vector<u8> const& bytes, size_t& index) override
     {
         u32 message_size = 0;
-        for (; index + sizeof(message_size) < bytes.size(); index += message_size) {
+        while (index + sizeof(message_size) <= bytes.size()) {
             memcpy(&message_size, bytes.data() + index, sizeof(message_size));
-            if (message_size == 0 || bytes.size() - index - sizeof(uint32_t) < message_size)
-                break;
-            index += sizeof(message_size);
-            auto remaining_bytes = ReadonlyBytes { bytes.data() + index, message_size };
+
+            ReadonlyBytes remaining_bytes;
+            Core::AnonymousBuffer shared_buffer;
+            if (message_size & shared_memory_message_flag) {
+                message_size &= ~shared_memory_message_flag;
+                auto maybe_shared_buffer = receive_shared_memory_message(message_size);
+                if (maybe_shared_buffer.is_error()) {
+                    dbgln("Failed to receive a message in shared memory: {}", maybe_shared_buffer.error());
+                    break;
+                }
+                shared_buffer = maybe_shared_buffer.release_value();
+                index += sizeof(message_size);
+                remaining_bytes = ReadonlyBytes { shared_buffer.data<u8>(), message_size };
+            } else {
+                if (message_size == 0 || bytes.size() - index - sizeof(uint32_t) < message_size)
+                    break;
+                index += sizeof(message_size);
+                remaining_bytes = ReadonlyBytes { bytes.data() + index, message_size };
+                index += message_size;
+            }
 
             auto local_message = LocalEndpoint::decode_message(remaining_bytes, fd_passing_socket());
             if (!local_message.is_error()) {
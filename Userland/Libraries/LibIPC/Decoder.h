@@ -105,6 +105,13 @@ ErrorOr<T> decode(Decoder& decoder)
     T vector;
 
     auto size = TRY(decoder.decode_size());
+
+    if constexpr (Concepts::BulkCopyable<typename T::ValueType>) {
+        TRY(vector.try_resize(size));
+        TRY(decoder.decode_into(Bytes { reinterpret_cast<u8*>(vector.data()), size * sizeof(typename T::ValueType) }));
+        return vector;
+    }
+
     TRY(vector.try_ensure_capacity(size));
 
     for (size_t i = 0; i < size; ++i) {
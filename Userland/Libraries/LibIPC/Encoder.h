@@ -136,6 +136,11 @@ ErrorOr<void> encode(Encoder& encoder, T const& vector)
     // NOTE: Do not change this encoding without also updating LibC/netdb.cpp.
     TRY(encoder.encode_size(vector.size()));
 
+    if constexpr (Concepts::BulkCopyable<typename T::ValueType>) {
+        TRY(encoder.append(reinterpret_cast<u8 const*>(vector.data()), vector.size() * sizeof(typename T::ValueType)));
+        return {};
+    }
+
     for (auto const& value : vector)
         TRY(encoder.encode(value));
 
@@ -34,6 +34,14 @@ private:
     int m_fd;
 };
 
+// Messages at least this large are handed to the peer in an anonymous buffer instead of being written to the socket,
+// which saves copying them into the kernel and back out again.
+static constexpr size_t shared_memory_message_threshold = 64 * KiB;
+
+// Set in the size that precedes a message when the message is in an anonymous buffer. The buffer's file descriptor is
+// passed ahead of the message's own file descriptors, and nothing but the size goes over the socket.
+static constexpr u32 shared_memory_message_flag = 1u << 31;
+
 struct MessageBuffer {
     Vector<u8, 1024> data;
     NonnullRefPtrVector<AutoCloseFileDescriptor, 1> fds;
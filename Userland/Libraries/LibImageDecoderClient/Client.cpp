@@ -20,20 +20,27 @@ void Client::die()
         on_death();
 }
 
-Optional<DecodedImage> Client::decode_image(ReadonlyBytes encoded_data, Optional<DeprecatedString> mime_type)
+static Optional<Core::AnonymousBuffer> copy_to_anonymous_buffer(ReadonlyBytes encoded_data)
 {
-    if (encoded_data.is_empty())
-        return {};
-
     auto encoded_buffer_or_error = Core::AnonymousBuffer::create_with_size(encoded_data.size());
     if (encoded_buffer_or_error.is_error()) {
         dbgln("Could not allocate encoded buffer");
         return {};
     }
     auto encoded_buffer = encoded_buffer_or_error.release_value();
-
     memcpy(encoded_buffer.data<void>(), encoded_data.data(), encoded_data.size());
-    auto response_or_error = try_decode_image(move(encoded_buffer), mime_type);
+    return encoded_buffer;
+}
+
+Optional<DecodedImage> Client::decode_image(ReadonlyBytes encoded_data, Optional<DeprecatedString> mime_type)
+{
+    if (encoded_data.is_empty())
+        return {};
+
+    auto encoded_buffer = copy_to_anonymous_buffer(encoded_data);
+    if (!encoded_buffer.has_value())
+        return {};
+    auto response_or_error = try_decode_image(encoded_buffer.release_value(), mime_type);
 
     if (response_or_error.is_error()) {
         dbgln("ImageDecoder died heroically");
@@ -57,4 +64,38 @@ Optional<DecodedImage> Client::decode_image(ReadonlyBytes encoded_data, Optional
     return image;
 }
 
+RefPtr<Gfx::Bitmap> Client::decode_partial_image(ReadonlyBytes encoded_data, Optional<DeprecatedString> mime_type)
+{
+    if (encoded_data.is_empty())
+        return {};
+
+    auto encoded_buffer = copy_to_anonymous_buffer(encoded_data);
+    if (!encoded_buffer.has_value())
+        return {};
+    auto response_or_error = try_decode_partial_image(encoded_buffer.release_value(), mime_type);
+
+    if (response_or_error.is_error()) {
+        dbgln("ImageDecoder died heroically");
+        return {};
+    }
+    return response_or_error.value().bitmap().bitmap();
+}
+
+RefPtr<Gfx::Bitmap> Client::decode_downscaled_image(ReadonlyBytes encoded_data, Gfx::IntSize minimum_size, Optional<DeprecatedString> mime_type)
+{
+    if (encoded_data.is_empty())
+        return {};
+
+    auto encoded_buffer = copy_to_anonymous_buffer(encoded_data);
+    if (!encoded_buffer.has_value())
+        return {};
+    auto response_or_error = try_decode_downscaled_image(encoded_buffer.release_value(), mime_type, minimum_size);
+
+    if (response_or_error.is_error()) {
+        dbgln("ImageDecoder died heroically");
+        return {};
+    }
+    return response_or_error.value().bitmap().bitmap();
+}
+
 }
@@ -32,6 +32,12 @@ class Client final
 public:
     Optional<DecodedImage> decode_image(ReadonlyBytes, Optional<DeprecatedString> mime_type = {});
 
+    // Decodes what there is of an image that is still being loaded. Returns null if nothing can be shown yet.
+    RefPtr<Gfx::Bitmap> decode_partial_image(ReadonlyBytes, Optional<DeprecatedString> mime_type = {});
+
+    // Decodes the first frame of an image at 1/2, 1/4 or 1/8 of its size, as long as that's at least `minimum_size`.
+    RefPtr<Gfx::Bitmap> decode_downscaled_image(ReadonlyBytes, Gfx::IntSize minimum_size, Optional<DeprecatedString> mime_type = {});
+
     Function<void()> on_death;
 
 private:
@@ -217,6 +217,20 @@ void LabelledStatement::dump(int indent) const
     m_labelled_item->dump(indent + 2);
 }
 
+FunctionBody::FunctionBody(SourceRange source_range)
+    : ScopeNode(source_range)
+{
+}
+
+FunctionBody::~FunctionBody() = default;
+
+void FunctionBody::set_bytecode_executables(Badge<ECMAScriptFunctionObject>, NonnullOwnPtr<Bytecode::Executable> executable, Vector<NonnullOwnPtr<Bytecode::Executable>> default_parameter_executables) const
+{
+    VERIFY(!m_bytecode_executable);
+    m_bytecode_executable = move(executable);
+    m_default_parameter_bytecode_executables = move(default_parameter_executables);
+}
+
 // 10.2.1.3 Runtime Semantics: EvaluateBody, https://tc39.es/ecma262/#sec-runtime-semantics-evaluatebody
 Completion FunctionBody::execute(Interpreter& interpreter) const
 {
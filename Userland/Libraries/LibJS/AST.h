@@ -561,10 +561,8 @@ public:
 
 class FunctionBody final : public ScopeNode {
 public:
-    explicit FunctionBody(SourceRange source_range)
-        : ScopeNode(source_range)
-    {
-    }
+    explicit FunctionBody(SourceRange);
+    virtual ~FunctionBody() override;
 
     void set_strict_mode() { m_in_strict_mode = true; }
 
@@ -572,8 +570,16 @@ public:
 
     virtual Completion execute(Interpreter&) const override;
 
+    // NOTE: The bytecode of a function is compiled when it's first called, and then shared by all function objects that
+    //       are created from the same function body (along with the bytecode for its default parameter values).
+    Bytecode::Executable const* bytecode_executable() const { return m_bytecode_executable; }
+    Vector<NonnullOwnPtr<Bytecode::Executable>> const& default_parameter_bytecode_executables() const { return m_default_parameter_bytecode_executables; }
+    void set_bytecode_executables(Badge<ECMAScriptFunctionObject>, NonnullOwnPtr<Bytecode::Executable>, Vector<NonnullOwnPtr<Bytecode::Executable>> default_parameter_executables) const;
+
 private:
     bool m_in_strict_mode { false };
+    mutable OwnPtr<Bytecode::Executable> m_bytecode_executable;
+    mutable Vector<NonnullOwnPtr<Bytecode::Executable>> m_default_parameter_bytecode_executables;
 };
 
 class Expression : public ASTNode {
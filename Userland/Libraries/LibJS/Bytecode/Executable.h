@@ -11,6 +11,7 @@
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/IdentifierTable.h>
 #include <LibJS/Bytecode/StringTable.h>
+#include <LibJS/JIT/NativeExecutable.h>
 
 namespace JS::Bytecode {
 
@@ -22,6 +23,12 @@ struct Executable {
     size_t number_of_registers { 0 };
     bool is_strict_mode { false };
 
+    // How often this executable has been entered or jumped around in by the interpreter, and what it was compiled
+    // into once that happened often enough.
+    mutable u32 hotness { 0 };
+    mutable bool did_try_to_compile { false };
+    mutable OwnPtr<JIT::NativeExecutable> native_executable {};
+
     DeprecatedString const& get_string(StringTableIndex index) const { return string_table->get(index); }
     DeprecatedFlyString const& get_identifier(IdentifierTableIndex index) const { return identifier_table->get(index); }
 
@@ -18,6 +18,7 @@
     O(BitwiseOr)                     \
     O(BitwiseXor)                    \
     O(Call)                          \
+    O(CompareAndJump)                \
     O(ConcatString)                  \
     O(ContinuePendingUnwind)         \
     O(CopyObjectExcludingProperties) \
@@ -106,6 +107,11 @@ public:
 #undef __BYTECODE_OP
     };
 
+    enum class RegisterAccess {
+        Read,
+        Write,
+    };
+
     bool is_terminator() const;
     Type type() const { return m_type; }
     size_t length() const;
@@ -113,6 +119,12 @@ public:
     ThrowCompletionOr<void> execute(Bytecode::Interpreter&) const;
     void replace_references(BasicBlock const&, BasicBlock const&);
     void replace_references(Register, Register);
+
+    // Calls the callback with every register operand of this instruction (except the implicit accumulator).
+    // NOTE: NewArray only reports the first and last register of its element range, it reads all the ones in between as well.
+    template<typename Callback>
+    void for_each_register(Callback);
+
     static void destroy(Instruction&);
 
 protected:
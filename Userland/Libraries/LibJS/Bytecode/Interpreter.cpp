@@ -11,6 +11,7 @@
 #include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Bytecode/Op.h>
 #include <LibJS/Interpreter.h>
+#include <LibJS/JIT/Compiler.h>
 #include <LibJS/Runtime/GlobalEnvironment.h>
 #include <LibJS/Runtime/GlobalObject.h>
 #include <LibJS/Runtime/Realm.h>
@@ -19,6 +20,10 @@ namespace JS::Bytecode {
 
 static Interpreter* s_current;
 bool g_dump_bytecode = false;
+bool g_jit_enabled = true;
+
+// How often an executable has to be entered or jump around in before it's compiled to native code.
+static constexpr u32 jit_threshold = 64;
 
 Interpreter* Interpreter::current()
 {
@@ -39,6 +44,103 @@ Interpreter::~Interpreter()
     s_current = nullptr;
 }
 
+ALWAYS_INLINE Interpreter::InstructionOutcome Interpreter::handle_instruction_result(ThrowCompletionOr<void> ran_or_error)
+{
+    if (ran_or_error.is_error()) {
+        auto exception_value = *ran_or_error.throw_completion().value();
+        m_saved_exception = make_handle(exception_value);
+        if (unwind_contexts().is_empty())
+            return InstructionOutcome::Stop;
+        auto& unwind_context = unwind_contexts().last();
+        if (unwind_context.executable != m_current_executable)
+            return InstructionOutcome::Stop;
+        if (unwind_context.handler) {
+            m_current_block = unwind_context.handler;
+            unwind_context.handler = nullptr;
+
+            accumulator() = exception_value;
+            m_saved_exception = {};
+            return InstructionOutcome::Jump;
+        }
+        if (unwind_context.finalizer) {
+            m_current_block = unwind_context.finalizer;
+            return InstructionOutcome::Jump;
+        }
+        // An unwind context with no handler or finalizer? We have nowhere to jump, and continuing on will make us crash on the next `Call` to a non-native function if there's an exception! So let's crash here instead.
+        // If you run into this, you probably forgot to remove the current unwind_context somewhere.
+        VERIFY_NOT_REACHED();
+    }
+    if (m_pending_jump.has_value()) {
+        m_current_block = m_pending_jump.release_value();
+        return InstructionOutcome::Jump;
+    }
+    if (!m_return_value.is_empty())
+        return InstructionOutcome::Stop;
+    return InstructionOutcome::Continue;
+}
+
+Interpreter::InstructionOutcome Interpreter::did_run_instruction(ThrowCompletionOr<void> ran_or_error)
+{
+    return handle_instruction_result(move(ran_or_error));
+}
+
+template<typename OpType>
+static ALWAYS_INLINE size_t instruction_length(OpType const& instruction)
+{
+    if constexpr (requires { instruction.length_impl(); })
+        return round_up_to_power_of_two(instruction.length_impl(), alignof(void*));
+    else
+        return sizeof(OpType);
+}
+
+Interpreter::InstructionOutcome Interpreter::run_block()
+{
+    Bytecode::InstructionStreamIterator pc(m_current_block->instruction_stream());
+    TemporaryChange temp_change { m_pc, &pc };
+
+    if (pc.at_end())
+        return InstructionOutcome::Stop;
+
+    // NOTE: Every instruction jumps straight to the code for the next one, which gives the branch predictor a much
+    //       better idea of where we're going than a single switch that every instruction goes through.
+    static void const* const dispatch_table[] = {
+#define __BYTECODE_OP(op) &&handle_##op,
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+    };
+
+    InstructionOutcome outcome;
+    goto *dispatch_table[to_underlying((*pc).type())];
+
+#define __BYTECODE_OP(op)                                                     \
+    handle_##op:                                                              \
+    {                                                                         \
+        auto const& instruction = static_cast<Op::op const&>(*pc);            \
+        outcome = handle_instruction_result(instruction.execute_impl(*this)); \
+        if (outcome != InstructionOutcome::Continue)                          \
+            return outcome;                                                   \
+        pc.jump(pc.offset() + instruction_length(instruction));               \
+        if (pc.at_end())                                                      \
+            return InstructionOutcome::Continue;                              \
+        goto *dispatch_table[to_underlying((*pc).type())];                    \
+    }
+    ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+}
+
+JIT::NativeExecutable const* Interpreter::compile_if_hot(Executable const& executable)
+{
+    if (executable.native_executable)
+        return executable.native_executable.ptr();
+    if (!g_jit_enabled || executable.did_try_to_compile || ++executable.hotness < jit_threshold)
+        return nullptr;
+
+    // NOTE: Whether this works or not, there's no point in trying again.
+    executable.did_try_to_compile = true;
+    executable.native_executable = JIT::Compiler::compile(executable);
+    return executable.native_executable.ptr();
+}
+
 Interpreter::ValueAndFrame Interpreter::run_and_return_frame(Executable const& executable, BasicBlock const* entry_point, RegisterWindow* in_frame)
 {
     dbgln_if(JS_BYTECODE_DEBUG, "Bytecode::Interpreter will run unit {:p}", &executable);
@@ -70,55 +172,22 @@ Interpreter::ValueAndFrame Interpreter::run_and_return_frame(Executable const& e
 
     registers().resize(executable.number_of_registers);
 
+    auto const* native_executable = compile_if_hot(executable);
+
     for (;;) {
-        Bytecode::InstructionStreamIterator pc(m_current_block->instruction_stream());
-        TemporaryChange temp_change { m_pc, &pc };
-
-        bool will_jump = false;
-        bool will_return = false;
-        while (!pc.at_end()) {
-            auto& instruction = *pc;
-            auto ran_or_error = instruction.execute(*this);
-            if (ran_or_error.is_error()) {
-                auto exception_value = *ran_or_error.throw_completion().value();
-                m_saved_exception = make_handle(exception_value);
-                if (unwind_contexts().is_empty())
-                    break;
-                auto& unwind_context = unwind_contexts().last();
-                if (unwind_context.executable != m_current_executable)
-                    break;
-                if (unwind_context.handler) {
-                    m_current_block = unwind_context.handler;
-                    unwind_context.handler = nullptr;
-
-                    accumulator() = exception_value;
-                    m_saved_exception = {};
-                    will_jump = true;
-                    break;
-                }
-                if (unwind_context.finalizer) {
-                    m_current_block = unwind_context.finalizer;
-                    will_jump = true;
-                    break;
-                }
-                // An unwind context with no handler or finalizer? We have nowhere to jump, and continuing on will make us crash on the next `Call` to a non-native function if there's an exception! So let's crash here instead.
-                // If you run into this, you probably forgot to remove the current unwind_context somewhere.
-                VERIFY_NOT_REACHED();
-            }
-            if (m_pending_jump.has_value()) {
-                m_current_block = m_pending_jump.release_value();
-                will_jump = true;
-                break;
-            }
-            if (!m_return_value.is_empty()) {
-                will_return = true;
-                break;
-            }
-            ++pc;
+        auto outcome = InstructionOutcome::Stop;
+        if (native_executable) {
+            outcome = static_cast<InstructionOutcome>(native_executable->run(*this, registers().data(), m_current_block));
+        } else {
+            outcome = run_block();
         }
 
-        if (will_jump)
+        if (outcome == InstructionOutcome::Jump) {
+            // NOTE: Jumps are where loops spend their time, so this lets a long-running loop switch over to native code.
+            if (!native_executable)
+                native_executable = compile_if_hot(executable);
             continue;
+        }
 
         if (!unwind_contexts().is_empty()) {
             auto& unwind_context = unwind_contexts().last();
@@ -131,14 +200,7 @@ Interpreter::ValueAndFrame Interpreter::run_and_return_frame(Executable const& e
             }
         }
 
-        if (pc.at_end())
-            break;
-
-        if (!m_saved_exception.is_null())
-            break;
-
-        if (will_return)
-            break;
+        break;
     }
 
     dbgln_if(JS_BYTECODE_DEBUG, "Bytecode::Interpreter did run unit {:p}", &executable);
@@ -242,7 +304,10 @@ Bytecode::PassManager& Interpreter::optimization_pipeline(Interpreter::Optimizat
 
     auto pm = make<PassManager>();
     if (level == OptimizationLevel::None) {
-        // No optimization.
+        // No optimization, but sharing registers and fusing instructions is cheap.
+        pm->add<Passes::GenerateCFG>();
+        pm->add<Passes::AllocateRegisters>();
+        pm->add<Passes::FuseInstructions>();
     } else if (level == OptimizationLevel::Optimize) {
         pm->add<Passes::GenerateCFG>();
         pm->add<Passes::UnifySameBlocks>();
@@ -255,6 +320,9 @@ Bytecode::PassManager& Interpreter::optimization_pipeline(Interpreter::Optimizat
         pm->add<Passes::GenerateCFG>();
         pm->add<Passes::PlaceBlocks>();
         pm->add<Passes::EliminateLoads>();
+        pm->add<Passes::GenerateCFG>();
+        pm->add<Passes::AllocateRegisters>();
+        pm->add<Passes::FuseInstructions>();
     } else {
         VERIFY_NOT_REACHED();
     }
@@ -48,6 +48,14 @@ public:
     };
     ValueAndFrame run_and_return_frame(Bytecode::Executable const&, Bytecode::BasicBlock const* entry_point, RegisterWindow* = nullptr);
 
+    // What has to happen after an instruction has run.
+    enum class InstructionOutcome : u32 {
+        Continue, // Go on with the next instruction.
+        Jump,     // Continue with the (now) current block.
+        Stop,     // Leave the current block, either to return or because of an exception.
+    };
+    InstructionOutcome did_run_instruction(ThrowCompletionOr<void>);
+
     ALWAYS_INLINE Value& accumulator() { return reg(Register::accumulator()); }
     Value& reg(Register const& r) { return registers()[r.index()]; }
 
@@ -96,6 +104,10 @@ private:
 
     MarkedVector<Value>& registers() { return window().registers; }
 
+    InstructionOutcome handle_instruction_result(ThrowCompletionOr<void>);
+    InstructionOutcome run_block();
+    JIT::NativeExecutable const* compile_if_hot(Executable const&);
+
     static AK::Array<OwnPtr<PassManager>, static_cast<UnderlyingType<Interpreter::OptimizationLevel>>(Interpreter::OptimizationLevel::__Count)> s_optimization_pipelines;
 
     VM& m_vm;
@@ -112,5 +124,6 @@ private:
 };
 
 extern bool g_dump_bytecode;
+extern bool g_jit_enabled;
 
 }
@@ -23,6 +23,7 @@
 #include <LibJS/Runtime/IteratorOperations.h>
 #include <LibJS/Runtime/NativeFunction.h>
 #include <LibJS/Runtime/ObjectEnvironment.h>
+#include <LibJS/Runtime/PrimitiveString.h>
 #include <LibJS/Runtime/Reference.h>
 #include <LibJS/Runtime/RegExpObject.h>
 #include <LibJS/Runtime/Value.h>
@@ -48,7 +49,7 @@ DeprecatedString Instruction::to_deprecated_string(Bytecode::Executable const& e
 
 namespace JS::Bytecode::Op {
 
-static ThrowCompletionOr<void> put_by_property_key(Object* object, Value value, PropertyKey name, Bytecode::Interpreter& interpreter, PropertyKind kind)
+static ThrowCompletionOr<void> put_by_property_key(Object* object, Value value, PropertyKey name, Bytecode::Interpreter& interpreter, PropertyKind kind, PropertyLookupCache* cache = nullptr)
 {
     auto& vm = interpreter.vm();
 
@@ -72,7 +73,18 @@ static ThrowCompletionOr<void> put_by_property_key(Object* object, Value value,
         break;
     }
     case PropertyKind::KeyValue: {
-        bool succeeded = TRY(object->internal_set(name, interpreter.accumulator(), object));
+        if (cache) {
+            u32 property_offset = 0;
+            if (cache->find(*object, property_offset) == object) {
+                object->put_direct(property_offset, interpreter.accumulator());
+                break;
+            }
+        }
+
+        CacheablePropertyMetadata cacheable_metadata;
+        bool succeeded = TRY(object->internal_set(name, interpreter.accumulator(), object, cache ? &cacheable_metadata : nullptr));
+        if (cache)
+            cache->update(*object, cacheable_metadata);
         if (!succeeded && vm.in_strict_mode())
             return vm.throw_completion<TypeError>(ErrorType::ReferenceNullishSetProperty, name, interpreter.accumulator().to_string_without_side_effects());
         break;
@@ -492,8 +504,27 @@ ThrowCompletionOr<void> SetVariable::execute_impl(Bytecode::Interpreter& interpr
 ThrowCompletionOr<void> GetById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
     auto& vm = interpreter.vm();
+
+    // OPTIMIZATION: Like Reference::get_value(), don't create a String object for properties of the string itself (e.g. its length).
+    if (interpreter.accumulator().is_string()) {
+        auto string_value = TRY(interpreter.accumulator().as_string().get(vm, interpreter.current_executable().get_identifier(m_property)));
+        if (string_value.has_value()) {
+            interpreter.accumulator() = *string_value;
+            return {};
+        }
+    }
+
     auto* object = TRY(interpreter.accumulator().to_object(vm));
-    interpreter.accumulator() = TRY(object->get(interpreter.current_executable().get_identifier(m_property)));
+
+    u32 property_offset = 0;
+    if (auto* holder = m_cache.find(*object, property_offset)) {
+        interpreter.accumulator() = holder->get_direct(property_offset);
+        return {};
+    }
+
+    CacheablePropertyMetadata cacheable_metadata;
+    interpreter.accumulator() = TRY(object->internal_get(interpreter.current_executable().get_identifier(m_property), object, &cacheable_metadata));
+    m_cache.update(*object, cacheable_metadata);
     return {};
 }
 
@@ -503,7 +534,7 @@ ThrowCompletionOr<void> PutById::execute_impl(Bytecode::Interpreter& interpreter
     auto* object = TRY(interpreter.reg(m_base).to_object(vm));
     PropertyKey name = interpreter.current_executable().get_identifier(m_property);
     auto value = interpreter.accumulator();
-    return put_by_property_key(object, value, name, interpreter, m_kind);
+    return put_by_property_key(object, value, name, interpreter, m_kind, &m_cache);
 }
 
 ThrowCompletionOr<void> DeleteById::execute_impl(Bytecode::Interpreter& interpreter) const
@@ -580,6 +611,36 @@ ThrowCompletionOr<void> JumpUndefined::execute_impl(Bytecode::Interpreter& inter
     return {};
 }
 
+ThrowCompletionOr<void> CompareAndJump::compare(Bytecode::Interpreter& interpreter) const
+{
+    auto& vm = interpreter.vm();
+    auto lhs = interpreter.reg(m_lhs_reg);
+    auto rhs = interpreter.accumulator();
+
+    switch (m_comparison) {
+#define __JS_FUSABLE_COMPARISON(OpTitleCase, op_snake_case)           \
+    case Type::OpTitleCase:                                           \
+        interpreter.accumulator() = TRY(op_snake_case(vm, lhs, rhs)); \
+        return {};
+        JS_ENUMERATE_FUSABLE_COMPARISON_OPS(__JS_FUSABLE_COMPARISON)
+#undef __JS_FUSABLE_COMPARISON
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+ThrowCompletionOr<void> CompareAndJump::execute_impl(Bytecode::Interpreter& interpreter) const
+{
+    VERIFY(m_true_target.has_value());
+    VERIFY(m_false_target.has_value());
+    TRY(compare(interpreter));
+    if (interpreter.accumulator().to_boolean())
+        interpreter.jump(m_true_target.value());
+    else
+        interpreter.jump(m_false_target.value());
+    return {};
+}
+
 // 13.3.8.1 https://tc39.es/ecma262/#sec-runtime-semantics-argumentlistevaluation
 static MarkedVector<Value> argument_list_evaluation(Bytecode::Interpreter& interpreter)
 {
@@ -1209,6 +1270,25 @@ DeprecatedString JumpUndefined::to_deprecated_string_impl(Bytecode::Executable c
     return DeprecatedString::formatted("JumpUndefined undefined:{} not undefined:{}", true_string, false_string);
 }
 
+DeprecatedString CompareAndJump::to_deprecated_string_impl(Bytecode::Executable const&) const
+{
+    StringView comparison_name;
+    switch (m_comparison) {
+#define __JS_FUSABLE_COMPARISON(OpTitleCase, op_snake_case) \
+    case Type::OpTitleCase:                                 \
+        comparison_name = #OpTitleCase##sv;                 \
+        break;
+        JS_ENUMERATE_FUSABLE_COMPARISON_OPS(__JS_FUSABLE_COMPARISON)
+#undef __JS_FUSABLE_COMPARISON
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    auto true_string = m_true_target.has_value() ? DeprecatedString::formatted("{}", *m_true_target) : "<empty>";
+    auto false_string = m_false_target.has_value() ? DeprecatedString::formatted("{}", *m_false_target) : "<empty>";
+    return DeprecatedString::formatted("CompareAndJump {} {} true:{} false:{}", comparison_name, m_lhs_reg, true_string, false_string);
+}
+
 DeprecatedString Call::to_deprecated_string_impl(Bytecode::Executable const& executable) const
 {
     if (m_expression_string.has_value())
@@ -13,6 +13,7 @@
 #include <LibJS/Bytecode/IdentifierTable.h>
 #include <LibJS/Bytecode/Instruction.h>
 #include <LibJS/Bytecode/Label.h>
+#include <LibJS/Bytecode/PropertyLookupCache.h>
 #include <LibJS/Bytecode/Register.h>
 #include <LibJS/Bytecode/StringTable.h>
 #include <LibJS/Heap/Cell.h>
@@ -39,6 +40,10 @@ public:
         if (m_src == from)
             m_src = to;
     }
+    template<typename Callback>
+    void for_each_register_impl(Callback callback) { callback(m_src, RegisterAccess::Read); }
+
+    Register src() const { return m_src; }
 
 private:
     Register m_src;
@@ -57,6 +62,8 @@ public:
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
     void replace_references_impl(Register, Register) { }
 
+    Value value() const { return m_value; }
+
 private:
     Value m_value;
 };
@@ -73,6 +80,8 @@ public:
     DeprecatedString to_deprecated_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
     void replace_references_impl(Register, Register) { }
+    template<typename Callback>
+    void for_each_register_impl(Callback callback) { callback(m_dst, RegisterAccess::Write); }
 
     Register dst() const { return m_dst; }
 
@@ -123,6 +132,13 @@ private:
             if (m_lhs_reg == from)                                                     \
                 m_lhs_reg = to;                                                        \
         }                                                                              \
+        template<typename Callback>                                                    \
+        void for_each_register_impl(Callback callback)                                 \
+        {                                                                              \
+            callback(m_lhs_reg, RegisterAccess::Read);                                 \
+        }                                                                              \
+                                                                                       \
+        Register lhs() const { return m_lhs_reg; }                                     \
                                                                                        \
     private:                                                                           \
         Register m_lhs_reg;                                                            \
@@ -252,6 +268,13 @@ public:
     DeprecatedString to_deprecated_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
     void replace_references_impl(Register from, Register to);
+    template<typename Callback>
+    void for_each_register_impl(Callback callback)
+    {
+        callback(m_from_object, RegisterAccess::Read);
+        for (size_t i = 0; i < m_excluded_names_count; ++i)
+            callback(m_excluded_names[i], RegisterAccess::Read);
+    }
 
     size_t length_impl() const { return sizeof(*this) + sizeof(Register) * m_excluded_names_count; }
 
@@ -301,6 +324,14 @@ public:
     // Note: The underlying element range shall never be changed item, by item
     //       shifting it may be done in the future
     void replace_references_impl(Register from, Register) { VERIFY(!m_element_count || from.index() < start().index() || from.index() > end().index()); }
+    template<typename Callback>
+    void for_each_register_impl(Callback callback)
+    {
+        if (!m_element_count)
+            return;
+        callback(m_elements[0], RegisterAccess::Read);
+        callback(m_elements[1], RegisterAccess::Read);
+    }
 
     size_t length_impl() const
     {
@@ -341,6 +372,8 @@ public:
 
     // Note: This should never do anything, the lhs should always be an array, that is currently being constructed
     void replace_references_impl(Register from, Register) { VERIFY(from != m_lhs); }
+    template<typename Callback>
+    void for_each_register_impl(Callback callback) { callback(m_lhs, RegisterAccess::Read); }
 
 private:
     Register m_lhs;
@@ -373,6 +406,9 @@ public:
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
     // Note: lhs should always be a string in construction, so this should never do anything
     void replace_references_impl(Register from, Register) { VERIFY(from != m_lhs); }
+    // NOTE: The string is appended to in place, which doesn't end the life of the value that was there before.
+    template<typename Callback>
+    void for_each_register_impl(Callback callback) { callback(m_lhs, RegisterAccess::Read); }
 
 private:
     Register m_lhs;
@@ -519,6 +555,7 @@ public:
 
 private:
     IdentifierTableIndex m_property;
+    PropertyLookupCache mutable m_cache;
 };
 
 enum class PropertyKind {
@@ -547,11 +584,14 @@ public:
         if (m_base == from)
             m_base = to;
     }
+    template<typename Callback>
+    void for_each_register_impl(Callback callback) { callback(m_base, RegisterAccess::Read); }
 
 private:
     Register m_base;
     IdentifierTableIndex m_property;
     PropertyKind m_kind;
+    PropertyLookupCache mutable m_cache;
 };
 
 class DeleteById final : public Instruction {
@@ -587,6 +627,8 @@ public:
         if (m_base == from)
             m_base = to;
     }
+    template<typename Callback>
+    void for_each_register_impl(Callback callback) { callback(m_base, RegisterAccess::Read); }
 
 private:
     Register m_base;
@@ -610,6 +652,12 @@ public:
         if (m_base == from)
             m_base = to;
     }
+    template<typename Callback>
+    void for_each_register_impl(Callback callback)
+    {
+        callback(m_base, RegisterAccess::Read);
+        callback(m_property, RegisterAccess::Read);
+    }
 
 private:
     Register m_base;
@@ -633,6 +681,8 @@ public:
         if (m_base == from)
             m_base = to;
     }
+    template<typename Callback>
+    void for_each_register_impl(Callback callback) { callback(m_base, RegisterAccess::Read); }
 
 private:
     Register m_base;
@@ -708,6 +758,46 @@ public:
     DeprecatedString to_deprecated_string_impl(Bytecode::Executable const&) const;
 };
 
+#define JS_ENUMERATE_FUSABLE_COMPARISON_OPS(O) \
+    O(GreaterThan, greater_than)               \
+    O(GreaterThanEquals, greater_than_equals)  \
+    O(LessThan, less_than)                     \
+    O(LessThanEquals, less_than_equals)        \
+    O(LooselyInequals, abstract_inequals)      \
+    O(LooselyEquals, abstract_equals)          \
+    O(StrictlyInequals, typed_inequals)        \
+    O(StrictlyEquals, typed_equals)
+
+// A comparison that is directly followed by a JumpConditional on its result, see Passes::FuseInstructions.
+// Like the two instructions it replaces, it leaves the result of the comparison in the accumulator.
+class CompareAndJump final : public Jump {
+public:
+    CompareAndJump(Type comparison, Register lhs_reg, Optional<Label> true_target, Optional<Label> false_target)
+        : Jump(Type::CompareAndJump, move(true_target), move(false_target))
+        , m_comparison(comparison)
+        , m_lhs_reg(lhs_reg)
+    {
+    }
+
+    // Only does the comparison, without jumping anywhere.
+    ThrowCompletionOr<void> compare(Bytecode::Interpreter&) const;
+
+    ThrowCompletionOr<void> execute_impl(Bytecode::Interpreter&) const;
+    DeprecatedString to_deprecated_string_impl(Bytecode::Executable const&) const;
+    void replace_references_impl(BasicBlock const& from, BasicBlock const& to) { Jump::replace_references_impl(from, to); }
+    void replace_references_impl(Register from, Register to)
+    {
+        if (m_lhs_reg == from)
+            m_lhs_reg = to;
+    }
+    template<typename Callback>
+    void for_each_register_impl(Callback callback) { callback(m_lhs_reg, RegisterAccess::Read); }
+
+private:
+    Type m_comparison;
+    Register m_lhs_reg;
+};
+
 // NOTE: This instruction is variable-width depending on the number of arguments!
 class Call final : public Instruction {
 public:
@@ -729,6 +819,12 @@ public:
     DeprecatedString to_deprecated_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
     void replace_references_impl(Register, Register);
+    template<typename Callback>
+    void for_each_register_impl(Callback callback)
+    {
+        callback(m_callee, RegisterAccess::Read);
+        callback(m_this_value, RegisterAccess::Read);
+    }
 
     Completion throw_type_error_for_callee(Bytecode::Interpreter&, StringView callee_type) const;
 
@@ -1174,6 +1270,28 @@ ALWAYS_INLINE void Instruction::replace_references(Register from, Register to)
 #undef __BYTECODE_OP
 }
 
+template<typename Callback>
+ALWAYS_INLINE void Instruction::for_each_register(Callback callback)
+{
+    // NOTE: Only instructions that have register operands implement for_each_register_impl().
+    auto visit = [&](auto& instruction) {
+        if constexpr (requires { instruction.for_each_register_impl(callback); })
+            instruction.for_each_register_impl(callback);
+    };
+
+#define __BYTECODE_OP(op)       \
+    case Instruction::Type::op: \
+        return visit(static_cast<Bytecode::Op::op&>(*this));
+
+    switch (type()) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+#undef __BYTECODE_OP
+}
+
 ALWAYS_INLINE size_t Instruction::length() const
 {
     if (type() == Type::NewArray)
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+static Optional<Register> fusable_comparison_lhs(Instruction const& instruction)
+{
+    switch (instruction.type()) {
+#define __JS_FUSABLE_COMPARISON(OpTitleCase, op_snake_case) \
+    case Instruction::Type::OpTitleCase:                    \
+        return static_cast<Op::OpTitleCase const&>(instruction).lhs();
+        JS_ENUMERATE_FUSABLE_COMPARISON_OPS(__JS_FUSABLE_COMPARISON)
+#undef __JS_FUSABLE_COMPARISON
+    default:
+        return {};
+    }
+}
+
+void FuseInstructions::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    for (auto& block : executable.executable.basic_blocks) {
+        InstructionStreamIterator it { block.instruction_stream() };
+        while (!it.at_end()) {
+            auto& instruction = const_cast<Instruction&>(*it);
+            ++it;
+            if (it.at_end())
+                break;
+
+            // <comparison> lhs; JumpConditional -> CompareAndJump
+            auto lhs = fusable_comparison_lhs(instruction);
+            if (!lhs.has_value() || (*it).type() != Instruction::Type::JumpConditional)
+                continue;
+
+            // Note: Comparisons are all the same size, and the fused instruction takes up exactly the space of both
+            //       instructions, so it can simply be put where they were.
+            static_assert(sizeof(Op::CompareAndJump) == sizeof(Op::LessThan) + sizeof(Op::JumpConditional));
+            auto const& jump = static_cast<Op::JumpConditional const&>(*it);
+            auto true_target = jump.true_target();
+            auto false_target = jump.false_target();
+            ++it;
+
+            auto comparison = instruction.type();
+            new (&instruction) Op::CompareAndJump(comparison, *lhs, move(true_target), move(false_target));
+        }
+    }
+
+    finished();
+}
+
+}
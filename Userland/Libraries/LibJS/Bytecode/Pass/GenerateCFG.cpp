@@ -59,6 +59,7 @@ void GenerateCFG::perform(PassPipelineExecutable& executable)
             enter_label(true_target, current_block);
             continue;
         }
+        case CompareAndJump:
         case JumpConditional:
         case JumpNullish:
         case JumpUndefined: {
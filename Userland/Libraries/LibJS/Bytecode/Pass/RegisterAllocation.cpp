@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashTable.h>
+#include <AK/QuickSort.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// NOTE: The accumulator and the register after it are never handed out by the generator, and are left alone here.
+static constexpr u32 first_allocatable_register = 2;
+
+struct BlockAccess {
+    size_t block_index { 0 };
+    bool is_read_before_written { false };
+    bool is_written { false };
+};
+
+struct LiveRange {
+    void extend(size_t position)
+    {
+        start = min(start, position);
+        end = max(end, position);
+    }
+
+    // The first and last instruction (in the order of the executable's blocks) at which the register may be live.
+    size_t start { NumericLimits<size_t>::max() };
+    size_t end { 0 };
+    // Pinned registers keep a slot of their own, see below.
+    bool is_pinned { false };
+    Vector<BlockAccess, 2> accesses;
+};
+
+void AllocateRegisters::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    VERIFY(executable.inverted_cfg.has_value());
+
+    auto& basic_blocks = executable.executable.basic_blocks;
+    auto number_of_registers = executable.executable.number_of_registers;
+    if (number_of_registers <= first_allocatable_register) {
+        finished();
+        return;
+    }
+
+    HashMap<BasicBlock const*, size_t> block_indices;
+    for (size_t i = 0; i < basic_blocks.size(); ++i)
+        block_indices.set(&basic_blocks[i], i);
+
+    // 1. Number all instructions, and find out which registers each block reads before writing them, and which ones it writes.
+    Vector<LiveRange> live_ranges;
+    live_ranges.resize(number_of_registers);
+    Vector<size_t> block_starts;
+    Vector<size_t> block_ends;
+    block_starts.resize(basic_blocks.size());
+    block_ends.resize(basic_blocks.size());
+    HashTable<size_t> unwind_targets;
+
+    size_t position = 0;
+    for (size_t block_index = 0; block_index < basic_blocks.size(); ++block_index) {
+        auto const& block = basic_blocks[block_index];
+        block_starts[block_index] = position;
+
+        auto note_access = [&](u32 index, Instruction::RegisterAccess access) {
+            if (index < first_allocatable_register)
+                return;
+            auto& live_range = live_ranges[index];
+            live_range.extend(position);
+            if (live_range.accesses.is_empty() || live_range.accesses.last().block_index != block_index)
+                live_range.accesses.append({ block_index });
+            auto& block_access = live_range.accesses.last();
+            if (access == Instruction::RegisterAccess::Write)
+                block_access.is_written = true;
+            else if (!block_access.is_written)
+                block_access.is_read_before_written = true;
+        };
+
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it, ++position) {
+            auto& instruction = const_cast<Instruction&>(*it);
+            switch (instruction.type()) {
+            case Instruction::Type::NewArray: {
+                // NOTE: The elements have to stay in consecutive registers, so they are pinned in order.
+                auto const& new_array = static_cast<Op::NewArray const&>(instruction);
+                if (!new_array.element_count())
+                    break;
+                for (auto index = new_array.start().index(); index <= new_array.end().index(); ++index) {
+                    note_access(index, Instruction::RegisterAccess::Read);
+                    if (index >= first_allocatable_register)
+                        live_ranges[index].is_pinned = true;
+                }
+                break;
+            }
+            case Instruction::Type::EnterUnwindContext: {
+                auto const& enter_unwind_context = static_cast<Op::EnterUnwindContext const&>(instruction);
+                if (auto const& handler = enter_unwind_context.handler_target(); handler.has_value())
+                    unwind_targets.set(block_indices.get(&handler->block()).value());
+                if (auto const& finalizer = enter_unwind_context.finalizer_target(); finalizer.has_value())
+                    unwind_targets.set(block_indices.get(&finalizer->block()).value());
+                break;
+            }
+            default:
+                instruction.for_each_register([&](Register& reg, Instruction::RegisterAccess access) {
+                    note_access(reg.index(), access);
+                });
+                break;
+            }
+        }
+
+        block_ends[block_index] = position > block_starts[block_index] ? position - 1 : position;
+    }
+
+    // 2. Extend the live range of every register over all blocks it's live in, by walking backwards from each block where
+    //    it's read before being written, until reaching blocks that write it.
+    // NOTE: Exceptions can get to handlers and finalizers from anywhere in a try block, which the CFG doesn't show.
+    //       Registers that are live on entry to those get a slot of their own instead, so nothing else can clobber them.
+    Vector<size_t> visited_by;
+    Vector<size_t> written_by;
+    visited_by.resize(basic_blocks.size());
+    written_by.resize(basic_blocks.size());
+    Vector<size_t> worklist;
+
+    for (size_t index = first_allocatable_register; index < number_of_registers; ++index) {
+        auto& live_range = live_ranges[index];
+        for (auto const& block_access : live_range.accesses) {
+            if (block_access.is_written)
+                written_by[block_access.block_index] = index;
+            if (block_access.is_read_before_written)
+                worklist.append(block_access.block_index);
+        }
+
+        while (!worklist.is_empty()) {
+            auto block_index = worklist.take_last();
+            if (visited_by[block_index] == index)
+                continue;
+            visited_by[block_index] = index;
+
+            live_range.extend(block_starts[block_index]);
+            if (unwind_targets.contains(block_index))
+                live_range.is_pinned = true;
+
+            auto predecessors = executable.inverted_cfg->find(&basic_blocks[block_index]);
+            if (predecessors == executable.inverted_cfg->end())
+                continue;
+            for (auto const* predecessor : predecessors->value) {
+                auto predecessor_index = block_indices.get(predecessor).value();
+                live_range.extend(block_ends[predecessor_index]);
+                if (written_by[predecessor_index] != index)
+                    worklist.append(predecessor_index);
+            }
+        }
+    }
+
+    // 3. Hand out slots: pinned registers first, in order, then everything else in order of where their live range starts,
+    //    reusing the slots of registers whose live range has ended.
+    Vector<u32> slots;
+    slots.resize(number_of_registers);
+    for (u32 index = 0; index < first_allocatable_register; ++index)
+        slots[index] = index;
+
+    u32 next_slot = first_allocatable_register;
+    Vector<u32> unpinned_registers;
+    for (u32 index = first_allocatable_register; index < number_of_registers; ++index) {
+        auto const& live_range = live_ranges[index];
+        if (live_range.accesses.is_empty())
+            continue;
+        if (live_range.is_pinned)
+            slots[index] = next_slot++;
+        else
+            unpinned_registers.append(index);
+    }
+
+    quick_sort(unpinned_registers, [&](u32 a, u32 b) { return live_ranges[a].start < live_ranges[b].start; });
+
+    struct ActiveRange {
+        size_t end;
+        u32 slot;
+    };
+    Vector<ActiveRange> active_ranges;
+    Vector<u32> free_slots;
+    for (auto index : unpinned_registers) {
+        auto const& live_range = live_ranges[index];
+        active_ranges.remove_all_matching([&](auto const& active_range) {
+            if (active_range.end >= live_range.start)
+                return false;
+            free_slots.append(active_range.slot);
+            return true;
+        });
+
+        u32 slot;
+        if (free_slots.is_empty()) {
+            slot = next_slot++;
+        } else {
+            size_t lowest = 0;
+            for (size_t i = 1; i < free_slots.size(); ++i) {
+                if (free_slots[i] < free_slots[lowest])
+                    lowest = i;
+            }
+            slot = free_slots.take(lowest);
+        }
+        slots[index] = slot;
+        active_ranges.append({ live_range.end, slot });
+    }
+
+    // 4. Rename all registers to their slots.
+    for (auto& block : basic_blocks) {
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            const_cast<Instruction&>(*it).for_each_register([&](Register& reg, Instruction::RegisterAccess) {
+                reg = Register { slots[reg.index()] };
+            });
+        }
+    }
+
+    executable.executable.number_of_registers = next_slot;
+
+    finished();
+}
+
+}
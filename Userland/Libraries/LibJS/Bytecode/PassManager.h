@@ -131,6 +131,30 @@ private:
     virtual void perform(PassPipelineExecutable&) override;
 };
 
+// Renumbers the registers of an executable so that registers whose values are never needed at the same time share a
+// slot, which makes for smaller register windows. Needs an up-to-date CFG.
+class AllocateRegisters : public Pass {
+public:
+    AllocateRegisters() = default;
+    virtual ~AllocateRegisters() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+// Replaces common sequences of instructions with a single instruction that does the same, so that the interpreter
+// has to dispatch fewer of them.
+// NOTE: This rewrites blocks in place, which leaves their terminator() pointing into the middle of an instruction,
+//       so this has to be the last pass that looks at the CFG.
+class FuseInstructions : public Pass {
+public:
+    FuseInstructions() = default;
+    virtual ~FuseInstructions() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
 }
 
 }
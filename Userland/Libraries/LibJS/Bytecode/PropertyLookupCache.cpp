@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PropertyLookupCache.h>
+#include <LibJS/Runtime/Object.h>
+
+namespace JS::Bytecode {
+
+Object* PropertyLookupCache::find(Object& object, u32& property_offset) const
+{
+    auto const& shape = object.shape();
+    for (auto const& entry : m_entries) {
+        if (!entry.receiver_shape.matches(shape))
+            continue;
+
+        // Note: Every shape knows its prototype, so matching shapes all the way up also means that we're looking at the
+        //       same prototypes, and that none of them has gained a property that would now shadow the cached one.
+        auto* holder = &object;
+        size_t depth = 0;
+        for (; depth < entry.prototype_chain_depth; ++depth) {
+            holder = holder->shape().prototype();
+            if (!holder || !entry.prototype_shapes[depth].matches(holder->shape()))
+                break;
+        }
+        if (depth != entry.prototype_chain_depth)
+            continue;
+
+        property_offset = entry.property_offset;
+        return holder;
+    }
+    return nullptr;
+}
+
+void PropertyLookupCache::update(Object& object, CacheablePropertyMetadata const& metadata)
+{
+    if (metadata.type == CacheablePropertyMetadata::Type::NotCacheable)
+        return;
+
+    Entry entry;
+    entry.receiver_shape = { &object.shape(), object.shape().serial_number() };
+    entry.property_offset = metadata.property_offset;
+
+    if (metadata.type == CacheablePropertyMetadata::Type::InPrototypeChain) {
+        auto* current = &object;
+        while (current != metadata.prototype) {
+            if (entry.prototype_chain_depth == max_prototype_chain_depth)
+                return;
+            current = current->shape().prototype();
+            if (!current)
+                return;
+            entry.prototype_shapes[entry.prototype_chain_depth++] = { &current->shape(), current->shape().serial_number() };
+        }
+    }
+
+    m_entries[m_next_entry_to_replace] = move(entry);
+    m_next_entry_to_replace = (m_next_entry_to_replace + 1) % max_entries;
+}
+
+}
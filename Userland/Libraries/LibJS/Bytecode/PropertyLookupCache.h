@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/WeakPtr.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/Shape.h>
+
+namespace JS::Bytecode {
+
+// An inline cache for the named property accesses of a single instruction.
+// For each of the last few shapes it has seen, it remembers at which offset the property was found, either in the
+// object itself or in one of its prototypes. Entries are only used as long as the shapes of the object and the
+// prototypes in between are the same ones, which covers both transitions and in-place changes to unique shapes.
+class PropertyLookupCache {
+public:
+    static constexpr size_t max_entries = 4;
+    static constexpr size_t max_prototype_chain_depth = 4;
+
+    // Returns the object that holds the property, or nullptr if there is no usable entry for this object.
+    Object* find(Object& object, u32& property_offset) const;
+
+    void update(Object& object, CacheablePropertyMetadata const&);
+
+private:
+    struct CachedShape {
+        WeakPtr<Shape> shape;
+        u32 serial_number { 0 };
+
+        bool matches(Shape const& other) const { return shape.ptr() == &other && serial_number == other.serial_number(); }
+    };
+
+    struct Entry {
+        CachedShape receiver_shape;
+        AK::Array<CachedShape, max_prototype_chain_depth> prototype_shapes;
+        u32 prototype_chain_depth { 0 };
+        u32 property_offset { 0 };
+    };
+
+    AK::Array<Entry, max_entries> m_entries;
+    u32 m_next_entry_to_replace { 0 };
+};
+
+}
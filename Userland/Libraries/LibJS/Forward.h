@@ -154,6 +154,7 @@ class Accessor;
 struct AsyncGeneratorRequest;
 class BigInt;
 class BoundFunction;
+struct CacheablePropertyMetadata;
 class Cell;
 class CellAllocator;
 class ClassExpression;
@@ -295,6 +296,10 @@ class Handle;
 template<class T, size_t inline_capacity = 32>
 class MarkedVector;
 
+namespace JIT {
+class NativeExecutable;
+}
+
 namespace Bytecode {
 class BasicBlock;
 struct Executable;
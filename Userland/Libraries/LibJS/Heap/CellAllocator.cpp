@@ -5,6 +5,7 @@
  */
 
 #include <AK/Badge.h>
+#include <AK/Debug.h>
 #include <LibJS/Heap/BlockAllocator.h>
 #include <LibJS/Heap/CellAllocator.h>
 #include <LibJS/Heap/Heap.h>
@@ -19,6 +20,11 @@ CellAllocator::CellAllocator(size_t cell_size)
 
 Cell* CellAllocator::allocate_cell(Heap& heap)
 {
+    // NOTE: Since the block is about to be allocated from, there is no point in giving it back if it turns out empty.
+    SweepStatistics statistics;
+    while (m_usable_blocks.is_empty() && !m_blocks_to_sweep.is_empty())
+        sweep_block(*m_blocks_to_sweep.first(), KeepEmptyBlock::Yes, statistics);
+
     if (m_usable_blocks.is_empty()) {
         auto block = HeapBlock::create_with_cell_size(heap, m_cell_size);
         m_usable_blocks.append(*block.leak_ptr());
@@ -32,19 +38,63 @@ Cell* CellAllocator::allocate_cell(Heap& heap)
     return cell;
 }
 
-void CellAllocator::block_did_become_empty(Badge<Heap>, HeapBlock& block)
+void CellAllocator::defer_sweeping_all_blocks(Badge<Heap>)
 {
-    auto& heap = block.heap();
-    block.m_list_node.remove();
-    // NOTE: HeapBlocks are managed by the BlockAllocator, so we don't want to `delete` the block here.
-    block.~HeapBlock();
-    heap.block_allocator().deallocate_block(&block);
+    // NOTE: Blocks that still have free cells have to wait for their sweep too, otherwise newly allocated (and thus
+    //       unmarked) cells would be collected along with the dead ones.
+    while (!m_full_blocks.is_empty())
+        m_blocks_to_sweep.append(*m_full_blocks.first());
+    while (!m_usable_blocks.is_empty())
+        m_blocks_to_sweep.append(*m_usable_blocks.first());
+}
+
+void CellAllocator::sweep_all_blocks(Badge<Heap>, SweepStatistics& statistics)
+{
+    while (!m_blocks_to_sweep.is_empty())
+        sweep_block(*m_blocks_to_sweep.first(), KeepEmptyBlock::No, statistics);
+}
+
+bool CellAllocator::sweep_next_block(Badge<Heap>, SweepStatistics& statistics)
+{
+    if (m_blocks_to_sweep.is_empty())
+        return false;
+    sweep_block(*m_blocks_to_sweep.first(), KeepEmptyBlock::No, statistics);
+    return true;
 }
 
-void CellAllocator::block_did_become_usable(Badge<Heap>, HeapBlock& block)
+void CellAllocator::sweep_block(HeapBlock& block, KeepEmptyBlock keep_empty_block, SweepStatistics& statistics)
 {
-    VERIFY(!block.is_full());
-    m_usable_blocks.append(block);
+    block.m_list_node.remove();
+
+    bool block_has_live_cells = false;
+    block.for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
+        if (!cell->is_marked()) {
+            dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
+            block.deallocate(cell);
+            ++statistics.collected_cells;
+            statistics.collected_cell_bytes += block.cell_size();
+        } else {
+            cell->set_marked(false);
+            block_has_live_cells = true;
+            ++statistics.live_cells;
+            statistics.live_cell_bytes += block.cell_size();
+        }
+    });
+
+    if (!block_has_live_cells && keep_empty_block == KeepEmptyBlock::No) {
+        dbgln_if(HEAP_DEBUG, " - HeapBlock empty @ {}: cell_size={}", &block, block.cell_size());
+        auto& heap = block.heap();
+        // NOTE: HeapBlocks are managed by the BlockAllocator, so we don't want to `delete` the block here.
+        block.~HeapBlock();
+        heap.block_allocator().deallocate_block(&block);
+        ++statistics.freed_blocks;
+        return;
+    }
+
+    if (block.is_full())
+        m_full_blocks.append(block);
+    else
+        m_usable_blocks.append(block);
 }
 
 }
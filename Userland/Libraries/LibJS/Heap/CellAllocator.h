@@ -33,18 +33,41 @@ public:
             if (callback(block) == IterationDecision::Break)
                 return IterationDecision::Break;
         }
+        for (auto& block : m_blocks_to_sweep) {
+            if (callback(block) == IterationDecision::Break)
+                return IterationDecision::Break;
+        }
         return IterationDecision::Continue;
     }
 
-    void block_did_become_empty(Badge<Heap>, HeapBlock&);
-    void block_did_become_usable(Badge<Heap>, HeapBlock&);
+    struct SweepStatistics {
+        size_t collected_cells { 0 };
+        size_t live_cells { 0 };
+        size_t collected_cell_bytes { 0 };
+        size_t live_cell_bytes { 0 };
+        size_t freed_blocks { 0 };
+    };
+
+    // Once all unreachable cells have been finalized, the blocks are swept lazily: a block only gets swept when its
+    // free cells are needed for allocation, or when the pending sweep is finished before the next collection.
+    void defer_sweeping_all_blocks(Badge<Heap>);
+    void sweep_all_blocks(Badge<Heap>, SweepStatistics&);
+    bool sweep_next_block(Badge<Heap>, SweepStatistics&);
+    bool has_blocks_to_sweep() const { return !m_blocks_to_sweep.is_empty(); }
 
 private:
+    enum class KeepEmptyBlock {
+        No,
+        Yes,
+    };
+    void sweep_block(HeapBlock&, KeepEmptyBlock, SweepStatistics&);
+
     const size_t m_cell_size;
 
     using BlockList = IntrusiveList<&HeapBlock::m_list_node>;
     BlockList m_full_blocks;
     BlockList m_usable_blocks;
+    BlockList m_blocks_to_sweep;
 };
 
 }
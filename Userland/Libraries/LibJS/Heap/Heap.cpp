@@ -5,8 +5,9 @@
  */
 
 #include <AK/Badge.h>
+#include <AK/BinarySearch.h>
 #include <AK/Debug.h>
-#include <AK/HashTable.h>
+#include <AK/QuickSort.h>
 #include <AK/StackInfo.h>
 #include <AK/TemporaryChange.h>
 #include <LibCore/ElapsedTimer.h>
@@ -106,21 +107,29 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
             m_should_gc_when_deferral_ends = true;
             return;
         }
-        HashTable<Cell*> roots;
+    }
+
+    // NOTE: Marking has to start out with every cell unmarked, and the conservative scan mustn't find any dead cells,
+    //       so whatever the previous collection left behind for lazy sweeping is swept first.
+    finish_sweeping();
+
+    if (collection_type == CollectionType::CollectGarbage) {
+        Vector<Cell*> roots;
         gather_roots(roots);
         mark_live_cells(roots);
     }
     finalize_unmarked_cells();
-    sweep_dead_cells(print_report, collection_measurement_timer);
+    remove_dead_cells_from_weak_containers();
+    sweep_dead_cells(collection_type, print_report, collection_measurement_timer);
 }
 
-void Heap::gather_roots(HashTable<Cell*>& roots)
+void Heap::gather_roots(Vector<Cell*>& roots)
 {
     vm().gather_roots(roots);
     gather_conservative_roots(roots);
 
     for (auto& handle : m_handles)
-        roots.set(handle.cell());
+        roots.append(handle.cell());
 
     for (auto& vector : m_marked_vectors)
         vector.gather_roots(roots);
@@ -132,7 +141,7 @@ void Heap::gather_roots(HashTable<Cell*>& roots)
     }
 }
 
-__attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(HashTable<Cell*>& roots)
+__attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Vector<Cell*>& roots)
 {
     FlatPtr dummy;
 
@@ -141,7 +150,35 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
     jmp_buf buf;
     setjmp(buf);
 
-    HashTable<FlatPtr> possible_pointers;
+    // NOTE: Every word we look at has to be checked against the set of live blocks, so we keep their (block-aligned)
+    //       addresses in a sorted array and only binary search it for values that fall within the heap at all.
+    Vector<FlatPtr> all_live_heap_blocks;
+    for_each_block([&](auto& block) {
+        all_live_heap_blocks.append(bit_cast<FlatPtr>(&block));
+        return IterationDecision::Continue;
+    });
+    if (all_live_heap_blocks.is_empty())
+        return;
+    quick_sort(all_live_heap_blocks);
+    auto lowest_heap_address = all_live_heap_blocks.first();
+    auto highest_heap_address = all_live_heap_blocks.last() + HeapBlock::block_size;
+
+    auto add_possible_pointer = [&](FlatPtr possible_pointer) {
+        if (possible_pointer < lowest_heap_address || possible_pointer >= highest_heap_address)
+            return;
+        dbgln_if(HEAP_DEBUG, "  ? {}", (void const*)possible_pointer);
+        auto* possible_heap_block = HeapBlock::from_cell(reinterpret_cast<Cell const*>(possible_pointer));
+        if (!binary_search(all_live_heap_blocks, bit_cast<FlatPtr>(possible_heap_block)))
+            return;
+        if (auto* cell = possible_heap_block->cell_from_possible_pointer(possible_pointer)) {
+            if (cell->state() == Cell::State::Live) {
+                dbgln_if(HEAP_DEBUG, "  ?-> {}", (void const*)cell);
+                roots.append(cell);
+            } else {
+                dbgln_if(HEAP_DEBUG, "  #-> {}", (void const*)cell);
+            }
+        }
+    };
 
     auto* raw_jmp_buf = reinterpret_cast<FlatPtr const*>(buf);
 
@@ -151,14 +188,14 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
             // match any pointer-backed tag, in that case we have to extract the pointer to its
             // canonical form and add that as a possible pointer.
             if ((data & SHIFTED_IS_CELL_PATTERN) == SHIFTED_IS_CELL_PATTERN)
-                possible_pointers.set(Value::extract_pointer_bits(data));
+                add_possible_pointer(Value::extract_pointer_bits(data));
             else
-                possible_pointers.set(data);
+                add_possible_pointer(data);
         } else {
             static_assert((sizeof(Value) % sizeof(FlatPtr*)) == 0);
             // In the 32-bit case we will look at the top and bottom part of Value separately we just
             // add both the upper and lower bytes as possible pointers.
-            possible_pointers.set(data);
+            add_possible_pointer(data);
         }
     };
 
@@ -182,34 +219,11 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
             }
         }
     }
-
-    HashTable<HeapBlock*> all_live_heap_blocks;
-    for_each_block([&](auto& block) {
-        all_live_heap_blocks.set(&block);
-        return IterationDecision::Continue;
-    });
-
-    for (auto possible_pointer : possible_pointers) {
-        if (!possible_pointer)
-            continue;
-        dbgln_if(HEAP_DEBUG, "  ? {}", (void const*)possible_pointer);
-        auto* possible_heap_block = HeapBlock::from_cell(reinterpret_cast<Cell const*>(possible_pointer));
-        if (all_live_heap_blocks.contains(possible_heap_block)) {
-            if (auto* cell = possible_heap_block->cell_from_possible_pointer(possible_pointer)) {
-                if (cell->state() == Cell::State::Live) {
-                    dbgln_if(HEAP_DEBUG, "  ?-> {}", (void const*)cell);
-                    roots.set(cell);
-                } else {
-                    dbgln_if(HEAP_DEBUG, "  #-> {}", (void const*)cell);
-                }
-            }
-        }
-    }
 }
 
 class MarkingVisitor final : public Cell::Visitor {
 public:
-    explicit MarkingVisitor(HashTable<Cell*> const& roots)
+    explicit MarkingVisitor(Vector<Cell*> const& roots)
     {
         for (auto* root : roots) {
             visit(root);
@@ -237,7 +251,7 @@ private:
     Vector<Cell&> m_work_queue;
 };
 
-void Heap::mark_live_cells(HashTable<Cell*> const& roots)
+void Heap::mark_live_cells(Vector<Cell*> const& roots)
 {
     dbgln_if(HEAP_DEBUG, "mark_live_cells:");
 
@@ -261,59 +275,73 @@ void Heap::finalize_unmarked_cells()
 {
     for_each_block([&](auto& block) {
         block.template for_each_cell_in_state<Cell::State::Live>([](Cell* cell) {
-            if (!cell->is_marked() && !cell_must_survive_garbage_collection(*cell))
+            if (cell->is_marked())
+                return;
+            // NOTE: From here on, a cell survives this collection if and only if it's marked.
+            if (cell_must_survive_garbage_collection(*cell))
+                cell->set_marked(true);
+            else
                 cell->finalize();
         });
         return IterationDecision::Continue;
     });
 }
 
-void Heap::sweep_dead_cells(bool print_report, Core::ElapsedTimer const& measurement_timer)
+void Heap::remove_dead_cells_from_weak_containers()
 {
-    dbgln_if(HEAP_DEBUG, "sweep_dead_cells:");
-    Vector<HeapBlock*, 32> empty_blocks;
-    Vector<HeapBlock*, 32> full_blocks_that_became_usable;
+    // NOTE: Containers are allowed to deregister themselves while we're iterating.
+    for (auto it = m_weak_containers.begin(); it != m_weak_containers.end();) {
+        auto& weak_container = *it;
+        ++it;
+        // NOTE: Containers that are going away themselves may be swept at any point later, and must not act on
+        //       anything anymore (e.g. schedule the cleanup of a dead FinalizationRegistry).
+        if (!weak_container.owner().is_marked())
+            continue;
+        weak_container.remove_dead_cells({});
+    }
+}
 
-    size_t collected_cells = 0;
-    size_t live_cells = 0;
-    size_t collected_cell_bytes = 0;
-    size_t live_cell_bytes = 0;
+void Heap::sweep_pending_blocks(Time budget)
+{
+    if (m_collecting_garbage)
+        return;
+    TemporaryChange change(m_collecting_garbage, true);
 
-    for_each_block([&](auto& block) {
-        bool block_has_live_cells = false;
-        bool block_was_full = block.is_full();
-        block.template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
-            if (!cell->is_marked() && !cell_must_survive_garbage_collection(*cell)) {
-                dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
-                block.deallocate(cell);
-                ++collected_cells;
-                collected_cell_bytes += block.cell_size();
-            } else {
-                cell->set_marked(false);
-                block_has_live_cells = true;
-                ++live_cells;
-                live_cell_bytes += block.cell_size();
-            }
-        });
-        if (!block_has_live_cells)
-            empty_blocks.append(&block);
-        else if (block_was_full != block.is_full())
-            full_blocks_that_became_usable.append(&block);
-        return IterationDecision::Continue;
-    });
+    Core::ElapsedTimer timer(true);
+    timer.start();
 
-    for (auto& weak_container : m_weak_containers)
-        weak_container.remove_dead_cells({});
-
-    for (auto* block : empty_blocks) {
-        dbgln_if(HEAP_DEBUG, " - HeapBlock empty @ {}: cell_size={}", block, block->cell_size());
-        allocator_for_size(block->cell_size()).block_did_become_empty({}, *block);
+    CellAllocator::SweepStatistics statistics;
+    for (auto& allocator : m_allocators) {
+        while (allocator->sweep_next_block({}, statistics)) {
+            if (timer.elapsed_time() >= budget)
+                return;
+        }
     }
+}
 
-    for (auto* block : full_blocks_that_became_usable) {
-        dbgln_if(HEAP_DEBUG, " - HeapBlock usable again @ {}: cell_size={}", block, block->cell_size());
-        allocator_for_size(block->cell_size()).block_did_become_usable({}, *block);
-    }
+void Heap::finish_sweeping()
+{
+    CellAllocator::SweepStatistics statistics;
+    for (auto& allocator : m_allocators)
+        allocator->sweep_all_blocks({}, statistics);
+}
+
+void Heap::sweep_dead_cells(CollectionType collection_type, bool print_report, Core::ElapsedTimer const& measurement_timer)
+{
+    dbgln_if(HEAP_DEBUG, "sweep_dead_cells:");
+
+    // NOTE: Destroying the dead cells is deferred until their memory is needed, which keeps the time spent in here
+    //       proportional to the number of cells that have to be finalized rather than to the size of the heap.
+    //       Sweeping happens right away if we're about to go away, or if someone wants to know how it went.
+    for (auto& allocator : m_allocators)
+        allocator->defer_sweeping_all_blocks({});
+
+    if (collection_type == CollectionType::CollectGarbage && !print_report)
+        return;
+
+    CellAllocator::SweepStatistics statistics;
+    for (auto& allocator : m_allocators)
+        allocator->sweep_all_blocks({}, statistics);
 
     if constexpr (HEAP_DEBUG) {
         for_each_block([&](auto& block) {
@@ -333,10 +361,10 @@ void Heap::sweep_dead_cells(bool print_report, Core::ElapsedTimer const& measure
         dbgln("Garbage collection report");
         dbgln("=============================================");
         dbgln("     Time spent: {} ms", time_spent.to_milliseconds());
-        dbgln("     Live cells: {} ({} bytes)", live_cells, live_cell_bytes);
-        dbgln("Collected cells: {} ({} bytes)", collected_cells, collected_cell_bytes);
+        dbgln("     Live cells: {} ({} bytes)", statistics.live_cells, statistics.live_cell_bytes);
+        dbgln("Collected cells: {} ({} bytes)", statistics.collected_cells, statistics.collected_cell_bytes);
         dbgln("    Live blocks: {} ({} bytes)", live_block_count, live_block_count * HeapBlock::block_size);
-        dbgln("   Freed blocks: {} ({} bytes)", empty_blocks.size(), empty_blocks.size() * HeapBlock::block_size);
+        dbgln("   Freed blocks: {} ({} bytes)", statistics.freed_blocks, statistics.freed_blocks * HeapBlock::block_size);
         dbgln("=============================================");
     }
 }
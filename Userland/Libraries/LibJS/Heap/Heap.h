@@ -11,6 +11,7 @@
 #include <AK/IntrusiveList.h>
 #include <AK/Noncopyable.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/Time.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibCore/Forward.h>
@@ -57,6 +58,11 @@ public:
 
     void collect_garbage(CollectionType = CollectionType::CollectGarbage, bool print_report = false);
 
+    // Sweeps what the last collection left to be swept lazily, for as long as the time budget allows.
+    // This is meant to be called when there's nothing else to do, so that neither allocations nor the next
+    // collection have to pay for it.
+    void sweep_pending_blocks(Time budget);
+
     VM& vm() { return m_vm; }
 
     bool should_collect_on_every_allocation() const { return m_should_collect_on_every_allocation; }
@@ -83,11 +89,13 @@ private:
 
     Cell* allocate_cell(size_t);
 
-    void gather_roots(HashTable<Cell*>&);
-    void gather_conservative_roots(HashTable<Cell*>&);
-    void mark_live_cells(HashTable<Cell*> const& live_cells);
+    void gather_roots(Vector<Cell*>&);
+    void gather_conservative_roots(Vector<Cell*>&);
+    void mark_live_cells(Vector<Cell*> const& live_cells);
     void finalize_unmarked_cells();
-    void sweep_dead_cells(bool print_report, Core::ElapsedTimer const&);
+    void remove_dead_cells_from_weak_containers();
+    void sweep_dead_cells(CollectionType, bool print_report, Core::ElapsedTimer const&);
+    void finish_sweeping();
 
     CellAllocator& allocator_for_size(size_t);
 
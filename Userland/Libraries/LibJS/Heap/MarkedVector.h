@@ -17,7 +17,7 @@ namespace JS {
 
 class MarkedVectorBase {
 public:
-    virtual void gather_roots(HashTable<Cell*>&) const = 0;
+    virtual void gather_roots(Vector<Cell*>&) const = 0;
 
 protected:
     explicit MarkedVectorBase(Heap&);
@@ -64,14 +64,14 @@ public:
         return *this;
     }
 
-    virtual void gather_roots(HashTable<Cell*>& roots) const override
+    virtual void gather_roots(Vector<Cell*>& roots) const override
     {
         for (auto& value : *this) {
             if constexpr (IsSame<Value, T>) {
                 if (value.is_cell())
-                    roots.set(&const_cast<T&>(value).as_cell());
+                    roots.append(&const_cast<T&>(value).as_cell());
             } else {
-                roots.set(value);
+                roots.append(value);
             }
         }
     };
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace JS::JIT {
+
+// A tiny x86_64 assembler that only knows the handful of instructions the JIT compiler needs.
+class Assembler {
+public:
+    enum class Reg : u8 {
+        RAX = 0,
+        RCX = 1,
+        RDX = 2,
+        RBX = 3,
+        RSP = 4,
+        RBP = 5,
+        RSI = 6,
+        RDI = 7,
+        R8 = 8,
+        R9 = 9,
+        R10 = 10,
+        R11 = 11,
+        R12 = 12,
+        R13 = 13,
+        R14 = 14,
+        R15 = 15,
+    };
+
+    enum class Condition : u8 {
+        Overflow = 0x0,
+        Equal = 0x4,
+        NotEqual = 0x5,
+    };
+
+    // A position in the code that can be jumped to before it is known where it will end up.
+    struct Label {
+        Optional<size_t> offset;
+        Vector<size_t> jump_sites;
+    };
+
+    explicit Assembler(Vector<u8>& output)
+        : m_output(output)
+    {
+    }
+
+    void place_label(Label& label)
+    {
+        label.offset = m_output.size();
+        for (auto site : label.jump_sites)
+            patch_rel32(site, *label.offset);
+        label.jump_sites.clear();
+    }
+
+    // mov dst, imm64
+    void mov(Reg dst, u64 immediate)
+    {
+        emit_rex(true, 0, 0, to_underlying(dst));
+        emit8(0xb8 | (to_underlying(dst) & 7));
+        emit64(immediate);
+    }
+
+    // mov dst, src
+    void mov(Reg dst, Reg src)
+    {
+        emit_rex(true, to_underlying(src), 0, to_underlying(dst));
+        emit8(0x89);
+        emit_modrm_register(to_underlying(src), to_underlying(dst));
+    }
+
+    // mov dst, [base + offset]
+    void load(Reg dst, Reg base, i32 offset)
+    {
+        emit_rex(true, to_underlying(dst), 0, to_underlying(base));
+        emit8(0x8b);
+        emit_modrm_memory(to_underlying(dst), to_underlying(base), offset);
+    }
+
+    // mov [base + offset], src
+    void store(Reg base, i32 offset, Reg src)
+    {
+        emit_rex(true, to_underlying(src), 0, to_underlying(base));
+        emit8(0x89);
+        emit_modrm_memory(to_underlying(src), to_underlying(base), offset);
+    }
+
+    // cmp lhs, rhs
+    void cmp(Reg lhs, Reg rhs)
+    {
+        emit_rex(true, to_underlying(rhs), 0, to_underlying(lhs));
+        emit8(0x39);
+        emit_modrm_register(to_underlying(rhs), to_underlying(lhs));
+    }
+
+    // cmp reg, imm32 (sign-extended)
+    void cmp(Reg reg, i32 immediate) { emit_alu_immediate(7, reg, immediate, true); }
+
+    // and reg, imm32 (sign-extended)
+    void bitwise_and(Reg reg, i32 immediate) { emit_alu_immediate(4, reg, immediate, true); }
+
+    // or dst, src
+    void bitwise_or(Reg dst, Reg src)
+    {
+        emit_rex(true, to_underlying(src), 0, to_underlying(dst));
+        emit8(0x09);
+        emit_modrm_register(to_underlying(src), to_underlying(dst));
+    }
+
+    // add reg32, imm32 and sub reg32, imm32, which also clear the upper half of the register.
+    void add32(Reg reg, i32 immediate) { emit_alu_immediate(0, reg, immediate, false); }
+    void sub32(Reg reg, i32 immediate) { emit_alu_immediate(5, reg, immediate, false); }
+
+    // test reg32, reg32
+    void test32(Reg lhs, Reg rhs)
+    {
+        emit_rex(false, to_underlying(rhs), 0, to_underlying(lhs));
+        emit8(0x85);
+        emit_modrm_register(to_underlying(rhs), to_underlying(lhs));
+    }
+
+    // shr reg, imm8
+    void shift_right(Reg reg, u8 amount)
+    {
+        emit_rex(true, 0, 0, to_underlying(reg));
+        emit8(0xc1);
+        emit_modrm_register(5, to_underlying(reg));
+        emit8(amount);
+    }
+
+    void push(Reg reg)
+    {
+        emit_rex(false, 0, 0, to_underlying(reg));
+        emit8(0x50 | (to_underlying(reg) & 7));
+    }
+
+    void pop(Reg reg)
+    {
+        emit_rex(false, 0, 0, to_underlying(reg));
+        emit8(0x58 | (to_underlying(reg) & 7));
+    }
+
+    void call(Reg reg)
+    {
+        emit_rex(false, 0, 0, to_underlying(reg));
+        emit8(0xff);
+        emit_modrm_register(2, to_underlying(reg));
+    }
+
+    void jump(Reg reg)
+    {
+        emit_rex(false, 0, 0, to_underlying(reg));
+        emit8(0xff);
+        emit_modrm_register(4, to_underlying(reg));
+    }
+
+    void jump(Label& label)
+    {
+        emit8(0xe9);
+        emit_rel32_to(label);
+    }
+
+    void jump_if(Condition condition, Label& label)
+    {
+        emit8(0x0f);
+        emit8(0x80 | to_underlying(condition));
+        emit_rel32_to(label);
+    }
+
+    void ret() { emit8(0xc3); }
+
+private:
+    void emit8(u8 value) { m_output.append(value); }
+
+    void emit32(u32 value)
+    {
+        for (size_t i = 0; i < 4; ++i)
+            emit8(static_cast<u8>(value >> (i * 8)));
+    }
+
+    void emit64(u64 value)
+    {
+        for (size_t i = 0; i < 8; ++i)
+            emit8(static_cast<u8>(value >> (i * 8)));
+    }
+
+    // Note: Only emits a REX prefix when it's actually needed, i.e. for 64-bit operands or extended registers.
+    void emit_rex(bool wide, u8 reg, u8 index, u8 base)
+    {
+        u8 rex = 0x40 | (wide ? 8 : 0) | ((reg & 8) >> 1) | ((index & 8) >> 2) | ((base & 8) >> 3);
+        if (rex != 0x40)
+            emit8(rex);
+    }
+
+    void emit_modrm_register(u8 reg, u8 rm)
+    {
+        emit8(0xc0 | ((reg & 7) << 3) | (rm & 7));
+    }
+
+    void emit_modrm_memory(u8 reg, u8 base, i32 offset)
+    {
+        emit8(0x80 | ((reg & 7) << 3) | (base & 7));
+        // Note: RSP and R12 can only be used as a base through a SIB byte.
+        if ((base & 7) == 4)
+            emit8(0x24);
+        emit32(static_cast<u32>(offset));
+    }
+
+    void emit_alu_immediate(u8 operation, Reg reg, i32 immediate, bool wide)
+    {
+        emit_rex(wide, 0, 0, to_underlying(reg));
+        emit8(0x81);
+        emit_modrm_register(operation, to_underlying(reg));
+        emit32(static_cast<u32>(immediate));
+    }
+
+    void emit_rel32_to(Label& label)
+    {
+        auto site = m_output.size();
+        emit32(0);
+        if (label.offset.has_value())
+            patch_rel32(site, *label.offset);
+        else
+            label.jump_sites.append(site);
+    }
+
+    void patch_rel32(size_t site, size_t target)
+    {
+        auto displacement = static_cast<u32>(static_cast<i64>(target) - static_cast<i64>(site + 4));
+        for (size_t i = 0; i < 4; ++i)
+            m_output[site + i] = static_cast<u8>(displacement >> (i * 8));
+    }
+
+    Vector<u8>& m_output;
+};
+
+}
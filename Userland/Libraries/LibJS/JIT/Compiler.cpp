@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Platform.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/JIT/Assembler.h>
+#include <LibJS/JIT/Compiler.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::JIT {
+
+#if ARCH(X86_64)
+
+static_assert(sizeof(Value) == sizeof(u64));
+
+using Reg = Assembler::Reg;
+
+// NOTE: These live in callee-saved registers, so they survive calls into C++.
+static constexpr Reg INTERPRETER = Reg::RBX;
+static constexpr Reg REGISTERS = Reg::R12;
+static constexpr Reg CURRENT_BLOCK = Reg::R13;
+
+template<typename OpType>
+static u32 run_instruction(Bytecode::Interpreter& interpreter, Bytecode::Instruction const& instruction)
+{
+    auto result = static_cast<OpType const&>(instruction).execute_impl(interpreter);
+    return to_underlying(interpreter.did_run_instruction(move(result)));
+}
+
+static u32 run_comparison(Bytecode::Interpreter& interpreter, Bytecode::Op::CompareAndJump const& instruction)
+{
+    return to_underlying(interpreter.did_run_instruction(instruction.compare(interpreter)));
+}
+
+static u32 accumulator_to_boolean(Value const* registers)
+{
+    return registers[Bytecode::Register::accumulator_index].to_boolean();
+}
+
+class CompilerImpl {
+public:
+    explicit CompilerImpl(Bytecode::Executable const& executable)
+        : m_executable(executable)
+        , m_assembler(m_output)
+    {
+    }
+
+    OwnPtr<NativeExecutable> compile()
+    {
+        emit_prologue();
+
+        m_block_labels.resize(m_executable.basic_blocks.size());
+        for (size_t i = 0; i < m_executable.basic_blocks.size(); ++i)
+            m_block_indices.set(&m_executable.basic_blocks[i], i);
+
+        HashMap<Bytecode::BasicBlock const*, size_t> block_offsets;
+        for (size_t i = 0; i < m_executable.basic_blocks.size(); ++i) {
+            auto const& block = m_executable.basic_blocks[i];
+            m_assembler.place_label(m_block_labels[i]);
+            block_offsets.set(&block, m_output.size());
+            compile_block(block);
+        }
+
+        m_assembler.place_label(m_exit);
+        emit_epilogue();
+
+        dbgln_if(JS_BYTECODE_DEBUG, "JIT: Compiled {} into {} bytes of native code", m_executable.name, m_output.size());
+        return NativeExecutable::try_create(m_output.span(), move(block_offsets));
+    }
+
+private:
+    static i32 register_offset(Bytecode::Register reg) { return static_cast<i32>(reg.index() * sizeof(Value)); }
+    static i32 accumulator_offset() { return register_offset(Bytecode::Register::accumulator()); }
+
+    void emit_prologue()
+    {
+        m_assembler.push(Reg::RBP);
+        m_assembler.mov(Reg::RBP, Reg::RSP);
+        m_assembler.push(INTERPRETER);
+        m_assembler.push(REGISTERS);
+        m_assembler.push(CURRENT_BLOCK);
+        // NOTE: This one is only pushed to keep the stack 16-byte aligned for the calls we make.
+        m_assembler.push(Reg::R14);
+
+        m_assembler.mov(INTERPRETER, Reg::RDI);
+        m_assembler.mov(REGISTERS, Reg::RSI);
+        m_assembler.mov(CURRENT_BLOCK, Reg::RDX);
+        m_assembler.jump(Reg::RCX);
+    }
+
+    void emit_epilogue()
+    {
+        m_assembler.pop(Reg::R14);
+        m_assembler.pop(CURRENT_BLOCK);
+        m_assembler.pop(REGISTERS);
+        m_assembler.pop(INTERPRETER);
+        m_assembler.pop(Reg::RBP);
+        m_assembler.ret();
+    }
+
+    void emit_exit(Bytecode::Interpreter::InstructionOutcome outcome)
+    {
+        m_assembler.mov(Reg::RAX, static_cast<u64>(to_underlying(outcome)));
+        m_assembler.jump(m_exit);
+    }
+
+    void emit_jump_to_block(Bytecode::BasicBlock const& block)
+    {
+        // NOTE: The interpreter still wants to know which block we're in, e.g. when we leave to unwind.
+        m_assembler.mov(Reg::RAX, reinterpret_cast<FlatPtr>(&block));
+        m_assembler.store(CURRENT_BLOCK, 0, Reg::RAX);
+        m_assembler.jump(m_block_labels[m_block_indices.get(&block).value()]);
+    }
+
+    void emit_call_instruction(Bytecode::Instruction const& instruction)
+    {
+        using RunInstruction = u32 (*)(Bytecode::Interpreter&, Bytecode::Instruction const&);
+        RunInstruction run = nullptr;
+        switch (instruction.type()) {
+#define __BYTECODE_OP(op)                       \
+    case Bytecode::Instruction::Type::op:       \
+        run = run_instruction<Bytecode::Op::op>; \
+        break;
+            ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+        default:
+            VERIFY_NOT_REACHED();
+        }
+        emit_call(instruction, reinterpret_cast<FlatPtr>(run));
+    }
+
+    // Calls function(interpreter, instruction), which returns an InstructionOutcome.
+    void emit_call(Bytecode::Instruction const& instruction, FlatPtr function)
+    {
+        m_assembler.mov(Reg::RDI, INTERPRETER);
+        m_assembler.mov(Reg::RSI, reinterpret_cast<FlatPtr>(&instruction));
+        m_assembler.mov(Reg::RAX, function);
+        m_assembler.call(Reg::RAX);
+
+        // Anything but InstructionOutcome::Continue means that the interpreter has to take it from here.
+        static_assert(to_underlying(Bytecode::Interpreter::InstructionOutcome::Continue) == 0);
+        m_assembler.test32(Reg::RAX, Reg::RAX);
+        m_assembler.jump_if(Assembler::Condition::NotEqual, m_exit);
+    }
+
+    void compile_block(Bytecode::BasicBlock const& block)
+    {
+        Bytecode::InstructionStreamIterator it(block.instruction_stream());
+        for (; !it.at_end(); ++it)
+            compile_instruction(*it);
+        emit_exit(Bytecode::Interpreter::InstructionOutcome::Stop);
+    }
+
+    void compile_instruction(Bytecode::Instruction const& instruction)
+    {
+        switch (instruction.type()) {
+        case Bytecode::Instruction::Type::Load:
+            m_assembler.load(Reg::RAX, REGISTERS, register_offset(static_cast<Bytecode::Op::Load const&>(instruction).src()));
+            m_assembler.store(REGISTERS, accumulator_offset(), Reg::RAX);
+            return;
+        case Bytecode::Instruction::Type::Store:
+            m_assembler.load(Reg::RAX, REGISTERS, accumulator_offset());
+            m_assembler.store(REGISTERS, register_offset(static_cast<Bytecode::Op::Store const&>(instruction).dst()), Reg::RAX);
+            return;
+        case Bytecode::Instruction::Type::LoadImmediate:
+            m_assembler.mov(Reg::RAX, bit_cast<u64>(static_cast<Bytecode::Op::LoadImmediate const&>(instruction).value()));
+            m_assembler.store(REGISTERS, accumulator_offset(), Reg::RAX);
+            return;
+        case Bytecode::Instruction::Type::Jump: {
+            auto const& jump = static_cast<Bytecode::Op::Jump const&>(instruction);
+            if (!jump.true_target().has_value())
+                break;
+            emit_jump_to_block(jump.true_target()->block());
+            return;
+        }
+        case Bytecode::Instruction::Type::JumpConditional:
+            compile_jump_conditional(static_cast<Bytecode::Op::Jump const&>(instruction));
+            return;
+        case Bytecode::Instruction::Type::CompareAndJump:
+            emit_call(instruction, reinterpret_cast<FlatPtr>(&run_comparison));
+            compile_jump_conditional(static_cast<Bytecode::Op::Jump const&>(instruction));
+            return;
+        case Bytecode::Instruction::Type::JumpNullish:
+            m_assembler.load(Reg::RAX, REGISTERS, accumulator_offset());
+            m_assembler.shift_right(Reg::RAX, TAG_SHIFT);
+            m_assembler.bitwise_and(Reg::RAX, static_cast<i32>(IS_NULLISH_EXTRACT_PATTERN));
+            m_assembler.cmp(Reg::RAX, static_cast<i32>(IS_NULLISH_PATTERN));
+            emit_branch(static_cast<Bytecode::Op::Jump const&>(instruction));
+            return;
+        case Bytecode::Instruction::Type::JumpUndefined:
+            m_assembler.load(Reg::RAX, REGISTERS, accumulator_offset());
+            m_assembler.shift_right(Reg::RAX, TAG_SHIFT);
+            m_assembler.cmp(Reg::RAX, static_cast<i32>(UNDEFINED_TAG));
+            emit_branch(static_cast<Bytecode::Op::Jump const&>(instruction));
+            return;
+        case Bytecode::Instruction::Type::Increment:
+            compile_int32_step(instruction, true);
+            return;
+        case Bytecode::Instruction::Type::Decrement:
+            compile_int32_step(instruction, false);
+            return;
+        default:
+            break;
+        }
+        emit_call_instruction(instruction);
+    }
+
+    // Jumps to the true target of a conditional jump if the last comparison was equal, and to the false target if not.
+    void emit_branch(Bytecode::Op::Jump const& jump)
+    {
+        Assembler::Label is_true;
+        m_assembler.jump_if(Assembler::Condition::Equal, is_true);
+        emit_jump_to_block(jump.false_target()->block());
+        m_assembler.place_label(is_true);
+        emit_jump_to_block(jump.true_target()->block());
+    }
+
+    void compile_jump_conditional(Bytecode::Op::Jump const& jump)
+    {
+        Assembler::Label is_true;
+        Assembler::Label is_false;
+
+        // Booleans are by far the most common condition, so only anything else needs to call out.
+        m_assembler.load(Reg::RAX, REGISTERS, accumulator_offset());
+        m_assembler.mov(Reg::RCX, bit_cast<u64>(Value(true)));
+        m_assembler.cmp(Reg::RAX, Reg::RCX);
+        m_assembler.jump_if(Assembler::Condition::Equal, is_true);
+        m_assembler.mov(Reg::RCX, bit_cast<u64>(Value(false)));
+        m_assembler.cmp(Reg::RAX, Reg::RCX);
+        m_assembler.jump_if(Assembler::Condition::Equal, is_false);
+
+        m_assembler.mov(Reg::RDI, REGISTERS);
+        m_assembler.mov(Reg::RAX, reinterpret_cast<FlatPtr>(&accumulator_to_boolean));
+        m_assembler.call(Reg::RAX);
+        m_assembler.test32(Reg::RAX, Reg::RAX);
+        m_assembler.jump_if(Assembler::Condition::NotEqual, is_true);
+
+        m_assembler.place_label(is_false);
+        emit_jump_to_block(jump.false_target()->block());
+        m_assembler.place_label(is_true);
+        emit_jump_to_block(jump.true_target()->block());
+    }
+
+    // Increments or decrements an int32 accumulator in place, and leaves everything else (including overflow) to the
+    // instruction itself.
+    void compile_int32_step(Bytecode::Instruction const& instruction, bool increment)
+    {
+        Assembler::Label slow_path;
+        Assembler::Label done;
+
+        m_assembler.load(Reg::RAX, REGISTERS, accumulator_offset());
+        m_assembler.mov(Reg::RCX, Reg::RAX);
+        m_assembler.shift_right(Reg::RCX, TAG_SHIFT);
+        m_assembler.cmp(Reg::RCX, static_cast<i32>(INT32_TAG));
+        m_assembler.jump_if(Assembler::Condition::NotEqual, slow_path);
+        if (increment)
+            m_assembler.add32(Reg::RAX, 1);
+        else
+            m_assembler.sub32(Reg::RAX, 1);
+        m_assembler.jump_if(Assembler::Condition::Overflow, slow_path);
+        m_assembler.mov(Reg::RCX, SHIFTED_INT32_TAG);
+        m_assembler.bitwise_or(Reg::RAX, Reg::RCX);
+        m_assembler.store(REGISTERS, accumulator_offset(), Reg::RAX);
+        m_assembler.jump(done);
+
+        m_assembler.place_label(slow_path);
+        emit_call_instruction(instruction);
+        m_assembler.place_label(done);
+    }
+
+    Bytecode::Executable const& m_executable;
+    Vector<u8> m_output;
+    Assembler m_assembler;
+    Assembler::Label m_exit;
+    Vector<Assembler::Label> m_block_labels;
+    HashMap<Bytecode::BasicBlock const*, size_t> m_block_indices;
+};
+
+OwnPtr<NativeExecutable> Compiler::compile(Bytecode::Executable const& executable)
+{
+    return CompilerImpl(executable).compile();
+}
+
+#else
+
+OwnPtr<NativeExecutable> Compiler::compile(Bytecode::Executable const&)
+{
+    return nullptr;
+}
+
+#endif
+
+}
@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <LibJS/Bytecode/Executable.h>
+#include <LibJS/JIT/NativeExecutable.h>
+
+namespace JS::JIT {
+
+// A baseline compiler that turns the bytecode of an executable into machine code, one instruction at a time.
+// The simplest instructions (moving values around, jumps and int32 increments) are done inline, everything else calls
+// into the instruction's own implementation directly, which still saves the interpreter's dispatch on every step.
+class Compiler {
+public:
+    // Returns nullptr if there's no compiler for this architecture, or the code couldn't be made executable.
+    static OwnPtr<NativeExecutable> compile(Bytecode::Executable const&);
+};
+
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibJS/Bytecode/BasicBlock.h>
+#include <LibJS/JIT/NativeExecutable.h>
+#include <sys/mman.h>
+
+namespace JS::JIT {
+
+OwnPtr<NativeExecutable> NativeExecutable::try_create(ReadonlyBytes code, HashMap<Bytecode::BasicBlock const*, size_t> block_offsets)
+{
+    // NOTE: The code is never writable and executable at the same time: it's written into a fresh mapping first,
+    //       which is then made executable (and read-only) once and for all.
+    auto* memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        dbgln_if(JS_BYTECODE_DEBUG, "JIT: Failed to allocate {} bytes for native code", code.size());
+        return nullptr;
+    }
+    __builtin_memcpy(memory, code.data(), code.size());
+
+    // NOTE: This is always going to fail for programs that aren't allowed to make memory executable, in which case we
+    //       simply keep on interpreting.
+    if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) < 0) {
+        dbgln_if(JS_BYTECODE_DEBUG, "JIT: Failed to make native code executable");
+        munmap(memory, code.size());
+        return nullptr;
+    }
+
+    auto* native_executable = new (nothrow) NativeExecutable(static_cast<u8*>(memory), code.size(), move(block_offsets));
+    if (!native_executable) {
+        munmap(memory, code.size());
+        return nullptr;
+    }
+    return adopt_own(*native_executable);
+}
+
+NativeExecutable::NativeExecutable(u8* code, size_t size, HashMap<Bytecode::BasicBlock const*, size_t> block_offsets)
+    : m_code(code)
+    , m_size(size)
+    , m_block_offsets(move(block_offsets))
+{
+}
+
+NativeExecutable::~NativeExecutable()
+{
+    munmap(m_code, m_size);
+}
+
+u32 NativeExecutable::run(Bytecode::Interpreter& interpreter, Value* registers, Bytecode::BasicBlock const*& current_block) const
+{
+    auto offset = m_block_offsets.get(current_block);
+    VERIFY(offset.has_value());
+    auto entry = reinterpret_cast<Entry>(m_code);
+    return entry(interpreter, registers, &current_block, m_code + *offset);
+}
+
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/Noncopyable.h>
+#include <AK/OwnPtr.h>
+#include <AK/Types.h>
+#include <LibJS/Forward.h>
+
+namespace JS::JIT {
+
+// Machine code for all basic blocks of a Bytecode::Executable.
+// Running it has the same effect as interpreting the instructions of a block and everything it jumps to directly,
+// and it only returns to the interpreter when the interpreter has to take over, e.g. to unwind or to return.
+class NativeExecutable {
+    AK_MAKE_NONCOPYABLE(NativeExecutable);
+    AK_MAKE_NONMOVABLE(NativeExecutable);
+
+public:
+    // The code is called with the interpreter, its current register window, where to keep track of the current block
+    // and the address to start at. It returns a Bytecode::Interpreter::InstructionOutcome.
+    using Entry = u32 (*)(Bytecode::Interpreter&, Value* registers, Bytecode::BasicBlock const** current_block, void* start);
+
+    static OwnPtr<NativeExecutable> try_create(ReadonlyBytes code, HashMap<Bytecode::BasicBlock const*, size_t> block_offsets);
+    ~NativeExecutable();
+
+    u32 run(Bytecode::Interpreter&, Value* registers, Bytecode::BasicBlock const*& current_block) const;
+
+private:
+    NativeExecutable(u8* code, size_t size, HashMap<Bytecode::BasicBlock const*, size_t> block_offsets);
+
+    u8* m_code { nullptr };
+    size_t m_size { 0 };
+    HashMap<Bytecode::BasicBlock const*, size_t> m_block_offsets;
+};
+
+}
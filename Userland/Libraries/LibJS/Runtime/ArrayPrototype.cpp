@@ -115,6 +115,18 @@ ThrowCompletionOr<void> ArrayPrototype::initialize(Realm& realm)
 }
 
 // 10.4.2.3 ArraySpeciesCreate ( originalArray, length ), https://tc39.es/ecma262/#sec-arrayspeciescreate
+// If the first `length` elements are all plain data properties of an array, reading them directly is indistinguishable
+// from going through HasProperty() and Get() for each of them, as long as no user code runs in between.
+static Optional<Span<Value const>> packed_array_elements(Object const& object, size_t length)
+{
+    if (!is<Array>(object))
+        return {};
+    auto elements = object.indexed_properties().packed_elements();
+    if (!elements.has_value() || elements->size() < length)
+        return {};
+    return elements->trim(length);
+}
+
 static ThrowCompletionOr<Object*> array_species_create(VM& vm, Object& original_array, size_t length)
 {
     auto& realm = *vm.current_realm();
@@ -904,6 +916,13 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::includes)
             from_index = from_argument;
     }
     auto value_to_find = vm.argument(0);
+    if (auto elements = packed_array_elements(*this_object, length); elements.has_value()) {
+        for (u64 i = from_index; i < length; ++i) {
+            if (same_value_zero(elements->at(i), value_to_find))
+                return Value(true);
+        }
+        return Value(false);
+    }
     for (u64 i = from_index; i < length; ++i) {
         auto element = TRY(this_object->get(i));
         if (same_value_zero(element, value_to_find))
@@ -957,6 +976,15 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::index_of)
         k = max(length + n, 0);
     }
 
+    // NOTE: Every element is present, so this is the same as the loop below without the property lookups.
+    if (auto elements = packed_array_elements(*object, length); elements.has_value()) {
+        for (; k < length; ++k) {
+            if (is_strictly_equal(search_element, elements->at(k)))
+                return Value(k);
+        }
+        return Value(-1);
+    }
+
     // 10. Repeat, while k < len,
     for (; k < length; ++k) {
         auto property_key = PropertyKey { k };
@@ -1068,6 +1096,15 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::last_index_of)
         k = (double)length + n;
     }
 
+    // NOTE: Every element is present, so this is the same as the loop below without the property lookups.
+    if (auto elements = packed_array_elements(*object, length); elements.has_value()) {
+        for (; k >= 0; --k) {
+            if (is_strictly_equal(search_element, elements->at(k)))
+                return Value((size_t)k);
+        }
+        return Value(-1);
+    }
+
     // 8. Repeat, while k ≥ 0,
     for (; k >= 0; --k) {
         auto property_key = PropertyKey { k };
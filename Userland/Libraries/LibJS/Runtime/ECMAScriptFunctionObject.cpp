@@ -840,14 +840,34 @@ Completion ECMAScriptFunctionObject::ordinary_call_evaluate_body()
                 return bytecode_executable;
             };
 
-            m_bytecode_executable = TRY(compile(*m_ecmascript_code, m_kind, m_name));
-
-            size_t default_parameter_index = 0;
-            for (auto& parameter : m_formal_parameters) {
-                if (!parameter.default_value)
-                    continue;
-                auto executable = TRY(compile(*parameter.default_value, FunctionKind::Normal, DeprecatedString::formatted("default parameter #{} for {}", default_parameter_index, m_name)));
-                m_default_parameter_bytecode_executables.append(move(executable));
+            auto const* function_body = is<FunctionBody>(*m_ecmascript_code) ? static_cast<FunctionBody const*>(m_ecmascript_code.ptr()) : nullptr;
+            if (!function_body || !function_body->bytecode_executable()) {
+                auto executable = TRY(compile(*m_ecmascript_code, m_kind, m_name));
+
+                Vector<NonnullOwnPtr<Bytecode::Executable>> default_parameter_executables;
+                size_t default_parameter_index = 0;
+                for (auto& parameter : m_formal_parameters) {
+                    if (!parameter.default_value)
+                        continue;
+                    default_parameter_executables.append(TRY(compile(*parameter.default_value, FunctionKind::Normal, DeprecatedString::formatted("default parameter #{} for {}", default_parameter_index, m_name))));
+                }
+
+                if (function_body) {
+                    function_body->set_bytecode_executables({}, move(executable), move(default_parameter_executables));
+                } else {
+                    m_owned_bytecode_executable = move(executable);
+                    m_owned_default_parameter_bytecode_executables = move(default_parameter_executables);
+                }
+            }
+
+            if (function_body) {
+                m_bytecode_executable = function_body->bytecode_executable();
+                for (auto& executable : function_body->default_parameter_bytecode_executables())
+                    m_default_parameter_bytecode_executables.append(executable.ptr());
+            } else {
+                m_bytecode_executable = m_owned_bytecode_executable.ptr();
+                for (auto& executable : m_owned_default_parameter_bytecode_executables)
+                    m_default_parameter_bytecode_executables.append(executable.ptr());
             }
         }
         TRY(function_declaration_instantiation(nullptr));
@@ -106,8 +106,11 @@ private:
     ThrowCompletionOr<void> function_declaration_instantiation(Interpreter*);
 
     DeprecatedFlyString m_name;
-    OwnPtr<Bytecode::Executable> m_bytecode_executable;
-    Vector<OwnPtr<Bytecode::Executable>> m_default_parameter_bytecode_executables;
+    Bytecode::Executable const* m_bytecode_executable { nullptr };
+    Vector<Bytecode::Executable const*> m_default_parameter_bytecode_executables;
+    // NOTE: The bytecode is owned (and shared) by the function body if there is one, this is for everything else.
+    OwnPtr<Bytecode::Executable> m_owned_bytecode_executable;
+    Vector<NonnullOwnPtr<Bytecode::Executable>> m_owned_default_parameter_bytecode_executables;
     i32 m_function_length { 0 };
 
     // Internal Slots of ECMAScript Function Objects, https://tc39.es/ecma262/#table-internal-slots-of-ecmascript-function-objects
@@ -11,7 +11,7 @@ namespace JS {
 
 FinalizationRegistry::FinalizationRegistry(Realm& realm, JobCallback cleanup_callback, Object& prototype)
     : Object(ConstructWithPrototypeTag::Tag, prototype)
-    , WeakContainer(heap())
+    , WeakContainer(heap(), *this)
     , m_realm(realm)
     , m_cleanup_callback(move(cleanup_callback))
 {
@@ -49,7 +49,7 @@ void FinalizationRegistry::remove_dead_cells(Badge<Heap>)
 {
     auto any_cells_were_removed = false;
     for (auto& record : m_records) {
-        if (!record.target || record.target->state() == Cell::State::Live)
+        if (!record.target || record.target->is_marked())
             continue;
         record.target = nullptr;
         any_cells_were_removed = true;
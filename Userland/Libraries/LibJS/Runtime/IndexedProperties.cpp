@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AllOf.h>
 #include <AK/QuickSort.h>
 #include <LibJS/Runtime/Accessor.h>
 #include <LibJS/Runtime/IndexedProperties.h>
@@ -16,6 +17,7 @@ constexpr const size_t LENGTH_SETTER_GENERIC_STORAGE_THRESHOLD = 4 * MiB;
 SimpleIndexedPropertyStorage::SimpleIndexedPropertyStorage(Vector<Value>&& initial_values)
     : m_array_size(initial_values.size())
     , m_packed_elements(move(initial_values))
+    , m_is_packed(all_of(m_packed_elements, [](auto& value) { return !value.is_empty(); }))
 {
 }
 
@@ -48,6 +50,9 @@ void SimpleIndexedPropertyStorage::put(u32 index, Value value, PropertyAttribute
 {
     VERIFY(attributes == default_attributes);
 
+    if (index > m_array_size || value.is_empty())
+        m_is_packed = false;
+
     if (index >= m_array_size) {
         m_array_size = index + 1;
         grow_storage_if_needed();
@@ -59,6 +64,7 @@ void SimpleIndexedPropertyStorage::remove(u32 index)
 {
     VERIFY(index < m_array_size);
     m_packed_elements[index] = {};
+    m_is_packed = false;
 }
 
 ValueAndAttributes SimpleIndexedPropertyStorage::take_first()
@@ -77,6 +83,8 @@ ValueAndAttributes SimpleIndexedPropertyStorage::take_last()
 
 bool SimpleIndexedPropertyStorage::set_array_like_size(size_t new_size)
 {
+    if (new_size > m_array_size)
+        m_is_packed = false;
     m_array_size = new_size;
     m_packed_elements.resize_and_keep_capacity(new_size);
     return true;
@@ -265,7 +273,10 @@ size_t IndexedProperties::real_size() const
     if (!m_storage)
         return 0;
     if (m_storage->is_simple_storage()) {
-        auto& packed_elements = static_cast<SimpleIndexedPropertyStorage const&>(*m_storage).elements();
+        auto const& storage = static_cast<SimpleIndexedPropertyStorage const&>(*m_storage);
+        if (storage.is_packed())
+            return storage.array_like_size();
+        auto& packed_elements = storage.elements();
         size_t size = 0;
         for (auto& element : packed_elements) {
             if (!element.is_empty())
@@ -297,6 +308,18 @@ Vector<u32> IndexedProperties::indices() const
     return indices;
 }
 
+Optional<Span<Value const>> IndexedProperties::packed_elements() const
+{
+    if (!m_storage)
+        return Span<Value const> {};
+    if (!m_storage->is_simple_storage())
+        return {};
+    auto const& storage = static_cast<SimpleIndexedPropertyStorage const&>(*m_storage);
+    if (!storage.is_packed())
+        return {};
+    return storage.elements().span().trim(storage.array_like_size());
+}
+
 void IndexedProperties::switch_to_generic_storage()
 {
     if (!m_storage) {
@@ -60,6 +60,11 @@ public:
     virtual bool is_simple_storage() const override { return true; }
     Vector<Value> const& elements() const { return m_packed_elements; }
 
+    // A packed storage has no holes, so every element below array_like_size() is a data property with a value.
+    // Once a hole might have been created, the storage becomes holey and stays that way, even if the hole is filled
+    // later on, as knowing that for sure would require looking at every element again.
+    bool is_packed() const { return m_is_packed; }
+
 private:
     friend GenericIndexedPropertyStorage;
 
@@ -67,6 +72,7 @@ private:
 
     size_t m_array_size { 0 };
     Vector<Value> m_packed_elements;
+    bool m_is_packed { true };
 };
 
 class GenericIndexedPropertyStorage final : public IndexedPropertyStorage {
@@ -140,6 +146,9 @@ public:
 
     Vector<u32> indices() const;
 
+    // Returns all elements if they can be read directly, i.e. if none of them is missing or has non-default attributes.
+    Optional<Span<Value const>> packed_elements() const;
+
     template<typename Callback>
     void for_each_value(Callback callback)
     {
@@ -703,12 +703,14 @@ ThrowCompletionOr<Optional<PropertyDescriptor>> Object::internal_get_own_propert
     VERIFY(property_key.is_valid());
 
     // 1. If O does not have an own property with key P, return undefined.
-    auto maybe_storage_entry = storage_get(property_key);
+    Optional<u32> property_offset;
+    auto maybe_storage_entry = storage_get(property_key, &property_offset);
     if (!maybe_storage_entry.has_value())
         return Optional<PropertyDescriptor> {};
 
     // 2. Let D be a newly created Property Descriptor with no fields.
     PropertyDescriptor descriptor;
+    descriptor.property_offset = property_offset;
 
     // 3. Let X be O's own property whose key is P.
     auto [value, attributes] = *maybe_storage_entry;
@@ -783,7 +785,7 @@ ThrowCompletionOr<bool> Object::internal_has_property(PropertyKey const& propert
 }
 
 // 10.1.8 [[Get]] ( P, Receiver ), https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots-get-p-receiver
-ThrowCompletionOr<Value> Object::internal_get(PropertyKey const& property_key, Value receiver) const
+ThrowCompletionOr<Value> Object::internal_get(PropertyKey const& property_key, Value receiver, CacheablePropertyMetadata* cacheable_metadata) const
 {
     VERIFY(!receiver.is_empty());
     VERIFY(property_key.is_valid());
@@ -803,12 +805,22 @@ ThrowCompletionOr<Value> Object::internal_get(PropertyKey const& property_key, V
             return js_undefined();
 
         // c. Return ? parent.[[Get]](P, Receiver).
-        return parent->internal_get(property_key, receiver);
+        auto value = TRY(parent->internal_get(property_key, receiver, cacheable_metadata));
+        if (cacheable_metadata && cacheable_metadata->type == CacheablePropertyMetadata::Type::OwnProperty) {
+            cacheable_metadata->type = CacheablePropertyMetadata::Type::InPrototypeChain;
+            cacheable_metadata->prototype = parent;
+        }
+        return value;
     }
 
     // 3. If IsDataDescriptor(desc) is true, return desc.[[Value]].
-    if (descriptor->is_data_descriptor())
+    if (descriptor->is_data_descriptor()) {
+        if (cacheable_metadata && descriptor->property_offset.has_value()) {
+            cacheable_metadata->type = CacheablePropertyMetadata::Type::OwnProperty;
+            cacheable_metadata->property_offset = descriptor->property_offset.value();
+        }
         return *descriptor->value;
+    }
 
     // 4. Assert: IsAccessorDescriptor(desc) is true.
     VERIFY(descriptor->is_accessor_descriptor());
@@ -825,7 +837,7 @@ ThrowCompletionOr<Value> Object::internal_get(PropertyKey const& property_key, V
 }
 
 // 10.1.9 [[Set]] ( P, V, Receiver ), https://tc39.es/ecma262/#sec-ordinary-object-internal-methods-and-internal-slots-set-p-v-receiver
-ThrowCompletionOr<bool> Object::internal_set(PropertyKey const& property_key, Value value, Value receiver)
+ThrowCompletionOr<bool> Object::internal_set(PropertyKey const& property_key, Value value, Value receiver, CacheablePropertyMetadata* cacheable_metadata)
 {
     VERIFY(property_key.is_valid());
     VERIFY(!value.is_empty());
@@ -834,6 +846,13 @@ ThrowCompletionOr<bool> Object::internal_set(PropertyKey const& property_key, Va
     // 2. Let ownDesc be ? O.[[GetOwnProperty]](P).
     auto own_descriptor = TRY(internal_get_own_property(property_key));
 
+    // Note: Setting a writable data property that lives in our own storage comes down to just replacing its value.
+    if (cacheable_metadata && own_descriptor.has_value() && own_descriptor->property_offset.has_value() && own_descriptor->is_data_descriptor()
+        && *own_descriptor->writable && receiver.is_object() && &receiver.as_object() == this) {
+        cacheable_metadata->type = CacheablePropertyMetadata::Type::OwnProperty;
+        cacheable_metadata->property_offset = own_descriptor->property_offset.value();
+    }
+
     // 3. Return ? OrdinarySetWithOwnDescriptor(O, P, V, Receiver, ownDesc).
     return ordinary_set_with_own_descriptor(property_key, value, receiver, own_descriptor);
 }
@@ -1015,7 +1034,7 @@ static Optional<Object::IntrinsicAccessor> find_intrinsic_accessor(Object const*
     return move(accessor->value);
 }
 
-Optional<ValueAndAttributes> Object::storage_get(PropertyKey const& property_key) const
+Optional<ValueAndAttributes> Object::storage_get(PropertyKey const& property_key, Optional<u32>* property_offset) const
 {
     VERIFY(property_key.is_valid());
 
@@ -1038,6 +1057,8 @@ Optional<ValueAndAttributes> Object::storage_get(PropertyKey const& property_key
 
         value = m_storage[metadata->offset];
         attributes = metadata->attributes;
+        if (property_offset)
+            *property_offset = metadata->offset;
     }
 
     return ValueAndAttributes { .value = value, .attributes = attributes };
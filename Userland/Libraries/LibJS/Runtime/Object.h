@@ -40,6 +40,20 @@ struct PrivateElement {
     Value value;
 };
 
+// Filled in by the ordinary [[Get]] and [[Set]] when the property they found can be accessed through its offset in the
+// storage of an object for as long as the shapes involved don't change. Used by the bytecode interpreter's inline caches.
+struct CacheablePropertyMetadata {
+    enum class Type {
+        NotCacheable,
+        OwnProperty,
+        InPrototypeChain,
+    };
+
+    Type type { Type::NotCacheable };
+    u32 property_offset { 0 };
+    Object const* prototype { nullptr };
+};
+
 class Object : public Cell {
     JS_CELL(Object, Cell);
 
@@ -119,8 +133,8 @@ public:
     virtual ThrowCompletionOr<Optional<PropertyDescriptor>> internal_get_own_property(PropertyKey const&) const;
     virtual ThrowCompletionOr<bool> internal_define_own_property(PropertyKey const&, PropertyDescriptor const&);
     virtual ThrowCompletionOr<bool> internal_has_property(PropertyKey const&) const;
-    virtual ThrowCompletionOr<Value> internal_get(PropertyKey const&, Value receiver) const;
-    virtual ThrowCompletionOr<bool> internal_set(PropertyKey const&, Value value, Value receiver);
+    virtual ThrowCompletionOr<Value> internal_get(PropertyKey const&, Value receiver, CacheablePropertyMetadata* = nullptr) const;
+    virtual ThrowCompletionOr<bool> internal_set(PropertyKey const&, Value value, Value receiver, CacheablePropertyMetadata* = nullptr);
     virtual ThrowCompletionOr<bool> internal_delete(PropertyKey const&);
     virtual ThrowCompletionOr<MarkedVector<Value>> internal_own_property_keys() const;
 
@@ -140,7 +154,7 @@ public:
 
     // Implementation-specific storage abstractions
 
-    Optional<ValueAndAttributes> storage_get(PropertyKey const&) const;
+    Optional<ValueAndAttributes> storage_get(PropertyKey const&, Optional<u32>* property_offset = nullptr) const;
     bool storage_has(PropertyKey const&) const;
     void storage_set(PropertyKey const&, ValueAndAttributes const&);
     void storage_delete(PropertyKey const&);
@@ -175,6 +189,7 @@ public:
     virtual void visit_edges(Cell::Visitor&) override;
 
     Value get_direct(size_t index) const { return m_storage[index]; }
+    void put_direct(size_t index, Value value) { m_storage[index] = value; }
 
     IndexedProperties const& indexed_properties() const { return m_indexed_properties; }
     IndexedProperties& indexed_properties() { return m_indexed_properties; }
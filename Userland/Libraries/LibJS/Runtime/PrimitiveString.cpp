@@ -40,8 +40,11 @@ PrimitiveString::PrimitiveString(Utf16String string)
 {
 }
 
-PrimitiveString::~PrimitiveString()
+PrimitiveString::~PrimitiveString() = default;
+
+void PrimitiveString::finalize()
 {
+    Base::finalize();
     if (has_utf8_string())
         vm().string_cache().remove(*m_utf8_string);
     if (has_deprecated_string())
@@ -73,6 +76,62 @@ bool PrimitiveString::is_empty() const
     VERIFY_NOT_REACHED();
 }
 
+ThrowCompletionOr<size_t> PrimitiveString::length_in_utf16_code_units() const
+{
+    if (m_length_in_utf16_code_units.has_value())
+        return *m_length_in_utf16_code_units;
+
+    auto length_of_resolved_string = [](PrimitiveString const& string) -> size_t {
+        if (string.has_utf16_string())
+            return string.m_utf16_string->length_in_code_units();
+        if (string.has_utf8_string())
+            return utf16_code_unit_length_from_utf8(string.m_utf8_string->bytes_as_string_view());
+        if (string.has_deprecated_string())
+            return utf16_code_unit_length_from_utf8(*string.m_deprecated_string);
+        VERIFY_NOT_REACHED();
+    };
+
+    if (!m_is_rope) {
+        m_length_in_utf16_code_units = length_of_resolved_string(*this);
+        return *m_length_in_utf16_code_units;
+    }
+
+    // NOTE: The length of a rope is the sum of the lengths of its pieces, even if a surrogate pair gets split across two
+    //       of them. Like when resolving ropes, this traverses the rope tree without using recursion, and remembers
+    //       the length of every rope along the way.
+    auto& vm = this->vm();
+    Vector<PrimitiveString const*> stack;
+    TRY_OR_THROW_OOM(vm, stack.try_append(this));
+    while (!stack.is_empty()) {
+        auto const* current = stack.last();
+        if (current->m_length_in_utf16_code_units.has_value()) {
+            stack.take_last();
+            continue;
+        }
+
+        if (!current->m_is_rope) {
+            current->m_length_in_utf16_code_units = length_of_resolved_string(*current);
+            stack.take_last();
+            continue;
+        }
+
+        auto const& lhs_length = current->m_lhs->m_length_in_utf16_code_units;
+        auto const& rhs_length = current->m_rhs->m_length_in_utf16_code_units;
+        if (lhs_length.has_value() && rhs_length.has_value()) {
+            current->m_length_in_utf16_code_units = *lhs_length + *rhs_length;
+            stack.take_last();
+            continue;
+        }
+
+        if (!rhs_length.has_value())
+            TRY_OR_THROW_OOM(vm, stack.try_append(current->m_rhs));
+        if (!lhs_length.has_value())
+            TRY_OR_THROW_OOM(vm, stack.try_append(current->m_lhs));
+    }
+
+    return *m_length_in_utf16_code_units;
+}
+
 ThrowCompletionOr<String> PrimitiveString::utf8_string() const
 {
     auto& vm = this->vm();
@@ -140,7 +199,7 @@ ThrowCompletionOr<Optional<Value>> PrimitiveString::get(VM& vm, PropertyKey cons
         return Optional<Value> {};
     if (property_key.is_string()) {
         if (property_key.as_string() == vm.names.length.as_string()) {
-            auto length = TRY(utf16_string()).length_in_code_units();
+            auto length = TRY(length_in_utf16_code_units());
             return Value(static_cast<double>(length));
         }
     }
@@ -35,6 +35,10 @@ public:
 
     bool is_empty() const;
 
+    // The length of the string in UTF-16 code units, i.e. what `length` is in JS.
+    // NOTE: This doesn't need to resolve ropes, or convert the string to UTF-16.
+    ThrowCompletionOr<size_t> length_in_utf16_code_units() const;
+
     ThrowCompletionOr<String> utf8_string() const;
     ThrowCompletionOr<StringView> utf8_string_view() const;
     bool has_utf8_string() const { return m_utf8_string.has_value(); }
@@ -54,6 +58,7 @@ private:
     explicit PrimitiveString(DeprecatedString);
     explicit PrimitiveString(Utf16String);
 
+    virtual void finalize() override;
     virtual void visit_edges(Cell::Visitor&) override;
 
     ThrowCompletionOr<void> resolve_rope_if_needed() const;
@@ -66,6 +71,8 @@ private:
     mutable Optional<String> m_utf8_string;
     mutable Optional<DeprecatedString> m_deprecated_string;
     mutable Optional<Utf16String> m_utf16_string;
+
+    mutable Optional<size_t> m_length_in_utf16_code_units;
 };
 
 }
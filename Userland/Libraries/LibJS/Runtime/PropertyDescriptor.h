@@ -39,6 +39,9 @@ public:
     Optional<bool> writable {};
     Optional<bool> enumerable {};
     Optional<bool> configurable {};
+
+    // Not part of the spec: Where the property lives in the object's storage, if it's an ordinary own property.
+    Optional<u32> property_offset {};
 };
 
 }
@@ -113,6 +113,12 @@ void Realm::set_global_object(Object* global_object, Object* this_value)
     // 7. Return unused.
 }
 
+void Realm::finalize()
+{
+    Base::finalize();
+    revoke_weak_ptrs();
+}
+
 void Realm::visit_edges(Visitor& visitor)
 {
     Base::visit_edges(visitor);
@@ -51,6 +51,7 @@ public:
 private:
     Realm() = default;
 
+    virtual void finalize() override;
     virtual void visit_edges(Visitor&) override;
 
     Intrinsics* m_intrinsics { nullptr };                // [[Intrinsics]]
@@ -59,7 +59,7 @@ Shape* Shape::create_put_transition(StringOrSymbol const& property_key, Property
         return existing_shape;
     auto new_shape = heap().allocate_without_realm<Shape>(*this, property_key, attributes, TransitionType::Put);
     if (!m_forward_transitions)
-        m_forward_transitions = make<HashMap<TransitionKey, WeakPtr<Shape>>>();
+        m_forward_transitions = make<FlatHashMap<TransitionKey, WeakPtr<Shape>>>();
     m_forward_transitions->set(key, new_shape.ptr());
     return new_shape;
 }
@@ -71,7 +71,7 @@ Shape* Shape::create_configure_transition(StringOrSymbol const& property_key, Pr
         return existing_shape;
     auto new_shape = heap().allocate_without_realm<Shape>(*this, property_key, attributes, TransitionType::Configure);
     if (!m_forward_transitions)
-        m_forward_transitions = make<HashMap<TransitionKey, WeakPtr<Shape>>>();
+        m_forward_transitions = make<FlatHashMap<TransitionKey, WeakPtr<Shape>>>();
     m_forward_transitions->set(key, new_shape.ptr());
     return new_shape;
 }
@@ -82,7 +82,7 @@ Shape* Shape::create_prototype_transition(Object* new_prototype)
         return existing_shape;
     auto new_shape = heap().allocate_without_realm<Shape>(*this, new_prototype);
     if (!m_prototype_transitions)
-        m_prototype_transitions = make<HashMap<Object*, WeakPtr<Shape>>>();
+        m_prototype_transitions = make<FlatHashMap<Object*, WeakPtr<Shape>>>();
     m_prototype_transitions->set(new_prototype, new_shape.ptr());
     return new_shape;
 }
@@ -112,6 +112,14 @@ Shape::Shape(Shape& previous_shape, Object* new_prototype)
 {
 }
 
+void Shape::finalize()
+{
+    Base::finalize();
+    // NOTE: Dead cells are only destroyed once their memory gets swept, but nothing may pick up this shape from a
+    //       cached transition (or a property lookup cache) in the meantime.
+    revoke_weak_ptrs();
+}
+
 void Shape::visit_edges(Cell::Visitor& visitor)
 {
     Cell::visit_edges(visitor);
@@ -196,6 +204,7 @@ void Shape::add_property_to_unique_shape(StringOrSymbol const& property_key, Pro
 
     VERIFY(m_property_count < NumericLimits<u32>::max());
     ++m_property_count;
+    ++m_serial_number;
 }
 
 void Shape::reconfigure_property_in_unique_shape(StringOrSymbol const& property_key, PropertyAttributes attributes)
@@ -206,6 +215,7 @@ void Shape::reconfigure_property_in_unique_shape(StringOrSymbol const& property_
     VERIFY(it != m_property_table->end());
     it->value.attributes = attributes;
     m_property_table->set(property_key, it->value);
+    ++m_serial_number;
 }
 
 void Shape::remove_property_from_unique_shape(StringOrSymbol const& property_key, size_t offset)
@@ -219,6 +229,7 @@ void Shape::remove_property_from_unique_shape(StringOrSymbol const& property_key
         if (it.value.offset > offset)
             --it.value.offset;
     }
+    ++m_serial_number;
 }
 
 void Shape::add_property_without_transition(StringOrSymbol const& property_key, PropertyAttributes attributes)
@@ -229,6 +240,7 @@ void Shape::add_property_without_transition(StringOrSymbol const& property_key,
         VERIFY(m_property_count < NumericLimits<u32>::max());
         ++m_property_count;
     }
+    ++m_serial_number;
 }
 
 FLATTEN void Shape::add_property_without_transition(PropertyKey const& property_key, PropertyAttributes attributes)
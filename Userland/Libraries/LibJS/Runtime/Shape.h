@@ -75,7 +75,15 @@ public:
 
     Vector<Property> property_table_ordered() const;
 
-    void set_prototype_without_transition(Object* new_prototype) { m_prototype = new_prototype; }
+    void set_prototype_without_transition(Object* new_prototype)
+    {
+        m_prototype = new_prototype;
+        ++m_serial_number;
+    }
+
+    // Changes whenever this shape is modified in place instead of through a transition, so that caches holding on to it
+    // can tell whether what they remembered is still true.
+    u32 serial_number() const { return m_serial_number; }
 
     void remove_property_from_unique_shape(StringOrSymbol const&, size_t offset);
     void add_property_to_unique_shape(StringOrSymbol const&, PropertyAttributes attributes);
@@ -86,6 +94,7 @@ private:
     Shape(Shape& previous_shape, StringOrSymbol const& property_key, PropertyAttributes attributes, TransitionType);
     Shape(Shape& previous_shape, Object* new_prototype);
 
+    virtual void finalize() override;
     virtual void visit_edges(Visitor&) override;
 
     Shape* get_or_prune_cached_forward_transition(TransitionKey const&);
@@ -97,12 +106,13 @@ private:
 
     mutable OwnPtr<HashMap<StringOrSymbol, PropertyMetadata>> m_property_table;
 
-    OwnPtr<HashMap<TransitionKey, WeakPtr<Shape>>> m_forward_transitions;
-    OwnPtr<HashMap<Object*, WeakPtr<Shape>>> m_prototype_transitions;
+    OwnPtr<FlatHashMap<TransitionKey, WeakPtr<Shape>>> m_forward_transitions;
+    OwnPtr<FlatHashMap<Object*, WeakPtr<Shape>>> m_prototype_transitions;
     Shape* m_previous { nullptr };
     StringOrSymbol m_property_key;
     Object* m_prototype { nullptr };
     u32 m_property_count { 0 };
+    u32 m_serial_number { 0 };
 
     PropertyAttributes m_attributes { 0 };
     TransitionType m_transition_type : 6 { TransitionType::Invalid };
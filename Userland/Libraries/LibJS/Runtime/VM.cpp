@@ -197,29 +197,29 @@ VM::InterpreterExecutionScope::~InterpreterExecutionScope()
     m_interpreter.vm().pop_interpreter(m_interpreter);
 }
 
-void VM::gather_roots(HashTable<Cell*>& roots)
+void VM::gather_roots(Vector<Cell*>& roots)
 {
-    roots.set(m_empty_string);
+    roots.append(m_empty_string);
     for (auto* string : m_single_ascii_character_strings)
-        roots.set(string);
+        roots.append(string);
 
     auto gather_roots_from_execution_context_stack = [&roots](Vector<ExecutionContext*> const& stack) {
         for (auto& execution_context : stack) {
             if (execution_context->this_value.is_cell())
-                roots.set(&execution_context->this_value.as_cell());
+                roots.append(&execution_context->this_value.as_cell());
             for (auto& argument : execution_context->arguments) {
                 if (argument.is_cell())
-                    roots.set(&argument.as_cell());
+                    roots.append(&argument.as_cell());
             }
-            roots.set(execution_context->lexical_environment);
-            roots.set(execution_context->variable_environment);
-            roots.set(execution_context->private_environment);
+            roots.append(execution_context->lexical_environment);
+            roots.append(execution_context->variable_environment);
+            roots.append(execution_context->private_environment);
             if (auto* context_owner = execution_context->context_owner)
-                roots.set(context_owner);
+                roots.append(context_owner);
             execution_context->script_or_module.visit(
                 [](Empty) {},
                 [&](auto& script_or_module) {
-                    roots.set(script_or_module.ptr());
+                    roots.append(script_or_module.ptr());
                 });
         }
     };
@@ -229,15 +229,15 @@ void VM::gather_roots(HashTable<Cell*>& roots)
         gather_roots_from_execution_context_stack(saved_stack);
 
 #define __JS_ENUMERATE(SymbolName, snake_name) \
-    roots.set(well_known_symbol_##snake_name());
+    roots.append(well_known_symbol_##snake_name());
     JS_ENUMERATE_WELL_KNOWN_SYMBOLS
 #undef __JS_ENUMERATE
 
     for (auto& symbol : m_global_symbol_registry)
-        roots.set(symbol.value);
+        roots.append(symbol.value);
 
     for (auto* finalization_registry : m_finalization_registry_cleanup_jobs)
-        roots.set(finalization_registry);
+        roots.append(finalization_registry);
 }
 
 ThrowCompletionOr<Value> VM::named_evaluation_if_anonymous_function(ASTNode const& expression, DeprecatedFlyString const& name)
@@ -9,8 +9,9 @@
 
 namespace JS {
 
-WeakContainer::WeakContainer(Heap& heap)
-    : m_heap(heap)
+WeakContainer::WeakContainer(Heap& heap, Cell& owner)
+    : m_owner(owner)
+    , m_heap(heap)
 {
     m_heap.did_create_weak_container({}, *this);
 }
@@ -13,16 +13,20 @@ namespace JS {
 
 class WeakContainer {
 public:
-    explicit WeakContainer(Heap&);
+    WeakContainer(Heap&, Cell& owner);
     virtual ~WeakContainer();
 
+    // This is called right after marking, so every cell that isn't marked by now is going to be destroyed.
     virtual void remove_dead_cells(Badge<Heap>) = 0;
 
+    Cell const& owner() const { return m_owner; }
+
 protected:
     void deregister();
 
 private:
     bool m_registered { true };
+    Cell& m_owner;
     Heap& m_heap;
 
     IntrusiveListNode<WeakContainer> m_list_node;
@@ -15,14 +15,14 @@ NonnullGCPtr<WeakMap> WeakMap::create(Realm& realm)
 
 WeakMap::WeakMap(Object& prototype)
     : Object(ConstructWithPrototypeTag::Tag, prototype)
-    , WeakContainer(heap())
+    , WeakContainer(heap(), *this)
 {
 }
 
 void WeakMap::remove_dead_cells(Badge<Heap>)
 {
     m_values.remove_all_matching([](Cell* key, Value) {
-        return key->state() != Cell::State::Live;
+        return !key->is_marked();
     });
 }
 
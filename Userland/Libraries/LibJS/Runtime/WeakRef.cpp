@@ -20,7 +20,7 @@ NonnullGCPtr<WeakRef> WeakRef::create(Realm& realm, Symbol& value)
 
 WeakRef::WeakRef(Object& value, Object& prototype)
     : Object(ConstructWithPrototypeTag::Tag, prototype)
-    , WeakContainer(heap())
+    , WeakContainer(heap(), *this)
     , m_value(&value)
     , m_last_execution_generation(vm().execution_generation())
 {
@@ -28,7 +28,7 @@ WeakRef::WeakRef(Object& value, Object& prototype)
 
 WeakRef::WeakRef(Symbol& value, Object& prototype)
     : Object(ConstructWithPrototypeTag::Tag, prototype)
-    , WeakContainer(heap())
+    , WeakContainer(heap(), *this)
     , m_value(&value)
     , m_last_execution_generation(vm().execution_generation())
 {
@@ -36,7 +36,7 @@ WeakRef::WeakRef(Symbol& value, Object& prototype)
 
 void WeakRef::remove_dead_cells(Badge<Heap>)
 {
-    if (m_value.visit([](Cell* cell) -> bool { return cell->state() == Cell::State::Live; }, [](Empty) -> bool { VERIFY_NOT_REACHED(); }))
+    if (m_value.visit([](Cell* cell) -> bool { return cell->is_marked(); }, [](Empty) -> bool { VERIFY_NOT_REACHED(); }))
         return;
 
     m_value = Empty {};
@@ -15,14 +15,14 @@ NonnullGCPtr<WeakSet> WeakSet::create(Realm& realm)
 
 WeakSet::WeakSet(Object& prototype)
     : Object(ConstructWithPrototypeTag::Tag, prototype)
-    , WeakContainer(heap())
+    , WeakContainer(heap(), *this)
 {
 }
 
 void WeakSet::remove_dead_cells(Badge<Heap>)
 {
     m_values.remove_all_matching([](Cell* cell) {
-        return cell->state() != Cell::State::Live;
+        return !cell->is_marked();
     });
 }
 
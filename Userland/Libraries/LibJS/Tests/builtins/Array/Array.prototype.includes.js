@@ -17,6 +17,31 @@ test("basic functionality", () => {
     expect(array.includes("friends", 100)).toBeFalse();
 });
 
+test("holes are read through the prototype chain", () => {
+    var array = [1, , 3];
+    expect(array.includes(undefined)).toBeTrue();
+    expect(array.includes(2)).toBeFalse();
+
+    Array.prototype[1] = 2;
+    try {
+        expect(array.includes(2)).toBeTrue();
+    } finally {
+        delete Array.prototype[1];
+    }
+});
+
+test("array shrinks while converting fromIndex", () => {
+    var array = [1, 2, 3, 4];
+    var fromIndex = {
+        valueOf() {
+            array.length = 2;
+            return 0;
+        },
+    };
+    expect(array.includes(undefined, fromIndex)).toBeTrue();
+    expect(array.includes(3)).toBeFalse();
+});
+
 test("is unscopable", () => {
     expect(Array.prototype[Symbol.unscopables].includes).toBeTrue();
     const array = [];
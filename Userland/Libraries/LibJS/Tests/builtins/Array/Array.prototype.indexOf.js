@@ -23,3 +23,26 @@ test("basic functionality", () => {
     expect([].indexOf()).toBe(-1);
     expect([undefined].indexOf()).toBe(0);
 });
+
+test("holes and array-like objects", () => {
+    var array = [1, , 3];
+    expect(array.indexOf(undefined)).toBe(-1);
+    expect(array.indexOf(3)).toBe(2);
+
+    array[1] = 2;
+    expect(array.indexOf(2)).toBe(1);
+
+    expect(Array.prototype.indexOf.call({ length: 2, 0: "a", 1: "b" }, "b")).toBe(1);
+});
+
+test("array shrinks while converting fromIndex", () => {
+    var array = [1, 2, 3, 4];
+    var fromIndex = {
+        valueOf() {
+            array.length = 2;
+            return 0;
+        },
+    };
+    expect(array.indexOf(3, fromIndex)).toBe(-1);
+    expect(array.indexOf(2)).toBe(1);
+});
@@ -20,3 +20,10 @@ test("basic functionality", () => {
     expect([undefined].lastIndexOf()).toBe(0);
     expect([undefined, undefined, undefined].lastIndexOf()).toBe(2);
 });
+
+test("holes", () => {
+    var array = [1, , 1, , 3];
+    expect(array.lastIndexOf(undefined)).toBe(-1);
+    expect(array.lastIndexOf(1)).toBe(2);
+    expect(array.lastIndexOf(3)).toBe(4);
+});
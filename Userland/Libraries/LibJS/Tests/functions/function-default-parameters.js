@@ -141,3 +141,11 @@ test("parameter with an object default value", () => {
     expect(arrowFunc()).toBe("bar");
     expect(arrowFunc({ foo: "baz" })).toBe("baz");
 });
+
+test("default parameters of functions created from the same code", () => {
+    const makeFunction = base => (a = base * 2) => a + base;
+    const functions = [1, 2, 3].map(makeFunction);
+
+    expect(functions.map(f => f())).toEqual([3, 6, 9]);
+    expect(functions.map(f => f(10))).toEqual([11, 12, 13]);
+});
@@ -0,0 +1,49 @@
+test("counting across the int32 boundary", () => {
+    let up = 2147483547;
+    for (let i = 0; i < 200; ++i) up++;
+    expect(up).toBe(2147483747);
+
+    let down = -2147483548;
+    for (let i = 0; i < 200; ++i) down--;
+    expect(down).toBe(-2147483748);
+});
+
+test("conditions that aren't booleans", () => {
+    const values = [0, 1, "", "a", null, undefined, {}, NaN, 0n, 1n];
+    let truthy = 0;
+    for (let round = 0; round < 100; ++round) {
+        for (const value of values) {
+            if (value) ++truthy;
+        }
+    }
+    expect(truthy).toBe(400);
+});
+
+test("nullish values in a loop", () => {
+    let defaults = 0;
+    for (let i = 0; i < 300; ++i) {
+        const value = i % 3 === 0 ? null : i % 3 === 1 ? undefined : i;
+        defaults += value ?? 1;
+    }
+    expect(defaults).toBe(200 + 3 * ((99 * 100) / 2) + 2 * 100);
+});
+
+test("exceptions thrown from a long-running loop", () => {
+    let caught = 0;
+    for (let i = 0; i < 200; ++i) {
+        try {
+            if (i % 2) throw new Error(`${i}`);
+        } catch (e) {
+            ++caught;
+        } finally {
+            ++caught;
+        }
+    }
+    expect(caught).toBe(300);
+
+    expect(() => {
+        for (let i = 0; ; ++i) {
+            if (i === 1000) throw new TypeError("done");
+        }
+    }).toThrowWithMessage(TypeError, "done");
+});
@@ -0,0 +1,105 @@
+test("own property changes are seen by repeated lookups", () => {
+    const read = o => o.x;
+    const write = (o, v) => {
+        o.x = v;
+    };
+
+    const o = { x: 1 };
+    for (let i = 0; i < 3; ++i) expect(read(o)).toBe(1);
+
+    write(o, 2);
+    expect(read(o)).toBe(2);
+
+    Object.defineProperty(o, "x", { get: () => 3 });
+    expect(read(o)).toBe(3);
+
+    delete o.x;
+    expect(read(o)).toBeUndefined();
+});
+
+test("lookups through the prototype chain", () => {
+    const read = o => o.x;
+
+    const proto = { x: 1 };
+    const o = Object.create(proto);
+    for (let i = 0; i < 3; ++i) expect(read(o)).toBe(1);
+
+    proto.x = 2;
+    expect(read(o)).toBe(2);
+
+    o.x = 3;
+    expect(read(o)).toBe(3);
+
+    delete o.x;
+    expect(read(o)).toBe(2);
+
+    Object.setPrototypeOf(o, { x: 4 });
+    expect(read(o)).toBe(4);
+});
+
+test("objects with many different shapes", () => {
+    const read = o => o.x;
+
+    const objects = [];
+    for (let i = 0; i < 10; ++i) {
+        const o = {};
+        o[`p${i}`] = i;
+        o.x = i;
+        objects.push(o);
+    }
+    for (let round = 0; round < 3; ++round) {
+        for (let i = 0; i < objects.length; ++i) expect(read(objects[i])).toBe(i);
+    }
+});
+
+test("writes to non-writable properties are not cached", () => {
+    const write = (o, v) => {
+        o.x = v;
+    };
+
+    const o = { x: 1 };
+    write(o, 2);
+    Object.defineProperty(o, "x", { writable: false });
+    write(o, 3);
+    expect(o.x).toBe(2);
+
+    const frozen = Object.freeze({ x: 1 });
+    write(frozen, 2);
+    expect(frozen.x).toBe(1);
+});
+
+test("setters in the prototype chain are called", () => {
+    const write = (o, v) => {
+        o.x = v;
+    };
+
+    let value;
+    const proto = {
+        set x(v) {
+            value = v;
+        },
+    };
+    const o = Object.create(proto);
+    write(o, 1);
+    write(o, 2);
+    expect(value).toBe(2);
+    expect(Object.hasOwn(o, "x")).toBeFalse();
+});
+
+test("proxies are always asked", () => {
+    const read = o => o.x;
+
+    let count = 0;
+    const proxy = new Proxy(
+        {},
+        {
+            get() {
+                return ++count;
+            },
+        }
+    );
+    const o = Object.create(proxy);
+    expect(read(o)).toBe(1);
+    expect(read(o)).toBe(2);
+    expect(read(proxy)).toBe(3);
+});
@@ -28,3 +28,17 @@ test("adding strings with dangling surrogates", () => {
     expect("\ud834a" + "\udf06").toBe("\ud834a\udf06");
     expect("\ud834" + "a\udf06").toBe("\ud834a\udf06");
 });
+
+test("length of concatenated strings", () => {
+    expect(("\ud834" + "\udf06").length).toBe(2);
+    expect(("ab" + "\ud834" + "\udf06" + "cd").length).toBe(6);
+    expect(("🙂" + "a" + "🙂").length).toBe(5);
+
+    let string = "";
+    for (let i = 0; i < 1000; ++i) {
+        string += i % 2 ? "a" : "🙂";
+        expect(string.length).toBe(((i + 1) >> 1) + 2 * ((i + 2) >> 1));
+    }
+    expect(string.length).toBe(1500);
+    expect(new String(string).length).toBe(1500);
+});
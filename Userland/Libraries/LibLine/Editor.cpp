@@ -262,6 +262,9 @@ bool Editor::load_history(DeprecatedString const& path)
         auto string = str.substring_view(it == 0 ? it : it + 2);
         m_history.append({ string, time });
     }
+    // The history file keeps growing across sessions, but only the most recent entries are ever kept in memory.
+    if (m_history.size() > m_history_capacity)
+        m_history.remove(0, m_history.size() - m_history_capacity);
     return true;
 }
 
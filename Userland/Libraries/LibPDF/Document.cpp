@@ -6,6 +6,7 @@
 
 #include <LibPDF/CommonNames.h>
 #include <LibPDF/Document.h>
+#include <LibPDF/Fonts/PDFFont.h>
 #include <LibPDF/Parser.h>
 
 namespace PDF {
@@ -63,6 +64,8 @@ Document::Document(NonnullRefPtr<DocumentParser> const& parser)
     m_parser->set_document(this);
 }
 
+Document::~Document() = default;
+
 PDFErrorOr<void> Document::initialize()
 {
     if (m_security_handler)
@@ -85,6 +88,17 @@ PDFErrorOr<Value> Document::get_or_load_value(u32 index)
     return object;
 }
 
+PDFErrorOr<NonnullRefPtr<PDFFont>> Document::get_or_create_font(NonnullRefPtr<DictObject> const& font_dictionary, float font_size)
+{
+    auto& fonts_by_size = m_fonts.ensure(font_dictionary);
+    if (auto font = fonts_by_size.get(font_size); font.has_value())
+        return NonnullRefPtr { *font.value() };
+
+    auto font = TRY(PDFFont::create(this, font_dictionary, font_size));
+    fonts_by_size.set(font_size, font);
+    return font;
+}
+
 u32 Document::get_first_page_index() const
 {
     // FIXME: A PDF can have a different default first page, which
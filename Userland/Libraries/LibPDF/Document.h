@@ -81,6 +81,7 @@ class Document final
     , public Weakable<Document> {
 public:
     static PDFErrorOr<NonnullRefPtr<Document>> create(ReadonlyBytes bytes);
+    ~Document();
 
     // If a security handler is present, it is the caller's responsibility to ensure
     // this document is unencrypted before calling this function. The user does not
@@ -119,6 +120,10 @@ public:
         return cast_to<T>(TRY(resolve(value)));
     }
 
+    // Loading a font means parsing its font program, so fonts are kept around for as long as
+    // the document is, for every size they were used in.
+    PDFErrorOr<NonnullRefPtr<PDFFont>> get_or_create_font(NonnullRefPtr<DictObject> const& font_dictionary, float font_size);
+
 private:
     explicit Document(NonnullRefPtr<DocumentParser> const& parser);
 
@@ -150,6 +155,7 @@ private:
     Vector<u32> m_page_object_indices;
     HashMap<u32, Page> m_pages;
     HashMap<u32, Value> m_values;
+    HashMap<NonnullRefPtr<DictObject>, HashMap<float, NonnullRefPtr<PDFFont>>> m_fonts;
     RefPtr<OutlineDict> m_outline;
     RefPtr<SecurityHandler> m_security_handler;
 };
@@ -14,11 +14,11 @@
 
 namespace PDF {
 
-PDFErrorOr<Vector<Operator>> Parser::parse_operators(Document* document, ReadonlyBytes bytes)
+PDFErrorOr<void> Parser::for_each_operator(Document* document, ReadonlyBytes bytes, OperatorCallback const& callback)
 {
     Parser parser(document, bytes);
     parser.m_disable_encryption = true;
-    return parser.parse_operators();
+    return parser.for_each_operator(callback);
 }
 
 Parser::Parser(Document* document, ReadonlyBytes bytes)
@@ -522,10 +522,12 @@ PDFErrorOr<NonnullRefPtr<StreamObject>> Parser::parse_stream(NonnullRefPtr<DictO
     return stream_object;
 }
 
-PDFErrorOr<Vector<Operator>> Parser::parse_operators()
+PDFErrorOr<void> Parser::for_each_operator(OperatorCallback const& callback)
 {
-    Vector<Operator> operators;
+    // Note: The operators are handed out as soon as they are parsed, so that content streams never have to be
+    //       materialized as a whole, and the same argument storage is reused for all of them.
     Vector<Value> operator_args;
+    operator_args.ensure_capacity(8);
 
     constexpr static auto is_operator_char = [](char ch) {
         return isalpha(ch) || ch == '*' || ch == '\'';
@@ -546,8 +548,8 @@ PDFErrorOr<Vector<Operator>> Parser::parse_operators()
 
             auto operator_string = StringView(m_reader.bytes().slice(operator_start, m_reader.offset() - operator_start));
             auto operator_type = Operator::operator_type_from_symbol(operator_string);
-            operators.append(Operator(operator_type, move(operator_args)));
-            operator_args = Vector<Value>();
+            TRY(callback(operator_type, operator_args));
+            operator_args.clear_with_capacity();
             m_reader.consume_whitespace();
 
             continue;
@@ -556,10 +558,10 @@ PDFErrorOr<Vector<Operator>> Parser::parse_operators()
         // Note: We disallow parsing indirect values here, since
         //       operations like 0 0 0 RG would confuse the parser
         auto v = TRY(parse_value(CanBeIndirectValue::No));
-        operator_args.append(v);
+        operator_args.append(move(v));
     }
 
-    return operators;
+    return {};
 }
 
 Error Parser::error(
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/SourceLocation.h>
 #include <AK/WeakPtr.h>
@@ -27,7 +28,10 @@ class Document;
 
 class Parser {
 public:
-    static PDFErrorOr<Vector<Operator>> parse_operators(Document*, ReadonlyBytes);
+    // Called once per operator in a content stream. The arguments are only valid for the duration of the call.
+    using OperatorCallback = Function<PDFErrorOr<void>(OperatorType, Vector<Value> const& arguments)>;
+
+    static PDFErrorOr<void> for_each_operator(Document*, ReadonlyBytes, OperatorCallback const&);
 
     Parser(ReadonlyBytes);
     Parser(Document*, ReadonlyBytes);
@@ -56,7 +60,7 @@ public:
     PDFErrorOr<NonnullRefPtr<ArrayObject>> parse_array();
     PDFErrorOr<NonnullRefPtr<DictObject>> parse_dict();
     PDFErrorOr<NonnullRefPtr<StreamObject>> parse_stream(NonnullRefPtr<DictObject> dict);
-    PDFErrorOr<Vector<Operator>> parse_operators();
+    PDFErrorOr<void> for_each_operator(OperatorCallback const&);
 
 protected:
     void push_reference(Reference const& ref) { m_current_reference_stack.append(ref); }
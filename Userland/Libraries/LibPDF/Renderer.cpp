@@ -103,34 +103,34 @@ PDFErrorsOr<void> Renderer::render()
         byte_buffer.append(bytes.data(), bytes.size());
     }
 
-    auto operators = TRY(Parser::parse_operators(m_document, byte_buffer));
-
     Errors errors;
-    for (auto& op : operators) {
-        auto maybe_error = handle_operator(op);
-        if (maybe_error.is_error()) {
+    auto maybe_parse_error = Parser::for_each_operator(m_document, byte_buffer, [&](OperatorType type, Vector<Value> const& arguments) -> PDFErrorOr<void> {
+        auto maybe_error = handle_operator(type, arguments);
+        if (maybe_error.is_error())
             errors.add_error(maybe_error.release_error());
-        }
-    }
+        return {};
+    });
+    if (maybe_parse_error.is_error())
+        errors.add_error(maybe_parse_error.release_error());
     if (!errors.errors().is_empty())
         return errors;
     return {};
 }
 
-PDFErrorOr<void> Renderer::handle_operator(Operator const& op, Optional<NonnullRefPtr<DictObject>> extra_resources)
+PDFErrorOr<void> Renderer::handle_operator(OperatorType type, Vector<Value> const& arguments, Optional<NonnullRefPtr<DictObject>> extra_resources)
 {
-    switch (op.type()) {
-#define V(name, snake_name, symbol)                                \
-    case OperatorType::name:                                       \
-        TRY(handle_##snake_name(op.arguments(), extra_resources)); \
+    switch (type) {
+#define V(name, snake_name, symbol)                           \
+    case OperatorType::name:                                  \
+        TRY(handle_##snake_name(arguments, extra_resources)); \
         break;
         ENUMERATE_OPERATORS(V)
 #undef V
     case OperatorType::TextNextLineShowString:
-        TRY(handle_text_next_line_show_string(op.arguments()));
+        TRY(handle_text_next_line_show_string(arguments));
         break;
     case OperatorType::TextNextLineShowStringSetSpacing:
-        TRY(handle_text_next_line_show_string_set_spacing(op.arguments()));
+        TRY(handle_text_next_line_show_string_set_spacing(arguments));
         break;
     }
 
@@ -424,7 +424,7 @@ RENDERER_HANDLER(text_set_font)
 
     auto& text_rendering_matrix = calculate_text_rendering_matrix();
     auto font_size = text_rendering_matrix.x_scale() * text_state().font_size;
-    auto font = TRY(PDFFont::create(m_document, font_dictionary, font_size));
+    auto font = TRY(m_document->get_or_create_font(font_dictionary, font_size));
     text_state().font = font;
 
     m_text_rendering_matrix_is_dirty = true;
@@ -641,9 +641,9 @@ RENDERER_HANDLER(paint_xobject)
         matrix = Vector { Value { 1 }, Value { 0 }, Value { 0 }, Value { 1 }, Value { 0 }, Value { 0 } };
     }
     MUST(handle_concatenate_matrix(matrix));
-    auto operators = TRY(Parser::parse_operators(m_document, xobject->bytes()));
-    for (auto& op : operators)
-        TRY(handle_operator(op, xobject_resources));
+    TRY(Parser::for_each_operator(m_document, xobject->bytes(), [&](OperatorType type, Vector<Value> const& arguments) {
+        return handle_operator(type, arguments, xobject_resources);
+    }));
     MUST(handle_restore_state({}));
     return {};
 }
@@ -103,7 +103,7 @@ private:
 
     PDFErrorsOr<void> render();
 
-    PDFErrorOr<void> handle_operator(Operator const&, Optional<NonnullRefPtr<DictObject>> = {});
+    PDFErrorOr<void> handle_operator(OperatorType, Vector<Value> const& arguments, Optional<NonnullRefPtr<DictObject>> = {});
 #define V(name, snake_name, symbol) \
     PDFErrorOr<void> handle_##snake_name(Vector<Value> const& args, Optional<NonnullRefPtr<DictObject>> = {});
     ENUMERATE_OPERATORS(V)
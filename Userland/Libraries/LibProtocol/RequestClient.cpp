@@ -19,6 +19,11 @@ void RequestClient::ensure_connection(URL const& url, ::RequestServer::CacheLeve
     async_ensure_connection(url, cache_level);
 }
 
+void RequestClient::set_connection_pool_limits(u32 max_connections_per_origin, u32 max_idle_connections)
+{
+    async_set_connection_pool_limits(max_connections_per_origin, max_idle_connections);
+}
+
 template<typename RequestHashMapTraits>
 RefPtr<Request> RequestClient::start_request(DeprecatedString const& method, URL const& url, HashMap<DeprecatedString, DeprecatedString, RequestHashMapTraits> const& request_headers, ReadonlyBytes request_body, Core::ProxyData const& proxy_data)
 {
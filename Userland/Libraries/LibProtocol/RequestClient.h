@@ -25,6 +25,7 @@ public:
     RefPtr<Request> start_request(DeprecatedString const& method, URL const&, HashMap<DeprecatedString, DeprecatedString, RequestHashMapTraits> const& request_headers = {}, ReadonlyBytes request_body = {}, Core::ProxyData const& = {});
 
     void ensure_connection(URL const&, ::RequestServer::CacheLevel);
+    void set_connection_pool_limits(u32 max_connections_per_origin, u32 max_idle_connections);
 
     bool stop_request(Badge<Request>, Request&);
     bool set_certificate(Badge<Request>, Request&, DeprecatedString, DeprecatedString);
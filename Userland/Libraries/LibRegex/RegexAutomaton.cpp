@@ -0,0 +1,691 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/HashTable.h>
+#include <AK/QuickSort.h>
+#include <LibRegex/RegexAutomaton.h>
+
+namespace regex {
+
+struct Automaton::TranslationContext {
+    struct Fixup {
+        enum class Kind {
+            Next,
+            Target,
+            Checkpoint,
+        };
+        u32 node;
+        Kind kind;
+        size_t bytecode_position;
+    };
+
+    size_t start { 0 };
+    size_t end { 0 };
+    TranslationContext* parent { nullptr };
+    HashMap<size_t, u32> nodes {};
+    Vector<Fixup> fixups {};
+};
+
+struct MaskedNode {
+    u32 node;
+    u64 mask;
+
+    bool operator==(MaskedNode const&) const = default;
+};
+
+struct MaskedNodeTraits : public GenericTraits<MaskedNode> {
+    static unsigned hash(MaskedNode const& node) { return pair_int_hash(node.node, u64_hash(node.mask)); }
+};
+
+// All threads at one position in the input, in the order the backtracking VM would try them in.
+struct Automaton::ThreadList {
+    explicit ThreadList(size_t node_count)
+    {
+        added.resize(node_count);
+        visited.resize(node_count);
+    }
+
+    void clear()
+    {
+        for (auto node : touched_nodes) {
+            added[node] = false;
+            visited[node] = false;
+        }
+        touched_nodes.clear_with_capacity();
+        visited_with_mask.clear_with_capacity();
+        threads.clear_with_capacity();
+    }
+
+    struct Frame {
+        Thread thread;
+        u64 mask { 0 };
+    };
+
+    Vector<Thread> threads;
+
+    // Every node is only followed once per position, by the thread that got there first. Since nothing that happens from
+    // there on depends on how the thread got there (apart from which checkpoints are at the current position), any later
+    // thread would just follow the same paths with a lower priority.
+    Vector<bool> added;
+    Vector<bool> visited;
+    HashTable<MaskedNode, MaskedNodeTraits> visited_with_mask;
+    Vector<u32> touched_nodes;
+    Vector<Frame> frames;
+};
+
+RefPtr<Automaton> Automaton::try_create(ByteCode const& bytecode)
+{
+    auto automaton = adopt_ref(*new Automaton);
+
+    TranslationContext context { .start = 0, .end = bytecode.size() };
+    if (!automaton->translate(bytecode, context)) {
+        dbgln_if(REGEX_DEBUG, "Automaton: Bytecode needs backtracking, not creating an automaton");
+        return nullptr;
+    }
+
+    return automaton;
+}
+
+u32 Automaton::append_node(Node node)
+{
+    m_nodes.append(node);
+    return m_nodes.size() - 1;
+}
+
+// Turns the bytecode in [context.start, context.end) into nodes, resolving jumps within that range.
+// NOTE: Repeat ops are unrolled, since the number of repetitions so far is state that nodes can't have. Every copy is
+//       translated in a context of its own, so jumps within a copy stay in that copy.
+bool Automaton::translate(ByteCode const& bytecode, TranslationContext& context)
+{
+    using Fixup = TranslationContext::Fixup;
+
+    auto jump_target = [&](size_t position, size_t size, ssize_t offset) {
+        return static_cast<size_t>(static_cast<ssize_t>(position + size) + offset);
+    };
+
+    MatchState state;
+    for (size_t position = context.start; position < context.end;) {
+        if (m_nodes.size() > c_max_automaton_nodes)
+            return false;
+
+        state.instruction_position = position;
+        auto& opcode = bytecode.get_opcode(state);
+        auto next_position = position + opcode.size();
+        context.nodes.set(position, m_nodes.size());
+
+        auto append_node_followed_by_next = [&](Node node) {
+            auto index = append_node(node);
+            context.fixups.append({ index, Fixup::Kind::Next, next_position });
+            return index;
+        };
+
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare: {
+            auto& compare = to<OpCode_Compare>(opcode);
+            auto offset = position + 3;
+            bool is_string = false;
+            for (size_t i = 0; i < compare.arguments_count(); ++i) {
+                auto compare_type = static_cast<CharacterCompareType>(bytecode.at(offset++));
+                switch (compare_type) {
+                case CharacterCompareType::Inverse:
+                case CharacterCompareType::TemporaryInverse:
+                case CharacterCompareType::AnyChar:
+                case CharacterCompareType::And:
+                case CharacterCompareType::Or:
+                case CharacterCompareType::EndAndOr:
+                    break;
+                case CharacterCompareType::Char:
+                case CharacterCompareType::CharClass:
+                case CharacterCompareType::CharRange:
+                case CharacterCompareType::Property:
+                case CharacterCompareType::GeneralCategory:
+                case CharacterCompareType::Script:
+                case CharacterCompareType::ScriptExtension:
+                    ++offset;
+                    break;
+                case CharacterCompareType::LookupTable:
+                    offset += bytecode.at(offset) + 1;
+                    break;
+                case CharacterCompareType::String: {
+                    // NOTE: Everything else consumes exactly one character, but strings have to be split up so that all threads
+                    //       keep moving through the input in lockstep.
+                    auto length = bytecode.at(offset);
+                    if (compare.arguments_count() != 1 || length == 0)
+                        return false;
+                    is_string = true;
+                    m_has_strings = true;
+                    append_node({ .type = Node::Type::String, .next = static_cast<u32>(m_nodes.size() + 1), .value = static_cast<u32>(bytecode.at(offset + 1)), .bytecode_position = position });
+                    for (size_t j = 1; j < length; ++j)
+                        append_node({ .type = Node::Type::StringCharacter, .next = static_cast<u32>(m_nodes.size() + 1), .value = static_cast<u32>(bytecode.at(offset + 1 + j)) });
+                    m_nodes.last().next = 0;
+                    context.fixups.append({ static_cast<u32>(m_nodes.size() - 1), Fixup::Kind::Next, next_position });
+                    offset += length + 1;
+                    break;
+                }
+                case CharacterCompareType::Reference:
+                case CharacterCompareType::Undefined:
+                case CharacterCompareType::RangeExpressionDummy:
+                    return false;
+                }
+            }
+            if (!is_string)
+                append_node_followed_by_next({ .type = Node::Type::Compare, .bytecode_position = position });
+            break;
+        }
+        case OpCodeId::Jump: {
+            auto index = append_node({ .type = Node::Type::Jump });
+            context.fixups.append({ index, Fixup::Kind::Target, jump_target(position, opcode.size(), to<OpCode_Jump>(opcode).offset()) });
+            break;
+        }
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkReplaceJump:
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceStay: {
+            // NOTE: ForkReplace* only differ from regular forks in which saved state they leave behind for backtracking,
+            //       and the optimizer only emits them when backtracking into them can't change the result.
+            auto prefers_target = opcode.opcode_id() == OpCodeId::ForkJump || opcode.opcode_id() == OpCodeId::ForkReplaceJump;
+            auto offset = prefers_target ? static_cast<OpCode_ForkJump const&>(opcode).offset() : static_cast<OpCode_ForkStay const&>(opcode).offset();
+            auto index = append_node_followed_by_next({ .type = Node::Type::Fork, .prefer_target = prefers_target, .is_fork = true });
+            context.fixups.append({ index, Fixup::Kind::Target, jump_target(position, opcode.size(), offset) });
+            break;
+        }
+        case OpCodeId::JumpNonEmpty: {
+            auto& jump = to<OpCode_JumpNonEmpty>(opcode);
+            Node node { .type = Node::Type::JumpNonEmpty };
+            switch (jump.form()) {
+            case OpCodeId::Jump:
+                break;
+            case OpCodeId::ForkJump:
+            case OpCodeId::ForkReplaceJump:
+                node.is_fork = true;
+                node.prefer_target = true;
+                break;
+            case OpCodeId::ForkStay:
+            case OpCodeId::ForkReplaceStay:
+                node.is_fork = true;
+                break;
+            default:
+                return false;
+            }
+            auto index = append_node_followed_by_next(node);
+            context.fixups.append({ index, Fixup::Kind::Target, jump_target(position, opcode.size(), jump.offset()) });
+            context.fixups.append({ index, Fixup::Kind::Checkpoint, jump_target(position, opcode.size(), jump.checkpoint()) });
+            break;
+        }
+        case OpCodeId::Checkpoint:
+            if (m_checkpoint_count == 64)
+                return false;
+            append_node_followed_by_next({ .type = Node::Type::Checkpoint, .value = static_cast<u32>(m_checkpoint_count++) });
+            break;
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup: {
+            size_t id;
+            Node::Type type;
+            if (opcode.opcode_id() == OpCodeId::SaveLeftCaptureGroup) {
+                id = to<OpCode_SaveLeftCaptureGroup>(opcode).id();
+                type = Node::Type::SaveLeftCaptureGroup;
+            } else if (opcode.opcode_id() == OpCodeId::SaveRightCaptureGroup) {
+                id = to<OpCode_SaveRightCaptureGroup>(opcode).id();
+                type = Node::Type::SaveRightCaptureGroup;
+            } else if (opcode.opcode_id() == OpCodeId::SaveRightNamedCaptureGroup) {
+                id = to<OpCode_SaveRightNamedCaptureGroup>(opcode).id();
+                type = Node::Type::SaveRightCaptureGroup;
+            } else {
+                id = to<OpCode_ClearCaptureGroup>(opcode).id();
+                type = Node::Type::ClearCaptureGroup;
+            }
+            if (id >= m_capture_group_names.size())
+                m_capture_group_names.resize(id + 1);
+            if (opcode.opcode_id() == OpCodeId::SaveRightNamedCaptureGroup)
+                m_capture_group_names[id] = to<OpCode_SaveRightNamedCaptureGroup>(opcode).name();
+            append_node_followed_by_next({ .type = type, .value = static_cast<u32>(id) });
+            break;
+        }
+        case OpCodeId::CheckBegin:
+        case OpCodeId::CheckEnd:
+        case OpCodeId::CheckBoundary: {
+            AssertionKind kind;
+            if (opcode.opcode_id() == OpCodeId::CheckBegin)
+                kind = AssertionKind::Begin;
+            else if (opcode.opcode_id() == OpCodeId::CheckEnd)
+                kind = AssertionKind::End;
+            else if (to<OpCode_CheckBoundary>(opcode).type() == BoundaryCheckType::Word)
+                kind = AssertionKind::WordBoundary;
+            else
+                kind = AssertionKind::NonWordBoundary;
+            // NOTE: Assertions of the same kind always give the same answer at the same position, so one of them is enough to ask.
+            if (!m_assertion_positions[to_underlying(kind)].has_value())
+                m_assertion_positions[to_underlying(kind)] = position;
+            append_node_followed_by_next({ .type = Node::Type::Assertion, .value = to_underlying(kind) });
+            break;
+        }
+        case OpCodeId::Repeat: {
+            auto& repeat = to<OpCode_Repeat>(opcode);
+            if (repeat.offset() > position - context.start)
+                return false;
+            // NOTE: The repeated expression was already translated once on the way here, so this is where the next copy starts.
+            for (size_t i = 1; i < repeat.count(); ++i) {
+                if (m_nodes.size() > c_max_automaton_nodes)
+                    return false;
+                TranslationContext copy { .start = position - repeat.offset(), .end = position, .parent = &context };
+                if (!translate(bytecode, copy))
+                    return false;
+            }
+            break;
+        }
+        case OpCodeId::ResetRepeat:
+            break;
+        case OpCodeId::Exit:
+            // NOTE: Exit only succeeds past the end of the bytecode, which is where the Match node goes.
+            append_node({ .type = Node::Type::Fail });
+            break;
+        case OpCodeId::FailForks:
+        case OpCodeId::Save:
+        case OpCodeId::Restore:
+        case OpCodeId::GoBack:
+            return false;
+        }
+
+        position = next_position;
+    }
+
+    if (!context.parent)
+        context.nodes.set(context.end, append_node({ .type = Node::Type::Match }));
+    else
+        context.nodes.set(context.end, m_nodes.size());
+
+    for (auto& fixup : context.fixups) {
+        if (fixup.bytecode_position < context.start || fixup.bytecode_position > context.end) {
+            if (!context.parent)
+                return false;
+            context.parent->fixups.append(fixup);
+            continue;
+        }
+
+        auto node = context.nodes.get(fixup.bytecode_position);
+        if (!node.has_value())
+            return false;
+
+        switch (fixup.kind) {
+        case TranslationContext::Fixup::Kind::Next:
+            m_nodes[fixup.node].next = *node;
+            break;
+        case TranslationContext::Fixup::Kind::Target:
+            m_nodes[fixup.node].target = *node;
+            break;
+        case TranslationContext::Fixup::Kind::Checkpoint:
+            if (*node >= m_nodes.size() || m_nodes[*node].type != Node::Type::Checkpoint)
+                return false;
+            m_nodes[fixup.node].value = m_nodes[*node].value;
+            break;
+        }
+    }
+
+    return true;
+}
+
+u8 Automaton::assertion_context(ByteCode const& bytecode, MatchInput const& input, MatchState& scratch, size_t position, size_t code_unit_position) const
+{
+    u8 context = 0;
+    for (size_t kind = 0; kind < assertion_kind_count; ++kind) {
+        if (!m_assertion_positions[kind].has_value())
+            continue;
+        scratch.string_position = position;
+        scratch.string_position_in_code_units = code_unit_position;
+        scratch.instruction_position = *m_assertion_positions[kind];
+        if (bytecode.get_opcode(scratch).execute(input, scratch) == ExecutionResult::Continue)
+            context |= 1 << kind;
+    }
+    return context;
+}
+
+bool Automaton::consumes(ByteCode const& bytecode, Node const& node, MatchInput const& input, MatchState& scratch, size_t position, size_t code_unit_position) const
+{
+    if (position >= input.view.length())
+        return false;
+
+    if (node.type == Node::Type::StringCharacter)
+        return true;
+
+    scratch.string_position = position;
+    scratch.string_position_in_code_units = code_unit_position;
+    scratch.instruction_position = node.bytecode_position;
+    return bytecode.get_opcode(scratch).execute(input, scratch) == ExecutionResult::Continue;
+}
+
+// Follows the thread through everything that doesn't consume input, adding a thread to `list` for every node that does.
+void Automaton::add_thread(ThreadList& list, Thread thread, size_t position, u8 assertion_context, bool track_captures, size_t& operations) const
+{
+    list.frames.append({ move(thread), 0 });
+
+    while (!list.frames.is_empty()) {
+        auto frame = list.frames.take_last();
+        auto& thread = frame.thread;
+
+        for (;;) {
+            auto node_index = thread.node;
+            auto const& node = m_nodes[node_index];
+            ++operations;
+
+            if (node.consumes() || node.type == Node::Type::Match) {
+                if (!list.added[node_index]) {
+                    list.added[node_index] = true;
+                    list.touched_nodes.append(node_index);
+                    list.threads.append(move(thread));
+                }
+                break;
+            }
+
+            if (frame.mask == 0) {
+                if (list.visited[node_index])
+                    break;
+                list.visited[node_index] = true;
+                list.touched_nodes.append(node_index);
+            } else if (list.visited_with_mask.set({ node_index, frame.mask }) != HashSetResult::InsertedNewEntry) {
+                break;
+            }
+
+            auto fork_to = [&](u32 primary, u32 secondary) {
+                list.frames.append({ thread, frame.mask });
+                list.frames.last().thread.node = secondary;
+                thread.node = primary;
+            };
+
+            bool failed = false;
+            switch (node.type) {
+            case Node::Type::Jump:
+                thread.node = node.target;
+                break;
+            case Node::Type::Fork:
+                if (node.prefer_target)
+                    fork_to(node.target, node.next);
+                else
+                    fork_to(node.next, node.target);
+                break;
+            case Node::Type::JumpNonEmpty:
+                if (frame.mask & (1ull << node.value))
+                    thread.node = node.next;
+                else if (!node.is_fork)
+                    thread.node = node.target;
+                else if (node.prefer_target)
+                    fork_to(node.target, node.next);
+                else
+                    fork_to(node.next, node.target);
+                break;
+            case Node::Type::Checkpoint:
+                frame.mask |= 1ull << node.value;
+                thread.node = node.next;
+                break;
+            case Node::Type::SaveLeftCaptureGroup:
+                if (track_captures)
+                    thread.captures[node.value].left_column = position;
+                thread.node = node.next;
+                break;
+            case Node::Type::SaveRightCaptureGroup:
+                if (track_captures) {
+                    auto& capture = thread.captures[node.value];
+                    if (position < capture.left_column) {
+                        failed = true;
+                        break;
+                    }
+                    if (!capture.has_match || capture.left_column >= capture.start) {
+                        capture.has_match = true;
+                        capture.start = capture.left_column;
+                        capture.end = position;
+                    }
+                }
+                thread.node = node.next;
+                break;
+            case Node::Type::ClearCaptureGroup:
+                if (track_captures)
+                    thread.captures[node.value] = {};
+                thread.node = node.next;
+                break;
+            case Node::Type::Assertion:
+                failed = !(assertion_context & (1 << node.value));
+                thread.node = node.next;
+                break;
+            case Node::Type::Fail:
+                failed = true;
+                break;
+            case Node::Type::Compare:
+            case Node::Type::String:
+            case Node::Type::StringCharacter:
+            case Node::Type::Match:
+                VERIFY_NOT_REACHED();
+            }
+
+            if (failed)
+                break;
+        }
+    }
+}
+
+// NOTE: The DFA only looks at one character at a time (plus which assertions hold), so it can't be used for inputs where
+//       what a Compare op sees at a position depends on more than that.
+bool Automaton::can_use_dfa(MatchInput const& input) const
+{
+    if (input.view.unicode())
+        return false;
+    if (m_has_strings && !input.view.is_string_view())
+        return false;
+    return true;
+}
+
+void Automaton::reset_dfa(FlagsUnderlyingType options) const
+{
+    m_dfa_states.clear();
+    m_dfa_state_indices.clear();
+    for (auto& start_state : m_dfa_start_states)
+        start_state.clear();
+    m_dfa_options = options;
+}
+
+u32 Automaton::dfa_state_for(ThreadList const& list) const
+{
+    Vector<u32> nodes;
+    nodes.ensure_capacity(list.threads.size());
+    bool has_match = false;
+    for (auto const& thread : list.threads) {
+        // NOTE: A state that has a match doesn't need to go anywhere, see dfa_has_match(), so all of them are the same.
+        if (m_nodes[thread.node].type == Node::Type::Match) {
+            has_match = true;
+            nodes.clear_with_capacity();
+            nodes.append(thread.node);
+            break;
+        }
+        nodes.unchecked_append(thread.node);
+    }
+    quick_sort(nodes);
+
+    if (auto index = m_dfa_state_indices.get(nodes); index.has_value())
+        return *index;
+
+    if (m_dfa_states.size() == c_max_automaton_dfa_states)
+        reset_dfa(*m_dfa_options);
+
+    auto index = static_cast<u32>(m_dfa_states.size());
+    m_dfa_states.append(make<DFAState>(DFAState { .nodes = nodes, .has_match = has_match, .transitions = {} }));
+    m_dfa_state_indices.set(move(nodes), index);
+    return index;
+}
+
+// Finds out whether there's a match starting anywhere at or after `start_position`, by running all the threads without
+// capture groups, and without caring about their order. Each distinct set of threads becomes a DFA state, and the
+// transitions between them are remembered for next time, up to c_max_automaton_dfa_states states.
+bool Automaton::dfa_has_match(ByteCode const& bytecode, MatchInput const& input, MatchState& scratch, size_t start_position, size_t& operations) const
+{
+    auto options = static_cast<FlagsUnderlyingType>(input.regex_options.value());
+    if (m_dfa_options != options)
+        reset_dfa(options);
+
+    auto const& view = input.view;
+    auto length = view.length();
+    ThreadList list { m_nodes.size() };
+
+    auto position = start_position;
+    auto context = assertion_context(bytecode, input, scratch, position, position);
+    auto& start_state = m_dfa_start_states[context];
+    if (!start_state.has_value()) {
+        add_thread(list, { .node = 0, .start = position, .captures = {} }, position, context, false, operations);
+        auto state = dfa_state_for(list);
+        m_dfa_start_states[context] = state;
+    }
+    auto state = *m_dfa_start_states[context];
+
+    for (; !m_dfa_states[state]->has_match; ++position) {
+        if (position == length)
+            return false;
+
+        auto next_context = assertion_context(bytecode, input, scratch, position + 1, position + 1);
+        u64 first_character = view.substring_view(position, 1)[0];
+        u64 character = view[position];
+        // NOTE: Give up on characters that don't fit in the key, whoever ends up matching will figure it out.
+        if (first_character >= (1u << 21) || character >= (1u << 21))
+            return true;
+        auto key = first_character | (character << 21) | (static_cast<u64>(next_context) << 42);
+
+        if (auto next_state = m_dfa_states[state]->transitions.get(key); next_state.has_value()) {
+            state = *next_state;
+            continue;
+        }
+
+        list.clear();
+        for (auto node_index : m_dfa_states[state]->nodes) {
+            auto const& node = m_nodes[node_index];
+            bool matches;
+            if (node.type == Node::Type::Compare) {
+                matches = consumes(bytecode, node, input, scratch, position, position);
+            } else {
+                auto input_character = static_cast<u8>(character);
+                auto string_character = static_cast<u8>(node.value);
+                if (input.regex_options & AllFlags::Insensitive)
+                    matches = to_ascii_lowercase(input_character) == to_ascii_lowercase(string_character);
+                else
+                    matches = input_character == string_character;
+            }
+            if (matches)
+                add_thread(list, { .node = node.next, .start = position, .captures = {} }, position + 1, next_context, false, operations);
+        }
+        add_thread(list, { .node = 0, .start = position + 1, .captures = {} }, position + 1, next_context, false, operations);
+
+        auto states_before = m_dfa_states.size();
+        auto next_state = dfa_state_for(list);
+        if (m_dfa_states.size() >= states_before)
+            m_dfa_states[state]->transitions.set(key, next_state);
+        state = next_state;
+    }
+
+    return true;
+}
+
+Optional<size_t> Automaton::match(ByteCode const& bytecode, MatchInput const& input, MatchState& state, size_t last_start_position, size_t& operations) const
+{
+    auto const& view = input.view;
+    auto length = view.length();
+    auto position = state.string_position;
+    auto code_unit_position = state.string_position_in_code_units;
+    MatchState scratch;
+
+    if (last_start_position > position && can_use_dfa(input) && !dfa_has_match(bytecode, input, scratch, position, operations))
+        return {};
+
+    bool track_captures = !m_capture_group_names.is_empty() && !input.regex_options.has_flag_set(AllFlags::SkipSubExprResults);
+    Captures initial_captures;
+    if (track_captures)
+        initial_captures.resize(m_capture_group_names.size());
+
+    ThreadList current { m_nodes.size() };
+    ThreadList next { m_nodes.size() };
+    Optional<Thread> match;
+    size_t match_end = 0;
+    size_t match_end_in_code_units = 0;
+
+    auto context = assertion_context(bytecode, input, scratch, position, code_unit_position);
+    add_thread(current, { .node = 0, .start = position, .captures = initial_captures }, position, context, track_captures, operations);
+
+    for (;;) {
+        auto next_position = position + 1;
+        auto next_code_unit_position = code_unit_position + 1;
+        if (view.unicode() && code_unit_position < view.length_in_code_units())
+            next_code_unit_position = code_unit_position + view.length_of_code_point(view[code_unit_position]);
+        auto next_context = position < length ? assertion_context(bytecode, input, scratch, next_position, next_code_unit_position) : 0;
+
+        for (auto& thread : current.threads) {
+            auto const& node = m_nodes[thread.node];
+            if (node.type == Node::Type::Match) {
+                // NOTE: Everything after this would only have been tried if this had failed, so this is it, unless one of
+                //       the threads before it gets to a match later.
+                match = move(thread);
+                match_end = position;
+                match_end_in_code_units = code_unit_position;
+                break;
+            }
+            if (consumes(bytecode, node, input, scratch, position, code_unit_position)) {
+                thread.node = node.next;
+                add_thread(next, move(thread), next_position, next_context, track_captures, operations);
+            }
+        }
+
+        if (position >= length)
+            break;
+
+        if (!match.has_value() && next_position <= last_start_position)
+            add_thread(next, { .node = 0, .start = next_position, .captures = initial_captures }, next_position, next_context, track_captures, operations);
+
+        if (next.threads.is_empty() && (match.has_value() || next_position > last_start_position))
+            break;
+
+        swap(current, next);
+        next.clear();
+        position = next_position;
+        code_unit_position = next_code_unit_position;
+    }
+
+    if (!match.has_value())
+        return {};
+
+    state.string_position = match_end;
+    state.string_position_in_code_units = match_end_in_code_units;
+
+    if (track_captures) {
+        while (state.capture_group_matches.size() <= input.match_index)
+            state.capture_group_matches.empend();
+
+        Vector<Match> groups;
+        groups.resize(match->captures.size());
+        for (size_t id = 0; id < match->captures.size(); ++id) {
+            auto const& capture = match->captures[id];
+            if (!capture.has_match) {
+                groups[id].left_column = capture.left_column;
+                continue;
+            }
+
+            auto subject = view.substring_view(capture.start, capture.end - capture.start);
+            auto const& name = m_capture_group_names[id];
+            if (name.is_null()) {
+                if (input.regex_options & AllFlags::StringCopyMatches)
+                    groups[id] = { subject.to_deprecated_string(), input.line, capture.start, input.global_offset + capture.start };
+                else
+                    groups[id] = { subject, input.line, capture.start, input.global_offset + capture.start };
+            } else {
+                if (input.regex_options & AllFlags::StringCopyMatches)
+                    groups[id] = { subject.to_deprecated_string(), name, input.line, capture.start, input.global_offset + capture.start };
+                else
+                    groups[id] = { subject, name, input.line, capture.start, input.global_offset + capture.start };
+            }
+            groups[id].left_column = capture.left_column;
+        }
+        state.capture_group_matches.at(input.match_index) = move(groups);
+    }
+
+    return match->start;
+}
+
+}
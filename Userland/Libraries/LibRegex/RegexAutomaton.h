@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "RegexByteCode.h"
+#include "RegexMatch.h"
+
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/OwnPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <AK/Vector.h>
+
+namespace regex {
+
+static constexpr size_t c_max_automaton_nodes = 4096;
+static constexpr size_t c_max_automaton_dfa_states = 512;
+
+// Matches bytecode that never needs to backtrack by following all of its paths through the input at once
+// (i.e. by simulating it as an NFA), which keeps matching linear in the length of the input.
+// Paths are kept in the order the backtracking VM would try them in, so the match and its capture groups are the same.
+// This only works for bytecode without backreferences or lookarounds, since those depend on more than the current position.
+// NOTE: match() builds a DFA of the states it visits as it goes, so an Automaton must not be used from more than one thread
+//       at a time. Regexes only share one with other Regexes on the same thread (see CompiledPatternCache).
+class Automaton : public RefCounted<Automaton> {
+public:
+    static RefPtr<Automaton> try_create(ByteCode const&);
+
+    // Looks for a match starting at state.string_position, or any later position up to and including `last_start_position`,
+    // and leaves `state` the way the backtracking VM would have on success. Returns the position the match starts at.
+    Optional<size_t> match(ByteCode const&, MatchInput const&, MatchState&, size_t last_start_position, size_t& operations) const;
+
+private:
+    struct Node {
+        enum class Type : u8 {
+            Compare,         // Consumes a character if the Compare op it was made from matches it.
+            String,          // Consumes the first character of a string if the Compare op it was made from matches the whole string.
+            StringCharacter, // Consumes one of the remaining characters of a string, `value` holds the character.
+            Jump,
+            Fork,
+            JumpNonEmpty, // Jumps or forks to the target unless nothing was consumed since the checkpoint `value`.
+            Checkpoint,
+            SaveLeftCaptureGroup,
+            SaveRightCaptureGroup,
+            ClearCaptureGroup,
+            Assertion,
+            Match,
+            Fail,
+        };
+
+        bool consumes() const { return type == Type::Compare || type == Type::String || type == Type::StringCharacter; }
+
+        Type type;
+        bool prefer_target { false };
+        bool is_fork { false };
+        u32 next { 0 };
+        u32 target { 0 };
+        u32 value { 0 };
+        size_t bytecode_position { 0 };
+    };
+
+    enum class AssertionKind : u8 {
+        Begin,
+        End,
+        WordBoundary,
+        NonWordBoundary,
+    };
+    static constexpr size_t assertion_kind_count = 4;
+
+    struct Capture {
+        size_t left_column { 0 };
+        size_t start { 0 };
+        size_t end { 0 };
+        bool has_match { false };
+    };
+    using Captures = Vector<Capture, 4>;
+
+    struct Thread {
+        u32 node { 0 };
+        size_t start { 0 };
+        Captures captures;
+    };
+
+    struct ThreadList;
+    struct DFAState {
+        Vector<u32> nodes;
+        bool has_match { false };
+        HashMap<u64, u32> transitions;
+    };
+
+    struct NodeSetTraits : public GenericTraits<Vector<u32>> {
+        static unsigned hash(Vector<u32> const& nodes)
+        {
+            unsigned hash = 0;
+            for (auto node : nodes)
+                hash = pair_int_hash(hash, node);
+            return hash;
+        }
+    };
+
+    struct TranslationContext;
+
+    Automaton() = default;
+
+    bool translate(ByteCode const&, TranslationContext&);
+    u32 append_node(Node);
+
+    u8 assertion_context(ByteCode const&, MatchInput const&, MatchState& scratch, size_t position, size_t code_unit_position) const;
+    bool consumes(ByteCode const&, Node const&, MatchInput const&, MatchState& scratch, size_t position, size_t code_unit_position) const;
+    void add_thread(ThreadList&, Thread, size_t position, u8 assertion_context, bool track_captures, size_t& operations) const;
+
+    bool can_use_dfa(MatchInput const&) const;
+    bool dfa_has_match(ByteCode const&, MatchInput const&, MatchState& scratch, size_t start_position, size_t& operations) const;
+    u32 dfa_state_for(ThreadList const&) const;
+    void reset_dfa(FlagsUnderlyingType) const;
+
+    Vector<Node> m_nodes;
+    Vector<StringView> m_capture_group_names;
+    Optional<size_t> m_assertion_positions[assertion_kind_count];
+    size_t m_checkpoint_count { 0 };
+    bool m_has_strings { false };
+
+    mutable Vector<NonnullOwnPtr<DFAState>> m_dfa_states;
+    mutable HashMap<Vector<u32>, u32, NodeSetTraits> m_dfa_state_indices;
+    mutable Optional<u32> m_dfa_start_states[1 << assertion_kind_count];
+    mutable Optional<FlagsUnderlyingType> m_dfa_options;
+};
+
+}
@@ -7,6 +7,8 @@
 #include <AK/BumpAllocator.h>
 #include <AK/Debug.h>
 #include <AK/DeprecatedString.h>
+#include <AK/HashMap.h>
+#include <AK/MemMem.h>
 #include <AK/StringBuilder.h>
 #include <LibRegex/RegexMatcher.h>
 #include <LibRegex/RegexParser.h>
@@ -21,6 +23,63 @@ namespace regex {
 static RegexDebug s_regex_dbg(stderr);
 #endif
 
+// Returns the first position at or after `start` that a match could start at, going by what the optimizer found out
+// about the pattern. This only works on non-Unicode input, where positions are the same as code units.
+static Optional<size_t> find_possible_match_start(regex::Parser::Result::OptimizationData const& data, RegexStringView const& view, size_t start)
+{
+    auto length = view.length_in_code_units();
+    if (start >= length)
+        return start;
+
+    if (view.is_string_view()) {
+        auto string = view.string_view();
+        if (!data.literal_prefix.is_empty()) {
+            Array<u8, 32> needle;
+            auto needle_length = min(data.literal_prefix.size(), needle.size());
+            for (size_t i = 0; i < needle_length; ++i) {
+                if (data.literal_prefix[i] > 0xff)
+                    return start;
+                needle[i] = static_cast<u8>(data.literal_prefix[i]);
+            }
+            auto offset = AK::memmem_optional(string.characters_without_null_termination() + start, length - start, needle.data(), needle_length);
+            if (!offset.has_value())
+                return {};
+            return start + *offset;
+        }
+
+        for (auto position = start; position < length; ++position) {
+            if (data.starting_bytes[static_cast<u8>(string[position])])
+                return position;
+        }
+        return {};
+    }
+
+    // NOTE: Compare ops don't all agree on what the character at a surrogate is, so those are always worth a try.
+    auto const& utf16_view = view.u16_view();
+    if (!data.literal_prefix.is_empty()) {
+        auto first = data.literal_prefix.first();
+        if (first > 0xffff || is_unicode_surrogate(first))
+            return start;
+        for (auto position = start; position < length; ++position) {
+            auto code_unit = utf16_view.code_unit_at(position);
+            if (code_unit == first || is_unicode_surrogate(code_unit))
+                return position;
+        }
+        return {};
+    }
+
+    for (auto position = start; position < length; ++position) {
+        u32 code_unit = utf16_view.code_unit_at(position);
+        if (is_unicode_surrogate(code_unit))
+            return position;
+        for (auto const& range : data.starting_ranges) {
+            if (code_unit >= range.from && code_unit <= range.to)
+                return position;
+        }
+    }
+    return {};
+}
+
 template<class Parser>
 regex::Parser::Result Regex<Parser>::parse_pattern(StringView pattern, typename ParserTraits<Parser>::OptionsType regex_options)
 {
@@ -30,28 +89,106 @@ regex::Parser::Result Regex<Parser>::parse_pattern(StringView pattern, typename
     return parser.parse();
 }
 
+static constexpr size_t c_compiled_pattern_cache_size = 64;
+
+struct CompiledPatternKey {
+    DeprecatedString pattern;
+    FlagsUnderlyingType options;
+
+    bool operator==(CompiledPatternKey const&) const = default;
+};
+
+struct CompiledPatternKeyTraits : public GenericTraits<CompiledPatternKey> {
+    static unsigned hash(CompiledPatternKey const& key) { return pair_int_hash(key.pattern.hash(), key.options); }
+};
+
+struct CompiledPattern {
+    regex::Parser::Result parser_result;
+    RefPtr<Automaton const> automaton;
+    u64 last_use { 0 };
+};
+
+// The optimized bytecode (and automaton) of the patterns that were compiled most recently, so that creating the same
+// Regex again doesn't have to parse and optimize it all over again.
+// NOTE: This is per thread, since the automaton's DFA cache isn't safe to share between threads.
+class CompiledPatternCache {
+public:
+    template<class Parser>
+    static CompiledPatternCache& the()
+    {
+        static thread_local CompiledPatternCache s_cache;
+        return s_cache;
+    }
+
+    CompiledPattern const* find(CompiledPatternKey const& key)
+    {
+        auto it = m_patterns.find(key);
+        if (it == m_patterns.end())
+            return nullptr;
+        it->value.last_use = ++m_use_counter;
+        return &it->value;
+    }
+
+    void add(CompiledPatternKey key, regex::Parser::Result const& parser_result, RefPtr<Automaton const> automaton)
+    {
+        if (m_patterns.size() >= c_compiled_pattern_cache_size) {
+            auto least_recently_used = m_patterns.begin();
+            for (auto it = m_patterns.begin(); it != m_patterns.end(); ++it) {
+                if (it->value.last_use < least_recently_used->value.last_use)
+                    least_recently_used = it;
+            }
+            m_patterns.remove(least_recently_used);
+        }
+        m_patterns.set(move(key), { parser_result, move(automaton), ++m_use_counter });
+    }
+
+private:
+    HashMap<CompiledPatternKey, CompiledPattern, CompiledPatternKeyTraits> m_patterns;
+    u64 m_use_counter { 0 };
+};
+
 template<class Parser>
 Regex<Parser>::Regex(DeprecatedString pattern, typename ParserTraits<Parser>::OptionsType regex_options)
     : pattern_value(move(pattern))
 {
+    auto& cache = CompiledPatternCache::the<Parser>();
+    CompiledPatternKey key { pattern_value, static_cast<FlagsUnderlyingType>(regex_options.value()) };
+    if (auto const* compiled = cache.find(key)) {
+        parser_result = regex::Parser::Result { compiled->parser_result };
+        matcher = make<Matcher<Parser>>(this, static_cast<decltype(regex_options.value())>(parser_result.options.value()), compiled->automaton);
+        return;
+    }
+
     regex::Lexer lexer(pattern_value);
 
     Parser parser(lexer, regex_options);
     parser_result = parser.parse();
 
     run_optimization_passes();
-    if (parser_result.error == regex::Error::NoError)
+    if (parser_result.error == regex::Error::NoError) {
         matcher = make<Matcher<Parser>>(this, static_cast<decltype(regex_options.value())>(parser_result.options.value()));
+        cache.add(move(key), parser_result, matcher->automaton());
+    }
 }
 
 template<class Parser>
 Regex<Parser>::Regex(regex::Parser::Result parse_result, DeprecatedString pattern, typename ParserTraits<Parser>::OptionsType regex_options)
     : pattern_value(move(pattern))
-    , parser_result(move(parse_result))
 {
+    auto& cache = CompiledPatternCache::the<Parser>();
+    CompiledPatternKey key { pattern_value, static_cast<FlagsUnderlyingType>(regex_options.value()) };
+    if (auto const* compiled = cache.find(key)) {
+        parser_result = regex::Parser::Result { compiled->parser_result };
+        matcher = make<Matcher<Parser>>(this, regex_options | static_cast<decltype(regex_options.value())>(parser_result.options.value()), compiled->automaton);
+        return;
+    }
+
+    parser_result = move(parse_result);
     run_optimization_passes();
-    if (parser_result.error == regex::Error::NoError)
-        matcher = make<Matcher<Parser>>(this, regex_options | static_cast<decltype(regex_options.value())>(parse_result.options.value()));
+    if (parser_result.error == regex::Error::NoError) {
+        matcher = make<Matcher<Parser>>(this, regex_options | static_cast<decltype(regex_options.value())>(parser_result.options.value()));
+        cache.add(move(key), parser_result, matcher->automaton());
+    }
 }
 
 template<class Parser>
@@ -185,6 +322,12 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
 
     auto single_match_only = input.regex_options.has_flag_set(AllFlags::SingleMatch);
 
+    auto const& optimization_data = m_pattern->parser_result.optimization_data;
+    bool can_skip_to_possible_match_start = continue_search
+        && !unicode
+        && !input.regex_options.has_flag_set(AllFlags::Insensitive)
+        && (!optimization_data.literal_prefix.is_empty() || !optimization_data.starting_ranges.is_empty());
+
     for (auto const& view : views) {
         if (lines_to_skip != 0) {
             ++input.line;
@@ -245,6 +388,17 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             if (match_length_minimum && match_length_minimum > view_length - view_index)
                 break;
 
+            if (can_skip_to_possible_match_start && (view.is_string_view() || view.is_u16_view())) {
+                auto possible_start = find_possible_match_start(optimization_data, view, view_index);
+                if (!possible_start.has_value())
+                    break;
+                if (*possible_start != view_index) {
+                    view_index = *possible_start;
+                    if (match_length_minimum && match_length_minimum > view_length - view_index)
+                        break;
+                }
+            }
+
             input.column = match_count;
             input.match_index = match_count;
 
@@ -253,7 +407,25 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             state.instruction_position = 0;
             state.repetition_marks.clear();
 
-            auto success = execute(input, state, operations);
+            bool success;
+            if (m_automaton) {
+                // NOTE: The automaton looks at all the remaining start positions at once, so there's no point in coming
+                //       back here unless it found something.
+                auto last_start_position = view_index;
+                if (continue_search) {
+                    last_start_position = view_length - match_length_minimum;
+                    if (last_start_position == view_length && input.regex_options.has_flag_set(AllFlags::Multiline))
+                        --last_start_position;
+                }
+                auto start_position = m_automaton->match(m_pattern->parser_result.bytecode, input, state, last_start_position, operations);
+                if (!start_position.has_value())
+                    break;
+                view_index = *start_position;
+                success = true;
+            } else {
+                success = execute(input, state, operations);
+            }
+
             if (success) {
                 succeeded = true;
 
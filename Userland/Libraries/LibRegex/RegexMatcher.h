@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "RegexAutomaton.h"
 #include "RegexByteCode.h"
 #include "RegexMatch.h"
 #include "RegexOptions.h"
@@ -56,6 +57,15 @@ public:
     Matcher(Regex<Parser> const* pattern, Optional<typename ParserTraits<Parser>::OptionsType> regex_options = {})
         : m_pattern(pattern)
         , m_regex_options(regex_options.value_or({}))
+        , m_automaton(Automaton::try_create(pattern->parser_result.bytecode))
+    {
+    }
+
+    // NOTE: The automaton has to have been created from the same bytecode as the pattern's.
+    Matcher(Regex<Parser> const* pattern, typename ParserTraits<Parser>::OptionsType regex_options, RefPtr<Automaton const> automaton)
+        : m_pattern(pattern)
+        , m_regex_options(regex_options)
+        , m_automaton(move(automaton))
     {
     }
     ~Matcher() = default;
@@ -73,13 +83,18 @@ public:
         m_pattern = pattern;
     }
 
+    RefPtr<Automaton const> const& automaton() const { return m_automaton; }
+
 private:
     bool execute(MatchInput const& input, MatchState& state, size_t& operations) const;
 
     Regex<Parser> const* m_pattern;
     typename ParserTraits<Parser>::OptionsType const m_regex_options;
+    RefPtr<Automaton const> m_automaton;
 };
 
+// NOTE: Matching updates state that's kept in the Regex and its matcher, so a Regex must not be used from more than one
+//       thread at a time. Give each thread its own Regex instead.
 template<class Parser>
 class Regex final {
 public:
@@ -90,6 +105,8 @@ public:
 
     static regex::Parser::Result parse_pattern(StringView pattern, typename ParserTraits<Parser>::OptionsType regex_options = {});
 
+    // NOTE: Recently compiled patterns are cached (per thread), so creating the same Regex over and over again is cheap.
+    //       This means that `parse_result` has to be the result of parsing `pattern` with `regex_options`.
     explicit Regex(DeprecatedString pattern, typename ParserTraits<Parser>::OptionsType regex_options = {});
     Regex(regex::Parser::Result parse_result, DeprecatedString pattern, typename ParserTraits<Parser>::OptionsType regex_options = {});
     ~Regex() = default;
@@ -232,6 +249,7 @@ public:
 private:
     void run_optimization_passes();
     void attempt_rewrite_loops_as_atomic_groups(BasicBlockList const&);
+    void fill_optimization_data();
 };
 
 // free standing functions for match, search and has_match
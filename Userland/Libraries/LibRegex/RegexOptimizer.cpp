@@ -5,6 +5,7 @@
  */
 
 #include <AK/Debug.h>
+#include <AK/HashTable.h>
 #include <AK/QuickSort.h>
 #include <AK/RedBlackTree.h>
 #include <AK/Stack.h>
@@ -29,6 +30,145 @@ void Regex<Parser>::run_optimization_passes()
     attempt_rewrite_loops_as_atomic_groups(split_basic_blocks(parser_result.bytecode));
 
     parser_result.bytecode.flatten();
+
+    fill_optimization_data();
+}
+
+static constexpr size_t c_max_starting_ranges = 32;
+static constexpr size_t c_max_starting_range_search_depth = 64;
+
+// Adds the ranges that the first character consumed from `instruction_position` on must be in, or returns false if
+// that can't be known (e.g. because something could match without consuming anything, or look at more than a character).
+static bool collect_starting_ranges(ByteCode const& bytecode, size_t instruction_position, Vector<CharRange>& ranges, HashTable<size_t>& visited)
+{
+    MatchState state;
+    for (;;) {
+        if (instruction_position >= bytecode.size())
+            return false;
+        // NOTE: Getting back here without consuming anything can't add anything new.
+        if (visited.set(instruction_position) != HashSetResult::InsertedNewEntry)
+            return true;
+        if (visited.size() > c_max_starting_range_search_depth)
+            return false;
+
+        state.instruction_position = instruction_position;
+        auto& opcode = bytecode.get_opcode(state);
+        auto next_position = instruction_position + opcode.size();
+
+        switch (opcode.opcode_id()) {
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup:
+        case OpCodeId::Checkpoint:
+            instruction_position = next_position;
+            break;
+        case OpCodeId::Jump:
+            instruction_position = next_position + static_cast<OpCode_Jump const&>(opcode).offset();
+            break;
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkReplaceJump:
+            if (!collect_starting_ranges(bytecode, next_position + static_cast<OpCode_ForkJump const&>(opcode).offset(), ranges, visited))
+                return false;
+            instruction_position = next_position;
+            break;
+        case OpCodeId::ForkStay:
+        case OpCodeId::ForkReplaceStay:
+            if (!collect_starting_ranges(bytecode, next_position + static_cast<OpCode_ForkStay const&>(opcode).offset(), ranges, visited))
+                return false;
+            instruction_position = next_position;
+            break;
+        case OpCodeId::Compare: {
+            auto& compare = static_cast<OpCode_Compare const&>(opcode);
+            if (compare.arguments_count() == 0)
+                return false;
+            auto offset = instruction_position + 3;
+            for (size_t i = 0; i < compare.arguments_count(); ++i) {
+                auto compare_type = static_cast<CharacterCompareType>(bytecode.at(offset++));
+                switch (compare_type) {
+                case CharacterCompareType::Char:
+                    ranges.empend(static_cast<u32>(bytecode.at(offset)), static_cast<u32>(bytecode.at(offset)));
+                    ++offset;
+                    break;
+                case CharacterCompareType::CharRange:
+                    ranges.empend(bytecode.at(offset++));
+                    break;
+                case CharacterCompareType::String:
+                    if (bytecode.at(offset) == 0)
+                        return false;
+                    ranges.empend(static_cast<u32>(bytecode.at(offset + 1)), static_cast<u32>(bytecode.at(offset + 1)));
+                    offset += bytecode.at(offset) + 1;
+                    break;
+                case CharacterCompareType::LookupTable: {
+                    auto count = bytecode.at(offset++);
+                    for (size_t j = 0; j < count; ++j)
+                        ranges.empend(bytecode.at(offset++));
+                    break;
+                }
+                default:
+                    return false;
+                }
+            }
+            return ranges.size() <= c_max_starting_ranges;
+        }
+        default:
+            return false;
+        }
+    }
+}
+
+template<typename Parser>
+void Regex<Parser>::fill_optimization_data()
+{
+    auto const& bytecode = parser_result.bytecode;
+    auto& data = parser_result.optimization_data;
+
+    // Follow the bytecode for as long as it can only match one thing, to find a literal prefix, e.g. "foo" in /foo(bar|baz)/.
+    MatchState state;
+    for (bool done = false; !done && state.instruction_position < bytecode.size();) {
+        auto& opcode = bytecode.get_opcode(state);
+        switch (opcode.opcode_id()) {
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup:
+        case OpCodeId::Checkpoint:
+            break;
+        case OpCodeId::Compare: {
+            auto& compare = static_cast<OpCode_Compare const&>(opcode);
+            auto offset = state.instruction_position + 3;
+            auto compare_type = compare.arguments_count() == 1 ? static_cast<CharacterCompareType>(bytecode.at(offset)) : CharacterCompareType::Undefined;
+            if (compare_type == CharacterCompareType::Char) {
+                data.literal_prefix.append(bytecode.at(offset + 1));
+            } else if (compare_type == CharacterCompareType::String) {
+                for (size_t i = 0; i < bytecode.at(offset + 1); ++i)
+                    data.literal_prefix.append(bytecode.at(offset + 2 + i));
+            } else {
+                done = true;
+            }
+            break;
+        }
+        default:
+            done = true;
+            break;
+        }
+        if (!done)
+            state.instruction_position += opcode.size();
+    }
+
+    if (!data.literal_prefix.is_empty())
+        return;
+
+    HashTable<size_t> visited;
+    if (!collect_starting_ranges(bytecode, 0, data.starting_ranges, visited)) {
+        data.starting_ranges.clear();
+        return;
+    }
+
+    for (auto const& range : data.starting_ranges) {
+        for (u32 byte = range.from; byte <= min(range.to, 255u); ++byte)
+            data.starting_bytes[byte] = true;
+    }
 }
 
 template<typename Parser>
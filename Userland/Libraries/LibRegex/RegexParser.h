@@ -11,6 +11,7 @@
 #include "RegexLexer.h"
 #include "RegexOptions.h"
 
+#include <AK/Array.h>
 #include <AK/Forward.h>
 #include <AK/StringBuilder.h>
 #include <AK/Types.h>
@@ -55,6 +56,16 @@ public:
         Token error_token;
         Vector<DeprecatedFlyString> capture_groups;
         AllOptions options;
+
+        // Filled in by Regex::run_optimization_passes(), lets the matcher skip over positions where no match can start.
+        struct OptimizationData {
+            // The characters every match starts with.
+            Vector<u32> literal_prefix;
+            // If there's no such prefix, a character every match starts with is in one of these.
+            Vector<CharRange> starting_ranges;
+            // The same as starting_ranges, for each byte of non-Unicode input.
+            Array<bool, 256> starting_bytes {};
+        } optimization_data {};
     };
 
     explicit Parser(Lexer& lexer)
@@ -389,6 +389,14 @@ RefPtr<CommonTableExpressionList> Parser::parse_common_table_expression_list()
 }
 
 NonnullRefPtr<Expression> Parser::parse_expression()
+{
+    return parse_expression(Precedence::Lowest);
+}
+
+// Parses an expression whose operators all bind at least as tightly as the given precedence. Operands on the right are
+// parsed with a higher minimum precedence, so that e.g. "a = b AND c = d" becomes "(a = b) AND (c = d)", and operators
+// of equal precedence group to the left.
+NonnullRefPtr<Expression> Parser::parse_expression(Precedence minimum_precedence)
 {
     if (++m_parser_state.m_current_expression_depth > Limits::maximum_expression_tree_depth) {
         syntax_error(DeprecatedString::formatted("Exceeded maximum expression tree depth of {}", Limits::maximum_expression_tree_depth));
@@ -398,7 +406,7 @@ NonnullRefPtr<Expression> Parser::parse_expression()
     // https://sqlite.org/lang_expr.html
     auto expression = parse_primary_expression();
 
-    if (match_secondary_expression())
+    while (match_secondary_expression() && secondary_expression_precedence() >= minimum_precedence)
         expression = parse_secondary_expression(move(expression));
 
     // FIXME: Parse 'function-name'.
@@ -508,6 +516,40 @@ bool Parser::match_secondary_expression() const
         || match(TokenType::In);
 }
 
+Parser::Precedence Parser::secondary_expression_precedence() const
+{
+    switch (m_parser_state.m_token.type()) {
+    case TokenType::Or:
+        return Precedence::Or;
+    case TokenType::And:
+        return Precedence::And;
+    case TokenType::LessThan:
+    case TokenType::LessThanEquals:
+    case TokenType::GreaterThan:
+    case TokenType::GreaterThanEquals:
+        return Precedence::Comparison;
+    case TokenType::Ampersand:
+    case TokenType::Pipe:
+    case TokenType::ShiftLeft:
+    case TokenType::ShiftRight:
+        return Precedence::Bitwise;
+    case TokenType::Plus:
+    case TokenType::Minus:
+        return Precedence::Additive;
+    case TokenType::Asterisk:
+    case TokenType::Divide:
+    case TokenType::Modulus:
+        return Precedence::Multiplicative;
+    case TokenType::DoublePipe:
+        return Precedence::Concatenation;
+    case TokenType::Collate:
+        return Precedence::Collate;
+    default:
+        // =, ==, !=, <>, IS, [NOT] LIKE, GLOB, MATCH, REGEXP, BETWEEN, IN, ISNULL, NOTNULL and NOT NULL.
+        return Precedence::Equality;
+    }
+}
+
 RefPtr<Expression> Parser::parse_literal_value_expression()
 {
     if (match(TokenType::NumericLiteral)) {
@@ -585,19 +627,19 @@ RefPtr<Expression> Parser::parse_column_name_expression(DeprecatedString with_pa
 RefPtr<Expression> Parser::parse_unary_operator_expression()
 {
     if (consume_if(TokenType::Minus))
-        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Minus, parse_expression());
+        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Minus, parse_expression(Precedence::Unary));
 
     if (consume_if(TokenType::Plus))
-        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Plus, parse_expression());
+        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Plus, parse_expression(Precedence::Unary));
 
     if (consume_if(TokenType::Tilde))
-        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::BitwiseNot, parse_expression());
+        return create_ast_node<UnaryOperatorExpression>(UnaryOperator::BitwiseNot, parse_expression(Precedence::Unary));
 
     if (consume_if(TokenType::Not)) {
         if (match(TokenType::Exists))
             return parse_exists_expression(true);
         else
-            return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Not, parse_expression());
+            return create_ast_node<UnaryOperatorExpression>(UnaryOperator::Not, parse_expression(Precedence::Not));
     }
 
     return {};
@@ -605,59 +647,61 @@ RefPtr<Expression> Parser::parse_unary_operator_expression()
 
 RefPtr<Expression> Parser::parse_binary_operator_expression(NonnullRefPtr<Expression> lhs)
 {
+    auto rhs_precedence = static_cast<Precedence>(to_underlying(secondary_expression_precedence()) + 1);
+
     if (consume_if(TokenType::DoublePipe))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Concatenate, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Concatenate, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::Asterisk))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Multiplication, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Multiplication, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::Divide))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Division, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Division, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::Modulus))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Modulo, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Modulo, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::Plus))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Plus, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Plus, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::Minus))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Minus, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Minus, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::ShiftLeft))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::ShiftLeft, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::ShiftLeft, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::ShiftRight))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::ShiftRight, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::ShiftRight, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::Ampersand))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::BitwiseAnd, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::BitwiseAnd, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::Pipe))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::BitwiseOr, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::BitwiseOr, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::LessThan))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::LessThan, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::LessThan, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::LessThanEquals))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::LessThanEquals, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::LessThanEquals, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::GreaterThan))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::GreaterThan, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::GreaterThan, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::GreaterThanEquals))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::GreaterThanEquals, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::GreaterThanEquals, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::Equals) || consume_if(TokenType::EqualsEquals))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Equals, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Equals, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::NotEquals1) || consume_if(TokenType::NotEquals2))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::NotEquals, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::NotEquals, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::And))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::And, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::And, move(lhs), parse_expression(rhs_precedence));
 
     if (consume_if(TokenType::Or))
-        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Or, move(lhs), parse_expression());
+        return create_ast_node<BinaryOperatorExpression>(BinaryOperator::Or, move(lhs), parse_expression(rhs_precedence));
 
     return {};
 }
@@ -765,7 +809,7 @@ RefPtr<Expression> Parser::parse_is_expression(NonnullRefPtr<Expression> express
         invert_expression = true;
     }
 
-    auto rhs = parse_expression();
+    auto rhs = parse_expression(Precedence::Comparison);
     return create_ast_node<IsExpression>(move(expression), move(rhs), invert_expression);
 }
 
@@ -774,31 +818,31 @@ RefPtr<Expression> Parser::parse_match_expression(NonnullRefPtr<Expression> lhs,
     auto parse_escape = [this]() {
         RefPtr<Expression> escape;
         if (consume_if(TokenType::Escape)) {
-            escape = parse_expression();
+            escape = parse_expression(Precedence::Comparison);
         }
         return escape;
     };
 
     if (consume_if(TokenType::Like)) {
-        NonnullRefPtr<Expression> rhs = parse_expression();
+        NonnullRefPtr<Expression> rhs = parse_expression(Precedence::Comparison);
         RefPtr<Expression> escape = parse_escape();
         return create_ast_node<MatchExpression>(MatchOperator::Like, move(lhs), move(rhs), move(escape), invert_expression);
     }
 
     if (consume_if(TokenType::Glob)) {
-        NonnullRefPtr<Expression> rhs = parse_expression();
+        NonnullRefPtr<Expression> rhs = parse_expression(Precedence::Comparison);
         RefPtr<Expression> escape = parse_escape();
         return create_ast_node<MatchExpression>(MatchOperator::Glob, move(lhs), move(rhs), move(escape), invert_expression);
     }
 
     if (consume_if(TokenType::Match)) {
-        NonnullRefPtr<Expression> rhs = parse_expression();
+        NonnullRefPtr<Expression> rhs = parse_expression(Precedence::Comparison);
         RefPtr<Expression> escape = parse_escape();
         return create_ast_node<MatchExpression>(MatchOperator::Match, move(lhs), move(rhs), move(escape), invert_expression);
     }
 
     if (consume_if(TokenType::Regexp)) {
-        NonnullRefPtr<Expression> rhs = parse_expression();
+        NonnullRefPtr<Expression> rhs = parse_expression(Precedence::Comparison);
         RefPtr<Expression> escape = parse_escape();
         return create_ast_node<MatchExpression>(MatchOperator::Regexp, move(lhs), move(rhs), move(escape), invert_expression);
     }
@@ -824,19 +868,12 @@ RefPtr<Expression> Parser::parse_between_expression(NonnullRefPtr<Expression> ex
 
     consume();
 
-    auto nested = parse_expression();
-    if (!is<BinaryOperatorExpression>(*nested)) {
-        expected("Binary Expression"sv);
-        return create_ast_node<ErrorExpression>();
-    }
-
-    auto const& binary_expression = static_cast<BinaryOperatorExpression const&>(*nested);
-    if (binary_expression.type() != BinaryOperator::And) {
-        expected("AND Expression"sv);
-        return create_ast_node<ErrorExpression>();
-    }
+    // The bounds bind more tightly than AND, which separates them.
+    auto lhs = parse_expression(Precedence::Comparison);
+    consume(TokenType::And);
+    auto rhs = parse_expression(Precedence::Comparison);
 
-    return create_ast_node<BetweenExpression>(move(expression), binary_expression.lhs(), binary_expression.rhs(), invert_expression);
+    return create_ast_node<BetweenExpression>(move(expression), move(lhs), move(rhs), invert_expression);
 }
 
 RefPtr<Expression> Parser::parse_in_expression(NonnullRefPtr<Expression> expression, bool invert_expression)
@@ -69,9 +69,27 @@ private:
     NonnullRefPtr<Select> parse_select_statement(RefPtr<CommonTableExpressionList>);
     RefPtr<CommonTableExpressionList> parse_common_table_expression_list();
 
+    // https://sqlite.org/lang_expr.html#operators_and_parse_affecting_attributes, from the loosest to the tightest binding.
+    enum class Precedence : u8 {
+        Lowest,
+        Or,
+        And,
+        Not,
+        Equality,
+        Comparison,
+        Bitwise,
+        Additive,
+        Multiplicative,
+        Concatenation,
+        Collate,
+        Unary,
+    };
+
+    NonnullRefPtr<Expression> parse_expression(Precedence minimum_precedence);
     NonnullRefPtr<Expression> parse_primary_expression();
     NonnullRefPtr<Expression> parse_secondary_expression(NonnullRefPtr<Expression> primary);
     bool match_secondary_expression() const;
+    Precedence secondary_expression_precedence() const;
     RefPtr<Expression> parse_literal_value_expression();
     RefPtr<Expression> parse_bind_parameter_expression();
     RefPtr<Expression> parse_column_name_expression(DeprecatedString with_parsed_identifier = {}, bool with_parsed_period = false);
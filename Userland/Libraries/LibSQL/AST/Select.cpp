@@ -4,7 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/HashMap.h>
 #include <AK/NumericLimits.h>
+#include <AK/OwnPtr.h>
 #include <LibSQL/AST/AST.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Meta.h>
@@ -37,6 +39,310 @@ static DeprecatedString result_column_name(ResultColumn const& column, size_t co
     return fallback_column_name();
 }
 
+namespace {
+
+// A conjunct of the WHERE clause, and the number of tables that have to be joined before it can be evaluated.
+struct Condition {
+    Expression const* expression { nullptr };
+    size_t stage { 0 };
+};
+
+}
+
+static void split_conjunction(Expression const& expression, Vector<Expression const*>& conjuncts)
+{
+    if (is<BinaryOperatorExpression>(expression)) {
+        auto const& binary_expression = verify_cast<BinaryOperatorExpression>(expression);
+        if (binary_expression.type() == BinaryOperator::And) {
+            split_conjunction(*binary_expression.lhs(), conjuncts);
+            split_conjunction(*binary_expression.rhs(), conjuncts);
+            return;
+        }
+    }
+    conjuncts.append(&expression);
+}
+
+// Returns false if the expression contains anything whose column references can't be determined up front.
+static bool collect_column_references(Expression const& expression, Vector<ColumnNameExpression const*>& columns)
+{
+    if (is<ColumnNameExpression>(expression)) {
+        columns.append(&verify_cast<ColumnNameExpression>(expression));
+        return true;
+    }
+    if (is<NumericLiteral>(expression) || is<StringLiteral>(expression) || is<BooleanLiteral>(expression) || is<NullLiteral>(expression) || is<Placeholder>(expression))
+        return true;
+    if (is<UnaryOperatorExpression>(expression))
+        return collect_column_references(*verify_cast<UnaryOperatorExpression>(expression).expression(), columns);
+    if (is<BinaryOperatorExpression>(expression)) {
+        auto const& binary_expression = verify_cast<BinaryOperatorExpression>(expression);
+        return collect_column_references(*binary_expression.lhs(), columns) && collect_column_references(*binary_expression.rhs(), columns);
+    }
+    if (is<MatchExpression>(expression)) {
+        auto const& match_expression = verify_cast<MatchExpression>(expression);
+        if (match_expression.escape() && !collect_column_references(*match_expression.escape(), columns))
+            return false;
+        return collect_column_references(*match_expression.lhs(), columns) && collect_column_references(*match_expression.rhs(), columns);
+    }
+    if (is<ChainedExpression>(expression)) {
+        for (auto const& element : verify_cast<ChainedExpression>(expression).expressions()) {
+            if (!collect_column_references(element, columns))
+                return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+// Resolves a column the same way ColumnNameExpression::evaluate() does, but only if it resolves to exactly one column.
+static Optional<size_t> resolve_column(ColumnNameExpression const& column, TupleDescriptor const& descriptor)
+{
+    Optional<size_t> index;
+    for (size_t ix = 0; ix < descriptor.size(); ++ix) {
+        if (!column.table_name().is_empty() && descriptor[ix].table != column.table_name())
+            continue;
+        if (descriptor[ix].name == column.column_name()) {
+            if (index.has_value())
+                return {};
+            index = ix;
+        }
+    }
+    return index;
+}
+
+// Values that compare equal have the same key. Values without a key (floats, or integers that don't fit an i64) have to
+// be compared with everything.
+static Optional<u32> join_key(Value const& value)
+{
+    switch (value.type()) {
+    case SQLType::Text:
+        return value.hash();
+    case SQLType::Integer:
+        if (auto integer = value.to_int<i64>(); integer.has_value())
+            return u64_hash(static_cast<u64>(integer.value()));
+        return {};
+    default:
+        return {};
+    }
+}
+
+static Tuple join_rows(NonnullRefPtr<TupleDescriptor> const& descriptor, Tuple const& row, Tuple const& table_row)
+{
+    Tuple joined_row(descriptor);
+    for (size_t ix = 0; ix < row.size(); ++ix)
+        joined_row[ix] = row[ix];
+    for (size_t ix = 0; ix < table_row.size(); ++ix)
+        joined_row[row.size() + ix] = table_row[ix];
+    return joined_row;
+}
+
+namespace {
+
+// An equality between a column of the table being joined and one that's already in the row.
+struct HashJoin {
+    size_t row_index { 0 };
+    size_t table_index { 0 };
+};
+
+// The operators a SELECT is executed with. Rows are pulled through them one at a time, so only the tables that are
+// joined against have to be held in memory, and nothing more is read once a LIMIT has been reached.
+class RowSource {
+public:
+    virtual ~RowSource() = default;
+
+    // Returns an empty Optional once there are no more rows.
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) = 0;
+};
+
+// Produces the single row that the first table is joined to.
+class UnitySource final : public RowSource {
+public:
+    explicit UnitySource(NonnullRefPtr<TupleDescriptor> descriptor)
+        : m_descriptor(move(descriptor))
+    {
+    }
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext&) override
+    {
+        if (m_done)
+            return Optional<Tuple> {};
+        m_done = true;
+
+        Tuple row(m_descriptor);
+        row[0] = Value { true };
+        return Optional<Tuple> { move(row) };
+    }
+
+private:
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+    bool m_done { false };
+};
+
+class FilterSource final : public RowSource {
+public:
+    FilterSource(NonnullOwnPtr<RowSource> input, Vector<Expression const*> conditions)
+        : m_input(move(input))
+        , m_conditions(move(conditions))
+    {
+    }
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext& context) override
+    {
+        while (true) {
+            auto row = TRY(m_input->next(context));
+            if (!row.has_value())
+                return row;
+            if (TRY(passes(context, row.value())))
+                return row;
+        }
+    }
+
+private:
+    ResultOr<bool> passes(ExecutionContext& context, Tuple& row) const
+    {
+        context.current_row = &row;
+        for (auto const* condition : m_conditions) {
+            auto result = TRY(condition->evaluate(context)).to_bool();
+            if (!result.has_value() || !result.value())
+                return false;
+        }
+        return true;
+    }
+
+    NonnullOwnPtr<RowSource> m_input;
+    Vector<Expression const*> m_conditions;
+};
+
+// Pairs every input row with the rows of a table, reading them from the database as they're pulled. This is used for the
+// first table, whose only input row is the unity row, so that table is read just once and never held in memory.
+class ScanSource final : public RowSource {
+public:
+    ScanSource(NonnullOwnPtr<RowSource> input, NonnullRefPtr<TableDef> table, NonnullRefPtr<TupleDescriptor> descriptor)
+        : m_input(move(input))
+        , m_table(move(table))
+        , m_descriptor(move(descriptor))
+    {
+    }
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext& context) override
+    {
+        while (true) {
+            if (m_current_row.has_value() && m_next_pointer != 0) {
+                auto table_row = TRY(context.database->read_row(*m_table, m_next_pointer));
+                m_next_pointer = table_row.next_pointer();
+                return Optional<Tuple> { join_rows(m_descriptor, m_current_row.value(), table_row) };
+            }
+
+            m_current_row = TRY(m_input->next(context));
+            if (!m_current_row.has_value())
+                return Optional<Tuple> {};
+            m_next_pointer = m_table->pointer();
+        }
+    }
+
+private:
+    NonnullOwnPtr<RowSource> m_input;
+    NonnullRefPtr<TableDef> m_table;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+    Optional<Tuple> m_current_row;
+    u32 m_next_pointer { 0 };
+};
+
+// Pairs every input row with the rows of a table, which are read into memory the first time a row is pulled. With a
+// hash join, an input row is only paired with the rows that can be equal to it.
+class JoinSource final : public RowSource {
+public:
+    JoinSource(NonnullOwnPtr<RowSource> input, NonnullRefPtr<TableDef> table, NonnullRefPtr<TupleDescriptor> descriptor, Optional<HashJoin> hash_join)
+        : m_input(move(input))
+        , m_table(move(table))
+        , m_descriptor(move(descriptor))
+        , m_hash_join(hash_join)
+    {
+    }
+
+    virtual ResultOr<Optional<Tuple>> next(ExecutionContext& context) override
+    {
+        if (!m_table_rows.has_value())
+            TRY(load_table_rows(context));
+
+        while (true) {
+            if (m_current_row.has_value() && !m_pending_table_rows.is_empty()) {
+                auto const& table_row = m_table_rows.value()[m_pending_table_rows[0]];
+                m_pending_table_rows = m_pending_table_rows.slice(1);
+                return Optional<Tuple> { join_rows(m_descriptor, m_current_row.value(), table_row) };
+            }
+
+            m_current_row = TRY(m_input->next(context));
+            if (!m_current_row.has_value())
+                return Optional<Tuple> {};
+            find_table_rows_for(m_current_row.value());
+        }
+    }
+
+private:
+    ResultOr<void> load_table_rows(ExecutionContext& context)
+    {
+        m_table_rows = TRY(context.database->select_all(*m_table));
+
+        auto const& table_rows = m_table_rows.value();
+        for (size_t ix = 0; ix < table_rows.size(); ++ix)
+            m_all_table_rows.append(ix);
+        if (!m_hash_join.has_value())
+            return {};
+
+        for (size_t ix = 0; ix < table_rows.size(); ++ix) {
+            auto const& value = table_rows[ix][m_hash_join->table_index];
+            if (value.is_null())
+                continue;
+            if (auto key = join_key(value); key.has_value())
+                m_table_rows_by_key.ensure(key.value()).append(ix);
+            else
+                m_unkeyed_table_rows.append(ix);
+        }
+        return {};
+    }
+
+    void find_table_rows_for(Tuple const& row)
+    {
+        if (!m_hash_join.has_value()) {
+            m_pending_table_rows = m_all_table_rows.span();
+            return;
+        }
+
+        m_pending_table_rows = {};
+        auto const& value = row[m_hash_join->row_index];
+        if (value.is_null())
+            return;
+
+        auto key = join_key(value);
+        if (!key.has_value()) {
+            m_pending_table_rows = m_all_table_rows.span();
+            return;
+        }
+
+        m_candidate_table_rows.clear_with_capacity();
+        if (auto candidates = m_table_rows_by_key.find(key.value()); candidates != m_table_rows_by_key.end())
+            m_candidate_table_rows.extend(candidates->value);
+        m_candidate_table_rows.extend(m_unkeyed_table_rows);
+        m_pending_table_rows = m_candidate_table_rows.span();
+    }
+
+    NonnullOwnPtr<RowSource> m_input;
+    NonnullRefPtr<TableDef> m_table;
+    NonnullRefPtr<TupleDescriptor> m_descriptor;
+    Optional<HashJoin> m_hash_join;
+
+    Optional<Vector<Row>> m_table_rows;
+    Vector<size_t> m_all_table_rows;
+    HashMap<u32, Vector<size_t>> m_table_rows_by_key;
+    Vector<size_t> m_unkeyed_table_rows;
+
+    Optional<Tuple> m_current_row;
+    Vector<size_t> m_candidate_table_rows;
+    Span<size_t const> m_pending_table_rows;
+};
+
+}
+
 ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
 {
     NonnullRefPtrVector<ResultColumn> columns;
@@ -85,74 +391,108 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
 
     ResultSet result { SQLCommand::Select, move(column_names) };
 
-    auto descriptor = adopt_ref(*new TupleDescriptor);
-    Tuple tuple(descriptor);
-    Vector<Tuple> rows;
-    descriptor->empend("__unity__"sv);
-    tuple.append(Value { true });
-    rows.append(tuple);
-
+    Vector<NonnullRefPtr<TableDef>> tables;
     for (auto& table_descriptor : table_or_subquery_list()) {
-        if (!table_descriptor.is_table())
-            return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
-
         auto table_def = TRY(context.database->get_table(table_descriptor.schema_name(), table_descriptor.table_name()));
-        if (table_def->num_columns() == 0)
-            continue;
+        if (table_def->num_columns() != 0)
+            tables.append(move(table_def));
+    }
 
-        auto old_descriptor_size = descriptor->size();
+    // Stage k joins the first k tables. Its rows start with the unity column, followed by the columns of each of those
+    // tables, so every stage's descriptor is a prefix of the next one's.
+    Vector<NonnullRefPtr<TupleDescriptor>> descriptors;
+    Vector<size_t> stage_offsets;
+    descriptors.append(adopt_ref(*new TupleDescriptor));
+    descriptors[0]->empend("__unity__"sv);
+    for (auto& table_def : tables) {
+        stage_offsets.append(descriptors.last()->size());
+        auto descriptor = adopt_ref(*new TupleDescriptor);
+        descriptor->extend(*descriptors.last());
         descriptor->extend(table_def->to_tuple_descriptor());
+        descriptors.append(move(descriptor));
+    }
+    auto const& final_descriptor = *descriptors.last();
+    auto final_stage = tables.size();
+
+    auto stage_of_column = [&](size_t index) {
+        size_t stage = 0;
+        while (stage < stage_offsets.size() && index >= stage_offsets[stage])
+            ++stage;
+        return stage;
+    };
 
-        while (!rows.is_empty() && (rows.first().size() == old_descriptor_size)) {
-            auto cartesian_row = rows.take_first();
-            auto table_rows = TRY(context.database->select_all(*table_def));
-
-            for (auto& table_row : table_rows) {
-                auto new_row = cartesian_row;
-                new_row.extend(table_row);
-                rows.append(new_row);
+    // Every conjunct of the WHERE clause is evaluated as soon as the tables it refers to have been joined. Anything that
+    // can't be analyzed, including columns that don't resolve, waits for the full row so it behaves as it always did.
+    Vector<Condition> conditions;
+    if (where_clause()) {
+        Vector<Expression const*> conjuncts;
+        split_conjunction(*where_clause(), conjuncts);
+        for (auto const* conjunct : conjuncts) {
+            Vector<ColumnNameExpression const*> column_references;
+            size_t stage = 0;
+            if (collect_column_references(*conjunct, column_references)) {
+                for (auto const* column : column_references) {
+                    auto index = resolve_column(*column, final_descriptor);
+                    stage = index.has_value() ? max(stage, stage_of_column(index.value())) : final_stage;
+                }
+            } else {
+                stage = final_stage;
             }
+            conditions.append({ conjunct, stage });
         }
     }
 
-    bool has_ordering { false };
-    auto sort_descriptor = adopt_ref(*new TupleDescriptor);
-    for (auto& term : m_ordering_term_list) {
-        sort_descriptor->append(TupleElementDescriptor { .order = term.order() });
-        has_ordering = true;
-    }
-    Tuple sort_key(sort_descriptor);
-
-    for (auto& row : rows) {
-        context.current_row = &row;
-
-        if (where_clause()) {
-            auto where_result = TRY(where_clause()->evaluate(context)).to_bool();
-            if (!where_result.has_value() || !where_result.value())
+    // An equality between a column of the table being joined and one that's already in the row is answered with a hash
+    // table over that table's rows, rather than by pairing every row with every other.
+    auto find_hash_join = [&](size_t stage) -> Optional<HashJoin> {
+        for (auto const& condition : conditions) {
+            if (condition.stage != stage || !is<BinaryOperatorExpression>(*condition.expression))
                 continue;
+            auto const& equality = verify_cast<BinaryOperatorExpression>(*condition.expression);
+            if (equality.type() != BinaryOperator::Equals || !is<ColumnNameExpression>(*equality.lhs()) || !is<ColumnNameExpression>(*equality.rhs()))
+                continue;
+            auto lhs_index = resolve_column(verify_cast<ColumnNameExpression>(*equality.lhs()), final_descriptor);
+            auto rhs_index = resolve_column(verify_cast<ColumnNameExpression>(*equality.rhs()), final_descriptor);
+            if (!lhs_index.has_value() || !rhs_index.has_value())
+                continue;
+            auto lhs_stage = stage_of_column(lhs_index.value());
+            auto rhs_stage = stage_of_column(rhs_index.value());
+            if (lhs_stage == rhs_stage)
+                continue;
+            auto row_index = lhs_stage < rhs_stage ? lhs_index.value() : rhs_index.value();
+            auto table_index = lhs_stage < rhs_stage ? rhs_index.value() : lhs_index.value();
+            auto type = final_descriptor[table_index].type;
+            if (final_descriptor[row_index].type != type || (type != SQLType::Integer && type != SQLType::Text))
+                continue;
+            return HashJoin { row_index, table_index - stage_offsets[stage - 1] };
         }
+        return {};
+    };
 
-        tuple.clear();
-
-        for (auto& col : columns) {
-            auto value = TRY(col.expression()->evaluate(context));
-            tuple.append(value);
-        }
-
-        if (has_ordering) {
-            sort_key.clear();
-            for (auto& term : m_ordering_term_list) {
-                auto value = TRY(term.expression()->evaluate(context));
-                sort_key.append(value);
-            }
+    auto filter = [&](NonnullOwnPtr<RowSource> input, size_t stage) -> NonnullOwnPtr<RowSource> {
+        Vector<Expression const*> stage_conditions;
+        for (auto const& condition : conditions) {
+            if (condition.stage == stage)
+                stage_conditions.append(condition.expression);
         }
+        if (stage_conditions.is_empty())
+            return input;
+        return make<FilterSource>(move(input), move(stage_conditions));
+    };
 
-        result.insert_row(tuple, sort_key);
+    NonnullOwnPtr<RowSource> source = filter(make<UnitySource>(descriptors[0]), 0);
+    for (size_t stage = 1; stage <= final_stage; ++stage) {
+        if (stage == 1)
+            source = make<ScanSource>(move(source), tables[0], descriptors[1]);
+        else
+            source = make<JoinSource>(move(source), tables[stage - 1], descriptors[stage], find_hash_join(stage));
+        source = filter(move(source), stage);
     }
 
+    size_t limit_value = NumericLimits<size_t>::max();
+    size_t offset_value = 0;
     if (m_limit_clause != nullptr) {
-        size_t limit_value = NumericLimits<size_t>::max();
-        size_t offset_value = 0;
+        context.current_row = nullptr;
 
         auto limit = TRY(m_limit_clause->limit_expression()->evaluate(context));
         if (!limit.is_null()) {
@@ -173,9 +513,49 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
                 offset_value = offset_value_maybe.value();
             }
         }
+    }
+    auto kept_rows = limit_value > NumericLimits<size_t>::max() - offset_value ? NumericLimits<size_t>::max() : offset_value + limit_value;
 
-        result.limit(offset_value, limit_value);
+    bool has_ordering { false };
+    auto sort_descriptor = adopt_ref(*new TupleDescriptor);
+    for (auto& term : m_ordering_term_list) {
+        sort_descriptor->append(TupleElementDescriptor { .order = term.order() });
+        has_ordering = true;
+    }
+    Tuple sort_key(sort_descriptor);
+
+    // Without an ORDER BY, the first rows are the result, so nothing more has to be read once there are enough of them.
+    // With one, every row has to be seen, but only the ones that sort first are kept.
+    Tuple tuple;
+    while (has_ordering || result.size() < kept_rows) {
+        auto row = TRY(source->next(context));
+        if (!row.has_value())
+            break;
+        context.current_row = &row.value();
+
+        tuple.clear();
+
+        for (auto& col : columns) {
+            auto value = TRY(col.expression()->evaluate(context));
+            tuple.append(value);
+        }
+
+        if (has_ordering) {
+            sort_key.clear();
+            for (auto& term : m_ordering_term_list) {
+                auto value = TRY(term.expression()->evaluate(context));
+                sort_key.append(value);
+            }
+        }
+
+        result.insert_row(tuple, sort_key);
+        if (result.size() > kept_rows)
+            result.take_last();
     }
+    context.current_row = nullptr;
+
+    if (m_limit_clause != nullptr)
+        result.limit(offset_value, limit_value);
 
     return result;
 }
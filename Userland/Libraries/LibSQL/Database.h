@@ -42,6 +42,8 @@ public:
     ResultOr<NonnullRefPtr<TableDef>> get_table(DeprecatedString const&, DeprecatedString const&);
 
     ErrorOr<Vector<Row>> select_all(TableDef const&);
+    // Reads a single row of the table. The first row is at the table's pointer, and each row points to the next one.
+    ErrorOr<Row> read_row(TableDef const&, u32 pointer);
     ErrorOr<Vector<Row>> match(TableDef const&, Key const&);
     ErrorOr<void> insert(Row&);
     ErrorOr<void> remove(Row&);
@@ -6,9 +6,11 @@
 
 #include <AK/DeprecatedString.h>
 #include <AK/Format.h>
+#include <AK/NumericLimits.h>
 #include <AK/QuickSort.h>
 #include <LibCore/IODevice.h>
 #include <LibCore/System.h>
+#include <LibCrypto/Checksum/CRC32.h>
 #include <LibSQL/Heap.h>
 #include <LibSQL/Serializer.h>
 #include <sys/stat.h>
@@ -23,10 +25,21 @@ Heap::Heap(DeprecatedString file_name)
 
 Heap::~Heap()
 {
-    if (m_file && !m_write_ahead_log.is_empty()) {
+    if (!m_file)
+        return;
+
+    if (!m_write_ahead_log.is_empty()) {
         if (auto maybe_error = flush(); maybe_error.is_error())
             warnln("~Heap({}): {}", name(), maybe_error.error());
     }
+
+    // Once everything is in the heap file, the log isn't needed anymore.
+    if (auto maybe_error = checkpoint(); maybe_error.is_error()) {
+        warnln("~Heap({}): {}", name(), maybe_error.error());
+        return;
+    }
+    if (auto maybe_error = Core::System::unlink(log_file_name()); maybe_error.is_error())
+        warnln("~Heap({}): {}", name(), maybe_error.error());
 }
 
 ErrorOr<void> Heap::open()
@@ -44,25 +57,41 @@ ErrorOr<void> Heap::open()
     } else {
         file_size = stat_buffer.st_size;
     }
-    if (file_size > 0)
+    if (file_size > 0) {
         m_next_block = m_end_of_file = file_size / BLOCKSIZE;
+    } else if (auto result = Core::System::unlink(log_file_name()); result.is_error() && result.error().code() != ENOENT) {
+        // A log next to an empty heap file belongs to a heap that has since been deleted.
+        return result.release_error();
+    }
 
     auto file = TRY(Core::Stream::File::open(name(), Core::Stream::OpenMode::ReadWrite));
+    m_file_descriptor = file->fd();
     m_file = TRY(Core::Stream::BufferedFile::create(move(file)));
+    m_log = TRY(Core::Stream::File::open(log_file_name(), Core::Stream::OpenMode::ReadWrite | Core::Stream::OpenMode::Append));
 
     if (file_size > 0) {
-        if (auto error_maybe = read_zero_block(); error_maybe.is_error()) {
+        auto error_maybe = recover_from_log();
+        if (!error_maybe.is_error())
+            error_maybe = read_zero_block();
+        if (error_maybe.is_error()) {
             m_file = nullptr;
+            m_log = nullptr;
             return error_maybe.error();
         }
     } else {
+        // The heap file is never empty once it has a log, so that a log without one can be recognized as stale.
         initialize_zero_block();
+        TRY(flush());
+        TRY(checkpoint());
     }
 
     // FIXME: We should more gracefully handle version incompatibilities. For now, we drop the database.
     if (m_version != current_version) {
         dbgln_if(SQL_DEBUG, "Heap file {} opened has incompatible version {}. Deleting for version {}.", name(), m_version, current_version);
         m_file = nullptr;
+        m_log = nullptr;
+        m_cached_block_list.clear();
+        m_cached_blocks.clear();
 
         TRY(Core::System::unlink(name()));
         return open();
@@ -81,20 +110,26 @@ ErrorOr<ByteBuffer> Heap::read_block(u32 block)
 
     if (auto buffer = m_write_ahead_log.get(block); buffer.has_value())
         return TRY(ByteBuffer::copy(*buffer));
+    if (auto buffer = m_logged_blocks.get(block); buffer.has_value())
+        return TRY(ByteBuffer::copy(*buffer));
 
     if (block >= m_next_block) {
         warnln("Heap({})::read_block({}): block # out of range (>= {})"sv, name(), block, m_next_block);
         return Error::from_string_literal("Heap()::read_block(): block # out of range");
     }
 
+    if (auto const* buffer = cached_block(block))
+        return TRY(ByteBuffer::copy(*buffer));
+
     dbgln_if(SQL_DEBUG, "Read heap block {}", block);
     TRY(seek_block(block));
 
+    // NOTE: The buffered file hands out at most as much as it reads from the file at once, which can be less than a block.
     auto buffer = TRY(ByteBuffer::create_uninitialized(BLOCKSIZE));
-    auto bytes = TRY(m_file->read(buffer));
+    TRY(m_file->read_entire_buffer(buffer));
 
-    dbgln_if(SQL_DEBUG, "{:hex-dump}", bytes.trim(8));
-    TRY(buffer.try_resize(bytes.size()));
+    dbgln_if(SQL_DEBUG, "{:hex-dump}", buffer.bytes().trim(8));
+    TRY(cache_block(block, buffer));
 
     return buffer;
 }
@@ -127,7 +162,7 @@ ErrorOr<void> Heap::write_block(u32 block, ByteBuffer& buffer)
 
     if (block == m_end_of_file)
         m_end_of_file++;
-    return {};
+    return cache_block(block, buffer);
 }
 
 ErrorOr<void> Heap::seek_block(u32 block)
@@ -166,22 +201,168 @@ u32 Heap::new_record_pointer()
     return m_next_block++;
 }
 
+// The log is a sequence of commits. Each one consists of the blocks it wrote, every one of them preceded by its index, and
+// ends with a commit record that holds the number of blocks and a checksum over them. Recovery stops at the first commit
+// that's incomplete or whose checksum doesn't match, which is where a crash interrupted the writing of the log.
+constexpr static u32 LOG_COMMIT_MARKER = NumericLimits<u32>::max();
+constexpr static size_t LOG_BLOCK_RECORD_SIZE = sizeof(u32) + BLOCKSIZE;
+constexpr static size_t LOG_COMMIT_RECORD_SIZE = 3 * sizeof(u32);
+
 ErrorOr<void> Heap::flush()
 {
     VERIFY(m_file);
+    if (m_write_ahead_log.is_empty())
+        return {};
+
     Vector<u32> blocks;
     for (auto& wal_entry : m_write_ahead_log) {
         blocks.append(wal_entry.key);
     }
     quick_sort(blocks);
+
+    auto log_records = TRY(ByteBuffer::create_zeroed(blocks.size() * LOG_BLOCK_RECORD_SIZE + LOG_COMMIT_RECORD_SIZE));
+    size_t offset = 0;
+    for (auto block : blocks) {
+        auto& buffer = m_write_ahead_log.find(block)->value;
+        if (buffer.size() > BLOCKSIZE) {
+            warnln("Heap({})::flush(): Oversized block {} ({} > {})"sv, name(), block, buffer.size(), BLOCKSIZE);
+            return Error::from_string_literal("Heap()::flush(): Oversized block");
+        }
+        log_records.overwrite(offset, &block, sizeof(u32));
+        log_records.overwrite(offset + sizeof(u32), buffer.data(), buffer.size());
+        offset += LOG_BLOCK_RECORD_SIZE;
+    }
+    u32 block_count = blocks.size();
+    u32 checksum = Crypto::Checksum::CRC32(log_records.bytes().trim(offset)).digest();
+    log_records.overwrite(offset, &LOG_COMMIT_MARKER, sizeof(u32));
+    log_records.overwrite(offset + sizeof(u32), &block_count, sizeof(u32));
+    log_records.overwrite(offset + 2 * sizeof(u32), &checksum, sizeof(u32));
+
+    // All blocks of a commit are synced to disk at once, and the heap file is only written to at the next checkpoint.
+    dbgln_if(SQL_DEBUG, "Committing {} blocks to {}", block_count, log_file_name());
+    TRY(m_log->write_entire_buffer(log_records));
+    TRY(Core::System::fsync(m_log->fd()));
+
+    for (auto& wal_entry : m_write_ahead_log)
+        m_logged_blocks.set(wal_entry.key, move(wal_entry.value));
+    m_write_ahead_log.clear();
+
+    if (m_logged_blocks.size() >= checkpoint_block_count)
+        TRY(checkpoint());
+    return {};
+}
+
+DeprecatedString Heap::log_file_name() const
+{
+    return DeprecatedString::formatted("{}.wal", name());
+}
+
+ErrorOr<void> Heap::checkpoint()
+{
+    if (m_logged_blocks.is_empty())
+        return {};
+
+    TRY(write_blocks(m_logged_blocks));
+    TRY(Core::System::fsync(m_file_descriptor));
+    TRY(m_log->truncate(0));
+    m_logged_blocks.clear();
+    dbgln_if(SQL_DEBUG, "WAL checkpointed. Heap size = {}", size());
+    return {};
+}
+
+ErrorOr<void> Heap::write_blocks(HashMap<u32, ByteBuffer>& buffers)
+{
+    Vector<u32> blocks;
+    for (auto& entry : buffers) {
+        blocks.append(entry.key);
+    }
+    quick_sort(blocks);
     for (auto& block : blocks) {
-        auto buffer_it = m_write_ahead_log.find(block);
-        VERIFY(buffer_it != m_write_ahead_log.end());
+        auto buffer_it = buffers.find(block);
+        VERIFY(buffer_it != buffers.end());
         dbgln_if(SQL_DEBUG, "Flushing block {} to {}", block, name());
         TRY(write_block(block, buffer_it->value));
     }
-    m_write_ahead_log.clear();
-    dbgln_if(SQL_DEBUG, "WAL flushed. Heap size = {}", size());
+    return {};
+}
+
+ErrorOr<void> Heap::recover_from_log()
+{
+    TRY(m_log->seek(0, SeekMode::SetPosition));
+    auto log = TRY(m_log->read_until_eof());
+    if (log.is_empty())
+        return {};
+
+    auto read_u32 = [&](size_t offset) {
+        u32 value;
+        memcpy(&value, log.offset_pointer(offset), sizeof(u32));
+        return value;
+    };
+
+    HashMap<u32, ByteBuffer> committed_blocks;
+    size_t commit_start = 0;
+    size_t offset = 0;
+    while (offset + sizeof(u32) <= log.size()) {
+        if (read_u32(offset) != LOG_COMMIT_MARKER) {
+            offset += LOG_BLOCK_RECORD_SIZE;
+            continue;
+        }
+        if (offset + LOG_COMMIT_RECORD_SIZE > log.size())
+            break;
+
+        auto records = log.bytes().slice(commit_start, offset - commit_start);
+        auto block_count = read_u32(offset + sizeof(u32));
+        auto checksum = read_u32(offset + 2 * sizeof(u32));
+        if (records.size() != block_count * LOG_BLOCK_RECORD_SIZE || Crypto::Checksum::CRC32(records).digest() != checksum)
+            break;
+
+        for (size_t record = commit_start; record < offset; record += LOG_BLOCK_RECORD_SIZE) {
+            auto block = read_u32(record);
+            committed_blocks.set(block, TRY(ByteBuffer::copy(log.offset_pointer(record + sizeof(u32)), BLOCKSIZE)));
+            m_next_block = max(m_next_block, block + 1);
+        }
+        offset += LOG_COMMIT_RECORD_SIZE;
+        commit_start = offset;
+    }
+
+    if (commit_start < log.size())
+        warnln("Heap({}): Ignoring {} bytes of incomplete commits in {}"sv, name(), log.size() - commit_start, log_file_name());
+    dbgln_if(SQL_DEBUG, "Recovering {} blocks from {}", committed_blocks.size(), log_file_name());
+
+    TRY(write_blocks(committed_blocks));
+    TRY(Core::System::fsync(m_file_descriptor));
+    TRY(m_log->truncate(0));
+    return {};
+}
+
+ByteBuffer const* Heap::cached_block(u32 block)
+{
+    auto it = m_cached_blocks.find(block);
+    if (it == m_cached_blocks.end())
+        return nullptr;
+    m_cached_block_list.prepend(*it->value);
+    return &it->value->data;
+}
+
+ErrorOr<void> Heap::cache_block(u32 block, ByteBuffer const& buffer)
+{
+    if (auto it = m_cached_blocks.find(block); it != m_cached_blocks.end()) {
+        it->value->data = TRY(ByteBuffer::copy(buffer));
+        m_cached_block_list.prepend(*it->value);
+        return {};
+    }
+
+    OwnPtr<CachedBlock> entry;
+    if (m_cached_blocks.size() >= cached_block_count) {
+        auto* least_recently_used = m_cached_block_list.take_last();
+        entry = m_cached_blocks.take(least_recently_used->block).release_value();
+    } else {
+        entry = make<CachedBlock>();
+    }
+    entry->block = block;
+    entry->data = TRY(ByteBuffer::copy(buffer));
+    m_cached_block_list.prepend(*entry);
+    m_cached_blocks.set(block, entry.release_nonnull());
     return {};
 }
 
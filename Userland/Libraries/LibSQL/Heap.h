@@ -10,13 +10,14 @@
 #include <AK/Debug.h>
 #include <AK/DeprecatedString.h>
 #include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
 #include <AK/Vector.h>
 #include <LibCore/Object.h>
 #include <LibCore/Stream.h>
 
 namespace SQL {
 
-constexpr static u32 BLOCKSIZE = 1024;
+constexpr static u32 BLOCKSIZE = 4096;
 
 /**
  * A Heap is a logical container for database (SQL) data. Conceptually a
@@ -28,12 +29,22 @@ constexpr static u32 BLOCKSIZE = 1024;
  * assumed that a single SQL database is backed by a single Heap.
  *
  * Currently only B-Trees and tuple stores are implemented.
+ *
+ * Blocks that are written are kept in memory until flush() commits them. A
+ * commit appends all of them to a write-ahead log next to the heap file, and
+ * syncs the log once. The log is copied into the heap file when it grows too
+ * large and when the heap is closed, and whatever it holds is copied again
+ * when the heap is opened after a crash. Blocks read from the heap file are
+ * kept in a cache of limited size, from which the least recently used blocks
+ * are evicted.
  */
 class Heap : public Core::Object {
     C_OBJECT(Heap);
 
 public:
-    static constexpr inline u32 current_version = 3;
+    static constexpr inline u32 current_version = 4;
+    static constexpr inline size_t cached_block_count = 256;
+    static constexpr inline size_t checkpoint_block_count = 256;
 
     virtual ~Heap() override;
 
@@ -91,6 +102,12 @@ public:
     ErrorOr<void> flush();
 
 private:
+    struct CachedBlock {
+        IntrusiveListNode<CachedBlock> list_node;
+        u32 block { 0 };
+        ByteBuffer data;
+    };
+
     explicit Heap(DeprecatedString);
 
     ErrorOr<void> write_block(u32, ByteBuffer&);
@@ -99,7 +116,18 @@ private:
     void initialize_zero_block();
     void update_zero_block();
 
+    DeprecatedString log_file_name() const;
+    ErrorOr<void> open_log();
+    ErrorOr<void> recover_from_log();
+    ErrorOr<void> checkpoint();
+    ErrorOr<void> write_blocks(HashMap<u32, ByteBuffer>&);
+
+    ByteBuffer const* cached_block(u32);
+    ErrorOr<void> cache_block(u32, ByteBuffer const&);
+
     OwnPtr<Core::Stream::BufferedFile> m_file;
+    int m_file_descriptor { -1 };
+    OwnPtr<Core::Stream::File> m_log;
     u32 m_free_list { 0 };
     u32 m_next_block { 1 };
     u32 m_end_of_file { 1 };
@@ -108,7 +136,13 @@ private:
     u32 m_table_columns_root { 0 };
     u32 m_version { current_version };
     Array<u32, 16> m_user_values { 0 };
+    // Blocks that have been written since the last commit.
     HashMap<u32, ByteBuffer> m_write_ahead_log;
+    // Blocks that have been committed to the log, but not yet copied into the heap file.
+    HashMap<u32, ByteBuffer> m_logged_blocks;
+    HashMap<u32, NonnullOwnPtr<CachedBlock>> m_cached_blocks;
+    // Most recently used first.
+    IntrusiveList<&CachedBlock::list_node> m_cached_block_list;
 };
 
 }
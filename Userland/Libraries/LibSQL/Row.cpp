@@ -19,13 +19,13 @@ Row::Row(NonnullRefPtr<TableDef> table, u32 pointer)
 void Row::deserialize(Serializer& serializer)
 {
     Tuple::deserialize(serializer);
-    m_next_pointer = serializer.deserialize<u32>();
+    m_next_pointer = static_cast<u32>(serializer.deserialize_varint());
 }
 
 void Row::serialize(Serializer& serializer) const
 {
     Tuple::serialize(serializer);
-    serializer.serialize<u32>(next_pointer());
+    serializer.serialize_varint(next_pointer());
 }
 
 }
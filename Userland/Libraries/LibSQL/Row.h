@@ -34,7 +34,7 @@ public:
     TableDef const& table() const { return *m_table; }
     TableDef& table() { return *m_table; }
 
-    [[nodiscard]] virtual size_t length() const override { return Tuple::length() + sizeof(u32); }
+    [[nodiscard]] virtual size_t length() const override { return Tuple::length() + Serializer::varint_length(next_pointer()); }
     virtual void serialize(Serializer&) const override;
     virtual void deserialize(Serializer&) override;
 
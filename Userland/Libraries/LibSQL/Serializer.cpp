@@ -10,14 +10,14 @@ namespace SQL {
 
 void Serializer::serialize(DeprecatedString const& text)
 {
-    serialize<u32>((u32)text.length());
+    serialize_varint(text.length());
     if (!text.is_empty())
         write((u8 const*)text.characters(), text.length());
 }
 
 void Serializer::deserialize_to(DeprecatedString& text)
 {
-    auto length = deserialize<u32>();
+    auto length = deserialize_varint();
     if (length > 0) {
         text = DeprecatedString(reinterpret_cast<char const*>(read(length)), length);
     } else {
@@ -25,4 +25,35 @@ void Serializer::deserialize_to(DeprecatedString& text)
     }
 }
 
+void Serializer::serialize_varint(u64 value)
+{
+    while (value >= 0x80) {
+        serialize<u8>(static_cast<u8>(value | 0x80));
+        value >>= 7;
+    }
+    serialize<u8>(static_cast<u8>(value));
+}
+
+u64 Serializer::deserialize_varint()
+{
+    u64 value = 0;
+    for (size_t shift = 0;; shift += 7) {
+        VERIFY(shift < 64);
+        auto byte = deserialize<u8>();
+        value |= static_cast<u64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+}
+
+size_t Serializer::varint_length(u64 value)
+{
+    size_t length = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++length;
+    }
+    return length;
+}
+
 }
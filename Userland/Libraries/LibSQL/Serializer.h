@@ -107,6 +107,14 @@ public:
 
     void serialize(DeprecatedString const&);
 
+    // Lengths, counts and pointers are mostly small, so they are stored seven bits per byte, using as many bytes as needed.
+    void serialize_varint(u64);
+    u64 deserialize_varint();
+    static size_t varint_length(u64);
+
+    void serialize_bytes(ReadonlyBytes bytes) { write(bytes.data(), bytes.size()); }
+    ReadonlyBytes deserialize_bytes(size_t size) { return { read(size), size }; }
+
     template<typename T>
     bool serialize_and_write(T const& t)
     {
@@ -118,6 +126,7 @@ public:
     }
 
     [[nodiscard]] size_t offset() const { return m_current_offset; }
+    [[nodiscard]] ReadonlyBytes bytes() const { return m_buffer; }
     u32 new_record_pointer()
     {
         VERIFY(m_heap.ptr() != nullptr);
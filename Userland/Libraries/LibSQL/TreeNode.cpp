@@ -102,22 +102,35 @@ TreeNode::TreeNode(BTree& tree, TreeNode* up, TreeNode* left, u32 pointer)
     m_is_leaf = left->pointer() == 0;
 }
 
+// The keys of a node are sorted, so neighbouring keys tend to start with the same bytes. Every key only stores how many
+// bytes it shares with the one before it, followed by the bytes that differ.
 void TreeNode::deserialize(Serializer& serializer)
 {
-    auto nodes = serializer.deserialize<u32>();
+    auto nodes = serializer.deserialize_varint();
     dbgln_if(SQL_DEBUG, "Deserializing node. Size {}", nodes);
     if (nodes > 0) {
+        ByteBuffer key_bytes;
         for (u32 i = 0; i < nodes; i++) {
-            auto left = serializer.deserialize<u32>();
+            auto left = static_cast<u32>(serializer.deserialize_varint());
             dbgln_if(SQL_DEBUG, "Down[{}] {}", i, left);
             if (!m_down.is_empty())
                 VERIFY((left == 0) == m_is_leaf);
             else
                 m_is_leaf = (left == 0);
-            m_entries.append(serializer.deserialize<Key>(m_tree.descriptor()));
+
+            auto shared_length = serializer.deserialize_varint();
+            auto suffix_length = serializer.deserialize_varint();
+            VERIFY(shared_length <= key_bytes.size());
+            key_bytes.resize(shared_length);
+            key_bytes.append(serializer.deserialize_bytes(suffix_length));
+
+            Serializer key_serializer;
+            key_serializer.serialize_bytes(key_bytes);
+            key_serializer.rewind();
+            m_entries.append(key_serializer.deserialize<Key>(m_tree.descriptor()));
             m_down.empend(this, left);
         }
-        auto right = serializer.deserialize<u32>();
+        auto right = static_cast<u32>(serializer.deserialize_varint());
         dbgln_if(SQL_DEBUG, "Right {}", right);
         VERIFY((right == 0) == m_is_leaf);
         m_down.empend(this, right);
@@ -126,17 +139,27 @@ void TreeNode::deserialize(Serializer& serializer)
 
 void TreeNode::serialize(Serializer& serializer) const
 {
-    u32 sz = size();
-    serializer.serialize<u32>(sz);
-    if (sz > 0) {
+    serializer.serialize_varint(size());
+    if (size() > 0) {
+        ByteBuffer previous_key_bytes;
         for (auto ix = 0u; ix < size(); ix++) {
             auto& entry = m_entries[ix];
             dbgln_if(SQL_DEBUG, "Serializing Left[{}] = {}", ix, m_down[ix].pointer());
-            serializer.serialize<u32>(is_leaf() ? 0u : m_down[ix].pointer());
-            serializer.serialize<Key>(entry);
+            serializer.serialize_varint(is_leaf() ? 0u : m_down[ix].pointer());
+
+            Serializer key_serializer;
+            key_serializer.serialize<Key>(entry);
+            auto key_bytes = key_serializer.bytes();
+            size_t shared_length = 0;
+            while (shared_length < key_bytes.size() && shared_length < previous_key_bytes.size() && key_bytes[shared_length] == previous_key_bytes[shared_length])
+                shared_length++;
+            serializer.serialize_varint(shared_length);
+            serializer.serialize_varint(key_bytes.size() - shared_length);
+            serializer.serialize_bytes(key_bytes.slice(shared_length));
+            previous_key_bytes = MUST(ByteBuffer::copy(key_bytes));
         }
         dbgln_if(SQL_DEBUG, "Serializing Right = {}", m_down[size()].pointer());
-        serializer.serialize<u32>(is_leaf() ? 0u : m_down[size()].pointer());
+        serializer.serialize_varint(is_leaf() ? 0u : m_down[size()].pointer());
     }
 }
 
@@ -144,11 +167,10 @@ size_t TreeNode::length() const
 {
     if (!size())
         return 0;
-    size_t len = sizeof(u32);
-    for (auto& key : m_entries) {
-        len += sizeof(u32) + key.length();
-    }
-    return len;
+    // How much the keys shrink depends on their neighbours, so the only way to know is to encode them.
+    Serializer serializer;
+    serialize(serializer);
+    return serializer.offset();
 }
 
 bool TreeNode::insert(Key const& key)
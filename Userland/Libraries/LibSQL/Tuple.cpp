@@ -37,31 +37,51 @@ Tuple::Tuple(NonnullRefPtr<TupleDescriptor> const& descriptor, Serializer& seria
     deserialize(serializer);
 }
 
+// A tuple is stored as the number of values, a bitmap with a bit set for every null value, and the values that aren't
+// null. The descriptor isn't stored, as whoever reads the tuple back already has it. The pointer comes last, so that the
+// encodings of keys that start with the same values start with the same bytes.
 void Tuple::deserialize(Serializer& serializer)
 {
     dbgln_if(SQL_DEBUG, "deserialize tuple at offset {}", serializer.offset());
-    serializer.deserialize_to<u32>(m_pointer);
-    dbgln_if(SQL_DEBUG, "pointer: {}", m_pointer);
-    auto sz = serializer.deserialize<u32>();
+    auto sz = serializer.deserialize_varint();
+    // Without a descriptor, one is made up from the types of the values.
+    bool has_descriptor = !m_descriptor->is_empty();
+    VERIFY(!has_descriptor || m_descriptor->size() == sz);
+
+    auto null_bitmap = serializer.deserialize_bytes((sz + 7) / 8);
     m_data.clear();
-    m_descriptor->clear();
-    for (auto ix = 0u; ix < sz; ++ix) {
-        m_descriptor->append(serializer.deserialize<TupleElementDescriptor>());
-        m_data.append(serializer.deserialize<Value>());
+    for (auto ix = 0u; ix < sz; ix++) {
+        bool is_null = null_bitmap[ix / 8] & (1 << (ix % 8));
+        if (is_null)
+            m_data.empend(has_descriptor ? (*m_descriptor)[ix].type : SQLType::Null);
+        else
+            m_data.append(serializer.deserialize<Value>());
+        if (!has_descriptor)
+            m_descriptor->append(m_data.last().descriptor());
     }
+
+    m_pointer = static_cast<u32>(serializer.deserialize_varint());
+    dbgln_if(SQL_DEBUG, "pointer: {}", m_pointer);
 }
 
 void Tuple::serialize(Serializer& serializer) const
 {
     VERIFY(m_descriptor->size() == m_data.size());
     dbgln_if(SQL_DEBUG, "Serializing tuple pointer {}", pointer());
-    serializer.serialize<u32>(pointer());
-    serializer.serialize<u32>((u32)m_descriptor->size());
-    for (auto ix = 0u; ix < m_descriptor->size(); ix++) {
-        auto& key_part = m_data[ix];
-        serializer.serialize<TupleElementDescriptor>((*m_descriptor)[ix]);
-        serializer.serialize<Value>(key_part);
+    serializer.serialize_varint(m_data.size());
+    for (auto ix = 0u; ix < m_data.size(); ix += 8) {
+        u8 null_bits = 0;
+        for (auto bit = 0u; bit < 8 && ix + bit < m_data.size(); bit++) {
+            if (m_data[ix + bit].is_null())
+                null_bits |= 1 << bit;
+        }
+        serializer.serialize<u8>(null_bits);
+    }
+    for (auto& value : m_data) {
+        if (!value.is_null())
+            serializer.serialize<Value>(value);
     }
+    serializer.serialize_varint(pointer());
 }
 
 Tuple::Tuple(Tuple const& other)
@@ -151,12 +171,10 @@ bool Tuple::is_compatible(Tuple const& other) const
 
 size_t Tuple::length() const
 {
-    size_t len = 2 * sizeof(u32);
-    for (auto ix = 0u; ix < m_descriptor->size(); ix++) {
-        auto& descriptor = (*m_descriptor)[ix];
-        auto& value = m_data[ix];
-        len += descriptor.length();
-        len += value.length();
+    size_t len = Serializer::varint_length(m_data.size()) + (m_data.size() + 7) / 8 + Serializer::varint_length(pointer());
+    for (auto& value : m_data) {
+        if (!value.is_null())
+            len += value.length();
     }
     return len;
 }
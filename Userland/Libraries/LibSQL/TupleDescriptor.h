@@ -36,7 +36,7 @@ struct TupleElementDescriptor {
 
     size_t length() const
     {
-        return (sizeof(u32) + name.length()) + 2 * sizeof(u8);
+        return (Serializer::varint_length(name.length()) + name.length()) + 2 * sizeof(u8);
     }
 
     DeprecatedString to_deprecated_string() const
@@ -68,7 +68,7 @@ public:
 
     void serialize(Serializer& serializer) const
     {
-        serializer.serialize<u32>(size());
+        serializer.serialize_varint(size());
         for (auto& element : *this) {
             serializer.serialize<TupleElementDescriptor>(element);
         }
@@ -76,7 +76,7 @@ public:
 
     void deserialize(Serializer& serializer)
     {
-        auto sz = serializer.deserialize<u32>();
+        auto sz = serializer.deserialize_varint();
         for (auto ix = 0u; ix < sz; ix++) {
             append(serializer.deserialize<TupleElementDescriptor>());
         }
@@ -84,7 +84,7 @@ public:
 
     size_t length() const
     {
-        size_t len = sizeof(u32);
+        size_t len = Serializer::varint_length(size());
         for (auto& element : *this) {
             len += element.length();
         }
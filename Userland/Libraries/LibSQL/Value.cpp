@@ -346,12 +346,13 @@ ResultOr<void> Value::assign_tuple(Vector<Value> values)
 
 size_t Value::length() const
 {
+    // The type flags come first, and are all there is to a null value.
     if (is_null())
-        return 0;
+        return sizeof(u8);
 
     // FIXME: This seems to be more of an encoded byte size rather than a length.
-    return m_value->visit(
-        [](DeprecatedString const& value) -> size_t { return sizeof(u32) + value.length(); },
+    auto data_length = m_value->visit(
+        [](DeprecatedString const& value) -> size_t { return Serializer::varint_length(value.length()) + value.length(); },
         [](Integer auto value) -> size_t {
             return downsize_integer(value, [](auto integer, auto) {
                 return sizeof(integer);
@@ -360,13 +361,14 @@ size_t Value::length() const
         [](double value) -> size_t { return sizeof(value); },
         [](bool value) -> size_t { return sizeof(value); },
         [](TupleValue const& value) -> size_t {
-            auto size = value.descriptor->length() + sizeof(u32);
+            auto size = value.descriptor->length() + Serializer::varint_length(value.values.size());
 
             for (auto const& element : value.values)
                 size += element.length();
 
             return size;
         });
+    return sizeof(u8) + data_length;
 }
 
 u32 Value::hash() const
@@ -717,7 +719,7 @@ void Value::serialize(Serializer& serializer) const
     m_value->visit(
         [&](TupleValue const& value) {
             serializer.serialize<TupleDescriptor>(*value.descriptor);
-            serializer.serialize(static_cast<u32>(value.values.size()));
+            serializer.serialize_varint(value.values.size());
 
             for (auto const& element : value.values)
                 serializer.serialize<Value>(element);
@@ -781,7 +783,7 @@ void Value::deserialize(Serializer& serializer)
         break;
     case SQLType::Tuple: {
         auto descriptor = serializer.adopt_and_deserialize<TupleDescriptor>();
-        auto size = serializer.deserialize<u32>();
+        auto size = serializer.deserialize_varint();
 
         Vector<Value> values;
         values.ensure_capacity(size);
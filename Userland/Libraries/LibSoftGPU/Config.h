@@ -24,6 +24,11 @@ static constexpr int MAX_TEXTURE_SIZE = 2048;
 static constexpr float MAX_TEXTURE_LOD_BIAS = 2.f;
 static constexpr int SUBPIXEL_BITS = 4;
 
+// Triangles are rasterized in parallel in horizontal bands of at least this many rows, a few bands per thread
+static constexpr int MIN_RASTERIZATION_BAND_HEIGHT = 16;
+static constexpr int RASTERIZATION_BANDS_PER_THREAD = 4;
+static constexpr i64 MIN_PIXELS_FOR_PARALLEL_RASTERIZATION = 128 * 128;
+
 static constexpr int NUM_SHADER_INPUTS = 64;
 
 // Verify that we have enough inputs to hold vertex color and texture coordinates for all fixed function texture units
@@ -25,6 +25,7 @@
 #include <LibSoftGPU/SIMD.h>
 #include <LibSoftGPU/Shader.h>
 #include <LibSoftGPU/ShaderCompiler.h>
+#include <LibThreading/ThreadPool.h>
 #include <math.h>
 
 namespace SoftGPU {
@@ -174,7 +175,7 @@ ALWAYS_INLINE static Vector4<f32x4> get_blend_factor(GPU::BlendFactor blend_fact
 }
 
 template<typename CB1, typename CB2, typename CB3>
-ALWAYS_INLINE void Device::rasterize(Gfx::IntRect& render_bounds, CB1 set_coverage_mask, CB2 set_quad_depth, CB3 set_quad_attributes)
+ALWAYS_INLINE void Device::rasterize(Gfx::IntRect& render_bounds, ShaderProcessor& shader_processor, CB1 set_coverage_mask, CB2 set_quad_depth, CB3 set_quad_attributes)
 {
     // Return if alpha testing is a no-op
     if (m_options.enable_alpha_test && m_options.alpha_test_func == GPU::AlphaTestFunction::Never)
@@ -405,7 +406,7 @@ ALWAYS_INLINE void Device::rasterize(Gfx::IntRect& render_bounds, CB1 set_covera
             INCREASE_STATISTICS_COUNTER(g_num_pixels_shaded, maskcount(quad.mask));
 
             set_quad_attributes(quad);
-            shade_fragments(quad);
+            shade_fragments(quad, shader_processor);
 
             // Alpha testing
             if (m_options.enable_alpha_test) {
@@ -497,6 +498,7 @@ void Device::rasterize_line_antialiased(GPU::Vertex& from, GPU::Vertex& to)
     f32x4 distance_along_line;
     rasterize(
         render_bounds,
+        m_shader_processor,
         [&from_coords4, &distance_along_line, &line_vector4, &line_dot4, &line_radius](auto& quad) {
             auto const screen_coordinates4 = to_vec2_f32x4(quad.screen_coordinates);
             auto const pixel_vector = screen_coordinates4 - from_coords4;
@@ -553,6 +555,7 @@ void Device::rasterize_point_aliased(GPU::Vertex& point)
     // Rasterize the point as a rect
     rasterize(
         point_rect,
+        m_shader_processor,
         [](auto& quad) {
             // We already passed in point_rect, so this doesn't matter
             quad.mask = expand4(~0);
@@ -585,6 +588,7 @@ void Device::rasterize_point_antialiased(GPU::Vertex& point)
     // Rasterize using a 2D signed distance field for a circle
     rasterize(
         render_bounds,
+        m_shader_processor,
         [&center4, &radius](auto& quad) {
             auto screen_coords = to_vec2_f32x4(quad.screen_coordinates);
             auto distance_to_point = length(center4 - screen_coords) - radius;
@@ -613,35 +617,64 @@ void Device::rasterize_point(GPU::Vertex& point)
         rasterize_point_aliased(point);
 }
 
-void Device::rasterize_triangle(Triangle& triangle)
+static ALWAYS_INLINE Array<IntVector2, 3> subpixel_coordinates(Triangle const& triangle)
 {
-    INCREASE_STATISTICS_COUNTER(g_num_rasterized_triangles, 1);
+    return {
+        (triangle.vertices[0].window_coordinates.xy() * subpixel_factor).to_rounded<int>(),
+        (triangle.vertices[1].window_coordinates.xy() * subpixel_factor).to_rounded<int>(),
+        (triangle.vertices[2].window_coordinates.xy() * subpixel_factor).to_rounded<int>(),
+    };
+}
 
-    auto v0 = (triangle.vertices[0].window_coordinates.xy() * subpixel_factor).to_rounded<int>();
-    auto v1 = (triangle.vertices[1].window_coordinates.xy() * subpixel_factor).to_rounded<int>();
-    auto v2 = (triangle.vertices[2].window_coordinates.xy() * subpixel_factor).to_rounded<int>();
+static ALWAYS_INLINE Gfx::IntRect triangle_render_bounds(IntVector2 v0, IntVector2 v1, IntVector2 v2)
+{
+    Gfx::IntRect render_bounds;
+    render_bounds.set_left(min(min(v0.x(), v1.x()), v2.x()) / subpixel_factor);
+    render_bounds.set_right(max(max(v0.x(), v1.x()), v2.x()) / subpixel_factor);
+    render_bounds.set_top(min(min(v0.y(), v1.y()), v2.y()) / subpixel_factor);
+    render_bounds.set_bottom(max(max(v0.y(), v1.y()), v2.y()) / subpixel_factor);
+    return render_bounds;
+}
+
+bool Device::set_up_triangle(Triangle& triangle)
+{
+    auto const coordinates = subpixel_coordinates(triangle);
+    auto v0 = coordinates[0];
+    auto v1 = coordinates[1];
+    auto v2 = coordinates[2];
 
     auto triangle_area = edge_function(v0, v1, v2);
     if (triangle_area == 0)
-        return;
+        return false;
 
     // Perform face culling
     if (m_options.enable_culling) {
         bool is_front = (m_options.front_face == GPU::WindingOrder::CounterClockwise ? triangle_area > 0 : triangle_area < 0);
 
         if (!is_front && m_options.cull_back)
-            return;
+            return false;
 
         if (is_front && m_options.cull_front)
-            return;
+            return false;
     }
 
     // Force counter-clockwise ordering of vertices
-    if (triangle_area < 0) {
+    if (triangle_area < 0)
         swap(triangle.vertices[0], triangle.vertices[1]);
-        swap(v0, v1);
-        triangle_area *= -1;
-    }
+
+    return true;
+}
+
+void Device::rasterize_triangle(Triangle const& triangle, Gfx::IntRect const& clip_rect, ShaderProcessor& shader_processor)
+{
+    INCREASE_STATISTICS_COUNTER(g_num_rasterized_triangles, 1);
+
+    auto const coordinates = subpixel_coordinates(triangle);
+    auto v0 = coordinates[0];
+    auto v1 = coordinates[1];
+    auto v2 = coordinates[2];
+    auto triangle_area = edge_function(v0, v1, v2);
+    VERIFY(triangle_area > 0);
 
     auto const& vertex0 = triangle.vertices[0];
     auto const& vertex1 = triangle.vertices[1];
@@ -676,11 +709,7 @@ void Device::rasterize_triangle(Triangle& triangle)
     };
 
     // Calculate render bounds based on the triangle's vertices
-    Gfx::IntRect render_bounds;
-    render_bounds.set_left(min(min(v0.x(), v1.x()), v2.x()) / subpixel_factor);
-    render_bounds.set_right(max(max(v0.x(), v1.x()), v2.x()) / subpixel_factor);
-    render_bounds.set_top(min(min(v0.y(), v1.y()), v2.y()) / subpixel_factor);
-    render_bounds.set_bottom(max(max(v0.y(), v1.y()), v2.y()) / subpixel_factor);
+    auto render_bounds = triangle_render_bounds(v0, v1, v2);
 
     // Calculate depth of fragment for fog;
     // OpenGL 1.5 chapter 3.10: "An implementation may choose to approximate the
@@ -723,8 +752,12 @@ void Device::rasterize_triangle(Triangle& triangle)
         expand4(vertex2.window_coordinates.z() + depth_offset),
     };
 
+    // The depth offset above depends on the triangle's full bounds, so only now limit them to the part we're drawing
+    render_bounds.intersect(clip_rect);
+
     rasterize(
         render_bounds,
+        shader_processor,
         [&](auto& quad) {
             auto edge_values = calculate_edge_values4(quad.screen_coordinates * subpixel_factor + half_pixel_offset);
             quad.mask = test_point4(edge_values);
@@ -967,6 +1000,29 @@ void Device::draw_primitives(GPU::PrimitiveType primitive_type, FloatMatrix4x4 c
     if (vertices.is_empty())
         return;
 
+    transform_vertices(model_view_transform, projection_transform, vertices);
+    rasterize_primitives(primitive_type, vertices);
+}
+
+void Device::draw_indexed_primitives(GPU::PrimitiveType primitive_type, FloatMatrix4x4 const& model_view_transform, FloatMatrix4x4 const& projection_transform, Vector<GPU::Vertex>& vertices, Vector<u32> const& indices)
+{
+    if (indices.is_empty())
+        return;
+
+    // Vertices that are shared between primitives are only transformed once; the primitives then get their own copies,
+    // since clipping and rasterization modify them.
+    transform_vertices(model_view_transform, projection_transform, vertices);
+
+    m_indexed_vertices.clear_with_capacity();
+    m_indexed_vertices.ensure_capacity(indices.size());
+    for (auto index : indices)
+        m_indexed_vertices.unchecked_append(vertices[index]);
+
+    rasterize_primitives(primitive_type, m_indexed_vertices);
+}
+
+void Device::transform_vertices(FloatMatrix4x4 const& model_view_transform, FloatMatrix4x4 const& projection_transform, Vector<GPU::Vertex>& vertices) const
+{
     // Set up normals transform by taking the upper left 3x3 elements from the model view matrix
     // See section 2.11.3 of the OpenGL 1.5 spec
     auto const normal_transform = model_view_transform.submatrix_from_topleft<3>().transpose().inverse();
@@ -991,7 +1047,10 @@ void Device::draw_primitives(GPU::PrimitiveType primitive_type, FloatMatrix4x4 c
             vertex.tex_coords[i] = texture_unit_configuration.transformation_matrix * vertex.tex_coords[i];
         }
     }
+}
 
+void Device::rasterize_primitives(GPU::PrimitiveType primitive_type, Vector<GPU::Vertex>& vertices)
+{
     // Window coordinate calculation
     auto const viewport = m_options.viewport;
     auto const viewport_half_width = viewport.width() / 2.f;
@@ -1135,18 +1194,82 @@ void Device::draw_primitives(GPU::PrimitiveType primitive_type, FloatMatrix4x4 c
         for (size_t i = 1; i < m_clipped_vertices.size() - 1; i++) {
             tri.vertices[1] = m_clipped_vertices[i];
             tri.vertices[2] = m_clipped_vertices[i + 1];
-            m_processed_triangles.append(tri);
+            if (set_up_triangle(tri))
+                m_processed_triangles.append(tri);
         }
     }
 
-    for (auto& triangle : m_processed_triangles)
-        rasterize_triangle(triangle);
+    rasterize_triangles();
+}
+
+void Device::rasterize_triangles()
+{
+    if (m_processed_triangles.is_empty())
+        return;
+
+    auto const framebuffer_rect = m_frame_buffer->rect();
+
+    // Rasterizing a handful of small triangles isn't worth waking up other threads for. The statistics counters are not
+    // synchronized, so with the overlay enabled everything is drawn on this thread as well.
+    i64 covered_pixels = 0;
+    for (auto const& triangle : m_processed_triangles) {
+        auto coordinates = subpixel_coordinates(triangle);
+        auto render_bounds = triangle_render_bounds(coordinates[0], coordinates[1], coordinates[2]).intersected(framebuffer_rect);
+        covered_pixels += static_cast<i64>(render_bounds.width()) * render_bounds.height();
+    }
+    auto band_count = ceil_div(framebuffer_rect.height(), MIN_RASTERIZATION_BAND_HEIGHT);
+    if (ENABLE_STATISTICS_OVERLAY || band_count <= 1 || covered_pixels < MIN_PIXELS_FOR_PARALLEL_RASTERIZATION) {
+        for (auto const& triangle : m_processed_triangles)
+            rasterize_triangle(triangle, framebuffer_rect, m_shader_processor);
+        return;
+    }
+
+    // Note: The thread pool starts its workers the first time it is used, so only get it once the triangles are known to
+    //       be drawn in parallel.
+    auto& thread_pool = Threading::ThreadPool::the();
+    band_count = min(band_count, static_cast<int>(thread_pool.worker_count() + 1) * RASTERIZATION_BANDS_PER_THREAD);
+
+    // Each band is a run of whole rows that only one thread draws to, so no two threads ever touch the same pixel. Bands
+    // start on an even row since pixels are drawn in 2x2 quads. Within a band the triangles are drawn in the order they
+    // were submitted, which gives the exact same result as drawing them one by one.
+    auto band_height = static_cast<int>(align_up_to(ceil_div(framebuffer_rect.height(), band_count), 2));
+    band_count = ceil_div(framebuffer_rect.height(), band_height);
+
+    m_band_triangles.resize(band_count);
+    for (auto& triangles : m_band_triangles)
+        triangles.clear_with_capacity();
+    while (m_band_shader_processors.size() < static_cast<size_t>(band_count))
+        m_band_shader_processors.append(make<ShaderProcessor>(m_samplers));
+
+    for (size_t i = 0; i < m_processed_triangles.size(); ++i) {
+        auto coordinates = subpixel_coordinates(m_processed_triangles[i]);
+        auto render_bounds = triangle_render_bounds(coordinates[0], coordinates[1], coordinates[2]).intersected(framebuffer_rect);
+        if (render_bounds.is_empty())
+            continue;
+        auto first_band = (render_bounds.top() - framebuffer_rect.top()) / band_height;
+        auto last_band = (render_bounds.bottom() - framebuffer_rect.top()) / band_height;
+        for (auto band = first_band; band <= last_band; ++band)
+            m_band_triangles[band].append(i);
+    }
+
+    thread_pool.parallel_for(band_count, 1, [&](size_t begin, size_t end) {
+        for (size_t band = begin; band < end; ++band) {
+            auto band_rect = Gfx::IntRect {
+                framebuffer_rect.left(),
+                framebuffer_rect.top() + static_cast<int>(band) * band_height,
+                framebuffer_rect.width(),
+                band_height,
+            };
+            for (auto index : m_band_triangles[band])
+                rasterize_triangle(m_processed_triangles[index], band_rect, *m_band_shader_processors[band]);
+        }
+    });
 }
 
-ALWAYS_INLINE void Device::shade_fragments(PixelQuad& quad)
+ALWAYS_INLINE void Device::shade_fragments(PixelQuad& quad, ShaderProcessor& shader_processor)
 {
     if (m_current_fragment_shader) {
-        m_shader_processor.execute(quad, *m_current_fragment_shader);
+        shader_processor.execute(quad, *m_current_fragment_shader);
         return;
     }
 
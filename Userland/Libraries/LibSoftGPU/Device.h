@@ -8,6 +8,7 @@
 #pragma once
 
 #include <AK/Array.h>
+#include <AK/NonnullOwnPtr.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/RefPtr.h>
 #include <AK/Vector.h>
@@ -49,6 +50,7 @@ public:
     virtual GPU::DeviceInfo info() const override;
 
     virtual void draw_primitives(GPU::PrimitiveType, FloatMatrix4x4 const& model_view_transform, FloatMatrix4x4 const& projection_transform, Vector<GPU::Vertex>& vertices) override;
+    virtual void draw_indexed_primitives(GPU::PrimitiveType, FloatMatrix4x4 const& model_view_transform, FloatMatrix4x4 const& projection_transform, Vector<GPU::Vertex>& vertices, Vector<u32> const& indices) override;
     virtual void resize(Gfx::IntSize min_size) override;
     virtual void clear_color(FloatVector4 const&) override;
     virtual void clear_depth(GPU::DepthType) override;
@@ -83,6 +85,8 @@ public:
 
 private:
     void calculate_vertex_lighting(GPU::Vertex& vertex) const;
+    void transform_vertices(FloatMatrix4x4 const& model_view_transform, FloatMatrix4x4 const& projection_transform, Vector<GPU::Vertex>& vertices) const;
+    void rasterize_primitives(GPU::PrimitiveType, Vector<GPU::Vertex>& vertices);
     void draw_statistics_overlay(Gfx::Bitmap&);
     Gfx::IntRect get_rasterization_rect_of_size(Gfx::IntSize size) const;
 
@@ -90,7 +94,7 @@ private:
     GPU::ImageDataLayout depth_buffer_data_layout(Vector2<u32> size, Vector2<i32> offset);
 
     template<typename CB1, typename CB2, typename CB3>
-    void rasterize(Gfx::IntRect& render_bounds, CB1 set_coverage_mask, CB2 set_quad_depth, CB3 set_quad_attributes);
+    void rasterize(Gfx::IntRect& render_bounds, ShaderProcessor&, CB1 set_coverage_mask, CB2 set_quad_depth, CB3 set_quad_attributes);
 
     void rasterize_line_aliased(GPU::Vertex&, GPU::Vertex&);
     void rasterize_line_antialiased(GPU::Vertex&, GPU::Vertex&);
@@ -100,8 +104,10 @@ private:
     void rasterize_point_antialiased(GPU::Vertex&);
     void rasterize_point(GPU::Vertex&);
 
-    void rasterize_triangle(Triangle&);
-    void shade_fragments(PixelQuad&);
+    bool set_up_triangle(Triangle&);
+    void rasterize_triangle(Triangle const&, Gfx::IntRect const& clip_rect, ShaderProcessor&);
+    void rasterize_triangles();
+    void shade_fragments(PixelQuad&, ShaderProcessor&);
 
     RefPtr<FrameBuffer<GPU::ColorType, GPU::DepthType, GPU::StencilType>> m_frame_buffer {};
     GPU::RasterizerOptions m_options;
@@ -110,6 +116,7 @@ private:
     Vector<Triangle> m_triangle_list;
     Vector<Triangle> m_processed_triangles;
     Vector<GPU::Vertex> m_clipped_vertices;
+    Vector<GPU::Vertex> m_indexed_vertices;
     Array<Sampler, GPU::NUM_TEXTURE_UNITS> m_samplers;
     bool m_samplers_need_texture_staging { false };
     Array<GPU::Light, NUM_LIGHTS> m_lights;
@@ -120,6 +127,9 @@ private:
     Array<GPU::TextureUnitConfiguration, GPU::NUM_TEXTURE_UNITS> m_texture_unit_configuration;
     RefPtr<Shader> m_current_fragment_shader;
     ShaderProcessor m_shader_processor;
+    // Triangles are drawn in horizontal bands of the framebuffer in parallel, each with its own shader processor.
+    Vector<NonnullOwnPtr<ShaderProcessor>> m_band_shader_processors;
+    Vector<Vector<size_t>> m_band_triangles;
 };
 
 }
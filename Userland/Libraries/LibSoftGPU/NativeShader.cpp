@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Platform.h>
+#include <LibSoftGPU/NativeShader.h>
+#include <LibSoftGPU/ShaderProcessor.h>
+#include <sys/mman.h>
+
+namespace SoftGPU {
+
+using AK::SIMD::f32x4;
+
+#if ARCH(X86_64)
+
+namespace {
+
+// Just enough of an x86_64 assembler to move f32x4 values between memory and SSE registers and do arithmetic on them.
+class Assembler {
+public:
+    enum class Reg : u8 {
+        RAX = 0,
+        RCX = 1,
+        RDX = 2,
+        RBX = 3,
+        RBP = 5,
+        RSI = 6,
+        RDI = 7,
+        R12 = 12,
+        R13 = 13,
+        R14 = 14,
+    };
+
+    enum class VectorOperation : u8 {
+        Add = 0x58,
+        Mul = 0x59,
+        Sub = 0x5c,
+        Div = 0x5e,
+    };
+
+    explicit Assembler(Vector<u8>& output)
+        : m_output(output)
+    {
+    }
+
+    // mov dst, imm64
+    void mov(Reg dst, u64 immediate)
+    {
+        emit_rex(true, 0, to_underlying(dst));
+        emit8(0xb8 | (to_underlying(dst) & 7));
+        emit64(immediate);
+    }
+
+    // mov dst, src
+    void mov(Reg dst, Reg src)
+    {
+        emit_rex(true, to_underlying(src), to_underlying(dst));
+        emit8(0x89);
+        emit8(0xc0 | ((to_underlying(src) & 7) << 3) | (to_underlying(dst) & 7));
+    }
+
+    // movups xmm, [base + offset]
+    void load_vector(u8 xmm, Reg base, i32 offset) { emit_vector_memory(0x10, xmm, base, offset); }
+
+    // movups [base + offset], xmm
+    void store_vector(Reg base, i32 offset, u8 xmm) { emit_vector_memory(0x11, xmm, base, offset); }
+
+    // addps/subps/mulps/divps xmm, [base + offset]
+    void vector_operation(VectorOperation operation, u8 xmm, Reg base, i32 offset) { emit_vector_memory(to_underlying(operation), xmm, base, offset); }
+
+    void push(Reg reg)
+    {
+        emit_rex(false, 0, to_underlying(reg));
+        emit8(0x50 | (to_underlying(reg) & 7));
+    }
+
+    void pop(Reg reg)
+    {
+        emit_rex(false, 0, to_underlying(reg));
+        emit8(0x58 | (to_underlying(reg) & 7));
+    }
+
+    void call(Reg reg)
+    {
+        emit_rex(false, 0, to_underlying(reg));
+        emit8(0xff);
+        emit8(0xd0 | (to_underlying(reg) & 7));
+    }
+
+    void ret() { emit8(0xc3); }
+
+private:
+    void emit8(u8 value) { m_output.append(value); }
+
+    void emit32(u32 value)
+    {
+        for (size_t i = 0; i < 4; ++i)
+            emit8(static_cast<u8>(value >> (i * 8)));
+    }
+
+    void emit64(u64 value)
+    {
+        for (size_t i = 0; i < 8; ++i)
+            emit8(static_cast<u8>(value >> (i * 8)));
+    }
+
+    // Note: Only emits a REX prefix when it's actually needed, i.e. for 64-bit operands or extended registers.
+    void emit_rex(bool wide, u8 reg, u8 base)
+    {
+        u8 rex = 0x40 | (wide ? 8 : 0) | ((reg & 8) >> 1) | ((base & 8) >> 3);
+        if (rex != 0x40)
+            emit8(rex);
+    }
+
+    void emit_vector_memory(u8 opcode, u8 xmm, Reg base, i32 offset)
+    {
+        emit_rex(false, xmm, to_underlying(base));
+        emit8(0x0f);
+        emit8(opcode);
+        emit8(0x80 | ((xmm & 7) << 3) | (to_underlying(base) & 7));
+        // Note: RSP and R12 can only be used as a base through a SIB byte.
+        if ((to_underlying(base) & 7) == 4)
+            emit8(0x24);
+        emit32(static_cast<u32>(offset));
+    }
+
+    Vector<u8>& m_output;
+};
+
+using Reg = Assembler::Reg;
+
+// NOTE: These live in callee-saved registers, so they survive calls into C++.
+static constexpr Reg PROCESSOR = Reg::R12;
+static constexpr Reg REGISTERS = Reg::RBX;
+static constexpr Reg INPUTS = Reg::R13;
+static constexpr Reg OUTPUTS = Reg::R14;
+
+static constexpr i32 offset_of(u16 index) { return static_cast<i32>(index * sizeof(f32x4)); }
+
+}
+
+static void compile_instructions(Assembler& assembler, Vector<Instruction> const& instructions, void (*sample_2d)(ShaderProcessor&, Instruction::Arguments const&))
+{
+    // NOTE: Pushing five registers on top of the return address keeps the stack 16-byte aligned for calls.
+    assembler.push(Reg::RBP);
+    assembler.push(REGISTERS);
+    assembler.push(PROCESSOR);
+    assembler.push(INPUTS);
+    assembler.push(OUTPUTS);
+    assembler.mov(PROCESSOR, Reg::RDI);
+    assembler.mov(REGISTERS, Reg::RSI);
+    assembler.mov(INPUTS, Reg::RDX);
+    assembler.mov(OUTPUTS, Reg::RCX);
+
+    auto binop = [&](Assembler::VectorOperation operation, Instruction::Arguments const& arguments) {
+        for (u16 i = 0; i < 4; ++i) {
+            assembler.load_vector(0, REGISTERS, offset_of(arguments.binop.source_register1 + i));
+            assembler.vector_operation(operation, 0, REGISTERS, offset_of(arguments.binop.source_register2 + i));
+            assembler.store_vector(REGISTERS, offset_of(arguments.binop.target_register + i), 0);
+        }
+    };
+
+    for (auto const& instruction : instructions) {
+        auto const& arguments = instruction.arguments;
+        switch (instruction.operation) {
+        case Opcode::Input:
+            for (u16 i = 0; i < 4; ++i) {
+                assembler.load_vector(0, INPUTS, offset_of(arguments.input.input_index + i));
+                assembler.store_vector(REGISTERS, offset_of(arguments.input.target_register + i), 0);
+            }
+            break;
+        case Opcode::Output:
+            for (u16 i = 0; i < 4; ++i) {
+                assembler.load_vector(0, REGISTERS, offset_of(arguments.output.source_register + i));
+                assembler.store_vector(OUTPUTS, offset_of(arguments.output.output_index + i), 0);
+            }
+            break;
+        case Opcode::Sample2D:
+            assembler.mov(Reg::RDI, PROCESSOR);
+            assembler.mov(Reg::RSI, bit_cast<u64>(&arguments));
+            assembler.mov(Reg::RAX, bit_cast<u64>(sample_2d));
+            assembler.call(Reg::RAX);
+            break;
+        case Opcode::Swizzle:
+            // All sources are read before anything is written, as the target may overlap them.
+            for (u8 i = 0; i < 4; ++i)
+                assembler.load_vector(i, REGISTERS, offset_of(arguments.swizzle.source_register + i));
+            for (u8 i = 0; i < 4; ++i)
+                assembler.store_vector(REGISTERS, offset_of(arguments.swizzle.target_register + i), swizzle_index(arguments.swizzle.pattern, i));
+            break;
+        case Opcode::Add:
+            binop(Assembler::VectorOperation::Add, arguments);
+            break;
+        case Opcode::Sub:
+            binop(Assembler::VectorOperation::Sub, arguments);
+            break;
+        case Opcode::Mul:
+            binop(Assembler::VectorOperation::Mul, arguments);
+            break;
+        case Opcode::Div:
+            binop(Assembler::VectorOperation::Div, arguments);
+            break;
+        default:
+            VERIFY_NOT_REACHED();
+        }
+    }
+
+    assembler.pop(OUTPUTS);
+    assembler.pop(INPUTS);
+    assembler.pop(PROCESSOR);
+    assembler.pop(REGISTERS);
+    assembler.pop(Reg::RBP);
+    assembler.ret();
+}
+
+#endif
+
+OwnPtr<NativeShader> NativeShader::try_compile([[maybe_unused]] Vector<Instruction> const& instructions)
+{
+#if ARCH(X86_64)
+    Vector<u8> code;
+    Assembler assembler(code);
+    compile_instructions(assembler, instructions, sample_2d);
+
+    // NOTE: The code is never writable and executable at the same time: it's written into a fresh mapping first,
+    //       which is then made executable (and read-only) once and for all.
+    auto* memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return nullptr;
+    __builtin_memcpy(memory, code.data(), code.size());
+
+    // NOTE: This is always going to fail for programs that aren't allowed to make memory executable, in which case we
+    //       simply keep on interpreting.
+    if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) < 0) {
+        munmap(memory, code.size());
+        return nullptr;
+    }
+
+    auto* native_shader = new (nothrow) NativeShader(static_cast<u8*>(memory), code.size());
+    if (!native_shader) {
+        munmap(memory, code.size());
+        return nullptr;
+    }
+    return adopt_own(*native_shader);
+#else
+    return nullptr;
+#endif
+}
+
+NativeShader::NativeShader(u8* code, size_t size)
+    : m_code(code)
+    , m_size(size)
+{
+}
+
+NativeShader::~NativeShader()
+{
+    munmap(m_code, m_size);
+}
+
+void NativeShader::run(ShaderProcessor& processor, PixelQuad& quad) const
+{
+    auto entry = reinterpret_cast<Entry>(m_code);
+    entry(&processor, processor.m_registers, quad.inputs.data(), quad.outputs.data());
+}
+
+void NativeShader::sample_2d(ShaderProcessor& processor, Instruction::Arguments const& arguments)
+{
+    processor.op_sample2d(arguments);
+}
+
+}
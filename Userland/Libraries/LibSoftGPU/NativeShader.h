@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Noncopyable.h>
+#include <AK/OwnPtr.h>
+#include <AK/SIMD.h>
+#include <AK/Vector.h>
+#include <LibSoftGPU/ISA.h>
+#include <LibSoftGPU/PixelQuad.h>
+
+namespace SoftGPU {
+
+class ShaderProcessor;
+
+// A shader's instructions compiled to x86_64 SSE code, so that running it doesn't have to decode and dispatch every
+// instruction again for every pixel quad. Running it has the same effect as ShaderProcessor::execute().
+class NativeShader {
+    AK_MAKE_NONCOPYABLE(NativeShader);
+    AK_MAKE_NONMOVABLE(NativeShader);
+
+public:
+    // NOTE: Returns nullptr if the instructions can't be compiled on this architecture or the code can't be made
+    //       executable, in which case the shader is interpreted instead. The instructions have to outlive the result.
+    static OwnPtr<NativeShader> try_compile(Vector<Instruction> const&);
+    ~NativeShader();
+
+    void run(ShaderProcessor&, PixelQuad&) const;
+
+private:
+    using Entry = void (*)(ShaderProcessor*, AK::SIMD::f32x4* registers, AK::SIMD::f32x4 const* inputs, AK::SIMD::f32x4* outputs);
+
+    NativeShader(u8* code, size_t size);
+
+    static void sample_2d(ShaderProcessor&, Instruction::Arguments const&);
+
+    u8* m_code { nullptr };
+    size_t m_size { 0 };
+};
+
+}
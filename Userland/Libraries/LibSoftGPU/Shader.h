@@ -6,9 +6,11 @@
 
 #pragma once
 
+#include <AK/OwnPtr.h>
 #include <AK/Vector.h>
 #include <LibGPU/Shader.h>
 #include <LibSoftGPU/ISA.h>
+#include <LibSoftGPU/NativeShader.h>
 
 namespace SoftGPU {
 
@@ -17,9 +19,11 @@ public:
     Shader(void const* ownership_token, Vector<Instruction> const&);
 
     Vector<Instruction> const& instructions() const { return m_instructions; }
+    NativeShader const* native_shader() const { return m_native_shader.ptr(); }
 
 private:
     Vector<Instruction> m_instructions;
+    OwnPtr<NativeShader> m_native_shader;
 };
 
 }
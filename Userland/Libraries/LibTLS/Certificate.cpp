@@ -10,6 +10,7 @@
 #include <LibCrypto/ASN1/ASN1.h>
 #include <LibCrypto/ASN1/DER.h>
 #include <LibCrypto/ASN1/PEM.h>
+#include <LibCrypto/Hash/SHA2.h>
 
 namespace TLS {
 
@@ -99,6 +100,12 @@ Optional<Certificate> Certificate::parse_asn1(ReadonlyBytes buffer, bool)
         return {};
     certificate.original_asn1 = copy_buffer_result.release_value();
 
+    auto fingerprint = Crypto::Hash::SHA256::hash(buffer.data(), buffer.size());
+    auto fingerprint_result = ByteBuffer::copy(fingerprint.immutable_data(), fingerprint.data_length());
+    if (fingerprint_result.is_error())
+        return {};
+    certificate.fingerprint = fingerprint_result.release_value();
+
     Crypto::ASN1::Decoder decoder { buffer };
     // Certificate ::= Sequence {
     //     certificate          TBSCertificate,
@@ -537,4 +544,56 @@ Optional<Certificate> Certificate::parse_asn1(ReadonlyBytes buffer, bool)
 #undef READ_OBJECT_OR_FAIL
 }
 
+Singleton<CertificateCache> CertificateCache::s_the;
+
+Optional<Certificate> CertificateCache::parse(ReadonlyBytes der)
+{
+    auto digest = Crypto::Hash::SHA256::hash(der.data(), der.size());
+    auto fingerprint = ByteBuffer::copy(digest.immutable_data(), digest.data_length());
+    if (fingerprint.is_error())
+        return Certificate::parse_asn1(der);
+
+    if (auto certificate = m_certificates.get(fingerprint.value()); certificate.has_value())
+        return *certificate;
+
+    auto certificate = Certificate::parse_asn1(der);
+    if (!certificate.has_value())
+        return {};
+
+    // Servers keep sending the same handful of chains, so rather than tracking what is used least we start over
+    // once the cache is full.
+    if (m_certificates.size() >= max_entries)
+        m_certificates.clear();
+    (void)m_certificates.try_set(fingerprint.release_value(), *certificate);
+    return certificate;
+}
+
+static Optional<ByteBuffer> signature_key(Certificate const& subject, Certificate const& issuer)
+{
+    if (subject.fingerprint.is_empty() || issuer.fingerprint.is_empty())
+        return {};
+    auto key = ByteBuffer::create_uninitialized(subject.fingerprint.size() + issuer.fingerprint.size());
+    if (key.is_error())
+        return {};
+    key.value().overwrite(0, subject.fingerprint.data(), subject.fingerprint.size());
+    key.value().overwrite(subject.fingerprint.size(), issuer.fingerprint.data(), issuer.fingerprint.size());
+    return key.release_value();
+}
+
+bool CertificateCache::has_verified_signature(Certificate const& subject, Certificate const& issuer) const
+{
+    auto key = signature_key(subject, issuer);
+    return key.has_value() && m_verified_signatures.contains(*key);
+}
+
+void CertificateCache::did_verify_signature(Certificate const& subject, Certificate const& issuer)
+{
+    auto key = signature_key(subject, issuer);
+    if (!key.has_value())
+        return;
+    if (m_verified_signatures.size() >= max_entries)
+        m_verified_signatures.clear();
+    (void)m_verified_signatures.try_set(key.release_value());
+}
+
 }
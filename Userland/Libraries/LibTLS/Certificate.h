@@ -8,6 +8,8 @@
 
 #include <AK/ByteBuffer.h>
 #include <AK/Forward.h>
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
 #include <AK/Optional.h>
 #include <AK/Singleton.h>
 #include <AK/Types.h>
@@ -126,11 +128,32 @@ public:
     }
 };
 
+// Certificates we have parsed and issuer signatures we have checked, shared by all connections of this process.
+// Both are keyed by SHA-256 fingerprints of the DER encoding, so a hit stands for exactly the work we would redo.
+class CertificateCache {
+public:
+    static CertificateCache& the() { return s_the; }
+
+    Optional<Certificate> parse(ReadonlyBytes der);
+
+    bool has_verified_signature(Certificate const& subject, Certificate const& issuer) const;
+    void did_verify_signature(Certificate const& subject, Certificate const& issuer);
+
+private:
+    static constexpr size_t max_entries = 256;
+
+    static Singleton<CertificateCache> s_the;
+
+    HashMap<ByteBuffer, Certificate> m_certificates;
+    HashTable<ByteBuffer> m_verified_signatures;
+};
+
 class DefaultRootCACertificates {
 public:
     DefaultRootCACertificates();
 
-    Vector<Certificate> const& certificates() const { return m_ca_certificates; }
+    // By subject identifier, shared by every connection that doesn't bring its own root certificates.
+    HashMap<DeprecatedString, Certificate> const& certificates() const { return m_ca_certificates; }
 
     void reload_certificates(Core::ConfigFile&);
 
@@ -139,10 +162,11 @@ public:
 private:
     static Singleton<DefaultRootCACertificates> s_the;
 
-    Vector<Certificate> m_ca_certificates;
+    HashMap<DeprecatedString, Certificate> m_ca_certificates;
 };
 
 }
 
 using TLS::Certificate;
+using TLS::CertificateCache;
 using TLS::DefaultRootCACertificates;
@@ -103,6 +103,8 @@ enum class HashAlgorithm : u8 {
     SHA256 = 4,
     SHA384 = 5,
     SHA512 = 6,
+    // RFC 8446 section 4.2.3: The signature schemes of TLS 1.3 that don't fit the TLS 1.2 scheme use this "hash".
+    Intrinsic = 8,
 };
 
 // Defined in RFC 5246 section 7.4.1.4.1
@@ -111,6 +113,10 @@ enum class SignatureAlgorithm : u8 {
     RSA = 1,
     DSA = 2,
     ECDSA = 3,
+    // Defined in RFC 8446 section 4.2.3, as the low byte of a SignatureScheme with the Intrinsic hash
+    RSA_PSS_RSAE_SHA256 = 4,
+    RSA_PSS_RSAE_SHA384 = 5,
+    RSA_PSS_RSAE_SHA512 = 6,
 };
 
 // Defined in RFC 5246 section 7.4.1.4.1
@@ -170,6 +176,7 @@ enum class CipherAlgorithm {
     AES_128_CCM_8,
     AES_256_CBC,
     AES_256_GCM,
+    CHACHA20_POLY1305,
 };
 
 constexpr size_t cipher_key_size(CipherAlgorithm algorithm)
@@ -182,6 +189,7 @@ constexpr size_t cipher_key_size(CipherAlgorithm algorithm)
         return 128;
     case CipherAlgorithm::AES_256_CBC:
     case CipherAlgorithm::AES_256_GCM:
+    case CipherAlgorithm::CHACHA20_POLY1305:
         return 256;
     case CipherAlgorithm::Invalid:
     default:
@@ -18,10 +18,15 @@ namespace TLS {
 
 ByteBuffer TLSv12::build_hello()
 {
-    fill_with_random(&m_context.local_random, 32);
-
-    auto packet_version = (u16)m_context.options.version;
-    auto version = (u16)m_context.options.version;
+    // RFC 8446 section 4.1.2: The ClientHello that answers a HelloRetryRequest keeps the random of the first one.
+    bool is_hello_retry = !m_context.tls13.hello_retry_transcript.is_empty();
+    if (!is_hello_retry)
+        fill_with_random(&m_context.local_random, 32);
+
+    // TLS 1.3 is negotiated with the supported_versions extension, the version fields always claim TLS 1.2.
+    auto packet_version = (u16)Version::V12;
+    auto version = (u16)Version::V12;
+    bool offer_tls13 = should_offer_tls13();
     PacketBuilder builder { MessageType::Handshake, packet_version };
 
     builder.append((u8)ClientHello);
@@ -35,32 +40,42 @@ ByteBuffer TLSv12::build_hello()
     builder.append(version);
     builder.append(m_context.local_random, sizeof(m_context.local_random));
 
+    // Offer to resume an earlier session, if we were given one whose cipher suite we are still willing to use.
+    auto const& session = m_context.options.session_to_resume;
+    bool can_resume_session = session.has_value() && session->version == Version::V12 && m_context.options.usable_cipher_suites.contains_slow(session->cipher);
+    if (is_hello_retry) {
+        // Keep the session ID of the first ClientHello.
+    } else if (can_resume_session && !session->session_id.is_empty() && session->session_id.size() <= sizeof(m_context.session_id)) {
+        memcpy(m_context.session_id, session->session_id.data(), session->session_id.size());
+        m_context.session_id_size = session->session_id.size();
+    } else if (can_resume_session && !session->ticket.is_empty()) {
+        // RFC 5077 section 3.4: A client that offers a ticket without a session ID makes one up, so that it can tell
+        // whether the server accepted the ticket from the session ID in its ServerHello.
+        fill_with_random(m_context.session_id, sizeof(m_context.session_id));
+        m_context.session_id_size = sizeof(m_context.session_id);
+    }
+
     builder.append(m_context.session_id_size);
     if (m_context.session_id_size)
         builder.append(m_context.session_id, m_context.session_id_size);
 
-    size_t extension_length = 0;
-    size_t alpn_length = 0;
-    size_t alpn_negotiated_length = 0;
-
     // ALPN
-    if (!m_context.negotiated_alpn.is_null()) {
-        alpn_negotiated_length = m_context.negotiated_alpn.length();
-        alpn_length = alpn_negotiated_length + 1;
-        extension_length += alpn_length + 6;
-    } else if (m_context.alpn.size()) {
-        for (auto& alpn : m_context.alpn) {
-            size_t length = alpn.length();
-            alpn_length += length + 1;
-        }
-        if (alpn_length)
-            extension_length += alpn_length + 6;
-    }
+    size_t alpn_length = 0;
+    for (auto& alpn : m_context.alpn)
+        alpn_length += alpn.length() + 1;
 
     // Ciphers
-    builder.append((u16)(m_context.options.usable_cipher_suites.size() * sizeof(u16)));
-    for (auto suite : m_context.options.usable_cipher_suites)
-        builder.append((u16)suite);
+    auto should_offer_cipher_suite = [&](CipherSuite suite) { return offer_tls13 || !is_tls13_cipher_suite(suite); };
+    size_t cipher_suite_count = 0;
+    for (auto suite : m_context.options.usable_cipher_suites) {
+        if (should_offer_cipher_suite(suite))
+            ++cipher_suite_count;
+    }
+    builder.append((u16)(cipher_suite_count * sizeof(u16)));
+    for (auto suite : m_context.options.usable_cipher_suites) {
+        if (should_offer_cipher_suite(suite))
+            builder.append((u16)suite);
+    }
 
     // we don't like compression
     VERIFY(!m_context.options.use_compression);
@@ -76,17 +91,9 @@ ByteBuffer TLSv12::build_hello()
     auto supported_ec_point_formats_length = m_context.options.supported_ec_point_formats.size();
     bool supports_elliptic_curves = elliptic_curves_length && supported_ec_point_formats_length;
 
-    // signature_algorithms: 2b extension ID, 2b extension length, 2b vector length, 2xN signatures and hashes
-    extension_length += 2 + 2 + 2 + 2 * m_context.options.supported_signature_algorithms.size();
-
-    if (sni_length)
-        extension_length += sni_length + 9;
-
-    // Only send elliptic_curves and ec_point_formats extensions if both are supported
-    if (supports_elliptic_curves)
-        extension_length += 6 + elliptic_curves_length + 5 + supported_ec_point_formats_length;
-
-    builder.append((u16)extension_length);
+    // extensions length (for later)
+    auto extensions_length_position = builder.length();
+    builder.append((u16)0);
 
     if (sni_length) {
         // SNI extension
@@ -130,11 +137,34 @@ ByteBuffer TLSv12::build_hello()
             builder.append((u8)format);
     }
 
+    // session_ticket: An empty one asks the server for a ticket, a non-empty one offers to resume its session.
+    ReadonlyBytes session_ticket;
+    if (can_resume_session)
+        session_ticket = session->ticket;
+    builder.append((u16)HandshakeExtension::SessionTicket);
+    builder.append((u16)session_ticket.size());
+    builder.append(session_ticket);
+
     if (alpn_length) {
-        // TODO
-        VERIFY_NOT_REACHED();
+        // https://www.rfc-editor.org/rfc/rfc7301#section-3.1
+        builder.append((u16)HandshakeExtension::ApplicationLayerProtocolNegotiation);
+        builder.append((u16)(alpn_length + 2));
+        builder.append((u16)alpn_length);
+        for (auto& alpn : m_context.alpn) {
+            builder.append((u8)alpn.length());
+            builder.append(alpn.bytes());
+        }
     }
 
+    // This has to come last, as the pre_shared_key extension must be the last one.
+    if (offer_tls13)
+        build_tls13_hello_extensions(builder);
+
+    // set the "length" field of the extensions
+    size_t extensions_length = builder.length() - extensions_length_position - 2;
+    builder.set(extensions_length_position, extensions_length / 0x100);
+    builder.set(extensions_length_position + 1, extensions_length % 0x100);
+
     // set the "length" field of the packet
     size_t remaining = builder.length() - start_length;
     size_t payload_position = 6;
@@ -145,6 +175,8 @@ ByteBuffer TLSv12::build_hello()
     builder.set(payload_position + 2, remaining);
 
     auto packet = builder.build();
+    if (m_context.tls13.offered_psk)
+        bind_psk_to_hello(packet);
     update_packet(packet);
 
     return packet;
@@ -152,7 +184,7 @@ ByteBuffer TLSv12::build_hello()
 
 ByteBuffer TLSv12::build_change_cipher_spec()
 {
-    PacketBuilder builder { MessageType::ChangeCipher, m_context.options.version, 64 };
+    PacketBuilder builder { MessageType::ChangeCipher, Version::V12, 64 };
     builder.append((u8)1);
     auto packet = builder.build();
     update_packet(packet);
@@ -162,7 +194,7 @@ ByteBuffer TLSv12::build_change_cipher_spec()
 
 ByteBuffer TLSv12::build_handshake_finished()
 {
-    PacketBuilder builder { MessageType::Handshake, m_context.options.version, 12 + 64 };
+    PacketBuilder builder { MessageType::Handshake, Version::V12, 12 + 64 };
     builder.append((u8)HandshakeType::Finished);
 
     // RFC 5246 section 7.4.9: "In previous versions of TLS, the verify_data was always 12 octets
@@ -218,6 +250,21 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
 
     // TODO: Compare Hashes
     dbgln_if(TLS_DEBUG, "FIXME: handle_handshake_finished :: Check message validity");
+
+    // RFC 5246 section 7.3: In an abbreviated handshake, the server sends its Finished message first. The handshake is
+    // only complete once ours, which also covers the server's, has been sent.
+    if (m_context.is_resuming_session) {
+        write_packets = WritePacketStage::Finished;
+        return index + size;
+    }
+
+    did_establish_connection();
+
+    return index + size;
+}
+
+void TLSv12::did_establish_connection()
+{
     m_context.connection_status = ConnectionStatus::Established;
 
     if (m_handshake_timeout_timer) {
@@ -227,15 +274,38 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
         m_handshake_timeout_timer = nullptr;
     }
 
+    // TLS 1.3 sessions arrive as NewSessionTicket messages after the handshake.
+    if (m_context.version == Version::V12 && (m_context.session_id_size || !m_context.session_ticket.is_empty())) {
+        // A resumed session keeps its ticket unless the server handed out a new one.
+        ReadonlyBytes ticket = m_context.session_ticket;
+        if (ticket.is_empty() && m_context.is_resuming_session)
+            ticket = m_context.options.session_to_resume->ticket;
+
+        auto master_key = ByteBuffer::copy(m_context.master_key);
+        auto session_id = ByteBuffer::copy(m_context.session_id, m_context.session_id_size);
+        auto ticket_copy = ByteBuffer::copy(ticket);
+        if (!master_key.is_error() && !session_id.is_error() && !ticket_copy.is_error()) {
+            m_context.options.session_handler(SessionState {
+                .cipher = m_context.cipher,
+                .master_key = master_key.release_value(),
+                .session_id = session_id.release_value(),
+                .ticket = ticket_copy.release_value(),
+            });
+        }
+    }
+
+    // Whatever the server didn't take as early data goes out first thing.
+    if (!m_context.options.early_data.is_empty() && !m_context.tls13.accepted_early_data)
+        MUST(write(m_context.options.early_data));
+
     if (on_connected)
         on_connected();
-
-    return index + size;
 }
 
 ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
 {
-    if (m_context.connection_status == ConnectionStatus::Established) {
+    // TLS 1.3 has no renegotiation, but it keeps sending tickets and key updates after the handshake.
+    if (m_context.connection_status == ConnectionStatus::Established && m_context.version != Version::V13) {
         dbgln_if(TLS_DEBUG, "Renegotiation attempt ignored");
         // FIXME: We should properly say "NoRenegotiation", but that causes a handshake failure
         //        so we just roll with it and pretend that we _did_ renegotiate
@@ -299,6 +369,29 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
             dbgln("unsupported: DTLS");
             payload_res = (i8)Error::UnexpectedMessage;
             break;
+        case NewSessionTicket:
+            if (m_context.version == Version::V13) {
+                // RFC 8446 section 4.6.1: The server may send any number of tickets once the handshake is done.
+                dbgln_if(TLS_DEBUG, "new session ticket");
+                if (m_context.connection_status != ConnectionStatus::Established)
+                    payload_res = (i8)Error::UnexpectedMessage;
+                else
+                    payload_res = handle_tls13_new_session_ticket(buffer.slice(1, payload_size));
+                break;
+            }
+            if (m_context.handshake_messages[11] >= 1) {
+                dbgln("unexpected new session ticket message");
+                payload_res = (i8)Error::UnexpectedMessage;
+                break;
+            }
+            ++m_context.handshake_messages[11];
+            dbgln_if(TLS_DEBUG, "new session ticket");
+            if (m_context.is_server) {
+                dbgln("unsupported: server mode");
+                VERIFY_NOT_REACHED();
+            }
+            payload_res = handle_new_session_ticket(buffer.slice(1, payload_size));
+            break;
         case CertificateMessage:
             if (m_context.handshake_messages[4] >= 1) {
                 dbgln("unexpected certificate message");
@@ -307,7 +400,13 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
             }
             ++m_context.handshake_messages[4];
             dbgln_if(TLS_DEBUG, "certificate");
-            if (m_context.connection_status == ConnectionStatus::Negotiating) {
+            if (m_context.version == Version::V13) {
+                // RFC 8446 section 4.4.2: The server authenticates with a certificate unless we resume a session.
+                if (m_context.connection_status == ConnectionStatus::Negotiating && m_context.handshake_messages[12] && !m_context.tls13.accepted_psk)
+                    payload_res = handle_tls13_certificate(buffer.slice(1, payload_size));
+                else
+                    payload_res = (i8)Error::UnexpectedMessage;
+            } else if (m_context.connection_status == ConnectionStatus::Negotiating) {
                 if (m_context.is_server) {
                     dbgln("unsupported: server mode");
                     VERIFY_NOT_REACHED();
@@ -339,7 +438,12 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
                 break;
             }
             ++m_context.handshake_messages[6];
-            if (m_context.is_server) {
+            if (m_context.version == Version::V13) {
+                if (m_context.connection_status == ConnectionStatus::Negotiating && m_context.handshake_messages[12] && !m_context.handshake_messages[4] && !m_context.tls13.accepted_psk)
+                    payload_res = handle_tls13_certificate_request(buffer.slice(1, payload_size));
+                else
+                    payload_res = (i8)Error::UnexpectedMessage;
+            } else if (m_context.is_server) {
                 dbgln("invalid request");
                 dbgln("unsupported: server mode");
                 VERIFY_NOT_REACHED();
@@ -376,7 +480,12 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
             }
             ++m_context.handshake_messages[8];
             dbgln_if(TLS_DEBUG, "certificate verify");
-            if (m_context.connection_status == ConnectionStatus::KeyExchange) {
+            if (m_context.version == Version::V13) {
+                if (m_context.connection_status == ConnectionStatus::Negotiating && m_context.handshake_messages[4])
+                    payload_res = handle_tls13_certificate_verify(buffer.slice(1, payload_size));
+                else
+                    payload_res = (i8)Error::UnexpectedMessage;
+            } else if (m_context.connection_status == ConnectionStatus::KeyExchange) {
                 payload_res = handle_certificate_verify(buffer.slice(1, payload_size));
             } else {
                 payload_res = (i8)Error::UnexpectedMessage;
@@ -406,11 +515,36 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
             }
             ++m_context.handshake_messages[10];
             dbgln_if(TLS_DEBUG, "finished");
-            payload_res = handle_handshake_finished(buffer.slice(1, payload_size), write_packets);
+            if (m_context.version == Version::V13) {
+                // RFC 8446 section 4.4.4: Without a pre-shared key, the server has to have proven who it is by now.
+                if (m_context.connection_status == ConnectionStatus::Negotiating && m_context.handshake_messages[12] && (m_context.tls13.accepted_psk || m_context.handshake_messages[8]))
+                    payload_res = handle_tls13_handshake_finished(buffer.slice(1, payload_size), write_packets);
+                else
+                    payload_res = (i8)Error::UnexpectedMessage;
+            } else {
+                payload_res = handle_handshake_finished(buffer.slice(1, payload_size), write_packets);
+            }
             if (payload_res > 0) {
                 memset(m_context.handshake_messages, 0, sizeof(m_context.handshake_messages));
             }
             break;
+        case EncryptedExtensions:
+            if (m_context.handshake_messages[12] >= 1 || m_context.version != Version::V13 || m_context.connection_status != ConnectionStatus::Negotiating) {
+                dbgln("unexpected encrypted extensions message");
+                payload_res = (i8)Error::UnexpectedMessage;
+                break;
+            }
+            ++m_context.handshake_messages[12];
+            dbgln_if(TLS_DEBUG, "encrypted extensions");
+            payload_res = handle_encrypted_extensions(buffer.slice(1, payload_size));
+            break;
+        case KeyUpdate:
+            dbgln_if(TLS_DEBUG, "key update");
+            if (m_context.version != Version::V13 || m_context.connection_status != ConnectionStatus::Established)
+                payload_res = (i8)Error::UnexpectedMessage;
+            else
+                payload_res = handle_key_update(buffer.slice(1, payload_size));
+            break;
         default:
             dbgln("message type not understood: {}", type);
             return (i8)Error::NotUnderstood;
@@ -496,6 +630,10 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
             // nothing to write
             break;
         case WritePacketStage::ClientHandshake:
+            if (m_context.version == Version::V13) {
+                write_tls13_client_handshake();
+                break;
+            }
             if (m_context.client_verified == VerificationNeeded) {
                 dbgln_if(TLS_DEBUG, "> Client Certificate");
                 auto packet = build_certificate();
@@ -538,8 +676,17 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
                 auto packet = build_handshake_finished();
                 write_packet(packet);
             }
-            m_context.connection_status = ConnectionStatus::Established;
+            did_establish_connection();
             break;
+        case WritePacketStage::HandshakeTrafficKeys:
+            derive_handshake_traffic_keys();
+            break;
+        case WritePacketStage::HelloRetry: {
+            dbgln_if(TLS_DEBUG, "> client hello (retry)");
+            auto packet = build_hello();
+            write_packet(packet);
+            break;
+        }
         }
         payload_size++;
         buffer_length -= payload_size;
@@ -76,7 +76,7 @@ ssize_t TLSv12::handle_certificate(ReadonlyBytes buffer)
             }
             remaining -= certificate_size_specific;
 
-            auto certificate = Certificate::parse_asn1(buffer.slice(res_cert, certificate_size_specific), false);
+            auto certificate = CertificateCache::the().parse(buffer.slice(res_cert, certificate_size_specific));
             if (certificate.has_value()) {
                 m_context.certificates.append(certificate.value());
                 valid_certificate = true;
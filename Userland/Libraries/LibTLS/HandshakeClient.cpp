@@ -217,7 +217,16 @@ void TLSv12::build_dhe_rsa_pre_master_secret(PacketBuilder& builder)
     auto dh_key_size = dh.p.size();
 
     auto dh_random = Crypto::NumberTheory::random_number(0, dh_p);
-    auto dh_Yc = Crypto::NumberTheory::ModularPower(dh_g, dh_random, dh_p);
+    // Both exponentiations below share the modulus, so only work out its Montgomery context once.
+    Optional<Crypto::MontgomeryContext> dh_p_context;
+    if (dh_p.is_odd() && dh_p != 1)
+        dh_p_context = Crypto::NumberTheory::make_montgomery_context(dh_p);
+    auto modular_power = [&](auto const& base, auto const& exponent) {
+        if (dh_p_context.has_value())
+            return Crypto::NumberTheory::ModularPower(base, exponent, *dh_p_context);
+        return Crypto::NumberTheory::ModularPower(base, exponent, dh_p);
+    };
+    auto dh_Yc = modular_power(dh_g, dh_random);
     auto dh_Yc_bytes_result = ByteBuffer::create_uninitialized(dh_key_size);
     if (dh_Yc_bytes_result.is_error()) {
         dbgln("Failed to build DHE_RSA premaster secret: not enough memory");
@@ -226,7 +235,7 @@ void TLSv12::build_dhe_rsa_pre_master_secret(PacketBuilder& builder)
     auto dh_Yc_bytes = dh_Yc_bytes_result.release_value();
     dh_Yc.export_data(dh_Yc_bytes);
 
-    auto premaster_key = Crypto::NumberTheory::ModularPower(dh_Ys, dh_random, dh_p);
+    auto premaster_key = modular_power(dh_Ys, dh_random);
     auto premaster_key_result = ByteBuffer::create_uninitialized(dh_key_size);
     if (premaster_key_result.is_error()) {
         dbgln("Failed to build DHE_RSA premaster secret: not enough memory");
@@ -309,7 +318,7 @@ void TLSv12::build_ecdhe_rsa_pre_master_secret(PacketBuilder& builder)
 
 ByteBuffer TLSv12::build_certificate()
 {
-    PacketBuilder builder { MessageType::Handshake, m_context.options.version };
+    PacketBuilder builder { MessageType::Handshake, Version::V12 };
 
     Vector<Certificate const&> certificates;
     Vector<Certificate>* local_certificates = nullptr;
@@ -369,7 +378,7 @@ ByteBuffer TLSv12::build_client_key_exchange()
         return {};
     }
 
-    PacketBuilder builder { MessageType::Handshake, m_context.options.version };
+    PacketBuilder builder { MessageType::Handshake, Version::V12 };
     builder.append((u8)HandshakeType::ClientKeyExchange);
 
     switch (get_key_exchange_algorithm(m_context.cipher)) {
@@ -24,7 +24,8 @@ namespace TLS {
 ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& write_packets)
 {
     write_packets = WritePacketStage::Initial;
-    if (m_context.connection_status != ConnectionStatus::Disconnected && m_context.connection_status != ConnectionStatus::Renegotiating) {
+    bool follows_hello_retry = m_context.connection_status == ConnectionStatus::Negotiating && !m_context.tls13.hello_retry_transcript.is_empty();
+    if (m_context.connection_status != ConnectionStatus::Disconnected && m_context.connection_status != ConnectionStatus::Renegotiating && !follows_hello_retry) {
         dbgln("unexpected hello message");
         return (i8)Error::UnexpectedMessage;
     }
@@ -61,7 +62,11 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         return (i8)Error::NeedMoreData;
     }
 
+    // A TLS 1.2 server resumes the session we offered by echoing its session ID, a TLS 1.3 server echoes it anyway.
+    bool echoes_session_id = session_length == m_context.session_id_size
+        && memcmp(m_context.session_id, buffer.offset_pointer(res), session_length) == 0;
     if (session_length && session_length <= 32) {
+        m_context.is_resuming_session = m_context.options.session_to_resume.has_value() && echoes_session_id;
         memcpy(m_context.session_id, buffer.offset_pointer(res), session_length);
         m_context.session_id_size = session_length;
         if constexpr (TLS_DEBUG) {
@@ -70,6 +75,7 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         }
     } else {
         m_context.session_id_size = 0;
+        m_context.is_resuming_session = false;
     }
     res += session_length;
 
@@ -84,12 +90,8 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         dbgln("No supported cipher could be agreed upon");
         return (i8)Error::NoCommonCipher;
     }
-    m_context.cipher = cipher;
     dbgln_if(TLS_DEBUG, "Cipher: {}", (u16)cipher);
 
-    // Simplification: We only support handshake hash functions via HMAC
-    m_context.handshake_hash.initialize(hmac_hash());
-
     // Compression method
     if (buffer.size() - res < 1)
         return (i8)Error::NeedMoreData;
@@ -97,12 +99,11 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
     if (compression != 0)
         return (i8)Error::CompressionNotSupported;
 
-    if (m_context.connection_status != ConnectionStatus::Renegotiating)
-        m_context.connection_status = ConnectionStatus::Negotiating;
-    if (m_context.is_server) {
-        dbgln("unsupported: server mode");
-        write_packets = WritePacketStage::ServerHandshake;
-    }
+    // The TLS 1.3 extensions, which are only acted on once we know which version the server picked.
+    Optional<Version> selected_version;
+    ReadonlyBytes key_share;
+    Optional<u16> selected_identity;
+    ReadonlyBytes cookie;
 
     // Presence of extensions is determined by availability of bytes after compression_method
     if (buffer.size() - res >= 2) {
@@ -149,28 +150,28 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
                 res += sni_name_length;
                 dbgln("SNI host_name: {}", m_context.extensions.SNI);
             }
-        } else if (extension_type == HandshakeExtension::ApplicationLayerProtocolNegotiation && m_context.alpn.size()) {
-            if (buffer.size() - res > 2) {
-                auto alpn_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
-                if (alpn_length && alpn_length <= extension_length - 2) {
-                    u8 const* alpn = buffer.offset_pointer(res + 2);
-                    size_t alpn_position = 0;
-                    while (alpn_position < alpn_length) {
-                        u8 alpn_size = alpn[alpn_position++];
-                        if (alpn_size + alpn_position >= extension_length)
-                            break;
-                        DeprecatedString alpn_str { (char const*)alpn + alpn_position, alpn_length };
-                        if (alpn_size && m_context.alpn.contains_slow(alpn_str)) {
-                            m_context.negotiated_alpn = alpn_str;
-                            dbgln("negotiated alpn: {}", alpn_str);
-                            break;
-                        }
-                        alpn_position += alpn_length;
-                        if (!m_context.is_server) // server hello must contain one ALPN
-                            break;
-                    }
-                }
-            }
+        } else if (extension_type == HandshakeExtension::ApplicationLayerProtocolNegotiation) {
+            if (auto result = handle_selected_alpn(buffer.slice(res, extension_length)); result < 0)
+                return result;
+            res += extension_length;
+        } else if (extension_type == HandshakeExtension::SupportedVersions) {
+            if (extension_length != 2)
+                return (i8)Error::BrokenPacket;
+            selected_version = static_cast<Version>(AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res))));
+            res += extension_length;
+        } else if (extension_type == HandshakeExtension::KeyShare) {
+            key_share = buffer.slice(res, extension_length);
+            res += extension_length;
+        } else if (extension_type == HandshakeExtension::PreSharedKey) {
+            if (extension_length != 2)
+                return (i8)Error::BrokenPacket;
+            selected_identity = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
+            res += extension_length;
+        } else if (extension_type == HandshakeExtension::Cookie) {
+            cookie = buffer.slice(res, extension_length);
+            res += extension_length;
+        } else if (extension_type == HandshakeExtension::SessionTicket) {
+            // RFC 5077 section 3.2: The server will send a NewSessionTicket message before its ChangeCipherSpec.
             res += extension_length;
         } else if (extension_type == HandshakeExtension::SignatureAlgorithms) {
             dbgln("supported signatures: ");
@@ -193,9 +194,135 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         }
     }
 
+    bool is_hello_retry_request = ReadonlyBytes { m_context.remote_random, sizeof(m_context.remote_random) } == ReadonlyBytes { hello_retry_request_random, sizeof(hello_retry_request_random) };
+    if (selected_version.has_value()) {
+        // RFC 8446 section 4.2.1: A TLS 1.3 ServerHello carries the real version in the supported_versions extension.
+        if (selected_version.value() != Version::V13 || !should_offer_tls13() || !is_tls13_cipher_suite(cipher) || !m_context.options.usable_cipher_suites.contains_slow(cipher)) {
+            dbgln("Server picked a version or cipher suite we didn't offer");
+            return (i8)Error::NotSafe;
+        }
+        if (!echoes_session_id) {
+            dbgln("Server did not echo our legacy session ID");
+            return (i8)Error::NotSafe;
+        }
+        m_context.is_resuming_session = false;
+        m_context.version = Version::V13;
+
+        bool is_second_hello = !m_context.tls13.hello_retry_transcript.is_empty();
+        if (is_second_hello && cipher != m_context.cipher) {
+            dbgln("Server changed its cipher suite after a HelloRetryRequest");
+            return (i8)Error::NotSafe;
+        }
+        m_context.cipher = cipher;
+        m_context.connection_status = ConnectionStatus::Negotiating;
+
+        ssize_t result;
+        if (is_hello_retry_request) {
+            result = handle_hello_retry_request(buffer.slice(0, 3 + following_bytes), key_share, cookie, write_packets);
+        } else {
+            if (m_context.handshake_hash.kind() == Crypto::Hash::HashKind::None)
+                m_context.handshake_hash.initialize(hmac_hash());
+            result = handle_tls13_server_hello(key_share, selected_identity, write_packets);
+        }
+        if (result < 0)
+            return result;
+        return res;
+    }
+
+    if (is_hello_retry_request || is_tls13_cipher_suite(cipher) || !m_context.tls13.hello_retry_transcript.is_empty()) {
+        dbgln("Server sent a TLS 1.3 ServerHello without the supported_versions extension");
+        return (i8)Error::NotSafe;
+    }
+    // RFC 8446 section 4.1.3: A server that could have done TLS 1.3 but negotiates TLS 1.2 anyway signals that with
+    // its random. Seeing that after offering TLS 1.3 means that someone tampered with our ClientHello.
+    if (should_offer_tls13() && ReadonlyBytes { m_context.remote_random + 24, 8 } == ReadonlyBytes { tls12_downgrade_random_suffix, 8 }) {
+        dbgln("Server signals a downgrade from TLS 1.3");
+        return (i8)Error::NotSafe;
+    }
+
+    if (m_context.is_resuming_session && cipher != m_context.options.session_to_resume->cipher) {
+        dbgln("Server resumed a session with a different cipher suite");
+        return (i8)Error::NotSafe;
+    }
+    m_context.cipher = cipher;
+    // Any early data we sent was for TLS 1.3, and is gone now.
+    m_cipher_local = Empty {};
+
+    // Simplification: We only support handshake hash functions via HMAC
+    m_context.handshake_hash.initialize(hmac_hash());
+
+    if (m_context.connection_status != ConnectionStatus::Renegotiating)
+        m_context.connection_status = ConnectionStatus::Negotiating;
+    if (m_context.is_server) {
+        dbgln("unsupported: server mode");
+        write_packets = WritePacketStage::ServerHandshake;
+    }
+
+    if (m_context.is_resuming_session) {
+        // RFC 5246 section 7.3: The server goes straight to ChangeCipherSpec and Finished, with the keys derived from
+        // the master secret of the resumed session and the new randoms.
+        dbgln_if(TLS_DEBUG, "Resuming session");
+        auto master_key = ByteBuffer::copy(m_context.options.session_to_resume->master_key);
+        if (master_key.is_error())
+            return (i8)Error::OutOfMemory;
+        m_context.master_key = master_key.release_value();
+        if (!expand_key())
+            return (i8)Error::NotSafe;
+        m_context.connection_status = ConnectionStatus::KeyExchange;
+    }
+
     return res;
 }
 
+ssize_t TLSv12::handle_new_session_ticket(ReadonlyBytes buffer)
+{
+    // RFC 5077 section 3.3:
+    // struct {
+    //     uint32 ticket_lifetime_hint;
+    //     opaque ticket<0..2^16-1>;
+    // } NewSessionTicket;
+    if (buffer.size() < 9)
+        return (i8)Error::NeedMoreData;
+
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+    if (size < 6)
+        return (i8)Error::BrokenPacket;
+
+    // We don't keep sessions around for long enough for the lifetime hint to matter.
+    size_t ticket_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(7)));
+    if (ticket_length != size - 6)
+        return (i8)Error::BrokenPacket;
+
+    auto ticket = ByteBuffer::copy(buffer.slice(9, ticket_length));
+    if (ticket.is_error())
+        return (i8)Error::OutOfMemory;
+    m_context.session_ticket = ticket.release_value();
+
+    return 3 + size;
+}
+
+ssize_t TLSv12::handle_selected_alpn(ReadonlyBytes extension)
+{
+    // https://www.rfc-editor.org/rfc/rfc7301#section-3.1: The server picks exactly one of the protocols we offered.
+    if (extension.size() < 3)
+        return (i8)Error::BrokenPacket;
+    size_t list_length = AK::convert_between_host_and_network_endian(ByteReader::load16(extension.data()));
+    size_t alpn_length = extension[2];
+    if (list_length + 2 != extension.size() || alpn_length + 1 != list_length || alpn_length == 0)
+        return (i8)Error::BrokenPacket;
+
+    DeprecatedString alpn { extension.slice(3, alpn_length) };
+    if (!m_context.alpn.contains_slow(alpn)) {
+        dbgln("Server selected the application protocol '{}', which we didn't offer", alpn);
+        return (i8)Error::NotUnderstood;
+    }
+    dbgln_if(TLS_DEBUG, "Negotiated ALPN: {}", alpn);
+    m_context.negotiated_alpn = move(alpn);
+    return 0;
+}
+
 ssize_t TLSv12::handle_server_hello_done(ReadonlyBytes buffer)
 {
     if (buffer.size() < 3)
@@ -345,18 +472,37 @@ ssize_t TLSv12::handle_ecdhe_rsa_server_key_exchange(ReadonlyBytes buffer)
 
 ssize_t TLSv12::verify_rsa_server_key_exchange(ReadonlyBytes server_key_info_buffer, ReadonlyBytes signature_buffer)
 {
-    auto signature_hash = signature_buffer[0];
-    auto signature_algorithm = signature_buffer[1];
-    if (signature_algorithm != (u8)SignatureAlgorithm::RSA) {
-        dbgln("verify_rsa_server_key_exchange failed: Signature algorithm is not RSA, instead {}", signature_algorithm);
-        return (i8)Error::NotUnderstood;
-    }
-
+    if (signature_buffer.size() < 4)
+        return (i8)Error::NeedMoreData;
+    SignatureAndHashAlgorithm algorithm { static_cast<HashAlgorithm>(signature_buffer[0]), static_cast<SignatureAlgorithm>(signature_buffer[1]) };
     auto signature_length = AK::convert_between_host_and_network_endian(ByteReader::load16(signature_buffer.offset_pointer(2)));
     auto signature = signature_buffer.slice(4, signature_length);
 
+    auto message_result = ByteBuffer::create_uninitialized(64 + server_key_info_buffer.size());
+    if (message_result.is_error()) {
+        dbgln("verify_rsa_server_key_exchange failed: Not enough memory");
+        return (i8)Error::OutOfMemory;
+    }
+    auto message = message_result.release_value();
+    ReadonlyBytes { m_context.local_random, 32 }.copy_to(message);
+    ReadonlyBytes { m_context.remote_random, 32 }.copy_to(message.bytes().slice(32));
+    server_key_info_buffer.copy_to(message.bytes().slice(64));
+
+    return verify_rsa_signature(message, algorithm, signature);
+}
+
+template<typename HashT>
+static Crypto::VerificationConsistency verify_rsa_pss(ReadonlyBytes message, ReadonlyBytes encoded_message, size_t em_bits)
+{
+    // RFC 8446 section 4.2.3: The salt is as long as the digest.
+    Crypto::PK::EMSA_PSS<HashT, HashT::DigestSize> pss;
+    return pss.verify(message, encoded_message, em_bits);
+}
+
+ssize_t TLSv12::verify_rsa_signature(ReadonlyBytes message, SignatureAndHashAlgorithm algorithm, ReadonlyBytes signature)
+{
     if (m_context.certificates.is_empty()) {
-        dbgln("verify_rsa_server_key_exchange failed: Attempting to verify signature without certificates");
+        dbgln("verify_rsa_signature failed: Attempting to verify signature without certificates");
         return (i8)Error::NotSafe;
     }
     // RFC5246 section 7.4.2: The sender's certificate MUST come first in the list.
@@ -364,49 +510,64 @@ ssize_t TLSv12::verify_rsa_server_key_exchange(ReadonlyBytes server_key_info_buf
     Crypto::PK::RSAPrivateKey dummy_private_key;
     auto rsa = Crypto::PK::RSA(certificate_public_key, dummy_private_key);
 
-    auto signature_verify_buffer_result = ByteBuffer::create_uninitialized(signature_length);
+    auto signature_verify_buffer_result = ByteBuffer::create_uninitialized(signature.size());
     if (signature_verify_buffer_result.is_error()) {
-        dbgln("verify_rsa_server_key_exchange failed: Not enough memory");
+        dbgln("verify_rsa_signature failed: Not enough memory");
         return (i8)Error::OutOfMemory;
     }
     auto signature_verify_buffer = signature_verify_buffer_result.release_value();
     auto signature_verify_bytes = signature_verify_buffer.bytes();
     rsa.verify(signature, signature_verify_bytes);
 
-    auto message_result = ByteBuffer::create_uninitialized(64 + server_key_info_buffer.size());
-    if (message_result.is_error()) {
-        dbgln("verify_rsa_server_key_exchange failed: Not enough memory");
-        return (i8)Error::OutOfMemory;
-    }
-    auto message = message_result.release_value();
-    message.overwrite(0, m_context.local_random, 32);
-    message.overwrite(32, m_context.remote_random, 32);
-    message.overwrite(64, server_key_info_buffer.data(), server_key_info_buffer.size());
-
-    Crypto::Hash::HashKind hash_kind;
-    switch ((HashAlgorithm)signature_hash) {
-    case HashAlgorithm::SHA1:
-        hash_kind = Crypto::Hash::HashKind::SHA1;
-        break;
-    case HashAlgorithm::SHA256:
-        hash_kind = Crypto::Hash::HashKind::SHA256;
-        break;
-    case HashAlgorithm::SHA384:
-        hash_kind = Crypto::Hash::HashKind::SHA384;
-        break;
-    case HashAlgorithm::SHA512:
-        hash_kind = Crypto::Hash::HashKind::SHA512;
-        break;
-    default:
-        dbgln("verify_rsa_server_key_exchange failed: Hash algorithm is not SHA1/256/384/512, instead {}", signature_hash);
-        return (i8)Error::NotUnderstood;
-    }
+    auto verification = Crypto::VerificationConsistency::Inconsistent;
+    if (algorithm.hash == HashAlgorithm::Intrinsic) {
+        // RSASSA-PSS, with an encoded message one bit shorter than the modulus.
+        auto em_bits = signature.size() * 8 - 1;
+        switch (algorithm.signature) {
+        case SignatureAlgorithm::RSA_PSS_RSAE_SHA256:
+            verification = verify_rsa_pss<Crypto::Hash::SHA256>(message, signature_verify_bytes, em_bits);
+            break;
+        case SignatureAlgorithm::RSA_PSS_RSAE_SHA384:
+            verification = verify_rsa_pss<Crypto::Hash::SHA384>(message, signature_verify_bytes, em_bits);
+            break;
+        case SignatureAlgorithm::RSA_PSS_RSAE_SHA512:
+            verification = verify_rsa_pss<Crypto::Hash::SHA512>(message, signature_verify_bytes, em_bits);
+            break;
+        default:
+            dbgln("verify_rsa_signature failed: Signature scheme is not RSA-PSS, instead {}", (u8)algorithm.signature);
+            return (i8)Error::NotUnderstood;
+        }
+    } else {
+        if (algorithm.signature != SignatureAlgorithm::RSA) {
+            dbgln("verify_rsa_signature failed: Signature algorithm is not RSA, instead {}", (u8)algorithm.signature);
+            return (i8)Error::NotUnderstood;
+        }
 
-    auto pkcs1 = Crypto::PK::EMSA_PKCS1_V1_5<Crypto::Hash::Manager>(hash_kind);
-    auto verification = pkcs1.verify(message, signature_verify_bytes, signature_length * 8);
+        Crypto::Hash::HashKind hash_kind;
+        switch (algorithm.hash) {
+        case HashAlgorithm::SHA1:
+            hash_kind = Crypto::Hash::HashKind::SHA1;
+            break;
+        case HashAlgorithm::SHA256:
+            hash_kind = Crypto::Hash::HashKind::SHA256;
+            break;
+        case HashAlgorithm::SHA384:
+            hash_kind = Crypto::Hash::HashKind::SHA384;
+            break;
+        case HashAlgorithm::SHA512:
+            hash_kind = Crypto::Hash::HashKind::SHA512;
+            break;
+        default:
+            dbgln("verify_rsa_signature failed: Hash algorithm is not SHA1/256/384/512, instead {}", (u8)algorithm.hash);
+            return (i8)Error::NotUnderstood;
+        }
+
+        auto pkcs1 = Crypto::PK::EMSA_PKCS1_V1_5<Crypto::Hash::Manager>(hash_kind);
+        verification = pkcs1.verify(message, signature_verify_bytes, signature.size() * 8);
+    }
 
     if (verification == Crypto::VerificationConsistency::Inconsistent) {
-        dbgln("verify_rsa_server_key_exchange failed: Verification of signature inconsistent");
+        dbgln("verify_rsa_signature failed: Verification of signature inconsistent");
         return (i8)Error::NotSafe;
     }
 
@@ -16,7 +16,7 @@ namespace TLS {
 
 ByteBuffer TLSv12::build_alert(bool critical, u8 code)
 {
-    PacketBuilder builder(MessageType::Alert, (u16)m_context.options.version);
+    PacketBuilder builder(MessageType::Alert, Version::V12);
     builder.append((u8)(critical ? AlertLevel::Critical : AlertLevel::Warning));
     builder.append(code);
 
@@ -69,6 +69,15 @@ void TLSv12::update_packet(ByteBuffer& packet)
     u32 header_size = 5;
     ByteReader::store(packet.offset_pointer(3), AK::convert_between_host_and_network_endian((u16)(packet.size() - header_size)));
 
+    if (is_tls13_cipher_suite(m_context.cipher)) {
+        if (packet[0] == (u8)MessageType::Handshake && packet.size() > header_size)
+            update_hash(packet.bytes(), header_size);
+        // Protecting a record counts it towards the sequence number of its traffic key.
+        if (!m_cipher_local.has<Empty>())
+            packet = protect_tls13_record(packet);
+        return;
+    }
+
     if (packet[0] != (u8)MessageType::ChangeCipher) {
         if (packet[0] == (u8)MessageType::Handshake && packet.size() > header_size) {
             u8 handshake_type = packet[header_size];
@@ -100,7 +109,8 @@ void TLSv12::update_packet(ByteBuffer& packet)
                     length += mac_size;
                     padding = block_size - length % block_size;
                     length += padding;
-                });
+                },
+                [&](Crypto::Cipher::ChaCha20Poly1305&) { VERIFY_NOT_REACHED(); });
 
             if (m_context.crypto.created == 1) {
                 // `buffer' will continue to be encrypted
@@ -218,7 +228,8 @@ void TLSv12::update_packet(ByteBuffer& packet)
                         // get a block to encrypt into
                         auto view = ct.bytes().slice(header_size + iv_size, length);
                         cbc.encrypt(buffer, view, iv);
-                    });
+                    },
+                    [&](Crypto::Cipher::ChaCha20Poly1305&) { VERIFY_NOT_REACHED(); });
 
                 // store the correct ciphertext length into the packet
                 u16 ct_length = (u16)ct.size() - header_size;
@@ -346,7 +357,24 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
     ByteBuffer decrypted;
 
-    if (m_context.cipher_spec_set && type != MessageType::ChangeCipher) {
+    // RFC 8446 section 5.2: Once there is a traffic key, everything but ChangeCipherSpec comes as protected application data.
+    bool is_tls13 = m_context.version == Version::V13;
+    if (is_tls13 && !m_cipher_remote.has<Empty>() && type != MessageType::ChangeCipher) {
+        if (type != MessageType::ApplicationData) {
+            dbgln("unexpected unprotected record of type {}", (u8)type);
+            auto packet = build_alert(true, (u8)AlertDescription::UnexpectedMessage);
+            write_packet(packet);
+            return (i8)Error::UnexpectedMessage;
+        }
+        auto result = unprotect_tls13_record(buffer.slice(0, header_size + length), decrypted, type);
+        if (result < 0) {
+            auto description = result == (i8)Error::IntegrityCheckFailed ? AlertDescription::BadRecordMAC : AlertDescription::UnexpectedMessage;
+            auto packet = build_alert(true, (u8)description);
+            write_packet(packet);
+            return result;
+        }
+        plain = decrypted;
+    } else if (!is_tls13 && m_context.cipher_spec_set && type != MessageType::ChangeCipher) {
         if constexpr (TLS_DEBUG) {
             dbgln("Encrypted: ");
             print_buffer(buffer.slice(header_size, length));
@@ -480,13 +508,15 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
                     return;
                 }
                 plain = decrypted.bytes().slice(0, length);
-            });
+            },
+            [&](Crypto::Cipher::ChaCha20Poly1305&) { VERIFY_NOT_REACHED(); });
 
         if (return_value != Error::NoError) {
             return (i8)return_value;
         }
     }
-    m_context.remote_sequence_number++;
+    if (!is_tls13)
+        m_context.remote_sequence_number++;
 
     switch (type) {
     case MessageType::ApplicationData:
@@ -510,7 +540,10 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
         payload_res = handle_handshake_payload(plain);
         break;
     case MessageType::ChangeCipher:
-        if (m_context.connection_status != ConnectionStatus::KeyExchange) {
+        if (is_tls13 && m_context.connection_status != ConnectionStatus::Established) {
+            // RFC 8446 section 5: Servers may send this for middlebox compatibility, it means nothing in TLS 1.3.
+            dbgln_if(TLS_DEBUG, "ignoring change cipher spec message");
+        } else if (m_context.connection_status != ConnectionStatus::KeyExchange) {
             dbgln("unexpected change cipher message");
             auto packet = build_alert(true, (u8)AlertDescription::UnexpectedMessage);
             write_packet(packet);
@@ -523,7 +556,7 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
         break;
     case MessageType::Alert:
         dbgln_if(TLS_DEBUG, "alert message of length {}", length);
-        if (length >= 2) {
+        if (plain.size() >= 2) {
             if constexpr (TLS_DEBUG)
                 print_buffer(plain);
 
@@ -540,8 +573,8 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
             if (code == (u8)AlertDescription::CloseNotify) {
                 res += 2;
-                alert(AlertLevel::Critical, AlertDescription::CloseNotify);
-                if (!m_context.cipher_spec_set) {
+                alert(AlertLevel::Warning, AlertDescription::CloseNotify);
+                if (!m_context.cipher_spec_set && m_context.connection_status != ConnectionStatus::Established) {
                     // AWS CloudFront hits this.
                     dbgln("Server sent a close notify and we haven't agreed on a cipher suite. Treating it as a handshake failure.");
                     m_context.critical_error = (u8)AlertDescription::HandshakeFailure;
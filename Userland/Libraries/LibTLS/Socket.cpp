@@ -16,6 +16,9 @@
 // which will be sent as a single record containing a single ApplicationData message.
 constexpr static size_t MaximumApplicationDataChunkSize = 16 * KiB;
 
+// How much decrypted application data we read ahead of the client before we stop reading from the socket.
+constexpr static size_t MaximumBufferedApplicationDataSize = 256 * KiB;
+
 namespace TLS {
 
 ErrorOr<Bytes> TLSv12::read(Bytes bytes)
@@ -27,8 +30,11 @@ ErrorOr<Bytes> TLSv12::read(Bytes bytes)
         return Bytes {};
     }
 
-    TRY(m_context.application_buffer.slice(0, size_to_read)).span().copy_to(bytes);
-    m_context.application_buffer = TRY(m_context.application_buffer.slice(size_to_read, m_context.application_buffer.size() - size_to_read));
+    // Shift the rest of the data down in place, reallocating it on every read is quadratic for a large buffer.
+    auto remaining_size = m_context.application_buffer.size() - size_to_read;
+    m_context.application_buffer.span().trim(size_to_read).copy_to(bytes);
+    memmove(m_context.application_buffer.data(), m_context.application_buffer.data() + size_to_read, remaining_size);
+    m_context.application_buffer.resize(remaining_size);
     return Bytes { bytes.data(), size_to_read };
 }
 
@@ -61,7 +67,7 @@ ErrorOr<size_t> TLSv12::write(ReadonlyBytes bytes)
     }
 
     for (size_t offset = 0; offset < bytes.size(); offset += MaximumApplicationDataChunkSize) {
-        PacketBuilder builder { MessageType::ApplicationData, m_context.options.version, bytes.size() - offset };
+        PacketBuilder builder { MessageType::ApplicationData, Version::V12, bytes.size() - offset };
         builder.append(bytes.slice(offset, min(bytes.size() - offset, MaximumApplicationDataChunkSize)));
         auto packet = builder.build();
 
@@ -72,6 +78,22 @@ ErrorOr<size_t> TLSv12::write(ReadonlyBytes bytes)
     return bytes.size();
 }
 
+void TLSv12::write_early_data()
+{
+    // RFC 8446 section 4.2.10: Early data follows the ClientHello right away, protected with the early traffic secret.
+    set_traffic_key(m_context.tls13.client_traffic_secret, true);
+
+    auto bytes = m_context.options.early_data.bytes();
+    for (size_t offset = 0; offset < bytes.size(); offset += MaximumApplicationDataChunkSize) {
+        PacketBuilder builder { MessageType::ApplicationData, Version::V12, bytes.size() - offset };
+        builder.append(bytes.slice(offset, min(bytes.size() - offset, MaximumApplicationDataChunkSize)));
+        auto packet = builder.build();
+
+        update_packet(packet);
+        write_packet(packet);
+    }
+}
+
 ErrorOr<NonnullOwnPtr<TLSv12>> TLSv12::connect(DeprecatedString const& host, u16 port, Options options)
 {
     Core::EventLoop loop;
@@ -147,6 +169,8 @@ void TLSv12::setup_connection()
             }).release_value_but_fixme_should_propagate_errors();
         auto packet = build_hello();
         write_packet(packet);
+        if (m_context.tls13.sent_early_data)
+            write_early_data();
         write_into_socket();
         m_handshake_timeout_timer->start();
         m_context.handshake_initiation_timestamp = Core::DateTime::now().timestamp();
@@ -189,6 +213,8 @@ ErrorOr<void> TLSv12::read_from_socket()
     Bytes bytes { buffer, array_size(buffer) };
     Bytes read_bytes {};
     auto& stream = underlying_stream();
+    // Leave the rest in the socket once the client has enough to chew on, so that a slow reader pushes back
+    // on the peer instead of having the whole response pile up here.
     do {
         auto result = stream.read(bytes);
         if (result.is_error()) {
@@ -201,7 +227,7 @@ ErrorOr<void> TLSv12::read_from_socket()
         }
         read_bytes = result.release_value();
         consume(read_bytes);
-    } while (!read_bytes.is_empty() && !m_context.critical_error);
+    } while (!read_bytes.is_empty() && !m_context.critical_error && m_context.application_buffer.size() < MaximumBufferedApplicationDataSize);
 
     return {};
 }
@@ -317,7 +343,8 @@ ErrorOr<bool> TLSv12::flush()
 
 void TLSv12::close()
 {
-    alert(AlertLevel::Critical, AlertDescription::CloseNotify);
+    // Closing with a fatal alert would keep the server from resuming this session (RFC 5246 section 7.2.2).
+    alert(AlertLevel::Warning, AlertDescription::CloseNotify);
     // bye bye.
     m_context.connection_status = ConnectionStatus::Disconnected;
 }
@@ -181,6 +181,7 @@ void TLSv12::set_root_certificates(Vector<Certificate> certificates)
         dbgln("TLS warn: resetting root certificates!");
         m_context.root_certificates.clear();
     }
+    m_context.uses_default_root_certificates = false;
 
     for (auto& cert : certificates) {
         if (!cert.is_valid())
@@ -208,7 +209,7 @@ static bool wildcard_matches(StringView host, StringView subject)
     return false;
 }
 
-static bool certificate_subject_matches_host(Certificate& cert, StringView host)
+static bool certificate_subject_matches_host(Certificate const& cert, StringView host)
 {
     if (wildcard_matches(host, cert.subject.subject))
         return true;
@@ -246,7 +247,7 @@ bool Context::verify_chain(StringView host) const
     // it in any case.
 
     if (!host.is_empty()) {
-        auto first_certificate = local_chain->first();
+        auto const& first_certificate = local_chain->first();
         auto subject_matches = certificate_subject_matches_host(first_certificate, host);
         if (!subject_matches) {
             dbgln("verify_chain: First certificate does not match the hostname");
@@ -259,7 +260,7 @@ bool Context::verify_chain(StringView host) const
     }
 
     for (size_t cert_index = 0; cert_index < local_chain->size(); ++cert_index) {
-        auto cert = local_chain->at(cert_index);
+        auto const& cert = local_chain->at(cert_index);
 
         auto subject_string = cert.subject_identifier_string();
         auto issuer_string = cert.issuer_identifier_string();
@@ -269,7 +270,7 @@ bool Context::verify_chain(StringView host) const
             return false;
         }
 
-        auto maybe_root_certificate = root_certificates.get(issuer_string);
+        auto maybe_root_certificate = find_root_certificate(issuer_string);
         if (maybe_root_certificate.has_value()) {
             auto& root_certificate = *maybe_root_certificate;
             auto verification_correct = verify_certificate_pair(cert, root_certificate);
@@ -293,7 +294,7 @@ bool Context::verify_chain(StringView host) const
             return false;
         }
 
-        auto parent_certificate = local_chain->at(cert_index + 1);
+        auto const& parent_certificate = local_chain->at(cert_index + 1);
         if (issuer_string != parent_certificate.subject_identifier_string()) {
             dbgln("verify_chain: Next certificate in the chain is not the issuer of this certificate");
             return false;
@@ -319,8 +320,20 @@ bool Context::verify_chain(StringView host) const
     VERIFY_NOT_REACHED();
 }
 
+Optional<Certificate const&> Context::find_root_certificate(DeprecatedString const& subject) const
+{
+    if (uses_default_root_certificates)
+        return DefaultRootCACertificates::the().certificates().get(subject);
+    return root_certificates.get(subject);
+}
+
 bool Context::verify_certificate_pair(Certificate const& subject, Certificate const& issuer) const
 {
+    // Checking an RSA signature is the costliest part of verifying a chain, and the same chains come up all the time.
+    auto& cache = CertificateCache::the();
+    if (cache.has_verified_signature(subject, issuer))
+        return true;
+
     Crypto::Hash::HashKind kind;
     switch (subject.signature_algorithm) {
     case CertificateKeyAlgorithm::RSA_SHA1:
@@ -357,7 +370,11 @@ bool Context::verify_certificate_pair(Certificate const& subject, Certificate co
     ReadonlyBytes message = subject.original_asn1.bytes().slice(4, subject.original_asn1.size() - 4 - (5 + subject.signature_value.size()) - 15);
     auto pkcs1 = Crypto::PK::EMSA_PKCS1_V1_5<Crypto::Hash::Manager>(kind);
     auto verification = pkcs1.verify(message, verification_buffer_bytes, subject.signature_value.size() * 8);
-    return verification == Crypto::VerificationConsistency::Consistent;
+    if (verification != Crypto::VerificationConsistency::Consistent)
+        return false;
+
+    cache.did_verify_signature(subject, issuer);
+    return true;
 }
 
 template<typename HMACType>
@@ -433,10 +450,12 @@ TLSv12::TLSv12(StreamVariantType stream, Options options)
     m_context.options = move(options);
     m_context.is_server = false;
     m_context.tls_buffer = {};
+    m_context.alpn = m_context.options.alpn_protocols;
 
-    set_root_certificates(m_context.options.root_certificates.has_value()
-            ? *m_context.options.root_certificates
-            : DefaultRootCACertificates::the().certificates());
+    if (m_context.options.root_certificates.has_value())
+        set_root_certificates(*m_context.options.root_certificates);
+    else
+        m_context.uses_default_root_certificates = true;
 
     setup_connection();
 }
@@ -499,7 +518,10 @@ void DefaultRootCACertificates::reload_certificates(Core::ConfigFile& config)
                 continue;
             }
             auto certificate = certificate_result.release_value();
-            m_ca_certificates.append(move(certificate));
+            if (!certificate.is_valid())
+                dbgln("Certificate for {} by {} is invalid, things may or may not work!", certificate.subject.subject, certificate.issuer.subject);
+            auto subject_identifier = certificate.subject_identifier_string();
+            m_ca_certificates.set(move(subject_identifier), move(certificate));
         }
     }
 
@@ -8,6 +8,7 @@
 
 #include "Certificate.h"
 #include <AK/IPv4Address.h>
+#include <AK/Time.h>
 #include <AK/WeakPtr.h>
 #include <LibCore/Notifier.h>
 #include <LibCore/Stream.h>
@@ -15,6 +16,7 @@
 #include <LibCrypto/Authentication/HMAC.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
 #include <LibCrypto/Cipher/AES.h>
+#include <LibCrypto/Cipher/ChaCha20Poly1305.h>
 #include <LibCrypto/Curves/EllipticCurve.h>
 #include <LibCrypto/Hash/HashManager.h>
 #include <LibCrypto/PK/RSA.h>
@@ -123,13 +125,18 @@ enum HandshakeType {
     ClientHello = 0x01,
     ServerHello = 0x02,
     HelloVerifyRequest = 0x03,
+    NewSessionTicket = 0x04,
+    EndOfEarlyData = 0x05,
+    EncryptedExtensions = 0x08,
     CertificateMessage = 0x0b,
     ServerKeyExchange = 0x0c,
     CertificateRequest = 0x0d,
     ServerHelloDone = 0x0e,
     CertificateVerify = 0x0f,
     ClientKeyExchange = 0x10,
-    Finished = 0x14
+    Finished = 0x14,
+    KeyUpdate = 0x18,
+    MessageHash = 0xfe,
 };
 
 enum class HandshakeExtension : u16 {
@@ -138,6 +145,13 @@ enum class HandshakeExtension : u16 {
     ECPointFormats = 0x0b,
     SignatureAlgorithms = 0x0d,
     ApplicationLayerProtocolNegotiation = 0x10,
+    SessionTicket = 0x23,
+    PreSharedKey = 0x29,
+    EarlyData = 0x2a,
+    SupportedVersions = 0x2b,
+    Cookie = 0x2c,
+    PskKeyExchangeModes = 0x2d,
+    KeyShare = 0x33,
 };
 
 enum class NameType : u8 {
@@ -149,6 +163,10 @@ enum class WritePacketStage {
     ClientHandshake = 1,
     ServerHandshake = 2,
     Finished = 3,
+    // TLS 1.3: Once the ServerHello is part of the transcript, switch to the handshake traffic keys.
+    HandshakeTrafficKeys = 4,
+    // TLS 1.3: Once the HelloRetryRequest is part of the transcript, send a new ClientHello.
+    HelloRetry = 5,
 };
 
 enum class ConnectionStatus {
@@ -168,11 +186,16 @@ enum class ECCurveType : u8 {
     NamedCurve = 3,
 };
 
+// Note for the 12 iv length of the TLS 1.3 cipher suites:
+// TLS 1.3 does not transmit any part of the nonce, which is the whole IV combined with the sequence number.
 // Note for the 16 iv length instead of 8:
 // 4 bytes of fixed IV, 8 random (nonce) bytes, 4 bytes for counter
 // GCM specifically asks us to transmit only the nonce, the counter is zero
 // and the fixed IV is derived from the premaster key.
 #define ENUMERATE_CIPHERS(C)                                                                                                                              \
+    C(true, CipherSuite::AES_128_GCM_SHA256, KeyExchangeAlgorithm::Invalid, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 12, true)                 \
+    C(true, CipherSuite::AES_256_GCM_SHA384, KeyExchangeAlgorithm::Invalid, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 12, true)                 \
+    C(true, CipherSuite::CHACHA20_POLY1305_SHA256, KeyExchangeAlgorithm::Invalid, CipherAlgorithm::CHACHA20_POLY1305, Crypto::Hash::SHA256, 12, true)     \
     C(true, CipherSuite::RSA_WITH_AES_128_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA1, 16, false)                \
     C(true, CipherSuite::RSA_WITH_AES_256_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_CBC, Crypto::Hash::SHA1, 16, false)                \
     C(true, CipherSuite::RSA_WITH_AES_128_CBC_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA256, 16, false)           \
@@ -210,6 +233,38 @@ constexpr CipherAlgorithm get_cipher_algorithm(CipherSuite suite)
     }
 }
 
+// The cipher suites of TLS 1.3 only name the AEAD and the hash, so they can't be used with any other version.
+constexpr bool is_tls13_cipher_suite(CipherSuite suite)
+{
+    return get_cipher_algorithm(suite) != CipherAlgorithm::Invalid && get_key_exchange_algorithm(suite) == KeyExchangeAlgorithm::Invalid;
+}
+
+// RFC 8446 section 4.1.3: A ServerHello with this random is a HelloRetryRequest.
+constexpr u8 hello_retry_request_random[32] = {
+    0xcf, 0x21, 0xad, 0x74, 0xe5, 0x9a, 0x61, 0x11, 0xbe, 0x1d, 0x8c, 0x02, 0x1e, 0x65, 0xb8, 0x91,
+    0xc2, 0xa2, 0x11, 0x16, 0x7a, 0xbb, 0x8c, 0x5e, 0x07, 0x9e, 0x09, 0xe2, 0xc8, 0xa8, 0x33, 0x9c
+};
+
+// RFC 8446 section 4.1.3: A server that supports TLS 1.3 ends its random with this when it negotiates TLS 1.2.
+constexpr u8 tls12_downgrade_random_suffix[8] = { 'D', 'O', 'W', 'N', 'G', 'R', 'D', 0x01 };
+
+// What it takes to resume an earlier session with a server in an abbreviated handshake, which skips the key exchange
+// and the verification of the certificate chain (RFC 5246 section 7.3, RFC 5077).
+// In TLS 1.3, the master key holds the pre-shared key derived from the resumption secret (RFC 8446 section 4.6.1).
+struct SessionState {
+    CipherSuite cipher { CipherSuite::Invalid };
+    Version version { Version::V12 };
+    ByteBuffer master_key;
+    ByteBuffer session_id;
+    ByteBuffer ticket;
+
+    // TLS 1.3 tickets carry their own lifetime, the value that hides their age, and how much early data they allow.
+    Time ticket_received_at {};
+    u32 ticket_lifetime { 0 };
+    u32 ticket_age_add { 0 };
+    u32 max_early_data_size { 0 };
+};
+
 struct Options {
     static Vector<CipherSuite> default_usable_cipher_suites()
     {
@@ -240,8 +295,12 @@ struct Options {
         return move(*this);                  \
     }
 
-    OPTION_WITH_DEFAULTS(Version, version, Version::V12)
+    // The highest version to offer; TLS 1.2 is always offered as well.
+    OPTION_WITH_DEFAULTS(Version, version, Version::V13)
     OPTION_WITH_DEFAULTS(Vector<SignatureAndHashAlgorithm>, supported_signature_algorithms,
+        { HashAlgorithm::Intrinsic, SignatureAlgorithm::RSA_PSS_RSAE_SHA256 },
+        { HashAlgorithm::Intrinsic, SignatureAlgorithm::RSA_PSS_RSAE_SHA384 },
+        { HashAlgorithm::Intrinsic, SignatureAlgorithm::RSA_PSS_RSAE_SHA512 },
         { HashAlgorithm::SHA512, SignatureAlgorithm::RSA },
         { HashAlgorithm::SHA384, SignatureAlgorithm::RSA },
         { HashAlgorithm::SHA256, SignatureAlgorithm::RSA },
@@ -260,6 +319,14 @@ struct Options {
     OPTION_WITH_DEFAULTS(Function<void(AlertDescription)>, alert_handler, [](auto) {})
     OPTION_WITH_DEFAULTS(Function<void()>, finish_callback, [] {})
     OPTION_WITH_DEFAULTS(Function<Vector<Certificate>()>, certificate_provider, [] { return Vector<Certificate> {}; })
+    OPTION_WITH_DEFAULTS(Optional<SessionState>, session_to_resume, )
+    OPTION_WITH_DEFAULTS(Function<void(SessionState const&)>, session_handler, [](auto&) {})
+    // Application data to send as soon as possible: Along with the ClientHello as TLS 1.3 early data, if the session
+    // to resume allows it, and otherwise (or if the server rejects it) right after the handshake.
+    // Early data can be replayed by an attacker, so it should only ever be an idempotent request (RFC 8446 section 8).
+    OPTION_WITH_DEFAULTS(ByteBuffer, early_data, )
+    // The application protocols to offer with ALPN (RFC 7301), most preferred first. Check alpn() for the one the server chose.
+    OPTION_WITH_DEFAULTS(Vector<DeprecatedString>, alpn_protocols, )
 
 #undef OPTION_WITH_DEFAULTS
 };
@@ -267,6 +334,7 @@ struct Options {
 struct Context {
     bool verify_chain(StringView host) const;
     bool verify_certificate_pair(Certificate const& subject, Certificate const& issuer) const;
+    Optional<Certificate const&> find_root_certificate(DeprecatedString const& subject) const;
 
     Options options;
 
@@ -274,7 +342,10 @@ struct Context {
     u8 local_random[32];
     u8 session_id[32];
     u8 session_id_size { 0 };
-    CipherSuite cipher;
+    ByteBuffer session_ticket;
+    bool is_resuming_session { false };
+    CipherSuite cipher { CipherSuite::Invalid };
+    Version version { Version::V12 };
     bool is_server { false };
     Vector<Certificate> certificates;
     Certificate private_key;
@@ -324,12 +395,14 @@ struct Context {
     bool has_invoked_finish_or_error_callback { false };
 
     // message flags
-    u8 handshake_messages[11] { 0 };
+    u8 handshake_messages[13] { 0 };
     ByteBuffer user_data;
+    // Our own root certificates by subject, unless we use the process-wide DefaultRootCACertificates.
     HashMap<DeprecatedString, Certificate> root_certificates;
+    bool uses_default_root_certificates { false };
 
     Vector<DeprecatedString> alpn;
-    StringView negotiated_alpn;
+    DeprecatedString negotiated_alpn;
 
     size_t send_retries { 0 };
 
@@ -342,6 +415,25 @@ struct Context {
     } server_diffie_hellman_params;
 
     OwnPtr<Crypto::Curves::EllipticCurve> server_key_exchange_curve;
+
+    // The key schedule of TLS 1.3 (RFC 8446 section 7.1), and what we offered in our ClientHello.
+    struct {
+        NamedCurve key_share_group { NamedCurve::x25519 };
+        ByteBuffer key_share_private_key;
+        ByteBuffer cookie;
+        // The message_hash and HelloRetryRequest messages that start the transcript after a HelloRetryRequest.
+        ByteBuffer hello_retry_transcript;
+        bool offered_psk { false };
+        bool accepted_psk { false };
+        bool sent_early_data { false };
+        bool accepted_early_data { false };
+        u8 certificate_request_context_size { 0 };
+        u8 certificate_request_context[255];
+        ByteBuffer secret;
+        ByteBuffer client_traffic_secret;
+        ByteBuffer server_traffic_secret;
+        ByteBuffer resumption_secret;
+    } tls13;
 };
 
 class TLSv12 final : public Core::Stream::Socket {
@@ -421,7 +513,7 @@ public:
 
     bool supports_version(Version v) const
     {
-        return v == Version::V12;
+        return v == Version::V12 || (v == Version::V13 && m_context.options.version >= Version::V13);
     }
 
     void alert(AlertLevel, AlertDescription);
@@ -468,6 +560,8 @@ private:
     void notify_client_for_app_data();
 
     ssize_t handle_server_hello(ReadonlyBytes, WritePacketStage&);
+    ssize_t handle_selected_alpn(ReadonlyBytes extension);
+    ssize_t handle_new_session_ticket(ReadonlyBytes);
     ssize_t handle_handshake_finished(ReadonlyBytes, WritePacketStage&);
     ssize_t handle_certificate(ReadonlyBytes);
     ssize_t handle_server_key_exchange(ReadonlyBytes);
@@ -478,9 +572,38 @@ private:
     ssize_t handle_handshake_payload(ReadonlyBytes);
     ssize_t handle_message(ReadonlyBytes);
 
+    void did_establish_connection();
+
+    // TLS 1.3
+    bool should_offer_tls13() const;
+    void build_tls13_hello_extensions(PacketBuilder&);
+    void bind_psk_to_hello(ByteBuffer& packet);
+    void write_early_data();
+    ssize_t handle_tls13_server_hello(ReadonlyBytes key_share, Optional<u16> selected_identity, WritePacketStage&);
+    ssize_t handle_hello_retry_request(ReadonlyBytes message, ReadonlyBytes key_share, ReadonlyBytes cookie, WritePacketStage&);
+    ssize_t handle_encrypted_extensions(ReadonlyBytes);
+    ssize_t handle_tls13_certificate_request(ReadonlyBytes);
+    ssize_t handle_tls13_certificate(ReadonlyBytes);
+    ssize_t handle_tls13_certificate_verify(ReadonlyBytes);
+    ssize_t handle_tls13_handshake_finished(ReadonlyBytes, WritePacketStage&);
+    ssize_t handle_tls13_new_session_ticket(ReadonlyBytes);
+    ssize_t handle_key_update(ReadonlyBytes);
+    void write_tls13_client_handshake();
+    ByteBuffer build_tls13_handshake_message(HandshakeType, ReadonlyBytes body);
+    ByteBuffer build_tls13_handshake_finished();
+    void derive_handshake_traffic_keys();
+    void set_traffic_key(ReadonlyBytes traffic_secret, bool local);
+    ByteBuffer derive_secret(ReadonlyBytes secret, StringView label, ReadonlyBytes transcript_hash) const;
+    ByteBuffer expand_label(ReadonlyBytes secret, StringView label, ReadonlyBytes context, size_t length) const;
+    ByteBuffer finished_verify_data(ReadonlyBytes base_key, ReadonlyBytes transcript_hash) const;
+    ByteBuffer transcript_hash();
+    ByteBuffer protect_tls13_record(ReadonlyBytes packet);
+    ssize_t unprotect_tls13_record(ReadonlyBytes record, ByteBuffer& plaintext, MessageType& type);
+
     void pseudorandom_function(Bytes output, ReadonlyBytes secret, u8 const* label, size_t label_length, ReadonlyBytes seed, ReadonlyBytes seed_b);
 
     ssize_t verify_rsa_server_key_exchange(ReadonlyBytes server_key_info_buffer, ReadonlyBytes signature_buffer);
+    ssize_t verify_rsa_signature(ReadonlyBytes message, SignatureAndHashAlgorithm, ReadonlyBytes signature);
 
     size_t key_length() const
     {
@@ -564,7 +687,8 @@ private:
     using CipherVariant = Variant<
         Empty,
         Crypto::Cipher::AESCipher::CBCMode,
-        Crypto::Cipher::AESCipher::GCMMode>;
+        Crypto::Cipher::AESCipher::GCMMode,
+        Crypto::Cipher::ChaCha20Poly1305>;
     CipherVariant m_cipher_local {};
     CipherVariant m_cipher_remote {};
 
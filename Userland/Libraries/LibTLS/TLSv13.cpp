@@ -0,0 +1,824 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/AnyOf.h>
+#include <AK/Debug.h>
+#include <AK/Endian.h>
+#include <AK/Memory.h>
+#include <LibCrypto/Curves/SECP256r1.h>
+#include <LibCrypto/Curves/X25519.h>
+#include <LibCrypto/Curves/X448.h>
+#include <LibCrypto/Hash/HKDF.h>
+#include <LibTLS/TLSv12.h>
+
+namespace TLS {
+
+using HKDF = Crypto::Hash::HKDF<Crypto::Hash::Manager>;
+
+// RFC 8446 section 4.6.1: Servers must not hand out tickets that live longer than seven days.
+static constexpr u32 maximum_ticket_lifetime = 7 * 24 * 60 * 60;
+
+static OwnPtr<Crypto::Curves::EllipticCurve> create_curve(NamedCurve curve)
+{
+    switch (curve) {
+    case NamedCurve::x25519:
+        return make<Crypto::Curves::X25519>();
+    case NamedCurve::x448:
+        return make<Crypto::Curves::X448>();
+    case NamedCurve::secp256r1:
+        return make<Crypto::Curves::SECP256r1>();
+    default:
+        return {};
+    }
+}
+
+static size_t digest_size_of(CipherSuite suite)
+{
+    switch (suite) {
+#define C(is_supported, suite, key_exchange, cipher, hash, iv_size, is_aead) \
+    case suite:                                                              \
+        return hash ::digest_size();
+        ENUMERATE_CIPHERS(C)
+#undef C
+    default:
+        return 0;
+    }
+}
+
+static ByteBuffer hash_messages(Crypto::Hash::HashKind kind, ReadonlyBytes first, ReadonlyBytes second = {})
+{
+    Crypto::Hash::Manager hash(kind);
+    hash.update(first);
+    hash.update(second);
+    auto digest = hash.digest();
+    return ByteBuffer::copy(digest.immutable_data(), hash.digest_size()).release_value_but_fixme_should_propagate_errors();
+}
+
+static u16 read_u16(ReadonlyBytes buffer, size_t offset)
+{
+    return AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(offset)));
+}
+
+static u32 read_u32(ReadonlyBytes buffer, size_t offset)
+{
+    return AK::convert_between_host_and_network_endian(ByteReader::load32(buffer.offset_pointer(offset)));
+}
+
+bool TLSv12::should_offer_tls13() const
+{
+    if (m_context.options.version < Version::V13 || m_context.options.elliptic_curves.is_empty())
+        return false;
+    return any_of(m_context.options.usable_cipher_suites, [](auto suite) { return is_tls13_cipher_suite(suite); });
+}
+
+void TLSv12::build_tls13_hello_extensions(PacketBuilder& builder)
+{
+    auto& tls13 = m_context.tls13;
+    bool is_hello_retry = !tls13.hello_retry_transcript.is_empty();
+
+    // supported_versions
+    builder.append((u16)HandshakeExtension::SupportedVersions);
+    builder.append((u16)5);
+    builder.append((u8)4);
+    builder.append((u16)Version::V13);
+    builder.append((u16)Version::V12);
+
+    // key_share: A single share, for the group a HelloRetryRequest asked for, or else the one we like best.
+    if (!is_hello_retry && !m_context.options.elliptic_curves.contains_slow(tls13.key_share_group))
+        tls13.key_share_group = m_context.options.elliptic_curves.first();
+    auto curve = create_curve(tls13.key_share_group);
+    VERIFY(curve);
+    if (tls13.key_share_private_key.is_empty())
+        tls13.key_share_private_key = curve->generate_private_key().release_value_but_fixme_should_propagate_errors();
+    auto public_key = curve->generate_public_key(tls13.key_share_private_key).release_value_but_fixme_should_propagate_errors();
+    builder.append((u16)HandshakeExtension::KeyShare);
+    builder.append((u16)(public_key.size() + 6));
+    builder.append((u16)(public_key.size() + 4));
+    builder.append((u16)tls13.key_share_group);
+    builder.append((u16)public_key.size());
+    builder.append(public_key);
+
+    // psk_key_exchange_modes: We only resume with a fresh key exchange (psk_dhe_ke).
+    builder.append((u16)HandshakeExtension::PskKeyExchangeModes);
+    builder.append((u16)2);
+    builder.append((u8)1);
+    builder.append((u8)1);
+
+    // cookie: Echoed verbatim from the HelloRetryRequest.
+    if (!tls13.cookie.is_empty()) {
+        builder.append((u16)HandshakeExtension::Cookie);
+        builder.append((u16)tls13.cookie.size());
+        builder.append(tls13.cookie);
+    }
+
+    // Offer to resume a TLS 1.3 session with the pre-shared key of its ticket, as long as the ticket is fresh and
+    // (after a HelloRetryRequest) its hash matches the cipher suite the server picked.
+    tls13.offered_psk = false;
+    tls13.sent_early_data = false;
+    auto const& session = m_context.options.session_to_resume;
+    if (!session.has_value() || session->version != Version::V13 || session->ticket.is_empty())
+        return;
+    if (!m_context.options.usable_cipher_suites.contains_slow(session->cipher))
+        return;
+    auto ticket_age = (Time::now_monotonic() - session->ticket_received_at).to_milliseconds();
+    if (ticket_age < 0 || ticket_age >= (i64)session->ticket_lifetime * 1000)
+        return;
+    if (is_hello_retry && digest_size_of(session->cipher) != mac_length())
+        return;
+
+    if (!is_hello_retry)
+        m_context.cipher = session->cipher;
+    tls13.offered_psk = true;
+
+    // RFC 8446 section 4.2.10: Early data is only allowed in the first ClientHello, and only as much as the ticket says.
+    auto const& early_data = m_context.options.early_data;
+    if (!is_hello_retry && !early_data.is_empty() && early_data.size() <= session->max_early_data_size) {
+        tls13.sent_early_data = true;
+        builder.append((u16)HandshakeExtension::EarlyData);
+        builder.append((u16)0);
+    }
+
+    // pre_shared_key: This has to be the last extension, its binder is filled in by bind_psk_to_hello().
+    auto binder_length = digest_size_of(session->cipher);
+    auto identities_length = 2 + session->ticket.size() + 4;
+    BigEndian<u32> obfuscated_ticket_age = (u32)ticket_age + session->ticket_age_add;
+    builder.append((u16)HandshakeExtension::PreSharedKey);
+    builder.append((u16)(2 + identities_length + 2 + 1 + binder_length));
+    builder.append((u16)identities_length);
+    builder.append((u16)session->ticket.size());
+    builder.append(session->ticket);
+    builder.append((u8 const*)&obfuscated_ticket_age, sizeof(obfuscated_ticket_age));
+    builder.append((u16)(1 + binder_length));
+    builder.append((u8)binder_length);
+    for (size_t i = 0; i < binder_length; ++i)
+        builder.append((u8)0);
+}
+
+void TLSv12::bind_psk_to_hello(ByteBuffer& packet)
+{
+    // RFC 8446 section 4.2.11.2: The binder is a Finished-style MAC over the ClientHello up to the binders, which
+    // proves that we hold the pre-shared key and ties it to this handshake.
+    auto& tls13 = m_context.tls13;
+    auto kind = hmac_hash();
+    auto binder_length = mac_length();
+    constexpr size_t header_size = 5;
+    auto truncated_hello = packet.bytes().slice(header_size, packet.size() - header_size - 3 - binder_length);
+
+    auto early_secret = HKDF::extract({}, m_context.options.session_to_resume->master_key, kind);
+    tls13.secret = ByteBuffer::copy(early_secret.immutable_data(), binder_length).release_value_but_fixme_should_propagate_errors();
+    auto binder_key = derive_secret(tls13.secret, "res binder"sv, hash_messages(kind, {}));
+    auto binder = finished_verify_data(binder_key, hash_messages(kind, tls13.hello_retry_transcript, truncated_hello));
+    packet.overwrite(packet.size() - binder_length, binder.data(), binder_length);
+
+    if (tls13.sent_early_data)
+        tls13.client_traffic_secret = derive_secret(tls13.secret, "c e traffic"sv, hash_messages(kind, packet.bytes().slice(header_size)));
+}
+
+ssize_t TLSv12::handle_hello_retry_request(ReadonlyBytes message, ReadonlyBytes key_share, ReadonlyBytes cookie, WritePacketStage& write_packets)
+{
+    auto& tls13 = m_context.tls13;
+    if (!tls13.hello_retry_transcript.is_empty()) {
+        dbgln("Server sent a second HelloRetryRequest");
+        return (i8)Error::UnexpectedMessage;
+    }
+
+    bool changes_hello = false;
+    if (!key_share.is_empty()) {
+        if (key_share.size() != 2)
+            return (i8)Error::BrokenPacket;
+        auto group = static_cast<NamedCurve>(read_u16(key_share, 0));
+        if (group == tls13.key_share_group || !m_context.options.elliptic_curves.contains_slow(group) || !create_curve(group)) {
+            dbgln("HelloRetryRequest asked for a group we can't use: {}", (u16)group);
+            return (i8)Error::NotSafe;
+        }
+        tls13.key_share_group = group;
+        tls13.key_share_private_key.clear();
+        changes_hello = true;
+    }
+    if (!cookie.is_empty()) {
+        auto cookie_copy = ByteBuffer::copy(cookie);
+        if (cookie_copy.is_error())
+            return (i8)Error::OutOfMemory;
+        tls13.cookie = cookie_copy.release_value();
+        changes_hello = true;
+    }
+    if (!changes_hello) {
+        dbgln("HelloRetryRequest would not change our ClientHello");
+        return (i8)Error::NotSafe;
+    }
+
+    // RFC 8446 section 4.4.1: The first ClientHello is replaced in the transcript by a message_hash message with its hash.
+    m_context.handshake_hash.initialize(hmac_hash());
+    m_context.handshake_hash.update(ReadonlyBytes {});
+    auto client_hello_hash = m_context.handshake_hash.digest();
+    auto hash_size = m_context.handshake_hash.digest_size();
+    u8 message_hash_header[4] = { HandshakeType::MessageHash, 0, 0, (u8)hash_size };
+    m_context.handshake_hash.update(message_hash_header, sizeof(message_hash_header));
+    m_context.handshake_hash.update(client_hello_hash.immutable_data(), hash_size);
+
+    // Keep the transcript so far around for the binder of the second ClientHello.
+    u8 server_hello_type = HandshakeType::ServerHello;
+    auto transcript = ByteBuffer::create_uninitialized(sizeof(message_hash_header) + hash_size + 1 + message.size());
+    if (transcript.is_error())
+        return (i8)Error::OutOfMemory;
+    tls13.hello_retry_transcript = transcript.release_value();
+    tls13.hello_retry_transcript.overwrite(0, message_hash_header, sizeof(message_hash_header));
+    tls13.hello_retry_transcript.overwrite(sizeof(message_hash_header), client_hello_hash.immutable_data(), hash_size);
+    tls13.hello_retry_transcript.overwrite(sizeof(message_hash_header) + hash_size, &server_hello_type, 1);
+    tls13.hello_retry_transcript.overwrite(sizeof(message_hash_header) + hash_size + 1, message.data(), message.size());
+
+    // The real ServerHello is yet to come, and any early data we sent is lost.
+    m_context.handshake_messages[2] = 0;
+    m_cipher_local = Empty {};
+    tls13.offered_psk = false;
+    tls13.sent_early_data = false;
+
+    write_packets = WritePacketStage::HelloRetry;
+    return 0;
+}
+
+ssize_t TLSv12::handle_tls13_server_hello(ReadonlyBytes key_share, Optional<u16> selected_identity, WritePacketStage& write_packets)
+{
+    auto& tls13 = m_context.tls13;
+
+    // struct { NamedGroup group; opaque key_exchange<1..2^16-1>; } KeyShareEntry;
+    if (key_share.size() < 4) {
+        dbgln("ServerHello without a key share");
+        return (i8)Error::NotSafe;
+    }
+    auto group = static_cast<NamedCurve>(read_u16(key_share, 0));
+    auto key_exchange_length = read_u16(key_share, 2);
+    if (key_share.size() != 4u + key_exchange_length)
+        return (i8)Error::BrokenPacket;
+    if (group != tls13.key_share_group) {
+        dbgln("ServerHello picked a group we didn't send a share for: {}", (u16)group);
+        return (i8)Error::NotSafe;
+    }
+
+    auto curve = create_curve(group);
+    auto shared_point = curve->compute_coordinate(tls13.key_share_private_key, key_share.slice(4));
+    if (shared_point.is_error()) {
+        dbgln("Failed to compute the shared secret: {}", shared_point.error());
+        return (i8)Error::NotSafe;
+    }
+    auto shared_secret = curve->derive_premaster_key(shared_point.value());
+    if (shared_secret.is_error())
+        return (i8)Error::OutOfMemory;
+    m_context.premaster_key = shared_secret.release_value();
+    tls13.key_share_private_key.clear();
+
+    tls13.accepted_psk = selected_identity.has_value();
+    if (tls13.accepted_psk && (!tls13.offered_psk || *selected_identity != 0 || digest_size_of(m_context.options.session_to_resume->cipher) != mac_length())) {
+        dbgln("ServerHello selected a pre-shared key we didn't offer");
+        return (i8)Error::NotSafe;
+    }
+
+    // RFC 8446 section 7.1: Without a pre-shared key, the early secret is derived from a string of zeros.
+    auto kind = hmac_hash();
+    auto hash_size = mac_length();
+    auto zeros = ByteBuffer::create_zeroed(hash_size).release_value_but_fixme_should_propagate_errors();
+    ReadonlyBytes psk = tls13.accepted_psk ? m_context.options.session_to_resume->master_key.bytes() : zeros.bytes();
+    auto early_secret = HKDF::extract({}, psk, kind);
+    auto derived = derive_secret({ early_secret.immutable_data(), hash_size }, "derived"sv, hash_messages(kind, {}));
+    auto handshake_secret = HKDF::extract(derived, m_context.premaster_key, kind);
+    tls13.secret = ByteBuffer::copy(handshake_secret.immutable_data(), hash_size).release_value_but_fixme_should_propagate_errors();
+    m_context.premaster_key.clear();
+
+    write_packets = WritePacketStage::HandshakeTrafficKeys;
+    return 0;
+}
+
+void TLSv12::derive_handshake_traffic_keys()
+{
+    auto& tls13 = m_context.tls13;
+    auto hash = transcript_hash();
+    tls13.client_traffic_secret = derive_secret(tls13.secret, "c hs traffic"sv, hash);
+    tls13.server_traffic_secret = derive_secret(tls13.secret, "s hs traffic"sv, hash);
+
+    set_traffic_key(tls13.server_traffic_secret, false);
+    // Our early data is still protected with the early traffic key until we send EndOfEarlyData.
+    if (!tls13.sent_early_data)
+        set_traffic_key(tls13.client_traffic_secret, true);
+}
+
+ssize_t TLSv12::handle_encrypted_extensions(ReadonlyBytes buffer)
+{
+    if (buffer.size() < 5)
+        return (i8)Error::NeedMoreData;
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+    size_t extensions_length = read_u16(buffer, 3);
+    if (extensions_length + 2 != size)
+        return (i8)Error::BrokenPacket;
+
+    size_t offset = 5;
+    while (offset + 4 <= 3 + size) {
+        auto extension_type = static_cast<HandshakeExtension>(read_u16(buffer, offset));
+        size_t extension_length = read_u16(buffer, offset + 2);
+        offset += 4;
+        if (offset + extension_length > 3 + size)
+            return (i8)Error::BrokenPacket;
+
+        if (extension_type == HandshakeExtension::EarlyData) {
+            if (!m_context.tls13.sent_early_data) {
+                dbgln("Server accepted early data we didn't send");
+                return (i8)Error::UnexpectedMessage;
+            }
+            m_context.tls13.accepted_early_data = true;
+        } else if (extension_type == HandshakeExtension::ApplicationLayerProtocolNegotiation) {
+            if (auto result = handle_selected_alpn(buffer.slice(offset, extension_length)); result < 0)
+                return result;
+        } else {
+            dbgln_if(TLS_DEBUG, "Encrypted extension {} with length {}", (u16)extension_type, extension_length);
+        }
+        offset += extension_length;
+    }
+
+    return 3 + size;
+}
+
+ssize_t TLSv12::handle_tls13_certificate_request(ReadonlyBytes buffer)
+{
+    // struct { opaque certificate_request_context<0..2^8-1>; Extension extensions<2..2^16-1>; } CertificateRequest;
+    if (buffer.size() < 4)
+        return (i8)Error::NeedMoreData;
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+    u8 context_size = buffer[3];
+    if (size < 1u + context_size)
+        return (i8)Error::BrokenPacket;
+
+    memcpy(m_context.tls13.certificate_request_context, buffer.offset_pointer(4), context_size);
+    m_context.tls13.certificate_request_context_size = context_size;
+
+    dbgln("certificate request");
+    if (on_tls_certificate_request)
+        on_tls_certificate_request(*this);
+    m_context.client_verified = VerificationNeeded;
+
+    return 3 + size;
+}
+
+ssize_t TLSv12::handle_tls13_certificate(ReadonlyBytes buffer)
+{
+    // struct { opaque certificate_request_context<0..2^8-1>; CertificateEntry certificate_list<0..2^24-1>; } Certificate;
+    // struct { opaque cert_data<1..2^24-1>; Extension extensions<0..2^16-1>; } CertificateEntry;
+    // Strip the request context and the extensions of each entry, and leave the rest to the TLS 1.2 parser.
+    if (buffer.size() < 7)
+        return (i8)Error::NeedMoreData;
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+    u8 context_size = buffer[3];
+    if (context_size != 0 || size < 4) {
+        dbgln("Server certificate with a request context");
+        return (i8)Error::BrokenPacket;
+    }
+    size_t list_length = buffer[4] * 0x10000 + buffer[5] * 0x100 + buffer[6];
+    if (list_length + 4 != size)
+        return (i8)Error::BrokenPacket;
+
+    auto certificates = ByteBuffer::create_uninitialized(6 + list_length);
+    if (certificates.is_error())
+        return (i8)Error::OutOfMemory;
+    auto& converted = certificates.value();
+    size_t converted_length = 6;
+    size_t offset = 7;
+    while (offset < 3 + size) {
+        if (offset + 3 > 3 + size)
+            return (i8)Error::BrokenPacket;
+        size_t certificate_length = buffer[offset] * 0x10000 + buffer[offset + 1] * 0x100 + buffer[offset + 2];
+        if (offset + 3 + certificate_length + 2 > 3 + size)
+            return (i8)Error::BrokenPacket;
+        converted.overwrite(converted_length, buffer.offset_pointer(offset), 3 + certificate_length);
+        converted_length += 3 + certificate_length;
+        offset += 3 + certificate_length;
+        size_t extensions_length = read_u16(buffer, offset);
+        offset += 2 + extensions_length;
+    }
+    if (offset != 3 + size)
+        return (i8)Error::BrokenPacket;
+
+    // Rebuild the TLS 1.2 message around the certificates: Its length, then the length of the certificate_list.
+    auto write_u24 = [&](size_t position, size_t value) {
+        converted[position] = value / 0x10000;
+        converted[position + 1] = (value / 0x100) % 0x100;
+        converted[position + 2] = value % 0x100;
+    };
+    write_u24(0, converted_length - 3);
+    write_u24(3, converted_length - 6);
+    auto result = handle_certificate({ converted.data(), converted_length });
+    if (result < 0)
+        return result;
+
+    if (!m_context.verify_chain(m_context.extensions.SNI)) {
+        dbgln("certificate verification failed :(");
+        return (i8)Error::BadCertificate;
+    }
+
+    return 3 + size;
+}
+
+ssize_t TLSv12::handle_tls13_certificate_verify(ReadonlyBytes buffer)
+{
+    // struct { SignatureScheme algorithm; opaque signature<0..2^16-1>; } CertificateVerify;
+    if (buffer.size() < 7)
+        return (i8)Error::NeedMoreData;
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+    size_t signature_length = read_u16(buffer, 5);
+    if (signature_length + 4 != size)
+        return (i8)Error::BrokenPacket;
+
+    SignatureAndHashAlgorithm algorithm { static_cast<HashAlgorithm>(buffer[3]), static_cast<SignatureAlgorithm>(buffer[4]) };
+    bool was_offered = any_of(m_context.options.supported_signature_algorithms, [&](auto& offered) {
+        return offered.hash == algorithm.hash && offered.signature == algorithm.signature;
+    });
+    // RFC 8446 section 4.4.3: RSA signatures in a CertificateVerify must use RSASSA-PSS.
+    if (!was_offered || algorithm.hash != HashAlgorithm::Intrinsic) {
+        dbgln("CertificateVerify with a signature scheme we didn't offer: {}.{}", (u8)algorithm.hash, (u8)algorithm.signature);
+        return (i8)Error::NotSafe;
+    }
+
+    // RFC 8446 section 4.4.3: The server signs 64 spaces, a context string, a zero byte and the transcript hash.
+    constexpr auto context_string = "TLS 1.3, server CertificateVerify"sv;
+    auto hash = transcript_hash();
+    auto content = ByteBuffer::create_uninitialized(64 + context_string.length() + 1 + hash.size());
+    if (content.is_error())
+        return (i8)Error::OutOfMemory;
+    auto& message = content.value();
+    memset(message.data(), ' ', 64);
+    message.overwrite(64, context_string.characters_without_null_termination(), context_string.length());
+    message[64 + context_string.length()] = 0;
+    message.overwrite(64 + context_string.length() + 1, hash.data(), hash.size());
+
+    auto result = verify_rsa_signature(message, algorithm, buffer.slice(7, signature_length));
+    if (result < 0)
+        return result;
+
+    return 3 + size;
+}
+
+ssize_t TLSv12::handle_tls13_handshake_finished(ReadonlyBytes buffer, WritePacketStage& write_packets)
+{
+    if (buffer.size() < 3)
+        return (i8)Error::NeedMoreData;
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+
+    // RFC 8446 section 4.4.4: verify_data = HMAC(finished_key, Transcript-Hash(Handshake Context, Certificate*, CertificateVerify*))
+    auto expected = finished_verify_data(m_context.tls13.server_traffic_secret, transcript_hash());
+    if (size != expected.size() || !timing_safe_compare(expected.data(), buffer.offset_pointer(3), size)) {
+        dbgln("Server Finished does not match the transcript");
+        return (i8)Error::NotSafe;
+    }
+
+    write_packets = WritePacketStage::ClientHandshake;
+    return 3 + size;
+}
+
+void TLSv12::write_tls13_client_handshake()
+{
+    auto& tls13 = m_context.tls13;
+    auto kind = hmac_hash();
+    auto hash_size = mac_length();
+
+    // The application traffic secrets cover the transcript up to the server Finished.
+    auto hash = transcript_hash();
+    auto derived = derive_secret(tls13.secret, "derived"sv, hash_messages(kind, {}));
+    auto zeros = ByteBuffer::create_zeroed(hash_size).release_value_but_fixme_should_propagate_errors();
+    auto master_secret = HKDF::extract(derived, zeros, kind);
+    tls13.secret = ByteBuffer::copy(master_secret.immutable_data(), hash_size).release_value_but_fixme_should_propagate_errors();
+    auto client_application_traffic_secret = derive_secret(tls13.secret, "c ap traffic"sv, hash);
+    tls13.server_traffic_secret = derive_secret(tls13.secret, "s ap traffic"sv, hash);
+    set_traffic_key(tls13.server_traffic_secret, false);
+
+    if (tls13.accepted_early_data) {
+        dbgln_if(TLS_DEBUG, "> end of early data");
+        auto packet = build_tls13_handshake_message(HandshakeType::EndOfEarlyData, {});
+        write_packet(packet);
+    }
+    if (tls13.sent_early_data)
+        set_traffic_key(tls13.client_traffic_secret, true);
+
+    if (m_context.client_verified == VerificationNeeded) {
+        // We don't authenticate ourselves in TLS 1.3, so answer a CertificateRequest with an empty certificate_list.
+        dbgln_if(TLS_DEBUG, "> Client Certificate");
+        u8 body[1 + 255 + 3] = {};
+        body[0] = tls13.certificate_request_context_size;
+        memcpy(body + 1, tls13.certificate_request_context, tls13.certificate_request_context_size);
+        auto packet = build_tls13_handshake_message(HandshakeType::CertificateMessage, { body, 1u + tls13.certificate_request_context_size + 3 });
+        write_packet(packet);
+        m_context.client_verified = Verified;
+    }
+
+    {
+        dbgln_if(TLS_DEBUG, "> client finished");
+        auto packet = build_tls13_handshake_finished();
+        write_packet(packet);
+    }
+
+    tls13.resumption_secret = derive_secret(tls13.secret, "res master"sv, transcript_hash());
+    tls13.client_traffic_secret = move(client_application_traffic_secret);
+    set_traffic_key(tls13.client_traffic_secret, true);
+
+    did_establish_connection();
+}
+
+ByteBuffer TLSv12::build_tls13_handshake_message(HandshakeType type, ReadonlyBytes body)
+{
+    PacketBuilder builder { MessageType::Handshake, Version::V12, body.size() + 4 };
+    builder.append((u8)type);
+    builder.append_u24(body.size());
+    builder.append(body);
+    auto packet = builder.build();
+    update_packet(packet);
+    return packet;
+}
+
+ByteBuffer TLSv12::build_tls13_handshake_finished()
+{
+    auto verify_data = finished_verify_data(m_context.tls13.client_traffic_secret, transcript_hash());
+    return build_tls13_handshake_message(HandshakeType::Finished, verify_data);
+}
+
+ssize_t TLSv12::handle_tls13_new_session_ticket(ReadonlyBytes buffer)
+{
+    // struct {
+    //     uint32 ticket_lifetime;
+    //     uint32 ticket_age_add;
+    //     opaque ticket_nonce<0..255>;
+    //     opaque ticket<1..2^16-1>;
+    //     Extension extensions<0..2^16-2>;
+    // } NewSessionTicket;
+    if (buffer.size() < 3)
+        return (i8)Error::NeedMoreData;
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+    auto message = buffer.slice(3, size);
+
+    if (message.size() < 9)
+        return (i8)Error::BrokenPacket;
+    auto lifetime = read_u32(message, 0);
+    auto age_add = read_u32(message, 4);
+    size_t nonce_length = message[8];
+    size_t offset = 9 + nonce_length;
+    if (message.size() < offset + 2)
+        return (i8)Error::BrokenPacket;
+    auto nonce = message.slice(9, nonce_length);
+    size_t ticket_length = read_u16(message, offset);
+    offset += 2;
+    if (ticket_length == 0 || message.size() < offset + ticket_length + 2)
+        return (i8)Error::BrokenPacket;
+    auto ticket = message.slice(offset, ticket_length);
+    offset += ticket_length;
+    size_t extensions_length = read_u16(message, offset);
+    offset += 2;
+    if (message.size() != offset + extensions_length)
+        return (i8)Error::BrokenPacket;
+
+    u32 max_early_data_size = 0;
+    while (offset + 4 <= message.size()) {
+        auto extension_type = static_cast<HandshakeExtension>(read_u16(message, offset));
+        size_t extension_length = read_u16(message, offset + 2);
+        offset += 4;
+        if (offset + extension_length > message.size())
+            return (i8)Error::BrokenPacket;
+        if (extension_type == HandshakeExtension::EarlyData && extension_length == 4)
+            max_early_data_size = read_u32(message, offset);
+        offset += extension_length;
+    }
+
+    // A lifetime of zero means that the ticket must not be used at all.
+    if (lifetime == 0)
+        return 3 + size;
+
+    auto ticket_copy = ByteBuffer::copy(ticket);
+    if (ticket_copy.is_error())
+        return (i8)Error::OutOfMemory;
+
+    m_context.options.session_handler(SessionState {
+        .cipher = m_context.cipher,
+        .version = Version::V13,
+        .master_key = expand_label(m_context.tls13.resumption_secret, "resumption"sv, nonce, mac_length()),
+        .session_id = {},
+        .ticket = ticket_copy.release_value(),
+        .ticket_received_at = Time::now_monotonic(),
+        .ticket_lifetime = min(lifetime, maximum_ticket_lifetime),
+        .ticket_age_add = age_add,
+        .max_early_data_size = max_early_data_size,
+    });
+
+    return 3 + size;
+}
+
+ssize_t TLSv12::handle_key_update(ReadonlyBytes buffer)
+{
+    // enum { update_not_requested(0), update_requested(1), (255) } KeyUpdateRequest;
+    if (buffer.size() < 4)
+        return (i8)Error::NeedMoreData;
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (size != 1 || buffer[3] > 1)
+        return (i8)Error::BrokenPacket;
+
+    auto& tls13 = m_context.tls13;
+    tls13.server_traffic_secret = expand_label(tls13.server_traffic_secret, "traffic upd"sv, {}, mac_length());
+    set_traffic_key(tls13.server_traffic_secret, false);
+
+    if (buffer[3] == 1) {
+        // Answer with our own update, which is the last message under the old key.
+        u8 update_not_requested = 0;
+        auto packet = build_tls13_handshake_message(HandshakeType::KeyUpdate, { &update_not_requested, 1 });
+        write_packet(packet);
+        tls13.client_traffic_secret = expand_label(tls13.client_traffic_secret, "traffic upd"sv, {}, mac_length());
+        set_traffic_key(tls13.client_traffic_secret, true);
+    }
+
+    return 3 + size;
+}
+
+void TLSv12::set_traffic_key(ReadonlyBytes traffic_secret, bool local)
+{
+    // RFC 8446 section 7.3: Every traffic secret gets its own key and IV, and restarts the sequence numbers.
+    auto key_size = key_length();
+    auto key = expand_label(traffic_secret, "key"sv, {}, key_size);
+    auto iv = expand_label(traffic_secret, "iv"sv, {}, iv_length());
+    auto& cipher = local ? m_cipher_local : m_cipher_remote;
+    auto intent = local ? Crypto::Cipher::Intent::Encryption : Crypto::Cipher::Intent::Decryption;
+
+    switch (get_cipher_algorithm(m_context.cipher)) {
+    case CipherAlgorithm::AES_128_GCM:
+    case CipherAlgorithm::AES_256_GCM:
+        cipher = Crypto::Cipher::AESCipher::GCMMode(key, key_size * 8, intent, Crypto::Cipher::PaddingMode::RFC5246);
+        break;
+    case CipherAlgorithm::CHACHA20_POLY1305:
+        cipher = Crypto::Cipher::ChaCha20Poly1305(key);
+        break;
+    default:
+        dbgln("Requested unknown TLS 1.3 cipher");
+        VERIFY_NOT_REACHED();
+    }
+
+    if (local) {
+        memcpy(m_context.crypto.local_iv, iv.data(), iv.size());
+        m_context.local_sequence_number = 0;
+    } else {
+        memcpy(m_context.crypto.remote_iv, iv.data(), iv.size());
+        m_context.remote_sequence_number = 0;
+    }
+}
+
+ByteBuffer TLSv12::expand_label(ReadonlyBytes secret, StringView label, ReadonlyBytes context, size_t length) const
+{
+    // struct {
+    //     uint16 length = Length;
+    //     opaque label<7..255> = "tls13 " + Label;
+    //     opaque context<0..255> = Context;
+    // } HkdfLabel;
+    constexpr auto prefix = "tls13 "sv;
+    auto info = ByteBuffer::create_uninitialized(2 + 1 + prefix.length() + label.length() + 1 + context.size()).release_value_but_fixme_should_propagate_errors();
+    size_t offset = 0;
+    info[offset++] = length / 0x100;
+    info[offset++] = length % 0x100;
+    info[offset++] = prefix.length() + label.length();
+    info.overwrite(offset, prefix.characters_without_null_termination(), prefix.length());
+    offset += prefix.length();
+    info.overwrite(offset, label.characters_without_null_termination(), label.length());
+    offset += label.length();
+    info[offset++] = context.size();
+    info.overwrite(offset, context.data(), context.size());
+
+    auto output = ByteBuffer::create_uninitialized(length).release_value_but_fixme_should_propagate_errors();
+    HKDF::expand(secret, info, output, hmac_hash());
+    return output;
+}
+
+ByteBuffer TLSv12::derive_secret(ReadonlyBytes secret, StringView label, ReadonlyBytes transcript_hash) const
+{
+    return expand_label(secret, label, transcript_hash, mac_length());
+}
+
+ByteBuffer TLSv12::finished_verify_data(ReadonlyBytes base_key, ReadonlyBytes transcript_hash) const
+{
+    auto finished_key = expand_label(base_key, "finished"sv, {}, mac_length());
+    Crypto::Authentication::HMAC<Crypto::Hash::Manager> hmac(finished_key.bytes(), hmac_hash());
+    auto verify_data = hmac.process(transcript_hash);
+    return ByteBuffer::copy(verify_data.immutable_data(), mac_length()).release_value_but_fixme_should_propagate_errors();
+}
+
+ByteBuffer TLSv12::transcript_hash()
+{
+    auto digest = m_context.handshake_hash.peek();
+    return ByteBuffer::copy(digest.immutable_data(), m_context.handshake_hash.digest_size()).release_value_but_fixme_should_propagate_errors();
+}
+
+static void compute_nonce(u8 const* iv, u64 sequence_number, Bytes nonce)
+{
+    // RFC 8446 section 5.3: The nonce is the IV, with the sequence number XORed into its last eight bytes.
+    memcpy(nonce.data(), iv, 12);
+    for (size_t i = 0; i < 8; ++i)
+        nonce[11 - i] ^= (sequence_number >> (8 * i)) & 0xff;
+}
+
+ByteBuffer TLSv12::protect_tls13_record(ReadonlyBytes packet)
+{
+    // struct { opaque content[length]; ContentType type; uint8 zeros[length_of_padding]; } TLSInnerPlaintext;
+    constexpr size_t header_size = 5;
+    constexpr size_t tag_size = 16;
+    auto content = packet.slice(header_size);
+    auto inner_plaintext = ByteBuffer::create_uninitialized(content.size() + 1).release_value_but_fixme_should_propagate_errors();
+    inner_plaintext.overwrite(0, content.data(), content.size());
+    inner_plaintext[content.size()] = packet[0];
+
+    // The outer record always claims to be TLS 1.2 application data.
+    size_t length = inner_plaintext.size() + tag_size;
+    auto record = ByteBuffer::create_uninitialized(header_size + length).release_value_but_fixme_should_propagate_errors();
+    record[0] = (u8)MessageType::ApplicationData;
+    record[1] = 0x03;
+    record[2] = 0x03;
+    record[3] = length / 0x100;
+    record[4] = length % 0x100;
+
+    u8 nonce[16] = {};
+    compute_nonce(m_context.crypto.local_iv, m_context.local_sequence_number, { nonce, 12 });
+    auto aad = record.bytes().slice(0, header_size);
+    auto ciphertext = record.bytes().slice(header_size, inner_plaintext.size());
+    auto tag = record.bytes().slice(header_size + inner_plaintext.size(), tag_size);
+
+    m_cipher_local.visit(
+        [&](Empty&) { VERIFY_NOT_REACHED(); },
+        [&](Crypto::Cipher::AESCipher::CBCMode&) { VERIFY_NOT_REACHED(); },
+        [&](Crypto::Cipher::AESCipher::GCMMode& gcm) {
+            // Our GCM implementation takes a 16-byte IV, whose last four bytes are the counter.
+            gcm.encrypt(inner_plaintext, ciphertext, { nonce, 16 }, aad, tag);
+        },
+        [&](Crypto::Cipher::ChaCha20Poly1305& chacha) {
+            MUST(chacha.encrypt(inner_plaintext, ciphertext, { nonce, 12 }, aad, tag));
+        });
+
+    ++m_context.local_sequence_number;
+    return record;
+}
+
+ssize_t TLSv12::unprotect_tls13_record(ReadonlyBytes record, ByteBuffer& plaintext, MessageType& type)
+{
+    constexpr size_t header_size = 5;
+    constexpr size_t tag_size = 16;
+    if (record.size() < header_size + 1 + tag_size) {
+        dbgln("Protected record is too short");
+        return (i8)Error::BrokenPacket;
+    }
+
+    auto aad = record.slice(0, header_size);
+    auto ciphertext = record.slice(header_size, record.size() - header_size - tag_size);
+    auto tag = record.slice(record.size() - tag_size);
+    auto plaintext_result = ByteBuffer::create_uninitialized(ciphertext.size());
+    if (plaintext_result.is_error())
+        return (i8)Error::OutOfMemory;
+    plaintext = plaintext_result.release_value();
+
+    u8 nonce[16] = {};
+    compute_nonce(m_context.crypto.remote_iv, m_context.remote_sequence_number, { nonce, 12 });
+
+    auto consistency = Crypto::VerificationConsistency::Inconsistent;
+    m_cipher_remote.visit(
+        [&](Empty&) { VERIFY_NOT_REACHED(); },
+        [&](Crypto::Cipher::AESCipher::CBCMode&) { VERIFY_NOT_REACHED(); },
+        [&](Crypto::Cipher::AESCipher::GCMMode& gcm) {
+            consistency = gcm.decrypt(ciphertext, plaintext, { nonce, 16 }, aad, tag);
+        },
+        [&](Crypto::Cipher::ChaCha20Poly1305& chacha) {
+            auto result = chacha.decrypt(ciphertext, plaintext, { nonce, 12 }, aad, tag);
+            if (!result.is_error())
+                consistency = result.value();
+        });
+
+    if (consistency != Crypto::VerificationConsistency::Consistent) {
+        dbgln("integrity check failed (tag length {})", tag.size());
+        return (i8)Error::IntegrityCheckFailed;
+    }
+    ++m_context.remote_sequence_number;
+
+    // The real content type is the last non-zero byte, followed by any amount of padding.
+    size_t length = plaintext.size();
+    while (length > 0 && plaintext[length - 1] == 0)
+        --length;
+    if (length == 0) {
+        dbgln("Protected record without a content type");
+        return (i8)Error::UnexpectedMessage;
+    }
+    type = static_cast<MessageType>(plaintext[length - 1]);
+    plaintext.resize(length - 1);
+
+    return 0;
+}
+
+}
@@ -10,6 +10,7 @@
 #include <LibTest/Macros.h> // intentionally first -- we redefine VERIFY and friends in here
 
 #include <AK/DeprecatedString.h>
+#include <AK/Format.h>
 #include <AK/Function.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/RefCounted.h>
@@ -40,6 +41,34 @@ private:
 // Helper to hide implementation of TestSuite from users
 void add_test_case_to_suite(NonnullRefPtr<TestCase> const& test_case);
 void set_suite_setup_function(Function<void()> setup);
+
+// Benchmarks run many times over, so they should use these to keep the compiler from noticing that their results are
+// never used (or never change) and optimizing the work being measured away.
+template<typename T>
+ALWAYS_INLINE void do_not_optimize(T const& value)
+{
+    asm volatile(""
+                 :
+                 : "m"(value)
+                 : "memory");
+}
+
+template<typename T>
+ALWAYS_INLINE void do_not_optimize(T& value)
+{
+    asm volatile(""
+                 : "+m"(value)
+                 :
+                 : "memory");
+}
+
+ALWAYS_INLINE void clobber_memory()
+{
+    asm volatile(""
+                 :
+                 :
+                 : "memory");
+}
 }
 
 #define TEST_SETUP                                   \
@@ -82,3 +111,20 @@ void set_suite_setup_function(Function<void()> setup);
     };                                                                                               \
     static struct __BENCHMARK_TYPE(x) __BENCHMARK_TYPE(x);                                           \
     static void __BENCHMARK_FUNC(x)()
+
+// Registers one benchmark per value, named x/value, each of which runs the body with `parameter` set to that value.
+#define BENCHMARK_CASE_WITH_PARAMETERS(x, parameter, ...)                                             \
+    static void __BENCHMARK_FUNC(x)(size_t);                                                          \
+    struct __BENCHMARK_TYPE(x) {                                                                      \
+        __BENCHMARK_TYPE(x)                                                                           \
+        ()                                                                                            \
+        {                                                                                             \
+            for (size_t value : { __VA_ARGS__ }) {                                                    \
+                auto name = DeprecatedString::formatted("{}/{}", #x, value);                          \
+                auto function = [value] { __BENCHMARK_FUNC(x)(value); };                              \
+                add_test_case_to_suite(adopt_ref(*new ::Test::TestCase(name, move(function), true))); \
+            }                                                                                         \
+        }                                                                                             \
+    };                                                                                                \
+    static struct __BENCHMARK_TYPE(x) __BENCHMARK_TYPE(x);                                            \
+    static void __BENCHMARK_FUNC(x)(size_t parameter)
@@ -8,7 +8,13 @@
 #include <LibTest/Macros.h> // intentionally first -- we redefine VERIFY and friends in here
 
 #include <AK/Function.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/Math.h>
+#include <AK/QuickSort.h>
+#include <AK/Time.h>
 #include <LibCore/ArgsParser.h>
+#include <LibCore/Stream.h>
 #include <LibTest/TestSuite.h>
 #include <stdlib.h>
 #include <sys/time.h>
@@ -66,13 +72,20 @@ int TestSuite::main(DeprecatedString const& suite_name, int argc, char** argv)
     bool do_benchmarks_only = false;
     bool do_list_cases = false;
     char const* search_string = "*";
+    StringView benchmark_results_path;
 
     args_parser.add_option(do_tests_only, "Only run tests.", "tests", 0);
     args_parser.add_option(do_benchmarks_only, "Only run benchmarks.", "bench", 0);
     args_parser.add_option(do_list_cases, "List available test cases.", "list", 0);
+    args_parser.add_option(m_benchmark_warmup_runs, "Number of unmeasured runs before measuring a benchmark (default: 1).", "bench-warmup", 0, "count");
+    args_parser.add_option(m_benchmark_repetitions, "Number of measured runs of each benchmark (default: enough to fill --bench-min-time with --bench, otherwise 1).", "bench-repetitions", 0, "count");
+    args_parser.add_option(m_benchmark_min_time_ms, "Time to spend measuring each benchmark, in milliseconds (default: 1000 with --bench).", "bench-min-time", 0, "ms");
+    args_parser.add_option(benchmark_results_path, "Write the benchmark results to a JSON file.", "bench-json", 0, "path");
     args_parser.add_positional_argument(search_string, "Only run matching cases.", "pattern", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
+    m_measure_benchmarks = do_benchmarks_only || m_benchmark_min_time_ms.has_value() || m_benchmark_repetitions != 0;
+
     if (m_setup)
         m_setup();
 
@@ -88,7 +101,16 @@ int TestSuite::main(DeprecatedString const& suite_name, int argc, char** argv)
 
     outln("Running {} cases out of {}.", matching_tests.size(), m_cases.size());
 
-    return run(matching_tests);
+    auto failed_count = run(matching_tests);
+
+    if (!benchmark_results_path.is_empty()) {
+        if (auto result = write_benchmark_results(benchmark_results_path); result.is_error()) {
+            warnln("Failed to write benchmark results to {}: {}", benchmark_results_path, result.error());
+            return 1;
+        }
+    }
+
+    return failed_count;
 }
 
 NonnullRefPtrVector<TestCase> TestSuite::find_cases(DeprecatedString const& search, bool find_tests, bool find_benchmarks)
@@ -125,10 +147,27 @@ int TestSuite::run(NonnullRefPtrVector<TestCase> const& tests)
         m_current_test_case_passed = true;
 
         TestElapsedTimer timer;
-        t.func()();
+        Optional<BenchmarkResult> benchmark_result;
+        if (t.is_benchmark())
+            benchmark_result = run_benchmark(t);
+        else
+            t.func()();
         auto const time = timer.elapsed_milliseconds();
 
         dbgln("{} {} '{}' in {}ms", m_current_test_case_passed ? "Completed" : "Failed", test_type, t.name(), time);
+        if (benchmark_result.has_value()) {
+            auto to_milliseconds = [](u64 nanoseconds) { return static_cast<double>(nanoseconds) / 1'000'000; };
+            dbgln("    {} runs: mean {:.3}ms, median {:.3}ms, stddev {:.3}ms, min {:.3}ms, max {:.3}ms, p90 {:.3}ms, p99 {:.3}ms",
+                benchmark_result->repetitions,
+                to_milliseconds(benchmark_result->mean_ns),
+                to_milliseconds(benchmark_result->median_ns),
+                to_milliseconds(benchmark_result->stddev_ns),
+                to_milliseconds(benchmark_result->min_ns),
+                to_milliseconds(benchmark_result->max_ns),
+                to_milliseconds(benchmark_result->p90_ns),
+                to_milliseconds(benchmark_result->p99_ns));
+            m_benchmark_results.append(benchmark_result.release_value());
+        }
 
         if (t.is_benchmark()) {
             m_benchtime += time;
@@ -155,4 +194,98 @@ int TestSuite::run(NonnullRefPtrVector<TestCase> const& tests)
     return (int)test_failed_count;
 }
 
+Optional<TestSuite::BenchmarkResult> TestSuite::run_benchmark(TestCase const& benchmark)
+{
+    auto run_once = [&] {
+        auto start = Time::now_monotonic();
+        benchmark.func()();
+        return static_cast<u64>(max<i64>(0, (Time::now_monotonic() - start).to_nanoseconds()));
+    };
+
+    // The warmup runs double as calibration: unless told otherwise, a benchmark is repeated often enough to take up
+    // the minimum time, based on how long its last warmup run took.
+    // When benchmarks aren't measured on purpose (e.g. as part of a test run), a single run is enough.
+    u64 calibration_ns = 0;
+    size_t warmup_runs = m_measure_benchmarks ? m_benchmark_warmup_runs : 0;
+    for (size_t i = 0; i < warmup_runs && m_current_test_case_passed; ++i)
+        calibration_ns = run_once();
+
+    size_t repetitions = m_benchmark_repetitions;
+    if (!m_measure_benchmarks) {
+        repetitions = 1;
+    } else if (repetitions == 0) {
+        constexpr size_t max_calibrated_repetitions = 1000;
+        auto min_time_ns = static_cast<u64>(m_benchmark_min_time_ms.value_or(1000)) * 1'000'000;
+        repetitions = calibration_ns == 0 ? max_calibrated_repetitions : clamp<u64>(ceil_div(min_time_ns, calibration_ns), 1, max_calibrated_repetitions);
+    }
+
+    Vector<u64> durations;
+    durations.ensure_capacity(repetitions);
+    for (size_t i = 0; i < repetitions && m_current_test_case_passed; ++i)
+        durations.unchecked_append(run_once());
+
+    if (!m_current_test_case_passed || durations.is_empty())
+        return {};
+
+    quick_sort(durations);
+
+    auto percentile = [&](size_t percent) {
+        // Nearest-rank method.
+        auto rank = ceil_div(percent * durations.size(), static_cast<size_t>(100));
+        return durations[max<size_t>(rank, 1) - 1];
+    };
+
+    double sum = 0;
+    for (auto duration : durations)
+        sum += static_cast<double>(duration);
+    auto mean = sum / durations.size();
+
+    double squared_deviations = 0;
+    for (auto duration : durations)
+        squared_deviations += (static_cast<double>(duration) - mean) * (static_cast<double>(duration) - mean);
+    auto stddev = durations.size() > 1 ? AK::sqrt(squared_deviations / (durations.size() - 1)) : 0.0;
+
+    auto median = durations.size() % 2 == 1
+        ? durations[durations.size() / 2]
+        : (durations[durations.size() / 2 - 1] + durations[durations.size() / 2]) / 2;
+
+    return BenchmarkResult {
+        .name = benchmark.name(),
+        .repetitions = durations.size(),
+        .min_ns = durations.first(),
+        .max_ns = durations.last(),
+        .mean_ns = static_cast<u64>(mean),
+        .median_ns = median,
+        .stddev_ns = static_cast<u64>(stddev),
+        .p90_ns = percentile(90),
+        .p99_ns = percentile(99),
+    };
+}
+
+ErrorOr<void> TestSuite::write_benchmark_results(StringView path) const
+{
+    JsonArray benchmarks;
+    for (auto const& result : m_benchmark_results) {
+        JsonObject object;
+        object.set("name", result.name);
+        object.set("repetitions", result.repetitions);
+        object.set("min_ns", result.min_ns);
+        object.set("max_ns", result.max_ns);
+        object.set("mean_ns", result.mean_ns);
+        object.set("median_ns", result.median_ns);
+        object.set("stddev_ns", result.stddev_ns);
+        object.set("p90_ns", result.p90_ns);
+        object.set("p99_ns", result.p99_ns);
+        benchmarks.append(move(object));
+    }
+
+    JsonObject results;
+    results.set("suite", m_suite_name);
+    results.set("benchmarks", move(benchmarks));
+
+    auto file = TRY(Core::Stream::File::open(path, Core::Stream::OpenMode::Write | Core::Stream::OpenMode::Truncate));
+    TRY(file->write_entire_buffer(results.to_deprecated_string().bytes()));
+    return {};
+}
+
 }
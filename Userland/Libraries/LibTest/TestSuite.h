@@ -12,6 +12,8 @@
 #include <AK/DeprecatedString.h>
 #include <AK/Function.h>
 #include <AK/NonnullRefPtrVector.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
 #include <LibTest/TestCase.h>
 
 namespace Test {
@@ -45,6 +47,21 @@ public:
     void set_suite_setup(Function<void()> setup) { m_setup = move(setup); }
 
 private:
+    struct BenchmarkResult {
+        DeprecatedString name;
+        size_t repetitions { 0 };
+        u64 min_ns { 0 };
+        u64 max_ns { 0 };
+        u64 mean_ns { 0 };
+        u64 median_ns { 0 };
+        u64 stddev_ns { 0 };
+        u64 p90_ns { 0 };
+        u64 p99_ns { 0 };
+    };
+
+    Optional<BenchmarkResult> run_benchmark(TestCase const&);
+    ErrorOr<void> write_benchmark_results(StringView path) const;
+
     static TestSuite* s_global;
     NonnullRefPtrVector<TestCase> m_cases;
     u64 m_testtime = 0;
@@ -52,6 +69,13 @@ private:
     DeprecatedString m_suite_name;
     bool m_current_test_case_passed = true;
     Function<void()> m_setup;
+
+    // Unless benchmarks are run on purpose, they are run just once, like tests.
+    bool m_measure_benchmarks { false };
+    size_t m_benchmark_warmup_runs { 1 };
+    size_t m_benchmark_repetitions { 0 };
+    Optional<size_t> m_benchmark_min_time_ms;
+    Vector<BenchmarkResult> m_benchmark_results;
 };
 
 }
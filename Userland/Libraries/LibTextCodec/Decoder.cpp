@@ -222,8 +222,21 @@ DeprecatedString Decoder::to_utf8(StringView input)
 
 void UTF8Decoder::process(StringView input, Function<void(u32)> on_code_point)
 {
-    for (auto c : Utf8View(input)) {
-        on_code_point(c);
+    Utf8View view { input };
+    auto bytes = input.bytes();
+    size_t offset = 0;
+    while (offset < bytes.size()) {
+        if (bytes[offset] < 0x80) {
+            auto ascii_bytes = Utf8View::count_leading_ascii_bytes(bytes.slice(offset));
+            for (auto byte : bytes.slice(offset, ascii_bytes))
+                on_code_point(byte);
+            offset += ascii_bytes;
+            continue;
+        }
+
+        auto iterator = view.iterator_at_byte_offset_without_validation(offset);
+        on_code_point(*iterator);
+        offset += iterator.underlying_code_point_length_in_bytes();
     }
 }
 
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibThreading/EpochReclaimer.h>
+
+namespace Threading {
+
+void EpochReclaimer::Participant::pin()
+{
+    VERIFY(!is_pinned());
+    m_state.store(m_reclaimer.m_epoch.load() * 2 + 1);
+    // Note: The pin has to be visible to collect() before this thread reads anything from the data structure.
+    AK::atomic_thread_fence(AK::MemoryOrder::memory_order_seq_cst);
+}
+
+void EpochReclaimer::Participant::unpin()
+{
+    VERIFY(is_pinned());
+    m_state.store(0, AK::MemoryOrder::memory_order_release);
+}
+
+EpochReclaimer::~EpochReclaimer()
+{
+    for (auto& participant : m_participants)
+        VERIFY(!participant->is_pinned());
+    for (auto& retired : m_retired)
+        retired.reclaim();
+}
+
+EpochReclaimer::Participant& EpochReclaimer::register_participant()
+{
+    MutexLocker locker(m_participants_mutex);
+    for (auto& participant : m_participants) {
+        if (!participant->m_is_registered) {
+            participant->m_is_registered = true;
+            return *participant;
+        }
+    }
+    m_participants.append(adopt_own(*new Participant(*this)));
+    return *m_participants.last();
+}
+
+void EpochReclaimer::unregister_participant(Participant& participant)
+{
+    VERIFY(!participant.is_pinned());
+    MutexLocker locker(m_participants_mutex);
+    participant.m_is_registered = false;
+}
+
+void EpochReclaimer::retire(Function<void()> reclaim)
+{
+    bool should_collect;
+    {
+        MutexLocker locker(m_retired_mutex);
+        m_retired.append({ m_epoch.load(), move(reclaim) });
+        should_collect = m_retired.size() % collect_threshold == 0;
+    }
+    if (should_collect)
+        collect();
+}
+
+void EpochReclaimer::try_advance_epoch()
+{
+    MutexLocker locker(m_participants_mutex);
+    auto epoch = m_epoch.load();
+    for (auto& participant : m_participants) {
+        auto state = participant->m_state.load();
+        if (state != 0 && state != epoch * 2 + 1)
+            return;
+    }
+    // Note: This fails if somebody else advanced the epoch in the meantime, which is just as good.
+    (void)m_epoch.compare_exchange_strong(epoch, epoch + 1);
+}
+
+void EpochReclaimer::collect()
+{
+    try_advance_epoch();
+
+    // Participants pinned in the retiring epoch have to unpin before the epoch can advance twice, and participants that pin
+    // later on can't find the memory anymore.
+    auto epoch = m_epoch.load();
+    if (epoch < 2)
+        return;
+
+    Vector<Retired> reclaimable;
+    {
+        MutexLocker locker(m_retired_mutex);
+        m_retired.remove_all_matching([&](auto& retired) {
+            if (retired.epoch + 2 > epoch)
+                return false;
+            reclaimable.append(move(retired));
+            return true;
+        });
+    }
+
+    for (auto& retired : reclaimable)
+        retired.reclaim();
+}
+
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Noncopyable.h>
+#include <AK/Platform.h>
+#include <AK/Vector.h>
+#include <LibThreading/Mutex.h>
+
+namespace Threading {
+
+// Epoch-based reclamation, for lock-free data structures that unlink memory while other threads may still be reading it.
+// Participants pin the current epoch for as long as they hold pointers into the data structure, and memory that's retired
+// during an epoch is only reclaimed once every participant that was pinned at the time has unpinned again.
+class EpochReclaimer {
+    AK_MAKE_NONCOPYABLE(EpochReclaimer);
+    AK_MAKE_NONMOVABLE(EpochReclaimer);
+
+public:
+    // One of the threads using the data structure. A participant must only ever be used by one thread at a time.
+    class Participant {
+        AK_MAKE_NONCOPYABLE(Participant);
+        AK_MAKE_NONMOVABLE(Participant);
+        friend class EpochReclaimer;
+
+    public:
+        void pin();
+        void unpin();
+        bool is_pinned() const { return m_state.load(AK::MemoryOrder::memory_order_relaxed) != 0; }
+
+    private:
+        explicit Participant(EpochReclaimer& reclaimer)
+            : m_reclaimer(reclaimer)
+        {
+        }
+
+        EpochReclaimer& m_reclaimer;
+        // The pinned epoch times two plus one, or zero when not pinned.
+        AK_CACHE_ALIGNED Atomic<u64> m_state { 0 };
+        bool m_is_registered { true };
+    };
+
+    class Guard {
+        AK_MAKE_NONCOPYABLE(Guard);
+        AK_MAKE_NONMOVABLE(Guard);
+
+    public:
+        explicit Guard(Participant& participant)
+            : m_participant(participant)
+        {
+            m_participant.pin();
+        }
+        ~Guard() { m_participant.unpin(); }
+
+    private:
+        Participant& m_participant;
+    };
+
+    EpochReclaimer() = default;
+    // Reclaims everything that's still retired. Nobody may be pinned anymore by then.
+    ~EpochReclaimer();
+
+    Participant& register_participant();
+    // The participant must not be pinned. Its storage is reused for participants registered later on.
+    void unregister_participant(Participant&);
+
+    // Calls `reclaim` once nobody can be looking at the memory it frees anymore.
+    // Must only be called after the memory has been unlinked from the data structure.
+    void retire(Function<void()> reclaim);
+
+    // Advances the epoch if all pinned participants have seen the current one, and reclaims whatever is safe to reclaim.
+    // This also happens every now and then as memory is retired.
+    void collect();
+
+    u64 epoch() const { return m_epoch.load(); }
+
+private:
+    static constexpr size_t collect_threshold = 64;
+
+    struct Retired {
+        u64 epoch;
+        Function<void()> reclaim;
+    };
+
+    void try_advance_epoch();
+
+    AK_CACHE_ALIGNED Atomic<u64> m_epoch { 0 };
+
+    Mutex m_participants_mutex;
+    Vector<NonnullOwnPtr<Participant>> m_participants;
+
+    Mutex m_retired_mutex;
+    Vector<Retired> m_retired;
+};
+
+}
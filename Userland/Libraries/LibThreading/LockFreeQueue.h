@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/BuiltinWrappers.h>
+#include <AK/Error.h>
+#include <AK/Noncopyable.h>
+#include <AK/Platform.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+
+namespace Threading {
+
+enum class QueueStatus : u8 {
+    Full,
+    Empty,
+};
+
+// A bounded lock-free queue for exactly one producer thread and one consumer thread.
+// Each side keeps its own copy of the other side's index, and only looks at the real one when that copy says the queue is
+// full (or empty), so the two threads rarely have to touch each other's cache lines.
+template<typename T, size_t Capacity>
+// Capacity must be a power of two, which speeds up the modulus operations for indexing.
+requires(popcount(Capacity) == 1)
+class SPSCQueue {
+    AK_MAKE_NONCOPYABLE(SPSCQueue);
+    AK_MAKE_NONMOVABLE(SPSCQueue);
+
+public:
+    using ValueType = T;
+
+    SPSCQueue() = default;
+    ~SPSCQueue()
+    {
+        while (!dequeue().is_error())
+            ;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Only callable from the producer. The value is left alone if the queue is full.
+    template<typename U = T>
+    ErrorOr<void, QueueStatus> enqueue(U&& value)
+    {
+        auto tail = m_tail.load(AK::MemoryOrder::memory_order_relaxed);
+        if (tail - m_cached_head == Capacity) {
+            m_cached_head = m_head.load(AK::MemoryOrder::memory_order_acquire);
+            if (tail - m_cached_head == Capacity)
+                return QueueStatus::Full;
+        }
+
+        new (slot(tail)) T(forward<U>(value));
+        m_tail.store(tail + 1, AK::MemoryOrder::memory_order_release);
+        return {};
+    }
+
+    // Only callable from the consumer.
+    ErrorOr<T, QueueStatus> dequeue()
+    {
+        auto head = m_head.load(AK::MemoryOrder::memory_order_relaxed);
+        if (head == m_cached_tail) {
+            m_cached_tail = m_tail.load(AK::MemoryOrder::memory_order_acquire);
+            if (head == m_cached_tail)
+                return QueueStatus::Empty;
+        }
+
+        auto* element = slot(head);
+        T value = move(*element);
+        element->~T();
+        m_head.store(head + 1, AK::MemoryOrder::memory_order_release);
+        return value;
+    }
+
+    // This is provably inconsistent while either side is running, and should only be used as a hint.
+    size_t weak_used() const
+    {
+        return m_tail.load(AK::MemoryOrder::memory_order_relaxed) - m_head.load(AK::MemoryOrder::memory_order_relaxed);
+    }
+
+private:
+    T* slot(size_t index) { return reinterpret_cast<T*>(&m_storage[(index % Capacity) * sizeof(T)]); }
+
+    // Owned by the consumer.
+    AK_CACHE_ALIGNED Atomic<size_t> m_head { 0 };
+    size_t m_cached_tail { 0 };
+
+    // Owned by the producer.
+    AK_CACHE_ALIGNED Atomic<size_t> m_tail { 0 };
+    size_t m_cached_head { 0 };
+
+    AK_CACHE_ALIGNED alignas(T) u8 m_storage[sizeof(T) * Capacity];
+};
+
+// A bounded lock-free queue for any number of producer and consumer threads (Dmitry Vyukov's bounded MPMC queue).
+// Every slot carries a sequence number that tells producers and consumers whose turn it is, so claiming a slot only takes
+// a single compare-exchange on the shared position, and producers and consumers never contend with each other.
+template<typename T, size_t Capacity>
+// Capacity must be a power of two, which speeds up the modulus operations for indexing.
+requires(popcount(Capacity) == 1)
+class MPMCQueue {
+    AK_MAKE_NONCOPYABLE(MPMCQueue);
+    AK_MAKE_NONMOVABLE(MPMCQueue);
+
+public:
+    using ValueType = T;
+
+    MPMCQueue()
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+            m_cells[i].sequence.store(i, AK::MemoryOrder::memory_order_relaxed);
+    }
+
+    ~MPMCQueue()
+    {
+        while (!dequeue().is_error())
+            ;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    // The value is left alone if the queue is full.
+    template<typename U = T>
+    ErrorOr<void, QueueStatus> enqueue(U&& value)
+    {
+        Cell* cell;
+        auto position = m_enqueue_position.load(AK::MemoryOrder::memory_order_relaxed);
+        while (true) {
+            cell = &m_cells[position % Capacity];
+            auto sequence = cell->sequence.load(AK::MemoryOrder::memory_order_acquire);
+            auto difference = static_cast<ssize_t>(sequence - position);
+            if (difference == 0) {
+                // Note: This updates `position` if another producer claimed the slot first.
+                if (m_enqueue_position.compare_exchange_strong(position, position + 1, AK::MemoryOrder::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                // The slot still holds the value from one lap ago.
+                return QueueStatus::Full;
+            } else {
+                position = m_enqueue_position.load(AK::MemoryOrder::memory_order_relaxed);
+            }
+        }
+
+        new (cell->value()) T(forward<U>(value));
+        cell->sequence.store(position + 1, AK::MemoryOrder::memory_order_release);
+        return {};
+    }
+
+    ErrorOr<T, QueueStatus> dequeue()
+    {
+        Cell* cell;
+        auto position = m_dequeue_position.load(AK::MemoryOrder::memory_order_relaxed);
+        while (true) {
+            cell = &m_cells[position % Capacity];
+            auto sequence = cell->sequence.load(AK::MemoryOrder::memory_order_acquire);
+            auto difference = static_cast<ssize_t>(sequence - (position + 1));
+            if (difference == 0) {
+                if (m_dequeue_position.compare_exchange_strong(position, position + 1, AK::MemoryOrder::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                // Nothing has been written to the slot in this lap yet.
+                return QueueStatus::Empty;
+            } else {
+                position = m_dequeue_position.load(AK::MemoryOrder::memory_order_relaxed);
+            }
+        }
+
+        auto* element = cell->value();
+        T value = move(*element);
+        element->~T();
+        cell->sequence.store(position + Capacity, AK::MemoryOrder::memory_order_release);
+        return value;
+    }
+
+    // This is provably inconsistent while other threads are using the queue, and should only be used as a hint.
+    size_t weak_used() const
+    {
+        return m_enqueue_position.load(AK::MemoryOrder::memory_order_relaxed) - m_dequeue_position.load(AK::MemoryOrder::memory_order_relaxed);
+    }
+
+private:
+    struct Cell {
+        T* value() { return reinterpret_cast<T*>(storage); }
+
+        // A producer may write to the slot at position p when this is p, and a consumer may read it when this is p + 1.
+        Atomic<size_t> sequence { 0 };
+        alignas(T) u8 storage[sizeof(T)];
+    };
+
+    AK_CACHE_ALIGNED Atomic<size_t> m_enqueue_position { 0 };
+    AK_CACHE_ALIGNED Atomic<size_t> m_dequeue_position { 0 };
+    AK_CACHE_ALIGNED Cell m_cells[Capacity];
+};
+
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibThreading/ThreadPool.h>
+#include <unistd.h>
+
+namespace Threading {
+
+static thread_local ThreadPool* s_current_pool;
+static thread_local size_t s_current_worker_index;
+
+ThreadPool& ThreadPool::the()
+{
+    static ThreadPool* s_the = new ThreadPool(max(sysconf(_SC_NPROCESSORS_ONLN) - 1, 1l));
+    return *s_the;
+}
+
+ThreadPool::ThreadPool(size_t worker_count)
+{
+    VERIFY(worker_count > 0);
+
+    m_queues.ensure_capacity(worker_count);
+    for (size_t i = 0; i < worker_count; ++i)
+        m_queues.unchecked_append(make<WorkQueue>());
+
+    m_workers.ensure_capacity(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        auto worker = Thread::construct([this, i] { return run_worker(i); }, "ThreadPool worker"sv);
+        worker->start();
+        m_workers.unchecked_append(move(worker));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    m_is_exiting = true;
+    notify_all();
+    for (auto& worker : m_workers)
+        (void)worker->join();
+}
+
+intptr_t ThreadPool::run_worker(size_t index)
+{
+    s_current_pool = this;
+    s_current_worker_index = index;
+    run_jobs_until([this] { return m_is_exiting.load(); });
+    return 0;
+}
+
+void ThreadPool::enqueue(Job job)
+{
+    auto index = s_current_pool == this ? s_current_worker_index : m_next_queue.fetch_add(1) % m_queues.size();
+
+    // Note: This is counted before the job is in the queue, so that the count never drops below zero when it's taken right away.
+    //       Threads that see the count before the job can only spin until it's there, they can't miss it.
+    m_pending_job_count.fetch_add(1);
+    {
+        auto& queue = *m_queues[index];
+        MutexLocker locker(queue.mutex);
+        queue.jobs.append(move(job));
+    }
+
+    MutexLocker locker(m_mutex);
+    m_condition.signal();
+}
+
+Optional<ThreadPool::Job> ThreadPool::take_job()
+{
+    if (m_pending_job_count.load() == 0)
+        return {};
+
+    // The newest job of our own queue comes first, since whatever it works on is the most likely to still be in the cache.
+    auto is_worker = s_current_pool == this;
+    if (is_worker) {
+        auto& queue = *m_queues[s_current_worker_index];
+        MutexLocker locker(queue.mutex);
+        if (queue.jobs.size() > queue.head) {
+            auto job = queue.jobs.take_last();
+            if (queue.jobs.size() == queue.head) {
+                queue.jobs.clear_with_capacity();
+                queue.head = 0;
+            }
+            m_pending_job_count.fetch_sub(1);
+            return job;
+        }
+    }
+
+    // Otherwise, steal the oldest job of another queue.
+    auto first_queue = is_worker ? s_current_worker_index + 1 : m_next_queue.load();
+    for (size_t i = 0; i < m_queues.size(); ++i) {
+        auto& queue = *m_queues[(first_queue + i) % m_queues.size()];
+        MutexLocker locker(queue.mutex);
+        if (queue.jobs.size() <= queue.head)
+            continue;
+
+        auto job = move(queue.jobs[queue.head++]);
+        if (queue.jobs.size() == queue.head) {
+            queue.jobs.clear_with_capacity();
+            queue.head = 0;
+        } else if (queue.head >= 64 && queue.head * 2 >= queue.jobs.size()) {
+            queue.jobs.remove(0, queue.head);
+            queue.head = 0;
+        }
+        m_pending_job_count.fetch_sub(1);
+        return job;
+    }
+
+    return {};
+}
+
+void ThreadPool::run_jobs_until(Function<bool()> condition)
+{
+    while (!condition()) {
+        if (auto job = take_job(); job.has_value()) {
+            (*job)();
+            continue;
+        }
+
+        MutexLocker locker(m_mutex);
+        while (!condition() && m_pending_job_count.load() == 0)
+            m_condition.wait();
+    }
+}
+
+void ThreadPool::notify_all()
+{
+    MutexLocker locker(m_mutex);
+    m_condition.broadcast();
+}
+
+struct ParallelForState : public AtomicRefCounted<ParallelForState> {
+    ParallelForState(size_t count, size_t grain_size, Function<void(size_t, size_t)>& callback)
+        : count(count)
+        , grain_size(grain_size)
+        , chunk_count(ceil_div(count, grain_size))
+        , callback(callback)
+    {
+    }
+
+    // Returns whether this finished the last chunk.
+    bool run_chunks()
+    {
+        bool finished_last_chunk = false;
+        for (size_t chunk; (chunk = next_chunk.fetch_add(1)) < chunk_count;) {
+            auto begin = chunk * grain_size;
+            callback(begin, min(begin + grain_size, count));
+            if (finished_chunk_count.fetch_add(1) + 1 == chunk_count)
+                finished_last_chunk = true;
+        }
+        return finished_last_chunk;
+    }
+
+    bool is_finished() const { return finished_chunk_count.load() == chunk_count; }
+
+    size_t count;
+    size_t grain_size;
+    size_t chunk_count;
+    // Note: This lives on the stack of the thread that called parallel_for(), and is only ever used before the last chunk
+    //       is finished, which is before parallel_for() returns. Jobs that start later don't find any chunk left to run.
+    Function<void(size_t, size_t)>& callback;
+    Atomic<size_t> next_chunk { 0 };
+    Atomic<size_t> finished_chunk_count { 0 };
+};
+
+void ThreadPool::parallel_for(size_t count, size_t grain_size, Function<void(size_t begin, size_t end)> callback)
+{
+    VERIFY(grain_size > 0);
+    if (count == 0)
+        return;
+    if (count <= grain_size) {
+        callback(0, count);
+        return;
+    }
+
+    auto state = adopt_ref(*new ParallelForState(count, grain_size, callback));
+    auto helper_count = min(worker_count(), state->chunk_count - 1);
+    for (size_t i = 0; i < helper_count; ++i) {
+        enqueue([this, state] {
+            if (state->run_chunks())
+                notify_all();
+        });
+    }
+
+    state->run_chunks();
+    run_jobs_until([&] { return state->is_finished(); });
+}
+
+}
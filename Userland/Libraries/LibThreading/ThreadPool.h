@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/AtomicRefCounted.h>
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/QuickSort.h>
+#include <AK/Span.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Vector.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+
+namespace Threading {
+
+class ThreadPool;
+
+// The result of a job submitted to a ThreadPool.
+template<typename T>
+class Future : public AtomicRefCounted<Future<T>> {
+    friend class ThreadPool;
+
+public:
+    bool is_resolved() const { return m_is_resolved.load(AK::MemoryOrder::memory_order_acquire); }
+
+    // Runs other jobs of the pool while waiting for this one, so it's fine to await a future from within a job.
+    decltype(auto) await();
+
+private:
+    using ValueType = Conditional<IsVoid<T>, Empty, T>;
+
+    explicit Future(ThreadPool& pool)
+        : m_pool(pool)
+    {
+    }
+
+    void resolve(ValueType);
+
+    ThreadPool& m_pool;
+    Optional<ValueType> m_value;
+    Atomic<bool> m_is_resolved { false };
+};
+
+// A fixed set of worker threads that run jobs, each from a queue of its own.
+// Jobs submitted from a worker go to the back of its queue, and it runs them last-in-first-out; workers that run out of jobs
+// steal from the front of the other queues. Threads that wait for a job to finish run other jobs in the meantime.
+class ThreadPool {
+    AK_MAKE_NONCOPYABLE(ThreadPool);
+    AK_MAKE_NONMOVABLE(ThreadPool);
+
+public:
+    // The pool shared by the whole process, with one worker for each processor but the one running the caller.
+    static ThreadPool& the();
+
+    explicit ThreadPool(size_t worker_count);
+    ~ThreadPool();
+
+    size_t worker_count() const { return m_workers.size(); }
+
+    template<typename Callback>
+    auto submit(Callback callback) -> NonnullRefPtr<Future<decltype(callback())>>
+    {
+        using T = decltype(callback());
+        auto future = adopt_ref(*new Future<T>(*this));
+        enqueue([future, callback = move(callback)]() mutable {
+            if constexpr (IsVoid<T>) {
+                callback();
+                future->resolve({});
+            } else {
+                future->resolve(callback());
+            }
+        });
+        return future;
+    }
+
+    // Calls `callback` for consecutive ranges [begin, end) that together cover [0, count) and are at most `grain_size` long,
+    // from this thread and the workers. Returns once all of them have been processed.
+    void parallel_for(size_t count, size_t grain_size, Function<void(size_t begin, size_t end)> callback);
+
+    template<typename T, typename Callback>
+    void parallel_for_each(Span<T> span, Callback callback, size_t grain_size = 1)
+    {
+        parallel_for(span.size(), grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                callback(span[i]);
+        });
+    }
+
+    // Sorts runs of the span in parallel, then merges neighbouring runs in parallel until only one is left.
+    // Like quick_sort(), this is not a stable sort.
+    template<typename T, typename LessThan>
+    void parallel_sort(Span<T> span, LessThan less_than)
+    {
+        auto run_count = min(worker_count() + 1, ceil_div(span.size(), minimum_parallel_sort_run_size));
+        if (run_count <= 1) {
+            quick_sort(span, less_than);
+            return;
+        }
+
+        auto run_size = ceil_div(span.size(), run_count);
+        run_count = ceil_div(span.size(), run_size);
+        parallel_for(run_count, 1, [&](size_t begin, size_t end) {
+            for (size_t run = begin; run < end; ++run) {
+                auto start = run * run_size;
+                auto slice = span.slice(start, min(run_size, span.size() - start));
+                quick_sort(slice, less_than);
+            }
+        });
+
+        for (; run_size < span.size(); run_size *= 2) {
+            parallel_for(ceil_div(span.size(), 2 * run_size), 1, [&](size_t begin, size_t end) {
+                for (size_t pair = begin; pair < end; ++pair) {
+                    auto start = pair * 2 * run_size;
+                    auto middle = start + run_size;
+                    if (middle >= span.size())
+                        continue;
+                    merge_runs(span.slice(start, min(2 * run_size, span.size() - start)), run_size, less_than);
+                }
+            });
+        }
+    }
+
+    template<typename T>
+    void parallel_sort(Span<T> span)
+    {
+        parallel_sort(span, [](auto& a, auto& b) { return a < b; });
+    }
+
+private:
+    template<typename>
+    friend class Future;
+
+    using Job = Function<void()>;
+
+    struct WorkQueue {
+        Mutex mutex;
+        Vector<Job> jobs;
+        // Jobs before this have been stolen already.
+        size_t head { 0 };
+    };
+
+    static constexpr size_t minimum_parallel_sort_run_size = 4096;
+
+    template<typename T, typename LessThan>
+    static void merge_runs(Span<T> span, size_t left_size, LessThan& less_than)
+    {
+        Vector<T> merged;
+        merged.ensure_capacity(span.size());
+        size_t left = 0;
+        size_t right = left_size;
+        while (left < left_size && right < span.size()) {
+            if (less_than(span[right], span[left]))
+                merged.unchecked_append(move(span[right++]));
+            else
+                merged.unchecked_append(move(span[left++]));
+        }
+        while (left < left_size)
+            merged.unchecked_append(move(span[left++]));
+        while (right < span.size())
+            merged.unchecked_append(move(span[right++]));
+        for (size_t i = 0; i < span.size(); ++i)
+            span[i] = move(merged[i]);
+    }
+
+    void enqueue(Job);
+    Optional<Job> take_job();
+    void run_jobs_until(Function<bool()> condition);
+    void notify_all();
+    intptr_t run_worker(size_t index);
+
+    Vector<NonnullRefPtr<Thread>> m_workers;
+    Vector<NonnullOwnPtr<WorkQueue>> m_queues;
+    Atomic<size_t> m_next_queue { 0 };
+    Atomic<size_t> m_pending_job_count { 0 };
+    Atomic<bool> m_is_exiting { false };
+
+    Mutex m_mutex;
+    ConditionVariable m_condition { m_mutex };
+};
+
+template<typename T>
+decltype(auto) Future<T>::await()
+{
+    m_pool.run_jobs_until([this] { return is_resolved(); });
+    if constexpr (!IsVoid<T>)
+        return (m_value.value());
+}
+
+template<typename T>
+void Future<T>::resolve(ValueType value)
+{
+    m_value = move(value);
+    m_is_resolved.store(true, AK::MemoryOrder::memory_order_release);
+    m_pool.notify_all();
+}
+
+}
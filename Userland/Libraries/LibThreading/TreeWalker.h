@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/DeprecatedString.h>
+#include <AK/Function.h>
+#include <AK/Optional.h>
+#include <AK/ScopeGuard.h>
+#include <AK/StringBuilder.h>
+#include <AK/Vector.h>
+#include <LibCore/System.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/ThreadPool.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+
+namespace Threading {
+
+struct TreeWalkerEntry {
+    // The directory that contains the entry (AT_FDCWD for the root), for looking at it with the *at() functions without
+    // resolving the whole path again.
+    int parent_fd { AT_FDCWD };
+    StringView name;
+    DeprecatedString path;
+    // One of the DT_* constants, but never DT_UNKNOWN.
+    unsigned char type { DT_UNKNOWN };
+    size_t depth { 0 };
+
+    ErrorOr<struct stat> stat() const { return Core::System::fstatat(parent_fd, name, AT_SYMLINK_NOFOLLOW); }
+};
+
+// Walks a directory tree on the threads of a ThreadPool, visiting the entries of a directory in parallel.
+// Symbolic links are never followed. The types of entries come from readdir() where possible, so that nothing has to be
+// stat'ed unless the callbacks ask for it.
+//
+// Everything in a directory has been visited by the time on_leave_directory() is called for it, and it gets the results
+// for its entries in the order they were read in. The walk stops at the first error that a callback returns.
+template<typename Result>
+class TreeWalker {
+public:
+    using Entry = TreeWalkerEntry;
+
+    // Called for everything that isn't a directory.
+    Function<ErrorOr<Result>(Entry const&)> on_file;
+    // Called for directories before anything in them. Optional.
+    Function<ErrorOr<void>(Entry const&)> on_enter_directory;
+    // Directories that this returns false for are skipped, and stand for a default-constructed result. Optional.
+    Function<bool(Entry const&)> should_enter_directory;
+    // Called for directories after everything in them.
+    Function<ErrorOr<Result>(Entry const&, Vector<Result>&)> on_leave_directory;
+
+    // Note: Without a pool of its own, the walker uses ThreadPool::the(), which isn't started until the first walk.
+    TreeWalker() = default;
+    explicit TreeWalker(ThreadPool& pool)
+        : m_pool(&pool)
+    {
+    }
+
+    ErrorOr<Result> walk(StringView path)
+    {
+        if (!m_pool)
+            m_pool = &ThreadPool::the();
+        m_error.clear();
+        auto result = visit({ AT_FDCWD, path, path, DT_UNKNOWN, 0 });
+        if (m_error.has_value())
+            return m_error.release_value();
+        return result;
+    }
+
+private:
+    struct DirectoryEntry {
+        DeprecatedString name;
+        unsigned char type { DT_UNKNOWN };
+    };
+
+    static unsigned char type_from_mode(mode_t mode)
+    {
+        if (S_ISDIR(mode))
+            return DT_DIR;
+        if (S_ISLNK(mode))
+            return DT_LNK;
+        if (S_ISCHR(mode))
+            return DT_CHR;
+        if (S_ISBLK(mode))
+            return DT_BLK;
+        if (S_ISFIFO(mode))
+            return DT_FIFO;
+        if (S_ISSOCK(mode))
+            return DT_SOCK;
+        return DT_REG;
+    }
+
+    bool has_failed()
+    {
+        MutexLocker locker(m_error_mutex);
+        return m_error.has_value();
+    }
+
+    // Returns a default-constructed result after failing, which will never be looked at.
+    Result fail(Error error)
+    {
+        MutexLocker locker(m_error_mutex);
+        if (!m_error.has_value())
+            m_error = move(error);
+        return {};
+    }
+
+    Result visit(Entry entry)
+    {
+        if (has_failed())
+            return {};
+
+        if (entry.type == DT_UNKNOWN) {
+            auto stat_or_error = entry.stat();
+            if (stat_or_error.is_error())
+                return fail(stat_or_error.release_error());
+            entry.type = type_from_mode(stat_or_error.value().st_mode);
+        }
+
+        if (entry.type != DT_DIR) {
+            auto result_or_error = on_file(entry);
+            if (result_or_error.is_error())
+                return fail(result_or_error.release_error());
+            return result_or_error.release_value();
+        }
+
+        if (should_enter_directory && !should_enter_directory(entry))
+            return {};
+
+        if (on_enter_directory) {
+            if (auto result = on_enter_directory(entry); result.is_error())
+                return fail(result.release_error());
+        }
+
+        auto fd_or_error = Core::System::openat(entry.parent_fd, entry.name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd_or_error.is_error())
+            return fail(fd_or_error.release_error());
+
+        auto* dir = fdopendir(fd_or_error.value());
+        if (!dir) {
+            auto error = Error::from_syscall("fdopendir"sv, -errno);
+            (void)Core::System::close(fd_or_error.value());
+            return fail(move(error));
+        }
+        ScopeGuard close_dir = [dir] { closedir(dir); };
+
+        // Note: All of the entries are read before any of them are visited, so that the directory is read as one.
+        Vector<DirectoryEntry> directory_entries;
+        while (true) {
+            errno = 0;
+            auto* dirent = readdir(dir);
+            if (!dirent) {
+                if (errno != 0)
+                    return fail(Error::from_syscall("readdir"sv, -errno));
+                break;
+            }
+            if (strcmp(dirent->d_name, ".") == 0 || strcmp(dirent->d_name, "..") == 0)
+                continue;
+            directory_entries.append({ dirent->d_name, dirent->d_type });
+        }
+
+        StringBuilder path_prefix;
+        path_prefix.append(entry.path);
+        if (!entry.path.ends_with('/'))
+            path_prefix.append('/');
+
+        Vector<Result> results;
+        results.resize(directory_entries.size());
+        auto parent_fd = dirfd(dir);
+        m_pool->parallel_for(directory_entries.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                auto const& directory_entry = directory_entries[i];
+                auto path = DeprecatedString::formatted("{}{}", path_prefix.string_view(), directory_entry.name);
+                results[i] = visit({ parent_fd, directory_entry.name, move(path), directory_entry.type, entry.depth + 1 });
+            }
+        });
+
+        if (has_failed())
+            return {};
+
+        auto result_or_error = on_leave_directory(entry, results);
+        if (result_or_error.is_error())
+            return fail(result_or_error.release_error());
+        return result_or_error.release_value();
+    }
+
+    ThreadPool* m_pool { nullptr };
+    Mutex m_error_mutex;
+    Optional<Error> m_error;
+};
+
+}
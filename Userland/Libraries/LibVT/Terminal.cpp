@@ -762,22 +762,25 @@ void Terminal::scroll_up(u16 region_top, u16 region_bottom, size_t count)
     if (should_move_to_scrollback) {
         auto remaining_lines = max_history_size() - history_size();
         history_delta = (count > remaining_lines) ? remaining_lines - count : 0;
-        for (size_t i = 0; i < count; ++i)
-            add_line_to_history(move(active_buffer().ptr_at(region_top + i)));
+        for (size_t i = 0; i < count; ++i) {
+            auto& line = active_buffer().ptr_at(region_top + i);
+            // Once the history is full, every line scrolling into it pushes out the oldest one, which then takes its
+            // place on screen. This way, scrolling through lots of output doesn't allocate and free a line every time.
+            if (auto oldest_line = add_line_to_history(move(line)))
+                line = oldest_line.release_nonnull();
+            else
+                line = make<Line>(columns());
+        }
     }
 
     // Move lines into their new place.
     for (u16 row = region_top; row + count <= region_bottom; ++row)
         swap(active_buffer().ptr_at(row), active_buffer().ptr_at(row + count));
     // Clear 'new' lines at the bottom.
-    if (should_move_to_scrollback) {
-        // Since we moved the previous lines into history, we can't just clear them.
-        for (u16 row = region_bottom + 1 - count; row <= region_bottom; ++row)
-            active_buffer().ptr_at(row) = make<Line>(columns());
-    } else {
-        // The new lines haven't been moved and we don't want to leak memory.
-        for (u16 row = region_bottom + 1 - count; row <= region_bottom; ++row)
-            active_buffer()[row].clear();
+    for (u16 row = region_bottom + 1 - count; row <= region_bottom; ++row) {
+        // Lines that come back from the history may have been put there before the terminal was last resized.
+        active_buffer()[row].set_length(columns());
+        active_buffer()[row].clear();
     }
     // Set dirty flag on swapped lines.
     // The other lines have implicitly been set dirty by being cleared.
@@ -382,10 +382,11 @@ protected:
 #ifndef KERNEL
     size_t m_history_start = 0;
     NonnullOwnPtrVector<Line> m_history;
-    void add_line_to_history(NonnullOwnPtr<Line>&& line)
+    // Returns the line that was pushed out of the history to make room for the new one, if any, so that it can be reused.
+    OwnPtr<Line> add_line_to_history(NonnullOwnPtr<Line>&& line)
     {
         if (max_history_size() == 0)
-            return;
+            return {};
 
         // If m_history can expand, add the new line to the end of the list.
         // If there is an overflow wrap, the end is at the index before the start.
@@ -395,10 +396,11 @@ protected:
             else
                 m_history.insert(m_history_start - 1, move(line));
 
-            return;
+            return {};
         }
-        m_history.ptr_at(m_history_start) = move(line);
+        auto oldest_line = exchange(m_history.ptr_at(m_history_start), move(line));
         m_history_start = (m_history_start + 1) % m_history.size();
+        return oldest_line;
     }
 
     NonnullOwnPtrVector<Line>& active_buffer() { return m_use_alternate_screen_buffer ? m_alternate_screen_buffer : m_normal_screen_buffer; };
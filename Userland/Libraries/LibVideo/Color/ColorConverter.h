@@ -63,9 +63,29 @@ class ColorConverter final {
 public:
     static DecoderErrorOr<ColorConverter> create(u8 bit_depth, CodingIndependentCodePoints cicp);
 
-    Gfx::Color convert_yuv_to_full_range_rgb(u16 y, u16 u, u16 v);
+    ALWAYS_INLINE Gfx::Color convert_yuv_to_full_range_rgb(u16 y, u16 u, u16 v) const
+    {
+        if (!m_should_skip_color_remapping)
+            return convert_yuv_to_full_range_rgb_with_color_remapping(y, u, v);
+
+        // Without remapping, the conversion is just the input matrix. It's inlined so that converting a whole frame doesn't
+        // make a call and a full 4x4 matrix multiplication for every pixel.
+        auto const& matrix = m_input_conversion_matrix.elements();
+        float y_value = y;
+        float u_value = u;
+        float v_value = v;
+        auto to_component = [](float value) {
+            return static_cast<u8>(clamp(value, 0.0f, 1.0f) * 255.0f);
+        };
+        return Gfx::Color(
+            to_component(matrix[0][0] * y_value + matrix[0][1] * u_value + matrix[0][2] * v_value + matrix[0][3]),
+            to_component(matrix[1][0] * y_value + matrix[1][1] * u_value + matrix[1][2] * v_value + matrix[1][3]),
+            to_component(matrix[2][0] * y_value + matrix[2][1] * u_value + matrix[2][2] * v_value + matrix[2][3]));
+    }
 
 private:
+    Gfx::Color convert_yuv_to_full_range_rgb_with_color_remapping(u16 y, u16 u, u16 v) const;
+
     static constexpr size_t to_linear_size = 64;
     static constexpr size_t to_non_linear_size = 64;
 
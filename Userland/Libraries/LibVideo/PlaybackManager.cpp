@@ -318,7 +318,8 @@ bool PlaybackManager::decode_and_queue_one_sample()
         break;
     }
 
-    auto bitmap = TRY_OR_ENQUEUE_ERROR(decoded_frame->to_bitmap());
+    auto bitmap = TRY_OR_ENQUEUE_ERROR(get_bitmap_for_frame(decoded_frame->size()));
+    TRY_OR_ENQUEUE_ERROR(decoded_frame->output_to_bitmap(bitmap));
     m_frame_queue->enqueue(FrameQueueItem::frame(bitmap, frame_sample->timestamp()));
     m_present_timer->start(0);
 
@@ -330,6 +331,21 @@ bool PlaybackManager::decode_and_queue_one_sample()
     return true;
 }
 
+DecoderErrorOr<NonnullRefPtr<Gfx::Bitmap>> PlaybackManager::get_bitmap_for_frame(Gfx::IntSize size)
+{
+    // Unused bitmaps of another size won't be needed again unless the video changes size back.
+    m_bitmap_pool.remove_all_matching([&](auto& bitmap) { return bitmap->ref_count() == 1 && bitmap->size() != size; });
+
+    for (auto& bitmap : m_bitmap_pool) {
+        if (bitmap->ref_count() == 1)
+            return bitmap;
+    }
+
+    auto bitmap = DECODER_TRY_ALLOC(Gfx::Bitmap::create(Gfx::BitmapFormat::BGRx8888, size));
+    DECODER_TRY_ALLOC(m_bitmap_pool.try_append(bitmap));
+    return bitmap;
+}
+
 void PlaybackManager::on_decode_timer()
 {
     if (!decode_and_queue_one_sample() && is_buffering()) {
@@ -136,6 +136,7 @@ private:
     void post_decoder_error(DecoderError error);
     bool decode_and_queue_one_sample();
     void on_decode_timer();
+    DecoderErrorOr<NonnullRefPtr<Gfx::Bitmap>> get_bitmap_for_frame(Gfx::IntSize);
 
     Core::Object& m_event_handler;
     Core::EventLoop& m_main_loop;
@@ -159,6 +160,10 @@ private:
 
     RefPtr<Core::Timer> m_decode_timer;
 
+    // Every bitmap that decoded frames were written to. Once the pool is the only one holding on to a bitmap, its frame
+    // has been presented and replaced, and the bitmap can be reused for another frame.
+    Vector<NonnullRefPtr<Gfx::Bitmap>> m_bitmap_pool;
+
     u64 m_skipped_frames;
 };
 
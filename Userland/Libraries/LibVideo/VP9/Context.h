@@ -13,10 +13,12 @@
 #include <LibGfx/Size.h>
 #include <LibVideo/Color/CodingIndependentCodePoints.h>
 
+#include "BitStream.h"
 #include "ContextStorage.h"
 #include "Enums.h"
 #include "LookupTables.h"
 #include "MotionVector.h"
+#include "SyntaxElementCounter.h"
 #include "Utilities.h"
 
 namespace Video::VP9 {
@@ -173,9 +175,11 @@ static NonZeroTokensView create_non_zero_tokens_view(NonZeroTokens& non_zero_tok
     return create_non_zero_tokens_view({ non_zero_tokens[0].span(), non_zero_tokens[1].span(), non_zero_tokens[2].span() }, start_in_sub_blocks, size_in_sub_blocks, subsampling);
 }
 
+// Tiles in different columns don't depend on each other, so each tile has its own bit stream and counts its own syntax
+// elements, and a column of tiles can be decoded on any thread.
 struct TileContext {
 public:
-    static ErrorOr<TileContext> try_create(FrameContext& frame_context, u32 rows_start, u32 rows_end, u32 columns_start, u32 columns_end, PartitionContextView above_partition_context, NonZeroTokensView above_non_zero_tokens, SegmentationPredictionContextView above_segmentation_ids)
+    static ErrorOr<TileContext> try_create(FrameContext& frame_context, ReadonlyBytes data, SyntaxElementCounter& counter, u32 rows_start, u32 rows_end, u32 columns_start, u32 columns_end, PartitionContextView above_partition_context, NonZeroTokensView above_non_zero_tokens, SegmentationPredictionContextView above_segmentation_ids)
     {
         auto width = columns_end - columns_start;
         auto height = rows_end - rows_start;
@@ -183,6 +187,8 @@ public:
 
         return TileContext {
             frame_context,
+            BitStream(data.data(), data.size()),
+            counter,
             rows_start,
             rows_end,
             columns_start,
@@ -200,6 +206,8 @@ public:
     Vector2D<FrameBlockContext> const& frame_block_contexts() const { return frame_context.block_contexts(); }
 
     FrameContext const& frame_context;
+    BitStream bit_stream;
+    SyntaxElementCounter& counter;
     u32 rows_start { 0 };
     u32 rows_end { 0 };
     u32 columns_start { 0 };
@@ -245,7 +253,7 @@ struct BlockContext {
     Vector2D<FrameBlockContext> const& frame_block_contexts() const { return frame_context.block_contexts(); }
 
     FrameContext const& frame_context;
-    TileContext const& tile_context;
+    TileContext& tile_context;
     u32 row { 0 };
     u32 column { 0 };
     BlockSubsize size;
@@ -89,7 +89,7 @@ private:
     DecoderErrorOr<u8> update_mv_prob(u8 prob);
 
     /* (6.4) Decode Tiles Syntax */
-    DecoderErrorOr<void> decode_tiles(FrameContext&);
+    DecoderErrorOr<void> decode_tiles(FrameContext&, ReadonlyBytes tile_data);
     DecoderErrorOr<void> decode_tile(TileContext&);
     void clear_left_context(TileContext&);
     DecoderErrorOr<void> decode_partition(TileContext&, u32 row, u32 column, BlockSubsize subsize);
@@ -109,10 +109,10 @@ private:
     DecoderErrorOr<void> read_ref_frames(BlockContext&, FrameBlockContext above_context, FrameBlockContext left_context);
     DecoderErrorOr<MotionVectorPair> get_motion_vector(BlockContext const&, BlockMotionVectorCandidates const&);
     DecoderErrorOr<MotionVector> read_motion_vector(BlockContext const&, BlockMotionVectorCandidates const&, ReferenceIndex);
-    DecoderErrorOr<i32> read_single_motion_vector_component(u8 component, bool use_high_precision);
+    DecoderErrorOr<i32> read_single_motion_vector_component(BlockContext const&, u8 component, bool use_high_precision);
     DecoderErrorOr<bool> residual(BlockContext&, bool has_block_above, bool has_block_left);
     DecoderErrorOr<bool> tokens(BlockContext&, size_t plane, u32 x, u32 y, TransformSize, TransformSet, Array<u8, 1024> token_cache);
-    DecoderErrorOr<i32> read_coef(u8 bit_depth, Token token);
+    DecoderErrorOr<i32> read_coef(BitStream&, u8 bit_depth, Token token);
 
     /* (6.5) Motion Vector Prediction */
     MotionVectorPair find_reference_motion_vectors(BlockContext&, ReferenceFrameType, i32 block);
@@ -15,6 +15,8 @@ class SyntaxElementCounter final {
 public:
     /* (8.3) Clear Counts Process */
     void clear_counts();
+    // Adds up the counts of tiles that were decoded separately.
+    SyntaxElementCounter& operator+=(SyntaxElementCounter const&);
 
     u32 m_counts_intra_mode[BLOCK_SIZE_GROUPS][INTRA_MODES];
     u32 m_counts_uv_mode[INTRA_MODES][INTRA_MODES];
@@ -6,6 +6,7 @@
 
 #include <AK/NonnullOwnPtr.h>
 #include <AK/OwnPtr.h>
+#include <LibThreading/ThreadPool.h>
 #include <LibVideo/Color/ColorConverter.h>
 
 #include "VideoFrame.h"
@@ -26,68 +27,85 @@ ErrorOr<NonnullOwnPtr<SubsampledYUVFrame>> SubsampledYUVFrame::try_create(
 
 DecoderErrorOr<void> SubsampledYUVFrame::output_to_bitmap(Gfx::Bitmap& bitmap)
 {
+    VERIFY(bitmap.format() == Gfx::BitmapFormat::BGRx8888 || bitmap.format() == Gfx::BitmapFormat::BGRA8888);
+    VERIFY(bitmap.size() == size());
+
     size_t width = this->width();
     size_t height = this->height();
-    auto u_sample_row = DECODER_TRY_ALLOC(FixedArray<u16>::create(width));
-    auto v_sample_row = DECODER_TRY_ALLOC(FixedArray<u16>::create(width));
     size_t uv_width = width >> m_subsampling_horizontal;
 
     auto converter = TRY(ColorConverter::create(bit_depth(), cicp()));
 
-    for (size_t row = 0; row < height; row++) {
-        auto uv_row = row >> m_subsampling_vertical;
+    // The rows are converted in bands on the thread pool. Every band starts on an even row, which doesn't depend on the
+    // UV samples interpolated for the row before it.
+    auto band_count = clamp(ceil_div(height, minimum_rows_per_band), 1, Threading::ThreadPool::the().worker_count() + 1);
+    auto rows_per_band = max(ceil_div(height, band_count), 2);
+    rows_per_band += rows_per_band & 1;
+    band_count = ceil_div(height, rows_per_band);
 
-        // Linearly interpolate the UV samples vertically first.
-        // This will write all UV samples that are located on the Y sample as well,
-        // so we only need to interpolate horizontally between UV samples in the next
-        // step.
-        if ((row & m_subsampling_vertical) == 0 || row == height - 1) {
-            for (size_t uv_column = 0; uv_column < uv_width; uv_column++) {
-                size_t column = uv_column << m_subsampling_horizontal;
-                size_t index = uv_row * uv_width + uv_column;
-                u_sample_row[column] = m_plane_u[index];
-                v_sample_row[column] = m_plane_v[index];
-            }
-        } else {
-            for (size_t uv_column = 0; uv_column < uv_width; uv_column++) {
-                size_t column = uv_column << m_subsampling_horizontal;
-                size_t index = (uv_row + 1) * uv_width + uv_column;
-                u_sample_row[column] = (u_sample_row[column] + m_plane_u[index]) >> 1;
-                v_sample_row[column] = (v_sample_row[column] + m_plane_v[index]) >> 1;
+    Vector<Optional<DecoderError>> band_errors;
+    DECODER_TRY_ALLOC(band_errors.try_resize(band_count));
+    Threading::ThreadPool::the().parallel_for(band_count, 1, [&](size_t begin, size_t end) {
+        for (size_t band = begin; band < end; band++) {
+            auto u_sample_row_or_error = FixedArray<u16>::create(width);
+            auto v_sample_row_or_error = FixedArray<u16>::create(width);
+            if (u_sample_row_or_error.is_error() || v_sample_row_or_error.is_error()) {
+                band_errors[band] = DecoderError::with_description(DecoderErrorCategory::Memory, "Couldn't allocate UV sample rows"sv);
+                continue;
             }
-        }
-        // Fill in the last pixel of the row which may not be applied by the above
-        // loops if the last pixel in each row is on an uneven index.
-        if ((width & 1) == 0) {
-            u_sample_row[width - 1] = u_sample_row[width - 2];
-            v_sample_row[width - 1] = v_sample_row[width - 2];
-        }
+            auto u_sample_row = u_sample_row_or_error.release_value();
+            auto v_sample_row = v_sample_row_or_error.release_value();
 
-        // Interpolate the samples horizontally.
-        if (m_subsampling_horizontal) {
-            for (size_t column = 1; column < width - 1; column += 2) {
-                u_sample_row[column] = (u_sample_row[column - 1] + u_sample_row[column + 1]) >> 1;
-                v_sample_row[column] = (v_sample_row[column - 1] + v_sample_row[column + 1]) >> 1;
-            }
-        }
+            auto band_end = min(height, (band + 1) * rows_per_band);
+            for (size_t row = band * rows_per_band; row < band_end; row++) {
+                auto uv_row = row >> m_subsampling_vertical;
 
-        for (size_t column = 0; column < width; column++) {
-            auto y_sample = m_plane_y[row * width + column];
-            auto u_sample = u_sample_row[column];
-            auto v_sample = v_sample_row[column];
+                // Linearly interpolate the UV samples vertically first.
+                // This will write all UV samples that are located on the Y sample as well,
+                // so we only need to interpolate horizontally between UV samples in the next
+                // step.
+                if ((row & m_subsampling_vertical) == 0 || row == height - 1) {
+                    for (size_t uv_column = 0; uv_column < uv_width; uv_column++) {
+                        size_t column = uv_column << m_subsampling_horizontal;
+                        size_t index = uv_row * uv_width + uv_column;
+                        u_sample_row[column] = m_plane_u[index];
+                        v_sample_row[column] = m_plane_v[index];
+                    }
+                } else {
+                    for (size_t uv_column = 0; uv_column < uv_width; uv_column++) {
+                        size_t column = uv_column << m_subsampling_horizontal;
+                        size_t index = (uv_row + 1) * uv_width + uv_column;
+                        u_sample_row[column] = (u_sample_row[column] + m_plane_u[index]) >> 1;
+                        v_sample_row[column] = (v_sample_row[column] + m_plane_v[index]) >> 1;
+                    }
+                }
+                // Fill in the last pixel of the row which may not be applied by the above
+                // loops if the last pixel in each row is on an uneven index.
+                if ((width & 1) == 0) {
+                    u_sample_row[width - 1] = u_sample_row[width - 2];
+                    v_sample_row[width - 1] = v_sample_row[width - 2];
+                }
 
-            bitmap.set_pixel(Gfx::IntPoint(column, row), converter.convert_yuv_to_full_range_rgb(y_sample, u_sample, v_sample));
+                // Interpolate the samples horizontally.
+                if (m_subsampling_horizontal) {
+                    for (size_t column = 1; column < width - 1; column += 2) {
+                        u_sample_row[column] = (u_sample_row[column - 1] + u_sample_row[column + 1]) >> 1;
+                        v_sample_row[column] = (v_sample_row[column - 1] + v_sample_row[column + 1]) >> 1;
+                    }
+                }
 
-            /*auto r_float = clamp(y_sample + (v_sample - 128) * 219.0f / 224.0f * 1.5748f, 0, 255);
-            auto g_float = clamp(y_sample + (u_sample - 128) * 219.0f / 224.0f * -0.0722f * 1.8556f / 0.7152f + (v_sample - 128) * 219.0f / 224.0f * -0.2126f * 1.5748f / 0.7152f, 0, 255);
-            auto b_float = clamp(y_sample + (u_sample - 128) * 219.0f / 224.0f * 1.8556f, 0, 255);
-            auto r = static_cast<u8>(r_float);
-            auto g = static_cast<u8>(g_float);
-            auto b = static_cast<u8>(b_float);
-            bitmap.set_pixel(Gfx::IntPoint(column, row), Color(r, g, b));*/
+                auto const* y_sample_row = m_plane_y.data() + row * width;
+                auto* scanline = bitmap.scanline(row);
+                for (size_t column = 0; column < width; column++)
+                    scanline[column] = converter.convert_yuv_to_full_range_rgb(y_sample_row[column], u_sample_row[column], v_sample_row[column]).value();
+            }
         }
-    }
+    });
 
+    for (auto& error : band_errors) {
+        if (error.has_value())
+            return error.release_value();
+    }
     return {};
 }
 
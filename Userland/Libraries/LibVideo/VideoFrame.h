@@ -75,6 +75,9 @@ public:
     DecoderErrorOr<void> output_to_bitmap(Gfx::Bitmap& bitmap) override;
 
 protected:
+    // Bands any smaller than this aren't worth handing to another thread.
+    static constexpr size_t minimum_rows_per_band = 32;
+
     bool m_subsampling_horizontal;
     bool m_subsampling_vertical;
     FixedArray<u16> m_plane_y;
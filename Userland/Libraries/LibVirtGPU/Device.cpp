@@ -265,6 +265,16 @@ void Device::draw_primitives(GPU::PrimitiveType primitive_type, FloatMatrix4x4 c
     MUST(upload_command_buffer(builder.build()));
 }
 
+void Device::draw_indexed_primitives(GPU::PrimitiveType primitive_type, FloatMatrix4x4 const& modelview_matrix, FloatMatrix4x4 const& projection_matrix, Vector<GPU::Vertex>& vertices, Vector<u32> const& indices)
+{
+    // FIXME: Upload the indices and draw with an index buffer instead.
+    m_indexed_vertices.clear_with_capacity();
+    m_indexed_vertices.ensure_capacity(indices.size());
+    for (auto index : indices)
+        m_indexed_vertices.unchecked_append(vertices[index]);
+    draw_primitives(primitive_type, modelview_matrix, projection_matrix, m_indexed_vertices);
+}
+
 void Device::resize(Gfx::IntSize)
 {
     dbgln("VirtGPU::Device::resize(): unimplemented");
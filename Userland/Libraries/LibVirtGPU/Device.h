@@ -28,6 +28,7 @@ public:
     virtual GPU::DeviceInfo info() const override;
 
     virtual void draw_primitives(GPU::PrimitiveType, FloatMatrix4x4 const& model_view_transform, FloatMatrix4x4 const& projection_transform, Vector<GPU::Vertex>& vertices) override;
+    virtual void draw_indexed_primitives(GPU::PrimitiveType, FloatMatrix4x4 const& model_view_transform, FloatMatrix4x4 const& projection_transform, Vector<GPU::Vertex>& vertices, Vector<u32> const& indices) override;
     virtual void resize(Gfx::IntSize min_size) override;
     virtual void clear_color(FloatVector4 const&) override;
     virtual void clear_depth(GPU::DepthType) override;
@@ -91,6 +92,7 @@ private:
     };
 
     Vector<VertexData> m_vertices;
+    Vector<GPU::Vertex> m_indexed_vertices;
 
     Vector<float> m_constant_buffer_data;
 };
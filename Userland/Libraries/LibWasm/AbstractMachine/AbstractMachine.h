@@ -462,27 +462,32 @@ private:
 
 class Label {
 public:
-    explicit Label(size_t arity, InstructionPointer continuation)
+    explicit Label(size_t arity, InstructionPointer continuation, size_t stack_height)
         : m_arity(arity)
         , m_continuation(continuation)
+        , m_stack_height(stack_height)
     {
     }
 
     auto continuation() const { return m_continuation; }
     auto arity() const { return m_arity; }
+    // The size of the value stack when the label was entered, a branch to it leaves its arity's worth of values on top of that.
+    auto stack_height() const { return m_stack_height; }
 
 private:
     size_t m_arity { 0 };
     InstructionPointer m_continuation { 0 };
+    size_t m_stack_height { 0 };
 };
 
 class Frame {
 public:
-    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity)
+    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity, Span<Module::Function::BlockInfo const> block_infos = {})
         : m_module(module)
         , m_locals(move(locals))
         , m_expression(expression)
         , m_arity(arity)
+        , m_block_infos(block_infos)
     {
     }
 
@@ -491,17 +496,26 @@ public:
     auto& locals() { return m_locals; }
     auto& expression() const { return m_expression; }
     auto arity() const { return m_arity; }
+    auto& block_info(InstructionPointer ip) const { return m_block_infos[ip.value()]; }
+
+    // The index of the function's own label in the label stack, everything above it belongs to this frame.
+    auto label_index() const { return m_label_index; }
+    void set_label_index(size_t index) { m_label_index = index; }
 
 private:
     ModuleInstance const& m_module;
     Vector<Value> m_locals;
     Expression const& m_expression;
     size_t m_arity { 0 };
+    size_t m_label_index { 0 };
+    Span<Module::Function::BlockInfo const> m_block_infos;
 };
 
+// NOTE: Labels and frames are kept on stacks of their own (see Configuration), so this only ever holds values
+//       and instructions can use them without having to check what they are first.
 class Stack {
 public:
-    using EntryType = Variant<Value, Label, Frame>;
+    using EntryType = Value;
     Stack() = default;
 
     [[nodiscard]] ALWAYS_INLINE bool is_empty() const { return m_data.is_empty(); }
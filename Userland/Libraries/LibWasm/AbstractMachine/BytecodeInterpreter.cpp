@@ -24,13 +24,6 @@ namespace Wasm {
         }                                                                                      \
     } while (false)
 
-#define TRAP_IF_NOT_NORETURN(x)                                                                \
-    do {                                                                                       \
-        if (trap_if_not(x, #x##sv)) {                                                          \
-            dbgln_if(WASM_TRACE_DEBUG, "Trapped because {} failed, at line {}", #x, __LINE__); \
-        }                                                                                      \
-    } while (false)
-
 void BytecodeInterpreter::interpret(Configuration& configuration)
 {
     m_trap.clear();
@@ -60,24 +53,25 @@ void BytecodeInterpreter::interpret(Configuration& configuration)
 void BytecodeInterpreter::branch_to_label(Configuration& configuration, LabelIndex index)
 {
     dbgln_if(WASM_TRACE_DEBUG, "Branch to label with index {}...", index.value());
-    auto label = configuration.nth_label(index.value());
-    dbgln_if(WASM_TRACE_DEBUG, "...which is actually IP {}, and has {} result(s)", label->continuation().value(), label->arity());
-    auto results = pop_values(configuration, label->arity());
-
-    size_t drop_count = index.value() + 1;
-    for (; !configuration.stack().is_empty();) {
-        auto& entry = configuration.stack().peek();
-        if (entry.has<Label>()) {
-            if (--drop_count == 0)
-                break;
-        }
-        configuration.stack().pop();
-    }
-
-    for (auto& result : results)
-        configuration.stack().push(move(result));
-
-    configuration.ip() = label->continuation();
+    auto label_index = configuration.nth_label_index(index.value());
+    TRAP_IF_NOT(label_index.has_value());
+    auto& label_stack = configuration.label_stack();
+    auto label = label_stack[*label_index];
+    dbgln_if(WASM_TRACE_DEBUG, "...which is actually IP {}, and has {} result(s)", label.continuation().value(), label.arity());
+
+    // Move the results down to where the label was entered, and drop everything in between.
+    auto& values = configuration.stack().entries();
+    TRAP_IF_NOT(values.size() >= label.stack_height() + label.arity());
+    auto first_result = values.size() - label.arity();
+    if (first_result != label.stack_height()) {
+        for (size_t i = 0; i < label.arity(); ++i)
+            values[label.stack_height() + i] = move(values[first_result + i]);
+        values.shrink(label.stack_height() + label.arity(), true);
+    }
+
+    // NOTE: The target label itself stays, it's popped by the `end` its continuation points at (or re-entered, for loops).
+    label_stack.shrink(*label_index + 1, true);
+    configuration.ip() = label.continuation();
 }
 
 template<typename ReadType, typename PushType>
@@ -91,7 +85,7 @@ void BytecodeInterpreter::load_and_push(Configuration& configuration, Instructio
     }
     auto& arg = instruction.arguments().get<Instruction::MemoryArgument>();
     auto& entry = configuration.stack().peek();
-    auto base = entry.get<Value>().to<i32>();
+    auto base = entry.to<i32>();
     if (!base.has_value()) {
         m_trap = Trap { "Memory access out of bounds" };
         return;
@@ -116,17 +110,14 @@ void BytecodeInterpreter::call_address(Configuration& configuration, FunctionAdd
     auto instance = configuration.store().get(address);
     FunctionType const* type { nullptr };
     instance->visit([&](auto const& function) { type = &function.type(); });
-    TRAP_IF_NOT(configuration.stack().entries().size() > type->parameters().size());
+    TRAP_IF_NOT(configuration.stack().size() >= configuration.label_stack().last().stack_height() + type->parameters().size());
     Vector<Value> args;
     args.ensure_capacity(type->parameters().size());
     auto span = configuration.stack().entries().span().slice_from_end(type->parameters().size());
-    for (auto& entry : span) {
-        auto* call_argument = entry.get_pointer<Value>();
-        TRAP_IF_NOT(call_argument);
-        args.unchecked_append(move(*call_argument));
-    }
+    for (auto& entry : span)
+        args.unchecked_append(move(entry));
 
-    configuration.stack().entries().remove(configuration.stack().size() - span.size(), span.size());
+    configuration.stack().entries().shrink(configuration.stack().size() - span.size(), true);
 
     Result result { Trap { ""sv } };
     {
@@ -149,10 +140,8 @@ void BytecodeInterpreter::binary_numeric_operation(Configuration& configuration)
 {
     auto rhs_entry = configuration.stack().pop();
     auto& lhs_entry = configuration.stack().peek();
-    auto rhs_ptr = rhs_entry.get_pointer<Value>();
-    auto lhs_ptr = lhs_entry.get_pointer<Value>();
-    auto rhs = rhs_ptr->to<PopType>();
-    auto lhs = lhs_ptr->to<PopType>();
+    auto rhs = rhs_entry.to<PopType>();
+    auto lhs = lhs_entry.to<PopType>();
     PushType result;
     auto call_result = Operator {}(lhs.value(), rhs.value());
     if constexpr (IsSpecializationOf<decltype(call_result), AK::Result>) {
@@ -172,8 +161,7 @@ template<typename PopType, typename PushType, typename Operator>
 void BytecodeInterpreter::unary_operation(Configuration& configuration)
 {
     auto& entry = configuration.stack().peek();
-    auto entry_ptr = entry.get_pointer<Value>();
-    auto value = entry_ptr->to<PopType>();
+    auto value = entry.to<PopType>();
     auto call_result = Operator {}(*value);
     PushType result;
     if constexpr (IsSpecializationOf<decltype(call_result), AK::Result>) {
@@ -225,10 +213,10 @@ template<typename PopT, typename StoreT>
 void BytecodeInterpreter::pop_and_store(Configuration& configuration, Instruction const& instruction)
 {
     auto entry = configuration.stack().pop();
-    auto value = ConvertToRaw<StoreT> {}(*entry.get<Value>().to<PopT>());
+    auto value = ConvertToRaw<StoreT> {}(*entry.to<PopT>());
     dbgln_if(WASM_TRACE_DEBUG, "stack({}) -> temporary({}b)", value, sizeof(StoreT));
     auto base_entry = configuration.stack().pop();
-    auto base = base_entry.get<Value>().to<i32>();
+    auto base = base_entry.to<i32>();
     store_to_memory(configuration, instruction, { &value, sizeof(StoreT) }, *base);
 }
 
@@ -329,21 +317,6 @@ MakeUnsigned<T> BytecodeInterpreter::checked_unsigned_truncate(V value)
     return true;
 }
 
-Vector<Value> BytecodeInterpreter::pop_values(Configuration& configuration, size_t count)
-{
-    Vector<Value> results;
-    results.resize(count);
-
-    for (size_t i = 0; i < count; ++i) {
-        auto top_of_stack = configuration.stack().pop();
-        if (auto value = top_of_stack.get_pointer<Value>())
-            results[i] = move(*value);
-        else
-            TRAP_IF_NOT_NORETURN(value);
-    }
-    return results;
-}
-
 void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPointer& ip, Instruction const& instruction)
 {
     dbgln_if(WASM_TRACE_DEBUG, "Executing instruction {} at ip {}", instruction_name(instruction.opcode()), ip.value());
@@ -359,7 +332,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         return;
     case Instructions::local_set.value(): {
         auto entry = configuration.stack().pop();
-        configuration.frame().locals()[instruction.arguments().get<LocalIndex>().value()] = move(entry.get<Value>());
+        configuration.frame().locals()[instruction.arguments().get<LocalIndex>().value()] = move(entry);
         return;
     }
     case Instructions::i32_const.value():
@@ -374,125 +347,51 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::f64_const.value():
         configuration.stack().push(Value(ValueType { ValueType::F64 }, instruction.arguments().get<double>()));
         return;
-    case Instructions::block.value(): {
-        size_t arity = 0;
-        size_t parameter_count = 0;
-        auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
-        switch (args.block_type.kind()) {
-        case BlockType::Empty:
-            break;
-        case BlockType::Type:
-            arity = 1;
-            break;
-        case BlockType::Index: {
-            auto& type = configuration.frame().module().types()[args.block_type.type_index().value()];
-            arity = type.results().size();
-            parameter_count = type.parameters().size();
-        }
-        }
-
-        configuration.stack().entries().insert(configuration.stack().size() - parameter_count, Label(arity, args.end_ip));
-        return;
-    }
+    case Instructions::block.value():
     case Instructions::loop.value(): {
-        size_t arity = 0;
-        size_t parameter_count = 0;
-        auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
-        switch (args.block_type.kind()) {
-        case BlockType::Empty:
-            break;
-        case BlockType::Type:
-            arity = 1;
-            break;
-        case BlockType::Index: {
-            auto& type = configuration.frame().module().types()[args.block_type.type_index().value()];
-            arity = type.results().size();
-            parameter_count = type.parameters().size();
-        }
-        }
-
-        configuration.stack().entries().insert(configuration.stack().size() - parameter_count, Label(arity, ip.value() + 1));
+        auto& info = configuration.frame().block_info(ip);
+        configuration.label_stack().append(Label(info.arity, info.continuation, configuration.stack().size() - info.parameter_count));
         return;
     }
     case Instructions::if_.value(): {
-        size_t arity = 0;
-        size_t parameter_count = 0;
         auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
-        switch (args.block_type.kind()) {
-        case BlockType::Empty:
-            break;
-        case BlockType::Type:
-            arity = 1;
-            break;
-        case BlockType::Index: {
-            auto& type = configuration.frame().module().types()[args.block_type.type_index().value()];
-            arity = type.results().size();
-            parameter_count = type.parameters().size();
-        }
-        }
-
+        auto& info = configuration.frame().block_info(ip);
         auto entry = configuration.stack().pop();
-        auto value = entry.get<Value>().to<i32>();
-        auto end_label = Label(arity, args.end_ip.value());
+        auto value = entry.to<i32>();
         if (value.value() == 0) {
-            if (args.else_ip.has_value()) {
-                configuration.ip() = args.else_ip.value();
-                configuration.stack().entries().insert(configuration.stack().size() - parameter_count, end_label);
-            } else {
+            if (!args.else_ip.has_value()) {
                 configuration.ip() = args.end_ip.value() + 1;
+                return;
             }
-        } else {
-            configuration.stack().entries().insert(configuration.stack().size() - parameter_count, end_label);
+            configuration.ip() = args.else_ip.value();
         }
+        configuration.label_stack().append(Label(info.arity, info.continuation, configuration.stack().size() - info.parameter_count));
         return;
     }
     case Instructions::structured_end.value():
-    case Instructions::structured_else.value(): {
-        auto index = configuration.nth_label_index(0);
-        auto label = configuration.stack().entries()[*index].get<Label>();
-        configuration.stack().entries().remove(*index, 1);
-
-        if (instruction.opcode() == Instructions::structured_end)
-            return;
-
-        // Jump to the end label
-        configuration.ip() = label.continuation();
+        configuration.label_stack().take_last();
         return;
-    }
-    case Instructions::return_.value(): {
-        auto& frame = configuration.frame();
-        Checked checked_index { configuration.stack().size() };
-        checked_index -= frame.arity();
-        VERIFY(!checked_index.has_overflow());
-
-        auto index = checked_index.value();
-        size_t i = 1;
-        for (; i <= index; ++i) {
-            auto& entry = configuration.stack().entries()[index - i];
-            if (entry.has<Label>()) {
-                if (configuration.stack().entries()[index - i - 1].has<Frame>())
-                    break;
-            }
-        }
-
-        configuration.stack().entries().remove(index - i + 1, i - 1);
-
-        // Jump past the call/indirect instruction
-        configuration.ip() = configuration.frame().expression().instructions().size();
+    case Instructions::structured_else.value():
+        // Jump to the end, which pops the label
+        configuration.ip() = configuration.label_stack().last().continuation();
         return;
+    case Instructions::return_.value(): {
+        // Branch to the frame's own label, which jumps past the end of the function.
+        auto label_depth = configuration.label_stack().size() - configuration.frame().label_index() - 1;
+        return branch_to_label(configuration, LabelIndex { label_depth });
     }
     case Instructions::br.value():
         return branch_to_label(configuration, instruction.arguments().get<LabelIndex>());
     case Instructions::br_if.value(): {
         auto entry = configuration.stack().pop();
-        if (entry.get<Value>().to<i32>().value_or(0) == 0)
+        if (entry.to<i32>().value_or(0) == 0)
             return;
         return branch_to_label(configuration, instruction.arguments().get<LabelIndex>());
     }
     case Instructions::br_table.value(): {
         auto& arguments = instruction.arguments().get<Instruction::TableBranchArgs>();
         auto entry = configuration.stack().pop();
-        auto maybe_i = entry.get<Value>().to<i32>();
+        auto maybe_i = entry.to<i32>();
         if (0 <= *maybe_i) {
             size_t i = *maybe_i;
             if (i < arguments.labels.size())
@@ -512,7 +411,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto table_address = configuration.frame().module().tables()[args.table.value()];
         auto table_instance = configuration.store().get(table_address);
         auto entry = configuration.stack().pop();
-        auto index = entry.get<Value>().to<i32>();
+        auto index = entry.to<i32>();
         TRAP_IF_NOT(index.value() >= 0);
         TRAP_IF_NOT(static_cast<size_t>(index.value()) < table_instance->elements().size());
         auto element = table_instance->elements()[index.value()];
@@ -571,7 +470,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         return pop_and_store<i64, i32>(configuration, instruction);
     case Instructions::local_tee.value(): {
         auto& entry = configuration.stack().peek();
-        auto value = entry.get<Value>();
+        auto value = entry;
         auto local_index = instruction.arguments().get<LocalIndex>();
         dbgln_if(WASM_TRACE_DEBUG, "stack:peek -> locals({})", local_index.value());
         configuration.frame().locals()[local_index.value()] = move(value);
@@ -589,7 +488,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto global_index = instruction.arguments().get<GlobalIndex>();
         auto address = configuration.frame().module().globals()[global_index.value()];
         auto entry = configuration.stack().pop();
-        auto value = entry.get<Value>();
+        auto value = entry;
         dbgln_if(WASM_TRACE_DEBUG, "stack -> global({})", address.value());
         auto global = configuration.store().get(address);
         global->set_value(move(value));
@@ -608,7 +507,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto instance = configuration.store().get(address);
         i32 old_pages = instance->size() / Constants::page_size;
         auto& entry = configuration.stack().peek();
-        auto new_pages = entry.get<Value>().to<i32>();
+        auto new_pages = entry.to<i32>();
         dbgln_if(WASM_TRACE_DEBUG, "memory.grow({}), previously {} pages...", *new_pages, old_pages);
         if (instance->grow(new_pages.value() * Constants::page_size))
             configuration.stack().peek() = Value((i32)old_pages);
@@ -620,9 +519,9 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::memory_fill.value(): {
         auto address = configuration.frame().module().memories()[0];
         auto instance = configuration.store().get(address);
-        auto count = configuration.stack().pop().get<Value>().to<i32>().value();
-        auto value = configuration.stack().pop().get<Value>().to<i32>().value();
-        auto destination_offset = configuration.stack().pop().get<Value>().to<i32>().value();
+        auto count = configuration.stack().pop().to<i32>().value();
+        auto value = configuration.stack().pop().to<i32>().value();
+        auto destination_offset = configuration.stack().pop().to<i32>().value();
 
         TRAP_IF_NOT(static_cast<size_t>(destination_offset + count) <= instance->data().size());
 
@@ -643,9 +542,9 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::memory_copy.value(): {
         auto address = configuration.frame().module().memories()[0];
         auto instance = configuration.store().get(address);
-        auto count = configuration.stack().pop().get<Value>().to<i32>().value();
-        auto source_offset = configuration.stack().pop().get<Value>().to<i32>().value();
-        auto destination_offset = configuration.stack().pop().get<Value>().to<i32>().value();
+        auto count = configuration.stack().pop().to<i32>().value();
+        auto source_offset = configuration.stack().pop().to<i32>().value();
+        auto destination_offset = configuration.stack().pop().to<i32>().value();
 
         TRAP_IF_NOT(static_cast<size_t>(source_offset + count) <= instance->data().size());
         TRAP_IF_NOT(static_cast<size_t>(destination_offset + count) <= instance->data().size());
@@ -677,9 +576,9 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto data_index = instruction.arguments().get<DataIndex>();
         auto& data_address = configuration.frame().module().datas()[data_index.value()];
         auto& data = *configuration.store().get(data_address);
-        auto count = *configuration.stack().pop().get<Value>().to<i32>();
-        auto source_offset = *configuration.stack().pop().get<Value>().to<i32>();
-        auto destination_offset = *configuration.stack().pop().get<Value>().to<i32>();
+        auto count = *configuration.stack().pop().to<i32>();
+        auto source_offset = *configuration.stack().pop().to<i32>();
+        auto destination_offset = *configuration.stack().pop().to<i32>();
 
         TRAP_IF_NOT(count > 0);
         TRAP_IF_NOT(source_offset + count > 0);
@@ -719,9 +618,9 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         return;
     }
     case Instructions::ref_is_null.value(): {
-        auto top = configuration.stack().peek().get_pointer<Value>();
-        TRAP_IF_NOT(top->type().is_reference());
-        auto is_null = top->to<Reference::Null>().has_value();
+        auto& top = configuration.stack().peek();
+        TRAP_IF_NOT(top.type().is_reference());
+        auto is_null = top.to<Reference::Null>().has_value();
         configuration.stack().peek() = Value(ValueType(ValueType::I32), static_cast<u64>(is_null ? 1 : 0));
         return;
     }
@@ -732,12 +631,12 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     case Instructions::select_typed.value(): {
         // Note: The type seems to only be used for validation.
         auto entry = configuration.stack().pop();
-        auto value = entry.get<Value>().to<i32>();
+        auto value = entry.to<i32>();
         dbgln_if(WASM_TRACE_DEBUG, "select({})", value.value());
         auto rhs_entry = configuration.stack().pop();
         auto& lhs_entry = configuration.stack().peek();
-        auto rhs = move(rhs_entry.get<Value>());
-        auto lhs = move(lhs_entry.get<Value>());
+        auto rhs = move(rhs_entry);
+        auto lhs = move(lhs_entry);
         configuration.stack().peek() = value.value() != 0 ? move(lhs) : move(rhs);
         return;
     }
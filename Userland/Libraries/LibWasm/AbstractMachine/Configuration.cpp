@@ -11,30 +11,19 @@
 
 namespace Wasm {
 
-Optional<size_t> Configuration::nth_label_index(size_t i)
-{
-    for (size_t index = m_stack.size(); index > 0; --index) {
-        auto& entry = m_stack.entries()[index - 1];
-        if (entry.has<Label>()) {
-            if (i == 0)
-                return index - 1;
-            --i;
-        }
-    }
-    return {};
-}
-
 void Configuration::unwind(Badge<CallFrameHandle>, CallFrameHandle const& frame_handle)
 {
-    if (m_stack.size() == frame_handle.stack_size && frame_handle.frame_index == m_current_frame_index)
+    if (m_stack.size() == frame_handle.stack_size && m_label_stack.size() == frame_handle.label_count && m_frame_stack.size() == frame_handle.frame_count)
         return;
 
-    VERIFY(m_stack.size() > frame_handle.stack_size);
-    m_stack.entries().remove(frame_handle.stack_size, m_stack.size() - frame_handle.stack_size);
-    m_current_frame_index = frame_handle.frame_index;
+    VERIFY(m_stack.size() >= frame_handle.stack_size);
+    VERIFY(m_label_stack.size() >= frame_handle.label_count);
+    VERIFY(m_frame_stack.size() >= frame_handle.frame_count);
+    m_stack.entries().shrink(frame_handle.stack_size, true);
+    m_label_stack.shrink(frame_handle.label_count, true);
+    m_frame_stack.shrink(frame_handle.frame_count, true);
     m_depth--;
     m_ip = frame_handle.ip;
-    VERIFY(m_stack.size() == frame_handle.stack_size);
 }
 
 Result Configuration::call(Interpreter& interpreter, FunctionAddress address, Vector<Value> arguments)
@@ -53,6 +42,7 @@ Result Configuration::call(Interpreter& interpreter, FunctionAddress address, Ve
             move(locals),
             wasm_function->code().body(),
             wasm_function->type().results().size(),
+            wasm_function->code().block_infos(),
         });
         m_ip = 0;
         return execute(interpreter);
@@ -69,17 +59,19 @@ Result Configuration::execute(Interpreter& interpreter)
     if (interpreter.did_trap())
         return Trap { interpreter.trap_reason() };
 
-    if (stack().size() <= frame().arity() + 1)
+    // ASSERT: The only label left is the one for the current frame
+    if (m_label_stack.size() != frame().label_index() + 1)
+        return Trap { "Invalid stack configuration" };
+
+    auto label = m_label_stack.take_last();
+    if (stack().size() < label.stack_height() + frame().arity())
         return Trap { "Not enough values to return from call" };
 
     Vector<Value> results;
     results.ensure_capacity(frame().arity());
     for (size_t i = 0; i < frame().arity(); ++i)
-        results.append(move(stack().pop().get<Value>()));
-    auto label = stack().pop();
-    // ASSERT: label == current frame
-    if (!label.has<Label>())
-        return Trap { "Invalid stack configuration" };
+        results.append(stack().pop());
+    stack().entries().shrink(label.stack_height(), true);
     return Result { move(results) };
 }
 
@@ -92,21 +84,15 @@ void Configuration::dump_stack()
         memory_stream.read_entire_buffer(buffer).release_value_but_fixme_should_propagate_errors();
         dbgln(format.view(), StringView(buffer).trim_whitespace());
     };
-    for (auto const& entry : stack().entries()) {
-        entry.visit(
-            [&](Value const& v) {
-                print_value("    {}", v);
-            },
-            [&](Frame const& f) {
-                dbgln("    frame({})", f.arity());
-                for (auto& local : f.locals()) {
-                    print_value("        {}", local);
-                }
-            },
-            [](Label const& l) {
-                dbgln("    label({}) -> {}", l.arity(), l.continuation());
-            });
+    for (auto const& frame : m_frame_stack) {
+        dbgln("    frame({})", frame.arity());
+        for (auto& local : frame.locals())
+            print_value("        {}", local);
     }
+    for (auto const& label : m_label_stack)
+        dbgln("    label({}) -> {} @ {}", label.arity(), label.continuation(), label.stack_height());
+    for (auto const& value : stack().entries())
+        print_value("    {}", value);
 }
 
 }
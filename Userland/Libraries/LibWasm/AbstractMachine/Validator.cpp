@@ -8,8 +8,10 @@
 #include <AK/Result.h>
 #include <AK/SourceLocation.h>
 #include <AK/Try.h>
+#include <LibThreading/Thread.h>
 #include <LibWasm/AbstractMachine/Validator.h>
 #include <LibWasm/Printer/Printer.h>
+#include <unistd.h>
 
 namespace Wasm {
 
@@ -148,6 +150,14 @@ ErrorOr<void, ValidationError> Validator::validate(Module& module)
         return Errors::out_of_bounds("memory section count"sv, m_context.memories.size(), 1, 1);
     }
 
+    auto& functions = module.functions();
+    if (functions.size() != m_function_block_infos.size()) {
+        module.set_validation_status(Module::ValidationStatus::Invalid, {});
+        return Errors::invalid("function count"sv);
+    }
+    for (size_t i = 0; i < functions.size(); ++i)
+        functions[i].set_block_infos(move(m_function_block_infos[i]), {});
+
     module.set_validation_status(Module::ValidationStatus::Valid, {});
     return {};
 }
@@ -248,28 +258,83 @@ ErrorOr<void, ValidationError> Validator::validate(TableSection const& section)
 
 ErrorOr<void, ValidationError> Validator::validate(CodeSection const& section)
 {
-    size_t index = m_context.imported_function_count;
-    for (auto& entry : section.functions()) {
-        auto function_index = index++;
-        TRY(validate(FunctionIndex { function_index }));
-        auto& function_type = m_context.functions[function_index];
-        auto& function = entry.func();
+    auto& functions = section.functions();
+    size_t code_size = 0;
+    for (size_t i = 0; i < functions.size(); ++i) {
+        TRY(validate(FunctionIndex { m_context.imported_function_count + i }));
+        code_size += functions[i].size();
+    }
+
+    auto first_block_info_index = m_function_block_infos.size();
+    m_function_block_infos.resize(first_block_info_index + functions.size());
+
+    // Function bodies don't depend on each other, so large code sections are split up between a few threads.
+    auto processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t thread_count = processor_count > 1 ? static_cast<size_t>(processor_count) : 1;
+    thread_count = min(thread_count, Constants::max_validation_threads);
+    thread_count = min(thread_count, max(code_size / Constants::minimum_code_size_per_validation_thread, 1));
 
+    Atomic<size_t> next_function_index { 0 };
+    Atomic<bool> did_fail { false };
+    Vector<Optional<ValidationError>> errors;
+    errors.resize(functions.size());
+
+    auto validate_functions = [&] {
+        // Note: Each thread gets a copy of the context, as it's modified while validating a function.
         auto function_validator = fork();
-        function_validator.m_context.locals = {};
-        function_validator.m_context.locals.extend(function_type.parameters());
-        for (auto& local : function.locals()) {
-            for (size_t i = 0; i < local.n(); ++i)
-                function_validator.m_context.locals.append(local.type());
+        while (!did_fail) {
+            auto index = next_function_index++;
+            if (index >= functions.size())
+                break;
+            auto result = function_validator.validate_function(m_context.imported_function_count + index, functions[index].func());
+            if (result.is_error()) {
+                errors[index] = result.release_error();
+                did_fail = true;
+                break;
+            }
+            m_function_block_infos[first_block_info_index + index] = result.release_value();
         }
+    };
 
-        function_validator.m_context.labels = { ResultType { function_type.results() } };
-        function_validator.m_context.return_ = ResultType { function_type.results() };
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t i = 1; i < thread_count; ++i) {
+        auto thread = Threading::Thread::construct([&] {
+            validate_functions();
+            return 0;
+        },
+            "Wasm validator"sv);
+        thread->start();
+        threads.append(move(thread));
+    }
+    validate_functions();
+    for (auto& thread : threads)
+        (void)thread->join();
+
+    // Note: Functions are handed out in order, so every function before the first invalid one has been validated.
+    for (auto& error : errors) {
+        if (error.has_value())
+            return error.release_value();
+    }
+    return {};
+}
 
-        TRY(function_validator.validate(function.body(), function_type.results()));
+ErrorOr<Vector<Module::Function::BlockInfo>, ValidationError> Validator::validate_function(size_t function_index, CodeSection::Func const& function)
+{
+    auto& function_type = m_context.functions[function_index];
+
+    m_context.locals.clear_with_capacity();
+    m_context.locals.extend(function_type.parameters());
+    for (auto& local : function.locals()) {
+        for (size_t i = 0; i < local.n(); ++i)
+            m_context.locals.append(local.type());
     }
 
-    return {};
+    m_context.labels = { ResultType { function_type.results() } };
+    m_context.return_ = ResultType { function_type.results() };
+    m_block_infos.clear_with_capacity();
+
+    TRY(validate(function.body(), function_type.results()));
+    return move(m_block_infos);
 }
 
 ErrorOr<void, ValidationError> Validator::validate(TableType const& type)
@@ -1937,7 +2002,8 @@ VALIDATE_INSTRUCTION(structured_end)
         return Errors::invalid("usage of structured end"sv);
 
     auto last_scope = m_entered_scopes.take_last();
-    m_context = m_parent_contexts.take_last();
+    // Note: Nothing but the labels changes inside a block, so there's no need to save and restore the whole context.
+    m_context.labels.take_first();
     auto last_block_type = m_entered_blocks.take_last();
 
     switch (last_scope) {
@@ -1995,7 +2061,6 @@ VALIDATE_INSTRUCTION(block)
 
     m_entered_scopes.append(ChildScopeKind::Block);
     m_block_details.empend(stack.actual_size(), Empty {});
-    m_parent_contexts.append(m_context);
     m_entered_blocks.append(block_type);
     m_context.labels.prepend(ResultType { block_type.results() });
     return {};
@@ -2015,7 +2080,6 @@ VALIDATE_INSTRUCTION(loop)
 
     m_entered_scopes.append(ChildScopeKind::Block);
     m_block_details.empend(stack.actual_size(), Empty {});
-    m_parent_contexts.append(m_context);
     m_entered_blocks.append(block_type);
     m_context.labels.prepend(ResultType { block_type.parameters() });
     return {};
@@ -2039,7 +2103,6 @@ VALIDATE_INSTRUCTION(if_)
 
     m_entered_scopes.append(args.else_ip.has_value() ? ChildScopeKind::IfWithElse : ChildScopeKind::IfWithoutElse);
     m_block_details.empend(stack.actual_size(), BlockDetails::IfDetails { move(stack_snapshot) });
-    m_parent_contexts.append(m_context);
     m_entered_blocks.append(block_type);
     m_context.labels.prepend(ResultType { block_type.results() });
     return {};
@@ -2188,11 +2251,35 @@ ErrorOr<Validator::ExpressionTypeResult, ValidationError> Validator::validate(Ex
     Stack stack;
     bool is_constant_expression = true;
 
-    for (auto& instruction : expression.instructions()) {
+    auto& instructions = expression.instructions();
+    for (size_t ip = 0; ip < instructions.size(); ++ip) {
+        auto& instruction = instructions[ip];
         bool is_constant = false;
         TRY(validate(instruction, stack, is_constant));
 
         is_constant_expression &= is_constant;
+
+        auto opcode = instruction.opcode();
+        if (opcode == Instructions::block || opcode == Instructions::loop || opcode == Instructions::if_) {
+            // Note: The block type was just validated and entered, so this can't fail.
+            auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
+            auto& block_type = m_entered_blocks.last();
+            if (m_block_infos.is_empty())
+                m_block_infos.resize(instructions.size());
+
+            auto& info = m_block_infos[ip];
+            info.parameter_count = block_type.parameters().size();
+            if (opcode == Instructions::loop) {
+                // Branching to a loop starts it over, with its parameters on the stack.
+                info.arity = info.parameter_count;
+                info.continuation = ip + 1;
+            } else {
+                // Branching to a block or if leaves it through its end, which pops the label.
+                // Note: With an else, end_ip points past the end.
+                info.arity = block_type.results().size();
+                info.continuation = args.else_ip.has_value() ? args.end_ip.value() - 1 : args.end_ip.value();
+            }
+        }
     }
 
     auto expected_result_types = result_types;
@@ -237,6 +237,7 @@ public:
     };
     ErrorOr<ExpressionTypeResult, ValidationError> validate(Expression const&, Vector<ValueType> const&);
     ErrorOr<void, ValidationError> validate(Instruction const& instruction, Stack& stack, bool& is_constant);
+    ErrorOr<Vector<Module::Function::BlockInfo>, ValidationError> validate_function(size_t function_index, CodeSection::Func const&);
     template<u32 opcode>
     ErrorOr<void, ValidationError> validate_instruction(Instruction const&, Stack& stack, bool& is_constant);
 
@@ -329,10 +330,11 @@ private:
     };
 
     Context m_context;
-    Vector<Context> m_parent_contexts;
     Vector<ChildScopeKind> m_entered_scopes;
     Vector<BlockDetails> m_block_details;
     Vector<FunctionType> m_entered_blocks;
+    Vector<Module::Function::BlockInfo> m_block_infos;
+    Vector<Vector<Module::Function::BlockInfo>> m_function_block_infos;
 };
 
 }
@@ -42,5 +42,7 @@ static constexpr auto minimum_stack_space_to_keep_free = 256 * KiB; // Note: Val
 static constexpr auto max_allowed_executed_instructions_per_call = 256 * 1024 * 1024;
 static constexpr auto max_allowed_vector_size = 500 * MiB;
 static constexpr auto max_allowed_function_locals_per_type = 42069; // Note: VERY arbitrary.
+static constexpr size_t max_validation_threads = 8;
+static constexpr size_t minimum_code_size_per_validation_thread = 256 * KiB;
 
 }
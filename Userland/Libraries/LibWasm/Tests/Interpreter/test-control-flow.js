@@ -0,0 +1,65 @@
+// Exports (all with the type (i32) -> i32):
+// - fib: Recursive calls from both arms of an if-else.
+// - sum: A loop that gets left with br_if, and continued with br.
+// - table: Three nested blocks entered through br_table, with a return from each.
+// - ifElseBranch: A loop that branches out of an if-else on every other iteration.
+// - earlyReturn: A return from inside nested blocks, with values of outer blocks left on the stack.
+// - blockResult: A br_if out of a block with a result, with more values on the stack than it returns.
+// prettier-ignore
+const controlFlowModule = new Uint8Array([
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x09, 0x02, 0x60, 0x01, 0x7f, 0x01, 0x7f,
+    0x60, 0x00, 0x00, 0x03, 0x07, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x40, 0x06, 0x03,
+    0x66, 0x69, 0x62, 0x00, 0x00, 0x03, 0x73, 0x75, 0x6d, 0x00, 0x01, 0x05, 0x74, 0x61, 0x62, 0x6c,
+    0x65, 0x00, 0x02, 0x0c, 0x69, 0x66, 0x45, 0x6c, 0x73, 0x65, 0x42, 0x72, 0x61, 0x6e, 0x63, 0x68,
+    0x00, 0x03, 0x0b, 0x65, 0x61, 0x72, 0x6c, 0x79, 0x52, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x00, 0x04,
+    0x0b, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x52, 0x65, 0x73, 0x75, 0x6c, 0x74, 0x00, 0x05, 0x0a, 0xb9,
+    0x01, 0x06, 0x1c, 0x00, 0x20, 0x00, 0x41, 0x02, 0x48, 0x04, 0x7f, 0x20, 0x00, 0x05, 0x20, 0x00,
+    0x41, 0x01, 0x6b, 0x10, 0x00, 0x20, 0x00, 0x41, 0x02, 0x6b, 0x10, 0x00, 0x6a, 0x0b, 0x0b, 0x21,
+    0x01, 0x01, 0x7f, 0x02, 0x40, 0x03, 0x40, 0x20, 0x00, 0x45, 0x0d, 0x01, 0x20, 0x01, 0x20, 0x00,
+    0x6a, 0x21, 0x01, 0x20, 0x00, 0x41, 0x01, 0x6b, 0x21, 0x00, 0x0c, 0x00, 0x0b, 0x0b, 0x20, 0x01,
+    0x0b, 0x1a, 0x00, 0x02, 0x40, 0x02, 0x40, 0x02, 0x40, 0x20, 0x00, 0x0e, 0x02, 0x00, 0x01, 0x02,
+    0x0b, 0x41, 0x0a, 0x0f, 0x0b, 0x41, 0x14, 0x0f, 0x0b, 0x41, 0x1e, 0x0b, 0x2d, 0x01, 0x01, 0x7f,
+    0x02, 0x40, 0x03, 0x40, 0x20, 0x00, 0x45, 0x0d, 0x01, 0x20, 0x00, 0x41, 0x01, 0x6b, 0x21, 0x00,
+    0x20, 0x00, 0x41, 0x01, 0x71, 0x04, 0x40, 0x0c, 0x00, 0x05, 0x20, 0x01, 0x41, 0x01, 0x6a, 0x21,
+    0x01, 0x0b, 0x01, 0x0c, 0x00, 0x0b, 0x0b, 0x20, 0x01, 0x0b, 0x1d, 0x00, 0x41, 0xe4, 0x00, 0x02,
+    0x40, 0x41, 0xc8, 0x01, 0x02, 0x40, 0x20, 0x00, 0x04, 0x40, 0x41, 0xac, 0x02, 0x41, 0x07, 0x0f,
+    0x0b, 0x0b, 0x1a, 0x0b, 0x1a, 0x41, 0x09, 0x0b, 0x11, 0x00, 0x02, 0x7f, 0x41, 0x01, 0x41, 0x02,
+    0x20, 0x00, 0x0d, 0x00, 0x1a, 0x1a, 0x41, 0x03, 0x0b, 0x0b,
+]);
+
+describe("control flow", () => {
+    const module = parseWebAssemblyModule(controlFlowModule);
+    const call = (name, ...args) => module.invoke(module.getExport(name), ...args);
+
+    test("calls", () => {
+        expect(call("fib", 0)).toBe(0);
+        expect(call("fib", 1)).toBe(1);
+        expect(call("fib", 15)).toBe(610);
+    });
+
+    test("loops", () => {
+        expect(call("sum", 0)).toBe(0);
+        expect(call("sum", 100)).toBe(5050);
+    });
+
+    test("br_table", () => {
+        expect(call("table", 0)).toBe(10);
+        expect(call("table", 1)).toBe(20);
+        expect(call("table", 2)).toBe(30);
+        expect(call("table", 1000)).toBe(30);
+        expect(call("table", -1)).toBe(30);
+    });
+
+    test("branching out of an if-else", () => {
+        expect(call("ifElseBranch", 0)).toBe(0);
+        expect(call("ifElseBranch", 10)).toBe(5);
+        expect(call("ifElseBranch", 1001)).toBe(501);
+    });
+
+    test("values left on the stack by branches", () => {
+        expect(call("earlyReturn", 1)).toBe(7);
+        expect(call("earlyReturn", 0)).toBe(9);
+        expect(call("blockResult", 1)).toBe(2);
+        expect(call("blockResult", 0)).toBe(3);
+    });
+});
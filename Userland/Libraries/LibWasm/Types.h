@@ -979,6 +979,8 @@ private:
 };
 
 class Module {
+    AK_MAKE_NONCOPYABLE(Module);
+
 public:
     enum class ValidationStatus {
         Unchecked,
@@ -988,10 +990,19 @@ public:
 
     class Function {
     public:
-        explicit Function(TypeIndex type, Vector<ValueType> local_types, Expression body)
+        // What a block, loop or if needs to set up its label, precomputed by the validator so that the interpreter
+        // doesn't have to look at the block type or work out where the structure ends.
+        struct BlockInfo {
+            u32 arity { 0 };
+            u32 parameter_count { 0 };
+            u32 continuation { 0 };
+        };
+
+        // NOTE: The body is owned by the module's code section, which outlives this.
+        explicit Function(TypeIndex type, Vector<ValueType> local_types, Expression const& body)
             : m_type(type)
             , m_local_types(move(local_types))
-            , m_body(move(body))
+            , m_body(body)
         {
         }
 
@@ -999,10 +1010,15 @@ public:
         auto& locals() const { return m_local_types; }
         auto& body() const { return m_body; }
 
+        // Indexed by instruction pointer, only the entries of block, loop and if instructions are meaningful.
+        auto& block_infos() const { return m_block_infos; }
+        void set_block_infos(Vector<BlockInfo> block_infos, Badge<Validator>) { m_block_infos = move(block_infos); }
+
     private:
         TypeIndex m_type;
         Vector<ValueType> m_local_types;
-        Expression m_body;
+        Expression const& m_body;
+        Vector<BlockInfo> m_block_infos;
     };
 
     using AnySection = Variant<
@@ -1032,8 +1048,12 @@ public:
         }
     }
 
+    Module(Module&&) = default;
+    Module& operator=(Module&&) = default;
+
     auto& sections() const { return m_sections; }
     auto& functions() const { return m_functions; }
+    auto& functions() { return m_functions; }
     auto& type(TypeIndex index) const
     {
         FunctionType const* type = nullptr;
@@ -163,7 +163,13 @@ JS::ThrowCompletionOr<Optional<JS::PropertyDescriptor>> LegacyPlatformObject::in
     return TRY(legacy_platform_object_get_own_property_for_get_own_property_slot(property_name));
 }
 
-JS::ThrowCompletionOr<bool> LegacyPlatformObject::internal_set(JS::PropertyKey const& property_name, JS::Value value, JS::Value receiver)
+JS::ThrowCompletionOr<JS::Value> LegacyPlatformObject::internal_get(JS::PropertyKey const& property_name, JS::Value receiver, JS::CacheablePropertyMetadata*) const
+{
+    // NOTE: Named properties can come and go without our shape changing, so lookups through us must never be cached.
+    return Base::internal_get(property_name, receiver);
+}
+
+JS::ThrowCompletionOr<bool> LegacyPlatformObject::internal_set(JS::PropertyKey const& property_name, JS::Value value, JS::Value receiver, JS::CacheablePropertyMetadata*)
 {
     [[maybe_unused]] auto& global_object = this->global_object();
 
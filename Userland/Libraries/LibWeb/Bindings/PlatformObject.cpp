@@ -23,6 +23,13 @@ PlatformObject::PlatformObject(JS::Object& prototype)
 
 PlatformObject::~PlatformObject() = default;
 
+void PlatformObject::finalize()
+{
+    Base::finalize();
+    // NOTE: The GC only destroys this object once its memory gets swept, weak pointers have to let go of it right away.
+    revoke_weak_ptrs();
+}
+
 JS::Realm& PlatformObject::realm() const
 {
     return shape().realm();
@@ -43,6 +43,8 @@ public:
 protected:
     explicit PlatformObject(JS::Realm&);
     explicit PlatformObject(JS::Object& prototype);
+
+    virtual void finalize() override;
 };
 
 }
@@ -31,6 +31,8 @@ public:
         return m_filter_value_list->filter_value_list().span();
     }
 
+    bool operator==(BackdropFilter const&) const = default;
+
 private:
     RefPtr<FilterValueListStyleValue const> m_filter_value_list { nullptr };
 };
@@ -38,6 +38,12 @@ JS::ThrowCompletionOr<void> CSSStyleSheet::initialize(JS::Realm& realm)
     return {};
 }
 
+void CSSStyleSheet::finalize()
+{
+    Base::finalize();
+    Weakable<CSSStyleSheet>::revoke_weak_ptrs();
+}
+
 void CSSStyleSheet::visit_edges(Cell::Visitor& visitor)
 {
     Base::visit_edges(visitor);
@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <AK/NonnullRefPtr.h>
 #include <AK/Optional.h>
+#include <AK/RefCounted.h>
 #include <LibWeb/CSS/BackdropFilter.h>
 #include <LibWeb/CSS/Clip.h>
 #include <LibWeb/CSS/LengthBox.h>
@@ -90,6 +92,8 @@ struct BackgroundLayerData {
     CSS::LengthPercentage size_y { CSS::Length::make_auto() };
     CSS::Repeat repeat_x { CSS::Repeat::Repeat };
     CSS::Repeat repeat_y { CSS::Repeat::Repeat };
+
+    bool operator==(BackgroundLayerData const&) const = default;
 };
 
 struct BorderData {
@@ -97,6 +101,8 @@ public:
     Color color { Color::Transparent };
     CSS::LineStyle line_style { CSS::LineStyle::None };
     float width { 0 };
+
+    bool operator==(BorderData const&) const = default;
 };
 
 using TransformValue = Variant<CSS::Angle, CSS::LengthPercentage, float>;
@@ -109,11 +115,15 @@ struct Transformation {
 struct TransformOrigin {
     CSS::LengthPercentage x { Percentage(50) };
     CSS::LengthPercentage y { Percentage(50) };
+
+    bool operator==(TransformOrigin const&) const = default;
 };
 
 struct FlexBasisData {
     CSS::FlexBasis type { CSS::FlexBasis::Auto };
     Optional<CSS::LengthPercentage> length_percentage;
+
+    bool operator==(FlexBasisData const&) const = default;
 };
 
 struct ShadowData {
@@ -123,6 +133,8 @@ struct ShadowData {
     CSS::Length blur_radius { Length::make_px(0) };
     CSS::Length spread_distance { Length::make_px(0) };
     CSS::ShadowPlacement placement { CSS::ShadowPlacement::Outer };
+
+    bool operator==(ShadowData const&) const = default;
 };
 
 struct ContentData {
@@ -135,101 +147,162 @@ struct ContentData {
     // FIXME: Data is a list of identifiers, strings and image values.
     DeprecatedString data {};
     DeprecatedString alt_text {};
+
+    bool operator==(ContentData const&) const = default;
 };
 
 struct BorderRadiusData {
     CSS::LengthPercentage horizontal_radius { InitialValues::border_radius() };
     CSS::LengthPercentage vertical_radius { InitialValues::border_radius() };
+
+    bool operator==(BorderRadiusData const&) const = default;
+};
+
+// A group of computed values that's shared between all the nodes it was copied to, until one of them changes it.
+// Every node starts out with the initial values, and setting a value to what it already is doesn't copy anything,
+// so most nodes end up only holding copies of the few groups that their style actually touches.
+template<typename T>
+class SharedValues {
+public:
+    SharedValues()
+        : m_data(initial_data())
+    {
+    }
+
+    T const* operator->() const { return &m_data->values; }
+    T const& operator*() const { return m_data->values; }
+
+    // Returns the values for writing, copying them first if they're shared.
+    T& mutate()
+    {
+        if (m_data->ref_count() > 1)
+            m_data = adopt_ref(*new Data(m_data->values));
+        return m_data->values;
+    }
+
+    template<typename V, typename U>
+    void set(V T::*member, U&& value)
+    {
+        if (m_data->values.*member == value)
+            return;
+        mutate().*member = forward<U>(value);
+    }
+
+    // Shares the other values instead of holding an identical copy.
+    void share_if_equal(SharedValues const& other)
+    {
+        if (m_data != other.m_data && m_data->values == other.m_data->values)
+            m_data = other.m_data;
+    }
+
+private:
+    struct Data : public RefCounted<Data> {
+        Data() = default;
+        explicit Data(T const& values)
+            : values(values)
+        {
+        }
+
+        T values;
+    };
+
+    static NonnullRefPtr<Data> const& initial_data()
+    {
+        static NonnullRefPtr<Data> const data = adopt_ref(*new Data);
+        return data;
+    }
+
+    NonnullRefPtr<Data> m_data;
 };
 
 class ComputedValues {
 public:
-    CSS::Float float_() const { return m_noninherited.float_; }
-    CSS::Clear clear() const { return m_noninherited.clear; }
-    CSS::Clip clip() const { return m_noninherited.clip; }
-    CSS::Cursor cursor() const { return m_inherited.cursor; }
-    CSS::ContentData content() const { return m_noninherited.content; }
-    CSS::PointerEvents pointer_events() const { return m_inherited.pointer_events; }
-    CSS::Display display() const { return m_noninherited.display; }
-    Optional<int> const& z_index() const { return m_noninherited.z_index; }
-    CSS::TextAlign text_align() const { return m_inherited.text_align; }
-    CSS::TextJustify text_justify() const { return m_inherited.text_justify; }
-    Vector<CSS::TextDecorationLine> const& text_decoration_line() const { return m_noninherited.text_decoration_line; }
-    CSS::LengthPercentage const& text_decoration_thickness() const { return m_noninherited.text_decoration_thickness; }
-    CSS::TextDecorationStyle text_decoration_style() const { return m_noninherited.text_decoration_style; }
-    Color text_decoration_color() const { return m_noninherited.text_decoration_color; }
-    CSS::TextTransform text_transform() const { return m_inherited.text_transform; }
-    Vector<ShadowData> const& text_shadow() const { return m_noninherited.text_shadow; }
-    CSS::Position position() const { return m_noninherited.position; }
-    CSS::WhiteSpace white_space() const { return m_inherited.white_space; }
-    CSS::FlexDirection flex_direction() const { return m_noninherited.flex_direction; }
-    CSS::FlexWrap flex_wrap() const { return m_noninherited.flex_wrap; }
-    FlexBasisData const& flex_basis() const { return m_noninherited.flex_basis; }
-    float flex_grow() const { return m_noninherited.flex_grow; }
-    float flex_shrink() const { return m_noninherited.flex_shrink; }
-    int order() const { return m_noninherited.order; }
-    CSS::AlignContent align_content() const { return m_noninherited.align_content; }
-    CSS::AlignItems align_items() const { return m_noninherited.align_items; }
-    CSS::AlignSelf align_self() const { return m_noninherited.align_self; }
-    CSS::Appearance appearance() const { return m_noninherited.appearance; }
-    float opacity() const { return m_noninherited.opacity; }
-    CSS::Visibility visibility() const { return m_inherited.visibility; }
-    CSS::ImageRendering image_rendering() const { return m_inherited.image_rendering; }
-    CSS::JustifyContent justify_content() const { return m_noninherited.justify_content; }
-    CSS::BackdropFilter const& backdrop_filter() const { return m_noninherited.backdrop_filter; }
-    Vector<ShadowData> const& box_shadow() const { return m_noninherited.box_shadow; }
-    CSS::BoxSizing box_sizing() const { return m_noninherited.box_sizing; }
-    CSS::Size const& width() const { return m_noninherited.width; }
-    CSS::Size const& min_width() const { return m_noninherited.min_width; }
-    CSS::Size const& max_width() const { return m_noninherited.max_width; }
-    CSS::Size const& height() const { return m_noninherited.height; }
-    CSS::Size const& min_height() const { return m_noninherited.min_height; }
-    CSS::Size const& max_height() const { return m_noninherited.max_height; }
-    Variant<CSS::VerticalAlign, CSS::LengthPercentage> const& vertical_align() const { return m_noninherited.vertical_align; }
-    CSS::GridTrackSizeList const& grid_template_columns() const { return m_noninherited.grid_template_columns; }
-    CSS::GridTrackSizeList const& grid_template_rows() const { return m_noninherited.grid_template_rows; }
-    CSS::GridTrackPlacement const& grid_column_end() const { return m_noninherited.grid_column_end; }
-    CSS::GridTrackPlacement const& grid_column_start() const { return m_noninherited.grid_column_start; }
-    CSS::GridTrackPlacement const& grid_row_end() const { return m_noninherited.grid_row_end; }
-    CSS::GridTrackPlacement const& grid_row_start() const { return m_noninherited.grid_row_start; }
-    CSS::Size const& column_gap() const { return m_noninherited.column_gap; }
-    CSS::Size const& row_gap() const { return m_noninherited.row_gap; }
-    CSS::BorderCollapse border_collapse() const { return m_noninherited.border_collapse; }
-    Vector<Vector<String>> const& grid_template_areas() const { return m_noninherited.grid_template_areas; }
-
-    CSS::LengthBox const& inset() const { return m_noninherited.inset; }
-    const CSS::LengthBox& margin() const { return m_noninherited.margin; }
-    const CSS::LengthBox& padding() const { return m_noninherited.padding; }
-
-    BorderData const& border_left() const { return m_noninherited.border_left; }
-    BorderData const& border_top() const { return m_noninherited.border_top; }
-    BorderData const& border_right() const { return m_noninherited.border_right; }
-    BorderData const& border_bottom() const { return m_noninherited.border_bottom; }
-
-    const CSS::BorderRadiusData& border_bottom_left_radius() const { return m_noninherited.border_bottom_left_radius; }
-    const CSS::BorderRadiusData& border_bottom_right_radius() const { return m_noninherited.border_bottom_right_radius; }
-    const CSS::BorderRadiusData& border_top_left_radius() const { return m_noninherited.border_top_left_radius; }
-    const CSS::BorderRadiusData& border_top_right_radius() const { return m_noninherited.border_top_right_radius; }
-
-    CSS::Overflow overflow_x() const { return m_noninherited.overflow_x; }
-    CSS::Overflow overflow_y() const { return m_noninherited.overflow_y; }
-
-    Color color() const { return m_inherited.color; }
-    Color background_color() const { return m_noninherited.background_color; }
-    Vector<BackgroundLayerData> const& background_layers() const { return m_noninherited.background_layers; }
-
-    CSS::ListStyleType list_style_type() const { return m_inherited.list_style_type; }
-
-    Optional<Color> const& fill() const { return m_inherited.fill; }
-    Optional<Color> const& stroke() const { return m_inherited.stroke; }
-    Optional<LengthPercentage> const& stroke_width() const { return m_inherited.stroke_width; }
-
-    Vector<CSS::Transformation> const& transformations() const { return m_noninherited.transformations; }
-    CSS::TransformOrigin const& transform_origin() const { return m_noninherited.transform_origin; }
-
-    float font_size() const { return m_inherited.font_size; }
-    int font_weight() const { return m_inherited.font_weight; }
-    CSS::FontVariant font_variant() const { return m_inherited.font_variant; }
+    CSS::Float float_() const { return m_box->float_; }
+    CSS::Clear clear() const { return m_box->clear; }
+    CSS::Clip clip() const { return m_box->clip; }
+    CSS::Cursor cursor() const { return m_inherited->cursor; }
+    CSS::ContentData content() const { return m_box->content; }
+    CSS::PointerEvents pointer_events() const { return m_inherited->pointer_events; }
+    CSS::Display display() const { return m_box->display; }
+    Optional<int> const& z_index() const { return m_box->z_index; }
+    CSS::TextAlign text_align() const { return m_inherited->text_align; }
+    CSS::TextJustify text_justify() const { return m_inherited->text_justify; }
+    Vector<CSS::TextDecorationLine> const& text_decoration_line() const { return m_effects->text_decoration_line; }
+    CSS::LengthPercentage const& text_decoration_thickness() const { return m_effects->text_decoration_thickness; }
+    CSS::TextDecorationStyle text_decoration_style() const { return m_effects->text_decoration_style; }
+    Color text_decoration_color() const { return m_effects->text_decoration_color; }
+    CSS::TextTransform text_transform() const { return m_inherited->text_transform; }
+    Vector<ShadowData> const& text_shadow() const { return m_effects->text_shadow; }
+    CSS::Position position() const { return m_box->position; }
+    CSS::WhiteSpace white_space() const { return m_inherited->white_space; }
+    CSS::FlexDirection flex_direction() const { return m_flex_and_grid->flex_direction; }
+    CSS::FlexWrap flex_wrap() const { return m_flex_and_grid->flex_wrap; }
+    FlexBasisData const& flex_basis() const { return m_flex_and_grid->flex_basis; }
+    float flex_grow() const { return m_flex_and_grid->flex_grow; }
+    float flex_shrink() const { return m_flex_and_grid->flex_shrink; }
+    int order() const { return m_flex_and_grid->order; }
+    CSS::AlignContent align_content() const { return m_flex_and_grid->align_content; }
+    CSS::AlignItems align_items() const { return m_flex_and_grid->align_items; }
+    CSS::AlignSelf align_self() const { return m_flex_and_grid->align_self; }
+    CSS::Appearance appearance() const { return m_box->appearance; }
+    float opacity() const { return m_effects->opacity; }
+    CSS::Visibility visibility() const { return m_inherited->visibility; }
+    CSS::ImageRendering image_rendering() const { return m_inherited->image_rendering; }
+    CSS::JustifyContent justify_content() const { return m_flex_and_grid->justify_content; }
+    CSS::BackdropFilter const& backdrop_filter() const { return m_effects->backdrop_filter; }
+    Vector<ShadowData> const& box_shadow() const { return m_effects->box_shadow; }
+    CSS::BoxSizing box_sizing() const { return m_box->box_sizing; }
+    CSS::Size const& width() const { return m_box->width; }
+    CSS::Size const& min_width() const { return m_box->min_width; }
+    CSS::Size const& max_width() const { return m_box->max_width; }
+    CSS::Size const& height() const { return m_box->height; }
+    CSS::Size const& min_height() const { return m_box->min_height; }
+    CSS::Size const& max_height() const { return m_box->max_height; }
+    Variant<CSS::VerticalAlign, CSS::LengthPercentage> const& vertical_align() const { return m_box->vertical_align; }
+    CSS::GridTrackSizeList const& grid_template_columns() const { return m_flex_and_grid->grid_template_columns; }
+    CSS::GridTrackSizeList const& grid_template_rows() const { return m_flex_and_grid->grid_template_rows; }
+    CSS::GridTrackPlacement const& grid_column_end() const { return m_flex_and_grid->grid_column_end; }
+    CSS::GridTrackPlacement const& grid_column_start() const { return m_flex_and_grid->grid_column_start; }
+    CSS::GridTrackPlacement const& grid_row_end() const { return m_flex_and_grid->grid_row_end; }
+    CSS::GridTrackPlacement const& grid_row_start() const { return m_flex_and_grid->grid_row_start; }
+    CSS::Size const& column_gap() const { return m_flex_and_grid->column_gap; }
+    CSS::Size const& row_gap() const { return m_flex_and_grid->row_gap; }
+    CSS::BorderCollapse border_collapse() const { return m_border->border_collapse; }
+    Vector<Vector<String>> const& grid_template_areas() const { return m_flex_and_grid->grid_template_areas; }
+
+    CSS::LengthBox const& inset() const { return m_box->inset; }
+    const CSS::LengthBox& margin() const { return m_box->margin; }
+    const CSS::LengthBox& padding() const { return m_box->padding; }
+
+    BorderData const& border_left() const { return m_border->border_left; }
+    BorderData const& border_top() const { return m_border->border_top; }
+    BorderData const& border_right() const { return m_border->border_right; }
+    BorderData const& border_bottom() const { return m_border->border_bottom; }
+
+    const CSS::BorderRadiusData& border_bottom_left_radius() const { return m_border->border_bottom_left_radius; }
+    const CSS::BorderRadiusData& border_bottom_right_radius() const { return m_border->border_bottom_right_radius; }
+    const CSS::BorderRadiusData& border_top_left_radius() const { return m_border->border_top_left_radius; }
+    const CSS::BorderRadiusData& border_top_right_radius() const { return m_border->border_top_right_radius; }
+
+    CSS::Overflow overflow_x() const { return m_box->overflow_x; }
+    CSS::Overflow overflow_y() const { return m_box->overflow_y; }
+
+    Color color() const { return m_inherited->color; }
+    Color background_color() const { return m_background->background_color; }
+    Vector<BackgroundLayerData> const& background_layers() const { return m_background->background_layers; }
+
+    CSS::ListStyleType list_style_type() const { return m_inherited->list_style_type; }
+
+    Optional<Color> const& fill() const { return m_inherited->fill; }
+    Optional<Color> const& stroke() const { return m_inherited->stroke; }
+    Optional<LengthPercentage> const& stroke_width() const { return m_inherited->stroke_width; }
+
+    Vector<CSS::Transformation> const& transformations() const { return m_effects->transformations; }
+    CSS::TransformOrigin const& transform_origin() const { return m_effects->transform_origin; }
+
+    float font_size() const { return m_inherited->font_size; }
+    int font_weight() const { return m_inherited->font_weight; }
+    CSS::FontVariant font_variant() const { return m_inherited->font_variant; }
 
     ComputedValues clone_inherited_values() const
     {
@@ -238,8 +311,11 @@ public:
         return clone;
     }
 
+    // NOTE: Most nodes inherit all of their inherited values unchanged, so they can share the parent's.
+    void share_inherited_values_with(ComputedValues const& parent) { m_inherited.share_if_equal(parent.m_inherited); }
+
 protected:
-    struct {
+    struct InheritedValues {
         float font_size { InitialValues::font_size() };
         int font_weight { InitialValues::font_weight() };
         CSS::FontVariant font_variant { InitialValues::font_variant() };
@@ -257,20 +333,16 @@ protected:
         Optional<Color> fill;
         Optional<Color> stroke;
         Optional<LengthPercentage> stroke_width;
-    } m_inherited;
 
-    struct {
+        bool operator==(InheritedValues const&) const = default;
+    };
+
+    struct BoxValues {
         CSS::Float float_ { InitialValues::float_() };
         CSS::Clear clear { InitialValues::clear() };
         CSS::Clip clip { InitialValues::clip() };
         CSS::Display display { InitialValues::display() };
         Optional<int> z_index;
-        // FIXME: Store this as flags in a u8.
-        Vector<CSS::TextDecorationLine> text_decoration_line { InitialValues::text_decoration_line() };
-        CSS::LengthPercentage text_decoration_thickness { InitialValues::text_decoration_thickness() };
-        CSS::TextDecorationStyle text_decoration_style { InitialValues::text_decoration_style() };
-        Color text_decoration_color { InitialValues::color() };
-        Vector<ShadowData> text_shadow {};
         CSS::Position position { InitialValues::position() };
         CSS::Size width { InitialValues::width() };
         CSS::Size min_width { InitialValues::min_width() };
@@ -281,7 +353,20 @@ protected:
         CSS::LengthBox inset { InitialValues::inset() };
         CSS::LengthBox margin { InitialValues::margin() };
         CSS::LengthBox padding { InitialValues::padding() };
-        CSS::BackdropFilter backdrop_filter { InitialValues::backdrop_filter() };
+        CSS::Appearance appearance { InitialValues::appearance() };
+        CSS::Overflow overflow_x { InitialValues::overflow() };
+        CSS::Overflow overflow_y { InitialValues::overflow() };
+        CSS::BoxSizing box_sizing { InitialValues::box_sizing() };
+        CSS::ContentData content;
+        Variant<CSS::VerticalAlign, CSS::LengthPercentage> vertical_align { InitialValues::vertical_align() };
+    };
+
+    struct BackgroundValues {
+        Color background_color { InitialValues::background_color() };
+        Vector<BackgroundLayerData> background_layers;
+    };
+
+    struct BorderValues {
         BorderData border_left;
         BorderData border_top;
         BorderData border_right;
@@ -290,8 +375,10 @@ protected:
         BorderRadiusData border_bottom_right_radius;
         BorderRadiusData border_top_left_radius;
         BorderRadiusData border_top_right_radius;
-        Color background_color { InitialValues::background_color() };
-        Vector<BackgroundLayerData> background_layers;
+        CSS::BorderCollapse border_collapse { InitialValues::border_collapse() };
+    };
+
+    struct FlexAndGridValues {
         CSS::FlexDirection flex_direction { InitialValues::flex_direction() };
         CSS::FlexWrap flex_wrap { InitialValues::flex_wrap() };
         CSS::FlexBasisData flex_basis {};
@@ -301,17 +388,7 @@ protected:
         CSS::AlignContent align_content { InitialValues::align_content() };
         CSS::AlignItems align_items { InitialValues::align_items() };
         CSS::AlignSelf align_self { InitialValues::align_self() };
-        CSS::Appearance appearance { InitialValues::appearance() };
         CSS::JustifyContent justify_content { InitialValues::justify_content() };
-        CSS::Overflow overflow_x { InitialValues::overflow() };
-        CSS::Overflow overflow_y { InitialValues::overflow() };
-        float opacity { InitialValues::opacity() };
-        Vector<ShadowData> box_shadow {};
-        Vector<CSS::Transformation> transformations {};
-        CSS::TransformOrigin transform_origin {};
-        CSS::BoxSizing box_sizing { InitialValues::box_sizing() };
-        CSS::ContentData content;
-        Variant<CSS::VerticalAlign, CSS::LengthPercentage> vertical_align { InitialValues::vertical_align() };
         CSS::GridTrackSizeList grid_template_columns;
         CSS::GridTrackSizeList grid_template_rows;
         CSS::GridTrackPlacement grid_column_end { InitialValues::grid_column_end() };
@@ -320,9 +397,29 @@ protected:
         CSS::GridTrackPlacement grid_row_start { InitialValues::grid_row_start() };
         CSS::Size column_gap { InitialValues::column_gap() };
         CSS::Size row_gap { InitialValues::row_gap() };
-        CSS::BorderCollapse border_collapse { InitialValues::border_collapse() };
         Vector<Vector<String>> grid_template_areas { InitialValues::grid_template_areas() };
-    } m_noninherited;
+    };
+
+    struct EffectValues {
+        // FIXME: Store this as flags in a u8.
+        Vector<CSS::TextDecorationLine> text_decoration_line { InitialValues::text_decoration_line() };
+        CSS::LengthPercentage text_decoration_thickness { InitialValues::text_decoration_thickness() };
+        CSS::TextDecorationStyle text_decoration_style { InitialValues::text_decoration_style() };
+        Color text_decoration_color { InitialValues::color() };
+        Vector<ShadowData> text_shadow {};
+        CSS::BackdropFilter backdrop_filter { InitialValues::backdrop_filter() };
+        float opacity { InitialValues::opacity() };
+        Vector<ShadowData> box_shadow {};
+        Vector<CSS::Transformation> transformations {};
+        CSS::TransformOrigin transform_origin {};
+    };
+
+    SharedValues<InheritedValues> m_inherited;
+    SharedValues<BoxValues> m_box;
+    SharedValues<BackgroundValues> m_background;
+    SharedValues<BorderValues> m_border;
+    SharedValues<FlexAndGridValues> m_flex_and_grid;
+    SharedValues<EffectValues> m_effects;
 };
 
 class ImmutableComputedValues final : public ComputedValues {
@@ -330,84 +427,94 @@ class ImmutableComputedValues final : public ComputedValues {
 
 class MutableComputedValues final : public ComputedValues {
 public:
-    void set_font_size(float font_size) { m_inherited.font_size = font_size; }
-    void set_font_weight(int font_weight) { m_inherited.font_weight = font_weight; }
-    void set_font_variant(CSS::FontVariant font_variant) { m_inherited.font_variant = font_variant; }
-    void set_color(Color color) { m_inherited.color = color; }
-    void set_clip(CSS::Clip const& clip) { m_noninherited.clip = clip; }
-    void set_content(ContentData const& content) { m_noninherited.content = content; }
-    void set_cursor(CSS::Cursor cursor) { m_inherited.cursor = cursor; }
-    void set_image_rendering(CSS::ImageRendering value) { m_inherited.image_rendering = value; }
-    void set_pointer_events(CSS::PointerEvents value) { m_inherited.pointer_events = value; }
-    void set_background_color(Color color) { m_noninherited.background_color = color; }
-    void set_background_layers(Vector<BackgroundLayerData>&& layers) { m_noninherited.background_layers = move(layers); }
-    void set_float(CSS::Float value) { m_noninherited.float_ = value; }
-    void set_clear(CSS::Clear value) { m_noninherited.clear = value; }
-    void set_z_index(Optional<int> value) { m_noninherited.z_index = value; }
-    void set_text_align(CSS::TextAlign text_align) { m_inherited.text_align = text_align; }
-    void set_text_justify(CSS::TextJustify text_justify) { m_inherited.text_justify = text_justify; }
-    void set_text_decoration_line(Vector<CSS::TextDecorationLine> value) { m_noninherited.text_decoration_line = move(value); }
-    void set_text_decoration_thickness(CSS::LengthPercentage value) { m_noninherited.text_decoration_thickness = move(value); }
-    void set_text_decoration_style(CSS::TextDecorationStyle value) { m_noninherited.text_decoration_style = value; }
-    void set_text_decoration_color(Color value) { m_noninherited.text_decoration_color = value; }
-    void set_text_transform(CSS::TextTransform value) { m_inherited.text_transform = value; }
-    void set_text_shadow(Vector<ShadowData>&& value) { m_noninherited.text_shadow = move(value); }
-    void set_position(CSS::Position position) { m_noninherited.position = position; }
-    void set_white_space(CSS::WhiteSpace value) { m_inherited.white_space = value; }
-    void set_width(CSS::Size const& width) { m_noninherited.width = width; }
-    void set_min_width(CSS::Size const& width) { m_noninherited.min_width = width; }
-    void set_max_width(CSS::Size const& width) { m_noninherited.max_width = width; }
-    void set_height(CSS::Size const& height) { m_noninherited.height = height; }
-    void set_min_height(CSS::Size const& height) { m_noninherited.min_height = height; }
-    void set_max_height(CSS::Size const& height) { m_noninherited.max_height = height; }
-    void set_inset(CSS::LengthBox const& inset) { m_noninherited.inset = inset; }
-    void set_margin(const CSS::LengthBox& margin) { m_noninherited.margin = margin; }
-    void set_padding(const CSS::LengthBox& padding) { m_noninherited.padding = padding; }
-    void set_overflow_x(CSS::Overflow value) { m_noninherited.overflow_x = value; }
-    void set_overflow_y(CSS::Overflow value) { m_noninherited.overflow_y = value; }
-    void set_list_style_type(CSS::ListStyleType value) { m_inherited.list_style_type = value; }
-    void set_display(CSS::Display value) { m_noninherited.display = value; }
-    void set_backdrop_filter(CSS::BackdropFilter backdrop_filter) { m_noninherited.backdrop_filter = move(backdrop_filter); }
-    void set_border_bottom_left_radius(CSS::BorderRadiusData value) { m_noninherited.border_bottom_left_radius = move(value); }
-    void set_border_bottom_right_radius(CSS::BorderRadiusData value) { m_noninherited.border_bottom_right_radius = move(value); }
-    void set_border_top_left_radius(CSS::BorderRadiusData value) { m_noninherited.border_top_left_radius = move(value); }
-    void set_border_top_right_radius(CSS::BorderRadiusData value) { m_noninherited.border_top_right_radius = move(value); }
-    BorderData& border_left() { return m_noninherited.border_left; }
-    BorderData& border_top() { return m_noninherited.border_top; }
-    BorderData& border_right() { return m_noninherited.border_right; }
-    BorderData& border_bottom() { return m_noninherited.border_bottom; }
-    void set_flex_direction(CSS::FlexDirection value) { m_noninherited.flex_direction = value; }
-    void set_flex_wrap(CSS::FlexWrap value) { m_noninherited.flex_wrap = value; }
-    void set_flex_basis(FlexBasisData value) { m_noninherited.flex_basis = move(value); }
-    void set_flex_grow(float value) { m_noninherited.flex_grow = value; }
-    void set_flex_shrink(float value) { m_noninherited.flex_shrink = value; }
-    void set_order(int value) { m_noninherited.order = value; }
-    void set_align_content(CSS::AlignContent value) { m_noninherited.align_content = value; }
-    void set_align_items(CSS::AlignItems value) { m_noninherited.align_items = value; }
-    void set_align_self(CSS::AlignSelf value) { m_noninherited.align_self = value; }
-    void set_appearance(CSS::Appearance value) { m_noninherited.appearance = value; }
-    void set_opacity(float value) { m_noninherited.opacity = value; }
-    void set_justify_content(CSS::JustifyContent value) { m_noninherited.justify_content = value; }
-    void set_box_shadow(Vector<ShadowData>&& value) { m_noninherited.box_shadow = move(value); }
-    void set_transformations(Vector<CSS::Transformation> value) { m_noninherited.transformations = move(value); }
-    void set_transform_origin(CSS::TransformOrigin value) { m_noninherited.transform_origin = value; }
-    void set_box_sizing(CSS::BoxSizing value) { m_noninherited.box_sizing = value; }
-    void set_vertical_align(Variant<CSS::VerticalAlign, CSS::LengthPercentage> value) { m_noninherited.vertical_align = move(value); }
-    void set_visibility(CSS::Visibility value) { m_inherited.visibility = value; }
-    void set_grid_template_columns(CSS::GridTrackSizeList value) { m_noninherited.grid_template_columns = move(value); }
-    void set_grid_template_rows(CSS::GridTrackSizeList value) { m_noninherited.grid_template_rows = move(value); }
-    void set_grid_column_end(CSS::GridTrackPlacement value) { m_noninherited.grid_column_end = value; }
-    void set_grid_column_start(CSS::GridTrackPlacement value) { m_noninherited.grid_column_start = value; }
-    void set_grid_row_end(CSS::GridTrackPlacement value) { m_noninherited.grid_row_end = value; }
-    void set_grid_row_start(CSS::GridTrackPlacement value) { m_noninherited.grid_row_start = value; }
-    void set_column_gap(CSS::Size const& column_gap) { m_noninherited.column_gap = column_gap; }
-    void set_row_gap(CSS::Size const& row_gap) { m_noninherited.row_gap = row_gap; }
-    void set_border_collapse(CSS::BorderCollapse const& border_collapse) { m_noninherited.border_collapse = border_collapse; }
-    void set_grid_template_areas(Vector<Vector<String>> const& grid_template_areas) { m_noninherited.grid_template_areas = grid_template_areas; }
-
-    void set_fill(Color value) { m_inherited.fill = value; }
-    void set_stroke(Color value) { m_inherited.stroke = value; }
-    void set_stroke_width(LengthPercentage value) { m_inherited.stroke_width = value; }
+    void set_font_size(float font_size) { m_inherited.set(&InheritedValues::font_size, font_size); }
+    void set_font_weight(int font_weight) { m_inherited.set(&InheritedValues::font_weight, font_weight); }
+    void set_font_variant(CSS::FontVariant font_variant) { m_inherited.set(&InheritedValues::font_variant, font_variant); }
+    void set_color(Color color) { m_inherited.set(&InheritedValues::color, color); }
+    void set_clip(CSS::Clip const& clip) { m_box.set(&BoxValues::clip, clip); }
+    void set_content(ContentData const& content) { m_box.set(&BoxValues::content, content); }
+    void set_cursor(CSS::Cursor cursor) { m_inherited.set(&InheritedValues::cursor, cursor); }
+    void set_image_rendering(CSS::ImageRendering value) { m_inherited.set(&InheritedValues::image_rendering, value); }
+    void set_pointer_events(CSS::PointerEvents value) { m_inherited.set(&InheritedValues::pointer_events, value); }
+    void set_background_color(Color color) { m_background.set(&BackgroundValues::background_color, color); }
+    void set_background_layers(Vector<BackgroundLayerData>&& layers) { m_background.set(&BackgroundValues::background_layers, move(layers)); }
+    void set_float(CSS::Float value) { m_box.set(&BoxValues::float_, value); }
+    void set_clear(CSS::Clear value) { m_box.set(&BoxValues::clear, value); }
+    void set_z_index(Optional<int> value) { m_box.set(&BoxValues::z_index, value); }
+    void set_text_align(CSS::TextAlign text_align) { m_inherited.set(&InheritedValues::text_align, text_align); }
+    void set_text_justify(CSS::TextJustify text_justify) { m_inherited.set(&InheritedValues::text_justify, text_justify); }
+    void set_text_decoration_line(Vector<CSS::TextDecorationLine> value) { m_effects.set(&EffectValues::text_decoration_line, move(value)); }
+    void set_text_decoration_thickness(CSS::LengthPercentage value) { m_effects.set(&EffectValues::text_decoration_thickness, move(value)); }
+    void set_text_decoration_style(CSS::TextDecorationStyle value) { m_effects.set(&EffectValues::text_decoration_style, value); }
+    void set_text_decoration_color(Color value) { m_effects.set(&EffectValues::text_decoration_color, value); }
+    void set_text_transform(CSS::TextTransform value) { m_inherited.set(&InheritedValues::text_transform, value); }
+    void set_text_shadow(Vector<ShadowData>&& value) { m_effects.set(&EffectValues::text_shadow, move(value)); }
+    void set_position(CSS::Position position) { m_box.set(&BoxValues::position, position); }
+    void set_white_space(CSS::WhiteSpace value) { m_inherited.set(&InheritedValues::white_space, value); }
+    void set_width(CSS::Size const& width) { m_box.set(&BoxValues::width, width); }
+    void set_min_width(CSS::Size const& width) { m_box.set(&BoxValues::min_width, width); }
+    void set_max_width(CSS::Size const& width) { m_box.set(&BoxValues::max_width, width); }
+    void set_height(CSS::Size const& height) { m_box.set(&BoxValues::height, height); }
+    void set_min_height(CSS::Size const& height) { m_box.set(&BoxValues::min_height, height); }
+    void set_max_height(CSS::Size const& height) { m_box.set(&BoxValues::max_height, height); }
+    void set_inset(CSS::LengthBox const& inset) { m_box.set(&BoxValues::inset, inset); }
+    void set_margin(const CSS::LengthBox& margin) { m_box.set(&BoxValues::margin, margin); }
+    void set_padding(const CSS::LengthBox& padding) { m_box.set(&BoxValues::padding, padding); }
+    void set_overflow_x(CSS::Overflow value) { m_box.set(&BoxValues::overflow_x, value); }
+    void set_overflow_y(CSS::Overflow value) { m_box.set(&BoxValues::overflow_y, value); }
+    void set_list_style_type(CSS::ListStyleType value) { m_inherited.set(&InheritedValues::list_style_type, value); }
+    void set_display(CSS::Display value) { m_box.set(&BoxValues::display, value); }
+    void set_backdrop_filter(CSS::BackdropFilter backdrop_filter) { m_effects.set(&EffectValues::backdrop_filter, move(backdrop_filter)); }
+    void set_border_bottom_left_radius(CSS::BorderRadiusData value) { m_border.set(&BorderValues::border_bottom_left_radius, move(value)); }
+    void set_border_bottom_right_radius(CSS::BorderRadiusData value) { m_border.set(&BorderValues::border_bottom_right_radius, move(value)); }
+    void set_border_top_left_radius(CSS::BorderRadiusData value) { m_border.set(&BorderValues::border_top_left_radius, move(value)); }
+    void set_border_top_right_radius(CSS::BorderRadiusData value) { m_border.set(&BorderValues::border_top_right_radius, move(value)); }
+    void set_border_left(BorderData value) { m_border.set(&BorderValues::border_left, move(value)); }
+    void set_border_top(BorderData value) { m_border.set(&BorderValues::border_top, move(value)); }
+    void set_border_right(BorderData value) { m_border.set(&BorderValues::border_right, move(value)); }
+    void set_border_bottom(BorderData value) { m_border.set(&BorderValues::border_bottom, move(value)); }
+    void set_flex_direction(CSS::FlexDirection value) { m_flex_and_grid.set(&FlexAndGridValues::flex_direction, value); }
+    void set_flex_wrap(CSS::FlexWrap value) { m_flex_and_grid.set(&FlexAndGridValues::flex_wrap, value); }
+    void set_flex_basis(FlexBasisData value) { m_flex_and_grid.set(&FlexAndGridValues::flex_basis, move(value)); }
+    void set_flex_grow(float value) { m_flex_and_grid.set(&FlexAndGridValues::flex_grow, value); }
+    void set_flex_shrink(float value) { m_flex_and_grid.set(&FlexAndGridValues::flex_shrink, value); }
+    void set_order(int value) { m_flex_and_grid.set(&FlexAndGridValues::order, value); }
+    void set_align_content(CSS::AlignContent value) { m_flex_and_grid.set(&FlexAndGridValues::align_content, value); }
+    void set_align_items(CSS::AlignItems value) { m_flex_and_grid.set(&FlexAndGridValues::align_items, value); }
+    void set_align_self(CSS::AlignSelf value) { m_flex_and_grid.set(&FlexAndGridValues::align_self, value); }
+    void set_appearance(CSS::Appearance value) { m_box.set(&BoxValues::appearance, value); }
+    void set_opacity(float value) { m_effects.set(&EffectValues::opacity, value); }
+    void set_justify_content(CSS::JustifyContent value) { m_flex_and_grid.set(&FlexAndGridValues::justify_content, value); }
+    void set_box_shadow(Vector<ShadowData>&& value) { m_effects.set(&EffectValues::box_shadow, move(value)); }
+    void set_transformations(Vector<CSS::Transformation> value)
+    {
+        if (value.is_empty() && m_effects->transformations.is_empty())
+            return;
+        m_effects.mutate().transformations = move(value);
+    }
+    void set_transform_origin(CSS::TransformOrigin value) { m_effects.set(&EffectValues::transform_origin, value); }
+    void set_box_sizing(CSS::BoxSizing value) { m_box.set(&BoxValues::box_sizing, value); }
+    void set_vertical_align(Variant<CSS::VerticalAlign, CSS::LengthPercentage> value)
+    {
+        if (value.has<CSS::VerticalAlign>() && m_box->vertical_align.has<CSS::VerticalAlign>() && value.get<CSS::VerticalAlign>() == m_box->vertical_align.get<CSS::VerticalAlign>())
+            return;
+        m_box.mutate().vertical_align = move(value);
+    }
+    void set_visibility(CSS::Visibility value) { m_inherited.set(&InheritedValues::visibility, value); }
+    void set_grid_template_columns(CSS::GridTrackSizeList value) { m_flex_and_grid.set(&FlexAndGridValues::grid_template_columns, move(value)); }
+    void set_grid_template_rows(CSS::GridTrackSizeList value) { m_flex_and_grid.set(&FlexAndGridValues::grid_template_rows, move(value)); }
+    void set_grid_column_end(CSS::GridTrackPlacement value) { m_flex_and_grid.set(&FlexAndGridValues::grid_column_end, value); }
+    void set_grid_column_start(CSS::GridTrackPlacement value) { m_flex_and_grid.set(&FlexAndGridValues::grid_column_start, value); }
+    void set_grid_row_end(CSS::GridTrackPlacement value) { m_flex_and_grid.set(&FlexAndGridValues::grid_row_end, value); }
+    void set_grid_row_start(CSS::GridTrackPlacement value) { m_flex_and_grid.set(&FlexAndGridValues::grid_row_start, value); }
+    void set_column_gap(CSS::Size const& column_gap) { m_flex_and_grid.set(&FlexAndGridValues::column_gap, column_gap); }
+    void set_row_gap(CSS::Size const& row_gap) { m_flex_and_grid.set(&FlexAndGridValues::row_gap, row_gap); }
+    void set_border_collapse(CSS::BorderCollapse const& border_collapse) { m_border.set(&BorderValues::border_collapse, border_collapse); }
+    void set_grid_template_areas(Vector<Vector<String>> const& grid_template_areas) { m_flex_and_grid.set(&FlexAndGridValues::grid_template_areas, grid_template_areas); }
+
+    void set_fill(Color value) { m_inherited.set(&InheritedValues::fill, value); }
+    void set_stroke(Color value) { m_inherited.set(&InheritedValues::stroke, value); }
+    void set_stroke_width(LengthPercentage value) { m_inherited.set(&InheritedValues::stroke_width, value); }
 };
 
 }
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/NumericLimits.h>
+#include <AK/Types.h>
+
+namespace Web::CSS {
+
+// A bloom filter that keys can be removed from again, by counting how many times each bucket was hit.
+// Every key sets two buckets, taken from the low and high bits of its hash.
+//
+// NOTE: A bucket that has been hit more often than its counter can count stays set forever, so the filter
+//       can only ever claim too much, never too little.
+template<typename CounterType, size_t key_bits>
+class CountingBloomFilter {
+public:
+    void clear() { m_buckets.fill(0); }
+
+    void increment(u32 key)
+    {
+        increment_bucket(first_bucket(key));
+        increment_bucket(second_bucket(key));
+    }
+
+    void decrement(u32 key)
+    {
+        decrement_bucket(first_bucket(key));
+        decrement_bucket(second_bucket(key));
+    }
+
+    bool may_contain(u32 key) const
+    {
+        return m_buckets[first_bucket(key)] != 0 && m_buckets[second_bucket(key)] != 0;
+    }
+
+private:
+    static constexpr size_t bucket_count = 1 << key_bits;
+    static constexpr u32 key_mask = bucket_count - 1;
+
+    static size_t first_bucket(u32 key) { return key & key_mask; }
+    static size_t second_bucket(u32 key) { return (key >> 16) & key_mask; }
+
+    void increment_bucket(size_t index)
+    {
+        if (m_buckets[index] != NumericLimits<CounterType>::max())
+            ++m_buckets[index];
+    }
+
+    void decrement_bucket(size_t index)
+    {
+        if (m_buckets[index] != NumericLimits<CounterType>::max())
+            --m_buckets[index];
+    }
+
+    Array<CounterType, bucket_count> m_buckets {};
+};
+
+}
@@ -5,9 +5,11 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BuiltinWrappers.h>
 #include <AK/CharacterTypes.h>
 #include <AK/Debug.h>
 #include <AK/FloatingPointStringConversions.h>
+#include <AK/SIMDExtras.h>
 #include <AK/SourceLocation.h>
 #include <AK/Vector.h>
 #include <LibTextCodec/Decoder.h>
@@ -175,6 +177,52 @@ static inline bool is_whitespace(u32 code_point)
     return code_point == 0x9 || code_point == 0xA || code_point == 0x20;
 }
 
+// Returns how many of the given bytes match before the first one that doesn't. The two predicates have to agree,
+// the vector one is used for as many whole 16-byte chunks as possible and the scalar one for the rest.
+template<typename VectorPredicate, typename BytePredicate>
+static size_t count_matching_bytes(ReadonlyBytes bytes, VectorPredicate matches_vector, BytePredicate matches_byte)
+{
+    using AK::SIMD::i8x16;
+    using AK::SIMD::u8x16;
+
+    size_t offset = 0;
+    for (; offset + sizeof(u8x16) <= bytes.size(); offset += sizeof(u8x16)) {
+        u8x16 chunk;
+        __builtin_memcpy(&chunk, bytes.offset(offset), sizeof(chunk));
+        if (auto bits = AK::SIMD::maskbits((i8x16)matches_vector(chunk)); bits != 0xFFFF)
+            return offset + count_trailing_zeroes(static_cast<u32>(~bits));
+    }
+    while (offset < bytes.size() && matches_byte(bytes[offset]))
+        ++offset;
+    return offset;
+}
+
+// Counts the bytes that make up ident code points, i.e. ASCII letters, digits, '_' and '-', and everything non-ASCII.
+// NOTE: The input has been decoded already, so every byte of a multi-byte sequence belongs to a valid non-ASCII code point.
+static size_t count_ident_code_point_bytes(ReadonlyBytes bytes)
+{
+    return count_matching_bytes(
+        bytes,
+        [](AK::SIMD::u8x16 chunk) {
+            return (chunk >= 0x80) | (((chunk | 0x20) - 'a') < 26) | ((chunk - '0') < 10) | (chunk == '_') | (chunk == '-');
+        },
+        [](u8 byte) {
+            return byte >= 0x80 || is_ascii_alphanumeric(byte) || byte == '_' || byte == '-';
+        });
+}
+
+static size_t count_whitespace_bytes(ReadonlyBytes bytes)
+{
+    return count_matching_bytes(
+        bytes,
+        [](AK::SIMD::u8x16 chunk) {
+            return (chunk == '\t') | (chunk == '\n') | (chunk == ' ');
+        },
+        [](u8 byte) {
+            return is_whitespace(byte);
+        });
+}
+
 static inline bool is_percent(u32 code_point)
 {
     return code_point == 0x25;
@@ -281,6 +329,35 @@ u32 Tokenizer::next_code_point()
     return code_point;
 }
 
+ReadonlyBytes Tokenizer::remaining_input_bytes() const
+{
+    return m_utf8_view.as_string().bytes().slice(m_utf8_view.byte_offset_of(m_utf8_iterator));
+}
+
+void Tokenizer::skip_bytes(size_t byte_count)
+{
+    VERIFY(byte_count > 0);
+    auto start = m_utf8_view.byte_offset_of(m_utf8_iterator);
+    auto bytes = m_utf8_view.as_string().bytes().slice(start, byte_count);
+
+    size_t last_code_point_start = 0;
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        if ((bytes[i] & 0xC0) == 0x80)
+            continue;
+        last_code_point_start = i;
+        m_prev_position = m_position;
+        if (is_newline(bytes[i])) {
+            m_position.line++;
+            m_position.column = 0;
+        } else {
+            m_position.column++;
+        }
+    }
+
+    m_prev_utf8_iterator = m_utf8_view.iterator_at_byte_offset_without_validation(start + last_code_point_start);
+    m_utf8_iterator = m_utf8_view.iterator_at_byte_offset_without_validation(start + byte_count);
+}
+
 u32 Tokenizer::peek_code_point(size_t offset) const
 {
     auto it = m_utf8_iterator;
@@ -592,6 +669,13 @@ DeprecatedString Tokenizer::consume_an_ident_sequence()
 
     // Repeatedly consume the next input code point from the stream:
     for (;;) {
+        // NOTE: Idents are mostly made up of name code points only, so runs of those are appended all at once.
+        auto remaining_bytes = remaining_input_bytes();
+        if (auto length = count_ident_code_point_bytes(remaining_bytes); length > 0) {
+            result.append(StringView { remaining_bytes.trim(length) });
+            skip_bytes(length);
+        }
+
         auto input = next_code_point();
 
         if (is_eof(input))
@@ -753,9 +837,8 @@ void Tokenizer::consume_the_remnants_of_a_bad_url()
 
 void Tokenizer::consume_as_much_whitespace_as_possible()
 {
-    while (is_whitespace(peek_code_point())) {
-        (void)next_code_point();
-    }
+    if (auto length = count_whitespace_bytes(remaining_input_bytes()); length > 0)
+        skip_bytes(length);
 }
 
 void Tokenizer::reconsume_current_input_code_point()
@@ -68,6 +68,9 @@ public:
 
 private:
     [[nodiscard]] u32 next_code_point();
+    [[nodiscard]] ReadonlyBytes remaining_input_bytes() const;
+    // Consumes the given number of bytes, which have to end on a code point boundary, as if one code point at a time.
+    void skip_bytes(size_t byte_count);
     [[nodiscard]] u32 peek_code_point(size_t offset = 0) const;
     [[nodiscard]] U32Twin peek_twin() const;
     [[nodiscard]] U32Triplet peek_triplet() const;
@@ -23,6 +23,51 @@ Selector::Selector(Vector<CompoundSelector>&& compound_selectors)
             }
         }
     }
+
+    collect_ancestor_hashes();
+}
+
+void Selector::collect_ancestor_hashes()
+{
+    size_t next_hash_index = 0;
+    auto append_unique_hash = [&](u32 hash) -> bool {
+        if (hash == 0)
+            return false;
+        for (size_t i = 0; i < next_hash_index; ++i) {
+            if (m_ancestor_hashes[i] == hash)
+                return false;
+        }
+        m_ancestor_hashes[next_hash_index++] = hash;
+        return next_hash_index == m_ancestor_hashes.size();
+    };
+
+    // A compound selector that is followed by a descendant or child combinator matches an ancestor of the element that
+    // the compound selector after it matches. That one is either the subject, an ancestor, or a sibling of either,
+    // and siblings share their ancestors, so it's always an ancestor of the subject.
+    for (size_t compound_index = 0; compound_index + 1 < m_compound_selectors.size(); ++compound_index) {
+        auto combinator = m_compound_selectors[compound_index + 1].combinator;
+        if (combinator != Combinator::Descendant && combinator != Combinator::ImmediateChild)
+            continue;
+
+        for (auto const& simple_selector : m_compound_selectors[compound_index].simple_selectors) {
+            bool is_full = false;
+            switch (simple_selector.type) {
+            case SimpleSelector::Type::Id:
+                is_full = append_unique_hash(ancestor_hash_for_id(simple_selector.name()));
+                break;
+            case SimpleSelector::Type::Class:
+                is_full = append_unique_hash(ancestor_hash_for_class(simple_selector.name()));
+                break;
+            case SimpleSelector::Type::TagName:
+                is_full = append_unique_hash(ancestor_hash_for_tag_name(simple_selector.lowercase_name()));
+                break;
+            default:
+                break;
+            }
+            if (is_full)
+                return;
+        }
+    }
 }
 
 // https://www.w3.org/TR/selectors-4/#specificity-rules
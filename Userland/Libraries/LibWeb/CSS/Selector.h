@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/DeprecatedFlyString.h>
 #include <AK/DeprecatedString.h>
 #include <AK/NonnullRefPtrVector.h>
@@ -202,12 +203,27 @@ public:
     u32 specificity() const;
     DeprecatedString serialize() const;
 
+    // Hashes of ids, classes and tag names that some ancestor of a matching element must have. Unused slots are 0.
+    // If any of them is missing from a bloom filter of the element's actual ancestors, the selector can't match.
+    auto const& ancestor_hashes() const { return m_ancestor_hashes; }
+
+    // NOTE: These take both DeprecatedString and DeprecatedFlyString, which hash the same.
+    template<typename StringType>
+    static u32 ancestor_hash_for_id(StringType const& id) { return id.hash() * 17; }
+    template<typename StringType>
+    static u32 ancestor_hash_for_class(StringType const& class_name) { return class_name.hash() * 19; }
+    template<typename StringType>
+    static u32 ancestor_hash_for_tag_name(StringType const& tag_name) { return tag_name.hash() * 13; }
+
 private:
     explicit Selector(Vector<CompoundSelector>&&);
 
+    void collect_ancestor_hashes();
+
     Vector<CompoundSelector> m_compound_selectors;
     mutable Optional<u32> m_specificity;
     Optional<Selector::PseudoElement> m_pseudo_element;
+    Array<u32, 8> m_ancestor_hashes {};
 };
 
 constexpr StringView pseudo_element_name(Selector::PseudoElement pseudo_element)
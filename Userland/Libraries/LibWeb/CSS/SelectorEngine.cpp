@@ -27,15 +27,10 @@ namespace Web::SelectorEngine {
 // https://drafts.csswg.org/selectors-4/#the-lang-pseudo
 static inline bool matches_lang_pseudo_class(DOM::Element const& element, Vector<DeprecatedFlyString> const& languages)
 {
-    DeprecatedFlyString element_language;
-    for (auto const* e = &element; e; e = e->parent_element()) {
-        auto lang = e->attribute(HTML::AttributeNames::lang);
-        if (!lang.is_null()) {
-            element_language = lang;
-            break;
-        }
-    }
-    if (element_language.is_null())
+    Optional<StringView> element_language;
+    for (auto const* e = &element; e && !element_language.has_value(); e = e->parent_element())
+        element_language = e->attribute_view(HTML::AttributeNames::lang);
+    if (!element_language.has_value())
         return false;
 
     // FIXME: This is ad-hoc. Implement a proper language range matching algorithm as recommended by BCP47.
@@ -44,9 +39,9 @@ static inline bool matches_lang_pseudo_class(DOM::Element const& element, Vector
             return false;
         if (language == "*"sv)
             return true;
-        if (!element_language.view().contains('-'))
-            return element_language.equals_ignoring_case(language);
-        auto parts = element_language.view().split_view('-');
+        if (!element_language->contains('-'))
+            return element_language->equals_ignoring_case(language);
+        auto parts = element_language->split_view('-');
         return parts[0].equals_ignoring_case(language);
     }
     return false;
@@ -100,6 +95,8 @@ static inline bool matches_attribute(CSS::Selector::SimpleSelector::Attribute co
         return element.has_attribute(attribute.name);
     }
 
+    // NOTE: Selectors may be matched from several threads at once, so the value isn't copied.
+    auto const element_attr_value = element.attribute_view(attribute.name).value_or({});
     auto const case_insensitive_match = (attribute.case_type == CSS::Selector::SimpleSelector::Attribute::CaseType::CaseInsensitiveMatch);
     auto const case_sensitivity = case_insensitive_match
         ? CaseSensitivity::CaseInsensitive
@@ -108,14 +105,14 @@ static inline bool matches_attribute(CSS::Selector::SimpleSelector::Attribute co
     switch (attribute.match_type) {
     case CSS::Selector::SimpleSelector::Attribute::MatchType::ExactValueMatch:
         return case_insensitive_match
-            ? element.attribute(attribute.name).equals_ignoring_case(attribute.value)
-            : element.attribute(attribute.name) == attribute.value;
+            ? element_attr_value.equals_ignoring_case(attribute.value)
+            : element_attr_value == attribute.value;
     case CSS::Selector::SimpleSelector::Attribute::MatchType::ContainsWord: {
         if (attribute.value.is_empty()) {
             // This selector is always false is match value is empty.
             return false;
         }
-        auto const view = element.attribute(attribute.name).split_view(' ');
+        auto const view = element_attr_value.split_view(' ');
         auto const size = view.size();
         for (size_t i = 0; i < size; ++i) {
             auto const value = view.at(i);
@@ -129,9 +126,8 @@ static inline bool matches_attribute(CSS::Selector::SimpleSelector::Attribute co
     }
     case CSS::Selector::SimpleSelector::Attribute::MatchType::ContainsString:
         return !attribute.value.is_empty()
-            && element.attribute(attribute.name).contains(attribute.value, case_sensitivity);
+            && element_attr_value.contains(attribute.value, case_sensitivity);
     case CSS::Selector::SimpleSelector::Attribute::MatchType::StartsWithSegment: {
-        auto const element_attr_value = element.attribute(attribute.name);
         if (element_attr_value.is_empty()) {
             // If the attribute value on element is empty, the selector is true
             // if the match value is also empty and false otherwise.
@@ -147,10 +143,10 @@ static inline bool matches_attribute(CSS::Selector::SimpleSelector::Attribute co
     }
     case CSS::Selector::SimpleSelector::Attribute::MatchType::StartsWithString:
         return !attribute.value.is_empty()
-            && element.attribute(attribute.name).starts_with(attribute.value, case_sensitivity);
+            && element_attr_value.starts_with(attribute.value, case_sensitivity);
     case CSS::Selector::SimpleSelector::Attribute::MatchType::EndsWithString:
         return !attribute.value.is_empty()
-            && element.attribute(attribute.name).ends_with(attribute.value, case_sensitivity);
+            && element_attr_value.ends_with(attribute.value, case_sensitivity);
     default:
         break;
     }
@@ -351,7 +347,7 @@ static inline bool matches(CSS::Selector::SimpleSelector const& component, DOM::
     case CSS::Selector::SimpleSelector::Type::Universal:
         return true;
     case CSS::Selector::SimpleSelector::Type::Id:
-        return component.name() == element.attribute(HTML::AttributeNames::id);
+        return element.attribute_view(HTML::AttributeNames::id) == component.name().view();
     case CSS::Selector::SimpleSelector::Type::Class:
         return element.has_class(component.name());
     case CSS::Selector::SimpleSelector::Type::TagName:
@@ -65,6 +65,8 @@ public:
 
     ErrorOr<String> to_string() const;
 
+    bool operator==(Size const&) const = default;
+
 private:
     Size(Type type, LengthPercentage);
 
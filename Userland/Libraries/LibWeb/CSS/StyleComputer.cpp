@@ -18,6 +18,8 @@
 #include <LibGfx/Font/ScaledFont.h>
 #include <LibGfx/Font/VectorFont.h>
 #include <LibGfx/Font/WOFF/Font.h>
+#include <LibThreading/BackgroundAction.h>
+#include <LibThreading/ThreadPool.h>
 #include <LibWeb/CSS/CSSFontFaceRule.h>
 #include <LibWeb/CSS/CSSStyleRule.h>
 #include <LibWeb/CSS/Parser/Parser.h>
@@ -56,11 +58,26 @@ public:
 
     virtual void resource_did_load() override
     {
-        auto result = try_load_font();
-        if (result.is_error())
-            return;
-        m_vector_font = result.release_value();
-        m_style_computer.did_load_font(m_family_name);
+        // Note: Fonts are decoded on a background thread, so that big ones don't hold up the page. Until then, text is
+        //       rendered with the next font in its font-family list, and swapped over once this one is ready.
+        //       The strings are copied, as they are looked at on the other thread.
+        NonnullRefPtr<Resource> resource = *this->resource();
+        DeprecatedString mime_type { resource->mime_type().view() };
+        (void)Threading::BackgroundAction<ErrorOr<NonnullRefPtr<Gfx::VectorFont>>>::construct(
+            [resource = move(resource), mime_type = move(mime_type)](auto&) {
+                return try_load_font(mime_type, resource->encoded_data());
+            },
+            [weak_this = make_weak_ptr<FontLoader>()](auto result) -> ErrorOr<void> {
+                if (!weak_this)
+                    return {};
+                if (result.is_error()) {
+                    dbgln("FontLoader: Failed to decode font {}: {}", weak_this->m_family_name, result.error());
+                    return {};
+                }
+                weak_this->m_vector_font = result.release_value();
+                weak_this->m_style_computer.did_load_font(weak_this->m_family_name);
+                return {};
+            });
     }
 
     virtual void resource_did_fail() override
@@ -87,18 +104,17 @@ public:
     }
 
 private:
-    ErrorOr<NonnullRefPtr<Gfx::VectorFont>> try_load_font()
+    static ErrorOr<NonnullRefPtr<Gfx::VectorFont>> try_load_font(StringView mime_type, ReadonlyBytes data)
     {
         // FIXME: This could maybe use the format() provided in @font-face as well, since often the mime type is just application/octet-stream and we have to try every format
-        auto mime_type = resource()->mime_type();
         if (mime_type == "font/ttf"sv || mime_type == "application/x-font-ttf"sv)
-            return TRY(OpenType::Font::try_load_from_externally_owned_memory(resource()->encoded_data()));
+            return TRY(OpenType::Font::try_load_from_externally_owned_memory(data));
         if (mime_type == "font/woff"sv)
-            return TRY(WOFF::Font::try_load_from_externally_owned_memory(resource()->encoded_data()));
-        auto ttf = OpenType::Font::try_load_from_externally_owned_memory(resource()->encoded_data());
+            return TRY(WOFF::Font::try_load_from_externally_owned_memory(data));
+        auto ttf = OpenType::Font::try_load_from_externally_owned_memory(data);
         if (!ttf.is_error())
             return ttf.release_value();
-        auto woff = WOFF::Font::try_load_from_externally_owned_memory(resource()->encoded_data());
+        auto woff = WOFF::Font::try_load_from_externally_owned_memory(data);
         if (!woff.is_error())
             return woff.release_value();
         return ttf.release_error();
@@ -149,6 +165,11 @@ void StyleComputer::for_each_stylesheet(CascadeOrigin cascade_origin, Callback c
 }
 
 Vector<MatchingRule> StyleComputer::collect_matching_rules(DOM::Element const& element, CascadeOrigin cascade_origin, Optional<CSS::Selector::PseudoElement> pseudo_element) const
+{
+    return collect_matching_rules(element, cascade_origin, pseudo_element, m_ancestor_filter);
+}
+
+Vector<MatchingRule> StyleComputer::collect_matching_rules(DOM::Element const& element, CascadeOrigin cascade_origin, Optional<CSS::Selector::PseudoElement> pseudo_element, AncestorFilter const& ancestor_filter) const
 {
     if (cascade_origin == CascadeOrigin::Author) {
         Vector<MatchingRule> rules_to_run;
@@ -160,8 +181,10 @@ Vector<MatchingRule> StyleComputer::collect_matching_rules(DOM::Element const& e
                 if (auto it = m_rule_cache->rules_by_class.find(class_name); it != m_rule_cache->rules_by_class.end())
                     rules_to_run.extend(it->value);
             }
-            if (auto id = element.get_attribute(HTML::AttributeNames::id); !id.is_null()) {
-                if (auto it = m_rule_cache->rules_by_id.find(id); it != m_rule_cache->rules_by_id.end())
+            if (auto id = element.attribute_view(HTML::AttributeNames::id); id.has_value()) {
+                // NOTE: Looking the id up as a DeprecatedFlyString would intern it, which only the main thread may do.
+                auto it = m_rule_cache->rules_by_id.find(id->hash(), [&](auto const& entry) { return entry.key == *id; });
+                if (it != m_rule_cache->rules_by_id.end())
                     rules_to_run.extend(it->value);
             }
             if (auto it = m_rule_cache->rules_by_tag_name.find(element.local_name()); it != m_rule_cache->rules_by_tag_name.end())
@@ -169,16 +192,22 @@ Vector<MatchingRule> StyleComputer::collect_matching_rules(DOM::Element const& e
             rules_to_run.extend(m_rule_cache->other_rules);
         }
 
+        bool const use_ancestor_filter = ancestor_filter_applies_to(ancestor_filter, element);
+
         Vector<MatchingRule> matching_rules;
         matching_rules.ensure_capacity(rules_to_run.size());
         for (auto const& rule_to_run : rules_to_run) {
             auto const& selector = rule_to_run.rule->selectors()[rule_to_run.selector_index];
+            if (use_ancestor_filter && should_reject_with_ancestor_filter(ancestor_filter, selector))
+                continue;
             if (SelectorEngine::matches(selector, element, pseudo_element))
                 matching_rules.append(rule_to_run);
         }
         return matching_rules;
     }
 
+    bool const use_ancestor_filter = ancestor_filter_applies_to(ancestor_filter, element);
+
     Vector<MatchingRule> matching_rules;
     size_t style_sheet_index = 0;
     for_each_stylesheet(cascade_origin, [&](auto& sheet) {
@@ -186,6 +215,10 @@ Vector<MatchingRule> StyleComputer::collect_matching_rules(DOM::Element const& e
         sheet.for_each_effective_style_rule([&](auto const& rule) {
             size_t selector_index = 0;
             for (auto& selector : rule.selectors()) {
+                if (use_ancestor_filter && should_reject_with_ancestor_filter(ancestor_filter, selector)) {
+                    ++selector_index;
+                    continue;
+                }
                 if (SelectorEngine::matches(selector, element, pseudo_element)) {
                     matching_rules.append({ &rule, style_sheet_index, rule_index, selector_index, selector.specificity() });
                     break;
@@ -856,12 +889,16 @@ static ErrorOr<void> cascade_custom_properties(DOM::Element& element, Vector<Mat
 // https://www.w3.org/TR/css-cascade/#cascading
 ErrorOr<void> StyleComputer::compute_cascaded_values(StyleProperties& style, DOM::Element& element, Optional<CSS::Selector::PseudoElement> pseudo_element) const
 {
-    // First, we collect all the CSS rules whose selectors match `element`:
+    // First, we collect all the CSS rules whose selectors match `element`, unless that already happened in parallel:
     MatchingRuleSet matching_rule_set;
-    matching_rule_set.user_agent_rules = collect_matching_rules(element, CascadeOrigin::UserAgent, pseudo_element);
-    sort_matching_rules(matching_rule_set.user_agent_rules);
-    matching_rule_set.author_rules = collect_matching_rules(element, CascadeOrigin::Author, pseudo_element);
-    sort_matching_rules(matching_rule_set.author_rules);
+    if (auto index = m_prematched_rule_set_indices.get(&element); index.has_value() && !pseudo_element.has_value()) {
+        matching_rule_set = move(m_prematched_rule_sets[*index]);
+    } else {
+        matching_rule_set.user_agent_rules = collect_matching_rules(element, CascadeOrigin::UserAgent, pseudo_element);
+        sort_matching_rules(matching_rule_set.user_agent_rules);
+        matching_rule_set.author_rules = collect_matching_rules(element, CascadeOrigin::Author, pseudo_element);
+        sort_matching_rules(matching_rule_set.author_rules);
+    }
 
     // Then we resolve all the CSS custom properties ("variables") for this element:
     // FIXME: Look into how custom properties should interact with pseudo elements and support that properly.
@@ -1380,6 +1417,13 @@ ErrorOr<NonnullRefPtr<StyleProperties>> StyleComputer::compute_style(DOM::Elemen
 {
     build_rule_cache_if_needed();
 
+    // Siblings with the same tag name and attributes usually end up with the same style, so try to take it over from one.
+    bool const can_share_style = !pseudo_element.has_value() && can_share_style_with_siblings(element);
+    if (can_share_style) {
+        if (auto shared_style = find_shared_style(element))
+            return shared_style.release_nonnull();
+    }
+
     auto style = StyleProperties::create();
     // 1. Perform the cascade. This produces the "specified style"
     TRY(compute_cascaded_values(style, element, pseudo_element));
@@ -1396,9 +1440,228 @@ ErrorOr<NonnullRefPtr<StyleProperties>> StyleComputer::compute_style(DOM::Elemen
     // 5. Run automatic box type transformations
     transform_box_type_if_needed(style, element, pseudo_element);
 
+    if (can_share_style)
+        add_style_sharing_candidate(element, *style);
+
     return style;
 }
 
+static void collect_elements_in_tree_order(DOM::Node const& node, Vector<DOM::Element const*>& elements)
+{
+    if (is<DOM::Element>(node)) {
+        auto const& element = static_cast<DOM::Element const&>(node);
+        elements.append(&element);
+        if (auto const* shadow_root = element.shadow_root_internal())
+            collect_elements_in_tree_order(*shadow_root, elements);
+    }
+    for (auto const* child = node.first_child(); child; child = child->next_sibling())
+        collect_elements_in_tree_order(*child, elements);
+}
+
+void StyleComputer::prematch_rules_in_parallel()
+{
+    // NOTE: The rule cache is only read from here on, so the threads can share it.
+    build_rule_cache_if_needed();
+
+    Vector<DOM::Element const*> elements;
+    collect_elements_in_tree_order(document(), elements);
+    if (elements.size() < minimum_element_count_for_parallel_matching)
+        return;
+
+    m_prematched_rule_sets.resize(elements.size());
+    Threading::ThreadPool::the().parallel_for(elements.size(), parallel_matching_grain_size, [&](size_t begin, size_t end) {
+        AncestorFilter ancestor_filter;
+        for (size_t i = begin; i < end; ++i) {
+            auto const& element = *elements[i];
+
+            // Within a run, the parent of an element is usually one that came before it. Otherwise, like at the start of
+            // a run, the filter starts over with the element's ancestors.
+            while (!ancestor_filter.elements.is_empty() && ancestor_filter.elements.last() != element.parent())
+                ancestor_filter.pop(*ancestor_filter.elements.last());
+            if (ancestor_filter.elements.is_empty()) {
+                Vector<DOM::Element const*> ancestors;
+                for (auto const* ancestor = element.parent_element(); ancestor; ancestor = ancestor->parent_element())
+                    ancestors.append(ancestor);
+                for (size_t j = ancestors.size(); j > 0; --j)
+                    ancestor_filter.push(*ancestors[j - 1]);
+            }
+
+            auto& matching_rule_set = m_prematched_rule_sets[i];
+            matching_rule_set.user_agent_rules = collect_matching_rules(element, CascadeOrigin::UserAgent, {}, ancestor_filter);
+            sort_matching_rules(matching_rule_set.user_agent_rules);
+            matching_rule_set.author_rules = collect_matching_rules(element, CascadeOrigin::Author, {}, ancestor_filter);
+            sort_matching_rules(matching_rule_set.author_rules);
+
+            ancestor_filter.push(element);
+        }
+    });
+
+    m_prematched_rule_set_indices.ensure_capacity(elements.size());
+    for (size_t i = 0; i < elements.size(); ++i)
+        m_prematched_rule_set_indices.set(elements[i], i);
+}
+
+void StyleComputer::discard_prematched_rules()
+{
+    m_prematched_rule_sets.clear();
+    m_prematched_rule_set_indices.clear();
+}
+
+template<typename Callback>
+static void for_each_ancestor_hash(DOM::Element const& element, Callback callback)
+{
+    callback(Selector::ancestor_hash_for_tag_name(element.local_name()));
+    if (auto id = element.attribute_view(HTML::AttributeNames::id); id.has_value())
+        callback(Selector::ancestor_hash_for_id(*id));
+    for (auto const& class_name : element.class_names())
+        callback(Selector::ancestor_hash_for_class(class_name));
+}
+
+void StyleComputer::AncestorFilter::push(DOM::Element const& element)
+{
+    elements.append(&element);
+    for_each_ancestor_hash(element, [&](u32 hash) {
+        hashes.increment(hash);
+    });
+}
+
+void StyleComputer::AncestorFilter::pop(DOM::Element const& element)
+{
+    VERIFY(!elements.is_empty() && elements.last() == &element);
+    elements.take_last();
+    for_each_ancestor_hash(element, [&](u32 hash) {
+        hashes.decrement(hash);
+    });
+}
+
+void StyleComputer::push_ancestor(DOM::Element const& element)
+{
+    m_ancestor_filter.push(element);
+}
+
+void StyleComputer::pop_ancestor(DOM::Element const& element)
+{
+    m_ancestor_filter.pop(element);
+
+    // NOTE: Style sharing candidates don't outlive the style update they were found in.
+    if (m_ancestor_filter.elements.is_empty())
+        m_style_sharing_candidates.clear();
+}
+
+bool StyleComputer::ancestor_filter_applies_to(AncestorFilter const& ancestor_filter, DOM::Element const& element) const
+{
+    // NOTE: The filter only holds all of the element's ancestors if its parent was the last one pushed.
+    //       Tag names are only compared case-sensitively (after lowercasing the selector) in HTML documents.
+    return !ancestor_filter.elements.is_empty()
+        && ancestor_filter.elements.last() == element.parent()
+        && document().document_type() == DOM::Document::Type::HTML;
+}
+
+bool StyleComputer::should_reject_with_ancestor_filter(AncestorFilter const& ancestor_filter, Selector const& selector)
+{
+    for (u32 hash : selector.ancestor_hashes()) {
+        if (hash == 0)
+            break;
+        if (!ancestor_filter.hashes.may_contain(hash))
+            return true;
+    }
+    return false;
+}
+
+// Whether the selector may match an element, but not a sibling of it with the same tag name and attributes.
+static bool may_match_siblings_differently(Selector const& selector)
+{
+    for (auto const& compound_selector : selector.compound_selectors()) {
+        if (compound_selector.combinator == Selector::Combinator::NextSibling || compound_selector.combinator == Selector::Combinator::SubsequentSibling)
+            return true;
+    }
+
+    // NOTE: Without sibling combinators, only the last compound selector is matched against the element itself. The rest match
+    //       its ancestors, which siblings have in common.
+    for (auto const& simple_selector : selector.compound_selectors().last().simple_selectors) {
+        if (simple_selector.type != Selector::SimpleSelector::Type::PseudoClass)
+            continue;
+        auto const& pseudo_class = simple_selector.pseudo_class();
+        switch (pseudo_class.type) {
+        case Selector::SimpleSelector::PseudoClass::Type::Link:
+        case Selector::SimpleSelector::PseudoClass::Type::Root:
+        case Selector::SimpleSelector::PseudoClass::Type::Lang:
+            break;
+        case Selector::SimpleSelector::PseudoClass::Type::Is:
+        case Selector::SimpleSelector::PseudoClass::Type::Not:
+        case Selector::SimpleSelector::PseudoClass::Type::Where:
+            for (auto const& argument_selector : pseudo_class.argument_selector_list) {
+                if (may_match_siblings_differently(argument_selector))
+                    return true;
+            }
+            break;
+        default:
+            return true;
+        }
+    }
+    return false;
+}
+
+bool StyleComputer::can_share_style_with_siblings(DOM::Element const& element) const
+{
+    // NOTE: Siblings are only known to have the same ancestors while they're styled as part of the same subtree.
+    //       Inline style belongs to the element, even if another one has the same style attribute.
+    return ancestor_filter_applies_to(m_ancestor_filter, element) && !element.inline_style();
+}
+
+static bool have_same_attributes(DOM::Element const& a, DOM::Element const& b)
+{
+    if (a.attribute_list_size() != b.attribute_list_size())
+        return false;
+    bool same_attributes = true;
+    a.for_each_attribute([&](auto const& name, auto const& value) {
+        if (same_attributes && (!b.has_attribute(name) || b.attribute(name) != value))
+            same_attributes = false;
+    });
+    return same_attributes;
+}
+
+Vector<bool> StyleComputer::match_revalidation_selectors(DOM::Element const& element) const
+{
+    Vector<bool> matches;
+    matches.ensure_capacity(m_rule_cache->revalidation_selectors.size());
+    for (auto const* selector : m_rule_cache->revalidation_selectors)
+        matches.unchecked_append(!should_reject_with_ancestor_filter(m_ancestor_filter, *selector) && SelectorEngine::matches(*selector, element));
+    return matches;
+}
+
+RefPtr<StyleProperties> StyleComputer::find_shared_style(DOM::Element& element) const
+{
+    Optional<Vector<bool>> revalidation_matches;
+    for (auto& candidate : m_style_sharing_candidates) {
+        auto const& candidate_element = *candidate.element;
+        if (candidate_element.parent() != element.parent()
+            || candidate_element.local_name() != element.local_name()
+            || candidate_element.namespace_() != element.namespace_()
+            || !have_same_attributes(candidate_element, element))
+            continue;
+
+        if (!candidate.revalidation_matches.has_value())
+            candidate.revalidation_matches = match_revalidation_selectors(candidate_element);
+        if (!revalidation_matches.has_value())
+            revalidation_matches = match_revalidation_selectors(element);
+        if (*candidate.revalidation_matches != *revalidation_matches)
+            continue;
+
+        // NOTE: Computing the style also determines the element's custom properties, which its descendants may refer to.
+        element.set_custom_properties(candidate_element.custom_properties());
+        return candidate.style->clone();
+    }
+    return nullptr;
+}
+
+void StyleComputer::add_style_sharing_candidate(DOM::Element const& element, StyleProperties& style) const
+{
+    if (m_style_sharing_candidates.size() == max_style_sharing_candidates)
+        m_style_sharing_candidates.take_last();
+    m_style_sharing_candidates.prepend(StyleSharingCandidate { &element, style, {} });
+}
+
 PropertyDependencyNode::PropertyDependencyNode(DeprecatedString name)
     : m_name(move(name))
 {
@@ -1490,6 +1753,10 @@ void StyleComputer::build_rule_cache()
                 if (!added_to_bucket)
                     m_rule_cache->other_rules.append(move(matching_rule));
 
+                if (!selector.pseudo_element().has_value() && may_match_siblings_differently(selector))
+                    m_rule_cache->revalidation_selectors.append(&selector);
+                collect_invalidations(selector, { .self = true });
+
                 ++selector_index;
             }
             ++rule_index;
@@ -1497,6 +1764,19 @@ void StyleComputer::build_rule_cache()
         ++style_sheet_index;
     });
 
+    for_each_stylesheet(CascadeOrigin::UserAgent, [&](auto& sheet) {
+        sheet.for_each_effective_style_rule([&](auto const& rule) {
+            for (CSS::Selector const& selector : rule.selectors()) {
+                if (!selector.pseudo_element().has_value() && may_match_siblings_differently(selector))
+                    m_rule_cache->revalidation_selectors.append(&selector);
+                collect_invalidations(selector, { .self = true });
+
+                // NOTE: Specificity is computed lazily, so that's done here and not while selectors are matched in parallel.
+                (void)selector.specificity();
+            }
+        });
+    });
+
     if constexpr (LIBWEB_CSS_DEBUG) {
         dbgln("Built rule cache!");
         dbgln("           ID: {}", num_id_rules);
@@ -1508,9 +1788,82 @@ void StyleComputer::build_rule_cache()
     }
 }
 
+void StyleComputer::collect_invalidations(Selector const& selector, StyleInvalidation const& outer_invalidation)
+{
+    auto const& compound_selectors = selector.compound_selectors();
+    for (size_t i = 0; i < compound_selectors.size(); ++i) {
+        // NOTE: The subject of the selector stands for whatever the outer compound selector matched. Every other compound
+        //       selector matches an ancestor or an earlier sibling of it, depending on the combinator that follows.
+        auto invalidation = outer_invalidation;
+        if (i + 1 < compound_selectors.size()) {
+            switch (compound_selectors[i + 1].combinator) {
+            case Selector::Combinator::NextSibling:
+            case Selector::Combinator::SubsequentSibling:
+                invalidation.siblings = true;
+                break;
+            case Selector::Combinator::Column:
+                invalidation.descendants = true;
+                invalidation.siblings = true;
+                break;
+            default:
+                invalidation.descendants = true;
+                break;
+            }
+        }
+
+        for (auto const& simple_selector : compound_selectors[i].simple_selectors) {
+            switch (simple_selector.type) {
+            case Selector::SimpleSelector::Type::Id:
+                m_rule_cache->invalidations_by_id.ensure(simple_selector.name()) |= invalidation;
+                break;
+            case Selector::SimpleSelector::Type::Class:
+                m_rule_cache->invalidations_by_class.ensure(simple_selector.name()) |= invalidation;
+                break;
+            case Selector::SimpleSelector::Type::Attribute:
+                m_rule_cache->invalidations_by_attribute.ensure(simple_selector.attribute().name.to_lowercase()) |= invalidation;
+                break;
+            case Selector::SimpleSelector::Type::PseudoClass: {
+                auto const& pseudo_class = simple_selector.pseudo_class();
+                m_rule_cache->invalidations_by_pseudo_class.ensure(pseudo_class.type) |= invalidation;
+                for (auto const& argument_selector : pseudo_class.argument_selector_list)
+                    collect_invalidations(argument_selector, invalidation);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+}
+
 void StyleComputer::invalidate_rule_cache()
 {
     m_rule_cache = nullptr;
+    m_style_sharing_candidates.clear();
+}
+
+StyleInvalidation StyleComputer::invalidation_for_class(DeprecatedFlyString const& class_name) const
+{
+    build_rule_cache_if_needed();
+    return m_rule_cache->invalidations_by_class.get(class_name).value_or({});
+}
+
+StyleInvalidation StyleComputer::invalidation_for_id(DeprecatedFlyString const& id) const
+{
+    build_rule_cache_if_needed();
+    return m_rule_cache->invalidations_by_id.get(id).value_or({});
+}
+
+StyleInvalidation StyleComputer::invalidation_for_attribute(DeprecatedFlyString const& attribute_name) const
+{
+    build_rule_cache_if_needed();
+    return m_rule_cache->invalidations_by_attribute.get(attribute_name.to_lowercase()).value_or({});
+}
+
+StyleInvalidation StyleComputer::invalidation_for_pseudo_class(Selector::SimpleSelector::PseudoClass::Type type) const
+{
+    build_rule_cache_if_needed();
+    return m_rule_cache->invalidations_by_pseudo_class.get(type).value_or({});
 }
 
 CSSPixelRect StyleComputer::viewport_rect() const
@@ -13,6 +13,7 @@
 #include <AK/OwnPtr.h>
 #include <LibWeb/CSS/CSSFontFaceRule.h>
 #include <LibWeb/CSS/CSSStyleDeclaration.h>
+#include <LibWeb/CSS/CountingBloomFilter.h>
 #include <LibWeb/CSS/Parser/ComponentValue.h>
 #include <LibWeb/CSS/Parser/TokenStream.h>
 #include <LibWeb/CSS/Selector.h>
@@ -29,6 +30,24 @@ struct MatchingRule {
     u32 specificity { 0 };
 };
 
+// What a change to some feature of an element, like one of its classes, can affect the style of.
+struct StyleInvalidation {
+    bool self { false };
+    bool descendants { false };
+    // NOTE: Only siblings that come after the element (and their descendants) are affected.
+    bool siblings { false };
+
+    bool is_empty() const { return !self && !descendants && !siblings; }
+
+    StyleInvalidation& operator|=(StyleInvalidation const& other)
+    {
+        self |= other.self;
+        descendants |= other.descendants;
+        siblings |= other.siblings;
+        return *this;
+    }
+};
+
 class PropertyDependencyNode : public RefCounted<PropertyDependencyNode> {
 public:
     static NonnullRefPtr<PropertyDependencyNode> create(DeprecatedString name)
@@ -71,6 +90,26 @@ public:
 
     void invalidate_rule_cache();
 
+    // Which elements' style a change to one of an element's classes, its id, an attribute or a pseudo-class state may
+    // affect, according to where these appear in the selectors of all style sheets.
+    StyleInvalidation invalidation_for_class(DeprecatedFlyString const&) const;
+    StyleInvalidation invalidation_for_id(DeprecatedFlyString const&) const;
+    StyleInvalidation invalidation_for_attribute(DeprecatedFlyString const&) const;
+    StyleInvalidation invalidation_for_pseudo_class(Selector::SimpleSelector::PseudoClass::Type) const;
+
+    // While the style of a subtree is being updated, the elements whose children are being styled are pushed here.
+    // The ids, classes and tag names of these ancestors are kept in a bloom filter, which rejects most selectors that
+    // need an ancestor the element doesn't have without walking up the tree. Siblings styled meanwhile may share styles.
+    void push_ancestor(DOM::Element const&);
+    void pop_ancestor(DOM::Element const&);
+
+    // Before every element of the document is restyled, the selectors can be matched against all of them on the thread pool.
+    // Each thread takes runs of consecutive elements in tree order, so whole subtrees, and keeps an ancestor filter of its own.
+    // compute_style() then uses the rules that were matched, until they are discarded at the end of the style update.
+    // NOTE: The DOM and the style sheets must not change in between.
+    void prematch_rules_in_parallel();
+    void discard_prematched_rules();
+
     Gfx::Font const& initial_font() const;
 
     void did_load_font(DeprecatedFlyString const& family_name);
@@ -105,18 +144,65 @@ private:
 
     void build_rule_cache();
     void build_rule_cache_if_needed() const;
+    void collect_invalidations(Selector const&, StyleInvalidation const& outer_invalidation = {});
+
+    struct AncestorFilter {
+        void push(DOM::Element const&);
+        void pop(DOM::Element const&);
+
+        CountingBloomFilter<u8, 12> hashes;
+        Vector<DOM::Element const*> elements;
+    };
+
+    Vector<MatchingRule> collect_matching_rules(DOM::Element const&, CascadeOrigin, Optional<CSS::Selector::PseudoElement>, AncestorFilter const&) const;
+
+    bool ancestor_filter_applies_to(AncestorFilter const&, DOM::Element const&) const;
+    static bool should_reject_with_ancestor_filter(AncestorFilter const&, Selector const&);
+
+    bool can_share_style_with_siblings(DOM::Element const&) const;
+    RefPtr<StyleProperties> find_shared_style(DOM::Element&) const;
+    void add_style_sharing_candidate(DOM::Element const&, StyleProperties&) const;
+    Vector<bool> match_revalidation_selectors(DOM::Element const&) const;
 
     DOM::Document& m_document;
 
     struct RuleCache {
-        HashMap<DeprecatedFlyString, Vector<MatchingRule>> rules_by_id;
-        HashMap<DeprecatedFlyString, Vector<MatchingRule>> rules_by_class;
-        HashMap<DeprecatedFlyString, Vector<MatchingRule>> rules_by_tag_name;
+        FlatHashMap<DeprecatedFlyString, Vector<MatchingRule>> rules_by_id;
+        FlatHashMap<DeprecatedFlyString, Vector<MatchingRule>> rules_by_class;
+        FlatHashMap<DeprecatedFlyString, Vector<MatchingRule>> rules_by_tag_name;
         HashMap<Selector::PseudoElement, Vector<MatchingRule>> rules_by_pseudo_element;
         Vector<MatchingRule> other_rules;
+
+        // Selectors of any origin that may match one sibling but not another with the same tag name and attributes,
+        // because they depend on the element's position among its siblings or on its state.
+        Vector<Selector const*> revalidation_selectors;
+
+        // NOTE: Attribute names are kept in lowercase.
+        HashMap<DeprecatedFlyString, StyleInvalidation> invalidations_by_class;
+        HashMap<DeprecatedFlyString, StyleInvalidation> invalidations_by_id;
+        HashMap<DeprecatedFlyString, StyleInvalidation> invalidations_by_attribute;
+        HashMap<Selector::SimpleSelector::PseudoClass::Type, StyleInvalidation> invalidations_by_pseudo_class;
     };
     OwnPtr<RuleCache> m_rule_cache;
 
+    AncestorFilter m_ancestor_filter;
+
+    // The rules matched by prematch_rules_in_parallel(), and the index of each element's set.
+    static constexpr size_t minimum_element_count_for_parallel_matching = 256;
+    static constexpr size_t parallel_matching_grain_size = 64;
+    mutable Vector<MatchingRuleSet> m_prematched_rule_sets;
+    HashMap<DOM::Element const*, size_t> m_prematched_rule_set_indices;
+
+    // Recently styled elements whose style a sibling may take over, if they match the same revalidation selectors.
+    // NOTE: These are only kept while a subtree is being styled, which keeps the elements alive.
+    struct StyleSharingCandidate {
+        DOM::Element const* element { nullptr };
+        NonnullRefPtr<StyleProperties> style;
+        Optional<Vector<bool>> revalidation_matches;
+    };
+    static constexpr size_t max_style_sharing_candidates = 16;
+    mutable Vector<StyleSharingCandidate> m_style_sharing_candidates;
+
     class FontLoader;
     HashMap<DeprecatedString, NonnullOwnPtr<FontLoader>> m_loaded_fonts;
 };
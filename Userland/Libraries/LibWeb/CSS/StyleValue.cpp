@@ -1876,11 +1876,6 @@ static bool operator==(LinearGradientStyleValue::GradientDirection const& a, Lin
     return false;
 }
 
-static bool operator==(EdgeRect const& a, EdgeRect const& b)
-{
-    return a.top_edge == b.top_edge && a.right_edge == b.right_edge && a.bottom_edge == b.bottom_edge && a.left_edge == b.left_edge;
-}
-
 bool LinearGradientStyleValue::equals(StyleValue const& other_) const
 {
     if (type() != other_.type())
@@ -143,6 +143,7 @@ struct EdgeRect {
     Length bottom_edge;
     Length left_edge;
     Gfx::FloatRect resolved(Layout::Node const&, Gfx::FloatRect) const;
+    bool operator==(EdgeRect const&) const = default;
 };
 
 namespace Filter {
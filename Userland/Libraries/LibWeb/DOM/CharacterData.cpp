@@ -10,6 +10,7 @@
 #include <LibWeb/DOM/MutationType.h>
 #include <LibWeb/DOM/Range.h>
 #include <LibWeb/DOM/StaticNodeList.h>
+#include <LibWeb/Layout/TextNode.h>
 
 namespace Web::DOM {
 
@@ -111,7 +112,14 @@ WebIDL::ExceptionOr<void> CharacterData::replace_data(size_t offset, size_t coun
         parent()->children_changed();
 
     set_needs_style_update(true);
-    document().set_needs_layout();
+    // NOTE: Only the text's own line boxes are affected, so there's no need to lay out the whole document again.
+    if (auto* layout_node = this->layout_node()) {
+        if (is<Layout::TextNode>(*layout_node))
+            static_cast<Layout::TextNode&>(*layout_node).invalidate_text_for_rendering();
+        layout_node->set_needs_layout();
+    } else {
+        document().set_needs_layout();
+    }
     return {};
 }
 
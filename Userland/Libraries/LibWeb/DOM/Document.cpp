@@ -65,6 +65,7 @@
 #include <LibWeb/HighResolutionTime/TimeOrigin.h>
 #include <LibWeb/Layout/BlockFormattingContext.h>
 #include <LibWeb/Layout/InitialContainingBlock.h>
+#include <LibWeb/Layout/LayoutState.h>
 #include <LibWeb/Layout/TreeBuilder.h>
 #include <LibWeb/Namespace.h>
 #include <LibWeb/Page/Page.h>
@@ -309,8 +310,11 @@ Document::Document(JS::Realm& realm, const AK::URL& url)
     });
 }
 
-Document::~Document()
+Document::~Document() = default;
+
+void Document::finalize()
 {
+    Base::finalize();
     HTML::main_thread_event_loop().unregister_document({}, *this);
 }
 
@@ -716,6 +720,8 @@ void Document::tear_down_layout_tree()
     }
 
     m_layout_root = nullptr;
+    m_previous_layout_state = nullptr;
+    m_needs_full_layout = true;
 }
 
 Color Document::background_color(Gfx::Palette const& palette) const
@@ -802,6 +808,15 @@ AK::URL Document::parse_url(DeprecatedString const& url) const
 }
 
 void Document::set_needs_layout()
+{
+    m_needs_full_layout = true;
+    if (m_needs_layout)
+        return;
+    m_needs_layout = true;
+    schedule_layout_update();
+}
+
+void Document::set_needs_layout_of_marked_nodes(Badge<Layout::Node>)
 {
     if (m_needs_layout)
         return;
@@ -848,14 +863,23 @@ void Document::update_layout()
         m_layout_root = verify_cast<Layout::InitialContainingBlock>(*tree_builder.build(*this));
     }
 
-    Layout::LayoutState layout_state;
-    layout_state.used_values_per_layout_node.resize(layout_node_count());
+    auto layout_state = make<Layout::LayoutState>();
+    layout_state->used_values_per_layout_node.resize(layout_node_count());
+    layout_state->is_document_layout = true;
+
+    // NOTE: Subtrees that haven't changed since the previous layout may reuse its results, unless something
+    //       that could affect any part of the layout has changed.
+    if (m_previous_layout_state && !m_needs_full_layout && viewport_rect.size() == m_previous_layout_viewport_size) {
+        layout_state->previous_layout = m_previous_layout_state.ptr();
+        layout_state->take_intrinsic_sizes_of_unchanged_boxes_from(*m_previous_layout_state);
+        layout_state->inside_layouts = move(m_previous_layout_state->inside_layouts);
+    }
 
     {
-        Layout::BlockFormattingContext root_formatting_context(layout_state, *m_layout_root, nullptr);
+        Layout::BlockFormattingContext root_formatting_context(*layout_state, *m_layout_root, nullptr);
 
         auto& icb = static_cast<Layout::InitialContainingBlock&>(*m_layout_root);
-        auto& icb_state = layout_state.get_mutable(icb);
+        auto& icb_state = layout_state->get_mutable(icb);
         icb_state.set_content_width(viewport_rect.width());
         icb_state.set_content_height(viewport_rect.height());
 
@@ -867,7 +891,12 @@ void Document::update_layout()
                 Layout::AvailableSize::make_definite(viewport_rect.height())));
     }
 
-    layout_state.commit();
+    layout_state->commit();
+    layout_state->previous_layout = nullptr;
+    m_previous_layout_state = move(layout_state);
+    m_previous_layout_viewport_size = viewport_rect.size();
+    m_needs_full_layout = false;
+    m_layout_root->clear_needs_layout_in_inclusive_subtree();
 
     browsing_context()->set_needs_display();
 
@@ -882,28 +911,37 @@ void Document::update_layout()
     m_layout_update_timer->stop();
 }
 
-[[nodiscard]] static bool update_style_recursively(DOM::Node& node)
+[[nodiscard]] static bool update_style_recursively(DOM::Node& node, bool parent_style_changed = false)
 {
     bool const needs_full_style_update = node.document().needs_full_style_update();
     bool needs_relayout = false;
 
+    // NOTE: Descendants inherit from the element, so they're restyled as well if its style changed.
+    bool restyle_children = needs_full_style_update || parent_style_changed;
     if (is<Element>(node)) {
-        needs_relayout |= static_cast<Element&>(node).recompute_style() == Element::NeedsRelayout::Yes;
+        auto& element = static_cast<Element&>(node);
+        auto const* old_computed_css_values = element.computed_css_values();
+        needs_relayout |= element.recompute_style() == Element::NeedsRelayout::Yes;
+        restyle_children = needs_full_style_update || element.computed_css_values() != old_computed_css_values;
     }
     node.set_needs_style_update(false);
 
-    if (needs_full_style_update || node.child_needs_style_update()) {
+    if (restyle_children || node.child_needs_style_update()) {
+        auto& style_computer = node.document().style_computer();
         if (node.is_element()) {
+            style_computer.push_ancestor(static_cast<DOM::Element&>(node));
             if (auto* shadow_root = static_cast<DOM::Element&>(node).shadow_root_internal()) {
-                if (needs_full_style_update || shadow_root->needs_style_update() || shadow_root->child_needs_style_update())
-                    needs_relayout |= update_style_recursively(*shadow_root);
+                if (restyle_children || shadow_root->needs_style_update() || shadow_root->child_needs_style_update())
+                    needs_relayout |= update_style_recursively(*shadow_root, restyle_children);
             }
         }
         node.for_each_child([&](auto& child) {
-            if (needs_full_style_update || child.needs_style_update() || child.child_needs_style_update())
-                needs_relayout |= update_style_recursively(child);
+            if (restyle_children || child.needs_style_update() || child.child_needs_style_update())
+                needs_relayout |= update_style_recursively(child, restyle_children);
             return IterationDecision::Continue;
         });
+        if (node.is_element())
+            style_computer.pop_ancestor(static_cast<DOM::Element&>(node));
     }
 
     node.set_child_needs_style_update(false);
@@ -922,8 +960,13 @@ void Document::update_style()
         return;
 
     evaluate_media_rules();
+
+    // NOTE: When every element is restyled, the selectors are matched against all of them in parallel up front.
+    if (needs_full_style_update())
+        style_computer().prematch_rules_in_parallel();
     if (update_style_recursively(*this))
         invalidate_layout();
+    style_computer().discard_prematched_rules();
     m_needs_full_style_update = false;
     m_style_update_timer->stop();
 }
@@ -996,10 +1039,19 @@ void Document::set_hovered_node(Node* node)
     m_hovered_node = node;
 
     auto* common_ancestor = find_common_ancestor(old_hovered_node, m_hovered_node);
-    if (common_ancestor)
-        common_ancestor->invalidate_style();
-    else
-        invalidate_style();
+
+    // NOTE: Only the elements between the common ancestor and the two hovered nodes start or stop matching :hover.
+    auto hover_invalidation = style_computer().invalidation_for_pseudo_class(CSS::Selector::SimpleSelector::PseudoClass::Type::Hover);
+    if (!hover_invalidation.is_empty()) {
+        auto invalidate_hover_chain = [&](Node* hovered_node) {
+            for (auto* chain_node = hovered_node; chain_node && chain_node != common_ancestor; chain_node = chain_node->parent_or_shadow_host()) {
+                if (is<Element>(*chain_node))
+                    static_cast<Element&>(*chain_node).apply_style_invalidation(hover_invalidation);
+            }
+        };
+        invalidate_hover_chain(old_hovered_node.ptr());
+        invalidate_hover_chain(m_hovered_node.ptr());
+    }
 
     // https://w3c.github.io/uievents/#mouseleave
     if (old_hovered_node && (!m_hovered_node || !m_hovered_node->is_descendant_of(*old_hovered_node))) {
@@ -190,6 +190,7 @@ public:
     void update_layout();
 
     void set_needs_layout();
+    void set_needs_layout_of_marked_nodes(Badge<Layout::Node>);
 
     void invalidate_layout();
     void invalidate_stacking_context_tree();
@@ -451,6 +452,7 @@ public:
 
 protected:
     virtual JS::ThrowCompletionOr<void> initialize(JS::Realm&) override;
+    virtual void finalize() override;
     virtual void visit_edges(Cell::Visitor&) override;
 
 private:
@@ -561,6 +563,11 @@ private:
 
     bool m_needs_layout { false };
 
+    // Unless set, the next layout only lays out again what contains layout nodes marked with Layout::Node::set_needs_layout().
+    bool m_needs_full_layout { true };
+    OwnPtr<Layout::LayoutState> m_previous_layout_state;
+    CSSPixelSize m_previous_layout_viewport_size;
+
     bool m_needs_full_style_update { false };
 
     HashTable<NodeIterator*> m_node_iterators;
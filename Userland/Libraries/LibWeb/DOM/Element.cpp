@@ -96,6 +96,14 @@ DeprecatedString Element::get_attribute(DeprecatedFlyString const& name) const
     return attribute->value();
 }
 
+Optional<StringView> Element::attribute_view(DeprecatedFlyString const& name) const
+{
+    auto const* attribute = m_attributes->get_attribute(name);
+    if (!attribute)
+        return {};
+    return attribute->value().view();
+}
+
 // https://dom.spec.whatwg.org/#dom-element-getattributenode
 JS::GCPtr<Attr> Element::get_attribute_node(DeprecatedFlyString const& name) const
 {
@@ -118,6 +126,8 @@ WebIDL::ExceptionOr<void> Element::set_attribute(DeprecatedFlyString const& name
     // 3. Let attribute be the first attribute in this’s attribute list whose qualified name is qualifiedName, and null otherwise.
     auto* attribute = m_attributes->get_attribute(name);
 
+    auto old_value = attribute ? attribute->value() : DeprecatedString {};
+
     // 4. If attribute is null, create an attribute whose local name is qualifiedName, value is value, and node document is this’s node document, then append this attribute to this, and then return.
     if (!attribute) {
         auto new_attribute = Attr::create(document(), insert_as_lowercase ? name.to_lowercase() : name, value);
@@ -133,7 +143,7 @@ WebIDL::ExceptionOr<void> Element::set_attribute(DeprecatedFlyString const& name
 
     parse_attribute(attribute->local_name(), value);
 
-    invalidate_style_after_attribute_change(name);
+    invalidate_style_after_attribute_change(name, old_value);
 
     return {};
 }
@@ -196,11 +206,13 @@ WebIDL::ExceptionOr<void> Element::set_attribute_ns(DeprecatedFlyString const& n
 // https://dom.spec.whatwg.org/#dom-element-removeattribute
 void Element::remove_attribute(DeprecatedFlyString const& name)
 {
+    auto old_value = attribute(name);
+
     m_attributes->remove_attribute(name);
 
     did_remove_attribute(name);
 
-    invalidate_style_after_attribute_change(name);
+    invalidate_style_after_attribute_change(name, old_value);
 }
 
 // https://dom.spec.whatwg.org/#dom-element-hasattribute
@@ -233,7 +245,7 @@ WebIDL::ExceptionOr<bool> Element::toggle_attribute(DeprecatedFlyString const& n
 
             parse_attribute(new_attribute->local_name(), "");
 
-            invalidate_style_after_attribute_change(name);
+            invalidate_style_after_attribute_change(name, {});
 
             return true;
         }
@@ -244,11 +256,13 @@ WebIDL::ExceptionOr<bool> Element::toggle_attribute(DeprecatedFlyString const& n
 
     // 5. Otherwise, if force is not given or is false, remove an attribute given qualifiedName and this, and then return false.
     if (!force.has_value() || !force.value()) {
+        auto old_value = attribute->value();
+
         m_attributes->remove_attribute(name);
 
         did_remove_attribute(name);
 
-        invalidate_style_after_attribute_change(name);
+        invalidate_style_after_attribute_change(name, old_value);
     }
 
     // 6. Return true.
@@ -358,7 +372,11 @@ void Element::parse_attribute(DeprecatedFlyString const& name, DeprecatedString
 
 void Element::did_remove_attribute(DeprecatedFlyString const& name)
 {
-    if (name == HTML::AttributeNames::style) {
+    if (name == HTML::AttributeNames::class_) {
+        m_classes.clear();
+        if (m_class_list)
+            m_class_list->associated_attribute_changed({});
+    } else if (name == HTML::AttributeNames::style) {
         if (m_inline_style) {
             m_inline_style = nullptr;
             set_needs_style_update(true);
@@ -1323,13 +1341,51 @@ ErrorOr<void> Element::scroll_into_view(Optional<Variant<bool, ScrollIntoViewOpt
     // FIXME: 8. Optionally perform some other action that brings the element to the user’s attention.
 }
 
-void Element::invalidate_style_after_attribute_change(DeprecatedFlyString const& attribute_name)
+void Element::invalidate_style_after_attribute_change(DeprecatedFlyString const& attribute_name, DeprecatedString const& old_value)
 {
-    // FIXME: Only invalidate if the attribute can actually affect style.
-    (void)attribute_name;
-
     // FIXME: This will need to become smarter when we implement the :has() selector.
-    invalidate_style();
+    auto const& style_computer = document().style_computer();
+    CSS::StyleInvalidation invalidation;
+
+    if (attribute_name == HTML::AttributeNames::class_) {
+        // NOTE: Only the classes that were added or removed can make a difference.
+        auto old_classes = old_value.split_view(Infra::is_ascii_whitespace);
+        for (auto old_class : old_classes) {
+            if (!any_of(m_classes, [&](auto const& new_class) { return new_class.view() == old_class; }))
+                invalidation |= style_computer.invalidation_for_class(old_class);
+        }
+        for (auto const& new_class : m_classes) {
+            if (!any_of(old_classes, [&](auto old_class) { return old_class == new_class.view(); }))
+                invalidation |= style_computer.invalidation_for_class(new_class);
+        }
+    } else if (attribute_name == HTML::AttributeNames::id) {
+        auto new_value = attribute(HTML::AttributeNames::id);
+        if (old_value != new_value) {
+            invalidation |= style_computer.invalidation_for_id(old_value);
+            invalidation |= style_computer.invalidation_for_id(new_value);
+        }
+    } else {
+        // NOTE: Any other attribute may be a presentational hint, or decide whether a pseudo-class like :checked,
+        //       :disabled or :lang matches this element or its descendants.
+        invalidation.self = true;
+        invalidation.descendants = true;
+    }
+
+    invalidation |= style_computer.invalidation_for_attribute(attribute_name);
+    apply_style_invalidation(invalidation);
+}
+
+void Element::apply_style_invalidation(CSS::StyleInvalidation const& invalidation)
+{
+    if (invalidation.descendants)
+        invalidate_style();
+    else if (invalidation.self)
+        set_needs_style_update(true);
+
+    if (invalidation.siblings) {
+        for (auto* sibling = next_sibling(); sibling; sibling = sibling->next_sibling())
+            sibling->invalidate_style();
+    }
 }
 
 // https://www.w3.org/TR/wai-aria-1.2/#tree_exclusion
@@ -72,6 +72,8 @@ public:
     bool has_attributes() const { return !m_attributes->is_empty(); }
     DeprecatedString attribute(DeprecatedFlyString const& name) const { return get_attribute(name); }
     DeprecatedString get_attribute(DeprecatedFlyString const& name) const;
+    // NOTE: Unlike get_attribute(), this doesn't copy the value, so several threads can look at the same element at once.
+    Optional<StringView> attribute_view(DeprecatedFlyString const& name) const;
     WebIDL::ExceptionOr<void> set_attribute(DeprecatedFlyString const& name, DeprecatedString const& value);
     WebIDL::ExceptionOr<void> set_attribute_ns(DeprecatedFlyString const& namespace_, DeprecatedFlyString const& qualified_name, DeprecatedString const& value);
     void remove_attribute(DeprecatedFlyString const& name);
@@ -117,6 +119,9 @@ public:
     };
     NeedsRelayout recompute_style();
 
+    // Marks the elements whose style may have changed, which are some of this element, its descendants and its later siblings.
+    void apply_style_invalidation(CSS::StyleInvalidation const&);
+
     Layout::NodeWithStyle* layout_node() { return static_cast<Layout::NodeWithStyle*>(Node::layout_node()); }
     Layout::NodeWithStyle const* layout_node() const { return static_cast<Layout::NodeWithStyle const*>(Node::layout_node()); }
 
@@ -271,7 +276,7 @@ protected:
 private:
     void make_html_uppercased_qualified_name();
 
-    void invalidate_style_after_attribute_change(DeprecatedFlyString const& attribute_name);
+    void invalidate_style_after_attribute_change(DeprecatedFlyString const& attribute_name, DeprecatedString const& old_value);
 
     WebIDL::ExceptionOr<JS::GCPtr<Node>> insert_adjacent(DeprecatedString const& where, JS::NonnullGCPtr<Node> node);
 
@@ -152,6 +152,11 @@ Attr const* NamedNodeMap::get_attribute(StringView qualified_name, size_t* item_
 
     // 2. Return the first attribute in element’s attribute list whose qualified name is qualifiedName; otherwise null.
     for (auto const& attribute : m_attributes) {
+        // Note: Names usually come from the same interned DeprecatedFlyString (e.g. HTML::AttributeNames), so check for that first.
+        auto const& name = attribute->name();
+        if (name.characters() == qualified_name.characters_without_null_termination() && name.length() == qualified_name.length())
+            return attribute.ptr();
+
         if (compare_as_lowercase) {
             if (attribute->name().equals_ignoring_case(qualified_name))
                 return attribute.ptr();
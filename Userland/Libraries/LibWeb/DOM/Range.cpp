@@ -61,8 +61,11 @@ Range::Range(Node& start_container, u32 start_offset, Node& end_container, u32 e
     live_ranges().set(this);
 }
 
-Range::~Range()
+Range::~Range() = default;
+
+void Range::finalize()
 {
+    Base::finalize();
     live_ranges().remove(this);
 }
 
@@ -94,6 +94,7 @@ private:
     Range(Node& start_container, u32 start_offset, Node& end_container, u32 end_offset);
 
     virtual JS::ThrowCompletionOr<void> initialize(JS::Realm&) override;
+    virtual void finalize() override;
     virtual void visit_edges(Cell::Visitor&) override;
 
     Node& root();
@@ -104,6 +104,7 @@ class ShadowStyleValue;
 class Size;
 class StringStyleValue;
 class StyleComputer;
+struct StyleInvalidation;
 class StyleProperties;
 class StyleSheet;
 class StyleSheetList;
@@ -368,6 +369,7 @@ namespace Web::Painting {
 enum class PaintPhase;
 class ButtonPaintable;
 class CheckBoxPaintable;
+class DisplayList;
 class LabelablePaintable;
 class Paintable;
 class PaintableBox;
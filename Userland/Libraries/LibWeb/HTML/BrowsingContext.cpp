@@ -239,6 +239,12 @@ BrowsingContext::BrowsingContext(Page& page, HTML::BrowsingContextContainer* con
 
 BrowsingContext::~BrowsingContext() = default;
 
+void BrowsingContext::finalize()
+{
+    Base::finalize();
+    revoke_weak_ptrs();
+}
+
 void BrowsingContext::visit_edges(Cell::Visitor& visitor)
 {
     Base::visit_edges(visitor);
@@ -268,6 +268,7 @@ public:
 private:
     explicit BrowsingContext(Page&, HTML::BrowsingContextContainer*);
 
+    virtual void finalize() override;
     virtual void visit_edges(Cell::Visitor&) override;
 
     void reset_cursor_blink_cycle();
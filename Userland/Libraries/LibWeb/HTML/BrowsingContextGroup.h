@@ -31,6 +31,7 @@ public:
 private:
     explicit BrowsingContextGroup(Web::Page&);
 
+    virtual void finalize() override;
     virtual void visit_edges(Cell::Visitor&) override;
 
     // https://html.spec.whatwg.org/multipage/browsers.html#browsing-context-group-set
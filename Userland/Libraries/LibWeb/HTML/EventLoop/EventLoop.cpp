@@ -82,6 +82,8 @@ void EventLoop::spin_until(Function<bool()> goal_condition)
 }
 
 // https://html.spec.whatwg.org/multipage/webappapis.html#event-loop-processing-model
+static constexpr double max_idle_sweep_time_in_ms = 4;
+
 void EventLoop::process()
 {
     // An event loop must continually run through the following steps for as long as it exists:
@@ -214,6 +216,12 @@ void EventLoop::process()
         //    perform the start an idle period algorithm for win with computeDeadline. [REQUESTIDLECALLBACK]
         for (auto& win : same_loop_windows())
             win->start_an_idle_period();
+
+        // NOTE: Use a bit of this idle period to destroy whatever the last garbage collection found to be dead, so that
+        //       neither allocations nor the next collection have to. This is kept short, so that new tasks aren't held up.
+        auto idle_time_left = min(compute_deadline() - HighResolutionTime::unsafe_shared_current_time(), max_idle_sweep_time_in_ms);
+        if (idle_time_left > 0)
+            vm().heap().sweep_pending_blocks(Time::from_microseconds(static_cast<i64>(idle_time_left * 1000)));
     }
 
     // FIXME: 14. If this is a worker event loop, then:
@@ -7,6 +7,7 @@
 #include <LibWeb/ARIA/Roles.h>
 #include <LibWeb/HTML/HTMLAnchorElement.h>
 #include <LibWeb/HTML/Window.h>
+#include <LibWeb/Loader/ResourceLoader.h>
 
 namespace Web::HTML {
 
@@ -28,6 +29,21 @@ JS::ThrowCompletionOr<void> HTMLAnchorElement::initialize(JS::Realm& realm)
     return {};
 }
 
+void HTMLAnchorElement::inserted()
+{
+    HTMLElement::inserted();
+
+    if (!has_attribute(HTML::AttributeNames::href) || !document().browsing_context())
+        return;
+
+    // Links are there to be followed, so look up the hosts they lead to ahead of time. The document's own host has
+    // just been looked up anyway.
+    auto url = document().parse_url(attribute(HTML::AttributeNames::href));
+    if (!url.is_valid() || (url.scheme() != "http"sv && url.scheme() != "https"sv) || url.host() == document().url().host())
+        return;
+    ResourceLoader::the().prefetch_dns(url);
+}
+
 void HTMLAnchorElement::parse_attribute(DeprecatedFlyString const& name, DeprecatedString const& value)
 {
     HTMLElement::parse_attribute(name, value);
@@ -36,6 +36,9 @@ private:
 
     void run_activation_behavior(Web::DOM::Event const&);
 
+    // ^DOM::Node
+    virtual void inserted() override;
+
     // ^DOM::Element
     virtual void parse_attribute(DeprecatedFlyString const& name, DeprecatedString const& value) override;
     virtual i32 default_tab_index_value() const override;
@@ -25,7 +25,11 @@ HTMLImageElement::HTMLImageElement(DOM::Document& document, DOM::QualifiedName q
 {
     m_image_loader.on_load = [this] {
         set_needs_style_update(true);
-        this->document().set_needs_layout();
+        // NOTE: Only the image's own box changes size, so the rest of the layout may be kept.
+        if (auto* layout_node = this->layout_node())
+            layout_node->set_needs_layout();
+        else
+            this->document().set_needs_layout();
         queue_an_element_task(HTML::Task::Source::DOMManipulation, [this] {
             dispatch_event(*DOM::Event::create(this->realm(), EventNames::load));
         });
@@ -34,7 +38,11 @@ HTMLImageElement::HTMLImageElement(DOM::Document& document, DOM::QualifiedName q
     m_image_loader.on_fail = [this] {
         dbgln("HTMLImageElement: Resource did fail: {}", src());
         set_needs_style_update(true);
-        this->document().set_needs_layout();
+        // NOTE: Only the image's own box changes size, so the rest of the layout may be kept.
+        if (auto* layout_node = this->layout_node())
+            layout_node->set_needs_layout();
+        else
+            this->document().set_needs_layout();
         queue_an_element_task(HTML::Task::Source::DOMManipulation, [this] {
             dispatch_event(*DOM::Event::create(this->realm(), EventNames::error));
         });
@@ -5,8 +5,10 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BuiltinWrappers.h>
 #include <AK/CharacterTypes.h>
 #include <AK/Debug.h>
+#include <AK/SIMDExtras.h>
 #include <AK/SourceLocation.h>
 #include <LibTextCodec/Decoder.h>
 #include <LibWeb/HTML/Parser/Entities.h>
@@ -191,17 +193,17 @@ Optional<u32> HTMLTokenizer::next_code_point()
     u32 code_point;
     // https://html.spec.whatwg.org/multipage/parsing.html#preprocessing-the-input-stream:tokenization
     // https://infra.spec.whatwg.org/#normalize-newlines
-    if (peek_code_point(0).value_or(0) == '\r' && peek_code_point(1).value_or(0) == '\n') {
+    if (*m_utf8_iterator != '\r') {
+        skip(1);
+        code_point = *m_prev_utf8_iterator;
+    } else if (peek_code_point(1).value_or(0) == '\n') {
         // replace every U+000D CR U+000A LF code point pair with a single U+000A LF code point,
         skip(2);
         code_point = '\n';
-    } else if (peek_code_point(0).value_or(0) == '\r') {
+    } else {
         // replace every remaining U+000D CR code point with a U+000A LF code point.
         skip(1);
         code_point = '\n';
-    } else {
-        skip(1);
-        code_point = *m_prev_utf8_iterator;
     }
 
     dbgln_if(TOKENIZER_TRACE_DEBUG, "(Tokenizer) Next code_point: {}", code_point);
@@ -227,6 +229,63 @@ void HTMLTokenizer::skip(size_t count)
     }
 }
 
+// Returns the number of bytes at the start of the given ones that come before the first one of the four stop bytes.
+static size_t count_bytes_before_any_of(ReadonlyBytes bytes, u8 a, u8 b, u8 c, u8 d)
+{
+    using AK::SIMD::i8x16;
+    using AK::SIMD::u8x16;
+
+    size_t offset = 0;
+    for (; offset + sizeof(u8x16) <= bytes.size(); offset += sizeof(u8x16)) {
+        u8x16 chunk;
+        __builtin_memcpy(&chunk, bytes.offset(offset), sizeof(chunk));
+        auto matches = (i8x16)((chunk == a) | (chunk == b) | (chunk == c) | (chunk == d));
+        if (auto bits = AK::SIMD::maskbits(matches); bits != 0)
+            return offset + count_trailing_zeroes(static_cast<u32>(bits));
+    }
+    for (; offset < bytes.size(); ++offset) {
+        if (first_is_one_of(bytes[offset], a, b, c, d))
+            return offset;
+    }
+    return offset;
+}
+
+StringView HTMLTokenizer::consume_bytes_before_any_of(u8 a, u8 b, u8 c, u8 d, size_t max_length)
+{
+    // NOTE: Newlines aren't normalized here, so a '\r' has to end the run.
+    VERIFY(first_is_one_of('\r', a, b, c, d));
+
+    auto start = m_utf8_view.byte_offset_of(m_utf8_iterator);
+    auto remaining_bytes = m_utf8_view.as_string().bytes().slice(start);
+    auto length = count_bytes_before_any_of(remaining_bytes.trim(max_length), a, b, c, d);
+    // The stop bytes are all ASCII, so the run can only end in the middle of a code point if it was cut short.
+    while (length > 0 && length < remaining_bytes.size() && (remaining_bytes[length] & 0xC0) == 0x80)
+        --length;
+    if (length == 0)
+        return {};
+
+    auto run = StringView { remaining_bytes.trim(length) };
+    if (!m_source_positions.is_empty()) {
+        auto position = m_source_positions.last();
+        for (auto byte : run.bytes()) {
+            if (byte == '\n') {
+                position.column = 0;
+                position.line++;
+            } else if ((byte & 0xC0) != 0x80) {
+                position.column++;
+            }
+        }
+        m_source_positions.append(position);
+    }
+
+    auto last_code_point_start = length - 1;
+    while (last_code_point_start > 0 && (run[last_code_point_start] & 0xC0) == 0x80)
+        --last_code_point_start;
+    m_prev_utf8_iterator = m_utf8_view.iterator_at_byte_offset_without_validation(start + last_code_point_start);
+    m_utf8_iterator = m_utf8_view.iterator_at_byte_offset_without_validation(start + length);
+    return run;
+}
+
 Optional<u32> HTMLTokenizer::peek_code_point(size_t offset) const
 {
     auto it = m_utf8_iterator;
@@ -286,6 +345,16 @@ _StartOfFunction:
                 }
                 ANYTHING_ELSE
                 {
+                    // NOTE: Text comes in long runs, so the rest of the run is tokenized in one go instead of returning to the
+                    //       state machine for every code point. The parser has to be able to stop at the insertion point though.
+                    if (!is_insertion_point_defined()) {
+                        create_new_token(HTMLToken::Type::Character);
+                        m_current_token.set_code_point(current_input_character.value());
+                        m_queued_tokens.enqueue(move(m_current_token));
+                        for (auto code_point : Utf8View { consume_bytes_before_any_of('<', '&', '\r', 0, bulk_text_chunk_size) })
+                            m_queued_tokens.enqueue(HTMLToken::make_character(code_point));
+                        return m_queued_tokens.dequeue();
+                    }
                     EMIT_CURRENT_CHARACTER;
                 }
             }
@@ -1258,6 +1327,7 @@ _StartOfFunction:
                 ANYTHING_ELSE
                 {
                     m_current_builder.append_code_point(current_input_character.value());
+                    m_current_builder.append(consume_bytes_before_any_of('"', '&', '\r', 0));
                     continue;
                 }
             }
@@ -1290,6 +1360,7 @@ _StartOfFunction:
                 ANYTHING_ELSE
                 {
                     m_current_builder.append_code_point(current_input_character.value());
+                    m_current_builder.append(consume_bytes_before_any_of('\'', '&', '\r', 0));
                     continue;
                 }
             }
@@ -124,6 +124,8 @@ public:
     bool is_blocked() const { return m_blocked; }
 
     DeprecatedString source() const { return m_decoded_input; }
+    // The part of the input that hasn't been tokenized yet.
+    StringView unprocessed_input() const { return m_decoded_input.substring_view(m_utf8_view.byte_offset_of(m_utf8_iterator)); }
 
     void insert_input_at_insertion_point(DeprecatedString const& input);
     void insert_eof();
@@ -150,6 +152,8 @@ private:
     void skip(size_t count);
     Optional<u32> next_code_point();
     Optional<u32> peek_code_point(size_t offset) const;
+    // Consumes the code points up to the first of the given ASCII bytes (or up to max_length bytes) in one go.
+    StringView consume_bytes_before_any_of(u8, u8, u8, u8, size_t max_length = NumericLimits<size_t>::max());
     bool consume_next_if_match(StringView, CaseSensitivity = CaseSensitivity::CaseSensitive);
     void create_new_token(HTMLToken::Type);
     bool current_end_tag_token_is_appropriate() const;
@@ -205,6 +209,8 @@ private:
     bool m_has_emitted_eof { false };
 
     Queue<HTMLToken> m_queued_tokens;
+    // How many bytes of text the data state turns into character tokens at once.
+    static constexpr size_t bulk_text_chunk_size = 256;
 
     u32 m_character_reference_code { 0 };
 
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibWeb/DOM/Document.h>
+#include <LibWeb/HTML/AttributeNames.h>
+#include <LibWeb/HTML/HTMLBaseElement.h>
+#include <LibWeb/HTML/Parser/HTMLToken.h>
+#include <LibWeb/HTML/Parser/HTMLTokenizer.h>
+#include <LibWeb/HTML/Parser/SpeculativeHTMLParser.h>
+#include <LibWeb/HTML/TagNames.h>
+#include <LibWeb/Infra/CharacterTypes.h>
+#include <LibWeb/Loader/LoadRequest.h>
+#include <LibWeb/Loader/ResourceLoader.h>
+
+namespace Web::HTML {
+
+SpeculativeHTMLParser::SpeculativeHTMLParser(DOM::Document& document, bool scripting_enabled)
+    : m_document(document)
+    , m_scripting_enabled(scripting_enabled)
+    , m_base_url(document.base_url())
+    , m_has_base_url_from_base_element(document.first_base_element_with_href_in_tree_order())
+{
+}
+
+static bool has_attribute(HTMLToken const& token, DeprecatedFlyString const& name)
+{
+    bool found = false;
+    token.for_each_attribute([&](auto const& attribute) {
+        if (name == attribute.local_name) {
+            found = true;
+            return IterationDecision::Break;
+        }
+        return IterationDecision::Continue;
+    });
+    return found;
+}
+
+void SpeculativeHTMLParser::run(StringView input)
+{
+    // NOTE: The input has already been decoded by the parser's own tokenizer.
+    HTMLTokenizer tokenizer { input, "utf-8" };
+    for (;;) {
+        auto token = tokenizer.next_token();
+        if (!token.has_value() || token->is_end_of_file())
+            return;
+        if (token->is_start_tag()) {
+            // NOTE: The rest of the input is plain text after this, so there's nothing more to find.
+            if (token->tag_name() == HTML::TagNames::plaintext)
+                return;
+            process_start_tag(*token, tokenizer);
+        } else if (token->is_end_tag() && token->tag_name() == HTML::TagNames::template_) {
+            if (m_template_depth > 0)
+                --m_template_depth;
+        }
+    }
+}
+
+void SpeculativeHTMLParser::process_start_tag(HTMLToken& token, HTMLTokenizer& tokenizer)
+{
+    auto const& tag_name = token.tag_name();
+
+    // NOTE: Without a tree builder, the tokenizer has to be told which elements' contents aren't markup.
+    //       This mirrors what the parser does for the same start tags.
+    if (tag_name == HTML::TagNames::textarea || tag_name == HTML::TagNames::title)
+        tokenizer.switch_to(HTMLTokenizer::State::RCDATA);
+    else if (tag_name.is_one_of(HTML::TagNames::style, HTML::TagNames::xmp, HTML::TagNames::iframe, HTML::TagNames::noembed, HTML::TagNames::noframes)
+        || (tag_name == HTML::TagNames::noscript && m_scripting_enabled))
+        tokenizer.switch_to(HTMLTokenizer::State::RAWTEXT);
+
+    if (tag_name == HTML::TagNames::template_) {
+        ++m_template_depth;
+        return;
+    }
+
+    // NOTE: A template's contents aren't rendered, so nothing it refers to is fetched until it gets used.
+    if (m_template_depth > 0) {
+        if (tag_name == HTML::TagNames::script)
+            tokenizer.switch_to(HTMLTokenizer::State::ScriptData);
+        return;
+    }
+
+    if (tag_name == HTML::TagNames::base) {
+        // NOTE: Only the first base element with an href attribute counts.
+        if (has_attribute(token, HTML::AttributeNames::href) && !m_has_base_url_from_base_element) {
+            m_base_url = m_document.fallback_base_url().complete_url(token.attribute(HTML::AttributeNames::href));
+            m_has_base_url_from_base_element = true;
+        }
+        return;
+    }
+
+    if (tag_name == HTML::TagNames::script) {
+        tokenizer.switch_to(HTMLTokenizer::State::ScriptData);
+        // NOTE: Module scripts are fetched without going through the resource cache, and nomodule scripts aren't run at all.
+        if (token.attribute(HTML::AttributeNames::type).equals_ignoring_case("module"sv) || has_attribute(token, HTML::AttributeNames::nomodule))
+            return;
+        speculative_fetch(token.attribute(HTML::AttributeNames::src), Resource::Type::Generic);
+        return;
+    }
+
+    if (tag_name == HTML::TagNames::link) {
+        bool is_stylesheet = false;
+        bool is_alternate = false;
+        for (auto keyword : token.attribute(HTML::AttributeNames::rel).split_view_if([](char c) { return Infra::is_ascii_whitespace(c); })) {
+            if (keyword.equals_ignoring_case("stylesheet"sv))
+                is_stylesheet = true;
+            else if (keyword.equals_ignoring_case("alternate"sv))
+                is_alternate = true;
+        }
+        if (is_stylesheet && !is_alternate)
+            speculative_fetch(token.attribute(HTML::AttributeNames::href), Resource::Type::Generic);
+        return;
+    }
+
+    if (tag_name == HTML::TagNames::img) {
+        // NOTE: With a srcset, the image that ends up being used depends on the layout, so it's left alone.
+        if (!has_attribute(token, HTML::AttributeNames::srcset))
+            speculative_fetch(token.attribute(HTML::AttributeNames::src), Resource::Type::Image);
+        return;
+    }
+}
+
+void SpeculativeHTMLParser::speculative_fetch(StringView url_string, Resource::Type type)
+{
+    if (url_string.is_empty())
+        return;
+    auto url = m_base_url.complete_url(url_string);
+    // NOTE: These aren't cached, so the element would end up loading them again.
+    if (!url.is_valid() || url.scheme().is_one_of("file"sv, "data"sv))
+        return;
+
+    // NOTE: This must be the same request that the element makes, so that it finds the resource in the cache.
+    auto request = LoadRequest::create_for_url_on_page(url, m_document.page());
+    (void)ResourceLoader::the().load_resource(type, request);
+}
+
+}
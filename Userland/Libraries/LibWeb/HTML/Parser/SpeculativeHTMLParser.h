@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/StringView.h>
+#include <AK/URL.h>
+#include <LibWeb/Forward.h>
+#include <LibWeb/Loader/Resource.h>
+
+namespace Web::HTML {
+
+class HTMLToken;
+class HTMLTokenizer;
+
+// https://html.spec.whatwg.org/multipage/parsing.html#speculative-html-parsing
+// Looks ahead in the input while the parser waits for a script, so that the resources it refers to are fetched in the
+// meantime rather than one after another. Nothing is added to the document: the fetches end up in the ResourceLoader's
+// cache, which is where the elements that need them will find them once the parser gets there.
+// FIXME: This runs to the end of the input before the parser starts waiting, rather than in parallel.
+class SpeculativeHTMLParser {
+public:
+    SpeculativeHTMLParser(DOM::Document&, bool scripting_enabled);
+
+    void run(StringView input);
+
+private:
+    void process_start_tag(HTMLToken&, HTMLTokenizer&);
+    void speculative_fetch(StringView url, Resource::Type);
+
+    DOM::Document& m_document;
+    bool m_scripting_enabled { true };
+    AK::URL m_base_url;
+    bool m_has_base_url_from_base_element { false };
+    size_t m_template_depth { 0 };
+};
+
+}
@@ -120,6 +120,7 @@ struct EnvironmentSettingsObject
 protected:
     explicit EnvironmentSettingsObject(NonnullOwnPtr<JS::ExecutionContext>);
 
+    virtual void finalize() override;
     virtual void visit_edges(Cell::Visitor&) override;
 
 private:
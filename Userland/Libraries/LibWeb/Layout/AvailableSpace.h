@@ -45,6 +45,8 @@ public:
         return m_value;
     }
 
+    bool operator==(AvailableSize const& other) const { return m_type == other.m_type && m_value == other.m_value; }
+
     DeprecatedString to_deprecated_string() const;
 
 private:
@@ -65,6 +67,8 @@ public:
     AvailableSize width;
     AvailableSize height;
 
+    bool operator==(AvailableSpace const& other) const { return width == other.width && height == other.height; }
+
     DeprecatedString to_deprecated_string() const;
 };
 
@@ -499,7 +499,7 @@ void BlockFormattingContext::layout_block_level_box(Box const& box, BlockContain
             // Margins of elements that establish new formatting contexts do not collapse with their in-flow children
             m_margin_state.reset();
 
-            independent_formatting_context->run(box, layout_mode, box_state.available_inner_space_or_constraints_from(available_space));
+            independent_formatting_context = run_or_reuse_previous_layout(independent_formatting_context.release_nonnull(), box, layout_mode, box_state.available_inner_space_or_constraints_from(available_space));
         } else {
             if (box.children_are_inline()) {
                 layout_inline_children(verify_cast<BlockContainer>(box), layout_mode, box_state.available_inner_space_or_constraints_from(available_space));
@@ -201,11 +201,99 @@ OwnPtr<FormattingContext> FormattingContext::layout_inside(Box const& child_box,
 
     auto independent_formatting_context = create_independent_formatting_context_if_needed(m_state, child_box);
     if (independent_formatting_context)
-        independent_formatting_context->run(child_box, layout_mode, available_space);
-    else
-        run(child_box, layout_mode, available_space);
+        return run_or_reuse_previous_layout(independent_formatting_context.release_nonnull(), child_box, layout_mode, available_space);
+
+    run(child_box, layout_mode, available_space);
+    return {};
+}
+
+static bool has_out_of_flow_descendants(Box const& box)
+{
+    bool found = false;
+    box.for_each_in_subtree([&](auto& node) {
+        if (node.is_absolutely_positioned()) {
+            found = true;
+            return IterationDecision::Break;
+        }
+        return IterationDecision::Continue;
+    });
+    return found;
+}
+
+// Stands in for the formatting context of a box whose inside layout was copied from the previous layout.
+class ReusedLayoutFormattingContext final : public FormattingContext {
+public:
+    ReusedLayoutFormattingContext(Type type, LayoutState& state, Box const& box, LayoutState::InsideLayout const& inside_layout)
+        : FormattingContext(type, state, box)
+        , m_automatic_content_width(inside_layout.automatic_content_width)
+        , m_automatic_content_height(inside_layout.automatic_content_height)
+    {
+    }
+
+    virtual CSSPixels automatic_content_width() const override { return m_automatic_content_width; }
+    virtual CSSPixels automatic_content_height() const override { return m_automatic_content_height; }
+    virtual void run(Box const&, LayoutMode, AvailableSpace const&) override { }
+
+private:
+    CSSPixels m_automatic_content_width { 0 };
+    CSSPixels m_automatic_content_height { 0 };
+};
+
+OwnPtr<FormattingContext> FormattingContext::run_or_reuse_previous_layout(NonnullOwnPtr<FormattingContext> context, Box const& box, LayoutMode layout_mode, AvailableSpace const& available_space)
+{
+    // NOTE: Only the document's layout records how boxes were laid out, as only its results end up in the layout tree.
+    //       Intrinsic sizing and the layout of throwaway states are left alone.
+    bool is_recorded = layout_mode == LayoutMode::Normal && &m_state == &m_state.m_root && m_state.is_document_layout;
+    if (!is_recorded) {
+        context->run(box, layout_mode, available_space);
+        return context;
+    }
+
+    auto& box_state = m_state.get_mutable(box);
+
+    // The previous results still hold if nothing in the subtree was marked for layout, and the box is laid out in the same space
+    // with the same size as before. Absolutely positioned descendants are laid out relative to boxes that may be outside the subtree,
+    // so they rule out reusing anything.
+    if (auto* previous_layout = m_state.previous_layout; previous_layout && !box.needs_layout() && !box.child_needs_layout()) {
+        auto it = m_state.inside_layouts.find(&box);
+        if (it != m_state.inside_layouts.end()) {
+            auto const& inside_layout = *it->value;
+            if (inside_layout.available_space == available_space
+                && inside_layout.content_width_before == box_state.content_width()
+                && inside_layout.content_height_before == box_state.content_height()
+                && inside_layout.had_definite_width_before == box_state.has_definite_width()
+                && inside_layout.had_definite_height_before == box_state.has_definite_height()
+                && !has_out_of_flow_descendants(box)) {
+                box.for_each_in_subtree([&](auto& node) {
+                    auto const& previous_used_values = previous_layout->used_values_per_layout_node[node.serial_id()];
+                    if (previous_used_values)
+                        m_state.used_values_per_layout_node[node.serial_id()] = adopt_own(*new LayoutState::UsedValues(*previous_used_values));
+                    else
+                        m_state.used_values_per_layout_node[node.serial_id()] = nullptr;
+                    return IterationDecision::Continue;
+                });
+                box_state.copy_inside_layout_results_from(inside_layout.results);
+                return make<ReusedLayoutFormattingContext>(context->type(), m_state, box, inside_layout);
+            }
+        }
+    }
 
-    return independent_formatting_context;
+    auto inside_layout = make<LayoutState::InsideLayout>(LayoutState::InsideLayout {
+        .available_space = available_space,
+        .content_width_before = box_state.content_width(),
+        .content_height_before = box_state.content_height(),
+        .had_definite_width_before = box_state.has_definite_width(),
+        .had_definite_height_before = box_state.has_definite_height(),
+        .results = {},
+    });
+
+    context->run(box, layout_mode, available_space);
+
+    inside_layout->results = box_state;
+    inside_layout->automatic_content_width = context->automatic_content_width();
+    inside_layout->automatic_content_height = context->automatic_content_height();
+    m_state.inside_layouts.set(&box, move(inside_layout));
+    return context;
 }
 
 CSSPixels FormattingContext::greatest_child_width(Box const& box)
@@ -89,6 +89,7 @@ protected:
     static bool should_treat_height_as_auto(Box const&, AvailableSpace const&);
 
     OwnPtr<FormattingContext> layout_inside(Box const&, LayoutMode, AvailableSpace const&);
+    OwnPtr<FormattingContext> run_or_reuse_previous_layout(NonnullOwnPtr<FormattingContext>, Box const&, LayoutMode, AvailableSpace const&);
     void compute_inset(Box const& box);
 
     struct SpaceUsedByFloats {
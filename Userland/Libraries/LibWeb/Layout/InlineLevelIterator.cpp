@@ -132,19 +132,18 @@ Optional<InlineLevelIterator::Item> InlineLevelIterator::next(CSSPixels availabl
         if (!m_text_node_context.has_value())
             enter_text_node(text_node);
 
-        auto chunk_opt = m_text_node_context->next_chunk;
-        if (!chunk_opt.has_value()) {
+        if (m_text_node_context->next_chunk_index == m_text_node_context->chunks.size()) {
             m_text_node_context = {};
             skip_to_next();
             return next(available_width);
         }
 
-        m_text_node_context->next_chunk = m_text_node_context->chunk_iterator.next();
-        if (!m_text_node_context->next_chunk.has_value())
+        auto const& measured_chunk = m_text_node_context->chunks[m_text_node_context->next_chunk_index++];
+        if (m_text_node_context->next_chunk_index == m_text_node_context->chunks.size())
             m_text_node_context->is_last_chunk = true;
 
-        auto& chunk = chunk_opt.value();
-        CSSPixels chunk_width = text_node.font().width(chunk.view) + text_node.font().glyph_spacing();
+        auto const& chunk = measured_chunk.chunk;
+        CSSPixels chunk_width = measured_chunk.width;
 
         if (m_text_node_context->do_respect_linebreaks && chunk.has_breaking_newline) {
             return Item {
@@ -258,7 +257,7 @@ void InlineLevelIterator::enter_text_node(Layout::TextNode const& text_node)
     if (text_node.dom_node().is_editable() && !text_node.dom_node().is_uninteresting_whitespace_node())
         do_collapse = false;
 
-    // FIXME: The const_cast here is gross.
+    // FIXME: The const_casts here are gross.
     const_cast<TextNode&>(text_node).compute_text_for_rendering(do_collapse);
 
     m_text_node_context = TextNodeContext {
@@ -267,9 +266,8 @@ void InlineLevelIterator::enter_text_node(Layout::TextNode const& text_node)
         .do_respect_linebreaks = do_respect_linebreaks,
         .is_first_chunk = true,
         .is_last_chunk = false,
-        .chunk_iterator = TextNode::ChunkIterator { text_node.text_for_rendering(), do_wrap_lines, do_respect_linebreaks, text_node.is_generated() && text_node.text_for_rendering().is_empty() },
+        .chunks = const_cast<TextNode&>(text_node).measured_chunks(do_wrap_lines, do_respect_linebreaks).span(),
     };
-    m_text_node_context->next_chunk = m_text_node_context->chunk_iterator.next();
 }
 
 void InlineLevelIterator::add_extra_box_model_metrics_to_item(Item& item, bool add_leading_metrics, bool add_trailing_metrics)
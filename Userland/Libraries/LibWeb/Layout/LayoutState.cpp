@@ -78,7 +78,8 @@ void LayoutState::commit()
             auto& paint_box = const_cast<Painting::PaintableBox&>(*box.paint_box());
             paint_box.set_offset(used_values.offset);
             paint_box.set_content_size(used_values.content_width(), used_values.content_height());
-            paint_box.set_overflow_data(move(used_values.overflow_data));
+            // NOTE: Line boxes and overflow data are copied rather than moved, as the next layout may reuse this state.
+            paint_box.set_overflow_data(used_values.overflow_data);
             paint_box.set_containing_line_box_fragment(used_values.containing_line_box_fragment);
 
             if (is<Layout::BlockContainer>(box)) {
@@ -88,7 +89,7 @@ void LayoutState::commit()
                             text_nodes.set(static_cast<Layout::TextNode*>(const_cast<Layout::Node*>(&fragment.layout_node())));
                     }
                 }
-                static_cast<Painting::PaintableWithLines&>(paint_box).set_line_boxes(move(used_values.line_boxes));
+                static_cast<Painting::PaintableWithLines&>(paint_box).set_line_boxes(Vector<LineBox>(used_values.line_boxes));
             }
         }
     }
@@ -97,6 +98,16 @@ void LayoutState::commit()
         text_node->set_paintable(text_node->create_paintable());
 }
 
+void LayoutState::take_intrinsic_sizes_of_unchanged_boxes_from(LayoutState& other)
+{
+    for (auto& it : other.intrinsic_sizes) {
+        if (it.key->needs_layout() || it.key->child_needs_layout())
+            continue;
+        intrinsic_sizes.set(it.key, move(it.value));
+    }
+    other.intrinsic_sizes.clear();
+}
+
 CSSPixels box_baseline(LayoutState const& state, Box const& box)
 {
     auto const& box_state = state.get(box);
@@ -336,6 +347,16 @@ void LayoutState::UsedValues::set_content_height(CSSPixels height)
     m_has_definite_height = true;
 }
 
+void LayoutState::UsedValues::copy_inside_layout_results_from(UsedValues const& other)
+{
+    m_content_width = other.m_content_width;
+    m_content_height = other.m_content_height;
+    m_has_definite_width = other.m_has_definite_width;
+    m_has_definite_height = other.m_has_definite_height;
+    line_boxes = other.line_boxes;
+    m_floating_descendants = other.m_floating_descendants;
+}
+
 void LayoutState::UsedValues::set_temporary_content_width(CSSPixels width)
 {
     m_content_width = width;
@@ -8,6 +8,7 @@
 
 #include <AK/HashMap.h>
 #include <LibGfx/Point.h>
+#include <LibWeb/Layout/AvailableSpace.h>
 #include <LibWeb/Layout/Box.h>
 #include <LibWeb/Layout/LineBox.h>
 #include <LibWeb/Painting/PaintableBox.h>
@@ -127,6 +128,9 @@ struct LayoutState {
         void add_floating_descendant(Box const& box) { m_floating_descendants.set(&box); }
         auto const& floating_descendants() const { return m_floating_descendants; }
 
+        // Takes over what laying out the inside of a box determined about the box itself.
+        void copy_inside_layout_results_from(UsedValues const&);
+
     private:
         AvailableSize available_width_inside() const;
         AvailableSize available_height_inside() const;
@@ -173,6 +177,33 @@ struct LayoutState {
 
     HashMap<NodeWithStyleAndBoxModelMetrics const*, NonnullOwnPtr<IntrinsicSizes>> mutable intrinsic_sizes;
 
+    // Moves over the cached intrinsic sizes of boxes that haven't been marked for layout since the previous layout.
+    void take_intrinsic_sizes_of_unchanged_boxes_from(LayoutState&);
+
+    // What went into and came out of the last layout of a box's inside in the document's layout.
+    // If the box and its descendants haven't changed since, and it's laid out the same way again,
+    // the result is copied from the previous layout instead.
+    struct InsideLayout {
+        AvailableSpace available_space;
+        CSSPixels content_width_before { 0 };
+        CSSPixels content_height_before { 0 };
+        bool had_definite_width_before { false };
+        bool had_definite_height_before { false };
+
+        UsedValues results;
+        CSSPixels automatic_content_width { 0 };
+        CSSPixels automatic_content_height { 0 };
+    };
+
+    // NOTE: These are only recorded in the document's layout, and carried over from one layout to the next.
+    HashMap<Box const*, NonnullOwnPtr<InsideLayout>> inside_layouts;
+
+    // Set for the layout that is committed to the document's layout tree.
+    bool is_document_layout { false };
+
+    // The committed state of the document's previous layout, if its results may be reused.
+    LayoutState const* previous_layout { nullptr };
+
     LayoutState const* m_parent { nullptr };
     LayoutState const& m_root;
 };
@@ -32,6 +32,12 @@ Node::Node(DOM::Document& document, DOM::Node* node)
 
 Node::~Node() = default;
 
+void Node::finalize()
+{
+    Base::finalize();
+    revoke_weak_ptrs();
+}
+
 void Node::visit_edges(Cell::Visitor& visitor)
 {
     Base::visit_edges(visitor);
@@ -164,6 +170,25 @@ InitialContainingBlock& Node::root()
     return *document().layout_node();
 }
 
+void Node::set_needs_layout()
+{
+    m_needs_layout = true;
+    for (auto* ancestor = parent(); ancestor && !ancestor->m_child_needs_layout; ancestor = ancestor->parent())
+        ancestor->m_child_needs_layout = true;
+    document().set_needs_layout_of_marked_nodes({});
+}
+
+void Node::clear_needs_layout_in_inclusive_subtree()
+{
+    m_needs_layout = false;
+    if (!m_child_needs_layout)
+        return;
+    m_child_needs_layout = false;
+    for_each_child([](auto& child) {
+        child.clear_needs_layout_in_inclusive_subtree();
+    });
+}
+
 void Node::set_needs_display()
 {
     auto* containing_block = this->containing_block();
@@ -556,7 +581,8 @@ void NodeWithStyle::apply_style(const CSS::StyleProperties& computed_style)
     computed_values.set_transformations(computed_style.transformations());
     computed_values.set_transform_origin(computed_style.transform_origin());
 
-    auto do_border_style = [&](CSS::BorderData& border, CSS::PropertyID width_property, CSS::PropertyID color_property, CSS::PropertyID style_property) {
+    auto do_border_style = [&](CSS::PropertyID width_property, CSS::PropertyID color_property, CSS::PropertyID style_property) {
+        CSS::BorderData border;
         // FIXME: The default border color value is `currentcolor`, but since we can't resolve that easily,
         //        we just manually grab the value from `color`. This makes it dependent on `color` being
         //        specified first, so it's far from ideal.
@@ -595,12 +621,13 @@ void NodeWithStyle::apply_style(const CSS::StyleProperties& computed_style)
 
             border.width = resolve_border_width();
         }
+        return border;
     };
 
-    do_border_style(computed_values.border_left(), CSS::PropertyID::BorderLeftWidth, CSS::PropertyID::BorderLeftColor, CSS::PropertyID::BorderLeftStyle);
-    do_border_style(computed_values.border_top(), CSS::PropertyID::BorderTopWidth, CSS::PropertyID::BorderTopColor, CSS::PropertyID::BorderTopStyle);
-    do_border_style(computed_values.border_right(), CSS::PropertyID::BorderRightWidth, CSS::PropertyID::BorderRightColor, CSS::PropertyID::BorderRightStyle);
-    do_border_style(computed_values.border_bottom(), CSS::PropertyID::BorderBottomWidth, CSS::PropertyID::BorderBottomColor, CSS::PropertyID::BorderBottomStyle);
+    computed_values.set_border_left(do_border_style(CSS::PropertyID::BorderLeftWidth, CSS::PropertyID::BorderLeftColor, CSS::PropertyID::BorderLeftStyle));
+    computed_values.set_border_top(do_border_style(CSS::PropertyID::BorderTopWidth, CSS::PropertyID::BorderTopColor, CSS::PropertyID::BorderTopStyle));
+    computed_values.set_border_right(do_border_style(CSS::PropertyID::BorderRightWidth, CSS::PropertyID::BorderRightColor, CSS::PropertyID::BorderRightStyle));
+    computed_values.set_border_bottom(do_border_style(CSS::PropertyID::BorderBottomWidth, CSS::PropertyID::BorderBottomColor, CSS::PropertyID::BorderBottomStyle));
 
     computed_values.set_content(computed_style.content());
     computed_values.set_grid_template_columns(computed_style.grid_template_columns());
@@ -129,6 +129,13 @@ public:
 
     virtual void set_needs_display();
 
+    // Nodes start out needing layout. Once laid out, a node only needs it again if it was marked with set_needs_layout(),
+    // and the next layout can keep the results for subtrees that contain no marked nodes.
+    bool needs_layout() const { return m_needs_layout; }
+    bool child_needs_layout() const { return m_child_needs_layout; }
+    void set_needs_layout();
+    void clear_needs_layout_in_inclusive_subtree();
+
     bool children_are_inline() const { return m_children_are_inline; }
     void set_children_are_inline(bool value) { m_children_are_inline = value; }
 
@@ -148,6 +155,7 @@ public:
 protected:
     Node(DOM::Document&, DOM::Node*);
 
+    virtual void finalize() override;
     virtual void visit_edges(Cell::Visitor&) override;
 
 private:
@@ -164,6 +172,8 @@ private:
     bool m_has_style { false };
     bool m_visible { true };
     bool m_children_are_inline { false };
+    bool m_needs_layout { true };
+    bool m_child_needs_layout { true };
     SelectionState m_selection_state { SelectionState::None };
 
     bool m_is_flex_item { false };
@@ -188,6 +198,7 @@ public:
     JS::NonnullGCPtr<NodeWithStyle> create_anonymous_wrapper() const;
 
     void reset_table_box_computed_values_used_by_wrapper_to_init_values();
+    void share_inherited_values_with(NodeWithStyle const& parent) { m_computed_values.share_inherited_values_with(parent.m_computed_values); }
 
 protected:
     NodeWithStyle(DOM::Document&, DOM::Node*, NonnullRefPtr<CSS::StyleProperties>);
@@ -41,10 +41,25 @@ static ErrorOr<DeprecatedString> apply_text_transform(DeprecatedString const& st
     return string;
 }
 
+void TextNode::invalidate_text_for_rendering()
+{
+    m_text_for_rendering_key = {};
+    m_measured_chunks_key = {};
+    m_measured_chunks.clear();
+}
+
 // NOTE: This collapses whitespace into a single ASCII space if collapse is true.
 void TextNode::compute_text_for_rendering(bool collapse)
 {
-    auto data = apply_text_transform(dom_node().data(), computed_values().text_transform()).release_value_but_fixme_should_propagate_errors();
+    TextForRenderingKey key { collapse, computed_values().text_transform() };
+    if (m_text_for_rendering_key == key)
+        return;
+    // The chunks point into the old text.
+    m_text_for_rendering_key = key;
+    m_measured_chunks_key = {};
+    m_measured_chunks.clear();
+
+    auto data = apply_text_transform(dom_node().data(), key.text_transform).release_value_but_fixme_should_propagate_errors();
 
     if (dom_node().is_password_input()) {
         m_text_for_rendering = DeprecatedString::repeated('*', data.length());
@@ -101,6 +116,24 @@ void TextNode::compute_text_for_rendering(bool collapse)
     m_text_for_rendering = builder.to_deprecated_string();
 }
 
+Vector<TextNode::MeasuredChunk> const& TextNode::measured_chunks(bool wrap_lines, bool respect_linebreaks)
+{
+    VERIFY(m_text_for_rendering_key.has_value());
+
+    MeasuredChunksKey key { wrap_lines, respect_linebreaks, &font() };
+    if (m_measured_chunks_key == key)
+        return m_measured_chunks;
+    m_measured_chunks_key = key;
+    m_measured_chunks.clear_with_capacity();
+
+    ChunkIterator iterator { m_text_for_rendering, wrap_lines, respect_linebreaks, is_generated() && m_text_for_rendering.is_empty() };
+    for (auto chunk = iterator.next(); chunk.has_value(); chunk = iterator.next()) {
+        CSSPixels width = font().width(chunk->view) + font().glyph_spacing();
+        m_measured_chunks.append({ chunk.release_value(), width });
+    }
+    return m_measured_chunks;
+}
+
 TextNode::ChunkIterator::ChunkIterator(StringView text, bool wrap_lines, bool respect_linebreaks, bool is_generated_empty_string)
     : m_wrap_lines(wrap_lines)
     , m_respect_linebreaks(respect_linebreaks)
@@ -48,7 +48,17 @@ public:
         Utf8View::Iterator m_iterator;
     };
 
+    struct MeasuredChunk {
+        Chunk chunk;
+        CSSPixels width { 0 };
+    };
+
+    // NOTE: Both of these are kept across layouts until the text changes, or they're asked for with different
+    //       white-space handling or font. Relayouts (e.g. after a resize) only have to break the cached chunks into lines.
     void compute_text_for_rendering(bool collapse);
+    Vector<MeasuredChunk> const& measured_chunks(bool wrap_lines, bool respect_linebreaks);
+
+    void invalidate_text_for_rendering();
 
     virtual JS::GCPtr<Painting::Paintable> create_paintable() const override;
 
@@ -56,6 +66,24 @@ private:
     virtual bool is_text_node() const final { return true; }
 
     DeprecatedString m_text_for_rendering;
+
+    struct TextForRenderingKey {
+        bool collapse { false };
+        CSS::TextTransform text_transform {};
+
+        bool operator==(TextForRenderingKey const&) const = default;
+    };
+    Optional<TextForRenderingKey> m_text_for_rendering_key;
+
+    struct MeasuredChunksKey {
+        bool wrap_lines { false };
+        bool respect_linebreaks { false };
+        Gfx::Font const* font { nullptr };
+
+        bool operator==(MeasuredChunksKey const&) const = default;
+    };
+    Optional<MeasuredChunksKey> m_measured_chunks_key;
+    Vector<MeasuredChunk> m_measured_chunks;
 };
 
 template<>
@@ -239,6 +239,9 @@ ErrorOr<void> TreeBuilder::create_layout_tree(DOM::Node& dom_node, TreeBuilder::
         insert_node_into_inline_or_block_ancestor(*layout_node, display, AppendOrPrepend::Append);
     }
 
+    if (is<NodeWithStyle>(*layout_node) && !m_ancestor_stack.is_empty())
+        static_cast<NodeWithStyle&>(*layout_node).share_inherited_values_with(m_ancestor_stack.last());
+
     auto* shadow_root = is<DOM::Element>(dom_node) ? verify_cast<DOM::Element>(dom_node).shadow_root_internal() : nullptr;
 
     if ((dom_node.has_children() || shadow_root) && layout_node->can_have_children()) {
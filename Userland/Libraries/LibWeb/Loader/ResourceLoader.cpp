@@ -62,6 +62,8 @@ ResourceLoader::ResourceLoader(NonnullRefPtr<ResourceLoaderConnector> connector)
 {
 }
 
+static constexpr size_t max_hosts_with_prefetched_dns = 256;
+
 void ResourceLoader::prefetch_dns(AK::URL const& url)
 {
     if (ContentFilter::the().is_filtered(url)) {
@@ -69,6 +71,14 @@ void ResourceLoader::prefetch_dns(AK::URL const& url)
         return;
     }
 
+    // Pages tend to link to the same few hosts over and over, and asking for them once is enough to have their
+    // addresses at hand. Forgetting about them every now and then keeps hosts that were asked for long ago fresh.
+    if (m_hosts_with_prefetched_dns.size() >= max_hosts_with_prefetched_dns)
+        m_hosts_with_prefetched_dns.clear();
+    if (m_hosts_with_prefetched_dns.contains(url.host()))
+        return;
+    m_hosts_with_prefetched_dns.set(url.host());
+
     m_connector->prefetch_dns(url);
 }
 
@@ -286,7 +296,7 @@ void ResourceLoader::load(LoadRequest& request, Function<void(ReadonlyBytes, Has
 
         HashMap<DeprecatedString, DeprecatedString> headers;
         headers.set("User-Agent", m_user_agent);
-        headers.set("Accept-Encoding", "gzip, deflate, br");
+        headers.set("Accept-Encoding", "gzip, deflate, br, zstd");
 
         for (auto& it : request.headers()) {
             headers.set(it.key, it.value);
@@ -120,6 +120,7 @@ private:
     int m_pending_loads { 0 };
 
     HashTable<NonnullRefPtr<ResourceLoaderConnectorRequest>> m_active_requests;
+    HashTable<DeprecatedString> m_hosts_with_prefetched_dns;
     NonnullRefPtr<ResourceLoaderConnector> m_connector;
     DeprecatedString m_user_agent;
     Optional<Page&> m_page {};
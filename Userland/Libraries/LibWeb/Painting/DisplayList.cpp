@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/GenericShorthands.h>
+#include <LibWeb/Layout/Box.h>
+#include <LibWeb/Painting/DisplayList.h>
+#include <LibWeb/Painting/PaintableBox.h>
+#include <LibWeb/Painting/StackingContext.h>
+
+namespace Web::Painting {
+
+void DisplayList::append(CommandType type, Paintable const& paintable, PaintPhase phase)
+{
+    m_commands.append({ .type = type, .phase = phase, .paintable = &paintable });
+}
+
+void DisplayList::append_paint(Paintable const& paintable, PaintPhase phase)
+{
+    append(CommandType::Paint, paintable, phase);
+}
+
+void DisplayList::append_focus_outline(Paintable const& paintable)
+{
+    append(CommandType::PaintIfFocused, paintable, PaintPhase::FocusOutline);
+}
+
+void DisplayList::append_before_children_paint(Paintable const& paintable, PaintPhase phase)
+{
+    append(CommandType::BeforeChildrenPaint, paintable, phase);
+}
+
+void DisplayList::append_after_children_paint(Paintable const& paintable, PaintPhase phase)
+{
+    append(CommandType::AfterChildrenPaint, paintable, phase);
+}
+
+void DisplayList::append_apply_clip_overflow_rect(Paintable const& paintable, PaintPhase phase)
+{
+    // NOTE: Overflow is only clipped while painting backgrounds, borders and the foreground, so there's nothing to record otherwise.
+    if (!AK::first_is_one_of(phase, PaintPhase::Background, PaintPhase::Border, PaintPhase::Foreground))
+        return;
+    append(CommandType::ApplyClipOverflowRect, paintable, phase);
+}
+
+void DisplayList::append_clear_clip_overflow_rect(Paintable const& paintable, PaintPhase phase)
+{
+    if (!AK::first_is_one_of(phase, PaintPhase::Background, PaintPhase::Border, PaintPhase::Foreground))
+        return;
+    append(CommandType::ClearClipOverflowRect, paintable, phase);
+}
+
+void DisplayList::append_stacking_context(StackingContext const& stacking_context)
+{
+    m_commands.append({ .type = CommandType::PaintStackingContext, .stacking_context = &stacking_context });
+}
+
+// A box's background and border are painted within its paint rect, so they can be skipped when that's not within the
+// painter's clip rect, e.g. when it has been scrolled out of view.
+static bool can_skip_painting(Paintable const& paintable, PaintPhase phase, PaintContext& context)
+{
+    if (phase != PaintPhase::Background && phase != PaintPhase::Border)
+        return false;
+    if (!is<PaintableBox>(paintable))
+        return false;
+    auto const& paintable_box = static_cast<PaintableBox const&>(paintable);
+    // NOTE: An absolutely positioned box with a clip rect saves the painter's state when painting its background, which
+    //       painting its overlay restores, so that has to happen either way.
+    if (paintable_box.computed_values().clip().is_rect() && paintable_box.layout_box().is_absolutely_positioned())
+        return false;
+    return paintable_box.is_out_of_view(context);
+}
+
+void DisplayList::replay(PaintContext& context) const
+{
+    for (auto const& command : m_commands) {
+        switch (command.type) {
+        case CommandType::Paint:
+            if (!can_skip_painting(*command.paintable, command.phase, context))
+                command.paintable->paint(context, command.phase);
+            break;
+        case CommandType::PaintIfFocused:
+            if (context.has_focus())
+                command.paintable->paint(context, command.phase);
+            break;
+        case CommandType::BeforeChildrenPaint:
+            command.paintable->before_children_paint(context, command.phase);
+            break;
+        case CommandType::AfterChildrenPaint:
+            command.paintable->after_children_paint(context, command.phase);
+            break;
+        case CommandType::ApplyClipOverflowRect:
+            command.paintable->apply_clip_overflow_rect(context, command.phase);
+            break;
+        case CommandType::ClearClipOverflowRect:
+            command.paintable->clear_clip_overflow_rect(context, command.phase);
+            break;
+        case CommandType::PaintStackingContext:
+            command.stacking_context->paint(context);
+            break;
+        }
+    }
+}
+
+}
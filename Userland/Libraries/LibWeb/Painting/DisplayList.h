@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Vector.h>
+#include <LibWeb/Forward.h>
+#include <LibWeb/Painting/Paintable.h>
+
+namespace Web::Painting {
+
+// The order in which a stacking context paints its content, as worked out by the walk described in CSS 2.1 Appendix E.
+//
+// The walk only depends on the layout tree, so it's recorded once and replayed until the stacking context tree is rebuilt.
+// Only which paintable paints in which phase is recorded: paintables still paint themselves when the list is replayed,
+// so a paintable that only needs to be repainted doesn't invalidate the list.
+class DisplayList {
+public:
+    void append_paint(Paintable const&, PaintPhase);
+    // NOTE: Focus outlines are only painted while the page has focus.
+    void append_focus_outline(Paintable const&);
+    void append_before_children_paint(Paintable const&, PaintPhase);
+    void append_after_children_paint(Paintable const&, PaintPhase);
+    void append_apply_clip_overflow_rect(Paintable const&, PaintPhase);
+    void append_clear_clip_overflow_rect(Paintable const&, PaintPhase);
+    void append_stacking_context(StackingContext const&);
+
+    void replay(PaintContext&) const;
+
+private:
+    enum class CommandType : u8 {
+        Paint,
+        PaintIfFocused,
+        BeforeChildrenPaint,
+        AfterChildrenPaint,
+        ApplyClipOverflowRect,
+        ClearClipOverflowRect,
+        PaintStackingContext,
+    };
+
+    struct Command {
+        CommandType type;
+        PaintPhase phase { PaintPhase::Background };
+        Paintable const* paintable { nullptr };
+        StackingContext const* stacking_context { nullptr };
+    };
+
+    void append(CommandType, Paintable const&, PaintPhase);
+
+    Vector<Command> m_commands;
+};
+
+}
@@ -6,13 +6,13 @@
 
 #include <LibGfx/Filters/BrightnessFilter.h>
 #include <LibGfx/Filters/ContrastFilter.h>
+#include <LibGfx/Filters/FilterPipeline.h>
 #include <LibGfx/Filters/GrayscaleFilter.h>
 #include <LibGfx/Filters/HueRotateFilter.h>
 #include <LibGfx/Filters/InvertFilter.h>
 #include <LibGfx/Filters/OpacityFilter.h>
 #include <LibGfx/Filters/SaturateFilter.h>
 #include <LibGfx/Filters/SepiaFilter.h>
-#include <LibGfx/Filters/StackBlurFilter.h>
 #include <LibWeb/Layout/Node.h>
 #include <LibWeb/Painting/BorderRadiusCornerClipper.h>
 #include <LibWeb/Painting/FilterPainting.h>
@@ -21,8 +21,10 @@ namespace Web::Painting {
 
 void apply_filter_list(Gfx::Bitmap& target_bitmap, Layout::Node const& node, Span<CSS::FilterFunction const> filter_list)
 {
-    auto apply_color_filter = [&](Gfx::ColorFilter const& filter) {
-        const_cast<Gfx::ColorFilter&>(filter).apply(target_bitmap, target_bitmap.rect(), target_bitmap, target_bitmap.rect());
+    // Note: The pipeline combines neighbouring color filters, so that the bitmap needs to be gone over only once for them.
+    Gfx::FilterPipeline pipeline;
+    auto add_color_filter = [&](Gfx::ColorFilter const& filter) {
+        pipeline.add_color_filter(filter);
     };
     for (auto& filter_function : filter_list) {
         // See: https://drafts.fxtf.org/filter-effects-1/#supported-filter-functions
@@ -30,8 +32,7 @@ void apply_filter_list(Gfx::Bitmap& target_bitmap, Layout::Node const& node, Spa
             [&](CSS::Filter::Blur const& blur) {
                 // Applies a Gaussian blur to the input image.
                 // The passed parameter defines the value of the standard deviation to the Gaussian function.
-                Gfx::StackBlurFilter filter { target_bitmap };
-                filter.process_rgba(blur.resolved_radius(node), Color::Transparent);
+                pipeline.add_stack_blur(blur.resolved_radius(node), Color::Transparent);
             },
             [&](CSS::Filter::Color const& color) {
                 auto amount = color.resolved_amount();
@@ -40,38 +41,38 @@ void apply_filter_list(Gfx::Bitmap& target_bitmap, Layout::Node const& node, Spa
                 case CSS::Filter::Color::Operation::Grayscale: {
                     // Converts the input image to grayscale. The passed parameter defines the proportion of the conversion.
                     // A value of 100% is completely grayscale. A value of 0% leaves the input unchanged.
-                    apply_color_filter(Gfx::GrayscaleFilter { amount_clamped });
+                    add_color_filter(Gfx::GrayscaleFilter { amount_clamped });
                     break;
                 }
                 case CSS::Filter::Color::Operation::Brightness: {
                     // Applies a linear multiplier to input image, making it appear more or less bright.
                     // A value of 0% will create an image that is completely black. A value of 100% leaves the input unchanged.
                     // Values of amount over 100% are allowed, providing brighter results.
-                    apply_color_filter(Gfx::BrightnessFilter { amount });
+                    add_color_filter(Gfx::BrightnessFilter { amount });
                     break;
                 }
                 case CSS::Filter::Color::Operation::Contrast: {
                     // Adjusts the contrast of the input. A value of 0% will create an image that is completely gray.
                     // A value of 100% leaves the input unchanged. Values of amount over 100% are allowed, providing results with more contrast.
-                    apply_color_filter(Gfx::ContrastFilter { amount });
+                    add_color_filter(Gfx::ContrastFilter { amount });
                     break;
                 }
                 case CSS::Filter::Color::Operation::Invert: {
                     // Inverts the samples in the input image. The passed parameter defines the proportion of the conversion.
                     // A value of 100% is completely inverted. A value of 0% leaves the input unchanged.
-                    apply_color_filter(Gfx::InvertFilter { amount_clamped });
+                    add_color_filter(Gfx::InvertFilter { amount_clamped });
                     break;
                 }
                 case CSS::Filter::Color::Operation::Opacity: {
                     // Applies transparency to the samples in the input image. The passed parameter defines the proportion of the conversion.
                     // A value of 0% is completely transparent. A value of 100% leaves the input unchanged.
-                    apply_color_filter(Gfx::OpacityFilter { amount_clamped });
+                    add_color_filter(Gfx::OpacityFilter { amount_clamped });
                     break;
                 }
                 case CSS::Filter::Color::Operation::Sepia: {
                     // Converts the input image to sepia. The passed parameter defines the proportion of the conversion.
                     // A value of 100% is completely sepia. A value of 0% leaves the input unchanged.
-                    apply_color_filter(Gfx::SepiaFilter { amount_clamped });
+                    add_color_filter(Gfx::SepiaFilter { amount_clamped });
                     break;
                 }
                 case CSS::Filter::Color::Operation::Saturate: {
@@ -79,7 +80,7 @@ void apply_filter_list(Gfx::Bitmap& target_bitmap, Layout::Node const& node, Spa
                     // A value of 0% is completely un-saturated. A value of 100% leaves the input unchanged.
                     // Other values are linear multipliers on the effect.
                     // Values of amount over 100% are allowed, providing super-saturated results
-                    apply_color_filter(Gfx::SaturateFilter { amount });
+                    add_color_filter(Gfx::SaturateFilter { amount });
                     break;
                 }
                 default:
@@ -90,12 +91,13 @@ void apply_filter_list(Gfx::Bitmap& target_bitmap, Layout::Node const& node, Spa
                 // Applies a hue rotation on the input image.
                 // The passed parameter defines the number of degrees around the color circle the input samples will be adjusted.
                 // A value of 0deg leaves the input unchanged. Implementations must not normalize this value in order to allow animations beyond 360deg.
-                apply_color_filter(Gfx::HueRotateFilter { hue_rotate.angle_degrees() });
+                add_color_filter(Gfx::HueRotateFilter { hue_rotate.angle_degrees() });
             },
             [&](CSS::Filter::DropShadow const&) {
                 dbgln("TODO: Implement drop-shadow() filter function!");
             });
     }
+    pipeline.apply(target_bitmap);
 }
 
 void apply_backdrop_filter(PaintContext& context, Layout::Node const& node, CSSPixelRect const& backdrop_rect, BorderRadiiData const& border_radii_data, CSS::BackdropFilter const& backdrop_filter)
@@ -16,15 +16,16 @@
 #include <LibWeb/Layout/Box.h>
 #include <LibWeb/Layout/InitialContainingBlock.h>
 #include <LibWeb/Layout/ReplacedBox.h>
+#include <LibWeb/Painting/DisplayList.h>
 #include <LibWeb/Painting/PaintableBox.h>
 #include <LibWeb/Painting/StackingContext.h>
 
 namespace Web::Painting {
 
-static void paint_node(Layout::Node const& layout_node, PaintContext& context, PaintPhase phase)
+static void record_node(DisplayList& display_list, Layout::Node const& layout_node, PaintPhase phase)
 {
     if (auto const* paintable = layout_node.paintable())
-        paintable->paint(context, phase);
+        display_list.append_paint(*paintable, phase);
 }
 
 StackingContext::StackingContext(Layout::Box& box, StackingContext* parent)
@@ -38,6 +39,8 @@ StackingContext::StackingContext(Layout::Box& box, StackingContext* parent)
         m_parent->m_children.append(this);
 }
 
+StackingContext::~StackingContext() = default;
+
 void StackingContext::sort()
 {
     quick_sort(m_children, [](auto& a, auto& b) {
@@ -69,11 +72,11 @@ static PaintPhase to_paint_phase(StackingContext::StackingContextPaintPhase phas
     }
 }
 
-void StackingContext::paint_descendants(PaintContext& context, Layout::Node const& box, StackingContextPaintPhase phase) const
+void StackingContext::record_descendants(DisplayList& display_list, Layout::Node const& box, StackingContextPaintPhase phase) const
 {
     if (auto* paintable = box.paintable()) {
-        paintable->before_children_paint(context, to_paint_phase(phase));
-        paintable->apply_clip_overflow_rect(context, to_paint_phase(phase));
+        display_list.append_before_children_paint(*paintable, to_paint_phase(phase));
+        display_list.append_apply_clip_overflow_rect(*paintable, to_paint_phase(phase));
     }
 
     box.for_each_child([&](auto& child) {
@@ -91,86 +94,85 @@ void StackingContext::paint_descendants(PaintContext& context, Layout::Node cons
         switch (phase) {
         case StackingContextPaintPhase::BackgroundAndBorders:
             if (!child_is_inline_or_replaced && !child.is_floating()) {
-                paint_node(child, context, PaintPhase::Background);
-                paint_node(child, context, PaintPhase::Border);
-                paint_descendants(context, child, phase);
+                record_node(display_list, child, PaintPhase::Background);
+                record_node(display_list, child, PaintPhase::Border);
+                record_descendants(display_list, child, phase);
             }
             break;
         case StackingContextPaintPhase::Floats:
             if (child.is_floating()) {
-                paint_node(child, context, PaintPhase::Background);
-                paint_node(child, context, PaintPhase::Border);
-                paint_descendants(context, child, StackingContextPaintPhase::BackgroundAndBorders);
+                record_node(display_list, child, PaintPhase::Background);
+                record_node(display_list, child, PaintPhase::Border);
+                record_descendants(display_list, child, StackingContextPaintPhase::BackgroundAndBorders);
             }
-            paint_descendants(context, child, phase);
+            record_descendants(display_list, child, phase);
             break;
         case StackingContextPaintPhase::BackgroundAndBordersForInlineLevelAndReplaced:
             if (child_is_inline_or_replaced) {
-                paint_node(child, context, PaintPhase::Background);
-                paint_node(child, context, PaintPhase::Border);
-                paint_descendants(context, child, StackingContextPaintPhase::BackgroundAndBorders);
+                record_node(display_list, child, PaintPhase::Background);
+                record_node(display_list, child, PaintPhase::Border);
+                record_descendants(display_list, child, StackingContextPaintPhase::BackgroundAndBorders);
             }
-            paint_descendants(context, child, phase);
+            record_descendants(display_list, child, phase);
             break;
         case StackingContextPaintPhase::Foreground:
-            paint_node(child, context, PaintPhase::Foreground);
-            paint_descendants(context, child, phase);
+            record_node(display_list, child, PaintPhase::Foreground);
+            record_descendants(display_list, child, phase);
             break;
         case StackingContextPaintPhase::FocusAndOverlay:
-            if (context.has_focus()) {
-                paint_node(child, context, PaintPhase::FocusOutline);
-            }
-            paint_node(child, context, PaintPhase::Overlay);
-            paint_descendants(context, child, phase);
+            if (auto const* paintable = child.paintable())
+                display_list.append_focus_outline(*paintable);
+            record_node(display_list, child, PaintPhase::Overlay);
+            record_descendants(display_list, child, phase);
             break;
         }
     });
 
     if (auto* paintable = box.paintable()) {
-        paintable->clear_clip_overflow_rect(context, to_paint_phase(phase));
-        paintable->after_children_paint(context, to_paint_phase(phase));
+        display_list.append_clear_clip_overflow_rect(*paintable, to_paint_phase(phase));
+        display_list.append_after_children_paint(*paintable, to_paint_phase(phase));
     }
 }
 
-void StackingContext::paint_internal(PaintContext& context) const
+void StackingContext::record(DisplayList& display_list) const
 {
     // For a more elaborate description of the algorithm, see CSS 2.1 Appendix E
     // Draw the background and borders for the context root (steps 1, 2)
-    paint_node(m_box, context, PaintPhase::Background);
-    paint_node(m_box, context, PaintPhase::Border);
+    record_node(display_list, m_box, PaintPhase::Background);
+    record_node(display_list, m_box, PaintPhase::Border);
 
-    auto paint_child = [&](auto* child) {
+    auto record_child = [&](auto* child) {
         auto parent = child->m_box.parent();
         auto* parent_paintable = parent ? parent->paintable() : nullptr;
         if (parent_paintable)
-            parent_paintable->before_children_paint(context, PaintPhase::Foreground);
+            display_list.append_before_children_paint(*parent_paintable, PaintPhase::Foreground);
         auto containing_block = child->m_box.containing_block();
         auto* containing_block_paintable = containing_block ? containing_block->paintable() : nullptr;
         if (containing_block_paintable)
-            containing_block_paintable->apply_clip_overflow_rect(context, PaintPhase::Foreground);
+            display_list.append_apply_clip_overflow_rect(*containing_block_paintable, PaintPhase::Foreground);
 
-        child->paint(context);
+        display_list.append_stacking_context(*child);
 
         if (parent_paintable)
-            parent_paintable->after_children_paint(context, PaintPhase::Foreground);
+            display_list.append_after_children_paint(*parent_paintable, PaintPhase::Foreground);
         if (containing_block_paintable)
-            containing_block_paintable->clear_clip_overflow_rect(context, PaintPhase::Foreground);
+            display_list.append_clear_clip_overflow_rect(*containing_block_paintable, PaintPhase::Foreground);
     };
 
     // Draw positioned descendants with negative z-indices (step 3)
     for (auto* child : m_children) {
         if (child->m_box.computed_values().z_index().has_value() && child->m_box.computed_values().z_index().value() < 0)
-            paint_child(child);
+            record_child(child);
     }
 
     // Draw the background and borders for block-level children (step 4)
-    paint_descendants(context, m_box, StackingContextPaintPhase::BackgroundAndBorders);
+    record_descendants(display_list, m_box, StackingContextPaintPhase::BackgroundAndBorders);
     // Draw the non-positioned floats (step 5)
-    paint_descendants(context, m_box, StackingContextPaintPhase::Floats);
+    record_descendants(display_list, m_box, StackingContextPaintPhase::Floats);
     // Draw inline content, replaced content, etc. (steps 6, 7)
-    paint_descendants(context, m_box, StackingContextPaintPhase::BackgroundAndBordersForInlineLevelAndReplaced);
-    paint_node(m_box, context, PaintPhase::Foreground);
-    paint_descendants(context, m_box, StackingContextPaintPhase::Foreground);
+    record_descendants(display_list, m_box, StackingContextPaintPhase::BackgroundAndBordersForInlineLevelAndReplaced);
+    record_node(display_list, m_box, PaintPhase::Foreground);
+    record_descendants(display_list, m_box, StackingContextPaintPhase::Foreground);
 
     // Draw positioned descendants with z-index `0` or `auto` in tree order. (step 8)
     // NOTE: Non-positioned descendants that establish stacking contexts with z-index `0` or `auto` are also painted here.
@@ -179,7 +181,7 @@ void StackingContext::paint_internal(PaintContext& context) const
         auto const& z_index = paint_box.computed_values().z_index();
         if (auto* child = paint_box.stacking_context()) {
             if (!z_index.has_value() || z_index.value() == 0)
-                paint_child(child);
+                record_child(child);
             return TraversalDecision::SkipChildrenAndContinue;
         }
         if (z_index.has_value() && z_index.value() != 0)
@@ -192,25 +194,25 @@ void StackingContext::paint_internal(PaintContext& context) const
         auto parent = paint_box.layout_node().parent();
         auto* parent_paintable = parent ? parent->paintable() : nullptr;
         if (parent_paintable)
-            parent_paintable->before_children_paint(context, PaintPhase::Foreground);
+            display_list.append_before_children_paint(*parent_paintable, PaintPhase::Foreground);
         auto containing_block = paint_box.layout_node().containing_block();
         auto* containing_block_paintable = containing_block ? containing_block->paintable() : nullptr;
         if (containing_block_paintable)
-            containing_block_paintable->apply_clip_overflow_rect(context, PaintPhase::Foreground);
-        paint_node(paint_box.layout_box(), context, PaintPhase::Background);
-        paint_node(paint_box.layout_box(), context, PaintPhase::Border);
-        paint_descendants(context, paint_box.layout_box(), StackingContextPaintPhase::BackgroundAndBorders);
-        paint_descendants(context, paint_box.layout_box(), StackingContextPaintPhase::Floats);
-        paint_descendants(context, paint_box.layout_box(), StackingContextPaintPhase::BackgroundAndBordersForInlineLevelAndReplaced);
-        paint_node(paint_box.layout_box(), context, PaintPhase::Foreground);
-        paint_descendants(context, paint_box.layout_box(), StackingContextPaintPhase::Foreground);
-        paint_node(paint_box.layout_box(), context, PaintPhase::FocusOutline);
-        paint_node(paint_box.layout_box(), context, PaintPhase::Overlay);
-        paint_descendants(context, paint_box.layout_box(), StackingContextPaintPhase::FocusAndOverlay);
+            display_list.append_apply_clip_overflow_rect(*containing_block_paintable, PaintPhase::Foreground);
+        record_node(display_list, paint_box.layout_box(), PaintPhase::Background);
+        record_node(display_list, paint_box.layout_box(), PaintPhase::Border);
+        record_descendants(display_list, paint_box.layout_box(), StackingContextPaintPhase::BackgroundAndBorders);
+        record_descendants(display_list, paint_box.layout_box(), StackingContextPaintPhase::Floats);
+        record_descendants(display_list, paint_box.layout_box(), StackingContextPaintPhase::BackgroundAndBordersForInlineLevelAndReplaced);
+        record_node(display_list, paint_box.layout_box(), PaintPhase::Foreground);
+        record_descendants(display_list, paint_box.layout_box(), StackingContextPaintPhase::Foreground);
+        record_node(display_list, paint_box.layout_box(), PaintPhase::FocusOutline);
+        record_node(display_list, paint_box.layout_box(), PaintPhase::Overlay);
+        record_descendants(display_list, paint_box.layout_box(), StackingContextPaintPhase::FocusAndOverlay);
         if (parent_paintable)
-            parent_paintable->after_children_paint(context, PaintPhase::Foreground);
+            display_list.append_after_children_paint(*parent_paintable, PaintPhase::Foreground);
         if (containing_block_paintable)
-            containing_block_paintable->clear_clip_overflow_rect(context, PaintPhase::Foreground);
+            display_list.append_clear_clip_overflow_rect(*containing_block_paintable, PaintPhase::Foreground);
 
         return TraversalDecision::Continue;
     });
@@ -218,12 +220,21 @@ void StackingContext::paint_internal(PaintContext& context) const
     // Draw other positioned descendants (step 9)
     for (auto* child : m_children) {
         if (child->m_box.computed_values().z_index().has_value() && child->m_box.computed_values().z_index().value() >= 1)
-            paint_child(child);
+            record_child(child);
     }
 
-    paint_node(m_box, context, PaintPhase::FocusOutline);
-    paint_node(m_box, context, PaintPhase::Overlay);
-    paint_descendants(context, m_box, StackingContextPaintPhase::FocusAndOverlay);
+    record_node(display_list, m_box, PaintPhase::FocusOutline);
+    record_node(display_list, m_box, PaintPhase::Overlay);
+    record_descendants(display_list, m_box, StackingContextPaintPhase::FocusAndOverlay);
+}
+
+void StackingContext::paint_internal(PaintContext& context) const
+{
+    if (!m_display_list) {
+        m_display_list = make<DisplayList>();
+        record(*m_display_list);
+    }
+    m_display_list->replay(context);
 }
 
 Gfx::FloatMatrix4x4 StackingContext::get_transformation_matrix(CSS::Transformation const& transformation) const
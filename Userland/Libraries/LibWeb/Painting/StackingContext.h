@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/OwnPtr.h>
 #include <AK/Vector.h>
 #include <LibGfx/Matrix4x4.h>
 #include <LibWeb/Layout/Node.h>
@@ -16,6 +17,7 @@ namespace Web::Painting {
 class StackingContext {
 public:
     StackingContext(Layout::Box&, StackingContext* parent);
+    ~StackingContext();
 
     StackingContext* parent() { return m_parent; }
     StackingContext const* parent() const { return m_parent; }
@@ -30,7 +32,6 @@ public:
         FocusAndOverlay,
     };
 
-    void paint_descendants(PaintContext&, Layout::Node const&, StackingContextPaintPhase) const;
     void paint(PaintContext&) const;
     Optional<HitTestResult> hit_test(CSSPixelPoint, HitTestType) const;
 
@@ -47,7 +48,11 @@ private:
     Gfx::FloatPoint m_transform_origin;
     StackingContext* const m_parent { nullptr };
     Vector<StackingContext*> m_children;
+    // Recorded the first time this is painted, as it's rebuilt along with the stacking context tree.
+    mutable OwnPtr<DisplayList> m_display_list;
 
+    void record(DisplayList&) const;
+    void record_descendants(DisplayList&, Layout::Node const&, StackingContextPaintPhase) const;
     void paint_internal(PaintContext&) const;
     Gfx::FloatMatrix4x4 get_transformation_matrix(CSS::Transformation const& transformation) const;
     Gfx::FloatMatrix4x4 combine_transformations(Vector<CSS::Transformation> const& transformations) const;
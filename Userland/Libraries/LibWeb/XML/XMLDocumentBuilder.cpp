@@ -46,9 +46,9 @@ XMLDocumentBuilder::XMLDocumentBuilder(DOM::Document& document, XMLScriptingSupp
 {
 }
 
-void XMLDocumentBuilder::set_source(DeprecatedString source)
+void XMLDocumentBuilder::set_source(StringView source)
 {
-    m_document.set_source(move(source));
+    m_document.set_source(source);
 }
 
 void XMLDocumentBuilder::element_start(const XML::Name& name, HashMap<XML::Name, DeprecatedString> const& attributes)
@@ -29,7 +29,7 @@ public:
     bool has_error() const { return m_has_error; }
 
 private:
-    virtual void set_source(DeprecatedString) override;
+    virtual void set_source(StringView) override;
     virtual void element_start(XML::Name const& name, HashMap<XML::Name, DeprecatedString> const& attributes) override;
     virtual void element_end(XML::Name const& name) override;
     virtual void text(StringView data) override;
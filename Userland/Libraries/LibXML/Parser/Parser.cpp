@@ -4,6 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/BuiltinWrappers.h>
+#include <AK/GenericShorthands.h>
+#include <AK/SIMDExtras.h>
 #include <LibXML/DOM/Document.h>
 #include <LibXML/Parser/Parser.h>
 
@@ -68,6 +71,38 @@ namespace XML {
 
 size_t Parser::s_debug_indent_level { 0 };
 
+// Returns the number of bytes at the start of the given ones that come before the first one of the three stop bytes.
+static size_t count_bytes_before_any_of(ReadonlyBytes bytes, u8 a, u8 b, u8 c)
+{
+    using AK::SIMD::i8x16;
+    using AK::SIMD::u8x16;
+
+    size_t offset = 0;
+    for (; offset + sizeof(u8x16) <= bytes.size(); offset += sizeof(u8x16)) {
+        u8x16 chunk;
+        __builtin_memcpy(&chunk, bytes.offset(offset), sizeof(chunk));
+        auto matches = (i8x16)((chunk == a) | (chunk == b) | (chunk == c));
+        if (auto bits = AK::SIMD::maskbits(matches); bits != 0)
+            return offset + count_trailing_zeroes(static_cast<u32>(bits));
+    }
+    for (; offset < bytes.size(); ++offset) {
+        if (first_is_one_of(bytes[offset], a, b, c))
+            return offset;
+    }
+    return offset;
+}
+
+Name Parser::intern_name(StringView name)
+{
+    auto it = m_names.find(name.hash(), [&](auto& entry) { return entry == name; });
+    if (it != m_names.end())
+        return *it;
+
+    Name interned = name;
+    m_names.set(interned);
+    return interned;
+}
+
 void Parser::append_node(NonnullOwnPtr<Node> node)
 {
     if (m_entered_node) {
@@ -538,16 +573,14 @@ ErrorOr<Name, ParseError> Parser::parse_name()
     auto rule = enter_rule();
 
     // Name ::= NameStartChar (NameChar)*
-    auto start = TRY(expect(s_name_start_characters, "a NameStartChar"sv));
+    auto start = m_lexer.tell();
+    TRY(expect(s_name_start_characters, "a NameStartChar"sv));
     auto accept = accept_rule();
 
-    auto rest = m_lexer.consume_while(s_name_characters);
-    StringBuilder builder;
-    builder.append(start);
-    builder.append(rest);
+    m_lexer.consume_while(s_name_characters);
 
     rollback.disarm();
-    return builder.to_deprecated_string();
+    return intern_name(m_source.substring_view(start, m_lexer.tell() - start));
 }
 
 // 2.8.28. doctypedecl, https://www.w3.org/TR/2006/REC-xml11-20060816/#NT-doctypedecl
@@ -611,7 +644,14 @@ ErrorOr<void, ParseError> Parser::parse_element()
     // element ::= EmptyElemTag
     //           | STag content ETag
     if (auto result = parse_empty_element_tag(); !result.is_error()) {
-        append_node(result.release_value());
+        auto node = result.release_value();
+        if (m_listener) {
+            auto& element = node->content.get<Node::Element>();
+            m_listener->element_start(element.name, element.attributes);
+            m_listener->element_end(element.name);
+        } else {
+            append_node(move(node));
+        }
         rollback.disarm();
         return {};
     }
@@ -619,7 +659,12 @@ ErrorOr<void, ParseError> Parser::parse_element()
     auto start_tag = TRY(parse_start_tag());
     auto& node = *start_tag;
     auto& tag = node.content.get<Node::Element>();
-    append_node(move(start_tag));
+    // Note: Listeners have already been told about an element once it's left, so it's not kept around for them.
+    OwnPtr<Node> node_for_listener;
+    if (m_listener)
+        node_for_listener = move(start_tag);
+    else
+        append_node(move(start_tag));
     enter_node(node);
     ScopeGuard quit {
         [&] {
@@ -712,25 +757,35 @@ ErrorOr<DeprecatedString, ParseError> Parser::parse_attribute_value()
 
 ErrorOr<DeprecatedString, ParseError> Parser::parse_attribute_value_inner(StringView disallow)
 {
+    VERIFY(disallow.length() <= 1);
+    // Note: Without a quote to stop at, the run only ends at the bytes that would end it anyway.
+    auto quote = disallow.is_empty() ? '<' : disallow[0];
+
     StringBuilder builder;
     while (true) {
-        if (m_lexer.next_is(is_any_of(disallow)) || m_lexer.is_eof())
+        auto remaining = m_lexer.remaining();
+        auto run = remaining.substring_view(0, count_bytes_before_any_of(remaining.bytes(), quote, '<', '&'));
+        m_lexer.ignore(run.length());
+
+        if (m_lexer.next_is(is_any_of(disallow)) || m_lexer.is_eof()) {
+            // Values without references are taken straight from the source.
+            if (builder.is_empty())
+                return DeprecatedString { run };
+            builder.append(run);
             break;
+        }
+        builder.append(run);
 
         if (m_lexer.next_is('<')) {
             // Not allowed, return a nice error to make it easier to debug.
             return parse_error(m_lexer.tell(), "Unescaped '<' not allowed in attribute values");
         }
 
-        if (m_lexer.next_is('&')) {
-            auto reference = TRY(parse_reference());
-            if (auto* char_reference = reference.get_pointer<DeprecatedString>())
-                builder.append(*char_reference);
-            else
-                builder.append(TRY(resolve_reference(reference.get<EntityReference>(), ReferencePlacement::AttributeValue)));
-        } else {
-            builder.append(m_lexer.consume());
-        }
+        auto reference = TRY(parse_reference());
+        if (auto* char_reference = reference.get_pointer<DeprecatedString>())
+            builder.append(*char_reference);
+        else
+            builder.append(TRY(resolve_reference(reference.get<EntityReference>(), ReferencePlacement::AttributeValue)));
     }
     return builder.to_deprecated_string();
 }
@@ -890,33 +945,16 @@ ErrorOr<StringView, ParseError> Parser::parse_char_data()
     auto rule = enter_rule();
 
     // CharData ::= [^<&]* - ([^<&]* ']]>' [^<&]*)
-    auto cend_state = 0; // 1: ], 2: ], 3: >
-    auto text = m_lexer.consume_while([&](auto ch) {
-        if (ch == '<' || ch == '&' || cend_state == 3)
-            return false;
-        switch (cend_state) {
-        case 0:
-        case 1:
-            if (ch == ']')
-                cend_state++;
-            else
-                cend_state = 0;
-            return true;
-        case 2:
-            if (ch == '>') {
-                cend_state++;
-                return true;
-            }
-            cend_state = 0;
-            return true;
-        default:
-            VERIFY_NOT_REACHED();
-        }
-    });
-    if (cend_state == 3) {
-        m_lexer.retreat(3);
-        text = text.substring_view(0, text.length() - 3);
+    auto remaining = m_lexer.remaining();
+    size_t length = 0;
+    while (true) {
+        length += count_bytes_before_any_of(remaining.bytes().slice(length), '<', '&', ']');
+        if (length == remaining.length() || remaining[length] != ']' || remaining.substring_view(length).starts_with("]]>"sv))
+            break;
+        ++length;
     }
+    auto text = remaining.substring_view(0, length);
+    m_lexer.ignore(length);
 
     rollback.disarm();
     return text;
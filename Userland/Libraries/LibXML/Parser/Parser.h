@@ -11,6 +11,7 @@
 #include <AK/Function.h>
 #include <AK/GenericLexer.h>
 #include <AK/HashMap.h>
+#include <AK/HashTable.h>
 #include <AK/OwnPtr.h>
 #include <AK/SourceLocation.h>
 #include <AK/TemporaryChange.h>
@@ -26,10 +27,12 @@ struct ParseError {
     DeprecatedString error;
 };
 
+// Listeners are told about the document as it's parsed, and no tree of it is built. Text and comments point into the
+// source where possible.
 struct Listener {
     virtual ~Listener() { }
 
-    virtual void set_source(DeprecatedString) { }
+    virtual void set_source(StringView) { }
     virtual void document_start() { }
     virtual void document_end() { }
     virtual void element_start(Name const&, HashMap<Name, DeprecatedString> const&) { }
@@ -72,6 +75,7 @@ private:
     };
 
     ErrorOr<void, ParseError> parse_internal();
+    Name intern_name(StringView);
     void append_node(NonnullOwnPtr<Node>);
     void append_text(StringView);
     void append_comment(StringView);
@@ -203,6 +207,8 @@ private:
     DeprecatedString m_encoding;
     bool m_standalone { false };
     HashMap<Name, DeprecatedString> m_processing_instructions;
+    // Every name that was seen so far, so that repeated element and attribute names share their storage.
+    HashTable<Name> m_names;
     struct AcceptedRule {
         Optional<DeprecatedString> rule {};
         bool accept { false };
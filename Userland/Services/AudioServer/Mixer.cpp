@@ -7,7 +7,7 @@
 
 #include "Mixer.h"
 #include <AK/Array.h>
-#include <AK/DeprecatedMemoryStream.h>
+#include <AK/Endian.h>
 #include <AK/Format.h>
 #include <AK/NumericLimits.h>
 #include <AudioServer/ConnectionFromClient.h>
@@ -15,6 +15,7 @@
 #include <LibCore/ConfigFile.h>
 #include <LibCore/Timer.h>
 #include <pthread.h>
+#include <sched.h>
 #include <sys/ioctl.h>
 
 namespace AudioServer {
@@ -38,7 +39,15 @@ Mixer::Mixer(NonnullRefPtr<Core::ConfigFile> config)
     m_muted = m_config->read_bool_entry("Master", "Mute", false);
     m_main_volume = static_cast<double>(m_config->read_num_entry("Master", "Volume", 100)) / 100.0;
 
+    auto period_size = m_config->read_num_entry("Mixer", "PeriodSize", DEFAULT_PERIOD_SIZE);
+    m_period_size = clamp(period_size, MINIMUM_PERIOD_SIZE, MAXIMUM_PERIOD_SIZE);
+    m_mixed_buffer.resize(m_period_size);
+    m_stream_buffer.resize(m_period_size * 2);
+
     m_sound_thread->start();
+    // The mixer has to keep the device fed no matter what else is going on, or playback will stutter.
+    if (auto result = m_sound_thread->set_priority(sched_get_priority_max(0)); result.is_error())
+        dbgln("Can't raise the priority of the mixer thread: {}", result.error());
 }
 
 NonnullRefPtr<ClientAudioStream> Mixer::create_queue(ConnectionFromClient& client)
@@ -47,6 +56,7 @@ NonnullRefPtr<ClientAudioStream> Mixer::create_queue(ConnectionFromClient& clien
     {
         Threading::MutexLocker const locker(m_pending_mutex);
         m_pending_mixing.append(*queue);
+        m_has_pending_mixing.store(true, AK::MemoryOrder::memory_order_release);
     }
     // Signal the mixer thread to start back up, in case nobody was connected before.
     m_mixing_necessary.signal();
@@ -59,7 +69,8 @@ void Mixer::mix()
     decltype(m_pending_mixing) active_mix_queues;
 
     for (;;) {
-        {
+        // The lock is only needed when there's nothing to mix yet, or when new streams are waiting to join.
+        if (active_mix_queues.is_empty() || m_has_pending_mixing.load(AK::MemoryOrder::memory_order_acquire)) {
             Threading::MutexLocker const locker(m_pending_mutex);
             // While we have nothing to mix, wait on the condition.
             m_mixing_necessary.wait_while([this, &active_mix_queues]() { return m_pending_mixing.is_empty() && active_mix_queues.is_empty(); });
@@ -67,11 +78,12 @@ void Mixer::mix()
                 active_mix_queues.extend(move(m_pending_mixing));
                 m_pending_mixing.clear();
             }
+            m_has_pending_mixing.store(false, AK::MemoryOrder::memory_order_relaxed);
         }
 
         active_mix_queues.remove_all_matching([&](auto& entry) { return !entry->is_connected(); });
 
-        Array<Audio::Sample, HARDWARE_BUFFER_SIZE> mixed_buffer;
+        m_mixed_buffer.span().fill({});
 
         m_main_volume.advance_time();
 
@@ -83,40 +95,28 @@ void Mixer::mix()
             }
             queue->volume().advance_time();
 
-            for (auto& mixed_sample : mixed_buffer) {
-                Audio::Sample sample;
-                if (!queue->get_next_sample(sample))
-                    break;
-                if (queue->is_muted())
-                    continue;
-                sample.log_multiply(SAMPLE_HEADROOM);
-                sample.log_multiply(static_cast<float>(queue->volume()));
-                mixed_sample += sample;
-            }
+            // Volumes only change once per period, so the gain is worked out up front rather than for every sample.
+            // Muted streams are still drained, so that they pick up where the others are once they're unmuted.
+            float gain = 0;
+            if (!queue->is_muted())
+                gain = Audio::Sample::linear_to_log(SAMPLE_HEADROOM) * Audio::Sample::linear_to_log(static_cast<float>(queue->volume()));
+            queue->mix_into(m_mixed_buffer.span(), gain);
         }
 
         // Even though it's not realistic, the user expects no sound at 0%.
         if (m_muted || m_main_volume < 0.01) {
-            m_device->write(m_zero_filled_buffer.data(), static_cast<int>(m_zero_filled_buffer.size()));
+            m_stream_buffer.span().fill(0);
         } else {
-            DeprecatedOutputMemoryStream stream { m_stream_buffer };
-
-            for (auto& mixed_sample : mixed_buffer) {
-                mixed_sample.log_multiply(static_cast<float>(m_main_volume));
+            auto main_gain = Audio::Sample::linear_to_log(static_cast<float>(m_main_volume));
+            for (size_t i = 0; i < m_period_size; ++i) {
+                auto mixed_sample = m_mixed_buffer[i] * main_gain;
                 mixed_sample.clip();
-
-                LittleEndian<i16> out_sample;
-                out_sample = static_cast<i16>(mixed_sample.left * NumericLimits<i16>::max());
-                stream << out_sample;
-
-                out_sample = static_cast<i16>(mixed_sample.right * NumericLimits<i16>::max());
-                stream << out_sample;
+                m_stream_buffer[2 * i] = static_cast<i16>(mixed_sample.left * NumericLimits<i16>::max());
+                m_stream_buffer[2 * i + 1] = static_cast<i16>(mixed_sample.right * NumericLimits<i16>::max());
             }
-
-            VERIFY(stream.is_end());
-            VERIFY(!stream.has_any_error());
-            m_device->write(stream.data(), static_cast<int>(stream.size()));
         }
+
+        m_device->write(reinterpret_cast<u8 const*>(m_stream_buffer.data()), static_cast<int>(m_stream_buffer.size() * sizeof(i16)));
     }
 }
 
@@ -29,10 +29,11 @@ namespace AudioServer {
 // Headroom, i.e. fixed attenuation for all audio streams.
 // This is to prevent clipping when two streams with low headroom (e.g. normalized & compressed) are playing.
 constexpr double SAMPLE_HEADROOM = 0.95;
-// The size of the buffer in samples that the hardware receives through write() calls to the audio device.
-constexpr size_t HARDWARE_BUFFER_SIZE = 512;
-// The hardware buffer size in bytes; there's two channels of 16-bit samples.
-constexpr size_t HARDWARE_BUFFER_SIZE_BYTES = HARDWARE_BUFFER_SIZE * 2 * sizeof(i16);
+// The size of the buffer in samples that the hardware receives through write() calls to the audio device, unless the
+// configuration asks for another one. Smaller periods lower the latency, but wake up the mixer more often.
+constexpr size_t DEFAULT_PERIOD_SIZE = 512;
+constexpr size_t MINIMUM_PERIOD_SIZE = 64;
+constexpr size_t MAXIMUM_PERIOD_SIZE = 4096;
 
 class ConnectionFromClient;
 
@@ -41,30 +42,44 @@ public:
     explicit ClientAudioStream(ConnectionFromClient&);
     ~ClientAudioStream() = default;
 
-    bool get_next_sample(Audio::Sample& sample)
+    // Adds the next samples of the stream to the buffer, scaled by the given gain, until either the buffer is full or the
+    // stream runs dry. Samples are taken a whole run at a time out of the current chunk, which keeps the loop simple
+    // enough for the compiler to vectorize.
+    bool mix_into(Span<Audio::Sample> buffer, float gain)
     {
         if (m_paused)
             return false;
 
-        if (m_in_chunk_location >= m_current_audio_chunk.size()) {
-            auto result = m_buffer->dequeue();
-            if (result.is_error()) {
-                if (result.error() == Audio::AudioQueue::QueueStatus::Empty) {
-                    dbgln("Audio client {} can't keep up!", m_client->client_id());
-                    // Note: Even though we only check client state here, we will probably close the client much earlier.
-                    if (!m_client->is_open()) {
-                        dbgln("Client socket {} has closed, closing audio server connection.", m_client->client_id());
-                        m_client->shutdown();
+        while (!buffer.is_empty()) {
+            if (m_in_chunk_location >= m_current_audio_chunk.size()) {
+                auto result = m_buffer->dequeue();
+                if (result.is_error()) {
+                    if (result.error() == Audio::AudioQueue::QueueStatus::Empty) {
+                        dbgln("Audio client {} can't keep up!", m_client->client_id());
+                        // Note: Even though we only check client state here, we will probably close the client much earlier.
+                        if (!m_client->is_open()) {
+                            dbgln("Client socket {} has closed, closing audio server connection.", m_client->client_id());
+                            m_client->shutdown();
+                        }
                     }
+
+                    return false;
                 }
+                m_current_audio_chunk = result.release_value();
+                m_in_chunk_location = 0;
+            }
 
-                return false;
+            auto count = min(buffer.size(), m_current_audio_chunk.size() - m_in_chunk_location);
+            auto const* source = m_current_audio_chunk.data() + m_in_chunk_location;
+            auto* destination = buffer.data();
+            for (size_t i = 0; i < count; ++i) {
+                destination[i].left += source[i].left * gain;
+                destination[i].right += source[i].right * gain;
             }
-            m_current_audio_chunk = result.release_value();
-            m_in_chunk_location = 0;
-        }
 
-        sample = m_current_audio_chunk[m_in_chunk_location++];
+            m_in_chunk_location += count;
+            buffer = buffer.slice(count);
+        }
 
         return true;
     }
@@ -94,7 +109,8 @@ public:
 private:
     OwnPtr<Audio::AudioQueue> m_buffer;
     Array<Audio::Sample, Audio::AUDIO_BUFFER_SIZE> m_current_audio_chunk;
-    size_t m_in_chunk_location;
+    // Starts out past the end, so that the first chunk is taken from the queue.
+    size_t m_in_chunk_location { Audio::AUDIO_BUFFER_SIZE };
 
     bool m_paused { true };
     bool m_muted { false };
@@ -126,6 +142,8 @@ private:
     void request_setting_sync();
 
     Vector<NonnullRefPtr<ClientAudioStream>> m_pending_mixing;
+    // Lets the mixer thread check for new streams without taking the lock every period.
+    Atomic<bool> m_has_pending_mixing { false };
     Threading::Mutex m_pending_mutex;
     Threading::ConditionVariable m_mixing_necessary { m_pending_mutex };
 
@@ -139,8 +157,10 @@ private:
     NonnullRefPtr<Core::ConfigFile> m_config;
     RefPtr<Core::Timer> m_config_write_timer;
 
-    Array<u8, HARDWARE_BUFFER_SIZE_BYTES> m_stream_buffer;
-    Array<u8, HARDWARE_BUFFER_SIZE_BYTES> const m_zero_filled_buffer {};
+    size_t m_period_size { DEFAULT_PERIOD_SIZE };
+    Vector<Audio::Sample> m_mixed_buffer;
+    // There's two channels of 16-bit samples for every sample in a period.
+    Vector<LittleEndian<i16>> m_stream_buffer;
 
     void mix();
 };
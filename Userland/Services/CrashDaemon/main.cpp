@@ -5,10 +5,12 @@
  */
 
 #include <AK/LexicalPath.h>
+#include <AK/MaybeOwned.h>
 #include <Kernel/API/InodeWatcherEvent.h>
+#include <LibCompress/Gzip.h>
 #include <LibCore/FileWatcher.h>
-#include <LibCore/MappedFile.h>
 #include <LibCore/Process.h>
+#include <LibCore/Stream.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
 #include <serenity.h>
@@ -32,6 +34,31 @@ static void wait_until_coredump_is_ready(DeprecatedString const& coredump_path)
     }
 }
 
+// Note: The coredump is compressed a chunk at a time, every one of which becomes a gzip member of its own. This way,
+//       only a single chunk of a coredump ever has to be in memory.
+static constexpr size_t compression_chunk_size = 1 * MiB;
+
+static ErrorOr<DeprecatedString> compress_coredump(DeprecatedString const& coredump_path)
+{
+    auto compressed_path = DeprecatedString::formatted("{}.gz", coredump_path);
+    auto input = TRY(Core::Stream::File::open(coredump_path, Core::Stream::OpenMode::Read));
+    auto output = TRY(Core::Stream::File::open(compressed_path, Core::Stream::OpenMode::Write | Core::Stream::OpenMode::MustBeNew, 0600));
+
+    {
+        Compress::GzipCompressor compressor { MaybeOwned<AK::Stream>(*output), Compress::DeflateCompressor::CompressionLevel::FAST };
+        auto buffer = TRY(ByteBuffer::create_uninitialized(compression_chunk_size));
+        while (true) {
+            auto chunk = TRY(input->read(buffer));
+            if (chunk.is_empty())
+                break;
+            TRY(compressor.write_entire_buffer(chunk));
+        }
+    }
+
+    TRY(Core::System::unlink(coredump_path));
+    return compressed_path;
+}
+
 static void launch_crash_reporter(DeprecatedString const& coredump_path, bool unlink_on_exit)
 {
     auto pid = Core::Process::spawn("/bin/CrashReporter"sv,
@@ -54,16 +81,20 @@ ErrorOr<int> serenity_main(Main::Arguments)
         VERIFY(event.has_value());
         if (event.value().type != Core::FileWatcherEvent::Type::ChildCreated)
             continue;
-        auto& coredump_path = event.value().event_path;
+        auto coredump_path = event.value().event_path;
+        // These are the compressed coredumps that we created ourselves.
+        if (coredump_path.ends_with(".gz"sv))
+            continue;
         dbgln("New coredump file: {}", coredump_path);
         wait_until_coredump_is_ready(coredump_path);
 
-        auto file_or_error = Core::MappedFile::map(coredump_path);
-        if (file_or_error.is_error()) {
-            dbgln("Unable to map coredump {}: {}", coredump_path, file_or_error.error());
+        auto compressed_path_or_error = compress_coredump(coredump_path);
+        if (compressed_path_or_error.is_error()) {
+            dbgln("Unable to compress coredump {}: {}", coredump_path, compressed_path_or_error.error());
+            launch_crash_reporter(coredump_path, true);
             continue;
         }
 
-        launch_crash_reporter(coredump_path, true);
+        launch_crash_reporter(compressed_path_or_error.value(), true);
     }
 }
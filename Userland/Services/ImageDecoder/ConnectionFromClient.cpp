@@ -6,6 +6,7 @@
 
 #include <AK/Debug.h>
 #include <ImageDecoder/ConnectionFromClient.h>
+#include <ImageDecoder/DecodedImageCache.h>
 #include <ImageDecoder/ImageDecoderClientEndpoint.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/ImageDecoder.h>
@@ -22,54 +23,119 @@ void ConnectionFromClient::die()
     Core::EventLoop::current().quit(0);
 }
 
-static void decode_image_to_bitmaps_and_durations_with_decoder(Gfx::ImageDecoder const& decoder, Vector<Gfx::ShareableBitmap>& bitmaps, Vector<u32>& durations)
+static Optional<DecodedImage> decode_image_with_decoder(Gfx::ImageDecoder const& decoder)
 {
+    if (!decoder.frame_count()) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Could not decode image from encoded data");
+        return {};
+    }
+
+    DecodedImage image;
+    image.is_animated = decoder.is_animated();
+    image.loop_count = decoder.loop_count();
     for (size_t i = 0; i < decoder.frame_count(); ++i) {
         auto frame_or_error = decoder.frame(i);
         if (frame_or_error.is_error()) {
-            bitmaps.append(Gfx::ShareableBitmap {});
-            durations.append(0);
+            image.frames.append(nullptr);
+            image.durations.append(0);
         } else {
             auto frame = frame_or_error.release_value();
-            bitmaps.append(frame.image->to_shareable_bitmap());
-            durations.append(frame.duration);
+            image.frames.append(move(frame.image));
+            image.durations.append(frame.duration);
         }
     }
+    return image;
 }
 
-static void decode_image_to_details(Core::AnonymousBuffer const& encoded_buffer, Optional<DeprecatedString> const& known_mime_type, bool& is_animated, u32& loop_count, Vector<Gfx::ShareableBitmap>& bitmaps, Vector<u32>& durations)
+static Messages::ImageDecoderServer::DecodeImageResponse to_decode_image_response(DecodedImage const& image)
 {
-    VERIFY(bitmaps.size() == 0);
-    VERIFY(durations.size() == 0);
+    Vector<Gfx::ShareableBitmap> bitmaps;
+    for (auto& frame : image.frames)
+        bitmaps.append(frame ? frame->to_shareable_bitmap() : Gfx::ShareableBitmap {});
+    return { image.is_animated, image.loop_count, move(bitmaps), image.durations };
+}
+
+Messages::ImageDecoderServer::DecodeImageResponse ConnectionFromClient::decode_image(Core::AnonymousBuffer const& encoded_buffer, Optional<DeprecatedString> const& mime_type)
+{
+    if (!encoded_buffer.is_valid()) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Encoded data is invalid");
+        return nullptr;
+    }
 
-    auto decoder = Gfx::ImageDecoder::try_create_for_raw_bytes(ReadonlyBytes { encoded_buffer.data<u8>(), encoded_buffer.size() }, known_mime_type);
+    ReadonlyBytes encoded_data { encoded_buffer.data<u8>(), encoded_buffer.size() };
+    auto key = DecodedImageCache::key_for(encoded_data, mime_type);
+    Optional<Messages::ImageDecoderServer::DecodeImageResponse> response;
+    if (DecodedImageCache::the().with_image(key, [&](auto& image) { response = to_decode_image_response(image); }))
+        return response.release_value();
+
+    auto decoder = Gfx::ImageDecoder::try_create_for_raw_bytes(encoded_data, mime_type);
     if (!decoder) {
         dbgln_if(IMAGE_DECODER_DEBUG, "Could not find suitable image decoder plugin for data");
-        return;
+        return { false, 0, {}, {} };
     }
 
-    if (!decoder->frame_count()) {
-        dbgln_if(IMAGE_DECODER_DEBUG, "Could not decode image from encoded data");
-        return;
+    auto image = decode_image_with_decoder(*decoder);
+    if (!image.has_value())
+        return { false, 0, {}, {} };
+
+    response = to_decode_image_response(*image);
+    DecodedImageCache::the().set(key, image.release_value());
+    return response.release_value();
+}
+
+Messages::ImageDecoderServer::DecodePartialImageResponse ConnectionFromClient::decode_partial_image(Core::AnonymousBuffer const& encoded_buffer, Optional<DeprecatedString> const& mime_type)
+{
+    if (!encoded_buffer.is_valid()) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Encoded data is invalid");
+        return Gfx::ShareableBitmap {};
     }
-    is_animated = decoder->is_animated();
-    loop_count = decoder->loop_count();
-    decode_image_to_bitmaps_and_durations_with_decoder(*decoder, bitmaps, durations);
+
+    auto decoder = Gfx::ImageDecoder::try_create_for_raw_bytes(ReadonlyBytes { encoded_buffer.data<u8>(), encoded_buffer.size() }, mime_type);
+    if (!decoder) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Could not find suitable image decoder plugin for data");
+        return Gfx::ShareableBitmap {};
+    }
+
+    auto frame_or_error = decoder->partial_frame();
+    if (frame_or_error.is_error()) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Could not decode partial image: {}", frame_or_error.error());
+        return Gfx::ShareableBitmap {};
+    }
+    return frame_or_error.value().image->to_shareable_bitmap();
 }
 
-Messages::ImageDecoderServer::DecodeImageResponse ConnectionFromClient::decode_image(Core::AnonymousBuffer const& encoded_buffer, Optional<DeprecatedString> const& mime_type)
+Messages::ImageDecoderServer::DecodeDownscaledImageResponse ConnectionFromClient::decode_downscaled_image(Core::AnonymousBuffer const& encoded_buffer, Optional<DeprecatedString> const& mime_type, Gfx::IntSize minimum_size)
 {
     if (!encoded_buffer.is_valid()) {
         dbgln_if(IMAGE_DECODER_DEBUG, "Encoded data is invalid");
-        return nullptr;
+        return Gfx::ShareableBitmap {};
     }
 
-    bool is_animated = false;
-    u32 loop_count = 0;
-    Vector<Gfx::ShareableBitmap> bitmaps;
-    Vector<u32> durations;
-    decode_image_to_details(encoded_buffer, mime_type, is_animated, loop_count, bitmaps, durations);
-    return { is_animated, loop_count, bitmaps, durations };
+    ReadonlyBytes encoded_data { encoded_buffer.data<u8>(), encoded_buffer.size() };
+    auto key = DecodedImageCache::key_for(encoded_data, mime_type, minimum_size);
+    Gfx::ShareableBitmap bitmap;
+    if (DecodedImageCache::the().with_image(key, [&](auto& image) { bitmap = image.frames.first()->to_shareable_bitmap(); }))
+        return bitmap;
+
+    auto decoder = Gfx::ImageDecoder::try_create_for_raw_bytes(encoded_data, mime_type);
+    if (!decoder) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Could not find suitable image decoder plugin for data");
+        return Gfx::ShareableBitmap {};
+    }
+
+    auto frame_or_error = decoder->downscaled_frame(0, minimum_size);
+    if (frame_or_error.is_error()) {
+        dbgln_if(IMAGE_DECODER_DEBUG, "Could not decode downscaled image: {}", frame_or_error.error());
+        return Gfx::ShareableBitmap {};
+    }
+
+    auto frame = frame_or_error.release_value();
+    bitmap = frame.image->to_shareable_bitmap();
+    DecodedImage image;
+    image.frames.append(move(frame.image));
+    image.durations.append(frame.duration);
+    DecodedImageCache::the().set(key, move(image));
+    return bitmap;
 }
 
 }
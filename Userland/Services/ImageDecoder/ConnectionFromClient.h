@@ -27,6 +27,8 @@ private:
     explicit ConnectionFromClient(NonnullOwnPtr<Core::Stream::LocalSocket>);
 
     virtual Messages::ImageDecoderServer::DecodeImageResponse decode_image(Core::AnonymousBuffer const&, Optional<DeprecatedString> const& mime_type) override;
+    virtual Messages::ImageDecoderServer::DecodePartialImageResponse decode_partial_image(Core::AnonymousBuffer const&, Optional<DeprecatedString> const& mime_type) override;
+    virtual Messages::ImageDecoderServer::DecodeDownscaledImageResponse decode_downscaled_image(Core::AnonymousBuffer const&, Optional<DeprecatedString> const& mime_type, Gfx::IntSize minimum_size) override;
 };
 
 }
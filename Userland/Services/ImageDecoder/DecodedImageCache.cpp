@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <ImageDecoder/DecodedImageCache.h>
+
+namespace ImageDecoder {
+
+// Note: This is how much memory the cached frames may take up before the least recently used images are evicted. The
+//       kernel may purge them long before that.
+static constexpr size_t maximum_cached_bytes = 64 * MiB;
+
+DecodedImageCache& DecodedImageCache::the()
+{
+    static DecodedImageCache s_the;
+    return s_the;
+}
+
+DecodedImageKey DecodedImageCache::key_for(ReadonlyBytes encoded_data, Optional<DeprecatedString> const& mime_type, Optional<Gfx::IntSize> minimum_size)
+{
+    return { Crypto::Hash::SHA256::hash(encoded_data.data(), encoded_data.size()), mime_type, minimum_size };
+}
+
+// Frames that are already backed by an anonymous buffer have been handed to the client as they are, so their memory
+// must not be purged from under it.
+static bool can_be_volatile(Gfx::Bitmap const& frame)
+{
+    return !frame.anonymous_buffer().is_valid();
+}
+
+bool DecodedImageCache::with_image(DecodedImageKey const& key, Function<void(DecodedImage const&)> callback)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+        return false;
+
+    auto& image = it->value.image;
+    bool has_all_frames = true;
+    for (auto& frame : image.frames) {
+        bool was_purged = false;
+        if (frame && (!frame->set_nonvolatile(was_purged) || was_purged))
+            has_all_frames = false;
+    }
+    if (!has_all_frames) {
+        remove(key);
+        return false;
+    }
+
+    it->value.last_use = ++m_use_counter;
+    callback(image);
+
+    for (auto& frame : image.frames) {
+        if (frame && can_be_volatile(*frame))
+            frame->set_volatile();
+    }
+    return true;
+}
+
+void DecodedImageCache::set(DecodedImageKey const& key, DecodedImage image)
+{
+    remove(key);
+
+    size_t size_in_bytes = 0;
+    for (auto& frame : image.frames) {
+        if (!frame)
+            continue;
+        size_in_bytes += frame->size_in_bytes();
+        if (can_be_volatile(*frame))
+            frame->set_volatile();
+    }
+    if (size_in_bytes > maximum_cached_bytes)
+        return;
+
+    evict_until_below(maximum_cached_bytes - size_in_bytes);
+    m_size_in_bytes += size_in_bytes;
+    m_entries.set(key, Entry { move(image), size_in_bytes, ++m_use_counter });
+}
+
+void DecodedImageCache::remove(DecodedImageKey const& key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+        return;
+    m_size_in_bytes -= it->value.size_in_bytes;
+    m_entries.remove(it);
+}
+
+void DecodedImageCache::evict_until_below(size_t size_in_bytes)
+{
+    while (m_size_in_bytes > size_in_bytes) {
+        auto least_recently_used = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->value.last_use < least_recently_used->value.last_use)
+                least_recently_used = it;
+        }
+        m_size_in_bytes -= least_recently_used->value.size_in_bytes;
+        m_entries.remove(least_recently_used);
+    }
+}
+
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/DeprecatedString.h>
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/RefPtr.h>
+#include <AK/Vector.h>
+#include <LibCrypto/Hash/SHA2.h>
+#include <LibGfx/Bitmap.h>
+#include <LibGfx/Size.h>
+
+namespace ImageDecoder {
+
+struct DecodedImageKey {
+    Crypto::Hash::SHA256::DigestType digest;
+    Optional<DeprecatedString> mime_type;
+    // The size that the image was downscaled for, if it was decoded with downscaled_frame().
+    Optional<Gfx::IntSize> minimum_size;
+
+    bool operator==(DecodedImageKey const&) const = default;
+};
+
+struct DecodedImage {
+    bool is_animated { false };
+    u32 loop_count { 0 };
+    // Note: Frames that could not be decoded are null.
+    Vector<RefPtr<Gfx::Bitmap>> frames;
+    Vector<u32> durations;
+};
+
+// Images that have been decoded before, looked up by a hash of their encoded data. The same favicons and sprite sheets
+// tend to be requested over and over again, and handing out copies of their frames is far cheaper than decoding them.
+// The frames are kept volatile while they're in the cache, so that the kernel can take their memory back whenever it
+// needs it; images that have been purged are simply decoded again.
+class DecodedImageCache {
+public:
+    static DecodedImageCache& the();
+
+    static DecodedImageKey key_for(ReadonlyBytes encoded_data, Optional<DeprecatedString> const& mime_type, Optional<Gfx::IntSize> minimum_size = {});
+
+    // Calls `callback` with the cached image, if there is one and none of its frames have been purged. The frames are
+    // only guaranteed to stay around until `callback` returns.
+    bool with_image(DecodedImageKey const&, Function<void(DecodedImage const&)> callback);
+    void set(DecodedImageKey const&, DecodedImage);
+
+private:
+    DecodedImageCache() = default;
+
+    struct Entry {
+        DecodedImage image;
+        size_t size_in_bytes { 0 };
+        u64 last_use { 0 };
+    };
+
+    void remove(DecodedImageKey const&);
+    void evict_until_below(size_t);
+
+    HashMap<DecodedImageKey, Entry> m_entries;
+    size_t m_size_in_bytes { 0 };
+    u64 m_use_counter { 0 };
+};
+
+}
+
+namespace AK {
+
+template<>
+struct Traits<ImageDecoder::DecodedImageKey> : public GenericTraits<ImageDecoder::DecodedImageKey> {
+    static unsigned hash(ImageDecoder::DecodedImageKey const& key)
+    {
+        // Note: The digest is as good a hash as any already, so its first bytes are used as is.
+        unsigned hash = 0;
+        __builtin_memcpy(&hash, key.digest.data, sizeof(hash));
+        if (key.mime_type.has_value())
+            hash = pair_int_hash(hash, key.mime_type->hash());
+        if (key.minimum_size.has_value())
+            hash = pair_int_hash(hash, pair_int_hash(key.minimum_size->width(), key.minimum_size->height()));
+        return hash;
+    }
+};
+
+}
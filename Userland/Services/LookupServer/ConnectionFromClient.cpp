@@ -15,6 +15,9 @@ using namespace DNS;
 
 static HashMap<int, RefPtr<ConnectionFromClient>> s_connections;
 
+// How long we wait for the IPv6 addresses of a name once its IPv4 addresses are in. (RFC 8305, 3)
+static constexpr int s_resolution_delay_ms = 50;
+
 ConnectionFromClient::ConnectionFromClient(NonnullOwnPtr<Core::Stream::LocalSocket> socket, int client_id)
     : IPC::ConnectionFromClient<LookupClientEndpoint, LookupServerEndpoint>(*this, move(socket), client_id)
 {
@@ -26,26 +29,52 @@ void ConnectionFromClient::die()
     s_connections.remove(client_id());
 }
 
-Messages::LookupServer::LookupNameResponse ConnectionFromClient::lookup_name(DeprecatedString const& name)
+ErrorOr<OwnPtr<IPC::MessageBuffer>> ConnectionFromClient::handle(IPC::Message const& message)
 {
-    auto maybe_answers = LookupServer::the().lookup(name, RecordType::A);
-    if (maybe_answers.is_error()) {
-        dbgln("LookupServer: Failed to lookup A record: {}", maybe_answers.error());
-        return { 1, {} };
+    switch (message.message_id()) {
+    case (int)Messages::LookupServer::MessageID::LookupName:
+        start_lookup_name(static_cast<Messages::LookupServer::LookupName const&>(message).name());
+        return nullptr;
+    case (int)Messages::LookupServer::MessageID::LookupAddress:
+        start_lookup_address(static_cast<Messages::LookupServer::LookupAddress const&>(message).address());
+        return nullptr;
+    default:
+        return LookupServerStub::handle(message);
     }
+}
 
-    auto answers = maybe_answers.release_value();
-    Vector<DeprecatedString> addresses;
-    for (auto& answer : answers) {
-        addresses.append(answer.record_data());
-    }
-    return { 0, move(addresses) };
+void ConnectionFromClient::start_lookup_name(DeprecatedString const& name)
+{
+    LookupServer::the().lookup(name, RecordType::A, [weak_this = make_weak_ptr<ConnectionFromClient>()](auto maybe_answers) {
+        if (!weak_this || !weak_this->is_open())
+            return;
+
+        Messages::LookupServer::LookupNameResponse response { 1, {} };
+        if (maybe_answers.is_error()) {
+            dbgln("LookupServer: Failed to lookup A record: {}", maybe_answers.error());
+        } else {
+            Vector<DeprecatedString> addresses;
+            for (auto& answer : maybe_answers.value())
+                addresses.append(answer.record_data());
+            response = { 0, move(addresses) };
+        }
+
+        if (auto result = weak_this->post_message(response); result.is_error())
+            dbgln("LookupServer: Failed to send response: {}", result.error());
+    });
 }
 
-Messages::LookupServer::LookupAddressResponse ConnectionFromClient::lookup_address(DeprecatedString const& address)
+void ConnectionFromClient::start_lookup_address(DeprecatedString const& address)
 {
+    auto send_response = [weak_this = make_weak_ptr<ConnectionFromClient>()](Messages::LookupServer::LookupAddressResponse const& response) {
+        if (!weak_this || !weak_this->is_open())
+            return;
+        if (auto result = weak_this->post_message(response); result.is_error())
+            dbgln("LookupServer: Failed to send response: {}", result.error());
+    };
+
     if (address.length() != 4)
-        return { 1, DeprecatedString() };
+        return send_response({ 1, DeprecatedString() });
     IPv4Address ip_address { (u8 const*)address.characters() };
     auto name = DeprecatedString::formatted("{}.{}.{}.{}.in-addr.arpa",
         ip_address[3],
@@ -53,15 +82,105 @@ Messages::LookupServer::LookupAddressResponse ConnectionFromClient::lookup_addre
         ip_address[1],
         ip_address[0]);
 
-    auto maybe_answers = LookupServer::the().lookup(name, RecordType::PTR);
+    LookupServer::the().lookup(name, RecordType::PTR, [send_response = move(send_response)](auto maybe_answers) {
+        if (maybe_answers.is_error()) {
+            dbgln("LookupServer: Failed to lookup PTR record: {}", maybe_answers.error());
+            return send_response({ 1, DeprecatedString() });
+        }
+
+        auto answers = maybe_answers.release_value();
+        if (answers.is_empty())
+            return send_response({ 1, DeprecatedString() });
+        send_response({ 0, answers[0].record_data() });
+    });
+}
+
+Messages::LookupServer::LookupNameResponse ConnectionFromClient::lookup_name(DeprecatedString const&)
+{
+    // Handled by start_lookup_name() instead, see handle().
+    VERIFY_NOT_REACHED();
+}
+
+Messages::LookupServer::LookupAddressResponse ConnectionFromClient::lookup_address(DeprecatedString const&)
+{
+    // Handled by start_lookup_address() instead, see handle().
+    VERIFY_NOT_REACHED();
+}
+
+void ConnectionFromClient::resolve(i32 request_id, DeprecatedString const& name)
+{
+    if (m_resolutions.contains(request_id)) {
+        dbgln("LookupServer: Client is already resolving something as request {}", request_id);
+        return;
+    }
+    m_resolutions.set(request_id, {});
+
+    for (auto record_type : { RecordType::AAAA, RecordType::A }) {
+        LookupServer::the().lookup(name, record_type, [weak_this = make_weak_ptr<ConnectionFromClient>(), request_id, record_type](auto maybe_answers) {
+            if (weak_this)
+                weak_this->did_look_up(request_id, record_type, move(maybe_answers));
+        });
+    }
+}
+
+void ConnectionFromClient::did_look_up(i32 request_id, RecordType record_type, ErrorOr<Vector<Answer>> maybe_answers)
+{
+    auto it = m_resolutions.find(request_id);
+    if (it == m_resolutions.end())
+        return;
+    auto& resolution = it->value;
+
+    Vector<DeprecatedString> addresses;
     if (maybe_answers.is_error()) {
-        dbgln("LookupServer: Failed to lookup PTR record: {}", maybe_answers.error());
-        return { 1, DeprecatedString() };
+        dbgln("LookupServer: Failed to lookup {} record: {}", record_type, maybe_answers.error());
+    } else {
+        for (auto& answer : maybe_answers.value())
+            addresses.append(answer.record_data());
+    }
+
+    if (record_type == RecordType::AAAA)
+        resolution.ipv6_addresses = move(addresses);
+    else
+        resolution.ipv4_addresses = move(addresses);
+
+    if (resolution.did_respond)
+        return;
+    if (resolution.ipv6_addresses.has_value() && resolution.ipv4_addresses.has_value())
+        return send_resolution(request_id);
+
+    // The client can start connecting to the IPv4 addresses already, so it shouldn't have to wait for long.
+    if (resolution.ipv4_addresses.has_value() && !resolution.ipv4_addresses->is_empty()) {
+        resolution.resolution_delay_timer = MUST(Core::Timer::create_single_shot(s_resolution_delay_ms, [weak_this = make_weak_ptr<ConnectionFromClient>(), request_id] {
+            if (weak_this)
+                weak_this->send_resolution(request_id);
+        }));
+        resolution.resolution_delay_timer->start();
     }
+}
 
-    auto answers = maybe_answers.release_value();
-    if (answers.is_empty())
-        return { 1, DeprecatedString() };
-    return { 0, answers[0].record_data() };
+void ConnectionFromClient::send_resolution(i32 request_id)
+{
+    auto it = m_resolutions.find(request_id);
+    if (it == m_resolutions.end() || it->value.did_respond)
+        return;
+    auto& resolution = it->value;
+    resolution.did_respond = true;
+    if (resolution.resolution_delay_timer)
+        resolution.resolution_delay_timer->stop();
+
+    Vector<DeprecatedString> addresses;
+    if (resolution.ipv6_addresses.has_value())
+        addresses.extend(resolution.ipv6_addresses.release_value());
+    if (resolution.ipv4_addresses.has_value())
+        addresses.extend(resolution.ipv4_addresses.release_value());
+    int code = addresses.is_empty() ? 1 : 0;
+    if (is_open())
+        async_resolved(request_id, code, move(addresses));
+
+    // Note: We may be in the callback of the resolution delay timer, or the other lookup may still come in.
+    deferred_invoke([this, request_id] {
+        m_resolutions.remove(request_id);
+    });
 }
+
 }
@@ -7,6 +7,8 @@
 #pragma once
 
 #include <AK/HashMap.h>
+#include <LibCore/Timer.h>
+#include <LibDNS/Answer.h>
 #include <LibIPC/ConnectionFromClient.h>
 #include <LookupServer/LookupClientEndpoint.h>
 #include <LookupServer/LookupServerEndpoint.h>
@@ -25,8 +27,26 @@ public:
 private:
     explicit ConnectionFromClient(NonnullOwnPtr<Core::Stream::LocalSocket>, int client_id);
 
+    // Lookups can take a while, and other clients shouldn't have to wait for them. Rather than from the handlers
+    // below, their responses are therefore sent whenever the answers come in.
+    virtual ErrorOr<OwnPtr<IPC::MessageBuffer>> handle(IPC::Message const&) override;
+    void start_lookup_name(DeprecatedString const&);
+    void start_lookup_address(DeprecatedString const&);
+
     virtual Messages::LookupServer::LookupNameResponse lookup_name(DeprecatedString const&) override;
     virtual Messages::LookupServer::LookupAddressResponse lookup_address(DeprecatedString const&) override;
+    virtual void resolve(i32 request_id, DeprecatedString const& name) override;
+
+    struct Resolution {
+        Optional<Vector<DeprecatedString>> ipv6_addresses;
+        Optional<Vector<DeprecatedString>> ipv4_addresses;
+        RefPtr<Core::Timer> resolution_delay_timer;
+        bool did_respond { false };
+    };
+    void did_look_up(i32 request_id, DNS::RecordType, ErrorOr<Vector<DNS::Answer>>);
+    void send_resolution(i32 request_id);
+
+    HashMap<i32, Resolution> m_resolutions;
 };
 
 }
@@ -41,29 +41,47 @@ ErrorOr<void> DNSServer::handle_client()
         return {};
     }
 
-    LookupServer& lookup_server = LookupServer::the();
-
     Packet response;
     response.set_is_response();
     response.set_id(request.id());
 
-    for (auto& question : request.questions()) {
-        if (question.class_code() != RecordClass::IN)
-            continue;
-        response.add_question(question);
-        auto answers = TRY(lookup_server.lookup(question.name(), question.record_type()));
-        for (auto& answer : answers) {
-            response.add_answer(answer);
-        }
+    answer_questions(move(request), move(response), 0, client_address);
+    return {};
+}
+
+// Note: The questions are answered one after the other, each one once the lookup for the one before has finished.
+void DNSServer::answer_questions(Packet request, Packet response, size_t question_index, sockaddr_in client_address)
+{
+    while (question_index < request.questions().size() && request.questions()[question_index].class_code() != RecordClass::IN)
+        ++question_index;
+
+    if (question_index == request.questions().size()) {
+        if (auto result = send_response(response, client_address); result.is_error())
+            dbgln("DNSServer: Failed to send response: {}", result.error());
+        return;
     }
 
+    auto question = request.questions()[question_index];
+    response.add_question(question);
+    LookupServer::the().lookup(question.name(), question.record_type(), [this, request = move(request), response = move(response), question_index, client_address](auto maybe_answers) mutable {
+        if (maybe_answers.is_error()) {
+            dbgln("DNSServer: Failed to handle client: {}", maybe_answers.error());
+            return;
+        }
+        for (auto& answer : maybe_answers.value())
+            response.add_answer(answer);
+        answer_questions(move(request), move(response), question_index + 1, client_address);
+    });
+}
+
+ErrorOr<void> DNSServer::send_response(Packet& response, sockaddr_in const& client_address)
+{
     if (response.answer_count() == 0)
         response.set_code(Packet::Code::NXDOMAIN);
     else
         response.set_code(Packet::Code::NOERROR);
 
-    buffer = TRY(response.to_byte_buffer());
-
+    auto buffer = TRY(response.to_byte_buffer());
     TRY(send(buffer, client_address));
     return {};
 }
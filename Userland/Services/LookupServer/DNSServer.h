@@ -7,9 +7,13 @@
 #pragma once
 
 #include <LibCore/UDPServer.h>
+#include <LibDNS/Packet.h>
+#include <netinet/in.h>
 
 namespace LookupServer {
 
+using namespace DNS;
+
 class DNSServer : public Core::UDPServer {
     C_OBJECT(DNSServer)
 
@@ -17,6 +21,8 @@ private:
     explicit DNSServer(Object* parent = nullptr);
 
     ErrorOr<void> handle_client();
+    void answer_questions(Packet request, Packet response, size_t question_index, sockaddr_in client_address);
+    ErrorOr<void> send_response(Packet&, sockaddr_in const& client_address);
 };
 
 }
@@ -9,7 +9,7 @@
 #include <AK/Debug.h>
 #include <AK/DeprecatedString.h>
 #include <AK/HashMap.h>
-#include <AK/Random.h>
+#include <AK/AnyOf.h>
 #include <AK/StringBuilder.h>
 #include <LibCore/ConfigFile.h>
 #include <LibCore/File.h>
@@ -26,6 +26,10 @@ namespace LookupServer {
 static LookupServer* s_the;
 // NOTE: This is the TTL we return for the hostname or answers from /etc/hosts.
 static constexpr u32 s_static_ttl = 86400;
+// NOTE: This is how long we remember that a name has no records of a type. RFC 2308 would have us take it from the SOA
+//       record that comes with such a response, but we don't parse that (yet), so it's kept short.
+static constexpr time_t s_negative_ttl = 60;
+static constexpr size_t s_max_cached_names = 1024;
 
 LookupServer& LookupServer::the()
 {
@@ -132,31 +136,27 @@ static DeprecatedString get_hostname()
     return buffer;
 }
 
-ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, RecordType record_type)
+// Gives the answers the name in the case it was asked for, since that's what some clients expect to get back.
+static Vector<Answer> answers_for(Name const& name, RecordType record_type, Vector<Answer> const& answers)
 {
-    dbgln_if(LOOKUPSERVER_DEBUG, "Got request for '{}'", name.as_string());
+    Vector<Answer> answers_with_original_case;
+    for (auto& answer : answers) {
+        if (answer.type() != record_type)
+            continue;
+        answers_with_original_case.empend(name, answer.type(), answer.class_code(), answer.ttl(), answer.record_data(), answer.mdns_cache_flush());
+    }
+    return answers_with_original_case;
+}
 
-    Vector<Answer> answers;
-    auto add_answer = [&](Answer const& answer) {
-        Answer answer_with_original_case {
-            name,
-            answer.type(),
-            answer.class_code(),
-            answer.ttl(),
-            answer.record_data(),
-            answer.mdns_cache_flush(),
-        };
-        answers.append(answer_with_original_case);
-    };
+void LookupServer::lookup(Name const& name, RecordType record_type, Function<void(ErrorOr<Vector<Answer>>)> callback)
+{
+    dbgln_if(LOOKUPSERVER_DEBUG, "Got request for '{}'", name.as_string());
 
     // First, try /etc/hosts.
     if (auto local_answers = m_etc_hosts.find(name); local_answers != m_etc_hosts.end()) {
-        for (auto& answer : local_answers->value) {
-            if (answer.type() == record_type)
-                add_answer(answer);
-        }
+        auto answers = answers_for(name, record_type, local_answers->value);
         if (!answers.is_empty())
-            return answers;
+            return callback(move(answers));
     }
 
     // Second, try the hostname.
@@ -164,144 +164,137 @@ ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, RecordType record
     if (record_type == RecordType::A && get_hostname() == name) {
         IPv4Address address = { 127, 0, 0, 1 };
         auto raw_address = address.to_in_addr_t();
-        Answer answer { name, RecordType::A, RecordClass::IN, s_static_ttl, DeprecatedString { (char const*)&raw_address, sizeof(raw_address) }, false };
-        answers.append(move(answer));
-        return answers;
+        Vector<Answer> answers;
+        answers.empend(name, RecordType::A, RecordClass::IN, s_static_ttl, DeprecatedString { (char const*)&raw_address, sizeof(raw_address) }, false);
+        return callback(move(answers));
     }
 
     // Third, try our cache.
-    if (auto cached_answers = m_lookup_cache.find(name); cached_answers != m_lookup_cache.end()) {
-        for (auto& answer : cached_answers->value) {
-            // TODO: Actually remove expired answers from the cache.
-            if (answer.type() == record_type && !answer.has_expired()) {
-                dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {}", name.as_string(), answer.record_data());
-                add_answer(answer);
-            }
-        }
-        if (!answers.is_empty())
-            return answers;
-    }
+    if (auto cached_answers = lookup_in_cache(name, record_type); cached_answers.has_value())
+        return callback(answers_for(name, record_type, *cached_answers));
 
     // Fourth, look up .local names using mDNS instead of DNS nameservers.
+    // FIXME: This still blocks everyone else while we wait for a response.
     if (name.as_string().ends_with(".local"sv)) {
-        answers = TRY(m_mdns->lookup(name, record_type));
-        for (auto& answer : answers)
+        auto answers = m_mdns->lookup(name, record_type);
+        if (answers.is_error())
+            return callback(answers.release_error());
+        for (auto& answer : answers.value())
             put_in_cache(answer);
-        return answers;
+        return callback(answers.release_value());
     }
 
     // Fifth, ask the upstream nameservers.
-    for (auto& nameserver : m_nameservers) {
-        dbgln_if(LOOKUPSERVER_DEBUG, "Doing lookup using nameserver '{}'", nameserver);
-        bool did_get_response = false;
-        int retries = 3;
-        Vector<Answer> upstream_answers;
-        do {
-            auto upstream_answers_or_error = lookup(name, nameserver, did_get_response, record_type);
-            if (upstream_answers_or_error.is_error())
-                continue;
-            upstream_answers = upstream_answers_or_error.release_value();
-            if (did_get_response)
-                break;
-        } while (--retries);
-        if (!upstream_answers.is_empty()) {
-            for (auto& answer : upstream_answers)
-                add_answer(answer);
-            break;
-        } else {
-            if (!did_get_response)
-                dbgln("Never got a response from '{}', trying next nameserver", nameserver);
-            else
-                dbgln("Received response from '{}' but no result(s), trying next nameserver", nameserver);
-        }
-    }
-
-    // Sixth, fail.
-    if (answers.is_empty()) {
-        dbgln("Tried all nameservers but never got a response :(");
-        return Vector<Answer> {};
-    }
-
-    return answers;
+    ask_upstream(name, record_type, [name, record_type, callback = move(callback)](Vector<Answer> answers) {
+        callback(answers_for(name, record_type, answers));
+    });
 }
 
-ErrorOr<Vector<Answer>> LookupServer::lookup(Name const& name, DeprecatedString const& nameserver, bool& did_get_response, RecordType record_type, ShouldRandomizeCase should_randomize_case)
+void LookupServer::ask_upstream(Name const& name, RecordType record_type, Function<void(Vector<Answer>)> callback)
 {
-    Packet request;
-    request.set_is_query();
-    request.set_id(get_random_uniform(UINT16_MAX));
-    Name name_in_question = name;
-    if (should_randomize_case == ShouldRandomizeCase::Yes)
-        name_in_question.randomize_case();
-    request.add_question({ name_in_question, record_type, RecordClass::IN, false });
+    UpstreamQueryKey key { name, record_type };
 
-    auto buffer = TRY(request.to_byte_buffer());
+    // Everyone asking the same question at the same time can wait for the same answer.
+    if (auto it = m_upstream_queries.find(key); it != m_upstream_queries.end()) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "Waiting for the lookup of '{}' that's already under way", name.as_string());
+        it->value.callbacks.append(move(callback));
+        return;
+    }
 
-    auto udp_socket = TRY(Core::Stream::UDPSocket::connect(nameserver, 53, Time::from_seconds(1)));
-    TRY(udp_socket->set_blocking(true));
+    auto query = UpstreamQuery::construct(name, record_type, m_nameservers);
+    query->on_finish = [this, key](Optional<Packet> response) {
+        finish_upstream_query(key, move(response));
+    };
 
-    TRY(udp_socket->write(buffer));
+    PendingUpstreamQuery pending_query { query, {} };
+    pending_query.callbacks.append(move(callback));
+    m_upstream_queries.set(key, move(pending_query));
+    query->start();
+}
 
-    u8 response_buffer[4096];
-    int nrecv = TRY(udp_socket->read({ response_buffer, sizeof(response_buffer) })).size();
-    if (udp_socket->is_eof())
-        return Vector<Answer> {};
+void LookupServer::finish_upstream_query(UpstreamQueryKey const& key, Optional<Packet> response)
+{
+    auto pending_query = m_upstream_queries.take(key);
+    VERIFY(pending_query.has_value());
 
-    did_get_response = true;
+    Vector<Answer> answers;
+    if (response.has_value()) {
+        for (auto& answer : response->answers()) {
+            put_in_cache(answer);
+            if (answer.type() == key.record_type)
+                answers.append(answer);
+        }
+        if (answers.is_empty()) {
+            dbgln_if(LOOKUPSERVER_DEBUG, "No {} record(s) for '{}'", key.record_type, key.name.as_string());
+            put_negative_answer_in_cache(key.name, key.record_type);
+        }
+    } else {
+        // Sixth, fail.
+        dbgln("Tried all nameservers but never got a response :(");
+    }
+
+    for (auto& callback : pending_query->callbacks)
+        callback(answers);
+}
 
-    auto o_response = Packet::from_raw_packet(response_buffer, nrecv);
-    if (!o_response.has_value())
-        return Vector<Answer> {};
+void LookupServer::CachedName::remove_expired_answers()
+{
+    auto now = time(nullptr);
+    answers.remove_all_matching([](auto& answer) { return answer.has_expired(); });
+    negative_answers.remove_all_matching([&](auto& negative_answer) { return negative_answer.expiry_time <= now; });
+}
 
-    auto& response = o_response.value();
+Optional<Vector<Answer>> LookupServer::lookup_in_cache(Name const& name, RecordType record_type)
+{
+    auto it = m_lookup_cache.find(name);
+    if (it == m_lookup_cache.end())
+        return {};
 
-    if (response.id() != request.id()) {
-        dbgln("LookupServer: ID mismatch ({} vs {}) :(", response.id(), request.id());
-        return Vector<Answer> {};
+    auto& cached_name = it->value;
+    cached_name.remove_expired_answers();
+    if (cached_name.is_empty()) {
+        m_lookup_cache.remove(it);
+        return {};
     }
+    cached_name.last_use = ++m_cache_use_counter;
 
-    if (response.code() == Packet::Code::REFUSED) {
-        if (should_randomize_case == ShouldRandomizeCase::Yes) {
-            // Retry with 0x20 case randomization turned off.
-            return lookup(name, nameserver, did_get_response, record_type, ShouldRandomizeCase::No);
+    Vector<Answer> answers;
+    for (auto& answer : cached_name.answers) {
+        if (answer.type() == record_type) {
+            dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} -> {}", name.as_string(), answer.record_data());
+            answers.append(answer);
         }
-        return Vector<Answer> {};
     }
+    if (!answers.is_empty())
+        return answers;
 
-    if (response.question_count() != request.question_count()) {
-        dbgln("LookupServer: Question count ({} vs {}) :(", response.question_count(), request.question_count());
-        return Vector<Answer> {};
+    if (any_of(cached_name.negative_answers, [&](auto& negative_answer) { return negative_answer.type == record_type; })) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "Cache hit: {} has no {} record(s)", name.as_string(), record_type);
+        return answers;
     }
+    return {};
+}
 
-    // Verify the questions in our request and in their response match, ignoring case.
-    for (size_t i = 0; i < request.question_count(); ++i) {
-        auto& request_question = request.questions()[i];
-        auto& response_question = response.questions()[i];
-        bool match = request_question.class_code() == response_question.class_code()
-            && request_question.record_type() == response_question.record_type()
-            && request_question.name().as_string().equals_ignoring_case(response_question.name().as_string());
-        if (!match) {
-            dbgln("Request and response questions do not match");
-            dbgln("   Request: name=_{}_, type={}, class={}", request_question.name().as_string(), response_question.record_type(), response_question.class_code());
-            dbgln("  Response: name=_{}_, type={}, class={}", response_question.name().as_string(), response_question.record_type(), response_question.class_code());
-            return Vector<Answer> {};
-        }
-    }
+void LookupServer::make_room_in_cache()
+{
+    if (m_lookup_cache.size() < s_max_cached_names)
+        return;
 
-    if (response.answer_count() < 1) {
-        dbgln("LookupServer: No answers :(");
-        return Vector<Answer> {};
-    }
+    // Names whose answers have all expired are the first to go.
+    m_lookup_cache.remove_all_matching([](auto&, auto& cached_name) {
+        cached_name.remove_expired_answers();
+        return cached_name.is_empty();
+    });
+    if (m_lookup_cache.size() < s_max_cached_names)
+        return;
 
-    Vector<Answer, 8> answers;
-    for (auto& answer : response.answers()) {
-        put_in_cache(answer);
-        if (answer.type() != record_type)
-            continue;
-        answers.append(answer);
+    auto least_recently_used = m_lookup_cache.begin();
+    for (auto it = m_lookup_cache.begin(); it != m_lookup_cache.end(); ++it) {
+        if (it->value.last_use < least_recently_used->value.last_use)
+            least_recently_used = it;
     }
-
-    return answers;
+    dbgln_if(LOOKUPSERVER_DEBUG, "Evicting {} from the cache", least_recently_used->key.as_string());
+    m_lookup_cache.remove(least_recently_used);
 }
 
 void LookupServer::put_in_cache(Answer const& answer)
@@ -309,31 +302,39 @@ void LookupServer::put_in_cache(Answer const& answer)
     if (answer.has_expired())
         return;
 
-    // Prevent the cache from growing too big.
-    // TODO: Evict least used entries.
-    if (m_lookup_cache.size() >= 256)
-        m_lookup_cache.remove(m_lookup_cache.begin());
-
     auto it = m_lookup_cache.find(answer.name());
-    if (it == m_lookup_cache.end())
-        m_lookup_cache.set(answer.name(), { answer });
-    else {
-        if (answer.mdns_cache_flush()) {
-            auto now = time(nullptr);
+    if (it == m_lookup_cache.end()) {
+        make_room_in_cache();
+        m_lookup_cache.set(answer.name(), CachedName { { answer }, {}, ++m_cache_use_counter });
+        return;
+    }
 
-            it->value.remove_all_matching([&](Answer const& other_answer) {
-                if (other_answer.type() != answer.type() || other_answer.class_code() != answer.class_code())
-                    return false;
+    auto& cached_name = it->value;
+    cached_name.remove_expired_answers();
+    if (answer.mdns_cache_flush()) {
+        auto now = time(nullptr);
 
-                if (other_answer.received_time() >= now - 1)
-                    return false;
+        cached_name.answers.remove_all_matching([&](Answer const& other_answer) {
+            if (other_answer.type() != answer.type() || other_answer.class_code() != answer.class_code())
+                return false;
 
-                dbgln_if(LOOKUPSERVER_DEBUG, "Removing cache entry: {}", other_answer.name());
-                return true;
-            });
-        }
-        it->value.append(answer);
+            if (other_answer.received_time() >= now - 1)
+                return false;
+
+            dbgln_if(LOOKUPSERVER_DEBUG, "Removing cache entry: {}", other_answer.name());
+            return true;
+        });
     }
+    cached_name.negative_answers.remove_all_matching([&](auto& negative_answer) { return negative_answer.type == answer.type(); });
+    cached_name.answers.append(answer);
+}
+
+void LookupServer::put_negative_answer_in_cache(Name const& name, RecordType record_type)
+{
+    if (!m_lookup_cache.contains(name))
+        make_room_in_cache();
+    auto& cached_name = m_lookup_cache.ensure(name, [&] { return CachedName { {}, {}, ++m_cache_use_counter }; });
+    cached_name.negative_answers.append({ record_type, time(nullptr) + s_negative_ttl });
 }
 
 }
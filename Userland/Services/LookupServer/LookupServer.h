@@ -9,6 +9,9 @@
 #include "ConnectionFromClient.h"
 #include "DNSServer.h"
 #include "MulticastDNS.h"
+#include "UpstreamQuery.h"
+#include <AK/Function.h>
+#include <AK/HashMap.h>
 #include <LibCore/FileWatcher.h>
 #include <LibCore/Object.h>
 #include <LibDNS/Name.h>
@@ -19,20 +22,67 @@ namespace LookupServer {
 
 using namespace DNS;
 
+struct UpstreamQueryKey {
+    Name name;
+    RecordType record_type;
+
+    bool operator==(UpstreamQueryKey const&) const = default;
+};
+
+}
+
+template<>
+struct AK::Traits<LookupServer::UpstreamQueryKey> : public GenericTraits<LookupServer::UpstreamQueryKey> {
+    static unsigned hash(LookupServer::UpstreamQueryKey const& key)
+    {
+        return pair_int_hash(DNS::Name::Traits::hash(key.name), to_underlying(key.record_type));
+    }
+};
+
+namespace LookupServer {
+
 class LookupServer final : public Core::Object {
     C_OBJECT(LookupServer);
 
 public:
     static LookupServer& the();
-    ErrorOr<Vector<Answer>> lookup(Name const& name, RecordType record_type);
+
+    // Calls `callback` with the answers once they're known, which may be right away.
+    void lookup(Name const& name, RecordType record_type, Function<void(ErrorOr<Vector<Answer>>)> callback);
 
 private:
     LookupServer();
 
     void load_etc_hosts();
+
+    struct NegativeAnswer {
+        RecordType type;
+        time_t expiry_time { 0 };
+    };
+
+    struct CachedName {
+        Vector<Answer> answers;
+        // The record types that the name is known not to have.
+        Vector<NegativeAnswer> negative_answers;
+        u64 last_use { 0 };
+
+        void remove_expired_answers();
+        bool is_empty() const { return answers.is_empty() && negative_answers.is_empty(); }
+    };
+
+    Optional<Vector<Answer>> lookup_in_cache(Name const&, RecordType);
     void put_in_cache(Answer const&);
+    void put_negative_answer_in_cache(Name const&, RecordType);
+    void make_room_in_cache();
+
+    void ask_upstream(Name const&, RecordType, Function<void(Vector<Answer>)> callback);
+    void finish_upstream_query(UpstreamQueryKey const&, Optional<Packet> response);
 
-    ErrorOr<Vector<Answer>> lookup(Name const& hostname, DeprecatedString const& nameserver, bool& did_get_response, RecordType record_type, ShouldRandomizeCase = ShouldRandomizeCase::Yes);
+    struct PendingUpstreamQuery {
+        NonnullRefPtr<UpstreamQuery> query;
+        // Everyone who asked the same question while the query was under way.
+        Vector<Function<void(Vector<Answer>)>> callbacks;
+    };
 
     OwnPtr<IPC::MultiServer<ConnectionFromClient>> m_server;
     RefPtr<DNSServer> m_dns_server;
@@ -40,7 +90,9 @@ private:
     Vector<DeprecatedString> m_nameservers;
     RefPtr<Core::FileWatcher> m_file_watcher;
     HashMap<Name, Vector<Answer>, Name::Traits> m_etc_hosts;
-    HashMap<Name, Vector<Answer>, Name::Traits> m_lookup_cache;
+    HashMap<Name, CachedName, Name::Traits> m_lookup_cache;
+    u64 m_cache_use_counter { 0 };
+    HashMap<UpstreamQueryKey, PendingUpstreamQuery> m_upstream_queries;
 };
 
 }
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "UpstreamQuery.h"
+#include <AK/AllOf.h>
+#include <AK/Debug.h>
+#include <AK/Endian.h>
+#include <AK/IPv4Address.h>
+#include <AK/Random.h>
+#include <LibCore/SocketAddress.h>
+#include <LibCore/System.h>
+#include <sys/socket.h>
+
+namespace LookupServer {
+
+// How long we give a nameserver to respond before asking it again, and how often we ask before giving up on it.
+static constexpr int s_attempt_timeout_ms = 1000;
+static constexpr int s_max_attempts = 3;
+
+static Packet build_request(Name const& name, RecordType record_type, ShouldRandomizeCase should_randomize_case)
+{
+    Packet request;
+    request.set_is_query();
+    request.set_id(get_random_uniform(UINT16_MAX));
+    Name name_in_question = name;
+    if (should_randomize_case == ShouldRandomizeCase::Yes)
+        name_in_question.randomize_case();
+    request.add_question({ name_in_question, record_type, RecordClass::IN, false });
+    return request;
+}
+
+UpstreamQuery::UpstreamQuery(Name const& name, RecordType record_type, Vector<DeprecatedString> const& nameservers)
+    : m_name(name)
+    , m_record_type(record_type)
+{
+    for (auto& address : nameservers) {
+        auto nameserver = make<Nameserver>();
+        nameserver->address = address;
+        nameserver->request = build_request(m_name, m_record_type, nameserver->should_randomize_case);
+        m_nameservers.append(move(nameserver));
+    }
+}
+
+void UpstreamQuery::start()
+{
+    m_timer = MUST(Core::Timer::create_repeating(s_attempt_timeout_ms, [this] { handle_timeout(); }, this));
+    m_timer->start();
+
+    if (m_nameservers.is_empty())
+        return finish({});
+
+    for (auto& nameserver : m_nameservers) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "Doing lookup using nameserver '{}'", nameserver->address);
+        if (auto result = send_datagram(*nameserver); result.is_error()) {
+            dbgln("LookupServer: Failed to send query to '{}': {}", nameserver->address, result.error());
+            give_up_on(*nameserver);
+        }
+    }
+}
+
+ErrorOr<void> UpstreamQuery::send_datagram(Nameserver& nameserver)
+{
+    if (!nameserver.udp_socket) {
+        nameserver.udp_socket = TRY(Core::Stream::UDPSocket::connect(nameserver.address, 53));
+        TRY(nameserver.udp_socket->set_blocking(false));
+        nameserver.udp_socket->on_ready_to_read = [this, &nameserver] {
+            if (auto result = receive_datagram(nameserver); result.is_error()) {
+                dbgln("LookupServer: Failed to receive response from '{}': {}", nameserver.address, result.error());
+                give_up_on(nameserver);
+            }
+        };
+    }
+
+    // Note: Every attempt asks the same question with the same ID, so a late response to an earlier one is still good.
+    ++nameserver.attempts;
+    auto buffer = TRY(nameserver.request.to_byte_buffer());
+    TRY(nameserver.udp_socket->write(buffer));
+    return {};
+}
+
+ErrorOr<void> UpstreamQuery::receive_datagram(Nameserver& nameserver)
+{
+    u8 response_buffer[4096];
+    auto response = TRY(nameserver.udp_socket->read({ response_buffer, sizeof(response_buffer) }));
+    handle_response(nameserver, response);
+    return {};
+}
+
+ErrorOr<void> UpstreamQuery::connect_over_tcp(Nameserver& nameserver)
+{
+    nameserver.state = State::WaitingForStream;
+    nameserver.attempts = 1;
+    nameserver.udp_socket->set_notifications_enabled(false);
+
+    auto address = IPv4Address::from_string(nameserver.address);
+    if (!address.has_value())
+        return Error::from_string_literal("Nameserver address is not an IPv4 address");
+
+    auto fd = TRY(Core::System::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+    auto socket_or_error = Core::Stream::TCPSocket::adopt_fd(fd);
+    if (socket_or_error.is_error()) {
+        (void)Core::System::close(fd);
+        return socket_or_error.release_error();
+    }
+    nameserver.tcp_socket = socket_or_error.release_value();
+    nameserver.tcp_socket->on_ready_to_read = [this, &nameserver] {
+        if (auto result = receive_over_tcp(nameserver); result.is_error()) {
+            dbgln("LookupServer: Failed to receive response from '{}' over TCP: {}", nameserver.address, result.error());
+            give_up_on(nameserver);
+        }
+    };
+
+    auto socket_address = Core::SocketAddress { *address, 53 }.to_sockaddr_in();
+    if (auto result = Core::System::connect(fd, bit_cast<sockaddr*>(&socket_address), sizeof(socket_address)); result.is_error()) {
+        if (!result.error().is_errno() || result.error().code() != EINPROGRESS)
+            return result.release_error();
+    }
+
+    nameserver.tcp_connect_notifier = Core::Notifier::construct(fd, Core::Notifier::Write);
+    nameserver.tcp_connect_notifier->on_ready_to_write = [this, &nameserver] {
+        nameserver.tcp_connect_notifier->set_enabled(false);
+        if (auto result = send_over_tcp(nameserver); result.is_error()) {
+            dbgln("LookupServer: Failed to send query to '{}' over TCP: {}", nameserver.address, result.error());
+            give_up_on(nameserver);
+        }
+    };
+    return {};
+}
+
+ErrorOr<void> UpstreamQuery::send_over_tcp(Nameserver& nameserver)
+{
+    int error = 0;
+    socklen_t error_size = sizeof(error);
+    TRY(Core::System::getsockopt(nameserver.tcp_connect_notifier->fd(), SOL_SOCKET, SO_ERROR, &error, &error_size));
+    if (error != 0)
+        return Error::from_errno(error);
+
+    // Messages sent over TCP are prefixed with their length. (RFC 1035, 4.2.2)
+    auto request = TRY(nameserver.request.to_byte_buffer());
+    TRY(nameserver.tcp_socket->write_value<BigEndian<u16>>(request.size()));
+    TRY(nameserver.tcp_socket->write_entire_buffer(request));
+    return {};
+}
+
+ErrorOr<void> UpstreamQuery::receive_over_tcp(Nameserver& nameserver)
+{
+    u8 buffer[4096];
+    auto bytes = TRY(nameserver.tcp_socket->read({ buffer, sizeof(buffer) }));
+    if (bytes.is_empty() && nameserver.tcp_socket->is_eof())
+        return Error::from_string_literal("Connection closed before the response was complete");
+    TRY(nameserver.tcp_response.try_append(bytes));
+
+    if (nameserver.tcp_response.size() < sizeof(u16))
+        return {};
+    size_t response_size = nameserver.tcp_response[0] << 8 | nameserver.tcp_response[1];
+    if (nameserver.tcp_response.size() < sizeof(u16) + response_size)
+        return {};
+
+    nameserver.tcp_socket->set_notifications_enabled(false);
+    handle_response(nameserver, nameserver.tcp_response.bytes().slice(sizeof(u16), response_size));
+    return {};
+}
+
+void UpstreamQuery::handle_response(Nameserver& nameserver, ReadonlyBytes raw_response)
+{
+    if (m_finished || nameserver.state == State::Done)
+        return;
+
+    auto maybe_response = Packet::from_raw_packet(raw_response.data(), raw_response.size());
+    if (!maybe_response.has_value())
+        return;
+    auto& response = maybe_response.value();
+    auto& request = nameserver.request;
+
+    if (response.id() != request.id()) {
+        dbgln("LookupServer: ID mismatch ({} vs {}) :(", response.id(), request.id());
+        return;
+    }
+
+    if (response.code() == Packet::Code::REFUSED) {
+        if (nameserver.state == State::WaitingForDatagram && nameserver.should_randomize_case == ShouldRandomizeCase::Yes) {
+            // Retry with 0x20 case randomization turned off.
+            nameserver.should_randomize_case = ShouldRandomizeCase::No;
+            nameserver.request = build_request(m_name, m_record_type, ShouldRandomizeCase::No);
+            nameserver.attempts = 0;
+            if (auto result = send_datagram(nameserver); result.is_error()) {
+                dbgln("LookupServer: Failed to send query to '{}': {}", nameserver.address, result.error());
+                give_up_on(nameserver);
+            }
+            return;
+        }
+        dbgln("LookupServer: '{}' refused to answer", nameserver.address);
+        return give_up_on(nameserver);
+    }
+
+    // The name doesn't exist, which is as much of an answer as we're going to get from anyone.
+    if (response.code() == Packet::Code::NXDOMAIN)
+        return finish(move(response));
+
+    if (response.code() != Packet::Code::NOERROR) {
+        dbgln("LookupServer: '{}' failed to answer (response code {})", nameserver.address, to_underlying(response.code()));
+        return give_up_on(nameserver);
+    }
+
+    if (response.is_truncated() && nameserver.state == State::WaitingForDatagram) {
+        dbgln_if(LOOKUPSERVER_DEBUG, "Response from '{}' was truncated, asking again over TCP", nameserver.address);
+        if (auto result = connect_over_tcp(nameserver); result.is_error()) {
+            dbgln("LookupServer: Failed to connect to '{}' over TCP: {}", nameserver.address, result.error());
+            give_up_on(nameserver);
+        }
+        return;
+    }
+
+    if (response.question_count() != request.question_count()) {
+        dbgln("LookupServer: Question count ({} vs {}) :(", response.question_count(), request.question_count());
+        return;
+    }
+
+    // Verify the questions in our request and in their response match, ignoring case.
+    for (size_t i = 0; i < request.question_count(); ++i) {
+        auto& request_question = request.questions()[i];
+        auto& response_question = response.questions()[i];
+        bool match = request_question.class_code() == response_question.class_code()
+            && request_question.record_type() == response_question.record_type()
+            && request_question.name().as_string().equals_ignoring_case(response_question.name().as_string());
+        if (!match) {
+            dbgln("Request and response questions do not match");
+            dbgln("   Request: name=_{}_, type={}, class={}", request_question.name().as_string(), response_question.record_type(), response_question.class_code());
+            dbgln("  Response: name=_{}_, type={}, class={}", response_question.name().as_string(), response_question.record_type(), response_question.class_code());
+            return;
+        }
+    }
+
+    finish(move(response));
+}
+
+void UpstreamQuery::handle_timeout()
+{
+    for (auto& nameserver : m_nameservers) {
+        if (m_finished)
+            return;
+        if (nameserver->state == State::Done)
+            continue;
+
+        if (nameserver->attempts >= s_max_attempts) {
+            dbgln("Never got a response from '{}'", nameserver->address);
+            give_up_on(*nameserver);
+            continue;
+        }
+
+        if (nameserver->state == State::WaitingForStream) {
+            ++nameserver->attempts;
+        } else if (auto result = send_datagram(*nameserver); result.is_error()) {
+            dbgln("LookupServer: Failed to send query to '{}': {}", nameserver->address, result.error());
+            give_up_on(*nameserver);
+        }
+    }
+}
+
+void UpstreamQuery::give_up_on(Nameserver& nameserver)
+{
+    // Note: This may be called from the callbacks of the sockets, so they have to stay around until we're destroyed.
+    nameserver.state = State::Done;
+    if (nameserver.udp_socket)
+        nameserver.udp_socket->set_notifications_enabled(false);
+    if (nameserver.tcp_socket)
+        nameserver.tcp_socket->set_notifications_enabled(false);
+    if (nameserver.tcp_connect_notifier)
+        nameserver.tcp_connect_notifier->set_enabled(false);
+
+    bool has_given_up_on_all = all_of(m_nameservers, [](auto& other_nameserver) { return other_nameserver->state == State::Done; });
+    if (has_given_up_on_all)
+        finish({});
+}
+
+void UpstreamQuery::finish(Optional<Packet> response)
+{
+    if (m_finished)
+        return;
+    m_finished = true;
+    m_timer->stop();
+
+    // Note: The callback will likely get rid of us, which our caller may not be ready for.
+    deferred_invoke([this, response = move(response)]() mutable {
+        if (on_finish)
+            on_finish(move(response));
+    });
+}
+
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/DeprecatedString.h>
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/Object.h>
+#include <LibCore/Stream.h>
+#include <LibCore/Timer.h>
+#include <LibDNS/Name.h>
+#include <LibDNS/Packet.h>
+
+namespace LookupServer {
+
+using namespace DNS;
+
+// Asks all upstream nameservers the same question at once, without blocking, and reports the first response that
+// settles it. Nameservers that don't respond are asked again a couple of times, and responses that were truncated
+// to fit into a datagram are asked for again over TCP.
+class UpstreamQuery final : public Core::Object {
+    C_OBJECT(UpstreamQuery);
+
+public:
+    virtual ~UpstreamQuery() override = default;
+
+    // Called once with the response that settled the question (one that has answers, or says that there are none),
+    // or with nothing if no nameserver could tell us.
+    Function<void(Optional<Packet>)> on_finish;
+
+    void start();
+
+private:
+    UpstreamQuery(Name const&, RecordType, Vector<DeprecatedString> const& nameservers);
+
+    enum class State {
+        WaitingForDatagram,
+        WaitingForStream,
+        Done,
+    };
+
+    struct Nameserver {
+        DeprecatedString address;
+        State state { State::WaitingForDatagram };
+        ShouldRandomizeCase should_randomize_case { ShouldRandomizeCase::Yes };
+        Packet request;
+        int attempts { 0 };
+
+        OwnPtr<Core::Stream::UDPSocket> udp_socket;
+        OwnPtr<Core::Stream::TCPSocket> tcp_socket;
+        RefPtr<Core::Notifier> tcp_connect_notifier;
+        ByteBuffer tcp_response;
+    };
+
+    ErrorOr<void> send_datagram(Nameserver&);
+    ErrorOr<void> connect_over_tcp(Nameserver&);
+    ErrorOr<void> send_over_tcp(Nameserver&);
+    ErrorOr<void> receive_datagram(Nameserver&);
+    ErrorOr<void> receive_over_tcp(Nameserver&);
+    void handle_response(Nameserver&, ReadonlyBytes);
+    void handle_timeout();
+    void give_up_on(Nameserver&);
+    void finish(Optional<Packet>);
+
+    Name m_name;
+    RecordType m_record_type;
+    Vector<NonnullOwnPtr<Nameserver>> m_nameservers;
+    RefPtr<Core::Timer> m_timer;
+    bool m_finished { false };
+};
+
+}
@@ -13,6 +13,32 @@ namespace RequestServer::ConnectionCache {
 
 HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<Core::Stream::TCPSocket, Core::Stream::Socket>>>> g_tcp_connection_cache {};
 HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<TLS::TLSv12>>>> g_tls_connection_cache {};
+HashMap<ConnectionKey, TLS::SessionState> g_tls_session_cache {};
+HashTable<ConnectionKey> g_http2_origins {};
+Statistics g_statistics {};
+size_t g_max_connections_per_origin { DefaultMaxConnectionsPerOrigin };
+size_t g_max_idle_connections { DefaultMaxIdleConnections };
+
+void set_up_session_resumption(TLS::Options& options, URL const& url)
+{
+    // The session is only put back once a handshake with it succeeds, so that a session the server
+    // no longer accepts is not offered again.
+    ConnectionKey key { url.host(), url.port_or_default() };
+    if (auto session = g_tls_session_cache.take(key); session.has_value())
+        options.set_session_to_resume(session.release_value());
+
+    options.set_session_handler([key](TLS::SessionState const& session) {
+        dbgln_if(REQUESTSERVER_DEBUG, "Caching TLS session for {}:{}", key.hostname, key.port);
+        g_tls_session_cache.set(key, session);
+    });
+}
+
+void set_up_application_protocols(TLS::Options& options, URL const& url)
+{
+    // Anything but HTTPS (i.e. Gemini) has no use for ALPN.
+    if (url.scheme() == "https"sv)
+        options.set_alpn_protocols({ "h2", "http/1.1" });
+}
 
 void request_did_finish(URL const& url, Core::Stream::Socket const* socket)
 {
@@ -36,16 +62,45 @@ void request_did_finish(URL const& url, Core::Stream::Socket const* socket)
             return;
         }
 
-        auto& connection = *connection_it;
+        // Hold on to the connection itself, its slot in the cache entry can move when another connection is removed.
+        auto* connection = connection_it->ptr();
+        if (connection->http2) {
+            // Whatever waits for a multiplexed connection can join the streams that are still going.
+            while (!connection->request_queue.is_empty() && connection->http2->can_open_stream())
+                start_job(*connection, url, connection->request_queue.take_first());
+            if (connection->http2->active_stream_count() > 0)
+                return;
+        }
         if (connection->request_queue.is_empty()) {
-            Core::deferred_invoke([&connection, &cache_entry = *it->value, key = it->key, &cache] {
+            // Rather than sit idle, take over a request that is waiting for a busier connection to the same origin.
+            auto* busiest_connection = connection;
+            for (auto& other : *it->value) {
+                // Whatever waits for a connection that is still being made has to stay with it.
+                if (!other.socket)
+                    continue;
+                if (other.request_queue.size() > busiest_connection->request_queue.size())
+                    busiest_connection = &other;
+            }
+            if (busiest_connection != connection)
+                connection->request_queue.append(busiest_connection->request_queue.take_first());
+        }
+        if (connection->request_queue.is_empty()) {
+            Core::deferred_invoke([connection, url, &cache_entry = *it->value, key = it->key, &cache] {
+                // Another request may have been started on (or queued for) the connection in the meantime.
+                if (connection->http2 && connection->http2->active_stream_count() > 0)
+                    return;
+                if (!connection->request_queue.is_empty()) {
+                    start_job(*connection, url, connection->request_queue.take_first());
+                    return;
+                }
                 connection->socket->set_notifications_enabled(false);
                 connection->has_started = false;
                 connection->current_url = {};
                 connection->job_data = {};
-                connection->removal_timer->on_timeout = [ptr = connection.ptr(), &cache_entry, key = move(key), &cache]() mutable {
+                connection->idle_timer.start();
+                connection->removal_timer->on_timeout = [ptr = connection, &cache_entry, key = move(key), &cache]() mutable {
                     Core::deferred_invoke([&, key = move(key), ptr] {
-                        dbgln_if(REQUESTSERVER_DEBUG, "Removing no-longer-used connection {} (socket {})", ptr, ptr->socket);
+                        dbgln_if(REQUESTSERVER_DEBUG, "Removing no-longer-used connection {} (socket {})", ptr, ptr->socket.ptr());
                         auto did_remove = cache_entry.remove_first_matching([&](auto& entry) { return entry == ptr; });
                         VERIFY(did_remove);
                         if (cache_entry.is_empty())
@@ -53,6 +108,7 @@ void request_did_finish(URL const& url, Core::Stream::Socket const* socket)
                     });
                 };
                 connection->removal_timer->start();
+                evict_idle_connections_if_needed();
             });
         } else {
             if (auto result = recreate_socket_if_needed(*connection, url); result.is_error()) {
@@ -60,13 +116,12 @@ void request_did_finish(URL const& url, Core::Stream::Socket const* socket)
                 connection->job_data.fail(Core::NetworkJob::Error::ConnectionFailed);
                 return;
             }
-            Core::deferred_invoke([&, url] {
-                dbgln_if(REQUESTSERVER_DEBUG, "Running next job in queue for connection {} @{}", &connection, connection->socket);
-                connection->timer.start();
-                connection->current_url = url;
-                connection->job_data = connection->request_queue.take_first();
-                connection->socket->set_notifications_enabled(true);
-                connection->job_data.start(*connection->socket);
+            // Take the job off the queue right away, so that no other connection picks it up in the meantime.
+            Core::deferred_invoke([connection, url, job_data = connection->request_queue.take_first()]() mutable {
+                dbgln_if(REQUESTSERVER_DEBUG, "Running next job in queue for connection {} @{}", connection, connection->socket.ptr());
+                start_job(*connection, url, move(job_data));
+                while (connection->http2 && !connection->request_queue.is_empty() && connection->http2->can_open_stream())
+                    start_job(*connection, url, connection->request_queue.take_first());
             });
         }
     };
@@ -79,13 +134,66 @@ void request_did_finish(URL const& url, Core::Stream::Socket const* socket)
         dbgln("Unknown socket {} finished for URL {}", socket, url);
 }
 
+void evict_idle_connections_if_needed()
+{
+    // Only connections that are still waiting for their removal timer can go, the others are about to be removed anyway.
+    auto is_evictable = [](auto& connection) { return is_idle(connection) && connection.removal_timer->is_active(); };
+
+    size_t idle_connections = 0;
+    auto count_idle_connections = [&](auto& cache) {
+        for (auto& entry : cache) {
+            for (auto& connection : *entry.value) {
+                if (is_evictable(connection))
+                    ++idle_connections;
+            }
+        }
+    };
+    count_idle_connections(g_tls_connection_cache);
+    count_idle_connections(g_tcp_connection_cache);
+
+    while (idle_connections > g_max_idle_connections) {
+        // The connection that has been idle the longest is the least likely to be used again.
+        i64 longest_idle_time = -1;
+        Function<void()> evict_connection;
+        auto find_least_recently_used = [&](auto& cache) {
+            for (auto& entry : cache) {
+                for (auto& connection : *entry.value) {
+                    if (!is_evictable(connection) || connection.idle_timer.elapsed() <= longest_idle_time)
+                        continue;
+                    longest_idle_time = connection.idle_timer.elapsed();
+                    evict_connection = [&cache, key = entry.key, ptr = &connection] {
+                        dbgln_if(REQUESTSERVER_DEBUG, "Evicting idle connection {} (socket {})", ptr, ptr->socket.ptr());
+                        auto& cache_entry = *cache.get(key).value();
+                        auto did_remove = cache_entry.remove_first_matching([&](auto& entry) { return entry == ptr; });
+                        VERIFY(did_remove);
+                        if (cache_entry.is_empty())
+                            cache.remove(key);
+                    };
+                }
+            }
+        };
+        find_least_recently_used(g_tls_connection_cache);
+        find_least_recently_used(g_tcp_connection_cache);
+
+        VERIFY(evict_connection);
+        evict_connection();
+        --idle_connections;
+        ++g_statistics.evicted_connections;
+    }
+}
+
 void dump_jobs()
 {
+    dbgln("=========== Connection Pool ==========");
+    dbgln(" - {} reused, {} new, {} queued, {} evicted", g_statistics.reused_connections, g_statistics.new_connections, g_statistics.queued_requests, g_statistics.evicted_connections);
+    dbgln(" - At most {} connections per origin, {} idle connections", g_max_connections_per_origin, g_max_idle_connections);
     dbgln("=========== TLS Connection Cache ==========");
     for (auto& connection : g_tls_connection_cache) {
         dbgln(" - {}:{}", connection.key.hostname, connection.key.port);
         for (auto& entry : *connection.value) {
-            dbgln("  - Connection {} (started={}) (socket={})", &entry, entry.has_started, entry.socket);
+            dbgln("  - Connection {} (started={}) (socket={})", &entry, entry.has_started, entry.socket.ptr());
+            if (entry.http2)
+                dbgln("    HTTP/2 with {} active streams", entry.http2->active_stream_count());
             dbgln("    Currently loading {} ({} elapsed)", entry.current_url, entry.timer.is_valid() ? entry.timer.elapsed() : 0);
             dbgln("    Request Queue:");
             for (auto& job : entry.request_queue)
@@ -96,7 +204,7 @@ void dump_jobs()
     for (auto& connection : g_tcp_connection_cache) {
         dbgln(" - {}:{}", connection.key.hostname, connection.key.port);
         for (auto& entry : *connection.value) {
-            dbgln("  - Connection {} (started={}) (socket={})", &entry, entry.has_started, entry.socket);
+            dbgln("  - Connection {} (started={}) (socket={})", &entry, entry.has_started, entry.socket.ptr());
             dbgln("    Currently loading {} ({} elapsed)", entry.current_url, entry.timer.is_valid() ? entry.timer.elapsed() : 0);
             dbgln("    Request Queue:");
             for (auto& job : entry.request_queue)
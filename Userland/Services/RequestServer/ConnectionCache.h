@@ -9,6 +9,7 @@
 
 #include <AK/Debug.h>
 #include <AK/HashMap.h>
+#include <AK/HashTable.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/URL.h>
 #include <AK/Vector.h>
@@ -17,7 +18,9 @@
 #include <LibCore/NetworkJob.h>
 #include <LibCore/SOCKSProxyClient.h>
 #include <LibCore/Timer.h>
+#include <LibHTTP/Http2Connection.h>
 #include <LibTLS/TLSv12.h>
+#include <RequestServer/TCPConnector.h>
 
 namespace RequestServer {
 
@@ -58,6 +61,7 @@ template<typename Socket, typename SocketStorageType = Socket>
 struct Connection {
     struct JobData {
         Function<void(Core::Stream::Socket&)> start {};
+        Function<void(Core::Stream::Socket&, HTTP::Http2Connection&)> start_http2 {};
         Function<void(Core::NetworkJob::Error)> fail {};
         Function<Vector<TLS::Certificate>()> provide_client_certificates {};
 
@@ -70,6 +74,12 @@ struct Connection {
                 .start = [&job](auto& socket) {
                     job.start(socket);
                 },
+                .start_http2 = [&job](auto& socket, auto& http2_connection) {
+                    if constexpr (requires { job.start_with_http2(socket, http2_connection); })
+                        job.start_with_http2(socket, http2_connection);
+                    else
+                        job.start(socket);
+                },
                 .fail = [&job](auto error) {
                     job.fail(error);
                 },
@@ -91,14 +101,22 @@ struct Connection {
     using SocketType = Socket;
     using StorageType = SocketStorageType;
 
-    NonnullOwnPtr<Core::Stream::BufferedSocket<SocketStorageType>> socket;
+    // Null until the connection has been made, until then the jobs that are going to use it wait in the request queue.
+    OwnPtr<Core::Stream::BufferedSocket<SocketStorageType>> socket;
     QueueType request_queue;
     NonnullRefPtr<Core::Timer> removal_timer;
     bool has_started { false };
     URL current_url {};
     Core::ElapsedTimer timer {};
+    Core::ElapsedTimer idle_timer {};
     JobData job_data {};
     Proxy proxy {};
+    // Set if the server agreed to HTTP/2, in which case any number of jobs can run on the connection at once.
+    // This has to be destroyed before the socket it uses.
+    OwnPtr<HTTP::Http2Connection> http2 {};
+    RefPtr<TCPConnector> connector {};
+    // Set while the TLS handshake on a new socket is in progress, after which it becomes the connection's socket.
+    OwnPtr<Socket> handshaking_socket {};
 };
 
 struct ConnectionKey {
@@ -123,20 +141,115 @@ namespace RequestServer::ConnectionCache {
 
 extern HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<Core::Stream::TCPSocket, Core::Stream::Socket>>>> g_tcp_connection_cache;
 extern HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<TLS::TLSv12>>>> g_tls_connection_cache;
+extern HashMap<ConnectionKey, TLS::SessionState> g_tls_session_cache;
+// Origins that agreed to HTTP/2 the last time we connected to them.
+extern HashTable<ConnectionKey> g_http2_origins;
+
+struct Statistics {
+    u64 reused_connections { 0 };
+    u64 new_connections { 0 };
+    u64 queued_requests { 0 };
+    u64 evicted_connections { 0 };
+};
+extern Statistics g_statistics;
+
+// How many connections we open to a single origin, and how many idle ones we keep around across all origins.
+extern size_t g_max_connections_per_origin;
+extern size_t g_max_idle_connections;
 
 void request_did_finish(URL const&, Core::Stream::Socket const*);
 void dump_jobs();
+void set_up_session_resumption(TLS::Options&, URL const&);
+void set_up_application_protocols(TLS::Options&, URL const&);
+void evict_idle_connections_if_needed();
 
-constexpr static size_t MaxConcurrentConnectionsPerURL = 4;
+constexpr static size_t DefaultMaxConnectionsPerOrigin = 6;
+constexpr static size_t DefaultMaxIdleConnections = 32;
 constexpr static size_t ConnectionKeepAliveTimeMilliseconds = 10'000;
 
+template<typename T>
+bool is_idle(T const& connection)
+{
+    return !connection.has_started && connection.request_queue.is_empty();
+}
+
+template<typename T>
+void set_up_http2_if_negotiated(T& connection, StringView negotiated_protocol)
+{
+    connection.http2 = nullptr;
+    if (negotiated_protocol != "h2"sv)
+        return;
+
+    auto http2_connection = HTTP::Http2Connection::try_create(*connection.socket);
+    if (http2_connection.is_error()) {
+        // Whoever uses the connection next will have to reconnect.
+        dbgln("ConnectionCache: Failed to set up HTTP/2 on {}: {}", connection.socket.ptr(), http2_connection.error());
+        connection.socket->close();
+        return;
+    }
+    dbgln_if(REQUESTSERVER_DEBUG, "Using HTTP/2 on {}", connection.socket.ptr());
+    connection.http2 = http2_connection.release_value();
+}
+
+template<typename T>
+void start_job(T& connection, URL const& url, typename T::JobData job_data)
+{
+    connection.timer.start();
+    connection.current_url = url;
+    connection.socket->set_notifications_enabled(true);
+    if (connection.http2) {
+        // Jobs come and go independently on a multiplexed connection, so none of them gets to own it.
+        connection.job_data = {};
+        job_data.start_http2(*connection.socket, *connection.http2);
+        return;
+    }
+    connection.job_data = move(job_data);
+    connection.job_data.start(*connection.socket);
+}
+
+template<typename T>
+TLS::Options tls_options_for(T& connection, URL const& url)
+{
+    TLS::Options options;
+    options.set_alert_handler([&connection](TLS::AlertDescription alert) {
+        Core::NetworkJob::Error reason;
+        if (alert == TLS::AlertDescription::HandshakeFailure)
+            reason = Core::NetworkJob::Error::ProtocolFailed;
+        else if (alert == TLS::AlertDescription::DecryptError)
+            reason = Core::NetworkJob::Error::ConnectionFailed;
+        else
+            reason = Core::NetworkJob::Error::TransmissionFailed;
+
+        if (connection.job_data.fail)
+            connection.job_data.fail(reason);
+    });
+    options.set_certificate_provider([&connection]() -> Vector<TLS::Certificate> {
+        if (connection.job_data.provide_client_certificates)
+            return connection.job_data.provide_client_certificates();
+        return {};
+    });
+    set_up_session_resumption(options, url);
+    set_up_application_protocols(options, url);
+    return options;
+}
+
+template<typename T>
+bool needs_new_socket(T const& connection)
+{
+    // A server that sent GOAWAY won't take any new streams, even if it keeps the socket open for a while.
+    bool http2_is_going_away = connection.http2 && connection.http2->is_going_away();
+    return !connection.socket->is_open() || connection.socket->is_eof() || http2_is_going_away;
+}
+
 template<typename T>
 ErrorOr<void> recreate_socket_if_needed(T& connection, URL const& url)
 {
     using SocketType = typename T::SocketType;
     using SocketStorageType = typename T::StorageType;
 
-    if (!connection.socket->is_open() || connection.socket->is_eof()) {
+    if (needs_new_socket(connection)) {
+        connection.http2 = nullptr;
+
         // Create another socket for the connection.
         auto set_socket = [&](auto socket) -> ErrorOr<void> {
             connection.socket = TRY(Core::Stream::BufferedSocket<SocketStorageType>::create(move(socket)));
@@ -144,68 +257,182 @@ ErrorOr<void> recreate_socket_if_needed(T& connection, URL const& url)
         };
 
         if constexpr (IsSame<TLS::TLSv12, SocketType>) {
-            TLS::Options options;
-            options.set_alert_handler([&connection](TLS::AlertDescription alert) {
-                Core::NetworkJob::Error reason;
-                if (alert == TLS::AlertDescription::HandshakeFailure)
-                    reason = Core::NetworkJob::Error::ProtocolFailed;
-                else if (alert == TLS::AlertDescription::DecryptError)
-                    reason = Core::NetworkJob::Error::ConnectionFailed;
-                else
-                    reason = Core::NetworkJob::Error::TransmissionFailed;
-
-                if (connection.job_data.fail)
-                    connection.job_data.fail(reason);
-            });
-            options.set_certificate_provider([&connection]() -> Vector<TLS::Certificate> {
-                if (connection.job_data.provide_client_certificates)
-                    return connection.job_data.provide_client_certificates();
-                return {};
-            });
-            TRY(set_socket(TRY((connection.proxy.template tunnel<SocketType, SocketStorageType>(url, move(options))))));
+            auto socket = TRY((connection.proxy.template tunnel<SocketType, SocketStorageType>(url, tls_options_for(connection, url))));
+            DeprecatedString negotiated_protocol = socket->alpn();
+            TRY(set_socket(move(socket)));
+            set_up_http2_if_negotiated(connection, negotiated_protocol);
         } else {
             TRY(set_socket(TRY((connection.proxy.template tunnel<SocketType, SocketStorageType>(url)))));
         }
-        dbgln_if(REQUESTSERVER_DEBUG, "Creating a new socket for {} -> {}", url, connection.socket);
+        dbgln_if(REQUESTSERVER_DEBUG, "Creating a new socket for {} -> {}", url, connection.socket.ptr());
     }
     return {};
 }
 
+template<typename T>
+void did_fail_to_connect(auto& cache, ConnectionKey const& key, T& connection, URL const& url, Error const& error)
+{
+    dbgln("ConnectionCache: Connection to {} failed: {}", url, error);
+    auto jobs = move(connection.request_queue);
+    auto& cache_entry = *cache.get(key).value();
+    auto did_remove = cache_entry.remove_first_matching([&](auto& entry) { return entry == &connection; });
+    VERIFY(did_remove);
+    if (cache_entry.is_empty())
+        cache.remove(key);
+    for (auto& job : jobs)
+        job.fail(Core::NetworkJob::Error::ConnectionFailed);
+}
+
+template<typename T>
+void did_connect(T& connection, URL const& url)
+{
+    dbgln_if(REQUESTSERVER_DEBUG, "Connected {} to {} - {}", &connection, url, connection.socket.ptr());
+    start_job(connection, url, connection.request_queue.take_first());
+    while (connection.http2 && !connection.request_queue.is_empty() && connection.http2->can_open_stream())
+        start_job(connection, url, connection.request_queue.take_first());
+}
+
+template<typename T>
+ErrorOr<void> start_tls_handshake(auto& cache, ConnectionKey const& key, T& connection, URL const& url, NonnullOwnPtr<Core::Stream::Socket> tcp_socket)
+{
+    using SocketStorageType = typename T::StorageType;
+
+    TRY(tcp_socket->set_blocking(false));
+    connection.handshaking_socket = make<TLS::TLSv12>(OwnPtr<Core::Stream::Socket>(move(tcp_socket)), tls_options_for(connection, url));
+    auto& tls_socket = *connection.handshaking_socket;
+    tls_socket.set_sni(url.host());
+
+    // Note: Both of these are called from within the socket, so we can only take it over once they have returned.
+    tls_socket.on_connected = [&cache, key, &connection, url] {
+        Core::deferred_invoke([&cache, key, &connection, url] {
+            if (!connection.handshaking_socket)
+                return;
+            auto tls_socket = connection.handshaking_socket.release_nonnull();
+            tls_socket->on_connected = nullptr;
+            tls_socket->on_tls_error = nullptr;
+            DeprecatedString negotiated_protocol = tls_socket->alpn();
+            auto socket = Core::Stream::BufferedSocket<SocketStorageType>::create(move(tls_socket));
+            if (socket.is_error())
+                return did_fail_to_connect(cache, key, connection, url, socket.error());
+            connection.socket = socket.release_value();
+            set_up_http2_if_negotiated(connection, negotiated_protocol);
+            if (connection.http2)
+                g_http2_origins.set(key);
+            else
+                g_http2_origins.remove(key);
+            did_connect(connection, url);
+        });
+    };
+    tls_socket.on_tls_error = [&cache, key, &connection, url](TLS::AlertDescription alert) {
+        Core::deferred_invoke([&cache, key, &connection, url, alert] {
+            if (!connection.handshaking_socket)
+                return;
+            connection.handshaking_socket = nullptr;
+            did_fail_to_connect(cache, key, connection, url, Error::from_string_view(TLS::alert_name(alert)));
+        });
+    };
+    return {};
+}
+
+// Makes a new socket for the connection without blocking, after which the jobs waiting in its request queue get to
+// use it. If that fails, they fail along with it, and the connection is removed from the cache.
+template<typename T>
+void connect_in_background(auto& cache, ConnectionKey const& key, T& connection, URL const& url)
+{
+    using SocketType = typename T::SocketType;
+    using SocketStorageType = typename T::StorageType;
+
+    dbgln_if(REQUESTSERVER_DEBUG, "Connecting {} to {} in the background", &connection, url);
+    connection.http2 = nullptr;
+    connection.socket = nullptr;
+    connection.has_started = true;
+    connection.removal_timer->stop();
+    connection.connector = TCPConnector::construct(url.host(), url.port_or_default());
+    connection.connector->on_finish = [&cache, key, &connection, url](auto tcp_socket) {
+        // Note: We're called from the connector, which keeps itself alive until we return.
+        connection.connector = nullptr;
+
+        auto result = [&]() -> ErrorOr<void> {
+            NonnullOwnPtr<Core::Stream::Socket> socket = TRY(move(tcp_socket));
+            if constexpr (IsSame<TLS::TLSv12, SocketType>) {
+                // The jobs get to start once the handshake is done.
+                return start_tls_handshake(cache, key, connection, url, move(socket));
+            } else {
+                connection.socket = TRY(Core::Stream::BufferedSocket<SocketStorageType>::create(move(socket)));
+                did_connect(connection, url);
+                return {};
+            }
+        }();
+        if (result.is_error())
+            did_fail_to_connect(cache, key, connection, url, result.error());
+    };
+    connection.connector->start();
+}
+
 decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto& job, Core::ProxyData proxy_data = {})
 {
     using CacheEntryType = RemoveCVReference<decltype(*cache.begin()->value)>;
-    auto& sockets_for_url = *cache.ensure({ url.host(), url.port_or_default(), proxy_data }, [] { return make<CacheEntryType>(); });
+    ConnectionKey key { url.host(), url.port_or_default(), proxy_data };
+    auto& sockets_for_url = *cache.ensure(key, [] { return make<CacheEntryType>(); });
 
     Proxy proxy { proxy_data };
 
     using ReturnType = decltype(&sockets_for_url[0]);
-    auto it = sockets_for_url.find_if([](auto& connection) { return connection->request_queue.is_empty(); });
+    // Prefer a multiplexed connection that has streams to spare, then a connection with nothing to do,
+    // then a new one while we're below the limit, and only then wait behind another request.
+    auto can_take_another_stream = [](auto& connection) { return connection.has_started && connection.http2 && connection.http2->can_open_stream(); };
+    auto it = sockets_for_url.find_if([&](auto& connection) { return can_take_another_stream(*connection); });
+    if (it.is_end())
+        it = sockets_for_url.find_if([](auto& connection) { return is_idle(*connection); });
+    // Rather than make another connection, wait for the one that's still being made if it's likely to be multiplexed.
+    if (it.is_end() && g_http2_origins.contains(key))
+        it = sockets_for_url.find_if([](auto& connection) { return connection->has_started && !connection->socket; });
     auto did_add_new_connection = false;
     auto failed_to_find_a_socket = it.is_end();
-    if (failed_to_find_a_socket && sockets_for_url.size() < ConnectionCache::MaxConcurrentConnectionsPerURL) {
+    if (failed_to_find_a_socket && sockets_for_url.size() < g_max_connections_per_origin) {
         using ConnectionType = RemoveCVReference<decltype(cache.begin()->value->at(0))>;
-        auto connection_result = proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url);
-        if (connection_result.is_error()) {
-            dbgln("ConnectionCache: Connection to {} failed: {}", url, connection_result.error());
-            Core::deferred_invoke([&job] {
-                job.fail(Core::NetworkJob::Error::ConnectionFailed);
-            });
-            return ReturnType { nullptr };
-        }
-        auto socket_result = Core::Stream::BufferedSocket<typename ConnectionType::StorageType>::create(connection_result.release_value());
-        if (socket_result.is_error()) {
-            dbgln("ConnectionCache: Failed to make a buffered socket for {}: {}", url, socket_result.error());
-            Core::deferred_invoke([&job] {
-                job.fail(Core::NetworkJob::Error::ConnectionFailed);
-            });
-            return ReturnType { nullptr };
+        OwnPtr<Core::Stream::BufferedSocket<typename ConnectionType::StorageType>> socket;
+        DeprecatedString negotiated_protocol;
+        // Direct connections are made in the background once we get to start the job below.
+        if (proxy.data.type != Core::ProxyData::Direct) {
+            auto connection_result = [&] {
+                if constexpr (IsSame<TLS::TLSv12, typename ConnectionType::SocketType>) {
+                    TLS::Options options;
+                    set_up_session_resumption(options, url);
+                    set_up_application_protocols(options, url);
+                    return proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url, move(options));
+                } else {
+                    return proxy.tunnel<typename ConnectionType::SocketType, typename ConnectionType::StorageType>(url);
+                }
+            }();
+            if (connection_result.is_error()) {
+                dbgln("ConnectionCache: Connection to {} failed: {}", url, connection_result.error());
+                Core::deferred_invoke([&job] {
+                    job.fail(Core::NetworkJob::Error::ConnectionFailed);
+                });
+                return ReturnType { nullptr };
+            }
+            if constexpr (IsSame<TLS::TLSv12, typename ConnectionType::SocketType>)
+                negotiated_protocol = connection_result.value()->alpn();
+            auto socket_result = Core::Stream::BufferedSocket<typename ConnectionType::StorageType>::create(connection_result.release_value());
+            if (socket_result.is_error()) {
+                dbgln("ConnectionCache: Failed to make a buffered socket for {}: {}", url, socket_result.error());
+                Core::deferred_invoke([&job] {
+                    job.fail(Core::NetworkJob::Error::ConnectionFailed);
+                });
+                return ReturnType { nullptr };
+            }
+            socket = socket_result.release_value();
         }
         sockets_for_url.append(make<ConnectionType>(
-            socket_result.release_value(),
+            move(socket),
             typename ConnectionType::QueueType {},
             Core::Timer::create_single_shot(ConnectionKeepAliveTimeMilliseconds, nullptr).release_value_but_fixme_should_propagate_errors()));
         sockets_for_url.last().proxy = move(proxy);
+        if (sockets_for_url.last().socket)
+            set_up_http2_if_negotiated(sockets_for_url.last(), negotiated_protocol);
         did_add_new_connection = true;
+        ++g_statistics.new_connections;
     }
     size_t index;
     if (failed_to_find_a_socket) {
@@ -224,6 +451,7 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto& job,
         }
     } else {
         index = it.index();
+        ++g_statistics.reused_connections;
     }
     if (sockets_for_url.is_empty()) {
         Core::deferred_invoke([&job] {
@@ -233,7 +461,15 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto& job,
     }
 
     auto& connection = sockets_for_url[index];
-    if (!connection.has_started) {
+    if (can_take_another_stream(connection)) {
+        dbgln_if(REQUESTSERVER_DEBUG, "Multiplex request for url {} onto {} - {}", url, &connection, connection.socket.ptr());
+        start_job(connection, url, decltype(connection.job_data)::create(job));
+    } else if (!connection.has_started) {
+        if (!connection.socket || (connection.proxy.data.type == Core::ProxyData::Direct && needs_new_socket(connection))) {
+            connection.request_queue.append(decltype(connection.job_data)::create(job));
+            connect_in_background(cache, key, connection, url);
+            return &connection;
+        }
         if (auto result = recreate_socket_if_needed(connection, url); result.is_error()) {
             dbgln("ConnectionCache: request failed to start, failed to make a socket: {}", result.error());
             Core::deferred_invoke([&job] {
@@ -241,17 +477,14 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto& job,
             });
             return ReturnType { nullptr };
         }
-        dbgln_if(REQUESTSERVER_DEBUG, "Immediately start request for url {} in {} - {}", url, &connection, connection.socket);
+        dbgln_if(REQUESTSERVER_DEBUG, "Immediately start request for url {} in {} - {}", url, &connection, connection.socket.ptr());
         connection.has_started = true;
         connection.removal_timer->stop();
-        connection.timer.start();
-        connection.current_url = url;
-        connection.job_data = decltype(connection.job_data)::create(job);
-        connection.socket->set_notifications_enabled(true);
-        connection.job_data.start(*connection.socket);
+        start_job(connection, url, decltype(connection.job_data)::create(job));
     } else {
-        dbgln_if(REQUESTSERVER_DEBUG, "Enqueue request for URL {} in {} - {}", url, &connection, connection.socket);
+        dbgln_if(REQUESTSERVER_DEBUG, "Enqueue request for URL {} in {} - {}", url, &connection, connection.socket.ptr());
         connection.request_queue.append(decltype(connection.job_data)::create(job));
+        ++g_statistics.queued_requests;
     }
     return &connection;
 }
@@ -8,6 +8,7 @@
 #include <AK/NonnullOwnPtr.h>
 #include <LibCore/Proxy.h>
 #include <RequestServer/ConnectionFromClient.h>
+#include <RequestServer/ConnectionToLookupServer.h>
 #include <RequestServer/Protocol.h>
 #include <RequestServer/Request.h>
 #include <RequestServer/RequestClientEndpoint.h>
@@ -150,8 +151,11 @@ void ConnectionFromClient::ensure_connection(URL const& url, ::RequestServer::Ca
     }
 
     if (cache_level == CacheLevel::ResolveOnly) {
+        dbgln("EnsureConnection: DNS-preload for {}", url.host());
+        // LookupServer keeps the answers around for when we connect, so there's nothing left to do with them here.
+        if (auto lookup_server = ConnectionToLookupServer::the())
+            return lookup_server->resolve(url.host(), [](auto) {});
         return Core::deferred_invoke([host = url.host()] {
-            dbgln("EnsureConnection: DNS-preload for {}", host);
             (void)gethostbyname(host.characters());
         });
     }
@@ -172,4 +176,22 @@ void ConnectionFromClient::ensure_connection(URL const& url, ::RequestServer::Ca
         dbgln("EnsureConnection: Invalid URL scheme: '{}'", url.scheme());
 }
 
+void ConnectionFromClient::set_connection_pool_limits(u32 max_connections_per_origin, u32 max_idle_connections)
+{
+    if (max_connections_per_origin == 0) {
+        dbgln("SetConnectionPoolLimits: Need to allow at least one connection per origin");
+        return;
+    }
+
+    ConnectionCache::g_max_connections_per_origin = max_connections_per_origin;
+    ConnectionCache::g_max_idle_connections = max_idle_connections;
+    ConnectionCache::evict_idle_connections_if_needed();
+}
+
+Messages::RequestServer::ConnectionPoolStatisticsResponse ConnectionFromClient::connection_pool_statistics()
+{
+    auto const& statistics = ConnectionCache::g_statistics;
+    return { statistics.reused_connections, statistics.new_connections, statistics.queued_requests, statistics.evicted_connections };
+}
+
 }
@@ -36,6 +36,8 @@ private:
     virtual Messages::RequestServer::StopRequestResponse stop_request(i32) override;
     virtual Messages::RequestServer::SetCertificateResponse set_certificate(i32, DeprecatedString const&, DeprecatedString const&) override;
     virtual void ensure_connection(URL const& url, ::RequestServer::CacheLevel const& cache_level) override;
+    virtual void set_connection_pool_limits(u32 max_connections_per_origin, u32 max_idle_connections) override;
+    virtual Messages::RequestServer::ConnectionPoolStatisticsResponse connection_pool_statistics() override;
 
     HashMap<i32, OwnPtr<Request>> m_requests;
 };
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <RequestServer/ConnectionToLookupServer.h>
+
+namespace RequestServer {
+
+static RefPtr<ConnectionToLookupServer> s_the;
+
+RefPtr<ConnectionToLookupServer> ConnectionToLookupServer::the()
+{
+    if (!s_the) {
+        auto connection = ConnectionToLookupServer::try_create();
+        if (connection.is_error()) {
+            dbgln("RequestServer: Failed to connect to LookupServer: {}", connection.error());
+            return nullptr;
+        }
+        s_the = connection.release_value();
+    }
+    return s_the;
+}
+
+ConnectionToLookupServer::ConnectionToLookupServer(NonnullOwnPtr<Core::Stream::LocalSocket> socket)
+    : IPC::ConnectionToServer<LookupClientEndpoint, LookupServerEndpoint>(*this, move(socket))
+{
+}
+
+void ConnectionToLookupServer::resolve(DeprecatedString const& name, ResolveCallback callback)
+{
+    auto request_id = m_next_request_id++;
+    m_pending_resolutions.set(request_id, move(callback));
+    async_resolve(request_id, name);
+}
+
+void ConnectionToLookupServer::resolved(i32 request_id, int code, Vector<DeprecatedString> const& addresses)
+{
+    auto callback = m_pending_resolutions.take(request_id);
+    if (!callback.has_value()) {
+        dbgln("RequestServer: LookupServer resolved unknown request {}", request_id);
+        return;
+    }
+    if (code != 0)
+        return (*callback)(Error::from_string_literal("Failed to resolve name"));
+
+    Vector<IPv4Address> ipv4_addresses;
+    for (auto& address : addresses) {
+        // FIXME: Connect to IPv6 addresses too, once we have IPv6 sockets.
+        if (address.length() == sizeof(IPv4Address::in_addr_t))
+            ipv4_addresses.append(IPv4Address { bit_cast<u8 const*>(address.characters()) });
+    }
+    dbgln_if(REQUESTSERVER_DEBUG, "LookupServer resolved request {} to {} IPv4 address(es), ignoring {} others", request_id, ipv4_addresses.size(), addresses.size() - ipv4_addresses.size());
+    if (ipv4_addresses.is_empty())
+        return (*callback)(Error::from_string_literal("Name has no IPv4 addresses"));
+    (*callback)(move(ipv4_addresses));
+}
+
+void ConnectionToLookupServer::die()
+{
+    dbgln("RequestServer: Lost connection to LookupServer");
+    auto pending_resolutions = move(m_pending_resolutions);
+    for (auto& resolution : pending_resolutions)
+        resolution.value(Error::from_string_literal("Lost connection to LookupServer"));
+
+    // The next resolution will reconnect.
+    deferred_invoke([this] {
+        if (s_the == this)
+            s_the = nullptr;
+    });
+}
+
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/HashMap.h>
+#include <AK/IPv4Address.h>
+#include <LibIPC/ConnectionToServer.h>
+#include <LookupServer/LookupClientEndpoint.h>
+#include <LookupServer/LookupServerEndpoint.h>
+
+namespace RequestServer {
+
+class ConnectionToLookupServer final
+    : public IPC::ConnectionToServer<LookupClientEndpoint, LookupServerEndpoint>
+    , public LookupClientEndpoint {
+    IPC_CLIENT_CONNECTION(ConnectionToLookupServer, "/tmp/portal/lookup"sv)
+
+public:
+    // Returns nullptr if LookupServer can't be reached, in which case names have to be resolved while connecting.
+    static RefPtr<ConnectionToLookupServer> the();
+
+    using ResolveCallback = Function<void(ErrorOr<Vector<IPv4Address>>)>;
+    void resolve(DeprecatedString const& name, ResolveCallback);
+
+private:
+    explicit ConnectionToLookupServer(NonnullOwnPtr<Core::Stream::LocalSocket>);
+
+    virtual void resolved(i32 request_id, int code, Vector<DeprecatedString> const& addresses) override;
+    virtual void die() override;
+
+    HashMap<i32, ResolveCallback> m_pending_resolutions;
+    i32 m_next_request_id { 0 };
+};
+
+}
@@ -8,13 +8,18 @@
 
 namespace RequestServer {
 
+class CachedRequest;
 class ConnectionFromClient;
+class ConnectionToLookupServer;
 class Request;
 class GeminiProtocol;
+class HttpCache;
+class HttpCacheTransaction;
 class HttpRequest;
 class HttpProtocol;
 class HttpsRequest;
 class HttpsProtocol;
 class Protocol;
+class TCPConnector;
 
 }
@@ -0,0 +1,630 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Endian.h>
+#include <AK/Hex.h>
+#include <AK/MemoryStream.h>
+#include <LibCore/DateTime.h>
+#include <LibCore/Directory.h>
+#include <LibCore/DirIterator.h>
+#include <LibCore/StandardPaths.h>
+#include <LibCore/System.h>
+#include <RequestServer/HttpCache.h>
+
+namespace RequestServer {
+
+// Note: The least recently used entries are evicted once the entries and bodies take up more than this on disk.
+static constexpr u64 maximum_cache_size = 256 * MiB;
+static constexpr u64 maximum_body_size = 32 * MiB;
+
+// https://www.rfc-editor.org/rfc/rfc9111#section-4.2.2: Heuristic freshness is a fraction of the time since the
+// resource was last modified, which we don't let grow beyond a week.
+static constexpr time_t maximum_heuristic_freshness = 7 * 24 * 60 * 60;
+
+static constexpr u32 entry_magic = 0x43485352; // "RSHC"
+static constexpr u32 entry_version = 1;
+
+struct CacheControl {
+    Optional<time_t> max_age;
+    bool no_cache { false };
+    bool no_store { false };
+};
+
+// https://www.rfc-editor.org/rfc/rfc9111#section-5.2
+static CacheControl parse_cache_control(StringView value)
+{
+    CacheControl cache_control;
+    for (auto directive : value.split_view(',')) {
+        auto name = directive.trim_whitespace();
+        StringView argument;
+        if (auto equals = name.find('='); equals.has_value()) {
+            argument = name.substring_view(*equals + 1).trim_whitespace().trim("\""sv);
+            name = name.substring_view(0, *equals).trim_whitespace();
+        }
+
+        if (name.equals_ignoring_case("max-age"sv)) {
+            // Note: A max-age we can't make sense of makes the response stale right away.
+            cache_control.max_age = argument.to_uint<u32>().value_or(0);
+        } else if (name.equals_ignoring_case("no-cache"sv)) {
+            cache_control.no_cache = true;
+        } else if (name.equals_ignoring_case("no-store"sv)) {
+            cache_control.no_store = true;
+        }
+    }
+    return cache_control;
+}
+
+// https://www.rfc-editor.org/rfc/rfc9110#section-5.6.7
+// FIXME: Only the preferred IMF-fixdate format is understood, not the obsolete RFC 850 and asctime() formats.
+static Optional<time_t> parse_http_date(StringView value)
+{
+    if (!value.ends_with(" GMT"sv))
+        return {};
+    auto date_with_offset = DeprecatedString::formatted("{} +0000", value.substring_view(0, value.length() - 4));
+    auto date = Core::DateTime::parse("%a, %d %b %Y %H:%M:%S %z"sv, date_with_offset);
+    if (!date.has_value())
+        return {};
+    return date->timestamp();
+}
+
+static Optional<DeprecatedString> find_request_header(RequestHeaders const& headers, StringView name)
+{
+    for (auto& header : headers) {
+        if (header.key.equals_ignoring_case(name))
+            return header.value;
+    }
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc9110#section-15.1
+static bool is_heuristically_cacheable(u32 status_code)
+{
+    switch (status_code) {
+    case 200:
+    case 203:
+    case 204:
+    case 300:
+    case 301:
+    case 308:
+    case 404:
+    case 405:
+    case 410:
+    case 414:
+    case 501:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static DeprecatedString key_for(URL const& url)
+{
+    return encode_hex(Crypto::Hash::SHA256::hash(url.serialize(URL::ExcludeFragment::Yes)).bytes());
+}
+
+static DeprecatedString entry_path(DeprecatedString const& key)
+{
+    return DeprecatedString::formatted("{}/entries/{}", HttpCache::directory(), key);
+}
+
+static DeprecatedString body_path(DeprecatedString const& name)
+{
+    return DeprecatedString::formatted("{}/bodies/{}", HttpCache::directory(), name);
+}
+
+static ErrorOr<void> create_directories()
+{
+    TRY(Core::Directory::create(DeprecatedString::formatted("{}/entries", HttpCache::directory()), Core::Directory::CreateDirectories::Yes));
+    TRY(Core::Directory::create(DeprecatedString::formatted("{}/bodies", HttpCache::directory()), Core::Directory::CreateDirectories::Yes));
+    return {};
+}
+
+// Writes to a temporary file first, so that nobody ever gets to see a half-written file.
+static ErrorOr<void> write_file_atomically(DeprecatedString const& path, ReadonlyBytes contents)
+{
+    auto temporary_path = DeprecatedString::formatted("{}.tmp", path);
+    {
+        auto file = TRY(Core::Stream::File::open(temporary_path, Core::Stream::OpenMode::Write | Core::Stream::OpenMode::Truncate, 0600));
+        TRY(file->write_entire_buffer(contents));
+    }
+    TRY(Core::System::rename(temporary_path, path));
+    return {};
+}
+
+// https://www.rfc-editor.org/rfc/rfc9110#section-6.6.1: A response without a valid Date is dated by when we got it.
+static time_t date_value(CachedResponse const& response)
+{
+    if (auto date = response.headers.get("Date"sv); date.has_value()) {
+        if (auto timestamp = parse_http_date(*date); timestamp.has_value())
+            return *timestamp;
+    }
+    return response.response_time;
+}
+
+time_t CachedResponse::current_age(time_t now) const
+{
+    time_t age_value = 0;
+    if (auto age = headers.get("Age"sv); age.has_value())
+        age_value = age->to_uint<u32>().value_or(0);
+
+    auto apparent_age = max<time_t>(0, response_time - date_value(*this));
+    auto response_delay = response_time - request_time;
+    auto corrected_initial_age = max<time_t>(apparent_age, age_value + response_delay);
+    auto resident_time = max<time_t>(0, now - response_time);
+    return corrected_initial_age + resident_time;
+}
+
+time_t CachedResponse::freshness_lifetime() const
+{
+    auto cache_control = parse_cache_control(headers.get("Cache-Control"sv).value_or({}));
+    if (cache_control.max_age.has_value())
+        return *cache_control.max_age;
+
+    auto date = date_value(*this);
+    if (auto expires = headers.get("Expires"sv); expires.has_value()) {
+        // Note: An invalid date, such as "0", means that the response has already expired.
+        auto expiry_date = parse_http_date(*expires);
+        if (!expiry_date.has_value())
+            return 0;
+        return max<time_t>(0, *expiry_date - date);
+    }
+
+    if (auto last_modified = headers.get("Last-Modified"sv); last_modified.has_value() && is_heuristically_cacheable(status_code)) {
+        if (auto last_modified_date = parse_http_date(*last_modified); last_modified_date.has_value())
+            return clamp<time_t>((date - *last_modified_date) / 10, 0, maximum_heuristic_freshness);
+    }
+
+    return 0;
+}
+
+bool CachedResponse::can_be_revalidated() const
+{
+    return headers.contains("ETag"sv) || headers.contains("Last-Modified"sv);
+}
+
+template<typename Headers>
+static ErrorOr<void> write_headers(AK::Stream& stream, Headers const& headers)
+{
+    TRY(stream.write_value<LittleEndian<u32>>(headers.size()));
+    for (auto& header : headers) {
+        TRY(stream.write_value<LittleEndian<u32>>(header.key.length()));
+        TRY(stream.write_entire_buffer(header.key.bytes()));
+        TRY(stream.write_value<LittleEndian<u32>>(header.value.length()));
+        TRY(stream.write_entire_buffer(header.value.bytes()));
+    }
+    return {};
+}
+
+static ErrorOr<DeprecatedString> read_string(FixedMemoryStream& stream)
+{
+    auto length = TRY(stream.read_value<LittleEndian<u32>>());
+    if (length > stream.remaining())
+        return Error::from_string_literal("Cache entry is truncated");
+    auto buffer = TRY(ByteBuffer::create_uninitialized(length));
+    TRY(stream.read_entire_buffer(buffer));
+    return DeprecatedString::copy(buffer);
+}
+
+template<typename Headers>
+static ErrorOr<void> read_headers(FixedMemoryStream& stream, Headers& headers)
+{
+    auto count = TRY(stream.read_value<LittleEndian<u32>>());
+    for (u32 i = 0; i < count; ++i) {
+        auto name = TRY(read_string(stream));
+        auto value = TRY(read_string(stream));
+        headers.set(move(name), move(value));
+    }
+    return {};
+}
+
+static ErrorOr<ByteBuffer> serialize_entry(CachedResponse const& response)
+{
+    AllocatingMemoryStream stream;
+    TRY(stream.write_value<LittleEndian<u32>>(entry_magic));
+    TRY(stream.write_value<LittleEndian<u32>>(entry_version));
+    TRY(stream.write_entire_buffer(response.body_digest.bytes()));
+    TRY(stream.write_value<LittleEndian<u64>>(response.body_size));
+    TRY(stream.write_value<LittleEndian<u32>>(response.status_code));
+    TRY(stream.write_value<LittleEndian<i64>>(response.request_time));
+    TRY(stream.write_value<LittleEndian<i64>>(response.response_time));
+
+    auto url = response.url.serialize(URL::ExcludeFragment::Yes);
+    TRY(stream.write_value<LittleEndian<u32>>(url.length()));
+    TRY(stream.write_entire_buffer(url.bytes()));
+    TRY(write_headers(stream, response.headers));
+    TRY(write_headers(stream, response.vary_headers));
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(stream.used_buffer_size()));
+    TRY(stream.read_entire_buffer(buffer));
+    return buffer;
+}
+
+// Reads as much of an entry as the index needs, which is just the part in front of the (variable-length) headers.
+static ErrorOr<void> read_entry_prologue(FixedMemoryStream& stream, CachedResponse& response)
+{
+    if (TRY(stream.read_value<LittleEndian<u32>>()) != entry_magic)
+        return Error::from_string_literal("Not a cache entry");
+    if (TRY(stream.read_value<LittleEndian<u32>>()) != entry_version)
+        return Error::from_string_literal("Cache entry has an unsupported version");
+    TRY(stream.read_entire_buffer({ response.body_digest.data, sizeof(response.body_digest.data) }));
+    response.body_size = TRY(stream.read_value<LittleEndian<u64>>());
+    return {};
+}
+
+HttpCache& HttpCache::the()
+{
+    static HttpCache s_the;
+    return s_the;
+}
+
+DeprecatedString HttpCache::directory()
+{
+    return DeprecatedString::formatted("{}/.cache/RequestServer", Core::StandardPaths::home_directory());
+}
+
+bool HttpCache::can_cache_request(HTTP::HttpRequest::Method method, RequestHeaders const& headers)
+{
+    if (method != HTTP::HttpRequest::Method::GET)
+        return false;
+
+    if (parse_cache_control(find_request_header(headers, "Cache-Control"sv).value_or({})).no_store)
+        return false;
+
+    // Note: These are only ever sent by clients that keep a cache of their own, and expect to get an answer about
+    //       their own copy of the resource.
+    for (auto name : { "If-Match"sv, "If-None-Match"sv, "If-Modified-Since"sv, "If-Unmodified-Since"sv, "If-Range"sv, "Range"sv }) {
+        if (find_request_header(headers, name).has_value())
+            return false;
+    }
+    return true;
+}
+
+// https://www.rfc-editor.org/rfc/rfc9111#section-3
+bool HttpCache::can_store_response(u32 status_code, ResponseHeaders const& headers)
+{
+    // Note: We don't know how to combine partial responses, and 304 is only ever an answer to a conditional request.
+    if (status_code < 200 || status_code == 206 || status_code == 304)
+        return false;
+
+    auto cache_control = parse_cache_control(headers.get("Cache-Control"sv).value_or({}));
+    if (cache_control.no_store)
+        return false;
+
+    if (auto vary = headers.get("Vary"sv); vary.has_value() && vary->contains('*'))
+        return false;
+
+    auto has_explicit_expiration_time = cache_control.max_age.has_value() || headers.contains("Expires"sv);
+    if (!has_explicit_expiration_time && !is_heuristically_cacheable(status_code))
+        return false;
+
+    // Note: A response that is stale right away and can't be revalidated would just take up space.
+    CachedResponse response;
+    response.status_code = status_code;
+    response.headers = headers;
+    response.request_time = response.response_time = time(nullptr);
+    return response.freshness_lifetime() > response.current_age(response.response_time) || response.can_be_revalidated();
+}
+
+Optional<HttpCache::LookupResult> HttpCache::lookup(HTTP::HttpRequest::Method method, URL const& url, RequestHeaders const& request_headers)
+{
+    if (!can_cache_request(method, request_headers))
+        return {};
+
+    load_index();
+    auto key = key_for(url);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+        return {};
+
+    auto response_or_error = read_entry(key);
+    if (response_or_error.is_error()) {
+        dbgln_if(HTTPCACHE_DEBUG, "HttpCache: Failed to read the entry for {}: {}", url, response_or_error.error());
+        remove_entry(key);
+        return {};
+    }
+    auto response = response_or_error.release_value();
+    if (!response.url.equals(url, URL::ExcludeFragment::Yes))
+        return {};
+
+    // https://www.rfc-editor.org/rfc/rfc9111#section-4.1
+    for (auto& header : response.vary_headers) {
+        if (find_request_header(request_headers, header.key).value_or({}) != header.value) {
+            dbgln_if(HTTPCACHE_DEBUG, "HttpCache: Stored response for {} varies on {}", url, header.key);
+            return {};
+        }
+    }
+
+    auto now = time(nullptr);
+    auto current_age = response.current_age(now);
+    auto request_cache_control = parse_cache_control(find_request_header(request_headers, "Cache-Control"sv).value_or({}));
+    auto response_cache_control = parse_cache_control(response.headers.get("Cache-Control"sv).value_or({}));
+
+    // https://www.rfc-editor.org/rfc/rfc9111#section-4.2
+    bool is_fresh = response.freshness_lifetime() > current_age;
+    if (request_cache_control.no_cache || response_cache_control.no_cache || find_request_header(request_headers, "Pragma"sv).value_or({}).contains("no-cache"sv))
+        is_fresh = false;
+    if (request_cache_control.max_age.has_value() && current_age > *request_cache_control.max_age)
+        is_fresh = false;
+
+    if (!is_fresh && !response.can_be_revalidated())
+        return {};
+
+    it->value.last_use = now;
+    // Note: The entry's modification time is what the LRU order is restored from the next time the cache is loaded.
+    (void)Core::System::utime(entry_path(key), {});
+
+    dbgln_if(HTTPCACHE_DEBUG, "HttpCache: Found {} response for {}, age {}s", is_fresh ? "fresh" : "stale", url, current_age);
+    if (is_fresh)
+        response.headers.set("Age", DeprecatedString::number(current_age));
+    return LookupResult { move(response), is_fresh };
+}
+
+ErrorOr<RefPtr<Core::MappedFile>> HttpCache::map_body(CachedResponse const& response) const
+{
+    if (response.body_size == 0)
+        return nullptr;
+
+    auto body = TRY(Core::MappedFile::map(body_path(encode_hex(response.body_digest.bytes()))));
+    if (body->size() != response.body_size)
+        return Error::from_string_literal("Cached body has the wrong size");
+    return body;
+}
+
+void HttpCache::store(CachedResponse response, ReadonlyBytes body)
+{
+    load_index();
+    auto key = key_for(response.url);
+    remove_entry(key);
+    if (body.size() > maximum_body_size)
+        return;
+
+    // Note: Cookies are the client's business, replaying them from the cache would only resurrect stale ones.
+    response.headers.remove("Set-Cookie"sv);
+    response.body_digest = Crypto::Hash::SHA256::hash(body.data(), body.size());
+    response.body_size = body.size();
+
+    auto entry_or_error = serialize_entry(response);
+    if (entry_or_error.is_error() || create_directories().is_error())
+        return;
+    auto entry = entry_or_error.release_value();
+    auto body_name = encode_hex(response.body_digest.bytes());
+
+    auto required_size = entry.size() + (m_bodies.contains(body_name) ? 0 : body.size());
+    if (required_size > maximum_cache_size)
+        return;
+    evict_until_below(maximum_cache_size - required_size);
+
+    if (!m_bodies.contains(body_name)) {
+        if (auto result = write_file_atomically(body_path(body_name), body); result.is_error()) {
+            dbgln("HttpCache: Failed to store the body of {}: {}", response.url, result.error());
+            return;
+        }
+    }
+    if (auto result = write_file_atomically(entry_path(key), entry); result.is_error()) {
+        dbgln("HttpCache: Failed to store the entry for {}: {}", response.url, result.error());
+        if (!m_bodies.contains(body_name))
+            (void)Core::System::unlink(body_path(body_name));
+        return;
+    }
+
+    dbgln_if(HTTPCACHE_DEBUG, "HttpCache: Stored {} response for {} ({} bytes)", response.status_code, response.url, body.size());
+    add_entry(key, { move(body_name), entry.size(), time(nullptr) });
+}
+
+void HttpCache::refresh(CachedResponse const& response)
+{
+    load_index();
+    auto key = key_for(response.url);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end() || it->value.body_name != encode_hex(response.body_digest.bytes()))
+        return;
+
+    auto entry = serialize_entry(response);
+    if (entry.is_error() || write_file_atomically(entry_path(key), entry.value()).is_error()) {
+        remove_entry(key);
+        return;
+    }
+
+    dbgln_if(HTTPCACHE_DEBUG, "HttpCache: Refreshed the entry for {}", response.url);
+    m_size_in_bytes -= it->value.size_in_bytes;
+    m_size_in_bytes += entry.value().size();
+    it->value.size_in_bytes = entry.value().size();
+    it->value.last_use = time(nullptr);
+}
+
+void HttpCache::invalidate(URL const& url)
+{
+    load_index();
+    remove_entry(key_for(url));
+}
+
+void HttpCache::load_index()
+{
+    if (m_is_loaded)
+        return;
+    m_is_loaded = true;
+
+    Core::DirIterator entries(DeprecatedString::formatted("{}/entries", directory()), Core::DirIterator::SkipDots);
+    while (entries.has_next()) {
+        auto key = entries.next_path();
+        auto path = entry_path(key);
+        auto entry_or_error = [&]() -> ErrorOr<Entry> {
+            auto file = TRY(Core::MappedFile::map(path));
+            auto stream = TRY(FixedMemoryStream::construct(file->bytes()));
+            CachedResponse response;
+            TRY(read_entry_prologue(*stream, response));
+            auto body_name = encode_hex(response.body_digest.bytes());
+            auto body_stat = TRY(Core::System::stat(body_path(body_name)));
+            if (static_cast<u64>(body_stat.st_size) != response.body_size)
+                return Error::from_string_literal("Cached body has the wrong size");
+            auto entry_stat = TRY(Core::System::stat(path));
+            return Entry { move(body_name), file->size(), entry_stat.st_mtime };
+        }();
+
+        // Note: This also cleans up the temporary files of writes that were interrupted.
+        if (entry_or_error.is_error()) {
+            dbgln_if(HTTPCACHE_DEBUG, "HttpCache: Discarding {}: {}", path, entry_or_error.error());
+            (void)Core::System::unlink(path);
+            continue;
+        }
+        add_entry(key, entry_or_error.release_value());
+    }
+
+    Core::DirIterator bodies(DeprecatedString::formatted("{}/bodies", directory()), Core::DirIterator::SkipDots);
+    while (bodies.has_next()) {
+        auto name = bodies.next_path();
+        if (!m_bodies.contains(name))
+            (void)Core::System::unlink(body_path(name));
+    }
+
+    dbgln_if(HTTPCACHE_DEBUG, "HttpCache: Loaded {} entries with {} bodies, {} bytes", m_entries.size(), m_bodies.size(), m_size_in_bytes);
+    evict_until_below(maximum_cache_size);
+}
+
+ErrorOr<CachedResponse> HttpCache::read_entry(DeprecatedString const& key) const
+{
+    auto file = TRY(Core::MappedFile::map(entry_path(key)));
+    auto stream = TRY(FixedMemoryStream::construct(file->bytes()));
+
+    CachedResponse response;
+    TRY(read_entry_prologue(*stream, response));
+    response.status_code = TRY(stream->read_value<LittleEndian<u32>>());
+    response.request_time = TRY(stream->read_value<LittleEndian<i64>>());
+    response.response_time = TRY(stream->read_value<LittleEndian<i64>>());
+    response.url = URL(TRY(read_string(*stream)));
+    TRY(read_headers(*stream, response.headers));
+    TRY(read_headers(*stream, response.vary_headers));
+    return response;
+}
+
+void HttpCache::add_entry(DeprecatedString const& key, Entry entry)
+{
+    auto& body = m_bodies.ensure(entry.body_name);
+    if (body.reference_count++ == 0) {
+        auto body_stat = Core::System::stat(body_path(entry.body_name));
+        body.size_in_bytes = body_stat.is_error() ? 0 : body_stat.value().st_size;
+        m_size_in_bytes += body.size_in_bytes;
+    }
+    m_size_in_bytes += entry.size_in_bytes;
+    m_entries.set(key, move(entry));
+}
+
+void HttpCache::remove_entry(DeprecatedString const& key)
+{
+    auto entry = m_entries.take(key);
+    if (!entry.has_value())
+        return;
+
+    (void)Core::System::unlink(entry_path(key));
+    m_size_in_bytes -= entry->size_in_bytes;
+
+    auto body = m_bodies.find(entry->body_name);
+    VERIFY(body != m_bodies.end());
+    if (--body->value.reference_count == 0) {
+        (void)Core::System::unlink(body_path(entry->body_name));
+        m_size_in_bytes -= body->value.size_in_bytes;
+        m_bodies.remove(body);
+    }
+}
+
+void HttpCache::evict_until_below(u64 size_in_bytes)
+{
+    while (m_size_in_bytes > size_in_bytes && !m_entries.is_empty()) {
+        auto least_recently_used = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->value.last_use < least_recently_used->value.last_use)
+                least_recently_used = it;
+        }
+        dbgln_if(HTTPCACHE_DEBUG, "HttpCache: Evicting {}", least_recently_used->key);
+        remove_entry(DeprecatedString { least_recently_used->key });
+    }
+}
+
+HttpCacheTransaction::HttpCacheTransaction(URL url, RequestHeaders request_headers, Core::Stream::File& output_stream, Optional<CachedResponse> stale_response, RefPtr<Core::MappedFile> stale_body)
+    : m_url(move(url))
+    , m_request_headers(move(request_headers))
+    , m_output_stream(output_stream)
+    , m_stale_response(move(stale_response))
+    , m_stale_body(move(stale_body))
+    , m_request_time(time(nullptr))
+{
+}
+
+void HttpCacheTransaction::did_receive_headers(u32 status_code, ResponseHeaders const& headers)
+{
+    // Note: Jobs report the headers a second time along with the trailers, which we don't care about.
+    if (m_status_code.has_value())
+        return;
+    m_status_code = status_code;
+    m_response_time = time(nullptr);
+
+    // https://www.rfc-editor.org/rfc/rfc9111#section-4.3.4
+    if (status_code == 304 && m_stale_response.has_value()) {
+        auto response = m_stale_response.release_value();
+        for (auto& header : headers) {
+            if (!header.key.equals_ignoring_case("Content-Length"sv))
+                response.headers.set(header.key, header.value);
+        }
+        response.request_time = m_request_time;
+        response.response_time = m_response_time;
+        HttpCache::the().refresh(response);
+
+        m_revalidated_response = move(response);
+        stop_recording();
+        return;
+    }
+
+    m_stale_body = nullptr;
+    m_response_headers = headers;
+    if (!HttpCache::can_store_response(status_code, headers))
+        stop_recording();
+}
+
+void HttpCacheTransaction::did_finish(bool success)
+{
+    if (!success || !m_is_recording || !m_status_code.has_value()) {
+        // https://www.rfc-editor.org/rfc/rfc9111#section-4.3.3: Whatever was stored is no good anymore when the server
+        // has replaced it with something we can't store.
+        if (success && m_status_code.has_value() && m_stale_response.has_value())
+            HttpCache::the().invalidate(m_url);
+        return;
+    }
+
+    CachedResponse response;
+    response.url = m_url;
+    response.status_code = *m_status_code;
+    response.headers = move(m_response_headers);
+    response.request_time = m_request_time;
+    response.response_time = m_response_time;
+    if (auto vary = response.headers.get("Vary"sv); vary.has_value()) {
+        for (auto name : vary->split_view(',')) {
+            name = name.trim_whitespace();
+            response.vary_headers.set(name, find_request_header(m_request_headers, name).value_or({}));
+        }
+    }
+
+    HttpCache::the().store(move(response), m_body);
+    stop_recording();
+}
+
+ErrorOr<size_t> HttpCacheTransaction::write(ReadonlyBytes bytes)
+{
+    auto written = TRY(m_output_stream.write(bytes));
+    if (m_is_recording) {
+        if (m_body.size() + written > maximum_body_size || m_body.try_append(bytes.trim(written)).is_error())
+            stop_recording();
+    }
+    return written;
+}
+
+void HttpCacheTransaction::stop_recording()
+{
+    m_is_recording = false;
+    m_body.clear();
+}
+
+}
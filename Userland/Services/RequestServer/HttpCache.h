@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/DeprecatedString.h>
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
+#include <AK/Stream.h>
+#include <AK/URL.h>
+#include <LibCore/MappedFile.h>
+#include <LibCore/Stream.h>
+#include <LibCrypto/Hash/SHA2.h>
+#include <LibHTTP/HttpRequest.h>
+#include <time.h>
+
+namespace RequestServer {
+
+using RequestHeaders = HashMap<DeprecatedString, DeprecatedString>;
+using ResponseHeaders = HashMap<DeprecatedString, DeprecatedString, CaseInsensitiveStringTraits>;
+
+struct CachedResponse {
+    URL url;
+    u32 status_code { 0 };
+    ResponseHeaders headers;
+    // The request headers named by the response's Vary header, as they were sent when the response was stored.
+    RequestHeaders vary_headers;
+    Crypto::Hash::SHA256::DigestType body_digest {};
+    u64 body_size { 0 };
+    time_t request_time { 0 };
+    time_t response_time { 0 };
+
+    // https://www.rfc-editor.org/rfc/rfc9111#section-4.2
+    time_t current_age(time_t now) const;
+    time_t freshness_lifetime() const;
+    bool can_be_revalidated() const;
+};
+
+// An HTTP cache (RFC 9111) for the responses to GET requests, persisted across runs in the user's home directory.
+//
+// Every entry is a small file named after the SHA-256 digest of its URL that holds the response's status and headers.
+// The bodies are stored separately, named after the SHA-256 digest of their contents, so that identical resources
+// served from different URLs are only stored once. Both are only ever read through a memory mapping, and the body
+// is not mapped until the response is actually sent to the client.
+//
+// The total size of the cache is bounded; the least recently used entries are evicted to make room for new ones.
+class HttpCache {
+public:
+    static HttpCache& the();
+    static DeprecatedString directory();
+
+    struct LookupResult {
+        CachedResponse response;
+        // Whether the response may be used as is. Otherwise, it has to be revalidated with the server first.
+        bool is_fresh { false };
+    };
+
+    // Returns the stored response for the request, if there is one that could be used to answer it.
+    Optional<LookupResult> lookup(HTTP::HttpRequest::Method, URL const&, RequestHeaders const&);
+    // Note: Empty bodies are not mapped, so this returns null for them.
+    ErrorOr<RefPtr<Core::MappedFile>> map_body(CachedResponse const&) const;
+
+    // Requests that the cache stays out of entirely: anything but GET, and requests with which the client asks for
+    // something the cache doesn't do, such as a conditional request for its own cached copy.
+    static bool can_cache_request(HTTP::HttpRequest::Method, RequestHeaders const&);
+    static bool can_store_response(u32 status_code, ResponseHeaders const&);
+
+    void store(CachedResponse, ReadonlyBytes body);
+    // Replaces the headers of a stored response after the server confirmed that its body is still current.
+    void refresh(CachedResponse const&);
+    void invalidate(URL const&);
+
+private:
+    HttpCache() = default;
+
+    struct Entry {
+        DeprecatedString body_name;
+        u64 size_in_bytes { 0 };
+        time_t last_use { 0 };
+    };
+
+    struct Body {
+        u64 size_in_bytes { 0 };
+        size_t reference_count { 0 };
+    };
+
+    void load_index();
+    ErrorOr<CachedResponse> read_entry(DeprecatedString const& key) const;
+    void add_entry(DeprecatedString const& key, Entry);
+    void remove_entry(DeprecatedString const& key);
+    void evict_until_below(u64 size_in_bytes);
+
+    bool m_is_loaded { false };
+    HashMap<DeprecatedString, Entry> m_entries;
+    HashMap<DeprecatedString, Body> m_bodies;
+    u64 m_size_in_bytes { 0 };
+};
+
+// Follows a single network request on behalf of the cache: it passes everything the job writes on to the client while
+// keeping a copy of the body, and stores the response once it is complete. If the request was sent to revalidate a
+// stale response, the server may instead tell us to keep using the response we have.
+class HttpCacheTransaction final : public AK::Stream {
+public:
+    HttpCacheTransaction(URL, RequestHeaders, Core::Stream::File& output_stream, Optional<CachedResponse> stale_response, RefPtr<Core::MappedFile> stale_body);
+
+    void did_receive_headers(u32 status_code, ResponseHeaders const&);
+    void did_finish(bool success);
+
+    // The refreshed stale response, if the server confirmed that it may still be used.
+    Optional<CachedResponse> const& revalidated_response() const { return m_revalidated_response; }
+
+    // Note: The body is mapped as soon as the request starts, so that it can't be evicted from under us while the
+    //       server is being asked about it.
+    RefPtr<Core::MappedFile> const& stale_body() const { return m_stale_body; }
+
+    virtual ErrorOr<Bytes> read(Bytes) override { return Error::from_errno(EBADF); }
+    virtual ErrorOr<size_t> write(ReadonlyBytes) override;
+    virtual bool is_eof() const override { return m_output_stream.is_eof(); }
+    virtual bool is_open() const override { return m_output_stream.is_open(); }
+    virtual void close() override { m_output_stream.close(); }
+
+private:
+    void stop_recording();
+
+    URL m_url;
+    RequestHeaders m_request_headers;
+    Core::Stream::File& m_output_stream;
+    Optional<CachedResponse> m_stale_response;
+    RefPtr<Core::MappedFile> m_stale_body;
+    Optional<CachedResponse> m_revalidated_response;
+    time_t m_request_time { 0 };
+    time_t m_response_time { 0 };
+
+    Optional<u32> m_status_code;
+    ResponseHeaders m_response_headers;
+    bool m_is_recording { true };
+    ByteBuffer m_body;
+};
+
+}
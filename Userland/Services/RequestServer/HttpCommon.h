@@ -14,8 +14,10 @@
 #include <AK/OwnPtr.h>
 #include <AK/Types.h>
 #include <LibHTTP/HttpRequest.h>
+#include <RequestServer/CachedRequest.h>
 #include <RequestServer/ConnectionCache.h>
 #include <RequestServer/ConnectionFromClient.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/Request.h>
 
 namespace RequestServer::Detail {
@@ -24,6 +26,14 @@ template<typename TSelf, typename TJob>
 void init(TSelf* self, TJob job)
 {
     job->on_headers_received = [self](auto& headers, auto response_code) {
+        if (auto* transaction = self->cache_transaction(); transaction && response_code.has_value()) {
+            transaction->did_receive_headers(response_code.value(), headers);
+            if (auto& revalidated_response = transaction->revalidated_response(); revalidated_response.has_value()) {
+                self->set_status_code(revalidated_response->status_code);
+                self->set_response_headers(revalidated_response->headers);
+                return;
+            }
+        }
         if (response_code.has_value())
             self->set_status_code(response_code.value());
         self->set_response_headers(headers);
@@ -33,6 +43,11 @@ void init(TSelf* self, TJob job)
         Core::deferred_invoke([url = self->job().url(), socket = self->job().socket()] {
             ConnectionCache::request_did_finish(url, socket);
         });
+        if (auto* transaction = self->cache_transaction()) {
+            if (auto& revalidated_response = transaction->revalidated_response(); success && revalidated_response.has_value())
+                return self->did_load_from_cache(revalidated_response.value(), transaction->stale_body());
+            transaction->did_finish(success);
+        }
         if (auto* response = self->job().response()) {
             self->set_status_code(response->code());
             self->set_response_headers(response->headers());
@@ -90,7 +105,45 @@ OwnPtr<Request> start_request(TBadgedProtocol&& protocol, ConnectionFromClient&
     else
         request.set_method(HTTP::HttpRequest::Method::GET);
     request.set_url(url);
-    request.set_headers(headers);
+
+    // https://www.rfc-editor.org/rfc/rfc9111#section-4.4
+    switch (request.method()) {
+    case HTTP::HttpRequest::Method::GET:
+    case HTTP::HttpRequest::Method::HEAD:
+    case HTTP::HttpRequest::Method::OPTIONS:
+    case HTTP::HttpRequest::Method::TRACE:
+        break;
+    default:
+        // Note: Unsafe methods are likely to change the resource, so our copy of it can't be trusted anymore.
+        HttpCache::the().invalidate(url);
+        break;
+    }
+
+    Optional<CachedResponse> cached_response;
+    RefPtr<Core::MappedFile> cached_body;
+    if (auto lookup_result = HttpCache::the().lookup(request.method(), url, headers); lookup_result.has_value()) {
+        if (auto body_or_error = HttpCache::the().map_body(lookup_result->response); !body_or_error.is_error()) {
+            if (lookup_result->is_fresh) {
+                auto output_stream = MUST(Core::Stream::File::adopt_fd(pipe_result.value().write_fd, Core::Stream::OpenMode::Write));
+                auto cached_request = CachedRequest::create(client, url, move(output_stream));
+                cached_request->set_request_fd(pipe_result.value().read_fd);
+                cached_request->did_load_from_cache(move(lookup_result->response), body_or_error.release_value());
+                return cached_request;
+            }
+            cached_response = move(lookup_result->response);
+            cached_body = body_or_error.release_value();
+        }
+    }
+
+    // https://www.rfc-editor.org/rfc/rfc9111#section-4.3.1
+    auto request_headers = headers;
+    if (cached_response.has_value()) {
+        if (auto etag = cached_response->headers.get("ETag"sv); etag.has_value())
+            request_headers.set("If-None-Match", etag.release_value());
+        if (auto last_modified = cached_response->headers.get("Last-Modified"sv); last_modified.has_value())
+            request_headers.set("If-Modified-Since", last_modified.release_value());
+    }
+    request.set_headers(request_headers);
 
     auto allocated_body_result = ByteBuffer::copy(body);
     if (allocated_body_result.is_error())
@@ -98,9 +151,15 @@ OwnPtr<Request> start_request(TBadgedProtocol&& protocol, ConnectionFromClient&
     request.set_body(allocated_body_result.release_value());
 
     auto output_stream = MUST(Core::Stream::File::adopt_fd(pipe_result.value().write_fd, Core::Stream::OpenMode::Write));
-    auto job = TJob::construct(move(request), *output_stream);
+    OwnPtr<HttpCacheTransaction> cache_transaction;
+    if (HttpCache::can_cache_request(request.method(), headers))
+        cache_transaction = make<HttpCacheTransaction>(url, headers, *output_stream, move(cached_response), move(cached_body));
+
+    auto job = TJob::construct(move(request), cache_transaction ? static_cast<AK::Stream&>(*cache_transaction) : *output_stream);
     auto protocol_request = TRequest::create_with_job(forward<TBadgedProtocol>(protocol), client, (TJob&)*job, move(output_stream));
     protocol_request->set_request_fd(pipe_result.value().read_fd);
+    if (cache_transaction)
+        protocol_request->set_cache_transaction(cache_transaction.release_nonnull());
 
     if constexpr (IsSame<typename TBadgedProtocol::Type, HttpsProtocol>)
         ConnectionCache::get_or_create_connection(ConnectionCache::g_tls_connection_cache, url, *job, proxy_data);
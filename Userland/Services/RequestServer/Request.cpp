@@ -51,4 +51,46 @@ void Request::did_request_certificates()
     m_client.did_request_certificates({}, *this);
 }
 
+void Request::did_load_from_cache(CachedResponse response, RefPtr<Core::MappedFile> body)
+{
+    m_cached_response = move(response);
+    m_cached_body = move(body);
+    m_cached_body_offset = 0;
+
+    // Note: The pipe is writable right away, so this also makes sure that the client only hears about the response
+    //       once it knows about the request.
+    m_cached_body_notifier = Core::Notifier::construct(m_output_stream->fd(), Core::Notifier::Event::Write);
+    m_cached_body_notifier->on_ready_to_write = [this] { send_cached_response(); };
+}
+
+void Request::send_cached_response()
+{
+    if (m_cached_response.has_value()) {
+        auto response = m_cached_response.release_value();
+        set_status_code(response.status_code);
+        set_response_headers(response.headers);
+    }
+
+    auto body = m_cached_body ? m_cached_body->bytes() : ReadonlyBytes {};
+    while (m_cached_body_offset < body.size()) {
+        auto result = m_output_stream->write(body.slice(m_cached_body_offset));
+        if (result.is_error()) {
+            if (result.error().is_errno() && result.error().code() == EINTR)
+                continue;
+            // Note: The notifier lets us know when the client has made room in the pipe again.
+            if (result.error().is_errno() && result.error().code() == EAGAIN)
+                return;
+            m_cached_body_notifier->set_enabled(false);
+            did_finish(false);
+            return;
+        }
+        m_cached_body_offset += result.value();
+    }
+
+    m_cached_body_notifier->set_enabled(false);
+    set_downloaded_size(body.size());
+    did_progress(body.size(), body.size());
+    did_finish(true);
+}
+
 }
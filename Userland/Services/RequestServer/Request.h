@@ -11,7 +11,10 @@
 #include <AK/Optional.h>
 #include <AK/RefCounted.h>
 #include <AK/URL.h>
+#include <LibCore/MappedFile.h>
+#include <LibCore/Notifier.h>
 #include <RequestServer/Forward.h>
+#include <RequestServer/HttpCache.h>
 
 namespace RequestServer {
 
@@ -42,6 +45,12 @@ public:
     void set_downloaded_size(size_t size) { m_downloaded_size = size; }
     Core::Stream::File const& output_stream() const { return *m_output_stream; }
 
+    HttpCacheTransaction* cache_transaction() { return m_cache_transaction.ptr(); }
+    void set_cache_transaction(NonnullOwnPtr<HttpCacheTransaction> transaction) { m_cache_transaction = move(transaction); }
+
+    // Answers the request with a response from the HTTP cache, regardless of what (if anything) the network said.
+    void did_load_from_cache(CachedResponse, RefPtr<Core::MappedFile> body);
+
 protected:
     explicit Request(ConnectionFromClient&, NonnullOwnPtr<Core::Stream::File>&&);
 
@@ -54,6 +63,14 @@ private:
     size_t m_downloaded_size { 0 };
     NonnullOwnPtr<Core::Stream::File> m_output_stream;
     HashMap<DeprecatedString, DeprecatedString, CaseInsensitiveStringTraits> m_response_headers;
+
+    void send_cached_response();
+
+    OwnPtr<HttpCacheTransaction> m_cache_transaction;
+    Optional<CachedResponse> m_cached_response;
+    RefPtr<Core::MappedFile> m_cached_body;
+    size_t m_cached_body_offset { 0 };
+    RefPtr<Core::Notifier> m_cached_body_notifier;
 };
 
 }
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/AllOf.h>
+#include <AK/Debug.h>
+#include <LibCore/SocketAddress.h>
+#include <LibCore/System.h>
+#include <RequestServer/ConnectionToLookupServer.h>
+#include <RequestServer/TCPConnector.h>
+#include <sys/socket.h>
+
+namespace RequestServer {
+
+// How long an attempt gets to connect on its own before the next one is started alongside it. (RFC 8305, 5)
+static constexpr int s_connection_attempt_delay_ms = 250;
+
+TCPConnector::TCPConnector(DeprecatedString host, u16 port)
+    : m_host(move(host))
+    , m_port(port)
+{
+}
+
+TCPConnector::~TCPConnector()
+{
+    for (auto& attempt : m_attempts)
+        abandon(*attempt);
+}
+
+void TCPConnector::start()
+{
+    if (auto address = IPv4Address::from_string(m_host); address.has_value())
+        return did_resolve(Vector { address.release_value() });
+
+    auto lookup_server = ConnectionToLookupServer::the();
+    if (!lookup_server) {
+        // All we can do now is to let the name be resolved while connecting, one address after another.
+        return finish(Core::Stream::TCPSocket::connect(m_host, m_port));
+    }
+    lookup_server->resolve(m_host, [self = NonnullRefPtr(*this)](auto addresses) {
+        self->did_resolve(move(addresses));
+    });
+}
+
+void TCPConnector::did_resolve(ErrorOr<Vector<IPv4Address>> addresses)
+{
+    if (m_finished)
+        return;
+    if (addresses.is_error())
+        return finish(addresses.release_error());
+
+    m_addresses = addresses.release_value();
+    m_attempt_delay_timer = MUST(Core::Timer::create_repeating(s_connection_attempt_delay_ms, [this] { start_next_attempt(); }, this));
+    start_next_attempt();
+}
+
+void TCPConnector::start_next_attempt()
+{
+    if (m_finished)
+        return;
+    if (m_next_address_index >= m_addresses.size()) {
+        m_attempt_delay_timer->stop();
+        return;
+    }
+
+    m_attempts.append(make<Attempt>());
+    auto& attempt = *m_attempts.last();
+    attempt.address = m_addresses[m_next_address_index++];
+    dbgln_if(REQUESTSERVER_DEBUG, "TCPConnector: Connecting to {} at {}:{}", m_host, attempt.address, m_port);
+
+    m_attempt_delay_timer->restart();
+    if (auto result = start_attempt(attempt); result.is_error())
+        did_fail(attempt, result.release_error());
+}
+
+ErrorOr<void> TCPConnector::start_attempt(Attempt& attempt)
+{
+    attempt.fd = TRY(Core::System::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+
+    auto socket_address = Core::SocketAddress { attempt.address, m_port }.to_sockaddr_in();
+    if (auto result = Core::System::connect(attempt.fd, bit_cast<sockaddr*>(&socket_address), sizeof(socket_address)); !result.is_error()) {
+        did_connect(attempt);
+        return {};
+    } else if (!result.error().is_errno() || result.error().code() != EINPROGRESS) {
+        return result.release_error();
+    }
+
+    attempt.notifier = Core::Notifier::construct(attempt.fd, Core::Notifier::Write);
+    attempt.notifier->on_ready_to_write = [this, &attempt] {
+        attempt.notifier->set_enabled(false);
+        int error = 0;
+        socklen_t error_size = sizeof(error);
+        if (auto result = Core::System::getsockopt(attempt.fd, SOL_SOCKET, SO_ERROR, &error, &error_size); result.is_error())
+            return did_fail(attempt, result.release_error());
+        if (error != 0)
+            return did_fail(attempt, Error::from_errno(error));
+        did_connect(attempt);
+    };
+    return {};
+}
+
+void TCPConnector::did_connect(Attempt& attempt)
+{
+    if (m_finished)
+        return;
+    dbgln_if(REQUESTSERVER_DEBUG, "TCPConnector: Connected to {} at {}:{}", m_host, attempt.address, m_port);
+
+    if (attempt.notifier)
+        attempt.notifier->set_enabled(false);
+    auto fd = exchange(attempt.fd, -1);
+    auto socket = Core::Stream::TCPSocket::adopt_fd(fd);
+    if (socket.is_error()) {
+        (void)Core::System::close(fd);
+        return finish(socket.release_error());
+    }
+    // Sockets that were connected by name are blocking, and everyone who uses ours expects the same.
+    if (auto result = socket.value()->set_blocking(true); result.is_error())
+        return finish(result.release_error());
+    finish(socket.release_value());
+}
+
+void TCPConnector::did_fail(Attempt& attempt, Error error)
+{
+    if (m_finished)
+        return;
+    dbgln_if(REQUESTSERVER_DEBUG, "TCPConnector: Connecting to {} at {}:{} failed: {}", m_host, attempt.address, m_port, error);
+    abandon(attempt);
+
+    // There's no need to give the attempt that failed any head start.
+    if (m_next_address_index < m_addresses.size())
+        return start_next_attempt();
+
+    bool have_all_attempts_failed = all_of(m_attempts, [](auto& other_attempt) { return other_attempt->fd == -1; });
+    if (have_all_attempts_failed)
+        finish(move(error));
+}
+
+void TCPConnector::abandon(Attempt& attempt)
+{
+    // Note: This may be called from the callback of the notifier, so it has to stay around until we're destroyed.
+    if (attempt.notifier)
+        attempt.notifier->set_enabled(false);
+    if (attempt.fd != -1)
+        (void)Core::System::close(exchange(attempt.fd, -1));
+}
+
+void TCPConnector::finish(ErrorOr<NonnullOwnPtr<Core::Stream::TCPSocket>> result)
+{
+    if (m_finished)
+        return;
+    m_finished = true;
+    if (m_attempt_delay_timer)
+        m_attempt_delay_timer->stop();
+    for (auto& attempt : m_attempts)
+        abandon(*attempt);
+
+    // Note: The callback will likely get rid of us, which our caller may not be ready for.
+    deferred_invoke([this, result = move(result)]() mutable {
+        if (on_finish)
+            on_finish(move(result));
+    });
+}
+
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/DeprecatedString.h>
+#include <AK/Function.h>
+#include <AK/IPv4Address.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Vector.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/Object.h>
+#include <LibCore/Stream.h>
+#include <LibCore/Timer.h>
+
+namespace RequestServer {
+
+// Connects to a host without blocking: its name is resolved by LookupServer, and if it has more than one address,
+// connection attempts to them are raced against each other, each one getting a head start on the next. (RFC 8305)
+class TCPConnector final : public Core::Object {
+    C_OBJECT(TCPConnector);
+
+public:
+    virtual ~TCPConnector() override;
+
+    // Called once, with the socket of the first attempt that succeeded or the error of the last one that failed.
+    Function<void(ErrorOr<NonnullOwnPtr<Core::Stream::TCPSocket>>)> on_finish;
+
+    void start();
+
+private:
+    TCPConnector(DeprecatedString host, u16 port);
+
+    struct Attempt {
+        IPv4Address address;
+        int fd { -1 };
+        RefPtr<Core::Notifier> notifier;
+    };
+
+    void did_resolve(ErrorOr<Vector<IPv4Address>>);
+    void start_next_attempt();
+    ErrorOr<void> start_attempt(Attempt&);
+    void did_connect(Attempt&);
+    void did_fail(Attempt&, Error);
+    void abandon(Attempt&);
+    void finish(ErrorOr<NonnullOwnPtr<Core::Stream::TCPSocket>>);
+
+    DeprecatedString m_host;
+    u16 m_port { 0 };
+    Vector<IPv4Address> m_addresses;
+    size_t m_next_address_index { 0 };
+    Vector<NonnullOwnPtr<Attempt>> m_attempts;
+    RefPtr<Core::Timer> m_attempt_delay_timer;
+    bool m_finished { false };
+};
+
+}
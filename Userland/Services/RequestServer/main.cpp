@@ -5,6 +5,7 @@
  */
 
 #include <AK/OwnPtr.h>
+#include <LibCore/Directory.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/LocalServer.h>
 #include <LibCore/System.h>
@@ -13,25 +14,20 @@
 #include <LibTLS/Certificate.h>
 #include <RequestServer/ConnectionFromClient.h>
 #include <RequestServer/GeminiProtocol.h>
+#include <RequestServer/HttpCache.h>
 #include <RequestServer/HttpProtocol.h>
 #include <RequestServer/HttpsProtocol.h>
 #include <signal.h>
 
 ErrorOr<int> serenity_main(Main::Arguments)
 {
-    if constexpr (TLS_SSL_KEYLOG_DEBUG)
-        TRY(Core::System::pledge("stdio inet accept unix cpath wpath rpath sendfd recvfd sigaction"));
-    else
-        TRY(Core::System::pledge("stdio inet accept unix rpath sendfd recvfd sigaction"));
+    TRY(Core::System::pledge("stdio inet accept unix cpath wpath rpath fattr sendfd recvfd sigaction"));
 
 #ifdef SIGINFO
     signal(SIGINFO, [](int) { RequestServer::ConnectionCache::dump_jobs(); });
 #endif
 
-    if constexpr (TLS_SSL_KEYLOG_DEBUG)
-        TRY(Core::System::pledge("stdio inet accept unix cpath wpath rpath sendfd recvfd"));
-    else
-        TRY(Core::System::pledge("stdio inet accept unix rpath sendfd recvfd"));
+    TRY(Core::System::pledge("stdio inet accept unix cpath wpath rpath fattr sendfd recvfd"));
 
     // Ensure the certificates are read out here.
     [[maybe_unused]] auto& certs = DefaultRootCACertificates::the();
@@ -42,6 +38,12 @@ ErrorOr<int> serenity_main(Main::Arguments)
     TRY(Core::System::unveil("/etc/timezone", "r"));
     if constexpr (TLS_SSL_KEYLOG_DEBUG)
         TRY(Core::System::unveil("/home/anon", "rwc"));
+
+    // Note: Without its directory, the HTTP cache simply fails to store anything.
+    auto http_cache_directory = RequestServer::HttpCache::directory();
+    if (auto result = Core::Directory::create(http_cache_directory, Core::Directory::CreateDirectories::Yes); result.is_error())
+        warnln("Failed to create the HTTP cache directory {}: {}", http_cache_directory, result.error());
+    TRY(Core::System::unveil(http_cache_directory, "rwc"sv));
     TRY(Core::System::unveil(nullptr, nullptr));
 
     [[maybe_unused]] auto gemini = make<RequestServer::GeminiProtocol>();
@@ -15,6 +15,11 @@ namespace SQLServer {
 static HashMap<SQL::StatementID, NonnullRefPtr<SQLStatement>> s_statements;
 static SQL::StatementID s_next_statement_id = 0;
 
+// Clients tend to prepare the same few statements over and over, so their parsed ASTs are kept around. An AST is
+// never modified by executing it, which lets any number of statements share it.
+static HashMap<DeprecatedString, NonnullRefPtr<SQL::AST::Statement>> s_parsed_statements;
+static constexpr size_t max_parsed_statements = 64;
+
 RefPtr<SQLStatement> SQLStatement::statement_for(SQL::StatementID statement_id)
 {
     if (s_statements.contains(statement_id))
@@ -25,12 +30,20 @@ RefPtr<SQLStatement> SQLStatement::statement_for(SQL::StatementID statement_id)
 
 SQL::ResultOr<NonnullRefPtr<SQLStatement>> SQLStatement::create(DatabaseConnection& connection, StringView sql)
 {
+    if (auto it = s_parsed_statements.find(sql); it != s_parsed_statements.end())
+        return TRY(adopt_nonnull_ref_or_enomem(new (nothrow) SQLStatement(connection, it->value)));
+
     auto parser = SQL::AST::Parser(SQL::AST::Lexer(sql));
     auto statement = parser.next_statement();
 
     if (parser.has_errors())
         return SQL::Result { SQL::SQLCommand::Unknown, SQL::SQLErrorCode::SyntaxError, parser.errors()[0].to_deprecated_string() };
 
+    // Rather than keeping track of which statement was used last, an arbitrary one makes room.
+    if (s_parsed_statements.size() >= max_parsed_statements)
+        s_parsed_statements.remove(s_parsed_statements.begin()->key);
+    s_parsed_statements.set(sql, statement);
+
     return TRY(adopt_nonnull_ref_or_enomem(new (nothrow) SQLStatement(connection, move(statement))));
 }
 
@@ -91,8 +104,7 @@ Optional<SQL::ExecutionID> SQLStatement::execute(Vector<SQL::Value> placeholder_
         if (should_send_result_rows(result)) {
             client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), true, 0, 0, 0);
 
-            auto result_size = result.size();
-            next(execution_id, move(result), result_size);
+            next(execution_id, move(result), 0);
         } else {
             if (result.command() == SQL::SQLCommand::Insert)
                 client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), false, result.size(), 0, 0);
@@ -122,7 +134,7 @@ bool SQLStatement::should_send_result_rows(SQL::ResultSet const& result) const
     }
 }
 
-void SQLStatement::next(SQL::ExecutionID execution_id, SQL::ResultSet result, size_t result_size)
+void SQLStatement::next(SQL::ExecutionID execution_id, SQL::ResultSet result, size_t rows_sent)
 {
     auto client_connection = ConnectionFromClient::client_connection_for(connection()->client_id());
     if (!client_connection) {
@@ -130,15 +142,21 @@ void SQLStatement::next(SQL::ExecutionID execution_id, SQL::ResultSet result, si
         return;
     }
 
-    if (!result.is_empty()) {
-        auto result_row = result.take_first();
-        client_connection->async_next_result(statement_id(), execution_id, result_row.row.take_data());
+    if (rows_sent < result.size()) {
+        auto batch_size = min(result.size() - rows_sent, result_batch_size);
+
+        Vector<Vector<SQL::Value>> rows;
+        rows.ensure_capacity(batch_size);
+        for (size_t i = 0; i < batch_size; ++i)
+            rows.unchecked_append(result[rows_sent + i].row.take_data());
+        client_connection->async_next_results(statement_id(), execution_id, move(rows));
 
-        deferred_invoke([this, execution_id, result = move(result), result_size]() mutable {
-            next(execution_id, move(result), result_size);
+        // The rest is sent on a later turn of the event loop, so that other clients aren't kept waiting behind a large result.
+        deferred_invoke([this, execution_id, result = move(result), rows_sent = rows_sent + batch_size]() mutable {
+            next(execution_id, move(result), rows_sent);
         });
     } else {
-        client_connection->async_results_exhausted(statement_id(), execution_id, result_size);
+        client_connection->async_results_exhausted(statement_id(), execution_id, result.size());
     }
 }
 
@@ -34,8 +34,11 @@ public:
 private:
     SQLStatement(DatabaseConnection&, NonnullRefPtr<SQL::AST::Statement> statement);
 
+    // The number of rows that are sent to the client in a single message.
+    static constexpr size_t result_batch_size = 64;
+
     bool should_send_result_rows(SQL::ResultSet const& result) const;
-    void next(SQL::ExecutionID execution_id, SQL::ResultSet result, size_t result_size);
+    void next(SQL::ExecutionID execution_id, SQL::ResultSet result, size_t rows_sent);
     void report_error(SQL::Result, SQL::ExecutionID execution_id);
 
     SQL::StatementID m_statement_id { 0 };
@@ -110,14 +110,47 @@ ErrorOr<void> Service::handle_socket_connection()
     return {};
 }
 
+ErrorOr<void> Service::start_up(bool spawn_eagerly)
+{
+    VERIFY(m_startup_state == StartupState::Waiting);
+
+    m_startup_began_at = Time::now_monotonic();
+    m_startup_state = StartupState::Starting;
+    m_spawn_eagerly = spawn_eagerly && m_lazy && !m_accept_socket_connections;
+    if (auto result = activate(); result.is_error()) {
+        fail_startup();
+        return result.release_error();
+    }
+
+    if (!is_one_shot())
+        did_start_up();
+    return {};
+}
+
+void Service::did_start_up()
+{
+    m_started_at = Time::now_monotonic();
+    m_startup_state = StartupState::Started;
+}
+
+void Service::fail_startup()
+{
+    if (m_startup_state == StartupState::Waiting)
+        m_startup_began_at = Time::now_monotonic();
+    m_started_at = Time::now_monotonic();
+    m_startup_state = StartupState::Failed;
+}
+
 ErrorOr<void> Service::activate()
 {
     VERIFY(m_pid < 0);
 
-    if (m_lazy)
+    // Note: Only the first activation of a lazy service can be eager, it goes back to waiting for a connection after
+    //       it exits.
+    if (m_lazy && !exchange(m_spawn_eagerly, false))
         setup_notifier();
     else
-        TRY(spawn());
+        TRY(spawn(m_lazy ? m_sockets[0].fd : -1));
     return {};
 }
 
@@ -239,6 +272,13 @@ ErrorOr<void> Service::did_exit(int exit_code)
     s_service_map.remove(m_pid);
     m_pid = -1;
 
+    if (m_startup_state == StartupState::Starting) {
+        if (exit_code == 0)
+            did_start_up();
+        else
+            fail_startup();
+    }
+
     if (!m_keep_alive)
         return {};
 
@@ -302,6 +342,19 @@ Service::Service(Core::ConfigFile const& config, StringView name)
     m_multi_instance = config.read_bool_entry(name, "MultiInstance");
     m_accept_socket_connections = config.read_bool_entry(name, "AcceptSocketConnections");
 
+    auto read_service_list = [&](DeprecatedString const& key) {
+        Vector<DeprecatedString> services;
+        for (auto& service : config.read_entry(name, key).split(','))
+            services.append(service.trim_whitespace());
+        return services;
+    };
+    m_required_services = read_service_list("Requires");
+    m_services_to_start_after = m_required_services;
+    for (auto& service : read_service_list("After")) {
+        if (!m_services_to_start_after.contains_slow(service))
+            m_services_to_start_after.append(move(service));
+    }
+
     DeprecatedString socket_entry = config.read_entry(name, "Socket");
     DeprecatedString socket_permissions_entry = config.read_entry(name, "SocketPermissions", "0600");
 
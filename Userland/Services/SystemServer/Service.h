@@ -8,6 +8,7 @@
 
 #include <AK/DeprecatedString.h>
 #include <AK/RefPtr.h>
+#include <AK/Time.h>
 #include <LibCore/Account.h>
 #include <LibCore/ElapsedTimer.h>
 #include <LibCore/Notifier.h>
@@ -20,7 +21,33 @@ public:
     static ErrorOr<NonnullRefPtr<Service>> try_create(Core::ConfigFile const& config, StringView name);
     ~Service();
 
+    enum class StartupState {
+        // Waiting for the services it comes after to start up.
+        Waiting,
+        // Running, but not considered started until it exits, see is_one_shot().
+        Starting,
+        Started,
+        Failed,
+    };
+
     bool is_enabled() const;
+    bool is_lazy() const { return m_lazy; }
+    // Services that neither stay alive nor have sockets are expected to do their job and exit, and are only started
+    // once they did.
+    bool is_one_shot() const { return !m_keep_alive && !m_lazy && m_sockets.is_empty(); }
+
+    Vector<DeprecatedString> const& required_services() const { return m_required_services; }
+    // Includes the required services.
+    Vector<DeprecatedString> const& services_to_start_after() const { return m_services_to_start_after; }
+
+    StartupState startup_state() const { return m_startup_state; }
+    Time startup_began_at() const { return m_startup_began_at; }
+    Time started_at() const { return m_started_at; }
+    // Activates the service for the first time. A lazy service that is needed anyway is spawned right away, unless it
+    // accepts socket connections.
+    ErrorOr<void> start_up(bool spawn_eagerly);
+    void fail_startup();
+
     ErrorOr<void> activate();
     ErrorOr<void> did_exit(int exit_code);
 
@@ -33,6 +60,7 @@ private:
     Service(Core::ConfigFile const&, StringView name);
 
     ErrorOr<void> spawn(int socket_fd = -1);
+    void did_start_up();
 
     ErrorOr<void> determine_account(int fd);
 
@@ -74,6 +102,15 @@ private:
     DeprecatedString m_environment;
     // Socket descriptors for this service.
     Vector<SocketDescriptor> m_sockets;
+    // Services that have to be enabled and started before this one.
+    Vector<DeprecatedString> m_required_services;
+    // Services that have to be started before this one if they're enabled, including the required ones.
+    Vector<DeprecatedString> m_services_to_start_after;
+
+    StartupState m_startup_state { StartupState::Waiting };
+    Time m_startup_began_at;
+    Time m_started_at;
+    bool m_spawn_eagerly { false };
 
     // The resolved user account to run this service as.
     Optional<Core::Account> m_account;
@@ -6,10 +6,13 @@
  */
 
 #include "Service.h"
+#include <AK/AnyOf.h>
 #include <AK/Assertions.h>
 #include <AK/ByteBuffer.h>
 #include <AK/Debug.h>
+#include <AK/QuickSort.h>
 #include <AK/String.h>
+#include <AK/StringBuilder.h>
 #include <Kernel/API/DeviceEvent.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/ConfigFile.h>
@@ -33,6 +36,11 @@
 DeprecatedString g_system_mode = "graphical";
 NonnullRefPtrVector<Service> g_services;
 
+static Time s_startup_began_at;
+static bool s_has_reported_startup { false };
+
+static void start_services();
+
 // NOTE: This handler ensures that the destructor of g_services is called.
 static void sigterm_handler(int)
 {
@@ -62,6 +70,157 @@ static void sigchld_handler(int)
         if (auto result = service->did_exit(status); result.is_error())
             dbgln("{}: {}", service->name(), result.release_error());
     }
+
+    // One-shot services are only started once they exit, which may let others start.
+    if (!s_has_reported_startup)
+        start_services();
+}
+
+static Service* find_service(StringView name)
+{
+    for (auto& service : g_services) {
+        if (service.name() == name)
+            return &service;
+    }
+    return nullptr;
+}
+
+static i64 milliseconds_since_startup_began(Time time)
+{
+    return (time - s_startup_began_at).to_milliseconds();
+}
+
+// Logs when every service began and finished starting up, drawn as a waterfall, followed by the chain of services that
+// the last one to start up had to wait for.
+static void report_startup()
+{
+    static constexpr i64 waterfall_width = 50;
+
+    Vector<Service*> services;
+    for (auto& service : g_services)
+        services.append(&service);
+    quick_sort(services, [](auto* a, auto* b) { return a->startup_began_at() < b->startup_began_at(); });
+
+    Service* last_started_service = nullptr;
+    for (auto* service : services) {
+        if (service->startup_state() == Service::StartupState::Started && (!last_started_service || service->started_at() > last_started_service->started_at()))
+            last_started_service = service;
+    }
+    auto total_milliseconds = last_started_service ? milliseconds_since_startup_began(last_started_service->started_at()) : 0;
+
+    dbgln("Started up services in {}ms:", total_milliseconds);
+    for (auto* service : services) {
+        auto began = milliseconds_since_startup_began(service->startup_began_at());
+        auto finished = milliseconds_since_startup_began(service->started_at());
+        auto offset = total_milliseconds > 0 ? began * waterfall_width / total_milliseconds : 0;
+        auto length = total_milliseconds > 0 ? max(finished * waterfall_width / total_milliseconds - offset, 1) : 1;
+        StringBuilder bar;
+        bar.append_repeated(' ', min(offset, waterfall_width));
+        bar.append_repeated('#', min(length, waterfall_width + 1 - min(offset, waterfall_width)));
+        dbgln("  {:>6}ms {:>6}ms |{:<51}| {}{}", began, finished, bar.string_view(), service->name(),
+            service->startup_state() == Service::StartupState::Failed ? " (failed)"sv : ""sv);
+    }
+
+    if (!last_started_service)
+        return;
+    StringBuilder critical_path;
+    for (auto* service = last_started_service; service;) {
+        if (service != last_started_service)
+            critical_path.append(" <- "sv);
+        critical_path.appendff("{} ({}ms)", service->name(), (service->started_at() - service->startup_began_at()).to_milliseconds());
+
+        Service* last_dependency = nullptr;
+        for (auto& name : service->services_to_start_after()) {
+            auto* dependency = find_service(name);
+            if (dependency && dependency->startup_state() == Service::StartupState::Started && (!last_dependency || dependency->started_at() > last_dependency->started_at()))
+                last_dependency = dependency;
+        }
+        service = last_dependency;
+    }
+    dbgln("Critical path: {}", critical_path.string_view());
+}
+
+enum class DependencyState {
+    Waiting,
+    Started,
+    Failed,
+};
+
+static DependencyState dependency_state(Service const& service)
+{
+    auto state = DependencyState::Started;
+    for (auto& name : service.services_to_start_after()) {
+        bool is_required = service.required_services().contains_slow(name);
+        auto* dependency = find_service(name);
+        if (!dependency) {
+            if (is_required) {
+                dbgln("{}: Requires {}, which isn't enabled", service.name(), name);
+                return DependencyState::Failed;
+            }
+            continue;
+        }
+        switch (dependency->startup_state()) {
+        case Service::StartupState::Failed:
+            if (is_required) {
+                dbgln("{}: Requires {}, which failed to start", service.name(), name);
+                return DependencyState::Failed;
+            }
+            break;
+        case Service::StartupState::Started:
+            break;
+        default:
+            state = DependencyState::Waiting;
+            break;
+        }
+    }
+    return state;
+}
+
+// Starts every service that doesn't have to wait for another one anymore, so that services which don't depend on each
+// other are all started right away.
+static void start_services()
+{
+    bool made_progress = true;
+    while (made_progress) {
+        made_progress = false;
+        for (auto& service : g_services) {
+            if (service.startup_state() != Service::StartupState::Waiting)
+                continue;
+
+            switch (dependency_state(service)) {
+            case DependencyState::Waiting:
+                continue;
+            case DependencyState::Failed:
+                service.fail_startup();
+                break;
+            case DependencyState::Started: {
+                // A lazy service is going to get a connection as soon as one of the services that require it starts
+                // up, so it's spawned right away instead.
+                bool is_needed = any_of(g_services, [&](auto& other) {
+                    return !other.is_lazy() && other.required_services().contains_slow(service.name());
+                });
+                if (auto result = service.start_up(is_needed); result.is_error())
+                    dbgln("{}: {}", service.name(), result.release_error());
+                break;
+            }
+            }
+            made_progress = true;
+        }
+    }
+
+    if (any_of(g_services, [](auto& service) { return service.startup_state() == Service::StartupState::Starting; }))
+        return;
+
+    // Nothing is left to wait for, so whatever is still waiting depends on itself.
+    for (auto& service : g_services) {
+        if (service.startup_state() == Service::StartupState::Waiting) {
+            dbgln("{}: Has a dependency cycle, not starting it", service.name());
+            service.fail_startup();
+        }
+    }
+
+    s_has_reported_startup = true;
+    report_startup();
 }
 
 static ErrorOr<void> determine_system_mode()
@@ -543,10 +702,8 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     // After we've set them all up, activate them!
     dbgln("Activating {} services...", g_services.size());
-    for (auto& service : g_services) {
-        if (auto result = service.activate(); result.is_error())
-            dbgln("{}: {}", service.name(), result.release_error());
-    }
+    s_startup_began_at = Time::now_monotonic();
+    start_services();
 
     return event_loop.exec();
 }
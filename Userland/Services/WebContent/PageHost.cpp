@@ -36,6 +36,7 @@ PageHost::~PageHost() = default;
 void PageHost::set_has_focus(bool has_focus)
 {
     m_has_focus = has_focus;
+    m_previous_frame = {};
 }
 
 void PageHost::setup_palette()
@@ -63,6 +64,7 @@ Gfx::Palette PageHost::palette() const
 void PageHost::set_palette_impl(Gfx::PaletteImpl const& impl)
 {
     m_palette_impl = impl;
+    m_previous_frame = {};
     if (auto* document = page().top_level_browsing_context().active_document())
         document->invalidate_style();
 }
@@ -70,6 +72,7 @@ void PageHost::set_palette_impl(Gfx::PaletteImpl const& impl)
 void PageHost::set_preferred_color_scheme(Web::CSS::PreferredColorScheme color_scheme)
 {
     m_preferred_color_scheme = color_scheme;
+    m_previous_frame = {};
     if (auto* document = page().top_level_browsing_context().active_document())
         document->invalidate_style();
 }
@@ -104,6 +107,41 @@ Web::Layout::InitialContainingBlock* PageHost::layout_root()
     return document->layout_node();
 }
 
+// Content that stays in place while the page scrolls underneath it.
+static bool has_content_fixed_to_viewport(Web::Layout::InitialContainingBlock const& layout_root)
+{
+    bool found = false;
+    layout_root.for_each_in_inclusive_subtree([&](Web::Layout::Node const& node) {
+        if (!node.has_style())
+            return IterationDecision::Continue;
+        if (node.is_fixed_position())
+            found = true;
+        for (auto const& layer : node.computed_values().background_layers()) {
+            if (layer.attachment == Web::CSS::BackgroundAttachment::Fixed)
+                found = true;
+        }
+        return found ? IterationDecision::Break : IterationDecision::Continue;
+    });
+    return found;
+}
+
+Vector<Gfx::IntRect, 4> PageHost::reuse_previous_frame(Web::Layout::InitialContainingBlock const& layout_root, Gfx::IntRect const& content_rect, Gfx::Painter& painter, Gfx::Bitmap const& target)
+{
+    auto const& previous_bitmap = m_previous_frame.bitmap;
+    if (!previous_bitmap || previous_bitmap.ptr() == &target || previous_bitmap->size() != target.size())
+        return { content_rect };
+
+    auto previous_content_rect = m_previous_frame.content_rect;
+    if (previous_content_rect.size() != content_rect.size())
+        return { content_rect };
+    auto reused_rect = content_rect.intersected(previous_content_rect);
+    if (reused_rect.is_empty() || has_content_fixed_to_viewport(layout_root))
+        return { content_rect };
+
+    painter.blit(reused_rect.location() - content_rect.location(), *previous_bitmap, reused_rect.translated(-previous_content_rect.location()));
+    return content_rect.shatter(reused_rect);
+}
+
 void PageHost::paint(Web::DevicePixelRect const& content_rect, Gfx::Bitmap& target)
 {
     Gfx::Painter painter(target);
@@ -115,6 +153,7 @@ void PageHost::paint(Web::DevicePixelRect const& content_rect, Gfx::Bitmap& targ
     auto* layout_root = this->layout_root();
     if (!layout_root) {
         painter.fill_rect(bitmap_rect, palette().base());
+        m_previous_frame = {};
         return;
     }
 
@@ -122,7 +161,17 @@ void PageHost::paint(Web::DevicePixelRect const& content_rect, Gfx::Bitmap& targ
     context.set_should_show_line_box_borders(m_should_show_line_box_borders);
     context.set_device_viewport_rect(content_rect);
     context.set_has_focus(m_has_focus);
-    layout_root->paint_all_phases(context);
+
+    // NOTE: If the page has only been scrolled since the last frame, the part of that frame that's still in view is copied,
+    //       and only what scrolled into view is painted.
+    auto device_content_rect = content_rect.to_type<int>();
+    for (auto const& rect : reuse_previous_frame(*layout_root, device_content_rect, painter, target)) {
+        Gfx::PainterStateSaver saver(painter);
+        painter.add_clip_rect(rect.translated(-device_content_rect.location()));
+        layout_root->paint_all_phases(context);
+    }
+
+    m_previous_frame = { target, device_content_rect };
 }
 
 void PageHost::set_viewport_rect(Web::DevicePixelRect const& rect)
@@ -132,6 +181,7 @@ void PageHost::set_viewport_rect(Web::DevicePixelRect const& rect)
 
 void PageHost::page_did_invalidate(Web::CSSPixelRect const& content_rect)
 {
+    m_previous_frame = {};
     m_invalidation_rect = m_invalidation_rect.united(page().enclosing_device_rect(content_rect));
     if (!m_invalidation_coalescing_timer->is_active())
         m_invalidation_coalescing_timer->start();
@@ -139,6 +189,7 @@ void PageHost::page_did_invalidate(Web::CSSPixelRect const& content_rect)
 
 void PageHost::page_did_change_selection()
 {
+    m_previous_frame = {};
     m_client.async_did_change_selection();
 }
 
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <LibGfx/Forward.h>
 #include <LibGfx/Rect.h>
 #include <LibWeb/Page/Page.h>
 #include <LibWeb/PixelUnits.h>
@@ -32,9 +33,17 @@ public:
     void set_palette_impl(Gfx::PaletteImpl const&);
     void set_viewport_rect(Web::DevicePixelRect const&);
     void set_screen_rects(Vector<Gfx::IntRect, 4> const& rects, size_t main_screen_index) { m_screen_rect = rects[main_screen_index].to_type<Web::DevicePixels>(); }
-    void set_device_pixels_per_css_pixel(float device_pixels_per_css_pixel) { m_device_pixels_per_css_pixel = device_pixels_per_css_pixel; }
+    void set_device_pixels_per_css_pixel(float device_pixels_per_css_pixel)
+    {
+        m_device_pixels_per_css_pixel = device_pixels_per_css_pixel;
+        m_previous_frame = {};
+    }
     void set_preferred_color_scheme(Web::CSS::PreferredColorScheme);
-    void set_should_show_line_box_borders(bool b) { m_should_show_line_box_borders = b; }
+    void set_should_show_line_box_borders(bool b)
+    {
+        m_should_show_line_box_borders = b;
+        m_previous_frame = {};
+    }
     void set_has_focus(bool);
     void set_is_scripting_enabled(bool);
     void set_window_position(Web::DevicePixelPoint);
@@ -103,6 +112,8 @@ private:
 
     Web::Layout::InitialContainingBlock* layout_root();
     void setup_palette();
+    // Copies what can be kept of the previous frame into the target, and returns the parts of the content rect that still need painting.
+    Vector<Gfx::IntRect, 4> reuse_previous_frame(Web::Layout::InitialContainingBlock const&, Gfx::IntRect const& content_rect, Gfx::Painter&, Gfx::Bitmap const& target);
 
     ConnectionFromClient& m_client;
     NonnullOwnPtr<Web::Page> m_page;
@@ -113,6 +124,13 @@ private:
     bool m_should_show_line_box_borders { false };
     bool m_has_focus { false };
 
+    // The last frame that was painted, for as long as nothing but the scroll position has changed since.
+    struct PaintedFrame {
+        RefPtr<Gfx::Bitmap> bitmap;
+        Gfx::IntRect content_rect;
+    };
+    PaintedFrame m_previous_frame;
+
     RefPtr<Web::Platform::Timer> m_invalidation_coalescing_timer;
     Web::DevicePixelRect m_invalidation_rect;
     Web::CSS::PreferredColorScheme m_preferred_color_scheme { Web::CSS::PreferredColorScheme::Auto };
@@ -8,16 +8,20 @@
 
 #include <AK/Base64.h>
 #include <AK/Debug.h>
+#include <AK/HashMap.h>
+#include <AK/InsertionSort.h>
 #include <AK/LexicalPath.h>
-#include <AK/MemoryStream.h>
 #include <AK/QuickSort.h>
 #include <AK/StringBuilder.h>
 #include <AK/URL.h>
+#include <LibCompress/Brotli.h>
+#include <LibCompress/Gzip.h>
+#include <LibCompress/Zstd.h>
 #include <LibCore/DateTime.h>
 #include <LibCore/DirIterator.h>
-#include <LibCore/File.h>
 #include <LibCore/MappedFile.h>
 #include <LibCore/MimeData.h>
+#include <LibCore/System.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 #include <WebServer/Client.h>
@@ -28,72 +32,193 @@
 
 namespace WebServer {
 
-Client::Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket> socket, Core::Object* parent)
-    : Core::Object(parent)
-    , m_socket(move(socket))
+// Each thread keeps the clients that it serves alive until they die.
+static thread_local HashMap<Client*, NonnullRefPtr<Client>> s_clients;
+
+// How long a kept-alive connection may sit around without another request before we close it.
+static constexpr int keep_alive_timeout_ms = 15'000;
+// Clients that send more than this without finishing a request are cut off.
+static constexpr size_t maximum_request_size = 64 * KiB;
+
+Client::Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket> socket)
+    : m_socket(move(socket))
 {
 }
 
 void Client::die()
 {
     m_socket->close();
-    deferred_invoke([this] { remove_from_parent(); });
+    if (m_idle_timer)
+        m_idle_timer->stop();
+    deferred_invoke([this] { s_clients.remove(this); });
 }
 
 void Client::start()
 {
-    m_socket->on_ready_to_read = [this] {
-        StringBuilder builder;
+    s_clients.set(this, *this);
+
+    auto maybe_idle_timer = Core::Timer::create_single_shot(keep_alive_timeout_ms, [this] { die(); }, this);
+    if (maybe_idle_timer.is_error()) {
+        warnln("Could not create the idle timer for client: {}", maybe_idle_timer.error());
+        die();
+        return;
+    }
+    m_idle_timer = maybe_idle_timer.release_value();
 
-        auto maybe_buffer = ByteBuffer::create_uninitialized(m_socket->buffer_size());
-        if (maybe_buffer.is_error()) {
-            warnln("Could not create buffer for client: {}", maybe_buffer.error());
+    m_socket->on_ready_to_read = [this] {
+        if (auto result = read_requests(); result.is_error()) {
+            warnln("Failed to read the request: {}", result.error());
             die();
-            return;
         }
+    };
+}
 
-        auto buffer = maybe_buffer.release_value();
-        for (;;) {
-            auto maybe_can_read = m_socket->can_read_without_blocking();
-            if (maybe_can_read.is_error()) {
-                warnln("Failed to get the blocking status for the socket: {}", maybe_can_read.error());
-                die();
-                return;
-            }
-
-            if (!maybe_can_read.value())
-                break;
-
-            auto maybe_bytes_read = m_socket->read_until_any_of(buffer, Array { "\r"sv, "\n"sv, "\r\n"sv });
-            if (maybe_bytes_read.is_error()) {
-                warnln("Failed to read a line from the request: {}", maybe_bytes_read.error());
-                die();
-                return;
-            }
-
-            if (m_socket->is_eof()) {
-                die();
-                break;
-            }
+ErrorOr<void> Client::read_requests()
+{
+    m_idle_timer->stop();
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(m_socket->buffer_size()));
+    auto client_has_finished_sending = false;
+    while (TRY(m_socket->can_read_without_blocking())) {
+        auto bytes_read = TRY(m_socket->read(buffer));
+        if (m_socket->is_eof()) {
+            client_has_finished_sending = true;
+            break;
+        }
+        TRY(m_pending_request_data.try_append(bytes_read));
+    }
 
-            builder.append(StringView { maybe_bytes_read.value() });
-            builder.append("\r\n"sv);
+    // A client may send several requests without waiting for the responses, so handle everything that has arrived in full.
+    for (;;) {
+        auto end_of_header = StringView { m_pending_request_data }.find("\r\n\r\n"sv);
+        if (!end_of_header.has_value()) {
+            if (m_pending_request_data.size() > maximum_request_size)
+                return Error::from_string_literal("Request is too large");
+            break;
         }
 
-        auto request = builder.to_byte_buffer();
-        dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", DeprecatedString::copy(request));
+        auto request_size = *end_of_header + 4;
+        auto request = TRY(ByteBuffer::copy(m_pending_request_data.bytes().trim(request_size)));
+        m_pending_request_data = TRY(ByteBuffer::copy(m_pending_request_data.bytes().slice(request_size)));
+        dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", StringView { request });
 
         auto maybe_did_handle = handle_request(request);
         if (maybe_did_handle.is_error()) {
             warnln("Failed to handle the request: {}", maybe_did_handle.error());
+            die();
+            return {};
         }
+        if (!m_keep_alive) {
+            die();
+            return {};
+        }
+    }
 
+    if (client_has_finished_sending) {
         die();
-    };
+        return {};
+    }
+    m_idle_timer->start();
+    return {};
+}
+
+struct ContentEncoding {
+    StringView name;
+    StringView file_extension;
+    ErrorOr<ByteBuffer> (*compress_all)(ReadonlyBytes);
+};
+
+// In the order that we prefer them in, if the client accepts several equally.
+static Array<ContentEncoding, 3> const s_content_encodings {
+    ContentEncoding { "br"sv, "br"sv, [](ReadonlyBytes bytes) { return Compress::BrotliCompressionStream::compress_all(bytes); } },
+    ContentEncoding { "zstd"sv, "zst"sv, [](ReadonlyBytes bytes) { return Compress::ZstdCompressor::compress_all(bytes); } },
+    ContentEncoding { "gzip"sv, "gz"sv, [](ReadonlyBytes bytes) { return Compress::GzipCompressor::compress_all(bytes); } },
+};
+
+// Files that are smaller than this aren't worth compressing, and larger ones would take too long to compress on the fly.
+static constexpr size_t minimum_compressible_size = 1 * KiB;
+static constexpr size_t maximum_compressible_size = 16 * MiB;
+
+static bool is_compressible_mime_type(StringView mime_type)
+{
+    return mime_type.starts_with("text/"sv)
+        || mime_type.is_one_of("application/javascript"sv, "application/json"sv, "application/xml"sv, "image/svg+xml"sv);
+}
+
+// Returns the content codings that the client accepts, with the ones it prefers first. See RFC 9110 section 12.5.3.
+static Vector<ContentEncoding const*, 3> acceptable_content_encodings(HTTP::HttpRequest const& request)
+{
+    auto header = request.headers().find_if([](auto& header) { return header.name.equals_ignoring_case("Accept-Encoding"sv); });
+    if (header.is_end())
+        return {};
+
+    Array<float, s_content_encodings.size()> qualities {};
+    Optional<float> wildcard_quality;
+    Array<bool, s_content_encodings.size()> is_listed {};
+    for (auto coding : header->value.view().split_view(',')) {
+        auto parameters = coding.split_view(';');
+        if (parameters.is_empty())
+            continue;
+        auto name = parameters[0].trim_whitespace();
+
+        float quality = 1;
+        for (size_t i = 1; i < parameters.size(); ++i) {
+            auto parameter = parameters[i].trim_whitespace();
+            if (parameter.starts_with("q="sv, CaseSensitivity::CaseInsensitive))
+                quality = parameter.substring_view(2).to_float().value_or(0);
+        }
+
+        if (name == "*"sv) {
+            wildcard_quality = quality;
+            continue;
+        }
+        for (size_t i = 0; i < s_content_encodings.size(); ++i) {
+            if (name.equals_ignoring_case(s_content_encodings[i].name)) {
+                qualities[i] = quality;
+                is_listed[i] = true;
+            }
+        }
+    }
+
+    Vector<ContentEncoding const*, 3> encodings;
+    for (size_t i = 0; i < s_content_encodings.size(); ++i) {
+        if (!is_listed[i])
+            qualities[i] = wildcard_quality.value_or(0);
+        if (qualities[i] > 0)
+            encodings.append(&s_content_encodings[i]);
+    }
+    // Note: This is a stable sort, so equally preferred codings stay in our own order.
+    insertion_sort(encodings, [&](auto* a, auto* b) {
+        return qualities[a - s_content_encodings.data()] > qualities[b - s_content_encodings.data()];
+    });
+    return encodings;
+}
+
+// HTTP/1.1 connections persist unless the client says otherwise, HTTP/1.0 ones only if it asks for it. See RFC 9112 section 9.3.
+static bool should_keep_connection_alive(ReadonlyBytes raw_request, HTTP::HttpRequest const& request)
+{
+    auto request_line = StringView { raw_request };
+    if (auto end_of_line = request_line.find("\r\n"sv); end_of_line.has_value())
+        request_line = request_line.substring_view(0, *end_of_line);
+    auto keep_alive = !request_line.ends_with(" HTTP/1.0"sv);
+
+    for (auto& header : request.headers()) {
+        if (!header.name.equals_ignoring_case("Connection"sv))
+            continue;
+        for (auto option : header.value.view().split_view(',')) {
+            option = option.trim_whitespace();
+            if (option.equals_ignoring_case("close"sv))
+                return false;
+            if (option.equals_ignoring_case("keep-alive"sv))
+                keep_alive = true;
+        }
+    }
+    return keep_alive;
 }
 
 ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
 {
+    m_keep_alive = false;
     auto request_or_error = HTTP::HttpRequest::from_raw_request(raw_request);
     if (!request_or_error.has_value())
         return false;
@@ -108,9 +233,11 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
     }
 
     if (request.method() != HTTP::HttpRequest::Method::GET) {
+        // Note: We don't know where the body of such a request would end, so the connection can't be used for another one.
         TRY(send_error_response(501, request));
         return false;
     }
+    m_keep_alive = should_keep_connection_alive(raw_request, request);
 
     // Check for credentials if they are required
     if (Configuration::the().credentials().has_value()) {
@@ -132,7 +259,14 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
     path_builder.append(requested_path);
     auto real_path = TRY(path_builder.to_string());
 
-    if (Core::File::is_directory(real_path.bytes_as_string_view())) {
+    auto maybe_stat = Core::System::stat(real_path);
+    if (maybe_stat.is_error()) {
+        TRY(send_error_response(404, request));
+        return false;
+    }
+    auto st = maybe_stat.release_value();
+
+    if (S_ISDIR(st.st_mode)) {
         if (!resource_decoded.ends_with('/')) {
             StringBuilder red;
 
@@ -147,38 +281,56 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
         index_html_path_builder.append(real_path);
         index_html_path_builder.append("/index.html"sv);
         auto index_html_path = TRY(index_html_path_builder.to_string());
-        if (!Core::File::exists(index_html_path)) {
-            TRY(handle_directory_listing(requested_path, real_path, request));
+        auto maybe_index_html_stat = Core::System::stat(index_html_path);
+        if (maybe_index_html_stat.is_error()) {
+            TRY(handle_directory_listing(requested_path, real_path, st, request));
             return true;
         }
         real_path = index_html_path;
+        st = maybe_index_html_stat.release_value();
     }
 
-    auto file = Core::File::construct(real_path.bytes_as_string_view());
-    if (!file->open(Core::OpenMode::ReadOnly)) {
-        TRY(send_error_response(404, request));
+    // Devices, pipes and the like aren't files that can be served.
+    if (!S_ISREG(st.st_mode)) {
+        TRY(send_error_response(403, request));
         return false;
     }
 
-    if (file->is_device()) {
-        TRY(send_error_response(403, request));
-        return false;
+    auto mime_type = TRY(String::from_deprecated_string(Core::guess_mime_type_based_on_filename(real_path.bytes_as_string_view())));
+    auto encodings = acceptable_content_encodings(request);
+
+    // Serve a compressed copy that sits next to the file, if there is one.
+    for (auto const* encoding : encodings) {
+        auto encoded_path = TRY(String::formatted("{}.{}", real_path, encoding->file_extension));
+        auto maybe_encoded_stat = Core::System::stat(encoded_path);
+        if (maybe_encoded_stat.is_error() || !S_ISREG(maybe_encoded_stat.value().st_mode))
+            continue;
+
+        TRY(send_file(encoded_path, maybe_encoded_stat.value(), request, { .type = move(mime_type), .encoding = encoding->name }));
+        return true;
     }
 
-    auto stream = TRY(Core::Stream::File::open(real_path.bytes_as_string_view(), Core::Stream::OpenMode::Read));
+    auto length = static_cast<size_t>(st.st_size);
+    if (!encodings.is_empty() && is_compressible_mime_type(mime_type) && length >= minimum_compressible_size && length <= maximum_compressible_size) {
+        auto const* encoding = encodings.first();
+        auto compressed = ContentCache::the().get(real_path, encoding->name, st);
+        if (!compressed) {
+            auto stream = TRY(Core::Stream::File::open(real_path.bytes_as_string_view(), Core::Stream::OpenMode::Read));
+            auto contents = TRY(stream->read_until_eof());
+            compressed = ContentCache::the().put(real_path, encoding->name, st, TRY(encoding->compress_all(contents)));
+        }
+        TRY(send_content(*compressed, request, { .type = move(mime_type), .encoding = encoding->name }));
+        return true;
+    }
 
-    auto const info = ContentInfo {
-        .type = TRY(String::from_deprecated_string(Core::guess_mime_type_based_on_filename(real_path.bytes_as_string_view()))),
-        .length = TRY(Core::File::size(real_path.bytes_as_string_view()))
-    };
-    TRY(send_response(*stream, request, move(info)));
+    TRY(send_file(real_path, st, request, { .type = move(mime_type) }));
     return true;
 }
 
-ErrorOr<void> Client::send_response(AK::Stream& response, HTTP::HttpRequest const& request, ContentInfo content_info)
+ErrorOr<ByteBuffer> Client::make_response_header(ContentInfo const& content_info) const
 {
     StringBuilder builder;
-    builder.append("HTTP/1.0 200 OK\r\n"sv);
+    builder.append("HTTP/1.1 200 OK\r\n"sv);
     builder.append("Server: WebServer (SerenityOS)\r\n"sv);
     builder.append("X-Frame-Options: SAMEORIGIN\r\n"sv);
     builder.append("X-Content-Type-Options: nosniff\r\n"sv);
@@ -188,11 +340,24 @@ ErrorOr<void> Client::send_response(AK::Stream& response, HTTP::HttpRequest cons
     else
         builder.appendff("Content-Type: {}\r\n", content_info.type);
     builder.appendff("Content-Length: {}\r\n", content_info.length);
+    if (!content_info.encoding.is_empty())
+        builder.appendff("Content-Encoding: {}\r\n", content_info.encoding);
+    builder.append("Vary: Accept-Encoding\r\n"sv);
+    builder.appendff("Connection: {}\r\n", m_keep_alive ? "keep-alive"sv : "close"sv);
     builder.append("\r\n"sv);
+    return builder.to_byte_buffer();
+}
 
-    auto builder_contents = builder.to_byte_buffer();
-    TRY(m_socket->write(builder_contents));
+ErrorOr<void> Client::send_response_header(HTTP::HttpRequest const& request, ContentInfo const& content_info)
+{
+    TRY(m_socket->write_entire_buffer(TRY(make_response_header(content_info))));
     log_response(200, request);
+    return {};
+}
+
+ErrorOr<void> Client::send_response(AK::Stream& response, HTTP::HttpRequest const& request, ContentInfo content_info)
+{
+    TRY(send_response_header(request, content_info));
 
     char buffer[PAGE_SIZE];
     do {
@@ -212,24 +377,75 @@ ErrorOr<void> Client::send_response(AK::Stream& response, HTTP::HttpRequest cons
         }
     } while (true);
 
-    auto keep_alive = false;
-    if (auto it = request.headers().find_if([](auto& header) { return header.name.equals_ignoring_case("Connection"sv); }); !it.is_end()) {
-        if (it->value.trim_whitespace().equals_ignoring_case("keep-alive"sv))
-            keep_alive = true;
+    return {};
+}
+
+ErrorOr<void> Client::send_content(CachedContent const& content, HTTP::HttpRequest const& request, ContentInfo content_info)
+{
+    content_info.length = content.bytes.size();
+
+    // Send the header along with the content, so that a small response doesn't get split up into several packets.
+    auto response = TRY(make_response_header(content_info));
+    TRY(response.try_append(content.bytes));
+    TRY(m_socket->write_entire_buffer(response));
+    log_response(200, request);
+    return {};
+}
+
+// Small files are sent from memory, and everything else straight from the disk.
+ErrorOr<void> Client::send_file(String const& path, struct stat const& st, HTTP::HttpRequest const& request, ContentInfo content_info)
+{
+    auto is_small = static_cast<size_t>(st.st_size) <= ContentCache::maximum_entry_size;
+    if (is_small) {
+        if (auto content = ContentCache::the().get(path, {}, st))
+            return send_content(*content, request, move(content_info));
+    }
+
+    auto maybe_file = Core::Stream::File::open(path.bytes_as_string_view(), Core::Stream::OpenMode::Read);
+    if (maybe_file.is_error())
+        return send_error_response(404, request);
+    auto file = maybe_file.release_value();
+
+    if (is_small)
+        return send_content(ContentCache::the().put(path, {}, st, TRY(file->read_until_eof())), request, move(content_info));
+
+    content_info.length = st.st_size;
+    return send_file_response(*file, request, move(content_info));
+}
+
+ErrorOr<void> Client::send_file_response(Core::Stream::File& file, HTTP::HttpRequest const& request, ContentInfo content_info)
+{
+#ifndef AK_OS_SERENITY
+    // Note: sendfile() is only available on Serenity, so just copy the file through our own buffer elsewhere.
+    return send_response(file, request, move(content_info));
+#else
+    TRY(send_response_header(request, content_info));
+
+    // Let the kernel move the file contents into the socket, instead of copying them through our own buffer.
+    auto socket_fd = m_socket->fd();
+    VERIFY(socket_fd.has_value());
+    size_t total_sent = 0;
+    while (total_sent < content_info.length) {
+        auto nsent = TRY(Core::System::sendfile(*socket_fd, file.fd(), nullptr, content_info.length - total_sent));
+        // The file got shorter since we looked at its size, but we've already promised a Content-Length.
+        if (nsent == 0)
+            return Error::from_string_literal("File shrank while it was being sent");
+        total_sent += nsent;
     }
-    if (!keep_alive)
-        m_socket->close();
 
     return {};
+#endif
 }
 
 ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
 {
     StringBuilder builder;
-    builder.append("HTTP/1.0 301 Moved Permanently\r\n"sv);
+    builder.append("HTTP/1.1 301 Moved Permanently\r\n"sv);
     builder.append("Location: "sv);
     builder.append(redirect_path);
     builder.append("\r\n"sv);
+    builder.append("Content-Length: 0\r\n"sv);
+    builder.appendff("Connection: {}\r\n", m_keep_alive ? "keep-alive"sv : "close"sv);
     builder.append("\r\n"sv);
 
     auto builder_contents = builder.to_byte_buffer();
@@ -239,30 +455,37 @@ ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest
     return {};
 }
 
-static DeprecatedString folder_image_data()
+// Note: These are initialized on first use by whichever thread gets there first, which the compiler makes thread-safe.
+static DeprecatedString const& folder_image_data()
 {
-    static DeprecatedString cache;
-    if (cache.is_empty()) {
+    static DeprecatedString const cache = [] {
         auto file = Core::MappedFile::map("/res/icons/16x16/filetype-folder.png"sv).release_value_but_fixme_should_propagate_errors();
         // FIXME: change to TRY() and make method fallible
-        cache = MUST(encode_base64(file->bytes())).to_deprecated_string();
-    }
+        return MUST(encode_base64(file->bytes())).to_deprecated_string();
+    }();
     return cache;
 }
 
-static DeprecatedString file_image_data()
+static DeprecatedString const& file_image_data()
 {
-    static DeprecatedString cache;
-    if (cache.is_empty()) {
+    static DeprecatedString const cache = [] {
         auto file = Core::MappedFile::map("/res/icons/16x16/filetype-unknown.png"sv).release_value_but_fixme_should_propagate_errors();
         // FIXME: change to TRY() and make method fallible
-        cache = MUST(encode_base64(file->bytes())).to_deprecated_string();
-    }
+        return MUST(encode_base64(file->bytes())).to_deprecated_string();
+    }();
     return cache;
 }
 
-ErrorOr<void> Client::handle_directory_listing(String const& requested_path, String const& real_path, HTTP::HttpRequest const& request)
+// Only the directory itself is checked for changes before a cached listing is used, but the sizes and modification times of
+// the files in it can change without the directory's own changing, so don't keep a listing around for too long.
+static constexpr Time directory_listing_max_age = Time::from_seconds(5);
+
+ErrorOr<void> Client::handle_directory_listing(String const& requested_path, String const& real_path, struct stat const& directory_stat, HTTP::HttpRequest const& request)
 {
+    auto text_html = TRY(String::from_utf8("text/html"sv));
+    if (auto listing = ContentCache::the().get(real_path, {}, directory_stat, directory_listing_max_age))
+        return send_content(*listing, request, { .type = move(text_html) });
+
     StringBuilder builder;
 
     builder.append("<!DOCTYPE html>\n"sv);
@@ -335,9 +558,8 @@ ErrorOr<void> Client::handle_directory_listing(String const& requested_path, Str
     builder.append("</body>\n"sv);
     builder.append("</html>\n"sv);
 
-    auto response = builder.to_deprecated_string();
-    auto stream = TRY(FixedMemoryStream::construct(response.bytes()));
-    return send_response(*stream, request, { .type = TRY(String::from_utf8("text/html"sv)), .length = response.length() });
+    auto listing = ContentCache::the().put(real_path, {}, directory_stat, builder.to_byte_buffer());
+    return send_content(*listing, request, { .type = move(text_html) });
 }
 
 ErrorOr<void> Client::send_error_response(unsigned code, HTTP::HttpRequest const& request, Vector<String> const& headers)
@@ -351,7 +573,7 @@ ErrorOr<void> Client::send_error_response(unsigned code, HTTP::HttpRequest const
     content_builder.append("</h1></body></html>"sv);
 
     StringBuilder header_builder;
-    header_builder.appendff("HTTP/1.0 {} ", code);
+    header_builder.appendff("HTTP/1.1 {} ", code);
     header_builder.append(reason_phrase);
     header_builder.append("\r\n"sv);
 
@@ -361,9 +583,10 @@ ErrorOr<void> Client::send_error_response(unsigned code, HTTP::HttpRequest const
     }
     header_builder.append("Content-Type: text/html; charset=UTF-8\r\n"sv);
     header_builder.appendff("Content-Length: {}\r\n", content_builder.length());
+    header_builder.appendff("Connection: {}\r\n", m_keep_alive ? "keep-alive"sv : "close"sv);
     header_builder.append("\r\n"sv);
-    TRY(m_socket->write(header_builder.to_byte_buffer()));
-    TRY(m_socket->write(content_builder.to_byte_buffer()));
+    header_builder.append(content_builder.string_view());
+    TRY(m_socket->write_entire_buffer(header_builder.to_byte_buffer()));
 
     log_response(code, request);
     return {};
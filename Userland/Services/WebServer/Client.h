@@ -7,11 +7,15 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
 #include <AK/String.h>
 #include <LibCore/Object.h>
 #include <LibCore/Stream.h>
+#include <LibCore/Timer.h>
 #include <LibHTTP/Forward.h>
 #include <LibHTTP/HttpRequest.h>
+#include <WebServer/ContentCache.h>
+#include <sys/stat.h>
 
 namespace WebServer {
 
@@ -22,23 +26,36 @@ public:
     void start();
 
 private:
-    Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket>, Core::Object* parent);
+    explicit Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket>);
 
     struct ContentInfo {
         String type;
         size_t length {};
+        // The content coding that the response body was compressed with, if any.
+        StringView encoding {};
     };
 
+    ErrorOr<void> read_requests();
     ErrorOr<bool> handle_request(ReadonlyBytes);
     ErrorOr<void> send_response(AK::Stream&, HTTP::HttpRequest const&, ContentInfo);
+    ErrorOr<void> send_file(String const& path, struct stat const&, HTTP::HttpRequest const&, ContentInfo);
+    ErrorOr<void> send_file_response(Core::Stream::File&, HTTP::HttpRequest const&, ContentInfo);
+    ErrorOr<void> send_content(CachedContent const&, HTTP::HttpRequest const&, ContentInfo);
+    ErrorOr<ByteBuffer> make_response_header(ContentInfo const&) const;
+    ErrorOr<void> send_response_header(HTTP::HttpRequest const&, ContentInfo const&);
     ErrorOr<void> send_redirect(StringView redirect, HTTP::HttpRequest const&);
     ErrorOr<void> send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers = {});
     void die();
     void log_response(unsigned code, HTTP::HttpRequest const&);
-    ErrorOr<void> handle_directory_listing(String const& requested_path, String const& real_path, HTTP::HttpRequest const&);
+    ErrorOr<void> handle_directory_listing(String const& requested_path, String const& real_path, struct stat const&, HTTP::HttpRequest const&);
     bool verify_credentials(Vector<HTTP::HttpRequest::Header> const&);
 
     NonnullOwnPtr<Core::Stream::BufferedTCPSocket> m_socket;
+    // The start of the requests that haven't been received in full yet.
+    ByteBuffer m_pending_request_data;
+    // Whether the connection stays open once the response to the current request has been sent.
+    bool m_keep_alive { false };
+    RefPtr<Core::Timer> m_idle_timer;
 };
 
 }
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <WebServer/ContentCache.h>
+
+namespace WebServer {
+
+ContentCache& ContentCache::the()
+{
+    static ContentCache s_the;
+    return s_the;
+}
+
+DeprecatedString ContentCache::key_for(StringView path, StringView encoding)
+{
+    // Note: Paths are absolute, so they can't be mistaken for the keys of encoded content.
+    if (encoding.is_empty())
+        return path;
+    return DeprecatedString::formatted("{}:{}", encoding, path);
+}
+
+RefPtr<CachedContent const> ContentCache::get(StringView path, StringView encoding, struct stat const& st, Time max_age)
+{
+    Threading::MutexLocker locker(m_mutex);
+    auto it = m_entries.find(key_for(path, encoding));
+    if (it == m_entries.end())
+        return nullptr;
+
+    auto& entry = it->value;
+    auto is_stale = entry.inode != st.st_ino
+        || entry.size != st.st_size
+        || entry.status_change_time.tv_sec != st.st_ctim.tv_sec
+        || entry.status_change_time.tv_nsec != st.st_ctim.tv_nsec
+        || Time::now_monotonic_coarse() - entry.cached_at > max_age;
+    if (is_stale) {
+        dbgln_if(WEBSERVER_DEBUG, "Dropping stale cached content for '{}'", path);
+        m_total_size -= entry.content->bytes.size();
+        m_entries.remove(it);
+        return nullptr;
+    }
+
+    entry.last_use = ++m_use_counter;
+    return entry.content;
+}
+
+NonnullRefPtr<CachedContent const> ContentCache::put(StringView path, StringView encoding, struct stat const& st, ByteBuffer bytes)
+{
+    auto content = adopt_ref(*new CachedContent(move(bytes)));
+    auto size = content->bytes.size();
+    if (size > maximum_entry_size)
+        return content;
+
+    Threading::MutexLocker locker(m_mutex);
+    auto key = key_for(path, encoding);
+    if (auto it = m_entries.find(key); it != m_entries.end()) {
+        m_total_size -= it->value.content->bytes.size();
+        m_entries.remove(it);
+    }
+    make_room_for(size);
+
+    m_entries.set(move(key), Entry {
+                                 .content = content,
+                                 .inode = st.st_ino,
+                                 .size = st.st_size,
+                                 .status_change_time = st.st_ctim,
+                                 .cached_at = Time::now_monotonic_coarse(),
+                                 .last_use = ++m_use_counter,
+                             });
+    m_total_size += size;
+    return content;
+}
+
+void ContentCache::make_room_for(size_t size)
+{
+    while (!m_entries.is_empty() && m_total_size + size > maximum_total_size) {
+        auto least_recently_used = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->value.last_use < least_recently_used->value.last_use)
+                least_recently_used = it;
+        }
+        dbgln_if(WEBSERVER_DEBUG, "Evicting cached content for '{}'", least_recently_used->key);
+        m_total_size -= least_recently_used->value.content->bytes.size();
+        m_entries.remove(least_recently_used);
+    }
+}
+
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/AtomicRefCounted.h>
+#include <AK/ByteBuffer.h>
+#include <AK/DeprecatedString.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Time.h>
+#include <LibThreading/Mutex.h>
+#include <sys/stat.h>
+
+namespace WebServer {
+
+struct CachedContent : public AtomicRefCounted<CachedContent> {
+    explicit CachedContent(ByteBuffer bytes)
+        : bytes(move(bytes))
+    {
+    }
+
+    ByteBuffer const bytes;
+};
+
+// Keeps small files and generated directory listings in memory, so that serving them again doesn't have to touch the disk.
+// It's shared by all worker threads. An entry is only used while the file it was made from still looks the same as it did
+// back then, i.e. has the same inode, size and status change time. (Unlike the modification time, that one can't be set
+// back by whoever changes the file.)
+class ContentCache {
+public:
+    static ContentCache& the();
+
+    // Anything larger is sent straight from the disk instead.
+    static constexpr size_t maximum_entry_size = 256 * KiB;
+    static constexpr size_t maximum_total_size = 32 * MiB;
+
+    // The content of `path` with the content coding `encoding` applied (if any), if it was cached no longer than `max_age`
+    // ago and the file still has the status `st`.
+    RefPtr<CachedContent const> get(StringView path, StringView encoding, struct stat const& st, Time max_age = Time::max());
+
+    // Caches the content if it's small enough, and returns it either way.
+    NonnullRefPtr<CachedContent const> put(StringView path, StringView encoding, struct stat const& st, ByteBuffer);
+
+private:
+    struct Entry {
+        NonnullRefPtr<CachedContent const> content;
+        ino_t inode { 0 };
+        off_t size { 0 };
+        struct timespec status_change_time { };
+        Time cached_at {};
+        u64 last_use { 0 };
+    };
+
+    static DeprecatedString key_for(StringView path, StringView encoding);
+    void make_room_for(size_t);
+
+    Threading::Mutex m_mutex;
+    HashMap<DeprecatedString, Entry> m_entries;
+    size_t m_total_size { 0 };
+    u64 m_use_counter { 0 };
+};
+
+}
@@ -9,6 +9,7 @@
 #include <AK/String.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/EventLoop.h>
+#include <LibCore/EventLoopGroup.h>
 #include <LibCore/File.h>
 #include <LibCore/MappedFile.h>
 #include <LibCore/System.h>
@@ -31,12 +32,14 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     DeprecatedString username;
     DeprecatedString password;
     DeprecatedString document_root_path = default_document_root_path.to_deprecated_string();
+    int thread_count = 0;
 
     Core::ArgsParser args_parser;
     args_parser.add_option(listen_address, "IP address to listen on", "listen-address", 'l', "listen_address");
     args_parser.add_option(port, "Port to listen on", "port", 'p', "port");
     args_parser.add_option(username, "HTTP basic authentication username", "user", 'U', "username");
     args_parser.add_option(password, "HTTP basic authentication password", "pass", 'P', "password");
+    args_parser.add_option(thread_count, "Number of threads to serve clients on (one per processor by default)", "threads", 'j', "count");
     args_parser.add_positional_argument(document_root_path, "Path to serve the contents of", "path", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
@@ -51,6 +54,11 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         return 1;
     }
 
+    if (thread_count < 0) {
+        warnln("Invalid number of threads: {}", thread_count);
+        return 1;
+    }
+
     if (username.is_empty() != password.is_empty()) {
         warnln("Both username and password are required for HTTP basic authentication.");
         return 1;
@@ -62,7 +70,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         return 1;
     }
 
-    TRY(Core::System::pledge("stdio accept rpath inet unix"));
+    TRY(Core::System::pledge("stdio accept rpath inet unix thread"));
 
     Optional<HTTP::HttpRequest::BasicAuthenticationCredentials> credentials;
     if (!username.is_empty() && !password.is_empty())
@@ -74,14 +82,10 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     auto server = TRY(Core::TCPServer::try_create());
 
-    server->on_ready_to_accept = [&] {
-        auto maybe_client_socket = server->accept();
-        if (maybe_client_socket.is_error()) {
-            warnln("Failed to accept the client: {}", maybe_client_socket.error());
-            return;
-        }
-
-        auto maybe_buffered_socket = Core::Stream::BufferedTCPSocket::create(maybe_client_socket.release_value());
+    // Connections are accepted on this thread, but each client is served by one of the group's threads from then on.
+    auto event_loop_group = TRY(Core::EventLoopGroup::try_create(thread_count));
+    event_loop_group->distribute_connections(*server, [](NonnullOwnPtr<Core::Stream::TCPSocket> client_socket) {
+        auto maybe_buffered_socket = Core::Stream::BufferedTCPSocket::create(move(client_socket));
         if (maybe_buffered_socket.is_error()) {
             warnln("Could not obtain a buffered socket for the client: {}", maybe_buffered_socket.error());
             return;
@@ -89,9 +93,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
         // FIXME: Propagate errors
         MUST(maybe_buffered_socket.value()->set_blocking(true));
-        auto client = WebServer::Client::construct(maybe_buffered_socket.release_value(), server);
+        auto client = WebServer::Client::construct(maybe_buffered_socket.release_value());
         client->start();
-    };
+    });
 
     TRY(server->listen(ipv4_address.value(), port));
 
@@ -105,6 +109,6 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     TRY(Core::System::unveil(real_document_root_path, "r"sv));
     TRY(Core::System::unveil(nullptr, nullptr));
 
-    TRY(Core::System::pledge("stdio accept rpath"));
+    TRY(Core::System::pledge("stdio accept rpath thread"));
     return loop.exec();
 }
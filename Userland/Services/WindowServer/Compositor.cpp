@@ -22,6 +22,7 @@
 #include <LibGfx/Painter.h>
 #include <LibGfx/StylePainter.h>
 #include <LibThreading/BackgroundAction.h>
+#include <LibThreading/ThreadPool.h>
 
 namespace WindowServer {
 
@@ -105,6 +106,7 @@ void CompositorScreenData::init_bitmaps(Compositor& compositor, Screen& screen)
     m_flush_rects.clear_with_capacity();
     m_flush_transparent_rects.clear_with_capacity();
     m_flush_special_rects.clear_with_capacity();
+    m_back_buffer_stale_rects.clear_with_capacity();
 
     auto size = screen.size();
     m_front_bitmap = nullptr;
@@ -247,12 +249,22 @@ void Compositor::compose()
 
     auto& cursor_screen = ScreenInput::the().cursor_location_screen();
 
+    // An opaque fullscreen window is composed all by itself, so everything in its dirty rects is about to be repainted,
+    // and doesn't have to be brought up to date in the back buffer first. For fullscreen content that changes with every
+    // frame, this leaves blitting it to the back buffer as the only copy the compositor makes.
+    Gfx::DisjointIntRectSet rects_about_to_be_repainted;
+    if (auto* fullscreen_window = wm.active_fullscreen_window(); fullscreen_window && fullscreen_window->is_opaque()) {
+        if (m_invalidated_window && !window_stack_transition_in_progress && m_overlay_list.is_empty() && m_animations.is_empty())
+            rects_about_to_be_repainted = fullscreen_window->opaque_rects().intersected(fullscreen_window->dirty_rects()).intersected(fullscreen_window->rect());
+    }
+
     Screen::for_each([&](auto& screen) {
         auto& screen_data = screen.compositor_screen_data();
         screen_data.m_have_flush_rects = false;
         screen_data.m_flush_rects.clear_with_capacity();
         screen_data.m_flush_transparent_rects.clear_with_capacity();
         screen_data.m_flush_special_rects.clear_with_capacity();
+        screen_data.update_back_buffer(screen, rects_about_to_be_repainted);
         return IterationDecision::Continue;
     });
 
@@ -374,7 +386,7 @@ void Compositor::compose()
         dbgln_if(COMPOSE_DEBUG, "  window {} frame rect: {}", window.title(), frame_rect);
 
         RefPtr<Gfx::Bitmap> backing_store = window.backing_store();
-        auto compose_window_rect = [&](Screen& screen, Gfx::Painter& painter, const Gfx::IntRect& rect) {
+        auto compose_window_rect = [&](Screen& screen, Gfx::Painter& painter, const Gfx::IntRect& rect, bool can_tile_blit = false) {
             if (!window.is_fullscreen()) {
                 rect.for_each_intersected(frame_rects, [&](const Gfx::IntRect& intersected_rect) {
                     Gfx::PainterStateSaver saver(painter);
@@ -457,6 +469,8 @@ void Compositor::compose()
                             return color;
                         });
                     }
+                } else if (can_tile_blit) {
+                    m_tiled_blits.append({ &screen, dst, *backing_store, dirty_rect_in_backing_coordinates, window.opacity() });
                 } else {
                     painter.blit(dst, *backing_store, dirty_rect_in_backing_coordinates, window.opacity());
                 }
@@ -491,7 +505,7 @@ void Compositor::compose()
                     auto& back_painter = *screen->compositor_screen_data().m_back_painter;
                     Gfx::PainterStateSaver saver(back_painter);
                     back_painter.add_clip_rect(screen_render_rect);
-                    compose_window_rect(*screen, back_painter, screen_render_rect);
+                    compose_window_rect(*screen, back_painter, screen_render_rect, true);
                 }
                 return IterationDecision::Continue;
             });
@@ -551,6 +565,7 @@ void Compositor::compose()
                 return IterationDecision::Continue;
             });
         }
+        run_tiled_blits();
 
         // Check that there are no overlapping transparent and opaque flush rectangles
         VERIFY(![&]() {
@@ -616,6 +631,57 @@ void Compositor::compose()
     });
 }
 
+void Compositor::run_tiled_blits()
+{
+    // Below this many pixels, handing the blits to other threads costs more than it saves.
+    static constexpr size_t minimum_pixel_count_for_threads = 256 * 256;
+    static constexpr int tile_size = 128;
+
+    if (m_tiled_blits.is_empty())
+        return;
+    ScopeGuard clear_blits = [&] { m_tiled_blits.clear_with_capacity(); };
+
+    size_t pixel_count = 0;
+    for (auto& blit : m_tiled_blits)
+        pixel_count += blit.source_rect.size().area();
+
+    if (pixel_count < minimum_pixel_count_for_threads) {
+        for (auto& blit : m_tiled_blits)
+            blit.screen->compositor_screen_data().m_back_painter->blit(blit.position, blit.source, blit.source_rect, blit.opacity);
+        return;
+    }
+
+    // Note: The opaque parts of windows don't overlap each other, or anything else that compose() paints to the back
+    //       buffer, so their blits can happen in any order. Cutting them along a grid of screen tiles spreads big windows
+    //       over all threads.
+    struct Tile {
+        TiledBlit const* blit;
+        Gfx::IntRect rect;
+    };
+    Vector<Tile> tiles;
+    for (auto& blit : m_tiled_blits) {
+        auto screen_location = blit.screen->rect().location();
+        auto destination_rect = Gfx::IntRect { blit.position, blit.source_rect.size() }.translated(-screen_location);
+        for (int y = destination_rect.top() / tile_size * tile_size; y <= destination_rect.bottom(); y += tile_size) {
+            for (int x = destination_rect.left() / tile_size * tile_size; x <= destination_rect.right(); x += tile_size) {
+                auto tile_rect = Gfx::IntRect { x, y, tile_size, tile_size }.intersected(destination_rect);
+                tiles.append({ &blit, tile_rect.translated(screen_location) });
+            }
+        }
+    }
+
+    Threading::ThreadPool::the().parallel_for(tiles.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            auto& tile = tiles[i];
+            auto& screen_data = tile.blit->screen->compositor_screen_data();
+            Gfx::Painter painter(*screen_data.m_back_bitmap);
+            painter.translate(-tile.blit->screen->rect().location());
+            painter.add_clip_rect(tile.rect);
+            painter.blit(tile.blit->position, tile.blit->source, tile.blit->source_rect, tile.blit->opacity);
+        }
+    });
+}
+
 void Compositor::flush(Screen& screen)
 {
     auto& screen_data = screen.compositor_screen_data();
@@ -678,35 +744,26 @@ void Compositor::flush(Screen& screen)
 
     auto do_flush = [&](Gfx::IntRect rect) {
         VERIFY(screen_rect.contains(rect));
+
+        // Note: If we can flip buffers, the back buffer now lacks what we just flushed. Copying that over is left to the
+        //       next compose(), which can skip whatever it's going to repaint anyway.
+        if (screen_data.m_screen_can_set_buffer) {
+            screen_data.m_back_buffer_stale_rects.add(rect);
+            return;
+        }
+
         rect.translate_by(-screen_rect.location());
 
         // Almost everything in Compositor is in logical coordinates, with the painters having
         // a scale applied. But this routine accesses the backbuffer pixels directly, so it
         // must work in physical coordinates.
         auto scaled_rect = rect * screen.scale_factor();
-        Gfx::ARGB32* front_ptr = screen_data.m_front_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
-        Gfx::ARGB32* back_ptr = screen_data.m_back_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
         size_t pitch = screen_data.m_back_bitmap->pitch();
 
-        // NOTE: The meaning of a flush depends on whether we can flip buffers or not.
-        //
-        //       If flipping is supported, flushing means that we've flipped, and now we
-        //       copy the changed bits from the front buffer to the back buffer, to keep
-        //       them in sync.
-        //
-        //       If flipping is not supported, flushing means that we copy the changed
+        // NOTE: Without buffer flipping, flushing means that we copy the changed
         //       rects from the backing bitmap to the display framebuffer.
-
-        Gfx::ARGB32* to_ptr;
-        const Gfx::ARGB32* from_ptr;
-
-        if (screen_data.m_screen_can_set_buffer) {
-            to_ptr = back_ptr;
-            from_ptr = front_ptr;
-        } else {
-            to_ptr = front_ptr;
-            from_ptr = back_ptr;
-        }
+        Gfx::ARGB32* to_ptr = screen_data.m_front_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
+        const Gfx::ARGB32* from_ptr = screen_data.m_back_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
 
         for (int y = 0; y < scaled_rect.height(); ++y) {
             fast_u32_copy(to_ptr, from_ptr, scaled_rect.width());
@@ -714,9 +771,7 @@ void Compositor::flush(Screen& screen)
             to_ptr = (Gfx::ARGB32*)((u8*)to_ptr + pitch);
         }
         if (device_can_flush_buffers) {
-            // Whether or not we need to flush buffers, we need to at least track what we modified
-            // so that we can flush these areas next time before we flip buffers. Or, if we don't
-            // support buffer flipping then we will flush them shortly.
+            // We don't support buffer flipping, so we will flush these shortly.
             screen.queue_flush_display_rect(rect);
         }
     };
@@ -872,6 +927,37 @@ void CompositorScreenData::flip_buffers(Screen& screen)
     m_buffers_are_flipped = !m_buffers_are_flipped;
 }
 
+void CompositorScreenData::update_back_buffer(Screen& screen, Gfx::DisjointIntRectSet const& rects_about_to_be_repainted)
+{
+    if (m_back_buffer_stale_rects.is_empty())
+        return;
+    VERIFY(m_screen_can_set_buffer);
+
+    auto screen_rect = screen.rect();
+    auto stale_rects = m_back_buffer_stale_rects.shatter(rects_about_to_be_repainted.intersected(screen_rect));
+    m_back_buffer_stale_rects.clear_with_capacity();
+
+    bool device_can_flush_buffers = screen.can_device_flush_buffers();
+    size_t pitch = m_back_bitmap->pitch();
+    for (auto rect : stale_rects.rects()) {
+        rect.translate_by(-screen_rect.location());
+
+        // Like flush(), this accesses the pixels directly, so it must work in physical coordinates.
+        auto scaled_rect = rect * screen.scale_factor();
+        const Gfx::ARGB32* from_ptr = m_front_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
+        Gfx::ARGB32* to_ptr = m_back_bitmap->scanline(scaled_rect.y()) + scaled_rect.x();
+        for (int y = 0; y < scaled_rect.height(); ++y) {
+            fast_u32_copy(to_ptr, from_ptr, scaled_rect.width());
+            from_ptr = (const Gfx::ARGB32*)((const u8*)from_ptr + pitch);
+            to_ptr = (Gfx::ARGB32*)((u8*)to_ptr + pitch);
+        }
+
+        // The device has to hear about this before the next flip, along with everything else we modified.
+        if (device_can_flush_buffers)
+            screen.queue_flush_display_rect(rect);
+    }
+}
+
 void Compositor::screen_resolution_changed()
 {
     // Screens may be gone now, invalidate any references to them
@@ -55,11 +55,14 @@ struct CompositorScreenData {
     Gfx::DisjointIntRectSet m_flush_rects;
     Gfx::DisjointIntRectSet m_flush_transparent_rects;
     Gfx::DisjointIntRectSet m_flush_special_rects;
+    // What was flushed to the front buffer before the last flip, and still has to be copied over to the back buffer.
+    Gfx::DisjointIntRectSet m_back_buffer_stale_rects;
 
     Gfx::Painter& overlay_painter() { return *m_temp_painter; }
 
     void init_bitmaps(Compositor&, Screen&);
     void flip_buffers(Screen&);
+    void update_back_buffer(Screen&, Gfx::DisjointIntRectSet const& rects_about_to_be_repainted);
     void draw_cursor(Screen&, Gfx::IntRect const&);
     bool restore_cursor_back(Screen&, Gfx::IntRect&);
     void init_wallpaper_bitmap(Screen&);
@@ -216,6 +219,16 @@ private:
     void start_window_stack_switch_overlay_timer();
     void finish_window_stack_switch();
     void update_wallpaper_bitmap();
+    void run_tiled_blits();
+
+    // A blit of a window's backing store to an opaque part of the back buffer, which compose() leaves for run_tiled_blits().
+    struct TiledBlit {
+        Screen* screen { nullptr };
+        Gfx::IntPoint position;
+        NonnullRefPtr<Gfx::Bitmap> source;
+        Gfx::IntRect source_rect;
+        float opacity { 1.0f };
+    };
 
     RefPtr<Core::Timer> m_compose_timer;
     RefPtr<Core::Timer> m_immediate_compose_timer;
@@ -252,6 +265,8 @@ private:
     Optional<Gfx::Color> m_custom_background_color;
 
     HashTable<Animation*> m_animations;
+
+    Vector<TiledBlit> m_tiled_blits;
 };
 
 }
@@ -5,6 +5,7 @@
  */
 
 #include <AK/Badge.h>
+#include <AK/LexicalPath.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/StandardCursor.h>
 #include <LibGfx/SystemTheme.h>
@@ -14,6 +15,7 @@
 #include <WindowServer/Menu.h>
 #include <WindowServer/MenuItem.h>
 #include <WindowServer/Screen.h>
+#include <WindowServer/SharedBitmapCache.h>
 #include <WindowServer/Window.h>
 #include <WindowServer/WindowClientEndpoint.h>
 #include <WindowServer/WindowManager.h>
@@ -331,6 +333,24 @@ Messages::WindowServer::GetWallpaperResponse ConnectionFromClient::get_wallpaper
     return Compositor::the().wallpaper_bitmap()->to_shareable_bitmap();
 }
 
+Messages::WindowServer::GetSharedBitmapResponse ConnectionFromClient::get_shared_bitmap(DeprecatedString const& path, int scale_factor)
+{
+    // Note: Only the read-only resources that every client may see anyway are shared, and only at sensible scales.
+    if (scale_factor < 1 || scale_factor > 4) {
+        did_misbehave("GetSharedBitmap: Bad scale factor");
+        return Gfx::ShareableBitmap {};
+    }
+    if (!path.starts_with("/res/"sv) || LexicalPath::canonicalized_path(path) != path) {
+        did_misbehave("GetSharedBitmap: Bad path");
+        return Gfx::ShareableBitmap {};
+    }
+
+    auto bitmap_or_error = SharedBitmapCache::the().get_or_load(path, scale_factor);
+    if (bitmap_or_error.is_error())
+        return Gfx::ShareableBitmap {};
+    return bitmap_or_error.value()->to_shareable_bitmap();
+}
+
 Messages::WindowServer::SetScreenLayoutResponse ConnectionFromClient::set_screen_layout(ScreenLayout const& screen_layout, bool save)
 {
     DeprecatedString error_msg;
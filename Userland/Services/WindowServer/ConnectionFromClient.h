@@ -132,6 +132,7 @@ private:
     virtual void set_background_color(DeprecatedString const&) override;
     virtual void set_wallpaper_mode(DeprecatedString const&) override;
     virtual Messages::WindowServer::GetWallpaperResponse get_wallpaper() override;
+    virtual Messages::WindowServer::GetSharedBitmapResponse get_shared_bitmap(DeprecatedString const&, int) override;
     virtual Messages::WindowServer::SetScreenLayoutResponse set_screen_layout(ScreenLayout const&, bool) override;
     virtual Messages::WindowServer::GetScreenLayoutResponse get_screen_layout() override;
     virtual Messages::WindowServer::SaveScreenLayoutResponse save_screen_layout() override;
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <WindowServer/SharedBitmapCache.h>
+
+namespace WindowServer {
+
+SharedBitmapCache& SharedBitmapCache::the()
+{
+    static SharedBitmapCache s_the;
+    return s_the;
+}
+
+ErrorOr<NonnullRefPtr<Gfx::Bitmap>> SharedBitmapCache::get_or_load(StringView path, int scale_factor)
+{
+    auto& bitmaps_for_path = m_bitmaps.ensure(path);
+    if (auto it = bitmaps_for_path.find(scale_factor); it != bitmaps_for_path.end()) {
+        if (!it->value)
+            return Error::from_string_literal("Bitmap could not be loaded");
+        return *it->value;
+    }
+
+    auto bitmap_or_error = Gfx::Bitmap::load_from_file(path, scale_factor);
+    if (bitmap_or_error.is_error()) {
+        bitmaps_for_path.set(scale_factor, nullptr);
+        return bitmap_or_error.release_error();
+    }
+    auto bitmap = TRY(bitmap_or_error.value()->to_bitmap_backed_by_anonymous_buffer());
+    bitmaps_for_path.set(scale_factor, bitmap);
+    return bitmap;
+}
+
+void SharedBitmapCache::purge_unused_bitmaps()
+{
+    m_bitmaps.remove_all_matching([](auto&, auto& bitmaps_for_path) {
+        bitmaps_for_path.remove_all_matching([](auto, auto& bitmap) {
+            return !bitmap || bitmap->ref_count() == 1;
+        });
+        return bitmaps_for_path.is_empty();
+    });
+}
+
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/DeprecatedString.h>
+#include <AK/HashMap.h>
+#include <AK/RefPtr.h>
+#include <LibGfx/Bitmap.h>
+
+namespace WindowServer {
+
+// Bitmaps decoded from the files in /res, kept in anonymous buffers so that they can be handed to every client without
+// copying. Theme bitmaps live in per-theme directories, so the path and scale factor are all that tell them apart.
+class SharedBitmapCache {
+public:
+    static SharedBitmapCache& the();
+
+    ErrorOr<NonnullRefPtr<Gfx::Bitmap>> get_or_load(StringView path, int scale_factor);
+
+    // Drops the bitmaps nobody but the cache holds on to anymore, e.g. those of a previous theme.
+    void purge_unused_bitmaps();
+
+private:
+    SharedBitmapCache() = default;
+
+    // Note: Files that could not be loaded are remembered as null bitmaps, so that they are only tried once.
+    HashMap<DeprecatedString, HashMap<int, RefPtr<Gfx::Bitmap>>> m_bitmaps;
+};
+
+}
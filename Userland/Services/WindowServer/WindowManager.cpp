@@ -23,6 +23,7 @@
 #include <WindowServer/Button.h>
 #include <WindowServer/ConnectionFromClient.h>
 #include <WindowServer/Cursor.h>
+#include <WindowServer/SharedBitmapCache.h>
 #include <WindowServer/WindowClientEndpoint.h>
 
 namespace WindowServer {
@@ -101,6 +102,7 @@ void WindowManager::reload_config()
     Compositor::the().invalidate_after_theme_or_font_change();
 
     WindowFrame::reload_config();
+    SharedBitmapCache::the().purge_unused_bitmaps();
 
     load_system_effects();
 }
@@ -2049,6 +2051,7 @@ void WindowManager::invalidate_after_theme_or_font_change()
 {
     Compositor::the().set_background_color(g_config->read_entry("Background", "Color", palette().desktop_background().to_deprecated_string()));
     WindowFrame::reload_config();
+    SharedBitmapCache::the().purge_unused_bitmaps();
     for_each_window_stack([&](auto& window_stack) {
         window_stack.for_each_window([&](Window& window) {
             window.frame().theme_changed();
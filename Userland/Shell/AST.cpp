@@ -1687,7 +1687,9 @@ void Execute::for_each_entry(RefPtr<Shell> shell, Function<IterationDecision(Non
         };
 
         notifier->on_ready_to_read = [&] {
-            constexpr static auto buffer_size = 16;
+            // Note: Reading a whole page at a time keeps the number of syscalls (and event loop iterations) down for
+            //       commands with a lot of output; all the entries that came in with one read are handed out at once.
+            constexpr static auto buffer_size = 4096;
             u8 buffer[buffer_size];
             size_t remaining_size = buffer_size;
 
@@ -1700,10 +1702,14 @@ void Execute::for_each_entry(RefPtr<Shell> shell, Function<IterationDecision(Non
                         notifier->set_event_mask(Core::Notifier::Read);
                 } };
 
-                if (check_and_call() == Break) {
-                    loop.quit(Break);
-                    return;
-                }
+                auto action = Continue;
+                do {
+                    action = check_and_call();
+                    if (action == Break) {
+                        loop.quit(Break);
+                        return;
+                    }
+                } while (action == Continue);
 
                 auto read_size = read(pipefd[0], buffer, remaining_size);
                 if (read_size < 0) {
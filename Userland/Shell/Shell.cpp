@@ -1344,45 +1344,82 @@ void Shell::cache_path()
     if (!cached_path.is_empty())
         cached_path.clear_with_capacity();
 
+    HashTable<DeprecatedString> seen_names;
+    auto add_to_cache = [&](RunnablePath::Kind kind, DeprecatedString name) {
+        if (seen_names.set(name) != HashSetResult::InsertedNewEntry)
+            return;
+        cached_path.append({ kind, move(name) });
+    };
+
     // Add shell builtins to the cache.
     for (auto const& builtin_name : builtin_names)
-        cached_path.append({ RunnablePath::Kind::Builtin, escape_token(builtin_name) });
+        add_to_cache(RunnablePath::Kind::Builtin, escape_token(builtin_name));
 
     // Add functions to the cache.
-    for (auto& function : m_functions) {
-        auto name = escape_token(function.key);
-        if (cached_path.contains_slow(name))
-            continue;
-        cached_path.append({ RunnablePath::Kind::Function, name });
-    }
+    for (auto& function : m_functions)
+        add_to_cache(RunnablePath::Kind::Function, escape_token(function.key));
 
     // Add aliases to the cache.
-    for (auto const& alias : m_aliases) {
-        auto name = escape_token(alias.key);
-        if (cached_path.contains_slow(name))
-            continue;
-        cached_path.append({ RunnablePath::Kind::Alias, name });
-    }
+    for (auto const& alias : m_aliases)
+        add_to_cache(RunnablePath::Kind::Alias, escape_token(alias.key));
 
     // TODO: Can we make this rely on Core::File::resolve_executable_from_environment()?
+    Vector<DeprecatedString> directories;
     DeprecatedString path = getenv("PATH");
     if (!path.is_empty()) {
-        auto directories = path.split(':');
+        directories = path.split(':');
         for (auto const& directory : directories) {
             Core::DirIterator programs(directory.characters(), Core::DirIterator::SkipDots);
             while (programs.has_next()) {
                 auto program = programs.next_path();
-                auto program_path = DeprecatedString::formatted("{}/{}", directory, program);
                 auto escaped_name = escape_token(program);
-                if (cached_path.contains_slow(escaped_name))
+                if (seen_names.contains(escaped_name))
                     continue;
+                auto program_path = DeprecatedString::formatted("{}/{}", directory, program);
                 if (access(program_path.characters(), X_OK) == 0)
-                    cached_path.append({ RunnablePath::Kind::Executable, escaped_name });
+                    add_to_cache(RunnablePath::Kind::Executable, move(escaped_name));
             }
         }
     }
 
     quick_sort(cached_path);
+
+    watch_path_directories(directories);
+}
+
+void Shell::watch_path_directories(Vector<DeprecatedString> const& directories)
+{
+    if (m_path_watcher && directories == m_watched_path_directories)
+        return;
+
+    // Programs that show up in (or disappear from) $PATH after the cache was built would otherwise only be noticed on
+    // the next explicit rehash, so rebuild the cache whenever one of its directories changes.
+    m_path_watcher = nullptr;
+    m_watched_path_directories = directories;
+
+    auto watcher_or_error = Core::FileWatcher::create();
+    if (watcher_or_error.is_error()) {
+        dbgln("Shell: Not watching $PATH for changes: {}", watcher_or_error.error());
+        return;
+    }
+    m_path_watcher = watcher_or_error.release_value();
+
+    for (auto const& directory : directories) {
+        // Directories in $PATH that don't exist (yet) are simply not watched.
+        (void)m_path_watcher->add_watch(directory, Core::FileWatcherEvent::Type::ChildCreated | Core::FileWatcherEvent::Type::ChildDeleted);
+    }
+
+    m_path_watcher->on_change = [this](Core::FileWatcherEvent const&) {
+        // Note: Installing a bunch of programs sends an event for each of them, so only rebuild the cache once for all
+        //       the events that arrived in the same event loop iteration.
+        if (m_path_cache_refresh_pending)
+            return;
+        m_path_cache_refresh_pending = true;
+        deferred_invoke([this] {
+            m_path_cache_refresh_pending = false;
+            cache_path();
+        });
+    };
 }
 
 void Shell::add_entry_to_cache(RunnablePath const& entry)
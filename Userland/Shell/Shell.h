@@ -18,6 +18,7 @@
 #include <AK/StringView.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
+#include <LibCore/FileWatcher.h>
 #include <LibCore/Notifier.h>
 #include <LibCore/Object.h>
 #include <LibLine/Editor.h>
@@ -391,6 +392,7 @@ private:
     Optional<int> resolve_job_spec(StringView);
     void add_entry_to_cache(RunnablePath const&);
     void remove_entry_from_cache(StringView);
+    void watch_path_directories(Vector<DeprecatedString> const&);
     void stop_all_jobs();
     Job const* m_current_job { nullptr };
     LocalFrame* find_frame_containing_local_variable(StringView name);
@@ -465,6 +467,10 @@ private:
 
     Optional<size_t> m_history_autosave_time;
 
+    RefPtr<Core::FileWatcher> m_path_watcher;
+    Vector<DeprecatedString> m_watched_path_directories;
+    bool m_path_cache_refresh_pending { false };
+
     StackInfo m_completion_stack_info;
 };
 
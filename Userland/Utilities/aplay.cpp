@@ -96,7 +96,6 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             if (samples.value().size() > 0) {
                 print_playback_update();
                 // We can read and enqueue more samples
-                resampler.reset();
                 auto resampled_samples = resampler.resample(move(samples.value()));
                 TRY(audio_client->async_enqueue(move(resampled_samples)));
             } else if (should_loop) {
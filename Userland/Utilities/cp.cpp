@@ -9,12 +9,58 @@
 #include <LibCore/File.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
+#include <LibThreading/TreeWalker.h>
 #include <stdio.h>
 #include <unistd.h>
 
+static Error to_error(Core::File::CopyError const& error)
+{
+    return Error::from_errno(error.code());
+}
+
+// Copies the files of each directory in parallel, creating directories before anything in them and giving them their
+// attributes once everything has been copied into them.
+static ErrorOr<void> copy_directory_tree(DeprecatedString const& destination_path, StringView source, Core::File::LinkMode link_mode, Core::File::PreserveMode preserve)
+{
+    auto source_root = LexicalPath(source).string();
+    auto destination_for = [&](Threading::TreeWalkerEntry const& entry) {
+        auto relative_path = entry.path.substring_view(source_root.length());
+        return relative_path.is_empty() ? destination_path : LexicalPath::join(destination_path, relative_path).string();
+    };
+
+    Threading::TreeWalker<Empty> walker;
+    walker.on_enter_directory = [&](auto const& entry) -> ErrorOr<void> {
+        auto destination = destination_for(entry);
+        TRY(Core::System::mkdir(destination, 0755));
+        if (entry.depth == 0) {
+            auto source_real_path = DeprecatedString::formatted("{}/", Core::File::real_path_for(entry.path));
+            auto destination_real_path = DeprecatedString::formatted("{}/", Core::File::real_path_for(destination));
+            if (destination_real_path.starts_with(source_real_path))
+                return Error::from_string_literal("Cannot copy a directory into itself");
+        }
+        return {};
+    };
+    walker.on_file = [&](auto const& entry) -> ErrorOr<Empty> {
+        auto result = Core::File::copy_file_or_directory(destination_for(entry), entry.path, Core::File::RecursionMode::Allowed, link_mode, Core::File::AddDuplicateFileMarker::Yes, preserve);
+        if (result.is_error())
+            return to_error(result.error());
+        return Empty {};
+    };
+    walker.on_leave_directory = [&](auto const& entry, auto&) -> ErrorOr<Empty> {
+        auto source_stat = TRY(entry.stat());
+        auto result = Core::File::copy_directory_attributes(destination_for(entry), source_stat, preserve);
+        if (result.is_error())
+            return to_error(result.error());
+        return Empty {};
+    };
+
+    TRY(walker.walk(source_root));
+    return {};
+}
+
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
-    TRY(Core::System::pledge("stdio rpath wpath cpath fattr chown"));
+    TRY(Core::System::pledge("stdio rpath wpath cpath fattr chown thread"));
 
     bool link = false;
     auto preserve = Core::File::PreserveMode::Nothing;
@@ -66,7 +112,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     if (has_flag(preserve, Core::File::PreserveMode::Permissions)) {
         umask(0);
     } else {
-        TRY(Core::System::pledge("stdio rpath wpath cpath fattr"));
+        TRY(Core::System::pledge("stdio rpath wpath cpath fattr thread"));
     }
 
     bool destination_is_existing_dir = Core::File::is_directory(destination);
@@ -76,10 +122,23 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             ? DeprecatedString::formatted("{}/{}", destination, LexicalPath::basename(source))
             : destination;
 
+        auto link_mode = link ? Core::File::LinkMode::Allowed : Core::File::LinkMode::Disallowed;
+        if (recursion_allowed && Core::File::is_directory(source)) {
+            auto result = copy_directory_tree(destination_path, source, link_mode, preserve);
+            if (result.is_error()) {
+                warnln("cp: unable to copy '{}' to '{}': {}", source, destination_path, result.error());
+                return 1;
+            }
+
+            if (verbose)
+                outln("'{}' -> '{}'", source, destination_path);
+            continue;
+        }
+
         auto result = Core::File::copy_file_or_directory(
             destination_path, source,
             recursion_allowed ? Core::File::RecursionMode::Allowed : Core::File::RecursionMode::Disallowed,
-            link ? Core::File::LinkMode::Allowed : Core::File::LinkMode::Disallowed,
+            link_mode,
             Core::File::AddDuplicateFileMarker::No,
             preserve);
 
@@ -10,10 +10,10 @@
 #include <AK/Vector.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DateTime.h>
-#include <LibCore/DirIterator.h>
 #include <LibCore/Stream.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
+#include <LibThreading/TreeWalker.h>
 #include <limits.h>
 #include <string.h>
 
@@ -36,8 +36,14 @@ struct DuOption {
     size_t max_depth = SIZE_MAX;
 };
 
+struct SpaceUsage {
+    u64 size { 0 };
+    // The lines for the entry and everything in it, in the order they are printed in.
+    DeprecatedString output;
+};
+
 static ErrorOr<void> parse_args(Main::Arguments arguments, Vector<DeprecatedString>& files, DuOption& du_option);
-static ErrorOr<u64> print_space_usage(DeprecatedString const& path, DuOption const& du_option, size_t current_depth, bool inside_dir = false);
+static ErrorOr<SpaceUsage> space_usage(Threading::TreeWalkerEntry const& entry, DuOption const& du_option, Vector<SpaceUsage> const& contents);
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
@@ -46,8 +52,18 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     TRY(parse_args(arguments, files, du_option));
 
-    for (auto const& file : files)
-        TRY(print_space_usage(file, du_option, 0));
+    Threading::TreeWalker<SpaceUsage> walker;
+    walker.on_file = [&](auto const& entry) { return space_usage(entry, du_option, {}); };
+    walker.on_leave_directory = [&](auto const& entry, auto& contents) { return space_usage(entry, du_option, contents); };
+
+    for (auto const& file : files) {
+        auto usage_or_error = walker.walk(file);
+        if (usage_or_error.is_error()) {
+            warnln("du: cannot read '{}': {}", file, usage_or_error.error());
+            return 1;
+        }
+        out("{}", usage_or_error.value().output);
+    }
 
     return 0;
 }
@@ -135,28 +151,21 @@ ErrorOr<void> parse_args(Main::Arguments arguments, Vector<DeprecatedString>& fi
     return {};
 }
 
-ErrorOr<u64> print_space_usage(DeprecatedString const& path, DuOption const& du_option, size_t current_depth, bool inside_dir)
+ErrorOr<SpaceUsage> space_usage(Threading::TreeWalkerEntry const& entry, DuOption const& du_option, Vector<SpaceUsage> const& contents)
 {
     u64 size = 0;
-    struct stat path_stat = TRY(Core::System::lstat(path));
+    StringBuilder output;
+    struct stat path_stat = TRY(entry.stat());
     bool const is_directory = S_ISDIR(path_stat.st_mode);
-    if (is_directory) {
-        auto di = Core::DirIterator(path, Core::DirIterator::SkipParentAndBaseDir);
-        if (di.has_error()) {
-            outln("du: cannot read directory '{}': {}", path, di.error_string());
-            return Error::from_string_literal("An error occurred. See previous error.");
-        }
-
-        while (di.has_next()) {
-            auto const child_path = di.next_full_path();
-            size += TRY(print_space_usage(child_path, du_option, current_depth + 1, true));
-        }
+    for (auto const& usage : contents) {
+        size += usage.size;
+        output.append(usage.output);
     }
 
-    auto const basename = LexicalPath::basename(path);
+    auto const basename = LexicalPath::basename(entry.path);
     for (auto const& pattern : du_option.excluded_patterns) {
         if (basename.matches(pattern, CaseSensitivity::CaseSensitive))
-            return { 0 };
+            return SpaceUsage { 0, output.to_deprecated_string() };
     }
 
     if (!du_option.apparent_size) {
@@ -166,24 +175,24 @@ ErrorOr<u64> print_space_usage(DeprecatedString const& path, DuOption const& du_
         size += path_stat.st_size;
     }
 
-    bool is_beyond_depth = current_depth > du_option.max_depth;
-    bool is_inner_file = inside_dir && !is_directory;
+    bool is_beyond_depth = entry.depth > du_option.max_depth;
+    bool is_inner_file = entry.depth > 0 && !is_directory;
     bool is_outside_threshold = (du_option.threshold > 0 && size < static_cast<u64>(du_option.threshold)) || (du_option.threshold < 0 && size > static_cast<u64>(-du_option.threshold));
 
     // All of these still count towards the full size, they are just not reported on individually.
     if (is_beyond_depth || (is_inner_file && !du_option.all) || is_outside_threshold)
-        return size;
+        return SpaceUsage { size, output.to_deprecated_string() };
 
     if (du_option.human_readable) {
-        out("{}", human_readable_size(size));
+        output.append(human_readable_size(size));
     } else if (du_option.human_readable_si) {
-        out("{}", human_readable_size(size, AK::HumanReadableBasedOn::Base10));
+        output.append(human_readable_size(size, AK::HumanReadableBasedOn::Base10));
     } else {
-        out("{}", ceil_div(size, du_option.block_size));
+        output.appendff("{}", ceil_div(size, du_option.block_size));
     }
 
     if (du_option.time_type == DuOption::TimeType::NotUsed) {
-        outln("\t{}", path);
+        output.appendff("\t{}\n", entry.path);
     } else {
         auto time = path_stat.st_mtime;
         switch (du_option.time_type) {
@@ -198,8 +207,8 @@ ErrorOr<u64> print_space_usage(DeprecatedString const& path, DuOption const& du_
         }
 
         auto const formatted_time = Core::DateTime::from_timestamp(time).to_deprecated_string();
-        outln("\t{}\t{}", formatted_time, path);
+        output.appendff("\t{}\t{}\n", formatted_time, entry.path);
     }
 
-    return { size };
+    return SpaceUsage { size, output.to_deprecated_string() };
 }
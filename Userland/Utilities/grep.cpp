@@ -13,11 +13,13 @@
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
+#include <LibCore/MappedFile.h>
 #include <LibCore/Stream.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
 #include <LibRegex/Regex.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 
 enum class BinaryFileMode {
@@ -50,6 +52,31 @@ static DeprecatedString escape_characters(StringView string, StringView characte
     return builder.to_deprecated_string();
 }
 
+static Optional<size_t> find_byte(StringView haystack, char needle, size_t start)
+{
+    if (start >= haystack.length())
+        return {};
+    auto const* begin = haystack.characters_without_null_termination();
+    auto const* found = static_cast<char const*>(memchr(begin + start, needle, haystack.length() - start));
+    if (!found)
+        return {};
+    return static_cast<size_t>(found - begin);
+}
+
+// Note: libc's memchr() is vectorized, so skipping ahead to candidates for the first byte of the needle this way gets
+//       through the haystack a lot faster than looking at every position.
+static Optional<size_t> find_literal(StringView haystack, StringView needle, size_t start)
+{
+    VERIFY(!needle.is_empty());
+    for (auto candidate = find_byte(haystack, needle[0], start); candidate.has_value(); candidate = find_byte(haystack, needle[0], *candidate + 1)) {
+        if (haystack.length() - *candidate < needle.length())
+            return {};
+        if (memcmp(haystack.characters_without_null_termination() + *candidate, needle.characters_without_null_termination(), needle.length()) == 0)
+            return candidate;
+    }
+    return {};
+}
+
 ErrorOr<int> serenity_main(Main::Arguments args)
 {
     TRY(Core::System::pledge("stdio rpath"));
@@ -160,6 +187,14 @@ ErrorOr<int> serenity_main(Main::Arguments args)
     if (case_insensitive)
         options |= PosixFlags::Insensitive;
 
+    // A line can only match a fixed string if it contains it, so only the lines that contain one of them have to go
+    // through the regular expressions, and all others can be skipped over without looking at them line by line.
+    Vector<StringView> required_literals;
+    if (fixed_strings && !invert_match && !case_insensitive && all_of(patterns, [](auto const& pattern) { return !pattern.is_empty(); })) {
+        for (auto const& pattern : patterns)
+            required_literals.append(pattern);
+    }
+
     auto grep_logic = [&](auto&& regular_expressions) {
         for (auto& re : regular_expressions) {
             if (re.parser_result.error != regex::Error::NoError) {
@@ -213,21 +248,67 @@ ErrorOr<int> serenity_main(Main::Arguments args)
 
         bool did_match_something = false;
 
-        auto handle_file = [&matches, binary_mode, count_lines, quiet_mode,
-                               user_specified_multiple_files, &matched_line_count, &did_match_something](StringView filename, bool print_filename) -> ErrorOr<void> {
-            auto file = TRY(Core::Stream::File::open(filename, Core::Stream::OpenMode::Read));
-            auto buffered_file = TRY(Core::Stream::BufferedFile::create(move(file)));
+        // Returns whether to stop looking at the rest of the file.
+        auto handle_line = [&matches, binary_mode, &did_match_something](StringView line, StringView filename, size_t line_number, bool print_filename) {
+            auto is_binary = line.contains('\0');
 
-            for (size_t line_number = 1; TRY(buffered_file->can_read_line()); ++line_number) {
-                Array<u8, PAGE_SIZE> buffer;
-                auto line = TRY(buffered_file->read_line(buffer));
+            auto matched = matches(line, filename, line_number, print_filename, is_binary);
+            did_match_something = did_match_something || matched;
+            return matched && is_binary && binary_mode == BinaryFileMode::Binary;
+        };
 
-                auto is_binary = line.contains('\0');
+        auto handle_mapped_file = [&handle_line, &required_literals, line_numbers](StringView contents, StringView filename, bool print_filename) {
+            Vector<Optional<size_t>> next_literal_offsets;
+            next_literal_offsets.resize(required_literals.size());
+
+            size_t line_number = 1;
+            size_t position = 0;
+            while (position < contents.length()) {
+                if (!required_literals.is_empty()) {
+                    Optional<size_t> next_candidate;
+                    for (size_t i = 0; i < required_literals.size(); ++i) {
+                        auto& offset = next_literal_offsets[i];
+                        if (!offset.has_value() || *offset < position)
+                            offset = find_literal(contents, required_literals[i], position);
+                        if (offset.has_value() && (!next_candidate.has_value() || *offset < *next_candidate))
+                            next_candidate = offset;
+                    }
+                    if (!next_candidate.has_value())
+                        break;
+
+                    auto line_start = *next_candidate;
+                    while (line_start > position && contents[line_start - 1] != '\n')
+                        --line_start;
+                    if (line_numbers) {
+                        for (auto newline = find_byte(contents, '\n', position); newline.has_value() && *newline < line_start; newline = find_byte(contents, '\n', *newline + 1))
+                            ++line_number;
+                    }
+                    position = line_start;
+                }
 
-                auto matched = matches(line, filename, line_number, print_filename, is_binary);
-                did_match_something = did_match_something || matched;
-                if (matched && is_binary && binary_mode == BinaryFileMode::Binary)
+                auto line_end = find_byte(contents, '\n', position).value_or(contents.length());
+                if (handle_line(contents.substring_view(position, line_end - position), filename, line_number, print_filename))
                     break;
+                position = line_end + 1;
+                ++line_number;
+            }
+        };
+
+        auto handle_file = [&handle_line, &handle_mapped_file, count_lines, quiet_mode,
+                               user_specified_multiple_files, &matched_line_count](StringView filename, bool print_filename) -> ErrorOr<void> {
+            // Note: Files that can't be mapped (such as empty ones, or ones in /proc) are read line by line instead.
+            if (auto mapped_file = Core::MappedFile::map(filename); !mapped_file.is_error()) {
+                handle_mapped_file(StringView { mapped_file.value()->bytes() }, filename, print_filename);
+            } else {
+                auto file = TRY(Core::Stream::File::open(filename, Core::Stream::OpenMode::Read));
+                auto buffered_file = TRY(Core::Stream::BufferedFile::create(move(file)));
+
+                for (size_t line_number = 1; TRY(buffered_file->can_read_line()); ++line_number) {
+                    Array<u8, PAGE_SIZE> buffer;
+                    auto line = TRY(buffered_file->read_line(buffer));
+                    if (handle_line(line, filename, line_number, print_filename))
+                        break;
+                }
             }
 
             if (count_lines && !quiet_mode) {
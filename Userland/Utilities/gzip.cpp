@@ -17,17 +17,27 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     bool keep_input_files { false };
     bool write_to_stdout { false };
     bool decompress { false };
+    bool fast { false };
+    bool best { false };
 
     Core::ArgsParser args_parser;
     args_parser.add_option(keep_input_files, "Keep (don't delete) input files", "keep", 'k');
     args_parser.add_option(write_to_stdout, "Write to stdout, keep original files unchanged", "stdout", 'c');
     args_parser.add_option(decompress, "Decompress", "decompress", 'd');
+    args_parser.add_option(fast, "Compress faster, at the expense of compression ratio", "fast", '1');
+    args_parser.add_option(best, "Compress better, at the expense of speed", "best", '9');
     args_parser.add_positional_argument(filenames, "Files", "FILES");
     args_parser.parse(arguments);
 
     if (write_to_stdout)
         keep_input_files = true;
 
+    auto compression_level = Compress::DeflateCompressor::CompressionLevel::GOOD;
+    if (fast)
+        compression_level = Compress::DeflateCompressor::CompressionLevel::FAST;
+    else if (best)
+        compression_level = Compress::DeflateCompressor::CompressionLevel::GREAT;
+
     for (auto const& input_filename : filenames) {
         DeprecatedString output_filename;
         if (decompress) {
@@ -53,7 +63,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         if (decompress)
             output_bytes = TRY(Compress::GzipDecompressor::decompress_all(input_bytes));
         else
-            output_bytes = TRY(Compress::GzipCompressor::compress_all(input_bytes));
+            output_bytes = TRY(Compress::GzipCompressor::compress_all(input_bytes, compression_level, Compress::DeflateCompressor::UseThreadPool::Yes));
 
         auto output_stream = write_to_stdout ? TRY(Core::Stream::File::standard_output()) : TRY(Core::Stream::File::open(output_filename, Core::Stream::OpenMode::Write));
         TRY(output_stream->write_entire_buffer(output_bytes));
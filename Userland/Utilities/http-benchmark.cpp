@@ -0,0 +1,741 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/BuiltinWrappers.h>
+#include <AK/ByteBuffer.h>
+#include <AK/DeprecatedString.h>
+#include <AK/JsonObject.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NumberFormat.h>
+#include <AK/Queue.h>
+#include <AK/StringBuilder.h>
+#include <AK/Time.h>
+#include <AK/URL.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/EventLoop.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/Stream.h>
+#include <LibCore/System.h>
+#include <LibCore/Timer.h>
+#include <LibMain/Main.h>
+#include <LibTLS/TLSv12.h>
+#include <LibThreading/Thread.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// Records latencies (in microseconds) the way an HDR histogram does: Values are grouped by their highest set bit, and each
+// of those groups is split into 64 buckets of equal width. That keeps every value to within 1/64th of what was recorded,
+// no matter how large it is, and a few thousand buckets cover everything from a microsecond to several days.
+class LatencyHistogram {
+public:
+    void record(u64 value)
+    {
+        auto index = bucket_index_for(value);
+        if (index >= m_counts.size())
+            m_counts.resize(index + 1);
+        ++m_counts[index];
+        m_minimum = m_count == 0 ? value : min(m_minimum, value);
+        m_maximum = max(m_maximum, value);
+        m_sum += value;
+        ++m_count;
+    }
+
+    void merge(LatencyHistogram const& other)
+    {
+        if (other.m_count == 0)
+            return;
+        if (other.m_counts.size() > m_counts.size())
+            m_counts.resize(other.m_counts.size());
+        for (size_t i = 0; i < other.m_counts.size(); ++i)
+            m_counts[i] += other.m_counts[i];
+        m_minimum = m_count == 0 ? other.m_minimum : min(m_minimum, other.m_minimum);
+        m_maximum = max(m_maximum, other.m_maximum);
+        m_sum += other.m_sum;
+        m_count += other.m_count;
+    }
+
+    u64 count() const { return m_count; }
+    u64 minimum() const { return m_minimum; }
+    u64 maximum() const { return m_maximum; }
+    double mean() const { return m_count == 0 ? 0 : static_cast<double>(m_sum) / m_count; }
+
+    u64 value_at_percentile(double percentile) const
+    {
+        if (m_count == 0)
+            return 0;
+        auto rank = max<u64>(1, static_cast<u64>(ceil(percentile / 100 * m_count)));
+        u64 seen = 0;
+        for (size_t i = 0; i < m_counts.size(); ++i) {
+            seen += m_counts[i];
+            if (seen >= rank)
+                return min(highest_value_in_bucket(i), m_maximum);
+        }
+        return m_maximum;
+    }
+
+private:
+    static constexpr size_t sub_bucket_count = 128;
+    static constexpr size_t sub_bucket_half_count = sub_bucket_count / 2;
+
+    static size_t bucket_index_for(u64 value)
+    {
+        if (value < sub_bucket_count)
+            return value;
+        // Shift the value right until it has 7 significant bits left, i.e. lands in the upper half of the sub-buckets.
+        size_t shift = (sizeof(u64) * 8 - 1 - count_leading_zeroes(value)) - 6;
+        return shift * sub_bucket_half_count + (value >> shift);
+    }
+
+    static u64 highest_value_in_bucket(size_t index)
+    {
+        if (index < sub_bucket_count)
+            return index;
+        size_t shift = index / sub_bucket_half_count - 1;
+        u64 sub_bucket = index - shift * sub_bucket_half_count;
+        return ((sub_bucket + 1) << shift) - 1;
+    }
+
+    Vector<u64> m_counts;
+    u64 m_count { 0 };
+    u64 m_sum { 0 };
+    u64 m_minimum { 0 };
+    u64 m_maximum { 0 };
+};
+
+struct Statistics {
+    LatencyHistogram latencies;
+    u64 bytes_received { 0 };
+    u64 unsuccessful_responses { 0 };
+    u64 connections_opened { 0 };
+    u64 connect_errors { 0 };
+    u64 read_errors { 0 };
+    u64 write_errors { 0 };
+    DeprecatedString last_error;
+
+    u64 error_count() const { return connect_errors + read_errors + write_errors; }
+
+    void merge(Statistics const& other)
+    {
+        latencies.merge(other.latencies);
+        bytes_received += other.bytes_received;
+        unsuccessful_responses += other.unsuccessful_responses;
+        connections_opened += other.connections_opened;
+        connect_errors += other.connect_errors;
+        read_errors += other.read_errors;
+        write_errors += other.write_errors;
+        if (!other.last_error.is_empty())
+            last_error = other.last_error;
+    }
+};
+
+struct Target {
+    DeprecatedString host;
+    sockaddr_in address {};
+    bool use_tls { false };
+    bool validate_certificates { true };
+    bool expects_response_body { true };
+    bool keep_alive { true };
+    size_t pipeline_depth { 1 };
+    ByteBuffer request;
+};
+
+// Sends the same request over and over on one connection, keeping up to `pipeline_depth` of them in flight, and records
+// how long each one took from being sent until its response had fully arrived. If the connection is closed (by either
+// side, or because of an error) a new one is made in its place.
+class Connection {
+public:
+    Connection(Target const& target, Statistics& statistics)
+        : m_target(target)
+        , m_statistics(statistics)
+        , m_retry_timer(MUST(Core::Timer::create_single_shot(connect_retry_delay_ms, [this] { connect(); })))
+        , m_read_buffer(MUST(ByteBuffer::create_uninitialized(64 * KiB)))
+    {
+    }
+
+    ~Connection()
+    {
+        if (m_fd >= 0)
+            (void)Core::System::close(m_fd);
+    }
+
+    void connect();
+
+private:
+    static constexpr int connect_retry_delay_ms = 100;
+    static constexpr size_t maximum_header_size = 64 * KiB;
+
+    enum class State {
+        Disconnected,
+        Connecting,
+        Headers,
+        Body,
+        BodyUntilClose,
+        ChunkSize,
+        ChunkData,
+        Trailers,
+    };
+
+    ErrorOr<void> start_connecting();
+    ErrorOr<void> did_connect();
+    ErrorOr<void> start_tls_handshake(NonnullOwnPtr<Core::Stream::Socket>);
+    void did_establish_connection();
+    void send_requests();
+    void read_responses();
+    ErrorOr<void> process_received_data(ReadonlyBytes);
+    ErrorOr<void> process_line(StringView);
+    ErrorOr<void> process_response_header(StringView);
+    void did_receive_response();
+    void did_close();
+    void did_fail(u64& error_count, Error const&);
+    void disconnect(bool retry_later = false);
+
+    Target const& m_target;
+    Statistics& m_statistics;
+    State m_state { State::Disconnected };
+    u64 m_generation { 0 };
+
+    int m_fd { -1 };
+    RefPtr<Core::Notifier> m_connect_notifier;
+    NonnullRefPtr<Core::Timer> m_retry_timer;
+    OwnPtr<Core::Stream::Socket> m_socket;
+    Optional<TLS::SessionState> m_tls_session;
+
+    Queue<Time> m_request_send_times;
+    ByteBuffer m_read_buffer;
+    ByteBuffer m_line_buffer;
+    unsigned m_status_code { 0 };
+    bool m_close_after_response { false };
+    u64 m_remaining_body_size { 0 };
+};
+
+void Connection::connect()
+{
+    m_socket = nullptr;
+    m_connect_notifier = nullptr;
+    if (m_fd >= 0)
+        (void)Core::System::close(exchange(m_fd, -1));
+    m_request_send_times.clear();
+    m_line_buffer.clear();
+    m_state = State::Connecting;
+
+    if (auto result = start_connecting(); result.is_error())
+        did_fail(m_statistics.connect_errors, result.error());
+}
+
+ErrorOr<void> Connection::start_connecting()
+{
+    m_fd = TRY(Core::System::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+    if (auto result = Core::System::connect(m_fd, bit_cast<sockaddr const*>(&m_target.address), sizeof(m_target.address)); !result.is_error())
+        return did_connect();
+    else if (!result.error().is_errno() || result.error().code() != EINPROGRESS)
+        return result.release_error();
+
+    m_connect_notifier = Core::Notifier::construct(m_fd, Core::Notifier::Write);
+    m_connect_notifier->on_ready_to_write = [this] {
+        // Note: The notifier can't be destroyed from within its own callback, so it's kept around until the next connection.
+        m_connect_notifier->set_enabled(false);
+        auto result = [&]() -> ErrorOr<void> {
+            int error = 0;
+            socklen_t error_size = sizeof(error);
+            TRY(Core::System::getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &error, &error_size));
+            if (error != 0)
+                return Error::from_errno(error);
+            return did_connect();
+        }();
+        if (result.is_error())
+            did_fail(m_statistics.connect_errors, result.error());
+    };
+    return {};
+}
+
+ErrorOr<void> Connection::did_connect()
+{
+    auto fd = exchange(m_fd, -1);
+    auto socket_or_error = Core::Stream::TCPSocket::adopt_fd(fd);
+    if (socket_or_error.is_error()) {
+        (void)Core::System::close(fd);
+        return socket_or_error.release_error();
+    }
+    auto socket = socket_or_error.release_value();
+    ++m_statistics.connections_opened;
+
+    if (m_target.use_tls)
+        return start_tls_handshake(move(socket));
+
+    // Note: We only ever read what's there, so it's only writes that can block, and requests are small.
+    TRY(socket->set_blocking(true));
+    m_socket = move(socket);
+    did_establish_connection();
+    return {};
+}
+
+ErrorOr<void> Connection::start_tls_handshake(NonnullOwnPtr<Core::Stream::Socket> tcp_socket)
+{
+    TLS::Options options;
+    options.set_validate_certificates(m_target.validate_certificates)
+        .set_alpn_protocols({ "http/1.1" })
+        .set_session_to_resume(m_tls_session)
+        .set_session_handler([this](TLS::SessionState const& session) { m_tls_session = session; });
+
+    TRY(tcp_socket->set_blocking(false));
+    auto tls_socket = make<TLS::TLSv12>(OwnPtr<Core::Stream::Socket>(move(tcp_socket)), move(options));
+    tls_socket->set_sni(m_target.host);
+
+    // Note: Both of these are called from within the socket, so anything that could destroy it has to wait until they return.
+    tls_socket->on_connected = [this, generation = m_generation] {
+        Core::deferred_invoke([this, generation] {
+            if (generation == m_generation && m_state == State::Connecting)
+                did_establish_connection();
+        });
+    };
+    tls_socket->on_tls_error = [this, generation = m_generation](TLS::AlertDescription alert) {
+        Core::deferred_invoke([this, generation, alert] {
+            if (generation != m_generation)
+                return;
+            auto error = Error::from_string_view(TLS::alert_name(alert));
+            did_fail(m_state == State::Connecting ? m_statistics.connect_errors : m_statistics.read_errors, error);
+        });
+    };
+    tls_socket->on_tls_finished = [this, generation = m_generation] {
+        Core::deferred_invoke([this, generation] {
+            if (generation == m_generation)
+                did_close();
+        });
+    };
+    m_socket = move(tls_socket);
+    return {};
+}
+
+void Connection::did_establish_connection()
+{
+    m_socket->on_ready_to_read = [this] { read_responses(); };
+    m_state = State::Headers;
+    send_requests();
+}
+
+void Connection::send_requests()
+{
+    auto count = m_target.pipeline_depth - m_request_send_times.size();
+    if (count == 0)
+        return;
+
+    auto result = [&]() -> ErrorOr<void> {
+        ByteBuffer requests;
+        for (size_t i = 0; i < count; ++i)
+            TRY(requests.try_append(m_target.request));
+        auto now = Time::now_monotonic();
+        TRY(m_socket->write_entire_buffer(requests));
+        for (size_t i = 0; i < count; ++i)
+            m_request_send_times.enqueue(now);
+        return {};
+    }();
+    if (result.is_error())
+        did_fail(m_statistics.write_errors, result.error());
+}
+
+void Connection::read_responses()
+{
+    auto result = [&]() -> ErrorOr<void> {
+        while (m_state != State::Disconnected && TRY(m_socket->can_read_without_blocking())) {
+            auto bytes = TRY(m_socket->read(m_read_buffer));
+            if (bytes.is_empty())
+                break;
+            m_statistics.bytes_received += bytes.size();
+            TRY(process_received_data(bytes));
+        }
+        return {};
+    }();
+    if (result.is_error())
+        return did_fail(m_statistics.read_errors, result.error());
+    if (m_state != State::Disconnected && m_socket->is_eof())
+        did_close();
+}
+
+ErrorOr<void> Connection::process_received_data(ReadonlyBytes data)
+{
+    while (!data.is_empty()) {
+        switch (m_state) {
+        case State::Disconnected:
+        case State::Connecting:
+        case State::BodyUntilClose:
+            return {};
+        case State::Body:
+        case State::ChunkData: {
+            auto size = min<u64>(m_remaining_body_size, data.size());
+            data = data.slice(size);
+            m_remaining_body_size -= size;
+            if (m_remaining_body_size == 0) {
+                if (m_state == State::Body)
+                    did_receive_response();
+                else
+                    m_state = State::ChunkSize;
+            }
+            break;
+        }
+        case State::Headers:
+        case State::ChunkSize:
+        case State::Trailers: {
+            // These are made of lines, which can arrive in pieces.
+            auto terminator = m_state == State::Headers ? "\r\n\r\n"sv : "\r\n"sv;
+            auto previous_size = m_line_buffer.size();
+            TRY(m_line_buffer.try_append(data));
+            auto search_start = previous_size >= terminator.length() ? previous_size - terminator.length() + 1 : 0;
+            auto end = StringView { m_line_buffer }.find(terminator, search_start);
+            if (!end.has_value()) {
+                if (m_line_buffer.size() > maximum_header_size)
+                    return Error::from_string_literal("Response header is too large");
+                return {};
+            }
+            data = data.slice(*end + terminator.length() - previous_size);
+            TRY(process_line(StringView { m_line_buffer.bytes().trim(*end) }));
+            m_line_buffer.clear();
+            break;
+        }
+        }
+    }
+    return {};
+}
+
+ErrorOr<void> Connection::process_line(StringView line)
+{
+    switch (m_state) {
+    case State::Headers:
+        return process_response_header(line);
+    case State::ChunkSize: {
+        auto size_text = line;
+        if (auto extensions_start = size_text.find(';'); extensions_start.has_value())
+            size_text = size_text.substring_view(0, *extensions_start);
+        auto size = AK::StringUtils::convert_to_uint_from_hex<u64>(size_text);
+        if (!size.has_value())
+            return Error::from_string_literal("Invalid chunk size");
+        if (*size == 0) {
+            m_state = State::Trailers;
+        } else {
+            // Note: The line break that ends the chunk is skipped along with its data.
+            m_remaining_body_size = *size + 2;
+            m_state = State::ChunkData;
+        }
+        return {};
+    }
+    case State::Trailers:
+        if (line.is_empty())
+            did_receive_response();
+        return {};
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+ErrorOr<void> Connection::process_response_header(StringView header)
+{
+    if (m_request_send_times.is_empty())
+        return Error::from_string_literal("Received a response that wasn't requested");
+
+    auto lines = header.split_view("\r\n"sv);
+    auto status_line = lines.take_first().split_view(' ');
+    if (status_line.size() < 2 || !status_line[0].starts_with("HTTP/1."sv))
+        return Error::from_string_literal("Invalid status line");
+    auto status_code = status_line[1].to_uint();
+    if (!status_code.has_value())
+        return Error::from_string_literal("Invalid status code");
+    m_status_code = *status_code;
+
+    // Interim responses are followed by the actual one.
+    if (m_status_code >= 100 && m_status_code < 200 && m_status_code != 101)
+        return {};
+
+    Optional<u64> content_length;
+    bool is_chunked = false;
+    m_close_after_response = status_line[0] == "HTTP/1.0"sv;
+    for (auto line : lines) {
+        auto colon = line.find(':');
+        if (!colon.has_value())
+            continue;
+        auto name = line.substring_view(0, *colon);
+        auto value = line.substring_view(*colon + 1).trim_whitespace();
+        if (name.equals_ignoring_case("Content-Length"sv))
+            content_length = value.to_uint<u64>();
+        else if (name.equals_ignoring_case("Transfer-Encoding"sv))
+            is_chunked = value.contains("chunked"sv, CaseSensitivity::CaseInsensitive);
+        else if (name.equals_ignoring_case("Connection"sv) && value.contains("close"sv, CaseSensitivity::CaseInsensitive))
+            m_close_after_response = true;
+        else if (name.equals_ignoring_case("Connection"sv) && value.contains("keep-alive"sv, CaseSensitivity::CaseInsensitive))
+            m_close_after_response = false;
+    }
+
+    if (!m_target.expects_response_body || m_status_code == 204 || m_status_code == 304) {
+        did_receive_response();
+    } else if (is_chunked) {
+        m_state = State::ChunkSize;
+    } else if (content_length.has_value()) {
+        m_remaining_body_size = *content_length;
+        m_state = State::Body;
+        if (m_remaining_body_size == 0)
+            did_receive_response();
+    } else {
+        m_close_after_response = true;
+        m_state = State::BodyUntilClose;
+    }
+    return {};
+}
+
+void Connection::did_receive_response()
+{
+    auto latency = Time::now_monotonic() - m_request_send_times.dequeue();
+    m_statistics.latencies.record(latency.to_microseconds());
+    if (m_status_code < 200 || m_status_code >= 400)
+        ++m_statistics.unsuccessful_responses;
+
+    m_state = State::Headers;
+    if (m_close_after_response || !m_target.keep_alive)
+        return disconnect();
+    send_requests();
+}
+
+void Connection::did_close()
+{
+    if (m_state == State::Disconnected)
+        return;
+    if (m_state == State::BodyUntilClose)
+        return did_receive_response();
+    // Servers are free to close idle connections, but not ones that still owe us responses.
+    if (!m_request_send_times.is_empty())
+        return did_fail(m_statistics.read_errors, Error::from_string_literal("Connection closed before all responses arrived"));
+    disconnect();
+}
+
+void Connection::did_fail(u64& error_count, Error const& error)
+{
+    if (m_state == State::Disconnected)
+        return;
+    ++error_count;
+    m_statistics.last_error = DeprecatedString::formatted("{}", error);
+    // Don't hammer a server that's refusing connections.
+    disconnect(&error_count == &m_statistics.connect_errors);
+}
+
+void Connection::disconnect(bool retry_later)
+{
+    if (m_state == State::Disconnected)
+        return;
+    m_state = State::Disconnected;
+    ++m_generation;
+
+    // Note: We might have been called from one of the socket's callbacks, so it has to be replaced later.
+    if (retry_later)
+        m_retry_timer->start();
+    else
+        Core::deferred_invoke([this] { connect(); });
+}
+
+static Statistics run_connections(Target const& target, size_t connection_count, Time duration)
+{
+    Core::EventLoop loop;
+    Statistics statistics;
+
+    Vector<NonnullOwnPtr<Connection>> connections;
+    for (size_t i = 0; i < connection_count; ++i) {
+        auto connection = make<Connection>(target, statistics);
+        connection->connect();
+        connections.append(move(connection));
+    }
+
+    auto stop_timer = MUST(Core::Timer::create_single_shot(duration.to_milliseconds(), [&] { loop.quit(0); }));
+    stop_timer->start();
+    loop.exec();
+
+    // Note: The connections have to be gone before the event loop is.
+    connections.clear();
+    return statistics;
+}
+
+static DeprecatedString format_latency(u64 microseconds)
+{
+    if (microseconds < 1000)
+        return DeprecatedString::formatted("{}us", microseconds);
+    return DeprecatedString::formatted("{:.2}ms", microseconds / 1000.0);
+}
+
+struct Percentile {
+    StringView name;
+    double value;
+};
+
+static constexpr Array percentiles = {
+    Percentile { "50"sv, 50 },
+    Percentile { "75"sv, 75 },
+    Percentile { "90"sv, 90 },
+    Percentile { "99"sv, 99 },
+    Percentile { "99.9"sv, 99.9 },
+    Percentile { "99.99"sv, 99.99 },
+    Percentile { "100"sv, 100 },
+};
+
+static void print_report(Statistics const& statistics, double elapsed_seconds)
+{
+    auto& latencies = statistics.latencies;
+    outln("{} requests in {:.2}s, {} received, over {} connection(s)", latencies.count(), elapsed_seconds, human_readable_size(statistics.bytes_received), statistics.connections_opened);
+    outln("Requests/s: {:.2}", latencies.count() / elapsed_seconds);
+    outln("Transfer/s: {}", human_readable_size(static_cast<u64>(statistics.bytes_received / elapsed_seconds)));
+    outln("Latency: min {}, mean {}, max {}", format_latency(latencies.minimum()), format_latency(static_cast<u64>(latencies.mean())), format_latency(latencies.maximum()));
+    for (auto& percentile : percentiles)
+        outln("  {:>6}% {}", percentile.name, format_latency(latencies.value_at_percentile(percentile.value)));
+    if (statistics.unsuccessful_responses > 0)
+        outln("Responses with a status other than 2xx or 3xx: {}", statistics.unsuccessful_responses);
+    if (statistics.error_count() > 0)
+        outln("Errors: {} connect, {} read, {} write (last: {})", statistics.connect_errors, statistics.read_errors, statistics.write_errors, statistics.last_error);
+}
+
+static void print_json_report(Statistics const& statistics, double elapsed_seconds)
+{
+    auto& latencies = statistics.latencies;
+    JsonObject latency;
+    latency.set("min_us", latencies.minimum());
+    latency.set("mean_us", latencies.mean());
+    latency.set("max_us", latencies.maximum());
+    for (auto& percentile : percentiles)
+        latency.set(DeprecatedString::formatted("p{}_us", percentile.name), latencies.value_at_percentile(percentile.value));
+
+    JsonObject report;
+    report.set("requests", latencies.count());
+    report.set("seconds", elapsed_seconds);
+    report.set("requests_per_second", latencies.count() / elapsed_seconds);
+    report.set("bytes_received", statistics.bytes_received);
+    report.set("connections_opened", statistics.connections_opened);
+    report.set("unsuccessful_responses", statistics.unsuccessful_responses);
+    report.set("connect_errors", statistics.connect_errors);
+    report.set("read_errors", statistics.read_errors);
+    report.set("write_errors", statistics.write_errors);
+    report.set("latency", move(latency));
+    outln("{}", report.to_deprecated_string());
+}
+
+ErrorOr<int> serenity_main(Main::Arguments arguments)
+{
+    TRY(Core::System::pledge("stdio inet unix rpath thread"));
+
+    StringView url_string;
+    size_t connection_count = 10;
+    size_t thread_count = 1;
+    size_t duration_seconds = 10;
+    size_t pipeline_depth = 1;
+    DeprecatedString method = "GET";
+    Vector<DeprecatedString> headers;
+    bool no_keep_alive = false;
+    bool insecure = false;
+    bool json = false;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Load an HTTP server with requests, and report its throughput and latencies.");
+    args_parser.add_option(connection_count, "Number of connections to keep open (default: 10)", "connections", 'c', "count");
+    args_parser.add_option(thread_count, "Number of threads to spread the connections over (default: 1)", "threads", 't', "count");
+    args_parser.add_option(duration_seconds, "How long to run for, in seconds (default: 10)", "duration", 'd', "seconds");
+    args_parser.add_option(pipeline_depth, "Number of requests to have in flight on each connection (default: 1)", "pipeline", 'p', "count");
+    args_parser.add_option(method, "Request method (default: GET)", "method", 'm', "method");
+    args_parser.add_option(Core::ArgsParser::Option {
+        .argument_mode = Core::ArgsParser::OptionArgumentMode::Required,
+        .help_string = "Add a header entry to the requests",
+        .long_name = "header",
+        .short_name = 'H',
+        .value_name = "key:value",
+        .accept_value = [&](auto* s) {
+            StringView header { s, strlen(s) };
+            if (!header.contains(':'))
+                return false;
+            headers.append(header);
+            return true;
+        } });
+    args_parser.add_option(no_keep_alive, "Make a new connection for every request", "no-keep-alive", 0);
+    args_parser.add_option(insecure, "Don't validate TLS certificates", "insecure", 'k');
+    args_parser.add_option(json, "Print the results as JSON", "json", 'j');
+    args_parser.add_positional_argument(url_string, "URL to request", "url");
+    args_parser.parse(arguments);
+
+    URL url(url_string);
+    if (!url.is_valid() || (url.scheme() != "http"sv && url.scheme() != "https"sv)) {
+        warnln("'{}' is not a valid http or https URL", url_string);
+        return 1;
+    }
+    if (connection_count == 0 || thread_count == 0 || duration_seconds == 0 || pipeline_depth == 0) {
+        warnln("The number of connections, threads and requests in flight, and the duration, all have to be at least 1");
+        return 1;
+    }
+    if (no_keep_alive && pipeline_depth > 1) {
+        warnln("Requests can't be pipelined without keep-alive");
+        return 1;
+    }
+    thread_count = min(thread_count, connection_count);
+
+    Target target;
+    target.host = url.host();
+    target.use_tls = url.scheme() == "https"sv;
+    target.validate_certificates = !insecure;
+    target.expects_response_body = method != "HEAD"sv;
+    target.keep_alive = !no_keep_alive;
+    target.pipeline_depth = pipeline_depth;
+
+    struct addrinfo hints {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    auto port = DeprecatedString::number(url.port_or_default());
+    auto addresses = TRY(Core::System::getaddrinfo(target.host.characters(), port.characters(), hints));
+    if (addresses.addresses().is_empty()) {
+        warnln("Unable to resolve '{}'", target.host);
+        return 1;
+    }
+    memcpy(&target.address, addresses.addresses()[0].ai_addr, sizeof(target.address));
+
+    StringBuilder request_builder;
+    request_builder.appendff("{} {}", method, URL::percent_encode(url.path(), URL::PercentEncodeSet::EncodeURI));
+    if (!url.query().is_empty())
+        request_builder.appendff("?{}", url.query());
+    request_builder.append(" HTTP/1.1\r\n"sv);
+    if (url.port().has_value())
+        request_builder.appendff("Host: {}:{}\r\n", url.host(), *url.port());
+    else
+        request_builder.appendff("Host: {}\r\n", url.host());
+    for (auto& header : headers)
+        request_builder.appendff("{}\r\n", header);
+    if (no_keep_alive)
+        request_builder.append("Connection: close\r\n"sv);
+    request_builder.append("\r\n"sv);
+    target.request = request_builder.to_byte_buffer();
+
+    if (!json)
+        outln("Running for {}s against {} with {} connection(s) on {} thread(s), {} request(s) in flight on each", duration_seconds, url, connection_count, thread_count, pipeline_depth);
+
+    auto duration = Time::from_seconds(duration_seconds);
+    Vector<Statistics> results;
+    results.resize(thread_count);
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    auto start_time = Time::now_monotonic();
+    for (size_t i = 0; i < thread_count; ++i) {
+        auto connections_for_thread = connection_count / thread_count + (i < connection_count % thread_count ? 1 : 0);
+        auto thread = Threading::Thread::construct([&, i, connections_for_thread]() -> intptr_t {
+            results[i] = run_connections(target, connections_for_thread, duration);
+            return 0;
+        },
+            "http-benchmark"sv);
+        thread->start();
+        threads.append(move(thread));
+    }
+    for (auto& thread : threads)
+        (void)thread->join();
+    auto elapsed_seconds = (Time::now_monotonic() - start_time).to_microseconds() / 1'000'000.0;
+
+    Statistics statistics;
+    for (auto& result : results)
+        statistics.merge(result);
+
+    if (json)
+        print_json_report(statistics, elapsed_seconds);
+    else
+        print_report(statistics, elapsed_seconds);
+    return 0;
+}
@@ -602,9 +602,10 @@ private:
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
-    TRY(Core::System::pledge("stdio rpath wpath cpath tty sigaction"));
+    TRY(Core::System::pledge("stdio rpath wpath cpath tty sigaction prot_exec"));
 
     bool gc_on_every_allocation = false;
+    bool disable_jit = false;
     bool disable_syntax_highlight = false;
     StringView evaluate_script;
     Vector<StringView> script_paths;
@@ -615,6 +616,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(JS::Bytecode::g_dump_bytecode, "Dump the bytecode", "dump-bytecode", 'd');
     args_parser.add_option(s_run_bytecode, "Run the bytecode", "run-bytecode", 'b');
     args_parser.add_option(s_opt_bytecode, "Optimize the bytecode", "optimize-bytecode", 'p');
+    args_parser.add_option(disable_jit, "Don't compile hot bytecode to native code", "no-jit", 0);
     args_parser.add_option(s_as_module, "Treat as module", "as-module", 'm');
     args_parser.add_option(s_print_last_result, "Print last result", "print-last-result", 'l');
     args_parser.add_option(s_strip_ansi, "Disable ANSI colors", "disable-ansi-colors", 'i');
@@ -626,6 +628,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.parse(arguments);
 
     bool syntax_highlight = !disable_syntax_highlight;
+    JS::Bytecode::g_jit_enabled = !disable_jit;
 
     g_vm = JS::VM::create();
     g_vm->enable_default_host_import_module_dynamically_hook();
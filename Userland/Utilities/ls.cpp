@@ -393,7 +393,7 @@ static int do_file_system_object_long(char const* path)
     if (flag_show_almost_all_dotfiles)
         flags = Core::DirIterator::SkipParentAndBaseDir;
 
-    Core::DirIterator di(path, flags);
+    Core::DirIterator di(path, static_cast<Core::DirIterator::Flags>(flags | Core::DirIterator::StatEntries));
 
     if (di.has_error()) {
         if (di.error() == ENOTDIR) {
@@ -425,9 +425,13 @@ static int do_file_system_object_long(char const* path)
         builder.append(metadata.name);
         metadata.path = builder.to_deprecated_string();
         VERIFY(!metadata.path.is_null());
-        int rc = lstat(metadata.path.characters(), &metadata.stat);
-        if (rc < 0)
-            perror("lstat");
+        if (auto const& stat = di.current_stat(); stat.has_value()) {
+            metadata.stat = *stat;
+        } else {
+            int rc = lstat(metadata.path.characters(), &metadata.stat);
+            if (rc < 0)
+                perror("lstat");
+        }
 
         files.append(move(metadata));
     }
@@ -508,7 +512,7 @@ int do_file_system_object_short(char const* path)
     if (flag_show_almost_all_dotfiles)
         flags = Core::DirIterator::SkipParentAndBaseDir;
 
-    Core::DirIterator di(path, flags);
+    Core::DirIterator di(path, static_cast<Core::DirIterator::Flags>(flags | Core::DirIterator::StatEntries));
     if (di.has_error()) {
         if (di.error() == ENOTDIR) {
             size_t nprinted = 0;
@@ -537,9 +541,13 @@ int do_file_system_object_short(char const* path)
         builder.append(metadata.name);
         metadata.path = builder.to_deprecated_string();
         VERIFY(!metadata.path.is_null());
-        int rc = lstat(metadata.path.characters(), &metadata.stat);
-        if (rc < 0)
-            perror("lstat");
+        if (auto const& stat = di.current_stat(); stat.has_value()) {
+            metadata.stat = *stat;
+        } else {
+            int rc = lstat(metadata.path.characters(), &metadata.stat);
+            if (rc < 0)
+                perror("lstat");
+        }
 
         files.append(metadata);
         if (metadata.name.length() > longest_name)
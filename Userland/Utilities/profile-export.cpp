@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Checked.h>
+#include <AK/HashMap.h>
+#include <AK/JsonArray.h>
+#include <AK/JsonObject.h>
+#include <AK/StringBuilder.h>
+#include <AK/Time.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ProcessStatisticsReader.h>
+#include <LibCore/Stream.h>
+#include <LibCore/System.h>
+#include <LibMain/Main.h>
+#include <LibSymbolication/Symbolication.h>
+#include <unistd.h>
+
+static constexpr auto enable_variable_path = "/sys/kernel/variables/continuous_profiling"sv;
+static constexpr auto samples_path = "/sys/kernel/profile_samples"sv;
+
+static volatile bool s_interrupted = false;
+
+struct Region {
+    FlatPtr base { 0 };
+    size_t size { 0 };
+    DeprecatedString path;
+};
+
+struct ProcessInfo {
+    DeprecatedString name;
+    Vector<Region> regions;
+};
+
+static HashMap<pid_t, ProcessInfo> s_processes;
+
+static void handle_sigint(int)
+{
+    s_interrupted = true;
+}
+
+static ErrorOr<void> write_enable_variable(bool enabled)
+{
+    auto file = TRY(Core::Stream::File::open(enable_variable_path, Core::Stream::OpenMode::Write));
+    TRY(file->write_entire_buffer((enabled ? "1"sv : "0"sv).bytes()));
+    return {};
+}
+
+static ErrorOr<bool> read_enable_variable()
+{
+    auto file = TRY(Core::Stream::File::open(enable_variable_path, Core::Stream::OpenMode::Read));
+    auto contents = TRY(file->read_until_eof());
+    return StringView { contents }.trim_whitespace() == "1"sv;
+}
+
+// Takes a snapshot of the process name and the executable mappings, the same way `bt` does it.
+// Addresses from processes that have exited before we got to look at them can't be symbolicated.
+static ProcessInfo const& process_info(pid_t pid)
+{
+    if (auto it = s_processes.find(pid); it != s_processes.end())
+        return it->value;
+
+    ProcessInfo info;
+    info.name = DeprecatedString::formatted("[{}]", pid);
+    if (auto all_processes = Core::ProcessStatisticsReader::get_all(false); !all_processes.is_error()) {
+        for (auto& process : all_processes.value().processes) {
+            if (process.pid == pid) {
+                info.name = process.name;
+                break;
+            }
+        }
+    }
+
+    if (auto maybe_kernel_base = Symbolication::kernel_base(); maybe_kernel_base.has_value())
+        info.regions.append({ maybe_kernel_base.value(), 0x3fffffff, "/boot/Kernel.debug" });
+
+    auto read_regions = [&]() -> ErrorOr<void> {
+        auto file = TRY(Core::Stream::File::open(DeprecatedString::formatted("/proc/{}/vm", pid), Core::Stream::OpenMode::Read));
+        auto json = TRY(JsonValue::from_string(TRY(file->read_until_eof())));
+        if (!json.is_array())
+            return {};
+        for (auto& region_value : json.as_array().values()) {
+            auto& region = region_value.as_object();
+            auto name = region.get_deprecated_string("name"sv).value_or({});
+            DeprecatedString path;
+            if (name == "/usr/lib/Loader.so")
+                path = name;
+            else if (name.ends_with(": .text"sv) || name.ends_with(": .rodata"sv))
+                path = name.split_view(':')[0];
+            else
+                continue;
+            info.regions.append({ region.get_addr("address"sv).value_or(0), region.get_addr("size"sv).value_or(0), move(path) });
+        }
+        return {};
+    };
+    (void)read_regions();
+
+    return s_processes.ensure(pid, [&] { return move(info); });
+}
+
+static DeprecatedString symbolicate(ProcessInfo const& process, FlatPtr address, bool is_first_frame, DeprecatedString& object)
+{
+    Region const* found_region = nullptr;
+    for (auto& region : process.regions) {
+        auto region_end = Checked<FlatPtr>::addition_would_overflow(region.base, region.size) ? NumericLimits<FlatPtr>::max() : region.base + region.size;
+        if (address >= region.base && address < region_end) {
+            found_region = &region;
+            break;
+        }
+    }
+    if (!found_region) {
+        object = "[unknown]";
+        return "[unknown]";
+    }
+
+    // The lowest mapping of an image is not necessarily its .text, so look for the real base of the image.
+    Region const* base_region = found_region;
+    for (auto& region : process.regions) {
+        if (region.path == found_region->path && region.base < base_region->base)
+            base_region = &region;
+    }
+
+    // All frames except the first one are return addresses, which point one instruction past the call.
+    auto adjusted_address = address - base_region->base - (is_first_frame ? 0 : 1);
+    auto symbol = Symbolication::symbolicate(found_region->path, adjusted_address, Symbolication::IncludeSourcePosition::No);
+    object = found_region->path;
+    if (!symbol.has_value() || symbol->name.is_empty())
+        return "[unknown]";
+    return DeprecatedString::formatted("{}+{:#x}", symbol->name, symbol->offset);
+}
+
+ErrorOr<int> serenity_main(Main::Arguments arguments)
+{
+    StringView format = "perf-script"sv;
+    int duration_seconds = 0;
+    int interval_ms = 250;
+    pid_t pid_filter = -1;
+    pid_t tid_filter = -1;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Continuously sample all CPUs and write the samples as perf-script or folded stacks.");
+    args_parser.add_option(format, "Output format: perf-script (default) or folded", "format", 'f', "format");
+    args_parser.add_option(duration_seconds, "Stop after this many seconds (default: until interrupted)", "duration", 'd', "seconds");
+    args_parser.add_option(interval_ms, "Time between reads of the sample rings (default: 250)", "interval", 'i', "milliseconds");
+    args_parser.add_option(pid_filter, "Only export samples of this process", "pid", 'p', "pid");
+    args_parser.add_option(tid_filter, "Only export samples of this thread", "tid", 't', "tid");
+    args_parser.parse(arguments);
+
+    bool folded = false;
+    if (format == "folded"sv) {
+        folded = true;
+    } else if (format != "perf-script"sv) {
+        warnln("Unknown output format '{}'", format);
+        return 1;
+    }
+
+    TRY(Core::System::signal(SIGINT, handle_sigint));
+
+    bool was_enabled = TRY(read_enable_variable());
+    if (!was_enabled)
+        TRY(write_enable_variable(true));
+
+    HashMap<DeprecatedString, u64> folded_stacks;
+    u64 exported = 0;
+    u64 overwritten = 0;
+    auto deadline = Time::now_monotonic() + Time::from_seconds(duration_seconds);
+
+    while (!s_interrupted && (duration_seconds == 0 || Time::now_monotonic() < deadline)) {
+        usleep(interval_ms * 1000);
+
+        auto file = TRY(Core::Stream::File::open(samples_path, Core::Stream::OpenMode::Read));
+        auto json = TRY(JsonValue::from_string(TRY(file->read_until_eof())));
+        auto& object = json.as_object();
+        overwritten += object.get_u64("overwritten"sv).value_or(0);
+
+        object.get_array("samples"sv)->for_each([&](JsonValue const& value) {
+            auto& sample = value.as_object();
+            auto pid = sample.get_i32("pid"sv).value_or(0);
+            auto tid = sample.get_i32("tid"sv).value_or(0);
+            if ((pid_filter >= 0 && pid != pid_filter) || (tid_filter >= 0 && tid != tid_filter))
+                return;
+            ++exported;
+
+            auto& process = process_info(pid);
+            auto& stack = sample.get_array("stack"sv).value();
+
+            if (folded) {
+                // Folded stacks go from the outermost frame to the innermost one.
+                StringBuilder builder;
+                builder.append(process.name);
+                for (size_t i = stack.size(); i > 0; --i) {
+                    DeprecatedString object_path;
+                    builder.append(';');
+                    builder.append(symbolicate(process, stack[i - 1].to_addr(), i == 1, object_path));
+                }
+                folded_stacks.ensure(builder.to_deprecated_string(), [] { return 0; })++;
+                return;
+            }
+
+            auto timestamp_ns = sample.get_u64("timestamp"sv).value_or(0);
+            outln("{} {}/{} [{:03}] {}.{:06}: 1 cpu-clock:", process.name, pid, tid, sample.get_u32("cpu"sv).value_or(0),
+                timestamp_ns / 1'000'000'000, (timestamp_ns / 1000) % 1'000'000);
+            for (size_t i = 0; i < stack.size(); ++i) {
+                auto address = stack[i].to_addr();
+                DeprecatedString object_path;
+                auto symbol = symbolicate(process, address, i == 0, object_path);
+                outln("\t{:16x} {} ({})", address, symbol, object_path);
+            }
+            outln();
+        });
+    }
+
+    if (!was_enabled)
+        TRY(write_enable_variable(false));
+
+    for (auto& it : folded_stacks)
+        outln("{} {}", it.key, it.value);
+
+    warnln("Exported {} samples, {} samples were overwritten before they could be read", exported, overwritten);
+    return 0;
+}
@@ -10,12 +10,13 @@
 #include <LibCore/File.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
+#include <LibThreading/TreeWalker.h>
 #include <stdio.h>
 #include <unistd.h>
 
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
-    TRY(Core::System::pledge("stdio rpath cpath"));
+    TRY(Core::System::pledge("stdio rpath cpath thread"));
 
     bool recursive = false;
     bool force = false;
@@ -36,6 +37,24 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         return 1;
     }
 
+    // Note: Everything in a directory is removed in parallel, and the directory itself once it's empty.
+    Threading::TreeWalker<Empty> walker;
+    walker.on_file = [](auto const& entry) -> ErrorOr<Empty> {
+        TRY(Core::System::unlinkat(entry.parent_fd, entry.name, 0));
+        return Empty {};
+    };
+    walker.on_leave_directory = [](auto const& entry, auto&) -> ErrorOr<Empty> {
+        TRY(Core::System::unlinkat(entry.parent_fd, entry.name, AT_REMOVEDIR));
+        return Empty {};
+    };
+
+    auto remove = [&](StringView path) -> ErrorOr<void> {
+        if (!recursive)
+            return Core::File::remove(path, Core::File::RecursionMode::Disallowed);
+        TRY(walker.walk(path));
+        return {};
+    };
+
     bool had_errors = false;
     for (auto& path : paths) {
         if (!no_preserve_root && path == "/") {
@@ -43,7 +62,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             continue;
         }
 
-        auto result = Core::File::remove(path, recursive ? Core::File::RecursionMode::Allowed : Core::File::RecursionMode::Disallowed);
+        auto result = remove(path);
 
         if (result.is_error()) {
             auto error = result.error();
@@ -6,13 +6,15 @@
  */
 
 #include <AK/DeprecatedString.h>
-#include <AK/QuickSort.h>
+#include <AK/StringBuilder.h>
 #include <AK/Vector.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/Stream.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
+#include <LibThreading/ThreadPool.h>
 #include <ctype.h>
+#include <string.h>
 
 struct Line {
     StringView key;
@@ -35,19 +37,6 @@ struct Line {
 
         return key == other.key;
     }
-
-private:
-};
-
-template<>
-struct AK::Traits<Line> : public GenericTraits<Line> {
-    static unsigned hash(Line l)
-    {
-        if (l.numeric)
-            return l.numeric_key;
-
-        return l.key.hash();
-    }
 };
 
 struct Options {
@@ -55,46 +44,158 @@ struct Options {
     bool unique { false };
     bool numeric { false };
     StringView separator { "\0", 1 };
+    size_t buffer_size_in_mib { 64 };
     Vector<DeprecatedString> files;
 };
 
-static ErrorOr<void> load_file(Options options, StringView filename, Vector<Line>& lines, HashTable<Line>& seen)
+// A sorted run of lines that didn't fit into memory together with the rest, waiting in a temporary file to be merged.
+struct Run {
+    NonnullOwnPtr<Core::Stream::BufferedFile> file;
+    Optional<Line> current;
+};
+
+// Lines with the same key stay in the order they were read in, so that -u keeps the first one of them.
+struct SortState {
+    // The lines read since the last run was written out, in the order they were read in.
+    Vector<Line> lines;
+    size_t buffered_bytes { 0 };
+    Vector<Run> runs;
+};
+
+// FIXME: Unlimited line length
+static constexpr size_t line_buffer_size = 4096;
+
+static Line make_line(Options const& options, DeprecatedString line)
+{
+    StringView key = line;
+    if (options.key_field != 0) {
+        auto split = (options.separator[0])
+            ? line.split_view(options.separator[0])
+            : line.split_view(isspace);
+        if (options.key_field - 1 >= split.size()) {
+            key = ""sv;
+        } else {
+            key = split[options.key_field - 1];
+        }
+    }
+
+    return { key, key.to_int().value_or(0), line, options.numeric };
+}
+
+static void sort_buffered_lines(SortState& state)
+{
+    Vector<size_t> order;
+    order.ensure_capacity(state.lines.size());
+    for (size_t i = 0; i < state.lines.size(); ++i)
+        order.unchecked_append(i);
+
+    // The keys are worked out once per line up front, so comparing two lines never has to look at the lines again.
+    auto const& lines = state.lines;
+    Threading::ThreadPool::the().parallel_sort(order.span(), [&](size_t a, size_t b) {
+        if (lines[a] < lines[b])
+            return true;
+        if (lines[b] < lines[a])
+            return false;
+        return a < b;
+    });
+
+    Vector<Line> sorted_lines;
+    sorted_lines.ensure_capacity(state.lines.size());
+    for (auto index : order)
+        sorted_lines.unchecked_append(move(state.lines[index]));
+    state.lines = move(sorted_lines);
+}
+
+static ErrorOr<Optional<Line>> read_run_line(Options const& options, Core::Stream::BufferedFile& file)
+{
+    if (!TRY(file.can_read_line()))
+        return Optional<Line> {};
+
+    Array<u8, line_buffer_size> buffer;
+    return make_line(options, TRY(file.read_line(buffer)));
+}
+
+static ErrorOr<void> spill_buffered_lines(Options const& options, SortState& state)
+{
+    sort_buffered_lines(state);
+
+    char path[] = "/tmp/sort.XXXXXX";
+    auto fd = TRY(Core::System::mkstemp(path));
+    // Nothing else needs the run by its name, and this way it's gone as soon as we're done with it.
+    TRY(Core::System::unlink({ path, strlen(path) }));
+    auto file = TRY(Core::Stream::File::adopt_fd(fd, Core::Stream::OpenMode::ReadWrite));
+
+    StringBuilder builder;
+    Line const* previous = nullptr;
+    for (auto const& line : state.lines) {
+        if (options.unique && previous && *previous == line)
+            continue;
+        previous = &line;
+        builder.append(line.line);
+        builder.append('\n');
+        if (builder.length() >= 64 * KiB) {
+            TRY(file->write_entire_buffer(builder.string_view().bytes()));
+            builder.clear();
+        }
+    }
+    TRY(file->write_entire_buffer(builder.string_view().bytes()));
+    TRY(file->seek(0, SeekMode::SetPosition));
+
+    auto buffered_file = TRY(Core::Stream::BufferedFile::create(move(file)));
+    auto current = TRY(read_run_line(options, *buffered_file));
+    TRY(state.runs.try_append({ move(buffered_file), move(current) }));
+
+    state.lines.clear();
+    state.buffered_bytes = 0;
+    return {};
+}
+
+static ErrorOr<void> load_file(Options const& options, StringView filename, SortState& state)
 {
     auto file = TRY(Core::Stream::BufferedFile::create(
         TRY(Core::Stream::File::open_file_or_standard_stream(filename, Core::Stream::OpenMode::Read))));
 
-    // FIXME: Unlimited line length
-    auto buffer = TRY(ByteBuffer::create_uninitialized(4096));
+    auto buffer = TRY(ByteBuffer::create_uninitialized(line_buffer_size));
     while (TRY(file->can_read_line())) {
         DeprecatedString line = TRY(file->read_line(buffer));
 
-        StringView key = line;
-        if (options.key_field != 0) {
-            auto split = (options.separator[0])
-                ? line.split_view(options.separator[0])
-                : line.split_view(isspace);
-            if (options.key_field - 1 >= split.size()) {
-                key = ""sv;
-            } else {
-                key = split[options.key_field - 1];
-            }
-        }
+        state.buffered_bytes += sizeof(Line) + line.length();
+        state.lines.append(make_line(options, move(line)));
+        if (state.buffered_bytes >= options.buffer_size_in_mib * MiB)
+            TRY(spill_buffered_lines(options, state));
+    }
 
-        Line l = { key, key.to_int().value_or(0), line, options.numeric };
+    return {};
+}
 
-        if (!options.unique || !seen.contains(l)) {
-            lines.append(l);
-            if (options.unique)
-                seen.set(l);
+// Merges the runs by repeatedly taking the smallest line at the front of any of them; on ties, the earlier run wins.
+static ErrorOr<void> merge_runs(Options const& options, SortState& state)
+{
+    Optional<Line> previous;
+    while (true) {
+        Optional<size_t> smallest;
+        for (size_t i = 0; i < state.runs.size(); ++i) {
+            auto const& current = state.runs[i].current;
+            if (current.has_value() && (!smallest.has_value() || *current < *state.runs[*smallest].current))
+                smallest = i;
         }
-    }
+        if (!smallest.has_value())
+            return {};
 
-    return {};
+        auto& run = state.runs[*smallest];
+        auto line = run.current.release_value();
+        run.current = TRY(read_run_line(options, *run.file));
+
+        if (options.unique && previous.has_value() && *previous == line)
+            continue;
+        outln("{}", line.line);
+        previous = move(line);
+    }
 }
 
 ErrorOr<int> serenity_main([[maybe_unused]] Main::Arguments arguments)
 {
-    TRY(Core::System::pledge("stdio rpath"));
+    TRY(Core::System::pledge("stdio rpath wpath cpath thread"));
 
     Options options;
 
@@ -103,23 +204,34 @@ ErrorOr<int> serenity_main([[maybe_unused]] Main::Arguments arguments)
     args_parser.add_option(options.unique, "Don't emit duplicate lines", "unique", 'u');
     args_parser.add_option(options.numeric, "treat the key field as a number", "numeric", 'n');
     args_parser.add_option(options.separator, "The separator to split fields by", "sep", 't', "char");
+    args_parser.add_option(options.buffer_size_in_mib, "How much input to sort in memory before using temporary files (default: 64)", "buffer-size", 'S', "MiB");
     args_parser.add_positional_argument(options.files, "Files to sort", "file", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
-    Vector<Line> lines;
-    HashTable<Line> seen;
+    SortState state;
 
     if (options.files.size() == 0) {
-        TRY(load_file(options, "-"sv, lines, seen));
+        TRY(load_file(options, "-"sv, state));
     } else {
         for (auto& file : options.files) {
-            TRY(load_file(options, file, lines, seen));
+            TRY(load_file(options, file, state));
         }
     }
 
-    quick_sort(lines);
+    if (!state.runs.is_empty()) {
+        if (!state.lines.is_empty())
+            TRY(spill_buffered_lines(options, state));
+        TRY(merge_runs(options, state));
+        return 0;
+    }
+
+    sort_buffered_lines(state);
 
-    for (auto& line : lines) {
+    Line const* previous = nullptr;
+    for (auto& line : state.lines) {
+        if (options.unique && previous && *previous == line)
+            continue;
+        previous = &line;
         outln("{}", line.line);
     }
 
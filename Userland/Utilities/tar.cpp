@@ -8,15 +8,19 @@
 #include <AK/LexicalPath.h>
 #include <AK/Span.h>
 #include <AK/Vector.h>
+#include <LibArchive/TarIndex.h>
 #include <LibArchive/TarStream.h>
 #include <LibCompress/Gzip.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/Directory.h>
 #include <LibCore/File.h>
+#include <LibCore/MappedFile.h>
 #include <LibCore/Stream.h>
 #include <LibCore/System.h>
 #include <LibMain/Main.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/ThreadPool.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <sys/stat.h>
@@ -24,6 +28,89 @@
 
 constexpr size_t buffer_size = 4096;
 
+// Lists or extracts an uncompressed archive that is entirely in memory. Since all member contents are at hand, regular
+// files are written out in parallel, after the directories and symlinks have been created in archive order.
+static ErrorOr<int> list_or_extract_indexed_archive(ReadonlyBytes archive, bool list, bool extract, bool verbose)
+{
+    auto index = TRY(Archive::TarIndex::create(archive));
+
+    struct FileToExtract {
+        DeprecatedString absolute_path;
+        mode_t mode;
+        ReadonlyBytes contents;
+    };
+    Vector<FileToExtract> files_to_extract;
+
+    for (auto const& member : index.members()) {
+        auto const& header = *member.header;
+
+        if (list || verbose)
+            outln("{}", member.path);
+
+        if (!extract)
+            continue;
+
+        DeprecatedString absolute_path = Core::File::absolute_path(member.path);
+        auto parent_path = LexicalPath(absolute_path).parent();
+        auto header_mode = TRY(header.mode());
+
+        switch (header.type_flag()) {
+        case Archive::TarFileType::NormalFile:
+        case Archive::TarFileType::AlternateNormalFile: {
+            // A later member with the same path would overwrite this one anyway, and they must not be written at once.
+            if (index.member_with_path(member.path) != &member)
+                break;
+
+            MUST(Core::Directory::create(parent_path, Core::Directory::CreateDirectories::Yes));
+            TRY(files_to_extract.try_append({ move(absolute_path), header_mode, member.contents }));
+            break;
+        }
+        case Archive::TarFileType::SymLink: {
+            MUST(Core::Directory::create(parent_path, Core::Directory::CreateDirectories::Yes));
+
+            TRY(Core::System::symlink(header.link_name(), absolute_path));
+            break;
+        }
+        case Archive::TarFileType::Directory: {
+            MUST(Core::Directory::create(parent_path, Core::Directory::CreateDirectories::Yes));
+
+            auto result_or_error = Core::System::mkdir(absolute_path, header_mode);
+            if (result_or_error.is_error() && result_or_error.error().code() != EEXIST)
+                return result_or_error.error();
+            break;
+        }
+        default:
+            // FIXME: Implement other file types
+            warnln("file type '{}' of {} is not yet supported", (char)header.type_flag(), header.filename());
+            VERIFY_NOT_REACHED();
+        }
+    }
+
+    auto write_file = [](FileToExtract const& file) -> ErrorOr<void> {
+        int fd = TRY(Core::System::open(file.absolute_path, O_CREAT | O_WRONLY, file.mode));
+        auto contents = file.contents;
+        while (!contents.is_empty())
+            contents = contents.slice(TRY(Core::System::write(fd, contents)));
+        TRY(Core::System::close(fd));
+        return {};
+    };
+
+    Threading::Mutex error_mutex;
+    Optional<Error> first_error;
+    Threading::ThreadPool::the().parallel_for_each(files_to_extract.span(), [&](auto const& file) {
+        auto result = write_file(file);
+        if (result.is_error()) {
+            Threading::MutexLocker locker(error_mutex);
+            if (!first_error.has_value())
+                first_error = result.release_error();
+        }
+    });
+    if (first_error.has_value())
+        return first_error.release_value();
+
+    return 0;
+}
+
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
     bool create = false;
@@ -64,6 +151,15 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         if (!directory.is_empty())
             TRY(Core::System::chdir(directory));
 
+        // Uncompressed archives in regular files are mapped and indexed, instead of being read through one member at a time.
+        if (!gzip && !archive_file.is_empty()) {
+            auto archive_stat = TRY(Core::System::stat(archive_file));
+            if (S_ISREG(archive_stat.st_mode) && archive_stat.st_size > 0) {
+                auto mapped_archive = TRY(Core::MappedFile::map(archive_file));
+                return list_or_extract_indexed_archive(mapped_archive->bytes(), list, extract, verbose);
+            }
+        }
+
         NonnullOwnPtr<AK::Stream> input_stream = TRY(Core::Stream::File::open_file_or_standard_stream(archive_file, Core::Stream::OpenMode::Read));
 
         if (gzip)
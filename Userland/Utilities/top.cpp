@@ -89,9 +89,10 @@ struct Snapshot {
     u64 total_time_scheduled_kernel { 0 };
 };
 
-static ErrorOr<Snapshot> get_snapshot()
+static ErrorOr<Snapshot> get_snapshot(Core::ProcessStatisticsReader& reader)
 {
-    auto all_processes = TRY(Core::ProcessStatisticsReader::get_all());
+    TRY(reader.update());
+    auto const& all_processes = reader.statistics();
 
     Snapshot snapshot;
     for (auto& process : all_processes.processes) {
@@ -199,7 +200,7 @@ static void enable_nonblocking_stdin()
 ErrorOr<int> serenity_main(Main::Arguments arguments)
 {
     TRY(Core::System::pledge("stdio rpath tty sigaction"));
-    TRY(Core::System::unveil("/sys/kernel/processes", "r"));
+    TRY(Core::System::unveil("/sys/kernel/process_statistics", "r"));
     TRY(Core::System::unveil("/etc/passwd", "r"));
     unveil(nullptr, nullptr);
 
@@ -216,8 +217,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     enable_nonblocking_stdin();
 
+    auto reader = TRY(Core::ProcessStatisticsReader::create());
     Vector<ThreadData*> threads;
-    auto prev = TRY(get_snapshot());
+    auto prev = TRY(get_snapshot(*reader));
     usleep(10000);
     for (;;) {
         if (g_window_size_changed) {
@@ -225,7 +227,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             g_window_size_changed = false;
         }
 
-        auto current = TRY(get_snapshot());
+        auto current = TRY(get_snapshot(*reader));
         auto total_scheduled_diff = current.total_time_scheduled - prev.total_time_scheduled;
 
         printf("\033[3J\033[H\033[2J");
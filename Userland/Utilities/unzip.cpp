@@ -5,6 +5,7 @@
  */
 
 #include <AK/Assertions.h>
+#include <AK/Atomic.h>
 #include <AK/NumberFormat.h>
 #include <AK/StringUtils.h>
 #include <LibArchive/Zip.h>
@@ -15,29 +16,39 @@
 #include <LibCore/MappedFile.h>
 #include <LibCore/System.h>
 #include <LibCrypto/Checksum/CRC32.h>
+#include <LibThreading/ThreadPool.h>
 #include <sys/stat.h>
 
-static bool unpack_zip_member(Archive::ZipMember zip_member, bool quiet)
+static bool create_zip_member_directories(Archive::ZipMember const& zip_member, bool quiet)
 {
-    if (zip_member.is_directory) {
-        if (auto maybe_error = Core::System::mkdir(zip_member.name, 0755); maybe_error.is_error()) {
-            warnln("Failed to create directory '{}': {}", zip_member.name, maybe_error.error());
+    if (!zip_member.is_directory) {
+        if (auto maybe_error = Core::Directory::create(LexicalPath(zip_member.name.to_deprecated_string()).parent(), Core::Directory::CreateDirectories::Yes); maybe_error.is_error()) {
+            warnln("Failed to create the parent directory of '{}': {}", zip_member.name, maybe_error.error());
             return false;
         }
-        if (!quiet)
-            outln(" extracting: {}", zip_member.name);
         return true;
     }
-    MUST(Core::Directory::create(LexicalPath(zip_member.name.to_deprecated_string()).parent(), Core::Directory::CreateDirectories::Yes));
+
+    if (auto maybe_error = Core::System::mkdir(zip_member.name, 0755); maybe_error.is_error()) {
+        warnln("Failed to create directory '{}': {}", zip_member.name, maybe_error.error());
+        return false;
+    }
+    if (!quiet)
+        outln(" extracting: {}", zip_member.name);
+    return true;
+}
+
+// Note: This may be called for several members at once, from different threads.
+static bool unpack_zip_member(Archive::ZipMember const& zip_member)
+{
+    VERIFY(!zip_member.is_directory);
+
     auto new_file = Core::File::construct(zip_member.name.to_deprecated_string());
     if (!new_file->open(Core::OpenMode::WriteOnly)) {
         warnln("Can't write file {}: {}", zip_member.name, new_file->error_string());
         return false;
     }
 
-    if (!quiet)
-        outln(" extracting: {}", zip_member.name);
-
     Crypto::Checksum::CRC32 checksum;
     switch (zip_member.compression_method) {
     case Archive::ZipCompressionMethod::Store: {
@@ -123,7 +134,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         TRY(Core::System::chdir(output_directory_path));
     }
 
-    auto success = TRY(zip_file->for_each_member([&](auto zip_member) {
+    Vector<Archive::ZipMember> files_to_extract;
+    for (size_t i = 0; i < zip_file->member_count(); ++i) {
+        auto zip_member = TRY(zip_file->member_at(i));
         bool keep_file = false;
 
         if (!file_filters.is_empty()) {
@@ -139,13 +152,25 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             keep_file = true;
         }
 
-        if (keep_file) {
-            if (!unpack_zip_member(zip_member, quiet))
-                return IterationDecision::Break;
-        }
+        if (!keep_file)
+            continue;
+
+        // All directories are created up front, so that the files can then be unpacked independently of each other.
+        if (!create_zip_member_directories(zip_member, quiet))
+            return 1;
+        if (zip_member.is_directory)
+            continue;
+
+        if (!quiet)
+            outln(" extracting: {}", zip_member.name);
+        TRY(files_to_extract.try_append(move(zip_member)));
+    }
 
-        return IterationDecision::Continue;
-    }));
+    Atomic<bool> success { true };
+    Threading::ThreadPool::the().parallel_for_each(files_to_extract.span(), [&](auto const& zip_member) {
+        if (!unpack_zip_member(zip_member))
+            success = false;
+    });
 
     return success ? 0 : 1;
 }
@@ -10,6 +10,7 @@
 #include <AK/URLParser.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/File.h>
+#include <LibCore/MappedFile.h>
 #include <LibCore/Stream.h>
 #include <LibMain/Main.h>
 #include <LibXML/DOM/Document.h>
@@ -516,10 +517,9 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     parser.parse(arguments);
 
     s_path = Core::File::real_path_for(filename);
-    auto file = TRY(Core::Stream::File::open(s_path, Core::Stream::OpenMode::Read));
-    auto contents = TRY(file->read_until_eof());
+    auto file = TRY(Core::MappedFile::map(s_path));
 
-    auto xml_parser = parse(contents);
+    auto xml_parser = parse(StringView { file->bytes() });
     auto result = xml_parser.parse();
     if (result.is_error()) {
         if (xml_parser.parse_error_causes().is_empty()) {
@@ -28,7 +28,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(force, "Overwrite existing zip file", "force", 'f');
     args_parser.parse(arguments);
 
-    TRY(Core::System::pledge("stdio rpath wpath cpath"));
+    TRY(Core::System::pledge("stdio rpath wpath cpath thread"));
 
     auto cwd = TRY(Core::System::getcwd());
     TRY(Core::System::unveil(LexicalPath::absolute_path(cwd, zip_path), "wc"sv));
@@ -58,7 +58,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         Archive::ZipMember member {};
         member.name = TRY(String::from_deprecated_string(canonicalized_path));
 
-        auto deflate_buffer = Compress::DeflateCompressor::compress_all(file_buffer);
+        auto deflate_buffer = Compress::DeflateCompressor::compress_all(file_buffer, Compress::DeflateCompressor::CompressionLevel::GOOD, Compress::DeflateCompressor::UseThreadPool::Yes);
         if (!deflate_buffer.is_error() && deflate_buffer.value().size() < file_buffer.size()) {
             member.compressed_data = deflate_buffer.value().bytes();
             member.compression_method = Archive::ZipCompressionMethod::Deflate;